@@ -115,6 +115,11 @@ struct HyCCAdapter::HyCCAdapterImpl {
   std::unordered_map<simple_circuitt::gatet::wire_endpointt, WireVector, wire_endpoint_hasht>
       yao_wires_;
 
+  bool release_dead_wires_ = false;
+  // number of gates which still need to read the wires of an endpoint
+  std::unordered_map<simple_circuitt::gatet::wire_endpointt, std::size_t, wire_endpoint_hasht>
+      num_readers_;
+
   MPCProtocol get_protocol_from_filename(const std::string&);
   simple_circuitt& load_circuit_files();
   void create_input_gate(std::size_t input_owner, const std::string& label, std::size_t index,
@@ -130,6 +135,10 @@ struct HyCCAdapter::HyCCAdapterImpl {
   const WireVector& store_wires(const simple_circuitt::gatet::wire_endpointt&, MPCProtocol,
                                 WireVector&&);
 
+  void count_readers(simple_circuitt&);
+  void release_wires(const simple_circuitt::gatet::wire_endpointt&);
+  void release_input_wires(const simple_circuitt::gatet*);
+
   void topological_traversal(simple_circuitt&);
   void visit_output_gate(simple_circuitt::gatet* gate);
   void visit_split_gate(simple_circuitt::gatet* gate);
@@ -452,6 +461,7 @@ void HyCCAdapter::HyCCAdapterImpl::create_output_gate(std::size_t output_owner,
   } else {
     throw hycc_error(fmt::format("unexpected protocol {}", ToString(protocol)));
   }
+  release_input_wires(gate);
 }
 
 const WireVector& HyCCAdapter::HyCCAdapterImpl::get_or_create_wires(
@@ -656,6 +666,35 @@ void HyCCAdapter::HyCCAdapterImpl::visit_binary_gate(simple_circuitt::gatet* gat
   store_wires(primary_output(gate), protocol, std::move(output));
 }
 
+void HyCCAdapter::HyCCAdapterImpl::count_readers(simple_circuitt& main_circuit) {
+  main_circuit.topological_traversal([this](simple_circuitt::gatet* gate) {
+    for (std::size_t input_i = 0; input_i < gate->num_fanins(); ++input_i) {
+      ++num_readers_[gate->fanin_range()[input_i]];
+    }
+  });
+}
+
+void HyCCAdapter::HyCCAdapterImpl::release_wires(
+    const simple_circuitt::gatet::wire_endpointt& key) {
+  auto it = num_readers_.find(key);
+  if (it == num_readers_.end() || --it->second > 0) {
+    return;
+  }
+  num_readers_.erase(it);
+  arithmetic_wires_.erase(key);
+  boolean_wires_.erase(key);
+  yao_wires_.erase(key);
+}
+
+void HyCCAdapter::HyCCAdapterImpl::release_input_wires(const simple_circuitt::gatet* gate) {
+  if (!release_dead_wires_) {
+    return;
+  }
+  for (std::size_t input_i = 0; input_i < gate->num_fanins(); ++input_i) {
+    release_wires(gate->fanin_range()[input_i]);
+  }
+}
+
 void HyCCAdapter::HyCCAdapterImpl::topological_traversal(simple_circuitt& main_circuit) {
   const auto visitor = [this](simple_circuitt::gatet* gate) {
     auto gate_op = gate->get_operation();
@@ -687,10 +726,11 @@ void HyCCAdapter::HyCCAdapterImpl::topological_traversal(simple_circuitt& main_c
       case simple_circuitt::INPUT:
       case simple_circuitt::OUTPUT:
         // inputs and outputs are handled separately
-        break;
+        return;
       case simple_circuitt::LUT:
         throw hycc_error("HyCC operation LUT is not supported");
     }
+    release_input_wires(gate);
   };
   main_circuit.topological_traversal(visitor);
 }
@@ -727,9 +767,22 @@ void HyCCAdapter::load_circuit(const std::string& file_path) {
   impl_->circuit_directory_ = path.parent_path();
 
   auto& main_circuit = impl_->load_circuit_files();
+  if (impl_->release_dead_wires_) {
+    impl_->count_readers(main_circuit);
+  }
   impl_->process_circuit_inputs(main_circuit);
   impl_->topological_traversal(main_circuit);
   impl_->process_circuit_outputs(main_circuit);
+  if (impl_->logger_ && impl_->release_dead_wires_) {
+    impl_->logger_->LogDebug(
+        fmt::format("loaded HyCC circuit, still holding the wires of {} endpoints",
+                    impl_->arithmetic_wires_.size() + impl_->boolean_wires_.size() +
+                        impl_->yao_wires_.size()));
+  }
+}
+
+void HyCCAdapter::set_release_dead_wires(bool release) noexcept {
+  impl_->release_dead_wires_ = release;
 }
 
 void HyCCAdapter::clear_hycc_data() {
@@ -741,6 +794,8 @@ void HyCCAdapter::clear_hycc_data() {
       .swap(impl_->boolean_wires_);
   std::unordered_map<simple_circuitt::gatet::wire_endpointt, WireVector, wire_endpoint_hasht>()
       .swap(impl_->yao_wires_);
+  std::unordered_map<simple_circuitt::gatet::wire_endpointt, std::size_t, wire_endpoint_hasht>()
+      .swap(impl_->num_readers_);
 }
 
 std::size_t HyCCAdapter::get_num_simd() const noexcept { return impl_->num_simd_; }
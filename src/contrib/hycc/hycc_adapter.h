@@ -51,6 +51,11 @@ class HyCCAdapter {
   void load_circuit(const std::string& path);
   void clear_hycc_data();
 
+  // Drop the adapter's references to the wires of a HyCC wire endpoint as soon as the last gate
+  // reading it has been created while the circuit is traversed in topological order, such that
+  // only the wires of the current frontier are held (set before load_circuit()).
+  void set_release_dead_wires(bool release) noexcept;
+
   std::size_t get_num_simd() const noexcept;
 
   std::unordered_map<
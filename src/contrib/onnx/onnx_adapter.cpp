@@ -22,6 +22,8 @@
 
 #include "onnx_adapter.h"
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <stdexcept>
@@ -30,9 +32,11 @@
 #include <fmt/format.h>
 #include <onnx/onnx_pb.h>
 
+#include "tensor/model_session.h"
 #include "tensor/network_builder.h"
 #include "tensor/tensor_op.h"
 #include "tensor/tensor_op_factory.h"
+#include "utility/fixed_point.h"
 
 namespace MOTION::onnx {
 
@@ -65,9 +69,233 @@ void OnnxAdapter::load_model(const std::string& path) {
     }
     impl_->model.ParseFromIstream(&in);
   }
+  model_directory_ = std::filesystem::path(path).parent_path();
+  find_fused_relus();
+  find_folded_avgpools();
   visit_model(impl_->model);
 }
 
+WeightStreamingStats OnnxAdapter::stream_weights() {
+  using clock_type = std::chrono::steady_clock;
+  const auto start_time = clock_type::now();
+  WeightStreamingStats stats;
+  auto& graph = *impl_->model.mutable_graph();
+  std::unordered_map<std::string, ::onnx::TensorProto*> initializers;
+  for (auto& initializer : *graph.mutable_initializer()) {
+    initializers.emplace(initializer.name(), &initializer);
+  }
+  const auto share = [this, &stats](auto& promise, auto& initializer, auto dummy) {
+    using T = decltype(dummy);
+    auto values = read_initializer<T>(initializer);
+    stats.max_plaintext_bytes = std::max(stats.max_plaintext_bytes, values.size() * sizeof(T));
+    promise.set_value(std::move(values));
+  };
+  // in the order of the layers
+  for (const auto& node : graph.node()) {
+    for (const auto& input_name : node.input()) {
+      auto it = streamed_weights_.find(input_name);
+      if (it == std::end(streamed_weights_)) {
+        continue;
+      }
+      auto& [tensor_share, promise] = it->second;
+      auto& initializer = *initializers.at(input_name);
+      if (auto* promise_64 =
+              std::get_if<ENCRYPTO::ReusableFiberPromise<std::vector<std::uint64_t>>>(&promise)) {
+        share(*promise_64, initializer, std::uint64_t{});
+      } else {
+        share(std::get<ENCRYPTO::ReusableFiberPromise<std::vector<std::uint32_t>>>(promise),
+              initializer, std::uint32_t{});
+      }
+      // the input gate has consumed the plaintext when its shares are ready
+      tensor_share->wait_online();
+      if (stats.num_tensors++ == 0) {
+        stats.time_to_first_layer =
+            std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - start_time);
+      }
+      streamed_weights_.erase(it);
+    }
+  }
+  if (!streamed_weights_.empty()) {
+    throw std::logic_error("initializer not used by any node");
+  }
+  stats.total_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - start_time);
+  return stats;
+}
+
+template <typename T>
+std::vector<T> OnnxAdapter::read_initializer(::onnx::TensorProto& tensor) const {
+  if (tensor.data_type() != ::onnx::TensorProto::FLOAT) {
+    throw std::invalid_argument(
+        fmt::format("initializer {}: unsupported element type", tensor.name()));
+  }
+  std::size_t num_values = 1;
+  for (const auto d : tensor.dims()) {
+    num_values *= d;
+  }
+  std::vector<float> floats(num_values);
+  if (tensor.data_location() == ::onnx::TensorProto::EXTERNAL) {
+    std::string location;
+    std::size_t offset = 0;
+    for (const auto& entry : tensor.external_data()) {
+      if (entry.key() == "location") {
+        location = entry.value();
+      } else if (entry.key() == "offset") {
+        offset = std::stoull(entry.value());
+      }
+    }
+    const auto data_path = model_directory_ / location;
+    std::ifstream in(data_path, std::ios_base::binary);
+    in.seekg(offset);
+    in.read(reinterpret_cast<char*>(floats.data()), num_values * sizeof(float));
+    if (location.empty() || in.fail()) {
+      throw std::runtime_error(fmt::format("initializer {}: failed to read external data from {}",
+                                           tensor.name(), data_path.string()));
+    }
+  } else if (tensor.has_raw_data()) {
+    // stored in little endian byte order
+    if (tensor.raw_data().size() != num_values * sizeof(float)) {
+      throw std::runtime_error(fmt::format("initializer {}: unexpected data size", tensor.name()));
+    }
+    std::memcpy(floats.data(), tensor.raw_data().data(), tensor.raw_data().size());
+    // release the memory, clear() would keep it
+    std::string().swap(*tensor.mutable_raw_data());
+  } else {
+    if (static_cast<std::size_t>(tensor.float_data_size()) != num_values) {
+      throw std::runtime_error(fmt::format("initializer {}: unexpected data size", tensor.name()));
+    }
+    std::copy(std::begin(tensor.float_data()), std::end(tensor.float_data()), std::begin(floats));
+    ::google::protobuf::RepeatedField<float>().Swap(tensor.mutable_float_data());
+  }
+  std::vector<T> values(num_values);
+  MOTION::fixed_point::encode(values.data(), floats.data(), fractional_bits_, num_values);
+  return values;
+}
+
+void OnnxAdapter::find_fused_relus() {
+  const auto& graph = impl_->model.graph();
+  std::unordered_map<std::string, std::size_t> num_uses;
+  std::unordered_map<std::string, std::reference_wrapper<const ::onnx::NodeProto>> producers;
+  for (const auto& node : graph.node()) {
+    for (const auto& input : node.input()) {
+      ++num_uses[input];
+    }
+    for (const auto& output : node.output()) {
+      producers.emplace(output, std::cref(node));
+    }
+  }
+  for (const auto& output : graph.output()) {
+    ++num_uses[output.name()];
+  }
+  for (const auto& node : graph.node()) {
+    if (node.op_type() != "Relu" || node.input_size() != 1 || node.output_size() != 1) {
+      continue;
+    }
+    const auto& input_name = node.input(0);
+    const auto it = producers.find(input_name);
+    if (it == std::end(producers)) {
+      continue;
+    }
+    const auto& op_type = it->second.get().op_type();
+    if ((op_type == "Conv" || op_type == "Gemm") && num_uses.at(input_name) == 1 &&
+        is_used_only_arithmetically(node.output(0))) {
+      fused_relus_.emplace(input_name, node.output(0));
+    }
+  }
+}
+
+void OnnxAdapter::find_folded_avgpools() {
+  const auto& graph = impl_->model.graph();
+  std::unordered_map<std::string, std::size_t> num_uses;
+  std::unordered_map<std::string, std::reference_wrapper<const ::onnx::NodeProto>> consumers;
+  for (const auto& node : graph.node()) {
+    for (const auto& input : node.input()) {
+      ++num_uses[input];
+      consumers.emplace(input, std::cref(node));
+    }
+  }
+  for (const auto& output : graph.output()) {
+    ++num_uses[output.name()];
+  }
+  for (const auto& node : graph.node()) {
+    if (node.op_type() != "AveragePool" || node.output_size() != 1) {
+      continue;
+    }
+    std::size_t kernel_size = 1;
+    for (const auto& attr : node.attribute()) {
+      if (attr.name() == "kernel_shape") {
+        for (const auto k : attr.ints()) {
+          kernel_size *= k;
+        }
+      }
+    }
+    if (kernel_size < 2 || (kernel_size & (kernel_size - 1)) != 0) {
+      continue;
+    }
+    std::size_t log_kernel_size = 0;
+    while ((std::size_t(1) << log_kernel_size) < kernel_size) {
+      ++log_kernel_size;
+    }
+    // follow the output through Flatten nodes to the linear layer
+    auto name = node.output(0);
+    const ::onnx::NodeProto* consumer = nullptr;
+    while (num_uses[name] == 1) {
+      consumer = &consumers.at(name).get();
+      if (consumer->op_type() != "Flatten" || consumer->output_size() != 1) {
+        break;
+      }
+      name = consumer->output(0);
+    }
+    if (num_uses[name] != 1 || consumer == nullptr || consumer->input(0) != name) {
+      continue;
+    }
+    const auto& op_type = consumer->op_type();
+    if (op_type == "Conv" || op_type == "Gemm") {
+      folded_avgpools_.insert(node.output(0));
+      extra_truncation_bits_.emplace(consumer->output(0), log_kernel_size);
+    }
+  }
+}
+
+std::size_t OnnxAdapter::get_truncation_bits(const std::string& name) const {
+  const auto it = extra_truncation_bits_.find(name);
+  return fractional_bits_ + (it == std::end(extra_truncation_bits_) ? 0 : it->second);
+}
+
+void OnnxAdapter::make_fused_relu(const std::string& name, const tensor::TensorCP& linear_output) {
+  const auto it = fused_relus_.find(name);
+  if (it == std::end(fused_relus_)) {
+    return;
+  }
+  try {
+    // the ReLU in mixed protocol only needs the signs of the values in Boolean sharing
+    const auto msb_tensor = network_builder_.convert_msb(boolean_protocol_, linear_output);
+    auto& tensor_op_factory = network_builder_.get_tensor_op_factory(boolean_protocol_);
+    arithmetic_tensor_map_[it->second] =
+        tensor_op_factory.make_tensor_relu_op(msb_tensor, linear_output);
+  } catch (std::exception&) {
+    // operation not supported, visit_relu handles the node
+    fused_relus_.erase(it);
+  }
+}
+
+bool OnnxAdapter::is_used_only_arithmetically(const std::string& name) const {
+  const auto& graph = impl_->model.graph();
+  for (const auto& node : graph.node()) {
+    for (const auto& input : node.input()) {
+      if (input == name) {
+        const auto& op_type = node.op_type();
+        // assume flatten only appear in front of Gemm
+        if (op_type != "Gemm" && op_type != "Mul" && op_type != "Conv" && op_type != "Flatten" &&
+            op_type != "AveragePool") {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 void OnnxAdapter::visit_initializer(const ::onnx::TensorProto& tensor) {
   if (tensor.dims_size() > 4) {
     throw std::invalid_argument("tensors with > 4 dimensions are not yet supported");
@@ -76,6 +304,19 @@ void OnnxAdapter::visit_initializer(const ::onnx::TensorProto& tensor) {
     throw std::invalid_argument("tensors needs at least 1 dimension");
   }
 
+  if (model_session_ != nullptr) {
+    if (auto weights = model_session_->get_weights(tensor.name())) {
+      // shared in a previous run of the session
+      if (weights->get_protocol() != arithmetic_protocol_) {
+        throw std::logic_error(
+            fmt::format("weights {} were shared with a different protocol", tensor.name()));
+      }
+      arithmetic_tensor_map_.insert({tensor.name(), std::move(weights)});
+      initializer_set_.insert(tensor.name());
+      return;
+    }
+  }
+
   const auto to_tensor_dims = [](const auto& dims) {
     tensor::TensorDimensions tensor_dims = {1, 1, 1, 1};
     auto n = dims.size();
@@ -103,23 +344,40 @@ void OnnxAdapter::visit_initializer(const ::onnx::TensorProto& tensor) {
   auto& tensor_op_factory = network_builder_.get_tensor_op_factory(arithmetic_protocol_);
   if (bit_size_ == 64) {
     if (is_model_provider_) {
-      auto result = tensor_op_factory.make_arithmetic_64_tensor_input_my(tensor_dims);
+      auto result =
+          tensor_op_factory.make_arithmetic_64_tensor_input_my(tensor_dims, fractional_bits_);
       tensor_share = std::move(result.second);
-      input_promises_64_.emplace(tensor.name(),
-                                 std::make_pair(tensor_dims, std::move(result.first)));
+      if (stream_weights_) {
+        streamed_weights_.emplace(tensor.name(),
+                                  std::make_pair(tensor_share, std::move(result.first)));
+      } else {
+        input_promises_64_.emplace(tensor.name(),
+                                   std::make_pair(tensor_dims, std::move(result.first)));
+      }
     } else {
-      tensor_share = tensor_op_factory.make_arithmetic_64_tensor_input_other(tensor_dims);
+      tensor_share =
+          tensor_op_factory.make_arithmetic_64_tensor_input_other(tensor_dims, fractional_bits_);
     }
   } else {
     if (is_model_provider_) {
-      auto result = tensor_op_factory.make_arithmetic_32_tensor_input_my(tensor_dims);
+      auto result =
+          tensor_op_factory.make_arithmetic_32_tensor_input_my(tensor_dims, fractional_bits_);
       tensor_share = std::move(result.second);
-      input_promises_32_.emplace(tensor.name(),
-                                 std::make_pair(tensor_dims, std::move(result.first)));
+      if (stream_weights_) {
+        streamed_weights_.emplace(tensor.name(),
+                                  std::make_pair(tensor_share, std::move(result.first)));
+      } else {
+        input_promises_32_.emplace(tensor.name(),
+                                   std::make_pair(tensor_dims, std::move(result.first)));
+      }
     } else {
-      tensor_share = tensor_op_factory.make_arithmetic_32_tensor_input_other(tensor_dims);
+      tensor_share =
+          tensor_op_factory.make_arithmetic_32_tensor_input_other(tensor_dims, fractional_bits_);
     }
   }
+  if (model_session_ != nullptr) {
+    model_session_->store_weights(tensor.name(), tensor_share);
+  }
   arithmetic_tensor_map_.insert({tensor.name(), std::move(tensor_share)});
   initializer_set_.insert(tensor.name());
 }
@@ -147,6 +405,19 @@ void OnnxAdapter::visit_input(const ::onnx::ValueInfoProto& value_info) {
     throw std::invalid_argument("tensors needs at least 1 dimension");
   }
 
+  if (model_session_ != nullptr) {
+    if (auto weights = model_session_->get_weights(tensor.name())) {
+      // shared in a previous run of the session
+      if (weights->get_protocol() != arithmetic_protocol_) {
+        throw std::logic_error(
+            fmt::format("weights {} were shared with a different protocol", tensor.name()));
+      }
+      arithmetic_tensor_map_.insert({tensor.name(), std::move(weights)});
+      initializer_set_.insert(tensor.name());
+      return;
+    }
+  }
+
   const auto to_tensor_dims = [](const auto& dims) {
     if (std::any_of(std::begin(dims), std::end(dims), [](const auto& d) {
           return d.value_case() != ::onnx::TensorShapeProto_Dimension::kDimValue;
@@ -175,22 +446,45 @@ void OnnxAdapter::visit_input(const ::onnx::ValueInfoProto& value_info) {
   };
 
   tensor::TensorDimensions tensor_dims = to_tensor_dims(tensor_shape.dim());
+  // the first dimension of a network input is its batch dimension
+  auto* batch_dim = [&tensor_dims, n = tensor_shape.dim_size()]() -> std::size_t* {
+    switch (n) {
+      case 4:
+        return &tensor_dims.batch_size_;
+      case 2:
+        return &tensor_dims.height_;
+      default:
+        return nullptr;
+    }
+  }();
+  if (batch_size_ == 0) {
+    batch_size_ = batch_dim ? *batch_dim : 1;
+  } else if (batch_dim) {
+    *batch_dim = batch_size_;
+  } else if (batch_size_ != 1) {
+    throw std::invalid_argument(
+        fmt::format("cannot set the batch size of input {}", value_info.name()));
+  }
   tensor::TensorCP tensor_share;
   auto& tensor_op_factory = network_builder_.get_tensor_op_factory(arithmetic_protocol_);
   if (bit_size_ == 64) {
     if (is_model_provider_) {
-      tensor_share = tensor_op_factory.make_arithmetic_64_tensor_input_other(tensor_dims);
+      tensor_share =
+          tensor_op_factory.make_arithmetic_64_tensor_input_other(tensor_dims, fractional_bits_);
     } else {
-      auto result = tensor_op_factory.make_arithmetic_64_tensor_input_my(tensor_dims);
+      auto result =
+          tensor_op_factory.make_arithmetic_64_tensor_input_my(tensor_dims, fractional_bits_);
       tensor_share = std::move(result.second);
       input_promises_64_.emplace(value_info.name(),
                                  std::make_pair(tensor_dims, std::move(result.first)));
     }
   } else {
     if (is_model_provider_) {
-      tensor_share = tensor_op_factory.make_arithmetic_32_tensor_input_other(tensor_dims);
+      tensor_share =
+          tensor_op_factory.make_arithmetic_32_tensor_input_other(tensor_dims, fractional_bits_);
     } else {
-      auto result = tensor_op_factory.make_arithmetic_32_tensor_input_my(tensor_dims);
+      auto result =
+          tensor_op_factory.make_arithmetic_32_tensor_input_my(tensor_dims, fractional_bits_);
       tensor_share = std::move(result.second);
       input_promises_32_.emplace(value_info.name(),
                                  std::make_pair(tensor_dims, std::move(result.first)));
@@ -291,8 +585,9 @@ void OnnxAdapter::visit_gemm(const ::onnx::NodeProto& node) {
   gemm_op.output_shape_ = gemm_op.compute_output_shape();
   assert(gemm_op.verify());
   const auto output_tensor = tensor_op_factory.make_tensor_gemm_op(
-      gemm_op, input_a_tensor, input_b_tensor, fractional_bits_);
+      gemm_op, input_a_tensor, input_b_tensor, get_truncation_bits(output_name));
   arithmetic_tensor_map_[output_name] = output_tensor;
+  make_fused_relu(output_name, output_tensor);
 }
 
 void OnnxAdapter::visit_conv(const ::onnx::NodeProto& node) {
@@ -388,12 +683,14 @@ void OnnxAdapter::visit_conv(const ::onnx::NodeProto& node) {
     conv_op.input_shape_[0] = input_dims.num_channels_;
     conv_op.input_shape_[1] = input_dims.height_;
     conv_op.input_shape_[2] = input_dims.width_;
+    conv_op.batch_size_ = input_dims.batch_size_;
     conv_op.output_shape_ = conv_op.compute_output_shape();
     assert(conv_op.verify());
   }
   const auto output_tensor = tensor_op_factory.make_tensor_conv2d_op(
-      conv_op, input_tensor, kernel_tensor, fractional_bits_);
+      conv_op, input_tensor, kernel_tensor, get_truncation_bits(output_name));
   arithmetic_tensor_map_[output_name] = output_tensor;
+  make_fused_relu(output_name, output_tensor);
 }
 
 void OnnxAdapter::visit_mul(const ::onnx::NodeProto& node) {
@@ -417,27 +714,15 @@ void OnnxAdapter::visit_relu(const ::onnx::NodeProto& node) {
   const auto& input_name = node.input(0);
   const auto& output_name = node.output(0);
 
-  const bool use_mixed_protocol_relu = [this, &input_name, &output_name] {
-    // check if input is available in arithmetic sharing
-    if (arithmetic_tensor_map_.count(input_name) == 0) {
-      return false;
-    }
-    // check if output is needed only in arithmetic sharing
-    const auto& graph = impl_->model.graph();
-    for (const auto& node : graph.node()) {
-      for (const auto& input : node.input()) {
-        if (input == output_name) {
-          const auto& op_type = node.op_type();
-          // assume flatten only appear in front of Gemm
-          if (op_type != "Gemm" && op_type != "Mul" && op_type != "Conv" && op_type != "Flatten" &&
-              op_type != "AveragePool") {
-            return false;
-          }
-        }
-      }
-    }
-    return true;
-  }();
+  if (fused_relus_.count(input_name) == 1) {
+    // already built together with the linear layer
+    return;
+  }
+
+  // check if input is available in arithmetic sharing and output is needed only in arithmetic
+  // sharing
+  const bool use_mixed_protocol_relu =
+      arithmetic_tensor_map_.count(input_name) == 1 && is_used_only_arithmetically(output_name);
 
   auto& tensor_op_factory = network_builder_.get_tensor_op_factory(boolean_protocol_);
   const auto input_tensor = get_as_boolean_tensor(input_name);
@@ -517,6 +802,7 @@ void OnnxAdapter::visit_maxpool(const ::onnx::NodeProto& node) {
     maxpool_op.input_shape_[0] = input_dims.num_channels_;
     maxpool_op.input_shape_[1] = input_dims.height_;
     maxpool_op.input_shape_[2] = input_dims.width_;
+    maxpool_op.batch_size_ = input_dims.batch_size_;
     maxpool_op.output_shape_ = maxpool_op.compute_output_shape();
     assert(maxpool_op.verify());
   }
@@ -592,11 +878,14 @@ void OnnxAdapter::visit_avgpool(const ::onnx::NodeProto& node) {
     avgpool_op.input_shape_[0] = input_dims.num_channels_;
     avgpool_op.input_shape_[1] = input_dims.height_;
     avgpool_op.input_shape_[2] = input_dims.width_;
+    avgpool_op.batch_size_ = input_dims.batch_size_;
     avgpool_op.output_shape_ = avgpool_op.compute_output_shape();
     assert(avgpool_op.verify());
   }
+  // a folded pool leaves the division to the linear layer after it
+  const auto truncate_bits = folded_avgpools_.count(output_name) == 1 ? 0 : fractional_bits_;
   const auto output_tensor =
-      tensor_op_factory.make_tensor_avgpool_op(avgpool_op, input_tensor, fractional_bits_);
+      tensor_op_factory.make_tensor_avgpool_op(avgpool_op, input_tensor, truncate_bits);
   arithmetic_tensor_map_[output_name] = output_tensor;
 }
 
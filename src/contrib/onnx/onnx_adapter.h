@@ -22,8 +22,11 @@
 
 #pragma once
 
+#include <chrono>
+#include <filesystem>
 #include <unordered_map>
 #include <unordered_set>
+#include <variant>
 
 #include "onnx_visitor.h"
 #include "tensor/tensor.h"
@@ -33,18 +36,48 @@
 namespace MOTION {
 
 namespace tensor {
+class ModelSession;
 class NetworkBuilder;
 }
 
 namespace onnx {
 
+// statistics of OnnxAdapter::stream_weights
+struct WeightStreamingStats {
+  // until the shares of the weights of the first layer are ready
+  std::chrono::microseconds time_to_first_layer{0};
+  // until the shares of all weights are ready
+  std::chrono::microseconds total_time{0};
+  std::size_t num_tensors = 0;
+  // plaintext of the largest weight tensor, only one is held in memory at once
+  std::size_t max_plaintext_bytes = 0;
+};
+
 class OnnxAdapter : public OnnxVisitor {
  public:
   OnnxAdapter(tensor::NetworkBuilder& network_builder, MPCProtocol arithmetic_protocol,
               MPCProtocol boolean_protocol, std::size_t bit_size, std::size_t fractional_bits,
               bool is_model_provider);
   ~OnnxAdapter();
+  // evaluate the network on `batch_size` samples at once, i.e., replace the batch dimension of the
+  // network inputs s.t. the samples share the layers' operations (call before load_model())
+  void set_batch_size(std::size_t batch_size) noexcept { batch_size_ = batch_size; }
+  // batch size of the network inputs (after load_model())
+  std::size_t get_batch_size() const noexcept { return batch_size_; }
+  // The model provider passes the weights stored in the model with stream_weights() instead of
+  // the input promises (call before load_model()).
+  void set_weight_streaming(bool stream_weights) noexcept { stream_weights_ = stream_weights; }
+  // Reuse the shares of the weights stored in `session` by a previous run and store the ones shared
+  // in this run there, s.t. only the inputs are shared (call before load_model()).  The model
+  // provider gets neither input promises nor streamed weights for the reused ones.
+  void set_model_session(tensor::ModelSession* session) noexcept { model_session_ = session; }
   void load_model(const std::string& path);
+  // Encode the weights of the model as fixed-point values and pass them to their input gates one
+  // tensor at a time in the order of the layers using them, the next one after the shares of the
+  // previous one are ready.  Initializers in external data files are only read then, and the data
+  // of every initializer is released from the model after it has been passed on.  Blocks until all
+  // weights are shared, i.e., needs to run concurrently with the backend.
+  WeightStreamingStats stream_weights();
   void visit_initializer(const ::onnx::TensorProto&) override;
   void visit_input(const ::onnx::ValueInfoProto&) override;
   void visit_output(const ::onnx::ValueInfoProto&) override;
@@ -69,16 +102,52 @@ class OnnxAdapter : public OnnxVisitor {
   get_output_futures() noexcept;
 
  private:
+  // fusion pass: find the Relu nodes whose input is the output of a Conv or Gemm node which is not
+  // needed otherwise, such that the ReLU of the linear layer only converts the signs of its output
+  void find_fused_relus();
+  // folding pass: find the AveragePool nodes with a power of two kernel size whose output is only
+  // used by a Conv or Gemm node (possibly through Flatten nodes), such that the pool only sums the
+  // windows and the division is done by truncating log2(kernel size) more bits of the linear layer
+  void find_folded_avgpools();
+  // bits to truncate after the linear layer with output `name`
+  std::size_t get_truncation_bits(const std::string& name) const;
+  // build the ReLU after the linear layer with output `name` if it has been fused with it
+  void make_fused_relu(const std::string& name, const tensor::TensorCP& linear_output);
+  // check if the tensor is only used by operations in arithmetic sharing
+  bool is_used_only_arithmetically(const std::string& name) const;
+
+  template <typename T>
+  std::vector<T> read_initializer(::onnx::TensorProto&) const;
+
   tensor::NetworkBuilder& network_builder_;
   MPCProtocol arithmetic_protocol_;
   MPCProtocol boolean_protocol_;
   std::size_t bit_size_;
   std::size_t fractional_bits_;
   bool is_model_provider_;
+  // batch size of the network inputs, 0 until the inputs are visited to use the one of the model
+  std::size_t batch_size_ = 0;
+  bool stream_weights_ = false;
+  tensor::ModelSession* model_session_ = nullptr;
+  // directory of the model, where the external data of the initializers is looked up
+  std::filesystem::path model_directory_;
 
   std::unordered_set<std::string> initializer_set_;
   std::unordered_map<std::string, tensor::TensorCP> arithmetic_tensor_map_;
   std::unordered_map<std::string, tensor::TensorCP> boolean_tensor_map_;
+  // output of a linear layer -> output of the Relu node fused with it
+  std::unordered_map<std::string, std::string> fused_relus_;
+  // initializer -> its shares and the promise for its values if the weights are streamed
+  std::unordered_map<
+      std::string,
+      std::pair<tensor::TensorCP,
+                std::variant<ENCRYPTO::ReusableFiberPromise<std::vector<std::uint32_t>>,
+                             ENCRYPTO::ReusableFiberPromise<std::vector<std::uint64_t>>>>>
+      streamed_weights_;
+  // outputs of the AveragePool nodes which only sum the windows
+  std::unordered_set<std::string> folded_avgpools_;
+  // output of a linear layer -> additional bits to truncate for the folded AveragePool before it
+  std::unordered_map<std::string, std::size_t> extra_truncation_bits_;
   std::unordered_map<std::string,
                      std::pair<tensor::TensorDimensions,
                                ENCRYPTO::ReusableFiberPromise<std::vector<std::uint32_t>>>>
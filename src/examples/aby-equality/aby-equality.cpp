@@ -41,6 +41,7 @@
 #include "communication/communication_layer.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "utility/logger.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/beavy/gate.h"
@@ -86,7 +87,7 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("num-simd", po::value<std::size_t>()->default_value(1), "number of SIMD values")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("no-run", po::bool_switch()->default_value(false), "just build the circuit, but not execute it")
+    ("no-run", po::bool_switch()->default_value(false), "just build the circuit and print its analysis, but not execute it")
     ;
   // clang-format on
 
@@ -256,6 +257,7 @@ auto make_input_wires(const Options& options) {
 void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend,  WireVector in1, WireVector in2, WireVector in3, WireVector in4) {
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -0,0 +1,200 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "utility/bit_expression.h"
+#include "utility/bit_matrix.h"
+#include "utility/bit_vector.h"
+
+static void BM_xor(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    a ^= b;
+    benchmark::DoNotOptimize(a.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_xor)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+static void BM_and(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    a &= b;
+    benchmark::DoNotOptimize(a.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_and)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+// y ^= (a & b) with a temporary for a & b, as in the online phase of the AND gates before
+static void BM_xor_and_temporary(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  auto y = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    y ^= (a & b);
+    benchmark::DoNotOptimize(y.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_xor_and_temporary)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+static void BM_xor_and_fused(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  auto y = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    y.XorAnd(a, b);
+    benchmark::DoNotOptimize(y.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_xor_and_fused)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+// online phase of the BEAVY AND gate: Delta_y ^= Delta_a & delta_b ^ Delta_b & delta_a ^
+// Delta_a & Delta_b, with one fused operation per product
+static void BM_beavy_and_online_fused(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  auto Delta_y = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto Delta_a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto Delta_b = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto delta_a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto delta_b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    Delta_y.XorAnd(Delta_a, delta_b);
+    Delta_y.XorAnd(Delta_b, delta_a);
+    Delta_y.XorAnd(Delta_a, Delta_b);
+    benchmark::DoNotOptimize(Delta_y.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_beavy_and_online_fused)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+// the same formula as a single expression
+static void BM_beavy_and_online_expression(benchmark::State& state) {
+  using ENCRYPTO::bits;
+  const std::size_t num_bits = state.range(0);
+  auto Delta_y = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto Delta_a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto Delta_b = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto delta_a = ENCRYPTO::BitVector<>::Random(num_bits);
+  const auto delta_b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+  for (auto _ : state) {
+    Delta_y ^= (bits(Delta_a) & (bits(delta_b) ^ bits(Delta_b))) ^ (bits(Delta_b) & bits(delta_a));
+    benchmark::DoNotOptimize(Delta_y.GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_beavy_and_online_expression)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 24);
+
+// count the set bits at each position of many wires as in the COUNT and HAM gates
+static void BM_count_bits_naive(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  const std::size_t num_wires = 64;
+  std::vector<ENCRYPTO::BitVector<>> planes;
+  for (std::size_t i = 0; i < num_wires; ++i) {
+    planes.push_back(ENCRYPTO::BitVector<>::Random(num_bits));
+  }
+  std::vector<std::uint64_t> counts(num_bits);
+
+  for (auto _ : state) {
+    for (const auto& p : planes) {
+      for (std::size_t j = 0; j < num_bits; ++j) {
+        counts[j] += p.Get(j);
+      }
+    }
+    benchmark::DoNotOptimize(counts.data());
+  }
+  state.SetBytesProcessed(state.iterations() * num_wires * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_count_bits_naive)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 20);
+
+static void BM_count_bits_sliced(benchmark::State& state) {
+  const std::size_t num_bits = state.range(0);
+  const std::size_t num_wires = 64;
+  std::vector<ENCRYPTO::BitVector<>> planes;
+  std::vector<const std::byte*> plane_ptrs;
+  for (std::size_t i = 0; i < num_wires; ++i) {
+    planes.push_back(ENCRYPTO::BitVector<>::Random(num_bits));
+  }
+  for (const auto& p : planes) {
+    plane_ptrs.push_back(p.GetData().data());
+  }
+  std::vector<std::uint64_t> counts(num_bits);
+
+  for (auto _ : state) {
+    ENCRYPTO::AccumulateBitCounts<std::uint64_t>(plane_ptrs, 0, num_bits, counts.data());
+    benchmark::DoNotOptimize(counts.data());
+  }
+  state.SetBytesProcessed(state.iterations() * num_wires * ((num_bits + 7) / 8));
+}
+BENCHMARK(BM_count_bits_sliced)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 20);
+
+// transpose the shares of 64 wires with many SIMD values from the wire-major to the SIMD-major layout
+static void BM_transpose_bit_matrix(benchmark::State& state) {
+  const std::size_t num_columns = state.range(0);
+  std::vector<ENCRYPTO::AlignedBitVector> rows;
+  for (std::size_t i = 0; i < 64; ++i) {
+    rows.push_back(ENCRYPTO::AlignedBitVector::Random(num_columns));
+  }
+  ENCRYPTO::BitMatrix matrix(rows);
+
+  for (auto _ : state) {
+    matrix.Transpose();
+    benchmark::DoNotOptimize(matrix.GetRow(0).GetData().data());
+  }
+  state.SetBytesProcessed(state.iterations() * 64 * (num_columns / 8));
+}
+BENCHMARK(BM_transpose_bit_matrix)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 20);
+
+static void BM_transpose_contiguous(benchmark::State& state) {
+  const std::size_t num_columns = state.range(0);
+  std::vector<ENCRYPTO::BitVector<>> rows;
+  for (std::size_t i = 0; i < 64; ++i) {
+    rows.push_back(ENCRYPTO::BitVector<>::Random(num_columns));
+  }
+  const ENCRYPTO::ContiguousBitMatrix matrix(rows);
+  ENCRYPTO::ContiguousBitMatrix transposed(num_columns, 64);
+
+  for (auto _ : state) {
+    ENCRYPTO::ContiguousBitMatrix::Transpose(matrix.GetData().data(), transposed.GetRowData(0), 64,
+                                             num_columns);
+    benchmark::DoNotOptimize(transposed.GetRowData(0));
+  }
+  state.SetBytesProcessed(state.iterations() * 64 * (num_columns / 8));
+}
+BENCHMARK(BM_transpose_contiguous)->RangeMultiplier(1 << 4)->Range(1 << 6, 1 << 20);
@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "utility/fixed_point.h"
+#include "utility/helpers.h"
+
+namespace fp = MOTION::fixed_point;
+using MOTION::Helpers::RandomVector;
+
+// The fixed-point conversions of tensors element by element with std::transform, as in the input
+// and output paths before, and with the vectorized range functions, see MOTION_MAX_ISA in
+// utility/cpu_features.h to compare the AVX2 and AVX-512 versions.
+
+constexpr std::size_t fractional_bits = 16;
+
+template <typename F>
+static std::vector<F> random_values(std::size_t n) {
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<F> dist(-100, 100);
+  std::vector<F> values(n);
+  std::generate(std::begin(values), std::end(values), [&] { return dist(gen); });
+  return values;
+}
+
+template <typename I, typename F>
+static void BM_encode_transform(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto values = random_values<F>(n);
+  std::vector<I> encoded(n);
+
+  for (auto _ : state) {
+    std::transform(std::begin(values), std::end(values), std::begin(encoded),
+                   [](auto x) { return fp::encode<I, F>(x, fractional_bits); });
+    benchmark::DoNotOptimize(encoded.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_encode_transform, std::uint32_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_encode_transform, std::uint64_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_encode_transform, std::uint64_t, double)->Range(1 << 10, 1 << 22);
+
+template <typename I, typename F>
+static void BM_encode_vectorized(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto values = random_values<F>(n);
+  std::vector<I> encoded(n);
+
+  for (auto _ : state) {
+    fp::encode(encoded.data(), values.data(), fractional_bits, n);
+    benchmark::DoNotOptimize(encoded.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_encode_vectorized, std::uint32_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_encode_vectorized, std::uint64_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_encode_vectorized, std::uint64_t, double)->Range(1 << 10, 1 << 22);
+
+template <typename I, typename F>
+static void BM_decode_transform(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  std::vector<I> encoded(n);
+  const auto values = random_values<F>(n);
+  fp::encode(encoded.data(), values.data(), fractional_bits, n);
+  std::vector<F> decoded(n);
+
+  for (auto _ : state) {
+    std::transform(std::begin(encoded), std::end(encoded), std::begin(decoded),
+                   [](auto y) { return fp::decode<I, F>(y, fractional_bits); });
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_decode_transform, std::uint32_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_decode_transform, std::uint64_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_decode_transform, std::uint64_t, double)->Range(1 << 10, 1 << 22);
+
+template <typename I, typename F>
+static void BM_decode_vectorized(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  std::vector<I> encoded(n);
+  const auto values = random_values<F>(n);
+  fp::encode(encoded.data(), values.data(), fractional_bits, n);
+  std::vector<F> decoded(n);
+
+  for (auto _ : state) {
+    fp::decode(decoded.data(), encoded.data(), fractional_bits, n);
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_decode_vectorized, std::uint32_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_decode_vectorized, std::uint64_t, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_decode_vectorized, std::uint64_t, double)->Range(1 << 10, 1 << 22);
+
+template <typename T>
+static void BM_truncate_shared_transform(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  auto shares = RandomVector<T>(n);
+
+  for (auto _ : state) {
+    std::transform(std::begin(shares), std::end(shares), std::begin(shares),
+                   [](auto x) { return -((-x) >> fractional_bits); });
+    benchmark::DoNotOptimize(shares.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_truncate_shared_transform, std::uint32_t)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_truncate_shared_transform, std::uint64_t)->Range(1 << 10, 1 << 22);
+
+template <typename T>
+static void BM_truncate_shared_vectorized(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  auto shares = RandomVector<T>(n);
+
+  for (auto _ : state) {
+    fp::truncate_shared(shares.data(), fractional_bits, n, false);
+    benchmark::DoNotOptimize(shares.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_truncate_shared_vectorized, std::uint32_t)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_truncate_shared_vectorized, std::uint64_t)->Range(1 << 10, 1 << 22);
@@ -23,6 +23,7 @@
 #include <benchmark/benchmark.h>
 #include "algorithm/circuit_loader.h"
 #include "crypto/garbling/half_gates.h"
+#include "crypto/garbling/three_halves.h"
 
 static void BM_garble_and(benchmark::State& state) {
   MOTION::Crypto::garbling::HalfGateGarbler garbler;
@@ -64,6 +65,50 @@ static void BM_evaluate_and(benchmark::State& state) {
 }
 BENCHMARK(BM_evaluate_and)->RangeMultiplier(1 << 2)->Range(1, 1 << 20);
 
+static void BM_garble_and_three_halves(benchmark::State& state) {
+  MOTION::Crypto::garbling::HalfGateGarbler hg_garbler;
+  MOTION::Crypto::garbling::ThreeHalvesGarbler garbler(hg_garbler.get_offset(),
+                                                       hg_garbler.get_public_data());
+  const std::size_t num_ands = state.range(0);
+  auto key_as = ENCRYPTO::block128_vector::make_random(num_ands);
+  auto key_bs = ENCRYPTO::block128_vector::make_random(num_ands);
+  const std::size_t index = 42;
+  ENCRYPTO::block128_vector key_cs(num_ands);
+  const auto table_size = MOTION::Crypto::garbling::three_halves_table_size(num_ands);
+  ENCRYPTO::block128_vector garbled_tables(table_size);
+
+  for (auto _ : state) {
+    garbler.batch_garble_and(key_cs, garbled_tables.data(), index, key_as, key_bs);
+  }
+  state.counters["ands_per_second"] =
+      benchmark::Counter(state.iterations() * num_ands, benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * 16 * table_size);
+}
+BENCHMARK(BM_garble_and_three_halves)->RangeMultiplier(1 << 2)->Range(1, 1 << 20);
+
+static void BM_evaluate_and_three_halves(benchmark::State& state) {
+  MOTION::Crypto::garbling::HalfGateGarbler hg_garbler;
+  MOTION::Crypto::garbling::ThreeHalvesGarbler garbler(hg_garbler.get_offset(),
+                                                       hg_garbler.get_public_data());
+  MOTION::Crypto::garbling::ThreeHalvesEvaluator evaluator(hg_garbler.get_public_data());
+  const std::size_t num_ands = state.range(0);
+  auto key_as = ENCRYPTO::block128_vector::make_random(num_ands);
+  auto key_bs = ENCRYPTO::block128_vector::make_random(num_ands);
+  const std::size_t index = 42;
+  ENCRYPTO::block128_vector key_cs(num_ands);
+  const auto table_size = MOTION::Crypto::garbling::three_halves_table_size(num_ands);
+  ENCRYPTO::block128_vector garbled_tables(table_size);
+  garbler.batch_garble_and(key_cs, garbled_tables.data(), index, key_as, key_bs);
+
+  for (auto _ : state) {
+    evaluator.batch_evaluate_and(key_cs, garbled_tables.data(), index, key_as, key_bs);
+  }
+  state.counters["ands_per_second"] =
+      benchmark::Counter(state.iterations() * num_ands, benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * 16 * table_size);
+}
+BENCHMARK(BM_evaluate_and_three_halves)->RangeMultiplier(1 << 2)->Range(1, 1 << 20);
+
 static void BM_garble_aes_128_circuit(benchmark::State& state) {
   MOTION::Crypto::garbling::HalfGateGarbler garbler;
   MOTION::CircuitLoader circuit_loader;
@@ -51,15 +51,26 @@ constexpr std::size_t ILLEGAL_PROTOCOL{100}, ILLEGAL_OPERATION_TYPE{100};
 
 struct Combination {
   Combination(std::size_t bit_size, MOTION::MPCProtocol protocol,
-              ENCRYPTO::IntegerOperationType op_type, std::size_t num_simd)
-      : bit_size_(bit_size), protocol_(protocol), op_type_(op_type), num_simd_(num_simd) {}
+              ENCRYPTO::IntegerOperationType op_type, std::size_t num_simd,
+              MOTION::IntegerAlgorithm algorithm = MOTION::IntegerAlgorithm::Circuit)
+      : bit_size_(bit_size),
+        protocol_(protocol),
+        op_type_(op_type),
+        num_simd_(num_simd),
+        algorithm_(algorithm) {}
 
   std::size_t bit_size_{0};
   MOTION::MPCProtocol protocol_{ILLEGAL_PROTOCOL};
   ENCRYPTO::IntegerOperationType op_type_{ILLEGAL_OPERATION_TYPE};
   std::size_t num_simd_{0};
+  // only used by DIV and GT
+  MOTION::IntegerAlgorithm algorithm_{MOTION::IntegerAlgorithm::Circuit};
 };
 
+const char* ToString(MOTION::IntegerAlgorithm algorithm) {
+  return algorithm == MOTION::IntegerAlgorithm::Native ? "native" : "circuit";
+}
+
 std::vector<Combination> GenerateAllCombinations() {
   const std::array arithmetic_bit_sizes = {8, 16, 32, 64};
   const std::array nums_simd = {1000};
@@ -74,6 +85,13 @@ std::vector<Combination> GenerateAllCombinations() {
       for (const auto num_simd : nums_simd) {
         combinations.emplace_back(bit_size, MOTION::MPCProtocol::BooleanGMW, op_type, num_simd);
         combinations.emplace_back(bit_size, MOTION::MPCProtocol::BMR, op_type, num_simd);
+        // compare the native circuits with the Bristol ones
+        if (op_type == T::DIV || op_type == T::GT) {
+          for (const auto protocol : {MOTION::MPCProtocol::BooleanGMW, MOTION::MPCProtocol::BMR}) {
+            combinations.emplace_back(bit_size, protocol, op_type, num_simd,
+                                      MOTION::IntegerAlgorithm::Native);
+          }
+        }
       }
     }
   }
@@ -99,8 +117,8 @@ int main(int ac, char* av[]) {
     for (std::size_t i = 0; i < num_repetitions; ++i) {
       MOTION::PartyPtr party{CreateParty(vm)};
       // establish communication channels with other parties
-      auto stats =
-          EvaluateProtocol(party, comb.num_simd_, comb.bit_size_, comb.protocol_, comb.op_type_);
+      auto stats = EvaluateProtocol(party, comb.num_simd_, comb.bit_size_, comb.protocol_,
+                                    comb.op_type_, comb.algorithm_);
       accumulated_stats.add(stats);
       auto comm_stats = party->get_communication_layer().get_transport_statistics();
       accumulated_comm_stats.add(comm_stats);
@@ -108,9 +126,9 @@ int main(int ac, char* av[]) {
     std::cout << fmt::format(MOTION::ToString(comb.protocol_), ENCRYPTO::ToString(comb.op_type_),
                              comb.bit_size_, comb.num_simd_);
     std::cout << MOTION::Statistics::print_stats(
-        fmt::format("Protocol {} operation {} bit size {} SIMD {}",
+        fmt::format("Protocol {} operation {} ({}) bit size {} SIMD {}",
                     MOTION::ToString(comb.protocol_), ENCRYPTO::ToString(comb.op_type_),
-                    comb.bit_size_, comb.num_simd_),
+                    ToString(comb.algorithm_), comb.bit_size_, comb.num_simd_),
         accumulated_stats, accumulated_comm_stats);
   }
   return EXIT_SUCCESS;
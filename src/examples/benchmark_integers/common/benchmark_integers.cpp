@@ -34,7 +34,8 @@
 MOTION::Statistics::RunTimeStats EvaluateProtocol(MOTION::PartyPtr& party, std::size_t num_simd,
                                                   std::size_t bit_size,
                                                   MOTION::MPCProtocol protocol,
-                                                  ENCRYPTO::IntegerOperationType op_type) {
+                                                  ENCRYPTO::IntegerOperationType op_type,
+                                                  MOTION::IntegerAlgorithm algorithm) {
   const std::vector<ENCRYPTO::BitVector<>> tmp_bool(bit_size, ENCRYPTO::BitVector<>(num_simd));
 
   MOTION::SecureUnsignedInteger a, b;
@@ -60,11 +61,11 @@ MOTION::Statistics::RunTimeStats EvaluateProtocol(MOTION::PartyPtr& party, std::
       break;
     }
     case ENCRYPTO::IntegerOperationType::GT: {
-      a > b;
+      a.GreaterThan(b, algorithm);
       break;
     }
     case ENCRYPTO::IntegerOperationType::DIV: {
-      a / b;
+      a.Divide(b, algorithm);
       break;
     }
     case ENCRYPTO::IntegerOperationType::MUL: {
@@ -25,10 +25,12 @@
 #pragma once
 
 #include "base/party.h"
+#include "secure_type/secure_unsigned_integer.h"
 #include "statistics/run_time_stats.h"
 #include "utility/typedefs.h"
 
 MOTION::Statistics::RunTimeStats EvaluateProtocol(MOTION::PartyPtr& party, std::size_t num_simd,
                                                   std::size_t bit_size,
                                                   MOTION::MPCProtocol protocol,
-                                                  ENCRYPTO::IntegerOperationType op_type);
+                                                  ENCRYPTO::IntegerOperationType op_type,
+                                                  MOTION::IntegerAlgorithm algorithm);
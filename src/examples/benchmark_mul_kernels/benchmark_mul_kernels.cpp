@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "protocols/common/mul_kernels.h"
+#include "utility/helpers.h"
+
+using MOTION::Helpers::RandomVector;
+
+// The share computations of the BEAVY multiplication gates per ring width, as a sequence of
+// std::transform passes with a temporary, as in the gates before, and as a single pass.
+
+template <typename T>
+static void BM_beavy_mul_setup_transform(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto delta_a = RandomVector<T>(n), delta_b = RandomVector<T>(n),
+             delta_y = RandomVector<T>(n), delta_ab_1 = RandomVector<T>(n),
+             delta_ab_2 = RandomVector<T>(n);
+  std::vector<T> Delta_y(n);
+
+  for (auto _ : state) {
+    std::transform(std::begin(delta_a), std::end(delta_a), std::begin(delta_b),
+                   std::begin(Delta_y), std::multiplies{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(delta_y),
+                   std::begin(Delta_y), std::plus{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(delta_ab_1),
+                   std::begin(Delta_y), std::plus{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(delta_ab_2),
+                   std::begin(Delta_y), std::plus{});
+    benchmark::DoNotOptimize(Delta_y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_transform, std::uint8_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_transform, std::uint16_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_transform, std::uint32_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_transform, std::uint64_t)->Range(1 << 6, 1 << 20);
+
+template <typename T>
+static void BM_beavy_mul_setup_fused(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto delta_a = RandomVector<T>(n), delta_b = RandomVector<T>(n),
+             delta_y = RandomVector<T>(n), delta_ab_1 = RandomVector<T>(n),
+             delta_ab_2 = RandomVector<T>(n);
+  std::vector<T> Delta_y(n);
+
+  for (auto _ : state) {
+    MOTION::proto::beavy_mul_setup(Delta_y.data(), delta_a.data(), delta_b.data(),
+                                   delta_y.data(), delta_ab_1.data(), delta_ab_2.data(), n);
+    benchmark::DoNotOptimize(Delta_y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_fused, std::uint8_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_fused, std::uint16_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_fused, std::uint32_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_setup_fused, std::uint64_t)->Range(1 << 6, 1 << 20);
+
+template <typename T>
+static void BM_beavy_mul_online_transform(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto Delta_a = RandomVector<T>(n), Delta_b = RandomVector<T>(n),
+             delta_a = RandomVector<T>(n), delta_b = RandomVector<T>(n);
+  auto Delta_y = RandomVector<T>(n);
+  std::vector<T> tmp(n);
+
+  for (auto _ : state) {
+    std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(delta_b), std::begin(tmp),
+                   std::multiplies{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(tmp), std::begin(Delta_y),
+                   std::minus{});
+    std::transform(std::begin(Delta_b), std::end(Delta_b), std::begin(delta_a), std::begin(tmp),
+                   std::multiplies{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(tmp), std::begin(Delta_y),
+                   std::minus{});
+    std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(Delta_b), std::begin(tmp),
+                   std::multiplies{});
+    std::transform(std::begin(Delta_y), std::end(Delta_y), std::begin(tmp), std::begin(Delta_y),
+                   std::plus{});
+    benchmark::DoNotOptimize(Delta_y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_transform, std::uint8_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_transform, std::uint16_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_transform, std::uint32_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_transform, std::uint64_t)->Range(1 << 6, 1 << 20);
+
+template <typename T>
+static void BM_beavy_mul_online_fused(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto Delta_a = RandomVector<T>(n), Delta_b = RandomVector<T>(n),
+             delta_a = RandomVector<T>(n), delta_b = RandomVector<T>(n);
+  auto Delta_y = RandomVector<T>(n);
+
+  for (auto _ : state) {
+    MOTION::proto::beavy_mul_online(Delta_y.data(), Delta_a.data(), Delta_b.data(),
+                                    delta_a.data(), delta_b.data(), n, true);
+    benchmark::DoNotOptimize(Delta_y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_fused, std::uint8_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_fused, std::uint16_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_fused, std::uint32_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_mul_online_fused, std::uint64_t)->Range(1 << 6, 1 << 20);
+
+template <typename T>
+static void BM_beavy_sqr_online_fused(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  const auto Delta_a = RandomVector<T>(n), delta_a = RandomVector<T>(n);
+  auto Delta_y = RandomVector<T>(n);
+
+  for (auto _ : state) {
+    MOTION::proto::beavy_sqr_online(Delta_y.data(), Delta_a.data(), delta_a.data(), n, true);
+    benchmark::DoNotOptimize(Delta_y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_beavy_sqr_online_fused, std::uint8_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_sqr_online_fused, std::uint16_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_sqr_online_fused, std::uint32_t)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_beavy_sqr_online_fused, std::uint64_t)->Range(1 << 6, 1 << 20);
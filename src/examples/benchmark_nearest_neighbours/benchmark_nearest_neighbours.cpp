@@ -0,0 +1,205 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Latency of the Hamming nearest neighbour search (see MOTION::HammingNearestNeighbours) for
+// galleries of random templates, by default of 10^5 and 10^6 templates.  Both parties run in this
+// process and are connected by dummy transports, so the latency does not include the network.
+// The gallery is shared once per size, and each repetition searches the k nearest templates of a
+// fresh query, whose result is checked against the distances computed in the clear.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "algorithm/nearest_neighbour.h"
+#include "communication/communication_layer.h"
+#include "communication/transport.h"
+#include "statistics/run_time_stats.h"
+#include "utility/bit_vector.h"
+#include "utility/logger.h"
+
+namespace po = boost::program_options;
+
+using StatID = MOTION::Statistics::RunTimeStats::StatID;
+
+constexpr std::size_t gallery_owner = 0;
+constexpr std::size_t query_owner = 1;
+
+std::size_t get_distance(const ENCRYPTO::BitVector<>& a, const ENCRYPTO::BitVector<>& b) {
+  std::size_t distance = 0;
+  for (std::size_t bit_j = 0; bit_j < a.GetSize(); ++bit_j) {
+    distance += a.Get(bit_j) != b.Get(bit_j);
+  }
+  return distance;
+}
+
+// whether the positions are k templates with the smallest distances to the query
+bool check_result(const std::vector<ENCRYPTO::BitVector<>>& gallery,
+                  const ENCRYPTO::BitVector<>& query, const std::vector<std::size_t>& positions,
+                  std::size_t k) {
+  std::vector<std::size_t> distances;
+  distances.reserve(gallery.size());
+  for (const auto& t : gallery) {
+    distances.push_back(get_distance(t, query));
+  }
+  if (positions.size() != k) {
+    return false;
+  }
+  std::vector<std::size_t> found;
+  for (auto position : positions) {
+    if (position >= gallery.size()) {
+      return false;
+    }
+    found.push_back(distances[position]);
+  }
+  std::partial_sort(std::begin(distances), std::begin(distances) + k, std::end(distances));
+  distances.resize(k);
+  std::sort(std::begin(found), std::end(found));
+  return found == distances;
+}
+
+struct SizeResult {
+  MOTION::NearestNeighbourStatistics statistics;
+  std::size_t bytes_sent = 0;
+  bool correct = true;
+};
+
+SizeResult run_size(std::size_t gallery_size, std::size_t template_bits, std::size_t k,
+                    std::size_t num_repetitions, std::size_t num_threads) {
+  std::vector<ENCRYPTO::BitVector<>> gallery;
+  gallery.reserve(gallery_size);
+  for (std::size_t template_i = 0; template_i < gallery_size; ++template_i) {
+    gallery.push_back(ENCRYPTO::BitVector<>::RandomSeeded(template_bits, template_i));
+  }
+  std::vector<ENCRYPTO::BitVector<>> queries;
+  for (std::size_t r = 0; r < num_repetitions; ++r) {
+    queries.push_back(ENCRYPTO::BitVector<>::RandomSeeded(template_bits, gallery_size + r));
+  }
+
+  auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2, false);
+  SizeResult result;
+  std::vector<std::future<void>> futs;
+  for (std::size_t i = 0; i < 2; ++i) {
+    futs.emplace_back(std::async(std::launch::async, [&, i] {
+      auto logger = std::make_shared<MOTION::Logger>(i, boost::log::trivial::severity_level::error);
+      comm_layers[i]->set_logger(logger);
+      MOTION::HammingNearestNeighbours engine(*comm_layers[i], gallery_owner, template_bits,
+                                              num_threads, logger);
+      if (i == gallery_owner) {
+        engine.share_gallery(gallery);
+      } else {
+        engine.share_gallery(gallery_size);
+      }
+      // only the searches are measured
+      comm_layers[i]->sync();
+      comm_layers[i]->reset_transport_statistics();
+      for (std::size_t r = 0; r < num_repetitions; ++r) {
+        if (i == gallery_owner) {
+          engine.search(k);
+        } else {
+          const auto positions = engine.search(queries[r], k);
+          result.correct = result.correct && check_result(gallery, queries[r], positions, k);
+        }
+      }
+      comm_layers[i]->sync();
+      if (i == query_owner) {
+        result.statistics = engine.get_statistics();
+      }
+      comm_layers[i]->shutdown();
+    }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  for (const auto& comm_layer : comm_layers) {
+    for (const auto& stats : comm_layer->get_transport_statistics()) {
+      result.bytes_sent += stats.num_bytes_sent;
+    }
+  }
+  return result;
+}
+
+std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]) {
+  bool help;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+      ("help,h", po::bool_switch(&help)->default_value(false),"produce help message")
+      ("gallery-sizes", po::value<std::vector<std::size_t>>()->multitoken()->default_value({100000, 1000000}, "100000 1000000"), "numbers of templates in the gallery")
+      ("template-bits", po::value<std::size_t>()->default_value(256), "bits of each template")
+      ("k", po::value<std::size_t>()->default_value(1), "number of nearest templates to search")
+      ("repetitions", po::value<std::size_t>()->default_value(3), "number of searches per gallery, evaluated one after another")
+      ("threads", po::value<std::size_t>()->default_value(2), "number of threads of each party");
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(ac, av, desc), vm);
+  if (help) {
+    std::cout << desc << "\n";
+    return std::make_pair<po::variables_map, bool>({}, true);
+  }
+  po::notify(vm);
+  return std::make_pair(vm, false);
+}
+
+int main(int ac, char* av[]) {
+  auto [vm, help_flag] = ParseProgramOptions(ac, av);
+  // if help flag is set - print allowed command line arguments and exit
+  if (help_flag) return EXIT_SUCCESS;
+
+  const auto gallery_sizes{vm["gallery-sizes"].as<std::vector<std::size_t>>()};
+  const auto template_bits{vm["template-bits"].as<std::size_t>()};
+  const auto k{vm["k"].as<std::size_t>()};
+  const auto num_repetitions{vm["repetitions"].as<std::size_t>()};
+  const auto num_threads{vm["threads"].as<std::size_t>()};
+  if (num_repetitions == 0) {
+    throw std::invalid_argument("need at least one repetition");
+  }
+
+  bool correct = true;
+  std::cout << fmt::format("{:>10} {:>14} {:>14} {:>14} {:>8} {:>14}\n", "templates",
+                           "sharing [ms]", "latency [ms]", "online [ms]", "rounds",
+                           "MiB/search");
+  for (auto gallery_size : gallery_sizes) {
+    const auto result = run_size(gallery_size, template_bits, k, num_repetitions, num_threads);
+    const auto& statistics = result.statistics;
+    correct = correct && result.correct;
+    std::cout << fmt::format(
+        "{:>10} {:>14.3f} {:>14.3f} {:>14.3f} {:>8} {:>14.3f}{}\n", gallery_size,
+        statistics.gallery_sharing_ms, statistics.get_mean_latency_ms(),
+        k * statistics.run_time_stats.get_percentile(StatID::gates_online, 50),
+        statistics.max_online_rounds,
+        static_cast<double>(result.bytes_sent) / num_repetitions / (1 << 20),
+        result.correct ? "" : "  WRONG RESULT");
+  }
+  return correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
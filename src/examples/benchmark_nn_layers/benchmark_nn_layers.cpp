@@ -20,11 +20,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <array>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <random>
 #include <regex>
 #include <stdexcept>
 #include <string>
@@ -41,11 +43,13 @@
 #include "communication/tcp_transport.h"
 #include "protocols/beavy/tensor.h"
 #include "protocols/gmw/tensor.h"
+#include "protocols/yao/yao_provider.h"
 #include "statistics/analysis.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_op.h"
 #include "tensor/tensor_op_factory.h"
 #include "utility/helpers.h"
+#include "utility/linear_algebra.h"
 #include "utility/logger.h"
 #include "utility/typedefs.h"
 
@@ -64,6 +68,10 @@ struct Options {
   std::string benchmark;
   std::size_t relu_variant;
   std::size_t relu_size;
+  std::size_t yao_chunk_size;
+  std::size_t gemm_variant;
+  std::array<std::size_t, 3> gemm_dims;
+  double weights_density;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -81,6 +89,14 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("benchmark", po::value<std::string>()->required(), "benchmark name")
     ("relu-variant", po::value<std::size_t>(), "variant of ReLU layer")
     ("relu-size", po::value<std::size_t>(), "size of ReLU layer")
+    ("yao-chunk-size", po::value<std::size_t>()->default_value(
+         MOTION::proto::yao::YaoProvider::default_tensor_chunk_size),
+     "values per message of garbled tables of the Yao ReLU, 0 sends all tables at once")
+    ("gemm-variant", po::value<std::size_t>(), "variant of Gemm layer")
+    ("gemm-dims", po::value<std::vector<std::size_t>>()->multitoken(),
+     "dimensions l m n of the product of an l x m input with m x n weights")
+    ("weights-density", po::value<double>()->default_value(0.2),
+     "fraction of nonzero weights of the Gemm layer")
     ("repetitions", po::value<std::size_t>()->default_value(1), "number of repetitions")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
@@ -127,7 +143,29 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     }
     options.relu_variant = vm["relu-variant"].as<std::size_t>();
     options.relu_size = vm["relu-size"].as<std::size_t>();
-    options.experiment_name = fmt::format("relu-{}-{}", options.relu_variant, options.relu_size);
+    options.yao_chunk_size = vm["yao-chunk-size"].as<std::size_t>();
+    options.experiment_name = fmt::format("relu-{}-{}-{}", options.relu_variant,
+                                          options.relu_size, options.yao_chunk_size);
+  } else if (options.benchmark == "gemm") {
+    if (vm.count("gemm-variant") == 0 || vm.count("gemm-dims") == 0) {
+      std::cerr << "Gemm benchmark needs arguments --gemm-variant and --gemm-dims\n";
+      return std::nullopt;
+    }
+    options.gemm_variant = vm["gemm-variant"].as<std::size_t>();
+    const auto gemm_dims = vm["gemm-dims"].as<std::vector<std::size_t>>();
+    if (gemm_dims.size() != 3) {
+      std::cerr << "--gemm-dims expects three dimensions\n";
+      return std::nullopt;
+    }
+    std::copy_n(std::begin(gemm_dims), 3, std::begin(options.gemm_dims));
+    options.weights_density = vm["weights-density"].as<double>();
+    if (options.weights_density < 0.0 || options.weights_density > 1.0) {
+      std::cerr << "--weights-density must be in [0, 1]\n";
+      return std::nullopt;
+    }
+    options.experiment_name =
+        fmt::format("gemm-{}-{}x{}x{}-{}", options.gemm_variant, gemm_dims[0], gemm_dims[1],
+                    gemm_dims[2], options.weights_density);
   } else {
     std::cerr << "unknown benchmark: " << options.benchmark << "\n";
     return std::nullopt;
@@ -201,8 +239,10 @@ auto make_input_share(MOTION::MPCProtocol protocol, MOTION::tensor::TensorDimens
 void prepare_relu(const Options& options, MOTION::TwoPartyTensorBackend& backend) {
   MOTION::tensor::TensorDimensions dims{
       .batch_size_ = 1, .num_channels_ = 1, .height_ = 1, .width_ = options.relu_size};
-  auto arithmetic_protocol = (options.relu_variant % 2 == 0) ? MOTION::MPCProtocol::ArithmeticGMW
-                                                             : MOTION::MPCProtocol::ArithmeticBEAVY;
+  // the fused variant 6 is only implemented for BEAVY
+  auto arithmetic_protocol = (options.relu_variant % 2 == 0 && options.relu_variant != 6)
+                                 ? MOTION::MPCProtocol::ArithmeticGMW
+                                 : MOTION::MPCProtocol::ArithmeticBEAVY;
   auto boolean_protocol = [&options] {
     if (options.relu_variant < 2) {
       return MOTION::MPCProtocol::Yao;
@@ -210,6 +250,8 @@ void prepare_relu(const Options& options, MOTION::TwoPartyTensorBackend& backend
       return MOTION::MPCProtocol::BooleanGMW;
     } else if (options.relu_variant == 3 || options.relu_variant == 5) {
       return MOTION::MPCProtocol::BooleanBEAVY;
+    } else if (options.relu_variant == 6) {
+      return MOTION::MPCProtocol::Yao;
     } else {
       throw std::invalid_argument("unexpected variant");
     }
@@ -243,6 +285,81 @@ void prepare_relu(const Options& options, MOTION::TwoPartyTensorBackend& backend
                                .make_tensor_relu_op(input_boolean_tensor, input_tensor);
       break;
     }
+    case 6: {
+      // conversions to and from Yao fused into the ReLU op
+      auto& yao_provider = dynamic_cast<MOTION::proto::yao::YaoProvider&>(
+          backend.get_tensor_op_factory(boolean_protocol));
+      auto output_tensor = yao_provider.make_arithmetic_beavy_tensor_relu_op(input_tensor);
+      break;
+    }
+    default:
+      throw std::invalid_argument("unexpected variant");
+  }
+}
+
+// weights of which a fraction of options.weights_density is nonzero, the sparsity pattern is the
+// same for both parties
+std::vector<std::uint64_t> make_sparse_weights(const Options& options) {
+  std::mt19937_64 pattern_rng(42);
+  std::bernoulli_distribution is_nonzero(options.weights_density);
+  auto weights =
+      MOTION::Helpers::RandomVector<std::uint64_t>(options.gemm_dims[1] * options.gemm_dims[2]);
+  for (auto& w : weights) {
+    if (!is_nonzero(pattern_rng)) {
+      w = 0;
+    } else if (w == 0) {
+      // keep the pattern
+      w = 1;
+    }
+  }
+  return weights;
+}
+
+// Variants 0 and 1 compute the product with dense shared weights in GMW or BEAVY, variants 2 and 3
+// the product with the sparse weights of party 1 in GMW or BEAVY.
+void prepare_gemm(const Options& options, MOTION::TwoPartyTensorBackend& backend) {
+  const auto [dim_l, dim_m, dim_n] = options.gemm_dims;
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {dim_l, dim_m},
+      .input_B_shape_ = {dim_m, dim_n},
+      .output_shape_ = {dim_l, dim_n}};
+  auto arithmetic_protocol = (options.gemm_variant % 2 == 0) ? MOTION::MPCProtocol::ArithmeticGMW
+                                                             : MOTION::MPCProtocol::ArithmeticBEAVY;
+  const auto make_share = [&options, arithmetic_protocol](auto dims) {
+    switch (options.bit_size) {
+      case 64:
+        return make_input_share<std::uint64_t>(arithmetic_protocol, dims);
+      case 32:
+        return make_input_share<std::uint32_t>(arithmetic_protocol, dims);
+      default:
+        throw std::invalid_argument("unexpected bit size");
+    }
+  };
+  auto input_tensor = make_share(gemm_op.get_input_A_tensor_dims());
+  auto& factory = backend.get_tensor_op_factory(arithmetic_protocol);
+
+  switch (options.gemm_variant) {
+    case 0:
+    case 1: {
+      auto weights_tensor = make_share(gemm_op.get_input_B_tensor_dims());
+      auto output_tensor = factory.make_tensor_gemm_op(gemm_op, input_tensor, weights_tensor,
+                                                       options.fractional_bits);
+      break;
+    }
+    case 2:
+    case 3: {
+      const auto dense_weights = make_sparse_weights(options);
+      auto weights =
+          MOTION::CSRMatrix<std::uint64_t>::from_dense(dim_m, dim_n, dense_weights.data());
+      // party 0 only knows the sparsity pattern
+      if (options.my_id != 1) {
+        weights.values_.clear();
+      }
+      auto output_tensor =
+          factory.make_tensor_sparse_gemm_op(gemm_op, input_tensor, weights, 1,
+                                             options.fractional_bits, options.fractional_bits);
+      break;
+    }
     default:
       throw std::invalid_argument("unexpected variant");
   }
@@ -250,12 +367,24 @@ void prepare_relu(const Options& options, MOTION::TwoPartyTensorBackend& backend
 
 void run_benchmark(const Options& options, MOTION::TwoPartyTensorBackend& backend) {
   if (options.benchmark == "relu") {
+    backend.set_yao_tensor_chunk_size(options.yao_chunk_size);
     prepare_relu(options, backend);
+  } else if (options.benchmark == "gemm") {
+    prepare_gemm(options, backend);
   }
 
   backend.run();
 }
 
+// ReLU values per second in the median setup and online phases of the gates
+double compute_relu_throughput(const Options& options,
+                               const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats) {
+  using StatID = MOTION::Statistics::RunTimeStats::StatID;
+  const auto time_ms = run_time_stats.get_percentile(StatID::gates_setup, 50) +
+                       run_time_stats.get_percentile(StatID::gates_online, 50);
+  return (time_ms > 0) ? options.relu_size / (time_ms / 1000) : 0;
+}
+
 void print_stats(const Options& options,
                  const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats,
                  const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats) {
@@ -269,11 +398,22 @@ void print_stats(const Options& options,
     if (options.benchmark == "relu") {
       obj.emplace("relu-variant", options.relu_variant);
       obj.emplace("relu-size", options.relu_size);
+      obj.emplace("yao-chunk-size", options.yao_chunk_size);
+      obj.emplace("relu-values-per-second", compute_relu_throughput(options, run_time_stats));
+    } else if (options.benchmark == "gemm") {
+      obj.emplace("gemm-variant", options.gemm_variant);
+      obj.emplace("gemm-dims", fmt::format("{}x{}x{}", options.gemm_dims[0],
+                                           options.gemm_dims[1], options.gemm_dims[2]));
+      obj.emplace("weights-density", options.weights_density);
     }
     std::cout << obj << "\n";
   } else {
     std::cout << MOTION::Statistics::print_stats(options.experiment_name, run_time_stats,
                                                  comm_stats);
+    if (options.benchmark == "relu") {
+      std::cout << fmt::format("ReLU throughput: {:.0f} values/s\n",
+                               compute_relu_throughput(options, run_time_stats));
+    }
   }
 }
 
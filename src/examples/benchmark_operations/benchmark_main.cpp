@@ -35,6 +35,7 @@
 #include "base/party.h"
 #include "common/benchmark.h"
 #include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
 #include "utility/typedefs.h"
@@ -45,7 +46,8 @@ bool CheckPartyArgumentSyntax(const std::string& p);
 
 std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]);
 
-MOTION::PartyPtr CreateParty(const po::variables_map& vm);
+MOTION::PartyPtr CreateParty(const po::variables_map& vm,
+                             const MOTION::Communication::NetworkProfile& network_profile);
 
 constexpr std::size_t ILLEGAL_PROTOCOL{100}, ILLEGAL_OPERATION_TYPE{100};
 
@@ -110,23 +112,27 @@ int main(int ac, char* av[]) {
 
   combinations = GenerateAllCombinations();
 
-  for (const auto comb : combinations) {
-    MOTION::Statistics::AccumulatedRunTimeStats accumulated_stats;
-    MOTION::Statistics::AccumulatedCommunicationStats accumulated_comm_stats;
-    for (std::size_t i = 0; i < num_repetitions; ++i) {
-      MOTION::PartyPtr party{CreateParty(vm)};
-      // establish communication channels with other parties
-      auto stats =
-          EvaluateProtocol(party, comb.num_simd_, comb.bit_size_, comb.protocol_, comb.op_type_);
-      accumulated_stats.add(stats);
-      auto comm_stats = party->get_communication_layer().get_transport_statistics();
-      accumulated_comm_stats.add(comm_stats);
+  for (const auto& profile_str : vm["network-profile"].as<std::vector<std::string>>()) {
+    const auto network_profile = MOTION::Communication::parse_network_profile(profile_str);
+    for (const auto comb : combinations) {
+      MOTION::Statistics::AccumulatedRunTimeStats accumulated_stats;
+      MOTION::Statistics::AccumulatedCommunicationStats accumulated_comm_stats;
+      for (std::size_t i = 0; i < num_repetitions; ++i) {
+        MOTION::PartyPtr party{CreateParty(vm, network_profile)};
+        // establish communication channels with other parties
+        auto stats = EvaluateProtocol(party, comb.num_simd_, comb.bit_size_, comb.protocol_,
+                                      comb.op_type_);
+        accumulated_stats.add(stats);
+        auto comm_stats = party->get_communication_layer().get_transport_statistics();
+        accumulated_comm_stats.add(comm_stats);
+      }
+      std::cout << MOTION::Statistics::print_stats(
+          fmt::format("Protocol {} operation {} bit size {} SIMD {} network {}",
+                      MOTION::ToString(comb.protocol_), ENCRYPTO::ToString(comb.op_type_),
+                      comb.bit_size_, comb.num_simd_,
+                      MOTION::Communication::to_string(network_profile)),
+          accumulated_stats, accumulated_comm_stats);
     }
-    std::cout << MOTION::Statistics::print_stats(
-        fmt::format("Protocol {} operation {} bit size {} SIMD {}",
-                    MOTION::ToString(comb.protocol_), ENCRYPTO::ToString(comb.op_type_),
-                    comb.bit_size_, comb.num_simd_),
-        accumulated_stats, accumulated_comm_stats);
   }
   return EXIT_SUCCESS;
 }
@@ -163,6 +169,7 @@ std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]) {
       ("my-id", po::value<std::size_t>(), "my party id")
       ("other-parties", po::value<std::vector<std::string>>()->multitoken(), "(other party id, IP, port, my role), e.g., --other-parties 1,127.0.0.1,7777")
       ("online-after-setup", po::value<bool>()->default_value(true), "compute the online phase of the gate evaluations after the setup phase for all of them is completed (true/1 or false/0)")
+      ("network-profile", po::value<std::vector<std::string>>()->multitoken()->default_value({"none"}, "none"), "emulate the network in process: none, lan, wan or <RTT ms>,<bandwidth Mbit/s>[,<jitter ms>], multiple values are benchmarked one after another")
       ("repetitions", po::value<std::size_t>()->default_value(1), "number of repetitions");
   // clang-format on
 
@@ -215,7 +222,8 @@ std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]) {
   return std::make_pair(vm, help);
 }
 
-MOTION::PartyPtr CreateParty(const po::variables_map& vm) {
+MOTION::PartyPtr CreateParty(const po::variables_map& vm,
+                             const MOTION::Communication::NetworkProfile& network_profile) {
   const auto parties_str{vm["other-parties"].as<const std::vector<std::string>>()};
   const auto num_parties{parties_str.size()};
   const auto my_id{vm["my-id"].as<std::size_t>()};
@@ -238,7 +246,14 @@ MOTION::PartyPtr CreateParty(const po::variables_map& vm) {
     parties_config.at(party_id) = std::make_pair(host, port);
   }
   MOTION::Communication::TCPSetupHelper helper(my_id, parties_config);
-  auto comm_layer = std::make_unique<MOTION::Communication::CommunicationLayer>(my_id, helper.setup_connections());
+  auto transports = helper.setup_connections();
+  if (!network_profile.is_none()) {
+    transports = MOTION::Communication::make_emulated_transports(
+        std::move(transports),
+        std::make_shared<MOTION::Communication::NetworkEmulation>(network_profile));
+  }
+  auto comm_layer =
+      std::make_unique<MOTION::Communication::CommunicationLayer>(my_id, std::move(transports));
   auto party = std::make_unique<MOTION::Party>(std::move(comm_layer));
   auto config = party->GetConfiguration();
   // disable logging if the corresponding flag was set
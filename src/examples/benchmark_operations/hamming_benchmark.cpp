@@ -0,0 +1,271 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares the two ways of computing Hamming distances in BEAVY: the Boolean
+// HAM gate (which converts every bit to an arithmetic share) against the
+// arithmetic AHAM gate that sums ring elements directly.  With --reuse-backend all
+// repetitions run on one TwoPartyBackend which is reset in between, so only the first
+// repetition pays for the base OTs and the creation of the fiber pools.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <stdexcept>
+
+#include <boost/json/serialize.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "communication/tcp_transport.h"
+#include "protocols/beavy/beavy_provider.h"
+#include "protocols/beavy/wire.h"
+#include "statistics/analysis.h"
+#include "utility/bit_vector.h"
+#include "utility/helpers.h"
+#include "utility/logger.h"
+
+namespace po = boost::program_options;
+using namespace MOTION::proto::beavy;
+using WireVector = std::vector<std::shared_ptr<MOTION::NewWire>>;
+
+struct Options {
+  std::size_t threads;
+  bool json;
+  std::size_t num_repetitions;
+  std::size_t num_windows;
+  std::size_t pattern_size;
+  bool arithmetic;
+  bool reuse_backend;
+  bool sync_between_setup_and_online;
+  std::size_t my_id;
+  MOTION::Communication::tcp_parties_config tcp_config;
+};
+
+std::optional<Options> parse_program_options(int argc, char* argv[]) {
+  Options options;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+    ("help,h", po::bool_switch()->default_value(false),"produce help message")
+    ("my-id", po::value<std::size_t>()->required(), "my party id")
+    ("party", po::value<std::vector<std::string>>()->multitoken(),
+     "(party id, IP, port), e.g., --party 1,127.0.0.1,7777")
+    ("threads", po::value<std::size_t>()->default_value(0), "number of threads to use for gate evaluation")
+    ("json", po::bool_switch()->default_value(false), "output data in JSON format")
+    ("num-windows", po::value<std::size_t>()->default_value(1024), "number of Hamming distances computed in parallel")
+    ("pattern-size", po::value<std::size_t>()->default_value(64), "number of positions per Hamming distance")
+    ("arithmetic", po::bool_switch()->default_value(false),
+     "use the arithmetic AHAM gate instead of Boolean HAM")
+    ("reuse-backend", po::bool_switch()->default_value(false),
+     "reset and reuse the backend between repetitions instead of creating a new one")
+    ("repetitions", po::value<std::size_t>()->default_value(1), "number of repetitions")
+    ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
+     "run a synchronization protocol before the online phase starts")
+    ;
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  if (vm["help"].as<bool>()) {
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "error:" << e.what() << "\n\n";
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+
+  options.my_id = vm["my-id"].as<std::size_t>();
+  options.threads = vm["threads"].as<std::size_t>();
+  options.json = vm["json"].as<bool>();
+  options.num_repetitions = vm["repetitions"].as<std::size_t>();
+  options.num_windows = vm["num-windows"].as<std::size_t>();
+  options.pattern_size = vm["pattern-size"].as<std::size_t>();
+  options.arithmetic = vm["arithmetic"].as<bool>();
+  options.reuse_backend = vm["reuse-backend"].as<bool>();
+  options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
+  if (options.num_windows == 0 || options.pattern_size == 0) {
+    std::cerr << "--num-windows and --pattern-size must be positive\n";
+    return std::nullopt;
+  }
+
+  const auto parse_party_argument =
+      [](const auto& s) -> std::pair<std::size_t, MOTION::Communication::tcp_connection_config> {
+    const static std::regex party_argument_re("([01]),([^,]+),(\\d{1,5})");
+    std::smatch match;
+    if (!std::regex_match(s, match, party_argument_re)) {
+      throw std::invalid_argument("invalid party argument");
+    }
+    auto id = boost::lexical_cast<std::size_t>(match[1]);
+    auto host = match[2];
+    auto port = boost::lexical_cast<std::uint16_t>(match[3]);
+    return {id, {host, port}};
+  };
+
+  if (!vm.count("party")) {
+    std::cerr << "expecting two --party options\n";
+    return std::nullopt;
+  }
+  const std::vector<std::string> party_infos = vm["party"].as<std::vector<std::string>>();
+  if (party_infos.size() != 2) {
+    std::cerr << "expecting two --party options\n";
+    return std::nullopt;
+  }
+
+  options.tcp_config.resize(2);
+  const auto [id0, conn_info0] = parse_party_argument(party_infos[0]);
+  const auto [id1, conn_info1] = parse_party_argument(party_infos[1]);
+  if (id0 == id1) {
+    std::cerr << "need party arguments for party 0 and 1\n";
+    return std::nullopt;
+  }
+  options.tcp_config[id0] = conn_info0;
+  options.tcp_config[id1] = conn_info1;
+
+  return options;
+}
+
+std::unique_ptr<MOTION::Communication::CommunicationLayer> setup_communication(
+    const Options& options) {
+  MOTION::Communication::TCPSetupHelper helper(options.my_id, options.tcp_config);
+  return std::make_unique<MOTION::Communication::CommunicationLayer>(options.my_id,
+                                                                     helper.setup_connections());
+}
+
+// pattern_size Boolean wires with one SIMD lane per window
+WireVector make_boolean_inputs(const Options& options) {
+  WireVector wires;
+  for (std::size_t i = 0; i < options.pattern_size; ++i) {
+    auto wire = std::make_shared<BooleanBEAVYWire>(options.num_windows);
+    wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(options.num_windows);
+    wire->get_public_share() = ENCRYPTO::BitVector<>::Random(options.num_windows);
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    wires.push_back(std::move(wire));
+  }
+  return wires;
+}
+
+// one arithmetic wire holding the pattern_size positions of each window consecutively
+WireVector make_arithmetic_inputs(const Options& options) {
+  const auto num_simd = options.num_windows * options.pattern_size;
+  auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(num_simd);
+  wire->get_secret_share() = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  wire->get_public_share() = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return {wire};
+}
+
+void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend) {
+  if (options.arithmetic) {
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(
+        backend.get_gate_factory(MOTION::MPCProtocol::ArithmeticBEAVY));
+    auto output = beavy_provider.make_arithmetic_hamming_gate(make_arithmetic_inputs(options),
+                                                              options.pattern_size);
+  } else {
+    auto& gate_factory = backend.get_gate_factory(MOTION::MPCProtocol::BooleanBEAVY);
+    auto output = gate_factory.make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM,
+                                               make_boolean_inputs(options));
+  }
+  backend.run();
+}
+
+void print_stats(const Options& options,
+                 const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats,
+                 const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats,
+                 double mean_query_ms) {
+  if (options.json) {
+    auto obj = MOTION::Statistics::to_json("hamming_benchmark", run_time_stats, comm_stats);
+    obj.emplace("party_id", options.my_id);
+    obj.emplace("gate", options.arithmetic ? "AHAM" : "HAM");
+    obj.emplace("num_windows", options.num_windows);
+    obj.emplace("pattern_size", options.pattern_size);
+    obj.emplace("threads", options.threads);
+    obj.emplace("sync_between_setup_and_online", options.sync_between_setup_and_online);
+    obj.emplace("reuse_backend", options.reuse_backend);
+    obj.emplace("mean_query_ms", mean_query_ms);
+    std::cout << obj << "\n";
+  } else {
+    std::cout << MOTION::Statistics::print_stats(
+        options.arithmetic ? "Hamming distance (AHAM)" : "Hamming distance (HAM)", run_time_stats,
+        comm_stats);
+    std::cout << "Mean time per repetition (incl. backend "
+              << (options.reuse_backend ? "reset" : "creation") << "): " << mean_query_ms
+              << " ms\n";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  auto options = parse_program_options(argc, argv);
+  if (!options.has_value()) {
+    return EXIT_FAILURE;
+  }
+
+  try {
+    auto comm_layer = setup_communication(*options);
+    auto logger = std::make_shared<MOTION::Logger>(options->my_id,
+                                                   boost::log::trivial::severity_level::trace);
+    comm_layer->set_logger(logger);
+    MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+    MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
+    std::unique_ptr<MOTION::TwoPartyBackend> backend;
+    double total_query_ms = 0;
+    for (std::size_t i = 0; i < options->num_repetitions; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      if (backend && options->reuse_backend) {
+        backend->reset();
+      } else {
+        backend.reset();
+        backend = std::make_unique<MOTION::TwoPartyBackend>(
+            *comm_layer, options->threads, options->sync_between_setup_and_online, logger);
+      }
+      run_circuit(*options, *backend);
+      comm_layer->sync();
+      total_query_ms += std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      comm_stats.add(comm_layer->get_transport_statistics());
+      comm_layer->reset_transport_statistics();
+      run_time_stats.add(backend->get_run_time_stats());
+    }
+    backend.reset();
+    comm_layer->shutdown();
+    print_stats(*options, run_time_stats, comm_stats,
+                total_query_ms / std::max(std::size_t{1}, options->num_repetitions));
+  } catch (std::runtime_error& e) {
+    std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
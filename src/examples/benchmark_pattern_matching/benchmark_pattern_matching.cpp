@@ -0,0 +1,388 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmarks of the BEAVY gates used for pattern matching (HAM, EQEXP, MULNI, MSG, AND4, DOT,
+// COUNT) and of the exact and wildcard pattern matching circuits built from them.  Both parties
+// run in this process and are connected by dummy transports or by local TCP connections.  Each
+// benchmark takes the arguments (text size, pattern size, ring size, threads, transport), where
+// the gates compute text_size - pattern_size + 1 windows in parallel on pattern_size * ring_size
+// Boolean wires.  The reported time is the wall-clock time of running the circuit including the
+// preprocessing; use --benchmark_format=json or --benchmark_out=<file> for regression tracking.
+//
+// BM_edit_distance compares the banded edit distance engine with a baseline computing the same
+// banded DP on 8 bit distances with the Bristol adder and comparison circuits.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <map>
+#include <vector>
+
+#include <boost/log/trivial.hpp>
+
+#include "algorithm/circuit_loader.h"
+#include "algorithm/edit_distance.h"
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "communication/transport.h"
+#include "protocols/beavy/beavy_provider.h"
+#include "protocols/beavy/wire.h"
+#include "protocols/plain/constant_folding.h"
+#include "statistics/run_time_stats.h"
+#include "utility/bit_vector.h"
+#include "utility/helpers.h"
+#include "utility/logger.h"
+#include "utility/typedefs.h"
+
+namespace {
+
+using namespace MOTION::proto::beavy;
+
+enum TransportType : std::int64_t { dummy = 0, tcp = 1 };
+
+struct Parameters {
+  std::size_t text_size_;
+  std::size_t pattern_size_;
+  std::size_t ring_size_;
+
+  std::size_t get_num_simd() const { return text_size_ - pattern_size_ + 1; }
+  std::size_t get_num_wires() const { return pattern_size_ * ring_size_; }
+};
+
+// builds the circuit of one party on its backend
+using CircuitFunction = std::function<void(MOTION::TwoPartyBackend&, const Parameters&)>;
+
+MOTION::WireVector make_boolean_wires(std::size_t num_wires, std::size_t num_simd) {
+  MOTION::WireVector wires;
+  for (std::size_t i = 0; i < num_wires; ++i) {
+    auto wire = std::make_shared<BooleanBEAVYWire>(num_simd);
+    wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_simd);
+    wire->get_public_share() = ENCRYPTO::BitVector<>::Random(num_simd);
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    wires.push_back(std::move(wire));
+  }
+  return wires;
+}
+
+// BooleanBEAVY wires holding the bits of a public value in every SIMD lane
+MOTION::WireVector make_boolean_constant_wires(std::uint64_t value, std::size_t num_wires,
+                                               std::size_t num_simd) {
+  MOTION::WireVector wires;
+  for (std::size_t i = 0; i < num_wires; ++i) {
+    auto wire = std::make_shared<BooleanBEAVYWire>(num_simd);
+    wire->get_secret_share() = ENCRYPTO::BitVector<>(num_simd);
+    wire->get_public_share() = ENCRYPTO::BitVector<>(num_simd, (value >> i) & 1);
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    wires.push_back(std::move(wire));
+  }
+  return wires;
+}
+
+MOTION::WireVector make_arithmetic_wire(std::size_t num_simd) {
+  auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(num_simd);
+  wire->get_secret_share() = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  wire->get_public_share() = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return {wire};
+}
+
+// second input of the EQEXP gate, a constant holding the bound of the compared values in every
+// SIMD lane as in the exact_pm example
+MOTION::WireVector make_eqexp_wire(const Parameters& parameters) {
+  return MOTION::proto::plain::make_arithmetic_constant_wire(
+      std::vector<std::uint64_t>(parameters.get_num_simd(), 2 * parameters.get_num_wires()));
+}
+
+std::vector<std::unique_ptr<MOTION::Communication::CommunicationLayer>> make_comm_layers(
+    std::int64_t transport) {
+  if (transport == TransportType::tcp) {
+    return MOTION::Communication::make_local_tcp_communication_layers(2, false);
+  }
+  // the dummy transports hand the messages over, without verifying them again
+  return MOTION::Communication::make_dummy_communication_layers(2, false);
+}
+
+// Runs the circuit with both parties on fresh backends in every iteration, such that each
+// iteration pays for the base OTs as a standalone run of the examples does.
+void run_two_party_benchmark(benchmark::State& state, const CircuitFunction& make_circuit) {
+  const Parameters parameters{.text_size_ = static_cast<std::size_t>(state.range(0)),
+                              .pattern_size_ = static_cast<std::size_t>(state.range(1)),
+                              .ring_size_ = static_cast<std::size_t>(state.range(2))};
+  const auto num_threads = static_cast<std::size_t>(state.range(3));
+  if (parameters.pattern_size_ > parameters.text_size_) {
+    state.SkipWithError("pattern size larger than text size");
+    return;
+  }
+
+  auto comm_layers = make_comm_layers(state.range(4));
+  std::array<std::shared_ptr<MOTION::Logger>, 2> loggers;
+  for (std::size_t i = 0; i < 2; ++i) {
+    loggers[i] = std::make_shared<MOTION::Logger>(i, boost::log::trivial::severity_level::error);
+    comm_layers[i]->set_logger(loggers[i]);
+  }
+
+  std::size_t bytes_sent = 0;
+  std::size_t messages_sent = 0;
+  double setup_ms = 0;
+  double online_ms = 0;
+  for (auto _ : state) {
+    std::array<double, 2> run_ms;
+    std::array<MOTION::Statistics::RunTimeStats, 2> run_time_stats;
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [&, i] {
+        MOTION::TwoPartyBackend backend(*comm_layers[i], num_threads, false, loggers[i]);
+        make_circuit(backend, parameters);
+        const auto start = std::chrono::steady_clock::now();
+        backend.run();
+        comm_layers[i]->sync();
+        run_ms[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                              start)
+                        .count();
+        run_time_stats[i] = backend.get_run_time_stats();
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+    state.SetIterationTime(std::max(run_ms[0], run_ms[1]) / 1000);
+
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (const auto& stats : comm_layers[i]->get_transport_statistics()) {
+        bytes_sent += stats.num_bytes_sent;
+        messages_sent += stats.num_messages_sent;
+      }
+      comm_layers[i]->reset_transport_statistics();
+    }
+    using StatID = MOTION::Statistics::RunTimeStats::StatID;
+    const auto duration_ms = [&stats = run_time_stats[0]](StatID id) {
+      const auto& [start, end] = stats.get(id);
+      return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+    setup_ms += duration_ms(StatID::gates_setup);
+    online_ms += duration_ms(StatID::gates_online);
+  }
+
+  std::vector<std::future<void>> futs;
+  for (std::size_t i = 0; i < 2; ++i) {
+    futs.emplace_back(std::async(std::launch::async, [&, i] { comm_layers[i]->shutdown(); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  // communication of both parties and the phases of party 0 per iteration
+  state.counters["bytes_sent"] =
+      benchmark::Counter(bytes_sent, benchmark::Counter::kAvgIterations);
+  state.counters["messages_sent"] =
+      benchmark::Counter(messages_sent, benchmark::Counter::kAvgIterations);
+  state.counters["setup_ms"] = benchmark::Counter(setup_ms, benchmark::Counter::kAvgIterations);
+  state.counters["online_ms"] = benchmark::Counter(online_ms, benchmark::Counter::kAvgIterations);
+  state.counters["windows"] = parameters.get_num_simd();
+}
+
+MOTION::GateFactory& get_boolean_factory(MOTION::TwoPartyBackend& backend) {
+  return backend.get_gate_factory(MOTION::MPCProtocol::BooleanBEAVY);
+}
+
+MOTION::GateFactory& get_arithmetic_factory(MOTION::TwoPartyBackend& backend) {
+  return backend.get_gate_factory(MOTION::MPCProtocol::ArithmeticBEAVY);
+}
+
+void BM_ham(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    get_boolean_factory(backend).make_unary_gate(
+        ENCRYPTO::PrimitiveOperationType::HAM,
+        make_boolean_wires(parameters.get_num_wires(), parameters.get_num_simd()));
+  });
+}
+
+void BM_count(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    get_boolean_factory(backend).make_unary_gate(
+        ENCRYPTO::PrimitiveOperationType::COUNT,
+        make_boolean_wires(parameters.get_num_wires(), parameters.get_num_simd()));
+  });
+}
+
+void BM_eqexp(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    auto values = make_arithmetic_wire(parameters.get_num_simd());
+    get_arithmetic_factory(backend).make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP,
+                                                     values, make_eqexp_wire(parameters));
+  });
+}
+
+void BM_mulni(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    const auto num_simd = parameters.get_num_simd();
+    get_arithmetic_factory(backend).make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI,
+                                                     make_arithmetic_wire(num_simd),
+                                                     make_arithmetic_wire(num_simd));
+  });
+}
+
+// binary Boolean gates on two inputs of pattern_size * ring_size wires
+template <ENCRYPTO::PrimitiveOperationType op>
+void BM_boolean_binary(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    const auto num_wires = parameters.get_num_wires();
+    const auto num_simd = parameters.get_num_simd();
+    get_boolean_factory(backend).make_binary_gate(op, make_boolean_wires(num_wires, num_simd),
+                                                  make_boolean_wires(num_wires, num_simd));
+  });
+}
+
+// HAM followed by EQEXP as in the exact_pm example
+void BM_exact_pm(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    auto distances = get_boolean_factory(backend).make_unary_gate(
+        ENCRYPTO::PrimitiveOperationType::HAM,
+        make_boolean_wires(parameters.get_num_wires(), parameters.get_num_simd()));
+    get_arithmetic_factory(backend).make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP,
+                                                     distances, make_eqexp_wire(parameters));
+  });
+}
+
+// HAM followed by MULNI and EQEXP as in the wildcard_pm example
+void BM_wildcard_pm(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    auto& arithmetic_factory = get_arithmetic_factory(backend);
+    auto distances = get_boolean_factory(backend).make_unary_gate(
+        ENCRYPTO::PrimitiveOperationType::HAM,
+        make_boolean_wires(parameters.get_num_wires(), parameters.get_num_simd()));
+    arithmetic_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, distances,
+                                        distances);
+    arithmetic_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP, distances,
+                                        make_eqexp_wire(parameters));
+  });
+}
+
+// banded edit distance of the pattern to each window followed by the threshold test
+template <std::size_t band>
+void BM_edit_distance(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(get_boolean_factory(backend));
+    const auto num_wires = parameters.get_num_wires();
+    const auto num_simd = parameters.get_num_simd();
+    auto distances = MOTION::make_banded_edit_distance_circuit(
+        beavy_provider, make_boolean_wires(num_wires, num_simd),
+        make_boolean_wires(num_wires, num_simd), parameters.ring_size_, band);
+    beavy_provider.make_threshold_gate(distances, parameters.pattern_size_ + 1, band);
+  });
+}
+
+// The same banded DP on 8 bit distances in BooleanBEAVY with the Bristol circuits, i.e.,
+// D[i][j] = min(min(D[i - 1][j], D[i][j - 1]) + 1, D[i - 1][j - 1] + c) where min(a, b) =
+// ~max(~a, ~b).  The mismatch bits c are random inputs, which favours the baseline.
+template <std::size_t band>
+void BM_edit_distance_bristol(benchmark::State& state) {
+  run_two_party_benchmark(state, [](auto& backend, const auto& parameters) {
+    constexpr std::size_t bit_size = 8;
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(get_boolean_factory(backend));
+    auto& circuit_loader = beavy_provider.get_circuit_loader();
+    const auto& max_algo = circuit_loader.load_gtmux_circuit(bit_size);
+    const auto& add_algo =
+        circuit_loader.load_circuit("int_add8_size.bristol", MOTION::CircuitFormat::Bristol);
+    const auto num_simd = parameters.get_num_simd();
+    const auto m = parameters.pattern_size_;
+    const auto inv = [&](const MOTION::WireVector& wires) {
+      return beavy_provider.make_unary_gate(ENCRYPTO::PrimitiveOperationType::INV, wires);
+    };
+    const auto min = [&](const MOTION::WireVector& a, const MOTION::WireVector& b) {
+      return inv(backend.make_circuit(max_algo, inv(a), inv(b)));
+    };
+    const auto one = make_boolean_constant_wires(1, bit_size, num_simd);
+    const auto zeros = make_boolean_constant_wires(0, bit_size - 1, num_simd);
+
+    std::map<std::pair<std::size_t, std::size_t>, MOTION::WireVector> dp;
+    for (std::size_t i = 0; i <= std::min(m, band); ++i) {
+      dp[{i, 0}] = dp[{0, i}] = make_boolean_constant_wires(i, bit_size, num_simd);
+    }
+    for (std::size_t d = 2; d <= 2 * m; ++d) {
+      for (std::size_t i = d > m ? d - m : 1; i <= std::min(m, d - 1); ++i) {
+        const auto j = d - i;
+        if ((i > j ? i - j : j - i) > band) {
+          continue;
+        }
+        const auto upper = dp.find({i - 1, j});
+        const auto left = dp.find({i, j - 1});
+        auto mismatch = make_boolean_wires(1, num_simd);
+        mismatch.insert(std::end(mismatch), std::begin(zeros), std::end(zeros));
+        auto diagonal = backend.make_circuit(add_algo, dp.at({i - 1, j - 1}), mismatch);
+        // only neighbours in the band are compared
+        if (upper == std::end(dp) && left == std::end(dp)) {
+          dp[{i, j}] = std::move(diagonal);
+          continue;
+        }
+        MOTION::WireVector neighbour;
+        if (upper == std::end(dp)) {
+          neighbour = left->second;
+        } else if (left == std::end(dp)) {
+          neighbour = upper->second;
+        } else {
+          neighbour = min(upper->second, left->second);
+        }
+        dp[{i, j}] = min(backend.make_circuit(add_algo, neighbour, one), diagonal);
+      }
+    }
+  });
+}
+
+void edit_distance_sweep(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"text", "pattern", "ring", "threads", "transport"})
+      ->ArgsProduct({{256, 1024}, {8, 16}, {2}, {1}, {TransportType::dummy}})
+      ->UseManualTime()
+      ->Unit(benchmark::kMillisecond);
+}
+
+const std::vector<std::int64_t> thread_counts = {1, 4};
+const std::vector<std::int64_t> transports = {TransportType::dummy, TransportType::tcp};
+
+void sweep(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"text", "pattern", "ring", "threads", "transport"})
+      ->ArgsProduct({{256, 4096}, {16, 64}, {2, 8}, thread_counts, transports})
+      ->UseManualTime()
+      ->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ham)->Apply(sweep);
+BENCHMARK(BM_count)->Apply(sweep);
+BENCHMARK(BM_eqexp)->Apply(sweep);
+BENCHMARK(BM_mulni)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_boolean_binary, ENCRYPTO::PrimitiveOperationType::AND4)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_boolean_binary, ENCRYPTO::PrimitiveOperationType::DOT)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_boolean_binary, ENCRYPTO::PrimitiveOperationType::MSG)->Apply(sweep);
+BENCHMARK(BM_exact_pm)->Apply(sweep);
+BENCHMARK(BM_wildcard_pm)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_edit_distance, 1)->Apply(edit_distance_sweep);
+BENCHMARK_TEMPLATE(BM_edit_distance, 4)->Apply(edit_distance_sweep);
+BENCHMARK_TEMPLATE(BM_edit_distance_bristol, 1)->Apply(edit_distance_sweep);
+BENCHMARK_TEMPLATE(BM_edit_distance_bristol, 4)->Apply(edit_distance_sweep);
@@ -35,6 +35,7 @@
 #include "base/party.h"
 #include "common/benchmark_providers.h"
 #include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
 #include "utility/typedefs.h"
@@ -43,16 +44,30 @@ namespace po = boost::program_options;
 
 bool CheckPartyArgumentSyntax(const std::string& p);
 
-std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]);
+std::tuple<po::variables_map, bool, bool, bool> ParseProgramOptions(int ac, char* av[]);
 
-MOTION::PartyPtr CreateParty(const po::variables_map& vm);
+MOTION::PartyPtr CreateParty(const po::variables_map& vm, std::size_t num_streams,
+                             const MOTION::Communication::NetworkProfile& network_profile);
 
 int main(int ac, char* av[]) {
-  auto [vm, help_flag, ots_flag] = ParseProgramOptions(ac, av);
+  auto [vm, help_flag, ots_flag, transpose_flag] = ParseProgramOptions(ac, av);
   // if help flag is set - print allowed command line arguments and exit
   if (help_flag) EXIT_SUCCESS;
   const auto num_repetitions{vm["repetitions"].as<std::size_t>()};
   const auto batch_size{vm["batch-size"].as<std::size_t>()};
+  if (transpose_flag) {
+    BenchmarkTransposeKernels(batch_size, num_repetitions);
+    return EXIT_SUCCESS;
+  }
+  if (vm["int-mult-kernels"].as<bool>()) {
+    BenchmarkIntegerMultiplicationKernels(batch_size, num_repetitions);
+    return EXIT_SUCCESS;
+  }
+  const auto num_streams_list{vm["num-streams"].as<std::vector<std::size_t>>()};
+  std::vector<MOTION::Communication::NetworkProfile> network_profiles;
+  for (const auto& profile_str : vm["network-profile"].as<std::vector<std::string>>()) {
+    network_profiles.push_back(MOTION::Communication::parse_network_profile(profile_str));
+  }
 
   struct Combination {
     Combination(Provider p, std::size_t bit_size, std::size_t batch_size)
@@ -90,20 +105,35 @@ int main(int ac, char* av[]) {
   // clang-format on
 
   auto chosen_combs = ots_flag ? combs_ots : combs;
-  for (const auto comb : chosen_combs) {
-    MOTION::Statistics::AccumulatedRunTimeStats accumulated_stats;
-    MOTION::Statistics::AccumulatedCommunicationStats accumulated_comm_stats;
-    for (std::size_t i = 0; i < num_repetitions; ++i) {
-      MOTION::PartyPtr party{CreateParty(vm)};
-      auto stats = BenchmarkProvider(party, comb.batch_size_, comb.p_, comb.bit_size_);
-      accumulated_stats.add(stats);
-      auto comm_stats = party->get_communication_layer().get_transport_statistics();
-      accumulated_comm_stats.add(comm_stats);
+  for (const auto& network_profile : network_profiles) {
+    for (const auto num_streams : num_streams_list) {
+      for (const auto comb : chosen_combs) {
+        MOTION::Statistics::AccumulatedRunTimeStats accumulated_stats;
+        MOTION::Statistics::AccumulatedCommunicationStats accumulated_comm_stats;
+        for (std::size_t i = 0; i < num_repetitions; ++i) {
+          MOTION::PartyPtr party{CreateParty(vm, num_streams, network_profile)};
+          auto stats = BenchmarkProvider(party, comb.batch_size_, comb.p_, comb.bit_size_);
+          accumulated_stats.add(stats);
+          auto comm_stats = party->get_communication_layer().get_transport_statistics();
+          accumulated_comm_stats.add(comm_stats);
+        }
+        std::cout << MOTION::Statistics::print_stats(
+            fmt::format("Provider {} bit size {} batch size {} streams {} network {}",
+                        ToString(comb.p_), comb.bit_size_, comb.batch_size_, num_streams,
+                        MOTION::Communication::to_string(network_profile)),
+            accumulated_stats, accumulated_comm_stats);
+        // bandwidth of the evaluation, to compare different numbers of streams
+        const auto evaluate_ms = boost::accumulators::mean(accumulated_stats.accumulators_.at(
+            static_cast<std::size_t>(MOTION::Statistics::RunTimeStats::StatID::evaluate)));
+        const auto num_bytes =
+            boost::accumulators::mean(accumulated_comm_stats.accumulators_.at(
+                MOTION::Statistics::AccumulatedCommunicationStats::idx_num_bytes_sent)) +
+            boost::accumulators::mean(accumulated_comm_stats.accumulators_.at(
+                MOTION::Statistics::AccumulatedCommunicationStats::idx_num_bytes_received));
+        std::cout << fmt::format("Bandwidth with {} streams: {:0.3f} MiB/s\n", num_streams,
+                                 num_bytes / 1048576 / (evaluate_ms / 1000));
+      }
     }
-    std::cout << MOTION::Statistics::print_stats(
-        fmt::format("Provider {} bit size {} batch size {}", ToString(comb.p_), comb.bit_size_,
-                    comb.batch_size_),
-        accumulated_stats, accumulated_comm_stats);
   }
   return EXIT_SUCCESS;
 }
@@ -124,12 +154,12 @@ std::tuple<std::size_t, std::string, std::uint16_t> ParsePartyArgument(const std
   return {id, host, port};
 }
 
-// <variables map, help flag>
-std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]) {
+// <variables map, help flag, ots flag, transpose flag>
+std::tuple<po::variables_map, bool, bool, bool> ParseProgramOptions(int ac, char* av[]) {
   using namespace std::string_view_literals;
   constexpr std::string_view config_file_msg =
       "config file, other arguments will overwrite the parameters read from the config file"sv;
-  bool print, help, ots;
+  bool print, help, ots, transpose;
   boost::program_options::options_description desc("Allowed options");
   // clang-format off
   desc.add_options()
@@ -142,7 +172,11 @@ std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]
       ("other-parties", po::value<std::vector<std::string>>()->multitoken(), "(other party id, IP, port, my role), e.g., --other-parties 1,127.0.0.1,7777")
       ("online-after-setup", po::value<bool>()->default_value(true), "compute the online phase of the gate evaluations after the setup phase for all of them is completed (true/1 or false/0)")
       ("repetitions", po::value<std::size_t>()->default_value(1), "number of repetitions")
-      ("ots,o", po::bool_switch(&ots)->default_value(false),"test OTs, otherwise all other providers");
+      ("num-streams", po::value<std::vector<std::size_t>>()->multitoken()->default_value({1}, "1"), "number of TCP connections to each party, multiple values are benchmarked one after another")
+      ("network-profile", po::value<std::vector<std::string>>()->multitoken()->default_value({"none"}, "none"), "emulate the network in process: none, lan, wan or <RTT ms>,<bandwidth Mbit/s>[,<jitter ms>], multiple values are benchmarked one after another")
+      ("ots,o", po::bool_switch(&ots)->default_value(false),"test OTs, otherwise all other providers")
+      ("transpose", po::bool_switch(&transpose)->default_value(false), "benchmark the transposition and hashing of the OT extension locally with each supported SIMD kernel")
+      ("int-mult-kernels", po::bool_switch()->default_value(false), "benchmark the summation of the OT outputs of the integer multiplications locally with each supported SIMD kernel");
   // clang-format on
 
   po::variables_map vm;
@@ -153,7 +187,7 @@ std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]
   // argument help or no arguments (at least a config file is expected)
   if (help) {
     std::cout << desc << "\n";
-    return std::make_tuple<po::variables_map, bool, bool>({}, true, false);
+    return std::make_tuple<po::variables_map, bool, bool, bool>({}, true, false, false);
   }
 
   // read config file
@@ -164,6 +198,11 @@ std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]
     po::notify(vm);
   }
 
+  // the local micro-benchmarks do not need any parties
+  if (transpose || vm["int-mult-kernels"].as<bool>()) {
+    return std::make_tuple(vm, help, ots, transpose);
+  }
+
   // print parsed parameters
   if (vm.count("my-id")) {
     if (print) std::cout << "My id " << vm["my-id"].as<std::size_t>() << std::endl;
@@ -191,10 +230,11 @@ std::tuple<po::variables_map, bool, bool> ParseProgramOptions(int ac, char* av[]
 
     std::cout << "MPC Protocol: " << vm["protocol"].as<std::string>() << std::endl;
   }
-  return std::make_tuple(vm, help, ots);
+  return std::make_tuple(vm, help, ots, transpose);
 }
 
-MOTION::PartyPtr CreateParty(const po::variables_map& vm) {
+MOTION::PartyPtr CreateParty(const po::variables_map& vm, std::size_t num_streams,
+                             const MOTION::Communication::NetworkProfile& network_profile) {
   const auto parties_str{vm["other-parties"].as<const std::vector<std::string>>()};
   const auto num_parties{parties_str.size()};
   const auto my_id{vm["my-id"].as<std::size_t>()};
@@ -216,8 +256,15 @@ MOTION::PartyPtr CreateParty(const po::variables_map& vm) {
     }
     parties_config.at(party_id) = std::make_pair(host, port);
   }
-  MOTION::Communication::TCPSetupHelper helper(my_id, parties_config);
-  auto comm_layer = std::make_unique<MOTION::Communication::CommunicationLayer>(my_id, helper.setup_connections());
+  MOTION::Communication::TCPSetupHelper helper(my_id, parties_config, num_streams);
+  auto transports = helper.setup_connections();
+  if (!network_profile.is_none()) {
+    transports = MOTION::Communication::make_emulated_transports(
+        std::move(transports),
+        std::make_shared<MOTION::Communication::NetworkEmulation>(network_profile));
+  }
+  auto comm_layer =
+      std::make_unique<MOTION::Communication::CommunicationLayer>(my_id, std::move(transports));
   auto party = std::make_unique<MOTION::Party>(std::move(comm_layer));
   auto config = party->GetConfiguration();
   // disable logging if the corresponding flag was set
@@ -24,13 +24,21 @@
 
 #include "benchmark_providers.h"
 
+#include <chrono>
+#include <iostream>
+
+#include <fmt/format.h>
+
 #include "base/backend.h"
+#include "crypto/arithmetic_provider.h"
 #include "crypto/multiplication_triple/mt_provider.h"
 #include "crypto/multiplication_triple/sb_provider.h"
 #include "crypto/multiplication_triple/sp_provider.h"
 #include "crypto/oblivious_transfer/ot_flavors.h"
+#include "crypto/pseudo_random_generator.h"
 #include "statistics/analysis.h"
 #include "statistics/run_time_stats.h"
+#include "utility/bit_matrix.h"
 #include "utility/block.h"
 #include "utility/config.h"
 
@@ -298,3 +306,80 @@ MOTION::Statistics::RunTimeStats BenchmarkProvider(MOTION::PartyPtr& party, std:
 
   return stats.front();
 }
+
+void BenchmarkTransposeKernels(std::size_t batch_size, std::size_t num_repetitions) {
+  using Kernel = ENCRYPTO::BitMatrix::TransposeKernel;
+  constexpr std::size_t kappa{128};
+  // as the OT extension, which pads the number of OTs to the next multiple of kappa
+  const std::size_t ncols = batch_size + kappa - (batch_size % kappa);
+
+  std::vector<ENCRYPTO::AlignedBitVector> rows(kappa);
+  std::array<const std::byte*, kappa> ptrs;
+  for (std::size_t i = 0; i < kappa; ++i) {
+    rows[i] = ENCRYPTO::AlignedBitVector::Random(ncols);
+    ptrs[i] = rows[i].GetData().data();
+  }
+  const std::vector<std::size_t> bitlengths(ncols, 1);
+  const auto choices = ENCRYPTO::BitVector<>::Random(kappa);
+  const auto key = ENCRYPTO::BitVector<>::Random(kappa);
+  ENCRYPTO::PRG prg_fixed_key;
+  prg_fixed_key.SetKey(key.GetData().data());
+
+  for (auto kernel : {Kernel::sse, Kernel::avx2, Kernel::avx512}) {
+    if (!ENCRYPTO::BitMatrix::IsTransposeKernelSupported(kernel)) {
+      std::cout << fmt::format("Transpose kernel {}: not supported by this CPU\n",
+                               to_string(kernel));
+      continue;
+    }
+    std::chrono::duration<double> sender_time{0}, receiver_time{0};
+    for (std::size_t i = 0; i < num_repetitions; ++i) {
+      std::vector<ENCRYPTO::BitVector<>> y0(batch_size), y1(batch_size), out(batch_size);
+      const auto t0 = std::chrono::steady_clock::now();
+      ENCRYPTO::BitMatrix::SenderTransposeAndEncrypt(ptrs, y0, y1, choices, prg_fixed_key, ncols,
+                                                     bitlengths, kernel);
+      const auto t1 = std::chrono::steady_clock::now();
+      ENCRYPTO::BitMatrix::ReceiverTransposeAndEncrypt(ptrs, out, prg_fixed_key, ncols, bitlengths,
+                                                       kernel);
+      const auto t2 = std::chrono::steady_clock::now();
+      sender_time += t1 - t0;
+      receiver_time += t2 - t1;
+    }
+    const double num_ots = batch_size * num_repetitions;
+    std::cout << fmt::format(
+        "Transpose kernel {}: sender {:0.3f} MOTs/s/core, receiver {:0.3f} MOTs/s/core\n",
+        to_string(kernel), num_ots / sender_time.count() / 1e6,
+        num_ots / receiver_time.count() / 1e6);
+  }
+}
+
+template <typename T>
+static void benchmark_integer_multiplication_kernels(std::size_t batch_size,
+                                                     std::size_t num_repetitions) {
+  using Kernel = MOTION::IntegerMultiplicationKernel;
+  const auto ot_outputs = MOTION::Helpers::RandomVector<T>(batch_size * ENCRYPTO::bit_size_v<T>);
+  std::vector<T> outputs(batch_size);
+  for (auto kernel : {Kernel::scalar, Kernel::avx2, Kernel::avx512}) {
+    if (!MOTION::is_integer_multiplication_kernel_supported(kernel)) {
+      std::cout << fmt::format("Integer multiplication kernel {}: not supported by this CPU\n",
+                               to_string(kernel));
+      continue;
+    }
+    std::chrono::duration<double> time{0};
+    for (std::size_t i = 0; i < num_repetitions; ++i) {
+      const auto t0 = std::chrono::steady_clock::now();
+      MOTION::detail::sum_bit_products(ot_outputs.data(), outputs.data(), batch_size, 1, true,
+                                       kernel);
+      time += std::chrono::steady_clock::now() - t0;
+    }
+    std::cout << fmt::format("Integer multiplication kernel {} ({} bit): {:0.3f} Mmults/s/core\n",
+                             to_string(kernel), ENCRYPTO::bit_size_v<T>,
+                             batch_size * num_repetitions / time.count() / 1e6);
+  }
+}
+
+void BenchmarkIntegerMultiplicationKernels(std::size_t batch_size, std::size_t num_repetitions) {
+  benchmark_integer_multiplication_kernels<std::uint8_t>(batch_size, num_repetitions);
+  benchmark_integer_multiplication_kernels<std::uint16_t>(batch_size, num_repetitions);
+  benchmark_integer_multiplication_kernels<std::uint32_t>(batch_size, num_repetitions);
+  benchmark_integer_multiplication_kernels<std::uint64_t>(batch_size, num_repetitions);
+}
@@ -45,3 +45,12 @@ inline std::string ToString(Provider p) { return PROVIDER_NAME[p]; }
 
 MOTION::Statistics::RunTimeStats BenchmarkProvider(MOTION::PartyPtr& party, std::size_t batch_size,
                                                   Provider provider, std::size_t bit_size = 0);
+
+// Benchmark the transposition and hashing of the OT extension with each kernel supported by the
+// CPU on a single core, without communication.  Prints the OTs per second for sender and receiver.
+void BenchmarkTransposeKernels(std::size_t batch_size, std::size_t num_repetitions);
+
+// Benchmark the summation of the ACOT outputs of the integer multiplications for each ring size
+// with the scalar code and each SIMD kernel supported by the CPU on a single core.  Prints the
+// multiplications per second of a party.
+void BenchmarkIntegerMultiplicationKernels(std::size_t batch_size, std::size_t num_repetitions);
@@ -0,0 +1,467 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs a workload with both parties in this process for a sweep of thread counts and reports the
+// speedup and the parallel efficiency of the whole run and of each phase relative to the first
+// thread count of the sweep.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/json/array.hpp>
+#include <boost/json/serialize.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "algorithm/circuit_loader.h"
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "base/two_party_tensor_backend.h"
+#include "communication/communication_layer.h"
+#include "protocols/beavy/beavy_provider.h"
+#include "protocols/beavy/tensor.h"
+#include "protocols/beavy/wire.h"
+#include "protocols/plain/constant_folding.h"
+#include "protocols/yao/yao_provider.h"
+#include "statistics/analysis.h"
+#include "statistics/run_time_stats.h"
+#include "tensor/tensor_op.h"
+#include "tensor/tensor_op_factory.h"
+#include "utility/bit_vector.h"
+#include "utility/helpers.h"
+#include "utility/logger.h"
+#include "utility/typedefs.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+using StatID = MOTION::Statistics::RunTimeStats::StatID;
+
+struct Options {
+  bool json;
+  std::vector<std::size_t> thread_counts;
+  std::size_t num_repetitions;
+  std::string workload;
+  std::string transport;
+  // number of windows of the pattern matching, blocks of AES, and values of the ReLU
+  std::size_t num_simd;
+  std::size_t pattern_size;
+  std::size_t ring_size;
+  std::array<std::size_t, 3> gemm_dims;
+  std::size_t fractional_bits;
+};
+
+// phases in the breakdown, evaluate covers the others except for the base OTs
+constexpr std::array<StatID, 8> reported_phases = {
+    StatID::base_ots,           StatID::ot_extension_setup, StatID::mt_setup,
+    StatID::linalgtriple_setup, StatID::preprocessing,      StatID::gates_setup,
+    StatID::gates_online,       StatID::evaluate};
+
+const char* phase_name(StatID id) {
+  switch (id) {
+    case StatID::base_ots:
+      return "base_ots";
+    case StatID::ot_extension_setup:
+      return "ot_extension_setup";
+    case StatID::mt_setup:
+      return "mt_setup";
+    case StatID::linalgtriple_setup:
+      return "linalgtriple_setup";
+    case StatID::preprocessing:
+      return "preprocessing";
+    case StatID::gates_setup:
+      return "gates_setup";
+    case StatID::gates_online:
+      return "gates_online";
+    case StatID::evaluate:
+      return "evaluate";
+    default:
+      throw std::invalid_argument("unexpected phase");
+  }
+}
+
+std::optional<Options> parse_program_options(int argc, char* argv[]) {
+  Options options;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+    ("help,h", po::bool_switch()->default_value(false),"produce help message")
+    ("workload", po::value<std::string>()->required(),
+     "workload to run: pattern-matching, aes or nn-layer")
+    ("threads", po::value<std::vector<std::size_t>>()->multitoken()->default_value(
+         {1, 2, 4, 8}, "1 2 4 8"),
+     "thread counts of the sweep, the first one is the baseline")
+    ("repetitions", po::value<std::size_t>()->default_value(5),
+     "number of repetitions per thread count")
+    ("transport", po::value<std::string>()->default_value("dummy"),
+     "transport between the parties: dummy or tcp")
+    ("json", po::bool_switch()->default_value(false), "output data in JSON format")
+    ("num-simd", po::value<std::size_t>()->default_value(1024),
+     "number of text windows, AES blocks, or ReLU values")
+    ("pattern-size", po::value<std::size_t>()->default_value(16),
+     "pattern size of the pattern matching")
+    ("ring-size", po::value<std::size_t>()->default_value(2),
+     "bits per character of the pattern matching")
+    ("gemm-dims", po::value<std::vector<std::size_t>>()->multitoken()->default_value(
+         {1, 256, 128}, "1 256 128"),
+     "dimensions l m n of the product of an l x m input with m x n weights of the NN layer")
+    ("fractional-bits", po::value<std::size_t>()->default_value(16),
+     "number of fractional bits for fixed-point arithmetic of the NN layer")
+    ;
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  bool help = vm["help"].as<bool>();
+  if (help) {
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "error:" << e.what() << "\n\n";
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+
+  options.json = vm["json"].as<bool>();
+  options.thread_counts = vm["threads"].as<std::vector<std::size_t>>();
+  options.num_repetitions = vm["repetitions"].as<std::size_t>();
+  options.workload = vm["workload"].as<std::string>();
+  boost::algorithm::to_lower(options.workload);
+  options.transport = vm["transport"].as<std::string>();
+  boost::algorithm::to_lower(options.transport);
+  options.num_simd = vm["num-simd"].as<std::size_t>();
+  options.pattern_size = vm["pattern-size"].as<std::size_t>();
+  options.ring_size = vm["ring-size"].as<std::size_t>();
+  options.fractional_bits = vm["fractional-bits"].as<std::size_t>();
+
+  if (options.workload != "pattern-matching" && options.workload != "aes" &&
+      options.workload != "nn-layer") {
+    std::cerr << "unknown workload: " << options.workload << "\n";
+    return std::nullopt;
+  }
+  if (options.transport != "dummy" && options.transport != "tcp") {
+    std::cerr << "unknown transport: " << options.transport << "\n";
+    return std::nullopt;
+  }
+  if (options.thread_counts.empty() ||
+      std::count(std::begin(options.thread_counts), std::end(options.thread_counts), 0) != 0) {
+    std::cerr << "--threads expects positive thread counts\n";
+    return std::nullopt;
+  }
+  if (options.num_repetitions == 0 || options.num_simd == 0) {
+    std::cerr << "--repetitions and --num-simd must be positive\n";
+    return std::nullopt;
+  }
+  const auto gemm_dims = vm["gemm-dims"].as<std::vector<std::size_t>>();
+  if (gemm_dims.size() != 3) {
+    std::cerr << "--gemm-dims expects three dimensions\n";
+    return std::nullopt;
+  }
+  std::copy_n(std::begin(gemm_dims), 3, std::begin(options.gemm_dims));
+
+  return options;
+}
+
+std::string get_experiment_name(const Options& options) {
+  if (options.workload == "pattern-matching") {
+    return fmt::format("pattern-matching-{}-{}-{}", options.num_simd, options.pattern_size,
+                       options.ring_size);
+  } else if (options.workload == "aes") {
+    return fmt::format("aes-{}", options.num_simd);
+  }
+  return fmt::format("nn-layer-{}x{}x{}", options.gemm_dims[0], options.gemm_dims[1],
+                     options.gemm_dims[2]);
+}
+
+MOTION::WireVector make_boolean_wires(std::size_t num_wires, std::size_t num_simd) {
+  MOTION::WireVector wires;
+  for (std::size_t i = 0; i < num_wires; ++i) {
+    auto wire = std::make_shared<MOTION::proto::beavy::BooleanBEAVYWire>(num_simd);
+    wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_simd);
+    wire->get_public_share() = ENCRYPTO::BitVector<>::Random(num_simd);
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    wires.push_back(std::move(wire));
+  }
+  return wires;
+}
+
+// HAM followed by EQEXP as in the exact_pm example
+void prepare_pattern_matching(const Options& options, MOTION::TwoPartyBackend& backend) {
+  const auto num_wires = options.pattern_size * options.ring_size;
+  auto distances = backend.get_gate_factory(MOTION::MPCProtocol::BooleanBEAVY)
+                       .make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM,
+                                        make_boolean_wires(num_wires, options.num_simd));
+  auto bound = MOTION::proto::plain::make_arithmetic_constant_wire(
+      std::vector<std::uint64_t>(options.num_simd, 2 * num_wires));
+  backend.get_gate_factory(MOTION::MPCProtocol::ArithmeticBEAVY)
+      .make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP, distances, bound);
+}
+
+// AES-128 in BooleanBEAVY on num_simd blocks
+void prepare_aes(const Options& options, MOTION::TwoPartyBackend& backend) {
+  auto& beavy_provider = dynamic_cast<MOTION::proto::beavy::BEAVYProvider&>(
+      backend.get_gate_factory(MOTION::MPCProtocol::BooleanBEAVY));
+  const auto& algo = beavy_provider.get_circuit_loader().load_circuit(
+      "aes_128.bristol", MOTION::CircuitFormat::Bristol);
+  backend.make_circuit(algo, make_boolean_wires(128, options.num_simd),
+                       make_boolean_wires(128, options.num_simd));
+}
+
+template <typename T>
+MOTION::tensor::TensorCP make_arithmetic_beavy_tensor(MOTION::tensor::TensorDimensions dims) {
+  auto t = std::make_shared<MOTION::proto::beavy::ArithmeticBEAVYTensor<T>>(dims);
+  t->get_secret_share() = MOTION::Helpers::RandomVector<T>(dims.get_data_size());
+  t->get_public_share() = MOTION::Helpers::RandomVector<T>(dims.get_data_size());
+  t->set_setup_ready();
+  t->set_online_ready();
+  return t;
+}
+
+// dense layer in ArithmeticBEAVY followed by the ReLU in Yao
+void prepare_nn_layer(const Options& options, MOTION::TwoPartyTensorBackend& backend) {
+  const auto [dim_l, dim_m, dim_n] = options.gemm_dims;
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {dim_l, dim_m},
+      .input_B_shape_ = {dim_m, dim_n},
+      .output_shape_ = {dim_l, dim_n}};
+  auto input_tensor =
+      make_arithmetic_beavy_tensor<std::uint64_t>(gemm_op.get_input_A_tensor_dims());
+  auto weights_tensor =
+      make_arithmetic_beavy_tensor<std::uint64_t>(gemm_op.get_input_B_tensor_dims());
+  auto output_tensor =
+      backend.get_tensor_op_factory(MOTION::MPCProtocol::ArithmeticBEAVY)
+          .make_tensor_gemm_op(gemm_op, input_tensor, weights_tensor, options.fractional_bits);
+  auto& yao_provider = dynamic_cast<MOTION::proto::yao::YaoProvider&>(
+      backend.get_tensor_op_factory(MOTION::MPCProtocol::Yao));
+  yao_provider.make_arithmetic_beavy_tensor_relu_op(output_tensor);
+}
+
+// builds the workload on a fresh backend of the party and runs it
+MOTION::Statistics::RunTimeStats run_party(const Options& options,
+                                           MOTION::Communication::CommunicationLayer& comm_layer,
+                                           std::size_t num_threads,
+                                           std::shared_ptr<MOTION::Logger> logger) {
+  if (options.workload == "nn-layer") {
+    MOTION::TwoPartyTensorBackend backend(comm_layer, num_threads, false, std::move(logger));
+    prepare_nn_layer(options, backend);
+    backend.run();
+    return backend.get_run_time_stats();
+  }
+  MOTION::TwoPartyBackend backend(comm_layer, num_threads, false, std::move(logger));
+  if (options.workload == "pattern-matching") {
+    prepare_pattern_matching(options, backend);
+  } else {
+    prepare_aes(options, backend);
+  }
+  backend.run();
+  return backend.get_run_time_stats();
+}
+
+struct SweepPoint {
+  std::size_t num_threads_;
+  // wall clock time of a run, i.e., of the slower party
+  std::vector<double> run_ms_;
+  std::array<MOTION::Statistics::AccumulatedRunTimeStats, 2> run_time_stats_;
+  MOTION::Statistics::AccumulatedCommunicationStats comm_stats_;
+
+  double get_median_run_ms() const {
+    return MOTION::Statistics::compute_percentile(run_ms_, 50);
+  }
+  // median of the phase of the slower party
+  double get_median_phase_ms(StatID id) const {
+    return std::max(run_time_stats_[0].get_percentile(id, 50),
+                    run_time_stats_[1].get_percentile(id, 50));
+  }
+};
+
+SweepPoint run_sweep_point(
+    const Options& options,
+    std::vector<std::unique_ptr<MOTION::Communication::CommunicationLayer>>& comm_layers,
+    const std::array<std::shared_ptr<MOTION::Logger>, 2>& loggers, std::size_t num_threads) {
+  SweepPoint point{.num_threads_ = num_threads};
+  for (std::size_t rep = 0; rep < options.num_repetitions; ++rep) {
+    std::array<double, 2> run_ms;
+    std::array<MOTION::Statistics::RunTimeStats, 2> run_time_stats;
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [&, i] {
+        const auto start = std::chrono::steady_clock::now();
+        run_time_stats[i] = run_party(options, *comm_layers[i], num_threads, loggers[i]);
+        comm_layers[i]->sync();
+        run_ms[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                              start)
+                        .count();
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+    point.run_ms_.push_back(std::max(run_ms[0], run_ms[1]));
+    for (std::size_t i = 0; i < 2; ++i) {
+      point.run_time_stats_[i].add(run_time_stats[i]);
+    }
+    point.comm_stats_.add(comm_layers[0]->get_transport_statistics());
+    for (auto& comm_layer : comm_layers) {
+      comm_layer->reset_transport_statistics();
+    }
+  }
+  return point;
+}
+
+// speedup and parallel efficiency of a duration relative to the baseline
+std::pair<double, double> compute_scaling(double baseline_ms, std::size_t baseline_threads,
+                                          double ms, std::size_t num_threads) {
+  if (ms <= 0 || baseline_ms <= 0) {
+    return {0, 0};
+  }
+  const auto speedup = baseline_ms / ms;
+  return {speedup, speedup * baseline_threads / num_threads};
+}
+
+std::string print_report(const Options& options, const std::vector<SweepPoint>& points) {
+  const auto& baseline = points.front();
+  std::stringstream ss;
+  ss << fmt::format("Thread scaling of {} ({} transport, {} repetitions per point)\n",
+                    get_experiment_name(options), options.transport, options.num_repetitions);
+  ss << "medians of the slower party, speedup and efficiency relative to " << baseline.num_threads_
+     << " thread(s)\n";
+  if (baseline.num_threads_ == 1 && points.size() > 1) {
+    ss << "note: 1 thread uses the sequential code path of the executor\n";
+  }
+  ss << "===========================================================================\n";
+  ss << fmt::format("{:>7}  {:>11}  {:>8}  {:>10}\n", "threads", "run", "speedup", "efficiency");
+  for (const auto& point : points) {
+    const auto [speedup, efficiency] =
+        compute_scaling(baseline.get_median_run_ms(), baseline.num_threads_,
+                        point.get_median_run_ms(), point.num_threads_);
+    ss << fmt::format("{:>7}  {:>8.3f} ms  {:>7.2f}x  {:>9.1f}%\n", point.num_threads_,
+                      point.get_median_run_ms(), speedup, 100 * efficiency);
+  }
+  ss << "---------------------------------------------------------------------------\n";
+  ss << fmt::format("{:<20} {:>7}  {:>11}  {:>8}  {:>10}\n", "phase", "threads", "median",
+                    "speedup", "efficiency");
+  for (const auto id : reported_phases) {
+    for (const auto& point : points) {
+      const auto [speedup, efficiency] =
+          compute_scaling(baseline.get_median_phase_ms(id), baseline.num_threads_,
+                          point.get_median_phase_ms(id), point.num_threads_);
+      ss << fmt::format("{:<20} {:>7}  {:>8.3f} ms  {:>7.2f}x  {:>9.1f}%\n", phase_name(id),
+                        point.num_threads_, point.get_median_phase_ms(id), speedup,
+                        100 * efficiency);
+    }
+  }
+  ss << "===========================================================================\n";
+  return ss.str();
+}
+
+boost::json::object to_json(const Options& options, const std::vector<SweepPoint>& points) {
+  const auto& baseline = points.front();
+  boost::json::array json_points;
+  for (const auto& point : points) {
+    const auto [speedup, efficiency] =
+        compute_scaling(baseline.get_median_run_ms(), baseline.num_threads_,
+                        point.get_median_run_ms(), point.num_threads_);
+    boost::json::object json_phases;
+    for (const auto id : reported_phases) {
+      const auto [phase_speedup, phase_efficiency] =
+          compute_scaling(baseline.get_median_phase_ms(id), baseline.num_threads_,
+                          point.get_median_phase_ms(id), point.num_threads_);
+      json_phases.emplace(phase_name(id),
+                          boost::json::object({{"median_ms", point.get_median_phase_ms(id)},
+                                               {"speedup", phase_speedup},
+                                               {"efficiency", phase_efficiency}}));
+    }
+    boost::json::array json_parties;
+    for (const auto& stats : point.run_time_stats_) {
+      json_parties.emplace_back(stats.to_json());
+    }
+    json_points.emplace_back(boost::json::object({{"threads", point.num_threads_},
+                                                  {"run_median_ms", point.get_median_run_ms()},
+                                                  {"speedup", speedup},
+                                                  {"efficiency", efficiency},
+                                                  {"phases", std::move(json_phases)},
+                                                  {"parties", std::move(json_parties)},
+                                                  {"communication", point.comm_stats_.to_json()}}));
+  }
+  return {{"experiment", get_experiment_name(options)},
+          {"workload", options.workload},
+          {"transport", options.transport},
+          {"repetitions", options.num_repetitions},
+          {"baseline_threads", baseline.num_threads_},
+          {"points", std::move(json_points)}};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  auto options = parse_program_options(argc, argv);
+  if (!options.has_value()) {
+    return EXIT_FAILURE;
+  }
+
+  try {
+    auto comm_layers = (options->transport == "tcp")
+                           ? MOTION::Communication::make_local_tcp_communication_layers(2, false)
+                           : MOTION::Communication::make_dummy_communication_layers(2, false);
+    std::array<std::shared_ptr<MOTION::Logger>, 2> loggers;
+    for (std::size_t i = 0; i < 2; ++i) {
+      loggers[i] = std::make_shared<MOTION::Logger>(i, boost::log::trivial::severity_level::error);
+      comm_layers[i]->set_logger(loggers[i]);
+    }
+
+    std::vector<SweepPoint> points;
+    for (const auto num_threads : options->thread_counts) {
+      points.push_back(run_sweep_point(*options, comm_layers, loggers, num_threads));
+    }
+
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [&, i] { comm_layers[i]->shutdown(); }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+    if (options->json) {
+      std::cout << to_json(*options, points) << "\n";
+    } else {
+      std::cout << print_report(*options, points);
+    }
+  } catch (std::runtime_error& e) {
+    std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
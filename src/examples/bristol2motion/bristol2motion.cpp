@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Convert a circuit in the Bristol (Fashion) format into the binary format of MOTION, which the
+// CircuitLoader picks up if it is stored as <circuit>.mbc next to the text file.
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+
+#include "algorithm/algorithm_description.h"
+#include "algorithm/circuit_loader.h"
+
+namespace po = boost::program_options;
+
+struct Options {
+  std::string input_path;
+  std::string output_path;
+  bool bristol_fashion;
+};
+
+std::optional<Options> parse_program_options(int argc, char* argv[]) {
+  Options options;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+    ("help,h", po::bool_switch()->default_value(false),"produce help message")
+    ("input", po::value<std::string>()->required(), "path to the circuit file")
+    ("output", po::value<std::string>(), "path of the binary circuit (default: <input>.mbc)")
+    ("format", po::value<std::string>()->default_value("bristol"),
+     "format of the input file (bristol or bristol-fashion)");
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  bool help = vm["help"].as<bool>();
+  if (help) {
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "error:" << e.what() << "\n\n";
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+
+  options.input_path = vm["input"].as<std::string>();
+  if (vm.count("output")) {
+    options.output_path = vm["output"].as<std::string>();
+  } else {
+    options.output_path = options.input_path + MOTION::binary_circuit_suffix;
+  }
+  const auto format = vm["format"].as<std::string>();
+  if (format == "bristol") {
+    options.bristol_fashion = false;
+  } else if (format == "bristol-fashion") {
+    options.bristol_fashion = true;
+  } else {
+    std::cerr << "invalid format: " << format << "\n";
+    return std::nullopt;
+  }
+  return options;
+}
+
+int main(int argc, char* argv[]) {
+  auto options = parse_program_options(argc, argv);
+  if (!options.has_value()) {
+    return EXIT_FAILURE;
+  }
+
+  try {
+    using clock_type = std::chrono::steady_clock;
+    auto start = clock_type::now();
+    const auto algo =
+        options->bristol_fashion
+            ? ENCRYPTO::AlgorithmDescription::FromBristolFashion(options->input_path)
+            : ENCRYPTO::AlgorithmDescription::FromBristol(options->input_path);
+    const auto text_ms = std::chrono::duration<double, std::milli>(clock_type::now() - start);
+    algo.WriteBinary(options->output_path);
+    start = clock_type::now();
+    const auto loaded_algo = ENCRYPTO::AlgorithmDescription::FromBinary(options->output_path);
+    const auto binary_ms = std::chrono::duration<double, std::milli>(clock_type::now() - start);
+    if (loaded_algo.gates_.size() != algo.gates_.size()) {
+      throw std::runtime_error("binary circuit does not contain all gates");
+    }
+    std::cout << fmt::format(
+        "wrote {} gates and {} wires to {} ({} bytes), loading took {:.3f} ms instead of {:.3f} "
+        "ms\n",
+        algo.gates_.size(), algo.n_wires_, options->output_path,
+        std::filesystem::file_size(options->output_path), binary_ms.count(), text_ms.count());
+  } catch (std::runtime_error& e) {
+    std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
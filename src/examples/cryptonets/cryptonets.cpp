@@ -36,6 +36,7 @@
 #include "base/two_party_tensor_backend.h"
 #include "communication/communication_layer.h"
 #include "communication/tcp_transport.h"
+#include "protocols/beavy/beavy_provider.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_op.h"
 #include "tensor/tensor_op_factory.h"
@@ -54,6 +55,7 @@ struct Options {
   std::size_t my_id;
   MOTION::Communication::tcp_parties_config tcp_config;
   bool relu;
+  bool fuse_square;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -74,7 +76,9 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("repetitions", po::value<std::size_t>()->default_value(1), "number of repetitions")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("relu", po::bool_switch(&options.relu)->default_value(false), "use ReLU instead of squaring as activation function");
+    ("relu", po::bool_switch(&options.relu)->default_value(false), "use ReLU instead of squaring as activation function")
+    ("fuse-square", po::bool_switch(&options.fuse_square)->default_value(false),
+     "square the outputs of the linear layers in their own gates (BEAVY only)");
   // clang-format on
 
   po::variables_map vm;
@@ -116,6 +120,11 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     std::cerr << "invalid protocol: " << protocol << "\n";
     return std::nullopt;
   }
+  if (options.fuse_square &&
+      (options.relu || options.protocol != MOTION::MPCProtocol::ArithmeticBEAVY)) {
+    std::cerr << "fuse-square requires BEAVY and squaring as activation function\n";
+    return std::nullopt;
+  }
 
   const auto parse_party_argument =
       [](const auto& s) -> std::pair<std::size_t, MOTION::Communication::tcp_connection_config> {
@@ -197,10 +206,15 @@ ENCRYPTO::ReusableFiberFuture<std::vector<std::uint64_t>> build_cryptonets(
       return arithmetic_tof.make_tensor_sqr_op(input, options.fractional_bits);
     };
   } else {
-    make_activation = [&](const auto& input) {
-      const auto boolean_tensor = boolean_tof.make_tensor_conversion(boolean_protocol, input);
-      const auto relu_tensor = boolean_tof.make_tensor_relu_op(boolean_tensor);
-      return boolean_tof.make_tensor_conversion(arithmetic_protocol, relu_tensor);
+    // only the signs are computed in Yao, the ReLU itself multiplies them with the arithmetic
+    // input, which saves converting all bits back and forth
+    const auto sign_protocol = arithmetic_protocol == MOTION::MPCProtocol::ArithmeticBEAVY
+                                   ? MOTION::MPCProtocol::BooleanBEAVY
+                                   : MOTION::MPCProtocol::BooleanGMW;
+    make_activation = [&, sign_protocol](const auto& input) {
+      const auto msb_tensor = boolean_tof.make_tensor_msb_conversion(boolean_protocol, input);
+      const auto sign_tensor = boolean_tof.make_tensor_conversion(sign_protocol, msb_tensor);
+      return arithmetic_tof.make_tensor_relu_op(sign_tensor, input);
     };
   }
 
@@ -230,13 +244,25 @@ ENCRYPTO::ReusableFiberFuture<std::vector<std::uint64_t>> build_cryptonets(
         arithmetic_tof.make_arithmetic_64_tensor_input_other(fully_connected_weights_dims);
   }
 
-  auto conv_output = arithmetic_tof.make_tensor_conv2d_op(
-      conv_op, input_tensor, conv_weights_tensor, options.fractional_bits);
-  auto act_1_output = make_activation(conv_output);
-  auto flatten_output = arithmetic_tof.make_tensor_flatten_op(act_1_output, 0);
-  auto squashed_output = arithmetic_tof.make_tensor_gemm_op(
-      gemm_op_1, flatten_output, squashed_weights_tensor, options.fractional_bits);
-  auto act_2_output = make_activation(squashed_output);
+  MOTION::tensor::TensorCP act_1_output;
+  MOTION::tensor::TensorCP act_2_output;
+  if (options.fuse_square) {
+    // the activations are evaluated by the gates of the linear layers
+    auto& beavy_provider = dynamic_cast<MOTION::proto::beavy::BEAVYProvider&>(arithmetic_tof);
+    act_1_output = beavy_provider.make_tensor_conv2d_sqr_op(
+        conv_op, input_tensor, conv_weights_tensor, nullptr, options.fractional_bits);
+    auto flatten_output = arithmetic_tof.make_tensor_flatten_op(act_1_output, 0);
+    act_2_output = beavy_provider.make_tensor_gemm_sqr_op(
+        gemm_op_1, flatten_output, squashed_weights_tensor, options.fractional_bits);
+  } else {
+    auto conv_output = arithmetic_tof.make_tensor_conv2d_op(
+        conv_op, input_tensor, conv_weights_tensor, options.fractional_bits);
+    act_1_output = make_activation(conv_output);
+    auto flatten_output = arithmetic_tof.make_tensor_flatten_op(act_1_output, 0);
+    auto squashed_output = arithmetic_tof.make_tensor_gemm_op(
+        gemm_op_1, flatten_output, squashed_weights_tensor, options.fractional_bits);
+    act_2_output = make_activation(squashed_output);
+  }
   auto fully_connected_output = arithmetic_tof.make_tensor_gemm_op(
       gemm_op_2, act_2_output, fully_connected_weights_tensor, options.fractional_bits);
 
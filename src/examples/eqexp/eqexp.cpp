@@ -41,6 +41,7 @@
 #include "communication/communication_layer.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "utility/logger.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/beavy/gate.h"
@@ -63,6 +64,7 @@ struct Options {
   std::size_t my_id;
   MOTION::Communication::tcp_parties_config tcp_config;
   bool no_run = false;
+  bool compress_messages = false;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -84,7 +86,9 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("num-simd", po::value<std::size_t>()->default_value(1), "number of SIMD values")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("no-run", po::bool_switch()->default_value(false), "just build the circuit, but not execute it")
+    ("no-run", po::bool_switch()->default_value(false), "just build the circuit and print its analysis, but not execute it")
+    ("compress-messages", po::bool_switch()->default_value(false),
+     "compress redundant messages, e.g., the one-hot vectors, if the other party supports it")
     ;
   // clang-format on
 
@@ -114,6 +118,7 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.num_simd = vm["num-simd"].as<std::size_t>();
   options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
   options.no_run = vm["no-run"].as<bool>();
+  options.compress_messages = vm["compress-messages"].as<bool>();
   if (options.my_id > 1) {
     std::cerr << "my-id must be one of 0 and 1\n";
     return std::nullopt;
@@ -221,6 +226,7 @@ void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend) {
   auto [input_promise, output_future] = create_circuit(options, backend);
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -264,6 +270,7 @@ int main(int argc, char* argv[]) {
     auto logger = std::make_shared<MOTION::Logger>(options->my_id,
                                                    boost::log::trivial::severity_level::trace);
     comm_layer->set_logger(logger);
+    comm_layer->set_message_compression(options->compress_messages);
     MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
     MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
     for (std::size_t i = 0; i < options->num_repetitions; ++i) {
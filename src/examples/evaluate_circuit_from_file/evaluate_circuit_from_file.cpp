@@ -40,7 +40,10 @@
 #include "base/two_party_backend.h"
 #include "communication/communication_layer.h"
 #include "communication/tcp_transport.h"
+#include "crypto/oblivious_transfer/ot_provider.h"
+#include "executor/new_gate_executor.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "utility/logger.h"
 
 namespace po = boost::program_options;
@@ -57,6 +60,10 @@ struct Options {
   std::string circuit_path;
   bool fashion;
   bool no_run = false;
+  MOTION::GateScheduling scheduling;
+  std::string scheduling_name;
+  bool asap;
+  bool fake_setup;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -76,7 +83,13 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("num-simd", po::value<std::size_t>()->default_value(1), "number of SIMD values")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("no-run", po::bool_switch()->default_value(false), "just build the circuit, but not execute it")
+    ("scheduling", po::value<std::string>()->default_value("all-at-once"),
+     "how the gates are scheduled (all-at-once, ready-queue or critical-path)")
+    ("asap", po::bool_switch()->default_value(false),
+     "run the online phase of each gate directly after its setup phase")
+    ("fake-setup", po::bool_switch()->default_value(false),
+     "derive the setup from a fixed key without communication (insecure, benchmarks the online phase)")
+    ("no-run", po::bool_switch()->default_value(false), "just build the circuit and print its analysis, but not execute it")
     ("circuit", po::value<std::string>()->required(), "path to a circuit file in the Bristol format")
     ("fashion", po::bool_switch()->default_value(false), "output data in JSON format")
     ;
@@ -108,6 +121,20 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.num_simd = vm["num-simd"].as<std::size_t>();
   options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
   options.no_run = vm["no-run"].as<bool>();
+  options.asap = vm["asap"].as<bool>();
+  options.fake_setup = vm["fake-setup"].as<bool>();
+  const auto scheduling = vm["scheduling"].as<std::string>();
+  options.scheduling_name = scheduling;
+  if (scheduling == "all-at-once") {
+    options.scheduling = MOTION::GateScheduling::all_at_once;
+  } else if (scheduling == "ready-queue") {
+    options.scheduling = MOTION::GateScheduling::ready_queue;
+  } else if (scheduling == "critical-path") {
+    options.scheduling = MOTION::GateScheduling::critical_path;
+  } else {
+    std::cerr << "invalid scheduling: " << scheduling << "\n";
+    return std::nullopt;
+  }
   if (options.my_id > 1) {
     std::cerr << "my-id must be one of 0 and 1\n";
     return std::nullopt;
@@ -199,6 +226,7 @@ void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend) {
   auto output_future = gate_factory.make_boolean_output_gate_my(MOTION::ALL_PARTIES, w_out);
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -228,6 +256,9 @@ void print_stats(const Options& options,
     obj.emplace("simd", options.num_simd);
     obj.emplace("threads", options.threads);
     obj.emplace("sync_between_setup_and_online", options.sync_between_setup_and_online);
+    obj.emplace("scheduling", options.scheduling_name);
+    obj.emplace("asap", options.asap);
+    obj.emplace("fake_setup", options.fake_setup);
     obj.emplace("circuit_path", options.circuit_path);
     obj.emplace("fashion", options.fashion);
     std::cout << obj << "\n";
@@ -252,6 +283,11 @@ int main(int argc, char* argv[]) {
     for (std::size_t i = 0; i < options->num_repetitions; ++i) {
       MOTION::TwoPartyBackend backend(*comm_layer, options->threads,
                                       options->sync_between_setup_and_online, logger);
+      backend.set_gate_scheduling(options->scheduling);
+      backend.set_evaluate_asap(options->asap);
+      if (options->fake_setup) {
+        backend.set_ot_backend(ENCRYPTO::ObliviousTransfer::OTBackend::fake_setup);
+      }
       run_circuit(*options, backend);
       comm_layer->sync();
       comm_stats.add(comm_layer->get_transport_statistics());
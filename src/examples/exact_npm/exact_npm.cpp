@@ -39,8 +39,10 @@
 #include "base/gate_factory.h"
 #include "base/two_party_backend.h"
 #include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "utility/logger.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/beavy/gate.h"
@@ -69,6 +71,7 @@ struct Options {
   std::size_t my_id;
   MOTION::Communication::tcp_parties_config tcp_config;
   bool no_run = false;
+  std::vector<MOTION::Communication::NetworkProfile> network_profiles;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -90,7 +93,9 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("num-simd", po::value<std::size_t>()->default_value(1), "number of SIMD values")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("no-run", po::bool_switch()->default_value(false), "just build the circuit, but not execute it")
+    ("no-run", po::bool_switch()->default_value(false), "just build the circuit and print its analysis, but not execute it")
+    ("network-profile", po::value<std::vector<std::string>>()->multitoken()->default_value({"none"}, "none"),
+     "emulate the network in process: none, lan, wan or <RTT ms>,<bandwidth Mbit/s>[,<jitter ms>], multiple values are run one after another")
     ;
   // clang-format on
 
@@ -120,6 +125,14 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.num_simd = vm["num-simd"].as<std::size_t>();
   options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
   options.no_run = vm["no-run"].as<bool>();
+  try {
+    for (const auto& profile : vm["network-profile"].as<std::vector<std::string>>()) {
+      options.network_profiles.push_back(MOTION::Communication::parse_network_profile(profile));
+    }
+  } catch (std::invalid_argument& e) {
+    std::cerr << "error:" << e.what() << "\n";
+    return std::nullopt;
+  }
 
   options.arithmetic_protocol = MOTION::MPCProtocol::ArithmeticBEAVY;
   options.boolean_protocol = MOTION::MPCProtocol::BooleanBEAVY;
@@ -173,10 +186,17 @@ static std::vector<std::shared_ptr<NewWire>> cast_wires(BooleanBEAVYWireVector&
 
 
 std::unique_ptr<MOTION::Communication::CommunicationLayer> setup_communication(
-    const Options& options) {
+    const Options& options,
+    std::shared_ptr<const MOTION::Communication::NetworkEmulation> network_emulation) {
   MOTION::Communication::TCPSetupHelper helper(options.my_id, options.tcp_config);
+  auto transports = helper.setup_connections();
+  if (std::any_of(std::begin(options.network_profiles), std::end(options.network_profiles),
+                  [](const auto& profile) { return !profile.is_none(); })) {
+    transports = MOTION::Communication::make_emulated_transports(std::move(transports),
+                                                                 std::move(network_emulation));
+  }
   return std::make_unique<MOTION::Communication::CommunicationLayer>(options.my_id,
-                                                                     helper.setup_connections());
+                                                                     std::move(transports));
 }
 
 std::vector<uint64_t> convert_to_binary(uint64_t x) {
@@ -241,6 +261,7 @@ auto make_ring_wire(const Options& options) {
 void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend, WireVector in1, WireVector in2) {
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -294,6 +315,7 @@ void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend, WireV
 }
 
 void print_stats(const Options& options,
+                 const MOTION::Communication::NetworkProfile& network_profile,
                  const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats,
                  const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats) {
   if (options.json) {
@@ -301,10 +323,12 @@ void print_stats(const Options& options,
     obj.emplace("party_id", options.my_id);
     obj.emplace("threads", options.threads);
     obj.emplace("sync_between_setup_and_online", options.sync_between_setup_and_online);
+    obj.emplace("network_profile", MOTION::Communication::to_string(network_profile));
     std::cout << obj << "\n";
   } else {
-    std::cout << MOTION::Statistics::print_stats("Exact Pattern Matching", run_time_stats,
-                                                 comm_stats);
+    std::cout << MOTION::Statistics::print_stats(
+        "Exact Pattern Matching, network " + MOTION::Communication::to_string(network_profile),
+        run_time_stats, comm_stats);
   }
 }
 
@@ -319,23 +343,27 @@ int main(int argc, char* argv[]) {
 
     auto in1 = make_input_wires(*options);
     auto in2 = make_ring_wire(*options);
-    auto comm_layer = setup_communication(*options);
+    auto network_emulation = std::make_shared<MOTION::Communication::NetworkEmulation>();
+    auto comm_layer = setup_communication(*options, network_emulation);
     auto logger = std::make_shared<MOTION::Logger>(options->my_id,
                                                    boost::log::trivial::severity_level::trace);
     comm_layer->set_logger(logger);
-    MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
-    MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
-    for (std::size_t i = 0; i < options->num_repetitions; ++i) {
-      MOTION::TwoPartyBackend backend(*comm_layer, options->threads,
-                                      options->sync_between_setup_and_online, logger);
-      run_circuit(*options, backend, in1, in2);
-      comm_layer->sync();
-      comm_stats.add(comm_layer->get_transport_statistics());
-      comm_layer->reset_transport_statistics();
-      run_time_stats.add(backend.get_run_time_stats());
+    for (const auto& network_profile : options->network_profiles) {
+      network_emulation->set_profile(network_profile);
+      MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+      MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
+      for (std::size_t i = 0; i < options->num_repetitions; ++i) {
+        MOTION::TwoPartyBackend backend(*comm_layer, options->threads,
+                                        options->sync_between_setup_and_online, logger);
+        run_circuit(*options, backend, in1, in2);
+        comm_layer->sync();
+        comm_stats.add(comm_layer->get_transport_statistics());
+        comm_layer->reset_transport_statistics();
+        run_time_stats.add(backend.get_run_time_stats());
+      }
+      print_stats(*options, network_profile, run_time_stats, comm_stats);
     }
     comm_layer->shutdown();
-    print_stats(*options, run_time_stats, comm_stats);
   } catch (std::runtime_error& e) {
     std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
     return EXIT_FAILURE;
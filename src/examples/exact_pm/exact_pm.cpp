@@ -39,12 +39,15 @@
 #include "base/gate_factory.h"
 #include "base/two_party_backend.h"
 #include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
 #include "communication/tcp_transport.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "utility/logger.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/beavy/gate.h"
 #include "protocols/beavy/beavy_provider.h"
+#include "protocols/plain/constant_folding.h"
 #include "utility/bit_vector.h"
 #include "protocols/beavy/beavy_provider.cpp"
 #include "wire/new_wire.h"
@@ -69,6 +72,9 @@ struct Options {
   std::size_t my_id;
   MOTION::Communication::tcp_parties_config tcp_config;
   bool no_run = false;
+  bool arithmetic = false;
+  std::size_t first_matches = 0;
+  std::vector<MOTION::Communication::NetworkProfile> network_profiles;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -90,7 +96,13 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("num-simd", po::value<std::size_t>()->default_value(1), "number of SIMD values")
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
-    ("no-run", po::bool_switch()->default_value(false), "just build the circuit, but not execute it")
+    ("no-run", po::bool_switch()->default_value(false), "just build the circuit and print its analysis, but not execute it")
+    ("arithmetic", po::bool_switch()->default_value(false),
+     "share the characters arithmetically and compute the squared distances of all windows with NTTs instead of the Hamming distances of their bits")
+    ("first-matches", po::value<std::size_t>()->default_value(0),
+     "compute only the positions of the first k matching windows instead of a bit per window, 0 for all bits")
+    ("network-profile", po::value<std::vector<std::string>>()->multitoken()->default_value({"none"}, "none"),
+     "emulate the network in process: none, lan, wan or <RTT ms>,<bandwidth Mbit/s>[,<jitter ms>], multiple values are run one after another")
     ;
   // clang-format on
 
@@ -120,6 +132,16 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.num_simd = vm["num-simd"].as<std::size_t>();
   options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
   options.no_run = vm["no-run"].as<bool>();
+  options.arithmetic = vm["arithmetic"].as<bool>();
+  options.first_matches = vm["first-matches"].as<std::size_t>();
+  try {
+    for (const auto& profile : vm["network-profile"].as<std::vector<std::string>>()) {
+      options.network_profiles.push_back(MOTION::Communication::parse_network_profile(profile));
+    }
+  } catch (std::invalid_argument& e) {
+    std::cerr << "error:" << e.what() << "\n";
+    return std::nullopt;
+  }
 
   options.arithmetic_protocol = MOTION::MPCProtocol::ArithmeticBEAVY;
   options.boolean_protocol = MOTION::MPCProtocol::BooleanBEAVY;
@@ -174,10 +196,17 @@ static std::vector<std::shared_ptr<NewWire>> cast_wires(BooleanBEAVYWireVector&
 
 
 std::unique_ptr<MOTION::Communication::CommunicationLayer> setup_communication(
-    const Options& options) {
+    const Options& options,
+    std::shared_ptr<const MOTION::Communication::NetworkEmulation> network_emulation) {
   MOTION::Communication::TCPSetupHelper helper(options.my_id, options.tcp_config);
+  auto transports = helper.setup_connections();
+  if (std::any_of(std::begin(options.network_profiles), std::end(options.network_profiles),
+                  [](const auto& profile) { return !profile.is_none(); })) {
+    transports = MOTION::Communication::make_emulated_transports(std::move(transports),
+                                                                 std::move(network_emulation));
+  }
   return std::make_unique<MOTION::Communication::CommunicationLayer>(options.my_id,
-                                                                     helper.setup_connections());
+                                                                     std::move(transports));
 }
 
 
@@ -191,32 +220,40 @@ std::vector<uint64_t> convert_to_binary(uint64_t x) {
     return res;
 }
 
-auto make_input_wires(const Options& options) {
+// Random shares of bit planes, i.e., wire b holds bit b of all num_characters characters.
+auto make_bit_plane_wires(const Options& options, std::size_t num_characters) {
   BooleanBEAVYWireVector wires;
-  auto num_simd = options.text_size - options.pattern_size + 1;
-  auto num_wires = options.pattern_size*options.ring_size;
-//   if (options.pattern_size * options.ring_size < 256){
-//     num_wires = options.pattern_size * options.ring_size;
-//   }
-  std::cout << "num_simd: " << num_simd << std::endl;
-  std::cout << "num_wires: " << num_wires << std::endl;
-  
-  // setting random val?
-  for (uint64_t j = 0; j < num_wires; ++j){
-    auto wire = std::make_shared<BooleanBEAVYWire>(num_simd);
-    ENCRYPTO::BitVector<> mx = ENCRYPTO::BitVector<>::Random(num_simd);
-    ENCRYPTO::BitVector<> dx = ENCRYPTO::BitVector<>::Random(num_simd);
-    wire->get_secret_share() = mx;
-    wire->get_public_share() = dx;
+  for (uint64_t j = 0; j < options.ring_size; ++j) {
+    auto wire = std::make_shared<BooleanBEAVYWire>(num_characters);
+    wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_characters);
+    wire->get_public_share() = ENCRYPTO::BitVector<>::Random(num_characters);
+    wire->set_setup_ready();
+    wire->set_online_ready();
     wires.push_back(std::move(wire));
   }
-  for (uint64_t j = 0; j < num_wires; ++j) {
-      wires[j]->set_setup_ready();
-      wires[j]->set_online_ready();
-  }
+  return cast_wires(wires);
+}
 
-  auto in1 = cast_wires(wires);
-  return in1;
+// Random shares of num_characters characters, one per SIMD value of a single arithmetic wire.
+WireVector make_arithmetic_wire(std::size_t num_characters) {
+  auto wire = std::make_shared<ArithmeticBEAVYWire<uint64_t>>(num_characters);
+  wire->get_secret_share() = MOTION::Helpers::RandomVector<uint64_t>(num_characters);
+  wire->get_public_share() = MOTION::Helpers::RandomVector<uint64_t>(num_characters);
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return {wire};
+}
+
+// The text is shared once, the windows of pattern_size characters are offsets into it, see
+// BooleanBEAVYWindowView.
+std::pair<WireVector, WireVector> make_input_wires(const Options& options) {
+  std::cout << "num_windows: " << options.text_size - options.pattern_size + 1 << std::endl;
+  if (options.arithmetic) {
+    return {make_arithmetic_wire(options.text_size), make_arithmetic_wire(options.pattern_size)};
+  }
+  std::cout << "num_wires: " << options.ring_size << std::endl;
+  return {make_bit_plane_wires(options, options.text_size),
+          make_bit_plane_wires(options, options.pattern_size)};
 }
 
 auto make_eqexp_wire(const Options& options) {
@@ -229,24 +266,16 @@ auto make_eqexp_wire(const Options& options) {
   std::cout << "num_simd: " << num_simd << std::endl;
   std::cout << "num_wires: " << num_wires << std::endl;
 
-  auto wire = std::make_shared<ArithmeticBEAVYWire<uint64_t>>(num_simd);
-  std::vector<MOTION::NewWireP> in2;
-  std::vector<uint64_t> x(num_simd, 2*num_wires);
-  std::cout << x.size() << std::endl;
-  std::cout << x[0] << std::endl;
-
-  wire->get_secret_share() = x;
-  wire->get_public_share() = x;
-  wire->set_setup_ready();
-  wire->set_online_ready();
-
-  in2.push_back(wire);
-  return in2;
+  // the bound is public, so it is passed as a constant instead of a fake shared wire
+  return MOTION::proto::plain::make_arithmetic_constant_wire(
+      std::vector<uint64_t>(num_simd, 2 * num_wires));
 }
 
-void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend, WireVector in1, WireVector in2) {
+void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend, WireVector text,
+                 WireVector pattern, WireVector in2) {
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -258,16 +287,29 @@ void run_circuit(const Options& options, MOTION::TwoPartyBackend& backend, WireV
   
 
 
-  auto output1 = gate_factory_bool.make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM, in1);
+  // distances of all windows, i.e., of the bits or of the arithmetically shared characters
+  WireVector output1;
+  if (options.arithmetic) {
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(gate_factory_arith);
+    output1 = beavy_provider.make_window_distance_gate(text, pattern);
+  } else {
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(gate_factory_bool);
+    output1 = beavy_provider.make_window_hamming_gate(text, pattern);
+  }
   // auto output2 = gate_factory_arith.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, 
   //                                                       output1, output1);
   auto output = gate_factory_arith.make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP, 
                                                         output1, in2);
+  if (options.first_matches > 0) {
+    auto& beavy_provider = dynamic_cast<BEAVYProvider&>(gate_factory_bool);
+    beavy_provider.make_first_positions_gate(output, options.first_matches);
+  }
   backend.run();
 
 }
 
 void print_stats(const Options& options,
+                 const MOTION::Communication::NetworkProfile& network_profile,
                  const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats,
                  const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats) {
   if (options.json) {
@@ -275,10 +317,12 @@ void print_stats(const Options& options,
     obj.emplace("party_id", options.my_id);
     obj.emplace("threads", options.threads);
     obj.emplace("sync_between_setup_and_online", options.sync_between_setup_and_online);
+    obj.emplace("network_profile", MOTION::Communication::to_string(network_profile));
     std::cout << obj << "\n";
   } else {
-    std::cout << MOTION::Statistics::print_stats("Exact Pattern Matching", run_time_stats,
-                                                 comm_stats);
+    std::cout << MOTION::Statistics::print_stats(
+        "Exact Pattern Matching, network " + MOTION::Communication::to_string(network_profile),
+        run_time_stats, comm_stats);
   }
 }
 
@@ -291,25 +335,29 @@ int main(int argc, char* argv[]) {
   
   try {
 
-    auto in1 = make_input_wires(*options);
+    auto [text, pattern] = make_input_wires(*options);
     auto in2 = make_eqexp_wire(*options);
-    auto comm_layer = setup_communication(*options);
+    auto network_emulation = std::make_shared<MOTION::Communication::NetworkEmulation>();
+    auto comm_layer = setup_communication(*options, network_emulation);
     auto logger = std::make_shared<MOTION::Logger>(options->my_id,
                                                    boost::log::trivial::severity_level::trace);
     comm_layer->set_logger(logger);
-    MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
-    MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
-    for (std::size_t i = 0; i < options->num_repetitions; ++i) {
-      MOTION::TwoPartyBackend backend(*comm_layer, options->threads,
-                                      options->sync_between_setup_and_online, logger);
-      run_circuit(*options, backend, in1, in2);
-      comm_layer->sync();
-      comm_stats.add(comm_layer->get_transport_statistics());
-      comm_layer->reset_transport_statistics();
-      run_time_stats.add(backend.get_run_time_stats());
+    for (const auto& network_profile : options->network_profiles) {
+      network_emulation->set_profile(network_profile);
+      MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+      MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
+      for (std::size_t i = 0; i < options->num_repetitions; ++i) {
+        MOTION::TwoPartyBackend backend(*comm_layer, options->threads,
+                                        options->sync_between_setup_and_online, logger);
+        run_circuit(*options, backend, text, pattern, in2);
+        comm_layer->sync();
+        comm_stats.add(comm_layer->get_transport_statistics());
+        comm_layer->reset_transport_statistics();
+        run_time_stats.add(backend.get_run_time_stats());
+      }
+      print_stats(*options, network_profile, run_time_stats, comm_stats);
     }
     comm_layer->shutdown();
-    print_stats(*options, run_time_stats, comm_stats);
   } catch (std::runtime_error& e) {
     std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
     return EXIT_FAILURE;
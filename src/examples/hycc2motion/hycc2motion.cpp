@@ -40,6 +40,7 @@
 #include "communication/tcp_transport.h"
 #include "hycc_adapter.h"
 #include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_op.h"
 #include "tensor/tensor_op_factory.h"
@@ -60,6 +61,7 @@ struct Options {
   std::size_t my_id;
   MOTION::Communication::tcp_parties_config tcp_config;
   std::string circuit_path;
+  bool release_dead_wires = false;
   bool no_run = false;
 };
 
@@ -82,7 +84,9 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
     ("sync-between-setup-and-online", po::bool_switch()->default_value(false),
      "run a synchronization protocol before the online phase starts")
     ("no-run", po::bool_switch()->default_value(false),
-     "just build the network, but not execute it")
+     "just build the network and print its analysis, but not execute it")
+    ("release-dead-wires", po::bool_switch()->default_value(false),
+     "drop the loader's references to wires once their last reader is built (for large circuits)")
     ("circuit", po::value<std::string>()->required(), "path to a HyCC circuit file");
   // clang-format on
 
@@ -112,6 +116,7 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.num_simd = vm["num-simd"].as<std::size_t>();
   options.sync_between_setup_and_online = vm["sync-between-setup-and-online"].as<bool>();
   options.no_run = vm["no-run"].as<bool>();
+  options.release_dead_wires = vm["release-dead-wires"].as<bool>();
   if (options.my_id > 1) {
     std::cerr << "my-id must be one of 0 and 1\n";
     return std::nullopt;
@@ -240,10 +245,12 @@ void run_model(const Options& options, MOTION::TwoPartyBackend& backend,
   MOTION::hycc::HyCCAdapter hycc_adapter(options.my_id, backend, options.arithmetic_protocol,
                                          options.boolean_protocol, MOTION::MPCProtocol::Yao,
                                          options.num_simd, logger);
+  hycc_adapter.set_release_dead_wires(options.release_dead_wires);
   hycc_adapter.load_circuit(options.circuit_path);
   hycc_adapter.clear_hycc_data();
 
   if (options.no_run) {
+    std::cout << backend.analyze_circuit().print_human_readable();
     return;
   }
 
@@ -0,0 +1,309 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+// Cryptography and Privacy Engineering Group (ENCRYPTO)
+// TU Darmstadt, Germany
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+
+// Measures the costs of the primitives between two parties on the target machines and writes
+// them as a machine profile, i.e., a JSON file which ProtocolCostModel::load_calibration() reads:
+// the network, the AES throughput, the providers (triples and OTs per second), and the time and
+// communication per SIMD value of the operations and conversions.  The operations are run with
+// the code of benchmark_operations, the providers with the one of benchmark_providers.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <vector>
+
+#include <fmt/format.h>
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/json.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include "base/party.h"
+#include "benchmark_operations/common/benchmark.h"
+#include "benchmark_providers/common/benchmark_providers.h"
+#include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
+#include "communication/tcp_transport.h"
+#include "communication/transport.h"
+#include "crypto/aes/aesni_primitives.h"
+#include "statistics/run_time_stats.h"
+#include "utility/runtime_info.h"
+#include "utility/typedefs.h"
+
+namespace po = boost::program_options;
+namespace json = boost::json;
+
+using StatID = MOTION::Statistics::RunTimeStats::StatID;
+
+// increased on incompatible changes of the machine profile
+constexpr std::size_t profile_version = 1;
+
+bool CheckPartyArgumentSyntax(const std::string& p);
+
+std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]);
+
+MOTION::PartyPtr CreateParty(const po::variables_map& vm);
+
+// time and bytes sent by this party of one run
+struct Measurement {
+  double seconds;
+  double bytes_sent;
+};
+
+template <typename F>
+Measurement Measure(const po::variables_map& vm, F&& run) {
+  MOTION::PartyPtr party{CreateParty(vm)};
+  const auto stats = run(party);
+  const auto& [start, end] = stats.get(StatID::evaluate);
+  double bytes_sent = 0;
+  for (const auto& transport_stats : party->get_communication_layer().get_transport_statistics()) {
+    bytes_sent += static_cast<double>(transport_stats.num_bytes_sent);
+  }
+  return {std::chrono::duration<double>(end - start).count(), bytes_sent};
+}
+
+// AES-128 blocks per second in counter mode on a single core
+double MeasureAES(std::size_t num_blocks) {
+  alignas(16) std::array<std::byte, aes_round_keys_size_128> round_keys{};
+  aesni_key_expansion_128(round_keys.data());
+  std::vector<std::byte, boost::alignment::aligned_allocator<std::byte, 16>> output(
+      num_blocks * aes_block_size);
+  std::uint64_t counter = 0;
+  const auto start = std::chrono::steady_clock::now();
+  aesni_ctr_stream_blocks_128(round_keys.data(), &counter, output.data(), num_blocks);
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_blocks) / duration.count();
+}
+
+int main(int ac, char* av[]) {
+  auto [vm, help_flag] = ParseProgramOptions(ac, av);
+  // if help flag is set - print allowed command line arguments and exit
+  if (help_flag) return EXIT_SUCCESS;
+
+  const auto num_simd{vm["num-simd"].as<std::size_t>()};
+  const auto batch_size{vm["batch-size"].as<std::size_t>()};
+  const auto bit_sizes{vm["bit-sizes"].as<std::vector<std::size_t>>()};
+  // the fixed costs, e.g., the rounds, cancel out in the difference of two runs
+  const auto num_simd_small = std::max<std::size_t>(num_simd / 10, 1);
+  if (num_simd_small >= num_simd) {
+    throw std::runtime_error("need --num-simd of at least 2");
+  }
+
+  json::object profile;
+  profile["version"] = profile_version;
+  profile["hostname"] = MOTION::get_hostname();
+  profile["timestamp"] = MOTION::get_timestamp();
+
+  MOTION::Communication::NetworkProfile network;
+  {
+    MOTION::PartyPtr party{CreateParty(vm)};
+    network = party->get_communication_layer().measure_network();
+  }
+  profile["network"] = json::object({{"round_trip_time_us", network.round_trip_time.count()},
+                                     {"bandwidth", network.bandwidth}});
+  std::cout << fmt::format("Network: {}\n", MOTION::Communication::to_string(network));
+
+  const auto aes_blocks_per_second = MeasureAES(batch_size);
+  profile["aes_blocks_per_second"] = aes_blocks_per_second;
+  std::cout << fmt::format("AES: {:.0f} blocks/s\n", aes_blocks_per_second);
+
+  // triples and OTs per second
+  struct ProviderCombination {
+    Provider provider_;
+    std::size_t bit_size_;
+  };
+  const std::vector<ProviderCombination> provider_combinations = {
+      {AMT, 8}, {AMT, 16}, {AMT, 32}, {AMT, 64}, {BMT, 1},    {SB, 32},
+      {SP, 32}, {GOT, 128}, {XCOT, 128}, {ACOT, 64}, {ROT, 128}};
+  json::array providers;
+  for (const auto& [provider, bit_size] : provider_combinations) {
+    const auto measurement = Measure(vm, [&](auto& party) {
+      return BenchmarkProvider(party, batch_size, provider, bit_size);
+    });
+    const auto per_second = static_cast<double>(batch_size) / measurement.seconds;
+    providers.emplace_back(json::object({{"provider", ToString(provider)},
+                                         {"bit_size", bit_size},
+                                         {"per_second", per_second},
+                                         {"bits", 8 * measurement.bytes_sent / batch_size}}));
+    std::cout << fmt::format("Provider {} bit size {}: {:.0f}/s\n", ToString(provider), bit_size,
+                             per_second);
+  }
+  profile["providers"] = std::move(providers);
+
+  // time and communication per SIMD value, without the fixed costs, where the compute time is
+  // what remains after sending the bits with the measured bandwidth
+  const auto measure_per_simd = [&](MOTION::MPCProtocol protocol,
+                                    ENCRYPTO::PrimitiveOperationType op, std::size_t bit_size) {
+    const auto run = [&](std::size_t n) {
+      return Measure(vm, [&](auto& party) {
+        return EvaluateProtocol(party, n, bit_size, protocol, op);
+      });
+    };
+    const auto small = run(num_simd_small);
+    const auto large = run(num_simd);
+    const auto n = static_cast<double>(num_simd - num_simd_small);
+    const auto seconds = std::max((large.seconds - small.seconds) / n, 0.0);
+    const auto bits = std::max(8 * (large.bytes_sent - small.bytes_sent) / n, 0.0);
+    auto compute_seconds = seconds;
+    if (network.bandwidth > 0) {
+      compute_seconds = std::max(seconds - bits / static_cast<double>(network.bandwidth), 0.0);
+    }
+    std::cout << fmt::format("Protocol {} operation {} bit size {}: {:.3f} us and {:.1f} bits per "
+                             "SIMD value\n",
+                             MOTION::ToString(protocol), ENCRYPTO::ToString(op), bit_size,
+                             seconds * 1e6, bits);
+    return json::object({{"bit_size", bit_size},
+                         {"bits", bits},
+                         {"compute_time_us", compute_seconds * 1e6},
+                         {"per_second", seconds > 0 ? 1 / seconds : 0.0}});
+  };
+
+  using T = ENCRYPTO::PrimitiveOperationType;
+  using P = MOTION::MPCProtocol;
+  json::array operations;
+  json::array conversions;
+  for (const auto bit_size : bit_sizes) {
+    for (const auto [protocol, op] :
+         {std::pair{P::BooleanGMW, T::XOR}, {P::BooleanGMW, T::AND}, {P::BMR, T::XOR},
+          {P::BMR, T::AND}, {P::ArithmeticGMW, T::ADD}, {P::ArithmeticGMW, T::MUL}}) {
+      auto entry = measure_per_simd(protocol, op, bit_size);
+      entry["operation"] = ENCRYPTO::ToString(op);
+      entry["protocol"] = MOTION::ToString(protocol);
+      operations.emplace_back(std::move(entry));
+    }
+    // conversions from the protocol of the inputs to the one of the outputs
+    for (const auto [src, op, dst] :
+         {std::tuple{P::BooleanGMW, T::B2A, P::ArithmeticGMW},
+          {P::BooleanGMW, T::B2Y, P::BMR},
+          {P::BMR, T::Y2A, P::ArithmeticGMW},
+          {P::BMR, T::Y2B, P::BooleanGMW},
+          {P::ArithmeticGMW, T::A2B, P::BooleanGMW},
+          {P::ArithmeticGMW, T::A2Y, P::BMR}}) {
+      auto entry = measure_per_simd(src, op, bit_size);
+      entry["source"] = MOTION::ToString(src);
+      entry["destination"] = MOTION::ToString(dst);
+      conversions.emplace_back(std::move(entry));
+    }
+  }
+  profile["operations"] = std::move(operations);
+  profile["conversions"] = std::move(conversions);
+
+  const auto path = vm["output"].as<std::string>();
+  std::ofstream file(path);
+  file << json::serialize(profile) << '\n';
+  if (!file) {
+    throw std::runtime_error(fmt::format("could not write {}", path));
+  }
+  std::cout << fmt::format("Wrote machine profile to {}\n", path);
+  return EXIT_SUCCESS;
+}
+
+const std::regex party_argument_re("(\\d+),(\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}),(\\d{1,5})");
+
+bool CheckPartyArgumentSyntax(const std::string& p) {
+  // other party's id, IP address, and port
+  return std::regex_match(p, party_argument_re);
+}
+
+std::tuple<std::size_t, std::string, std::uint16_t> ParsePartyArgument(const std::string& p) {
+  std::smatch match;
+  std::regex_match(p, match, party_argument_re);
+  auto id = boost::lexical_cast<std::size_t>(match[1]);
+  auto host = match[2];
+  auto port = boost::lexical_cast<std::uint16_t>(match[3]);
+  return {id, host, port};
+}
+
+// <variables map, help flag>
+std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]) {
+  bool help;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+      ("help,h", po::bool_switch(&help)->default_value(false),"produce help message")
+      ("disable-logging,l","disable logging to file")
+      ("my-id", po::value<std::size_t>(), "my party id")
+      ("other-parties", po::value<std::vector<std::string>>()->multitoken(), "(other party id, IP, port, my role), e.g., --other-parties 1,127.0.0.1,7777")
+      ("num-simd", po::value<std::size_t>()->default_value(10000), "number of SIMD values of the operations, they are also run with a tenth of it to remove the fixed costs")
+      ("bit-sizes", po::value<std::vector<std::size_t>>()->multitoken()->default_value({32}, "32"), "bit sizes of the values of the operations: 8, 16, 32 or 64")
+      ("batch-size", po::value<std::size_t>()->default_value(100000), "number of triples and OTs of the providers and of AES blocks")
+      ("output,o", po::value<std::string>()->default_value("machine_profile.json"), "path of the machine profile");
+  // clang-format on
+
+  po::variables_map vm;
+
+  po::store(po::parse_command_line(ac, av, desc), vm);
+  po::notify(vm);
+
+  if (help) {
+    std::cout << desc << "\n";
+    return std::make_pair<po::variables_map, bool>({}, true);
+  }
+
+  if (!vm.count("my-id")) {
+    throw std::runtime_error("My id is not set but required");
+  }
+  if (vm.count("other-parties")) {
+    for (auto& p : vm["other-parties"].as<std::vector<std::string>>()) {
+      if (!CheckPartyArgumentSyntax(p)) {
+        throw std::runtime_error("Incorrect party argument syntax " + p);
+      }
+    }
+  } else {
+    throw std::runtime_error("Other parties' information is not set but required");
+  }
+  return std::make_pair(vm, help);
+}
+
+MOTION::PartyPtr CreateParty(const po::variables_map& vm) {
+  const auto parties_str{vm["other-parties"].as<const std::vector<std::string>>()};
+  const auto num_parties{parties_str.size()};
+  const auto my_id{vm["my-id"].as<std::size_t>()};
+  if (my_id >= num_parties) {
+    throw std::runtime_error(fmt::format(
+        "My id needs to be in the range [0, #parties - 1], current my id is {} and #parties is {}",
+        my_id, num_parties));
+  }
+
+  MOTION::Communication::tcp_parties_config parties_config(num_parties);
+
+  for (const auto& party_str : parties_str) {
+    const auto [party_id, host, port] = ParsePartyArgument(party_str);
+    if (party_id >= num_parties) {
+      throw std::runtime_error(
+          fmt::format("Party's id needs to be in the range [0, #parties - 1], current id "
+                      "is {} and #parties is {}",
+                      party_id, num_parties));
+    }
+    parties_config.at(party_id) = std::make_pair(host, port);
+  }
+  MOTION::Communication::TCPSetupHelper helper(my_id, parties_config);
+  auto comm_layer = std::make_unique<MOTION::Communication::CommunicationLayer>(
+      my_id, helper.setup_connections());
+  auto party = std::make_unique<MOTION::Party>(std::move(comm_layer));
+  auto config = party->GetConfiguration();
+  // disable logging if the corresponding flag was set
+  const auto logging{!vm.count("disable-logging")};
+  config->SetLoggingEnabled(logging);
+  return party;
+}
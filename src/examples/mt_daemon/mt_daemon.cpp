@@ -0,0 +1,250 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Generates multiplication triples in the background and publishes them in an MTStore, from
+// where the MOTION processes of the same party on this machine take them, e.g.,
+//
+//   mt_daemon --my-id 0 --party 0,127.0.0.1,7777 --party 1,127.0.0.1,7778 \
+//       --store /dev/shm/motion_mts_0 --binary-mts 1000000 --arithmetic-mts 100000
+//
+// and in each process
+//
+//   MOTION::MTStoreReader store_reader("/dev/shm/motion_mts_0", my_id);
+//   store_reader.take(backend.get_mt_reservoir(), std::chrono::seconds(10));
+//
+// before building the circuit.  Both daemons need the same batch sizes, and both parties need
+// to start the same number of consumers with matching start batches and strides.
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "communication/tcp_transport.h"
+#include "crypto/multiplication_triple/mt_provider.h"
+#include "data_storage/mt_store.h"
+#include "utility/logger.h"
+
+namespace po = boost::program_options;
+
+struct Options {
+  std::size_t threads;
+  std::size_t my_id;
+  MOTION::Communication::tcp_parties_config tcp_config;
+  std::filesystem::path store;
+  std::size_t first_batch;
+  // 0 runs until the daemon is stopped
+  std::size_t num_batches;
+  std::size_t max_available;
+  std::size_t binary_mts;
+  std::size_t arithmetic_mts;
+  std::size_t bit_size;
+};
+
+std::optional<Options> parse_program_options(int argc, char* argv[]) {
+  Options options;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+    ("help,h", po::bool_switch()->default_value(false),"produce help message")
+    ("config-file", po::value<std::string>(), "config file containing options")
+    ("my-id", po::value<std::size_t>()->required(), "my party id")
+    ("party", po::value<std::vector<std::string>>()->multitoken(),
+     "(party id, IP, port), e.g., --party 1,127.0.0.1,7777")
+    ("threads", po::value<std::size_t>()->default_value(0), "number of threads to use")
+    ("store", po::value<std::string>(),
+     "directory of the MT store (default: /dev/shm/motion_mts_<my-id>)")
+    ("first-batch", po::value<std::size_t>()->default_value(0), "id of the first batch")
+    ("batches", po::value<std::size_t>()->default_value(0),
+     "number of batches to generate (0: until stopped)")
+    ("max-available", po::value<std::size_t>()->default_value(4),
+     "pause while this many batches have not been taken")
+    ("binary-mts", po::value<std::size_t>()->default_value(0), "binary MTs per batch")
+    ("arithmetic-mts", po::value<std::size_t>()->default_value(0), "arithmetic MTs per batch")
+    ("bit-size", po::value<std::size_t>()->default_value(64),
+     "bit size of the arithmetic MTs (8, 16, 32, 64)")
+    ;
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  bool help = vm["help"].as<bool>();
+  if (help) {
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+  if (vm.count("config-file")) {
+    std::ifstream ifs(vm["config-file"].as<std::string>().c_str());
+    po::store(po::parse_config_file(ifs, desc), vm);
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << e.what() << "\n\n";
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+
+  options.my_id = vm["my-id"].as<std::size_t>();
+  if (options.my_id > 1) {
+    std::cerr << "my-id must be one of 0 and 1\n";
+    return std::nullopt;
+  }
+  options.threads = vm["threads"].as<std::size_t>();
+  options.store = vm.count("store") ? vm["store"].as<std::string>()
+                                    : fmt::format("/dev/shm/motion_mts_{}", options.my_id);
+  options.first_batch = vm["first-batch"].as<std::size_t>();
+  options.num_batches = vm["batches"].as<std::size_t>();
+  options.max_available = std::max<std::size_t>(1, vm["max-available"].as<std::size_t>());
+  options.binary_mts = vm["binary-mts"].as<std::size_t>();
+  options.arithmetic_mts = vm["arithmetic-mts"].as<std::size_t>();
+  options.bit_size = vm["bit-size"].as<std::size_t>();
+  if (options.bit_size != 8 && options.bit_size != 16 && options.bit_size != 32 &&
+      options.bit_size != 64) {
+    std::cerr << "invalid bit size: " << options.bit_size << "\n";
+    return std::nullopt;
+  }
+  if (options.binary_mts == 0 && options.arithmetic_mts == 0) {
+    std::cerr << "need --binary-mts or --arithmetic-mts\n";
+    return std::nullopt;
+  }
+
+  const auto parse_party_argument =
+      [](const auto& s) -> std::pair<std::size_t, MOTION::Communication::tcp_connection_config> {
+    const static std::regex party_argument_re("([01]),([^,]+),(\\d{1,5})");
+    std::smatch match;
+    if (!std::regex_match(s, match, party_argument_re)) {
+      throw std::invalid_argument("invalid party argument");
+    }
+    auto id = boost::lexical_cast<std::size_t>(match[1]);
+    auto host = match[2];
+    auto port = boost::lexical_cast<std::uint16_t>(match[3]);
+    return {id, {host, port}};
+  };
+
+  const std::vector<std::string> party_infos = vm["party"].as<std::vector<std::string>>();
+  if (party_infos.size() != 2) {
+    std::cerr << "expecting two --party options\n";
+    return std::nullopt;
+  }
+
+  options.tcp_config.resize(2);
+  const auto [id0, conn_info0] = parse_party_argument(party_infos[0]);
+  const auto [id1, conn_info1] = parse_party_argument(party_infos[1]);
+  if (id0 == id1) {
+    std::cerr << "need party arguments for party 0 and 1\n";
+    return std::nullopt;
+  }
+  options.tcp_config[id0] = conn_info0;
+  options.tcp_config[id1] = conn_info1;
+
+  return options;
+}
+
+std::unique_ptr<MOTION::Communication::CommunicationLayer> setup_communication(
+    const Options& options) {
+  MOTION::Communication::TCPSetupHelper helper(options.my_id, options.tcp_config);
+  return std::make_unique<MOTION::Communication::CommunicationLayer>(options.my_id,
+                                                                     helper.setup_connections());
+}
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void set_capacities(const Options& options, MOTION::MTReservoir& reservoir) {
+  reservoir.SetCapacity<bool>(options.binary_mts);
+  switch (options.bit_size) {
+    case 8:
+      reservoir.SetCapacity<std::uint8_t>(options.arithmetic_mts);
+      break;
+    case 16:
+      reservoir.SetCapacity<std::uint16_t>(options.arithmetic_mts);
+      break;
+    case 32:
+      reservoir.SetCapacity<std::uint32_t>(options.arithmetic_mts);
+      break;
+    case 64:
+      reservoir.SetCapacity<std::uint64_t>(options.arithmetic_mts);
+      break;
+  }
+}
+
+void run_daemon(const Options& options, MOTION::Communication::CommunicationLayer& comm_layer,
+                MOTION::TwoPartyBackend& backend) {
+  MOTION::MTStoreWriter store_writer(options.store, options.my_id, options.first_batch);
+  auto& reservoir = backend.get_mt_reservoir();
+  set_capacities(options, reservoir);
+  for (std::size_t batch_i = 0; options.num_batches == 0 || batch_i < options.num_batches;
+       ++batch_i) {
+    // both parties need to pause and stop in the same round
+    while (!stop_requested && store_writer.get_num_available() >= options.max_available) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    comm_layer.sync();
+    if (stop_requested) {
+      break;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    backend.refill_mt_reservoir();
+    const auto batch_id = store_writer.publish(reservoir);
+    const std::chrono::duration<double, std::milli> duration =
+        std::chrono::steady_clock::now() - start;
+    std::cout << fmt::format("published batch {} in {:.3f} ms\n", batch_id, duration.count());
+  }
+}
+
+int main(int argc, char* argv[]) {
+  auto options = parse_program_options(argc, argv);
+  if (!options.has_value()) {
+    return EXIT_FAILURE;
+  }
+  std::signal(SIGINT, [](int) { stop_requested = 1; });
+  std::signal(SIGTERM, [](int) { stop_requested = 1; });
+
+  try {
+    auto comm_layer = setup_communication(*options);
+    auto logger = std::make_shared<MOTION::Logger>(options->my_id,
+                                                   boost::log::trivial::severity_level::trace);
+    comm_layer->set_logger(logger);
+    MOTION::TwoPartyBackend backend(*comm_layer, options->threads, false, logger);
+    run_daemon(*options, *comm_layer, backend);
+    comm_layer->shutdown();
+  } catch (std::runtime_error& e) {
+    std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
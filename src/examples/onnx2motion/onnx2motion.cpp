@@ -22,28 +22,33 @@
 
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <optional>
 #include <regex>
 #include <stdexcept>
 #include <string>
 
+#include <boost/accumulators/statistics/mean.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/json/serialize.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/program_options.hpp>
+#include <fmt/format.h>
 
 #include "base/two_party_tensor_backend.h"
 #include "communication/communication_layer.h"
 #include "communication/tcp_transport.h"
 #include "onnx_adapter.h"
 #include "statistics/analysis.h"
+#include "tensor/model_session.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_op.h"
 #include "tensor/tensor_op_factory.h"
 #include "utility/helpers.h"
+#include "utility/linear_algebra.h"
 #include "utility/logger.h"
 #include "utility/typedefs.h"
 
@@ -63,6 +68,18 @@ struct Options {
   std::string model_path;
   bool no_run = false;
   bool fake_triples = false;
+  // batch sizes to evaluate the model with, 0 to use the one of the model
+  std::vector<std::size_t> batch_sizes;
+  // run the setup of the layers at most this many layers ahead of the online phase, 0 disables it
+  std::size_t pipeline_lookahead = 0;
+  // the model provider shares the weights of the model layer by layer during the evaluation
+  bool stream_weights = false;
+  // share the weights only in the first run and keep their shares and spare triples for the others
+  bool reuse_weights = false;
+  // free the activations of a layer once the following layers have read them
+  bool memory_planning = false;
+  // run the products with at least this many multiplications on the GPU, 0 disables it
+  std::size_t gpu_min_work = 0;
 };
 
 std::optional<Options> parse_program_options(int argc, char* argv[]) {
@@ -90,6 +107,18 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
      "just build the network, but not execute it")
     ("fake-triples", po::bool_switch()->default_value(false),
      "use random data instead of generating valid Beaver triples")
+    ("pipeline-lookahead", po::value<std::size_t>()->default_value(0),
+     "overlap the setup of the next layers with the online phase, running at most this many ahead")
+    ("stream-weights", po::bool_switch()->default_value(false),
+     "share the weights stored in the model layer by layer instead of random ones before the run")
+    ("reuse-weights", po::bool_switch()->default_value(false),
+     "share the weights once and reuse them and the triples generated ahead in later repetitions")
+    ("memory-planning", po::bool_switch()->default_value(false),
+     "release the intermediate tensors after their last use instead of at the end of the run")
+    ("gpu-min-work", po::value<std::size_t>()->default_value(0),
+     "run convolutions and matrix products with at least this many multiplications on the GPU")
+    ("batch-size", po::value<std::vector<std::size_t>>()->multitoken(),
+     "number of samples evaluated at once, e.g., --batch-size 1 8 32 to compare their throughput")
     ("model", po::value<std::string>()->required(), "path to a model file in ONNX format");
   // clang-format on
 
@@ -121,6 +150,28 @@ std::optional<Options> parse_program_options(int argc, char* argv[]) {
   options.fractional_bits = vm["fractional-bits"].as<std::size_t>();
   options.no_run = vm["no-run"].as<bool>();
   options.fake_triples = vm["fake-triples"].as<bool>();
+  options.pipeline_lookahead = vm["pipeline-lookahead"].as<std::size_t>();
+  options.stream_weights = vm["stream-weights"].as<bool>();
+  options.reuse_weights = vm["reuse-weights"].as<bool>();
+  options.memory_planning = vm["memory-planning"].as<bool>();
+  options.gpu_min_work = vm["gpu-min-work"].as<std::size_t>();
+  if (options.gpu_min_work > 0 && !MOTION::is_linear_algebra_gpu_available()) {
+    std::cerr << "no GPU available, build with MOTION_USE_CUDA to use --gpu-min-work\n";
+    return std::nullopt;
+  }
+  if (options.reuse_weights && options.no_run) {
+    std::cerr << "cannot reuse the weights without running the network\n";
+    return std::nullopt;
+  }
+  if (options.pipeline_lookahead > 0 && options.sync_between_setup_and_online) {
+    std::cerr << "cannot synchronize between setup and online phase with a pipeline lookahead\n";
+    return std::nullopt;
+  }
+  if (vm.count("batch-size")) {
+    options.batch_sizes = vm["batch-size"].as<std::vector<std::size_t>>();
+  } else {
+    options.batch_sizes = {0};
+  }
   if (options.my_id > 1) {
     std::cerr << "my-id must be one of 0 and 1\n";
     return std::nullopt;
@@ -215,29 +266,66 @@ void collect_outputs(MOTION::onnx::OnnxAdapter& onnx_adapter) {
   get_futures(std::uint64_t{});
 }
 
-void run_model(const Options& options, MOTION::TwoPartyTensorBackend& backend) {
+// returns the number of samples the model is evaluated on, the statistics of streaming the
+// weights are appended to `weight_streaming_stats`
+std::size_t run_model(const Options& options, std::size_t batch_size,
+                      MOTION::TwoPartyTensorBackend& backend,
+                      MOTION::tensor::ModelSession* model_session,
+                      std::vector<MOTION::onnx::WeightStreamingStats>& weight_streaming_stats) {
+  const bool is_model_provider = options.my_id == 0;
   MOTION::onnx::OnnxAdapter onnx_adapter(backend, options.arithmetic_protocol,
                                          options.boolean_protocol, options.bit_size,
-                                         options.fractional_bits, options.my_id == 0);
+                                         options.fractional_bits, is_model_provider);
+  onnx_adapter.set_batch_size(batch_size);
+  onnx_adapter.set_weight_streaming(options.stream_weights);
+  if (model_session != nullptr) {
+    model_session->attach(backend);
+    onnx_adapter.set_model_session(model_session);
+  }
   onnx_adapter.load_model(options.model_path);
 
   if (options.no_run) {
-    return;
+    return onnx_adapter.get_batch_size();
   }
 
   set_inputs(onnx_adapter);
 
-  backend.run();
+  if (options.stream_weights && is_model_provider) {
+    auto streaming =
+        std::async(std::launch::async, [&onnx_adapter] { return onnx_adapter.stream_weights(); });
+    backend.run();
+    weight_streaming_stats.push_back(streaming.get());
+  } else {
+    backend.run();
+  }
 
   if (options.my_id == 1) {
     collect_outputs(onnx_adapter);
   }
+  return onnx_adapter.get_batch_size();
 }
 
-void print_stats(const Options& options,
+void print_stats(const Options& options, std::size_t batch_size,
                  const MOTION::Statistics::AccumulatedRunTimeStats& run_time_stats,
-                 const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats) {
+                 const MOTION::Statistics::AccumulatedCommunicationStats& comm_stats,
+                 const std::vector<MOTION::onnx::WeightStreamingStats>& weight_streaming_stats) {
   const auto filename = std::filesystem::path(options.model_path).filename();
+  // samples per second of the whole evaluation and of the online phase
+  const auto get_throughput = [batch_size, &run_time_stats](auto stat_id) {
+    const auto& acc = run_time_stats.accumulators_[static_cast<std::size_t>(stat_id)];
+    return 1000.0 * double(batch_size) / boost::accumulators::mean(acc);
+  };
+  using StatID = MOTION::Statistics::RunTimeStats::StatID;
+  const auto throughput = get_throughput(StatID::evaluate);
+  const auto online_throughput = get_throughput(StatID::gates_online);
+  // mean over the repetitions in milliseconds
+  const auto get_mean_ms = [&weight_streaming_stats](auto member) {
+    double sum = 0;
+    for (const auto& stats : weight_streaming_stats) {
+      sum += std::chrono::duration<double, std::milli>(stats.*member).count();
+    }
+    return sum / weight_streaming_stats.size();
+  };
   if (options.json) {
     auto obj = MOTION::Statistics::to_json(filename, run_time_stats, comm_stats);
     obj.emplace("party_id", options.my_id);
@@ -247,9 +335,34 @@ void print_stats(const Options& options,
     obj.emplace("boolean_protocol", MOTION::ToString(options.boolean_protocol));
     obj.emplace("model_path", options.model_path);
     obj.emplace("fake_triples", options.fake_triples);
+    obj.emplace("pipeline_lookahead", options.pipeline_lookahead);
+    obj.emplace("reuse_weights", options.reuse_weights);
+    obj.emplace("memory_planning", options.memory_planning);
+    obj.emplace("gpu_min_work", options.gpu_min_work);
+    obj.emplace("batch_size", batch_size);
+    obj.emplace("throughput", throughput);
+    obj.emplace("online_throughput", online_throughput);
+    if (!weight_streaming_stats.empty()) {
+      obj.emplace("time_to_first_layer_ms",
+                  get_mean_ms(&MOTION::onnx::WeightStreamingStats::time_to_first_layer));
+      obj.emplace("weight_streaming_ms",
+                  get_mean_ms(&MOTION::onnx::WeightStreamingStats::total_time));
+      obj.emplace("max_plaintext_weight_bytes", weight_streaming_stats.back().max_plaintext_bytes);
+    }
     std::cout << obj << "\n";
   } else {
     std::cout << MOTION::Statistics::print_stats(filename, run_time_stats, comm_stats);
+    std::cout << fmt::format("batch size {}: {:.2f} samples/s ({:.2f} samples/s online)\n",
+                             batch_size, throughput, online_throughput);
+    if (!weight_streaming_stats.empty()) {
+      std::cout << fmt::format(
+          "streamed {} weight tensors: {:.3f} ms to the first layer, {:.3f} ms in total, at most "
+          "{} bytes of plaintext\n",
+          weight_streaming_stats.back().num_tensors,
+          get_mean_ms(&MOTION::onnx::WeightStreamingStats::time_to_first_layer),
+          get_mean_ms(&MOTION::onnx::WeightStreamingStats::total_time),
+          weight_streaming_stats.back().max_plaintext_bytes);
+    }
   }
 }
 
@@ -264,20 +377,34 @@ int main(int argc, char* argv[]) {
     auto logger = std::make_shared<MOTION::Logger>(options->my_id,
                                                    boost::log::trivial::severity_level::trace);
     comm_layer->set_logger(logger);
-    MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
-    MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
-    for (std::size_t i = 0; i < options->num_repetitions; ++i) {
-      MOTION::TwoPartyTensorBackend backend(*comm_layer, options->threads,
-                                            options->sync_between_setup_and_online, logger,
-                                            options->fake_triples);
-      run_model(*options, backend);
-      comm_layer->sync();
-      comm_stats.add(comm_layer->get_transport_statistics());
-      comm_layer->reset_transport_statistics();
-      run_time_stats.add(backend.get_run_time_stats());
+    MOTION::set_linear_algebra_gpu_min_work(options->gpu_min_work);
+    // the weights do not depend on the batch size, so all runs share them
+    std::optional<MOTION::tensor::ModelSession> model_session;
+    if (options->reuse_weights) {
+      model_session.emplace(options->num_repetitions - 1);
+    }
+    for (const auto requested_batch_size : options->batch_sizes) {
+      MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+      MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
+      std::vector<MOTION::onnx::WeightStreamingStats> weight_streaming_stats;
+      std::size_t batch_size = 1;
+      for (std::size_t i = 0; i < options->num_repetitions; ++i) {
+        MOTION::TwoPartyTensorBackend backend(*comm_layer, options->threads,
+                                              options->sync_between_setup_and_online, logger,
+                                              options->fake_triples);
+        backend.set_pipelined_execution(options->pipeline_lookahead);
+        backend.set_memory_planning(options->memory_planning);
+        batch_size =
+            run_model(*options, requested_batch_size, backend,
+                      model_session.has_value() ? &*model_session : nullptr, weight_streaming_stats);
+        comm_layer->sync();
+        comm_stats.add(comm_layer->get_transport_statistics());
+        comm_layer->reset_transport_statistics();
+        run_time_stats.add(backend.get_run_time_stats());
+      }
+      print_stats(*options, batch_size, run_time_stats, comm_stats, weight_streaming_stats);
     }
     comm_layer->shutdown();
-    print_stats(*options, run_time_stats, comm_stats);
   } catch (std::runtime_error& e) {
     std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
     return EXIT_FAILURE;
@@ -0,0 +1,281 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// End-to-end performance regression suite of the pattern matching pipelines.  Every combination
+// of query type (exact, wildcard, approximate) and pipeline (HAM/EQEXP, MSG) is run with both
+// parties in this process, connected by dummy transports, at fixed text and pattern sizes.  Per
+// case, the suite records the median time and the peak memory growth of each phase, the bytes
+// and messages sent by both parties, the online rounds of the circuit, and, if the library is
+// built with MOTION_GATE_PROFILING, the time and bytes of each gate type, all per query.
+//
+// The measurements are compared with a baseline file (see Statistics::PerformanceBaseline) and
+// the program exits with a non-zero status if a metric exceeds its tolerance, listing the
+// regressed metrics of the phases and of the gate types.  --write-baseline stores the
+// measurements as the new baseline instead, which should be done on the machine that runs the
+// suite, since the times and memory are only comparable on the same machine.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "algorithm/pattern_matcher.h"
+#include "communication/communication_layer.h"
+#include "communication/transport.h"
+#include "statistics/analysis.h"
+#include "statistics/performance_baseline.h"
+#include "statistics/run_time_stats.h"
+#include "utility/constants.h"
+#include "utility/logger.h"
+
+namespace po = boost::program_options;
+
+using MOTION::PatternMatchingPipeline;
+using MOTION::PatternMatchingType;
+using StatID = MOTION::Statistics::RunTimeStats::StatID;
+
+struct RegressionCase {
+  PatternMatchingType type;
+  PatternMatchingPipeline pipeline;
+  std::size_t text_size;
+  std::size_t pattern_size;
+
+  std::string get_name() const {
+    const auto type_name = type == PatternMatchingType::exact      ? "exact"
+                           : type == PatternMatchingType::wildcard ? "wildcard"
+                                                                   : "approximate";
+    const auto pipeline_name = pipeline == PatternMatchingPipeline::msg ? "msg" : "ham_eqexp";
+    return fmt::format("{}/{}/{}x{}", type_name, pipeline_name, text_size, pattern_size);
+  }
+};
+
+std::vector<RegressionCase> make_cases() {
+  std::vector<RegressionCase> cases;
+  for (auto type : {PatternMatchingType::exact, PatternMatchingType::wildcard,
+                    PatternMatchingType::approximate}) {
+    for (auto pipeline : {PatternMatchingPipeline::ham_eqexp, PatternMatchingPipeline::msg}) {
+      for (auto [text_size, pattern_size] : {std::pair<std::size_t, std::size_t>{1024, 8},
+                                             std::pair<std::size_t, std::size_t>{16384, 32}}) {
+        cases.push_back({type, pipeline, text_size, pattern_size});
+      }
+    }
+  }
+  return cases;
+}
+
+// the statistics of the pattern owner and the communication of both parties
+struct CaseResult {
+  MOTION::PatternMatchingStatistics statistics;
+  std::size_t bytes_sent = 0;
+  std::size_t messages_sent = 0;
+};
+
+CaseResult run_case(const RegressionCase& c, std::size_t bits_per_character,
+                    std::size_t num_repetitions, std::size_t num_threads) {
+  // the same inputs in every run of the suite
+  std::mt19937_64 rng(c.text_size * 1000 + c.pattern_size);
+  std::uniform_int_distribution<std::uint64_t> dist(0,
+                                                     (std::uint64_t(1) << bits_per_character) - 1);
+  std::vector<std::uint64_t> text(c.text_size);
+  std::generate(std::begin(text), std::end(text), [&] { return dist(rng); });
+  MOTION::PatternQuery query{.type = c.type, .pattern_size = c.pattern_size};
+  query.pipeline = c.pipeline;
+  MOTION::PatternQuery full_query = query;
+  full_query.pattern.assign(std::begin(text) + 100, std::begin(text) + 100 + c.pattern_size);
+  if (c.type == PatternMatchingType::wildcard) {
+    full_query.wildcards.resize(c.pattern_size);
+    for (std::size_t k = 0; k < c.pattern_size; k += 4) {
+      full_query.wildcards[k] = true;
+    }
+  } else if (c.type == PatternMatchingType::approximate) {
+    full_query.threshold = c.pattern_size / 4;
+  }
+
+  auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2, false);
+  std::array<MOTION::PatternMatchingStatistics, 2> statistics;
+  std::vector<std::future<void>> futs;
+  for (std::size_t i = 0; i < 2; ++i) {
+    futs.emplace_back(std::async(std::launch::async, [&, i] {
+      auto logger = std::make_shared<MOTION::Logger>(i, boost::log::trivial::severity_level::error);
+      comm_layers[i]->set_logger(logger);
+      MOTION::PatternMatcher matcher(*comm_layers[i], 0, bits_per_character, num_threads, logger);
+      if (i == matcher.get_text_owner()) {
+        matcher.share_text(text);
+      } else {
+        matcher.share_text(text.size());
+      }
+      // only the queries are measured
+      comm_layers[i]->sync();
+      comm_layers[i]->reset_transport_statistics();
+      for (std::size_t r = 0; r < num_repetitions; ++r) {
+        matcher.add_query(i == matcher.get_pattern_owner() ? full_query : query);
+        matcher.run();
+      }
+      comm_layers[i]->sync();
+      statistics[i] = matcher.get_statistics();
+      comm_layers[i]->shutdown();
+    }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  CaseResult result{.statistics = std::move(statistics[1])};
+  for (const auto& comm_layer : comm_layers) {
+    for (const auto& stats : comm_layer->get_transport_statistics()) {
+      result.bytes_sent += stats.num_bytes_sent;
+      result.messages_sent += stats.num_messages_sent;
+    }
+  }
+  return result;
+}
+
+std::string to_string(StatID id) {
+  switch (id) {
+    case StatID::preprocessing:
+      return "preprocessing";
+    case StatID::gates_setup:
+      return "gates_setup";
+    case StatID::gates_online:
+      return "gates_online";
+    default:
+      return "unknown";
+  }
+}
+
+MOTION::Statistics::PerformanceMetrics get_metrics(const CaseResult& result,
+                                                   std::size_t num_repetitions) {
+  const auto& statistics = result.statistics;
+  const auto& run_time_stats = statistics.run_time_stats;
+  const auto n = static_cast<double>(num_repetitions);
+  MOTION::Statistics::PerformanceMetrics metrics;
+  for (auto id : MOTION::Statistics::RunTimeStats::memory_phases) {
+    const auto phase = to_string(id);
+    metrics[phase + ".time_ms"] = run_time_stats.get_percentile(id, 50);
+    const auto& samples = run_time_stats.memory_samples_.at(static_cast<std::size_t>(id));
+    std::size_t rss_growth = 0;
+    std::size_t tracked_peak = 0;
+    for (const auto& sample : samples) {
+      rss_growth = std::max(rss_growth, sample.peak_rss_growth_bytes_);
+      tracked_peak = std::max(tracked_peak, sample.tracked_peak_bytes_);
+    }
+    metrics[phase + ".peak_rss_growth_bytes"] = static_cast<double>(rss_growth);
+    if constexpr (MOTION::MOTION_MEMORY_TRACKING) {
+      metrics[phase + ".tracked_peak_bytes"] = static_cast<double>(tracked_peak);
+    }
+  }
+  metrics["bytes_sent"] = static_cast<double>(result.bytes_sent) / n;
+  metrics["messages_sent"] = static_cast<double>(result.messages_sent) / n;
+  metrics["online_rounds"] = static_cast<double>(statistics.max_online_rounds);
+  // empty unless MOTION_GATE_PROFILING is enabled
+  for (const auto& [gate_type, entry] : run_time_stats.gate_profile_.by_type_) {
+    const auto prefix = fmt::format("gate.{}.", gate_type);
+    metrics[prefix + "setup_time_ms"] = entry.setup_time_ms_ / n;
+    metrics[prefix + "online_time_ms"] = entry.online_time_ms_ / n;
+    metrics[prefix + "bytes_sent"] = static_cast<double>(entry.num_bytes_sent_) / n;
+  }
+  return metrics;
+}
+
+std::pair<po::variables_map, bool> ParseProgramOptions(int ac, char* av[]) {
+  bool help;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+      ("help,h", po::bool_switch(&help)->default_value(false),"produce help message")
+      ("baseline", po::value<std::string>()->default_value("pattern_matching_baseline.json"), "path of the baseline")
+      ("write-baseline", po::bool_switch()->default_value(false), "store the measurements as the new baseline instead of comparing with it")
+      ("repetitions", po::value<std::size_t>()->default_value(5), "number of queries per case, evaluated one after another")
+      ("threads", po::value<std::size_t>()->default_value(2), "number of threads of each party")
+      ("bits-per-character", po::value<std::size_t>()->default_value(2), "bits of each character of the text");
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(ac, av, desc), vm);
+  if (help) {
+    std::cout << desc << "\n";
+    return std::make_pair<po::variables_map, bool>({}, true);
+  }
+  po::notify(vm);
+  return std::make_pair(vm, false);
+}
+
+int main(int ac, char* av[]) {
+  auto [vm, help_flag] = ParseProgramOptions(ac, av);
+  // if help flag is set - print allowed command line arguments and exit
+  if (help_flag) return EXIT_SUCCESS;
+
+  const auto baseline_path{vm["baseline"].as<std::string>()};
+  const auto write_baseline{vm["write-baseline"].as<bool>()};
+  const auto num_repetitions{vm["repetitions"].as<std::size_t>()};
+  const auto num_threads{vm["threads"].as<std::size_t>()};
+  const auto bits_per_character{vm["bits-per-character"].as<std::size_t>()};
+  if (num_repetitions == 0) {
+    throw std::invalid_argument("need at least one repetition");
+  }
+
+  MOTION::Statistics::PerformanceBaseline baseline;
+  if (std::filesystem::exists(baseline_path)) {
+    baseline = MOTION::Statistics::PerformanceBaseline::load(baseline_path);
+  } else if (!write_baseline) {
+    std::cerr << fmt::format("no baseline at {}, create it with --write-baseline\n",
+                             baseline_path);
+    return EXIT_FAILURE;
+  }
+  if constexpr (!MOTION::MOTION_GATE_PROFILING) {
+    std::cout << "MOTION_GATE_PROFILING is disabled, the gate types are not compared\n";
+  }
+
+  bool regression = false;
+  for (const auto& c : make_cases()) {
+    const auto name = c.get_name();
+    const auto metrics =
+        get_metrics(run_case(c, bits_per_character, num_repetitions, num_threads), num_repetitions);
+    if (write_baseline) {
+      baseline.set_case(name, metrics);
+      std::cout << fmt::format("{}: recorded {} metrics\n", name, metrics.size());
+    } else if (!baseline.has_case(name)) {
+      std::cout << fmt::format("{}: not in the baseline\n", name);
+    } else {
+      const auto comparisons = baseline.compare(name, metrics);
+      regression = regression || MOTION::Statistics::has_regression(comparisons);
+      std::cout << MOTION::Statistics::print_comparison(name, comparisons);
+    }
+  }
+
+  if (write_baseline) {
+    baseline.save(baseline_path);
+    std::cout << fmt::format("baseline written to {}\n", baseline_path);
+    return EXIT_SUCCESS;
+  }
+  return regression ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Exact pattern matching with each party scaled out over several worker processes (see
+// base/scale_out.h), e.g., on different machines.  Worker w of both parties evaluates the windows
+// of slice w of the text with a PatternMatcher, over its own connection given by --party, and
+// sends its match bits to the coordinator of its party, which listens on
+// --coordinator-port + w for worker w.  The coordinator of the pattern owner prints the merged
+// matches.  The text and the pattern are generated from --seed, s.t. the text owner's workers
+// agree on the text without a shared file.
+//
+// e.g., with two workers per party:
+//   scale_out_pm --role coordinator --my-id 1 --num-workers 2 --coordinator-port 8000
+//   scale_out_pm --role worker --my-id 1 --num-workers 2 --worker-id 0 --coordinator-host
+//       127.0.0.1 --coordinator-port 8000 --party 0,127.0.0.1,7000 --party 1,127.0.0.1,7001
+//   ... and the same for worker 1 (ports 7002, 7003) and for party 0
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "algorithm/pattern_matcher.h"
+#include "base/scale_out.h"
+#include "communication/communication_layer.h"
+#include "communication/tcp_transport.h"
+#include "utility/bit_vector.h"
+#include "utility/logger.h"
+
+namespace po = boost::program_options;
+
+constexpr std::size_t text_owner = 0;
+constexpr std::size_t pattern_owner = 1;
+
+struct Options {
+  bool coordinator;
+  std::size_t my_id;
+  std::size_t num_workers;
+  std::size_t worker_id;
+  std::string coordinator_host;
+  std::uint16_t coordinator_port;
+  MOTION::Communication::tcp_parties_config tcp_config;
+  std::size_t text_size;
+  std::size_t pattern_size;
+  std::size_t bits_per_character;
+  std::size_t threads;
+  std::uint64_t seed;
+};
+
+std::optional<Options> parse_program_options(int argc, char* argv[]) {
+  Options options;
+  boost::program_options::options_description desc("Allowed options");
+  // clang-format off
+  desc.add_options()
+    ("help,h", po::bool_switch()->default_value(false),"produce help message")
+    ("role", po::value<std::string>()->required(), "worker or coordinator")
+    ("my-id", po::value<std::size_t>()->required(), "my party id, 0 owns the text and 1 the pattern")
+    ("num-workers", po::value<std::size_t>()->required(), "number of workers per party")
+    ("worker-id", po::value<std::size_t>()->default_value(0), "id of this worker")
+    ("coordinator-host", po::value<std::string>()->default_value("127.0.0.1"), "host of the coordinator of my party")
+    ("coordinator-port", po::value<std::uint16_t>()->required(), "the coordinator listens on this port + worker id for each worker")
+    ("party", po::value<std::vector<std::string>>()->multitoken(),
+     "(party id, IP, port) of this worker and of its counterpart, e.g., --party 1,127.0.0.1,7777")
+    ("text-size", po::value<std::size_t>()->default_value(1000000), "number of characters of the text")
+    ("pattern-size", po::value<std::size_t>()->default_value(8), "number of characters of the pattern")
+    ("bits-per-character", po::value<std::size_t>()->default_value(2), "bits of each character")
+    ("threads", po::value<std::size_t>()->default_value(0), "number of threads of each worker")
+    ("seed", po::value<std::uint64_t>()->default_value(1), "seed of the text and the pattern")
+    ;
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  if (vm["help"].as<bool>()) {
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "error:" << e.what() << "\n\n";
+    std::cerr << desc << "\n";
+    return std::nullopt;
+  }
+
+  const auto role = vm["role"].as<std::string>();
+  if (role != "worker" && role != "coordinator") {
+    std::cerr << "unknown role " << role << "\n";
+    return std::nullopt;
+  }
+  options.coordinator = role == "coordinator";
+  options.my_id = vm["my-id"].as<std::size_t>();
+  options.num_workers = vm["num-workers"].as<std::size_t>();
+  options.worker_id = vm["worker-id"].as<std::size_t>();
+  options.coordinator_host = vm["coordinator-host"].as<std::string>();
+  options.coordinator_port = vm["coordinator-port"].as<std::uint16_t>();
+  options.text_size = vm["text-size"].as<std::size_t>();
+  options.pattern_size = vm["pattern-size"].as<std::size_t>();
+  options.bits_per_character = vm["bits-per-character"].as<std::size_t>();
+  options.threads = vm["threads"].as<std::size_t>();
+  options.seed = vm["seed"].as<std::uint64_t>();
+  if (options.my_id > 1 || options.num_workers == 0 || options.worker_id >= options.num_workers ||
+      options.pattern_size == 0 || options.pattern_size > options.text_size ||
+      options.bits_per_character == 0 || options.bits_per_character > 8) {
+    std::cerr << "invalid party, worker or text parameters\n";
+    return std::nullopt;
+  }
+  if (options.coordinator) {
+    return options;
+  }
+
+  const auto parse_party_argument =
+      [](const auto& s) -> std::pair<std::size_t, MOTION::Communication::tcp_connection_config> {
+    const static std::regex party_argument_re("([01]),([^,]+),(\\d{1,5})");
+    std::smatch match;
+    if (!std::regex_match(s, match, party_argument_re)) {
+      throw std::invalid_argument("invalid party argument");
+    }
+    auto id = boost::lexical_cast<std::size_t>(match[1]);
+    auto host = match[2];
+    auto port = boost::lexical_cast<std::uint16_t>(match[3]);
+    return {id, {host, port}};
+  };
+
+  if (!vm.count("party") || vm["party"].as<std::vector<std::string>>().size() != 2) {
+    std::cerr << "expecting two --party options for a worker\n";
+    return std::nullopt;
+  }
+  const auto party_infos = vm["party"].as<std::vector<std::string>>();
+  const auto [id0, conn_info0] = parse_party_argument(party_infos[0]);
+  const auto [id1, conn_info1] = parse_party_argument(party_infos[1]);
+  if (id0 == id1) {
+    std::cerr << "need party arguments for party 0 and 1\n";
+    return std::nullopt;
+  }
+  options.tcp_config.resize(2);
+  options.tcp_config[id0] = conn_info0;
+  options.tcp_config[id1] = conn_info1;
+  return options;
+}
+
+// the characters [offset, offset + size) of the text generated from the seed
+std::vector<std::uint64_t> make_text(const Options& options, std::size_t offset,
+                                     std::size_t size) {
+  std::mt19937_64 rng(options.seed);
+  rng.discard(offset);
+  std::vector<std::uint64_t> text(size);
+  const auto mask = (std::uint64_t(1) << options.bits_per_character) - 1;
+  std::generate(std::begin(text), std::end(text), [&] { return rng() & mask; });
+  return text;
+}
+
+// a window of the text s.t. there is at least one match
+std::vector<std::uint64_t> make_pattern(const Options& options) {
+  const auto num_windows = options.text_size - options.pattern_size + 1;
+  const auto position = std::mt19937_64(options.seed + 1)() % num_windows;
+  return make_text(options, position, options.pattern_size);
+}
+
+// the transport to the coordinator, which is party 0 of a two-party setup per worker
+std::unique_ptr<MOTION::Communication::Transport> connect_to_coordinator(
+    const Options& options, std::size_t worker_id) {
+  const auto port = static_cast<std::uint16_t>(options.coordinator_port + worker_id);
+  MOTION::Communication::tcp_parties_config config = {{options.coordinator_host, port},
+                                                      {options.coordinator_host, port}};
+  MOTION::Communication::TCPSetupHelper helper(options.coordinator ? 0 : 1, config);
+  auto transports = helper.setup_connections();
+  return std::move(transports.at(options.coordinator ? 1 : 0));
+}
+
+int run_worker(const Options& options) {
+  MOTION::ScaleOutWorker worker(options.worker_id, options.num_workers,
+                                connect_to_coordinator(options, options.worker_id));
+  const auto num_windows = options.text_size - options.pattern_size + 1;
+  const auto slice = worker.get_slice(num_windows);
+  // the windows of the slice need pattern_size - 1 characters of the next slice
+  const auto slice_size = slice.num_simd + options.pattern_size - 1;
+
+  MOTION::Communication::TCPSetupHelper helper(options.my_id, options.tcp_config);
+  auto comm_layer = std::make_unique<MOTION::Communication::CommunicationLayer>(
+      options.my_id, helper.setup_connections());
+  auto logger =
+      std::make_shared<MOTION::Logger>(options.my_id, boost::log::trivial::severity_level::info);
+  comm_layer->set_logger(logger);
+  {
+    MOTION::PatternMatcher matcher(*comm_layer, text_owner, options.bits_per_character,
+                                   options.threads, logger);
+    MOTION::PatternQuery query{.type = MOTION::PatternMatchingType::exact,
+                               .pattern_size = options.pattern_size};
+    if (slice.num_simd > 0) {
+      if (options.my_id == text_owner) {
+        matcher.share_text(make_text(options, slice.offset, slice_size));
+      } else {
+        matcher.share_text(slice_size);
+        query.pattern = make_pattern(options);
+      }
+      matcher.add_query(std::move(query));
+      const auto matches = matcher.run().at(0);
+      if (options.my_id == pattern_owner) {
+        worker.send_output_bits(slice.offset, matches);
+      } else {
+        worker.send_output(slice.offset, slice.num_simd, {});
+      }
+      std::cout << fmt::format("worker {}: windows [{}, {}), {}", options.worker_id, slice.offset,
+                               slice.offset + slice.num_simd,
+                               matcher.get_statistics().print_human_readable());
+    }
+  }
+  worker.finish();
+  comm_layer->shutdown();
+  return EXIT_SUCCESS;
+}
+
+int run_coordinator(const Options& options) {
+  std::vector<std::future<std::unique_ptr<MOTION::Communication::Transport>>> connections;
+  for (std::size_t worker_id = 0; worker_id < options.num_workers; ++worker_id) {
+    connections.push_back(std::async(std::launch::async, [&options, worker_id] {
+      return connect_to_coordinator(options, worker_id);
+    }));
+  }
+  std::vector<std::unique_ptr<MOTION::Communication::Transport>> workers;
+  for (auto& connection : connections) {
+    workers.push_back(connection.get());
+  }
+  const auto start = std::chrono::steady_clock::now();
+  MOTION::ScaleOutCoordinator coordinator(std::move(workers));
+  const auto chunks = coordinator.collect_outputs();
+  const auto time_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  const auto num_windows = options.text_size - options.pattern_size + 1;
+  std::cout << fmt::format("{} workers: {} windows in {:.3f} ms ({:.0f} windows/s)\n",
+                           options.num_workers, num_windows, time_ms,
+                           time_ms > 0 ? 1000 * num_windows / time_ms : 0.0);
+  if (options.my_id == pattern_owner) {
+    const auto matches = MOTION::ScaleOutCoordinator::merge_bits(chunks);
+    std::size_t num_matches = 0;
+    for (std::size_t window_i = 0; window_i < matches.GetSize(); ++window_i) {
+      num_matches += matches.Get(window_i);
+    }
+    std::cout << fmt::format("{} of {} windows match\n", num_matches, matches.GetSize());
+  }
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+  auto options = parse_program_options(argc, argv);
+  if (!options.has_value()) {
+    return EXIT_FAILURE;
+  }
+  try {
+    return options->coordinator ? run_coordinator(*options) : run_worker(*options);
+  } catch (std::runtime_error& e) {
+    std::cerr << "ERROR OCCURRED: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+}
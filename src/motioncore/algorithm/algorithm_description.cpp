@@ -24,9 +24,20 @@
 
 #include "algorithm_description.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <regex>
 #include <sstream>
+#include <system_error>
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
@@ -410,5 +421,170 @@ AlgorithmDescription AlgorithmDescription::FromABY(std::ifstream& stream) {
     line_v.clear();
   }
   return algo;
-}  // namespace ENCRYPTO
 }
+
+//
+// Binary format (all integers in host byte order):
+//
+//   header:   magic, number of gates, number of wires, number of input wires of parent a and b
+//             (all ones if there is no parent b), number of output wires, padded to 64 bytes
+//   gate:     type, flags (has parent b, has selection bit), 2 bytes padding, parent a,
+//             parent b, selection bit and output wire as 32 bit integers
+//
+// The file is meant to be written by the converter on the machine which evaluates the circuit.
+//
+
+namespace {
+
+constexpr std::array<char, 8> binary_circuit_magic = {'M', 'O', 'T', 'N', 'C', 'I', 'R', '1'};
+constexpr std::uint64_t no_parent_b_inputs = std::numeric_limits<std::uint64_t>::max();
+
+struct BinaryCircuitHeader {
+  std::array<char, 8> magic;
+  std::uint64_t n_gates;
+  std::uint64_t n_wires;
+  std::uint64_t n_input_wires_parent_a;
+  std::uint64_t n_input_wires_parent_b;
+  std::uint64_t n_output_wires;
+  std::uint64_t reserved[2];
+};
+static_assert(sizeof(BinaryCircuitHeader) == 64);
+
+struct BinaryGate {
+  static constexpr std::uint8_t has_parent_b = 1;
+  static constexpr std::uint8_t has_selection_bit = 2;
+  std::uint8_t type;
+  std::uint8_t flags;
+  std::uint16_t padding;
+  std::uint32_t parent_a;
+  std::uint32_t parent_b;
+  std::uint32_t selection_bit;
+  std::uint32_t output_wire;
+};
+static_assert(sizeof(BinaryGate) == 20);
+
+std::uint32_t to_binary_wire_id(std::size_t wire_id) {
+  if (wire_id > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error(fmt::format("wire id {} does not fit into 32 bit", wire_id));
+  }
+  return static_cast<std::uint32_t>(wire_id);
+}
+
+}  // namespace
+
+AlgorithmDescription AlgorithmDescription::FromBinary(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            fmt::format("FromBinary: could not open {}", path));
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == -1) {
+    auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("FromBinary: could not stat {}", path));
+  }
+  const std::size_t file_size = file_stat.st_size;
+  if (file_size < sizeof(BinaryCircuitHeader)) {
+    ::close(fd);
+    throw std::runtime_error(fmt::format("FromBinary: {} is too small", path));
+  }
+  void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  auto error = errno;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("FromBinary: could not map {}", path));
+  }
+  ::madvise(mapping, file_size, MADV_SEQUENTIAL);
+  struct Unmap {
+    void* mapping;
+    std::size_t size;
+    ~Unmap() { ::munmap(mapping, size); }
+  } unmap{mapping, file_size};
+
+  const auto* data = static_cast<const std::byte*>(mapping);
+  BinaryCircuitHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != binary_circuit_magic) {
+    throw std::runtime_error(fmt::format("FromBinary: {} is not a binary circuit", path));
+  }
+  if ((file_size - sizeof(header)) / sizeof(BinaryGate) != header.n_gates ||
+      (file_size - sizeof(header)) % sizeof(BinaryGate) != 0) {
+    throw std::runtime_error(
+        fmt::format("FromBinary: {} does not contain {} gates", path, header.n_gates));
+  }
+
+  AlgorithmDescription algo;
+  algo.n_gates_ = header.n_gates;
+  algo.n_wires_ = header.n_wires;
+  algo.n_input_wires_parent_a_ = header.n_input_wires_parent_a;
+  if (header.n_input_wires_parent_b != no_parent_b_inputs) {
+    algo.n_input_wires_parent_b_ = header.n_input_wires_parent_b;
+  }
+  algo.n_output_wires_ = header.n_output_wires;
+  algo.gates_.resize(header.n_gates);
+  const auto* gate_data = data + sizeof(header);
+  for (std::size_t gate_i = 0; gate_i < header.n_gates; ++gate_i) {
+    BinaryGate gate;
+    std::memcpy(&gate, gate_data + gate_i * sizeof(BinaryGate), sizeof(BinaryGate));
+    if (gate.type >= static_cast<std::uint8_t>(PrimitiveOperationType::INVALID) ||
+        gate.parent_a >= header.n_wires || gate.output_wire >= header.n_wires ||
+        ((gate.flags & BinaryGate::has_parent_b) && gate.parent_b >= header.n_wires) ||
+        ((gate.flags & BinaryGate::has_selection_bit) && gate.selection_bit >= header.n_wires)) {
+      throw std::runtime_error(fmt::format("FromBinary: {} has an invalid gate {}", path, gate_i));
+    }
+    auto& op = algo.gates_[gate_i];
+    op.type_ = static_cast<PrimitiveOperationType>(gate.type);
+    op.parent_a_ = gate.parent_a;
+    if (gate.flags & BinaryGate::has_parent_b) {
+      op.parent_b_ = gate.parent_b;
+    }
+    if (gate.flags & BinaryGate::has_selection_bit) {
+      op.selection_bit_ = gate.selection_bit;
+    }
+    op.output_wire_ = gate.output_wire;
+  }
+  return algo;
+}
+
+void AlgorithmDescription::WriteBinary(const std::string& path) const {
+  BinaryCircuitHeader header{};
+  header.magic = binary_circuit_magic;
+  header.n_gates = gates_.size();
+  header.n_wires = n_wires_;
+  header.n_input_wires_parent_a = n_input_wires_parent_a_;
+  header.n_input_wires_parent_b = n_input_wires_parent_b_.value_or(no_parent_b_inputs);
+  header.n_output_wires = n_output_wires_;
+
+  std::vector<BinaryGate> gates(gates_.size());
+  for (std::size_t gate_i = 0; gate_i < gates_.size(); ++gate_i) {
+    const auto& op = gates_[gate_i];
+    auto& gate = gates[gate_i];
+    gate = BinaryGate{};
+    gate.type = static_cast<std::uint8_t>(op.type_);
+    gate.parent_a = to_binary_wire_id(op.parent_a_);
+    if (op.parent_b_.has_value()) {
+      gate.flags |= BinaryGate::has_parent_b;
+      gate.parent_b = to_binary_wire_id(*op.parent_b_);
+    }
+    if (op.selection_bit_.has_value()) {
+      gate.flags |= BinaryGate::has_selection_bit;
+      gate.selection_bit = to_binary_wire_id(*op.selection_bit_);
+    }
+    gate.output_wire = to_binary_wire_id(op.output_wire_);
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error(fmt::format("WriteBinary: could not open {}", path));
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(gates.data()), gates.size() * sizeof(BinaryGate));
+  if (!file) {
+    throw std::runtime_error(fmt::format("WriteBinary: could not write {}", path));
+  }
+}
+
+}  // namespace ENCRYPTO
@@ -26,6 +26,7 @@
 
 #include <cassert>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "utility/typedefs.h"
@@ -59,6 +60,14 @@ struct AlgorithmDescription {
 
   static AlgorithmDescription FromABY(std::ifstream& stream);
 
+  // Compact binary format with packed gate records and 32 bit wire ids, see
+  // algorithm_description.cpp.  The file is memory-mapped and the records are copied into gates_
+  // without any parsing.
+  static AlgorithmDescription FromBinary(const std::string& path);
+
+  // write the circuit in the binary format, throws if a wire id does not fit into 32 bit
+  void WriteBinary(const std::string& path) const;
+
   std::size_t n_output_wires_{0}, n_input_wires_parent_a_{0}, n_wires_{0}, n_gates_{0};
   std::optional<std::size_t> n_input_wires_parent_b_{std::nullopt};
   std::vector<PrimitiveOperation> gates_;
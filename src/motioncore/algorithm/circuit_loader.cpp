@@ -25,6 +25,8 @@
 #include <algorithm>
 #include <exception>
 #include <filesystem>
+#include <fstream>
+#include <numeric>
 #include <optional>
 #include <queue>
 #include <stdexcept>
@@ -38,6 +40,113 @@ namespace fs = std::filesystem;
 
 namespace MOTION {
 
+std::chrono::duration<double> CircuitCostModel::estimate(
+    const ENCRYPTO::CircuitStatistics& stats, std::size_t num_simd) const {
+  auto time = stats.and_depth * round_trip_time / 2 + stats.num_gates * time_per_gate;
+  if (bandwidth > 0) {
+    const auto num_bits = static_cast<double>(stats.num_and_gates + stats.num_or_gates) *
+                          static_cast<double>(num_simd) * bits_per_and_gate;
+    time += std::chrono::duration<double>(num_bits / bandwidth);
+  }
+  return time;
+}
+
+TreeSchedule::TreeSchedule(std::size_t num_inputs) : num_inputs(num_inputs), layer_offsets{0} {
+  if (num_inputs == 0) {
+    throw std::logic_error("need at least one input to combine");
+  }
+  // combine the two oldest values until one is left and compute the layer of every value
+  std::queue<std::size_t> values;
+  std::vector<std::size_t> layers(num_inputs, 0);
+  for (std::size_t i = 0; i < num_inputs; ++i) {
+    values.push(i);
+  }
+  while (values.size() > 1) {
+    const auto value_a = values.front();
+    values.pop();
+    const auto value_b = values.front();
+    values.pop();
+    // values enter the queue in the order of their layers, so the layers are contiguous
+    const auto layer = std::max(layers.at(value_a), layers.at(value_b)) + 1;
+    if (layer > layer_offsets.size()) {
+      layer_offsets.push_back(instances.size());
+    }
+    values.push(num_inputs + instances.size());
+    layers.push_back(layer);
+    instances.emplace_back(value_a, value_b);
+  }
+  if (!instances.empty()) {
+    layer_offsets.push_back(instances.size());
+  }
+}
+
+CircuitCache& CircuitCache::get_instance() {
+  static CircuitCache instance;
+  return instance;
+}
+
+static ENCRYPTO::AlgorithmDescription read_circuit(const fs::path& path, CircuitFormat format) {
+  if (format != CircuitFormat::Binary) {
+    fs::directory_entry binary_entry(path.string() + binary_circuit_suffix);
+    if (binary_entry.is_regular_file() &&
+        binary_entry.last_write_time() >= fs::last_write_time(path)) {
+      return ENCRYPTO::AlgorithmDescription::FromBinary(binary_entry.path());
+    }
+  }
+  switch (format) {
+    case CircuitFormat::ABY:
+      return ENCRYPTO::AlgorithmDescription::FromABY(path);
+    case CircuitFormat::Bristol:
+      return ENCRYPTO::AlgorithmDescription::FromBristol(path);
+    case CircuitFormat::BristolFashion:
+      return ENCRYPTO::AlgorithmDescription::FromBristolFashion(path);
+    case CircuitFormat::Binary:
+      return ENCRYPTO::AlgorithmDescription::FromBinary(path);
+  }
+  throw std::logic_error("unknown circuit format");
+}
+
+std::shared_ptr<const ENCRYPTO::AlgorithmDescription> CircuitCache::load(const fs::path& path,
+                                                                         CircuitFormat format) {
+  auto key = std::make_pair(fs::absolute(path).lexically_normal().string(), format);
+  {
+    std::scoped_lock lock(mutex_);
+    if (auto it = circuits_.find(key); it != std::end(circuits_)) {
+      return it->second;
+    }
+  }
+  if (!fs::is_regular_file(path)) {
+    throw std::runtime_error(fmt::format("Could not find circuit file {}", path.string()));
+  }
+  // parse without holding the lock, if several threads load the same circuit, the first one to
+  // finish is kept
+  auto algo = std::make_shared<const ENCRYPTO::AlgorithmDescription>(read_circuit(path, format));
+  std::scoped_lock lock(mutex_);
+  ++num_parsed_;
+  return circuits_.try_emplace(std::move(key), std::move(algo)).first->second;
+}
+
+void CircuitCache::preload(const std::vector<std::pair<fs::path, CircuitFormat>>& circuits) {
+  for (const auto& [path, format] : circuits) {
+    load(path, format);
+  }
+}
+
+std::size_t CircuitCache::get_num_circuits() const {
+  std::scoped_lock lock(mutex_);
+  return circuits_.size();
+}
+
+std::size_t CircuitCache::get_num_parsed() const {
+  std::scoped_lock lock(mutex_);
+  return num_parsed_;
+}
+
+void CircuitCache::clear() {
+  std::scoped_lock lock(mutex_);
+  circuits_.clear();
+}
+
 CircuitLoader::CircuitLoader() {
   fs::path circuit_dir = MOTION::MOTION_ROOT_DIR;
   circuit_dir /= "circuits";
@@ -66,7 +175,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_circuit(std::string na
                                                                   CircuitFormat format) {
   auto it = algo_cache_.find(name);
   if (it != std::end(algo_cache_)) {
-    return it->second;
+    return *it->second;
   }
 
   for (const auto& dir : circuit_search_path_) {
@@ -74,19 +183,8 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_circuit(std::string na
     fs::directory_entry dir_entry(path);
     if (dir_entry.exists() && dir_entry.is_regular_file()) {
       try {
-        switch (format) {
-          case CircuitFormat::ABY:
-            algo_cache_[name] = ENCRYPTO::AlgorithmDescription::FromABY(dir_entry.path());
-            break;
-          case CircuitFormat::Bristol:
-            algo_cache_[name] = ENCRYPTO::AlgorithmDescription::FromBristol(dir_entry.path());
-            break;
-          case CircuitFormat::BristolFashion:
-            algo_cache_[name] =
-                ENCRYPTO::AlgorithmDescription::FromBristolFashion(dir_entry.path());
-            break;
-        }
-        return algo_cache_[name];
+        auto algo = CircuitCache::get_instance().load(dir_entry.path(), format);
+        return *(algo_cache_[name] = std::move(algo));
       } catch (std::runtime_error& e) {
         throw std::runtime_error(
             fmt::format("Could not load circuit description '{:s}' from file {:s}: '{:s}'", name,
@@ -98,11 +196,66 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_circuit(std::string na
                                        name, format_search_path(circuit_search_path_)));
 }
 
+ENCRYPTO::CircuitStatistics CircuitLoader::load_circuit_statistics(const std::string& name,
+                                                                   CircuitFormat format) {
+  for (const auto& dir : circuit_search_path_) {
+    const auto path = dir / name;
+    if (!fs::is_regular_file(path)) {
+      continue;
+    }
+    auto stats_path = path;
+    stats_path.replace_extension(".stats");
+    std::ifstream stats_file(stats_path);
+    if (!stats_file) {
+      return ENCRYPTO::ComputeCircuitStatistics(load_circuit(name, format));
+    }
+    // lines of the form "<key> <value>"
+    std::unordered_map<std::string, std::size_t> values;
+    std::string key;
+    std::size_t value;
+    while (stats_file >> key >> value) {
+      values[key] = value;
+    }
+    if (!stats_file.eof()) {
+      throw std::runtime_error(
+          fmt::format("Could not parse circuit statistics {}", stats_path.string()));
+    }
+    const auto get = [&values, &stats_path](const std::string& key) {
+      auto it = values.find(key);
+      if (it == std::end(values)) {
+        throw std::runtime_error(
+            fmt::format("Circuit statistics {} do not contain {}", stats_path.string(), key));
+      }
+      return it->second;
+    };
+    return {.num_gates = get("total_gates"),
+            .num_and_gates = get("and_gates"),
+            .num_or_gates = get("or_gates"),
+            .num_xor_gates = get("xor_gates"),
+            .num_inv_gates = get("not_gates"),
+            .and_depth = get("non_xor_depth")};
+  }
+  throw std::runtime_error(fmt::format("Could not find circuit description '{}' in search path: {}",
+                                       name, format_search_path(circuit_search_path_)));
+}
+
+bool CircuitLoader::select_depth_optimized(const std::string& name, std::size_t num_simd,
+                                           bool default_depth_optimized) {
+  if (!cost_model_.has_value()) {
+    return default_depth_optimized;
+  }
+  const auto depth_stats =
+      load_circuit_statistics(fmt::format("{}_depth.bristol", name), CircuitFormat::Bristol);
+  const auto size_stats =
+      load_circuit_statistics(fmt::format("{}_size.bristol", name), CircuitFormat::Bristol);
+  return cost_model_->estimate(depth_stats, num_simd) < cost_model_->estimate(size_stats, num_simd);
+}
+
 const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_relu_circuit(std::size_t bit_size) {
   const auto name = fmt::format("__circuit_loader_builtin__relu_{}_bit", bit_size);
   auto it = algo_cache_.find(name);
   if (it != std::end(algo_cache_)) {
-    return it->second;
+    return *it->second;
   }
 
   std::vector<ENCRYPTO::PrimitiveOperation> gates(bit_size + 1);
@@ -128,8 +281,102 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_relu_circuit(std::size
                                       .n_wires_ = 2 * bit_size + 1,
                                       .n_gates_ = bit_size + 1,
                                       .gates_ = std::move(gates)};
-  algo_cache_[name] = std::move(algo);
-  return algo_cache_[name];
+  return *(algo_cache_[name] =
+               std::make_shared<const ENCRYPTO::AlgorithmDescription>(std::move(algo)));
+}
+
+// Append the gates of sub_algo to algo, where the input wires of sub_algo are replaced by the
+// given wires of algo and its other wires by new wires in the same order.  Returns the wires of
+// the outputs of sub_algo.
+static std::vector<std::size_t> append_circuit(ENCRYPTO::AlgorithmDescription& algo,
+                                               const ENCRYPTO::AlgorithmDescription& sub_algo,
+                                               const std::vector<std::size_t>& input_wires) {
+  const auto num_inputs =
+      sub_algo.n_input_wires_parent_a_ + sub_algo.n_input_wires_parent_b_.value_or(0);
+  if (input_wires.size() != num_inputs) {
+    throw std::logic_error("wrong number of input wires for the sub-circuit");
+  }
+  std::vector<std::size_t> wire_map(sub_algo.n_wires_);
+  std::copy(std::begin(input_wires), std::end(input_wires), std::begin(wire_map));
+  std::iota(std::begin(wire_map) + num_inputs, std::end(wire_map), algo.n_wires_);
+  algo.n_wires_ += sub_algo.n_wires_ - num_inputs;
+  std::transform(std::begin(sub_algo.gates_), std::end(sub_algo.gates_),
+                 std::back_inserter(algo.gates_), [&wire_map](ENCRYPTO::PrimitiveOperation op) {
+                   op.parent_a_ = wire_map.at(op.parent_a_);
+                   if (op.parent_b_.has_value()) {
+                     *op.parent_b_ = wire_map.at(*op.parent_b_);
+                   }
+                   if (op.selection_bit_.has_value()) {
+                     *op.selection_bit_ = wire_map.at(*op.selection_bit_);
+                   }
+                   op.output_wire_ = wire_map.at(op.output_wire_);
+                   return op;
+                 });
+  algo.n_gates_ = algo.gates_.size();
+  return {std::end(wire_map) - sub_algo.n_output_wires_, std::end(wire_map)};
+}
+
+const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_masked_relu_circuit(
+    std::size_t bit_size) {
+  const auto name = fmt::format("__circuit_loader_builtin__masked_relu_{}_bit", bit_size);
+  auto it = algo_cache_.find(name);
+  if (it != std::end(algo_cache_)) {
+    return *it->second;
+  }
+  const auto& addition_algo =
+      load_circuit(fmt::format("int_add{}_size.bristol", bit_size), CircuitFormat::Bristol);
+
+  // inputs: a = [0, bit_size), mask = [bit_size, 2 * bit_size), b = [2 * bit_size, 3 * bit_size)
+  ENCRYPTO::AlgorithmDescription algo{.n_output_wires_ = bit_size,
+                                      .n_input_wires_parent_a_ = 2 * bit_size,
+                                      .n_wires_ = 3 * bit_size,
+                                      .n_gates_ = 0,
+                                      .n_input_wires_parent_b_ = bit_size,
+                                      .gates_ = {}};
+  std::vector<std::size_t> input_wires(2 * bit_size);
+  std::iota(std::begin(input_wires), std::begin(input_wires) + bit_size, 0);
+  std::iota(std::begin(input_wires) + bit_size, std::end(input_wires), 2 * bit_size);
+  const auto sum_wires = append_circuit(algo, addition_algo, input_wires);
+
+  // x_j & ~msb(x) for the lower bits, and msb(x) ^ msb(x) = 0 for the msb
+  const auto msb_wire = sum_wires.back();
+  const auto not_msb_wire = algo.n_wires_;
+  algo.gates_.push_back({.type_ = ENCRYPTO::PrimitiveOperationType::INV,
+                         .parent_a_ = msb_wire,
+                         .output_wire_ = not_msb_wire});
+  std::vector<std::size_t> relu_wires(2 * bit_size);
+  for (std::size_t bit_j = 0; bit_j < bit_size - 1; ++bit_j) {
+    relu_wires.at(bit_j) = not_msb_wire + 1 + bit_j;
+    algo.gates_.push_back({.type_ = ENCRYPTO::PrimitiveOperationType::AND,
+                           .parent_a_ = sum_wires.at(bit_j),
+                           .parent_b_ = not_msb_wire,
+                           .output_wire_ = relu_wires.at(bit_j)});
+  }
+  relu_wires.at(bit_size - 1) = not_msb_wire + bit_size;
+  algo.gates_.push_back({.type_ = ENCRYPTO::PrimitiveOperationType::XOR,
+                         .parent_a_ = msb_wire,
+                         .parent_b_ = msb_wire,
+                         .output_wire_ = relu_wires.at(bit_size - 1)});
+  algo.n_wires_ += bit_size + 1;
+  algo.n_gates_ = algo.gates_.size();
+
+  // add the mask, the outputs of the addition are the last wires
+  std::iota(std::begin(relu_wires) + bit_size, std::end(relu_wires), bit_size);
+  [[maybe_unused]] const auto output_wires = append_circuit(algo, addition_algo, relu_wires);
+  assert(output_wires.front() == algo.n_wires_ - bit_size);
+  assert(output_wires.back() == algo.n_wires_ - 1);
+
+  return *(algo_cache_[name] =
+               std::make_shared<const ENCRYPTO::AlgorithmDescription>(std::move(algo)));
+}
+
+const ENCRYPTO::AlgorithmDescription& CircuitLoader::optimize_and_cache(
+    const std::string& name, const ENCRYPTO::AlgorithmDescription& algo) {
+  const auto& optimized_algo = *(algo_cache_[name] =
+      std::make_shared<const ENCRYPTO::AlgorithmDescription>(ENCRYPTO::OptimizeCircuit(algo)));
+  optimization_reports_.push_back({name, ENCRYPTO::ComputeCircuitStatistics(algo),
+                                   ENCRYPTO::ComputeCircuitStatistics(optimized_algo)});
+  return optimized_algo;
 }
 
 const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gt_circuit(std::size_t bit_size,
@@ -141,7 +388,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gt_circuit(std::size_t
                                 depth_optimized ? "depth" : "size");
   auto it = algo_cache_.find(name);
   if (it != std::end(algo_cache_)) {
-    return it->second;
+    return *it->second;
   }
   auto algo =
       load_circuit(fmt::format("int_gt{}_{}.bristol", bit_size, depth_optimized ? "depth" : "size"),
@@ -154,7 +401,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gt_circuit(std::size_t
   algo.gates_.resize(algo.n_gates_);
   algo.gates_.at(algo.n_gates_ - 1).output_wire_ -= 2;
 
-  return algo_cache_[name] = std::move(algo);
+  return optimize_and_cache(name, algo);
 }
 
 const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gtmux_circuit(std::size_t bit_size,
@@ -166,7 +413,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gtmux_circuit(std::siz
                                 depth_optimized ? "depth" : "size");
   auto it = algo_cache_.find(name);
   if (it != std::end(algo_cache_)) {
-    return it->second;
+    return *it->second;
   }
   const auto& gt_algo = load_gt_circuit(bit_size, depth_optimized);
   auto algo = gt_algo;
@@ -212,8 +459,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_gtmux_circuit(std::siz
     assert(op.output_wire_ < algo.n_wires_);
   }
 
-  algo_cache_[name] = std::move(algo);
-  return algo_cache_[name];
+  return optimize_and_cache(name, algo);
 }
 
 const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_tree_circuit(const std::string& algo_name,
@@ -226,10 +472,10 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_tree_circuit(const std
   const auto name = fmt::format("__circuit_loader_builtin__tree__{}__{}_bit", algo_name, bit_size);
   auto it = algo_cache_.find(name);
   if (it != std::end(algo_cache_)) {
-    return it->second;
+    return *it->second;
   }
 
-  const auto& sub_algo = algo_cache_.at(algo_name);
+  const auto& sub_algo = *algo_cache_.at(algo_name);
   if (sub_algo.n_input_wires_parent_a_ != bit_size ||
       !sub_algo.n_input_wires_parent_b_.has_value() ||
       *sub_algo.n_input_wires_parent_b_ != bit_size || sub_algo.n_output_wires_ != bit_size) {
@@ -244,18 +490,16 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_tree_circuit(const std
       .n_input_wires_parent_b_ = std::nullopt,
       .gates_ = {}};
 
-  // store the wire offsets of the current values
-  std::queue<std::size_t> values;
+  // store the wire offsets of the values
+  std::vector<std::size_t> values;
   for (std::size_t i = 0; i < num_inputs; ++i) {
-    values.push(i * bit_size);
+    values.push_back(i * bit_size);
   }
   std::size_t wire_offset = bit_size * num_inputs;  // number of input wires
-  // std::size_t gate_offset = 0;
-  while (values.size() > 1) {
-    auto input_a_offset = values.front();
-    values.pop();
-    auto input_b_offset = values.front();
-    values.pop();
+  const TreeSchedule schedule(num_inputs);
+  for (const auto& [value_a, value_b] : schedule.instances) {
+    const auto input_a_offset = values.at(value_a);
+    const auto input_b_offset = values.at(value_b);
 
     std::transform(
         std::begin(sub_algo.gates_), std::end(sub_algo.gates_),
@@ -281,9 +525,9 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_tree_circuit(const std
           return op;
         });
     wire_offset += sub_algo.n_wires_ - 2 * bit_size;
-    values.push(wire_offset - bit_size);
+    values.push_back(wire_offset - bit_size);
   }
-  assert(values.front() == wire_offset - bit_size);
+  assert(values.back() == wire_offset - bit_size);
   assert(wire_offset == tree_algo.n_wires_);
   assert(tree_algo.gates_.size() == (num_inputs - 1) * sub_algo.n_gates_);
   assert(tree_algo.gates_.size() == tree_algo.n_gates_);
@@ -315,8 +559,7 @@ const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_tree_circuit(const std
     }
   }
 
-  algo_cache_[name] = std::move(tree_algo);
-  return algo_cache_[name];
+  return optimize_and_cache(name, tree_algo);
 }
 
 const ENCRYPTO::AlgorithmDescription& CircuitLoader::load_maxpool_circuit(std::size_t bit_size,
@@ -22,11 +22,20 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "algorithm_description.h"
+#include "circuit_optimizer.h"
 
 namespace MOTION {
 
@@ -34,14 +43,100 @@ enum class CircuitFormat {
   ABY,
   Bristol,
   BristolFashion,
+  // precompiled with bristol2motion, see AlgorithmDescription::FromBinary
+  Binary,
+};
+
+// suffix of the precompiled binary version of a circuit file
+inline constexpr const char* binary_circuit_suffix = ".mbc";
+
+// Process-wide cache of the circuits read from files, shared by all CircuitLoaders and the
+// SecureUnsignedInteger operations of all backends, s.t. every file is parsed only once per
+// process.  The cached descriptions are immutable, and the cache can be used by several threads.
+class CircuitCache {
+ public:
+  static CircuitCache& get_instance();
+
+  // The circuit in the file at `path`, which is parsed on the first call.  For the text formats,
+  // the precompiled binary version `<path>.mbc` is read instead if it is not older than the file.
+  // Throws std::runtime_error if the file cannot be read.
+  std::shared_ptr<const ENCRYPTO::AlgorithmDescription> load(const std::filesystem::path&,
+                                                             CircuitFormat);
+  // parse the given circuits in advance, e.g., at startup before the first backend is created
+  void preload(const std::vector<std::pair<std::filesystem::path, CircuitFormat>>&);
+
+  std::size_t get_num_circuits() const;
+  // files parsed so far, i.e., cache misses
+  std::size_t get_num_parsed() const;
+  // the descriptions handed out before stay valid
+  void clear();
+
+ private:
+  CircuitCache() = default;
+
+  mutable std::mutex mutex_;
+  // (normalized absolute path, format) -> circuit
+  std::map<std::pair<std::string, CircuitFormat>,
+           std::shared_ptr<const ENCRYPTO::AlgorithmDescription>>
+      circuits_;
+  std::size_t num_parsed_ = 0;
+};
+
+// statistics of a builtin circuit before and after it has been passed through OptimizeCircuit
+struct CircuitOptimizationReport {
+  std::string name;
+  ENCRYPTO::CircuitStatistics original;
+  ENCRYPTO::CircuitStatistics optimized;
+};
+
+// Estimates how long a Boolean circuit takes with GMW or BEAVY on a network: every layer of AND
+// gates waits for the messages of the previous one, which both parties send at the same time,
+// i.e., costs half a round trip, and every AND gate sends some bits per SIMD value.
+struct CircuitCostModel {
+  std::chrono::duration<double> round_trip_time{0};
+  // bits per second, 0 means unlimited
+  double bandwidth = 0;
+  // sent by each party per AND (OR) gate and SIMD value in the online phase
+  double bits_per_and_gate = 2;
+  // local evaluation time per gate, independent of the number of SIMD values
+  std::chrono::duration<double> time_per_gate = std::chrono::microseconds(1);
+
+  std::chrono::duration<double> estimate(const ENCRYPTO::CircuitStatistics&,
+                                         std::size_t num_simd) const;
+};
+
+// Order in which load_tree_circuit combines its inputs with the sub-circuit: values
+// [0, num_inputs) are the inputs and value num_inputs + i is the output of the i-th instance of the
+// sub-circuit.  The instances are grouped into layers of independent instances, such that a whole
+// layer can be evaluated as one instance of the sub-circuit with the SIMD values of its instances
+// concatenated.
+struct TreeSchedule {
+  explicit TreeSchedule(std::size_t num_inputs);
+  std::size_t get_num_layers() const noexcept { return layer_offsets.size() - 1; }
+  std::size_t get_layer_size(std::size_t layer_i) const noexcept {
+    return layer_offsets.at(layer_i + 1) - layer_offsets.at(layer_i);
+  }
+
+  std::size_t num_inputs;
+  // input values of every instance
+  std::vector<std::pair<std::size_t, std::size_t>> instances;
+  // the instances [layer_offsets[l], layer_offsets[l + 1]) form layer l
+  std::vector<std::size_t> layer_offsets;
 };
 
 class CircuitLoader {
  public:
   CircuitLoader();
   ~CircuitLoader();
+  // A circuit in a text format is loaded from its precompiled binary version `<name>.mbc` if this
+  // file exists next to it and is not older than it.  Every file is parsed once per process, see
+  // CircuitCache.
   const ENCRYPTO::AlgorithmDescription& load_circuit(std::string name, CircuitFormat);
   const ENCRYPTO::AlgorithmDescription& load_relu_circuit(std::size_t bit_size);
+  // ReLU of the sum of two values plus a mask for the conversions from and to additive sharing,
+  // i.e., (a || mask, b) -> ReLU(a + b) + mask where the ReLU treats the values as signed.  This
+  // combines two instances of int_add{bit_size}_size.bristol with a ReLU in one circuit.
+  const ENCRYPTO::AlgorithmDescription& load_masked_relu_circuit(std::size_t bit_size);
   const ENCRYPTO::AlgorithmDescription& load_gt_circuit(std::size_t bit_size,
                                                         bool depth_optimized = false);
   const ENCRYPTO::AlgorithmDescription& load_gtmux_circuit(std::size_t bit_size,
@@ -53,9 +148,38 @@ class CircuitLoader {
                                                              std::size_t num_inputs,
                                                              bool depth_optimized = false);
 
+  // Statistics of a circuit in the search path from the `.stats` file next to it, e.g.,
+  // `int_gt32_size.stats` for `int_gt32_size.bristol`, or computed from the circuit if there is
+  // none.
+  ENCRYPTO::CircuitStatistics load_circuit_statistics(const std::string& name, CircuitFormat);
+
+  // Choose between the `<name>_depth.bristol` and `<name>_size.bristol` variants of a circuit,
+  // e.g. `int_gt32`, evaluated with `num_simd` values according to the cost model, or return
+  // `default_depth_optimized` if no cost model is set.
+  bool select_depth_optimized(const std::string& name, std::size_t num_simd,
+                              bool default_depth_optimized = false);
+  void set_cost_model(std::optional<CircuitCostModel> cost_model) {
+    cost_model_ = std::move(cost_model);
+  }
+  const std::optional<CircuitCostModel>& get_cost_model() const noexcept { return cost_model_; }
+
+  // The builtin comparison, (gt)mux and tree circuits are optimized before they are cached,
+  // this reports the effect on every circuit loaded so far (in the order of loading).
+  const std::vector<CircuitOptimizationReport>& get_optimization_reports() const noexcept {
+    return optimization_reports_;
+  }
+
  private:
+  const ENCRYPTO::AlgorithmDescription& optimize_and_cache(const std::string& name,
+                                                           const ENCRYPTO::AlgorithmDescription&);
+
   std::vector<std::filesystem::path> circuit_search_path_;
-  std::unordered_map<std::string, ENCRYPTO::AlgorithmDescription> algo_cache_;
+  // the circuits from files are shared with the CircuitCache, the builtin ones are built per
+  // loader
+  std::unordered_map<std::string, std::shared_ptr<const ENCRYPTO::AlgorithmDescription>>
+      algo_cache_;
+  std::vector<CircuitOptimizationReport> optimization_reports_;
+  std::optional<CircuitCostModel> cost_model_;
 };
 
 }  // namespace MOTION
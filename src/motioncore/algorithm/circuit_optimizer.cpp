@@ -0,0 +1,572 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "circuit_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace ENCRYPTO {
+
+CircuitStatistics ComputeCircuitStatistics(const AlgorithmDescription& algo) {
+  CircuitStatistics stats;
+  std::vector<std::size_t> depths(algo.n_wires_, 0);
+  for (const auto& op : algo.gates_) {
+    std::size_t depth = depths.at(op.parent_a_);
+    if (op.parent_b_.has_value()) {
+      depth = std::max(depth, depths.at(*op.parent_b_));
+    }
+    if (op.selection_bit_.has_value()) {
+      depth = std::max(depth, depths.at(*op.selection_bit_));
+    }
+    ++stats.num_gates;
+    switch (op.type_) {
+      case PrimitiveOperationType::XOR:
+        ++stats.num_xor_gates;
+        break;
+      case PrimitiveOperationType::INV:
+        ++stats.num_inv_gates;
+        break;
+      case PrimitiveOperationType::AND:
+        ++stats.num_and_gates;
+        ++depth;
+        break;
+      case PrimitiveOperationType::OR:
+        ++stats.num_or_gates;
+        ++depth;
+        break;
+      default:
+        ++depth;
+        break;
+    }
+    depths.at(op.output_wire_) = depth;
+  }
+  for (std::size_t wire_i = algo.n_wires_ - algo.n_output_wires_; wire_i < algo.n_wires_;
+       ++wire_i) {
+    stats.and_depth = std::max(stats.and_depth, depths.at(wire_i));
+  }
+  return stats;
+}
+
+namespace {
+
+using node_id = std::size_t;
+constexpr node_id no_node = std::numeric_limits<node_id>::max();
+
+enum class NodeType : std::uint8_t { input, constant, INV, XOR, AND, OR };
+
+// input: a is the wire id, constant: a is the value, gates: a and b are the inputs
+struct Node {
+  NodeType type;
+  node_id a;
+  node_id b;
+  bool operator==(const Node&) const = default;
+};
+
+struct NodeHash {
+  std::size_t operator()(const Node& node) const noexcept {
+    std::size_t h = std::hash<node_id>()(node.a);
+    h ^= std::hash<node_id>()(node.b) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+    return h ^ static_cast<std::size_t>(node.type);
+  }
+};
+
+// Circuit as a DAG in which equal gates are merged and constants are folded while it is built.
+// Nodes are only created after their inputs, so their ids are a topological order.
+class CircuitGraph {
+ public:
+  explicit CircuitGraph(std::size_t num_inputs) : num_inputs_(num_inputs) {
+    for (std::size_t wire_i = 0; wire_i < num_inputs; ++wire_i) {
+      nodes_.push_back({NodeType::input, wire_i, 0});
+      depths_.push_back(0);
+    }
+  }
+
+  std::size_t get_num_inputs() const noexcept { return num_inputs_; }
+  std::size_t size() const noexcept { return nodes_.size(); }
+  Node get(node_id x) const noexcept { return nodes_[x]; }
+  NodeType type(node_id x) const noexcept { return nodes_[x].type; }
+  std::size_t depth(node_id x) const noexcept { return depths_[x]; }
+
+  node_id make_constant(bool value) {
+    auto& constant = constants_[value];
+    if (constant == no_node) {
+      constant = nodes_.size();
+      nodes_.push_back({NodeType::constant, value, 0});
+      depths_.push_back(0);
+    }
+    return constant;
+  }
+
+  node_id make_inv(node_id x) {
+    const auto node = get(x);
+    if (node.type == NodeType::constant) {
+      return make_constant(!node.a);
+    }
+    if (node.type == NodeType::INV) {
+      return node.a;
+    }
+    return insert({NodeType::INV, x, 0});
+  }
+
+  node_id make_xor(node_id x, node_id y) {
+    if (x == y) {
+      return make_constant(false);
+    }
+    if (type(x) == NodeType::constant) {
+      std::swap(x, y);
+    }
+    if (type(y) == NodeType::constant) {
+      return get(y).a ? make_inv(x) : x;
+    }
+    return insert({NodeType::XOR, std::min(x, y), std::max(x, y)});
+  }
+
+  node_id make_and(node_id x, node_id y) {
+    if (x == y) {
+      return x;
+    }
+    if (type(x) == NodeType::constant) {
+      std::swap(x, y);
+    }
+    if (type(y) == NodeType::constant) {
+      return get(y).a ? x : y;
+    }
+    if (are_complements(x, y)) {
+      return make_constant(false);
+    }
+    return insert({NodeType::AND, std::min(x, y), std::max(x, y)});
+  }
+
+  node_id make_or(node_id x, node_id y) {
+    if (x == y) {
+      return x;
+    }
+    if (type(x) == NodeType::constant) {
+      std::swap(x, y);
+    }
+    if (type(y) == NodeType::constant) {
+      return get(y).a ? y : x;
+    }
+    if (are_complements(x, y)) {
+      return make_constant(true);
+    }
+    return insert({NodeType::OR, std::min(x, y), std::max(x, y)});
+  }
+
+  node_id make_gate(NodeType type, node_id x, node_id y) {
+    switch (type) {
+      case NodeType::INV:
+        return make_inv(x);
+      case NodeType::XOR:
+        return make_xor(x, y);
+      case NodeType::AND:
+        return make_and(x, y);
+      case NodeType::OR:
+        return make_or(x, y);
+      default:
+        throw std::logic_error("CircuitGraph: not a gate");
+    }
+  }
+
+ private:
+  bool are_complements(node_id x, node_id y) const noexcept {
+    return (type(x) == NodeType::INV && get(x).a == y) ||
+           (type(y) == NodeType::INV && get(y).a == x);
+  }
+
+  node_id insert(const Node& node) {
+    auto [it, inserted] = table_.try_emplace(node, nodes_.size());
+    if (inserted) {
+      std::size_t depth = depths_[node.a];
+      if (node.type != NodeType::INV) {
+        depth = std::max(depth, depths_[node.b]);
+      }
+      if (node.type == NodeType::AND || node.type == NodeType::OR) {
+        ++depth;
+      }
+      nodes_.push_back(node);
+      depths_.push_back(depth);
+    }
+    return it->second;
+  }
+
+  std::size_t num_inputs_;
+  std::vector<Node> nodes_;
+  std::vector<std::size_t> depths_;
+  std::unordered_map<Node, node_id, NodeHash> table_;
+  std::array<node_id, 2> constants_ = {no_node, no_node};
+};
+
+struct Circuit {
+  CircuitGraph graph;
+  std::vector<node_id> outputs;
+};
+
+bool is_gate(NodeType type) noexcept {
+  return type != NodeType::input && type != NodeType::constant;
+}
+
+// the nodes which contribute to an output, how often they are used and by which type of gate
+struct Liveness {
+  explicit Liveness(const Circuit& circuit)
+      : is_live(circuit.graph.size(), false),
+        fanout(circuit.graph.size(), 0),
+        consumer(circuit.graph.size(), NodeType::input) {
+    const auto& graph = circuit.graph;
+    for (auto output : circuit.outputs) {
+      is_live[output] = true;
+      ++fanout[output];
+      // outputs cannot be absorbed into the tree of some other gate
+      consumer[output] = NodeType::input;
+    }
+    for (std::size_t x = graph.size(); x-- > 0;) {
+      const auto node = graph.get(x);
+      if (!is_live[x] || !is_gate(node.type)) {
+        continue;
+      }
+      const std::array<node_id, 2> inputs = {node.a, node.b};
+      for (std::size_t i = 0; i < (node.type == NodeType::INV ? 1 : 2); ++i) {
+        is_live[inputs[i]] = true;
+        ++fanout[inputs[i]];
+        consumer[inputs[i]] = node.type;
+      }
+    }
+  }
+
+  // the gate is only used by a gate of the same type, i.e., it is an inner node of an AND or OR
+  // tree
+  bool is_absorbed(const CircuitGraph& graph, node_id x) const noexcept {
+    const auto type = graph.type(x);
+    return (type == NodeType::AND || type == NodeType::OR) && fanout[x] == 1 &&
+           consumer[x] == type;
+  }
+
+  std::vector<bool> is_live;
+  std::vector<std::size_t> fanout;
+  std::vector<NodeType> consumer;
+};
+
+std::pair<std::size_t, std::size_t> count_and_depth(const Circuit& circuit) {
+  const Liveness liveness(circuit);
+  std::size_t num_and_gates = 0;
+  for (std::size_t x = 0; x < circuit.graph.size(); ++x) {
+    const auto type = circuit.graph.type(x);
+    if (liveness.is_live[x] && (type == NodeType::AND || type == NodeType::OR)) {
+      ++num_and_gates;
+    }
+  }
+  std::size_t depth = 0;
+  for (auto output : circuit.outputs) {
+    depth = std::max(depth, circuit.graph.depth(output));
+  }
+  return {num_and_gates, depth};
+}
+
+// rebuild the live part of the circuit, factor out common inputs of ANDs below an XOR and
+// rebalance the AND and OR trees
+Circuit restructure(const Circuit& circuit) {
+  const auto& graph = circuit.graph;
+  const Liveness liveness(circuit);
+  Circuit result{CircuitGraph(graph.get_num_inputs()), {}};
+  auto& new_graph = result.graph;
+  std::vector<node_id> new_nodes(graph.size(), no_node);
+  for (std::size_t x = 0; x < graph.get_num_inputs(); ++x) {
+    new_nodes[x] = x;
+  }
+
+  // x & y ^ x & z = x & (y ^ z), unless the ANDs are also used elsewhere
+  const auto factor_xor = [&](node_id x, node_id y) {
+    const auto node_x = graph.get(x), node_y = graph.get(y);
+    if (node_x.type != NodeType::AND || node_y.type != NodeType::AND ||
+        liveness.fanout[x] != 1 || liveness.fanout[y] != 1) {
+      return no_node;
+    }
+    for (auto [s, u] : {std::pair(node_x.a, node_x.b), std::pair(node_x.b, node_x.a)}) {
+      for (auto [t, v] : {std::pair(node_y.a, node_y.b), std::pair(node_y.b, node_y.a)}) {
+        // inputs absorbed into the AND trees of x or y have not been rebuilt
+        if (s == t && new_nodes[s] != no_node && new_nodes[u] != no_node &&
+            new_nodes[v] != no_node) {
+          return new_graph.make_and(new_nodes[s], new_graph.make_xor(new_nodes[u], new_nodes[v]));
+        }
+      }
+    }
+    return no_node;
+  };
+
+  using leaf_t = std::pair<std::size_t, node_id>;
+  std::vector<node_id> stack;
+  std::vector<leaf_t> leaves;
+  for (std::size_t x = graph.get_num_inputs(); x < graph.size(); ++x) {
+    if (!liveness.is_live[x] || liveness.is_absorbed(graph, x)) {
+      continue;
+    }
+    const auto node = graph.get(x);
+    switch (node.type) {
+      case NodeType::constant:
+        new_nodes[x] = new_graph.make_constant(node.a);
+        break;
+      case NodeType::INV:
+        new_nodes[x] = new_graph.make_inv(new_nodes[node.a]);
+        break;
+      case NodeType::XOR:
+        new_nodes[x] = factor_xor(node.a, node.b);
+        if (new_nodes[x] == no_node) {
+          new_nodes[x] = new_graph.make_xor(new_nodes[node.a], new_nodes[node.b]);
+        }
+        break;
+      case NodeType::AND:
+      case NodeType::OR: {
+        // collect the inputs of the tree and combine the two shallowest ones until one is left
+        leaves.clear();
+        stack = {node.a, node.b};
+        while (!stack.empty()) {
+          const auto y = stack.back();
+          stack.pop_back();
+          if (liveness.is_absorbed(graph, y)) {
+            stack.push_back(graph.get(y).a);
+            stack.push_back(graph.get(y).b);
+          } else {
+            leaves.emplace_back(new_graph.depth(new_nodes[y]), new_nodes[y]);
+          }
+        }
+        std::priority_queue<leaf_t, std::vector<leaf_t>, std::greater<leaf_t>> queue(
+            std::greater<leaf_t>(), std::move(leaves));
+        while (queue.size() > 1) {
+          const auto first = queue.top().second;
+          queue.pop();
+          const auto second = queue.top().second;
+          queue.pop();
+          const auto combined = new_graph.make_gate(node.type, first, second);
+          queue.emplace(new_graph.depth(combined), combined);
+        }
+        new_nodes[x] = queue.top().second;
+        leaves = {};
+        break;
+      }
+      case NodeType::input:
+        break;
+    }
+  }
+  for (auto output : circuit.outputs) {
+    result.outputs.push_back(new_nodes[output]);
+  }
+  return result;
+}
+
+PrimitiveOperationType to_operation_type(NodeType type) {
+  switch (type) {
+    case NodeType::INV:
+      return PrimitiveOperationType::INV;
+    case NodeType::XOR:
+      return PrimitiveOperationType::XOR;
+    case NodeType::AND:
+      return PrimitiveOperationType::AND;
+    case NodeType::OR:
+      return PrimitiveOperationType::OR;
+    default:
+      throw std::logic_error("not a gate");
+  }
+}
+
+// write the live gates of the circuit, the outputs need to be the last wires
+AlgorithmDescription to_algorithm(const Circuit& circuit, const AlgorithmDescription& original) {
+  const auto& graph = circuit.graph;
+  const Liveness liveness(circuit);
+  const auto num_inputs = graph.get_num_inputs();
+  const auto num_outputs = circuit.outputs.size();
+
+  // a gate computes the first output it is used for directly, other outputs, e.g., inputs,
+  // constants or duplicates, are computed by two INVs (or an XOR of a wire with itself)
+  std::vector<std::size_t> output_indices(graph.size(), no_node);
+  std::vector<bool> is_direct_output(num_outputs, false);
+  std::size_t num_internal_wires = 0;
+  for (std::size_t output_i = 0; output_i < num_outputs; ++output_i) {
+    const auto output = circuit.outputs[output_i];
+    if (is_gate(graph.type(output)) && output_indices[output] == no_node) {
+      output_indices[output] = output_i;
+      is_direct_output[output_i] = true;
+    } else if (graph.type(output) != NodeType::constant || graph.get(output).a) {
+      ++num_internal_wires;
+    }
+  }
+  for (std::size_t x = num_inputs; x < graph.size(); ++x) {
+    if (liveness.is_live[x] && is_gate(graph.type(x)) && output_indices[x] == no_node) {
+      ++num_internal_wires;
+    }
+  }
+
+  AlgorithmDescription algo;
+  algo.n_input_wires_parent_a_ = original.n_input_wires_parent_a_;
+  algo.n_input_wires_parent_b_ = original.n_input_wires_parent_b_;
+  algo.n_output_wires_ = num_outputs;
+  algo.n_wires_ = num_inputs + num_internal_wires + num_outputs;
+  const auto first_output_wire = num_inputs + num_internal_wires;
+
+  std::vector<std::size_t> wires(graph.size(), no_node);
+  for (std::size_t x = 0; x < num_inputs; ++x) {
+    wires[x] = x;
+  }
+  std::size_t next_wire = num_inputs;
+  for (std::size_t x = num_inputs; x < graph.size(); ++x) {
+    const auto node = graph.get(x);
+    if (!liveness.is_live[x] || !is_gate(node.type)) {
+      continue;
+    }
+    wires[x] =
+        output_indices[x] == no_node ? next_wire++ : first_output_wire + output_indices[x];
+    PrimitiveOperation op{.type_ = to_operation_type(node.type),
+                          .parent_a_ = wires[node.a],
+                          .output_wire_ = wires[x]};
+    if (node.type != NodeType::INV) {
+      op.parent_b_ = wires[node.b];
+    }
+    algo.gates_.push_back(op);
+  }
+  for (std::size_t output_i = 0; output_i < num_outputs; ++output_i) {
+    if (is_direct_output[output_i]) {
+      continue;
+    }
+    const auto output = circuit.outputs[output_i];
+    const auto output_wire = first_output_wire + output_i;
+    if (graph.type(output) == NodeType::constant) {
+      const bool value = graph.get(output).a;
+      algo.gates_.push_back({.type_ = PrimitiveOperationType::XOR,
+                             .parent_a_ = 0,
+                             .parent_b_ = 0,
+                             .output_wire_ = value ? next_wire : output_wire});
+      if (!value) {
+        continue;
+      }
+    } else {
+      algo.gates_.push_back({.type_ = PrimitiveOperationType::INV,
+                             .parent_a_ = wires[output],
+                             .output_wire_ = next_wire});
+    }
+    algo.gates_.push_back({.type_ = PrimitiveOperationType::INV,
+                           .parent_a_ = next_wire,
+                           .output_wire_ = output_wire});
+    ++next_wire;
+  }
+  if (next_wire != first_output_wire) {
+    throw std::logic_error("OptimizeCircuit: wrong number of wires");
+  }
+  algo.n_gates_ = algo.gates_.size();
+  return algo;
+}
+
+std::optional<Circuit> from_algorithm(const AlgorithmDescription& algo) {
+  const auto num_inputs = algo.n_input_wires_parent_a_ + algo.n_input_wires_parent_b_.value_or(0);
+  if (num_inputs == 0 || algo.n_output_wires_ > algo.n_wires_) {
+    return std::nullopt;
+  }
+  Circuit circuit{CircuitGraph(num_inputs), {}};
+  std::vector<node_id> wire_nodes(algo.n_wires_, no_node);
+  for (std::size_t wire_i = 0; wire_i < num_inputs; ++wire_i) {
+    wire_nodes.at(wire_i) = wire_i;
+  }
+  const auto get_node = [&wire_nodes](std::size_t wire) {
+    if (wire >= wire_nodes.size() || wire_nodes[wire] == no_node) {
+      throw std::invalid_argument(
+          fmt::format("OptimizeCircuit: wire {} is used before it is assigned", wire));
+    }
+    return wire_nodes[wire];
+  };
+  for (const auto& op : algo.gates_) {
+    NodeType type;
+    switch (op.type_) {
+      case PrimitiveOperationType::INV:
+        type = NodeType::INV;
+        break;
+      case PrimitiveOperationType::XOR:
+        type = NodeType::XOR;
+        break;
+      case PrimitiveOperationType::AND:
+        type = NodeType::AND;
+        break;
+      case PrimitiveOperationType::OR:
+        type = NodeType::OR;
+        break;
+      default:
+        return std::nullopt;
+    }
+    if ((type == NodeType::INV) == op.parent_b_.has_value() || op.selection_bit_.has_value()) {
+      return std::nullopt;
+    }
+    const auto x = get_node(op.parent_a_);
+    const auto y = op.parent_b_.has_value() ? get_node(*op.parent_b_) : no_node;
+    wire_nodes.at(op.output_wire_) = circuit.graph.make_gate(type, x, y);
+  }
+  for (std::size_t wire_i = algo.n_wires_ - algo.n_output_wires_; wire_i < algo.n_wires_;
+       ++wire_i) {
+    circuit.outputs.push_back(get_node(wire_i));
+  }
+  return circuit;
+}
+
+}  // namespace
+
+AlgorithmDescription OptimizeCircuit(const AlgorithmDescription& algo) {
+  auto circuit = from_algorithm(algo);
+  if (!circuit.has_value()) {
+    return algo;
+  }
+  // every round can only decrease the number of ANDs and the depth, stop if neither changes
+  constexpr std::size_t max_num_rounds = 8;
+  auto cost = count_and_depth(*circuit);
+  for (std::size_t round_i = 0; round_i < max_num_rounds; ++round_i) {
+    auto next_circuit = restructure(*circuit);
+    const auto next_cost = count_and_depth(next_circuit);
+    if (next_cost.first > cost.first || next_cost.second > cost.second) {
+      break;
+    }
+    const bool improved = next_cost != cost;
+    circuit = std::move(next_circuit);
+    cost = next_cost;
+    if (!improved) {
+      break;
+    }
+  }
+  auto optimized_algo = to_algorithm(*circuit, algo);
+  // keep the original if its representation is smaller, e.g., since outputs had to be copied
+  const auto stats = ComputeCircuitStatistics(algo);
+  const auto optimized_stats = ComputeCircuitStatistics(optimized_algo);
+  if (std::pair(optimized_stats.num_and_gates + optimized_stats.num_or_gates,
+                optimized_stats.and_depth) >
+      std::pair(stats.num_and_gates + stats.num_or_gates, stats.and_depth)) {
+    return algo;
+  }
+  return optimized_algo;
+}
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,55 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "algorithm_description.h"
+
+namespace ENCRYPTO {
+
+// size and depth of a Boolean circuit, AND and OR gates need communication in GMW and BEAVY
+struct CircuitStatistics {
+  std::size_t num_gates = 0;
+  std::size_t num_and_gates = 0;
+  std::size_t num_or_gates = 0;
+  std::size_t num_xor_gates = 0;
+  std::size_t num_inv_gates = 0;
+  // largest number of gates other than XOR and INV on a path from an input to an output
+  std::size_t and_depth = 0;
+};
+
+CircuitStatistics ComputeCircuitStatistics(const AlgorithmDescription& algo);
+
+// Optimize a Boolean circuit of XOR, AND, OR and INV gates before its gates are instantiated:
+//
+// - constants, e.g., x ^ x, are propagated and equal gates are merged
+// - gates which do not contribute to an output are removed
+// - x & y ^ x & z is rewritten as x & (y ^ z)
+// - trees of AND (OR) gates are rebalanced such that the deepest inputs enter last
+//
+// The inputs and outputs keep their wire ids.  A circuit with other gate types is returned
+// unchanged.
+AlgorithmDescription OptimizeCircuit(const AlgorithmDescription& algo);
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,313 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "edit_distance.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "protocols/beavy/beavy_provider.h"
+#include "utility/typedefs.h"
+#include "wire/new_wire.h"
+
+namespace MOTION {
+
+namespace {
+
+// difference of two neighbouring cells of the DP, where pos is set for 1 and neg for -1
+template <typename Bit>
+struct Difference {
+  Bit pos;
+  Bit neg;
+};
+
+// Evaluates the banded DP anti-diagonal by anti-diagonal and returns the increments
+// D[i][i] - D[i - 1][i - 1] for i = 1, ..., m, which are bits.  mismatch(i, j) is the mismatch
+// bit of pattern character i - 1 and text character j - 1.  All ANDs of an anti-diagonal are
+// computed by a single call of ops.and_all().
+//
+// With the differences dh = D[i - 1][j] - D[i - 1][j - 1] of the upper and dv = D[i][j - 1] -
+// D[i - 1][j - 1] of the left neighbour, the increment z = D[i][j] - D[i - 1][j - 1] is
+// min(c, dh + 1, dv + 1) = c & ~dh.neg & ~dv.neg.  The differences of the cell are z - dh and
+// z - dv, where z = 1 implies dh, dv >= 0 and dh = 1 implies z = 0, s.t. each of their bits is
+// an AND of at most 4 bits, XORed with one of the neighbours' bits.
+template <typename Ops, typename Mismatch>
+std::vector<typename Ops::Bit> diagonal_increments(Ops& ops, std::size_t m, std::size_t band,
+                                                   const Mismatch& mismatch) {
+  using Bit = typename Ops::Bit;
+  const auto in_band = [m, band](std::size_t i, std::size_t j) {
+    return i <= m && j <= m && (i > j ? i - j : j - i) <= band;
+  };
+  // the differences of row 0 and column 0 are 1, and cells outside of the band are infinite,
+  // which is equivalent to a difference of 1 since the minimum is at most 1 above the diagonal
+  // neighbour
+  const Difference<Bit> one{ops.constant(true), ops.constant(false)};
+  const auto width = 2 * band + 1;
+  const auto index = [band, width](std::size_t i, std::size_t j) {
+    return i * width + j + band - i;
+  };
+  // differences of the cells in the band to their upper (vertical) and left (horizontal) neighbour
+  std::vector<std::optional<Difference<Bit>>> vertical((m + 1) * width);
+  std::vector<std::optional<Difference<Bit>>> horizontal((m + 1) * width);
+  const auto get = [&](const auto& differences, std::size_t i, std::size_t j) {
+    if (i == 0 || j == 0 || !in_band(i, j)) {
+      return one;
+    }
+    return *differences[index(i, j)];
+  };
+
+  struct Cell {
+    std::size_t i;
+    std::size_t j;
+    Difference<Bit> dh;
+    Difference<Bit> dv;
+    bool need_vertical;
+    bool need_horizontal;
+  };
+  std::vector<Bit> increments(m);
+  for (std::size_t d = 2; d <= 2 * m; ++d) {
+    std::vector<Cell> cells;
+    std::vector<std::vector<Bit>> terms;
+    for (std::size_t i = d > m ? d - m : 1; i <= std::min(m, d - 1); ++i) {
+      const auto j = d - i;
+      if (!in_band(i, j)) {
+        continue;
+      }
+      const auto c = mismatch(i, j);
+      const auto dh = get(horizontal, i - 1, j);
+      const auto dv = get(vertical, i, j - 1);
+      // the differences are only needed by the right and the lower neighbour in the band
+      Cell cell{i, j, dh, dv, in_band(i, j + 1), in_band(i + 1, j)};
+      const auto not_dh_neg = ops.inv(dh.neg);
+      const auto not_dv_neg = ops.inv(dv.neg);
+      if (i == j) {
+        terms.push_back({c, not_dh_neg, not_dv_neg});
+      }
+      if (cell.need_vertical) {
+        // z - dh is 1 iff z = 1 and dh = 0, or dh = -1, and -1 iff z = 0 and dh = 1
+        terms.push_back({c, not_dh_neg, not_dv_neg, ops.inv(dh.pos)});
+        terms.push_back({c, not_dv_neg, dh.pos});
+      }
+      if (cell.need_horizontal) {
+        terms.push_back({c, not_dh_neg, not_dv_neg, ops.inv(dv.pos)});
+        terms.push_back({c, not_dh_neg, dv.pos});
+      }
+      cells.push_back(std::move(cell));
+    }
+
+    const auto products = ops.and_all(terms);
+    std::size_t term_i = 0;
+    for (const auto& cell : cells) {
+      if (cell.i == cell.j) {
+        increments[cell.i - 1] = products[term_i++];
+      }
+      if (cell.need_vertical) {
+        vertical[index(cell.i, cell.j)] =
+            Difference<Bit>{ops.xor_(products[term_i], cell.dh.neg),
+                            ops.xor_(cell.dh.pos, products[term_i + 1])};
+        term_i += 2;
+      }
+      if (cell.need_horizontal) {
+        horizontal[index(cell.i, cell.j)] =
+            Difference<Bit>{ops.xor_(products[term_i], cell.dv.neg),
+                            ops.xor_(cell.dv.pos, products[term_i + 1])};
+        term_i += 2;
+      }
+    }
+  }
+  return increments;
+}
+
+struct PlainOps {
+  using Bit = bool;
+  bool constant(bool value) const { return value; }
+  bool inv(bool a) const { return !a; }
+  bool xor_(bool a, bool b) const { return a != b; }
+  std::vector<bool> and_all(const std::vector<std::vector<bool>>& terms) const {
+    std::vector<bool> products;
+    for (const auto& term : terms) {
+      products.push_back(std::all_of(std::begin(term), std::end(term), [](bool b) { return b; }));
+    }
+    return products;
+  }
+};
+
+// A bit which is either a public constant or held by a BooleanBEAVY wire.  Constants are folded
+// when the circuit is built, e.g., for the first row and column of the DP.
+struct SharedBit {
+  std::shared_ptr<NewWire> wire;
+  bool value = false;
+};
+
+class WireOps {
+ public:
+  using Bit = SharedBit;
+
+  explicit WireOps(proto::beavy::BEAVYProvider& beavy_provider) : beavy_provider_(beavy_provider) {}
+
+  SharedBit constant(bool value) const { return {nullptr, value}; }
+  SharedBit wire(std::shared_ptr<NewWire> wire) const { return {std::move(wire)}; }
+
+  SharedBit inv(const SharedBit& a) {
+    if (!a.wire) {
+      return constant(!a.value);
+    }
+    return wire(beavy_provider_.make_unary_gate(ENCRYPTO::PrimitiveOperationType::INV, {a.wire})
+                    .at(0));
+  }
+
+  SharedBit xor_(const SharedBit& a, const SharedBit& b) {
+    if (!a.wire) {
+      return a.value ? inv(b) : b;
+    }
+    if (!b.wire) {
+      return b.value ? inv(a) : a;
+    }
+    return wire(beavy_provider_
+                    .make_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR, {a.wire}, {b.wire})
+                    .at(0));
+  }
+
+  // The products of each term, where the terms with the same number of wires are evaluated by
+  // one multi-input AND, i.e., in one round for up to 4 wires.
+  std::vector<SharedBit> and_all(const std::vector<std::vector<SharedBit>>& terms) {
+    std::vector<SharedBit> products(terms.size());
+    // term indices and the operands of a multi-input AND per number of wires
+    std::map<std::size_t, std::pair<std::vector<std::size_t>, std::vector<WireVector>>> groups;
+    for (std::size_t term_i = 0; term_i < terms.size(); ++term_i) {
+      WireVector wires;
+      bool is_zero = false;
+      for (const auto& bit : terms[term_i]) {
+        if (bit.wire) {
+          wires.push_back(bit.wire);
+        } else {
+          is_zero |= !bit.value;
+        }
+      }
+      if (is_zero || wires.empty()) {
+        products[term_i] = constant(!is_zero);
+      } else if (wires.size() == 1) {
+        products[term_i] = wire(wires[0]);
+      } else {
+        auto& [indices, operands] = groups[wires.size()];
+        operands.resize(wires.size());
+        indices.push_back(term_i);
+        for (std::size_t k = 0; k < wires.size(); ++k) {
+          operands[k].push_back(wires[k]);
+        }
+      }
+    }
+    for (const auto& [num_wires, group] : groups) {
+      const auto& [indices, operands] = group;
+      const auto outputs = beavy_provider_.make_multi_and_gate(operands);
+      for (std::size_t k = 0; k < indices.size(); ++k) {
+        products[indices[k]] = wire(outputs.at(k));
+      }
+    }
+    return products;
+  }
+
+ private:
+  proto::beavy::BEAVYProvider& beavy_provider_;
+};
+
+}  // namespace
+
+std::size_t banded_edit_distance(std::span<const std::uint64_t> pattern,
+                                 std::span<const std::uint64_t> text, std::size_t band) {
+  if (pattern.empty() || pattern.size() != text.size()) {
+    throw std::invalid_argument(fmt::format("banded_edit_distance: strings of size {} and {}",
+                                            pattern.size(), text.size()));
+  }
+  PlainOps ops;
+  const auto increments =
+      diagonal_increments(ops, pattern.size(), band, [&](std::size_t i, std::size_t j) {
+        return pattern[i - 1] != text[j - 1];
+      });
+  return std::count(std::begin(increments), std::end(increments), true);
+}
+
+WireVector make_banded_edit_distance_circuit(proto::beavy::BEAVYProvider& beavy_provider,
+                                             const WireVector& text, const WireVector& pattern,
+                                             std::size_t bits_per_character, std::size_t band) {
+  if (bits_per_character == 0 || text.empty() || text.size() != pattern.size() ||
+      text.size() % bits_per_character != 0) {
+    throw std::invalid_argument(fmt::format(
+        "make_banded_edit_distance_circuit: {} text and {} pattern wires for {} bits per character",
+        text.size(), pattern.size(), bits_per_character));
+  }
+  const auto is_beavy = [](const auto& wire) {
+    return wire->get_protocol() == MPCProtocol::BooleanBEAVY;
+  };
+  if (!std::all_of(std::begin(text), std::end(text), is_beavy) ||
+      !std::all_of(std::begin(pattern), std::end(pattern), is_beavy)) {
+    throw std::invalid_argument("make_banded_edit_distance_circuit: needs BooleanBEAVY wires");
+  }
+  const auto m = text.size() / bits_per_character;
+  WireOps ops(beavy_provider);
+
+  // a character matches iff all bits of text ^ ~pattern are set, and the mismatch bits of all
+  // cells in the band are computed by the same multi-input ANDs before the DP
+  std::vector<SharedBit> not_pattern;
+  for (const auto& wire : pattern) {
+    not_pattern.push_back(ops.inv(ops.wire(wire)));
+  }
+  std::map<std::pair<std::size_t, std::size_t>, std::size_t> cell_indices;
+  std::vector<std::vector<SharedBit>> equal_bits;
+  for (std::size_t i = 1; i <= m; ++i) {
+    for (std::size_t j = i > band ? i - band : 1; j <= std::min(m, i + band); ++j) {
+      std::vector<SharedBit> bits;
+      for (std::size_t bit_j = 0; bit_j < bits_per_character; ++bit_j) {
+        bits.push_back(ops.xor_(ops.wire(text[(j - 1) * bits_per_character + bit_j]),
+                                not_pattern[(i - 1) * bits_per_character + bit_j]));
+      }
+      cell_indices[{i, j}] = equal_bits.size();
+      equal_bits.push_back(std::move(bits));
+    }
+  }
+  auto matches = ops.and_all(equal_bits);
+  std::vector<SharedBit> mismatches;
+  for (const auto& match : matches) {
+    mismatches.push_back(ops.inv(match));
+  }
+
+  const auto increments =
+      diagonal_increments(ops, m, band, [&](std::size_t i, std::size_t j) {
+        return mismatches[cell_indices.at({i, j})];
+      });
+  // the increments are ANDs with a mismatch bit, so they are wires or constant 0
+  WireVector increment_wires;
+  for (const auto& increment : increments) {
+    if (increment.wire) {
+      increment_wires.push_back(increment.wire);
+    } else if (increment.value) {
+      throw std::logic_error("make_banded_edit_distance_circuit: constant increment");
+    }
+  }
+  return beavy_provider.make_unary_gate(ENCRYPTO::PrimitiveOperationType::COUNT, increment_wires);
+}
+
+}  // namespace MOTION
@@ -0,0 +1,63 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace MOTION {
+
+class NewWire;
+using WireVector = std::vector<std::shared_ptr<NewWire>>;
+
+namespace proto::beavy {
+class BEAVYProvider;
+}  // namespace proto::beavy
+
+// Banded edit distance, i.e., the Levenshtein distance where the alignments may only use cells
+// (i, j) of the DP with |i - j| <= band, between a pattern and strings of the same length.
+//
+// The DP is not evaluated on the distances, but on the differences of neighbouring cells, which
+// are in {-1, 0, 1} and encoded by two bits each (as in the bit-parallel algorithms of Myers and
+// Hyyrö).  Then each cell needs 4-input ANDs of its mismatch bit and the differences of its upper
+// and left neighbour, and all cells of an anti-diagonal are evaluated in one round, i.e., 2 *
+// pattern_size - 1 rounds for any band.  The distance is the sum of the increments along the main
+// diagonal.  Cells outside of the band are treated as infinite.
+
+// the distance on plain values computed by the same recurrences
+std::size_t banded_edit_distance(std::span<const std::uint64_t> pattern,
+                                 std::span<const std::uint64_t> text, std::size_t band);
+
+// Distances between the pattern and every window of the text, both in the layout of the
+// PatternMatcher: wire k * bits_per_character + j holds bit j of character k of the window (or
+// the pattern) in every SIMD value.  The mismatch bits of all cells are computed in
+// ceil(log_4(bits_per_character)) rounds before the DP.  The output is a single additively shared
+// arithmetic wire of 64 bit values, e.g., for BEAVYProvider::make_threshold_gate() with bound
+// pattern_size + 1.  Throws std::invalid_argument for inputs which do not fit this layout.
+WireVector make_banded_edit_distance_circuit(proto::beavy::BEAVYProvider&, const WireVector& text,
+                                             const WireVector& pattern,
+                                             std::size_t bits_per_character, std::size_t band);
+
+}  // namespace MOTION
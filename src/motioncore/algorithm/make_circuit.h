@@ -32,9 +32,12 @@ namespace MOTION {
 
 using WireVector = std::vector<std::shared_ptr<NewWire>>;
 
-template <typename Builder>
-WireVector make_circuit(Builder& builder, const ENCRYPTO::AlgorithmDescription& algo,
-                        const WireVector& wires_in_a, const WireVector& wires_in_b) {
+namespace detail {
+
+// check the number of input wires and return a vector for all wires of the circuit, starting with
+// the input wires
+inline WireVector load_circuit_inputs(const ENCRYPTO::AlgorithmDescription& algo,
+                                      const WireVector& wires_in_a, const WireVector& wires_in_b) {
   if (!algo.n_input_wires_parent_b_.has_value()) {
     throw std::invalid_argument("AlgorithmDescription expects 1 input but 2 are provided");
   }
@@ -52,6 +55,15 @@ WireVector make_circuit(Builder& builder, const ENCRYPTO::AlgorithmDescription&
   // load the input wires into vector
   auto it = std::copy(std::begin(wires_in_a), std::end(wires_in_a), std::begin(circuit_wires));
   std::copy(std::begin(wires_in_b), std::end(wires_in_b), it);
+  return circuit_wires;
+}
+
+}  // namespace detail
+
+template <typename Builder>
+WireVector make_circuit(Builder& builder, const ENCRYPTO::AlgorithmDescription& algo,
+                        const WireVector& wires_in_a, const WireVector& wires_in_b) {
+  auto circuit_wires = detail::load_circuit_inputs(algo, wires_in_a, wires_in_b);
   // create all the gates gate
   for (const auto& prim_op : algo.gates_) {
     auto op_type = prim_op.type_;
@@ -70,22 +82,14 @@ WireVector make_circuit(Builder& builder, const ENCRYPTO::AlgorithmDescription&
   return output_wires;
 }
 
+namespace detail {
+
+// construct the gates of the circuit whose input wires are already in circuit_wires
 template <typename Builder>
-std::pair<std::vector<std::unique_ptr<NewGate>>, WireVector> construct_circuit(
-    Builder& builder, const ENCRYPTO::AlgorithmDescription& algo, const WireVector& wires_in_a) {
-  if (algo.n_input_wires_parent_b_.has_value()) {
-    throw std::invalid_argument("AlgorithmDescription expects 2 input but only 1 is provided");
-  }
-  if (algo.n_input_wires_parent_a_ != wires_in_a.size()) {
-    throw std::invalid_argument(
-        fmt::format("AlgorithmDescription expects {} wires for input a, but {} are provided",
-                    algo.n_input_wires_parent_a_, wires_in_a.size()));
-  }
+std::pair<std::vector<std::unique_ptr<NewGate>>, WireVector> construct_circuit_gates(
+    Builder& builder, const ENCRYPTO::AlgorithmDescription& algo, WireVector& circuit_wires) {
   std::vector<std::unique_ptr<NewGate>> gates;
   gates.reserve(algo.n_gates_);
-  WireVector circuit_wires(algo.n_wires_);
-  // load the input wires into vector
-  std::copy(std::begin(wires_in_a), std::end(wires_in_a), std::begin(circuit_wires));
   // create all the gates gate
   for (const auto& prim_op : algo.gates_) {
     auto op_type = prim_op.type_;
@@ -107,4 +111,47 @@ std::pair<std::vector<std::unique_ptr<NewGate>>, WireVector> construct_circuit(
   return {std::move(gates), std::move(output_wires)};
 }
 
+}  // namespace detail
+
+template <typename Builder>
+std::pair<std::vector<std::unique_ptr<NewGate>>, WireVector> construct_circuit(
+    Builder& builder, const ENCRYPTO::AlgorithmDescription& algo, const WireVector& wires_in_a) {
+  if (algo.n_input_wires_parent_b_.has_value()) {
+    throw std::invalid_argument("AlgorithmDescription expects 2 input but only 1 is provided");
+  }
+  if (algo.n_input_wires_parent_a_ != wires_in_a.size()) {
+    throw std::invalid_argument(
+        fmt::format("AlgorithmDescription expects {} wires for input a, but {} are provided",
+                    algo.n_input_wires_parent_a_, wires_in_a.size()));
+  }
+  WireVector circuit_wires(algo.n_wires_);
+  // load the input wires into vector
+  std::copy(std::begin(wires_in_a), std::end(wires_in_a), std::begin(circuit_wires));
+  return detail::construct_circuit_gates(builder, algo, circuit_wires);
+}
+
+template <typename Builder>
+std::pair<std::vector<std::unique_ptr<NewGate>>, WireVector> construct_circuit(
+    Builder& builder, const ENCRYPTO::AlgorithmDescription& algo, const WireVector& wires_in_a,
+    const WireVector& wires_in_b) {
+  if (!algo.n_input_wires_parent_b_.has_value()) {
+    throw std::invalid_argument("AlgorithmDescription expects 1 input but 2 are provided");
+  }
+  if (algo.n_input_wires_parent_a_ != wires_in_a.size()) {
+    throw std::invalid_argument(
+        fmt::format("AlgorithmDescription expects {} wires for input a, but {} are provided",
+                    algo.n_input_wires_parent_a_, wires_in_a.size()));
+  }
+  if (*algo.n_input_wires_parent_b_ != wires_in_b.size()) {
+    throw std::invalid_argument(
+        fmt::format("AlgorithmDescription expects {} wires for input b, but {} are provided",
+                    *algo.n_input_wires_parent_b_, wires_in_b.size()));
+  }
+  WireVector circuit_wires(algo.n_wires_);
+  // load the input wires into vector
+  auto it = std::copy(std::begin(wires_in_a), std::end(wires_in_a), std::begin(circuit_wires));
+  std::copy(std::begin(wires_in_b), std::end(wires_in_b), it);
+  return detail::construct_circuit_gates(builder, algo, circuit_wires);
+}
+
 }  // namespace MOTION
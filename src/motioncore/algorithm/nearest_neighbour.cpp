@@ -0,0 +1,374 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "nearest_neighbour.h"
+
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "protocols/beavy/beavy_provider.h"
+#include "protocols/beavy/wire.h"
+#include "protocols/plain/constant_folding.h"
+#include "statistics/circuit_analysis.h"
+#include "utility/logger.h"
+
+namespace MOTION {
+
+using proto::beavy::ArithmeticBEAVYWire;
+using proto::beavy::BooleanBEAVYWire;
+
+// The threshold test of the tournament supports values below this bound.
+constexpr std::size_t max_comparison_bound = std::size_t(1) << 16;
+
+std::string NearestNeighbourStatistics::print_human_readable() const {
+  std::stringstream ss;
+  ss << fmt::format("Nearest neighbours: {} searches in a gallery of {} templates, {} circuits\n",
+                    num_searches, gallery_size, num_circuits)
+     << fmt::format("Gallery sharing:    {:10.3f} ms\n", gallery_sharing_ms)
+     << fmt::format("Searches total:     {:10.3f} ms\n", searches_ms)
+     << fmt::format("Mean latency:       {:10.3f} ms/search\n", get_mean_latency_ms())
+     << fmt::format("Last latency:       {:10.3f} ms\n", last_search_ms)
+     << fmt::format("Online rounds:      {:10}\n", max_online_rounds);
+  return ss.str();
+}
+
+HammingNearestNeighbours::HammingNearestNeighbours(
+    Communication::CommunicationLayer& communication_layer, std::size_t gallery_owner,
+    std::size_t template_bits, std::size_t num_threads, std::shared_ptr<Logger> logger)
+    : communication_layer_(communication_layer),
+      my_id_(communication_layer.get_my_id()),
+      gallery_owner_(gallery_owner),
+      template_bits_(template_bits),
+      num_threads_(num_threads),
+      logger_(std::move(logger)) {
+  if (communication_layer.get_num_parties() != 2) {
+    throw std::logic_error("HammingNearestNeighbours: currently only two parties are supported");
+  }
+  if (gallery_owner_ > 1) {
+    throw std::invalid_argument(
+        fmt::format("HammingNearestNeighbours: invalid gallery owner {}", gallery_owner_));
+  }
+  // the differences of two distances need to be below the bound of the threshold test
+  if (template_bits_ == 0 || 2 * template_bits_ + 1 > max_comparison_bound) {
+    throw std::invalid_argument(fmt::format(
+        "HammingNearestNeighbours: invalid number of bits per template {}", template_bits_));
+  }
+}
+
+HammingNearestNeighbours::~HammingNearestNeighbours() = default;
+
+TwoPartyBackend& HammingNearestNeighbours::get_backend() {
+  if (backend_) {
+    backend_->reset();
+  } else {
+    backend_ =
+        std::make_unique<TwoPartyBackend>(communication_layer_, num_threads_, false, logger_);
+  }
+  return *backend_;
+}
+
+void HammingNearestNeighbours::share_gallery(const std::vector<ENCRYPTO::BitVector<>>& templates) {
+  if (my_id_ != gallery_owner_) {
+    throw std::logic_error("HammingNearestNeighbours: only the gallery owner can provide it");
+  }
+  if (templates.empty()) {
+    throw std::invalid_argument("HammingNearestNeighbours: gallery must not be empty");
+  }
+  const auto gallery_size = templates.size();
+  BitValues bit_planes(template_bits_, ENCRYPTO::BitVector<>(gallery_size));
+  for (std::size_t template_i = 0; template_i < gallery_size; ++template_i) {
+    const auto& bits = templates[template_i];
+    if (bits.GetSize() != template_bits_) {
+      throw std::invalid_argument(
+          fmt::format("HammingNearestNeighbours: template {} has {} bits instead of {}",
+                      template_i, bits.GetSize(), template_bits_));
+    }
+    for (std::size_t bit_j = 0; bit_j < template_bits_; ++bit_j) {
+      if (bits.Get(bit_j)) {
+        bit_planes[bit_j].Set(true, template_i);
+      }
+    }
+  }
+  share_gallery_planes(std::move(bit_planes), gallery_size);
+}
+
+void HammingNearestNeighbours::share_gallery(std::size_t gallery_size) {
+  if (my_id_ == gallery_owner_) {
+    throw std::logic_error("HammingNearestNeighbours: the gallery owner needs to provide it");
+  }
+  if (gallery_size == 0) {
+    throw std::invalid_argument("HammingNearestNeighbours: gallery must not be empty");
+  }
+  share_gallery_planes({}, gallery_size);
+}
+
+void HammingNearestNeighbours::share_gallery_planes(BitValues&& bit_planes,
+                                                    std::size_t gallery_size) {
+  const auto start = clock_type::now();
+  {
+    auto& backend = get_backend();
+    auto& gate_factory = backend.get_gate_factory(MPCProtocol::BooleanBEAVY);
+    WireVector wires;
+    if (my_id_ == gallery_owner_) {
+      auto [promise, my_wires] =
+          gate_factory.make_boolean_input_gate_my(gallery_owner_, template_bits_, gallery_size);
+      promise.set_value(std::move(bit_planes));
+      wires = std::move(my_wires);
+    } else {
+      wires =
+          gate_factory.make_boolean_input_gate_other(gallery_owner_, template_bits_, gallery_size);
+    }
+    backend.run();
+    gallery_public_shares_.clear();
+    gallery_secret_shares_.clear();
+    for (const auto& wire : wires) {
+      auto beavy_wire = std::dynamic_pointer_cast<BooleanBEAVYWire>(wire);
+      beavy_wire->wait_online();
+      gallery_public_shares_.push_back(beavy_wire->get_public_share());
+      gallery_secret_shares_.push_back(beavy_wire->get_secret_share());
+    }
+    gallery_size_ = gallery_size;
+    communication_layer_.sync();
+  }
+  statistics_.gallery_size = gallery_size;
+  statistics_.gallery_sharing_ms +=
+      std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void HammingNearestNeighbours::check_search(std::size_t k) const {
+  if (gallery_size_ == 0) {
+    throw std::logic_error(
+        "HammingNearestNeighbours: share_gallery() needs to be called before search()");
+  }
+  if (k == 0 || k > gallery_size_) {
+    throw std::invalid_argument(fmt::format(
+        "HammingNearestNeighbours: cannot search {} of {} templates", k, gallery_size_));
+  }
+  // with penalties, the distances are at most 2 * template_bits_ + 1
+  if (k > 1 && 4 * template_bits_ + 3 > max_comparison_bound) {
+    throw std::invalid_argument(fmt::format(
+        "HammingNearestNeighbours: templates of {} bits support only k = 1", template_bits_));
+  }
+}
+
+std::vector<std::size_t> HammingNearestNeighbours::search(const ENCRYPTO::BitVector<>& query,
+                                                          std::size_t k) {
+  if (my_id_ == gallery_owner_) {
+    throw std::logic_error("HammingNearestNeighbours: only the query owner can provide a query");
+  }
+  if (query.GetSize() != template_bits_) {
+    throw std::invalid_argument(
+        fmt::format("HammingNearestNeighbours: query has {} bits instead of {}", query.GetSize(),
+                    template_bits_));
+  }
+  check_search(k);
+  return run_search(&query, k);
+}
+
+void HammingNearestNeighbours::search(std::size_t k) {
+  if (my_id_ != gallery_owner_) {
+    throw std::logic_error("HammingNearestNeighbours: the query owner needs to provide a query");
+  }
+  check_search(k);
+  run_search(nullptr, k);
+}
+
+std::vector<std::size_t> HammingNearestNeighbours::run_search(const ENCRYPTO::BitVector<>* query,
+                                                              std::size_t k) {
+  const auto start = clock_type::now();
+  std::vector<std::size_t> found;
+  for (std::size_t neighbour_i = 0; neighbour_i < k; ++neighbour_i) {
+    const auto position = run_tournament(query, found, k > 1);
+    if (query != nullptr) {
+      found.push_back(position);
+    }
+  }
+  const auto latency =
+      std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  ++statistics_.num_searches;
+  statistics_.searches_ms += latency;
+  statistics_.last_search_ms = latency;
+  return found;
+}
+
+// Create a wire with BEAVY shares of a Boolean value which are already available.
+static std::shared_ptr<BooleanBEAVYWire> make_ready_wire(
+    const ENCRYPTO::BitVector<>& public_share, const ENCRYPTO::BitVector<>& secret_share) {
+  auto wire = std::make_shared<BooleanBEAVYWire>(public_share.GetSize());
+  wire->get_public_share() = public_share;
+  wire->get_secret_share() = secret_share;
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return wire;
+}
+
+// Create an arithmetic wire with a zero mask, which holds a public value, or, if it is additively
+// shared, this party's share.  It must not be reconstructed on its own.
+static WireVector make_ready_wire(std::vector<std::uint64_t>&& public_share, bool additive) {
+  auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(public_share.size());
+  wire->get_public_share() = std::move(public_share);
+  wire->set_additively_shared(additive);
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return {std::move(wire)};
+}
+
+static std::vector<std::size_t> make_positions(std::size_t first, std::size_t count) {
+  std::vector<std::size_t> positions(count);
+  std::iota(std::begin(positions), std::end(positions), first);
+  return positions;
+}
+
+std::size_t HammingNearestNeighbours::run_tournament(const ENCRYPTO::BitVector<>* query,
+                                                     const std::vector<std::size_t>& found,
+                                                     bool with_penalties) {
+  using ENCRYPTO::PrimitiveOperationType;
+  const auto num_templates = gallery_size_;
+  const auto query_owner = get_query_owner();
+  const bool is_query_owner = my_id_ == query_owner;
+  // a penalty exceeds the distance of any template
+  const std::uint64_t penalty = template_bits_ + 1;
+  const std::uint64_t max_distance = with_penalties ? template_bits_ + penalty : template_bits_;
+
+  if (logger_) {
+    logger_->LogInfo(fmt::format(
+        "HammingNearestNeighbours: searching the nearest of {} templates of {} bits",
+        num_templates, template_bits_));
+  }
+
+  auto& backend = get_backend();
+  auto& boolean_factory = backend.get_gate_factory(MPCProtocol::BooleanBEAVY);
+  auto& arithmetic_factory = backend.get_gate_factory(MPCProtocol::ArithmeticBEAVY);
+  auto& beavy_provider = dynamic_cast<proto::beavy::BEAVYProvider&>(arithmetic_factory);
+
+  WireVector gallery_wires;
+  for (std::size_t bit_j = 0; bit_j < template_bits_; ++bit_j) {
+    gallery_wires.push_back(
+        make_ready_wire(gallery_public_shares_[bit_j], gallery_secret_shares_[bit_j]));
+  }
+  // the query is repeated for each template
+  WireVector query_wires;
+  if (is_query_owner) {
+    BitValues values;
+    values.reserve(template_bits_);
+    for (std::size_t bit_j = 0; bit_j < template_bits_; ++bit_j) {
+      values.emplace_back(num_templates, query->Get(bit_j));
+    }
+    auto [promise, wires] =
+        boolean_factory.make_boolean_input_gate_my(query_owner, template_bits_, num_templates);
+    promise.set_value(std::move(values));
+    query_wires = std::move(wires);
+  } else {
+    query_wires =
+        boolean_factory.make_boolean_input_gate_other(query_owner, template_bits_, num_templates);
+  }
+  const auto mismatches =
+      boolean_factory.make_binary_gate(PrimitiveOperationType::XOR, gallery_wires, query_wires);
+  auto values = boolean_factory.make_unary_gate(PrimitiveOperationType::HAM, mismatches);
+  if (with_penalties) {
+    // only the additive shares of the query owner change, s.t. the gallery owner's view does not
+    // depend on the templates found so far
+    std::vector<std::uint64_t> penalties(num_templates);
+    if (is_query_owner) {
+      for (auto position : found) {
+        penalties[position] = penalty;
+      }
+    }
+    values = arithmetic_factory.make_binary_gate(PrimitiveOperationType::ADD, values,
+                                                 make_ready_wire(std::move(penalties), true));
+  }
+  std::vector<std::uint64_t> initial_positions(num_templates);
+  std::iota(std::begin(initial_positions), std::end(initial_positions), 0);
+  auto positions = make_ready_wire(std::move(initial_positions), false);
+
+  // each level keeps the smaller value of value i and value i + half, and an odd last value
+  for (auto num_values = num_templates; num_values > 1; num_values = (num_values + 1) / 2) {
+    const auto half = num_values / 2;
+    const auto a = beavy_provider.make_arithmetic_lane_map_gate(values, make_positions(0, half));
+    const auto b =
+        beavy_provider.make_arithmetic_lane_map_gate(values, make_positions(half, half));
+    const auto a_position =
+        beavy_provider.make_arithmetic_lane_map_gate(positions, make_positions(0, half));
+    const auto b_position =
+        beavy_provider.make_arithmetic_lane_map_gate(positions, make_positions(half, half));
+    // a <= b iff a - b + max_distance <= max_distance, where the left side lies in
+    // [0, 2 * max_distance]
+    const auto difference = arithmetic_factory.make_binary_gate(
+        PrimitiveOperationType::ADD, a,
+        arithmetic_factory.make_unary_gate(PrimitiveOperationType::NEG, b));
+    const auto shifted = arithmetic_factory.make_binary_gate(
+        PrimitiveOperationType::ADD, difference,
+        proto::plain::make_arithmetic_constant_wire(64, half, max_distance));
+    const auto a_wins = beavy_provider.make_threshold_gate(shifted, 2 * max_distance + 1,
+                                                           max_distance);
+    // min = b + [a <= b] * (a - b), and the same for the positions
+    auto min_values = arithmetic_factory.make_binary_gate(
+        PrimitiveOperationType::ADD, b,
+        arithmetic_factory.make_binary_gate(PrimitiveOperationType::MUL, difference, a_wins));
+    const auto position_difference = arithmetic_factory.make_binary_gate(
+        PrimitiveOperationType::ADD, a_position,
+        arithmetic_factory.make_unary_gate(PrimitiveOperationType::NEG, b_position));
+    auto min_positions = arithmetic_factory.make_binary_gate(
+        PrimitiveOperationType::ADD, b_position,
+        arithmetic_factory.make_binary_gate(PrimitiveOperationType::MUL, position_difference,
+                                            a_wins));
+    if (num_values % 2 == 1) {
+      // the last value is appended to the minima
+      auto next = make_positions(0, half + 1);
+      next[half] = half + num_values - 1;
+      values = beavy_provider.make_arithmetic_lane_map_gate({min_values.at(0), values.at(0)},
+                                                            std::vector<std::size_t>(next));
+      positions = beavy_provider.make_arithmetic_lane_map_gate(
+          {min_positions.at(0), positions.at(0)}, std::move(next));
+    } else {
+      values = std::move(min_values);
+      positions = std::move(min_positions);
+    }
+  }
+
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint64_t>> position_future;
+  if (is_query_owner) {
+    position_future = arithmetic_factory.make_arithmetic_64_output_gate_my(query_owner, positions);
+  } else {
+    arithmetic_factory.make_arithmetic_output_gate_other(query_owner, positions);
+  }
+
+  statistics_.max_online_rounds =
+      std::max(statistics_.max_online_rounds, backend.analyze_circuit().online_rounds_);
+  backend.run();
+  ++statistics_.num_circuits;
+  statistics_.run_time_stats.add(backend.get_run_time_stats());
+
+  if (!is_query_owner) {
+    return 0;
+  }
+  return position_future.get().at(0);
+}
+
+}  // namespace MOTION
@@ -0,0 +1,135 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "statistics/analysis.h"
+#include "utility/bit_vector.h"
+
+namespace MOTION {
+
+class Logger;
+class TwoPartyBackend;
+
+namespace Communication {
+class CommunicationLayer;
+}  // namespace Communication
+
+struct NearestNeighbourStatistics {
+  std::size_t gallery_size = 0;
+  std::size_t num_searches = 0;
+  std::size_t num_circuits = 0;
+  // time to secret share the gallery
+  double gallery_sharing_ms = 0;
+  // total time of the searches, each from the query to its k indices
+  double searches_ms = 0;
+  double last_search_ms = 0;
+  // online rounds of the deepest circuit as predicted by the cost models of its gates
+  std::size_t max_online_rounds = 0;
+  Statistics::AccumulatedRunTimeStats run_time_stats;
+
+  double get_mean_latency_ms() const noexcept {
+    return num_searches ? searches_ms / num_searches : 0;
+  }
+  std::string print_human_readable() const;
+};
+
+// Two-party k nearest neighbour search under the Hamming distance, e.g., of a biometric template
+// in a gallery of enrolled templates.  One party owns the gallery, the other one the queries, and
+// only the positions of the k templates closest to a query are output to the query owner.
+//
+// The gallery is secret shared once, bit plane by bit plane as the text of the PatternMatcher.
+// Per search, the distances of the query to all templates are computed with one XOR and one HAM
+// gate over SIMD values, and the nearest template is found by a tournament over the additively
+// shared distances: each level compares the first half of the remaining values with the second
+// half in one threshold test, and keeps the smaller values and their positions with a
+// multiplication by the comparison bit, s.t. ceil(log_2(gallery size)) levels of a constant
+// number of rounds are needed.  The halves are moved by local lane maps.  A tie is won by the
+// value of the first half.
+//
+// The positions are only output at the root of the tournament.  For k > 1, the search is repeated
+// k times, where the query owner adds a penalty which exceeds any distance to its additive share
+// of the distances of the templates found so far, s.t. the gallery owner learns nothing about
+// them.  The threshold test supports distances of up to 2^15 - 1, hence templates of up to 32767
+// bits for k = 1 and 16383 bits otherwise.  Each comparison sends a one-hot encoding of the
+// next power of two above twice the maximal distance bits, see BEAVYProvider::make_threshold_gate.
+class HammingNearestNeighbours {
+ public:
+  HammingNearestNeighbours(Communication::CommunicationLayer&, std::size_t gallery_owner,
+                           std::size_t template_bits, std::size_t num_threads,
+                           std::shared_ptr<Logger>);
+  ~HammingNearestNeighbours();
+
+  std::size_t get_gallery_owner() const noexcept { return gallery_owner_; }
+  std::size_t get_query_owner() const noexcept { return 1 - gallery_owner_; }
+  std::size_t get_gallery_size() const noexcept { return gallery_size_; }
+
+  // called by the gallery owner with templates of template_bits bits
+  void share_gallery(const std::vector<ENCRYPTO::BitVector<>>& templates);
+  // called by the query owner with the size of the gallery
+  void share_gallery(std::size_t gallery_size);
+
+  // Called by the query owner.  Returns the positions of the k templates closest to the query in
+  // the gallery, ordered by their distance.
+  std::vector<std::size_t> search(const ENCRYPTO::BitVector<>& query, std::size_t k);
+  // called by the gallery owner for each search of the query owner
+  void search(std::size_t k);
+
+  const NearestNeighbourStatistics& get_statistics() const noexcept { return statistics_; }
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // the backend of the previous circuit after a reset, or a new one
+  TwoPartyBackend& get_backend();
+  void share_gallery_planes(std::vector<ENCRYPTO::BitVector<>>&& bit_planes,
+                            std::size_t gallery_size);
+  void check_search(std::size_t k) const;
+  std::vector<std::size_t> run_search(const ENCRYPTO::BitVector<>* query, std::size_t k);
+  // Position of the template nearest to the query for the query owner.  With penalties, which
+  // are used for k > 1 by both parties, the templates found so far are excluded.
+  std::size_t run_tournament(const ENCRYPTO::BitVector<>* query,
+                             const std::vector<std::size_t>& found, bool with_penalties);
+
+  Communication::CommunicationLayer& communication_layer_;
+  std::size_t my_id_;
+  std::size_t gallery_owner_;
+  std::size_t template_bits_;
+  std::size_t num_threads_;
+  std::shared_ptr<Logger> logger_;
+  std::unique_ptr<TwoPartyBackend> backend_;
+  std::size_t gallery_size_ = 0;
+  // BEAVY shares of the gallery, plane j holds bit j of all templates
+  std::vector<ENCRYPTO::BitVector<>> gallery_public_shares_;
+  std::vector<ENCRYPTO::BitVector<>> gallery_secret_shares_;
+  NearestNeighbourStatistics statistics_;
+};
+
+}  // namespace MOTION
@@ -0,0 +1,680 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pattern_matcher.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <fmt/format.h>
+
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
+#include "gate/gate_cost.h"
+#include "protocols/beavy/wire.h"
+#include "protocols/plain/constant_folding.h"
+#include "statistics/circuit_analysis.h"
+#include "utility/logger.h"
+#include "utility/mapped_file.h"
+#include "utility/type_traits.hpp"
+#include "utility/typedefs.h"
+
+namespace MOTION {
+
+using proto::beavy::BooleanBEAVYWire;
+
+std::string PatternMatchingStatistics::print_human_readable() const {
+  std::stringstream ss;
+  ss << fmt::format("Pattern matching: {} queries in {} circuits\n", num_queries, num_circuits)
+     << fmt::format("Text sharing:       {:10.3f} ms\n", text_sharing_ms)
+     << fmt::format("Queries total:      {:10.3f} ms\n", queries_ms)
+     << fmt::format("Amortized latency:  {:10.3f} ms/query\n", get_amortized_latency_ms())
+     << fmt::format("Throughput:         {:10.3f} queries/s\n", get_throughput())
+     << fmt::format("Online rounds:      {:10}\n", max_online_rounds);
+  return ss.str();
+}
+
+std::string to_string(PatternMatchingPipeline pipeline) {
+  switch (pipeline) {
+    case PatternMatchingPipeline::ham_eqexp:
+      return "HAM/EQEXP";
+    case PatternMatchingPipeline::msg:
+      return "MSG";
+  }
+  return "unknown";
+}
+
+PatternMatchingPlanner PatternMatchingPlanner::from_network(
+    const Communication::NetworkProfile& profile) {
+  PatternMatchingPlanner planner;
+  planner.round_trip_time = profile.round_trip_time;
+  planner.bandwidth = static_cast<double>(profile.bandwidth);
+  return planner;
+}
+
+PatternMatchingCost PatternMatchingPlanner::get_cost(PatternMatchingType type,
+                                                     std::size_t pattern_size,
+                                                     std::size_t bits_per_character,
+                                                     PatternMatchingPipeline pipeline) {
+  if (pattern_size == 0 || bits_per_character == 0) {
+    throw std::invalid_argument("PatternMatchingPlanner: empty pattern or alphabet");
+  }
+  // the approximate circuits test every character, the others the whole window
+  const bool per_character = type == PatternMatchingType::approximate;
+  const std::size_t num_tests = per_character ? pattern_size : 1;
+  const std::size_t num_bits = per_character ? bits_per_character : pattern_size * bits_per_character;
+
+  PatternMatchingCost cost;
+  switch (pipeline) {
+    case PatternMatchingPipeline::ham_eqexp: {
+      // HAM converts a random bit per input bit with an ACOT into the ring of 64 bit, where one
+      // party is the sender and the other one the receiver, and opens the masked input bit.
+      // EQEXP broadcasts the one-hot encoding of the 2 * num_bits values and the output share.
+      const double bits_per_bit =
+          (GateCost::cot_sender_bits(1, 64) + GateCost::cot_receiver_bits(1)) / 2.0 + 1;
+      cost.online_rounds = 2;
+      cost.bits = static_cast<double>(num_tests) * (num_bits * bits_per_bit + 2 * num_bits + 1);
+      break;
+    }
+    case PatternMatchingPipeline::msg: {
+      std::size_t num_ands = 0;
+      for (auto num_values = num_bits; num_values > 1;) {
+        num_values = (num_values + 3) / 4;
+        num_ands += num_values;
+        ++cost.online_rounds;
+      }
+      // every 4-input AND needs the products of the 11 subsets of at least two delta shares, with
+      // an XCOT of a bit in each direction per product, and broadcasts one bit
+      constexpr std::size_t num_products = 11;
+      const double bits_per_and =
+          num_products * (GateCost::cot_sender_bits(1, 1) + GateCost::cot_receiver_bits(1)) + 1;
+      cost.bits = static_cast<double>(num_tests * num_ands) * bits_per_and;
+      break;
+    }
+  }
+  return cost;
+}
+
+std::chrono::duration<double> PatternMatchingPlanner::estimate(PatternMatchingType type,
+                                                               std::size_t pattern_size,
+                                                               std::size_t bits_per_character,
+                                                               PatternMatchingPipeline pipeline,
+                                                               std::size_t num_windows) const {
+  const auto cost = get_cost(type, pattern_size, bits_per_character, pipeline);
+  std::chrono::duration<double> time = static_cast<double>(cost.online_rounds) * round_trip_time / 2;
+  if (bandwidth > 0) {
+    time += std::chrono::duration<double>(cost.bits * num_windows / bandwidth);
+  }
+  if (auto it = compute_time_per_bit.find(pipeline); it != std::end(compute_time_per_bit)) {
+    time += static_cast<double>(pattern_size * bits_per_character * num_windows) * it->second;
+  }
+  return time;
+}
+
+PatternMatchingPipeline PatternMatchingPlanner::choose(PatternMatchingType type,
+                                                       std::size_t pattern_size,
+                                                       std::size_t bits_per_character,
+                                                       std::size_t num_windows) const {
+  auto best = PatternMatchingPipeline::ham_eqexp;
+  auto best_time = estimate(type, pattern_size, bits_per_character, best, num_windows);
+  for (auto pipeline : {PatternMatchingPipeline::msg}) {
+    const auto time = estimate(type, pattern_size, bits_per_character, pipeline, num_windows);
+    if (time < best_time) {
+      best = pipeline;
+      best_time = time;
+    }
+  }
+  return best;
+}
+
+struct PatternMatcher::Batch {
+  PatternMatchingType type;
+  std::size_t pattern_size;
+  PatternMatchingPipeline pipeline;
+  std::vector<const PatternQuery*> queries;
+  // windows of the stored text which are evaluated
+  std::size_t first_window;
+  std::size_t num_windows;
+};
+
+namespace {
+
+template <typename T>
+std::vector<ENCRYPTO::BitVector<>> encode_bit_planes_impl(std::span<const T> text,
+                                                          std::size_t bits_per_character) {
+  const auto text_size = text.size();
+  std::vector<ENCRYPTO::BitVector<>> bit_planes(bits_per_character,
+                                                ENCRYPTO::BitVector<>(text_size));
+  std::vector<std::byte*> plane_data(bits_per_character);
+  for (std::size_t bit_j = 0; bit_j < bits_per_character; ++bit_j) {
+    plane_data[bit_j] = bit_planes[bit_j].GetMutableData().data();
+  }
+  // every iteration writes one byte of each plane, so no two threads share a byte
+  const auto num_bytes = (text_size + 7) / 8;
+#pragma omp parallel for
+  for (std::size_t byte_i = 0; byte_i < num_bytes; ++byte_i) {
+    const auto begin = 8 * byte_i;
+    const auto end = std::min(text_size, begin + 8);
+    for (std::size_t bit_j = 0; bit_j < bits_per_character; ++bit_j) {
+      unsigned byte = 0;
+      // planes above the size of T stay zero
+      if (bit_j < ENCRYPTO::bit_size_v<T>) {
+        for (auto i = begin; i < end; ++i) {
+          byte |= ((text[i] >> bit_j) & 1) << (i - begin);
+        }
+      }
+      plane_data[bit_j][byte_i] = std::byte(byte);
+    }
+  }
+  return bit_planes;
+}
+
+}  // namespace
+
+std::vector<ENCRYPTO::BitVector<>> encode_bit_planes(std::span<const std::uint8_t> text,
+                                                     std::size_t bits_per_character) {
+  return encode_bit_planes_impl(text, bits_per_character);
+}
+
+std::vector<ENCRYPTO::BitVector<>> encode_bit_planes(std::span<const std::uint64_t> text,
+                                                     std::size_t bits_per_character) {
+  return encode_bit_planes_impl(text, bits_per_character);
+}
+
+MatchBitsWriter::MatchBitsWriter(const std::string& path)
+    : path_(path), file_(path, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw std::runtime_error(fmt::format("MatchBitsWriter: could not open {}", path_));
+  }
+}
+
+void MatchBitsWriter::write(std::size_t query_i, const ENCRYPTO::BitVector<>& matches) {
+  const std::array<std::uint64_t, 2> header = {query_i, matches.GetSize()};
+  file_.write(reinterpret_cast<const char*>(header.data()), sizeof(header));
+  // the bits are written from the buffer of the BitVector
+  file_.write(reinterpret_cast<const char*>(matches.GetData().data()),
+              (matches.GetSize() + 7) / 8);
+  if (!file_) {
+    throw std::runtime_error(fmt::format("MatchBitsWriter: could not write {}", path_));
+  }
+}
+
+void MatchBitsWriter::close() {
+  file_.close();
+  if (!file_) {
+    throw std::runtime_error(fmt::format("MatchBitsWriter: could not write {}", path_));
+  }
+}
+
+PatternMatcher::PatternMatcher(Communication::CommunicationLayer& communication_layer,
+                               std::size_t text_owner, std::size_t bits_per_character,
+                               std::size_t num_threads, std::shared_ptr<Logger> logger)
+    : communication_layer_(communication_layer),
+      my_id_(communication_layer.get_my_id()),
+      text_owner_(text_owner),
+      bits_per_character_(bits_per_character),
+      num_threads_(num_threads),
+      logger_(std::move(logger)) {
+  if (communication_layer.get_num_parties() != 2) {
+    throw std::logic_error("PatternMatcher: currently only two parties are supported");
+  }
+  if (text_owner_ > 1) {
+    throw std::invalid_argument(fmt::format("PatternMatcher: invalid text owner {}", text_owner_));
+  }
+  if (bits_per_character_ == 0 || bits_per_character_ > 64) {
+    throw std::invalid_argument(fmt::format(
+        "PatternMatcher: invalid number of bits per character {}", bits_per_character_));
+  }
+}
+
+PatternMatcher::~PatternMatcher() = default;
+
+TwoPartyBackend& PatternMatcher::get_backend() {
+  if (backend_) {
+    backend_->reset();
+  } else {
+    backend_ =
+        std::make_unique<TwoPartyBackend>(communication_layer_, num_threads_, false, logger_);
+  }
+  return *backend_;
+}
+
+void PatternMatcher::share_text(const std::vector<std::uint64_t>& text) {
+  if (my_id_ != text_owner_) {
+    throw std::logic_error("PatternMatcher: only the text owner can provide the text");
+  }
+  if (text.empty()) {
+    throw std::invalid_argument("PatternMatcher: text must not be empty");
+  }
+  share_bit_planes(encode_bit_planes(std::span(text), bits_per_character_), text.size(), false);
+}
+
+void PatternMatcher::share_text_file(const std::string& path) {
+  if (my_id_ != text_owner_) {
+    throw std::logic_error("PatternMatcher: only the text owner can provide the text");
+  }
+  BitValues bit_planes;
+  std::size_t text_size;
+  {
+    // the mapping is released before the text is shared
+    const MappedFile file(path);
+    text_size = file.get_size();
+    if (text_size == 0) {
+      throw std::invalid_argument(fmt::format("PatternMatcher: text file {} is empty", path));
+    }
+    file.advise_sequential();
+    const auto data = file.get_data();
+    bit_planes = encode_bit_planes(
+        std::span(reinterpret_cast<const std::uint8_t*>(data.data()), data.size()),
+        bits_per_character_);
+  }
+  share_bit_planes(std::move(bit_planes), text_size, false);
+}
+
+void PatternMatcher::share_text(std::size_t text_size) {
+  if (my_id_ == text_owner_) {
+    throw std::logic_error("PatternMatcher: the text owner needs to provide the text");
+  }
+  if (text_size == 0) {
+    throw std::invalid_argument("PatternMatcher: text must not be empty");
+  }
+  share_bit_planes({}, text_size, false);
+}
+
+void PatternMatcher::append_text(const std::vector<std::uint64_t>& text) {
+  if (my_id_ != text_owner_) {
+    throw std::logic_error("PatternMatcher: only the text owner can provide the text");
+  }
+  if (text.empty()) {
+    return;
+  }
+  share_bit_planes(encode_bit_planes(std::span(text), bits_per_character_), text.size(), true);
+}
+
+void PatternMatcher::append_text(std::size_t num_characters) {
+  if (my_id_ == text_owner_) {
+    throw std::logic_error("PatternMatcher: the text owner needs to provide the text");
+  }
+  if (num_characters == 0) {
+    return;
+  }
+  share_bit_planes({}, num_characters, true);
+}
+
+void PatternMatcher::share_bit_planes(BitValues&& bit_planes, std::size_t num_characters,
+                                      bool append) {
+  const auto start = clock_type::now();
+  {
+    auto& backend = get_backend();
+    auto& gate_factory = backend.get_gate_factory(MPCProtocol::BooleanBEAVY);
+    WireVector wires;
+    if (my_id_ == text_owner_) {
+      auto [promise, my_wires] =
+          gate_factory.make_boolean_input_gate_my(text_owner_, bits_per_character_, num_characters);
+      promise.set_value(std::move(bit_planes));
+      wires = std::move(my_wires);
+    } else {
+      wires = gate_factory.make_boolean_input_gate_other(text_owner_, bits_per_character_,
+                                                         num_characters);
+    }
+    backend.run();
+    if (!append) {
+      text_offset_ = 0;
+      text_size_ = 0;
+      text_public_shares_.assign(bits_per_character_, {});
+      text_secret_shares_.assign(bits_per_character_, {});
+      for (auto& standing_query : standing_queries_) {
+        standing_query.next_window = 0;
+      }
+    } else if (text_public_shares_.empty()) {
+      text_public_shares_.resize(bits_per_character_);
+      text_secret_shares_.resize(bits_per_character_);
+    }
+    for (std::size_t bit_j = 0; bit_j < bits_per_character_; ++bit_j) {
+      auto beavy_wire = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires.at(bit_j));
+      beavy_wire->wait_online();
+      text_public_shares_[bit_j].Append(beavy_wire->get_public_share());
+      text_secret_shares_[bit_j].Append(beavy_wire->get_secret_share());
+    }
+    text_size_ += num_characters;
+    communication_layer_.sync();
+  }
+  statistics_.text_sharing_ms +=
+      std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void PatternMatcher::discard_text(std::size_t new_offset) {
+  if (new_offset <= text_offset_) {
+    return;
+  }
+  const auto num_discarded = std::min(new_offset - text_offset_, text_size_);
+  for (std::size_t bit_j = 0; bit_j < bits_per_character_; ++bit_j) {
+    text_public_shares_[bit_j] = text_public_shares_[bit_j].Subset(num_discarded, text_size_);
+    text_secret_shares_[bit_j] = text_secret_shares_[bit_j].Subset(num_discarded, text_size_);
+  }
+  text_offset_ += num_discarded;
+  text_size_ -= num_discarded;
+}
+
+void PatternMatcher::check_query(const PatternQuery& query) const {
+  if (query.pattern_size == 0) {
+    throw std::invalid_argument("PatternMatcher: pattern must not be empty");
+  }
+  if (my_id_ != text_owner_) {
+    if (query.pattern.size() != query.pattern_size) {
+      throw std::invalid_argument(
+          fmt::format("PatternMatcher: pattern has {} characters, but pattern size is {}",
+                      query.pattern.size(), query.pattern_size));
+    }
+    if (query.type == PatternMatchingType::wildcard && !query.wildcards.empty() &&
+        query.wildcards.size() != query.pattern_size) {
+      throw std::invalid_argument("PatternMatcher: wildcards need one entry per character");
+    }
+  }
+}
+
+std::size_t PatternMatcher::add_query(PatternQuery query) {
+  if (text_size_ == 0) {
+    throw std::logic_error("PatternMatcher: share_text() needs to be called before add_query()");
+  }
+  if (query.pattern_size > text_size_) {
+    throw std::invalid_argument(fmt::format(
+        "PatternMatcher: invalid pattern size {} for a text of size {}", query.pattern_size,
+        text_size_));
+  }
+  check_query(query);
+  pending_queries_.push_back(std::move(query));
+  return pending_queries_.size() - 1;
+}
+
+std::size_t PatternMatcher::add_standing_query(PatternQuery query) {
+  check_query(query);
+  standing_queries_.push_back({std::move(query), text_offset_});
+  return standing_queries_.size() - 1;
+}
+
+std::vector<ENCRYPTO::BitVector<>> PatternMatcher::run(std::size_t max_batch_size) {
+  std::vector<ENCRYPTO::BitVector<>> results(pending_queries_.size());
+  run([&results](auto query_i, auto&& matches) { results[query_i] = std::move(matches); },
+      max_batch_size);
+  return results;
+}
+
+void PatternMatcher::run(const result_callback& on_result, std::size_t max_batch_size) {
+  if (max_batch_size == 0) {
+    throw std::invalid_argument("PatternMatcher: batch size needs to be positive");
+  }
+
+  // group the queries by circuit shape, keeping the order within each group
+  std::map<std::tuple<PatternMatchingType, std::size_t, PatternMatchingPipeline>,
+           std::vector<std::size_t>>
+      groups;
+  for (std::size_t query_i = 0; query_i < pending_queries_.size(); ++query_i) {
+    const auto& query = pending_queries_[query_i];
+    const auto pipeline = query.pipeline.value_or(
+        planner_.choose(query.type, query.pattern_size, bits_per_character_,
+                        text_size_ - query.pattern_size + 1));
+    groups[{query.type, query.pattern_size, pipeline}].push_back(query_i);
+  }
+
+  for (const auto& [shape, query_indices] : groups) {
+    const auto num_windows = text_size_ - std::get<1>(shape) + 1;
+    for (std::size_t begin = 0; begin < query_indices.size(); begin += max_batch_size) {
+      const auto end = std::min(query_indices.size(), begin + max_batch_size);
+      Batch batch{std::get<0>(shape), std::get<1>(shape), std::get<2>(shape), {}, 0, num_windows};
+      for (auto i = begin; i < end; ++i) {
+        batch.queries.push_back(&pending_queries_[query_indices[i]]);
+      }
+      const auto start = clock_type::now();
+      auto matches = run_batch(batch);
+      statistics_.queries_ms +=
+          std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+      ++statistics_.num_circuits;
+      for (std::size_t q = 0; q < matches.size(); ++q) {
+        on_result(query_indices[begin + q], std::move(matches[q]));
+      }
+    }
+  }
+  statistics_.num_queries += pending_queries_.size();
+  pending_queries_.clear();
+}
+
+void PatternMatcher::run_standing_queries(const standing_result_callback& on_result,
+                                          std::size_t max_batch_size) {
+  if (max_batch_size == 0) {
+    throw std::invalid_argument("PatternMatcher: batch size needs to be positive");
+  }
+  const auto text_end = text_offset_ + text_size_;
+
+  // group the queries with new windows by circuit shape and window range, where the range
+  // only depends on the pattern size and the previous evaluation of a query
+  std::map<std::tuple<PatternMatchingType, std::size_t, PatternMatchingPipeline, std::size_t>,
+           std::vector<std::size_t>>
+      groups;
+  std::size_t num_evaluated = 0;
+  for (std::size_t query_i = 0; query_i < standing_queries_.size(); ++query_i) {
+    const auto& [query, next_window] = standing_queries_[query_i];
+    if (query.pattern_size > text_end - next_window) {
+      continue;
+    }
+    const auto num_windows = text_end - next_window - query.pattern_size + 1;
+    const auto pipeline = query.pipeline.value_or(
+        planner_.choose(query.type, query.pattern_size, bits_per_character_, num_windows));
+    groups[{query.type, query.pattern_size, pipeline, next_window}].push_back(query_i);
+    ++num_evaluated;
+  }
+
+  for (const auto& [shape, query_indices] : groups) {
+    const auto [type, pattern_size, pipeline, first_window] = shape;
+    const auto num_windows = text_end - first_window - pattern_size + 1;
+    for (std::size_t begin = 0; begin < query_indices.size(); begin += max_batch_size) {
+      const auto end = std::min(query_indices.size(), begin + max_batch_size);
+      Batch batch{type, pattern_size, pipeline, {}, first_window - text_offset_, num_windows};
+      for (auto i = begin; i < end; ++i) {
+        batch.queries.push_back(&standing_queries_[query_indices[i]].query);
+      }
+      const auto start = clock_type::now();
+      auto matches = run_batch(batch);
+      statistics_.queries_ms +=
+          std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+      ++statistics_.num_circuits;
+      for (std::size_t q = 0; q < matches.size(); ++q) {
+        on_result(query_indices[begin + q], first_window, std::move(matches[q]));
+      }
+    }
+    for (auto query_i : query_indices) {
+      standing_queries_[query_i].next_window = first_window + num_windows;
+    }
+  }
+  statistics_.num_queries += num_evaluated;
+
+  // keep only the characters of windows which are not complete yet
+  if (!standing_queries_.empty()) {
+    auto new_offset = text_end;
+    for (const auto& standing_query : standing_queries_) {
+      new_offset = std::min(new_offset, standing_query.next_window);
+    }
+    discard_text(new_offset);
+  }
+}
+
+// Create a wire with n copies of a BEAVY share which is already available.
+static std::shared_ptr<BooleanBEAVYWire> make_ready_wire(const ENCRYPTO::BitVector<>& public_share,
+                                                         const ENCRYPTO::BitVector<>& secret_share,
+                                                         std::size_t n) {
+  const auto size = public_share.GetSize();
+  auto wire = std::make_shared<BooleanBEAVYWire>(n * size);
+  wire->get_public_share().Reserve((n * size + 7) / 8);
+  wire->get_secret_share().Reserve((n * size + 7) / 8);
+  for (std::size_t i = 0; i < n; ++i) {
+    wire->get_public_share().Append(public_share);
+    wire->get_secret_share().Append(secret_share);
+  }
+  wire->set_setup_ready();
+  wire->set_online_ready();
+  return wire;
+}
+
+std::vector<ENCRYPTO::BitVector<>> PatternMatcher::run_batch(const Batch& batch) {
+  const auto pattern_size = batch.pattern_size;
+  const auto num_queries = batch.queries.size();
+  const auto first_window = batch.first_window;
+  const auto num_windows = batch.num_windows;
+  const auto num_simd = num_queries * num_windows;
+  const auto num_wires = pattern_size * bits_per_character_;
+  const auto pattern_owner = get_pattern_owner();
+  const bool is_pattern_owner = my_id_ == pattern_owner;
+
+  if (logger_) {
+    logger_->LogInfo(
+        fmt::format("PatternMatcher: evaluating {} queries of size {} in one {} circuit",
+                    num_queries, pattern_size, to_string(batch.pipeline)));
+  }
+
+  auto& backend = get_backend();
+  auto& boolean_factory = backend.get_gate_factory(MPCProtocol::BooleanBEAVY);
+  auto& arithmetic_factory = backend.get_gate_factory(MPCProtocol::ArithmeticBEAVY);
+
+  // windows of the text: wire k * bits_per_character + j contains bit j of character
+  // first_window + i + k in SIMD position i, repeated for each query
+  WireVector text_wires;
+  for (std::size_t k = 0; k < pattern_size; ++k) {
+    const auto from = first_window + k;
+    for (std::size_t bit_j = 0; bit_j < bits_per_character_; ++bit_j) {
+      text_wires.push_back(
+          make_ready_wire(text_public_shares_[bit_j].Subset(from, from + num_windows),
+                          text_secret_shares_[bit_j].Subset(from, from + num_windows), num_queries));
+    }
+  }
+
+  // the pattern (and the mask of non-wildcard positions), also in the same layout
+  const auto make_pattern_input = [&, this](auto&& get_bit) {
+    if (!is_pattern_owner) {
+      return boolean_factory.make_boolean_input_gate_other(pattern_owner, num_wires, num_simd);
+    }
+    BitValues values(num_wires);
+    for (std::size_t k = 0; k < pattern_size; ++k) {
+      for (std::size_t bit_j = 0; bit_j < bits_per_character_; ++bit_j) {
+        auto& value = values[k * bits_per_character_ + bit_j];
+        value.Reserve((num_simd + 7) / 8);
+        for (const auto* query : batch.queries) {
+          const bool bit = get_bit(*query, k, bit_j);
+          value.Append(ENCRYPTO::BitVector<>(num_windows, bit));
+        }
+      }
+    }
+    auto [promise, wires] =
+        boolean_factory.make_boolean_input_gate_my(pattern_owner, num_wires, num_simd);
+    promise.set_value(std::move(values));
+    return wires;
+  };
+  auto pattern_wires = make_pattern_input([](const auto& query, auto k, auto bit_j) {
+    return ((query.pattern[k] >> bit_j) & 1) == 1;
+  });
+  auto mismatches = boolean_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR,
+                                                     text_wires, pattern_wires);
+  if (batch.type == PatternMatchingType::wildcard) {
+    auto mask_wires = make_pattern_input([](const auto& query, auto k, auto) {
+      return query.wildcards.empty() || !query.wildcards[k];
+    });
+    mismatches = boolean_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                  mismatches, mask_wires);
+  }
+
+  // match bit of each SIMD value, i.e., 1 iff all the given mismatching bits are 0
+  const auto make_match = [&](const WireVector& bits) {
+    if (batch.pipeline == PatternMatchingPipeline::msg) {
+      WireVector zeros;
+      for (std::size_t i = 0; i < bits.size(); ++i) {
+        zeros.push_back(make_ready_wire(ENCRYPTO::BitVector<>(num_simd),
+                                        ENCRYPTO::BitVector<>(num_simd), 1));
+      }
+      return boolean_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MSG, bits, zeros);
+    }
+    auto distance = boolean_factory.make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM, bits);
+    return arithmetic_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQEXP, distance,
+                                               proto::plain::make_arithmetic_constant_wire(
+                                                   64, num_simd, 2 * bits.size()));
+  };
+
+  ENCRYPTO::ReusableFiberFuture<BitValues> match_future;
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint64_t>> count_future;
+  if (batch.type == PatternMatchingType::approximate) {
+    // count the matching characters of each window
+    WireVector character_matches;
+    for (std::size_t k = 0; k < pattern_size; ++k) {
+      WireVector character_mismatches(
+          std::begin(mismatches) + k * bits_per_character_,
+          std::begin(mismatches) + (k + 1) * bits_per_character_);
+      character_matches.push_back(make_match(character_mismatches).at(0));
+    }
+    auto count = boolean_factory.make_unary_gate(ENCRYPTO::PrimitiveOperationType::COUNT,
+                                                 character_matches);
+    if (is_pattern_owner) {
+      count_future = arithmetic_factory.make_arithmetic_64_output_gate_my(pattern_owner, count);
+    } else {
+      arithmetic_factory.make_arithmetic_output_gate_other(pattern_owner, count);
+    }
+  } else {
+    auto match = make_match(mismatches);
+    if (is_pattern_owner) {
+      match_future = boolean_factory.make_boolean_output_gate_my(pattern_owner, match);
+    } else {
+      boolean_factory.make_boolean_output_gate_other(pattern_owner, match);
+    }
+  }
+
+  statistics_.max_online_rounds =
+      std::max(statistics_.max_online_rounds, backend.analyze_circuit().online_rounds_);
+  backend.run();
+  statistics_.run_time_stats.add(backend.get_run_time_stats());
+
+  std::vector<ENCRYPTO::BitVector<>> results;
+  if (is_pattern_owner) {
+    if (batch.type == PatternMatchingType::approximate) {
+      const auto counts = count_future.get();
+      for (std::size_t q = 0; q < num_queries; ++q) {
+        const auto& query = *batch.queries[q];
+        ENCRYPTO::BitVector<> result(num_windows);
+        for (std::size_t i = 0; i < num_windows; ++i) {
+          result.Set(counts[q * num_windows + i] + query.threshold >= pattern_size, i);
+        }
+        results.push_back(std::move(result));
+      }
+    } else {
+      const auto matches = match_future.get();
+      for (std::size_t q = 0; q < num_queries; ++q) {
+        results.push_back(matches.at(0).Subset(q * num_windows, (q + 1) * num_windows));
+      }
+    }
+  }
+  communication_layer_.sync();
+  return results;
+}
+
+}  // namespace MOTION
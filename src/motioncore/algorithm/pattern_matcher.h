@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "statistics/analysis.h"
+#include "utility/bit_vector.h"
+
+namespace MOTION {
+
+class Logger;
+class TwoPartyBackend;
+
+namespace Communication {
+class CommunicationLayer;
+struct NetworkProfile;
+}  // namespace Communication
+
+enum class PatternMatchingType : std::uint8_t { exact, wildcard, approximate };
+
+// Circuits which compute whether the mismatching bits of a window, or in the approximate case
+// of each character of a window, are all zero.
+enum class PatternMatchingPipeline : std::uint8_t {
+  // Hamming distance of the bits compared with 0 by an EQEXP gate, i.e., two online rounds for
+  // any number of bits
+  ham_eqexp,
+  // AND of the negated bits in a tree of 4-input ANDs (see BooleanBEAVYMSGGate), i.e.,
+  // ceil(log_4(#bits)) online rounds, but more setup communication per bit
+  msg,
+};
+
+std::string to_string(PatternMatchingPipeline);
+
+// Cost per window of the part of a query circuit which depends on the pipeline.  The other
+// gates, e.g., the inputs of the pattern, the masking of the wildcards, the COUNT of the matching
+// characters and the outputs, are the same for all pipelines.
+struct PatternMatchingCost {
+  std::size_t online_rounds = 0;
+  // sent by each party in the setup and the online phase, on average over both parties
+  double bits = 0;
+};
+
+// Chooses the pipeline of a query with the smallest estimated time from the sizes of the query
+// and the network.  Like for the CircuitCostModel, every round costs half a round trip.  The
+// wildcard positions and the threshold are private to the pattern owner, so the choice only
+// depends on the type of the query, its size and the alphabet.  Both parties need to use the
+// same planner, e.g., with the same network profile, s.t. they build the same circuits.
+struct PatternMatchingPlanner {
+  std::chrono::duration<double> round_trip_time{0};
+  // bits per second, 0 means unlimited
+  double bandwidth = 0;
+  // measured local computation per window and mismatching bit of each pipeline, e.g., with
+  // benchmark_pattern_matching, missing pipelines are assumed to be free
+  std::map<PatternMatchingPipeline, std::chrono::duration<double>> compute_time_per_bit;
+
+  static PatternMatchingPlanner from_network(const Communication::NetworkProfile&);
+
+  // throws std::invalid_argument for an empty pattern or alphabet
+  static PatternMatchingCost get_cost(PatternMatchingType, std::size_t pattern_size,
+                                      std::size_t bits_per_character, PatternMatchingPipeline);
+  std::chrono::duration<double> estimate(PatternMatchingType, std::size_t pattern_size,
+                                         std::size_t bits_per_character, PatternMatchingPipeline,
+                                         std::size_t num_windows) const;
+  // ties are broken in the order of PatternMatchingPipeline
+  PatternMatchingPipeline choose(PatternMatchingType, std::size_t pattern_size,
+                                 std::size_t bits_per_character, std::size_t num_windows) const;
+};
+
+struct PatternQuery {
+  PatternMatchingType type = PatternMatchingType::exact;
+  // number of characters of the pattern, needs to be known by both parties
+  std::size_t pattern_size = 0;
+  // the characters of the pattern, only needed by the pattern owner
+  std::vector<std::uint64_t> pattern;
+  // wildcard: positions which match any character, only needed by the pattern owner
+  std::vector<bool> wildcards;
+  // approximate: maximal number of mismatching characters, only needed by the pattern owner
+  std::size_t threshold = 0;
+  // nullopt lets the planner of the PatternMatcher choose, otherwise the same for both parties
+  std::optional<PatternMatchingPipeline> pipeline;
+};
+
+struct PatternMatchingStatistics {
+  std::size_t num_queries = 0;
+  std::size_t num_circuits = 0;
+  // time to secret share the text, including characters appended later
+  double text_sharing_ms = 0;
+  // total time spent on query circuits
+  double queries_ms = 0;
+  // online rounds of the deepest query circuit as predicted by the cost models of its gates
+  std::size_t max_online_rounds = 0;
+  Statistics::AccumulatedRunTimeStats run_time_stats;
+
+  double get_amortized_latency_ms() const noexcept {
+    return num_queries ? queries_ms / num_queries : 0;
+  }
+  double get_throughput() const noexcept {
+    return queries_ms > 0 ? 1000 * num_queries / queries_ms : 0;
+  }
+  std::string print_human_readable() const;
+};
+
+// Bit planes of a text, i.e., plane j holds bit j of all characters, for characters of
+// bits_per_character bits.  The planes are filled in parallel, a byte of each plane, i.e., 8
+// characters, at a time.
+std::vector<ENCRYPTO::BitVector<>> encode_bit_planes(std::span<const std::uint8_t> text,
+                                                     std::size_t bits_per_character);
+std::vector<ENCRYPTO::BitVector<>> encode_bit_planes(std::span<const std::uint64_t> text,
+                                                     std::size_t bits_per_character);
+
+// Writes the match bits of the queries to a file as they are computed, s.t. they need not be
+// kept in memory.  Each result is stored as the query index and the number of bits (64 bit
+// integers in host byte order), followed by the bits packed into bytes, least significant bit
+// first, as in BitVector.
+class MatchBitsWriter {
+ public:
+  explicit MatchBitsWriter(const std::string& path);
+
+  void write(std::size_t query_i, const ENCRYPTO::BitVector<>& matches);
+  void close();
+
+ private:
+  std::string path_;
+  std::ofstream file_;
+};
+
+// Two-party pattern matching on a text that is secret-shared only once.
+//
+// One party owns the text, the other one the patterns.  After share_text() has been called,
+// patterns can be added with add_query().  run() evaluates all pending queries, where queries
+// of the same type, pattern size and pipeline are combined into a single SIMD circuit with up to
+// max_batch_size queries.  The text shares are reused by all circuits, only the pattern is input
+// per query.
+//
+// For every query, the pattern owner obtains one bit per text position (window start) which is
+// set iff the pattern matches there.  In the approximate case, the pattern owner learns the
+// number of matching characters per window and compares it with the threshold locally.
+//
+// For a text which grows continuously, e.g., a log, characters can be appended with
+// append_text(), and standing queries are evaluated by run_standing_queries() only on the windows
+// which touch characters appended since their previous evaluation.  Characters which are not
+// needed by any standing query anymore, i.e., all but the last pattern_size - 1 ones, are
+// discarded then, s.t. the cost of an update is proportional to the number of appended characters.
+class PatternMatcher {
+ public:
+  PatternMatcher(Communication::CommunicationLayer&, std::size_t text_owner,
+                 std::size_t bits_per_character, std::size_t num_threads,
+                 std::shared_ptr<Logger>);
+  ~PatternMatcher();
+
+  std::size_t get_text_owner() const noexcept { return text_owner_; }
+  std::size_t get_pattern_owner() const noexcept { return 1 - text_owner_; }
+
+  // called by the text owner
+  void share_text(const std::vector<std::uint64_t>& text);
+  // called by the text owner instead of share_text() with a file of one byte per character, e.g.,
+  // a multi-GB text, which is mapped into memory and encoded without an intermediate copy (the
+  // pattern owner calls share_text() with the file size)
+  void share_text_file(const std::string& path);
+  // called by the pattern owner
+  void share_text(std::size_t text_size);
+
+  // Append characters to the shared text, where only the new characters are secret-shared.  The
+  // text owner provides the characters, the pattern owner their number.  Can also be used instead
+  // of share_text() for the first characters.
+  void append_text(const std::vector<std::uint64_t>& text);
+  void append_text(std::size_t num_characters);
+  // position of the first character which is still stored, i.e., of window 0 of run(), in the
+  // whole text appended so far
+  std::size_t get_text_offset() const noexcept { return text_offset_; }
+
+  // queue a query and return its index
+  std::size_t add_query(PatternQuery query);
+  // Evaluate all pending queries.  Returns the match bits of each query for the pattern owner,
+  // and empty vectors for the text owner.
+  std::vector<ENCRYPTO::BitVector<>> run(std::size_t max_batch_size = 16);
+  // Evaluate all pending queries and pass the match bits of each query to the callback once its
+  // circuit has been evaluated, e.g., to write them to a MatchBitsWriter, instead of returning
+  // all of them at the end.  The callback is only called for the pattern owner.
+  using result_callback =
+      std::function<void(std::size_t query_i, ENCRYPTO::BitVector<>&& matches)>;
+  void run(const result_callback& on_result, std::size_t max_batch_size = 16);
+
+  // Register a query which is evaluated by every call of run_standing_queries() on the windows
+  // that have become complete since its previous evaluation, starting at the current text offset.
+  // The pattern may be longer than the text shared so far.  Returns the index of the query.
+  std::size_t add_standing_query(PatternQuery query);
+  // Evaluate the new windows of all standing queries.  The callback obtains the position of the
+  // first new window in the whole text and the match bits of the new windows, and is only called
+  // for the pattern owner and for queries with at least one new window.  Afterwards, the
+  // characters before the next window of every standing query are discarded.
+  using standing_result_callback = std::function<void(
+      std::size_t query_i, std::size_t first_window, ENCRYPTO::BitVector<>&& matches)>;
+  void run_standing_queries(const standing_result_callback& on_result,
+                            std::size_t max_batch_size = 16);
+
+  const PatternMatchingStatistics& get_statistics() const noexcept { return statistics_; }
+
+  // select the pipelines of the queries without a fixed one (set by both parties in the same way
+  // before run())
+  void set_planner(PatternMatchingPlanner planner) { planner_ = std::move(planner); }
+  const PatternMatchingPlanner& get_planner() const noexcept { return planner_; }
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  struct Batch;
+  struct StandingQuery {
+    PatternQuery query;
+    // position of the next window to evaluate in the whole text
+    std::size_t next_window;
+  };
+  // the backend of the previous circuit after a reset, or a new one
+  TwoPartyBackend& get_backend();
+  // returns the match bits of each query of the batch for the pattern owner
+  std::vector<ENCRYPTO::BitVector<>> run_batch(const Batch&);
+  void check_query(const PatternQuery&) const;
+  // secret share num_characters characters, where bit_planes is empty for the pattern owner, and
+  // replace or extend the stored text
+  void share_bit_planes(std::vector<ENCRYPTO::BitVector<>>&& bit_planes,
+                        std::size_t num_characters, bool append);
+  // drop the stored characters before position new_offset of the whole text
+  void discard_text(std::size_t new_offset);
+
+  Communication::CommunicationLayer& communication_layer_;
+  std::size_t my_id_;
+  std::size_t text_owner_;
+  std::size_t bits_per_character_;
+  std::size_t num_threads_;
+  std::shared_ptr<Logger> logger_;
+  // all circuits use the same backend, s.t. base OTs and thread pools are set up only once
+  std::unique_ptr<TwoPartyBackend> backend_;
+
+  // BEAVY shares of the stored text, one bit plane per character bit, starting at position
+  // text_offset_ of the whole text
+  std::size_t text_offset_ = 0;
+  std::size_t text_size_ = 0;
+  std::vector<ENCRYPTO::BitVector<>> text_public_shares_;
+  std::vector<ENCRYPTO::BitVector<>> text_secret_shares_;
+
+  std::vector<PatternQuery> pending_queries_;
+  std::vector<StandingQuery> standing_queries_;
+  PatternMatchingPlanner planner_;
+  PatternMatchingStatistics statistics_;
+};
+
+}  // namespace MOTION
@@ -0,0 +1,367 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "private_set_intersection.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "base/gate_factory.h"
+#include "base/two_party_backend.h"
+#include "communication/communication_layer.h"
+#include "protocols/plain/constant_folding.h"
+#include "utility/logger.h"
+
+namespace MOTION {
+
+std::size_t get_psi_bin(std::uint64_t item, std::size_t hash_i, std::uint64_t seed,
+                        std::size_t num_bins) {
+  // finalizer of splitmix64, a bijection, on the item keyed by the seed and the hash function
+  auto x = item ^ (seed + 0x9e3779b97f4a7c15 * (hash_i + 1));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x % num_bins;
+}
+
+std::vector<std::optional<std::size_t>> make_cuckoo_table(
+    const std::vector<std::uint64_t>& items, std::size_t num_bins, std::uint64_t seed) {
+  if (num_bins < items.size()) {
+    throw std::invalid_argument(
+        fmt::format("cuckoo hashing of {} items needs at least as many bins", items.size()));
+  }
+  constexpr std::size_t max_evictions = 1000;
+  std::vector<std::optional<std::size_t>> table(num_bins);
+  // the choices of the evicted items need not be secret, only the table is kept private
+  std::mt19937_64 rng(seed);
+  for (std::size_t item_i = 0; item_i < items.size(); ++item_i) {
+    auto current = item_i;
+    for (std::size_t evictions = 0;; ++evictions) {
+      bool placed = false;
+      for (std::size_t hash_i = 0; hash_i < psi_num_hash_functions && !placed; ++hash_i) {
+        auto& bin = table[get_psi_bin(items[current], hash_i, seed, num_bins)];
+        if (!bin.has_value()) {
+          bin = current;
+          placed = true;
+        }
+      }
+      if (placed) {
+        break;
+      }
+      if (evictions == max_evictions) {
+        throw std::runtime_error(
+            fmt::format("cuckoo hashing of {} items into {} bins failed", items.size(), num_bins));
+      }
+      // place the current item in one of its bins and continue with the item stored there
+      const auto hash_i = rng() % psi_num_hash_functions;
+      std::swap(current, *table[get_psi_bin(items[current], hash_i, seed, num_bins)]);
+    }
+  }
+  return table;
+}
+
+std::vector<std::vector<std::size_t>> make_simple_hash_table(
+    const std::vector<std::uint64_t>& items, std::size_t num_bins, std::uint64_t seed) {
+  if (num_bins == 0) {
+    throw std::invalid_argument("simple hashing needs at least one bin");
+  }
+  std::vector<std::vector<std::size_t>> table(num_bins);
+  for (std::size_t item_i = 0; item_i < items.size(); ++item_i) {
+    std::array<std::size_t, psi_num_hash_functions> bins;
+    for (std::size_t hash_i = 0; hash_i < psi_num_hash_functions; ++hash_i) {
+      bins[hash_i] = get_psi_bin(items[item_i], hash_i, seed, num_bins);
+      if (std::find(std::begin(bins), std::begin(bins) + hash_i, bins[hash_i]) ==
+          std::begin(bins) + hash_i) {
+        table[bins[hash_i]].push_back(item_i);
+      }
+    }
+  }
+  return table;
+}
+
+std::size_t get_max_bin_load(std::size_t num_items, std::size_t num_bins,
+                             std::size_t statistical_security) {
+  if (num_bins == 0) {
+    throw std::invalid_argument("the maximal bin load needs at least one bin");
+  }
+  if (num_bins == 1 || num_items == 0) {
+    return num_items;
+  }
+  // the load of a bin is at most Binomial(n, 1 / num_bins) distributed, and the probability
+  // that any bin exceeds the bound is at most num_bins times the tail
+  const auto n = static_cast<double>(num_items * psi_num_hash_functions);
+  const auto log_p = -std::log(static_cast<double>(num_bins));
+  const auto log_q = std::log1p(-1.0 / static_cast<double>(num_bins));
+  const auto pmf = [&](double j) {
+    return std::exp(std::lgamma(n + 1) - std::lgamma(j + 1) - std::lgamma(n - j + 1) + j * log_p +
+                    (n - j) * log_q);
+  };
+  const auto max_tail =
+      std::exp2(-static_cast<double>(statistical_security)) / static_cast<double>(num_bins);
+  const auto mean = n / static_cast<double>(num_bins);
+  for (std::size_t load = 1; load < num_items; ++load) {
+    double tail = 0;
+    for (auto j = static_cast<double>(load + 1); j <= n; ++j) {
+      const auto term = pmf(j);
+      tail += term;
+      // beyond the mean, the terms decrease at least geometrically
+      if (j > mean && term <= tail * 1e-17) {
+        break;
+      }
+    }
+    if (tail <= max_tail) {
+      return load;
+    }
+  }
+  return num_items;
+}
+
+std::size_t PSIParameters::get_num_bins() const {
+  return std::max<std::size_t>(
+      static_cast<std::size_t>(std::ceil(bin_factor * static_cast<double>(client_set_size))), 1);
+}
+
+std::string PSIStatistics::print_human_readable() const {
+  std::stringstream ss;
+  ss << fmt::format("PSI: {} bins of {} slots, {} comparisons in {} circuits\n", num_bins,
+                    max_bin_load, num_comparisons, num_circuits)
+     << fmt::format("Hashing:            {:10.3f} ms\n", hashing_ms)
+     << fmt::format("Circuits total:     {:10.3f} ms\n", circuits_ms);
+  return ss.str();
+}
+
+PrivateSetIntersection::PrivateSetIntersection(
+    Communication::CommunicationLayer& communication_layer, std::size_t client_id,
+    PSIParameters parameters, std::size_t num_threads, std::shared_ptr<Logger> logger)
+    : communication_layer_(communication_layer),
+      my_id_(communication_layer.get_my_id()),
+      client_id_(client_id),
+      parameters_(std::move(parameters)),
+      num_threads_(num_threads),
+      logger_(std::move(logger)) {
+  if (communication_layer.get_num_parties() != 2) {
+    throw std::logic_error("PrivateSetIntersection: currently only two parties are supported");
+  }
+  if (client_id_ > 1) {
+    throw std::invalid_argument(
+        fmt::format("PrivateSetIntersection: invalid client {}", client_id_));
+  }
+  if (parameters_.bits_per_item == 0 || parameters_.bits_per_item > 64) {
+    throw std::invalid_argument(fmt::format(
+        "PrivateSetIntersection: invalid number of bits per item {}", parameters_.bits_per_item));
+  }
+  if (parameters_.client_set_size == 0 || parameters_.server_set_size == 0) {
+    throw std::invalid_argument("PrivateSetIntersection: the sets must not be empty");
+  }
+  if (!(parameters_.bin_factor >= 1)) {
+    throw std::invalid_argument(fmt::format(
+        "PrivateSetIntersection: need at least one bin per item, got {}", parameters_.bin_factor));
+  }
+}
+
+PrivateSetIntersection::~PrivateSetIntersection() = default;
+
+TwoPartyBackend& PrivateSetIntersection::get_backend() {
+  if (backend_) {
+    backend_->reset();
+  } else {
+    backend_ =
+        std::make_unique<TwoPartyBackend>(communication_layer_, num_threads_, false, logger_);
+  }
+  return *backend_;
+}
+
+void PrivateSetIntersection::check_items(const std::vector<std::uint64_t>& items) const {
+  const auto set_size =
+      my_id_ == client_id_ ? parameters_.client_set_size : parameters_.server_set_size;
+  if (items.size() != set_size) {
+    throw std::invalid_argument(fmt::format(
+        "PrivateSetIntersection: expected {} items, got {}", set_size, items.size()));
+  }
+  if (parameters_.bits_per_item < 64) {
+    const auto bound = std::uint64_t(1) << parameters_.bits_per_item;
+    if (std::any_of(std::begin(items), std::end(items), [bound](auto x) { return x >= bound; })) {
+      throw std::invalid_argument(fmt::format(
+          "PrivateSetIntersection: items need to fit into {} bits", parameters_.bits_per_item));
+    }
+  }
+  auto sorted = items;
+  std::sort(std::begin(sorted), std::end(sorted));
+  if (std::adjacent_find(std::begin(sorted), std::end(sorted)) != std::end(sorted)) {
+    throw std::invalid_argument("PrivateSetIntersection: the items need to be distinct");
+  }
+}
+
+std::vector<std::size_t> PrivateSetIntersection::run(const std::vector<std::uint64_t>& items) {
+  check_items(items);
+  const bool is_client = my_id_ == client_id_;
+  const auto num_bins = parameters_.get_num_bins();
+  const auto max_load = get_max_bin_load(parameters_.server_set_size, num_bins);
+  const auto seed = parameters_.seed;
+
+  const auto hashing_start = clock_type::now();
+  std::vector<std::optional<std::size_t>> cuckoo_table;
+  std::vector<std::vector<std::size_t>> simple_table;
+  if (is_client) {
+    cuckoo_table = make_cuckoo_table(items, num_bins, seed);
+  } else {
+    simple_table = make_simple_hash_table(items, num_bins, seed);
+    // the client learns the slot of a match, which must not depend on the order of the items
+    std::mt19937_64 rng(std::random_device{}());
+    for (auto& bin : simple_table) {
+      if (bin.size() > max_load) {
+        throw std::runtime_error(fmt::format(
+            "PrivateSetIntersection: bin load {} exceeds the bound {}", bin.size(), max_load));
+      }
+      std::shuffle(std::begin(bin), std::end(bin), rng);
+    }
+  }
+  statistics_.hashing_ms +=
+      std::chrono::duration<double, std::milli>(clock_type::now() - hashing_start).count();
+  statistics_.num_bins = num_bins;
+  statistics_.max_bin_load = max_load;
+
+  const auto bins_per_circuit = parameters_.max_bins_per_circuit == 0
+                                    ? num_bins
+                                    : std::min(parameters_.max_bins_per_circuit, num_bins);
+  std::vector<std::size_t> result;
+  for (std::size_t first_bin = 0; first_bin < num_bins; first_bin += bins_per_circuit) {
+    const auto circuit_bins = std::min(bins_per_circuit, num_bins - first_bin);
+    // bit planes of the items (0 for empty bins) followed by the valid bits
+    const auto encode = [&, this](auto&& get_item_index) {
+      std::vector<std::uint64_t> values(circuit_bins);
+      ENCRYPTO::BitVector<> valid(circuit_bins);
+      for (std::size_t bin_i = 0; bin_i < circuit_bins; ++bin_i) {
+        if (const std::optional<std::size_t> item_i = get_item_index(first_bin + bin_i)) {
+          values[bin_i] = items[*item_i];
+          valid.Set(true, bin_i);
+        }
+      }
+      auto planes = encode_bit_planes(std::span<const std::uint64_t>(values),
+                                      parameters_.bits_per_item);
+      planes.push_back(std::move(valid));
+      return planes;
+    };
+    std::vector<std::vector<ENCRYPTO::BitVector<>>> inputs;
+    if (is_client) {
+      inputs.push_back(encode([&](std::size_t bin_i) { return cuckoo_table[bin_i]; }));
+    } else {
+      for (std::size_t slot_i = 0; slot_i < max_load; ++slot_i) {
+        inputs.push_back(encode([&](std::size_t bin_i) -> std::optional<std::size_t> {
+          const auto& bin = simple_table[bin_i];
+          return slot_i < bin.size() ? std::optional(bin[slot_i]) : std::nullopt;
+        }));
+      }
+    }
+    const auto matches = run_circuit(circuit_bins, std::move(inputs));
+    if (is_client) {
+      for (std::size_t bin_i = 0; bin_i < circuit_bins; ++bin_i) {
+        const auto& item_i = cuckoo_table[first_bin + bin_i];
+        if (item_i.has_value() && matches.Get(bin_i)) {
+          result.push_back(*item_i);
+        }
+      }
+    }
+  }
+  statistics_.num_comparisons += num_bins * max_load;
+  std::sort(std::begin(result), std::end(result));
+  return result;
+}
+
+ENCRYPTO::BitVector<> PrivateSetIntersection::run_circuit(
+    std::size_t num_bins, std::vector<std::vector<ENCRYPTO::BitVector<>>>&& inputs) {
+  const auto num_wires = parameters_.bits_per_item + 1;
+  const auto num_slots = statistics_.max_bin_load;
+  const auto server_id = get_server_id();
+  const bool is_client = my_id_ == client_id_;
+
+  if (logger_) {
+    logger_->LogInfo(fmt::format("PrivateSetIntersection: comparing {} bins of {} slots with {}",
+                                 num_bins, num_slots, to_string(parameters_.pipeline)));
+  }
+
+  auto& backend = get_backend();
+  auto& boolean_factory = backend.get_gate_factory(MPCProtocol::BooleanBEAVY);
+  auto& arithmetic_factory = backend.get_gate_factory(MPCProtocol::ArithmeticBEAVY);
+
+  const auto make_input = [&](std::size_t input_owner,
+                              std::vector<ENCRYPTO::BitVector<>>* values) {
+    if (my_id_ != input_owner) {
+      return boolean_factory.make_boolean_input_gate_other(input_owner, num_wires, num_bins);
+    }
+    auto [promise, wires] =
+        boolean_factory.make_boolean_input_gate_my(input_owner, num_wires, num_bins);
+    promise.set_value(std::move(*values));
+    return wires;
+  };
+  const auto client_wires = make_input(client_id_, is_client ? &inputs.at(0) : nullptr);
+
+  // match bit of each bin, the XOR of the match bits of its slots
+  WireVector match;
+  for (std::size_t slot_i = 0; slot_i < num_slots; ++slot_i) {
+    const auto slot_wires = make_input(server_id, is_client ? nullptr : &inputs.at(slot_i));
+    WireVector slot_match;
+    if (parameters_.pipeline == PatternMatchingPipeline::msg) {
+      slot_match = boolean_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MSG,
+                                                    client_wires, slot_wires);
+    } else {
+      const auto mismatches = boolean_factory.make_binary_gate(
+          ENCRYPTO::PrimitiveOperationType::XOR, client_wires, slot_wires);
+      const auto distance =
+          boolean_factory.make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM, mismatches);
+      slot_match = arithmetic_factory.make_binary_gate(
+          ENCRYPTO::PrimitiveOperationType::EQEXP, distance,
+          proto::plain::make_arithmetic_constant_wire(64, num_bins, 2 * num_wires));
+    }
+    match = slot_i == 0 ? std::move(slot_match)
+                        : boolean_factory.make_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR,
+                                                           match, slot_match);
+  }
+
+  ENCRYPTO::ReusableFiberFuture<BitValues> match_future;
+  if (is_client) {
+    match_future = boolean_factory.make_boolean_output_gate_my(client_id_, match);
+  } else {
+    boolean_factory.make_boolean_output_gate_other(client_id_, match);
+  }
+
+  const auto start = clock_type::now();
+  backend.run();
+  statistics_.circuits_ms +=
+      std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  ++statistics_.num_circuits;
+  statistics_.run_time_stats.add(backend.get_run_time_stats());
+
+  if (!is_client) {
+    return {};
+  }
+  return std::move(match_future.get().at(0));
+}
+
+}  // namespace MOTION
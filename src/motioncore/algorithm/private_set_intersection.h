@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "algorithm/pattern_matcher.h"
+#include "statistics/analysis.h"
+#include "utility/bit_vector.h"
+
+namespace MOTION {
+
+class Logger;
+class TwoPartyBackend;
+
+namespace Communication {
+class CommunicationLayer;
+}  // namespace Communication
+
+// Both parties place their items with the same public hash functions into bins, the client with
+// cuckoo hashing (at most one item per bin), the server with simple hashing (each item in the bins
+// of all its hash functions), s.t. an item of the client can only match the server items of its
+// own bin.
+constexpr std::size_t psi_num_hash_functions = 3;
+
+// bin of an item for hash function hash_i
+std::size_t get_psi_bin(std::uint64_t item, std::size_t hash_i, std::uint64_t seed,
+                        std::size_t num_bins);
+// Cuckoo hashing of distinct items: the index of the item stored in each bin.  Throws
+// std::runtime_error if an item cannot be placed, which happens with negligible probability
+// for at least 1.27 bins per item.
+std::vector<std::optional<std::size_t>> make_cuckoo_table(
+    const std::vector<std::uint64_t>& items, std::size_t num_bins, std::uint64_t seed);
+// Simple hashing: the indices of the items stored in each bin, an item occurs once per bin.
+std::vector<std::vector<std::size_t>> make_simple_hash_table(
+    const std::vector<std::uint64_t>& items, std::size_t num_bins, std::uint64_t seed);
+// Public bound on the number of items in a bin of the simple hash table, which is exceeded with
+// probability at most 2^-statistical_security, s.t. the bins can be padded to it without
+// revealing the actual loads.
+std::size_t get_max_bin_load(std::size_t num_items, std::size_t num_bins,
+                             std::size_t statistical_security = 40);
+
+// The parameters need to be the same for both parties.
+struct PSIParameters {
+  std::size_t client_set_size = 0;
+  std::size_t server_set_size = 0;
+  // the items are smaller than 2^bits_per_item
+  std::size_t bits_per_item = 64;
+  // number of bins per client item
+  double bin_factor = 1.27;
+  // seed of the hash functions
+  std::uint64_t seed = 0;
+  // the bins are evaluated in circuits of at most this many bins, 0 puts all of them into one
+  std::size_t max_bins_per_circuit = 0;
+  // equality test of the items, as in the pattern matcher
+  PatternMatchingPipeline pipeline = PatternMatchingPipeline::msg;
+
+  std::size_t get_num_bins() const;
+};
+
+struct PSIStatistics {
+  std::size_t num_bins = 0;
+  // comparisons per bin
+  std::size_t max_bin_load = 0;
+  std::size_t num_comparisons = 0;
+  std::size_t num_circuits = 0;
+  // time to place the items into the bins
+  double hashing_ms = 0;
+  // total time of the circuits
+  double circuits_ms = 0;
+  Statistics::AccumulatedRunTimeStats run_time_stats;
+
+  std::string print_human_readable() const;
+};
+
+// Two-party private set intersection where the client learns which of its items are in the set
+// of the server, and the server learns nothing.  Instead of comparing every pair of items, each
+// client item is only compared with the server items of its bin (see make_cuckoo_table() and
+// make_simple_hash_table()), i.e., with get_max_bin_load() items, s.t. O(n + m) comparisons are
+// needed instead of O(n * m).
+//
+// The bins are packed into the SIMD values of one circuit: the client inputs the item of each bin
+// once, the server one input per slot of the bins, which are padded to the public maximum load
+// with dummies and shuffled.  An extra wire marks real items, s.t. dummies never match a real
+// item.  All slots are compared with the client's items in parallel, and since the server's items
+// in a bin are distinct, at most one slot matches, s.t. the match bit of a bin is the XOR of the
+// match bits of its slots, which is computed locally.  Only the match bit of each bin is output to
+// the client.
+class PrivateSetIntersection {
+ public:
+  PrivateSetIntersection(Communication::CommunicationLayer&, std::size_t client_id,
+                         PSIParameters, std::size_t num_threads, std::shared_ptr<Logger>);
+  ~PrivateSetIntersection();
+
+  std::size_t get_client_id() const noexcept { return client_id_; }
+  std::size_t get_server_id() const noexcept { return 1 - client_id_; }
+
+  // Called by both parties with their distinct items.  Returns the sorted indices of the client's
+  // items which are in the server's set for the client, and an empty vector for the server.
+  std::vector<std::size_t> run(const std::vector<std::uint64_t>& items);
+
+  const PSIStatistics& get_statistics() const noexcept { return statistics_; }
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // the backend of the previous circuit after a reset, or a new one
+  TwoPartyBackend& get_backend();
+  void check_items(const std::vector<std::uint64_t>& items) const;
+  // Compare num_bins bins, where the inputs hold the bits and the valid bit of the items, one
+  // BitVector per wire with a bit per bin, of the client's bins or of each slot of the server's
+  // bins.  Returns the match bits of the bins for the client.
+  ENCRYPTO::BitVector<> run_circuit(std::size_t num_bins,
+                                    std::vector<std::vector<ENCRYPTO::BitVector<>>>&& inputs);
+
+  Communication::CommunicationLayer& communication_layer_;
+  std::size_t my_id_;
+  std::size_t client_id_;
+  PSIParameters parameters_;
+  std::size_t num_threads_;
+  std::shared_ptr<Logger> logger_;
+  std::unique_ptr<TwoPartyBackend> backend_;
+  PSIStatistics statistics_;
+};
+
+}  // namespace MOTION
@@ -0,0 +1,623 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "protocol_assignment.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <boost/json.hpp>
+
+#include "gate/gate_cost.h"
+#include "statistics/circuit_analysis.h"
+#include "utility/typedefs.h"
+
+namespace json = boost::json;
+
+namespace MOTION {
+
+namespace {
+
+using PrimitiveOperationType = ENCRYPTO::PrimitiveOperationType;
+
+// operations and protocols which can be named in a calibration
+constexpr std::array<PrimitiveOperationType, 8> calibrated_operations = {
+    PrimitiveOperationType::XOR, PrimitiveOperationType::AND, PrimitiveOperationType::INV,
+    PrimitiveOperationType::OR,  PrimitiveOperationType::NEG, PrimitiveOperationType::ADD,
+    PrimitiveOperationType::MUL, PrimitiveOperationType::SQR};
+constexpr std::array<MPCProtocol, 5> calibrated_protocols = {
+    MPCProtocol::ArithmeticGMW, MPCProtocol::BooleanGMW, MPCProtocol::Yao,
+    MPCProtocol::ArithmeticBEAVY, MPCProtocol::BooleanBEAVY};
+
+std::optional<PrimitiveOperationType> parse_operation(std::string_view name) {
+  for (const auto op : calibrated_operations) {
+    if (ToString(op) == name) {
+      return op;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<MPCProtocol> parse_protocol(std::string_view name) {
+  for (const auto proto : calibrated_protocols) {
+    if (ToString(proto) == name) {
+      return proto;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string_view get_string(const json::object& object, std::string_view key) {
+  const auto* value = object.if_contains(key);
+  if (value == nullptr || !value->is_string()) {
+    throw std::invalid_argument(
+        fmt::format("ProtocolCostModel: missing string entry \"{}\" in calibration", key));
+  }
+  return value->get_string();
+}
+
+// overwrite the fields of the cost which are contained in the object
+void update_cost(OperationCost& cost, const json::object& object) {
+  if (const auto* value = object.if_contains("online_rounds")) {
+    cost.online_rounds_ = json::value_to<std::size_t>(*value);
+  }
+  if (const auto* value = object.if_contains("bits")) {
+    cost.bits_ = json::value_to<double>(*value);
+  }
+  if (const auto* value = object.if_contains("online_bits")) {
+    cost.online_bits_ = json::value_to<double>(*value);
+  }
+  if (const auto* value = object.if_contains("compute_time_us")) {
+    cost.compute_time_ = std::chrono::duration<double, std::micro>(json::value_to<double>(*value));
+  }
+}
+
+// true if the entry is for values of another bit size than the model's
+bool other_bit_size(const json::object& entry, std::size_t bit_size) {
+  const auto* value = entry.if_contains("bit_size");
+  return value != nullptr && bit_size != 0 && json::value_to<std::size_t>(*value) != bit_size;
+}
+
+const json::array& get_array(const json::object& object, std::string_view key) {
+  static const json::array empty;
+  const auto* value = object.if_contains(key);
+  if (value == nullptr) {
+    return empty;
+  }
+  if (!value->is_array()) {
+    throw std::invalid_argument(
+        fmt::format("ProtocolCostModel: entry \"{}\" is not an array", key));
+  }
+  return value->get_array();
+}
+
+bool is_gmw(MPCProtocol proto) {
+  return proto == MPCProtocol::BooleanGMW || proto == MPCProtocol::ArithmeticGMW;
+}
+
+// bits sent for the circuit, the setup phase of GMW consists of the triples only
+double get_charged_bits(const OperationCost& cost, MPCProtocol proto, bool pooled_mts) {
+  return pooled_mts && is_gmw(proto) ? cost.online_bits_ : cost.bits_;
+}
+
+void check_topological_order(const std::vector<ProtocolAssignmentNode>& nodes) {
+  for (std::size_t node_id = 0; node_id < nodes.size(); ++node_id) {
+    for (const auto input_id : nodes[node_id].inputs_) {
+      if (input_id >= node_id) {
+        throw std::invalid_argument(fmt::format(
+            "ProtocolAssigner: input {} of node {} is not an earlier node", input_id, node_id));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+ProtocolCostModel ProtocolCostModel::make_default(std::size_t bit_size) {
+  const auto l = static_cast<double>(bit_size);
+  const auto kappa = static_cast<double>(GateCost::ot_security_parameter);
+  ProtocolCostModel model;
+  model.bit_size = bit_size;
+  auto& ops = model.operations_;
+  auto& convs = model.conversions_;
+
+  // Arithmetic GMW: a multiplication opens two masked values and needs a triple from
+  // bit_size COTs with bit_size bit messages
+  ops[{PrimitiveOperationType::ADD, MPCProtocol::ArithmeticGMW}] = {0, 0};
+  ops[{PrimitiveOperationType::NEG, MPCProtocol::ArithmeticGMW}] = {0, 0};
+  ops[{PrimitiveOperationType::MUL, MPCProtocol::ArithmeticGMW}] = {1, 2 * l + l * (kappa + l),
+                                                                     2 * l};
+  ops[{PrimitiveOperationType::SQR, MPCProtocol::ArithmeticGMW}] = {1, l + l * (kappa + l) / 2, l};
+  // Arithmetic BEAVY: one share of the masked product online, the rest in the setup
+  ops[{PrimitiveOperationType::ADD, MPCProtocol::ArithmeticBEAVY}] = {0, 0};
+  ops[{PrimitiveOperationType::NEG, MPCProtocol::ArithmeticBEAVY}] = {0, 0};
+  ops[{PrimitiveOperationType::MUL, MPCProtocol::ArithmeticBEAVY}] = {1, l + l * (kappa + l), l};
+  ops[{PrimitiveOperationType::SQR, MPCProtocol::ArithmeticBEAVY}] = {1, l + l * (kappa + l) / 2,
+                                                                       l};
+  // Boolean GMW and BEAVY: the same per bit with random OTs for the MTs
+  for (const auto proto : {MPCProtocol::BooleanGMW, MPCProtocol::BooleanBEAVY}) {
+    const double online_bits = proto == MPCProtocol::BooleanGMW ? 2 * l : l;
+    ops[{PrimitiveOperationType::XOR, proto}] = {0, 0};
+    ops[{PrimitiveOperationType::INV, proto}] = {0, 0};
+    ops[{PrimitiveOperationType::AND, proto}] = {1, online_bits + 2 * l * (kappa + 1),
+                                                 online_bits};
+    ops[{PrimitiveOperationType::OR, proto}] = {1, online_bits + 2 * l * (kappa + 1), online_bits};
+  }
+  // Yao with half gates: the garbled tables are sent before the online phase
+  ops[{PrimitiveOperationType::XOR, MPCProtocol::Yao}] = {0, 0};
+  ops[{PrimitiveOperationType::INV, MPCProtocol::Yao}] = {0, 0};
+  ops[{PrimitiveOperationType::AND, MPCProtocol::Yao}] = {0, 2 * kappa * l};
+  ops[{PrimitiveOperationType::OR, MPCProtocol::Yao}] = {0, 2 * kappa * l};
+
+  // the direct conversions supported by the providers
+  convs[{MPCProtocol::BooleanGMW, MPCProtocol::ArithmeticGMW}] = {1, l * (kappa + l),
+                                                                  l * (kappa + l)};
+  convs[{MPCProtocol::BooleanBEAVY, MPCProtocol::ArithmeticBEAVY}] = {1, l + l * (kappa + l), l};
+  convs[{MPCProtocol::BooleanBEAVY, MPCProtocol::BooleanGMW}] = {0, 0};
+  convs[{MPCProtocol::ArithmeticBEAVY, MPCProtocol::ArithmeticGMW}] = {0, 0};
+  convs[{MPCProtocol::BooleanGMW, MPCProtocol::BooleanBEAVY}] = {1, l, l};
+  convs[{MPCProtocol::ArithmeticGMW, MPCProtocol::ArithmeticBEAVY}] = {1, l, l};
+  for (const auto proto : {MPCProtocol::BooleanGMW, MPCProtocol::BooleanBEAVY}) {
+    // the evaluator obtains the keys of its shares by OT
+    const auto ot_bits = l * kappa + l * (kappa + 1);
+    convs[{proto, MPCProtocol::Yao}] = {1, ot_bits, ot_bits};
+    convs[{MPCProtocol::Yao, proto}] = {1, l, l};
+  }
+  for (const auto proto : {MPCProtocol::ArithmeticGMW, MPCProtocol::ArithmeticBEAVY}) {
+    // additionally the shares are added (subtracted) in a garbled circuit sent in the setup
+    const auto ot_bits = l * kappa + l * (kappa + 1);
+    convs[{proto, MPCProtocol::Yao}] = {1, ot_bits + 2 * kappa * l, ot_bits};
+    convs[{MPCProtocol::Yao, proto}] = {1, l + 2 * kappa * l, l};
+  }
+  return model;
+}
+
+void ProtocolCostModel::calibrate(const json::object& object) {
+  for (const auto& value : get_array(object, "operations")) {
+    const auto& entry = value.as_object();
+    const auto op = parse_operation(get_string(entry, "operation"));
+    const auto proto = parse_protocol(get_string(entry, "protocol"));
+    if (op.has_value() && proto.has_value() && !other_bit_size(entry, bit_size)) {
+      update_cost(operations_[{*op, *proto}], entry);
+    }
+  }
+  for (const auto& value : get_array(object, "conversions")) {
+    const auto& entry = value.as_object();
+    const auto src = parse_protocol(get_string(entry, "source"));
+    const auto dst = parse_protocol(get_string(entry, "destination"));
+    if (src.has_value() && dst.has_value() && !other_bit_size(entry, bit_size)) {
+      update_cost(conversions_[{*src, *dst}], entry);
+    }
+  }
+}
+
+void ProtocolCostModel::load_calibration(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error(fmt::format("ProtocolCostModel: could not open {}", path));
+  }
+  const std::string content(std::istreambuf_iterator<char>(file), {});
+  json::error_code ec;
+  const auto value = json::parse(content, ec);
+  if (ec || !value.is_object()) {
+    throw std::runtime_error(fmt::format("ProtocolCostModel: could not parse {}", path));
+  }
+  calibrate(value.get_object());
+}
+
+std::chrono::duration<double> ProtocolCostModel::estimate(const OperationCost& cost,
+                                                          std::size_t num_simd) const {
+  const auto n = static_cast<double>(num_simd);
+  auto time = static_cast<double>(cost.online_rounds_) * round_trip_time / 2 +
+              n * cost.compute_time_;
+  if (bandwidth > 0) {
+    time += std::chrono::duration<double>(n * cost.bits_ / bandwidth);
+  }
+  return time;
+}
+
+std::chrono::duration<double> ProtocolCostModel::estimate_online(const OperationCost& cost,
+                                                                 std::size_t num_simd) const {
+  const auto n = static_cast<double>(num_simd);
+  auto time = static_cast<double>(cost.online_rounds_) * round_trip_time / 2 +
+              n * cost.compute_time_;
+  if (bandwidth > 0) {
+    time += std::chrono::duration<double>(n * cost.online_bits_ / bandwidth);
+  }
+  return time;
+}
+
+std::optional<std::chrono::duration<double>> ProtocolCostModel::estimate_operation(
+    PrimitiveOperationType op, MPCProtocol proto, std::size_t num_simd) const {
+  const auto it = operations_.find({op, proto});
+  if (it == std::end(operations_)) {
+    return std::nullopt;
+  }
+  return estimate(it->second, num_simd);
+}
+
+std::optional<std::chrono::duration<double>> ProtocolCostModel::estimate_circuit(
+    const ENCRYPTO::AlgorithmDescription& algo, MPCProtocol proto, std::size_t num_simd) const {
+  const auto cost = get_circuit_cost(algo, proto, num_simd);
+  if (!cost.has_value()) {
+    return std::nullopt;
+  }
+  return estimate(*cost, 1);
+}
+
+std::optional<OperationCost> ProtocolCostModel::get_circuit_cost(
+    const ENCRYPTO::AlgorithmDescription& algo, MPCProtocol proto, std::size_t num_simd) const {
+  if (proto != MPCProtocol::BooleanGMW && proto != MPCProtocol::BooleanBEAVY &&
+      proto != MPCProtocol::Yao) {
+    return std::nullopt;
+  }
+  // the analysis is for the whole SIMD vector already
+  const auto analysis = Statistics::analyze_circuit(algo, proto, num_simd);
+  OperationCost cost;
+  cost.online_rounds_ = analysis.online_rounds_;
+  cost.bits_ = 8 * static_cast<double>(analysis.get_setup_bytes() + analysis.get_online_bytes());
+  cost.online_bits_ = 8 * static_cast<double>(analysis.get_online_bytes());
+  return cost;
+}
+
+std::optional<std::chrono::duration<double>> ProtocolCostModel::estimate_conversion(
+    MPCProtocol src, MPCProtocol dst, std::size_t num_simd,
+    const convert_via_function& convert_via) const {
+  const auto cost = get_conversion_cost(src, dst, convert_via);
+  if (!cost.has_value()) {
+    return std::nullopt;
+  }
+  return estimate(*cost, num_simd);
+}
+
+std::optional<OperationCost> ProtocolCostModel::get_conversion_cost(
+    MPCProtocol src, MPCProtocol dst, const convert_via_function& convert_via) const {
+  if (src == dst) {
+    return OperationCost{};
+  }
+  if (const auto via = convert_via ? convert_via(src, dst) : std::nullopt; via.has_value()) {
+    const auto first = get_conversion_cost(src, *via, convert_via);
+    const auto second = get_conversion_cost(*via, dst, convert_via);
+    if (!first.has_value() || !second.has_value()) {
+      return std::nullopt;
+    }
+    return OperationCost{first->online_rounds_ + second->online_rounds_,
+                         first->bits_ + second->bits_, first->online_bits_ + second->online_bits_,
+                         first->compute_time_ + second->compute_time_};
+  }
+  const auto it = conversions_.find({src, dst});
+  if (it == std::end(conversions_)) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::string ProtocolAssignment::print_human_readable() const {
+  std::stringstream ss;
+  std::map<MPCProtocol, std::size_t> num_nodes;
+  for (const auto proto : protocols_) {
+    ++num_nodes[proto];
+  }
+  ss << fmt::format(
+      "Protocol assignment of {} nodes, estimated time {:.3f} ms (online {:.3f} ms), {:.1f} kB\n",
+      protocols_.size(), std::chrono::duration<double, std::milli>(estimated_time_).count(),
+      std::chrono::duration<double, std::milli>(estimated_online_time_).count(),
+      estimated_bits_ / 8000);
+  for (const auto& [proto, count] : num_nodes) {
+    ss << fmt::format("  {:16s} {:8d} nodes\n", ToString(proto), count);
+  }
+  for (const auto& conversion : conversions_) {
+    ss << fmt::format("  convert node {} from {} to {}\n", conversion.node_,
+                      ToString(conversion.src_), ToString(conversion.dst_));
+  }
+  return ss.str();
+}
+
+ProtocolAssigner::ProtocolAssigner(ProtocolCostModel cost_model,
+                                   std::vector<MPCProtocol> protocols,
+                                   ProtocolCostModel::convert_via_function convert_via)
+    : cost_model_(std::move(cost_model)),
+      protocols_(std::move(protocols)),
+      convert_via_(std::move(convert_via)) {
+  if (protocols_.empty()) {
+    throw std::invalid_argument("ProtocolAssigner: need at least one protocol");
+  }
+}
+
+std::optional<std::chrono::duration<double>> ProtocolAssigner::estimate_node(
+    const ProtocolAssignmentNode& node, MPCProtocol proto) const {
+  const auto cost = get_node_cost(node, proto);
+  if (!cost.has_value()) {
+    return std::nullopt;
+  }
+  return cost_model_.estimate(cost->first, cost->second);
+}
+
+std::optional<std::pair<OperationCost, std::size_t>> ProtocolAssigner::get_node_cost(
+    const ProtocolAssignmentNode& node, MPCProtocol proto) const {
+  if (node.operation_ == PrimitiveOperationType::IN ||
+      node.operation_ == PrimitiveOperationType::OUT) {
+    return std::make_pair(OperationCost{}, std::size_t(1));
+  }
+  if (node.circuit_ != nullptr) {
+    const auto cost = cost_model_.get_circuit_cost(*node.circuit_, proto, node.num_simd_);
+    if (!cost.has_value()) {
+      return std::nullopt;
+    }
+    return std::make_pair(*cost, std::size_t(1));
+  }
+  const auto it = cost_model_.operations_.find({node.operation_, proto});
+  if (it == std::end(cost_model_.operations_)) {
+    return std::nullopt;
+  }
+  return std::make_pair(it->second, node.num_simd_);
+}
+
+std::optional<std::chrono::duration<double>> ProtocolAssigner::estimate_conversion(
+    MPCProtocol src, MPCProtocol dst, std::size_t num_simd) const {
+  return cost_model_.estimate_conversion(src, dst, num_simd, convert_via_);
+}
+
+ProtocolAssignment ProtocolAssigner::assign(
+    const std::vector<ProtocolAssignmentNode>& nodes) const {
+  using duration = std::chrono::duration<double>;
+  const auto num_protocols = protocols_.size();
+  const auto allowed = [this](const ProtocolAssignmentNode& node, std::size_t proto_i) {
+    return !node.protocol_.has_value() || *node.protocol_ == protocols_[proto_i];
+  };
+  check_topological_order(nodes);
+
+  // ready[node][p]: earliest time at which the node's output is available in protocols_[p]
+  std::vector<std::vector<std::optional<duration>>> ready(nodes.size());
+  // best_input_protocol[node][input_i][p]: protocol of the input for the best ready[node][p]
+  std::vector<std::vector<std::vector<std::size_t>>> best_input_protocol(nodes.size());
+  for (std::size_t node_id = 0; node_id < nodes.size(); ++node_id) {
+    const auto& node = nodes[node_id];
+    ready[node_id].resize(num_protocols);
+    best_input_protocol[node_id].assign(node.inputs_.size(),
+                                        std::vector<std::size_t>(num_protocols));
+    for (std::size_t p = 0; p < num_protocols; ++p) {
+      if (!allowed(node, p)) {
+        continue;
+      }
+      const auto cost = estimate_node(node, protocols_[p]);
+      if (!cost.has_value()) {
+        continue;
+      }
+      duration start{0};
+      bool feasible = true;
+      for (std::size_t input_i = 0; input_i < node.inputs_.size() && feasible; ++input_i) {
+        const auto input_id = node.inputs_[input_i];
+        std::optional<duration> best;
+        for (std::size_t q = 0; q < num_protocols; ++q) {
+          if (!ready[input_id][q].has_value()) {
+            continue;
+          }
+          const auto conversion =
+              estimate_conversion(protocols_[q], protocols_[p], nodes[input_id].num_simd_);
+          if (!conversion.has_value()) {
+            continue;
+          }
+          const auto time = *ready[input_id][q] + *conversion;
+          if (!best.has_value() || time < *best) {
+            best = time;
+            best_input_protocol[node_id][input_i][p] = q;
+          }
+        }
+        if (best.has_value()) {
+          start = std::max(start, *best);
+        } else {
+          feasible = false;
+        }
+      }
+      if (feasible) {
+        ready[node_id][p] = start + *cost;
+      }
+    }
+    if (std::none_of(std::begin(ready[node_id]), std::end(ready[node_id]),
+                     [](const auto& time) { return time.has_value(); })) {
+      throw std::invalid_argument(fmt::format(
+          "ProtocolAssigner: node {} ({}) cannot be evaluated in any of the protocols", node_id,
+          ToString(node.operation_)));
+    }
+  }
+
+  // choose from the outputs to the inputs: nodes without a chosen protocol whose output is not
+  // used by a chosen node take their fastest protocol
+  std::vector<std::optional<std::size_t>> chosen(nodes.size());
+  for (std::size_t i = nodes.size(); i-- > 0;) {
+    if (!chosen[i].has_value()) {
+      std::size_t best_p = num_protocols;
+      for (std::size_t p = 0; p < num_protocols; ++p) {
+        if (ready[i][p].has_value() &&
+            (best_p == num_protocols || *ready[i][p] < *ready[i][best_p])) {
+          best_p = p;
+        }
+      }
+      chosen[i] = best_p;
+    }
+    const auto& node = nodes[i];
+    for (std::size_t input_i = 0; input_i < node.inputs_.size(); ++input_i) {
+      auto& input_choice = chosen[node.inputs_[input_i]];
+      if (!input_choice.has_value()) {
+        input_choice = best_input_protocol[i][input_i][*chosen[i]];
+      }
+    }
+  }
+
+  std::vector<MPCProtocol> protocols;
+  protocols.reserve(nodes.size());
+  for (const auto p : chosen) {
+    protocols.push_back(protocols_[*p]);
+  }
+  return make_assignment(nodes, std::move(protocols), false);
+}
+
+ProtocolAssignment ProtocolAssigner::assign_boolean_sharing(
+    const std::vector<ProtocolAssignmentNode>& nodes, std::chrono::duration<double> max_online_time,
+    bool pooled_mts) const {
+  using duration = std::chrono::duration<double>;
+  check_topological_order(nodes);
+
+  // number of consumers and layer of each node
+  std::vector<std::size_t> fan_out(nodes.size(), 0);
+  std::vector<std::size_t> depth(nodes.size(), 0);
+  // every node starts in the sharing with fewer bits, GMW nodes which BEAVY supports may move
+  std::vector<MPCProtocol> protocols(nodes.size());
+  std::vector<bool> movable(nodes.size(), false);
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const auto& node = nodes[i];
+    for (const auto input_id : node.inputs_) {
+      ++fan_out[input_id];
+      depth[i] = std::max(depth[i], depth[input_id] + 1);
+    }
+    if (node.protocol_.has_value()) {
+      protocols[i] = *node.protocol_;
+      continue;
+    }
+    const auto gmw = get_node_cost(node, MPCProtocol::BooleanGMW);
+    const auto beavy = get_node_cost(node, MPCProtocol::BooleanBEAVY);
+    if (!gmw.has_value() && !beavy.has_value()) {
+      throw std::invalid_argument(fmt::format(
+          "ProtocolAssigner: node {} ({}) cannot be evaluated in BooleanGMW or BooleanBEAVY", i,
+          ToString(node.operation_)));
+    }
+    const auto bits = [pooled_mts](const auto& cost, MPCProtocol proto) {
+      return static_cast<double>(cost->second) * get_charged_bits(cost->first, proto, pooled_mts);
+    };
+    if (gmw.has_value() && (!beavy.has_value() || bits(gmw, MPCProtocol::BooleanGMW) <=
+                                                      bits(beavy, MPCProtocol::BooleanBEAVY))) {
+      protocols[i] = MPCProtocol::BooleanGMW;
+      movable[i] = beavy.has_value();
+    } else {
+      protocols[i] = MPCProtocol::BooleanBEAVY;
+    }
+  }
+
+  std::vector<duration> online_times(nodes.size());
+  // the input of each node on its critical path
+  std::vector<std::optional<std::size_t>> critical_input(nodes.size());
+  while (!nodes.empty()) {
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      duration start{0};
+      critical_input[i] = std::nullopt;
+      for (const auto input_id : nodes[i].inputs_) {
+        const auto conversion =
+            cost_model_.get_conversion_cost(protocols[input_id], protocols[i], convert_via_);
+        if (!conversion.has_value()) {
+          throw std::invalid_argument(
+              fmt::format("ProtocolAssigner: no conversion from {} to {} for node {}",
+                          ToString(protocols[input_id]), ToString(protocols[i]), input_id));
+        }
+        const auto time = online_times[input_id] +
+                          cost_model_.estimate_online(*conversion, nodes[input_id].num_simd_);
+        if (!critical_input[i].has_value() || time > start) {
+          start = time;
+          critical_input[i] = input_id;
+        }
+      }
+      online_times[i] = start;
+      if (const auto cost = get_node_cost(nodes[i], protocols[i]); cost.has_value()) {
+        online_times[i] += cost_model_.estimate_online(cost->first, cost->second);
+      }
+      if (online_times[i] > online_times[last]) {
+        last = i;
+      }
+    }
+    if (online_times[last] <= max_online_time) {
+      break;
+    }
+    std::optional<std::size_t> candidate;
+    for (auto i = std::make_optional(last); i.has_value(); i = critical_input[*i]) {
+      if (!movable[*i] || protocols[*i] != MPCProtocol::BooleanGMW) {
+        continue;
+      }
+      if (!candidate.has_value() || fan_out[*i] > fan_out[*candidate] ||
+          (fan_out[*i] == fan_out[*candidate] && depth[*i] < depth[*candidate])) {
+        candidate = *i;
+      }
+    }
+    if (!candidate.has_value()) {
+      break;
+    }
+    protocols[*candidate] = MPCProtocol::BooleanBEAVY;
+  }
+  return make_assignment(nodes, std::move(protocols), pooled_mts);
+}
+
+ProtocolAssignment ProtocolAssigner::make_assignment(
+    const std::vector<ProtocolAssignmentNode>& nodes, std::vector<MPCProtocol> protocols,
+    bool pooled_mts) const {
+  using duration = std::chrono::duration<double>;
+  ProtocolAssignment assignment;
+  assignment.protocols_ = std::move(protocols);
+  std::vector<duration> times(nodes.size());
+  std::vector<duration> online_times(nodes.size());
+  std::set<std::pair<std::size_t, MPCProtocol>> conversions;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const auto& node = nodes[i];
+    const auto proto = assignment.protocols_[i];
+    duration start{0};
+    duration online_start{0};
+    for (const auto input_id : node.inputs_) {
+      const auto input_proto = assignment.protocols_[input_id];
+      const auto conversion = cost_model_.get_conversion_cost(input_proto, proto, convert_via_);
+      if (!conversion.has_value()) {
+        // can only happen for an input chosen by an earlier consumer
+        throw std::invalid_argument(
+            fmt::format("ProtocolAssigner: no conversion from {} to {} for node {}",
+                        ToString(input_proto), ToString(proto), input_id));
+      }
+      const auto num_simd = nodes[input_id].num_simd_;
+      start = std::max(start, times[input_id] + cost_model_.estimate(*conversion, num_simd));
+      online_start = std::max(online_start, online_times[input_id] +
+                                                cost_model_.estimate_online(*conversion, num_simd));
+      if (input_proto != proto && conversions.emplace(input_id, proto).second) {
+        assignment.conversions_.push_back({input_id, input_proto, proto});
+        assignment.estimated_bits_ += static_cast<double>(num_simd) * conversion->bits_;
+      }
+    }
+    times[i] = start;
+    online_times[i] = online_start;
+    if (const auto cost = get_node_cost(node, proto); cost.has_value()) {
+      const auto& [node_cost, num_values] = *cost;
+      times[i] += cost_model_.estimate(node_cost, num_values);
+      online_times[i] += cost_model_.estimate_online(node_cost, num_values);
+      assignment.estimated_bits_ +=
+          static_cast<double>(num_values) * get_charged_bits(node_cost, proto, pooled_mts);
+    }
+    assignment.estimated_time_ = std::max(assignment.estimated_time_, times[i]);
+    assignment.estimated_online_time_ =
+        std::max(assignment.estimated_online_time_, online_times[i]);
+  }
+  return assignment;
+}
+
+}  // namespace MOTION
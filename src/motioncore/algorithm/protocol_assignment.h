@@ -0,0 +1,198 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/json/object.hpp>
+
+namespace ENCRYPTO {
+struct AlgorithmDescription;
+enum class PrimitiveOperationType : std::uint8_t;
+}  // namespace ENCRYPTO
+
+namespace MOTION {
+
+enum class MPCProtocol : unsigned int;
+
+// Cost of an operation or a direct conversion per SIMD value.  The bits are all the bits sent by
+// a party, i.e., including the setup phase, since the assignment minimizes the end-to-end time.
+struct OperationCost {
+  std::size_t online_rounds_ = 0;
+  double bits_ = 0;
+  // part of bits_ sent in the online phase, the rest is sent in the setup phase
+  double online_bits_ = 0;
+  // local computation, e.g., measured in a benchmark run
+  std::chrono::duration<double> compute_time_{0};
+};
+
+// Costs of the operations in each protocol on a network, used to assign the operations of a
+// mixed circuit to protocols.  Like the CircuitCostModel, every round costs half a round trip
+// since both parties send at the same time.
+struct ProtocolCostModel {
+  using convert_via_function = std::function<std::optional<MPCProtocol>(MPCProtocol, MPCProtocol)>;
+
+  std::chrono::duration<double> round_trip_time{0};
+  // bits per second, 0 means unlimited
+  double bandwidth = 0;
+  // size of the values, 0 if unknown
+  std::size_t bit_size = 0;
+  // (operation, protocol) -> cost, unsupported combinations are missing
+  std::map<std::pair<ENCRYPTO::PrimitiveOperationType, MPCProtocol>, OperationCost> operations_;
+  // (source, destination) -> cost of a direct conversion
+  std::map<std::pair<MPCProtocol, MPCProtocol>, OperationCost> conversions_;
+
+  // Analytic costs of the two-party GMW, BEAVY and Yao operations and conversions on values of
+  // `bit_size` bits, without local computation.
+  static ProtocolCostModel make_default(std::size_t bit_size);
+
+  // Replace the costs of the listed entries by calibrated ones from a JSON object of the form
+  //   {"operations": [{"operation": "MUL", "protocol": "ArithmeticBEAVY", "online_rounds": 1,
+  //                    "bits": 64, "compute_time_us": 0.5}, ...],
+  //    "conversions": [{"source": "ArithmeticBEAVY", "destination": "Yao", ...}, ...]}
+  // where missing fields keep their previous value.  Entries with a "bit_size" other than the one
+  // of the model and entries of other operations and protocols, e.g., the BMR ones of the machine
+  // profiles written by motion_calibrate, are skipped.
+  void calibrate(const boost::json::object&);
+  void load_calibration(const std::string& path);
+
+  std::chrono::duration<double> estimate(const OperationCost&, std::size_t num_simd) const;
+  // only the online phase: the rounds, the online bits and the local computation
+  std::chrono::duration<double> estimate_online(const OperationCost&, std::size_t num_simd) const;
+  // nullopt if the protocol does not support the operation
+  std::optional<std::chrono::duration<double>> estimate_operation(ENCRYPTO::PrimitiveOperationType,
+                                                                  MPCProtocol,
+                                                                  std::size_t num_simd) const;
+  // Boolean circuit evaluated in BooleanGMW, BooleanBEAVY or Yao, see
+  // Statistics::analyze_circuit(), nullopt for other protocols
+  std::optional<std::chrono::duration<double>> estimate_circuit(
+      const ENCRYPTO::AlgorithmDescription&, MPCProtocol, std::size_t num_simd) const;
+  // cost of the circuit for the whole SIMD vector
+  std::optional<OperationCost> get_circuit_cost(const ENCRYPTO::AlgorithmDescription&, MPCProtocol,
+                                                std::size_t num_simd) const;
+  // conversion along the path taken by CircuitBuilder::convert() with the given convert_via
+  std::optional<std::chrono::duration<double>> estimate_conversion(
+      MPCProtocol src, MPCProtocol dst, std::size_t num_simd,
+      const convert_via_function& convert_via) const;
+  // sum of the costs of the direct conversions on that path
+  std::optional<OperationCost> get_conversion_cost(MPCProtocol src, MPCProtocol dst,
+                                                   const convert_via_function& convert_via) const;
+};
+
+// Operation of a mixed circuit whose protocol is to be chosen.
+struct ProtocolAssignmentNode {
+  // IN for an input, OUT for an output, otherwise a unary or binary operation
+  ENCRYPTO::PrimitiveOperationType operation_;
+  // ids of the nodes (i.e., indices in the node vector) which are the inputs of this one, they
+  // need to come earlier
+  std::vector<std::size_t> inputs_;
+  std::size_t num_simd_ = 1;
+  // evaluate this Boolean circuit with two inputs instead of the operation
+  const ENCRYPTO::AlgorithmDescription* circuit_ = nullptr;
+  // fixed protocol, e.g., for inputs which are shared already or outputs needed in some protocol
+  std::optional<MPCProtocol> protocol_;
+};
+
+struct ProtocolAssignment {
+  struct Conversion {
+    // node whose output is converted
+    std::size_t node_;
+    MPCProtocol src_;
+    MPCProtocol dst_;
+  };
+
+  // protocol of each node
+  std::vector<MPCProtocol> protocols_;
+  // conversions inserted between the nodes, each at most once
+  std::vector<Conversion> conversions_;
+  std::chrono::duration<double> estimated_time_{0};
+  // time until the last output is available in the online phase
+  std::chrono::duration<double> estimated_online_time_{0};
+  // bits sent by a party, without the triples of GMW if they are taken from a pool
+  double estimated_bits_ = 0;
+
+  std::string print_human_readable() const;
+};
+
+// Chooses a protocol for each node of a mixed circuit, such that the estimated time until the last
+// output is available is small.  The time at which a node is available in each protocol is
+// computed in topological order, which is exact for trees.  Then the protocols are chosen from the
+// outputs to the inputs, where a node used by several others keeps the first choice and is
+// converted for the others.
+class ProtocolAssigner {
+ public:
+  ProtocolAssigner(ProtocolCostModel cost_model, std::vector<MPCProtocol> protocols,
+                   ProtocolCostModel::convert_via_function convert_via);
+
+  // throws std::invalid_argument if the nodes are not in topological order or some node cannot
+  // be evaluated in any of the protocols
+  ProtocolAssignment assign(const std::vector<ProtocolAssignmentNode>&) const;
+
+  // Chooses BooleanGMW or BooleanBEAVY for each node of a Boolean circuit, such that the parties
+  // send few bits while the online phase takes at most `max_online_time`.  With `pooled_mts`, the
+  // triples of GMW are taken from the pool of the MTProvider, which is filled ahead of the
+  // circuit, so a GMW AND costs only the opened values, whereas BEAVY needs a setup phase for
+  // every gate of the circuit but opens a single value per gate online, which its consumers share.
+  //
+  // Every node starts in the sharing with fewer bits.  As long as the online phase is too long,
+  // the GMW node on the critical path with the most consumers is moved to BEAVY, preferring the
+  // shallower ones on a tie, s.t. the BEAVY regions grow along the critical path from the nodes
+  // whose output is reused most.  The conversions from BEAVY to GMW are local, while the ones in
+  // the other direction need a round, which is charged where the regions meet.  If the budget
+  // cannot be met, the assignment with the critical path in BEAVY is returned, check
+  // estimated_online_time_.  Nodes with a fixed protocol keep it.  Throws std::invalid_argument
+  // like assign() and if a node is supported by neither of the sharings.
+  ProtocolAssignment assign_boolean_sharing(const std::vector<ProtocolAssignmentNode>&,
+                                            std::chrono::duration<double> max_online_time,
+                                            bool pooled_mts = true) const;
+
+  const ProtocolCostModel& get_cost_model() const noexcept { return cost_model_; }
+
+ private:
+  std::optional<std::chrono::duration<double>> estimate_node(const ProtocolAssignmentNode&,
+                                                             MPCProtocol) const;
+  // cost of the node per value and the number of values, nullopt if the protocol does not
+  // support the node
+  std::optional<std::pair<OperationCost, std::size_t>> get_node_cost(const ProtocolAssignmentNode&,
+                                                                     MPCProtocol) const;
+  // the conversions and estimates of the chosen protocols
+  ProtocolAssignment make_assignment(const std::vector<ProtocolAssignmentNode>&,
+                                     std::vector<MPCProtocol> protocols, bool pooled_mts) const;
+  std::optional<std::chrono::duration<double>> estimate_conversion(MPCProtocol src,
+                                                                   MPCProtocol dst,
+                                                                   std::size_t num_simd) const;
+
+  ProtocolCostModel cost_model_;
+  std::vector<MPCProtocol> protocols_;
+  ProtocolCostModel::convert_via_function convert_via_;
+};
+
+}  // namespace MOTION
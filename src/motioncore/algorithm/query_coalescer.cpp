@@ -0,0 +1,246 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "query_coalescer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "communication/communication_layer.h"
+#include "communication/message.h"
+#include "communication/message_handler.h"
+
+namespace MOTION {
+
+namespace {
+
+// The payload of a PatternQueryBatch message is the batch size of PatternMatcher::run() followed
+// by the type, the pipeline (or 0xff if the planner chooses) and the pattern size of each query.
+// An empty payload lets the text owner stop.
+constexpr std::uint8_t planner_pipeline = 0xff;
+constexpr std::size_t encoded_query_size = 2 + sizeof(std::uint64_t);
+
+void append_uint64(std::vector<std::uint8_t>& payload, std::uint64_t value) {
+  const auto offset = payload.size();
+  payload.resize(offset + sizeof(value));
+  std::memcpy(payload.data() + offset, &value, sizeof(value));
+}
+
+std::uint64_t read_uint64(const std::uint8_t* data) {
+  std::uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+QueryCoalescer::QueryCoalescer(Communication::CommunicationLayer& communication_layer,
+                               PatternMatcher& pattern_matcher, QueryCoalescingPolicy policy)
+    : communication_layer_(communication_layer),
+      pattern_matcher_(pattern_matcher),
+      policy_(policy),
+      is_pattern_owner_(communication_layer.get_my_id() == pattern_matcher.get_pattern_owner()) {
+  if (policy_.max_queries == 0 || policy_.max_batch_size == 0) {
+    throw std::invalid_argument("QueryCoalescer: batch sizes need to be positive");
+  }
+  if (!is_pattern_owner_) {
+    batch_handler_ = std::make_shared<Communication::QueueHandler>();
+    communication_layer_.register_message_handler(
+        [handler = batch_handler_](std::size_t) { return handler; },
+        {Communication::MessageType::PatternQueryBatch});
+  }
+  // the handler is registered before the pattern owner can send a batch
+  communication_layer_.sync();
+}
+
+QueryCoalescer::~QueryCoalescer() {
+  if (batch_handler_) {
+    communication_layer_.deregister_message_handler(
+        {Communication::MessageType::PatternQueryBatch});
+  }
+}
+
+std::future<ENCRYPTO::BitVector<>> QueryCoalescer::submit(PatternQuery query) {
+  if (!is_pattern_owner_) {
+    throw std::logic_error("QueryCoalescer: only the pattern owner can submit queries");
+  }
+  std::promise<ENCRYPTO::BitVector<>> promise;
+  auto future = promise.get_future();
+  {
+    std::scoped_lock lock(mutex_);
+    if (stopped_) {
+      throw std::logic_error("QueryCoalescer: submit() after stop()");
+    }
+    pending_queries_.push_back({std::move(query), std::move(promise), clock_type::now()});
+  }
+  cv_.notify_all();
+  return future;
+}
+
+void QueryCoalescer::stop() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  // an empty message wakes up serve() of the text owner
+  if (batch_handler_) {
+    batch_handler_->get_queue().enqueue(std::vector<std::uint8_t>());
+  }
+}
+
+QueryCoalescingStatistics QueryCoalescer::get_statistics() const {
+  std::scoped_lock lock(mutex_);
+  return statistics_;
+}
+
+void QueryCoalescer::serve() {
+  if (is_pattern_owner_) {
+    serve_patterns();
+  } else {
+    serve_text();
+  }
+}
+
+std::deque<QueryCoalescer::PendingQuery> QueryCoalescer::take_batch() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !pending_queries_.empty() || stopped_; });
+  if (!stopped_) {
+    // the oldest query determines the deadline of the batch
+    const auto deadline = pending_queries_.front().submitted + policy_.max_delay;
+    cv_.wait_until(lock, deadline, [this] {
+      return pending_queries_.size() >= policy_.max_queries || stopped_;
+    });
+  }
+  const auto num_queries = std::min(pending_queries_.size(), policy_.max_queries);
+  std::deque<PendingQuery> batch;
+  std::move(std::begin(pending_queries_), std::begin(pending_queries_) + num_queries,
+            std::back_inserter(batch));
+  pending_queries_.erase(std::begin(pending_queries_),
+                         std::begin(pending_queries_) + num_queries);
+  return batch;
+}
+
+void QueryCoalescer::serve_patterns() {
+  while (true) {
+    auto batch = take_batch();
+    if (batch.empty()) {
+      const std::vector<std::uint8_t> payload;
+      communication_layer_.send_message(
+          pattern_matcher_.get_text_owner(),
+          Communication::BuildMessage(Communication::MessageType::PatternQueryBatch, &payload));
+      return;
+    }
+
+    // invalid queries fail on their own and are not sent to the text owner
+    std::vector<PendingQuery> queries;
+    std::vector<std::uint8_t> payload;
+    append_uint64(payload, policy_.max_batch_size);
+    for (auto& pending : batch) {
+      const auto type = pending.query.type;
+      const auto pipeline = pending.query.pipeline;
+      const auto pattern_size = pending.query.pattern_size;
+      try {
+        pattern_matcher_.add_query(std::move(pending.query));
+      } catch (...) {
+        pending.promise.set_exception(std::current_exception());
+        continue;
+      }
+      payload.push_back(static_cast<std::uint8_t>(type));
+      payload.push_back(pipeline ? static_cast<std::uint8_t>(*pipeline) : planner_pipeline);
+      append_uint64(payload, pattern_size);
+      queries.push_back(std::move(pending));
+    }
+    if (queries.empty()) {
+      continue;
+    }
+    communication_layer_.send_message(
+        pattern_matcher_.get_text_owner(),
+        Communication::BuildMessage(Communication::MessageType::PatternQueryBatch, &payload));
+
+    std::vector<bool> done(queries.size(), false);
+    try {
+      pattern_matcher_.run(
+          [&](std::size_t query_i, ENCRYPTO::BitVector<>&& matches) {
+            auto& query = queries.at(query_i);
+            const auto latency_ms =
+                std::chrono::duration<double, std::milli>(clock_type::now() - query.submitted)
+                    .count();
+            query.promise.set_value(std::move(matches));
+            done[query_i] = true;
+            std::scoped_lock lock(mutex_);
+            ++statistics_.num_queries;
+            statistics_.total_latency_ms += latency_ms;
+          },
+          policy_.max_batch_size);
+    } catch (...) {
+      for (std::size_t query_i = 0; query_i < queries.size(); ++query_i) {
+        if (!done[query_i]) {
+          queries[query_i].promise.set_exception(std::current_exception());
+        }
+      }
+      throw;
+    }
+    std::scoped_lock lock(mutex_);
+    ++statistics_.num_batches;
+  }
+}
+
+void QueryCoalescer::serve_text() {
+  while (auto raw_message = batch_handler_->get_queue().dequeue()) {
+    if (raw_message->empty()) {
+      return;
+    }
+    const auto message = Communication::GetMessage(raw_message->data());
+    const auto payload = message->payload();
+    if (payload == nullptr || payload->size() == 0) {
+      return;
+    }
+    if (payload->size() < sizeof(std::uint64_t) ||
+        (payload->size() - sizeof(std::uint64_t)) % encoded_query_size != 0) {
+      throw std::runtime_error(
+          fmt::format("QueryCoalescer: received batch of invalid size {}", payload->size()));
+    }
+    const auto max_batch_size = read_uint64(payload->data());
+    const auto num_queries = (payload->size() - sizeof(std::uint64_t)) / encoded_query_size;
+    for (std::size_t query_i = 0; query_i < num_queries; ++query_i) {
+      const auto* data =
+          payload->data() + sizeof(std::uint64_t) + query_i * encoded_query_size;
+      PatternQuery query;
+      query.type = static_cast<PatternMatchingType>(data[0]);
+      if (data[1] != planner_pipeline) {
+        query.pipeline = static_cast<PatternMatchingPipeline>(data[1]);
+      }
+      query.pattern_size = read_uint64(data + 2);
+      pattern_matcher_.add_query(std::move(query));
+    }
+    pattern_matcher_.run([](std::size_t, ENCRYPTO::BitVector<>&&) {}, max_batch_size);
+    std::scoped_lock lock(mutex_);
+    ++statistics_.num_batches;
+    statistics_.num_queries += num_queries;
+  }
+}
+
+}  // namespace MOTION
@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "pattern_matcher.h"
+#include "utility/bit_vector.h"
+
+namespace MOTION {
+
+namespace Communication {
+class CommunicationLayer;
+class QueueHandler;
+}  // namespace Communication
+
+// When the QueryCoalescer evaluates the pending queries.  A longer delay and larger batches
+// increase the throughput, since more queries share the fixed costs of a run (rounds, setup of
+// the gates, synchronization), at the cost of the latency of the queries which arrive first.
+struct QueryCoalescingPolicy {
+  // evaluate the pending queries once the oldest one has waited this long ...
+  std::chrono::microseconds max_delay = std::chrono::milliseconds(5);
+  // ... or once this many queries are pending
+  std::size_t max_queries = 64;
+  // number of queries of the same circuit shape combined into one SIMD circuit, see
+  // PatternMatcher::run()
+  std::size_t max_batch_size = 64;
+};
+
+struct QueryCoalescingStatistics {
+  std::size_t num_batches = 0;
+  std::size_t num_queries = 0;
+  // sum over all queries of the time from submit() until the match bits are available
+  double total_latency_ms = 0;
+
+  double get_average_batch_size() const noexcept {
+    return num_batches ? double(num_queries) / num_batches : 0;
+  }
+  double get_average_latency_ms() const noexcept {
+    return num_queries ? total_latency_ms / num_queries : 0;
+  }
+};
+
+// Front end of a PatternMatcher for a server which receives many small queries, e.g., from
+// concurrent clients.  Running each of them on its own would be dominated by the fixed costs of a
+// circuit, so the queries submitted within the delay of the policy are collected and evaluated
+// together by one PatternMatcher::run(), which packs queries of the same shape into the SIMD
+// values of one circuit.  The match bits are returned to each client by its future.
+//
+// Both parties construct the QueryCoalescer after the text has been shared, which synchronizes
+// them, and call serve(), e.g., in a dedicated thread.  The pattern owner decides on the batches
+// and sends the public parameters of the queries (type, pattern size, pipeline) to the text
+// owner, which builds the same circuits.  The PatternMatcher must not be used otherwise while
+// serve() is running.
+class QueryCoalescer {
+ public:
+  QueryCoalescer(Communication::CommunicationLayer&, PatternMatcher&,
+                 QueryCoalescingPolicy = {});
+  ~QueryCoalescer();
+
+  // Called by the pattern owner from any thread.  The future fails with the exception of
+  // PatternMatcher::add_query() if the query is invalid.
+  std::future<ENCRYPTO::BitVector<>> submit(PatternQuery query);
+
+  // Evaluate batches of queries until stop() is called.
+  void serve();
+  // Called by the pattern owner: evaluate the queries submitted so far, then serve() of both
+  // parties returns.  Called by the text owner, serve() returns without waiting for the pattern
+  // owner, e.g., on shutdown.
+  void stop();
+
+  QueryCoalescingStatistics get_statistics() const;
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  struct PendingQuery {
+    PatternQuery query;
+    std::promise<ENCRYPTO::BitVector<>> promise;
+    clock_type::time_point submitted;
+  };
+
+  void serve_patterns();
+  void serve_text();
+  // wait for the next batch according to the policy, an empty batch after stop()
+  std::deque<PendingQuery> take_batch();
+
+  Communication::CommunicationLayer& communication_layer_;
+  PatternMatcher& pattern_matcher_;
+  QueryCoalescingPolicy policy_;
+  bool is_pattern_owner_;
+  // receives the batches of the text owner
+  std::shared_ptr<Communication::QueueHandler> batch_handler_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<PendingQuery> pending_queries_;
+  bool stopped_ = false;
+  QueryCoalescingStatistics statistics_;
+};
+
+}  // namespace MOTION
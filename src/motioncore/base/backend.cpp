@@ -45,9 +45,11 @@
 #include "crypto/multiplication_triple/sp_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
 #include "data_storage/base_ot_data.h"
-#include "executor/gate_executor.h"
+#include "executor/new_gate_executor.h"
 #include "gate/bmr_gate.h"
 #include "gate/boolean_gmw_gate.h"
+#include "gate/legacy_gate_adapter.h"
+#include "gate_register.h"
 #include "register.h"
 #include "share/bmr_share.h"
 #include "share/boolean_gmw_share.h"
@@ -65,8 +67,9 @@ Backend::Backend(Communication::CommunicationLayer &communication_layer, Configu
       logger_(logger),
       config_(config),
       register_(std::make_shared<Register>(logger_)),
-      gate_executor_(std::make_unique<GateExecutor>(
-          *register_, [this] { RunPreprocessing(); }, logger_)) {
+      gate_register_(std::make_unique<GateRegister>()),
+      gate_executor_(std::make_unique<NewGateExecutor>(
+          *gate_register_, [this] { RunPreprocessing(); }, config_->GetNumOfThreads(), logger_)) {
   motion_base_provider_ =
       std::make_unique<Crypto::MotionBaseProvider>(communication_layer_, logger_);
   base_ot_provider_ =
@@ -162,12 +165,27 @@ void Backend::RunPreprocessing() {
   run_time_stats_.back().record_end<Statistics::RunTimeStats::StatID::preprocessing>();
 }
 
+void Backend::RegisterGatesWithExecutor() {
+  gate_register_->reset();
+  gate_executor_->reset();
+  for (const auto &gate : register_->GetGates()) {
+    gate_register_->register_gate(
+        std::make_unique<LegacyGateAdapter>(gate_register_->get_next_gate_id(), gate));
+  }
+}
+
 void Backend::EvaluateSequential() {
+  RegisterGatesWithExecutor();
   gate_executor_->evaluate_setup_online(run_time_stats_.back());
+  // XXX: since we never pop elements from the active queue, clear it manually for now
+  // otherwise there will be complains that it is not empty upon repeated execution
+  register_->ClearActiveQueue();
 }
 
 void Backend::EvaluateParallel() {
+  RegisterGatesWithExecutor();
   gate_executor_->evaluate(run_time_stats_.back());
+  register_->ClearActiveQueue();
 }
 
 const Gates::Interfaces::GatePtr &Backend::GetGate(std::size_t gate_id) const {
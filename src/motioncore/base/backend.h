@@ -60,7 +60,8 @@ using ConfigurationPtr = std::shared_ptr<Configuration>;
 class Register;
 using RegisterPtr = std::shared_ptr<Register>;
 
-class GateExecutor;
+class GateRegister;
+class NewGateExecutor;
 
 namespace Statistics {
 struct RunTimeStats;
@@ -307,13 +308,18 @@ class Backend : public std::enable_shared_from_this<Backend> {
   auto &GetMutableRunTimeStats() { return run_time_stats_; }
 
  private:
+  // register adapters of the gates of the circuit with gate_register_
+  void RegisterGatesWithExecutor();
+
   std::list<Statistics::RunTimeStats> run_time_stats_;
 
   Communication::CommunicationLayer &communication_layer_;
   std::shared_ptr<Logger> logger_;
   ConfigurationPtr config_;
   RegisterPtr register_;
-  std::unique_ptr<GateExecutor> gate_executor_;
+  // the gates of register_ are wrapped into LegacyGateAdapters in here before each evaluation
+  std::unique_ptr<GateRegister> gate_register_;
+  std::unique_ptr<NewGateExecutor> gate_executor_;
 
   std::unique_ptr<Crypto::MotionBaseProvider> motion_base_provider_;
   std::unique_ptr<BaseOTProvider> base_ot_provider_;
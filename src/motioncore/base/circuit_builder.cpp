@@ -22,12 +22,16 @@
 
 #include "circuit_builder.h"
 
+#include <algorithm>
+#include <map>
 #include <stdexcept>
+#include <utility>
 
 #include <fmt/format.h>
 
 #include "algorithm/algorithm_description.h"
 #include "algorithm/make_circuit.h"
+#include "algorithm/protocol_assignment.h"
 #include "gate_factory.h"
 #include "wire/new_wire.h"
 
@@ -48,17 +52,17 @@ WireVector CircuitBuilder::make_binary_gate(ENCRYPTO::PrimitiveOperationType op,
   if (wires_a.empty() || wires_b.empty()) {
     throw std::logic_error("empty WireVector");
   }
-  auto proto_a = wires_a[0]->get_protocol();
-  auto proto_b = wires_b[0]->get_protocol();
+  return get_binary_gate_factory(wires_a[0]->get_protocol(), wires_b[0]->get_protocol())
+      .make_binary_gate(op, wires_a, wires_b);
+}
+
+GateFactory& CircuitBuilder::get_binary_gate_factory(MPCProtocol proto_a, MPCProtocol proto_b) {
   if (proto_a == proto_b) {
-    auto& gate_factory = get_gate_factory(proto_a);
-    return gate_factory.make_binary_gate(op, wires_a, wires_b);
+    return get_gate_factory(proto_a);
   } else if (proto_a == MPCProtocol::ArithmeticPlain || proto_a == MPCProtocol::BooleanPlain) {
-    auto& gate_factory = get_gate_factory(proto_b);
-    return gate_factory.make_binary_gate(op, wires_a, wires_b);
+    return get_gate_factory(proto_b);
   } else if (proto_b == MPCProtocol::ArithmeticPlain || proto_b == MPCProtocol::BooleanPlain) {
-    auto& gate_factory = get_gate_factory(proto_a);
-    return gate_factory.make_binary_gate(op, wires_a, wires_b);
+    return get_gate_factory(proto_a);
   } else {
     throw std::logic_error("multi-protocol gates are not yet supported");
   }
@@ -107,10 +111,123 @@ std::optional<MPCProtocol> CircuitBuilder::convert_via(MPCProtocol, MPCProtocol)
   return std::nullopt;
 }
 
+// The gates are constructed layer by layer, where the gates of a layer with the same operation and
+// input protocols are constructed by one call of GateFactory::make_{unary,binary}_gates().
 WireVector CircuitBuilder::make_circuit(const ENCRYPTO::AlgorithmDescription& algo,
                                         const WireVector& wires_in_a,
                                         const WireVector& wires_in_b) {
-  return ::MOTION::make_circuit(*this, algo, wires_in_a, wires_in_b);
+  auto circuit_wires = detail::load_circuit_inputs(algo, wires_in_a, wires_in_b);
+
+  // the layer of each gate is one more than the maximal layer of its inputs, which are in layer 0
+  std::vector<std::size_t> wire_layers(algo.n_wires_, 0);
+  std::map<std::pair<std::size_t, ENCRYPTO::PrimitiveOperationType>, std::vector<std::size_t>>
+      groups;
+  for (std::size_t gate_i = 0; gate_i < algo.gates_.size(); ++gate_i) {
+    const auto& prim_op = algo.gates_[gate_i];
+    auto layer = wire_layers.at(prim_op.parent_a_);
+    if (prim_op.parent_b_.has_value()) {
+      layer = std::max(layer, wire_layers.at(*prim_op.parent_b_));
+    }
+    wire_layers.at(prim_op.output_wire_) = layer + 1;
+    groups[{layer, prim_op.type_}].push_back(gate_i);
+  }
+
+  for (const auto& [key, gate_indices] : groups) {
+    const auto op = key.second;
+    // the protocols of the inputs are only known after the previous layers have been constructed,
+    // e.g., if gates on constants have been folded
+    std::map<std::pair<MPCProtocol, MPCProtocol>, std::vector<std::size_t>> by_protocols;
+    for (const auto gate_i : gate_indices) {
+      const auto& prim_op = algo.gates_[gate_i];
+      const auto proto_a = circuit_wires.at(prim_op.parent_a_)->get_protocol();
+      const auto proto_b = prim_op.parent_b_.has_value()
+                               ? circuit_wires.at(*prim_op.parent_b_)->get_protocol()
+                               : proto_a;
+      by_protocols[{proto_a, proto_b}].push_back(gate_i);
+    }
+    for (const auto& [protocols, indices] : by_protocols) {
+      auto& factory = get_binary_gate_factory(protocols.first, protocols.second);
+      if (!is_wire_wise(op)) {
+        for (const auto gate_i : indices) {
+          const auto& prim_op = algo.gates_[gate_i];
+          const auto& wire_a = circuit_wires.at(prim_op.parent_a_);
+          auto output_wires =
+              prim_op.parent_b_.has_value()
+                  ? factory.make_binary_gate(op, {wire_a}, {circuit_wires.at(*prim_op.parent_b_)})
+                  : factory.make_unary_gate(op, {wire_a});
+          circuit_wires.at(prim_op.output_wire_) = std::move(output_wires.at(0));
+        }
+        continue;
+      }
+      std::vector<std::size_t> inputs_a, inputs_b;
+      for (const auto gate_i : indices) {
+        const auto& prim_op = algo.gates_[gate_i];
+        inputs_a.push_back(prim_op.parent_a_);
+        if (prim_op.parent_b_.has_value()) {
+          inputs_b.push_back(*prim_op.parent_b_);
+        }
+      }
+      const auto output_wires =
+          inputs_b.empty() ? factory.make_unary_gates(op, circuit_wires, inputs_a)
+                           : factory.make_binary_gates(op, circuit_wires, inputs_a, inputs_b);
+      for (std::size_t k = 0; k < indices.size(); ++k) {
+        circuit_wires.at(algo.gates_[indices[k]].output_wire_) = output_wires.at(k);
+      }
+    }
+  }
+  return WireVector(std::end(circuit_wires) - algo.n_output_wires_, std::end(circuit_wires));
+}
+
+std::vector<WireVector> CircuitBuilder::make_assigned_circuit(
+    const std::vector<ProtocolAssignmentNode>& nodes, const ProtocolAssignment& assignment,
+    const std::vector<WireVector>& inputs) {
+  if (assignment.protocols_.size() != nodes.size()) {
+    throw std::invalid_argument("protocol assignment does not match the nodes");
+  }
+  std::vector<WireVector> outputs(nodes.size());
+  // (node, protocol) -> converted output wires of the node
+  std::map<std::pair<std::size_t, MPCProtocol>, WireVector> converted;
+  const auto get_input = [this, &outputs, &converted](std::size_t node_id,
+                                                      MPCProtocol proto) -> const WireVector& {
+    const auto& wires = outputs.at(node_id);
+    if (wires.empty() || wires[0]->get_protocol() == proto) {
+      return wires;
+    }
+    auto it = converted.find({node_id, proto});
+    if (it == std::end(converted)) {
+      it = converted.emplace(std::make_pair(node_id, proto), convert(proto, wires)).first;
+    }
+    return it->second;
+  };
+
+  std::size_t next_input = 0;
+  for (std::size_t node_id = 0; node_id < nodes.size(); ++node_id) {
+    const auto& node = nodes[node_id];
+    const auto proto = assignment.protocols_[node_id];
+    std::vector<WireVector> in;
+    for (const auto input_id : node.inputs_) {
+      in.push_back(get_input(input_id, proto));
+    }
+    if (node.operation_ == ENCRYPTO::PrimitiveOperationType::IN) {
+      const auto& wires = inputs.at(next_input++);
+      outputs[node_id] = (wires.empty() || wires[0]->get_protocol() == proto)
+                             ? wires
+                             : convert(proto, wires);
+    } else if (node.operation_ == ENCRYPTO::PrimitiveOperationType::OUT) {
+      outputs[node_id] = in.at(0);
+    } else if (node.circuit_ != nullptr) {
+      outputs[node_id] = make_circuit(*node.circuit_, in.at(0), in.at(1));
+    } else if (in.size() == 1) {
+      outputs[node_id] = make_unary_gate(node.operation_, in[0]);
+    } else if (in.size() == 2) {
+      outputs[node_id] = make_binary_gate(node.operation_, in[0], in[1]);
+    } else {
+      throw std::invalid_argument(
+          fmt::format("node {} has {} inputs, only unary and binary operations are supported",
+                      node_id, in.size()));
+    }
+  }
+  return outputs;
 }
 
 }  // namespace MOTION
@@ -37,6 +37,8 @@ namespace MOTION {
 class GateFactory;
 enum class MPCProtocol : unsigned int;
 class NewWire;
+struct ProtocolAssignment;
+struct ProtocolAssignmentNode;
 using WireVector = std::vector<std::shared_ptr<NewWire>>;
 
 class CircuitBuilder {
@@ -47,8 +49,19 @@ class CircuitBuilder {
   WireVector make_circuit(const ENCRYPTO::AlgorithmDescription&, const WireVector&,
                           const WireVector&);
   WireVector convert(MPCProtocol, const WireVector&);
+  // Build the nodes of a mixed circuit in the protocols chosen by a ProtocolAssigner and convert
+  // the outputs of the nodes where needed, each at most once per protocol.  `inputs` are the wires
+  // of the IN nodes in their order.  Returns the output wires of every node.
+  std::vector<WireVector> make_assigned_circuit(const std::vector<ProtocolAssignmentNode>&,
+                                                const ProtocolAssignment&,
+                                                const std::vector<WireVector>& inputs);
   virtual std::optional<MPCProtocol> convert_via(MPCProtocol src, MPCProtocol dst);
   virtual GateFactory& get_gate_factory(MPCProtocol) = 0;
+
+ private:
+  // the factory of the gates on inputs of these protocols, where plain inputs are handled by the
+  // factory of the other input
+  GateFactory& get_binary_gate_factory(MPCProtocol proto_a, MPCProtocol proto_b);
 };
 
 }  // namespace MOTION
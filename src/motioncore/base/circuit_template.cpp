@@ -0,0 +1,679 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "circuit_template.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "base/gate_register.h"
+#include "base/two_party_backend.h"
+#include "circuit_builder.h"
+#include "utility/typedefs.h"
+#include "wire/new_wire.h"
+
+namespace MOTION {
+
+// Forwards the calls to the factory of the backend and records them.
+class CircuitTemplate::RecordingGateFactory : public GateFactory {
+ public:
+  RecordingGateFactory(Recorder& recorder, GateFactory& factory, MPCProtocol protocol)
+      : recorder_(recorder), factory_(factory), protocol_(protocol) {}
+
+  std::string get_provider_name() const noexcept override { return factory_.get_provider_name(); }
+
+  std::pair<ENCRYPTO::ReusableFiberPromise<BitValues>, WireVector> make_boolean_input_gate_my(
+      std::size_t input_owner, std::size_t num_wires, std::size_t num_simd) override;
+  WireVector make_boolean_input_gate_other(std::size_t input_owner, std::size_t num_wires,
+                                           std::size_t num_simd) override;
+
+  std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint8_t>>, WireVector>
+  make_arithmetic_8_input_gate_my(std::size_t input_owner, std::size_t num_simd) override {
+    return make_arithmetic_input_gate_my<std::uint8_t>(
+        input_owner, num_simd, factory_.make_arithmetic_8_input_gate_my(input_owner, num_simd));
+  }
+  std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint16_t>>, WireVector>
+  make_arithmetic_16_input_gate_my(std::size_t input_owner, std::size_t num_simd) override {
+    return make_arithmetic_input_gate_my<std::uint16_t>(
+        input_owner, num_simd, factory_.make_arithmetic_16_input_gate_my(input_owner, num_simd));
+  }
+  std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, WireVector>
+  make_arithmetic_32_input_gate_my(std::size_t input_owner, std::size_t num_simd) override {
+    return make_arithmetic_input_gate_my<std::uint32_t>(
+        input_owner, num_simd, factory_.make_arithmetic_32_input_gate_my(input_owner, num_simd));
+  }
+  std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, WireVector>
+  make_arithmetic_64_input_gate_my(std::size_t input_owner, std::size_t num_simd) override {
+    return make_arithmetic_input_gate_my<std::uint64_t>(
+        input_owner, num_simd, factory_.make_arithmetic_64_input_gate_my(input_owner, num_simd));
+  }
+
+  WireVector make_arithmetic_8_input_gate_other(std::size_t input_owner,
+                                                std::size_t num_simd) override {
+    return make_arithmetic_input_gate_other(
+        8, input_owner, num_simd,
+        factory_.make_arithmetic_8_input_gate_other(input_owner, num_simd));
+  }
+  WireVector make_arithmetic_16_input_gate_other(std::size_t input_owner,
+                                                 std::size_t num_simd) override {
+    return make_arithmetic_input_gate_other(
+        16, input_owner, num_simd,
+        factory_.make_arithmetic_16_input_gate_other(input_owner, num_simd));
+  }
+  WireVector make_arithmetic_32_input_gate_other(std::size_t input_owner,
+                                                 std::size_t num_simd) override {
+    return make_arithmetic_input_gate_other(
+        32, input_owner, num_simd,
+        factory_.make_arithmetic_32_input_gate_other(input_owner, num_simd));
+  }
+  WireVector make_arithmetic_64_input_gate_other(std::size_t input_owner,
+                                                 std::size_t num_simd) override {
+    return make_arithmetic_input_gate_other(
+        64, input_owner, num_simd,
+        factory_.make_arithmetic_64_input_gate_other(input_owner, num_simd));
+  }
+
+  ENCRYPTO::ReusableFiberFuture<BitValues> make_boolean_output_gate_my(
+      std::size_t output_owner, const WireVector& wires) override;
+  void make_boolean_output_gate_other(std::size_t output_owner, const WireVector& wires) override;
+
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint8_t>> make_arithmetic_8_output_gate_my(
+      std::size_t output_owner, const WireVector& wires) override {
+    auto future = factory_.make_arithmetic_8_output_gate_my(output_owner, wires);
+    record_output_gate(InstructionType::arithmetic_output_my, 8, output_owner, wires);
+    return future;
+  }
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint16_t>> make_arithmetic_16_output_gate_my(
+      std::size_t output_owner, const WireVector& wires) override {
+    auto future = factory_.make_arithmetic_16_output_gate_my(output_owner, wires);
+    record_output_gate(InstructionType::arithmetic_output_my, 16, output_owner, wires);
+    return future;
+  }
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint32_t>> make_arithmetic_32_output_gate_my(
+      std::size_t output_owner, const WireVector& wires) override {
+    auto future = factory_.make_arithmetic_32_output_gate_my(output_owner, wires);
+    record_output_gate(InstructionType::arithmetic_output_my, 32, output_owner, wires);
+    return future;
+  }
+  ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint64_t>> make_arithmetic_64_output_gate_my(
+      std::size_t output_owner, const WireVector& wires) override {
+    auto future = factory_.make_arithmetic_64_output_gate_my(output_owner, wires);
+    record_output_gate(InstructionType::arithmetic_output_my, 64, output_owner, wires);
+    return future;
+  }
+  void make_arithmetic_output_gate_other(std::size_t output_owner,
+                                         const WireVector& wires) override;
+
+  WireVector make_unary_gate(ENCRYPTO::PrimitiveOperationType op,
+                             const WireVector& wires) override;
+  WireVector make_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector& wires_a,
+                              const WireVector& wires_b) override;
+  WireVector make_unary_gates(ENCRYPTO::PrimitiveOperationType op, const WireVector& wires,
+                              std::span<const std::size_t> inputs) override;
+  WireVector make_binary_gates(ENCRYPTO::PrimitiveOperationType op, const WireVector& wires,
+                               std::span<const std::size_t> inputs_a,
+                               std::span<const std::size_t> inputs_b) override;
+
+  WireVector convert(MPCProtocol dst_protocol, const WireVector& wires) override;
+
+ private:
+  template <typename T>
+  std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, WireVector>
+  make_arithmetic_input_gate_my(
+      std::size_t input_owner, std::size_t num_simd,
+      std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, WireVector>&& result);
+  WireVector make_arithmetic_input_gate_other(std::size_t bit_size, std::size_t input_owner,
+                                              std::size_t num_simd, WireVector&& wires);
+  void record_output_gate(InstructionType, std::size_t bit_size, std::size_t output_owner,
+                          const WireVector& wires);
+  Instruction make_instruction(InstructionType type) const noexcept;
+
+  Recorder& recorder_;
+  GateFactory& factory_;
+  MPCProtocol protocol_;
+};
+
+// The CircuitBuilder passed to the build function of CircuitTemplate::record().
+class CircuitTemplate::Recorder : public CircuitBuilder {
+ public:
+  Recorder(CircuitTemplate& circuit_template, TwoPartyBackend& backend)
+      : circuit_template_(circuit_template), backend_(backend) {}
+
+  GateFactory& get_gate_factory(MPCProtocol proto) override {
+    auto it = factories_.find(proto);
+    if (it == std::end(factories_)) {
+      auto& factory = backend_.get_gate_factory(proto);
+      it = factories_
+               .emplace(proto, std::make_unique<RecordingGateFactory>(*this, factory, proto))
+               .first;
+    }
+    return *it->second;
+  }
+
+  std::optional<MPCProtocol> convert_via(MPCProtocol src, MPCProtocol dst) override {
+    return backend_.convert_via(src, dst);
+  }
+
+  // wire index of a wire, wires which are not known yet are reused by every instance
+  std::uint32_t get_wire_index(const std::shared_ptr<NewWire>& wire) {
+    const auto it = wire_indices_.find(wire.get());
+    if (it != std::end(wire_indices_)) {
+      return it->second;
+    }
+    const auto wire_idx = add_wire(wire);
+    circuit_template_.constants_.emplace_back(wire_idx, wire);
+    return wire_idx;
+  }
+
+  // give each wire a new wire index
+  std::uint32_t add_wires(const WireVector& wires) {
+    const auto first_wire_idx = circuit_template_.num_wires_;
+    for (const auto& wire : wires) {
+      add_wire(wire);
+    }
+    return first_wire_idx;
+  }
+
+  void add_instruction(Instruction instruction, const WireVector& wires_a,
+                       const WireVector& wires_b, const WireVector& output_wires) {
+    auto& operands = circuit_template_.operands_;
+    instruction.first_operand_ = operands.size();
+    instruction.num_operands_a_ = wires_a.size();
+    instruction.num_operands_b_ = wires_b.size();
+    for (const auto& wires : {std::cref(wires_a), std::cref(wires_b)}) {
+      for (const auto& wire : wires.get()) {
+        operands.push_back(get_wire_index(wire));
+      }
+    }
+    instruction.num_outputs_ = output_wires.size();
+    instruction.first_output_ = add_wires(output_wires);
+    auto& protocols = circuit_template_.protocols_;
+    if (std::find(std::begin(protocols), std::end(protocols), instruction.protocol_) ==
+        std::end(protocols)) {
+      protocols.push_back(instruction.protocol_);
+    }
+    circuit_template_.instructions_.push_back(instruction);
+  }
+
+  std::uint32_t add_indices(std::span<const std::size_t> indices) {
+    auto& template_indices = circuit_template_.indices_;
+    const auto first_index = template_indices.size();
+    template_indices.insert(std::end(template_indices), std::begin(indices), std::end(indices));
+    return first_index;
+  }
+
+ private:
+  std::uint32_t add_wire(const std::shared_ptr<NewWire>& wire) {
+    const auto wire_idx = circuit_template_.num_wires_++;
+    // an output may be an input again, e.g., of a conversion into the same protocol
+    wire_indices_[wire.get()] = wire_idx;
+    // keep the wire alive s.t. its address is not reused by another wire while recording
+    wires_.push_back(wire);
+    return wire_idx;
+  }
+
+  CircuitTemplate& circuit_template_;
+  TwoPartyBackend& backend_;
+  std::unordered_map<MPCProtocol, std::unique_ptr<RecordingGateFactory>> factories_;
+  std::unordered_map<const NewWire*, std::uint32_t> wire_indices_;
+  WireVector wires_;
+};
+
+CircuitTemplate::Instruction CircuitTemplate::RecordingGateFactory::make_instruction(
+    InstructionType type) const noexcept {
+  Instruction instruction{};
+  instruction.type_ = type;
+  instruction.protocol_ = protocol_;
+  return instruction;
+}
+
+std::pair<ENCRYPTO::ReusableFiberPromise<BitValues>, WireVector>
+CircuitTemplate::RecordingGateFactory::make_boolean_input_gate_my(std::size_t input_owner,
+                                                                  std::size_t num_wires,
+                                                                  std::size_t num_simd) {
+  auto result = factory_.make_boolean_input_gate_my(input_owner, num_wires, num_simd);
+  auto instruction = make_instruction(InstructionType::boolean_input_my);
+  instruction.party_id_ = input_owner;
+  instruction.num_wires_ = num_wires;
+  instruction.num_simd_ = num_simd;
+  recorder_.add_instruction(instruction, {}, {}, result.second);
+  return result;
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_boolean_input_gate_other(
+    std::size_t input_owner, std::size_t num_wires, std::size_t num_simd) {
+  auto wires = factory_.make_boolean_input_gate_other(input_owner, num_wires, num_simd);
+  auto instruction = make_instruction(InstructionType::boolean_input_other);
+  instruction.party_id_ = input_owner;
+  instruction.num_wires_ = num_wires;
+  instruction.num_simd_ = num_simd;
+  recorder_.add_instruction(instruction, {}, {}, wires);
+  return wires;
+}
+
+template <typename T>
+std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, WireVector>
+CircuitTemplate::RecordingGateFactory::make_arithmetic_input_gate_my(
+    std::size_t input_owner, std::size_t num_simd,
+    std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, WireVector>&& result) {
+  auto instruction = make_instruction(InstructionType::arithmetic_input_my);
+  instruction.bit_size_ = sizeof(T) * 8;
+  instruction.party_id_ = input_owner;
+  instruction.num_simd_ = num_simd;
+  recorder_.add_instruction(instruction, {}, {}, result.second);
+  return std::move(result);
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_arithmetic_input_gate_other(
+    std::size_t bit_size, std::size_t input_owner, std::size_t num_simd, WireVector&& wires) {
+  auto instruction = make_instruction(InstructionType::arithmetic_input_other);
+  instruction.bit_size_ = bit_size;
+  instruction.party_id_ = input_owner;
+  instruction.num_simd_ = num_simd;
+  recorder_.add_instruction(instruction, {}, {}, wires);
+  return std::move(wires);
+}
+
+void CircuitTemplate::RecordingGateFactory::record_output_gate(InstructionType type,
+                                                               std::size_t bit_size,
+                                                               std::size_t output_owner,
+                                                               const WireVector& wires) {
+  auto instruction = make_instruction(type);
+  instruction.bit_size_ = bit_size;
+  instruction.party_id_ = output_owner;
+  recorder_.add_instruction(instruction, wires, {}, {});
+}
+
+ENCRYPTO::ReusableFiberFuture<BitValues>
+CircuitTemplate::RecordingGateFactory::make_boolean_output_gate_my(std::size_t output_owner,
+                                                                   const WireVector& wires) {
+  auto future = factory_.make_boolean_output_gate_my(output_owner, wires);
+  record_output_gate(InstructionType::boolean_output_my, 1, output_owner, wires);
+  return future;
+}
+
+void CircuitTemplate::RecordingGateFactory::make_boolean_output_gate_other(
+    std::size_t output_owner, const WireVector& wires) {
+  factory_.make_boolean_output_gate_other(output_owner, wires);
+  record_output_gate(InstructionType::boolean_output_other, 1, output_owner, wires);
+}
+
+void CircuitTemplate::RecordingGateFactory::make_arithmetic_output_gate_other(
+    std::size_t output_owner, const WireVector& wires) {
+  factory_.make_arithmetic_output_gate_other(output_owner, wires);
+  record_output_gate(InstructionType::arithmetic_output_other, 0, output_owner, wires);
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_unary_gate(
+    ENCRYPTO::PrimitiveOperationType op, const WireVector& wires) {
+  auto output_wires = factory_.make_unary_gate(op, wires);
+  auto instruction = make_instruction(InstructionType::unary_gate);
+  instruction.op_ = op;
+  recorder_.add_instruction(instruction, wires, {}, output_wires);
+  return output_wires;
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_binary_gate(
+    ENCRYPTO::PrimitiveOperationType op, const WireVector& wires_a, const WireVector& wires_b) {
+  auto output_wires = factory_.make_binary_gate(op, wires_a, wires_b);
+  auto instruction = make_instruction(InstructionType::binary_gate);
+  instruction.op_ = op;
+  recorder_.add_instruction(instruction, wires_a, wires_b, output_wires);
+  return output_wires;
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_unary_gates(
+    ENCRYPTO::PrimitiveOperationType op, const WireVector& wires,
+    std::span<const std::size_t> inputs) {
+  auto output_wires = factory_.make_unary_gates(op, wires, inputs);
+  auto instruction = make_instruction(InstructionType::unary_gates);
+  instruction.op_ = op;
+  instruction.first_index_ = recorder_.add_indices(inputs);
+  recorder_.add_instruction(instruction, wires, {}, output_wires);
+  return output_wires;
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::make_binary_gates(
+    ENCRYPTO::PrimitiveOperationType op, const WireVector& wires,
+    std::span<const std::size_t> inputs_a, std::span<const std::size_t> inputs_b) {
+  auto output_wires = factory_.make_binary_gates(op, wires, inputs_a, inputs_b);
+  auto instruction = make_instruction(InstructionType::binary_gates);
+  instruction.op_ = op;
+  instruction.first_index_ = recorder_.add_indices(inputs_a);
+  recorder_.add_indices(inputs_b);
+  recorder_.add_instruction(instruction, wires, {}, output_wires);
+  return output_wires;
+}
+
+WireVector CircuitTemplate::RecordingGateFactory::convert(MPCProtocol dst_protocol,
+                                                          const WireVector& wires) {
+  // a factory which does not support the conversion throws before anything is recorded
+  auto output_wires = factory_.convert(dst_protocol, wires);
+  auto instruction = make_instruction(InstructionType::convert);
+  instruction.dst_protocol_ = dst_protocol;
+  recorder_.add_instruction(instruction, wires, {}, output_wires);
+  return output_wires;
+}
+
+CircuitTemplate::CircuitTemplate() = default;
+CircuitTemplate::~CircuitTemplate() = default;
+CircuitTemplate::CircuitTemplate(CircuitTemplate&&) noexcept = default;
+CircuitTemplate& CircuitTemplate::operator=(CircuitTemplate&&) noexcept = default;
+
+CircuitTemplate::Instance CircuitTemplate::record(TwoPartyBackend& backend,
+                                                  const std::vector<WireVector>& inputs,
+                                                  const build_function& build) {
+  if (recorded_) {
+    throw std::logic_error("CircuitTemplate: the circuit has already been recorded");
+  }
+  if (backend.get_gate_register().get_num_gates() > 0) {
+    throw std::logic_error("CircuitTemplate: a circuit can only be recorded on an empty backend");
+  }
+  Recorder recorder(*this, backend);
+  for (const auto& input : inputs) {
+    input_shape_.push_back(input.size());
+    recorder.add_wires(input);
+  }
+  // count the ids taken by the gates, which are the sizes of the blocks of an instance built by
+  // instantiate_concurrently()
+  ConstructionScope tally(ConstructionScope::Mode::tally);
+  Instance instance;
+  {
+    ConstructionScope::Guard guard(tally);
+    instance.outputs_ = build(recorder, inputs);
+  }
+  construction_counts_ = tally.get_counts();
+  serial_reason_ = tally.get_serial_reason();
+  for (const auto& instruction : instructions_) {
+    // the garbled circuits keep per circuit state in the providers
+    const auto protocols = {instruction.protocol_, instruction.type_ == InstructionType::convert
+                                                       ? instruction.dst_protocol_
+                                                       : instruction.protocol_};
+    for (const auto protocol : protocols) {
+      if (serial_reason_.empty() &&
+          (protocol == MPCProtocol::Yao || protocol == MPCProtocol::BMR)) {
+        serial_reason_ = fmt::format("gates of {}", ToString(protocol));
+      }
+    }
+  }
+  for (const auto& wire : instance.outputs_) {
+    outputs_.push_back(recorder.get_wire_index(wire));
+  }
+  const auto& gate_register = backend.get_gate_register();
+  num_gates_ = gate_register.get_gates().size();
+  num_gate_ids_ = gate_register.get_num_gates();
+  preprocessing_plan_ = backend.get_preprocessing_plan();
+  instructions_.shrink_to_fit();
+  operands_.shrink_to_fit();
+  indices_.shrink_to_fit();
+  recorded_ = true;
+  return instance;
+}
+
+CircuitTemplate::Instance CircuitTemplate::instantiate(
+    TwoPartyBackend& backend, const std::vector<WireVector>& inputs) const {
+  if (!recorded_) {
+    throw std::logic_error("CircuitTemplate: no circuit has been recorded");
+  }
+  if (backend.get_gate_register().get_num_gates() > 0) {
+    throw std::logic_error(
+        "CircuitTemplate: a circuit can only be instantiated on an empty backend");
+  }
+  check_inputs(inputs);
+  backend.reserve_circuit(num_gates_, num_gate_ids_, protocols_);
+  return build_instance(backend, inputs);
+}
+
+std::vector<CircuitTemplate::Instance> CircuitTemplate::instantiate_concurrently(
+    TwoPartyBackend& backend, const std::vector<std::vector<WireVector>>& inputs,
+    std::size_t num_threads) const {
+  if (!recorded_) {
+    throw std::logic_error("CircuitTemplate: no circuit has been recorded");
+  }
+  if (backend.get_gate_register().get_num_gates() > 0) {
+    throw std::logic_error(
+        "CircuitTemplate: a circuit can only be instantiated on an empty backend");
+  }
+  if (!serial_reason_.empty()) {
+    throw std::invalid_argument(fmt::format(
+        "CircuitTemplate: the circuit cannot be built concurrently, since it contains {}",
+        serial_reason_));
+  }
+  if (num_threads == 0) {
+    throw std::invalid_argument("CircuitTemplate: at least one thread is required");
+  }
+  for (const auto& instance_inputs : inputs) {
+    check_inputs(instance_inputs);
+  }
+  const auto num_instances = inputs.size();
+  backend.reserve_circuit(num_instances * num_gates_, num_instances * num_gate_ids_, protocols_);
+  // the blocks are taken in the order of the instances, so both parties assign the same ids to
+  // the same gates, regardless of the order in which the threads build them
+  std::vector<ConstructionScope> scopes;
+  scopes.reserve(num_instances);
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    scopes.push_back(backend.reserve_construction_blocks(construction_counts_));
+  }
+
+  std::vector<Instance> instances(num_instances);
+  std::vector<std::exception_ptr> errors(num_instances);
+  std::atomic<std::size_t> next_instance = 0;
+  const auto build_instances = [&] {
+    for (auto i = next_instance++; i < num_instances; i = next_instance++) {
+      try {
+        ConstructionScope::Guard guard(scopes[i]);
+        instances[i] = build_instance(backend, inputs[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < std::min(num_threads, num_instances); ++t) {
+    threads.emplace_back(build_instances);
+  }
+  build_instances();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    if (errors[i]) {
+      std::rethrow_exception(errors[i]);
+    }
+    scopes[i].check_exhausted();
+  }
+  return instances;
+}
+
+void CircuitTemplate::check_inputs(const std::vector<WireVector>& inputs) const {
+  if (inputs.size() != input_shape_.size()) {
+    throw std::invalid_argument(fmt::format("CircuitTemplate: expected {} inputs, got {}",
+                                            input_shape_.size(), inputs.size()));
+  }
+  for (std::size_t input_i = 0; input_i < inputs.size(); ++input_i) {
+    if (inputs[input_i].size() != input_shape_[input_i]) {
+      throw std::invalid_argument(
+          fmt::format("CircuitTemplate: expected {} wires in input {}, got {}",
+                      input_shape_[input_i], input_i, inputs[input_i].size()));
+    }
+  }
+}
+
+CircuitTemplate::Instance CircuitTemplate::build_instance(
+    TwoPartyBackend& backend, const std::vector<WireVector>& inputs) const {
+  WireVector wires(num_wires_);
+  auto wire_it = std::begin(wires);
+  for (const auto& input : inputs) {
+    wire_it = std::copy(std::begin(input), std::end(input), wire_it);
+  }
+  for (const auto& [wire_idx, wire] : constants_) {
+    wires[wire_idx] = wire;
+  }
+
+  Instance instance;
+  WireVector wires_a;
+  WireVector wires_b;
+  for (const auto& instruction : instructions_) {
+    wires_a.clear();
+    wires_b.clear();
+    auto operand_it = std::begin(operands_) + instruction.first_operand_;
+    for (std::size_t i = 0; i < instruction.num_operands_a_; ++i) {
+      wires_a.push_back(wires[*operand_it++]);
+    }
+    for (std::size_t i = 0; i < instruction.num_operands_b_; ++i) {
+      wires_b.push_back(wires[*operand_it++]);
+    }
+    const std::span<const std::size_t> indices_a(indices_.data() + instruction.first_index_,
+                                                 instruction.num_outputs_);
+    const std::span<const std::size_t> indices_b(
+        indices_.data() + instruction.first_index_ + instruction.num_outputs_,
+        instruction.num_outputs_);
+
+    auto& factory = backend.get_gate_factory(instruction.protocol_);
+    WireVector output_wires;
+    switch (instruction.type_) {
+      case InstructionType::unary_gate:
+        output_wires = factory.make_unary_gate(instruction.op_, wires_a);
+        break;
+      case InstructionType::binary_gate:
+        output_wires = factory.make_binary_gate(instruction.op_, wires_a, wires_b);
+        break;
+      case InstructionType::unary_gates:
+        output_wires = factory.make_unary_gates(instruction.op_, wires_a, indices_a);
+        break;
+      case InstructionType::binary_gates:
+        output_wires = factory.make_binary_gates(instruction.op_, wires_a, indices_a, indices_b);
+        break;
+      case InstructionType::convert:
+        output_wires = factory.convert(instruction.dst_protocol_, wires_a);
+        break;
+      case InstructionType::boolean_input_my: {
+        auto [promise, input_wires] = factory.make_boolean_input_gate_my(
+            instruction.party_id_, instruction.num_wires_, instruction.num_simd_);
+        instance.input_promises_.emplace_back(std::move(promise));
+        output_wires = std::move(input_wires);
+        break;
+      }
+      case InstructionType::boolean_input_other:
+        output_wires = factory.make_boolean_input_gate_other(
+            instruction.party_id_, instruction.num_wires_, instruction.num_simd_);
+        break;
+      case InstructionType::arithmetic_input_my: {
+        const auto add_input = [&instance, &output_wires](auto&& result) {
+          instance.input_promises_.emplace_back(std::move(result.first));
+          output_wires = std::move(result.second);
+        };
+        switch (instruction.bit_size_) {
+          case 8:
+            add_input(factory.make_arithmetic_8_input_gate_my(instruction.party_id_,
+                                                              instruction.num_simd_));
+            break;
+          case 16:
+            add_input(factory.make_arithmetic_16_input_gate_my(instruction.party_id_,
+                                                               instruction.num_simd_));
+            break;
+          case 32:
+            add_input(factory.make_arithmetic_32_input_gate_my(instruction.party_id_,
+                                                               instruction.num_simd_));
+            break;
+          case 64:
+            add_input(factory.make_arithmetic_64_input_gate_my(instruction.party_id_,
+                                                               instruction.num_simd_));
+            break;
+        }
+        break;
+      }
+      case InstructionType::arithmetic_input_other:
+        switch (instruction.bit_size_) {
+          case 8:
+            output_wires = factory.make_arithmetic_8_input_gate_other(instruction.party_id_,
+                                                                      instruction.num_simd_);
+            break;
+          case 16:
+            output_wires = factory.make_arithmetic_16_input_gate_other(instruction.party_id_,
+                                                                       instruction.num_simd_);
+            break;
+          case 32:
+            output_wires = factory.make_arithmetic_32_input_gate_other(instruction.party_id_,
+                                                                       instruction.num_simd_);
+            break;
+          case 64:
+            output_wires = factory.make_arithmetic_64_input_gate_other(instruction.party_id_,
+                                                                       instruction.num_simd_);
+            break;
+        }
+        break;
+      case InstructionType::boolean_output_my:
+        instance.output_futures_.emplace_back(
+            factory.make_boolean_output_gate_my(instruction.party_id_, wires_a));
+        break;
+      case InstructionType::boolean_output_other:
+        factory.make_boolean_output_gate_other(instruction.party_id_, wires_a);
+        break;
+      case InstructionType::arithmetic_output_my:
+        switch (instruction.bit_size_) {
+          case 8:
+            instance.output_futures_.emplace_back(
+                factory.make_arithmetic_8_output_gate_my(instruction.party_id_, wires_a));
+            break;
+          case 16:
+            instance.output_futures_.emplace_back(
+                factory.make_arithmetic_16_output_gate_my(instruction.party_id_, wires_a));
+            break;
+          case 32:
+            instance.output_futures_.emplace_back(
+                factory.make_arithmetic_32_output_gate_my(instruction.party_id_, wires_a));
+            break;
+          case 64:
+            instance.output_futures_.emplace_back(
+                factory.make_arithmetic_64_output_gate_my(instruction.party_id_, wires_a));
+            break;
+        }
+        break;
+      case InstructionType::arithmetic_output_other:
+        factory.make_arithmetic_output_gate_other(instruction.party_id_, wires_a);
+        break;
+    }
+
+    if (output_wires.size() != instruction.num_outputs_) {
+      throw std::runtime_error(
+          fmt::format("CircuitTemplate: {} returned {} wires instead of {}",
+                      factory.get_provider_name(), output_wires.size(), instruction.num_outputs_));
+    }
+    std::move(std::begin(output_wires), std::end(output_wires),
+              std::begin(wires) + instruction.first_output_);
+  }
+
+  instance.outputs_.reserve(outputs_.size());
+  for (const auto wire_idx : outputs_) {
+    instance.outputs_.push_back(wires[wire_idx]);
+  }
+  return instance;
+}
+
+}  // namespace MOTION
@@ -0,0 +1,183 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "data_storage/preprocessing_plan.h"
+#include "gate_factory.h"
+#include "utility/construction_scope.h"
+
+namespace MOTION {
+
+class CircuitBuilder;
+class TwoPartyBackend;
+
+// Topology of a circuit captured while it is built for the first time, which builds the same
+// circuit on new input wires again without running the code that constructed it, e.g., a loop
+// over a Bristol description or an ONNX model, in every repetition.
+//
+// record() builds the circuit with a CircuitBuilder which forwards the GateFactory calls to the
+// backend and appends each of them to a flat list of instructions on wire indices.  Wires which are
+// neither inputs nor outputs of a recorded gate, e.g., constants, are kept and reused by every
+// instance, so they must not hold state of a run.  Only the GateFactory interface is recorded:
+// gates built with provider specific methods, e.g., after a dynamic_cast to the BEAVYProvider,
+// are not supported.  Besides the topology, the template keeps the number of gates and gate ids
+// and the correlated randomness of the circuit, s.t. instantiate() allocates the gate list and the
+// message slots of the providers in one go before it builds the gates, and
+// get_preprocessing_plan() can be passed to TwoPartyBackend::prepare_preprocessing().  Both
+// parties need to record and instantiate the same template.
+class CircuitTemplate {
+ public:
+  using InputPromise =
+      std::variant<ENCRYPTO::ReusableFiberPromise<BitValues>,
+                   ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint8_t>>,
+                   ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint16_t>>,
+                   ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>,
+                   ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>>;
+  using OutputFuture =
+      std::variant<ENCRYPTO::ReusableFiberFuture<BitValues>,
+                   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint8_t>>,
+                   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint16_t>>,
+                   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint32_t>>,
+                   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint64_t>>>;
+
+  // a circuit built from the template
+  struct Instance {
+    // the wires returned by the build function
+    WireVector outputs_;
+    // the promises of the input gates of this party and the futures of its output gates in the
+    // order in which the gates were built, only filled by instantiate()
+    std::vector<InputPromise> input_promises_;
+    std::vector<OutputFuture> output_futures_;
+  };
+
+  // builds the circuit on the input wires and returns its output wires
+  using build_function =
+      std::function<WireVector(CircuitBuilder&, const std::vector<WireVector>& inputs)>;
+
+  CircuitTemplate();
+  ~CircuitTemplate();
+  CircuitTemplate(CircuitTemplate&&) noexcept;
+  CircuitTemplate& operator=(CircuitTemplate&&) noexcept;
+
+  // Build the circuit with `build` on the backend, where no circuit may be built yet, and capture
+  // it.  The promises and futures of the input and output gates are returned by the factories to
+  // `build` as usual.
+  Instance record(TwoPartyBackend&, const std::vector<WireVector>& inputs,
+                  const build_function& build);
+  // Build the captured circuit on new input wires of the same shapes on a backend where no
+  // circuit is built yet, e.g., after TwoPartyBackend::reset() or on a new backend.
+  Instance instantiate(TwoPartyBackend&, const std::vector<WireVector>& inputs) const;
+  // Build one instance of the captured circuit per element of `inputs` on up to num_threads
+  // threads at once on a backend where no circuit is built yet.  Each instance takes its gate ids,
+  // input ids and correlated randomness from blocks of the sizes counted by record(), which are
+  // reserved in the order of the instances, see ConstructionScope.  Circuits with steps that
+  // depend on the order of the whole circuit, e.g., OT registrations (use batched OT
+  // preprocessing for BEAVY) or Yao gates, cannot be built this way.
+  std::vector<Instance> instantiate_concurrently(TwoPartyBackend&,
+                                                 const std::vector<std::vector<WireVector>>& inputs,
+                                                 std::size_t num_threads) const;
+
+  bool is_recorded() const noexcept { return recorded_; }
+  std::size_t get_num_instructions() const noexcept { return instructions_.size(); }
+  std::size_t get_num_gates() const noexcept { return num_gates_; }
+  std::size_t get_num_gate_ids() const noexcept { return num_gate_ids_; }
+  const PreprocessingPlan& get_preprocessing_plan() const noexcept { return preprocessing_plan_; }
+  // whether instantiate_concurrently() can build the circuit, otherwise the reason why not
+  bool can_instantiate_concurrently() const noexcept { return serial_reason_.empty(); }
+  const std::string& get_serial_reason() const noexcept { return serial_reason_; }
+
+ private:
+  enum class InstructionType : std::uint8_t {
+    unary_gate,
+    binary_gate,
+    unary_gates,
+    binary_gates,
+    convert,
+    boolean_input_my,
+    boolean_input_other,
+    arithmetic_input_my,
+    arithmetic_input_other,
+    boolean_output_my,
+    boolean_output_other,
+    arithmetic_output_my,
+    arithmetic_output_other
+  };
+
+  // One call of a GateFactory.  The operands are wire indices in operands_ starting at
+  // first_operand_, first the num_operands_a_ wires of the first operand, then the ones of the
+  // second.  The bulk constructions keep their index arrays in indices_ starting at
+  // first_index_.  The outputs have the wire indices [first_output_, first_output_ +
+  // num_outputs_).
+  struct Instruction {
+    InstructionType type_;
+    ENCRYPTO::PrimitiveOperationType op_;
+    // protocol of the factory and the destination protocol of a conversion
+    MPCProtocol protocol_;
+    MPCProtocol dst_protocol_;
+    std::uint8_t bit_size_;
+    std::size_t party_id_;
+    std::uint32_t num_wires_;
+    std::uint32_t num_simd_;
+    std::uint32_t first_operand_;
+    std::uint32_t num_operands_a_;
+    std::uint32_t num_operands_b_;
+    std::uint32_t first_index_;
+    std::uint32_t first_output_;
+    std::uint32_t num_outputs_;
+  };
+
+  class Recorder;
+  class RecordingGateFactory;
+
+  void check_inputs(const std::vector<WireVector>& inputs) const;
+  Instance build_instance(TwoPartyBackend&, const std::vector<WireVector>& inputs) const;
+
+  bool recorded_ = false;
+  // sizes of the input wire vectors, their wires have the first wire indices
+  std::vector<std::uint32_t> input_shape_;
+  std::uint32_t num_wires_ = 0;
+  std::vector<Instruction> instructions_;
+  std::vector<std::uint32_t> operands_;
+  std::vector<std::size_t> indices_;
+  // (wire index, wire) of the wires which are reused by every instance
+  std::vector<std::pair<std::uint32_t, std::shared_ptr<NewWire>>> constants_;
+  std::vector<std::uint32_t> outputs_;
+  // protocols of the factories used by the circuit
+  std::vector<MPCProtocol> protocols_;
+  std::size_t num_gates_ = 0;
+  std::size_t num_gate_ids_ = 0;
+  PreprocessingPlan preprocessing_plan_;
+  // ids taken by the gates of the circuit and the first step which prevents building it
+  // concurrently
+  ConstructionScope::Counts construction_counts_{};
+  std::string serial_reason_;
+};
+
+}  // namespace MOTION
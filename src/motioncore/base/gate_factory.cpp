@@ -26,8 +26,27 @@
 
 #include <fmt/format.h>
 
+#include "utility/typedefs.h"
+
 namespace MOTION {
 
+bool is_wire_wise(ENCRYPTO::PrimitiveOperationType op) {
+  using ENCRYPTO::PrimitiveOperationType;
+  switch (op) {
+    case PrimitiveOperationType::XOR:
+    case PrimitiveOperationType::AND:
+    case PrimitiveOperationType::INV:
+    case PrimitiveOperationType::OR:
+    case PrimitiveOperationType::NEG:
+    case PrimitiveOperationType::ADD:
+    case PrimitiveOperationType::MUL:
+    case PrimitiveOperationType::SQR:
+      return true;
+    default:
+      return false;
+  }
+}
+
 GateFactory::~GateFactory() = default;
 
 // Boolean inputs
@@ -116,4 +135,52 @@ void GateFactory::make_arithmetic_output_gate_other(std::size_t, const WireVecto
       fmt::format("{} does not support arithmetic outputs", get_provider_name()));
 }
 
+// bulk construction of function gates
+
+namespace {
+
+WireVector select_wires(const WireVector& wires, std::span<const std::size_t> indices) {
+  WireVector selected;
+  selected.reserve(indices.size());
+  for (const auto index : indices) {
+    selected.push_back(wires.at(index));
+  }
+  return selected;
+}
+
+}  // namespace
+
+WireVector GateFactory::make_unary_gates(ENCRYPTO::PrimitiveOperationType op,
+                                         const WireVector& wires,
+                                         std::span<const std::size_t> inputs) {
+  if (!is_wire_wise(op)) {
+    throw std::invalid_argument(
+        fmt::format("{}: {} gates cannot be constructed in bulk", get_provider_name(),
+                    ENCRYPTO::ToString(op)));
+  }
+  return make_unary_gate(op, select_wires(wires, inputs));
+}
+
+WireVector GateFactory::make_binary_gates(ENCRYPTO::PrimitiveOperationType op,
+                                          const WireVector& wires,
+                                          std::span<const std::size_t> inputs_a,
+                                          std::span<const std::size_t> inputs_b) {
+  if (!is_wire_wise(op)) {
+    throw std::invalid_argument(
+        fmt::format("{}: {} gates cannot be constructed in bulk", get_provider_name(),
+                    ENCRYPTO::ToString(op)));
+  }
+  if (inputs_a.size() != inputs_b.size()) {
+    throw std::invalid_argument(fmt::format("{}: {} gates with {} and {} inputs",
+                                            get_provider_name(), ENCRYPTO::ToString(op),
+                                            inputs_a.size(), inputs_b.size()));
+  }
+  return make_binary_gate(op, select_wires(wires, inputs_a), select_wires(wires, inputs_b));
+}
+
+WireVector GateFactory::make_broadcast_mul_gate(const WireVector&, const WireVector&) {
+  throw std::logic_error(
+      fmt::format("{} does not support broadcast multiplications", get_provider_name()));
+}
+
 }  // namespace MOTION
@@ -24,6 +24,7 @@
 
 #include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "utility/bit_vector.h"
@@ -36,12 +37,17 @@ enum class PrimitiveOperationType : std::uint8_t;
 namespace MOTION {
 
 class NewWire;
+enum class MPCProtocol : unsigned int;
 constexpr std::size_t ALL_PARTIES = std::numeric_limits<std::size_t>::max();
 using WireVector = std::vector<std::shared_ptr<NewWire>>;
 using BitValues = std::vector<ENCRYPTO::BitVector<>>;
 template <typename T>
 using IntegerValues = std::vector<T>;
 
+// Whether output wire k of a gate only depends on input wire k (of each operand), s.t. gates of
+// the operation on single wires can be combined into one gate on many wires.
+bool is_wire_wise(ENCRYPTO::PrimitiveOperationType);
+
 class GateFactory {
  public:
   virtual ~GateFactory() = 0;
@@ -100,6 +106,26 @@ class GateFactory {
   virtual WireVector make_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector&,
                                       const WireVector&) = 0;
 
+  // Bulk construction of independent gates of one wire-wise operation (see is_wire_wise), e.g.,
+  // of a layer of a circuit loaded from a Bristol file: gate k gets the input wire
+  // wires[inputs[k]] (or wires[inputs_a[k]] and wires[inputs_b[k]]).  Returns the output wire of
+  // each gate.  The gates are constructed as one gate on all of their wires, i.e., with a single
+  // gate object, registration and message per round instead of one per wire.  The input wires of
+  // an operand need to have the same protocol.
+  virtual WireVector make_unary_gates(ENCRYPTO::PrimitiveOperationType op, const WireVector& wires,
+                                      std::span<const std::size_t> inputs);
+  virtual WireVector make_binary_gates(ENCRYPTO::PrimitiveOperationType op,
+                                       const WireVector& wires,
+                                       std::span<const std::size_t> inputs_a,
+                                       std::span<const std::size_t> inputs_b);
+
+  // Multiplication of SIMD value i of in_a with each of the SIMD values [i * m, (i + 1) * m) of
+  // in_b, where in_b has m times as many SIMD values, e.g., of one secret weight or pattern
+  // character with many values.  Providers with triple-based multiplications use triples which
+  // share their multiplicand (see SharedIntegerMTVector), i.e., need a m-th of the OTs of a MUL
+  // gate on m copies of in_a.  Throws if the provider does not support it.
+  virtual WireVector make_broadcast_mul_gate(const WireVector& in_a, const WireVector& in_b);
+
   // conversions
   virtual WireVector convert(MPCProtocol dst_protocol, const WireVector&) = 0;
 };
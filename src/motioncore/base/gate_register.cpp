@@ -28,21 +28,51 @@ namespace MOTION {
 
 GateRegister::GateRegister()
     : next_gate_id_(0),
+      first_gate_id_(0),
       num_gates_with_setup_(0),
       num_gates_with_online_(0),
       num_evaluated_setup_(0),
-      num_evaluated_online_(0) {}
+      num_evaluated_online_(0),
+      wire_arena_(std::make_shared<ENCRYPTO::Arena>(wire_arena_chunk_size)) {}
 
 GateRegister::~GateRegister() = default;
 
 void GateRegister::register_gate(std::unique_ptr<NewGate>&& gate) {
   if (gate->need_setup()) {
-    ++num_gates_with_setup_;
+    num_gates_with_setup_.fetch_add(1, std::memory_order_relaxed);
   }
   if (gate->need_online()) {
-    ++num_gates_with_online_;
+    num_gates_with_online_.fetch_add(1, std::memory_order_relaxed);
   }
-  gates_.emplace_back(std::move(gate));
+  if (auto slot = ConstructionScope::take(ConstructionCounter::gate_slots, 1)) {
+    gates_[*slot] = std::move(gate);
+  } else {
+    gates_.emplace_back(std::move(gate));
+  }
+}
+
+void GateRegister::reserve(std::size_t num_gates) {
+  gates_.reserve(gates_.size() + num_gates);
+}
+
+std::size_t GateRegister::reserve_gate_slots(std::size_t num_gates) {
+  const auto first_slot = gates_.size();
+  gates_.resize(first_slot + num_gates);
+  return first_slot;
+}
+
+void GateRegister::reset() {
+  gates_.clear();
+  arena_.release();
+  // wires of the old circuit may still be referenced, e.g., by the caller or the providers
+  wire_arena_ = std::make_shared<ENCRYPTO::Arena>(wire_arena_chunk_size);
+  first_gate_id_ = next_gate_id_;
+  num_gates_with_setup_ = 0;
+  num_gates_with_online_ = 0;
+  num_evaluated_setup_ = 0;
+  num_evaluated_online_ = 0;
+  reset_setup_ready();
+  reset_online_ready();
 }
 
 void GateRegister::increment_gate_setup_counter() noexcept {
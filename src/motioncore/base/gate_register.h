@@ -25,8 +25,11 @@
 #include <atomic>
 #include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "utility/arena.h"
+#include "utility/construction_scope.h"
 #include "utility/enable_wait.h"
 
 namespace MOTION {
@@ -37,23 +40,61 @@ class GateRegister : public ENCRYPTO::enable_wait_setup, public ENCRYPTO::enable
  public:
   GateRegister();
   ~GateRegister();
-  std::size_t get_next_gate_id() noexcept { return next_gate_id_++; }
+  // within a ConstructionScope, the ids are taken from the block of the calling thread
+  std::size_t get_next_gate_id() { return get_next_gate_ids(1); }
+  // reserve num_ids consecutive ids for a gate which sends its messages under several ids
+  std::size_t get_next_gate_ids(std::size_t num_ids) {
+    if (auto gate_id = ConstructionScope::take(ConstructionCounter::gate_ids, num_ids)) {
+      return *gate_id;
+    }
+    auto gate_id = next_gate_id_;
+    next_gate_id_ += num_ids;
+    return gate_id;
+  }
+  // id of the next gate without taking it
+  std::size_t peek_next_gate_id() const noexcept { return next_gate_id_; }
+  // within a ConstructionScope, the gate is stored in a slot of the block of the calling thread
+  // without taking a lock
   void register_gate(std::unique_ptr<NewGate>&& gate);
+  // make room for num_gates more gates, e.g., of a circuit whose size is known before it is built
+  void reserve(std::size_t num_gates);
+  // append num_gates empty slots for the gates of a ConstructionScope and return the first one
+  std::size_t reserve_gate_slots(std::size_t num_gates);
   void increment_gate_setup_counter() noexcept;
   void increment_gate_online_counter() noexcept;
+  // Remove all gates to register the next circuit and free the memory they took from the arena.
+  // Gate ids are not reused, since they are used as nonces for the shared randomness and to
+  // identify the gate messages.
+  void reset();
 
-  std::size_t get_num_gates() const noexcept { return next_gate_id_; }
+  std::size_t get_num_gates() const noexcept { return next_gate_id_ - first_gate_id_; }
   std::size_t get_num_gates_with_setup() const noexcept { return num_gates_with_setup_; }
   std::size_t get_num_gates_with_online() const noexcept { return num_gates_with_online_; }
   std::vector<std::unique_ptr<NewGate>>& get_gates() noexcept { return gates_; }
   const std::vector<std::unique_ptr<NewGate>>& get_gates() const noexcept { return gates_; }
+  // memory for the buffers the gates keep until the end of the run, released by reset()
+  ENCRYPTO::Arena& get_arena() noexcept { return arena_; }
+  // create a wire of the circuit, the wire and its reference count are placed in an arena
+  // instead of a heap allocation of their own, a new arena is started by reset() and the old one
+  // is freed when the last wire of the old circuit has been destroyed
+  template <typename WireType, typename... Args>
+  std::shared_ptr<WireType> make_wire(Args&&... args) {
+    return std::allocate_shared<WireType>(ENCRYPTO::SharedArenaAllocator<WireType>(wire_arena_),
+                                          std::forward<Args>(args)...);
+  }
 
  private:
   std::size_t next_gate_id_;
-  std::size_t num_gates_with_setup_;
-  std::size_t num_gates_with_online_;
+  std::size_t first_gate_id_;
+  // atomic, s.t. gates can be registered concurrently within ConstructionScopes
+  std::atomic<std::size_t> num_gates_with_setup_;
+  std::atomic<std::size_t> num_gates_with_online_;
   std::atomic<std::size_t> num_evaluated_setup_;
   std::atomic<std::size_t> num_evaluated_online_;
+  // declared before gates_, such that it outlives the gates' buffers
+  ENCRYPTO::Arena arena_;
+  static constexpr std::size_t wire_arena_chunk_size = std::size_t(1) << 16;
+  std::shared_ptr<ENCRYPTO::Arena> wire_arena_;
   std::vector<std::unique_ptr<NewGate>> gates_;
 };
 
@@ -0,0 +1,206 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "incremental_preprocessing.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "communication/communication_layer.h"
+#include "crypto/arithmetic_provider.h"
+#include "crypto/base_ots/base_ot_provider.h"
+#include "crypto/motion_base_provider.h"
+#include "crypto/multiplication_triple/mt_provider.h"
+#include "crypto/oblivious_transfer/ot_provider.h"
+#include "statistics/run_time_stats.h"
+#include "utility/logger.h"
+
+namespace MOTION {
+
+IncrementalMTPreprocessing::IncrementalMTPreprocessing(Communication::CommunicationLayer& parent,
+                                                       std::uint32_t session_id,
+                                                       MTReservoir& mt_reservoir,
+                                                       std::size_t window_size,
+                                                       std::shared_ptr<Logger> logger)
+    : comm_layer_(std::make_unique<Communication::CommunicationLayer>(parent, session_id)),
+      mt_reservoir_(mt_reservoir),
+      window_size_(window_size),
+      logger_(std::move(logger)),
+      run_time_stats_(std::make_unique<Statistics::RunTimeStats>()) {
+  if (window_size_ == 0) {
+    throw std::invalid_argument("IncrementalMTPreprocessing: window size must be positive");
+  }
+  if (comm_layer_->get_num_parties() != 2) {
+    throw std::invalid_argument("IncrementalMTPreprocessing: only two parties are supported");
+  }
+  motion_base_provider_ = std::make_unique<Crypto::MotionBaseProvider>(*comm_layer_, logger_);
+  base_ot_provider_ =
+      std::make_unique<BaseOTProvider>(*comm_layer_, run_time_stats_.get(), logger_);
+  ot_manager_ = std::make_unique<ENCRYPTO::ObliviousTransfer::OTProviderManager>(
+      *comm_layer_, *base_ot_provider_, *motion_base_provider_, run_time_stats_.get(), logger_);
+  comm_layer_->start();
+  worker_ = std::thread([this] { run_worker(); });
+}
+
+IncrementalMTPreprocessing::~IncrementalMTPreprocessing() {
+  {
+    std::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+  comm_layer_->shutdown();
+}
+
+void IncrementalMTPreprocessing::add_request(std::size_t bit_size, std::size_t num_mts) {
+  std::size_t type_i;
+  switch (bit_size) {
+    case 1:
+      type_i = 0;
+      break;
+    case 8:
+      type_i = 1;
+      break;
+    case 16:
+      type_i = 2;
+      break;
+    case 32:
+      type_i = 3;
+      break;
+    case 64:
+      type_i = 4;
+      break;
+    default:
+      throw std::invalid_argument(
+          fmt::format("IncrementalMTPreprocessing: unsupported bit size {}", bit_size));
+  }
+  const auto num_prefetched = std::min(prefetched_[type_i], num_mts);
+  prefetched_[type_i] -= num_prefetched;
+  num_mts -= num_prefetched;
+  if (num_mts == 0) {
+    return;
+  }
+  pending_[type_i] += num_mts;
+  num_pending_ += num_mts;
+  if (num_pending_ < window_size_) {
+    return;
+  }
+  {
+    std::scoped_lock lock(mutex_);
+    windows_.push(std::exchange(pending_, {}));
+  }
+  num_pending_ = 0;
+  cv_.notify_all();
+}
+
+void IncrementalMTPreprocessing::finish() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return windows_.empty() && !busy_; });
+  pending_ = {};
+  num_pending_ = 0;
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+void IncrementalMTPreprocessing::prefetch(std::size_t num_binary_mts,
+                                          const std::array<std::size_t, 4>& num_mts) {
+  const Window window = {num_binary_mts, num_mts[0], num_mts[1], num_mts[2], num_mts[3]};
+  if (std::all_of(std::begin(window), std::end(window), [](auto n) { return n == 0; })) {
+    return;
+  }
+  for (std::size_t type_i = 0; type_i < window.size(); ++type_i) {
+    prefetched_[type_i] += window[type_i];
+  }
+  {
+    std::scoped_lock lock(mutex_);
+    windows_.push(window);
+  }
+  cv_.notify_all();
+}
+
+void IncrementalMTPreprocessing::run_worker() {
+  while (true) {
+    Window window;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !windows_.empty(); });
+      if (stop_) {
+        return;
+      }
+      window = windows_.front();
+      windows_.pop();
+      // after an error the windows of the parties are not aligned anymore
+      if (error_) {
+        lock.unlock();
+        cv_.notify_all();
+        continue;
+      }
+      busy_ = true;
+    }
+    try {
+      generate_window(window);
+    } catch (...) {
+      std::scoped_lock lock(mutex_);
+      error_ = std::current_exception();
+    }
+    {
+      std::scoped_lock lock(mutex_);
+      busy_ = false;
+    }
+    cv_.notify_all();
+  }
+}
+
+void IncrementalMTPreprocessing::generate_window(const Window& window) {
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug(fmt::format(
+          "IncrementalMTPreprocessing: generate window of {} binary, {}/{}/{}/{} arithmetic "
+          "(8/16/32/64 bit) MTs",
+          window[0], window[1], window[2], window[3], window[4]));
+    }
+  }
+  ArithmeticProviderManager arithmetic_manager(*comm_layer_, *ot_manager_, logger_);
+  MTProviderFromOTs mt_provider(comm_layer_->get_my_id(), comm_layer_->get_num_parties(), true,
+                                arithmetic_manager, *ot_manager_, *run_time_stats_, logger_);
+  mt_provider.RequestBinaryMTs(window[0]);
+  mt_provider.RequestArithmeticMTs<std::uint8_t>(window[1]);
+  mt_provider.RequestArithmeticMTs<std::uint16_t>(window[2]);
+  mt_provider.RequestArithmeticMTs<std::uint32_t>(window[3]);
+  mt_provider.RequestArithmeticMTs<std::uint64_t>(window[4]);
+
+  motion_base_provider_->setup();
+  base_ot_provider_->ComputeBaseOTs();
+  mt_provider.PreSetup();
+  ot_manager_->run_setup();
+  mt_provider.Setup();
+  mt_reservoir_.Add(mt_provider);
+  // the OTs of the next window start from scratch
+  ot_manager_->reset();
+  comm_layer_->sync();
+}
+
+}  // namespace MOTION
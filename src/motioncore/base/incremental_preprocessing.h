@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace ENCRYPTO::ObliviousTransfer {
+class OTProviderManager;
+}  // namespace ENCRYPTO::ObliviousTransfer
+
+namespace MOTION {
+
+class BaseOTProvider;
+class Logger;
+class MTReservoir;
+
+namespace Statistics {
+struct RunTimeStats;
+}
+
+namespace Communication {
+class CommunicationLayer;
+}  // namespace Communication
+
+namespace Crypto {
+class MotionBaseProvider;
+}
+
+// Generates the multiplication triples of a circuit in windows while the circuit is still being
+// built.  The requests of the MTProvider are counted and after every `window_size` requested
+// triples a worker thread generates the triples of the window with its own OT extension on a
+// separate session of the communication layer.  The triples are appended to the MT reservoir,
+// where the MTProvider of the circuit takes them from in its PreSetup(), so only the triples of
+// the last, incomplete window are left for the preprocessing.  The windows of both parties are
+// aligned since they build the same circuit.
+class IncrementalMTPreprocessing {
+ public:
+  // all parties need to use the same session_id, see CommunicationLayer
+  IncrementalMTPreprocessing(Communication::CommunicationLayer& parent, std::uint32_t session_id,
+                             MTReservoir&, std::size_t window_size, std::shared_ptr<Logger>);
+  ~IncrementalMTPreprocessing();
+
+  // count a request of the MTProvider (bit size 1 for binary triples)
+  void add_request(std::size_t bit_size, std::size_t num_mts);
+
+  // wait until the triples of all complete windows are in the reservoir and drop the requests of
+  // the incomplete one, rethrows errors of the worker
+  void finish();
+
+  // generate the given triples in a window of their own right away, e.g., the ones of the next
+  // circuit while the current one is evaluated, and do not count as many of the later requests,
+  // which are then served from the reservoir (kept across finish())
+  void prefetch(std::size_t num_binary_mts, const std::array<std::size_t, 4>& num_mts);
+  // count the prefetched triples which have not been requested yet again
+  void discard_prefetched() noexcept { prefetched_ = {}; }
+
+  std::size_t get_window_size() const noexcept { return window_size_; }
+
+ private:
+  // numbers of binary and 8, 16, 32 and 64 bit triples
+  using Window = std::array<std::size_t, 5>;
+
+  void run_worker();
+  void generate_window(const Window& window);
+
+  std::unique_ptr<Communication::CommunicationLayer> comm_layer_;
+  MTReservoir& mt_reservoir_;
+  const std::size_t window_size_;
+  std::shared_ptr<Logger> logger_;
+  std::unique_ptr<Statistics::RunTimeStats> run_time_stats_;
+  std::unique_ptr<Crypto::MotionBaseProvider> motion_base_provider_;
+  std::unique_ptr<BaseOTProvider> base_ot_provider_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::OTProviderManager> ot_manager_;
+
+  // requests since the last window, only used by the thread building the circuit
+  Window pending_{};
+  std::size_t num_pending_ = 0;
+  // prefetched triples which have not been requested yet
+  Window prefetched_{};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::queue<Window> windows_;
+  bool stop_ = false;
+  bool busy_ = false;
+  std::exception_ptr error_;
+  std::thread worker_;
+};
+
+}  // namespace MOTION
@@ -172,22 +172,4 @@ void Register::Clear() {
   gates_online_done_flag_ = false;
 }
 
-bool Register::AddCachedAlgorithmDescription(
-    std::string path, const std::shared_ptr<ENCRYPTO::AlgorithmDescription> &algo_description) {
-  std::scoped_lock lock(cached_algos_mutex_);
-  const auto [it, success] = cached_algos_.try_emplace(path, algo_description);
-  return success;
-}
-
-std::shared_ptr<ENCRYPTO::AlgorithmDescription> Register::GetCachedAlgorithmDescription(
-    const std::string &path) {
-  std::scoped_lock lock(cached_algos_mutex_);
-  const auto it = cached_algos_.find(path);
-  if (it == cached_algos_.end()) {
-    return nullptr;
-  } else {
-    return it->second;
-  }
-}
-
 }  // namespace MOTION
@@ -28,10 +28,8 @@
 #include <memory>
 #include <mutex>
 #include <queue>
-#include <unordered_map>
 
 namespace ENCRYPTO {
-struct AlgorithmDescription;
 class FiberCondition;
 }
 
@@ -120,18 +118,6 @@ class Register {
     return gates_online_done_condition_;
   };
 
-  /// \brief Tries to insert an AlgorithmDescription object read from a file into cached_algos_
-  /// \param path absolute path to the corresponding file
-  /// \param algo_description AlgorithmDescription object corresponding to the parsed file
-  /// \returns true if the insertion was successful and false if the object is already in the cache
-  bool AddCachedAlgorithmDescription(
-      std::string path, const std::shared_ptr<ENCRYPTO::AlgorithmDescription> &algo_description);
-
-  /// \brief Gets cached AlgorithmDescription object read from a file and placed into cached_algos_
-  /// \return shared_ptr to the algorithm description or to nullptr if not in the hash table
-  std::shared_ptr<ENCRYPTO::AlgorithmDescription> GetCachedAlgorithmDescription(
-      const std::string &path);
-
  private:
   std::shared_ptr<Logger> logger_;
 
@@ -157,9 +143,6 @@ class Register {
   std::vector<Gates::GatePtr> gates_;
 
   std::vector<Wires::WirePtr> wires_;
-
-  std::unordered_map<std::string, std::shared_ptr<ENCRYPTO::AlgorithmDescription>> cached_algos_;
-  std::mutex cached_algos_mutex_;
 };
 
 using RegisterPtr = std::shared_ptr<Register>;
@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "scale_out.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "base/two_party_backend.h"
+#include "communication/transport.h"
+#include "utility/helpers.h"
+
+namespace MOTION {
+
+namespace {
+
+// Messages from a worker to the coordinator: the type, the offset and the number of SIMD values
+// (64 bit integers in host byte order), followed by the output bytes.
+enum class ScaleOutMessageType : std::uint8_t { output, finished };
+
+constexpr std::size_t header_size = 1 + 2 * sizeof(std::uint64_t);
+
+std::vector<std::uint8_t> make_message(ScaleOutMessageType type, std::uint64_t offset,
+                                       std::uint64_t num_simd,
+                                       const std::vector<std::uint8_t>& output) {
+  std::vector<std::uint8_t> message(header_size + output.size());
+  message[0] = static_cast<std::uint8_t>(type);
+  std::memcpy(message.data() + 1, &offset, sizeof(offset));
+  std::memcpy(message.data() + 1 + sizeof(offset), &num_simd, sizeof(num_simd));
+  std::copy(std::begin(output), std::end(output), std::begin(message) + header_size);
+  return message;
+}
+
+// receive the chunks of one worker until it has finished
+std::vector<ScaleOutChunk> receive_chunks(Communication::Transport& worker, std::size_t worker_id) {
+  std::vector<ScaleOutChunk> chunks;
+  while (true) {
+    auto message = worker.receive_message();
+    if (!message.has_value()) {
+      throw std::runtime_error(
+          fmt::format("ScaleOutCoordinator: worker {} disconnected before finishing", worker_id));
+    }
+    if (message->size() < header_size ||
+        (*message)[0] > static_cast<std::uint8_t>(ScaleOutMessageType::finished)) {
+      throw std::runtime_error(
+          fmt::format("ScaleOutCoordinator: malformed message from worker {}", worker_id));
+    }
+    if ((*message)[0] == static_cast<std::uint8_t>(ScaleOutMessageType::finished)) {
+      return chunks;
+    }
+    std::uint64_t offset, num_simd;
+    std::memcpy(&offset, message->data() + 1, sizeof(offset));
+    std::memcpy(&num_simd, message->data() + 1 + sizeof(offset), sizeof(num_simd));
+    chunks.push_back(ScaleOutChunk{.offset = offset, .num_simd = num_simd, .output = {}});
+    chunks.back().output.assign(std::begin(*message) + header_size, std::end(*message));
+  }
+}
+
+}  // namespace
+
+std::vector<SimdSlice> partition_simd(std::size_t num_simd, std::size_t num_workers,
+                                      std::size_t alignment) {
+  if (num_workers == 0 || alignment == 0) {
+    throw std::invalid_argument(fmt::format(
+        "partition_simd: need at least one worker and a positive alignment, got {} and {}",
+        num_workers, alignment));
+  }
+  // distribute the blocks of alignment values as evenly as possible
+  const auto num_blocks = (num_simd + alignment - 1) / alignment;
+  std::vector<SimdSlice> slices(num_workers);
+  std::size_t offset = 0;
+  for (std::size_t worker_id = 0; worker_id < num_workers; ++worker_id) {
+    const auto worker_blocks =
+        num_blocks / num_workers + (worker_id < num_blocks % num_workers ? 1 : 0);
+    const auto end = std::min(offset + worker_blocks * alignment, num_simd);
+    slices[worker_id] = SimdSlice{.offset = offset, .num_simd = end - offset};
+    offset = end;
+  }
+  return slices;
+}
+
+ScaleOutWorker::ScaleOutWorker(std::size_t worker_id, std::size_t num_workers,
+                               std::unique_ptr<Communication::Transport> coordinator)
+    : worker_id_(worker_id), num_workers_(num_workers), coordinator_(std::move(coordinator)) {
+  if (worker_id >= num_workers) {
+    throw std::invalid_argument(
+        fmt::format("ScaleOutWorker: worker id {} of {} workers", worker_id, num_workers));
+  }
+  if (coordinator_ == nullptr) {
+    throw std::invalid_argument("ScaleOutWorker: need a transport to the coordinator");
+  }
+}
+
+ScaleOutWorker::~ScaleOutWorker() = default;
+
+SimdSlice ScaleOutWorker::get_slice(std::size_t num_simd, std::size_t alignment) const {
+  return partition_simd(num_simd, num_workers_, alignment).at(worker_id_);
+}
+
+void ScaleOutWorker::send_output(std::size_t offset, std::size_t num_simd,
+                                 std::vector<std::uint8_t> output) {
+  if (finished_) {
+    throw std::logic_error("ScaleOutWorker: outputs sent after finish()");
+  }
+  coordinator_->send_message(make_message(ScaleOutMessageType::output, offset, num_simd, output));
+}
+
+void ScaleOutWorker::send_output_bits(std::size_t offset, const ENCRYPTO::BitVector<>& bits) {
+  const auto& data = bits.GetData();
+  std::vector<std::uint8_t> output(Helpers::Convert::BitsToBytes(bits.GetSize()));
+  std::memcpy(output.data(), data.data(), output.size());
+  send_output(offset, bits.GetSize(), std::move(output));
+}
+
+void ScaleOutWorker::finish() {
+  if (finished_) {
+    return;
+  }
+  coordinator_->send_message(make_message(ScaleOutMessageType::finished, 0, 0, {}));
+  finished_ = true;
+}
+
+SimdSlice ScaleOutWorker::run_chunked(TwoPartyBackend& backend, std::size_t num_simd,
+                                      std::size_t chunk_size, const build_function& build_chunk,
+                                      const collect_function& collect_chunk) {
+  if (chunk_size == 0) {
+    throw std::invalid_argument("ScaleOutWorker: chunk size must be positive");
+  }
+  const auto slice = get_slice(num_simd, chunk_size);
+  backend.run_chunked(
+      slice.num_simd, chunk_size,
+      [&slice, &build_chunk](std::size_t offset, std::size_t chunk_num_simd) {
+        build_chunk(slice.offset + offset, chunk_num_simd);
+      },
+      [this, &slice, &collect_chunk](std::size_t offset, std::size_t chunk_num_simd) {
+        send_output(slice.offset + offset, chunk_num_simd,
+                    collect_chunk(slice.offset + offset, chunk_num_simd));
+      });
+  finish();
+  return slice;
+}
+
+ScaleOutCoordinator::ScaleOutCoordinator(
+    std::vector<std::unique_ptr<Communication::Transport>> workers)
+    : workers_(std::move(workers)) {
+  if (workers_.empty()) {
+    throw std::invalid_argument("ScaleOutCoordinator: need at least one worker");
+  }
+}
+
+ScaleOutCoordinator::~ScaleOutCoordinator() = default;
+
+std::vector<ScaleOutChunk> ScaleOutCoordinator::collect_outputs() {
+  // the workers run independently, so a slow one must not block the transports of the others
+  std::vector<std::future<std::vector<ScaleOutChunk>>> futures;
+  for (std::size_t worker_id = 0; worker_id < workers_.size(); ++worker_id) {
+    futures.push_back(std::async(std::launch::async, [this, worker_id] {
+      return receive_chunks(*workers_[worker_id], worker_id);
+    }));
+  }
+  std::vector<ScaleOutChunk> chunks;
+  for (auto& future : futures) {
+    auto worker_chunks = future.get();
+    std::move(std::begin(worker_chunks), std::end(worker_chunks), std::back_inserter(chunks));
+  }
+  std::sort(std::begin(chunks), std::end(chunks),
+            [](const auto& a, const auto& b) { return a.offset < b.offset; });
+  std::size_t end = 0;
+  for (const auto& chunk : chunks) {
+    if (chunk.offset != end) {
+      throw std::runtime_error(fmt::format(
+          "ScaleOutCoordinator: chunk at offset {} does not follow the previous one ending at {}",
+          chunk.offset, end));
+    }
+    end += chunk.num_simd;
+  }
+  return chunks;
+}
+
+ENCRYPTO::BitVector<> ScaleOutCoordinator::merge_bits(const std::vector<ScaleOutChunk>& chunks) {
+  ENCRYPTO::BitVector<> bits;
+  for (const auto& chunk : chunks) {
+    if (chunk.output.size() != Helpers::Convert::BitsToBytes(chunk.num_simd)) {
+      throw std::invalid_argument(
+          fmt::format("ScaleOutCoordinator: chunk at offset {} has {} bytes for {} bits",
+                      chunk.offset, chunk.output.size(), chunk.num_simd));
+    }
+    bits.Append(ENCRYPTO::BitVector<>(chunk.output.data(), chunk.num_simd));
+  }
+  return bits;
+}
+
+}  // namespace MOTION
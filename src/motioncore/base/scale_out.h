@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "utility/bit_vector.h"
+
+namespace MOTION {
+
+class TwoPartyBackend;
+
+namespace Communication {
+class Transport;
+}
+
+// Scale-out of a logical party over several machines
+//
+// Each party runs as num_workers workers, e.g., processes on different machines, and worker w
+// evaluates the circuit only on slice w of its SIMD values (see partition_simd) together with
+// worker w of the other party.  Every worker pair has its own CommunicationLayer and backend, so
+// the pairs neither share memory nor messages, and the throughput grows with their number.  The
+// workers of a party only send their outputs to the coordinator of the party, which merges them.
+// Both parties need to use the same number of workers and the same partition.
+
+// range [offset, offset + num_simd) of the SIMD values of a circuit
+struct SimdSlice {
+  std::size_t offset = 0;
+  std::size_t num_simd = 0;
+};
+
+// Splits num_simd values into num_workers consecutive slices, where all slices but the last
+// non-empty one are multiples of alignment, e.g., of the chunk size of
+// TwoPartyBackend::run_chunked, and their sizes differ by at most alignment.  Slices at the end
+// may be empty.
+std::vector<SimdSlice> partition_simd(std::size_t num_simd, std::size_t num_workers,
+                                      std::size_t alignment = 1);
+
+// outputs of a slice of SIMD values as received by the coordinator
+struct ScaleOutChunk {
+  std::size_t offset = 0;
+  std::size_t num_simd = 0;
+  std::vector<std::uint8_t> output;
+};
+
+// One worker of a party, which sends the outputs of its slice to the coordinator.
+class ScaleOutWorker {
+ public:
+  ScaleOutWorker(std::size_t worker_id, std::size_t num_workers,
+                 std::unique_ptr<Communication::Transport> coordinator);
+  ~ScaleOutWorker();
+
+  std::size_t get_worker_id() const noexcept { return worker_id_; }
+  std::size_t get_num_workers() const noexcept { return num_workers_; }
+  // the slice of this worker of num_simd values (see partition_simd)
+  SimdSlice get_slice(std::size_t num_simd, std::size_t alignment = 1) const;
+
+  // send the outputs of the values [offset, offset + num_simd), where offset refers to all SIMD
+  // values of the circuit, e.g., an empty output for the party which does not learn it
+  void send_output(std::size_t offset, std::size_t num_simd, std::vector<std::uint8_t> output);
+  // send one bit per SIMD value, e.g., the match bits of pattern matching
+  void send_output_bits(std::size_t offset, const ENCRYPTO::BitVector<>& bits);
+  // tell the coordinator that all outputs have been sent
+  void finish();
+
+  // Evaluate the slice of this worker of a circuit over num_simd values in chunks of chunk_size
+  // values with TwoPartyBackend::run_chunked(), where build_chunk builds the circuit on the
+  // values [offset, offset + chunk_num_simd) of the whole circuit and collect_chunk returns the
+  // outputs of the chunk, which are sent to the coordinator.  The slices are aligned to
+  // chunk_size.  Calls finish() and returns the slice.
+  using build_function = std::function<void(std::size_t offset, std::size_t chunk_num_simd)>;
+  using collect_function =
+      std::function<std::vector<std::uint8_t>(std::size_t offset, std::size_t chunk_num_simd)>;
+  SimdSlice run_chunked(TwoPartyBackend&, std::size_t num_simd, std::size_t chunk_size,
+                        const build_function& build_chunk, const collect_function& collect_chunk);
+
+ private:
+  std::size_t worker_id_;
+  std::size_t num_workers_;
+  std::unique_ptr<Communication::Transport> coordinator_;
+  bool finished_ = false;
+};
+
+// The coordinator of a party, which collects the outputs of its workers.
+class ScaleOutCoordinator {
+ public:
+  // the transport to worker w at position w
+  explicit ScaleOutCoordinator(std::vector<std::unique_ptr<Communication::Transport>> workers);
+  ~ScaleOutCoordinator();
+
+  // Receive the outputs of all workers, in parallel, until each of them has finished.  Returns
+  // the chunks ordered by their offsets.  Throws std::runtime_error if a worker disconnects
+  // before it has finished, or if the chunks do not cover the values [0, n) without gaps.
+  std::vector<ScaleOutChunk> collect_outputs();
+  // concatenate the outputs of chunks which hold one bit per SIMD value (see
+  // ScaleOutWorker::send_output_bits)
+  static ENCRYPTO::BitVector<> merge_bits(const std::vector<ScaleOutChunk>&);
+
+ private:
+  std::vector<std::unique_ptr<Communication::Transport>> workers_;
+};
+
+}  // namespace MOTION
@@ -22,27 +22,42 @@
 
 #include "two_party_backend.h"
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 
 #include <fmt/format.h>
 
 #include "algorithm/circuit_loader.h"
+#include "algorithm/protocol_assignment.h"
 #include "base/gate_register.h"
+#include "base/incremental_preprocessing.h"
 #include "communication/communication_layer.h"
+#include "communication/emulated_transport.h"
+#include "communication/message.h"
+#include "communication/message_handler.h"
 #include "crypto/arithmetic_provider.h"
+#include "crypto/base_ots/base_ot_cache.h"
 #include "crypto/base_ots/base_ot_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/multiplication_triple/mt_provider.h"
 #include "crypto/multiplication_triple/sb_provider.h"
 #include "crypto/multiplication_triple/sp_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "data_storage/preprocessing_plan.h"
+#include "data_storage/preprocessing_store.h"
+#include "data_storage/run_checkpoint.h"
 #include "executor/new_gate_executor.h"
 #include "protocols/beavy/beavy_provider.h"
 #include "protocols/gmw/gmw_provider.h"
 #include "protocols/yao/yao_provider.h"
+#include "statistics/circuit_analysis.h"
+#include "statistics/gate_profiler.h"
 #include "statistics/run_time_stats.h"
+#include "statistics/trace_recorder.h"
+#include "utility/constants.h"
 #include "utility/logger.h"
+#include "utility/random.h"
 #include "utility/typedefs.h"
 
 namespace MOTION {
@@ -65,42 +80,385 @@ TwoPartyBackend::TwoPartyBackend(Communication::CommunicationLayer& comm_layer,
       ot_manager_(std::make_unique<ENCRYPTO::ObliviousTransfer::OTProviderManager>(
           comm_layer_, *base_ot_provider_, *motion_base_provider_, &run_time_stats_.back(),
           logger_)),
-      arithmetic_manager_(
-          std::make_unique<ArithmeticProviderManager>(comm_layer_, *ot_manager_, logger_)),
-      mt_provider_(std::make_unique<MTProviderFromOTs>(my_id_, comm_layer_.get_num_parties(), true,
+      mt_reservoir_(std::make_unique<MTReservoir>()) {
+  run_time_stats_.back().record_start<Statistics::RunTimeStats::StatID::time_to_first_gate>();
+  if constexpr (MOTION_GATE_PROFILING) {
+    gate_profiler_ = std::make_unique<Statistics::GateProfiler>();
+    gate_executor_->set_gate_profiler(gate_profiler_.get());
+  }
+  if constexpr (MOTION_TRACING) {
+    trace_recorder_ = std::make_shared<Statistics::TraceRecorder>(my_id_);
+    gate_executor_->set_trace_recorder(trace_recorder_.get());
+    comm_layer_.set_trace_recorder(trace_recorder_);
+  }
+  make_circuit_providers();
+  gate_executor_->set_transport_mode_fctn(
+      [this](auto mode) { comm_layer_.set_transport_mode(mode); });
+  // the stored Yao gates need the keys of the garbling scheme
+  gate_executor_->set_preprocessing_store_fctns(
+      [this](auto& writer) { yao_provider_->save_setup(writer); },
+      [this](auto& record) { yao_provider_->load_setup(record); });
+  comm_layer_.start();
+}
+
+TwoPartyBackend::~TwoPartyBackend() {
+  if (checkpoint_handler_ != nullptr) {
+    comm_layer_.deregister_message_handler({Communication::MessageType::RunCheckpointCheck});
+  }
+  if (base_ots_future_.valid()) {
+    base_ots_future_.wait();
+  }
+  if (trace_recorder_ != nullptr) {
+    comm_layer_.set_trace_recorder(nullptr);
+  }
+}
+
+void TwoPartyBackend::make_circuit_providers() {
+  arithmetic_manager_ =
+      std::make_unique<ArithmeticProviderManager>(comm_layer_, *ot_manager_, logger_);
+  if (is_fake_setup()) {
+    // derived without any communication, so neither the reservoir nor the incremental
+    // preprocessing is used
+    const auto num_parties = comm_layer_.get_num_parties();
+    mt_provider_ = std::make_unique<FakeMTProvider>(my_id_, num_parties);
+    sp_provider_ = std::make_unique<FakeSPProvider>(my_id_, num_parties);
+    sb_provider_ = std::make_unique<FakeSBProvider>(my_id_, num_parties);
+  } else {
+    mt_provider_ = std::make_unique<MTProviderFromOTs>(my_id_, comm_layer_.get_num_parties(), true,
                                                        *arithmetic_manager_, *ot_manager_,
-                                                       run_time_stats_.back(), logger_)),
-      sp_provider_(std::make_unique<SPProviderFromOTs>(ot_manager_->get_providers(), my_id_,
-                                                       run_time_stats_.back(), logger_)),
-      sb_provider_(std::make_unique<TwoPartySBProvider>(
-          comm_layer_, ot_manager_->get_provider(1 - my_id_), run_time_stats_.back(), logger_)),
-      beavy_provider_(std::make_unique<proto::beavy::BEAVYProvider>(
-          comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_, *ot_manager_,
-          *arithmetic_manager_, logger_)),
-      gmw_provider_(std::make_unique<proto::gmw::GMWProvider>(
-          comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_, *ot_manager_,
-          *arithmetic_manager_, *mt_provider_, *sp_provider_, *sb_provider_, logger_)),
-      yao_provider_(std::make_unique<proto::yao::YaoProvider>(
-          comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_,
-          ot_manager_->get_provider(1 - my_id_), logger_)) {
+                                                       run_time_stats_.back(), logger_);
+    mt_provider_->SetReservoir(mt_reservoir_.get());
+    if (incremental_preprocessing_ != nullptr) {
+      mt_provider_->SetRequestCallback([this](std::size_t bit_size, std::size_t num_mts) {
+        incremental_preprocessing_->add_request(bit_size, num_mts);
+      });
+    }
+    sp_provider_ = std::make_unique<SPProviderFromOTs>(ot_manager_->get_providers(), my_id_,
+                                                       run_time_stats_.back(), logger_);
+    if (sbs_from_rots_) {
+      sb_provider_ = std::make_unique<TwoPartySBProviderFromROTs>(
+          comm_layer_, ot_manager_->get_provider(1 - my_id_), run_time_stats_.back(), logger_);
+    } else {
+      sb_provider_ = std::make_unique<TwoPartySBProvider>(
+          comm_layer_, ot_manager_->get_provider(1 - my_id_), run_time_stats_.back(), logger_);
+    }
+  }
+  beavy_provider_ = std::make_unique<proto::beavy::BEAVYProvider>(
+      comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_, *ot_manager_,
+      *arithmetic_manager_, logger_);
+  beavy_provider_->set_batch_ot_preprocessing(batch_ot_preprocessing_);
+  beavy_provider_->set_non_interactive_inputs(non_interactive_inputs_);
+  beavy_provider_->set_strong_party(beavy_strong_party_);
+  gmw_provider_ = std::make_unique<proto::gmw::GMWProvider>(
+      comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_, *ot_manager_,
+      *arithmetic_manager_, *mt_provider_, *sp_provider_, *sb_provider_, logger_);
+  yao_provider_ = std::make_unique<proto::yao::YaoProvider>(
+      comm_layer_, *gate_register_, *circuit_loader_, *motion_base_provider_,
+      ot_manager_->get_provider(1 - my_id_), logger_);
+  yao_provider_->set_garbling_scheme(garbling_scheme_);
+  yao_provider_->set_garbled_table_window(garbled_table_window_);
+  yao_provider_->set_batch_input_ots(batch_yao_input_ots_);
+  if (gate_profiler_ != nullptr) {
+    beavy_provider_->set_gate_profiler(gate_profiler_.get());
+    gmw_provider_->set_gate_profiler(gate_profiler_.get());
+    yao_provider_->set_gate_profiler(gate_profiler_.get());
+  }
+  gate_factories_.clear();
   gate_factories_.emplace(MPCProtocol::ArithmeticBEAVY, *beavy_provider_);
   gate_factories_.emplace(MPCProtocol::BooleanBEAVY, *beavy_provider_);
   gate_factories_.emplace(MPCProtocol::ArithmeticGMW, *gmw_provider_);
   gate_factories_.emplace(MPCProtocol::BooleanGMW, *gmw_provider_);
   gate_factories_.emplace(MPCProtocol::Yao, *yao_provider_);
-  comm_layer_.start();
 }
 
-TwoPartyBackend::~TwoPartyBackend() = default;
+void TwoPartyBackend::reset() {
+  if (incremental_preprocessing_ != nullptr) {
+    // the windows of the next circuit start from scratch
+    incremental_preprocessing_->finish();
+  }
+  // the gates hold OT and triple objects of the providers, so delete them first
+  gate_register_->reset();
+  gate_executor_->reset();
+  gate_factories_.clear();
+  yao_provider_.reset();
+  gmw_provider_.reset();
+  beavy_provider_.reset();
+  sb_provider_.reset();
+  sp_provider_.reset();
+  mt_provider_.reset();
+  arithmetic_manager_.reset();
+  ot_manager_->reset();
+  {
+    using StatID = Statistics::RunTimeStats::StatID;
+    auto& stats = run_time_stats_.back();
+    const auto time_to_first_gate = stats.get(StatID::time_to_first_gate);
+    stats = {};
+    if (!first_gate_recorded_) {
+      // no circuit has been evaluated yet
+      stats.data_[static_cast<std::size_t>(StatID::time_to_first_gate)] = time_to_first_gate;
+    }
+  }
+  plan_.reset();
+  prefetch_plan_.reset();
+  make_circuit_providers();
+  // no messages of the next circuit must arrive before the providers have been created
+  comm_layer_.sync();
+}
+
+void TwoPartyBackend::run_chunked(std::size_t num_simd, std::size_t chunk_size,
+                                  const chunk_function& build_chunk,
+                                  const chunk_function& collect_chunk) {
+  if (chunk_size == 0) {
+    throw std::invalid_argument("TwoPartyBackend: chunk size must be positive");
+  }
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("chunks can only be run while no circuit is built");
+  }
+  for (std::size_t offset = 0; offset < num_simd; offset += chunk_size) {
+    const auto chunk_num_simd = std::min(chunk_size, num_simd - offset);
+    build_chunk(offset, chunk_num_simd);
+    // the next chunk requests the same triples if it has the same size
+    const auto next_offset = offset + chunk_num_simd;
+    if (incremental_preprocessing_ != nullptr && num_simd - next_offset >= chunk_size) {
+      prefetch_plan_ = std::make_unique<PreprocessingPlan>(get_preprocessing_plan());
+    }
+    run();
+    collect_chunk(offset, chunk_num_simd);
+    reset();
+  }
+  if (incremental_preprocessing_ != nullptr) {
+    incremental_preprocessing_->discard_prefetched();
+  }
+}
+
+void TwoPartyBackend::refill_mt_reservoir() {
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("the MT reservoir can only be refilled while no circuit is built");
+  }
+  if (is_fake_setup()) {
+    // the fake triples do not use the reservoir
+    return;
+  }
+  if constexpr (MOTION_DEBUG) {
+    logger_->LogDebug(fmt::format(
+        "refill MT reservoir: {} binary, {}/{}/{}/{} arithmetic (8/16/32/64 bit) MTs",
+        mt_reservoir_->GetNumMissing<bool>(), mt_reservoir_->GetNumMissing<std::uint8_t>(),
+        mt_reservoir_->GetNumMissing<std::uint16_t>(),
+        mt_reservoir_->GetNumMissing<std::uint32_t>(),
+        mt_reservoir_->GetNumMissing<std::uint64_t>()));
+  }
+  if (incremental_preprocessing_ != nullptr) {
+    // no window must add triples to the reservoir concurrently
+    incremental_preprocessing_->finish();
+  }
+  // generate the triples with own providers s.t. the ones of the next circuit stay untouched
+  Statistics::RunTimeStats stats;
+  ArithmeticProviderManager arithmetic_manager(comm_layer_, *ot_manager_, logger_);
+  MTProviderFromOTs mt_provider(my_id_, comm_layer_.get_num_parties(), true, arithmetic_manager,
+                                *ot_manager_, stats, logger_);
+  mt_provider.RequestBinaryMTs(mt_reservoir_->GetNumMissing<bool>());
+  mt_provider.RequestArithmeticMTs<std::uint8_t>(mt_reservoir_->GetNumMissing<std::uint8_t>());
+  mt_provider.RequestArithmeticMTs<std::uint16_t>(mt_reservoir_->GetNumMissing<std::uint16_t>());
+  mt_provider.RequestArithmeticMTs<std::uint32_t>(mt_reservoir_->GetNumMissing<std::uint32_t>());
+  mt_provider.RequestArithmeticMTs<std::uint64_t>(mt_reservoir_->GetNumMissing<std::uint64_t>());
+  if (!mt_provider.NeedMTs()) {
+    return;
+  }
+
+  wait_base_ots();
+  motion_base_provider_->setup();
+  base_ot_provider_->ComputeBaseOTs();
+  mt_provider.PreSetup();
+  ot_manager_->run_setup();
+  mt_provider.Setup();
+  mt_reservoir_->Add(mt_provider);
+  // the OTs of the next circuit start from scratch
+  ot_manager_->reset();
+  comm_layer_.sync();
+}
+
+void TwoPartyBackend::fill_ot_pool(std::size_t num_ots) {
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("the OT pool can only be filled while no circuit is built");
+  }
+  if (ot_manager_->get_backend() != ENCRYPTO::ObliviousTransfer::OTBackend::silent_ot) {
+    throw std::logic_error("only the silent OT backend keeps a pool of random OTs");
+  }
+  wait_base_ots();
+  motion_base_provider_->setup();
+  base_ot_provider_->ComputeBaseOTs();
+  ot_manager_->fill_pools(num_ots);
+}
+
+PreprocessingPlan TwoPartyBackend::get_preprocessing_plan() const {
+  PreprocessingPlan plan;
+  plan.num_binary_mts = mt_provider_->GetNumMTs<bool>();
+  plan.num_mts = {mt_provider_->GetNumMTs<std::uint8_t>(), mt_provider_->GetNumMTs<std::uint16_t>(),
+                  mt_provider_->GetNumMTs<std::uint32_t>(),
+                  mt_provider_->GetNumMTs<std::uint64_t>()};
+  plan.num_sbs = {sb_provider_->GetNumSBs<std::uint8_t>(), sb_provider_->GetNumSBs<std::uint16_t>(),
+                  sb_provider_->GetNumSBs<std::uint32_t>(),
+                  sb_provider_->GetNumSBs<std::uint64_t>()};
+  plan.num_sps = {sp_provider_->GetNumSPs<std::uint8_t>(), sp_provider_->GetNumSPs<std::uint16_t>(),
+                  sp_provider_->GetNumSPs<std::uint32_t>(),
+                  sp_provider_->GetNumSPs<std::uint64_t>(), sp_provider_->GetNumSPs<__uint128_t>()};
+  const auto& ot_provider = ot_manager_->get_provider(1 - my_id_);
+  plan.num_ots_sent = ot_provider.GetNumOTsSender();
+  plan.num_ots_received = ot_provider.GetNumOTsReceiver();
+  return plan;
+}
+
+const GateRegister& TwoPartyBackend::get_gate_register() const noexcept {
+  return *gate_register_;
+}
+
+void TwoPartyBackend::reserve_circuit(std::size_t num_gates, std::size_t num_gate_ids,
+                                      const std::vector<MPCProtocol>& protocols) {
+  gate_register_->reserve(num_gates);
+  const auto first_gate_id = gate_register_->peek_next_gate_id();
+  for (const auto proto : protocols) {
+    // the plain protocols have no gates of their own
+    const auto it = gate_factories_.find(proto);
+    if (it == std::end(gate_factories_)) {
+      continue;
+    }
+    dynamic_cast<proto::CommMixin&>(it->second.get())
+        .reserve_message_slots(first_gate_id, num_gate_ids);
+  }
+}
+
+ConstructionScope TwoPartyBackend::reserve_construction_blocks(
+    const ConstructionScope::Counts& counts) {
+  if (ConstructionScope::is_active()) {
+    throw std::logic_error(
+        "TwoPartyBackend: construction blocks cannot be reserved within a ConstructionScope");
+  }
+  ConstructionScope scope(ConstructionScope::Mode::blocks);
+  for (std::size_t i = 0; i < num_construction_counters; ++i) {
+    const auto num_ids = counts[i];
+    if (num_ids == 0) {
+      continue;
+    }
+    const auto counter = static_cast<ConstructionCounter>(i);
+    std::size_t first;
+    switch (counter) {
+      case ConstructionCounter::gate_ids:
+        first = gate_register_->get_next_gate_ids(num_ids);
+        break;
+      case ConstructionCounter::gate_slots:
+        first = gate_register_->reserve_gate_slots(num_ids);
+        break;
+      case ConstructionCounter::beavy_input_ids:
+        first = beavy_provider_->get_next_input_id(num_ids);
+        break;
+      case ConstructionCounter::gmw_input_ids:
+        first = gmw_provider_->get_next_input_id(num_ids);
+        break;
+      case ConstructionCounter::batched_xcot_bits:
+        first = beavy_provider_->reserve_batched_xcot_block(num_ids);
+        break;
+      case ConstructionCounter::binary_mts:
+        first = mt_provider_->RequestBinaryMTs(num_ids);
+        break;
+      case ConstructionCounter::mts_8:
+        first = mt_provider_->RequestArithmeticMTs<std::uint8_t>(num_ids);
+        break;
+      case ConstructionCounter::mts_16:
+        first = mt_provider_->RequestArithmeticMTs<std::uint16_t>(num_ids);
+        break;
+      case ConstructionCounter::mts_32:
+        first = mt_provider_->RequestArithmeticMTs<std::uint32_t>(num_ids);
+        break;
+      case ConstructionCounter::mts_64:
+        first = mt_provider_->RequestArithmeticMTs<std::uint64_t>(num_ids);
+        break;
+      case ConstructionCounter::sps_8:
+        first = sp_provider_->RequestSPs<std::uint8_t>(num_ids);
+        break;
+      case ConstructionCounter::sps_16:
+        first = sp_provider_->RequestSPs<std::uint16_t>(num_ids);
+        break;
+      case ConstructionCounter::sps_32:
+        first = sp_provider_->RequestSPs<std::uint32_t>(num_ids);
+        break;
+      case ConstructionCounter::sps_64:
+        first = sp_provider_->RequestSPs<std::uint64_t>(num_ids);
+        break;
+      case ConstructionCounter::sps_128:
+        first = sp_provider_->RequestSPs<__uint128_t>(num_ids);
+        break;
+      case ConstructionCounter::sbs_8:
+        first = sb_provider_->RequestSBs<std::uint8_t>(num_ids);
+        break;
+      case ConstructionCounter::sbs_16:
+        first = sb_provider_->RequestSBs<std::uint16_t>(num_ids);
+        break;
+      case ConstructionCounter::sbs_32:
+        first = sb_provider_->RequestSBs<std::uint32_t>(num_ids);
+        break;
+      case ConstructionCounter::sbs_64:
+        first = sb_provider_->RequestSBs<std::uint64_t>(num_ids);
+        break;
+      default:
+        throw std::logic_error(fmt::format("TwoPartyBackend: unknown construction counter {}", i));
+    }
+    scope.add_block(counter, first, num_ids);
+  }
+  return scope;
+}
+
+Statistics::CircuitAnalysis TwoPartyBackend::analyze_circuit() const {
+  return Statistics::analyze_circuit(*gate_register_);
+}
+
+void TwoPartyBackend::prepare_preprocessing(const PreprocessingPlan& plan) {
+  auto& reservoir = *mt_reservoir_;
+  reservoir.SetCapacity<bool>(std::max(reservoir.GetCapacity<bool>(), plan.num_binary_mts));
+  reservoir.SetCapacity<std::uint8_t>(
+      std::max(reservoir.GetCapacity<std::uint8_t>(), plan.num_mts[0]));
+  reservoir.SetCapacity<std::uint16_t>(
+      std::max(reservoir.GetCapacity<std::uint16_t>(), plan.num_mts[1]));
+  reservoir.SetCapacity<std::uint32_t>(
+      std::max(reservoir.GetCapacity<std::uint32_t>(), plan.num_mts[2]));
+  reservoir.SetCapacity<std::uint64_t>(
+      std::max(reservoir.GetCapacity<std::uint64_t>(), plan.num_mts[3]));
+  refill_mt_reservoir();
+  plan_ = std::make_unique<PreprocessingPlan>(plan);
+}
 
 void TwoPartyBackend::run_preprocessing() {
   run_time_stats_.back().record_start<Statistics::RunTimeStats::StatID::preprocessing>();
 
+  if (plan_ != nullptr) {
+    if constexpr (MOTION_DEBUG) {
+      if (*plan_ != get_preprocessing_plan()) {
+        logger_->LogDebug(
+            "circuit does not match the preprocessing plan, missing triples are generated now");
+      }
+    }
+    plan_.reset();
+  }
+  if (incremental_preprocessing_ != nullptr) {
+    // the MT provider takes the triples of the complete windows from the reservoir
+    incremental_preprocessing_->finish();
+  }
+
+  wait_base_ots();
   motion_base_provider_->setup();
-  base_ot_provider_->ComputeBaseOTs();
+  if (!is_fake_setup()) {
+    base_ot_provider_->ComputeBaseOTs();
+  }
   mt_provider_->PreSetup();
+  if (prefetch_plan_ != nullptr) {
+    // the MT provider has taken its triples from the reservoir, so the worker can add the ones
+    // of the next chunk while this one is evaluated
+    incremental_preprocessing_->prefetch(prefetch_plan_->num_binary_mts, prefetch_plan_->num_mts);
+    prefetch_plan_.reset();
+  }
   sp_provider_->PreSetup();
   sb_provider_->PreSetup();
+  beavy_provider_->register_batched_ots();
+  yao_provider_->register_batched_ots();
   ot_manager_->run_setup();
   mt_provider_->Setup();
   sp_provider_->Setup();
@@ -112,8 +470,294 @@ void TwoPartyBackend::run_preprocessing() {
   run_time_stats_.back().record_end<Statistics::RunTimeStats::StatID::preprocessing>();
 }
 
+void TwoPartyBackend::record_time_to_first_gate() {
+  if (first_gate_recorded_) {
+    return;
+  }
+  run_time_stats_.back().record_end<Statistics::RunTimeStats::StatID::time_to_first_gate>();
+  first_gate_recorded_ = true;
+}
+
 void TwoPartyBackend::run() {
-  gate_executor_->evaluate_setup_online(run_time_stats_.back());
+  record_time_to_first_gate();
+  if (checkpoint_ != nullptr) {
+    run_with_checkpoint();
+  } else if (garbled_table_window_ > 0 || evaluate_asap_) {
+    // with a garbled table window, the garbler waits in its setup phase for the evaluator's
+    // online phase
+    gate_executor_->evaluate(run_time_stats_.back());
+  } else {
+    gate_executor_->evaluate_setup_online(run_time_stats_.back());
+  }
+}
+
+void TwoPartyBackend::set_checkpoint(const std::string& directory, const std::string& run_name) {
+  if (checkpoint_ == nullptr) {
+    checkpoint_handler_ = std::make_shared<Communication::QueueHandler>();
+    comm_layer_.register_message_handler(
+        [handler = checkpoint_handler_](std::size_t) { return handler; },
+        {Communication::MessageType::RunCheckpointCheck});
+    // the handler is registered before the other party can send its check
+    comm_layer_.sync();
+  }
+  checkpoint_ = std::make_unique<RunCheckpoint>(directory, run_name);
+}
+
+void TwoPartyBackend::run_with_checkpoint() {
+  if (garbled_table_window_ > 0 || evaluate_asap_) {
+    throw std::logic_error(
+        "TwoPartyBackend: a checkpoint needs the setup phase to finish before the online phase");
+  }
+  // fail before the setup instead of at the checkpoint
+  gate_executor_->check_preprocessing_store_support();
+  const auto num_gates = gate_register_->get_num_gates();
+  auto marker = checkpoint_->load_marker(my_id_);
+  if (marker.has_value() && marker->num_gates_ != num_gates) {
+    // the checkpoint belongs to another circuit
+    marker.reset();
+  }
+
+  // send the identifier of our checkpoint (zero if we have none) and a fresh nonce
+  constexpr std::size_t id_size = std::tuple_size_v<RunCheckpoint::id_t>;
+  std::vector<std::uint8_t> check(2 * id_size, 0);
+  if (marker.has_value()) {
+    std::transform(std::begin(marker->id_), std::end(marker->id_), std::begin(check),
+                   [](auto b) { return std::uint8_t(b); });
+  }
+  const auto nonce = RandomVector(id_size);
+  std::copy(std::begin(nonce), std::end(nonce), std::begin(check) + id_size);
+  comm_layer_.send_message(1 - my_id_, Communication::BuildMessage(
+                                           Communication::MessageType::RunCheckpointCheck, &check));
+  const auto raw_message = checkpoint_handler_->get_queue().dequeue();
+  if (!raw_message.has_value()) {
+    throw std::runtime_error("TwoPartyBackend: did not receive the checkpoint of the other party");
+  }
+  const auto payload = Communication::GetMessage(raw_message->data())->payload();
+  if (payload == nullptr || payload->size() != check.size()) {
+    throw std::runtime_error("TwoPartyBackend: received checkpoint check of wrong size");
+  }
+
+  const bool resume = marker.has_value() &&
+                      std::any_of(std::begin(check), std::begin(check) + id_size,
+                                  [](auto b) { return b != 0; }) &&
+                      std::equal(std::begin(check), std::begin(check) + id_size, payload->begin());
+  auto& stats = run_time_stats_.back();
+  if (resume) {
+    if (logger_) {
+      logger_->LogInfo(fmt::format("Resuming from the checkpoint in {}",
+                                   checkpoint_->get_store_path(my_id_)));
+    }
+    const PreprocessingReader reader(checkpoint_->get_store_path(my_id_), my_id_);
+    gate_executor_->evaluate_online_from_store(stats, reader);
+  } else {
+    checkpoint_->remove(my_id_);
+    // both parties contributed to the identifier of the new checkpoint, so a party only resumes
+    // if the other one has completed the same checkpoint
+    RunCheckpoint::Marker new_marker{.num_gates_ = num_gates};
+    for (std::size_t j = 0; j < id_size; ++j) {
+      new_marker.id_[j] = std::byte(check[id_size + j] ^ payload->Get(id_size + j));
+    }
+    gate_executor_->set_setup_finished_fctn([this, &new_marker] {
+      PreprocessingWriter writer(checkpoint_->get_store_path(my_id_), my_id_);
+      gate_executor_->write_setup_to_store(writer);
+      checkpoint_->store_marker(my_id_, new_marker);
+    });
+    try {
+      gate_executor_->evaluate_setup_online(stats);
+    } catch (...) {
+      gate_executor_->set_setup_finished_fctn(nullptr);
+      throw;
+    }
+    gate_executor_->set_setup_finished_fctn(nullptr);
+  }
+  // the setup material must not be used for a second online phase
+  checkpoint_->remove(my_id_);
+}
+
+void TwoPartyBackend::run_setup_and_store(const std::string& path) {
+  record_time_to_first_gate();
+  PreprocessingWriter writer(path, my_id_);
+  gate_executor_->evaluate_setup_and_store(run_time_stats_.back(), writer);
+}
+
+void TwoPartyBackend::run_online_from_store(const std::string& path) {
+  record_time_to_first_gate();
+  const PreprocessingReader reader(path, my_id_);
+  gate_executor_->evaluate_online_from_store(run_time_stats_.back(), reader);
+}
+
+void TwoPartyBackend::set_gate_scheduling(GateScheduling scheduling) {
+  gate_executor_->set_gate_scheduling(scheduling);
+}
+
+void TwoPartyBackend::set_thread_placement(ENCRYPTO::ThreadPlacement placement) {
+  gate_executor_->set_thread_placement(placement);
+}
+
+void TwoPartyBackend::set_fiber_stack_sizes(const FiberStackSizes& stack_sizes) {
+  gate_executor_->set_fiber_stack_sizes(stack_sizes);
+}
+
+void TwoPartyBackend::set_adaptive_thread_allocation(std::size_t num_cpus) {
+  gate_executor_->set_adaptive_thread_allocation(num_cpus);
+}
+
+void TwoPartyBackend::set_fuse_online_messages(bool fuse) {
+  gate_executor_->set_fuse_online_messages(fuse);
+}
+
+void TwoPartyBackend::set_fuse_output_messages(bool fuse) {
+  gate_executor_->set_fuse_output_messages(fuse);
+}
+
+void TwoPartyBackend::set_transport_modes(Communication::TransportMode setup_mode,
+                                          Communication::TransportMode online_mode) {
+  gate_executor_->set_transport_modes(setup_mode, online_mode);
+}
+
+void TwoPartyBackend::set_batch_ot_preprocessing(bool batch) {
+  batch_ot_preprocessing_ = batch;
+  beavy_provider_->set_batch_ot_preprocessing(batch);
+}
+
+void TwoPartyBackend::set_non_interactive_inputs(bool non_interactive) {
+  non_interactive_inputs_ = non_interactive;
+  beavy_provider_->set_non_interactive_inputs(non_interactive);
+}
+
+void TwoPartyBackend::set_beavy_strong_party(std::optional<std::size_t> party_id) {
+  beavy_strong_party_ = party_id;
+  beavy_provider_->set_strong_party(party_id);
+}
+
+void TwoPartyBackend::set_incremental_preprocessing(std::uint32_t session_id,
+                                                    std::size_t window_size) {
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("incremental preprocessing can only be set while no circuit is built");
+  }
+  incremental_preprocessing_.reset();
+  if (window_size > 0) {
+    incremental_preprocessing_ = std::make_unique<IncrementalMTPreprocessing>(
+        comm_layer_, session_id, *mt_reservoir_, window_size, logger_);
+    mt_provider_->SetRequestCallback([this](std::size_t bit_size, std::size_t num_mts) {
+      incremental_preprocessing_->add_request(bit_size, num_mts);
+    });
+  } else {
+    mt_provider_->SetRequestCallback(nullptr);
+  }
+}
+
+void TwoPartyBackend::set_ot_backend(ENCRYPTO::ObliviousTransfer::OTBackend backend) {
+  // the circuit providers hold references to the OT providers which are replaced
+  gate_factories_.clear();
+  yao_provider_.reset();
+  gmw_provider_.reset();
+  beavy_provider_.reset();
+  sb_provider_.reset();
+  sp_provider_.reset();
+  mt_provider_.reset();
+  arithmetic_manager_.reset();
+  ot_manager_->set_backend(backend);
+  make_circuit_providers();
+}
+
+void TwoPartyBackend::set_streaming_ot_setup(bool streaming) {
+  ot_manager_->set_streaming_setup(streaming);
+}
+
+void TwoPartyBackend::start_base_ots() {
+  if (base_ots_future_.valid()) {
+    return;
+  }
+  base_ots_future_ = std::async(std::launch::async, [this] {
+    motion_base_provider_->setup();
+    if (!is_fake_setup()) {
+      base_ot_provider_->ComputeBaseOTs();
+    }
+  });
+}
+
+void TwoPartyBackend::wait_base_ots() {
+  if (base_ots_future_.valid()) {
+    // rethrows the errors of the background task
+    base_ots_future_.get();
+  }
+}
+
+bool TwoPartyBackend::is_fake_setup() const {
+  return ot_manager_->get_backend() == ENCRYPTO::ObliviousTransfer::OTBackend::fake_setup;
+}
+
+void TwoPartyBackend::set_base_ot_cache(const std::string& directory,
+                                        const std::string& peer_name) {
+  base_ot_provider_->set_cache(std::make_shared<BaseOTCache>(directory, peer_name));
+}
+
+void TwoPartyBackend::set_garbling_scheme(proto::yao::GarblingScheme scheme) {
+  garbling_scheme_ = scheme;
+  yao_provider_->set_garbling_scheme(scheme);
+}
+
+void TwoPartyBackend::set_garbled_table_window(std::size_t num_blocks) {
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("the garbled table window can only be set while no circuit is built");
+  }
+  garbled_table_window_ = num_blocks;
+  yao_provider_->set_garbled_table_window(num_blocks);
+}
+
+void TwoPartyBackend::set_batch_yao_input_ots(bool batch) {
+  if (gate_register_->get_num_gates() > 0) {
+    throw std::logic_error("the Yao input OTs can only be batched while no circuit is built");
+  }
+  batch_yao_input_ots_ = batch;
+  yao_provider_->set_batch_input_ots(batch);
+}
+
+void TwoPartyBackend::set_network_profile(const Communication::NetworkProfile& profile) {
+  CircuitCostModel cost_model;
+  cost_model.round_trip_time = profile.round_trip_time;
+  cost_model.bandwidth = static_cast<double>(profile.bandwidth);
+  circuit_loader_->set_cost_model(cost_model);
+}
+
+Communication::NetworkProfile TwoPartyBackend::measure_network() {
+  auto profile = comm_layer_.measure_network();
+  set_network_profile(profile);
+  return profile;
+}
+
+ProtocolAssignment TwoPartyBackend::assign_protocols(
+    const std::vector<ProtocolAssignmentNode>& nodes, const std::vector<MPCProtocol>& protocols,
+    std::size_t bit_size) {
+  auto cost_model = ProtocolCostModel::make_default(bit_size);
+  if (const auto& network = circuit_loader_->get_cost_model(); network.has_value()) {
+    cost_model.round_trip_time = network->round_trip_time;
+    cost_model.bandwidth = network->bandwidth;
+  }
+  if (!protocol_calibration_path_.empty()) {
+    cost_model.load_calibration(protocol_calibration_path_);
+  }
+  ProtocolAssigner assigner(std::move(cost_model), protocols,
+                            [this](auto src, auto dst) { return convert_via(src, dst); });
+  return assigner.assign(nodes);
+}
+
+void TwoPartyBackend::set_sbs_from_rots(bool from_rots) {
+  if (from_rots == sbs_from_rots_) {
+    return;
+  }
+  sbs_from_rots_ = from_rots;
+  // the GMW provider holds a reference to the SB provider which is replaced
+  gate_factories_.clear();
+  yao_provider_.reset();
+  gmw_provider_.reset();
+  beavy_provider_.reset();
+  sb_provider_.reset();
+  sp_provider_.reset();
+  mt_provider_.reset();
+  arithmetic_manager_.reset();
+  make_circuit_providers();
 }
 
 std::optional<MPCProtocol> TwoPartyBackend::convert_via(MPCProtocol src_proto,
@@ -144,6 +788,20 @@ GateFactory& TwoPartyBackend::get_gate_factory(MPCProtocol proto) {
   }
 }
 
+void TwoPartyBackend::set_gate_profiler_range_width(std::size_t width) {
+  if (gate_profiler_ != nullptr) {
+    gate_profiler_->set_gate_id_range_width(width);
+  }
+}
+
+void TwoPartyBackend::write_chrome_trace(const std::string& path) const {
+  if (trace_recorder_ == nullptr) {
+    throw std::logic_error(
+        "TwoPartyBackend::write_chrome_trace: tracing is disabled, enable MOTION_TRACING");
+  }
+  trace_recorder_->write_chrome_trace(path);
+}
+
 const Statistics::RunTimeStats& TwoPartyBackend::get_run_time_stats() const noexcept {
   return run_time_stats_.back();
 }
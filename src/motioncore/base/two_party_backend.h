@@ -22,15 +22,26 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
+#include <string>
 #include <unordered_map>
 
 #include "circuit_builder.h"
 #include "gate_factory.h"
+#include "utility/constants.h"
+#include "utility/construction_scope.h"
 
-namespace ENCRYPTO::ObliviousTransfer {
+namespace ENCRYPTO {
+enum class ThreadPlacement : unsigned int;
+namespace ObliviousTransfer {
 class OTProviderManager;
-}
+enum class OTBackend : unsigned int;
+}  // namespace ObliviousTransfer
+}  // namespace ENCRYPTO
 
 namespace MOTION {
 
@@ -39,16 +50,26 @@ class BaseOTProvider;
 class CircuitLoader;
 class GateFactory;
 class GateRegister;
+class IncrementalMTPreprocessing;
 class Logger;
 class MTProvider;
+class MTReservoir;
 class NewGateExecutor;
+enum class GateScheduling;
+struct PreprocessingPlan;
+struct ProtocolAssignment;
+struct ProtocolAssignmentNode;
+class RunCheckpoint;
 class SBProvider;
 class SPProvider;
 enum class MPCProtocol : unsigned int;
 
 namespace Communication {
 class CommunicationLayer;
-}
+struct NetworkProfile;
+class QueueHandler;
+enum class TransportMode : std::uint8_t;
+}  // namespace Communication
 
 namespace Crypto {
 class MotionBaseProvider;
@@ -62,13 +83,17 @@ namespace gmw {
 class GMWProvider;
 }
 namespace yao {
+enum class GarblingScheme : std::uint8_t;
 class YaoProvider;
-}
+}  // namespace yao
 }  // namespace proto
 
 namespace Statistics {
+struct CircuitAnalysis;
+class GateProfiler;
 struct RunTimeStats;
-}
+class TraceRecorder;
+}  // namespace Statistics
 
 class TwoPartyBackend : public CircuitBuilder {
  public:
@@ -78,26 +103,211 @@ class TwoPartyBackend : public CircuitBuilder {
 
   void run_preprocessing();
   void run();
+  // Run the preprocessing and the setup phase of the circuit and write the setup material of all
+  // gates to the file at `path` instead of running the online phase.
+  void run_setup_and_store(const std::string& path);
+  // Run only the online phase of the circuit with setup material loaded from the file at `path`.
+  // The circuit has to be built exactly as when the store was written, on a fresh backend.  For
+  // Yao, the store contains the garbled circuit, which must only be evaluated once.
+  void run_online_from_store(const std::string& path);
+  // Let run() write a checkpoint to `directory` once the setup phase of all gates has finished,
+  // where `run_name` identifies the run across restarts.  If both parties find the same checkpoint
+  // when run() starts, they load its setup material and run only the online phase, e.g., after
+  // the connection was lost during the online phase and has been set up again with a new
+  // CommunicationLayer and backend on which the same circuit is built.  The base OTs can be kept
+  // with set_base_ot_cache(); the other preprocessing is part of the setup material.  The resumed
+  // online phase has to use the same inputs as the interrupted one, since it runs on the same
+  // setup material, e.g., garbled circuit.  The checkpoint is removed once the online phase has
+  // finished.  Needs gates which support the preprocessing store and cannot be combined with
+  // set_evaluate_asap() or a garbled table window (called by both parties before building).
+  void set_checkpoint(const std::string& directory, const std::string& run_name);
+  // Delete the evaluated circuit such that the next one can be built on the same backend.  The
+  // communication, the base OTs, the OT extension state and the fiber pool are kept, so only
+  // the first circuit pays for their setup.  Needs to be called by both parties after run().
+  // Gates and wires of the old circuit must not be used afterwards.
+  void reset();
+  // Evaluate a circuit over num_simd values in chunks of chunk_size SIMD values, s.t. the memory
+  // of the gates depends on chunk_size instead of num_simd.  For each chunk, build_chunk builds
+  // the circuit on the values [offset, offset + chunk_num_simd), which is then run, collect_chunk
+  // reads its outputs, and the backend is reset for the next chunk.  With incremental
+  // preprocessing, the triples of the next chunk are generated on its session while the current
+  // chunk is evaluated.  Called by both parties while no circuit is built.
+  using chunk_function = std::function<void(std::size_t offset, std::size_t chunk_num_simd)>;
+  void run_chunked(std::size_t num_simd, std::size_t chunk_size, const chunk_function& build_chunk,
+                   const chunk_function& collect_chunk);
+
+  // select how the gate executor hands the gates to the fiber pool
+  void set_gate_scheduling(GateScheduling scheduling);
+  // run the online phase of each gate right after its setup phase instead of after the setup of
+  // all gates, see NewGateExecutor::evaluate() (set by both parties before run())
+  void set_evaluate_asap(bool asap) noexcept { evaluate_asap_ = asap; }
+  // pin the worker threads of the gate executor, e.g., to the NUMA nodes with the gates split
+  // between them (set before the first run)
+  void set_thread_placement(ENCRYPTO::ThreadPlacement placement);
+  // stack sizes of the fiber stack classes of the gates (set before the first run)
+  void set_fiber_stack_sizes(const FiberStackSizes& stack_sizes);
+  // split num_cpus CPUs (0 for all) between the OpenMP loops of the providers and the gates per
+  // phase and adapt the split to the utilization after each run, see ThreadAllocator (set before
+  // the first run)
+  void set_adaptive_thread_allocation(std::size_t num_cpus);
+  // send one fused online message per layer and gate type instead of one per gate
+  void set_fuse_online_messages(bool fuse);
+  // send one fused output message per layer and gate type instead of one per output gate
+  void set_fuse_output_messages(bool fuse);
+  // select the transport modes for the setup and the online phase, see NewGateExecutor
+  void set_transport_modes(Communication::TransportMode setup_mode,
+                           Communication::TransportMode online_mode);
+  // share one OT extension round among the BEAVY AND and DOT gates (set before building)
+  void set_batch_ot_preprocessing(bool batch);
+  // share the BEAVY inputs without any message, see BEAVYProvider::set_non_interactive_inputs()
+  // (set by both parties before building)
+  void set_non_interactive_inputs(bool non_interactive);
+  // let the given party do the heavy part of the OT extension of the BEAVY gates, e.g., a server
+  // with a constrained client, see BEAVYProvider::set_strong_party() (set by both parties before
+  // building)
+  void set_beavy_strong_party(std::optional<std::size_t> party_id);
+  // generate the OTs with the given backend, e.g. silent OT (set by both parties before building);
+  // with OTBackend::fake_setup all correlated randomness, i.e. also the MTs, SPs and SBs, is
+  // derived from a fixed key without communication: insecure, only to benchmark the online phase
+  void set_ot_backend(ENCRYPTO::ObliviousTransfer::OTBackend backend);
+  // hand the OTs of a batch to the gates range by range while the OT extension is still running
+  void set_streaming_ot_setup(bool streaming);
+  // keep the base OTs with the peer in `directory` and reuse them re-randomized in later runs
+  // instead of computing new ones, `peer_name` identifies the peer across restarts (set by both
+  // parties before run_preprocessing())
+  void set_base_ot_cache(const std::string& directory, const std::string& peer_name);
+  // exchange the seeds and compute the base OTs in the background right away, s.t. they overlap
+  // with building the circuit instead of delaying its preprocessing (called by both parties after
+  // set_base_ot_cache() and before building)
+  void start_base_ots();
+  // garble the Yao AND gates with the given scheme, e.g. three halves (set by both parties before
+  // building)
+  void set_garbling_scheme(proto::yao::GarblingScheme scheme);
+  // bound the Yao garbled tables in flight to num_blocks blocks and evaluate the online phase of
+  // each gate right after its setup phase, s.t. the evaluator consumes and frees the tables while
+  // the garbler is still garbling, 0 disables it (set by both parties before building)
+  void set_garbled_table_window(std::size_t num_blocks);
+  // run the OTs of all Yao input gates as a single batch and send their keys in a single message,
+  // see YaoProvider::set_batch_input_ots (set by both parties before building)
+  void set_batch_yao_input_ots(bool batch);
+  // generate the shared bits from random OTs with a single message instead of from ACOTs (set by
+  // both parties before building)
+  void set_sbs_from_rots(bool from_rots);
+  // generate the MTs requested by the gates in windows of `window_size` triples in the
+  // background while the circuit is still being built, using the session `session_id` of the
+  // communication layer for their OTs, 0 disables it (set by both parties before building)
+  void set_incremental_preprocessing(std::uint32_t session_id, std::size_t window_size);
+
+  // select the depth- or size-optimized variants of the builtin circuits, e.g., the comparisons of
+  // the maxpool gates, with a CircuitCostModel for the given network (set before building)
+  void set_network_profile(const Communication::NetworkProfile& profile);
+  // measure the network to the other party and call set_network_profile() with the result
+  // (called by both parties at the same time before building)
+  Communication::NetworkProfile measure_network();
+  // refine the analytic costs used by assign_protocols() with the calibration in the JSON file at
+  // `path`, see ProtocolCostModel::calibrate(), an empty path removes it
+  void set_protocol_calibration(const std::string& path) { protocol_calibration_path_ = path; }
+  // choose the cheapest of the given protocols for each node of a mixed circuit on `bit_size` bit
+  // values, using the network of set_network_profile(), and build the result with
+  // make_assigned_circuit() (both parties need the same network profile and calibration)
+  ProtocolAssignment assign_protocols(const std::vector<ProtocolAssignmentNode>& nodes,
+                                      const std::vector<MPCProtocol>& protocols,
+                                      std::size_t bit_size);
+
+  // multiplication triples which are generated ahead of demand and used by the next circuits
+  // before generating new ones, set its capacities by both parties in the same way
+  MTReservoir& get_mt_reservoir() noexcept { return *mt_reservoir_; }
+  // generate the triples missing in the reservoir, e.g., in the idle time between two circuits
+  // (called by both parties while no circuit is built, i.e., before building or after reset())
+  void refill_mt_reservoir();
+  // generate num_ots random OTs in each direction ahead of demand, e.g., in the idle time between
+  // two circuits, s.t. the OT setup of the next circuits only derandomizes them (requires the
+  // silent OT backend, see set_ot_backend(); called by both parties while no circuit is built)
+  void fill_ot_pool(std::size_t num_ots);
+
+  // correlated randomness requested by the circuit built so far, e.g., to save the plan of a dry
+  // run which only builds the circuit (called after building and before run_preprocessing())
+  PreprocessingPlan get_preprocessing_plan() const;
+  // start the preprocessing of a circuit with the given plan before it is built: the capacities of
+  // the MT reservoir are raised to the planned numbers of triples, which are generated right away,
+  // and run_preprocessing() reports if the circuit does not match the plan (called by both
+  // parties while no circuit is built)
+  void prepare_preprocessing(const PreprocessingPlan& plan);
+
+  // the gates of the circuit built so far, e.g., to capture a CircuitTemplate
+  const GateRegister& get_gate_register() const noexcept;
+  // allocate the gate list and the message slots of the providers of the given protocols for a
+  // circuit of num_gates gates which take num_gate_ids gate ids before it is built, see
+  // CircuitTemplate
+  void reserve_circuit(std::size_t num_gates, std::size_t num_gate_ids,
+                       const std::vector<MPCProtocol>& protocols);
+  // take blocks of the given numbers of ids from the counters of the gate register and the
+  // providers for a part of the circuit which is built by another thread within the returned
+  // scope, e.g., with the counts of a tally scope (called by both parties in the same order while
+  // no scope is entered, after reserve_circuit())
+  ConstructionScope reserve_construction_blocks(const ConstructionScope::Counts& counts);
+
+  // predicted depth, critical path and communication of the circuit built so far, e.g., to print
+  // a report instead of running the circuit (called after building)
+  Statistics::CircuitAnalysis analyze_circuit() const;
 
   std::optional<MPCProtocol> convert_via(MPCProtocol src_proto, MPCProtocol dst_proto) override;
   GateFactory& get_gate_factory(MPCProtocol proto) override;
 
+  // group the gate ids into ranges of the given width in the gate profile of the run time stats
+  // (only used if MOTION_GATE_PROFILING is enabled)
+  void set_gate_profiler_range_width(std::size_t width);
+  // write the timeline of the gate phases, messages and waits of all circuits evaluated so far
+  // in the Chrome trace format, see Statistics::TraceRecorder (only if MOTION_TRACING is enabled)
+  void write_chrome_trace(const std::string& path) const;
+
   const Statistics::RunTimeStats& get_run_time_stats() const noexcept;
 
  private:
+  // (re)create the providers that hold per circuit state
+  void make_circuit_providers();
+  // wait for the base OTs started by start_base_ots()
+  void wait_base_ots();
+  // the OTs use OTBackend::fake_setup
+  bool is_fake_setup() const;
+  // the first circuit is about to be evaluated
+  void record_time_to_first_gate();
+  // run() with set_checkpoint()
+  void run_with_checkpoint();
+
   Communication::CommunicationLayer& comm_layer_;
   std::size_t my_id_;
   std::shared_ptr<Logger> logger_;
+  // timeline of this party, only created if MOTION_TRACING is enabled, outlives the threads of the
+  // gate executor which refer to it
+  std::shared_ptr<Statistics::TraceRecorder> trace_recorder_;
   std::unique_ptr<GateRegister> gate_register_;
   std::unique_ptr<NewGateExecutor> gate_executor_;
   std::unique_ptr<CircuitLoader> circuit_loader_;
   std::unordered_map<MPCProtocol, std::reference_wrapper<GateFactory>> gate_factories_;
   std::vector<Statistics::RunTimeStats> run_time_stats_;
+  bool batch_ot_preprocessing_ = false;
+  bool non_interactive_inputs_ = false;
+  std::optional<std::size_t> beavy_strong_party_;
+  // half gates
+  proto::yao::GarblingScheme garbling_scheme_{};
+  std::size_t garbled_table_window_ = 0;
+  bool batch_yao_input_ots_ = false;
+  bool evaluate_asap_ = false;
+  bool sbs_from_rots_ = false;
+  std::string protocol_calibration_path_;
+  // plan passed to prepare_preprocessing() for the current circuit
+  std::unique_ptr<PreprocessingPlan> plan_;
+  // triples of the next chunk of run_chunked(), prefetched after those of the current one
+  std::unique_ptr<PreprocessingPlan> prefetch_plan_;
+  // per gate time and communication, only created if MOTION_GATE_PROFILING is enabled
+  std::unique_ptr<Statistics::GateProfiler> gate_profiler_;
 
   std::unique_ptr<Crypto::MotionBaseProvider> motion_base_provider_;
   std::unique_ptr<BaseOTProvider> base_ot_provider_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::OTProviderManager> ot_manager_;
   std::unique_ptr<ArithmeticProviderManager> arithmetic_manager_;
+  std::unique_ptr<MTReservoir> mt_reservoir_;
   std::unique_ptr<MTProvider> mt_provider_;
   std::unique_ptr<SPProvider> sp_provider_;
   std::unique_ptr<SBProvider> sb_provider_;
@@ -105,6 +315,17 @@ class TwoPartyBackend : public CircuitBuilder {
   std::unique_ptr<proto::beavy::BEAVYProvider> beavy_provider_;
   std::unique_ptr<proto::gmw::GMWProvider> gmw_provider_;
   std::unique_ptr<proto::yao::YaoProvider> yao_provider_;
+
+  // adds the triples of the circuit's windows to mt_reservoir_
+  std::unique_ptr<IncrementalMTPreprocessing> incremental_preprocessing_;
+
+  // set by set_checkpoint(), receives the RunCheckpointCheck message of the other party
+  std::unique_ptr<RunCheckpoint> checkpoint_;
+  std::shared_ptr<Communication::QueueHandler> checkpoint_handler_;
+
+  // seed exchange and base OTs started by start_base_ots()
+  std::future<void> base_ots_future_;
+  bool first_gate_recorded_ = false;
 };
 
 }  // namespace MOTION
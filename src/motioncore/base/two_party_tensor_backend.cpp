@@ -112,6 +112,7 @@ void TwoPartyTensorBackend::run_preprocessing() {
   mt_provider_->PreSetup();
   sp_provider_->PreSetup();
   sb_provider_->PreSetup();
+  linalg_triple_provider_->presetup();
   ot_manager_->run_setup();
   linalg_triple_provider_->setup();
   mt_provider_->Setup();
@@ -125,7 +126,15 @@ void TwoPartyTensorBackend::run_preprocessing() {
 }
 
 void TwoPartyTensorBackend::run() {
-  gate_executor_->evaluate_setup_online(run_time_stats_.back());
+  if (pipeline_lookahead_ > 0) {
+    gate_executor_->evaluate_pipelined(run_time_stats_.back(), pipeline_lookahead_);
+  } else {
+    gate_executor_->evaluate_setup_online(run_time_stats_.back());
+  }
+}
+
+void TwoPartyTensorBackend::set_memory_planning(bool enable) noexcept {
+  gate_executor_->set_memory_planning(enable);
 }
 
 tensor::TensorOpFactory& TwoPartyTensorBackend::get_tensor_op_factory(MPCProtocol proto) {
@@ -149,6 +158,10 @@ std::optional<MPCProtocol> TwoPartyTensorBackend::convert_via(MPCProtocol src_pr
   return std::nullopt;
 }
 
+void TwoPartyTensorBackend::set_yao_tensor_chunk_size(std::size_t num_values) noexcept {
+  yao_provider_->set_tensor_chunk_size(num_values);
+}
+
 const Statistics::RunTimeStats& TwoPartyTensorBackend::get_run_time_stats() const noexcept {
   return run_time_stats_.back();
 }
@@ -83,6 +83,15 @@ class TwoPartyTensorBackend : public tensor::NetworkBuilder {
 
   virtual void run_preprocessing();
   void run();
+  // run the setup of the tensor ops at most `lookahead` ops ahead of their online phase instead of
+  // running all setups first, 0 disables it (set before run())
+  void set_pipelined_execution(std::size_t lookahead) noexcept { pipeline_lookahead_ = lookahead; }
+  // free the intermediate tensors after their last use, see TensorOpExecutor::set_memory_planning()
+  // (set before run(), a tensor read by other ops and after run() needs to be made persistent)
+  void set_memory_planning(bool enable) noexcept;
+  // see YaoProvider::set_tensor_chunk_size() (set by both parties before building)
+  void set_yao_tensor_chunk_size(std::size_t num_values) noexcept;
+  LinAlgTripleProvider& get_linalg_triple_provider() noexcept { return *linalg_triple_provider_; }
 
   tensor::TensorOpFactory& get_tensor_op_factory(MPCProtocol) override;
   std::optional<MPCProtocol> convert_via(MPCProtocol src_proto, MPCProtocol dst_proto) override;
@@ -99,6 +108,7 @@ class TwoPartyTensorBackend : public tensor::NetworkBuilder {
   std::unordered_map<MPCProtocol, std::reference_wrapper<tensor::TensorOpFactory>>
       tensor_op_factories_;
   std::vector<Statistics::RunTimeStats> run_time_stats_;
+  std::size_t pipeline_lookahead_ = 0;
 
   std::unique_ptr<Crypto::MotionBaseProvider> motion_base_provider_;
   std::unique_ptr<BaseOTProvider> base_ot_provider_;
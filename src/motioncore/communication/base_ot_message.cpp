@@ -49,4 +49,14 @@ flatbuffers::FlatBufferBuilder BuildBaseROTMessageSender(std::byte *buffer, std:
   return BuildMessage(MessageType::BaseROTMessageSender, builder.GetBufferPointer(),
                       builder.GetSize());
 }
+
+flatbuffers::FlatBufferBuilder BuildBaseOTCacheCheckMessage(std::byte *buffer, std::size_t size) {
+  flatbuffers::FlatBufferBuilder builder(size + 32);
+  std::vector<std::uint8_t> v_buffer(reinterpret_cast<std::uint8_t *>(buffer),
+                                     reinterpret_cast<std::uint8_t *>(buffer) + size);
+  auto root = CreateBaseROTMessageDirect(builder, 0, &v_buffer);
+  FinishBaseROTMessageBuffer(builder, root);
+  return BuildMessage(MessageType::BaseOTCacheCheck, builder.GetBufferPointer(),
+                      builder.GetSize());
+}
 }  // namespace MOTION::Communication
@@ -33,4 +33,7 @@ flatbuffers::FlatBufferBuilder BuildBaseROTMessageReceiver(std::byte *buffer, st
 
 flatbuffers::FlatBufferBuilder BuildBaseROTMessageSender(std::byte *buffer, std::size_t size,
                                                          std::size_t ot_id);
+
+// identifier of the base OTs found in the cache and a fresh nonce, see BaseOTCache
+flatbuffers::FlatBufferBuilder BuildBaseOTCacheCheckMessage(std::byte *buffer, std::size_t size);
 }  // namespace MOTION::Communication
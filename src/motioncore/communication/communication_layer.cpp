@@ -22,24 +22,43 @@
 
 #include "communication_layer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <span>
 #include <shared_mutex>
 #include <stdexcept>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <variant>
 
+#include <unistd.h>
+
 #include <flatbuffers/flatbuffers.h>
 #include <fmt/format.h>
 
 #include "dummy_transport.h"
+#include "emulated_transport.h"
 #include "message.h"
+#include "message_codec.h"
 #include "message_handler.h"
+#include "shm_transport.h"
 #include "sync_handler.h"
+#include "statistics/metrics.h"
+#include "statistics/trace_recorder.h"
 #include "tcp_transport.h"
+#include "utility/buffer_pool.h"
 #include "utility/constants.h"
 #include "utility/logger.h"
+#include "utility/mpsc_queue.h"
 #include "utility/synchronized_queue.h"
 #include "utility/thread.h"
 
@@ -50,16 +69,28 @@ struct CommunicationLayer::CommunicationLayerImpl {
                          std::shared_ptr<Logger> logger);
   // run in a thread for each party
   void receive_task(std::size_t party_id);
+  void dispatch_task(std::size_t party_id);
   void send_task(std::size_t party_id);
 
-  // setup threads and data structures
-  void initialize(std::size_t my_id, std::size_t num_parties);
-  void send_termination_messages();
+  // pass a verified and decompressed message to the handler of its session
+  void dispatch_message(std::size_t party_id, ENCRYPTO::PooledBuffer&& raw_message);
+  // dispatch the buffered messages of all started sessions
+  void deliver_early_messages(std::size_t party_id);
+  void call_fallback_message_handler(std::size_t party_id, std::uint32_t session_id,
+                                     ENCRYPTO::PooledBuffer&& raw_message);
+
+  // let the threads begin with the communication
+  void start();
+  void open_session(std::uint32_t session_id);
+  void start_session(std::uint32_t session_id);
+  void close_session(std::uint32_t session_id);
   void shutdown();
 
   std::size_t my_id_;
   std::size_t num_parties_;
 
+  std::once_flag start_flag_;
+  std::atomic<bool> is_started_ = false;
   std::promise<void> start_promise_;
   std::shared_future<void> start_sfuture_;
   std::atomic<bool> continue_communication_ = true;
@@ -71,16 +102,89 @@ struct CommunicationLayer::CommunicationLayerImpl {
       std::variant<std::vector<std::uint8_t>, std::shared_ptr<const std::vector<std::uint8_t>>,
                    flatbuffers::DetachedBuffer>;
 
-  std::vector<ENCRYPTO::SynchronizedFiberQueue<message_t>> send_queues_;
+  static std::span<const std::uint8_t> get_raw_message(const message_t&);
+
+  // replace the messages of the batch that compress well by CompressedMessages
+  void compress_batch(std::size_t party_id, std::vector<message_t>& batch, std::uint8_t codecs);
+
+  // Move the bulk messages of the batch to the bulk lane and append up to bulk_chunk_size_ bytes
+  // of the bulk lane to the batch, splitting messages larger than bulk_chunk_size_ into chunks.
+  // bulk_offset is the number of bytes of the first message of the lane sent in earlier chunks.
+  void schedule_bulk_messages(std::vector<message_t>& batch, std::deque<message_t>& bulk_lane,
+                              std::size_t& bulk_offset) const;
+  // see set_bulk_chunk_size()
+  std::size_t bulk_chunk_size_ = 0;
+
+  // written by all gate fibers, drained in batches by the send thread
+  std::vector<ENCRYPTO::MPSCFiberQueue<message_t>> send_queues_;
   std::vector<std::thread> receive_threads_;
+  std::vector<std::thread> dispatch_threads_;
   std::vector<std::thread> send_threads_;
 
+  // received messages waiting for verification and dispatch, the receive thread blocks if the
+  // dispatch thread of the party falls behind by more than this number of messages
+  static constexpr std::size_t receive_queue_capacity = 256;
+  std::vector<std::unique_ptr<ENCRYPTO::BoundedSynchronizedQueue<ENCRYPTO::PooledBuffer>>>
+      receive_queues_;
+  // buffers the transports receive into, they return to the pool after they have been handled
+  std::shared_ptr<ENCRYPTO::BufferPool> receive_buffer_pool_;
+  struct ReceiveQueueStatistics {
+    std::atomic<std::size_t> max_depth = 0;
+    std::atomic<std::size_t> stall_time_us = 0;
+  };
+  std::vector<ReceiveQueueStatistics> receive_queue_stats_;
+
+  // check messages received over in-process transports, see Transport::is_in_process()
+  std::atomic<bool> verify_in_process_messages_ = true;
+
+  // codecs which can be used for messages sent to each party
+  bool message_compression_ = false;
+  std::vector<std::atomic<std::uint8_t>> peer_message_codecs_;
+  struct CompressionStatistics {
+    std::atomic<std::size_t> num_compressed_messages = 0;
+    std::atomic<std::size_t> num_bytes_saved = 0;
+  };
+  std::vector<CompressionStatistics> compression_stats_;
+
+  // live metrics of the connection to each party in the MetricsRegistry
+  struct PartyMetrics {
+    PartyMetrics(std::size_t my_id, std::size_t party_id);
+    Statistics::Counter& num_messages_sent_;
+    Statistics::Counter& num_bytes_sent_;
+    Statistics::Counter& num_messages_received_;
+    Statistics::Counter& num_bytes_received_;
+    Statistics::Gauge& receive_queue_depth_;
+  };
+  std::vector<std::unique_ptr<PartyMetrics>> party_metrics_;
+
+  // copy of the recorder for the events of the send and receive threads
+  std::shared_ptr<Statistics::TraceRecorder> get_trace_recorder();
+  std::mutex trace_recorder_mutex_;
+  std::shared_ptr<Statistics::TraceRecorder> trace_recorder_;
+
   using MessageHandlerMap = std::unordered_map<MessageType, std::shared_ptr<MessageHandler>>;
-  std::shared_mutex message_handlers_mutex_;
-  std::vector<MessageHandlerMap> message_handlers_;
-  std::vector<std::shared_ptr<MessageHandler>> fallback_message_handlers_;
+  struct Session {
+    explicit Session(std::size_t num_parties)
+        : message_handlers_(num_parties),
+          fallback_message_handlers_(num_parties),
+          early_messages_(num_parties) {}
+    std::vector<MessageHandlerMap> message_handlers_;
+    std::vector<std::shared_ptr<MessageHandler>> fallback_message_handlers_;
+    // messages received before the session has been started
+    std::vector<std::vector<ENCRYPTO::PooledBuffer>> early_messages_;
+    // reads the epochs stamped on the compact gate messages of the session
+    std::shared_ptr<SyncHandler> sync_handler_;
+    // a CommunicationLayer object exists for this session
+    bool is_open_ = false;
+    bool is_started_ = false;
+  };
+  Session& get_session(std::uint32_t session_id);
 
-  std::shared_ptr<SyncHandler> sync_handler_;
+  // protects the sessions and their message handlers
+  std::shared_mutex message_handlers_mutex_;
+  std::unordered_map<std::uint32_t, Session> sessions_;
+  // sessions which have been shut down, later messages for them are dropped
+  std::unordered_set<std::uint32_t> closed_sessions_;
 
   std::shared_ptr<Logger> logger_;
 };
@@ -93,70 +197,181 @@ CommunicationLayer::CommunicationLayerImpl::CommunicationLayerImpl(
       start_sfuture_(start_promise_.get_future().share()),
       transports_(std::move(transports)),
       send_queues_(num_parties_),
-      message_handlers_(num_parties_),
-      fallback_message_handlers_(num_parties_),
-      sync_handler_(std::make_shared<SyncHandler>(my_id_, num_parties_, logger)),
+      receive_queues_(num_parties_),
+      receive_buffer_pool_(ENCRYPTO::BufferPool::create()),
+      receive_queue_stats_(num_parties_),
+      peer_message_codecs_(num_parties_),
+      compression_stats_(num_parties_),
+      party_metrics_(num_parties_),
       logger_(std::move(logger)) {
+  // session 0 belongs to the CommunicationLayer owning the connections, no messages are read
+  // before it has been started
+  auto& root_session = get_session(0);
+  root_session.is_open_ = true;
+  root_session.is_started_ = true;
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id) {
       receive_threads_.emplace_back();
+      dispatch_threads_.emplace_back();
       send_threads_.emplace_back();
       continue;
     }
+    receive_queues_.at(party_id) =
+        std::make_unique<ENCRYPTO::BoundedSynchronizedQueue<ENCRYPTO::PooledBuffer>>(
+            receive_queue_capacity);
+    party_metrics_.at(party_id) = std::make_unique<PartyMetrics>(my_id_, party_id);
     receive_threads_.emplace_back([this, party_id] { receive_task(party_id); });
+    dispatch_threads_.emplace_back([this, party_id] { dispatch_task(party_id); });
     send_threads_.emplace_back([this, party_id] { send_task(party_id); });
 
     ENCRYPTO::thread_set_name(receive_threads_.at(party_id),
                               fmt::format("recv-{}<->{}", my_id_, party_id));
+    ENCRYPTO::thread_set_name(dispatch_threads_.at(party_id),
+                              fmt::format("disp-{}<->{}", my_id_, party_id));
     ENCRYPTO::thread_set_name(send_threads_.at(party_id),
                               fmt::format("send-{}<->{}", my_id_, party_id));
   }
 }
 
+namespace {
+
+Statistics::MetricLabels party_metric_labels(std::size_t my_id, std::size_t party_id) {
+  return {{"my_id", std::to_string(my_id)}, {"party_id", std::to_string(party_id)}};
+}
+
+// compact gate messages are only checked for a consistent framing, their payload is interpreted
+// by the gate message handler
+bool is_well_formed(std::span<const std::uint8_t> raw_message) {
+  if (IsCompactGateMessage(raw_message)) {
+    return ParseCompactGateMessage(raw_message).has_value();
+  }
+  flatbuffers::Verifier verifier(raw_message.data(), raw_message.size());
+  return VerifyMessageBuffer(verifier);
+}
+
+// the messages of the OT extensions and base OTs, which are sent in the bulk lane with
+// set_bulk_chunk_size(), and the termination message, which needs to stay behind them
+bool is_bulk_message(std::span<const std::uint8_t> raw_message) {
+  if (IsCompactGateMessage(raw_message)) {
+    return false;
+  }
+  switch (GetMessageTypeAndSessionId(raw_message).first) {
+    case MessageType::BaseROTMessageSender:
+    case MessageType::BaseROTMessageReceiver:
+    case MessageType::OTExtensionReceiverMasks:
+    case MessageType::OTExtensionReceiverCorrections:
+    case MessageType::OTExtensionSender:
+    case MessageType::SilentOTReceiver:
+    case MessageType::SilentOTSender:
+    case MessageType::TerminationMessage:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+CommunicationLayer::CommunicationLayerImpl::PartyMetrics::PartyMetrics(std::size_t my_id,
+                                                                       std::size_t party_id)
+    : num_messages_sent_(Statistics::MetricsRegistry::get_instance().get_counter(
+          "motion_messages_sent_total", "Messages sent to the party",
+          party_metric_labels(my_id, party_id))),
+      num_bytes_sent_(Statistics::MetricsRegistry::get_instance().get_counter(
+          "motion_bytes_sent_total", "Bytes sent to the party",
+          party_metric_labels(my_id, party_id))),
+      num_messages_received_(Statistics::MetricsRegistry::get_instance().get_counter(
+          "motion_messages_received_total", "Messages received from the party",
+          party_metric_labels(my_id, party_id))),
+      num_bytes_received_(Statistics::MetricsRegistry::get_instance().get_counter(
+          "motion_bytes_received_total", "Bytes received from the party",
+          party_metric_labels(my_id, party_id))),
+      receive_queue_depth_(Statistics::MetricsRegistry::get_instance().get_gauge(
+          "motion_receive_queue_depth", "Received messages waiting for the dispatch thread",
+          party_metric_labels(my_id, party_id))) {}
+
+std::shared_ptr<Statistics::TraceRecorder>
+CommunicationLayer::CommunicationLayerImpl::get_trace_recorder() {
+  std::scoped_lock lock(trace_recorder_mutex_);
+  return trace_recorder_;
+}
+
 void CommunicationLayer::CommunicationLayerImpl::send_task(std::size_t party_id) {
   auto& queue = send_queues_.at(party_id);
   auto& transport = *transports_.at(party_id);
+  auto& metrics = *party_metrics_.at(party_id);
 
   auto my_start_sfuture = start_sfuture_;
   my_start_sfuture.get();
 
-  while (!queue.closed_and_empty()) {
-    auto tmp_queue = queue.batch_dequeue();
-    if (!tmp_queue.has_value()) {
-      assert(queue.closed());
-      break;
+  const bool in_process = transport.is_in_process();
+  std::vector<message_t> batch;
+  std::vector<std::span<const std::uint8_t>> buffers;
+  // messages of the batch for an in-process transport, which takes them over
+  std::vector<std::vector<std::uint8_t>> owned_messages;
+  // bulk messages waiting behind the other messages, see set_bulk_chunk_size()
+  std::deque<message_t> bulk_lane;
+  std::size_t bulk_offset = 0;
+  // move the whole batch out of the queue and hand it to the transport at once, such that it can
+  // be written with a single gathering write
+  while (true) {
+    if (bulk_lane.empty()) {
+      if (!queue.batch_dequeue(batch)) {
+        break;
+      }
+    } else {
+      // only pick up the messages sent in the meantime, the bulk lane has more to send
+      queue.try_batch_dequeue(batch);
+    }
+    if (bulk_chunk_size_ > 0) {
+      schedule_bulk_messages(batch, bulk_lane, bulk_offset);
     }
-    while (!tmp_queue->empty()) {
-      auto& message = tmp_queue->front();
-      if (message.index() == 0) {
-        // std::vector<std::uint8_t>
-        transport.send_message(std::get<0>(message));
-      } else if (message.index() == 1) {
-        // std::shared_ptr<const std::vector<std::uint8_t>>
-        transport.send_message(*std::get<1>(message));
-      } else if (message.index() == 2) {
-        // flatbuffers::DetachedBuffer
-        const auto& detached_buffer = std::get<2>(message);
-        transport.send_message(detached_buffer.data(), detached_buffer.size());
+    const auto message_codecs = peer_message_codecs_.at(party_id).load();
+    if (message_codecs != 0) {
+      compress_batch(party_id, batch, message_codecs);
+    }
+    buffers.clear();
+    if (in_process) {
+      // vectors are moved, only shared messages and flatbuffers need to be copied
+      owned_messages.clear();
+      owned_messages.reserve(batch.size());
+      for (auto& message : batch) {
+        if (message.index() == 0) {
+          owned_messages.emplace_back(std::move(std::get<0>(message)));
+        } else if (message.index() == 1) {
+          owned_messages.emplace_back(*std::get<1>(message));
+        } else if (message.index() == 2) {
+          const auto& detached_buffer = std::get<2>(message);
+          owned_messages.emplace_back(detached_buffer.data(),
+                                      detached_buffer.data() + detached_buffer.size());
+        }
+        buffers.emplace_back(owned_messages.back());
       }
-      if (logger_) {
+    } else {
+      for (const auto& message : batch) {
+        if (message.index() == 0) {
+          // std::vector<std::uint8_t>
+          buffers.emplace_back(std::get<0>(message));
+        } else if (message.index() == 1) {
+          // std::shared_ptr<const std::vector<std::uint8_t>>
+          buffers.emplace_back(*std::get<1>(message));
+        } else if (message.index() == 2) {
+          // flatbuffers::DetachedBuffer
+          const auto& detached_buffer = std::get<2>(message);
+          buffers.emplace_back(detached_buffer.data(), detached_buffer.size());
+        }
+      }
+    }
+    // logged before sending, since an in-process transport passes the buffers on to the receiver
+    if (logger_) {
+      for (const auto& buffer : buffers) {
         if constexpr (MOTION_DEBUG) {
-          const std::uint8_t* raw_message = nullptr;
-          std::size_t message_size = 0;
-          if (message.index() == 0) {
-            // std::vector<std::uint8_t>
-            raw_message = std::get<0>(message).data();
-            message_size = std::get<0>(message).size();
-          } else if (message.index() == 1) {
-            raw_message = std::get<1>(message)->data();
-            message_size = std::get<1>(message)->size();
-          } else if (message.index() == 2) {
-            raw_message = std::get<2>(message).data();
-            message_size = std::get<2>(message).size();
-          }
-          flatbuffers::Verifier verifier(raw_message, message_size);
-          if (VerifyMessageBuffer(verifier)) {
-            auto fb_message = GetMessage(raw_message);
+          flatbuffers::Verifier verifier(buffer.data(), buffer.size());
+          if (auto compact = ParseCompactGateMessage(buffer)) {
+            logger_->LogDebug(fmt::format("Sent message of type {} to party {}",
+                                          EnumNameMessageType(compact->message_type), party_id));
+          } else if (VerifyMessageBuffer(verifier)) {
+            auto fb_message = GetMessage(buffer.data());
             auto message_type = fb_message->message_type();
             logger_->LogDebug(fmt::format("Sent message of type {} to party {}",
                                           EnumNameMessageType(message_type), party_id));
@@ -168,7 +383,37 @@ void CommunicationLayer::CommunicationLayerImpl::send_task(std::size_t party_id)
           logger_->LogDebug(fmt::format("Sent message to party {}", party_id));
         }
       }
-      tmp_queue->pop();
+    }
+    std::shared_ptr<Statistics::TraceRecorder> trace_recorder;
+    Statistics::TraceRecorder::clock_type::time_point send_start;
+    if constexpr (MOTION_TRACING) {
+      trace_recorder = get_trace_recorder();
+      send_start = Statistics::TraceRecorder::clock_type::now();
+    }
+    if (in_process) {
+      for (auto& message : owned_messages) {
+        transport.send_message(std::move(message));
+      }
+    } else if (buffers.size() == 1) {
+      transport.send_message(buffers.front().data(), buffers.front().size());
+    } else {
+      transport.send_messages(buffers);
+    }
+    metrics.num_messages_sent_.increment(buffers.size());
+    for (const auto& buffer : buffers) {
+      metrics.num_bytes_sent_.increment(buffer.size());
+    }
+    if constexpr (MOTION_TRACING) {
+      if (trace_recorder != nullptr) {
+        std::size_t num_bytes = 0;
+        for (const auto& buffer : buffers) {
+          num_bytes += buffer.size();
+        }
+        trace_recorder->record(
+            "send", "communication", send_start, Statistics::TraceRecorder::clock_type::now(),
+            fmt::format("\"party_id\":{},\"num_messages\":{},\"num_bytes\":{}", party_id,
+                        buffers.size(), num_bytes));
+      }
     }
   }
 
@@ -179,17 +424,103 @@ void CommunicationLayer::CommunicationLayerImpl::send_task(std::size_t party_id)
   }
 }
 
+std::span<const std::uint8_t> CommunicationLayer::CommunicationLayerImpl::get_raw_message(
+    const message_t& message) {
+  if (message.index() == 0) {
+    return std::get<0>(message);
+  } else if (message.index() == 1) {
+    return *std::get<1>(message);
+  }
+  const auto& detached_buffer = std::get<2>(message);
+  return std::span(detached_buffer.data(), detached_buffer.size());
+}
+
+void CommunicationLayer::CommunicationLayerImpl::schedule_bulk_messages(
+    std::vector<message_t>& batch, std::deque<message_t>& bulk_lane,
+    std::size_t& bulk_offset) const {
+  auto bulk_begin = std::stable_partition(std::begin(batch), std::end(batch), [](const auto& m) {
+    return !is_bulk_message(get_raw_message(m));
+  });
+  std::move(bulk_begin, std::end(batch), std::back_inserter(bulk_lane));
+  batch.erase(bulk_begin, std::end(batch));
+
+  auto budget = bulk_chunk_size_;
+  while (!bulk_lane.empty() && budget > 0) {
+    auto& message = bulk_lane.front();
+    const auto raw_message = get_raw_message(message);
+    if (bulk_offset == 0 && raw_message.size() <= budget) {
+      budget -= raw_message.size();
+      batch.emplace_back(std::move(message));
+      bulk_lane.pop_front();
+      continue;
+    }
+    if (bulk_offset == 0 && raw_message.size() <= bulk_chunk_size_) {
+      // send it as a whole in the next round
+      break;
+    }
+    const auto chunk_size = std::min(budget, raw_message.size() - bulk_offset);
+    const bool last_chunk = bulk_offset + chunk_size == raw_message.size();
+    batch.emplace_back(
+        BuildMessage(last_chunk ? MessageType::LastMessageChunk : MessageType::MessageChunk,
+                     raw_message.data() + bulk_offset, chunk_size)
+            .Release());
+    budget -= chunk_size;
+    if (last_chunk) {
+      bulk_lane.pop_front();
+      bulk_offset = 0;
+    } else {
+      bulk_offset += chunk_size;
+    }
+  }
+}
+
+void CommunicationLayer::CommunicationLayerImpl::compress_batch(std::size_t party_id,
+                                                                std::vector<message_t>& batch,
+                                                                std::uint8_t codecs) {
+  auto& stats = compression_stats_.at(party_id);
+  for (auto& message : batch) {
+    std::span<const std::uint8_t> raw_message;
+    if (message.index() == 0) {
+      raw_message = std::get<0>(message);
+    } else if (message.index() == 1) {
+      raw_message = *std::get<1>(message);
+    } else if (message.index() == 2) {
+      const auto& detached_buffer = std::get<2>(message);
+      raw_message = std::span(detached_buffer.data(), detached_buffer.size());
+    }
+    auto payload = compress_message(raw_message, codecs);
+    if (!payload.has_value()) {
+      continue;
+    }
+    auto compressed_message = BuildMessage(MessageType::CompressedMessage, &*payload).Release();
+    if (compressed_message.size() >= raw_message.size()) {
+      continue;
+    }
+    stats.num_compressed_messages += 1;
+    stats.num_bytes_saved += raw_message.size() - compressed_message.size();
+    message = std::move(compressed_message);
+  }
+}
+
 void CommunicationLayer::CommunicationLayerImpl::receive_task(std::size_t party_id) {
   auto& transport = *transports_.at(party_id);
-  auto& handler_map = message_handlers_.at(party_id);
+  auto& queue = *receive_queues_.at(party_id);
+  auto& queue_stats = receive_queue_stats_.at(party_id);
+  auto& metrics = *party_metrics_.at(party_id);
 
   auto my_start_sfuture = start_sfuture_;
   my_start_sfuture.get();
 
+  // only read from the socket here, verification and dispatch happen in dispatch_task such that
+  // large messages do not stall the socket
   while (continue_communication_) {
-    std::optional<std::vector<std::uint8_t>> raw_message_opt;
+    std::optional<ENCRYPTO::PooledBuffer> raw_message_opt;
+    Statistics::TraceRecorder::clock_type::time_point receive_start;
+    if constexpr (MOTION_TRACING) {
+      receive_start = Statistics::TraceRecorder::clock_type::now();
+    }
     try {
-      raw_message_opt = transport.receive_message();
+      raw_message_opt = transport.receive_pooled_message(*receive_buffer_pool_);
     } catch (std::runtime_error& e) {
       if (logger_) {
         logger_->LogError(
@@ -198,36 +529,116 @@ void CommunicationLayer::CommunicationLayerImpl::receive_task(std::size_t party_
       break;
     }
     if (!raw_message_opt.has_value()) {
-      // underlying transport was closed unexpectedly
-      if (logger_) {
-        logger_->LogError(
-            fmt::format("underlying transport was closed unexpectedly from party {}", party_id));
-      }
+      // underlying transport was closed, dispatch_task checks if this was expected
       break;
     }
+    metrics.num_messages_received_.increment();
+    metrics.num_bytes_received_.increment(raw_message_opt->size());
+    if constexpr (MOTION_TRACING) {
+      // includes the time waiting for the message
+      if (auto trace_recorder = get_trace_recorder(); trace_recorder != nullptr) {
+        trace_recorder->record(
+            "receive", "communication", receive_start,
+            Statistics::TraceRecorder::clock_type::now(),
+            fmt::format("\"party_id\":{},\"num_bytes\":{}", party_id, raw_message_opt->size()));
+      }
+    }
+    auto depth = queue.try_enqueue(*raw_message_opt);
+    if (!depth.has_value()) {
+      const auto stall_start = std::chrono::steady_clock::now();
+      depth = queue.enqueue(std::move(*raw_message_opt));
+      const auto stall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - stall_start);
+      queue_stats.stall_time_us += stall_time.count();
+    }
+    if (*depth > queue_stats.max_depth) {
+      queue_stats.max_depth = *depth;
+    }
+    metrics.receive_queue_depth_.set(*depth);
+  }
+  queue.close();
+
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug(fmt::format("receive_task finished for party {}", party_id));
+    }
+  }
+}
+
+void CommunicationLayer::CommunicationLayerImpl::dispatch_task(std::size_t party_id) {
+  auto& queue = *receive_queues_.at(party_id);
+  auto& metrics = *party_metrics_.at(party_id);
+  const bool in_process = transports_.at(party_id)->is_in_process();
+
+  bool terminated = false;
+  // payloads of the MessageChunks received so far, see set_bulk_chunk_size()
+  std::vector<std::uint8_t> chunks;
+  while (auto raw_message_opt = queue.dequeue()) {
     auto raw_message = std::move(*raw_message_opt);
+    metrics.receive_queue_depth_.set(queue.size());
 
-    flatbuffers::Verifier verifier(reinterpret_cast<std::uint8_t*>(raw_message.data()),
-                                   raw_message.size());
-    if (!VerifyMessageBuffer(verifier)) {
+    if (raw_message.empty()) {
+      // enqueued by start_session when a session with buffered messages has been started
+      deliver_early_messages(party_id);
+      continue;
+    }
+
+    if ((!in_process || verify_in_process_messages_) && !is_well_formed(raw_message.span())) {
       if (logger_) {
         logger_->LogError(fmt::format("received corrupt message from party {}", party_id));
       }
-      auto fbh = fallback_message_handlers_.at(party_id);
-      if (fbh) {
-        fbh->received_message(party_id, std::move(raw_message));
-      }
+      call_fallback_message_handler(party_id, 0, std::move(raw_message));
       continue;
     }
 
-    // XXX: maybe use a separate thread for this
-    auto message = GetMessage(raw_message.data());
-
-    auto message_type = message->message_type();
+    auto [message_type, session_id] = GetMessageTypeAndSessionId(raw_message.span());
+    if (message_type == MessageType::CompressedMessage) {
+      try {
+        const auto* payload = GetMessage(raw_message.data())->payload();
+        if (payload == nullptr) {
+          throw std::runtime_error("compressed message: missing payload");
+        }
+        raw_message = receive_buffer_pool_->adopt(
+            decompress_message(std::span(payload->data(), payload->size())));
+      } catch (std::runtime_error& e) {
+        if (logger_) {
+          logger_->LogError(fmt::format("received corrupt compressed message from party {}: {}",
+                                        party_id, e.what()));
+        }
+        continue;
+      }
+      if (!is_well_formed(raw_message.span())) {
+        if (logger_) {
+          logger_->LogError(fmt::format("received corrupt message from party {}", party_id));
+        }
+        call_fallback_message_handler(party_id, 0, std::move(raw_message));
+        continue;
+      }
+      std::tie(message_type, session_id) = GetMessageTypeAndSessionId(raw_message.span());
+    }
+    if (message_type == MessageType::MessageChunk ||
+        message_type == MessageType::LastMessageChunk) {
+      if (const auto* payload = GetMessage(raw_message.data())->payload(); payload != nullptr) {
+        chunks.insert(std::end(chunks), payload->begin(), payload->end());
+      }
+      if (message_type == MessageType::MessageChunk) {
+        continue;
+      }
+      raw_message = receive_buffer_pool_->adopt(std::exchange(chunks, {}));
+      if (!is_well_formed(raw_message.span())) {
+        if (logger_) {
+          logger_->LogError(
+              fmt::format("received corrupt chunked message from party {}", party_id));
+        }
+        call_fallback_message_handler(party_id, 0, std::move(raw_message));
+        continue;
+      }
+      std::tie(message_type, session_id) = GetMessageTypeAndSessionId(raw_message.span());
+    }
     if constexpr (MOTION_DEBUG) {
       if (logger_) {
-        logger_->LogDebug(fmt::format("received message of type {} from party {}",
-                                      EnumNameMessageType(message_type), party_id));
+        logger_->LogDebug(fmt::format("received message of type {} for session {} from party {}",
+                                      EnumNameMessageType(message_type), session_id, party_id));
       }
     }
     if (message_type == MessageType::TerminationMessage) {
@@ -236,31 +647,167 @@ void CommunicationLayer::CommunicationLayerImpl::receive_task(std::size_t party_
           logger_->LogDebug(fmt::format("received termination message from party {}", party_id));
         }
       }
+      terminated = true;
       break;
     }
+    dispatch_message(party_id, std::move(raw_message));
+  }
+
+  if (!terminated) {
+    if (logger_) {
+      logger_->LogError(
+          fmt::format("underlying transport was closed unexpectedly from party {}", party_id));
+    }
+  }
+  // discard everything after the termination message such that receive_task cannot block
+  while (queue.dequeue().has_value()) {
+  }
+
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug(fmt::format("dispatch_task finished for party {}", party_id));
+    }
+  }
+}
+
+void CommunicationLayer::CommunicationLayerImpl::dispatch_message(
+    std::size_t party_id, ENCRYPTO::PooledBuffer&& raw_message) {
+  const auto [message_type, session_id] = GetMessageTypeAndSessionId(raw_message.span());
+  {
     std::shared_lock lock(message_handlers_mutex_);
-    auto it = handler_map.find(message_type);
-    if (it != handler_map.end()) {
-      it->second->received_message(party_id, std::move(raw_message));
-    } else {
-      auto fbh = fallback_message_handlers_.at(party_id);
-      if (fbh) {
-        fbh->received_message(party_id, std::move(raw_message));
+    auto session_it = sessions_.find(session_id);
+    // messages buffered earlier need to be delivered first to keep the order
+    if (session_it != sessions_.end() && session_it->second.is_started_ &&
+        session_it->second.early_messages_.at(party_id).empty()) {
+      auto& session = session_it->second;
+      if (session.sync_handler_ != nullptr && IsCompactGateMessage(raw_message.span())) {
+        session.sync_handler_->received_epoch(
+            party_id, raw_message.span()[compact_gate_message_sync_epoch_offset]);
       }
+      auto& handler_map = session.message_handlers_.at(party_id);
+      auto it = handler_map.find(message_type);
+      if (it != handler_map.end()) {
+        it->second->received_pooled_message(party_id, std::move(raw_message));
+      } else {
+        auto fbh = session.fallback_message_handlers_.at(party_id);
+        if (fbh) {
+          fbh->received_pooled_message(party_id, std::move(raw_message));
+        }
+        if (logger_) {
+          logger_->LogError(fmt::format("dropping message of type {} for session {} from party {}",
+                                        EnumNameMessageType(message_type), session_id, party_id));
+        }
+      }
+      return;
+    }
+  }
+
+  bool deliver_now = false;
+  {
+    std::scoped_lock lock(message_handlers_mutex_);
+    if (closed_sessions_.contains(session_id)) {
       if (logger_) {
-        logger_->LogError(fmt::format("dropping message of type {} from party {}",
-                                      EnumNameMessageType(message_type), party_id));
+        logger_->LogError(
+            fmt::format("dropping message of type {} for closed session {} from party {}",
+                        EnumNameMessageType(message_type), session_id, party_id));
       }
+      return;
     }
+    auto& session = get_session(session_id);
+    session.early_messages_.at(party_id).emplace_back(std::move(raw_message));
+    // the session may have been started since the check above
+    deliver_now = session.is_started_;
   }
+  if (deliver_now) {
+    deliver_early_messages(party_id);
+  }
+}
 
-  if constexpr (MOTION_DEBUG) {
-    if (logger_) {
-      logger_->LogDebug(fmt::format("receive_task finished for party {}", party_id));
+void CommunicationLayer::CommunicationLayerImpl::deliver_early_messages(std::size_t party_id) {
+  std::vector<ENCRYPTO::PooledBuffer> messages;
+  {
+    std::scoped_lock lock(message_handlers_mutex_);
+    for (auto& [session_id, session] : sessions_) {
+      if (!session.is_started_) {
+        continue;
+      }
+      auto& early_messages = session.early_messages_.at(party_id);
+      std::move(std::begin(early_messages), std::end(early_messages),
+                std::back_inserter(messages));
+      early_messages.clear();
+    }
+  }
+  // only this thread dispatches messages from this party, so no newer message can overtake them
+  for (auto& message : messages) {
+    dispatch_message(party_id, std::move(message));
+  }
+}
+
+void CommunicationLayer::CommunicationLayerImpl::call_fallback_message_handler(
+    std::size_t party_id, std::uint32_t session_id, ENCRYPTO::PooledBuffer&& raw_message) {
+  std::shared_lock lock(message_handlers_mutex_);
+  auto session_it = sessions_.find(session_id);
+  if (session_it == sessions_.end()) {
+    return;
+  }
+  auto fbh = session_it->second.fallback_message_handlers_.at(party_id);
+  if (fbh) {
+    fbh->received_pooled_message(party_id, std::move(raw_message));
+  }
+}
+
+CommunicationLayer::CommunicationLayerImpl::Session&
+CommunicationLayer::CommunicationLayerImpl::get_session(std::uint32_t session_id) {
+  return sessions_.try_emplace(session_id, num_parties_).first->second;
+}
+
+void CommunicationLayer::CommunicationLayerImpl::start() {
+  std::call_once(start_flag_, [this] {
+    is_started_ = true;
+    start_promise_.set_value();
+  });
+}
+
+void CommunicationLayer::CommunicationLayerImpl::open_session(std::uint32_t session_id) {
+  std::scoped_lock lock(message_handlers_mutex_);
+  if (closed_sessions_.contains(session_id)) {
+    throw std::invalid_argument(fmt::format("session {} has already been closed", session_id));
+  }
+  auto& session = get_session(session_id);
+  if (session.is_open_) {
+    throw std::invalid_argument(fmt::format("session {} is already in use", session_id));
+  }
+  session.is_open_ = true;
+}
+
+void CommunicationLayer::CommunicationLayerImpl::start_session(std::uint32_t session_id) {
+  std::vector<std::size_t> parties_with_early_messages;
+  {
+    std::scoped_lock lock(message_handlers_mutex_);
+    auto& session = get_session(session_id);
+    session.is_started_ = true;
+    for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+      if (!session.early_messages_.at(party_id).empty()) {
+        parties_with_early_messages.push_back(party_id);
+      }
+    }
+  }
+  // wake up the dispatch threads, such that they deliver the buffered messages in order
+  for (auto party_id : parties_with_early_messages) {
+    try {
+      receive_queues_.at(party_id)->enqueue({});
+    } catch (std::logic_error&) {
+      // the connection has already been closed
     }
   }
 }
 
+void CommunicationLayer::CommunicationLayerImpl::close_session(std::uint32_t session_id) {
+  std::scoped_lock lock(message_handlers_mutex_);
+  sessions_.erase(session_id);
+  closed_sessions_.insert(session_id);
+}
+
 void CommunicationLayer::CommunicationLayerImpl::shutdown() {
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
@@ -274,10 +821,36 @@ void CommunicationLayer::CommunicationLayerImpl::shutdown() {
     }
     send_threads_.at(party_id).join();
     receive_threads_.at(party_id).join();
+    dispatch_threads_.at(party_id).join();
     transports_.at(party_id)->shutdown();
   }
 }
 
+namespace {
+
+// copy the message and set its session_id, for messages which have not been created with
+// BuildMessage and thus cannot be changed in place
+std::vector<std::uint8_t> rebuild_message(std::span<const std::uint8_t> raw_message,
+                                          std::uint32_t session_id) {
+  const auto* message = GetMessage(raw_message.data());
+  const auto* payload = message->payload();
+  auto message_builder =
+      payload == nullptr
+          ? BuildMessage(message->message_type(), nullptr, session_id)
+          : BuildMessage(message->message_type(), payload->data(), payload->size(), session_id);
+  auto message_detached = message_builder.Release();
+  return std::vector<std::uint8_t>(message_detached.data(),
+                                   message_detached.data() + message_detached.size());
+}
+
+void set_session_id(std::vector<std::uint8_t>& message, std::uint32_t session_id) {
+  if (session_id != 0 && !SetMessageSessionId(message.data(), session_id)) {
+    message = rebuild_message(message, session_id);
+  }
+}
+
+}  // namespace
+
 CommunicationLayer::CommunicationLayer(std::size_t my_id,
                                        std::vector<std::unique_ptr<Transport>>&& transports)
     : CommunicationLayer(my_id, std::move(transports), nullptr) {}
@@ -287,7 +860,9 @@ CommunicationLayer::CommunicationLayer(std::size_t my_id,
                                        std::shared_ptr<Logger> logger)
     : my_id_(my_id),
       num_parties_(transports.size()),
-      impl_(std::make_unique<CommunicationLayerImpl>(my_id, std::move(transports), logger)),
+      session_id_(0),
+      impl_(std::make_shared<CommunicationLayerImpl>(my_id, std::move(transports), logger)),
+      sync_handler_(std::make_shared<SyncHandler>(my_id_, num_parties_, logger)),
       is_started_(false),
       is_shutdown_(false),
       logger_(std::move(logger)) {
@@ -299,12 +874,47 @@ CommunicationLayer::CommunicationLayer(std::size_t my_id,
     throw std::invalid_argument(
         fmt::format("speficied invalid party id: {} >= {}", my_id, num_parties_));
   }
-  register_message_handler([this](auto) { return impl_->sync_handler_; },
+  register_message_handler([this](auto) { return sync_handler_; },
+                           {MessageType::SynchronizationMessage});
+  sync_handler_->set_flush_function(
+      [this](std::size_t party_id) { send_sync_message(party_id); });
+  {
+    std::scoped_lock lock(impl_->message_handlers_mutex_);
+    impl_->sessions_.at(session_id_).sync_handler_ = sync_handler_;
+  }
+}
+
+CommunicationLayer::CommunicationLayer(CommunicationLayer& parent, std::uint32_t session_id)
+    : my_id_(parent.my_id_),
+      num_parties_(parent.num_parties_),
+      session_id_(session_id),
+      impl_(parent.impl_),
+      sync_handler_(std::make_shared<SyncHandler>(my_id_, num_parties_, parent.logger_)),
+      is_started_(false),
+      is_shutdown_(false),
+      logger_(parent.logger_) {
+  if (session_id == 0) {
+    throw std::invalid_argument("session id 0 is reserved for the parent CommunicationLayer");
+  }
+  impl_->open_session(session_id);
+  register_message_handler([this](auto) { return sync_handler_; },
                            {MessageType::SynchronizationMessage});
+  sync_handler_->set_flush_function(
+      [this](std::size_t party_id) { send_sync_message(party_id); });
+  {
+    std::scoped_lock lock(impl_->message_handlers_mutex_);
+    impl_->sessions_.at(session_id_).sync_handler_ = sync_handler_;
+  }
 }
 
 CommunicationLayer::~CommunicationLayer() {
   deregister_message_handler({MessageType::SynchronizationMessage});
+  {
+    std::scoped_lock lock(impl_->message_handlers_mutex_);
+    if (auto it = impl_->sessions_.find(session_id_); it != impl_->sessions_.end()) {
+      it->second.sync_handler_.reset();
+    }
+  }
   shutdown();
 }
 
@@ -313,16 +923,22 @@ void CommunicationLayer::start() {
     sync();
     return;
   }
-  impl_->start_promise_.set_value();
+  impl_->start();
+  if (session_id_ != 0) {
+    impl_->start_session(session_id_);
+  }
   if constexpr (MOTION_DEBUG) {
     if (logger_) {
+      std::shared_lock lock(impl_->message_handlers_mutex_);
+      const auto& session = impl_->sessions_.at(session_id_);
       for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
         if (party_id == my_id_) {
           continue;
         }
-        for (auto& [type, h] : impl_->message_handlers_.at(party_id)) {
-          logger_->LogDebug(fmt::format("message_handler installed for party {}, type {}", party_id,
-                                        EnumNameMessageType(type)));
+        for (auto& [type, h] : session.message_handlers_.at(party_id)) {
+          logger_->LogDebug(
+              fmt::format("message_handler installed for session {}, party {}, type {}",
+                          session_id_, party_id, EnumNameMessageType(type)));
         }
       }
     }
@@ -330,27 +946,39 @@ void CommunicationLayer::start() {
   is_started_ = true;
 }
 
-void CommunicationLayer::sync() {
+void CommunicationLayer::sync() { sync(0, lazy_sync_); }
+
+void CommunicationLayer::sync(std::size_t padding, bool lazy) {
   if constexpr (MOTION_DEBUG) {
     if (logger_) {
       logger_->LogDebug("start synchronization");
     }
   }
-  auto& sync_handler = *impl_->sync_handler_;
+  auto& sync_handler = *sync_handler_;
   // synchronize s.t. this method cannot be executed simultaneously
   std::scoped_lock lock(sync_handler.get_mutex());
   // increment counter
-  std::uint64_t new_sync_state = sync_handler.increment_my_sync_state();
+  sync_handler.increment_my_sync_state();
+  if (lazy && sync_handler.others_reached()) {
+    // we are the last party, our state is stamped on our next gate messages
+    if constexpr (MOTION_DEBUG) {
+      if (logger_) {
+        logger_->LogDebug("finished synchronization without a message");
+      }
+    }
+    return;
+  }
   // broadcast sync message with counter value
-  {
-    const std::vector<std::uint8_t> v(
-        reinterpret_cast<std::uint8_t*>(&new_sync_state),
-        reinterpret_cast<std::uint8_t*>(&new_sync_state) + sizeof(new_sync_state));
-    auto message_builder = BuildMessage(MessageType::SynchronizationMessage, &v);
-    broadcast_message(std::move(message_builder));
+  send_sync_message(std::nullopt, padding);
+  // wait for N-1 sync messages or stamped gate messages with at least the same value
+  if (lazy) {
+    while (!sync_handler.wait_for(lazy_sync_timeout_)) {
+      // the parties which have already arrived send our state back if they have not yet told us
+      send_sync_message(std::nullopt);
+    }
+  } else {
+    sync_handler.wait();
   }
-  // wait for N-1 sync messages with at least the same value
-  sync_handler.wait();
   if constexpr (MOTION_DEBUG) {
     if (logger_) {
       logger_->LogDebug("finished synchronization");
@@ -358,23 +986,101 @@ void CommunicationLayer::sync() {
   }
 }
 
+void CommunicationLayer::send_sync_message(std::optional<std::size_t> party_id,
+                                           std::size_t padding) {
+  std::uint64_t sync_state = sync_handler_->get_my_sync_state();
+  std::vector<std::uint8_t> v(reinterpret_cast<std::uint8_t*>(&sync_state),
+                              reinterpret_cast<std::uint8_t*>(&sync_state) + sizeof(sync_state));
+  // random padding, such that it is not compressed away
+  std::minstd_rand random_engine;
+  std::generate_n(std::back_inserter(v), padding,
+                  [&random_engine] { return static_cast<std::uint8_t>(random_engine()); });
+  auto message_builder = BuildMessage(MessageType::SynchronizationMessage, &v, session_id_);
+  if (party_id.has_value()) {
+    send_message(*party_id, std::move(message_builder));
+  } else {
+    sync_handler_->mark_announced();
+    broadcast_message(std::move(message_builder));
+  }
+}
+
+void CommunicationLayer::set_lazy_sync(bool lazy, std::chrono::microseconds timeout) {
+  lazy_sync_ = lazy;
+  lazy_sync_timeout_ = timeout;
+}
+
+NetworkProfile CommunicationLayer::measure_network(std::size_t num_rounds,
+                                                   std::size_t probe_size) {
+  if (num_rounds == 0) {
+    throw std::invalid_argument("need at least one round to measure the network");
+  }
+  const auto measure = [this, num_rounds](std::size_t padding) {
+    std::vector<std::chrono::duration<double>> durations(num_rounds);
+    for (auto& duration : durations) {
+      const auto start = std::chrono::steady_clock::now();
+      // the measurement needs explicit messages
+      sync(padding, false);
+      duration = std::chrono::steady_clock::now() - start;
+    }
+    std::nth_element(std::begin(durations), std::begin(durations) + num_rounds / 2,
+                     std::end(durations));
+    return durations[num_rounds / 2];
+  };
+  // start all parties at the same time
+  sync(0, false);
+  // in a sequence of synchronizations, each waits for the messages sent at the end of the
+  // previous one by the other parties, i.e., it takes one way
+  const auto one_way_time = measure(0);
+  const auto probe_time = measure(probe_size);
+
+  NetworkProfile profile;
+  profile.name = "measured";
+  profile.round_trip_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(2 * one_way_time);
+  if (probe_time > one_way_time) {
+    profile.bandwidth =
+        static_cast<std::uint64_t>(8 * probe_size / (probe_time - one_way_time).count());
+  }
+  if (logger_) {
+    logger_->LogInfo(fmt::format("measured network: {}", to_string(profile)));
+  }
+  return profile;
+}
+
 void CommunicationLayer::send_message(std::size_t party_id, std::vector<std::uint8_t>&& message) {
+  if (IsCompactGateMessage(message)) {
+    message.at(compact_gate_message_sync_epoch_offset) = sync_handler_->stamp_epoch(party_id);
+  }
+  set_session_id(message, session_id_);
   impl_->send_queues_.at(party_id).enqueue(std::move(message));
 }
 
 void CommunicationLayer::send_message(std::size_t party_id,
                                       const std::vector<std::uint8_t>& message) {
+  if (session_id_ != 0) {
+    send_message(party_id, std::vector<std::uint8_t>(message));
+    return;
+  }
   impl_->send_queues_.at(party_id).enqueue(message);
 }
 
 void CommunicationLayer::send_message(std::size_t party_id,
                                       std::shared_ptr<const std::vector<std::uint8_t>> message) {
+  if (session_id_ != 0) {
+    send_message(party_id, std::vector<std::uint8_t>(*message));
+    return;
+  }
   impl_->send_queues_.at(party_id).enqueue(std::move(message));
 }
 
 void CommunicationLayer::send_message(std::size_t party_id,
                                       flatbuffers::FlatBufferBuilder&& message_builder) {
   auto message_detached = message_builder.Release();
+  if (session_id_ != 0 && !SetMessageSessionId(message_detached.data(), session_id_)) {
+    impl_->send_queues_.at(party_id).enqueue(
+        rebuild_message(std::span(message_detached.data(), message_detached.size()), session_id_));
+    return;
+  }
   impl_->send_queues_.at(party_id).enqueue(std::move(message_detached));
 }
 
@@ -383,11 +1089,25 @@ void CommunicationLayer::broadcast_message(std::vector<std::uint8_t>&& message)
     send_message(1 - my_id_, std::move(message));
     return;
   }
-  broadcast_message(std::make_shared<std::vector<std::uint8_t>>(std::move(message)));
+  if (IsCompactGateMessage(message)) {
+    message.at(compact_gate_message_sync_epoch_offset) = sync_handler_->stamp_epoch();
+  }
+  set_session_id(message, session_id_);
+  auto shared_message = std::make_shared<const std::vector<std::uint8_t>>(std::move(message));
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (party_id == my_id_) {
+      continue;
+    }
+    impl_->send_queues_.at(party_id).enqueue(shared_message);
+  }
 }
 
 // TODO: prevent unnecessary copies
 void CommunicationLayer::broadcast_message(const std::vector<std::uint8_t>& message) {
+  if (session_id_ != 0) {
+    broadcast_message(std::vector<std::uint8_t>(message));
+    return;
+  }
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
       continue;
@@ -398,6 +1118,10 @@ void CommunicationLayer::broadcast_message(const std::vector<std::uint8_t>& mess
 
 void CommunicationLayer::broadcast_message(
     std::shared_ptr<const std::vector<std::uint8_t>> message) {
+  if (session_id_ != 0) {
+    broadcast_message(std::vector<std::uint8_t>(*message));
+    return;
+  }
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
       continue;
@@ -409,23 +1133,20 @@ void CommunicationLayer::broadcast_message(
 void CommunicationLayer::broadcast_message(flatbuffers::FlatBufferBuilder&& message_builder) {
   auto message_detached = message_builder.Release();
   auto message_buffer = message_detached.data();
-  if (num_parties_ == 2) {
-    send_message(1 - my_id_, std::vector<std::uint8_t>(message_buffer,
-                                                       message_buffer + message_detached.size()));
-    return;
-  }
-  broadcast_message(std::make_shared<std::vector<std::uint8_t>>(
-      message_buffer, message_buffer + message_detached.size()));
+  // copy such that messages which cannot be changed in place are rebuilt by broadcast_message
+  broadcast_message(
+      std::vector<std::uint8_t>(message_buffer, message_buffer + message_detached.size()));
 }
 
 void CommunicationLayer::register_message_handler(message_handler_f handler_factory,
                                                   const std::vector<MessageType>& message_types) {
   std::scoped_lock lock(impl_->message_handlers_mutex_);
+  auto& session = impl_->sessions_.at(session_id_);
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
       continue;
     }
-    auto& map = impl_->message_handlers_.at(party_id);
+    auto& map = session.message_handlers_.at(party_id);
     auto handler = handler_factory(party_id);
     for (auto type : message_types) {
       map.emplace(type, handler);
@@ -441,11 +1162,16 @@ void CommunicationLayer::register_message_handler(message_handler_f handler_fact
 
 void CommunicationLayer::deregister_message_handler(const std::vector<MessageType>& message_types) {
   std::scoped_lock lock(impl_->message_handlers_mutex_);
+  auto session_it = impl_->sessions_.find(session_id_);
+  if (session_it == impl_->sessions_.end()) {
+    // the session has already been shut down
+    return;
+  }
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
       continue;
     }
-    auto& map = impl_->message_handlers_.at(party_id);
+    auto& map = session_it->second.message_handlers_.at(party_id);
     for (auto type : message_types) {
       map.erase(type);
       if constexpr (MOTION_DEBUG) {
@@ -465,7 +1191,7 @@ MessageHandler& CommunicationLayer::get_message_handler(std::size_t party_id,
     throw std::invalid_argument(fmt::format("invalid party_id {} specified", party_id));
   }
   std::scoped_lock lock(impl_->message_handlers_mutex_);
-  const auto& map = impl_->message_handlers_.at(party_id);
+  const auto& map = impl_->sessions_.at(session_id_).message_handlers_.at(party_id);
   auto it = map.find(message_type);
   if (it == map.end()) {
     throw std::logic_error(
@@ -476,8 +1202,8 @@ MessageHandler& CommunicationLayer::get_message_handler(std::size_t party_id,
 }
 
 void CommunicationLayer::register_fallback_message_handler(message_handler_f handler_factory) {
-  auto& fbhs = impl_->fallback_message_handlers_;
-  fbhs.resize(num_parties_);
+  std::scoped_lock lock(impl_->message_handlers_mutex_);
+  auto& fbhs = impl_->sessions_.at(session_id_).fallback_message_handlers_;
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
       continue;
@@ -490,13 +1216,20 @@ MessageHandler& CommunicationLayer::get_fallback_message_handler(std::size_t par
   if (party_id == my_id_ || party_id >= num_parties_) {
     throw std::invalid_argument(fmt::format("invalid party_id {} specified", party_id));
   }
-  return *impl_->fallback_message_handlers_.at(party_id);
+  std::scoped_lock lock(impl_->message_handlers_mutex_);
+  return *impl_->sessions_.at(session_id_).fallback_message_handlers_.at(party_id);
 }
 
 void CommunicationLayer::shutdown() {
   if (is_shutdown_) {
     return;
   }
+  if (session_id_ != 0) {
+    // the connections stay open for the parent and the other sessions
+    impl_->close_session(session_id_);
+    is_shutdown_ = true;
+    return;
+  }
   auto message_builder = BuildMessage(MessageType::TerminationMessage, nullptr);
   broadcast_message(std::move(message_builder));
   if constexpr (MOTION_DEBUG) {
@@ -508,6 +1241,15 @@ void CommunicationLayer::shutdown() {
   is_shutdown_ = true;
 }
 
+void CommunicationLayer::set_transport_mode(TransportMode mode) {
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (party_id == my_id_) {
+      continue;
+    }
+    impl_->transports_.at(party_id)->set_mode(mode);
+  }
+}
+
 std::vector<TransportStatistics> CommunicationLayer::get_transport_statistics() const noexcept {
   std::vector<TransportStatistics> stats;
   stats.reserve(num_parties_);
@@ -515,7 +1257,17 @@ std::vector<TransportStatistics> CommunicationLayer::get_transport_statistics()
     if (party_id == my_id_) {
       continue;
     }
-    stats.emplace_back(impl_->transports_.at(party_id)->get_stats());
+    auto& party_stats = stats.emplace_back(impl_->transports_.at(party_id)->get_stats());
+    const auto& queue_stats = impl_->receive_queue_stats_.at(party_id);
+    party_stats.max_receive_queue_depth = queue_stats.max_depth;
+    party_stats.receive_stall_time_us = queue_stats.stall_time_us;
+    const auto& compression_stats = impl_->compression_stats_.at(party_id);
+    party_stats.num_compressed_messages_sent = compression_stats.num_compressed_messages;
+    party_stats.num_bytes_saved_by_compression = compression_stats.num_bytes_saved;
+    const auto send_queue_stats = impl_->send_queues_.at(party_id).get_statistics();
+    party_stats.num_send_batches = send_queue_stats.num_batches;
+    party_stats.max_send_batch_size = send_queue_stats.max_batch_size;
+    party_stats.num_send_queue_retries = send_queue_stats.num_enqueue_retries;
   }
   return stats;
 }
@@ -526,6 +1278,13 @@ void CommunicationLayer::reset_transport_statistics() noexcept {
       continue;
     }
     impl_->transports_.at(party_id)->reset_stats();
+    auto& queue_stats = impl_->receive_queue_stats_.at(party_id);
+    queue_stats.max_depth = 0;
+    queue_stats.stall_time_us = 0;
+    auto& compression_stats = impl_->compression_stats_.at(party_id);
+    compression_stats.num_compressed_messages = 0;
+    compression_stats.num_bytes_saved = 0;
+    impl_->send_queues_.at(party_id).reset_statistics();
   }
 }
 
@@ -535,11 +1294,53 @@ void CommunicationLayer::set_logger(std::shared_ptr<Logger> logger) {
         "changing the logger is not allowed after the CommunicationLayer has been started");
   }
   logger_ = logger;
-  impl_->logger_ = logger;
+  // the threads of the connections belong to the parent
+  if (session_id_ == 0) {
+    impl_->logger_ = logger;
+  }
+}
+
+void CommunicationLayer::set_in_process_message_verification(bool verify) {
+  impl_->verify_in_process_messages_ = verify;
+}
+
+void CommunicationLayer::set_trace_recorder(std::shared_ptr<Statistics::TraceRecorder> recorder) {
+  std::scoped_lock lock(impl_->trace_recorder_mutex_);
+  impl_->trace_recorder_ = std::move(recorder);
+}
+
+void CommunicationLayer::set_message_compression(bool enable) {
+  if (is_started_ || impl_->is_started_) {
+    throw std::logic_error(
+        "changing the message compression is not allowed after the CommunicationLayer has been "
+        "started");
+  }
+  impl_->message_compression_ = enable;
+}
+
+void CommunicationLayer::set_bulk_chunk_size(std::size_t chunk_size) {
+  if (is_started_ || impl_->is_started_) {
+    throw std::logic_error(
+        "changing the bulk chunk size is not allowed after the CommunicationLayer has been "
+        "started");
+  }
+  impl_->bulk_chunk_size_ = chunk_size;
+}
+
+std::uint8_t CommunicationLayer::get_supported_message_codecs() const noexcept {
+  return impl_->message_compression_ ? supported_message_codecs : 0;
+}
+
+void CommunicationLayer::set_peer_message_codecs(std::size_t party_id,
+                                                 std::uint8_t codecs) noexcept {
+  // compress only if both parties enabled it
+  if (impl_->message_compression_) {
+    impl_->peer_message_codecs_.at(party_id) = codecs & supported_message_codecs;
+  }
 }
 
 std::vector<std::unique_ptr<CommunicationLayer>> make_dummy_communication_layers(
-    std::size_t num_parties) {
+    std::size_t num_parties, bool verify_messages) {
   std::vector<std::vector<std::unique_ptr<Transport>>> transports;
   transports.reserve(num_parties);
   std::generate_n(std::back_inserter(transports), num_parties,
@@ -556,6 +1357,27 @@ std::vector<std::unique_ptr<CommunicationLayer>> make_dummy_communication_layers
   for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
     comm_layers.emplace_back(
         std::make_unique<CommunicationLayer>(party_id, std::move(transports.at(party_id))));
+    comm_layers.back()->set_in_process_message_verification(verify_messages);
+  }
+  return comm_layers;
+}
+
+std::vector<std::unique_ptr<CommunicationLayer>> make_local_shm_communication_layers(
+    std::size_t num_parties) {
+  static std::atomic<std::size_t> instance_counter = 0;
+  const auto name = fmt::format("motion-{}-{}", getpid(), instance_counter++);
+  std::vector<std::future<std::vector<std::unique_ptr<Transport>>>> futs;
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    futs.emplace_back(std::async(std::launch::async, [party_id, num_parties, &name] {
+      ShmSetupHelper helper(party_id, num_parties, name);
+      return helper.setup_connections();
+    }));
+  }
+  std::vector<std::unique_ptr<CommunicationLayer>> comm_layers;
+  comm_layers.reserve(num_parties);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    auto transports = futs.at(party_id).get();
+    comm_layers.emplace_back(std::make_unique<CommunicationLayer>(party_id, std::move(transports)));
   }
   return comm_layers;
 }
@@ -23,9 +23,11 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "fbs_headers/message_generated.h"
@@ -35,28 +37,58 @@ namespace MOTION {
 
 class Logger;
 
+namespace Statistics {
+class TraceRecorder;
+}
+
 namespace Communication {
 
 class MessageHandler;
+struct NetworkProfile;
+class SyncHandler;
 struct TransportStatistics;
 
 // Central interface for all communication related functionality
 //
 // Allows to send messages to other parties and to register handlers for
 // specific message types.
+//
+// Several sessions can share the connections of one CommunicationLayer, e.g., to evaluate
+// circuits of multiple TwoPartyBackends concurrently.  Each session is a CommunicationLayer with
+// its own message handlers, which the messages are routed to by the session_id stored in them.
 class CommunicationLayer {
  public:
   CommunicationLayer(std::size_t my_id, std::vector<std::unique_ptr<Transport>>&& transports);
   CommunicationLayer(std::size_t my_id, std::vector<std::unique_ptr<Transport>>&& transports,
                      std::shared_ptr<Logger> logger);
+  // Create a session which uses the connections of parent.  All parties need to create it with the
+  // same session_id, which must be nonzero and must not be reused while the parent exists.
+  // Messages for the session that arrive before it has been started are buffered.  A session
+  // needs to be shut down before its parent.
+  CommunicationLayer(CommunicationLayer& parent, std::uint32_t session_id);
+  CommunicationLayer(const CommunicationLayer&) = delete;
+  CommunicationLayer& operator=(const CommunicationLayer&) = delete;
   ~CommunicationLayer();
 
   std::size_t get_num_parties() const { return num_parties_; }
   std::size_t get_my_id() const { return my_id_; }
+  std::uint32_t get_session_id() const { return session_id_; }
 
-  // Start communication
+  // Start communication, for a session this also starts the parent if necessary
   void start();
+  // Wait until all parties have called sync() as often as this party.  The parties also learn
+  // this from the epoch stamped on the compact gate messages, see SyncHandler.
   void sync();
+  // Let the last party to arrive at a sync() return without sending a SynchronizationMessage,
+  // the others learn from the epoch of its next gate messages that it has arrived.  If it sends
+  // none within `timeout`, they ask for a SynchronizationMessage, so an explicit round is only
+  // needed while it is idle (set by all parties before the first sync()).
+  void set_lazy_sync(bool lazy, std::chrono::microseconds timeout = std::chrono::milliseconds(1));
+  // Estimate the round trip time and the bandwidth to the other parties from the durations of
+  // `num_rounds` synchronizations without and with `probe_size` bytes of padding, e.g., to select
+  // circuits with a CircuitCostModel (called by all parties at the same time).  The bandwidth is
+  // 0 if the padding made no measurable difference.
+  NetworkProfile measure_network(std::size_t num_rounds = 8, std::size_t probe_size = 1 << 20);
 
   // Send a message to a specified party
   void send_message(std::size_t party_id, std::vector<std::uint8_t>&& message);
@@ -84,27 +116,73 @@ class CommunicationLayer {
   void register_fallback_message_handler(message_handler_f);
   MessageHandler& get_fallback_message_handler(std::size_t party_id);
 
-  // shutdown the communication layer
+  // shutdown the communication layer, a session only stops receiving messages
   void shutdown();
 
+  // switch all transports to the given mode, e.g., at the boundary between setup and online phase
+  // (the transports are shared by all sessions)
+  void set_transport_mode(TransportMode mode);
+
   std::vector<TransportStatistics> get_transport_statistics() const noexcept;
   void reset_transport_statistics() noexcept;
 
   void set_logger(std::shared_ptr<Logger> logger);
 
+  // Check the messages received over in-process transports (see Transport::is_in_process()) like
+  // any other message (default), or pass them on as they are since they have been built by
+  // another CommunicationLayer in this process, e.g., such that local benchmarks do not measure
+  // the verification (the transports are shared by all sessions).
+  void set_in_process_message_verification(bool verify);
+
+  // Enable the compression of redundant messages, needs to be called before start().  Messages
+  // are only compressed for parties which have announced support in their HelloMessage.
+  void set_message_compression(bool enable);
+  // bit mask of the MessageCodecs this party announces to the others
+  std::uint8_t get_supported_message_codecs() const noexcept;
+  // set the codecs announced by the given party to enable compression of messages to it
+  void set_peer_message_codecs(std::size_t party_id, std::uint8_t codecs) noexcept;
+
+  // Send the bulk messages of the OT extensions and the base OTs to each party in a lane behind
+  // all other messages, and split them into chunks of chunk_size bytes, s.t. the gate messages of
+  // an online phase overlapping with the preprocessing are sent between two chunks instead of
+  // after a whole OT matrix.  Each round of the send thread sends up to chunk_size bytes of the
+  // bulk lane after the other messages.  0 (the default) sends all messages in order.  Needs to
+  // be called before start(), the receiver reassembles chunks in any case (the transports are
+  // shared by all sessions).
+  void set_bulk_chunk_size(std::size_t chunk_size);
+
+  // Record an event for each batch of messages sent and for each message received with the
+  // recorder, nullptr stops the recording (only used if MOTION_TRACING is enabled, the transports
+  // are shared by all sessions).
+  void set_trace_recorder(std::shared_ptr<Statistics::TraceRecorder> recorder);
+
  private:
   struct CommunicationLayerImpl;
 
+  // sync() with a sync message padded by `padding` bytes, see set_lazy_sync() for `lazy`
+  void sync(std::size_t padding, bool lazy);
+  // send our sync state to the party or to all parties
+  void send_sync_message(std::optional<std::size_t> party_id, std::size_t padding = 0);
+
   std::size_t my_id_;
   std::size_t num_parties_;
-  std::unique_ptr<CommunicationLayerImpl> impl_;
+  std::uint32_t session_id_;
+  std::shared_ptr<CommunicationLayerImpl> impl_;
+  std::shared_ptr<SyncHandler> sync_handler_;
+  bool lazy_sync_ = false;
+  std::chrono::microseconds lazy_sync_timeout_{1000};
   bool is_started_;
   bool is_shutdown_;
   std::shared_ptr<Logger> logger_;
 };
 
-// Create a set of communication layers connected by dummy transports
+// Create a set of communication layers connected by dummy transports, which hand the message
+// buffers over to each other, see set_in_process_message_verification() for `verify_messages`
 std::vector<std::unique_ptr<CommunicationLayer>> make_dummy_communication_layers(
+    std::size_t num_parties, bool verify_messages = true);
+
+// Create a set of communication layers connected by shared memory transports
+std::vector<std::unique_ptr<CommunicationLayer>> make_local_shm_communication_layers(
     std::size_t num_parties);
 
 // Create a set of communication layers connected by local TCP connections
@@ -41,6 +41,9 @@ class DummyTransport : public Transport {
   void send_message(const std::vector<std::uint8_t>& message) override;
   void send_message(const std::uint8_t* message, std::size_t size) override;
 
+  // the messages are handed over to the other transport of the pair
+  bool is_in_process() const noexcept override { return true; }
+
   // check if a new message is available
   bool available() const override;
 
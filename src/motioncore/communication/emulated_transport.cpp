@@ -0,0 +1,247 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "emulated_transport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace MOTION::Communication {
+
+NetworkProfile NetworkProfile::lan() {
+  return {"lan", std::chrono::microseconds(500), std::chrono::microseconds(0), 1'000'000'000};
+}
+
+NetworkProfile NetworkProfile::wan() {
+  return {"wan", std::chrono::milliseconds(100), std::chrono::microseconds(0), 100'000'000};
+}
+
+namespace {
+
+double parse_number(std::string_view s, std::string_view spec) {
+  double value;
+  const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  if (ec != std::errc() || ptr != s.data() + s.size() || value < 0) {
+    throw std::invalid_argument(fmt::format("invalid network profile: {}", spec));
+  }
+  return value;
+}
+
+std::chrono::microseconds from_milliseconds(double ms) {
+  return std::chrono::microseconds(static_cast<std::int64_t>(ms * 1000));
+}
+
+}  // namespace
+
+NetworkProfile parse_network_profile(std::string_view spec) {
+  if (spec == "none") {
+    return {};
+  } else if (spec == "lan") {
+    return NetworkProfile::lan();
+  } else if (spec == "wan") {
+    return NetworkProfile::wan();
+  }
+  std::vector<std::string_view> fields;
+  for (std::size_t pos = 0; pos <= spec.size();) {
+    const auto end = std::min(spec.find(',', pos), spec.size());
+    fields.push_back(spec.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  if (fields.size() != 2 && fields.size() != 3) {
+    throw std::invalid_argument(fmt::format("invalid network profile: {}", spec));
+  }
+  NetworkProfile profile;
+  profile.name = std::string(spec);
+  profile.round_trip_time = from_milliseconds(parse_number(fields[0], spec));
+  profile.bandwidth = static_cast<std::uint64_t>(parse_number(fields[1], spec) * 1'000'000);
+  if (fields.size() == 3) {
+    profile.jitter = from_milliseconds(parse_number(fields[2], spec));
+  }
+  return profile;
+}
+
+std::string to_string(const NetworkProfile& profile) {
+  if (profile.is_none()) {
+    return profile.name;
+  }
+  auto bandwidth = profile.bandwidth == 0
+                       ? std::string("unlimited")
+                       : fmt::format("{} Mbit/s", static_cast<double>(profile.bandwidth) / 1e6);
+  return fmt::format("{} ({} ms RTT, {} ms jitter, {})", profile.name,
+                     static_cast<double>(profile.round_trip_time.count()) / 1000,
+                     static_cast<double>(profile.jitter.count()) / 1000, bandwidth);
+}
+
+void NetworkEmulation::set_profile(NetworkProfile profile) {
+  std::scoped_lock lock(mutex_);
+  profile_ = std::move(profile);
+}
+
+NetworkProfile NetworkEmulation::get_profile() const {
+  std::scoped_lock lock(mutex_);
+  return profile_;
+}
+
+EmulatedTransport::EmulatedTransport(std::unique_ptr<Transport> transport,
+                                     std::shared_ptr<const NetworkEmulation> emulation)
+    : transport_(std::move(transport)),
+      emulation_(std::move(emulation)),
+      link_free_time_(clock_type::now()),
+      last_delivery_time_(link_free_time_),
+      jitter_rng_(std::random_device{}()),
+      delivery_thread_([this] { delivery_task(); }) {}
+
+EmulatedTransport::~EmulatedTransport() {
+  shutdown_send();
+  if (delivery_thread_.joinable()) {
+    delivery_thread_.join();
+  }
+}
+
+void EmulatedTransport::send_message(std::vector<std::uint8_t>&& message) {
+  const auto profile = emulation_->get_profile();
+  const auto message_size = message.size();
+  {
+    std::scoped_lock lock(mutex_);
+    if (send_closed_) {
+      throw std::logic_error("EmulatedTransport: send_message after shutdown_send");
+    }
+    // the message starts when the link is idle and needs size / bandwidth to be transmitted
+    const auto start_time = std::max(clock_type::now(), link_free_time_);
+    link_free_time_ = start_time;
+    if (profile.bandwidth != 0) {
+      link_free_time_ += std::chrono::nanoseconds(
+          static_cast<std::int64_t>(8e9 * static_cast<double>(message_size) /
+                                    static_cast<double>(profile.bandwidth)));
+    }
+    auto delivery_time = link_free_time_ + profile.round_trip_time / 2;
+    if (profile.jitter.count() > 0) {
+      std::uniform_int_distribution<std::int64_t> dist(0, profile.jitter.count());
+      delivery_time += std::chrono::microseconds(dist(jitter_rng_));
+    }
+    // jitter must not reorder the messages
+    delivery_time = std::max(delivery_time, last_delivery_time_);
+    last_delivery_time_ = delivery_time;
+    queue_.emplace_back(delivery_time, std::move(message));
+  }
+  cv_.notify_one();
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += message_size;
+}
+
+void EmulatedTransport::send_message(const std::vector<std::uint8_t>& message) {
+  send_message(std::vector<std::uint8_t>(message));
+}
+
+void EmulatedTransport::send_message(const std::uint8_t* message, std::size_t size) {
+  send_message(std::vector<std::uint8_t>(message, message + size));
+}
+
+void EmulatedTransport::set_mode(TransportMode mode) { transport_->set_mode(mode); }
+
+void EmulatedTransport::delivery_task() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return !queue_.empty() || send_closed_; });
+    if (queue_.empty()) {
+      break;
+    }
+    // new messages are appended behind the front, so its delivery time cannot change
+    const auto delivery_time = queue_.front().first;
+    while (clock_type::now() < delivery_time) {
+      cv_.wait_until(lock, delivery_time);
+    }
+    auto message = std::move(queue_.front().second);
+    queue_.pop_front();
+    lock.unlock();
+    try {
+      transport_->send_message(std::move(message));
+    } catch (std::runtime_error&) {
+      // the connection is broken, drop the remaining messages as the wrapped transport would
+      lock.lock();
+      queue_.clear();
+      break;
+    }
+    lock.lock();
+  }
+  lock.unlock();
+  transport_->shutdown_send();
+}
+
+bool EmulatedTransport::available() const { return transport_->available(); }
+
+std::optional<std::vector<std::uint8_t>> EmulatedTransport::receive_message() {
+  auto message_opt = transport_->receive_message();
+  if (message_opt.has_value()) {
+    statistics_.num_messages_received += 1;
+    statistics_.num_bytes_received += message_opt->size();
+  }
+  return message_opt;
+}
+
+std::optional<ENCRYPTO::PooledBuffer> EmulatedTransport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  auto message_opt = transport_->receive_pooled_message(pool);
+  if (message_opt.has_value()) {
+    statistics_.num_messages_received += 1;
+    statistics_.num_bytes_received += message_opt->size();
+  }
+  return message_opt;
+}
+
+void EmulatedTransport::shutdown_send() {
+  {
+    std::scoped_lock lock(mutex_);
+    send_closed_ = true;
+  }
+  cv_.notify_one();
+}
+
+void EmulatedTransport::shutdown() {
+  shutdown_send();
+  // the queued messages are still delivered
+  if (delivery_thread_.joinable()) {
+    delivery_thread_.join();
+  }
+  transport_->shutdown();
+}
+
+std::vector<std::unique_ptr<Transport>> make_emulated_transports(
+    std::vector<std::unique_ptr<Transport>>&& transports,
+    std::shared_ptr<const NetworkEmulation> emulation) {
+  std::vector<std::unique_ptr<Transport>> emulated_transports;
+  emulated_transports.reserve(transports.size());
+  for (auto& transport : transports) {
+    if (transport == nullptr) {
+      emulated_transports.emplace_back();
+      continue;
+    }
+    emulated_transports.emplace_back(
+        std::make_unique<EmulatedTransport>(std::move(transport), emulation));
+  }
+  return emulated_transports;
+}
+
+}  // namespace MOTION::Communication
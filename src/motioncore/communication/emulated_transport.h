@@ -0,0 +1,130 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "transport.h"
+
+namespace MOTION::Communication {
+
+// Characteristics of an emulated network link.  The round trip time is split evenly between both
+// directions, each message is additionally delayed by a uniformly distributed jitter, and the
+// bandwidth limits how fast consecutive messages leave.  Zero values disable the respective
+// effect.
+struct NetworkProfile {
+  std::string name = "none";
+  std::chrono::microseconds round_trip_time{0};
+  std::chrono::microseconds jitter{0};
+  // bits per second
+  std::uint64_t bandwidth = 0;
+
+  bool is_none() const noexcept {
+    return round_trip_time.count() == 0 && jitter.count() == 0 && bandwidth == 0;
+  }
+
+  // 1 Gbit/s, 0.5 ms round trip time
+  static NetworkProfile lan();
+  // 100 Mbit/s, 100 ms round trip time
+  static NetworkProfile wan();
+};
+
+// Parse "none", "lan", "wan" or "<RTT ms>,<bandwidth Mbit/s>[,<jitter ms>]", where a bandwidth of
+// 0 means unlimited.  Throws std::invalid_argument for other strings.
+NetworkProfile parse_network_profile(std::string_view spec);
+
+// human readable description of the profile
+std::string to_string(const NetworkProfile& profile);
+
+// Profile shared by a set of EmulatedTransports, such that it can be switched for all of them at
+// once, e.g., between the runs of a benchmark.
+class NetworkEmulation {
+ public:
+  explicit NetworkEmulation(NetworkProfile profile = {}) : profile_(std::move(profile)) {}
+  void set_profile(NetworkProfile profile);
+  NetworkProfile get_profile() const;
+
+ private:
+  mutable std::mutex mutex_;
+  NetworkProfile profile_;
+};
+
+// Decorator which delays the messages sent over another transport according to a NetworkProfile.
+// Messages are queued and handed to the wrapped transport by a separate thread once they would
+// have arrived at the other party, such that the sender does not block, as with a large socket
+// buffer.  Messages are never reordered.  Received messages are passed through unchanged, so both
+// parties need to emulate the network to get the full round trip time.
+class EmulatedTransport : public Transport {
+ public:
+  EmulatedTransport(std::unique_ptr<Transport> transport,
+                    std::shared_ptr<const NetworkEmulation> emulation);
+  ~EmulatedTransport();
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+
+  void set_mode(TransportMode mode) override;
+
+  bool available() const override;
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool) override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // hand the queued messages to the wrapped transport when they are due
+  void delivery_task();
+
+  std::unique_ptr<Transport> transport_;
+  std::shared_ptr<const NetworkEmulation> emulation_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<clock_type::time_point, std::vector<std::uint8_t>>> queue_;
+  // when the emulated link has finished transmitting the previous message
+  clock_type::time_point link_free_time_;
+  clock_type::time_point last_delivery_time_;
+  std::mt19937_64 jitter_rng_;
+  bool send_closed_ = false;
+  std::thread delivery_thread_;
+};
+
+// Wrap all (non-null) transports into EmulatedTransports sharing the given emulation.
+std::vector<std::unique_ptr<Transport>> make_emulated_transports(
+    std::vector<std::unique_ptr<Transport>>&& transports,
+    std::shared_ptr<const NetworkEmulation> emulation);
+
+}  // namespace MOTION::Communication
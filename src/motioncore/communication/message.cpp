@@ -29,19 +29,112 @@
 
 namespace MOTION::Communication {
 flatbuffers::FlatBufferBuilder BuildMessage(MessageType message_type,
-                                                   const std::vector<uint8_t> *payload) {
-  auto allocation_size = payload ? payload->size() + 20 : 1024;
+                                                   const std::vector<uint8_t> *payload,
+                                                   std::uint32_t session_id) {
+  auto allocation_size = payload ? payload->size() + 28 : 1024;
   flatbuffers::FlatBufferBuilder builder(allocation_size);
-  auto root = CreateMessageDirect(builder, message_type, payload);
+  // serialize the session_id even if it is 0
+  builder.ForceDefaults(true);
+  auto root = CreateMessageDirect(builder, message_type, payload, session_id);
   FinishMessageBuffer(builder, root);
   return builder;
 }
 
 flatbuffers::FlatBufferBuilder BuildMessage(MessageType message_type, const uint8_t *payload,
-                                                   std::size_t size) {
+                                                   std::size_t size, std::uint32_t session_id) {
   assert(payload);
   std::vector<std::uint8_t> buffer(payload, payload + size);
-  return BuildMessage(message_type, &buffer);
+  return BuildMessage(message_type, &buffer, session_id);
+}
+
+bool SetMessageSessionId(std::uint8_t *message, std::uint32_t session_id) {
+  if (message[0] == compact_gate_message_marker) {
+    for (std::size_t i = 0; i < sizeof(session_id); ++i) {
+      message[2 + i] = static_cast<std::uint8_t>(session_id >> (8 * i));
+    }
+    return true;
+  }
+  return GetMutableMessage(message)->mutate_session_id(session_id);
+}
+
+namespace {
+
+constexpr std::size_t compact_header_size = 7;
+constexpr std::size_t max_varint_size = 10;
+
+void append_varint(std::vector<std::uint8_t> &buffer, std::uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<std::uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint32_t read_compact_session_id(std::span<const std::uint8_t> message) {
+  std::uint32_t session_id = 0;
+  for (std::size_t i = 0; i < sizeof(session_id); ++i) {
+    session_id |= std::uint32_t(message[2 + i]) << (8 * i);
+  }
+  return session_id;
+}
+
+bool read_varint(std::span<const std::uint8_t> buffer, std::size_t &pos, std::uint64_t &value) {
+  value = 0;
+  for (std::size_t i = 0; i < max_varint_size && pos < buffer.size(); ++i) {
+    const auto byte = buffer[pos++];
+    value |= std::uint64_t(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> BuildCompactGateMessage(MessageType message_type, std::uint64_t gate_id,
+                                                  std::uint64_t msg_num,
+                                                  std::span<const std::uint8_t> payload,
+                                                  std::uint32_t session_id) {
+  std::vector<std::uint8_t> buffer;
+  buffer.reserve(compact_header_size + 3 * max_varint_size + payload.size());
+  buffer.push_back(compact_gate_message_marker);
+  buffer.push_back(static_cast<std::uint8_t>(message_type));
+  buffer.resize(compact_header_size);
+  SetMessageSessionId(buffer.data(), session_id);
+  append_varint(buffer, gate_id);
+  append_varint(buffer, msg_num);
+  append_varint(buffer, payload.size());
+  buffer.insert(buffer.end(), payload.begin(), payload.end());
+  return buffer;
+}
+
+std::optional<CompactGateMessage> ParseCompactGateMessage(
+    std::span<const std::uint8_t> message) noexcept {
+  if (message.size() < compact_header_size || message[0] != compact_gate_message_marker) {
+    return std::nullopt;
+  }
+  CompactGateMessage result;
+  result.message_type = static_cast<MessageType>(message[1]);
+  result.session_id = read_compact_session_id(message);
+  result.sync_epoch = message[compact_gate_message_sync_epoch_offset];
+  std::size_t pos = compact_header_size;
+  std::uint64_t payload_size;
+  if (!read_varint(message, pos, result.gate_id) || !read_varint(message, pos, result.msg_num) ||
+      !read_varint(message, pos, payload_size) || payload_size != message.size() - pos) {
+    return std::nullopt;
+  }
+  result.payload = message.subspan(pos);
+  return result;
+}
+
+std::pair<MessageType, std::uint32_t> GetMessageTypeAndSessionId(
+    std::span<const std::uint8_t> message) {
+  if (IsCompactGateMessage(message)) {
+    return {static_cast<MessageType>(message[1]), read_compact_session_id(message)};
+  }
+  const auto *fb_message = GetMessage(message.data());
+  return {fb_message->message_type(), fb_message->session_id()};
 }
 
 using namespace std::string_literals;
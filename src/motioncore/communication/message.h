@@ -24,15 +24,71 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
 #include <flatbuffers/flatbuffers.h>
 
 #include "fbs_headers/message_generated.h"
 
 namespace MOTION::Communication {
+// The session_id field is always serialized, such that it can be changed in place with
+// SetMessageSessionId.
 flatbuffers::FlatBufferBuilder BuildMessage(MessageType message_type,
-                                                   const std::vector<uint8_t> *payload);
+                                                   const std::vector<uint8_t> *payload,
+                                                   std::uint32_t session_id = 0);
 flatbuffers::FlatBufferBuilder BuildMessage(MessageType message_type, const uint8_t *payload,
-                                                   std::size_t size);
+                                                   std::size_t size, std::uint32_t session_id = 0);
+
+// Set the session_id of a serialized message in place.  Returns false if the message does not
+// contain the field, i.e., if it has not been created with BuildMessage or
+// BuildCompactGateMessage.
+bool SetMessageSessionId(std::uint8_t *message, std::uint32_t session_id);
+
+// Compact framing of the gate messages sent by CommMixin, which avoids building and verifying a
+// CommMixinGateMessage nested in a Message for each of the many small messages of the online phase:
+//
+//   marker (0xff) | message_type (1 B) | session_id (4 B, little endian) | sync_epoch (1 B) |
+//   varint gate_id | varint msg_num | varint payload size | payload
+//
+// A serialized Message starts with the offset of its root table, which is a multiple of 4, hence
+// a first byte of 0xff distinguishes the two formats.  The session_id has a fixed position such
+// that SetMessageSessionId can change it in place for either format.  The sync_epoch is stamped
+// by the CommunicationLayer when the message is sent, see SyncHandler::received_epoch(), 0 means
+// that it has not been stamped.
+constexpr std::uint8_t compact_gate_message_marker = 0xff;
+constexpr std::size_t compact_gate_message_sync_epoch_offset = 6;
+
+struct CompactGateMessage {
+  MessageType message_type;
+  std::uint32_t session_id;
+  std::uint8_t sync_epoch;
+  std::uint64_t gate_id;
+  std::uint64_t msg_num;
+  std::span<const std::uint8_t> payload;
+};
+
+std::vector<std::uint8_t> BuildCompactGateMessage(MessageType message_type, std::uint64_t gate_id,
+                                                  std::uint64_t msg_num,
+                                                  std::span<const std::uint8_t> payload,
+                                                  std::uint32_t session_id = 0);
+
+// Check only the marker byte; use ParseCompactGateMessage to validate the frame.
+inline bool IsCompactGateMessage(std::span<const std::uint8_t> message) noexcept {
+  return !message.empty() && message[0] == compact_gate_message_marker;
+}
+
+// Returns std::nullopt if the frame is truncated or its payload size does not match.
+std::optional<CompactGateMessage> ParseCompactGateMessage(
+    std::span<const std::uint8_t> message) noexcept;
+
+// Read message_type and session_id of a message in either format.  The message needs to have
+// been verified (or parsed, if it is compact) before.
+std::pair<MessageType, std::uint32_t> GetMessageTypeAndSessionId(
+    std::span<const std::uint8_t> message);
 
 // Give a human readable representation of MessageType values
 std::string to_string(MessageType message_type);
@@ -0,0 +1,252 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "message_codec.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace MOTION::Communication {
+
+namespace {
+
+// runs shorter than this are encoded as part of a literal sequence
+constexpr std::size_t min_run_length = 4;
+
+// only use a codec if it saves at least a quarter of the bytes
+constexpr bool pays_off(std::size_t encoded_size, std::size_t size) {
+  return encoded_size < size - size / 4;
+}
+
+constexpr std::size_t varint_size(std::uint64_t value) {
+  std::size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+void write_varint(std::vector<std::uint8_t>& output, std::uint64_t value) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<std::uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  output.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t read_varint(std::span<const std::uint8_t>& input) {
+  std::uint64_t value = 0;
+  for (std::size_t shift = 0; shift < 64; shift += 7) {
+    if (input.empty()) {
+      throw std::runtime_error("compressed message: truncated varint");
+    }
+    const auto byte = input.front();
+    input = input.subspan(1);
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("compressed message: varint too long");
+}
+
+struct EncodedSizes {
+  std::size_t sparse = 0;
+  std::size_t run_length = 0;
+};
+
+// compute the exact output sizes of both codecs in one pass over the runs of the input
+EncodedSizes compute_encoded_sizes(std::span<const std::uint8_t> input) {
+  EncodedSizes sizes;
+  std::size_t sparse_position = 0;
+  std::size_t literal_length = 0;
+  for (std::size_t i = 0; i < input.size();) {
+    const auto value = input[i];
+    std::size_t j = i + 1;
+    while (j < input.size() && input[j] == value) {
+      ++j;
+    }
+    const auto run = j - i;
+    if (value != 0) {
+      sizes.sparse += varint_size(i - sparse_position) + 1 + 2 * (run - 1);
+      sparse_position = j;
+    }
+    if (run >= min_run_length) {
+      if (literal_length > 0) {
+        sizes.run_length += varint_size(literal_length << 1) + literal_length;
+        literal_length = 0;
+      }
+      sizes.run_length += varint_size((run << 1) | 1) + 1;
+    } else {
+      literal_length += run;
+    }
+    i = j;
+  }
+  if (literal_length > 0) {
+    sizes.run_length += varint_size(literal_length << 1) + literal_length;
+  }
+  return sizes;
+}
+
+void encode_sparse(std::vector<std::uint8_t>& output, std::span<const std::uint8_t> input) {
+  std::size_t position = 0;
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    if (input[i] != 0) {
+      write_varint(output, i - position);
+      output.push_back(input[i]);
+      position = i + 1;
+    }
+  }
+}
+
+void encode_run_length(std::vector<std::uint8_t>& output, std::span<const std::uint8_t> input) {
+  std::size_t literal_start = 0;
+  auto flush_literal = [&](std::size_t end) {
+    if (end > literal_start) {
+      write_varint(output, (end - literal_start) << 1);
+      output.insert(std::end(output), std::begin(input) + literal_start, std::begin(input) + end);
+    }
+  };
+  for (std::size_t i = 0; i < input.size();) {
+    std::size_t j = i + 1;
+    while (j < input.size() && input[j] == input[i]) {
+      ++j;
+    }
+    if (j - i >= min_run_length) {
+      flush_literal(i);
+      write_varint(output, ((j - i) << 1) | 1);
+      output.push_back(input[i]);
+      literal_start = j;
+    }
+    i = j;
+  }
+  flush_literal(input.size());
+}
+
+void decode_sparse(std::vector<std::uint8_t>& output, std::span<const std::uint8_t> input) {
+  std::size_t position = 0;
+  while (!input.empty()) {
+    position += read_varint(input);
+    if (input.empty() || position >= output.size()) {
+      throw std::runtime_error("compressed message: invalid sparse encoding");
+    }
+    output[position++] = input.front();
+    input = input.subspan(1);
+  }
+}
+
+void decode_run_length(std::vector<std::uint8_t>& output, std::span<const std::uint8_t> input) {
+  std::size_t position = 0;
+  while (!input.empty()) {
+    const auto header = read_varint(input);
+    const auto length = header >> 1;
+    const bool is_run = header & 1;
+    if (length > output.size() - position || input.size() < (is_run ? 1 : length)) {
+      throw std::runtime_error("compressed message: invalid run-length encoding");
+    }
+    if (is_run) {
+      std::fill_n(std::begin(output) + position, length, input.front());
+      input = input.subspan(1);
+    } else {
+      std::copy_n(std::begin(input), length, std::begin(output) + position);
+      input = input.subspan(length);
+    }
+    position += length;
+  }
+  if (position != output.size()) {
+    throw std::runtime_error("compressed message: run-length encoding is too short");
+  }
+}
+
+constexpr bool is_allowed(std::uint8_t allowed_codecs, MessageCodec codec) {
+  return allowed_codecs & (1 << static_cast<std::uint8_t>(codec));
+}
+
+}  // namespace
+
+std::optional<std::vector<std::uint8_t>> compress_message(std::span<const std::uint8_t> message,
+                                                          std::uint8_t allowed_codecs) {
+  allowed_codecs &= supported_message_codecs;
+  if (message.size() < min_compressed_message_size || allowed_codecs == 0) {
+    return std::nullopt;
+  }
+  // most messages consist of random shares, reject them after looking at a prefix
+  constexpr std::size_t sample_size = 4096;
+  auto sizes = compute_encoded_sizes(message.first(std::min(message.size(), sample_size)));
+  auto best_codec = [&] {
+    const bool sparse = is_allowed(allowed_codecs, MessageCodec::sparse);
+    const bool run_length = is_allowed(allowed_codecs, MessageCodec::run_length);
+    if (sparse && (!run_length || sizes.sparse <= sizes.run_length)) {
+      return std::make_pair(MessageCodec::sparse, sizes.sparse);
+    }
+    return std::make_pair(MessageCodec::run_length, sizes.run_length);
+  };
+  if (!pays_off(best_codec().second, std::min(message.size(), sample_size))) {
+    return std::nullopt;
+  }
+  if (message.size() > sample_size) {
+    sizes = compute_encoded_sizes(message);
+  }
+  const auto [codec, encoded_size] = best_codec();
+  if (!pays_off(encoded_size, message.size())) {
+    return std::nullopt;
+  }
+
+  std::vector<std::uint8_t> payload;
+  payload.reserve(1 + varint_size(message.size()) + encoded_size);
+  payload.push_back(static_cast<std::uint8_t>(codec));
+  write_varint(payload, message.size());
+  if (codec == MessageCodec::sparse) {
+    encode_sparse(payload, message);
+  } else {
+    encode_run_length(payload, message);
+  }
+  return payload;
+}
+
+std::vector<std::uint8_t> decompress_message(std::span<const std::uint8_t> payload) {
+  if (payload.empty()) {
+    throw std::runtime_error("compressed message: empty payload");
+  }
+  const auto codec = static_cast<MessageCodec>(payload.front());
+  payload = payload.subspan(1);
+  const auto size = read_varint(payload);
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("compressed message: decoded size too large");
+  }
+  std::vector<std::uint8_t> message(size, 0);
+  switch (codec) {
+    case MessageCodec::sparse:
+      decode_sparse(message, payload);
+      break;
+    case MessageCodec::run_length:
+      decode_run_length(message, payload);
+      break;
+    default:
+      throw std::runtime_error("compressed message: unknown codec");
+  }
+  return message;
+}
+
+}  // namespace MOTION::Communication
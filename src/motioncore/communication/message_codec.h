@@ -0,0 +1,57 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace MOTION::Communication {
+
+// Codecs for the payload of CompressedMessages.
+enum class MessageCodec : std::uint8_t {
+  // (distance to the next nonzero byte, byte) pairs, e.g., for one-hot bit vectors
+  sparse = 1,
+  // runs of equal bytes and literal sequences, e.g., for zero-filled blocks
+  run_length = 2,
+};
+
+// bit mask of the codecs implemented by this version
+constexpr std::uint8_t supported_message_codecs =
+    (1 << static_cast<std::uint8_t>(MessageCodec::sparse)) |
+    (1 << static_cast<std::uint8_t>(MessageCodec::run_length));
+
+// messages below this size are always sent uncompressed
+constexpr std::size_t min_compressed_message_size = 128;
+
+// Encode the message with the allowed codec (bit mask) that gives the smallest output.  Returns
+// the payload of a CompressedMessage or std::nullopt if compression does not pay off.
+std::optional<std::vector<std::uint8_t>> compress_message(std::span<const std::uint8_t> message,
+                                                          std::uint8_t allowed_codecs);
+
+// Decode the payload of a CompressedMessage.  Throws std::runtime_error on malformed input.
+std::vector<std::uint8_t> decompress_message(std::span<const std::uint8_t> payload);
+
+}  // namespace MOTION::Communication
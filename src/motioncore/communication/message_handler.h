@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "utility/buffer_pool.h"
 #include "utility/synchronized_queue.h"
 
 namespace MOTION::Communication {
@@ -46,6 +47,15 @@ class MessageHandler {
   // This method may be called concurrently with different values of party_id.
   // The client is responsible for the necessary synchronization.
   virtual void received_message(std::size_t party_id, std::vector<std::uint8_t>&& message) = 0;
+
+  // Method which is called by the CommunicationLayer with received messages in a pooled receive
+  // buffer, which goes back to the pool once all references to it have been dropped.  Handlers
+  // which only read the message in place should override this to avoid allocating a vector for
+  // each message.  By default, the message is passed on to received_message, and the vector is
+  // moved out of the buffer if no other reference exists.
+  virtual void received_pooled_message(std::size_t party_id, ENCRYPTO::PooledBuffer&& message) {
+    received_message(party_id, message.release());
+  }
 };
 
 // Example message handler which puts received messages into a queue
@@ -39,4 +39,13 @@ flatbuffers::FlatBufferBuilder BuildOTExtensionMessageReceiverMasks(const std::b
 flatbuffers::FlatBufferBuilder BuildOTExtensionMessageReceiverCorrections(const std::byte *buffer,
                                                                           const std::size_t size,
                                                                           const std::size_t i);
+
+// messages of the silent OT generator, `i` identifies the step of the protocol
+flatbuffers::FlatBufferBuilder BuildSilentOTMessageReceiver(const std::byte *buffer,
+                                                            const std::size_t size,
+                                                            const std::size_t i);
+
+flatbuffers::FlatBufferBuilder BuildSilentOTMessageSender(const std::byte *buffer,
+                                                          const std::size_t size,
+                                                          const std::size_t i);
 }  // namespace MOTION::Communication
@@ -0,0 +1,448 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "shm_transport.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace MOTION::Communication {
+
+namespace detail {
+
+namespace {
+
+enum SegmentState : std::uint32_t { initializing = 0, ready = 1, attached = 2 };
+
+// control block of the ring buffer for one direction, all positions are in bytes and only grow
+struct ShmRingControl {
+  // written by the sender
+  alignas(64) std::atomic<std::uint64_t> head = 0;
+  // written by the receiver
+  alignas(64) std::atomic<std::uint64_t> tail = 0;
+  // futex words, incremented whenever head or tail have been moved or the ring has been closed
+  alignas(64) std::atomic<std::uint32_t> data_seq = 0;
+  std::atomic<std::uint32_t> receiver_waiting = 0;
+  std::atomic<std::uint32_t> space_seq = 0;
+  std::atomic<std::uint32_t> sender_waiting = 0;
+  std::atomic<std::uint32_t> sender_closed = 0;
+  std::atomic<std::uint32_t> receiver_closed = 0;
+};
+
+struct ShmSegmentHeader {
+  std::atomic<std::uint32_t> state = SegmentState::initializing;
+  std::uint64_t ring_size = 0;
+  // ring 0 is used by the party with the smaller id for sending
+  ShmRingControl rings[2];
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+// the ring buffers start at the first page after the header
+constexpr std::size_t data_offset = (sizeof(ShmSegmentHeader) + 4095) / 4096 * 4096;
+
+constexpr std::size_t get_segment_size(std::size_t ring_size) {
+  return data_offset + 2 * ring_size;
+}
+
+// bound the time of a single wait, such that a lost wakeup cannot block forever
+constexpr timespec wait_timeout = {0, 100'000'000};
+
+void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) {
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected,
+          &wait_timeout, nullptr, 0);
+}
+
+void futex_wake(std::atomic<std::uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE,
+          std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+}
+
+// increment the sequence word and wake the other side if it is sleeping on it
+void notify(std::atomic<std::uint32_t>& seq, std::atomic<std::uint32_t>& waiting) {
+  seq.fetch_add(1);
+  if (waiting.load()) {
+    futex_wake(seq);
+  }
+}
+
+// sleep until the condition holds, it is checked again after announcing the wait to avoid lost
+// wakeups
+template <typename Condition>
+void wait_until(std::atomic<std::uint32_t>& seq, std::atomic<std::uint32_t>& waiting,
+                Condition&& condition) {
+  while (!condition()) {
+    waiting.store(1);
+    const auto current_seq = seq.load();
+    if (!condition()) {
+      futex_wait(seq, current_seq);
+    }
+    waiting.store(0);
+  }
+}
+
+}  // namespace
+
+struct ShmTransportImpl {
+  ShmTransportImpl(void* mapping, std::size_t mapping_size, std::size_t send_ring_i);
+  ~ShmTransportImpl();
+
+  // copy the data into the send ring, blocks while the ring is full
+  void write(const std::uint8_t* data, std::size_t size);
+  // copy data from the receive ring, blocks until size bytes are available, returns the number
+  // of bytes read which is less than size only if the ring has been closed
+  std::size_t read(std::uint8_t* data, std::size_t size);
+
+  void* mapping_;
+  std::size_t mapping_size_;
+  std::size_t ring_size_;
+  ShmRingControl& send_control_;
+  std::uint8_t* send_data_;
+  ShmRingControl& receive_control_;
+  std::uint8_t* receive_data_;
+};
+
+ShmTransportImpl::ShmTransportImpl(void* mapping, std::size_t mapping_size,
+                                   std::size_t send_ring_i)
+    : mapping_(mapping),
+      mapping_size_(mapping_size),
+      ring_size_(static_cast<ShmSegmentHeader*>(mapping)->ring_size),
+      send_control_(static_cast<ShmSegmentHeader*>(mapping)->rings[send_ring_i]),
+      send_data_(static_cast<std::uint8_t*>(mapping) + data_offset + send_ring_i * ring_size_),
+      receive_control_(static_cast<ShmSegmentHeader*>(mapping)->rings[1 - send_ring_i]),
+      receive_data_(static_cast<std::uint8_t*>(mapping) + data_offset +
+                    (1 - send_ring_i) * ring_size_) {}
+
+ShmTransportImpl::~ShmTransportImpl() { munmap(mapping_, mapping_size_); }
+
+void ShmTransportImpl::write(const std::uint8_t* data, std::size_t size) {
+  auto& control = send_control_;
+  // only this thread moves the head
+  auto head = control.head.load(std::memory_order_relaxed);
+  while (size > 0) {
+    std::size_t free_space = 0;
+    wait_until(control.space_seq, control.sender_waiting, [&] {
+      free_space = ring_size_ - (head - control.tail.load());
+      return free_space > 0 || control.receiver_closed.load();
+    });
+    if (free_space == 0) {
+      throw std::runtime_error("Error while writing to shared memory: receiver has been closed");
+    }
+    const auto offset = head % ring_size_;
+    const auto chunk_size = std::min({size, free_space, ring_size_ - offset});
+    std::memcpy(send_data_ + offset, data, chunk_size);
+    head += chunk_size;
+    control.head.store(head);
+    notify(control.data_seq, control.receiver_waiting);
+    data += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+std::size_t ShmTransportImpl::read(std::uint8_t* data, std::size_t size) {
+  auto& control = receive_control_;
+  // only this thread moves the tail
+  auto tail = control.tail.load(std::memory_order_relaxed);
+  std::size_t num_read = 0;
+  while (num_read < size) {
+    std::size_t available = 0;
+    wait_until(control.data_seq, control.receiver_waiting, [&] {
+      available = control.head.load() - tail;
+      return available > 0 || control.sender_closed.load() || control.receiver_closed.load();
+    });
+    if (available == 0) {
+      break;
+    }
+    const auto offset = tail % ring_size_;
+    const auto chunk_size = std::min({size - num_read, available, ring_size_ - offset});
+    std::memcpy(data + num_read, receive_data_ + offset, chunk_size);
+    tail += chunk_size;
+    control.tail.store(tail);
+    notify(control.space_seq, control.sender_waiting);
+    num_read += chunk_size;
+  }
+  return num_read;
+}
+
+}  // namespace detail
+
+static void u32tou8(std::uint32_t v, std::uint8_t* result) {
+  for (auto i = 0u; i < sizeof(std::uint32_t); ++i) {
+    result[i] = (v >> i * 8) & 0xFF;
+  }
+}
+
+static std::uint32_t u8tou32(const std::array<std::uint8_t, sizeof(std::uint32_t)>& v) {
+  std::uint32_t result = 0;
+  for (auto i = 0u; i < sizeof(std::uint32_t); ++i) {
+    result += (v[i] << i * 8);
+  }
+  return result;
+}
+
+ShmTransport::ShmTransport(std::unique_ptr<detail::ShmTransportImpl> impl)
+    : impl_(std::move(impl)) {}
+
+ShmTransport::ShmTransport(ShmTransport&& other)
+    : Transport(std::move(other)), impl_(std::move(other.impl_)) {}
+
+ShmTransport::~ShmTransport() = default;
+
+void ShmTransport::send_message(std::vector<std::uint8_t>&& message) { send_message(message); }
+
+void ShmTransport::send_message(const std::vector<std::uint8_t>& message) {
+  send_message(message.data(), message.size());
+}
+
+void ShmTransport::send_message(const std::uint8_t* message, std::size_t size) {
+  send_messages(std::array{std::span<const std::uint8_t>(message, size)});
+}
+
+void ShmTransport::send_messages(std::span<const std::span<const std::uint8_t>> messages) {
+  for (const auto& message : messages) {
+    if (message.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error(fmt::format("Max message size is {} B but tried to send {} B",
+                                           std::numeric_limits<std::uint32_t>::max(),
+                                           message.size()));
+    }
+    std::array<std::uint8_t, sizeof(std::uint32_t)> message_size;
+    u32tou8(message.size(), message_size.data());
+    impl_->write(message_size.data(), message_size.size());
+    impl_->write(message.data(), message.size());
+    statistics_.num_bytes_sent += message.size() + sizeof(std::uint32_t);
+  }
+  statistics_.num_messages_sent += messages.size();
+}
+
+bool ShmTransport::available() const {
+  const auto& control = impl_->receive_control_;
+  return control.head.load() != control.tail.load();
+}
+
+std::optional<std::vector<std::uint8_t>> ShmTransport::receive_message() {
+  return receive_into<std::vector<std::uint8_t>>(
+      [](std::size_t size) { return std::vector<std::uint8_t>(size); });
+}
+
+std::optional<ENCRYPTO::PooledBuffer> ShmTransport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  return receive_into<ENCRYPTO::PooledBuffer>(
+      [&pool](std::size_t size) { return pool.acquire(size); });
+}
+
+template <typename Buffer, typename AllocateF>
+std::optional<Buffer> ShmTransport::receive_into(AllocateF allocate) {
+  std::array<std::uint8_t, sizeof(std::uint32_t)> message_size_buffer;
+  const auto num_read = impl_->read(message_size_buffer.data(), message_size_buffer.size());
+  if (num_read == 0) {
+    // transport has been closed
+    return std::nullopt;
+  }
+  if (num_read != message_size_buffer.size()) {
+    throw std::runtime_error("Error while reading message size from shared memory: closed");
+  }
+  const std::uint32_t message_size = u8tou32(message_size_buffer);
+  auto message_buffer = allocate(message_size);
+  if (impl_->read(message_buffer.data(), message_size) != message_size) {
+    throw std::runtime_error("Error while reading message from shared memory: closed");
+  }
+  statistics_.num_bytes_received += message_size + sizeof(std::uint32_t);
+  statistics_.num_messages_received += 1;
+  return message_buffer;
+}
+
+void ShmTransport::shutdown_send() {
+  auto& control = impl_->send_control_;
+  control.sender_closed = 1;
+  detail::notify(control.data_seq, control.receiver_waiting);
+}
+
+void ShmTransport::shutdown() {
+  shutdown_send();
+  // also wakes up a local thread blocked in receive_message
+  auto& control = impl_->receive_control_;
+  control.receiver_closed = 1;
+  detail::notify(control.space_seq, control.sender_waiting);
+  detail::notify(control.data_seq, control.receiver_waiting);
+}
+
+ShmSetupHelper::ShmSetupHelper(std::size_t my_id, std::size_t num_parties, std::string name,
+                               std::size_t ring_size)
+    : my_id_(my_id), num_parties_(num_parties), name_(std::move(name)), ring_size_(ring_size) {
+  if (num_parties_ <= 1) {
+    throw std::invalid_argument("specified number of parties: num_parties <= 1");
+  }
+  if (my_id_ >= num_parties_) {
+    throw std::invalid_argument("specified invalid party id: my_id >= num_parties");
+  }
+  if (ring_size_ == 0) {
+    throw std::invalid_argument("specified invalid ring size: ring_size == 0");
+  }
+}
+
+namespace {
+
+using namespace std::chrono_literals;
+
+std::unique_ptr<Transport> create_segment(const std::string& segment_name, std::size_t ring_size,
+                                          int num_retries) {
+  const auto segment_size = detail::get_segment_size(ring_size);
+  int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1 && errno == EEXIST) {
+    // left over from an aborted run
+    shm_unlink(segment_name.c_str());
+    fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  if (fd == -1) {
+    throw std::runtime_error(
+        fmt::format("cannot create shared memory {}: {}", segment_name, std::strerror(errno)));
+  }
+  if (ftruncate(fd, segment_size) == -1) {
+    const auto error = errno;
+    close(fd);
+    shm_unlink(segment_name.c_str());
+    throw std::runtime_error(
+        fmt::format("cannot resize shared memory {}: {}", segment_name, std::strerror(error)));
+  }
+  void* mapping = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const auto mmap_error = errno;
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    shm_unlink(segment_name.c_str());
+    throw std::runtime_error(
+        fmt::format("cannot map shared memory {}: {}", segment_name, std::strerror(mmap_error)));
+  }
+  auto* header = new (mapping) detail::ShmSegmentHeader();
+  header->ring_size = ring_size;
+  header->state = detail::SegmentState::ready;
+  detail::futex_wake(header->state);
+
+  // the name can be removed as soon as the other party has mapped the segment
+  int retry_i = 0;
+  for (; retry_i < num_retries && header->state.load() != detail::SegmentState::attached;
+       ++retry_i) {
+    detail::futex_wait(header->state, detail::SegmentState::ready);
+  }
+  shm_unlink(segment_name.c_str());
+  if (header->state.load() != detail::SegmentState::attached) {
+    munmap(mapping, segment_size);
+    throw std::runtime_error(
+        fmt::format("other party did not attach to shared memory {}", segment_name));
+  }
+  return std::make_unique<ShmTransport>(
+      std::make_unique<detail::ShmTransportImpl>(mapping, segment_size, 0));
+}
+
+std::unique_ptr<Transport> attach_segment(const std::string& segment_name, int num_retries) {
+  for (int retry_i = 0; retry_i < num_retries; ++retry_i) {
+    int fd = shm_open(segment_name.c_str(), O_RDWR, 0600);
+    if (fd == -1) {
+      std::this_thread::sleep_for(100ms);
+      continue;
+    }
+    struct stat segment_stat;
+    if (fstat(fd, &segment_stat) == -1 ||
+        static_cast<std::size_t>(segment_stat.st_size) <= detail::data_offset) {
+      // not yet initialized by the other party
+      close(fd);
+      std::this_thread::sleep_for(100ms);
+      continue;
+    }
+    const auto segment_size = static_cast<std::size_t>(segment_stat.st_size);
+    void* mapping = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error(
+          fmt::format("cannot map shared memory {}: {}", segment_name, std::strerror(errno)));
+    }
+    auto* header = static_cast<detail::ShmSegmentHeader*>(mapping);
+    for (int wait_i = 0;
+         wait_i < num_retries && header->state.load() == detail::SegmentState::initializing;
+         ++wait_i) {
+      detail::futex_wait(header->state, detail::SegmentState::initializing);
+    }
+    if (header->state.load() != detail::SegmentState::ready ||
+        detail::get_segment_size(header->ring_size) != segment_size) {
+      munmap(mapping, segment_size);
+      throw std::runtime_error(fmt::format("shared memory {} is in an invalid state", segment_name));
+    }
+    header->state = detail::SegmentState::attached;
+    detail::futex_wake(header->state);
+    return std::make_unique<ShmTransport>(
+        std::make_unique<detail::ShmTransportImpl>(mapping, segment_size, 1));
+  }
+  throw std::runtime_error(
+      fmt::format("too many errors while trying to open shared memory {}", segment_name));
+}
+
+}  // namespace
+
+std::vector<std::unique_ptr<Transport>> ShmSetupHelper::setup_connections() {
+  std::vector<std::future<std::unique_ptr<Transport>>> futs(num_parties_);
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (party_id == my_id_) {
+      continue;
+    }
+    const auto segment_name = fmt::format("/{}-{}-{}", name_, std::min(my_id_, party_id),
+                                          std::max(my_id_, party_id));
+    if (my_id_ < party_id) {
+      futs.at(party_id) = std::async(std::launch::async, [this, segment_name] {
+        return create_segment(segment_name, ring_size_, num_attach_retries_);
+      });
+    } else {
+      futs.at(party_id) = std::async(std::launch::async, [this, segment_name] {
+        return attach_segment(segment_name, num_attach_retries_);
+      });
+    }
+  }
+  std::vector<std::unique_ptr<Transport>> result(num_parties_);
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (party_id == my_id_) {
+      continue;
+    }
+    // transports already created are destroyed if another one fails
+    result.at(party_id) = futs.at(party_id).get();
+  }
+  return result;
+}
+
+}  // namespace MOTION::Communication
@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "transport.h"
+
+namespace MOTION::Communication {
+
+namespace detail {
+struct ShmTransportImpl;
+}
+
+// Transport between two processes on the same host via a POSIX shared memory segment.  The
+// segment contains one ring buffer for each direction.  Sending copies the message into the ring
+// buffer and receiving copies it out again, waiting parties sleep on a futex in the segment.
+// Each transport may only be used by one sending and one receiving thread at a time.
+class ShmTransport : public Transport {
+ public:
+  ShmTransport(std::unique_ptr<detail::ShmTransportImpl> impl);
+  ShmTransport(ShmTransport&& other);
+
+  // Destructor needs to be defined in implementation due to pimpl
+  ~ShmTransport();
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+  void send_messages(std::span<const std::span<const std::uint8_t>> messages) override;
+
+  bool available() const override;
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool) override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+ private:
+  // read the next message into a buffer obtained from allocate(size)
+  template <typename Buffer, typename AllocateF>
+  std::optional<Buffer> receive_into(AllocateF allocate);
+
+  std::unique_ptr<detail::ShmTransportImpl> impl_;
+};
+
+// Helper class to establish shared memory transports among a set of parties running on the same
+// host, analogous to TCPSetupHelper.  All parties need to use the same name.  For each pair of
+// parties, the party with the smaller ID creates the segment /<name>-<id0>-<id1> and removes its
+// name again as soon as the other party has attached to it.
+class ShmSetupHelper {
+ public:
+  static constexpr std::size_t default_ring_size = std::size_t{16} << 20;
+
+  ShmSetupHelper(std::size_t my_id, std::size_t num_parties, std::string name,
+                 std::size_t ring_size = default_ring_size);
+
+  // Try to establish connections as described above.
+  // Throws a std::runtime_error if something goes wrong.
+  std::vector<std::unique_ptr<Transport>> setup_connections();
+
+ private:
+  std::size_t my_id_;
+  std::size_t num_parties_;
+  std::string name_;
+  std::size_t ring_size_;
+  int num_attach_retries_ = 300;
+};
+
+}  // namespace MOTION::Communication
@@ -22,6 +22,9 @@
 
 #include "sync_handler.h"
 
+#include <algorithm>
+#include <cassert>
+
 #include <fmt/format.h>
 
 #include "fbs_headers/message_generated.h"
@@ -29,15 +32,41 @@
 
 namespace MOTION::Communication {
 
+namespace {
+
+// the stamps cycle through 1, ..., 255, 0 marks an unstamped message
+constexpr std::uint64_t num_stamps = 255;
+
+std::uint8_t make_stamp(std::uint64_t sync_state) noexcept {
+  return static_cast<std::uint8_t>(sync_state % num_stamps + 1);
+}
+
+}  // namespace
+
+SyncHandler::SyncHandler(std::size_t my_id, std::size_t num_parties,
+                         std::shared_ptr<Logger> logger)
+    : my_id_(my_id),
+      num_parties_(num_parties),
+      sync_states_(num_parties_, 0),
+      announced_states_(std::make_unique<std::atomic<std::uint64_t>[]>(num_parties_)),
+      logger_(std::move(logger)) {}
+
+std::uint64_t SyncHandler::increment_my_sync_state() {
+  std::scoped_lock lock(received_sync_states_mutex_);
+  ++my_sync_state_;
+  return ++sync_states_.at(my_id_);
+}
+
 void SyncHandler::received_message(std::size_t party_id, std::vector<std::uint8_t>&& raw_message) {
   assert(!raw_message.empty());
   const auto message =
       Communication::GetMessage(reinterpret_cast<std::uint8_t*>(raw_message.data()));
   auto message_size = message->payload()->size();
-  if (message_size != sizeof(std::uint64_t)) {
+  // longer messages are padded to measure the bandwidth, see CommunicationLayer::measure_network
+  if (message_size < sizeof(std::uint64_t)) {
     if (logger_) {
       logger_->LogError(
-          fmt::format("received SynchronizationMessage from party {} with invalid size {} /= {}",
+          fmt::format("received SynchronizationMessage from party {} with invalid size {} < {}",
                       party_id, message_size, sizeof(std::uint64_t)));
     }
     return;
@@ -49,15 +78,74 @@ void SyncHandler::received_message(std::size_t party_id, std::vector<std::uint8_
     sync_states_.at(party_id) = std::max(received_sync_state, sync_states_.at(party_id));
   }
   sync_states_cv_.notify_all();
+
+  // the party waits for our state, which we have left to our next gate messages
+  const auto my_sync_state = my_sync_state_.load();
+  if (received_sync_state >= my_sync_state && announced_states_[party_id] < my_sync_state &&
+      flush_function_) {
+    announced_states_[party_id] = my_sync_state;
+    flush_function_(party_id);
+  }
+}
+
+std::uint8_t SyncHandler::stamp_epoch(std::size_t party_id) noexcept {
+  const auto my_sync_state = my_sync_state_.load();
+  announced_states_[party_id] = my_sync_state;
+  return make_stamp(my_sync_state);
+}
+
+std::uint8_t SyncHandler::stamp_epoch() noexcept {
+  const auto my_sync_state = my_sync_state_.load();
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    announced_states_[party_id] = my_sync_state;
+  }
+  return make_stamp(my_sync_state);
+}
+
+void SyncHandler::received_epoch(std::size_t party_id, std::uint8_t epoch) {
+  if (epoch == 0) {
+    return;
+  }
+  {
+    std::scoped_lock lock(received_sync_states_mutex_);
+    auto& sync_state = sync_states_.at(party_id);
+    // the parties are at most a few syncs apart, so the stamp determines the state
+    const auto distance = (epoch - 1 + num_stamps - sync_state % num_stamps) % num_stamps;
+    if (distance == 0 || distance > num_stamps / 2) {
+      // nothing new or an older message
+      return;
+    }
+    sync_state += distance;
+  }
+  sync_states_cv_.notify_all();
+}
+
+void SyncHandler::mark_announced() noexcept {
+  const auto my_sync_state = my_sync_state_.load();
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    announced_states_[party_id] = my_sync_state;
+  }
+}
+
+bool SyncHandler::others_reached_locked() const {
+  const auto my_sync_state = sync_states_.at(my_id_);
+  return std::all_of(std::begin(sync_states_), std::end(sync_states_),
+                     [my_sync_state](auto s) { return s >= my_sync_state; });
+}
+
+bool SyncHandler::others_reached() {
+  std::scoped_lock lock(received_sync_states_mutex_);
+  return others_reached_locked();
 }
 
 void SyncHandler::wait() {
-  auto my_sync_state = sync_states_.at(my_id_);
   std::unique_lock lock(received_sync_states_mutex_);
-  sync_states_cv_.wait(lock, [this, my_sync_state] {
-    return std::all_of(std::begin(sync_states_), std::end(sync_states_),
-                       [my_sync_state](auto s) { return s >= my_sync_state; });
-  });
+  sync_states_cv_.wait(lock, [this] { return others_reached_locked(); });
+}
+
+bool SyncHandler::wait_for(std::chrono::microseconds timeout) {
+  std::unique_lock lock(received_sync_states_mutex_);
+  return sync_states_cv_.wait_for(lock, timeout, [this] { return others_reached_locked(); });
 }
 
 }  // namespace MOTION::Communication
@@ -22,8 +22,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -35,25 +40,51 @@ class Logger;
 
 namespace Communication {
 
+// Counts the sync() calls of all parties.  Besides the SynchronizationMessages, the states of the
+// other parties are learned from the epoch stamped on their gate messages: a gate message sent
+// after a party has entered its n-th sync() proves that it has reached this point.
 class SyncHandler : public MessageHandler {
  public:
-  SyncHandler(std::size_t my_id, std::size_t num_parties, std::shared_ptr<Logger> logger)
-      : my_id_(my_id),
-        num_parties_(num_parties),
-        sync_states_(num_parties_, 0),
-        logger_(std::move(logger)) {}
-  std::uint64_t increment_my_sync_state() { return ++sync_states_.at(my_id_); }
+  SyncHandler(std::size_t my_id, std::size_t num_parties, std::shared_ptr<Logger> logger);
+  std::uint64_t increment_my_sync_state();
+  std::uint64_t get_my_sync_state() const noexcept { return my_sync_state_.load(); }
   void received_message(std::size_t party_id, std::vector<std::uint8_t>&& message) override;
+
+  // byte to stamp on a compact gate message to the given party (or to all parties), which then
+  // knows that we have reached our current state
+  std::uint8_t stamp_epoch(std::size_t party_id) noexcept;
+  std::uint8_t stamp_epoch() noexcept;
+  // a compact gate message with the given stamp has been received
+  void received_epoch(std::size_t party_id, std::uint8_t epoch);
+  // our current state has been sent to all parties in a SynchronizationMessage
+  void mark_announced() noexcept;
+
+  // have all other parties reached our current state?
+  bool others_reached();
   void wait();
+  // returns false if the other parties have not reached our state within the timeout
+  bool wait_for(std::chrono::microseconds timeout);
   std::mutex& get_mutex() { return this_party_mutex_; }
 
+  // called with the id of a party which waits for us, but has not been told our current state yet
+  // (see CommunicationLayer::set_lazy_sync())
+  void set_flush_function(std::function<void(std::size_t party_id)> flush_function) {
+    flush_function_ = std::move(flush_function);
+  }
+
  private:
+  bool others_reached_locked() const;
+
   std::size_t my_id_;
   std::size_t num_parties_;
   std::mutex this_party_mutex_;
   std::mutex received_sync_states_mutex_;
   std::condition_variable sync_states_cv_;
   std::vector<std::uint64_t> sync_states_;
+  std::atomic<std::uint64_t> my_sync_state_{0};
+  // highest of our states each party has been told
+  std::unique_ptr<std::atomic<std::uint64_t>[]> announced_states_;
+  std::function<void(std::size_t party_id)> flush_function_;
   std::shared_ptr<Logger> logger_;
 };
 
@@ -22,11 +22,24 @@
 
 #include "tcp_transport.h"
 
+#include <array>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
+#include <exception>
 #include <future>
+#include <iterator>
+#include <limits>
+#include <span>
 #include <thread>
 #include <shared_mutex>
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <boost/asio/connect.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/asio/io_context.hpp>
@@ -36,6 +49,8 @@
 #include <boost/system/error_code.hpp>
 #include <fmt/format.h>
 
+#include "uring_transport.h"
+
 using boost::asio::ip::tcp;
 
 namespace MOTION::Communication {
@@ -48,10 +63,49 @@ struct TCPTransportImpl {
   std::shared_ptr<boost::asio::io_context> io_context_;
   boost::asio::ip::tcp::socket socket_;
   std::shared_mutex socket_mutex_;
+  std::atomic<TransportMode> mode_ = TransportMode::throughput;
 };
 
 }  // namespace detail
 
+namespace {
+
+// boost::asio passes at most this many buffers to one writev
+constexpr std::size_t max_buffers_per_write = 64;
+// in throughput mode, batches of at least this many bytes are corked
+constexpr std::size_t cork_threshold = std::size_t{64} << 10;
+
+// Corks the socket while a batch is written if the transport is in throughput mode and the batch
+// probably needs several writes.  Otherwise, TCP_NODELAY would send the last partial segment of
+// each write on its own.  Uncorking in the destructor flushes the remaining data.
+class CorkGuard {
+ public:
+  CorkGuard(detail::TCPTransportImpl& impl, std::size_t num_buffers, std::size_t num_bytes)
+      : impl_(impl),
+        corked_(impl.mode_ == TransportMode::throughput &&
+                (num_buffers > max_buffers_per_write || num_bytes >= cork_threshold)) {
+    if (corked_) {
+      set_cork(1);
+    }
+  }
+  ~CorkGuard() {
+    if (corked_) {
+      set_cork(0);
+    }
+  }
+
+ private:
+  void set_cork(int value) {
+    // errors can be ignored, since corking only affects the segmentation
+    ::setsockopt(impl_.socket_.native_handle(), IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+  }
+
+  detail::TCPTransportImpl& impl_;
+  bool corked_;
+};
+
+}  // namespace
+
 TCPTransport::TCPTransport(std::unique_ptr<detail::TCPTransportImpl> impl)
     : is_connected_(true), impl_(std::move(impl)) {}
 
@@ -104,7 +158,10 @@ void TCPTransport::send_message(const std::uint8_t* message, std::size_t size) {
 
   boost::system::error_code ec;
   std::shared_lock lock(impl_->socket_mutex_);
-  boost::asio::write(impl_->socket_, buffers, boost::asio::transfer_all(), ec);
+  {
+    CorkGuard cork(*impl_, buffers.size(), size + sizeof(std::uint32_t));
+    boost::asio::write(impl_->socket_, buffers, boost::asio::transfer_all(), ec);
+  }
   if (ec) {
     throw std::runtime_error(fmt::format("Error while writing to socket: {}", ec.message()));
   }
@@ -112,6 +169,41 @@ void TCPTransport::send_message(const std::uint8_t* message, std::size_t size) {
   statistics_.num_messages_sent += 1;
 }
 
+void TCPTransport::send_messages(std::span<const std::span<const std::uint8_t>> messages) {
+  const auto num_messages = messages.size();
+  std::vector<std::array<std::uint8_t, sizeof(std::uint32_t)>> message_sizes(num_messages);
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.reserve(2 * num_messages);
+  std::size_t num_bytes = 0;
+  for (std::size_t message_i = 0; message_i < num_messages; ++message_i) {
+    const auto& message = messages[message_i];
+    if (message.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error(fmt::format("Max message size is {} B but tried to send {} B",
+                                           std::numeric_limits<std::uint32_t>::max(),
+                                           message.size()));
+    }
+    u32tou8(message.size(), message_sizes[message_i].data());
+    buffers.push_back(boost::asio::buffer(message_sizes[message_i]));
+    buffers.push_back(boost::asio::buffer(message.data(), message.size()));
+    num_bytes += message.size() + sizeof(std::uint32_t);
+  }
+
+  boost::system::error_code ec;
+  std::shared_lock lock(impl_->socket_mutex_);
+  {
+    CorkGuard cork(*impl_, buffers.size(), num_bytes);
+    // asio splits the buffer sequence into as few writev calls as the iovec limit allows
+    boost::asio::write(impl_->socket_, buffers, boost::asio::transfer_all(), ec);
+  }
+  if (ec) {
+    throw std::runtime_error(fmt::format("Error while writing to socket: {}", ec.message()));
+  }
+  statistics_.num_bytes_sent += num_bytes;
+  statistics_.num_messages_sent += num_messages;
+}
+
+void TCPTransport::set_mode(TransportMode mode) { impl_->mode_ = mode; }
+
 static std::uint32_t u8tou32(std::array<std::uint8_t, sizeof(std::uint32_t)>& v) {
   std::uint32_t result = 0;
   for (auto i = 0u; i < sizeof(std::uint32_t); ++i) {
@@ -121,6 +213,18 @@ static std::uint32_t u8tou32(std::array<std::uint8_t, sizeof(std::uint32_t)>& v)
 }
 
 std::optional<std::vector<std::uint8_t>> TCPTransport::receive_message() {
+  return receive_into<std::vector<std::uint8_t>>(
+      [](std::size_t size) { return std::vector<std::uint8_t>(size); });
+}
+
+std::optional<ENCRYPTO::PooledBuffer> TCPTransport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  return receive_into<ENCRYPTO::PooledBuffer>(
+      [&pool](std::size_t size) { return pool.acquire(size); });
+}
+
+template <typename Buffer, typename AllocateF>
+std::optional<Buffer> TCPTransport::receive_into(AllocateF allocate) {
   std::array<std::uint8_t, sizeof(std::uint32_t)> message_size_buffer;
   boost::system::error_code ec;
   std::shared_lock lock(impl_->socket_mutex_);
@@ -140,9 +244,9 @@ std::optional<std::vector<std::uint8_t>> TCPTransport::receive_message() {
                                          ec.message(), ec.value()));
   }
   std::uint32_t message_size = u8tou32(message_size_buffer);
-  std::vector<std::uint8_t> message_buffer(message_size);
-  boost::asio::read(impl_->socket_, boost::asio::buffer(message_buffer),
-                    boost::asio::transfer_exactly(message_buffer.size()), ec);
+  auto message_buffer = allocate(message_size);
+  boost::asio::read(impl_->socket_, boost::asio::buffer(message_buffer.data(), message_size),
+                    boost::asio::transfer_exactly(message_size), ec);
   if (ec) {
     throw std::runtime_error(
         fmt::format("Error while reading message size socket: {} ({})", ec.message(), ec.value()));
@@ -152,26 +256,247 @@ std::optional<std::vector<std::uint8_t>> TCPTransport::receive_message() {
   return message_buffer;
 }
 
+namespace {
+
+// [total size, number of chunks] in front of each message on the first stream
+using stream_header_t = std::array<std::uint8_t, 2 * sizeof(std::uint32_t)>;
+
+// split size bytes into num_chunks almost equally sized chunks, returns [offset, size] of a chunk
+std::pair<std::size_t, std::size_t> get_chunk(std::size_t size, std::size_t num_chunks,
+                                              std::size_t chunk_i) {
+  const auto chunk_size = (size + num_chunks - 1) / num_chunks;
+  const auto offset = std::min(size, chunk_i * chunk_size);
+  return {offset, std::min(chunk_size, size - offset)};
+}
+
+template <typename ConstBufferSequence>
+void write_to_socket(detail::TCPTransportImpl& impl, const ConstBufferSequence& buffers) {
+  boost::system::error_code ec;
+  std::shared_lock lock(impl.socket_mutex_);
+  {
+    CorkGuard cork(impl,
+                   std::distance(boost::asio::buffer_sequence_begin(buffers),
+                                 boost::asio::buffer_sequence_end(buffers)),
+                   boost::asio::buffer_size(buffers));
+    boost::asio::write(impl.socket_, buffers, boost::asio::transfer_all(), ec);
+  }
+  if (ec) {
+    throw std::runtime_error(fmt::format("Error while writing to socket: {}", ec.message()));
+  }
+}
+
+// returns false if the connection has been closed before any data was read
+bool read_from_socket(detail::TCPTransportImpl& impl, boost::asio::mutable_buffer buffer) {
+  boost::system::error_code ec;
+  std::shared_lock lock(impl.socket_mutex_);
+  boost::asio::read(impl.socket_, buffer, boost::asio::transfer_exactly(buffer.size()), ec);
+  if (ec) {
+    if (ec.value() == boost::asio::error::misc_errors::eof) {
+      return false;
+    }
+    throw std::runtime_error(
+        fmt::format("Error while reading from socket: {} ({})", ec.message(), ec.value()));
+  }
+  return true;
+}
+
+}  // namespace
+
+MultiStreamTCPTransport::MultiStreamTCPTransport(
+    std::vector<std::unique_ptr<detail::TCPTransportImpl>> impls, std::size_t striping_threshold)
+    : striping_threshold_(striping_threshold), impls_(std::move(impls)) {
+  if (impls_.empty()) {
+    throw std::invalid_argument("MultiStreamTCPTransport needs at least one connection");
+  }
+}
+
+MultiStreamTCPTransport::~MultiStreamTCPTransport() = default;
+
+bool MultiStreamTCPTransport::available() const {
+  std::scoped_lock lock(impls_.front()->socket_mutex_);
+  return impls_.front()->socket_.available() > 0;
+}
+
+void MultiStreamTCPTransport::set_mode(TransportMode mode) {
+  for (auto& impl : impls_) {
+    impl->mode_ = mode;
+  }
+}
+
+void MultiStreamTCPTransport::shutdown_send() {
+  for (auto& impl : impls_) {
+    std::scoped_lock lock(impl->socket_mutex_);
+    boost::system::error_code ec;
+    impl->socket_.shutdown(tcp::socket::shutdown_send, ec);
+  }
+}
+
+void MultiStreamTCPTransport::shutdown() {
+  for (auto& impl : impls_) {
+    std::scoped_lock lock(impl->socket_mutex_);
+    boost::system::error_code ec;
+    impl->socket_.shutdown(tcp::socket::shutdown_both, ec);
+    impl->socket_.close(ec);
+  }
+}
+
+void MultiStreamTCPTransport::send_message(std::vector<std::uint8_t>&& message) {
+  send_message(message.data(), message.size());
+}
+
+void MultiStreamTCPTransport::send_message(const std::vector<std::uint8_t>& message) {
+  send_message(message.data(), message.size());
+}
+
+void MultiStreamTCPTransport::send_message(const std::uint8_t* message, std::size_t size) {
+  send_messages(std::array{std::span<const std::uint8_t>(message, size)});
+}
+
+void MultiStreamTCPTransport::send_messages(
+    std::span<const std::span<const std::uint8_t>> messages) {
+  const auto num_streams = impls_.size();
+  std::vector<stream_header_t> headers(messages.size());
+  std::vector<boost::asio::const_buffer> buffers;
+
+  // messages below the threshold are collected and written with one gathering write to the first
+  // stream, they need to be flushed before a striped message to keep the order
+  auto flush = [this, &buffers] {
+    if (!buffers.empty()) {
+      write_to_socket(*impls_.front(), buffers);
+      buffers.clear();
+    }
+  };
+
+  for (std::size_t message_i = 0; message_i < messages.size(); ++message_i) {
+    const auto message = messages[message_i];
+    const auto size = message.size();
+    if (size > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error(fmt::format("Max message size is {} B but tried to send {} B",
+                                           std::numeric_limits<std::uint32_t>::max(), size));
+    }
+    const std::size_t num_chunks = (size >= striping_threshold_) ? num_streams : 1;
+    auto& header = headers[message_i];
+    u32tou8(size, header.data());
+    u32tou8(num_chunks, header.data() + sizeof(std::uint32_t));
+    buffers.push_back(boost::asio::buffer(header));
+    if (num_chunks == 1) {
+      buffers.push_back(boost::asio::buffer(message.data(), size));
+    } else {
+      // write the chunks to all streams concurrently
+      std::vector<std::future<void>> futs;
+      futs.reserve(num_chunks - 1);
+      for (std::size_t chunk_i = 1; chunk_i < num_chunks; ++chunk_i) {
+        const auto [offset, chunk_size] = get_chunk(size, num_chunks, chunk_i);
+        futs.emplace_back(std::async(std::launch::async, [this, chunk_i, message, offset = offset,
+                                                          chunk_size = chunk_size] {
+          write_to_socket(*impls_.at(chunk_i),
+                          boost::asio::buffer(message.data() + offset, chunk_size));
+        }));
+      }
+      const auto [offset, chunk_size] = get_chunk(size, num_chunks, 0);
+      buffers.push_back(boost::asio::buffer(message.data() + offset, chunk_size));
+      flush();
+      for (auto& fut : futs) {
+        fut.get();
+      }
+    }
+    statistics_.num_bytes_sent += size + sizeof(stream_header_t);
+  }
+  flush();
+  statistics_.num_messages_sent += messages.size();
+}
+
+std::optional<std::vector<std::uint8_t>> MultiStreamTCPTransport::receive_message() {
+  return receive_into<std::vector<std::uint8_t>>(
+      [](std::size_t size) { return std::vector<std::uint8_t>(size); });
+}
+
+std::optional<ENCRYPTO::PooledBuffer> MultiStreamTCPTransport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  return receive_into<ENCRYPTO::PooledBuffer>(
+      [&pool](std::size_t size) { return pool.acquire(size); });
+}
+
+template <typename Buffer, typename AllocateF>
+std::optional<Buffer> MultiStreamTCPTransport::receive_into(AllocateF allocate) {
+  auto& first_impl = *impls_.front();
+  {
+    boost::system::error_code ec;
+    std::shared_lock lock(first_impl.socket_mutex_);
+    first_impl.socket_.wait(tcp::socket::wait_read, ec);
+    if (ec) {
+      throw std::runtime_error(
+          fmt::format("Error while wait read on socket: {} ({})", ec.message(), ec.value()));
+    }
+  }
+  stream_header_t header;
+  if (!read_from_socket(first_impl, boost::asio::buffer(header))) {
+    // connection has been closed
+    return std::nullopt;
+  }
+  std::array<std::uint8_t, sizeof(std::uint32_t)> field;
+  std::copy_n(std::begin(header), sizeof(std::uint32_t), std::begin(field));
+  const std::size_t size = u8tou32(field);
+  std::copy_n(std::begin(header) + sizeof(std::uint32_t), sizeof(std::uint32_t),
+              std::begin(field));
+  const std::size_t num_chunks = u8tou32(field);
+  if (num_chunks == 0 || num_chunks > impls_.size()) {
+    throw std::runtime_error(
+        fmt::format("received message striped over {} streams, but only {} are connected",
+                    num_chunks, impls_.size()));
+  }
+
+  auto message_buffer = allocate(size);
+  std::vector<std::future<bool>> futs;
+  futs.reserve(num_chunks - 1);
+  for (std::size_t chunk_i = 1; chunk_i < num_chunks; ++chunk_i) {
+    const auto [offset, chunk_size] = get_chunk(size, num_chunks, chunk_i);
+    futs.emplace_back(std::async(std::launch::async, [this, chunk_i, &message_buffer,
+                                                      offset = offset, chunk_size = chunk_size] {
+      return read_from_socket(*impls_.at(chunk_i),
+                              boost::asio::buffer(message_buffer.data() + offset, chunk_size));
+    }));
+  }
+  const auto [offset, chunk_size] = get_chunk(size, num_chunks, 0);
+  bool complete = read_from_socket(
+      first_impl, boost::asio::buffer(message_buffer.data() + offset, chunk_size));
+  for (auto& fut : futs) {
+    complete &= fut.get();
+  }
+  if (!complete) {
+    throw std::runtime_error("connection has been closed while receiving a striped message");
+  }
+  statistics_.num_bytes_received += size + sizeof(stream_header_t);
+  statistics_.num_messages_received += 1;
+  return message_buffer;
+}
+
 using namespace std::chrono_literals;
 
 struct TCPSetupHelper::TCPSetupImpl {
-  [[nodiscard]] std::map<std::size_t, tcp::socket> accept_task();
-  [[nodiscard]] tcp::socket connect_task(std::size_t other_id, std::string host,
-                                         std::uint16_t port);
+  [[nodiscard]] std::map<std::size_t, std::vector<tcp::socket>> accept_task();
+  [[nodiscard]] std::vector<tcp::socket> connect_task(std::size_t other_id, std::string host,
+                                                      std::uint16_t port);
+  [[nodiscard]] tcp::socket connect_stream(std::size_t other_id, std::size_t stream_i,
+                                           const tcp::resolver::results_type& endpoints,
+                                           const std::string& host, std::uint16_t port);
 
   std::size_t my_id_;
   std::size_t num_parties_;
+  std::size_t num_streams_;
   int num_connect_retries_ = 10;
   decltype(1s) retry_delay_ = 3s;
   boost::asio::ip::address bind_address_;
   std::uint16_t bind_port_;
   std::shared_ptr<boost::asio::io_context> io_context_;
-  std::map<std::size_t, tcp::socket> sockets_;
+  std::map<std::size_t, std::vector<tcp::socket>> sockets_;
 };
 
-TCPSetupHelper::TCPSetupHelper(std::size_t my_id, const tcp_parties_config& parties_config)
+TCPSetupHelper::TCPSetupHelper(std::size_t my_id, const tcp_parties_config& parties_config,
+                               std::size_t num_streams)
     : my_id_(my_id),
       num_parties_(parties_config.size()),
+      num_streams_(num_streams),
       parties_config_(parties_config),
       impl_(std::make_unique<TCPSetupImpl>()) {
   // check arguments
@@ -181,10 +506,14 @@ TCPSetupHelper::TCPSetupHelper(std::size_t my_id, const tcp_parties_config& part
   if (my_id_ >= num_parties_) {
     throw std::invalid_argument("specified invalid party id: my_id >= parties_config.size()");
   }
+  if (num_streams_ == 0) {
+    throw std::invalid_argument("specified invalid number of streams: num_streams == 0");
+  }
   boost::system::error_code ec;
   auto my_config = parties_config_[my_id_];
   impl_->my_id_ = my_id_;
   impl_->num_parties_ = num_parties_;
+  impl_->num_streams_ = num_streams_;
   impl_->bind_port_ = std::get<1>(my_config);
   impl_->bind_address_ = boost::asio::ip::make_address(std::get<0>(my_config), ec);
   if (ec) {
@@ -197,8 +526,16 @@ TCPSetupHelper::TCPSetupHelper(std::size_t my_id, const tcp_parties_config& part
 TCPSetupHelper::~TCPSetupHelper() = default;
 
 std::vector<std::unique_ptr<Transport>> TCPSetupHelper::setup_connections() {
+  if (use_io_uring_) {
+    if (num_streams_ != 1) {
+      throw std::invalid_argument("io_uring is only supported with a single stream per party");
+    }
+    if (!is_io_uring_available()) {
+      throw std::runtime_error("io_uring is not available");
+    }
+  }
   auto accept_fut = std::async(std::launch::async, [this] { return impl_->accept_task(); });
-  std::vector<std::future<tcp::socket>> futs;
+  std::vector<std::future<std::vector<tcp::socket>>> futs;
   for (std::size_t party_id = 0; party_id < my_id_; ++party_id) {
     auto party_config = parties_config_.at(party_id);
     futs.emplace_back(std::async(std::launch::async, [this, party_id, party_config] {
@@ -213,33 +550,75 @@ std::vector<std::unique_ptr<Transport>> TCPSetupHelper::setup_connections() {
   } catch (std::runtime_error& e) {
     // an error happened => close all other sockets
     std::for_each(std::begin(impl_->sockets_), std::end(impl_->sockets_), [](auto& it) {
-      auto& socket = it.second;
-      if (socket.is_open()) {
-        boost::system::error_code ec;
-        socket.shutdown(tcp::socket::shutdown_type::shutdown_both, ec);
-        socket.close(ec);
-        // socket is closed even if error occures
+      for (auto& socket : it.second) {
+        if (socket.is_open()) {
+          boost::system::error_code ec;
+          socket.shutdown(tcp::socket::shutdown_type::shutdown_both, ec);
+          socket.close(ec);
+          // socket is closed even if error occures
+        }
       }
     });
     throw;
   }
 
+  for (auto& [party_id, sockets] : impl_->sockets_) {
+    for (auto& socket : sockets) {
+      boost::system::error_code ec;
+      socket.set_option(tcp::no_delay(true), ec);
+      if (ec) {
+        throw std::runtime_error(fmt::format("Error while setting TCP_NODELAY: {}", ec.message()));
+      }
+    }
+  }
+
   std::vector<std::unique_ptr<Transport>> result(num_parties_);
+  if (use_io_uring_) {
+    std::vector<std::size_t> party_ids;
+    std::vector<int> socket_fds;
+    for (auto& [party_id, sockets] : impl_->sockets_) {
+      // the event loop takes ownership of a duplicate of the socket
+      auto fd = ::dup(sockets.front().native_handle());
+      boost::system::error_code ec;
+      sockets.front().close(ec);
+      if (fd < 0) {
+        for (auto other_fd : socket_fds) {
+          ::close(other_fd);
+        }
+        throw std::runtime_error(fmt::format("dup of socket failed: {}", std::strerror(errno)));
+      }
+      party_ids.push_back(party_id);
+      socket_fds.push_back(fd);
+    }
+    auto transports = make_uring_tcp_transports(std::move(socket_fds));
+    for (std::size_t i = 0; i < party_ids.size(); ++i) {
+      result.at(party_ids[i]) = std::move(transports[i]);
+    }
+    return result;
+  }
   std::for_each(std::begin(impl_->sockets_), std::end(impl_->sockets_), [this, &result](auto& it) {
-    auto transport_impl =
-        std::make_unique<detail::TCPTransportImpl>(impl_->io_context_, std::move(it.second));
-    result.at(it.first) = std::make_unique<TCPTransport>(std::move(transport_impl));
+    std::vector<std::unique_ptr<detail::TCPTransportImpl>> transport_impls;
+    for (auto& socket : it.second) {
+      transport_impls.emplace_back(
+          std::make_unique<detail::TCPTransportImpl>(impl_->io_context_, std::move(socket)));
+    }
+    if (num_streams_ == 1) {
+      result.at(it.first) = std::make_unique<TCPTransport>(std::move(transport_impls.front()));
+    } else {
+      result.at(it.first) = std::make_unique<MultiStreamTCPTransport>(std::move(transport_impls));
+    }
   });
   return result;
 }
 
-std::map<std::size_t, tcp::socket> TCPSetupHelper::TCPSetupImpl::accept_task() {
+std::map<std::size_t, std::vector<tcp::socket>> TCPSetupHelper::TCPSetupImpl::accept_task() {
   if (my_id_ == num_parties_ - 1) {
     return {};
   }
-  std::map<std::size_t, tcp::socket> sockets;
+  // (party id, stream index) -> socket
+  std::map<std::pair<std::size_t, std::size_t>, tcp::socket> sockets;
   std::size_t num_accepted = 0;
-  std::size_t expected_connections = num_parties_ - my_id_ - 1;
+  std::size_t expected_connections = (num_parties_ - my_id_ - 1) * num_streams_;
   boost::system::error_code ec;
   tcp::acceptor acceptor(*io_context_, tcp::endpoint(bind_address_, bind_port_),
                          /* reuse_addr = */ true);
@@ -254,24 +633,26 @@ std::map<std::size_t, tcp::socket> TCPSetupHelper::TCPSetupImpl::accept_task() {
       throw std::runtime_error(fmt::format("error occurred on accept: {}\n", ec.message()));
     }
     std::size_t other_id;
-    // receive other id
+    std::size_t stream_i;
+    // receive other id and the index of the stream
     {
-      std::uint64_t received_id;
-      boost::asio::read(socket, boost::asio::mutable_buffer(&received_id, sizeof(received_id)), ec);
+      std::array<std::uint64_t, 2> received;
+      boost::asio::read(socket, boost::asio::buffer(received), ec);
       if (ec) {
         socket.close();
         continue;
       }
-      other_id = static_cast<std::size_t>(received_id);
+      other_id = static_cast<std::size_t>(received[0]);
+      stream_i = static_cast<std::size_t>(received[1]);
     }
     // validate received id
-    if (other_id <= my_id_ || other_id >= num_parties_) {
+    if (other_id <= my_id_ || other_id >= num_parties_ || stream_i >= num_streams_) {
       // invalid_id
       socket.close();
       continue;
     }
     // check if we are already connected to this party
-    if (auto it = sockets.find(static_cast<std::size_t>(other_id)); it != sockets.end()) {
+    if (auto it = sockets.find({other_id, stream_i}); it != sockets.end()) {
       socket.close();
       continue;
     }
@@ -285,21 +666,63 @@ std::map<std::size_t, tcp::socket> TCPSetupHelper::TCPSetupImpl::accept_task() {
       }
     }
     // success
-    sockets.emplace(std::make_pair(other_id, std::move(socket)));
+    sockets.emplace(std::make_pair(other_id, stream_i), std::move(socket));
     ++num_accepted;
   }
-  return sockets;
+  // the map is ordered by stream index for each party
+  std::map<std::size_t, std::vector<tcp::socket>> result;
+  for (auto& [key, socket] : sockets) {
+    result[key.first].emplace_back(std::move(socket));
+  }
+  return result;
 }
 
-tcp::socket TCPSetupHelper::TCPSetupImpl::connect_task(std::size_t other_id, std::string host,
-                                                       std::uint16_t port) {
+std::vector<tcp::socket> TCPSetupHelper::TCPSetupImpl::connect_task(std::size_t other_id,
+                                                                    std::string host,
+                                                                    std::uint16_t port) {
   boost::system::error_code ec;
-  tcp::socket socket(*io_context_);
   tcp::resolver resolver(*io_context_);
   auto endpoints = resolver.resolve(host, std::to_string(port), ec);
   if (ec) {
     throw std::runtime_error(fmt::format("cannot resolve {}:{}, {}\n", host, port, ec.message()));
   }
+  std::vector<tcp::socket> sockets;
+  sockets.reserve(num_streams_);
+  if (num_streams_ == 1) {
+    sockets.emplace_back(connect_stream(other_id, 0, endpoints, host, port));
+    return sockets;
+  }
+  // connect the streams concurrently, s.t. their retries and handshakes overlap
+  std::vector<std::future<tcp::socket>> futs;
+  futs.reserve(num_streams_);
+  for (std::size_t stream_i = 0; stream_i < num_streams_; ++stream_i) {
+    futs.emplace_back(std::async(std::launch::async, [this, other_id, stream_i, &endpoints, &host,
+                                                      port] {
+      return connect_stream(other_id, stream_i, endpoints, host, port);
+    }));
+  }
+  std::exception_ptr error;
+  for (auto& fut : futs) {
+    try {
+      sockets.emplace_back(fut.get());
+    } catch (std::runtime_error&) {
+      // wait for the other streams before rethrowing, they refer to the endpoints
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return sockets;
+}
+
+tcp::socket TCPSetupHelper::TCPSetupImpl::connect_stream(
+    std::size_t other_id, std::size_t stream_i, const tcp::resolver::results_type& endpoints,
+    const std::string& host, std::uint16_t port) {
+  boost::system::error_code ec;
+  tcp::socket socket(*io_context_);
   int connect_retry_i = 0;
   for (; connect_retry_i < num_connect_retries_; ++connect_retry_i) {
     boost::asio::connect(socket, endpoints, ec);
@@ -308,10 +731,11 @@ tcp::socket TCPSetupHelper::TCPSetupImpl::connect_task(std::size_t other_id, std
       continue;
     }
 
-    // send my id to the peer
+    // send my id and the index of the stream to the peer
     {
-      std::uint64_t own_id = static_cast<std::uint64_t>(my_id_);
-      boost::asio::write(socket, boost::asio::const_buffer(&own_id, sizeof(own_id)), ec);
+      std::array<std::uint64_t, 2> own_id = {static_cast<std::uint64_t>(my_id_),
+                                             static_cast<std::uint64_t>(stream_i)};
+      boost::asio::write(socket, boost::asio::buffer(own_id), ec);
       if (ec) {
         socket.close();
         continue;
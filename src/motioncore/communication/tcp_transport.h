@@ -24,6 +24,7 @@
 
 #include <map>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -46,17 +47,61 @@ class TCPTransport : public Transport {
   void send_message(std::vector<std::uint8_t>&& message) override;
   void send_message(const std::vector<std::uint8_t>& message) override;
   void send_message(const std::uint8_t* message, std::size_t size) override;
+  // write all messages with a single gathering write, payloads are not copied
+  void send_messages(std::span<const std::span<const std::uint8_t>> messages) override;
+  void set_mode(TransportMode mode) override;
 
   bool available() const override;
   std::optional<std::vector<std::uint8_t>> receive_message() override;
+  std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool) override;
   void shutdown_send() override;
   void shutdown() override;
 
  private:
+  // read the next message into a buffer obtained from allocate(size)
+  template <typename Buffer, typename AllocateF>
+  std::optional<Buffer> receive_into(AllocateF allocate);
+
   bool is_connected_;
   std::unique_ptr<detail::TCPTransportImpl> impl_;
 };
 
+// Transport using several TCP connections to the same peer to utilize more bandwidth.  Messages
+// of at least striping_threshold bytes are split into one chunk per connection, and the chunks
+// are written and read concurrently.  Smaller messages use only the first connection.
+class MultiStreamTCPTransport : public Transport {
+ public:
+  static constexpr std::size_t default_striping_threshold = std::size_t{1} << 20;
+
+  MultiStreamTCPTransport(std::vector<std::unique_ptr<detail::TCPTransportImpl>> impls,
+                          std::size_t striping_threshold = default_striping_threshold);
+
+  // Destructor needs to be defined in implementation due to pimpl
+  ~MultiStreamTCPTransport();
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+  void send_messages(std::span<const std::span<const std::uint8_t>> messages) override;
+  void set_mode(TransportMode mode) override;
+
+  bool available() const override;
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool) override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+  std::size_t get_num_streams() const noexcept { return impls_.size(); }
+
+ private:
+  // read the next message into a buffer obtained from allocate(size)
+  template <typename Buffer, typename AllocateF>
+  std::optional<Buffer> receive_into(AllocateF allocate);
+
+  std::size_t striping_threshold_;
+  std::vector<std::unique_ptr<detail::TCPTransportImpl>> impls_;
+};
+
 using tcp_connection_config = std::pair<std::string, std::uint16_t>;
 using tcp_parties_config = std::vector<tcp_connection_config>;
 
@@ -64,14 +109,21 @@ using tcp_parties_config = std::vector<tcp_connection_config>;
 // parties.  Given the ID of the local party and a collection of host and port
 // for all parties, connections are created as follows: This party tries to
 // connect to all parties with smaller IDs, and it accepts connections from the
-// parties with larger IDs.
+// parties with larger IDs.  With num_streams > 1, that many connections are opened to each party
+// and combined into a MultiStreamTCPTransport.  All connections use TCP_NODELAY, the transports
+// start in TransportMode::throughput.
 class TCPSetupHelper {
  public:
-  TCPSetupHelper(std::size_t my_id, const tcp_parties_config& parties_config);
+  TCPSetupHelper(std::size_t my_id, const tcp_parties_config& parties_config,
+                 std::size_t num_streams = 1);
 
   // Destructor needs to be defined in implementation due to pimpl
   ~TCPSetupHelper();
 
+  // Drive the established connections by a single io_uring event loop (see UringTCPTransport)
+  // instead of blocking socket calls.  Only supported with one stream per party.
+  void set_use_io_uring(bool use_io_uring) noexcept { use_io_uring_ = use_io_uring; }
+
   // Try to establish connections as described above.
   // Throws a std::runtime_error if something goes wrong.
   std::vector<std::unique_ptr<Transport>> setup_connections();
@@ -81,6 +133,8 @@ class TCPSetupHelper {
 
   std::size_t my_id_;
   std::size_t num_parties_;
+  std::size_t num_streams_;
+  bool use_io_uring_ = false;
   bool connections_open = false;
   const tcp_parties_config parties_config_;
   std::unique_ptr<TCPSetupImpl> impl_;
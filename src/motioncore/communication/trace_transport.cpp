@@ -0,0 +1,241 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "trace_transport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace MOTION::Communication {
+
+RecordingTransport::RecordingTransport(std::unique_ptr<Transport> transport,
+                                       const std::string& path)
+    : transport_(std::move(transport)),
+      start_time_(clock_type::now()),
+      file_(path, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw std::runtime_error(fmt::format("RecordingTransport: could not create {}", path));
+  }
+  file_.write(trace_magic, sizeof(trace_magic));
+}
+
+void RecordingTransport::send_message(std::vector<std::uint8_t>&& message) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += message.size();
+  transport_->send_message(std::move(message));
+}
+
+void RecordingTransport::send_message(const std::vector<std::uint8_t>& message) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += message.size();
+  transport_->send_message(message);
+}
+
+void RecordingTransport::send_message(const std::uint8_t* message, std::size_t size) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += size;
+  transport_->send_message(message, size);
+}
+
+void RecordingTransport::send_messages(std::span<const std::span<const std::uint8_t>> messages) {
+  for (const auto& message : messages) {
+    statistics_.num_messages_sent += 1;
+    statistics_.num_bytes_sent += message.size();
+  }
+  transport_->send_messages(messages);
+}
+
+void RecordingTransport::set_mode(TransportMode mode) { transport_->set_mode(mode); }
+
+bool RecordingTransport::available() const { return transport_->available(); }
+
+void RecordingTransport::write_record(std::uint64_t size, const std::uint8_t* data) {
+  const std::uint64_t time_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start_time_)
+          .count();
+  std::scoped_lock lock(file_mutex_);
+  file_.write(reinterpret_cast<const char*>(&time_ns), sizeof(time_ns));
+  file_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  if (size == end_of_trace) {
+    file_.flush();
+  } else {
+    file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+  }
+}
+
+std::optional<std::vector<std::uint8_t>> RecordingTransport::receive_message() {
+  auto message_opt = transport_->receive_message();
+  if (message_opt.has_value()) {
+    write_record(message_opt->size(), message_opt->data());
+    statistics_.num_messages_received += 1;
+    statistics_.num_bytes_received += message_opt->size();
+  } else {
+    write_record(end_of_trace, nullptr);
+  }
+  return message_opt;
+}
+
+std::optional<ENCRYPTO::PooledBuffer> RecordingTransport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  auto message_opt = transport_->receive_pooled_message(pool);
+  if (message_opt.has_value()) {
+    write_record(message_opt->size(), message_opt->data());
+    statistics_.num_messages_received += 1;
+    statistics_.num_bytes_received += message_opt->size();
+  } else {
+    write_record(end_of_trace, nullptr);
+  }
+  return message_opt;
+}
+
+void RecordingTransport::shutdown_send() { transport_->shutdown_send(); }
+
+void RecordingTransport::shutdown() {
+  transport_->shutdown();
+  std::scoped_lock lock(file_mutex_);
+  file_.flush();
+}
+
+ReplayTransport::ReplayTransport(const std::string& path, double time_scale)
+    : path_(path),
+      time_scale_(time_scale),
+      start_time_(clock_type::now()),
+      file_(path, std::ios::binary) {
+  if (time_scale < 0) {
+    throw std::invalid_argument("ReplayTransport: time scale must not be negative");
+  }
+  char magic[sizeof(trace_magic)];
+  if (!file_ || !file_.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, trace_magic, sizeof(magic)) != 0) {
+    throw std::runtime_error(fmt::format("ReplayTransport: {} is not a trace", path_));
+  }
+  read_next_header();
+}
+
+void ReplayTransport::read_next_header() {
+  std::uint64_t header[2];
+  if (!file_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    // a trace without end, e.g., since the recording party was killed
+    next_size_ = end_of_trace;
+    return;
+  }
+  next_time_ns_ = header[0];
+  next_size_ = header[1];
+}
+
+bool ReplayTransport::wait_until(std::uint64_t time_ns, std::unique_lock<std::mutex>& lock) {
+  const auto due_time =
+      start_time_ + std::chrono::duration_cast<clock_type::duration>(std::chrono::nanoseconds(
+                        static_cast<std::int64_t>(static_cast<double>(time_ns) * time_scale_)));
+  return !cv_.wait_until(lock, due_time, [this] { return closed_; });
+}
+
+void ReplayTransport::send_message(std::vector<std::uint8_t>&& message) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += message.size();
+}
+
+void ReplayTransport::send_message(const std::vector<std::uint8_t>& message) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += message.size();
+}
+
+void ReplayTransport::send_message(const std::uint8_t*, std::size_t size) {
+  statistics_.num_messages_sent += 1;
+  statistics_.num_bytes_sent += size;
+}
+
+bool ReplayTransport::available() const {
+  std::scoped_lock lock(mutex_);
+  if (closed_ || next_size_ == end_of_trace) {
+    return false;
+  }
+  const auto elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start_time_);
+  return static_cast<double>(next_time_ns_) * time_scale_ <=
+         static_cast<double>(elapsed_ns.count());
+}
+
+std::optional<std::vector<std::uint8_t>> ReplayTransport::receive_message() {
+  std::unique_lock lock(mutex_);
+  if (closed_ || !wait_until(next_time_ns_, lock)) {
+    return std::nullopt;
+  }
+  if (next_size_ == end_of_trace) {
+    return std::nullopt;
+  }
+  std::vector<std::uint8_t> message(next_size_);
+  if (!file_.read(reinterpret_cast<char*>(message.data()),
+                  static_cast<std::streamsize>(message.size()))) {
+    throw std::runtime_error(fmt::format("ReplayTransport: {} is truncated", path_));
+  }
+  read_next_header();
+  statistics_.num_messages_received += 1;
+  statistics_.num_bytes_received += message.size();
+  return message;
+}
+
+void ReplayTransport::shutdown_send() {}
+
+void ReplayTransport::shutdown() {
+  {
+    std::scoped_lock lock(mutex_);
+    closed_ = true;
+  }
+  cv_.notify_all();
+}
+
+std::vector<std::unique_ptr<Transport>> make_recording_transports(
+    std::vector<std::unique_ptr<Transport>>&& transports, const std::string& path_prefix) {
+  std::vector<std::unique_ptr<Transport>> recording_transports;
+  recording_transports.reserve(transports.size());
+  for (std::size_t party_id = 0; party_id < transports.size(); ++party_id) {
+    auto& transport = transports.at(party_id);
+    if (transport == nullptr) {
+      recording_transports.emplace_back();
+      continue;
+    }
+    recording_transports.emplace_back(std::make_unique<RecordingTransport>(
+        std::move(transport), fmt::format("{}_{}.trace", path_prefix, party_id)));
+  }
+  return recording_transports;
+}
+
+std::vector<std::unique_ptr<Transport>> make_replay_transports(std::size_t num_parties,
+                                                               std::size_t my_id,
+                                                               const std::string& path_prefix,
+                                                               double time_scale) {
+  std::vector<std::unique_ptr<Transport>> replay_transports(num_parties);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    if (party_id != my_id) {
+      replay_transports.at(party_id) = std::make_unique<ReplayTransport>(
+          fmt::format("{}_{}.trace", path_prefix, party_id), time_scale);
+    }
+  }
+  return replay_transports;
+}
+
+}  // namespace MOTION::Communication
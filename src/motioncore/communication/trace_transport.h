@@ -0,0 +1,132 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "transport.h"
+
+namespace MOTION::Communication {
+
+// A trace file consists of the magic bytes and a record per received message: its arrival time
+// in nanoseconds since the RecordingTransport was created, its size and its bytes.  A final
+// record with the size end_of_trace marks when the other party closed the connection.
+constexpr char trace_magic[8] = {'M', 'O', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr std::uint64_t end_of_trace = ~std::uint64_t(0);
+
+// Decorator which writes the messages received over another transport with their arrival times
+// into a trace file, such that a ReplayTransport can feed them to the same party again without
+// the other party.  Sent messages are passed on unchanged.
+class RecordingTransport : public Transport {
+ public:
+  // throws std::runtime_error if the file cannot be created
+  RecordingTransport(std::unique_ptr<Transport> transport, const std::string& path);
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+  void send_messages(std::span<const std::span<const std::uint8_t>> messages) override;
+
+  void set_mode(TransportMode mode) override;
+
+  bool available() const override;
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool) override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  void write_record(std::uint64_t size, const std::uint8_t* data);
+
+  std::unique_ptr<Transport> transport_;
+  const clock_type::time_point start_time_;
+  std::mutex file_mutex_;
+  std::ofstream file_;
+};
+
+// Transport which plays back a trace of a RecordingTransport, e.g., to profile the computation
+// of one party offline and without the variance of the network.  Each message is received at its
+// recorded arrival time multiplied by time_scale, counted from the creation of the transport, or
+// at once with a time_scale of 0, such that the party only waits for its own computation.  Sent
+// messages are dropped.  The party has to run the same circuit with the same inputs as in the
+// recording; the values received are not consistent with fresh randomness of the party, so its
+// outputs are meaningless, but it performs the same computation and communication.
+class ReplayTransport : public Transport {
+ public:
+  // throws std::runtime_error if the file cannot be read or is not a trace
+  explicit ReplayTransport(const std::string& path, double time_scale = 1.0);
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+
+  // a message is available once its scaled arrival time has passed
+  bool available() const override;
+  // throws std::runtime_error if the trace is truncated
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // read the time and size of the next record, the mutex needs to be held
+  void read_next_header();
+  // wait until the scaled time has passed or the transport is shut down, returns false in the
+  // latter case
+  bool wait_until(std::uint64_t time_ns, std::unique_lock<std::mutex>& lock);
+
+  const std::string path_;
+  const double time_scale_;
+  const clock_type::time_point start_time_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::ifstream file_;
+  // header of the next record, the end of the trace if next_size_ is end_of_trace
+  std::uint64_t next_time_ns_ = 0;
+  std::uint64_t next_size_ = end_of_trace;
+  bool closed_ = false;
+};
+
+// Wrap all (non-null) transports into RecordingTransports which write the trace of party i to
+// "<path_prefix>_<i>.trace".
+std::vector<std::unique_ptr<Transport>> make_recording_transports(
+    std::vector<std::unique_ptr<Transport>>&& transports, const std::string& path_prefix);
+
+// Transports of party my_id which replay the traces written by make_recording_transports.
+std::vector<std::unique_ptr<Transport>> make_replay_transports(std::size_t num_parties,
+                                                               std::size_t my_id,
+                                                               const std::string& path_prefix,
+                                                               double time_scale = 1.0);
+
+}  // namespace MOTION::Communication
@@ -24,6 +24,21 @@
 
 namespace MOTION::Communication {
 
+void Transport::send_messages(std::span<const std::span<const std::uint8_t>> messages) {
+  for (const auto& message : messages) {
+    send_message(message.data(), message.size());
+  }
+}
+
+std::optional<ENCRYPTO::PooledBuffer> Transport::receive_pooled_message(
+    ENCRYPTO::BufferPool& pool) {
+  auto message = receive_message();
+  if (!message.has_value()) {
+    return std::nullopt;
+  }
+  return pool.adopt(std::move(*message));
+}
+
 const TransportStatistics& Transport::get_stats() const { return statistics_; }
 
 void Transport::reset_stats() {
@@ -31,6 +46,10 @@ void Transport::reset_stats() {
   statistics_.num_messages_received = 0;
   statistics_.num_bytes_sent = 0;
   statistics_.num_bytes_received = 0;
+  statistics_.max_receive_queue_depth = 0;
+  statistics_.receive_stall_time_us = 0;
+  statistics_.num_compressed_messages_sent = 0;
+  statistics_.num_bytes_saved_by_compression = 0;
 }
 
 }  // namespace MOTION::Communication
@@ -23,10 +23,14 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
+#include "utility/buffer_pool.h"
+
 namespace MOTION::Communication {
 
 struct TransportStatistics {
@@ -34,6 +38,29 @@ struct TransportStatistics {
   std::size_t num_messages_received = 0;
   std::size_t num_bytes_sent = 0;
   std::size_t num_bytes_received = 0;
+  // filled by the CommunicationLayer: largest number of received messages waiting for
+  // verification and dispatch, and the time the socket reader was blocked on a full queue
+  std::size_t max_receive_queue_depth = 0;
+  std::size_t receive_stall_time_us = 0;
+  // filled by the CommunicationLayer: messages sent as CompressedMessage and the number of bytes
+  // saved by compressing them
+  std::size_t num_compressed_messages_sent = 0;
+  std::size_t num_bytes_saved_by_compression = 0;
+  // filled by the CommunicationLayer: batches the send thread took from the send queue, the
+  // largest one, and how often gate fibers had to retry enqueueing since another one was faster
+  std::size_t num_send_batches = 0;
+  std::size_t max_send_batch_size = 0;
+  std::size_t num_send_queue_retries = 0;
+};
+
+// How a transport trades latency against throughput.
+enum class TransportMode : std::uint8_t {
+  // every batch of messages leaves as soon as it has been written, for the many small messages
+  // of round-heavy online phases
+  latency,
+  // large batches are corked until they have been written completely, such that they leave in
+  // full segments, for the bulk data of the setup phase
+  throughput,
 };
 
 // underlying transport between two parties
@@ -51,6 +78,16 @@ class Transport {
   virtual void send_message(std::vector<std::uint8_t>&& message) = 0;
   virtual void send_message(const std::vector<std::uint8_t>& message) = 0;
   virtual void send_message(const std::uint8_t* message, std::size_t size) = 0;
+  // send a batch of messages in order, the default implementation sends them one by one
+  virtual void send_messages(std::span<const std::span<const std::uint8_t>> messages);
+
+  // select the mode used for the following messages, no effect by default
+  virtual void set_mode(TransportMode) {}
+
+  // Check if the transport connects two parties in the same process.  Such a transport gets the
+  // messages as vectors which are passed on to the receiver without copying them, and its
+  // messages can be trusted to be well-formed.
+  virtual bool is_in_process() const noexcept { return false; }
 
   // check if a new message is available
   virtual bool available() const = 0;
@@ -58,6 +95,11 @@ class Transport {
   // receive message, possibly blocking
   virtual std::optional<std::vector<std::uint8_t>> receive_message() = 0;
 
+  // receive message into a buffer from the pool, possibly blocking, such that no allocation is
+  // needed once the pool is warm.  The default implementation adopts the vector returned by
+  // receive_message.
+  virtual std::optional<ENCRYPTO::PooledBuffer> receive_pooled_message(ENCRYPTO::BufferPool& pool);
+
   // shutdown the outgoing part of the transport to signal end of communication
   virtual void shutdown_send() = 0;
 
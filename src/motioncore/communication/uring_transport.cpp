@@ -0,0 +1,724 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "uring_transport.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace MOTION::Communication {
+
+namespace detail {
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+T load_acquire(T* ptr) noexcept {
+  return std::atomic_ref<T>(*ptr).load(std::memory_order_acquire);
+}
+
+template <typename T>
+void store_release(T* ptr, T value) noexcept {
+  std::atomic_ref<T>(*ptr).store(value, std::memory_order_release);
+}
+
+// the operation of a completion is stored in the lower bits of its user_data, the peer index in
+// the remaining ones
+enum OperationKind : std::uint64_t { op_receive = 0, op_send = 1, op_wakeup = 2 };
+constexpr std::uint64_t op_bits = 2;
+
+std::uint64_t make_user_data(std::size_t peer_index, OperationKind kind) {
+  return (std::uint64_t(peer_index) << op_bits) | kind;
+}
+
+// Minimal io_uring without SQ polling.  The submission queue is only accessed by the thread
+// calling get_sqe and submit_and_wait, so the kernel reads the SQEs only within io_uring_enter.
+class Ring {
+ public:
+  explicit Ring(unsigned entries) {
+    std::memset(&params_, 0, sizeof(params_));
+    fd_ = sys_io_uring_setup(entries, &params_);
+    if (fd_ < 0) {
+      throw std::runtime_error(fmt::format("io_uring_setup failed: {}", std::strerror(errno)));
+    }
+    sq_size_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+    cq_size_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params_.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                     IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd_);
+      throw std::runtime_error(fmt::format("mmap of io_uring failed: {}", std::strerror(error)));
+    }
+    if (single_mmap) {
+      cq_ptr_ = sq_ptr_;
+    } else {
+      cq_ptr_ = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                       IORING_OFF_CQ_RING);
+    }
+    sqes_size_ = params_.sq_entries * sizeof(io_uring_sqe);
+    void* sqes_ptr = MAP_FAILED;
+    if (cq_ptr_ != MAP_FAILED) {
+      sqes_ptr = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd_, IORING_OFF_SQES);
+    }
+    if (sqes_ptr == MAP_FAILED) {
+      auto error = errno;
+      unmap_rings();
+      ::close(fd_);
+      throw std::runtime_error(fmt::format("mmap of io_uring failed: {}", std::strerror(error)));
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes_ptr);
+
+    auto sq = static_cast<std::uint8_t*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params_.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.array);
+    auto cq = static_cast<std::uint8_t*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params_.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params_.cq_off.cqes);
+  }
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  ~Ring() {
+    ::munmap(sqes_, sqes_size_);
+    unmap_rings();
+    ::close(fd_);
+  }
+
+  // returns false if the kernel refused to register the buffers, e.g., due to RLIMIT_MEMLOCK
+  bool register_buffers(const std::vector<iovec>& buffers) {
+    return sys_io_uring_register(fd_, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) ==
+           0;
+  }
+
+  // returns a cleared SQE which is submitted with the next call of submit_and_wait
+  io_uring_sqe& get_sqe() {
+    auto tail = *sq_tail_;
+    if (tail - load_acquire(sq_head_) == params_.sq_entries) {
+      submit_and_wait(0);
+    }
+    const auto index = tail & sq_mask_;
+    auto& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sq_array_[index] = index;
+    store_release(sq_tail_, tail + 1);
+    ++num_unsubmitted_;
+    return sqe;
+  }
+
+  void submit_and_wait(unsigned min_complete) {
+    const unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+      auto ret = sys_io_uring_enter(fd_, num_unsubmitted_, min_complete, flags);
+      if (ret >= 0) {
+        num_unsubmitted_ -= ret;
+        return;
+      }
+      if (errno != EINTR) {
+        throw std::runtime_error(fmt::format("io_uring_enter failed: {}", std::strerror(errno)));
+      }
+    }
+  }
+
+  template <typename F>
+  void for_each_cqe(F&& f) {
+    auto head = *cq_head_;
+    const auto tail = load_acquire(cq_tail_);
+    for (; head != tail; ++head) {
+      f(cqes_[head & cq_mask_]);
+    }
+    store_release(cq_head_, head);
+  }
+
+ private:
+  void unmap_rings() {
+    if (cq_ptr_ != sq_ptr_ && cq_ptr_ != MAP_FAILED) {
+      ::munmap(cq_ptr_, cq_size_);
+    }
+    ::munmap(sq_ptr_, sq_size_);
+  }
+
+  int fd_;
+  io_uring_params params_;
+  void* sq_ptr_ = MAP_FAILED;
+  void* cq_ptr_ = MAP_FAILED;
+  std::size_t sq_size_;
+  std::size_t cq_size_;
+  std::size_t sqes_size_;
+  io_uring_sqe* sqes_;
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned sq_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe* cqes_;
+  unsigned num_unsubmitted_ = 0;
+};
+
+void u32tou8(std::uint32_t v, std::uint8_t* result) {
+  for (auto i = 0u; i < sizeof(std::uint32_t); ++i) {
+    result[i] = (v >> i * 8) & 0xFF;
+  }
+}
+
+// in throughput mode, batches of at least this many bytes are corked
+constexpr std::size_t cork_threshold = std::size_t{64} << 10;
+
+std::uint32_t u8tou32(const std::uint8_t* v) {
+  std::uint32_t result = 0;
+  for (auto i = 0u; i < sizeof(std::uint32_t); ++i) {
+    result += (std::uint32_t(v[i]) << i * 8);
+  }
+  return result;
+}
+
+}  // namespace
+
+class UringEventLoop {
+ public:
+  static constexpr std::size_t receive_buffer_size = std::size_t{1} << 18;
+
+  // the file descriptors are closed by the destructor
+  explicit UringEventLoop(const std::vector<int>& socket_fds);
+  ~UringEventLoop();
+
+  // blocks until all buffers have been written
+  void send(std::size_t peer_index, std::vector<iovec>&& buffers);
+  bool available(std::size_t peer_index) const;
+  std::optional<std::vector<std::uint8_t>> receive(std::size_t peer_index);
+  void shutdown_send(std::size_t peer_index);
+  void shutdown(std::size_t peer_index);
+  void set_cork(std::size_t peer_index, bool cork);
+
+ private:
+  struct SendRequest {
+    std::vector<iovec> buffers_;
+    std::size_t next_buffer_ = 0;
+    msghdr msg_;
+    std::promise<void> done_;
+  };
+
+  struct Peer {
+    int fd_;
+    // receive state, only used by the loop thread
+    std::unique_ptr<std::uint8_t[]> buffer_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    bool reading_large_message_ = false;
+    std::vector<std::uint8_t> large_message_;
+    std::size_t large_message_offset_ = 0;
+    // queue of messages passed to receive()
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::vector<std::uint8_t>> queue_;
+    bool closed_ = false;
+    std::string error_;
+    std::atomic<bool> shut_down_ = false;
+    // send state, the mutex allows only one SendRequest per peer at a time
+    std::mutex send_mutex_;
+    SendRequest* send_request_ = nullptr;
+  };
+
+  void run();
+  void wake_up();
+  void arm_wakeup();
+  void arm_receive(std::size_t peer_index);
+  void on_receive(std::size_t peer_index, int res);
+  void split_messages(Peer& peer);
+  void close_receive(Peer& peer, std::string error);
+  void submit_send(std::size_t peer_index);
+  void on_send(std::size_t peer_index, int res);
+
+  Ring ring_;
+  std::vector<std::unique_ptr<Peer>> peers_;
+  bool registered_buffers_;
+  int wakeup_fd_;
+  std::uint64_t wakeup_value_;
+  std::mutex pending_mutex_;
+  std::vector<std::pair<std::size_t, SendRequest*>> pending_sends_;
+  std::atomic<bool> stop_ = false;
+  // number of receive and send operations in flight
+  std::size_t num_outstanding_ = 0;
+  std::thread thread_;
+};
+
+UringEventLoop::UringEventLoop(const std::vector<int>& socket_fds)
+    // at most one receive and one send per peer and the wakeup read are in flight
+    : ring_(2 * socket_fds.size() + 1) {
+  wakeup_fd_ = ::eventfd(0, EFD_CLOEXEC);
+  if (wakeup_fd_ < 0) {
+    throw std::runtime_error(fmt::format("eventfd failed: {}", std::strerror(errno)));
+  }
+  std::vector<iovec> buffers;
+  for (auto fd : socket_fds) {
+    auto& peer = *peers_.emplace_back(std::make_unique<Peer>());
+    peer.fd_ = fd;
+    peer.buffer_ = std::make_unique<std::uint8_t[]>(receive_buffer_size);
+    buffers.push_back({peer.buffer_.get(), receive_buffer_size});
+  }
+  registered_buffers_ = ring_.register_buffers(buffers);
+  thread_ = std::thread([this] { run(); });
+}
+
+UringEventLoop::~UringEventLoop() {
+  stop_ = true;
+  // complete the outstanding receives
+  for (auto& peer : peers_) {
+    ::shutdown(peer->fd_, SHUT_RDWR);
+  }
+  wake_up();
+  thread_.join();
+  for (auto& peer : peers_) {
+    ::close(peer->fd_);
+  }
+  ::close(wakeup_fd_);
+}
+
+void UringEventLoop::run() {
+  arm_wakeup();
+  for (std::size_t peer_i = 0; peer_i < peers_.size(); ++peer_i) {
+    arm_receive(peer_i);
+  }
+  while (true) {
+    {
+      std::scoped_lock lock(pending_mutex_);
+      for (auto [peer_i, request] : pending_sends_) {
+        peers_[peer_i]->send_request_ = request;
+        submit_send(peer_i);
+      }
+      pending_sends_.clear();
+    }
+    if (stop_ && num_outstanding_ == 0) {
+      break;
+    }
+    ring_.submit_and_wait(1);
+    ring_.for_each_cqe([this](const io_uring_cqe& cqe) {
+      const auto peer_i = cqe.user_data >> op_bits;
+      switch (cqe.user_data & ((1 << op_bits) - 1)) {
+        case op_receive:
+          on_receive(peer_i, cqe.res);
+          break;
+        case op_send:
+          on_send(peer_i, cqe.res);
+          break;
+        case op_wakeup:
+          arm_wakeup();
+          break;
+      }
+    });
+  }
+}
+
+void UringEventLoop::wake_up() {
+  std::uint64_t value = 1;
+  [[maybe_unused]] auto ret = ::write(wakeup_fd_, &value, sizeof(value));
+}
+
+void UringEventLoop::arm_wakeup() {
+  auto& sqe = ring_.get_sqe();
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = wakeup_fd_;
+  sqe.addr = reinterpret_cast<std::uint64_t>(&wakeup_value_);
+  sqe.len = sizeof(wakeup_value_);
+  sqe.user_data = make_user_data(0, op_wakeup);
+}
+
+void UringEventLoop::arm_receive(std::size_t peer_index) {
+  auto& peer = *peers_[peer_index];
+  auto& sqe = ring_.get_sqe();
+  sqe.fd = peer.fd_;
+  sqe.user_data = make_user_data(peer_index, op_receive);
+  if (peer.reading_large_message_) {
+    // read the rest of the message directly into its vector
+    sqe.opcode = IORING_OP_RECV;
+    sqe.addr = reinterpret_cast<std::uint64_t>(peer.large_message_.data() +
+                                               peer.large_message_offset_);
+    sqe.len = peer.large_message_.size() - peer.large_message_offset_;
+  } else {
+    sqe.opcode = registered_buffers_ ? IORING_OP_READ_FIXED : IORING_OP_RECV;
+    sqe.addr = reinterpret_cast<std::uint64_t>(peer.buffer_.get() + peer.end_);
+    sqe.len = receive_buffer_size - peer.end_;
+    sqe.buf_index = peer_index;
+  }
+  ++num_outstanding_;
+}
+
+void UringEventLoop::on_receive(std::size_t peer_index, int res) {
+  --num_outstanding_;
+  auto& peer = *peers_[peer_index];
+  if (res == -EINTR || res == -EAGAIN) {
+    arm_receive(peer_index);
+    return;
+  }
+  if (res < 0) {
+    if (stop_ || peer.shut_down_) {
+      close_receive(peer, {});
+    } else {
+      close_receive(peer,
+                    fmt::format("Error while reading from socket: {} ({})", std::strerror(-res),
+                                -res));
+    }
+    return;
+  }
+  if (res == 0) {
+    // connection has been closed
+    if (peer.reading_large_message_ || peer.begin_ != peer.end_) {
+      close_receive(peer, "Connection has been closed in the middle of a message");
+    } else {
+      close_receive(peer, {});
+    }
+    return;
+  }
+  if (peer.reading_large_message_) {
+    peer.large_message_offset_ += res;
+    if (peer.large_message_offset_ == peer.large_message_.size()) {
+      {
+        std::scoped_lock lock(peer.queue_mutex_);
+        peer.queue_.push_back(std::move(peer.large_message_));
+      }
+      peer.queue_cv_.notify_one();
+      peer.reading_large_message_ = false;
+      peer.large_message_ = {};
+    }
+  } else {
+    peer.end_ += res;
+    split_messages(peer);
+  }
+  if (!stop_) {
+    arm_receive(peer_index);
+  }
+}
+
+void UringEventLoop::split_messages(Peer& peer) {
+  constexpr auto header_size = sizeof(std::uint32_t);
+  std::vector<std::vector<std::uint8_t>> messages;
+  auto* buffer = peer.buffer_.get();
+  while (peer.end_ - peer.begin_ >= header_size) {
+    const std::size_t message_size = u8tou32(buffer + peer.begin_);
+    const auto num_available = peer.end_ - peer.begin_ - header_size;
+    const auto* data = buffer + peer.begin_ + header_size;
+    if (num_available >= message_size) {
+      messages.emplace_back(data, data + message_size);
+      peer.begin_ += header_size + message_size;
+    } else if (header_size + message_size > receive_buffer_size) {
+      // does not fit into the buffer, so continue reading directly into the message
+      peer.large_message_.resize(message_size);
+      std::copy_n(data, num_available, peer.large_message_.data());
+      peer.large_message_offset_ = num_available;
+      peer.reading_large_message_ = true;
+      peer.begin_ = peer.end_ = 0;
+      break;
+    } else {
+      break;
+    }
+  }
+  // move the incomplete message to the front of the buffer
+  if (peer.begin_ > 0) {
+    std::memmove(buffer, buffer + peer.begin_, peer.end_ - peer.begin_);
+    peer.end_ -= peer.begin_;
+    peer.begin_ = 0;
+  }
+  if (!messages.empty()) {
+    {
+      std::scoped_lock lock(peer.queue_mutex_);
+      std::move(std::begin(messages), std::end(messages), std::back_inserter(peer.queue_));
+    }
+    peer.queue_cv_.notify_one();
+  }
+}
+
+void UringEventLoop::close_receive(Peer& peer, std::string error) {
+  {
+    std::scoped_lock lock(peer.queue_mutex_);
+    peer.closed_ = true;
+    peer.error_ = std::move(error);
+  }
+  peer.queue_cv_.notify_all();
+}
+
+void UringEventLoop::submit_send(std::size_t peer_index) {
+  auto& peer = *peers_[peer_index];
+  auto& request = *peer.send_request_;
+  std::memset(&request.msg_, 0, sizeof(request.msg_));
+  request.msg_.msg_iov = request.buffers_.data() + request.next_buffer_;
+  request.msg_.msg_iovlen =
+      std::min<std::size_t>(IOV_MAX, request.buffers_.size() - request.next_buffer_);
+  auto& sqe = ring_.get_sqe();
+  sqe.opcode = IORING_OP_SENDMSG;
+  sqe.fd = peer.fd_;
+  sqe.addr = reinterpret_cast<std::uint64_t>(&request.msg_);
+  sqe.len = 1;
+  sqe.msg_flags = MSG_NOSIGNAL;
+  sqe.user_data = make_user_data(peer_index, op_send);
+  ++num_outstanding_;
+}
+
+void UringEventLoop::on_send(std::size_t peer_index, int res) {
+  --num_outstanding_;
+  auto& peer = *peers_[peer_index];
+  auto& request = *peer.send_request_;
+  if (res == -EINTR || res == -EAGAIN) {
+    submit_send(peer_index);
+    return;
+  }
+  if (res < 0) {
+    peer.send_request_ = nullptr;
+    request.done_.set_exception(std::make_exception_ptr(std::runtime_error(
+        fmt::format("Error while writing to socket: {} ({})", std::strerror(-res), -res))));
+    return;
+  }
+  // skip the written bytes
+  std::size_t num_written = res;
+  auto& buffers = request.buffers_;
+  while (request.next_buffer_ < buffers.size() &&
+         num_written >= buffers[request.next_buffer_].iov_len) {
+    num_written -= buffers[request.next_buffer_].iov_len;
+    ++request.next_buffer_;
+  }
+  if (request.next_buffer_ == buffers.size()) {
+    peer.send_request_ = nullptr;
+    request.done_.set_value();
+    return;
+  }
+  if (res == 0) {
+    peer.send_request_ = nullptr;
+    request.done_.set_exception(std::make_exception_ptr(
+        std::runtime_error("Error while writing to socket: nothing has been written")));
+    return;
+  }
+  auto& buffer = buffers[request.next_buffer_];
+  buffer.iov_base = static_cast<std::uint8_t*>(buffer.iov_base) + num_written;
+  buffer.iov_len -= num_written;
+  submit_send(peer_index);
+}
+
+void UringEventLoop::send(std::size_t peer_index, std::vector<iovec>&& buffers) {
+  auto& peer = *peers_[peer_index];
+  std::scoped_lock send_lock(peer.send_mutex_);
+  SendRequest request;
+  request.buffers_ = std::move(buffers);
+  auto future = request.done_.get_future();
+  {
+    std::scoped_lock lock(pending_mutex_);
+    pending_sends_.emplace_back(peer_index, &request);
+  }
+  wake_up();
+  future.get();
+}
+
+bool UringEventLoop::available(std::size_t peer_index) const {
+  const auto& peer = *peers_[peer_index];
+  std::scoped_lock lock(peer.queue_mutex_);
+  return !peer.queue_.empty();
+}
+
+std::optional<std::vector<std::uint8_t>> UringEventLoop::receive(std::size_t peer_index) {
+  auto& peer = *peers_[peer_index];
+  std::unique_lock lock(peer.queue_mutex_);
+  peer.queue_cv_.wait(lock, [&peer] { return !peer.queue_.empty() || peer.closed_; });
+  if (!peer.queue_.empty()) {
+    auto message = std::move(peer.queue_.front());
+    peer.queue_.pop_front();
+    return message;
+  }
+  if (!peer.error_.empty()) {
+    throw std::runtime_error(peer.error_);
+  }
+  return std::nullopt;
+}
+
+void UringEventLoop::set_cork(std::size_t peer_index, bool cork) {
+  int value = cork;
+  // errors can be ignored, since corking only affects the segmentation
+  ::setsockopt(peers_[peer_index]->fd_, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+}
+
+void UringEventLoop::shutdown_send(std::size_t peer_index) {
+  ::shutdown(peers_[peer_index]->fd_, SHUT_WR);
+}
+
+void UringEventLoop::shutdown(std::size_t peer_index) {
+  auto& peer = *peers_[peer_index];
+  peer.shut_down_ = true;
+  // the outstanding receive completes, the socket is closed by the destructor
+  ::shutdown(peer.fd_, SHUT_RDWR);
+}
+
+}  // namespace detail
+
+bool is_io_uring_available() noexcept {
+  static const bool available = [] {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    auto fd = detail::sys_io_uring_setup(1, &params);
+    if (fd < 0) {
+      return false;
+    }
+    ::close(fd);
+    return true;
+  }();
+  return available;
+}
+
+UringTCPTransport::UringTCPTransport(std::shared_ptr<detail::UringEventLoop> event_loop,
+                                     std::size_t peer_index)
+    : event_loop_(std::move(event_loop)), peer_index_(peer_index) {}
+
+UringTCPTransport::~UringTCPTransport() = default;
+
+void UringTCPTransport::send_message(std::vector<std::uint8_t>&& message) {
+  send_message(message.data(), message.size());
+}
+
+void UringTCPTransport::send_message(const std::vector<std::uint8_t>& message) {
+  send_message(message.data(), message.size());
+}
+
+void UringTCPTransport::send_message(const std::uint8_t* message, std::size_t size) {
+  const std::span<const std::uint8_t> buffer(message, size);
+  send_messages({&buffer, 1});
+}
+
+void UringTCPTransport::send_messages(std::span<const std::span<const std::uint8_t>> messages) {
+  const auto num_messages = messages.size();
+  std::vector<std::array<std::uint8_t, sizeof(std::uint32_t)>> message_sizes(num_messages);
+  std::vector<iovec> buffers;
+  buffers.reserve(2 * num_messages);
+  std::size_t num_bytes = 0;
+  for (std::size_t message_i = 0; message_i < num_messages; ++message_i) {
+    const auto& message = messages[message_i];
+    if (message.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error(fmt::format("Max message size is {} B but tried to send {} B",
+                                           std::numeric_limits<std::uint32_t>::max(),
+                                           message.size()));
+    }
+    detail::u32tou8(message.size(), message_sizes[message_i].data());
+    buffers.push_back({message_sizes[message_i].data(), sizeof(std::uint32_t)});
+    // the kernel only reads from the payload
+    buffers.push_back({const_cast<std::uint8_t*>(message.data()), message.size()});
+    num_bytes += message.size() + sizeof(std::uint32_t);
+  }
+  // in throughput mode, batches which probably need several sendmsg calls are corked
+  const bool cork = mode_ == TransportMode::throughput &&
+                    (buffers.size() > IOV_MAX || num_bytes >= detail::cork_threshold);
+  if (cork) {
+    event_loop_->set_cork(peer_index_, true);
+  }
+  try {
+    event_loop_->send(peer_index_, std::move(buffers));
+  } catch (std::runtime_error&) {
+    if (cork) {
+      event_loop_->set_cork(peer_index_, false);
+    }
+    throw;
+  }
+  if (cork) {
+    event_loop_->set_cork(peer_index_, false);
+  }
+  statistics_.num_bytes_sent += num_bytes;
+  statistics_.num_messages_sent += num_messages;
+}
+
+void UringTCPTransport::set_mode(TransportMode mode) { mode_ = mode; }
+
+bool UringTCPTransport::available() const { return event_loop_->available(peer_index_); }
+
+std::optional<std::vector<std::uint8_t>> UringTCPTransport::receive_message() {
+  auto message = event_loop_->receive(peer_index_);
+  if (message.has_value()) {
+    statistics_.num_bytes_received += message->size() + sizeof(std::uint32_t);
+    statistics_.num_messages_received += 1;
+  }
+  return message;
+}
+
+void UringTCPTransport::shutdown_send() { event_loop_->shutdown_send(peer_index_); }
+
+void UringTCPTransport::shutdown() { event_loop_->shutdown(peer_index_); }
+
+std::vector<std::unique_ptr<Transport>> make_uring_tcp_transports(std::vector<int>&& socket_fds) {
+  std::shared_ptr<detail::UringEventLoop> event_loop;
+  try {
+    event_loop = std::make_shared<detail::UringEventLoop>(socket_fds);
+  } catch (std::runtime_error&) {
+    for (auto fd : socket_fds) {
+      ::close(fd);
+    }
+    throw;
+  }
+  std::vector<std::unique_ptr<Transport>> transports;
+  for (std::size_t peer_i = 0; peer_i < socket_fds.size(); ++peer_i) {
+    transports.emplace_back(std::make_unique<UringTCPTransport>(event_loop, peer_i));
+  }
+  return transports;
+}
+
+}  // namespace MOTION::Communication
@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "transport.h"
+
+namespace MOTION::Communication {
+
+namespace detail {
+class UringEventLoop;
+}
+
+// Returns true if io_uring can be used in this process, i.e., the kernel supports it and it has
+// not been disabled.
+bool is_io_uring_available() noexcept;
+
+// Transport over an established TCP connection whose socket I/O is driven by an io_uring event
+// loop.  One loop thread serves all transports created together by make_uring_tcp_transports:
+// it keeps a read into a registered per-peer buffer outstanding for every connection, splits the
+// received bytes into messages, and submits the writes of sending threads.  Messages larger than
+// the registered buffer are read directly into the message vector.  The wire format is the same
+// as the one of TCPTransport.
+class UringTCPTransport : public Transport {
+ public:
+  UringTCPTransport(std::shared_ptr<detail::UringEventLoop> event_loop, std::size_t peer_index);
+
+  // Destructor needs to be defined in implementation due to pimpl
+  ~UringTCPTransport();
+
+  void send_message(std::vector<std::uint8_t>&& message) override;
+  void send_message(const std::vector<std::uint8_t>& message) override;
+  void send_message(const std::uint8_t* message, std::size_t size) override;
+  // write all messages with as few sendmsg operations as the iovec limit allows, payloads are
+  // not copied
+  void send_messages(std::span<const std::span<const std::uint8_t>> messages) override;
+  void set_mode(TransportMode mode) override;
+
+  bool available() const override;
+  std::optional<std::vector<std::uint8_t>> receive_message() override;
+  void shutdown_send() override;
+  void shutdown() override;
+
+ private:
+  std::shared_ptr<detail::UringEventLoop> event_loop_;
+  std::size_t peer_index_;
+  std::atomic<TransportMode> mode_ = TransportMode::throughput;
+};
+
+// Create one UringTCPTransport for each of the given connected TCP sockets, all served by a
+// single new event loop.  Takes ownership of the file descriptors.
+// Throws a std::runtime_error if the io_uring cannot be set up.
+std::vector<std::unique_ptr<Transport>> make_uring_tcp_transports(std::vector<int>&& socket_fds);
+
+}  // namespace MOTION::Communication
@@ -25,6 +25,13 @@
 #include <array>
 #include "aesni_primitives.h"
 
+#include "utility/cpu_features.h"
+
+bool vaes_supported() {
+  const auto& features = MOTION::get_cpu_features();
+  return features.avx512f && features.vaes;
+}
+
 template <int round_constant>
 static __m128i aes_key_expand(__m128i xmm1) {
   // aeskeygenassist xmm3, xmm1, \rcon
@@ -207,6 +214,107 @@ void aesni_ctr_stream_blocks_128_unaligned(const void* round_keys_in, std::uint6
   *counter_in = counter;
 }
 
+void aesni_ctr_stream_blocks_128_nonce(const void* round_keys_in, std::uint64_t nonce,
+                                       std::uint64_t* counter_in, void* output_in,
+                                       std::size_t num_blocks) {
+  alignas(16) std::array<__m128i, aes_num_round_keys_128> round_keys;
+  alignas(16) std::array<__m128i, 8> wb;
+  auto counter = *counter_in;
+  auto output = reinterpret_cast<__m128i*>(__builtin_assume_aligned(output_in, aes_block_size));
+
+  // copy the round keys onto the stack
+  // -> compiler will put them into registers
+  std::copy(reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)),
+            reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)) +
+                aes_num_round_keys_128,
+            round_keys.data());
+
+  // do as many blocks as possible in 8er batches
+  auto batch_blocks = num_blocks & (~0b111);
+  for (size_t i = 0; i < batch_blocks; i += 8) {
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_set_epi64x(counter + j, nonce);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_xor_si128(wb[j], round_keys[0]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[1]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[2]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[3]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[4]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[5]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[6]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[7]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[8]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[9]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenclast_si128(wb[j], round_keys[10]);
+    for (std::size_t j = 0; j < 8; ++j) output[i + j] = wb[j];
+    counter += 8;
+  }
+
+  // do the remaining blocks
+  for (size_t i = batch_blocks; i < num_blocks; ++i) {
+    wb[0] = _mm_set_epi64x(counter, nonce);
+    wb[0] = _mm_xor_si128(wb[0], round_keys[0]);
+    for (std::size_t r = 1; r < aes_num_round_keys_128 - 1; ++r) {
+      wb[0] = _mm_aesenc_si128(wb[0], round_keys[r]);
+    }
+    wb[0] = _mm_aesenclast_si128(wb[0], round_keys[10]);
+    output[i] = wb[0];
+    ++counter;
+  }
+
+  // write the new counter back
+  *counter_in = counter;
+}
+
+// compiled for AVX-512 independently of the flags of the build, callers check the CPU at runtime
+__attribute__((target("avx512f,vaes"))) void vaes_ctr_stream_blocks_128_unaligned(
+    const void* round_keys_in, std::uint64_t* counter_in, void* output_in, std::size_t num_blocks) {
+  std::array<__m512i, aes_num_round_keys_128> round_keys;
+  std::array<__m512i, 4> wb;
+  auto counter = *counter_in;
+  auto output = reinterpret_cast<std::byte*>(output_in);
+
+  // broadcast each round key to all four 128 bit lanes
+  auto round_keys_ptr =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size));
+  for (std::size_t r = 0; r < aes_num_round_keys_128; ++r) {
+    round_keys[r] = _mm512_broadcast_i32x4(round_keys_ptr[r]);
+  }
+
+  // the lanes hold the blocks (0, counter), ..., (0, counter + 3), i.e., only the lower 64 bit of
+  // each lane are incremented
+  const __m512i lane_offsets = _mm512_set_epi64(0, 3, 0, 2, 0, 1, 0, 0);
+  const __m512i four = _mm512_maskz_set1_epi64(0x55, 4);
+
+  // 16 blocks per iteration keep the AES units busy
+  auto batch_blocks = num_blocks & (~std::size_t(0b1111));
+  for (std::size_t i = 0; i < batch_blocks; i += 16) {
+    __m512i ctr = _mm512_add_epi64(_mm512_maskz_set1_epi64(0x55, counter), lane_offsets);
+    for (std::size_t j = 0; j < 4; ++j) {
+      wb[j] = _mm512_xor_si512(ctr, round_keys[0]);
+      ctr = _mm512_add_epi64(ctr, four);
+    }
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[1]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[2]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[3]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[4]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[5]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[6]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[7]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[8]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[9]);
+    for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenclast_epi128(wb[j], round_keys[10]);
+    for (std::size_t j = 0; j < 4; ++j) {
+      _mm512_storeu_si512(output + (i + 4 * j) * aes_block_size, wb[j]);
+    }
+    counter += 16;
+  }
+  *counter_in = counter;
+
+  // do the remaining blocks
+  aesni_ctr_stream_blocks_128_unaligned(round_keys_in, counter_in,
+                                        output + batch_blocks * aes_block_size,
+                                        num_blocks - batch_blocks);
+}
+
 void aesni_ctr_stream_single_block_128_unaligned(const void* round_keys_in, std::uint64_t* counter,
                                                  void* output) {
   auto round_keys =
@@ -298,6 +406,111 @@ void aesni_mmo_single(const void* round_keys_in, void* input) {
   _mm_storeu_si128(input_ptr, wb_1);
 }
 
+void aesni_mmo_batch_8(const void* round_keys_in, void* input) {
+  alignas(16) std::array<__m128i, aes_num_round_keys_128> round_keys;
+  alignas(16) std::array<__m128i, 8> wb;
+
+  // copy the round keys onto the stack
+  // -> compiler will put them into registers
+  std::copy(reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)),
+            reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)) +
+                aes_num_round_keys_128,
+            round_keys.data());
+  auto input_ptr = reinterpret_cast<__m128i*>(__builtin_assume_aligned(input, aes_block_size));
+
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_xor_si128(input_ptr[j], round_keys[0]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[1]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[2]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[3]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[4]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[5]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[6]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[7]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[8]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[9]);
+  for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenclast_si128(wb[j], round_keys[10]);
+  for (std::size_t j = 0; j < 8; ++j) input_ptr[j] = _mm_xor_si128(wb[j], input_ptr[j]);
+}
+
+// compiled for AVX-512 independently of the flags of the build, callers check the CPU at runtime
+__attribute__((target("avx512f,vaes"))) void vaes_mmo_batch_16(const void* round_keys_in,
+                                                                void* input) {
+  std::array<__m512i, aes_num_round_keys_128> round_keys;
+  std::array<__m512i, 4> in;
+  std::array<__m512i, 4> wb;
+
+  // broadcast each round key to all four 128 bit lanes
+  auto round_keys_ptr =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size));
+  for (std::size_t r = 0; r < aes_num_round_keys_128; ++r) {
+    round_keys[r] = _mm512_broadcast_i32x4(round_keys_ptr[r]);
+  }
+  auto input_ptr = reinterpret_cast<std::byte*>(__builtin_assume_aligned(input, aes_block_size));
+
+  for (std::size_t j = 0; j < 4; ++j) in[j] = _mm512_loadu_si512(input_ptr + 64 * j);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_xor_si512(in[j], round_keys[0]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[1]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[2]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[3]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[4]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[5]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[6]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[7]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[8]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenc_epi128(wb[j], round_keys[9]);
+  for (std::size_t j = 0; j < 4; ++j) wb[j] = _mm512_aesenclast_epi128(wb[j], round_keys[10]);
+  for (std::size_t j = 0; j < 4; ++j) {
+    _mm512_storeu_si512(input_ptr + 64 * j, _mm512_xor_si512(wb[j], in[j]));
+  }
+}
+
+void aesni_ggm_expand_level(const void* round_keys_in, void* nodes_in, std::size_t num_parents) {
+  alignas(16) std::array<__m128i, aes_num_round_keys_128> round_keys;
+  alignas(16) std::array<__m128i, 8> in;
+  alignas(16) std::array<__m128i, 8> wb;
+  const __m128i one = _mm_set_epi64x(0, 1);
+
+  // copy the round keys onto the stack
+  // -> compiler will put them into registers
+  std::copy(reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)),
+            reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)) +
+                aes_num_round_keys_128,
+            round_keys.data());
+  auto nodes = reinterpret_cast<__m128i*>(__builtin_assume_aligned(nodes_in, aes_block_size));
+
+  // go from the back to the front, s.t. no parent is overwritten before it has been expanded
+  std::size_t i = num_parents;
+  for (; i >= 4; i -= 4) {
+    for (std::size_t j = 0; j < 4; ++j) {
+      in[2 * j] = nodes[i - 4 + j];
+      in[2 * j + 1] = _mm_xor_si128(in[2 * j], one);
+    }
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_xor_si128(in[j], round_keys[0]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[1]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[2]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[3]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[4]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[5]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[6]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[7]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[8]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[9]);
+    for (std::size_t j = 0; j < 8; ++j) wb[j] = _mm_aesenclast_si128(wb[j], round_keys[10]);
+    for (std::size_t j = 0; j < 8; ++j) nodes[2 * (i - 4) + j] = _mm_xor_si128(wb[j], in[j]);
+  }
+  // the remaining parents at the front
+  for (; i > 0; --i) {
+    in[0] = nodes[i - 1];
+    in[1] = _mm_xor_si128(in[0], one);
+    for (std::size_t j = 0; j < 2; ++j) wb[j] = _mm_xor_si128(in[j], round_keys[0]);
+    for (std::size_t r = 1; r < aes_num_round_keys_128 - 1; ++r) {
+      for (std::size_t j = 0; j < 2; ++j) wb[j] = _mm_aesenc_si128(wb[j], round_keys[r]);
+    }
+    for (std::size_t j = 0; j < 2; ++j) wb[j] = _mm_aesenclast_si128(wb[j], round_keys[10]);
+    for (std::size_t j = 0; j < 2; ++j) nodes[2 * (i - 1) + j] = _mm_xor_si128(wb[j], in[j]);
+  }
+}
+
 static __m128i aesni_mix_keys(__m128i key_a, __m128i key_b) {
   const __m128i modulus = _mm_set_epi32(0, 0, 0, 0x87);
   const __m128i msb_mask = _mm_set_epi32(0x80000000, 0, 0, 0);
@@ -348,6 +561,60 @@ void aesni_bmr_dkc(const void* round_keys_in, const void* key_a, const void* key
   }
 }
 
+void aesni_bmr_dkc_batch(const void* round_keys_in, const void* keys_a, const void* keys_b,
+                         const std::uint64_t* gate_ids, std::size_t num_dkcs,
+                         std::size_t num_parties, void* output_in) {
+  constexpr std::size_t batch_size = 8;
+  auto keys_a_ptr =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(keys_a, aes_block_size));
+  auto keys_b_ptr =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(keys_b, aes_block_size));
+  auto round_keys =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size));
+  auto out = reinterpret_cast<__m128i*>(__builtin_assume_aligned(output_in, aes_block_size));
+  const std::size_t num_blocks = num_dkcs * num_parties;
+  if (num_blocks == 0) {
+    return;
+  }
+
+  // the inputs of the blocks are generated in order, the keys are only mixed once per DKC
+  std::size_t dkc_i = 0;
+  std::size_t party_id = 0;
+  __m128i mixed_keys = aesni_mix_keys(keys_a_ptr[0], keys_b_ptr[0]);
+  auto next_input = [&] {
+    __m128i in = mixed_keys ^ _mm_set_epi64x(gate_ids[dkc_i], party_id);
+    if (++party_id == num_parties) {
+      party_id = 0;
+      if (++dkc_i < num_dkcs) {
+        mixed_keys = aesni_mix_keys(keys_a_ptr[dkc_i], keys_b_ptr[dkc_i]);
+      }
+    }
+    return in;
+  };
+
+  std::size_t block_i = 0;
+  for (; block_i + batch_size <= num_blocks; block_i += batch_size) {
+    __m128i in[batch_size];
+    __m128i wb[batch_size];
+    for (std::size_t j = 0; j < batch_size; ++j) {
+      in[j] = next_input();
+      wb[j] = _mm_xor_si128(in[j], round_keys[0]);
+    }
+    for (std::size_t r = 1; r < 10; ++r) {
+      for (std::size_t j = 0; j < batch_size; ++j) {
+        wb[j] = _mm_aesenc_si128(wb[j], round_keys[r]);
+      }
+    }
+    for (std::size_t j = 0; j < batch_size; ++j) {
+      wb[j] = _mm_aesenclast_si128(wb[j], round_keys[10]);
+      out[block_i + j] ^= wb[j] ^ in[j];
+    }
+  }
+  for (; block_i < num_blocks; ++block_i) {
+    out[block_i] ^= aesni_xor_encrypt(round_keys, next_input());
+  }
+}
+
 static __m128i sigma(__m128i x) {
   // \sigma from https://eprint.iacr.org/2019/074
   // Sections 7.3 and 8.1
@@ -397,6 +664,95 @@ inline void aesni_fixed_key_mmo_hat_batch_4(const void* round_keys_in, void* inp
   for (std::size_t j = 0; j < 4; ++j) input_ptr[j] = _mm_xor_si128(wb_2[j], wb_1[j]);
 }
 
+void aesni_fixed_key_mmo_hat_batch_8(const void* round_keys_in, void* input) {
+  alignas(16) std::array<__m128i, aes_num_round_keys_128> round_keys;
+  alignas(16) std::array<__m128i, 8> wb_1;
+  alignas(16) std::array<__m128i, 8> wb_2;
+
+  auto input_ptr = reinterpret_cast<__m128i*>(__builtin_assume_aligned(input, aes_block_size));
+
+  // compute wb_1 <- \sigma(x)
+  for (std::size_t j = 0; j < 8; ++j) wb_1[j] = sigma(input_ptr[j]);
+
+  // copy the round keys onto the stack
+  // -> compiler will put them into registers
+  std::copy(reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)),
+            reinterpret_cast<__m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size)) +
+                aes_num_round_keys_128,
+            round_keys.data());
+
+  // compute wb_2 <- \pi(\sigma(x))
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_xor_si128(wb_1[j], round_keys[0]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[1]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[2]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[3]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[4]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[5]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[6]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[7]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[8]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenc_si128(wb_2[j], round_keys[9]);
+  for (std::size_t j = 0; j < 8; ++j) wb_2[j] = _mm_aesenclast_si128(wb_2[j], round_keys[10]);
+
+  // store \pi(\sigma(x)) ^ \sigma(x)
+  for (std::size_t j = 0; j < 8; ++j) input_ptr[j] = _mm_xor_si128(wb_2[j], wb_1[j]);
+}
+
+// compiled for AVX-512 independently of the flags of the build, callers check the CPU at runtime
+__attribute__((target("avx512f,vaes"))) void vaes_fixed_key_mmo_hat_batch_16(
+    const void* round_keys_in, void* input) {
+  std::array<__m512i, aes_num_round_keys_128> round_keys;
+  std::array<__m512i, 4> wb_1;
+  std::array<__m512i, 4> wb_2;
+
+  // broadcast each round key to all four 128 bit lanes
+  auto round_keys_ptr =
+      reinterpret_cast<const __m128i*>(__builtin_assume_aligned(round_keys_in, aes_block_size));
+  for (std::size_t r = 0; r < aes_num_round_keys_128; ++r) {
+    round_keys[r] = _mm512_broadcast_i32x4(round_keys_ptr[r]);
+  }
+  auto input_ptr = reinterpret_cast<std::byte*>(__builtin_assume_aligned(input, aes_block_size));
+
+  // compute wb_1 <- \sigma(x) in every lane, see sigma above
+  const __m512i mask = _mm512_broadcast_i32x4(_mm_set_epi64x(0xffffffffffffffff, 0));
+  for (std::size_t j = 0; j < 4; ++j) {
+    const __m512i x = _mm512_loadu_si512(input_ptr + 64 * j);
+    const __m512i tmp = _mm512_shuffle_epi32(x, _MM_PERM_ENUM(0b01'00'11'10));
+    wb_1[j] = _mm512_xor_si512(tmp, _mm512_and_si512(x, mask));
+  }
+
+  // compute wb_2 <- \pi(\sigma(x))
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_xor_si512(wb_1[j], round_keys[0]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[1]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[2]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[3]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[4]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[5]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[6]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[7]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[8]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenc_epi128(wb_2[j], round_keys[9]);
+  for (std::size_t j = 0; j < 4; ++j) wb_2[j] = _mm512_aesenclast_epi128(wb_2[j], round_keys[10]);
+
+  // store \pi(\sigma(x)) ^ \sigma(x)
+  for (std::size_t j = 0; j < 4; ++j) {
+    _mm512_storeu_si512(input_ptr + 64 * j, _mm512_xor_si512(wb_2[j], wb_1[j]));
+  }
+}
+
+void fixed_key_mmo_hat_batch(const void* round_keys_in, void* input, std::size_t num_blocks) {
+  auto* input_ptr = reinterpret_cast<std::byte*>(input);
+  std::size_t i = 0;
+  if (vaes_supported()) {
+    for (; i + 16 <= num_blocks; i += 16) {
+      vaes_fixed_key_mmo_hat_batch_16(round_keys_in, input_ptr + 16 * i);
+    }
+  }
+  for (; i < num_blocks; i += 8) {
+    aesni_fixed_key_mmo_hat_batch_8(round_keys_in, input_ptr + 16 * i);
+  }
+}
+
 void aesni_fixed_key_for_half_gates_batch_4(const void* round_keys_in, const void* hash_key,
                                             std::size_t index, void* input) {
   alignas(16) std::array<__m128i, 4> wb_1;
@@ -30,6 +30,9 @@ constexpr std::size_t aes_block_size = 16;
 constexpr std::size_t aes_round_keys_size_128 = 176;
 constexpr std::size_t aes_num_round_keys_128 = 11;
 
+// true if the CPU supports AVX-512F and VAES, which the vaes_* functions require
+bool vaes_supported();
+
 // expand the round_keys with the assumptions:
 // * first round key == aes key is already placed at the start of the buffer
 // * round_keys is 16B aligned
@@ -45,6 +48,20 @@ void aesni_ctr_stream_blocks_128(const void* round_keys, std::uint64_t* counter,
 void aesni_ctr_stream_blocks_128_unaligned(const void* round_keys, std::uint64_t* counter,
                                            void* output, std::size_t num_blocks);
 
+// generate num_blocks of random bytes using AES in counter mode with the 512 bit VAES
+// instructions, the output is the same as the one of aesni_ctr_stream_blocks_128_unaligned
+// * only call this if the CPU supports AVX-512F and VAES
+// * round_keys are 16B aligned
+void vaes_ctr_stream_blocks_128_unaligned(const void* round_keys, std::uint64_t* counter,
+                                          void* output, std::size_t num_blocks);
+
+// generate num_blocks of random bytes using AES in counter mode on the blocks nonce || counter,
+// i.e., the nonce is in the lower and the counter in the upper 64 bit of each block
+// * round_keys and output are 16B aligned
+void aesni_ctr_stream_blocks_128_nonce(const void* round_keys, std::uint64_t nonce,
+                                       std::uint64_t* counter, void* output,
+                                       std::size_t num_blocks);
+
 // generate a single block of random bytes using AES in counter mode
 // * round_keys are 16B aligned
 void aesni_ctr_stream_single_block_128_unaligned(const void* round_keys, std::uint64_t* counter,
@@ -66,6 +83,27 @@ void aesni_tmmo_batch_4(const void* round_keys, void* input, __uint128_t tweak);
 // * round_keys are 16B aligned
 void aesni_mmo_single(const void* round_keys, void* input);
 
+// Compute MMO^\pi(x) = \pi(x) ^ x for 8 blocks inplace
+//
+// * round_keys and input are 16B aligned
+void aesni_mmo_batch_8(const void* round_keys, void* input);
+
+// Compute MMO^\pi(x) = \pi(x) ^ x for 16 blocks inplace with the 512 bit VAES instructions
+//
+// * only call this if the CPU supports AVX-512F and VAES
+// * round_keys and input are 16B aligned
+void vaes_mmo_batch_16(const void* round_keys, void* input);
+
+// Expand `num_parents` nodes of a GGM tree inplace with the length-doubling PRG
+//
+// G(x) = MMO^\pi(x) || MMO^\pi(x ^ 1),
+//
+// i.e., the node at position i is replaced by its children at positions 2i and 2i + 1.
+//
+// * round_keys and nodes are 16B aligned
+// * nodes has space for 2 * num_parents blocks
+void aesni_ggm_expand_level(const void* round_keys, void* nodes, std::size_t num_parents);
+
 // Compute the dual-key cipher A2/D1 by Bellare et al.
 // (https://eprint.iacr.org/2013/426).
 //
@@ -80,11 +118,30 @@ void aesni_mmo_single(const void* round_keys, void* input);
 void aesni_bmr_dkc(const void* round_keys, const void* key_a, const void* key_b,
                    std::uint64_t gate_id, std::size_t num_parties, void* output);
 
+// Computes `num_dkcs` invocations of aesni_bmr_dkc at once, i.e., for i = 0, ..., num_dkcs - 1
+//   aesni_bmr_dkc(round_keys, key_a[i], key_b[i], gate_ids[i], num_parties,
+//                 output + i * num_parties)
+// where the blocks of all invocations are encrypted in an interleaved manner.
+void aesni_bmr_dkc_batch(const void* round_keys, const void* keys_a, const void* keys_b,
+                         const std::uint64_t* gate_ids, std::size_t num_dkcs,
+                         std::size_t num_parties, void* output);
+
 // Vectorized implementation of the \hat{MMO} construction providing circular
 // correlation robustness from https://eprint.iacr.org/2019/074:
 //   \hat{MMO}_\sigma^\pi(x) := \pi(\sigma(x)) \oplus \sigma(x)
 //
 void aesni_fixed_key_mmo_hat_batch_4(const void* round_keys_in, void* input);
+// the same on 8 blocks
+// * round_keys and input are 16B aligned
+void aesni_fixed_key_mmo_hat_batch_8(const void* round_keys_in, void* input);
+// the same on 16 blocks with the 512 bit VAES instructions
+// * only call this if the CPU supports AVX-512F and VAES
+// * round_keys and input are 16B aligned
+void vaes_fixed_key_mmo_hat_batch_16(const void* round_keys_in, void* input);
+// the same on num_blocks blocks, with VAES if the CPU supports it
+// * num_blocks is a multiple of 8
+// * round_keys and input are 16B aligned
+void fixed_key_mmo_hat_batch(const void* round_keys_in, void* input, std::size_t num_blocks);
 void aesni_fixed_key_for_half_gates_batch_2(const void* round_keys_in, const void* hash_key,
                                             std::size_t index, void* input);
 void aesni_fixed_key_for_half_gates_batch_4(const void* round_keys_in, const void* hash_key,
@@ -22,17 +22,311 @@
 
 #include "arithmetic_provider.h"
 
+#include <immintrin.h>
+#include <array>
 #include <stdexcept>
 #include <vector>
 
+#include <fmt/format.h>
 #include <unsupported/Eigen/CXX11/Tensor>
 
 #include "communication/communication_layer.h"
 #include "oblivious_transfer/ot_flavors.h"
 #include "oblivious_transfer/ot_provider.h"
+#include "utility/cpu_features.h"
 
 namespace MOTION {
 
+// ---------- integer multiplication kernels ----------
+
+namespace {
+
+template <typename T>
+void sum_bit_products_scalar(const T* __restrict ot_outputs, T* __restrict outputs,
+                             std::size_t batch_size, std::size_t vector_size, bool negate) {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  for (std::size_t output_i = 0; output_i < batch_size; ++output_i) {
+    for (std::size_t vector_entry_k = 0; vector_entry_k < vector_size; ++vector_entry_k) {
+      T value = 0;
+      for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
+        value += ot_outputs[(output_i * bit_size + bit_j) * vector_size + vector_entry_k];
+      }
+      outputs[output_i * vector_size + vector_entry_k] = negate ? T(-value) : value;
+    }
+  }
+}
+
+template <typename T>
+inline __m128i add_sse(__m128i a, __m128i b) {
+  if constexpr (sizeof(T) == 1) {
+    return _mm_add_epi8(a, b);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm_add_epi16(a, b);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm_add_epi32(a, b);
+  } else {
+    return _mm_add_epi64(a, b);
+  }
+}
+
+// sum of the lanes of x
+template <typename T>
+inline T horizontal_sum_sse(__m128i x) {
+  x = add_sse<T>(x, _mm_srli_si128(x, 8));
+  if constexpr (sizeof(T) <= 4) {
+    x = add_sse<T>(x, _mm_srli_si128(x, 4));
+  }
+  if constexpr (sizeof(T) <= 2) {
+    x = add_sse<T>(x, _mm_srli_si128(x, 2));
+  }
+  if constexpr (sizeof(T) == 1) {
+    x = add_sse<T>(x, _mm_srli_si128(x, 1));
+  }
+  return static_cast<T>(_mm_cvtsi128_si64(x));
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i add_avx2(__m256i a, __m256i b) {
+  if constexpr (sizeof(T) == 1) {
+    return _mm256_add_epi8(a, b);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm256_add_epi16(a, b);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm256_add_epi32(a, b);
+  } else {
+    return _mm256_add_epi64(a, b);
+  }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i sub_avx2(__m256i a, __m256i b) {
+  if constexpr (sizeof(T) == 1) {
+    return _mm256_sub_epi8(a, b);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm256_sub_epi16(a, b);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm256_sub_epi32(a, b);
+  } else {
+    return _mm256_sub_epi64(a, b);
+  }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline T horizontal_sum_avx2(__m256i x) {
+  return horizontal_sum_sse<T>(
+      add_sse<T>(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+// sum up the rows of the bits element-wise if the products are vectors
+template <typename T>
+__attribute__((target("avx2"))) void sum_bit_rows_avx2(const T* ot_outputs, T* outputs,
+                                                      std::size_t batch_size,
+                                                      std::size_t vector_size, bool negate) {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  constexpr std::size_t lanes = sizeof(__m256i) / sizeof(T);
+  const auto zero = _mm256_setzero_si256();
+  for (std::size_t output_i = 0; output_i < batch_size; ++output_i) {
+    const T* block = ot_outputs + output_i * bit_size * vector_size;
+    T* out = outputs + output_i * vector_size;
+    std::size_t vector_entry_k = 0;
+    for (; vector_entry_k + lanes <= vector_size; vector_entry_k += lanes) {
+      auto acc = zero;
+      for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
+        acc = add_avx2<T>(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                                   block + bit_j * vector_size + vector_entry_k)));
+      }
+      if (negate) {
+        acc = sub_avx2<T>(zero, acc);
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + vector_entry_k), acc);
+    }
+    for (; vector_entry_k < vector_size; ++vector_entry_k) {
+      T value = 0;
+      for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
+        value += block[bit_j * vector_size + vector_entry_k];
+      }
+      out[vector_entry_k] = negate ? T(-value) : value;
+    }
+  }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void sum_bit_products_avx2(const T* ot_outputs, T* outputs,
+                                                          std::size_t batch_size,
+                                                          std::size_t vector_size, bool negate) {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  constexpr std::size_t lanes = sizeof(__m256i) / sizeof(T);
+  if (vector_size != 1) {
+    sum_bit_rows_avx2(ot_outputs, outputs, batch_size, vector_size, negate);
+    return;
+  }
+  if constexpr (sizeof(T) == 1) {
+    // the sums of absolute differences to zero add up the 8 products of 4 outputs at once
+    const auto zero = _mm256_setzero_si256();
+    std::size_t output_i = 0;
+    for (; output_i + 4 <= batch_size; output_i += 4) {
+      auto sums = _mm256_sad_epu8(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ot_outputs + output_i * bit_size)),
+          zero);
+      if (negate) {
+        sums = _mm256_sub_epi64(zero, sums);
+      }
+      alignas(sizeof(__m256i)) std::array<std::uint64_t, 4> values;
+      _mm256_store_si256(reinterpret_cast<__m256i*>(values.data()), sums);
+      for (std::size_t l = 0; l < 4; ++l) {
+        outputs[output_i + l] = static_cast<T>(values[l]);
+      }
+    }
+    sum_bit_products_scalar(ot_outputs + output_i * bit_size, outputs + output_i,
+                            batch_size - output_i, 1, negate);
+  } else {
+    // the bit_size products of an output fill bit_size / lanes vectors
+    for (std::size_t output_i = 0; output_i < batch_size; ++output_i) {
+      const T* products = ot_outputs + output_i * bit_size;
+      auto acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(products));
+      for (std::size_t v = 1; v < bit_size / lanes; ++v) {
+        acc = add_avx2<T>(acc,
+                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(products) + v));
+      }
+      const auto value = horizontal_sum_avx2<T>(acc);
+      outputs[output_i] = negate ? T(-value) : value;
+    }
+  }
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) inline __m512i add_avx512(__m512i a, __m512i b) {
+  if constexpr (sizeof(T) == 1) {
+    return _mm512_add_epi8(a, b);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm512_add_epi16(a, b);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm512_add_epi32(a, b);
+  } else {
+    return _mm512_add_epi64(a, b);
+  }
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) void sum_bit_products_avx512(
+    const T* ot_outputs, T* outputs, std::size_t batch_size, std::size_t vector_size,
+    bool negate) {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  constexpr std::size_t lanes = sizeof(__m512i) / sizeof(T);
+  if (vector_size != 1 || (sizeof(T) != 1 && bit_size < lanes)) {
+    // the 16 products of a 16 bit output fill only a 256 bit vector
+    sum_bit_products_avx2(ot_outputs, outputs, batch_size, vector_size, negate);
+    return;
+  }
+  if constexpr (sizeof(T) == 1) {
+    // the sums of absolute differences to zero add up the 8 products of 8 outputs at once
+    const auto zero = _mm512_setzero_si512();
+    std::size_t output_i = 0;
+    for (; output_i + 8 <= batch_size; output_i += 8) {
+      auto sums = _mm512_sad_epu8(_mm512_loadu_si512(ot_outputs + output_i * bit_size), zero);
+      if (negate) {
+        sums = _mm512_sub_epi64(zero, sums);
+      }
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(outputs + output_i),
+                       _mm512_cvtepi64_epi8(sums));
+    }
+    sum_bit_products_scalar(ot_outputs + output_i * bit_size, outputs + output_i,
+                            batch_size - output_i, 1, negate);
+  } else {
+    for (std::size_t output_i = 0; output_i < batch_size; ++output_i) {
+      const T* products = ot_outputs + output_i * bit_size;
+      auto acc = _mm512_loadu_si512(products);
+      for (std::size_t v = 1; v < bit_size / lanes; ++v) {
+        acc = add_avx512<T>(acc, _mm512_loadu_si512(products + v * lanes));
+      }
+      const auto value = horizontal_sum_avx2<T>(
+          add_avx2<T>(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1)));
+      outputs[output_i] = negate ? T(-value) : value;
+    }
+  }
+}
+
+}  // namespace
+
+bool is_integer_multiplication_kernel_supported(IntegerMultiplicationKernel kernel) {
+  switch (kernel) {
+    case IntegerMultiplicationKernel::automatic:
+    case IntegerMultiplicationKernel::scalar:
+      return true;
+    case IntegerMultiplicationKernel::avx2:
+      return get_cpu_features().avx2;
+    case IntegerMultiplicationKernel::avx512:
+      return get_cpu_features().avx512f && get_cpu_features().avx512bw;
+  }
+  return false;
+}
+
+IntegerMultiplicationKernel get_best_integer_multiplication_kernel() {
+  static const IntegerMultiplicationKernel best_kernel = [] {
+    for (auto kernel : {IntegerMultiplicationKernel::avx512, IntegerMultiplicationKernel::avx2}) {
+      if (is_integer_multiplication_kernel_supported(kernel)) {
+        return kernel;
+      }
+    }
+    return IntegerMultiplicationKernel::scalar;
+  }();
+  return best_kernel;
+}
+
+std::string to_string(IntegerMultiplicationKernel kernel) {
+  switch (kernel) {
+    case IntegerMultiplicationKernel::automatic:
+      return "automatic";
+    case IntegerMultiplicationKernel::scalar:
+      return "scalar";
+    case IntegerMultiplicationKernel::avx2:
+      return "avx2";
+    case IntegerMultiplicationKernel::avx512:
+      return "avx512";
+  }
+  return "invalid";
+}
+
+namespace detail {
+
+template <typename T>
+void sum_bit_products(const T* ot_outputs, T* outputs, std::size_t batch_size,
+                      std::size_t vector_size, bool negate, IntegerMultiplicationKernel kernel) {
+  if (kernel == IntegerMultiplicationKernel::automatic) {
+    kernel = get_best_integer_multiplication_kernel();
+  } else if (!is_integer_multiplication_kernel_supported(kernel)) {
+    throw std::invalid_argument(fmt::format(
+        "integer multiplication kernel {} is not supported by this CPU", to_string(kernel)));
+  }
+  // 128 bit rings have no SIMD lanes
+  if constexpr (sizeof(T) <= sizeof(std::uint64_t)) {
+    switch (kernel) {
+      case IntegerMultiplicationKernel::avx512:
+        sum_bit_products_avx512(ot_outputs, outputs, batch_size, vector_size, negate);
+        return;
+      case IntegerMultiplicationKernel::avx2:
+        sum_bit_products_avx2(ot_outputs, outputs, batch_size, vector_size, negate);
+        return;
+      default:
+        break;
+    }
+  }
+  sum_bit_products_scalar(ot_outputs, outputs, batch_size, vector_size, negate);
+}
+
+template void sum_bit_products(const std::uint8_t*, std::uint8_t*, std::size_t, std::size_t, bool,
+                               IntegerMultiplicationKernel);
+template void sum_bit_products(const std::uint16_t*, std::uint16_t*, std::size_t, std::size_t,
+                               bool, IntegerMultiplicationKernel);
+template void sum_bit_products(const std::uint32_t*, std::uint32_t*, std::size_t, std::size_t,
+                               bool, IntegerMultiplicationKernel);
+template void sum_bit_products(const std::uint64_t*, std::uint64_t*, std::size_t, std::size_t,
+                               bool, IntegerMultiplicationKernel);
+template void sum_bit_products(const __uint128_t*, __uint128_t*, std::size_t, std::size_t, bool,
+                               IntegerMultiplicationKernel);
+
+}  // namespace detail
+
 // ---------- BitIntegerMultiplicationIntSide ----------
 
 template <typename T>
@@ -204,25 +498,11 @@ void IntegerMultiplicationSender<T>::set_inputs(const T* inputs) {
 
 template <typename T>
 void IntegerMultiplicationSender<T>::compute_outputs() {
-  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
-
-  const auto idx = [this](auto output_i, auto vector_enty_k, auto bit_j) {
-    return output_i * vector_size_ * bit_size + bit_j * vector_size_ + vector_enty_k;
-  };
-
   ot_sender_->ComputeOutputs();
   auto ot_outputs = ot_sender_->GetOutputs();
-  assert(ot_outputs.size() == batch_size_ * vector_size_ * bit_size);
+  assert(ot_outputs.size() == batch_size_ * vector_size_ * ENCRYPTO::bit_size_v<T>);
   outputs_.resize(batch_size_ * vector_size_);
-  for (std::size_t output_i = 0; output_i < batch_size_; ++output_i) {
-    for (std::size_t vector_enty_k = 0; vector_enty_k < vector_size_; ++vector_enty_k) {
-      T value = 0;
-      for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
-        value -= ot_outputs[idx(output_i, vector_enty_k, bit_j)];
-      }
-      outputs_[output_i * vector_size_ + vector_enty_k] = value;
-    }
-  }
+  detail::sum_bit_products(ot_outputs.data(), outputs_.data(), batch_size_, vector_size_, true);
 }
 
 template <typename T>
@@ -274,25 +554,11 @@ void IntegerMultiplicationReceiver<T>::set_inputs(const T* inputs) {
 
 template <typename T>
 void IntegerMultiplicationReceiver<T>::compute_outputs() {
-  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
-
-  const auto idx = [this](auto output_i, auto vector_enty_k, auto bit_j) {
-    return output_i * vector_size_ * bit_size + bit_j * vector_size_ + vector_enty_k;
-  };
-
   ot_receiver_->ComputeOutputs();
   auto ot_outputs = ot_receiver_->GetOutputs();
-  assert(ot_outputs.size() == batch_size_ * vector_size_ * bit_size);
+  assert(ot_outputs.size() == batch_size_ * vector_size_ * ENCRYPTO::bit_size_v<T>);
   outputs_.resize(batch_size_ * vector_size_);
-  for (std::size_t output_i = 0; output_i < batch_size_; ++output_i) {
-    for (std::size_t vector_enty_k = 0; vector_enty_k < vector_size_; ++vector_enty_k) {
-      T value = 0;
-      for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
-        value += ot_outputs[idx(output_i, vector_enty_k, bit_j)];
-      }
-      outputs_[output_i * vector_size_ + vector_enty_k] = value;
-    }
-  }
+  detail::sum_bit_products(ot_outputs.data(), outputs_.data(), batch_size_, vector_size_, false);
 }
 
 template <typename T>
@@ -311,9 +577,11 @@ void IntegerMultiplicationReceiver<T>::clear() noexcept {
 
 template <typename T>
 MatrixMultiplicationRHS<T>::MatrixMultiplicationRHS(std::size_t l, std::size_t m, std::size_t n,
-                                                    ArithmeticProvider& arith_provider)
+                                                    ArithmeticProvider& arith_provider,
+                                                    std::size_t num_matrices)
     : dims_({l, m, n}),
-      mult_sender_(arith_provider.register_integer_multiplication_send<T>(l * m, n)),
+      num_matrices_(num_matrices),
+      mult_sender_(arith_provider.register_integer_multiplication_send<T>(num_matrices * l * m, n)),
       is_output_ready_(false) {}
 
 template <typename T>
@@ -326,7 +594,7 @@ void MatrixMultiplicationRHS<T>::set_input(std::vector<T>&& inputs) {
 
 template <typename T>
 void MatrixMultiplicationRHS<T>::set_input(const std::vector<T>& inputs) {
-  if (inputs.size() != dims_[1] * dims_[2]) {
+  if (inputs.size() != num_matrices_ * dims_[1] * dims_[2]) {
     throw std::invalid_argument("input has unexpected size");
   }
   set_input(inputs.data());
@@ -335,9 +603,12 @@ void MatrixMultiplicationRHS<T>::set_input(const std::vector<T>& inputs) {
 template <typename T>
 void MatrixMultiplicationRHS<T>::set_input(const T* inputs) {
   const auto input_size = dims_[1] * dims_[2];
-  std::vector<T> mult_inputs(dims_[0] * input_size);
-  for (std::size_t i = 0; i < dims_[0]; ++i) {
-    std::copy_n(inputs, input_size, std::begin(mult_inputs) + i * input_size);
+  std::vector<T> mult_inputs(num_matrices_ * dims_[0] * input_size);
+  auto mult_inputs_it = std::begin(mult_inputs);
+  for (std::size_t mat_i = 0; mat_i < num_matrices_; ++mat_i) {
+    for (std::size_t i = 0; i < dims_[0]; ++i) {
+      mult_inputs_it = std::copy_n(inputs + mat_i * input_size, input_size, mult_inputs_it);
+    }
   }
   mult_sender_->set_inputs(std::move(mult_inputs));
 }
@@ -346,11 +617,13 @@ template <typename T>
 void MatrixMultiplicationRHS<T>::compute_output() {
   mult_sender_->compute_outputs();
   auto mult_output = mult_sender_->get_outputs();
-  output_.resize(dims_[0] * dims_[2]);
+  output_.resize(num_matrices_ * dims_[0] * dims_[2]);
   using TensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
   using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  Eigen::TensorMap<TensorType3> input_tensor(mult_output.data(), dims_[0], dims_[1], dims_[2]);
-  Eigen::TensorMap<TensorType2> output_tensor(output_.data(), dims_[0], dims_[2]);
+  // the rows of all matrices of the batch are reduced at once
+  Eigen::TensorMap<TensorType3> input_tensor(mult_output.data(), num_matrices_ * dims_[0],
+                                             dims_[1], dims_[2]);
+  Eigen::TensorMap<TensorType2> output_tensor(output_.data(), num_matrices_ * dims_[0], dims_[2]);
   Eigen::array<Eigen::Index, 1> reduction_dimensions = {1};
   output_tensor = input_tensor.sum(reduction_dimensions);
   is_output_ready_ = true;
@@ -373,9 +646,12 @@ void MatrixMultiplicationRHS<T>::clear() noexcept {
 
 template <typename T>
 MatrixMultiplicationLHS<T>::MatrixMultiplicationLHS(std::size_t l, std::size_t m, std::size_t n,
-                                                    ArithmeticProvider& arith_provider)
+                                                    ArithmeticProvider& arith_provider,
+                                                    std::size_t num_matrices)
     : dims_({l, m, n}),
-      mult_receiver_(arith_provider.register_integer_multiplication_receive<T>(l * m, n)),
+      num_matrices_(num_matrices),
+      mult_receiver_(
+          arith_provider.register_integer_multiplication_receive<T>(num_matrices * l * m, n)),
       is_output_ready_(false) {}
 
 template <typename T>
@@ -383,7 +659,7 @@ MatrixMultiplicationLHS<T>::~MatrixMultiplicationLHS() = default;
 
 template <typename T>
 void MatrixMultiplicationLHS<T>::set_input(std::vector<T>&& inputs) {
-  if (inputs.size() != dims_[0] * dims_[1]) {
+  if (inputs.size() != num_matrices_ * dims_[0] * dims_[1]) {
     throw std::invalid_argument("input has unexpected size");
   }
   mult_receiver_->set_inputs(std::move(inputs));
@@ -391,7 +667,7 @@ void MatrixMultiplicationLHS<T>::set_input(std::vector<T>&& inputs) {
 
 template <typename T>
 void MatrixMultiplicationLHS<T>::set_input(const std::vector<T>& inputs) {
-  if (inputs.size() != dims_[0] * dims_[1]) {
+  if (inputs.size() != num_matrices_ * dims_[0] * dims_[1]) {
     throw std::invalid_argument("input has unexpected size");
   }
   set_input(inputs.data());
@@ -399,7 +675,7 @@ void MatrixMultiplicationLHS<T>::set_input(const std::vector<T>& inputs) {
 
 template <typename T>
 void MatrixMultiplicationLHS<T>::set_input(const T* inputs) {
-  std::vector<T> mult_inputs(inputs, inputs + dims_[0] * dims_[1]);
+  std::vector<T> mult_inputs(inputs, inputs + num_matrices_ * dims_[0] * dims_[1]);
   mult_receiver_->set_inputs(std::move(mult_inputs));
 }
 
@@ -407,12 +683,14 @@ template <typename T>
 void MatrixMultiplicationLHS<T>::compute_output() {
   mult_receiver_->compute_outputs();
   auto mult_output = mult_receiver_->get_outputs();
-  assert(mult_output.size() == dims_[0] * dims_[1] * dims_[2]);
-  output_.resize(dims_[0] * dims_[2]);
+  assert(mult_output.size() == num_matrices_ * dims_[0] * dims_[1] * dims_[2]);
+  output_.resize(num_matrices_ * dims_[0] * dims_[2]);
   using TensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
   using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  Eigen::TensorMap<TensorType3> input_tensor(mult_output.data(), dims_[0], dims_[1], dims_[2]);
-  Eigen::TensorMap<TensorType2> output_tensor(output_.data(), dims_[0], dims_[2]);
+  // the rows of all matrices of the batch are reduced at once
+  Eigen::TensorMap<TensorType3> input_tensor(mult_output.data(), num_matrices_ * dims_[0],
+                                             dims_[1], dims_[2]);
+  Eigen::TensorMap<TensorType2> output_tensor(output_.data(), num_matrices_ * dims_[0], dims_[2]);
   Eigen::array<Eigen::Index, 1> reduction_dimensions = {1};
   output_tensor = input_tensor.sum(reduction_dimensions);
   is_output_ready_ = true;
@@ -431,16 +709,41 @@ void MatrixMultiplicationLHS<T>::clear() noexcept {
   is_output_ready_ = false;
 }
 
+// transform the convolution output in matrix form back into the output tensor (in place), the
+// columns of the samples of a batch are stored one after another
+template <typename T>
+static void convolution_output_from_matrix(const tensor::Conv2DOp& conv_op, T* output_buffer) {
+  using CTensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
+  using TensorType4 = Eigen::Tensor<T, 4, Eigen::RowMajor>;
+  const auto matrix_shape = conv_op.compute_output_matrix_shape();
+  // be careful about aliasing, use eval()
+  Eigen::TensorMap<CTensorType2> output_matrix(output_buffer, matrix_shape.first,
+                                               matrix_shape.second);
+  Eigen::TensorMap<TensorType4> output(output_buffer, conv_op.batch_size_,
+                                       conv_op.output_shape_[0], conv_op.output_shape_[1],
+                                       conv_op.output_shape_[2]);
+  const std::array<Eigen::Index, 4> matrix_dimensions = {
+      static_cast<Eigen::Index>(conv_op.output_shape_[0]),
+      static_cast<Eigen::Index>(conv_op.batch_size_),
+      static_cast<Eigen::Index>(conv_op.output_shape_[2]),
+      static_cast<Eigen::Index>(conv_op.output_shape_[1])};
+  output = output_matrix.reshape(matrix_dimensions)
+               .shuffle(Eigen::array<Eigen::Index, 4>{1, 0, 3, 2})
+               .eval();
+}
+
 // ---------- ConvolutionInputSide ----------
 
 template <typename T>
 ConvolutionInputSide<T>::ConvolutionInputSide(tensor::Conv2DOp conv_op,
-                                              ArithmeticProvider& arith_provider)
-    : conv_op_(conv_op), is_output_ready_(false) {
+                                              ArithmeticProvider& arith_provider,
+                                              std::size_t num_convs)
+    : conv_op_(conv_op), num_convs_(num_convs), is_output_ready_(false) {
   const auto kernel_matrix_shape = conv_op_.compute_kernel_matrix_shape();
   const auto input_matrix_shape = conv_op_.compute_input_matrix_shape();
   matrix_rhs_ = arith_provider.register_matrix_multiplication_rhs<T>(
-      kernel_matrix_shape.first, kernel_matrix_shape.second, input_matrix_shape.second);
+      kernel_matrix_shape.first, kernel_matrix_shape.second, input_matrix_shape.second,
+      num_convs);
 }
 
 template <typename T>
@@ -453,7 +756,7 @@ void ConvolutionInputSide<T>::set_input(std::vector<T>&& input) {
 
 template <typename T>
 void ConvolutionInputSide<T>::set_input(const std::vector<T>& input) {
-  if (input.size() != conv_op_.compute_input_size()) {
+  if (input.size() != num_convs_ * conv_op_.compute_input_size()) {
     throw std::invalid_argument("input has unexpected size");
   }
   set_input(input.data());
@@ -462,22 +765,30 @@ void ConvolutionInputSide<T>::set_input(const std::vector<T>& input) {
 template <typename T>
 void ConvolutionInputSide<T>::set_input(const T* input_buffer) {
   const auto matrix_shape = conv_op_.compute_input_matrix_shape();
-  std::vector<T> input_matrix_buffer(matrix_shape.first * matrix_shape.second);
+  const auto matrix_size = matrix_shape.first * matrix_shape.second;
+  const auto input_size = conv_op_.compute_input_size();
+  std::vector<T> input_matrix_buffer(num_convs_ * matrix_size);
   using TensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
-  using CTensorType3 = Eigen::Tensor<const T, 3, Eigen::RowMajor>;
-  Eigen::TensorMap<CTensorType3> input(input_buffer, conv_op_.input_shape_[0],
-                                       conv_op_.input_shape_[1], conv_op_.input_shape_[2]);
-  Eigen::TensorMap<TensorType2> input_matrix(input_matrix_buffer.data(), matrix_shape.first,
-                                             matrix_shape.second);
-  input_matrix =
-      input.shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0})
-          .extract_image_patches(conv_op_.kernel_shape_[2], conv_op_.kernel_shape_[3],
-                                 conv_op_.strides_[0], conv_op_.strides_[1], conv_op_.dilations_[0],
-                                 conv_op_.dilations_[1], 1, 1, conv_op_.pads_[0], conv_op_.pads_[2],
-                                 conv_op_.pads_[1], conv_op_.pads_[3], 0)
-          .reshape(Eigen::array<Eigen::Index, 2>{static_cast<Eigen::Index>(matrix_shape.second),
-                                                 static_cast<Eigen::Index>(matrix_shape.first)})
-          .shuffle(Eigen::array<Eigen::Index, 2>{1, 0});
+  using CTensorType4 = Eigen::Tensor<const T, 4, Eigen::RowMajor>;
+  for (std::size_t conv_i = 0; conv_i < num_convs_; ++conv_i) {
+    Eigen::TensorMap<CTensorType4> input(input_buffer + conv_i * input_size, conv_op_.batch_size_,
+                                         conv_op_.input_shape_[0], conv_op_.input_shape_[1],
+                                         conv_op_.input_shape_[2]);
+    Eigen::TensorMap<TensorType2> input_matrix(input_matrix_buffer.data() + conv_i * matrix_size,
+                                               matrix_shape.first, matrix_shape.second);
+    // the patches of the samples are the columns of a single matrix, one sample after another,
+    // s.t. the kernel is multiplied with the whole batch at once
+    input_matrix =
+        input.shuffle(Eigen::array<Eigen::Index, 4>{0, 3, 2, 1})
+            .extract_image_patches(conv_op_.kernel_shape_[2], conv_op_.kernel_shape_[3],
+                                   conv_op_.strides_[0], conv_op_.strides_[1],
+                                   conv_op_.dilations_[0], conv_op_.dilations_[1], 1, 1,
+                                   conv_op_.pads_[0], conv_op_.pads_[2], conv_op_.pads_[1],
+                                   conv_op_.pads_[3], 0)
+            .reshape(Eigen::array<Eigen::Index, 2>{static_cast<Eigen::Index>(matrix_shape.second),
+                                                   static_cast<Eigen::Index>(matrix_shape.first)})
+            .shuffle(Eigen::array<Eigen::Index, 2>{1, 0});
+  }
   matrix_rhs_->set_input(std::move(input_matrix_buffer));
 }
 
@@ -485,23 +796,11 @@ template <typename T>
 void ConvolutionInputSide<T>::compute_output() {
   matrix_rhs_->compute_output();
   output_ = matrix_rhs_->get_output();
-  assert(output_.size() == conv_op_.compute_output_size());
-  using CTensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
-  using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  const auto matrix_shape = conv_op_.compute_output_matrix_shape();
-  // be careful about aliasing, use eval()
-  Eigen::TensorMap<CTensorType2> output_matrix(output_.data(), matrix_shape.first,
-                                               matrix_shape.second);
-  Eigen::TensorMap<TensorType3> output(output_.data(), conv_op_.output_shape_[0],
-                                       conv_op_.output_shape_[1], conv_op_.output_shape_[2]);
-  const std::array<Eigen::Index, 3> rev_output_dimensions = {
-      static_cast<Eigen::Index>(conv_op_.output_shape_[2]),
-      static_cast<Eigen::Index>(conv_op_.output_shape_[1]),
-      static_cast<Eigen::Index>(conv_op_.output_shape_[0])};
-  output = output_matrix.shuffle(std::array<Eigen::Index, 2>{1, 0})
-               .reshape(rev_output_dimensions)
-               .shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0})
-               .eval();
+  const auto output_size = conv_op_.compute_output_size();
+  assert(output_.size() == num_convs_ * output_size);
+  for (std::size_t conv_i = 0; conv_i < num_convs_; ++conv_i) {
+    convolution_output_from_matrix(conv_op_, output_.data() + conv_i * output_size);
+  }
   is_output_ready_ = true;
 }
 
@@ -522,12 +821,14 @@ void ConvolutionInputSide<T>::clear() noexcept {
 
 template <typename T>
 ConvolutionKernelSide<T>::ConvolutionKernelSide(tensor::Conv2DOp conv_op,
-                                                ArithmeticProvider& arith_provider)
-    : conv_op_(conv_op), is_output_ready_(false) {
+                                                ArithmeticProvider& arith_provider,
+                                                std::size_t num_convs)
+    : conv_op_(conv_op), num_convs_(num_convs), is_output_ready_(false) {
   const auto kernel_matrix_shape = conv_op_.compute_kernel_matrix_shape();
   const auto input_matrix_shape = conv_op_.compute_input_matrix_shape();
   matrix_lhs_ = arith_provider.register_matrix_multiplication_lhs<T>(
-      kernel_matrix_shape.first, kernel_matrix_shape.second, input_matrix_shape.second);
+      kernel_matrix_shape.first, kernel_matrix_shape.second, input_matrix_shape.second,
+      num_convs);
 }
 
 template <typename T>
@@ -540,7 +841,7 @@ void ConvolutionKernelSide<T>::set_input(std::vector<T>&& kernel_buffer) {
 
 template <typename T>
 void ConvolutionKernelSide<T>::set_input(const std::vector<T>& kernel) {
-  if (kernel.size() != conv_op_.compute_kernel_size()) {
+  if (kernel.size() != num_convs_ * conv_op_.compute_kernel_size()) {
     throw std::invalid_argument("kernel has unexpected size");
   }
   set_input(kernel.data());
@@ -550,18 +851,22 @@ template <typename T>
 void ConvolutionKernelSide<T>::set_input(const T* kernel_buffer) {
   using TensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
   using CTensorType4 = Eigen::Tensor<const T, 4, Eigen::RowMajor>;
-  Eigen::TensorMap<CTensorType4> kernel(kernel_buffer, conv_op_.kernel_shape_[0],
-                                        conv_op_.kernel_shape_[1], conv_op_.kernel_shape_[2],
-                                        conv_op_.kernel_shape_[3]);
   const auto matrix_shape = conv_op_.compute_kernel_matrix_shape();
-  std::vector<T> kernel_matrix_buffer(matrix_shape.first * matrix_shape.second);
-  Eigen::TensorMap<TensorType2> kernel_matrix(kernel_matrix_buffer.data(), matrix_shape.first,
-                                              matrix_shape.second);
-  kernel_matrix =
-      kernel.shuffle(std::array<Eigen::Index, 4>{3, 2, 1, 0})
-          .reshape(std::array<Eigen::Index, 2>{static_cast<Eigen::Index>(matrix_shape.second),
-                                               static_cast<Eigen::Index>(matrix_shape.first)})
-          .shuffle(std::array<Eigen::Index, 2>{1, 0});
+  const auto matrix_size = matrix_shape.first * matrix_shape.second;
+  const auto kernel_size = conv_op_.compute_kernel_size();
+  std::vector<T> kernel_matrix_buffer(num_convs_ * matrix_size);
+  for (std::size_t conv_i = 0; conv_i < num_convs_; ++conv_i) {
+    Eigen::TensorMap<CTensorType4> kernel(kernel_buffer + conv_i * kernel_size,
+                                          conv_op_.kernel_shape_[0], conv_op_.kernel_shape_[1],
+                                          conv_op_.kernel_shape_[2], conv_op_.kernel_shape_[3]);
+    Eigen::TensorMap<TensorType2> kernel_matrix(kernel_matrix_buffer.data() + conv_i * matrix_size,
+                                                matrix_shape.first, matrix_shape.second);
+    kernel_matrix =
+        kernel.shuffle(std::array<Eigen::Index, 4>{3, 2, 1, 0})
+            .reshape(std::array<Eigen::Index, 2>{static_cast<Eigen::Index>(matrix_shape.second),
+                                                 static_cast<Eigen::Index>(matrix_shape.first)})
+            .shuffle(std::array<Eigen::Index, 2>{1, 0});
+  }
   matrix_lhs_->set_input(std::move(kernel_matrix_buffer));
 }
 
@@ -569,23 +874,11 @@ template <typename T>
 void ConvolutionKernelSide<T>::compute_output() {
   matrix_lhs_->compute_output();
   output_ = matrix_lhs_->get_output();
-  assert(output_.size() == conv_op_.compute_output_size());
-  using CTensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
-  using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  const auto matrix_shape = conv_op_.compute_output_matrix_shape();
-  // be careful about aliasing, use eval()
-  Eigen::TensorMap<CTensorType2> output_matrix(output_.data(), matrix_shape.first,
-                                               matrix_shape.second);
-  Eigen::TensorMap<TensorType3> output(output_.data(), conv_op_.output_shape_[0],
-                                       conv_op_.output_shape_[1], conv_op_.output_shape_[2]);
-  const std::array<Eigen::Index, 3> rev_output_dimensions = {
-      static_cast<Eigen::Index>(conv_op_.output_shape_[2]),
-      static_cast<Eigen::Index>(conv_op_.output_shape_[1]),
-      static_cast<Eigen::Index>(conv_op_.output_shape_[0])};
-  output = output_matrix.shuffle(std::array<Eigen::Index, 2>{1, 0})
-               .reshape(rev_output_dimensions)
-               .shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0})
-               .eval();
+  const auto output_size = conv_op_.compute_output_size();
+  assert(output_.size() == num_convs_ * output_size);
+  for (std::size_t conv_i = 0; conv_i < num_convs_; ++conv_i) {
+    convolution_output_from_matrix(conv_op_, output_.data() + conv_i * output_size);
+  }
   is_output_ready_ = true;
 }
 
@@ -602,6 +895,161 @@ void ConvolutionKernelSide<T>::clear() noexcept {
   is_output_ready_ = false;
 }
 
+// ---------- SparseMatrixMultiplication ----------
+
+// accumulate the shares of the products of the nonzero entries e of B with column j_e of A, which
+// are stored one after another, into the shares of the l x n output
+template <typename T>
+static void aggregate_sparse_products(std::size_t dim_l, const CSRMatrix<T>& pattern,
+                                      const std::vector<T>& products, std::vector<T>& output) {
+  assert(products.size() == pattern.get_num_nonzeros() * dim_l);
+  output.assign(dim_l * pattern.cols_, T(0));
+  for (std::size_t e = 0; e < pattern.get_num_nonzeros(); ++e) {
+    const auto k = pattern.col_idx_[e];
+    for (std::size_t i = 0; i < dim_l; ++i) {
+      output[i * pattern.cols_ + k] += products[e * dim_l + i];
+    }
+  }
+}
+
+// the pattern without its values
+template <typename T>
+static CSRMatrix<T> get_sparsity_pattern(const CSRMatrix<T>& matrix) {
+  if (!matrix.verify()) {
+    throw std::invalid_argument("invalid sparsity pattern");
+  }
+  return {.rows_ = matrix.rows_,
+          .cols_ = matrix.cols_,
+          .row_ptr_ = matrix.row_ptr_,
+          .col_idx_ = matrix.col_idx_,
+          .values_ = {}};
+}
+
+template <typename T>
+SparseMatrixMultiplicationSparseSide<T>::SparseMatrixMultiplicationSparseSide(
+    std::size_t l, const CSRMatrix<T>& pattern, ArithmeticProvider& arith_provider)
+    : dim_l_(l), pattern_(get_sparsity_pattern(pattern)), is_output_ready_(false) {
+  // without nonzero entries the product is zero and no OTs are needed
+  if (pattern_.get_num_nonzeros() > 0) {
+    mult_receiver_ =
+        arith_provider.register_integer_multiplication_receive<T>(pattern_.get_num_nonzeros(), l);
+  }
+}
+
+template <typename T>
+SparseMatrixMultiplicationSparseSide<T>::~SparseMatrixMultiplicationSparseSide() = default;
+
+template <typename T>
+void SparseMatrixMultiplicationSparseSide<T>::set_input(std::vector<T>&& values) {
+  set_input(values);
+}
+
+template <typename T>
+void SparseMatrixMultiplicationSparseSide<T>::set_input(const std::vector<T>& values) {
+  if (values.size() != pattern_.get_num_nonzeros()) {
+    throw std::invalid_argument("input has unexpected size");
+  }
+  set_input(values.data());
+}
+
+template <typename T>
+void SparseMatrixMultiplicationSparseSide<T>::set_input(const T* values) {
+  if (mult_receiver_) {
+    mult_receiver_->set_inputs(values);
+  }
+}
+
+template <typename T>
+void SparseMatrixMultiplicationSparseSide<T>::compute_output() {
+  std::vector<T> mult_output;
+  if (mult_receiver_) {
+    mult_receiver_->compute_outputs();
+    mult_output = mult_receiver_->get_outputs();
+  }
+  aggregate_sparse_products(dim_l_, pattern_, mult_output, output_);
+  is_output_ready_ = true;
+}
+
+template <typename T>
+std::vector<T> SparseMatrixMultiplicationSparseSide<T>::get_output() {
+  assert(is_output_ready_);
+  return std::move(output_);
+}
+
+template <typename T>
+void SparseMatrixMultiplicationSparseSide<T>::clear() noexcept {
+  if (mult_receiver_) {
+    mult_receiver_->clear();
+  }
+  output_ = {};
+  is_output_ready_ = false;
+}
+
+template <typename T>
+SparseMatrixMultiplicationDenseSide<T>::SparseMatrixMultiplicationDenseSide(
+    std::size_t l, const CSRMatrix<T>& pattern, ArithmeticProvider& arith_provider)
+    : dim_l_(l), pattern_(get_sparsity_pattern(pattern)), is_output_ready_(false) {
+  if (pattern_.get_num_nonzeros() > 0) {
+    mult_sender_ =
+        arith_provider.register_integer_multiplication_send<T>(pattern_.get_num_nonzeros(), l);
+  }
+}
+
+template <typename T>
+SparseMatrixMultiplicationDenseSide<T>::~SparseMatrixMultiplicationDenseSide() = default;
+
+template <typename T>
+void SparseMatrixMultiplicationDenseSide<T>::set_input(const std::vector<T>& inputs) {
+  if (inputs.size() != dim_l_ * pattern_.rows_) {
+    throw std::invalid_argument("input has unexpected size");
+  }
+  set_input(inputs.data());
+}
+
+template <typename T>
+void SparseMatrixMultiplicationDenseSide<T>::set_input(const T* inputs) {
+  if (!mult_sender_) {
+    return;
+  }
+  // the nonzero entry e in row j of B is multiplied with column j of A
+  const auto dim_m = pattern_.rows_;
+  std::vector<T> mult_inputs(pattern_.get_num_nonzeros() * dim_l_);
+  for (std::size_t j = 0; j < dim_m; ++j) {
+    for (std::size_t e = pattern_.row_ptr_[j]; e < pattern_.row_ptr_[j + 1]; ++e) {
+      for (std::size_t i = 0; i < dim_l_; ++i) {
+        mult_inputs[e * dim_l_ + i] = inputs[i * dim_m + j];
+      }
+    }
+  }
+  mult_sender_->set_inputs(std::move(mult_inputs));
+}
+
+template <typename T>
+void SparseMatrixMultiplicationDenseSide<T>::compute_output() {
+  std::vector<T> mult_output;
+  if (mult_sender_) {
+    mult_sender_->compute_outputs();
+    mult_output = mult_sender_->get_outputs();
+  }
+  aggregate_sparse_products(dim_l_, pattern_, mult_output, output_);
+  is_output_ready_ = true;
+}
+
+template <typename T>
+std::vector<T> SparseMatrixMultiplicationDenseSide<T>::get_output() {
+  assert(is_output_ready_);
+  return std::move(output_);
+}
+
+template <typename T>
+void SparseMatrixMultiplicationDenseSide<T>::clear() noexcept {
+  if (mult_sender_) {
+    mult_sender_->clear();
+  }
+  output_ = {};
+  is_output_ready_ = false;
+}
+
 // ---------- ArithmeticProvider ----------
 
 ArithmeticProvider::ArithmeticProvider(ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider,
@@ -640,26 +1088,40 @@ ArithmeticProvider::register_integer_multiplication_receive(std::size_t batch_si
 
 template <typename T>
 std::unique_ptr<MatrixMultiplicationRHS<T>> ArithmeticProvider::register_matrix_multiplication_rhs(
-    std::size_t dim_l, std::size_t dim_m, std::size_t dim_n) {
-  return std::make_unique<MatrixMultiplicationRHS<T>>(dim_l, dim_m, dim_n, *this);
+    std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, std::size_t num_matrices) {
+  return std::make_unique<MatrixMultiplicationRHS<T>>(dim_l, dim_m, dim_n, *this, num_matrices);
 }
 
 template <typename T>
 std::unique_ptr<MatrixMultiplicationLHS<T>> ArithmeticProvider::register_matrix_multiplication_lhs(
-    std::size_t dim_l, std::size_t dim_m, std::size_t dim_n) {
-  return std::make_unique<MatrixMultiplicationLHS<T>>(dim_l, dim_m, dim_n, *this);
+    std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, std::size_t num_matrices) {
+  return std::make_unique<MatrixMultiplicationLHS<T>>(dim_l, dim_m, dim_n, *this, num_matrices);
 }
 
 template <typename T>
 std::unique_ptr<ConvolutionInputSide<T>> ArithmeticProvider::register_convolution_input_side(
-    tensor::Conv2DOp conv_op) {
-  return std::make_unique<ConvolutionInputSide<T>>(conv_op, *this);
+    tensor::Conv2DOp conv_op, std::size_t num_convs) {
+  return std::make_unique<ConvolutionInputSide<T>>(conv_op, *this, num_convs);
 }
 
 template <typename T>
 std::unique_ptr<ConvolutionKernelSide<T>> ArithmeticProvider::register_convolution_kernel_side(
-    tensor::Conv2DOp conv_op) {
-  return std::make_unique<ConvolutionKernelSide<T>>(conv_op, *this);
+    tensor::Conv2DOp conv_op, std::size_t num_convs) {
+  return std::make_unique<ConvolutionKernelSide<T>>(conv_op, *this, num_convs);
+}
+
+template <typename T>
+std::unique_ptr<SparseMatrixMultiplicationSparseSide<T>>
+ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side(
+    std::size_t dim_l, const CSRMatrix<T>& pattern) {
+  return std::make_unique<SparseMatrixMultiplicationSparseSide<T>>(dim_l, pattern, *this);
+}
+
+template <typename T>
+std::unique_ptr<SparseMatrixMultiplicationDenseSide<T>>
+ArithmeticProvider::register_sparse_matrix_multiplication_dense_side(
+    std::size_t dim_l, const CSRMatrix<T>& pattern) {
+  return std::make_unique<SparseMatrixMultiplicationDenseSide<T>>(dim_l, pattern, *this);
 }
 
 // ---------- ArithmeticProviderManager ----------
@@ -733,6 +1195,18 @@ template class ConvolutionKernelSide<std::uint32_t>;
 template class ConvolutionKernelSide<std::uint64_t>;
 template class ConvolutionKernelSide<__uint128_t>;
 
+template class SparseMatrixMultiplicationSparseSide<std::uint8_t>;
+template class SparseMatrixMultiplicationSparseSide<std::uint16_t>;
+template class SparseMatrixMultiplicationSparseSide<std::uint32_t>;
+template class SparseMatrixMultiplicationSparseSide<std::uint64_t>;
+template class SparseMatrixMultiplicationSparseSide<__uint128_t>;
+
+template class SparseMatrixMultiplicationDenseSide<std::uint8_t>;
+template class SparseMatrixMultiplicationDenseSide<std::uint16_t>;
+template class SparseMatrixMultiplicationDenseSide<std::uint32_t>;
+template class SparseMatrixMultiplicationDenseSide<std::uint64_t>;
+template class SparseMatrixMultiplicationDenseSide<__uint128_t>;
+
 template std::unique_ptr<BitIntegerMultiplicationIntSide<std::uint8_t>>
     ArithmeticProvider::register_bit_integer_multiplication_int_side<std::uint8_t>(std::size_t,
                                                                                    std::size_t);
@@ -798,56 +1272,98 @@ template std::unique_ptr<IntegerMultiplicationReceiver<__uint128_t>>
 
 template std::unique_ptr<MatrixMultiplicationRHS<std::uint8_t>>
     ArithmeticProvider::register_matrix_multiplication_rhs<std::uint8_t>(std::size_t, std::size_t,
-                                                                         std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationRHS<std::uint16_t>>
     ArithmeticProvider::register_matrix_multiplication_rhs<std::uint16_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationRHS<std::uint32_t>>
     ArithmeticProvider::register_matrix_multiplication_rhs<std::uint32_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationRHS<std::uint64_t>>
     ArithmeticProvider::register_matrix_multiplication_rhs<std::uint64_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationRHS<__uint128_t>>
     ArithmeticProvider::register_matrix_multiplication_rhs<__uint128_t>(std::size_t, std::size_t,
-                                                                        std::size_t);
+                                                                        std::size_t, std::size_t);
 
 template std::unique_ptr<MatrixMultiplicationLHS<std::uint8_t>>
     ArithmeticProvider::register_matrix_multiplication_lhs<std::uint8_t>(std::size_t, std::size_t,
-                                                                         std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationLHS<std::uint16_t>>
     ArithmeticProvider::register_matrix_multiplication_lhs<std::uint16_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationLHS<std::uint32_t>>
     ArithmeticProvider::register_matrix_multiplication_lhs<std::uint32_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationLHS<std::uint64_t>>
     ArithmeticProvider::register_matrix_multiplication_lhs<std::uint64_t>(std::size_t, std::size_t,
-                                                                          std::size_t);
+                                                                        std::size_t, std::size_t);
 template std::unique_ptr<MatrixMultiplicationLHS<__uint128_t>>
     ArithmeticProvider::register_matrix_multiplication_lhs<__uint128_t>(std::size_t, std::size_t,
-                                                                        std::size_t);
+                                                                        std::size_t, std::size_t);
 
 template std::unique_ptr<ConvolutionInputSide<std::uint8_t>>
-    ArithmeticProvider::register_convolution_input_side<std::uint8_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_input_side<std::uint8_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionInputSide<std::uint16_t>>
-    ArithmeticProvider::register_convolution_input_side<std::uint16_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_input_side<std::uint16_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionInputSide<std::uint32_t>>
-    ArithmeticProvider::register_convolution_input_side<std::uint32_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_input_side<std::uint32_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionInputSide<std::uint64_t>>
-    ArithmeticProvider::register_convolution_input_side<std::uint64_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_input_side<std::uint64_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionInputSide<__uint128_t>>
-    ArithmeticProvider::register_convolution_input_side<__uint128_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_input_side<__uint128_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 
 template std::unique_ptr<ConvolutionKernelSide<std::uint8_t>>
-    ArithmeticProvider::register_convolution_kernel_side<std::uint8_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_kernel_side<std::uint8_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionKernelSide<std::uint16_t>>
-    ArithmeticProvider::register_convolution_kernel_side<std::uint16_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_kernel_side<std::uint16_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionKernelSide<std::uint32_t>>
-    ArithmeticProvider::register_convolution_kernel_side<std::uint32_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_kernel_side<std::uint32_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionKernelSide<std::uint64_t>>
-    ArithmeticProvider::register_convolution_kernel_side<std::uint64_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_kernel_side<std::uint64_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
 template std::unique_ptr<ConvolutionKernelSide<__uint128_t>>
-    ArithmeticProvider::register_convolution_kernel_side<__uint128_t>(tensor::Conv2DOp);
+    ArithmeticProvider::register_convolution_kernel_side<__uint128_t>(tensor::Conv2DOp,
+                                                                       std::size_t);
+
+template std::unique_ptr<SparseMatrixMultiplicationSparseSide<std::uint8_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side<std::uint8_t>(
+        std::size_t, const CSRMatrix<std::uint8_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationSparseSide<std::uint16_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side<std::uint16_t>(
+        std::size_t, const CSRMatrix<std::uint16_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationSparseSide<std::uint32_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side<std::uint32_t>(
+        std::size_t, const CSRMatrix<std::uint32_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationSparseSide<std::uint64_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side<std::uint64_t>(
+        std::size_t, const CSRMatrix<std::uint64_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationSparseSide<__uint128_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_sparse_side<__uint128_t>(
+        std::size_t, const CSRMatrix<__uint128_t>&);
+
+template std::unique_ptr<SparseMatrixMultiplicationDenseSide<std::uint8_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_dense_side<std::uint8_t>(
+        std::size_t, const CSRMatrix<std::uint8_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationDenseSide<std::uint16_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_dense_side<std::uint16_t>(
+        std::size_t, const CSRMatrix<std::uint16_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationDenseSide<std::uint32_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_dense_side<std::uint32_t>(
+        std::size_t, const CSRMatrix<std::uint32_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationDenseSide<std::uint64_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_dense_side<std::uint64_t>(
+        std::size_t, const CSRMatrix<std::uint64_t>&);
+template std::unique_ptr<SparseMatrixMultiplicationDenseSide<__uint128_t>>
+    ArithmeticProvider::register_sparse_matrix_multiplication_dense_side<__uint128_t>(
+        std::size_t, const CSRMatrix<__uint128_t>&);
 
 }  // namespace MOTION
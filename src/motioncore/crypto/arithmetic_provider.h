@@ -23,11 +23,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <vector>
 
 #include "oblivious_transfer/ot_provider.h"
 #include "tensor/tensor_op.h"
+#include "utility/linear_algebra.h"
 #include "utility/reusable_future.h"
 #include "utility/type_traits.hpp"
 
@@ -49,6 +51,25 @@ class CommunicationLayer;
 class ArithmeticProvider;
 class Logger;
 
+// SIMD kernels which sum up the ACOT outputs of the bits of an integer multiplication
+enum class IntegerMultiplicationKernel : unsigned int { automatic, scalar, avx2, avx512 };
+
+bool is_integer_multiplication_kernel_supported(IntegerMultiplicationKernel kernel);
+// the fastest kernel supported by the CPU
+IntegerMultiplicationKernel get_best_integer_multiplication_kernel();
+std::string to_string(IntegerMultiplicationKernel kernel);
+
+namespace detail {
+
+// outputs[i * vector_size + k] = sum_j ot_outputs[(i * bit_size + j) * vector_size + k] for the
+// bit_size bits j of T, negated if `negate` is set
+template <typename T>
+void sum_bit_products(const T* ot_outputs, T* outputs, std::size_t batch_size,
+                      std::size_t vector_size, bool negate,
+                      IntegerMultiplicationKernel kernel = IntegerMultiplicationKernel::automatic);
+
+}  // namespace detail
+
 template <typename T>
 class BitIntegerMultiplicationIntSide {
  public:
@@ -137,7 +158,10 @@ class IntegerMultiplicationReceiver {
 template <typename T>
 class MatrixMultiplicationRHS {
  public:
-  MatrixMultiplicationRHS(std::size_t l, std::size_t m, std::size_t n, ArithmeticProvider&);
+  // a batch of num_matrices independent products of l x m and m x n matrices whose inputs and
+  // outputs are stored one after another
+  MatrixMultiplicationRHS(std::size_t l, std::size_t m, std::size_t n, ArithmeticProvider&,
+                          std::size_t num_matrices = 1);
   ~MatrixMultiplicationRHS();
   void set_input(std::vector<T>&& inputs);
   void set_input(const std::vector<T>& inputs);
@@ -149,6 +173,7 @@ class MatrixMultiplicationRHS {
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
   std::array<std::size_t, 3> dims_;
+  std::size_t num_matrices_;
   std::vector<T> output_;
   std::unique_ptr<IntegerMultiplicationSender<T>> mult_sender_;
   bool is_output_ready_;
@@ -157,7 +182,10 @@ class MatrixMultiplicationRHS {
 template <typename T>
 class MatrixMultiplicationLHS {
  public:
-  MatrixMultiplicationLHS(std::size_t l, std::size_t m, std::size_t n, ArithmeticProvider&);
+  // a batch of num_matrices independent products of l x m and m x n matrices whose inputs and
+  // outputs are stored one after another
+  MatrixMultiplicationLHS(std::size_t l, std::size_t m, std::size_t n, ArithmeticProvider&,
+                          std::size_t num_matrices = 1);
   ~MatrixMultiplicationLHS();
   void set_input(std::vector<T>&& inputs);
   void set_input(const std::vector<T>& inputs);
@@ -169,6 +197,7 @@ class MatrixMultiplicationLHS {
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
   std::array<std::size_t, 3> dims_;
+  std::size_t num_matrices_;
   std::vector<T> output_;
   std::unique_ptr<IntegerMultiplicationReceiver<T>> mult_receiver_;
   std::shared_ptr<Logger> logger_;
@@ -178,7 +207,9 @@ class MatrixMultiplicationLHS {
 template <typename T>
 class ConvolutionInputSide {
  public:
-  ConvolutionInputSide(tensor::Conv2DOp, ArithmeticProvider&);
+  // a batch of num_convs independent convolutions whose inputs and outputs are stored one after
+  // another
+  ConvolutionInputSide(tensor::Conv2DOp, ArithmeticProvider&, std::size_t num_convs = 1);
   ~ConvolutionInputSide();
   void set_input(std::vector<T>&& inputs);
   void set_input(const std::vector<T>& inputs);
@@ -190,6 +221,7 @@ class ConvolutionInputSide {
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
   const tensor::Conv2DOp conv_op_;
+  const std::size_t num_convs_;
   std::vector<T> output_;
   std::unique_ptr<MatrixMultiplicationRHS<T>> matrix_rhs_;
   bool is_output_ready_;
@@ -198,7 +230,8 @@ class ConvolutionInputSide {
 template <typename T>
 class ConvolutionKernelSide {
  public:
-  ConvolutionKernelSide(tensor::Conv2DOp conv_op, ArithmeticProvider&);
+  // see ConvolutionInputSide
+  ConvolutionKernelSide(tensor::Conv2DOp conv_op, ArithmeticProvider&, std::size_t num_convs = 1);
   ~ConvolutionKernelSide();
   void set_input(std::vector<T>&& inputs);
   void set_input(const std::vector<T>& inputs);
@@ -210,12 +243,61 @@ class ConvolutionKernelSide {
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
   const tensor::Conv2DOp conv_op_;
+  const std::size_t num_convs_;
   std::vector<T> output_;
   std::unique_ptr<MatrixMultiplicationLHS<T>> matrix_lhs_;
   std::shared_ptr<Logger> logger_;
   bool is_output_ready_;
 };
 
+template <typename T>
+class SparseMatrixMultiplicationSparseSide {
+ public:
+  // product of a dense l x m matrix of the other party with a sparse m x n matrix of this party
+  // whose sparsity pattern is known to both parties, i.e., only the nonzero entries are
+  // multiplied and the values of the pattern are ignored
+  SparseMatrixMultiplicationSparseSide(std::size_t l, const CSRMatrix<T>& pattern,
+                                       ArithmeticProvider&);
+  ~SparseMatrixMultiplicationSparseSide();
+  // the nonzero entries in the order of the pattern
+  void set_input(std::vector<T>&& values);
+  void set_input(const std::vector<T>& values);
+  void set_input(const T* values);
+  void compute_output();
+  std::vector<T> get_output();
+  void clear() noexcept;
+
+ private:
+  using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
+  std::size_t dim_l_;
+  CSRMatrix<T> pattern_;
+  std::vector<T> output_;
+  std::unique_ptr<IntegerMultiplicationReceiver<T>> mult_receiver_;
+  bool is_output_ready_;
+};
+
+template <typename T>
+class SparseMatrixMultiplicationDenseSide {
+ public:
+  // see SparseMatrixMultiplicationSparseSide
+  SparseMatrixMultiplicationDenseSide(std::size_t l, const CSRMatrix<T>& pattern,
+                                      ArithmeticProvider&);
+  ~SparseMatrixMultiplicationDenseSide();
+  void set_input(const std::vector<T>& inputs);
+  void set_input(const T* inputs);
+  void compute_output();
+  std::vector<T> get_output();
+  void clear() noexcept;
+
+ private:
+  using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
+  std::size_t dim_l_;
+  CSRMatrix<T> pattern_;
+  std::vector<T> output_;
+  std::unique_ptr<IntegerMultiplicationSender<T>> mult_sender_;
+  bool is_output_ready_;
+};
+
 class ArithmeticProvider {
  public:
   ArithmeticProvider(ENCRYPTO::ObliviousTransfer::OTProvider&, std::shared_ptr<Logger>);
@@ -244,19 +326,28 @@ class ArithmeticProvider {
     return register_integer_multiplication_receive<T>(batch_size, 1);
   }
 
+  // the batched variants share one OT batch among num_matrices or num_convs operations
+  template <typename T>
+  std::unique_ptr<MatrixMultiplicationRHS<T>> register_matrix_multiplication_rhs(
+      std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, std::size_t num_matrices = 1);
+  template <typename T>
+  std::unique_ptr<MatrixMultiplicationLHS<T>> register_matrix_multiplication_lhs(
+      std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, std::size_t num_matrices = 1);
+
+  // the OTs only cover the nonzero entries of the sparse matrix
   template <typename T>
-  std::unique_ptr<MatrixMultiplicationRHS<T>> register_matrix_multiplication_rhs(std::size_t dim_l,
-                                                                                 std::size_t dim_m,
-                                                                                 std::size_t dim_n);
+  std::unique_ptr<SparseMatrixMultiplicationSparseSide<T>>
+  register_sparse_matrix_multiplication_sparse_side(std::size_t dim_l, const CSRMatrix<T>& pattern);
   template <typename T>
-  std::unique_ptr<MatrixMultiplicationLHS<T>> register_matrix_multiplication_lhs(std::size_t dim_l,
-                                                                                 std::size_t dim_m,
-                                                                                 std::size_t dim_n);
+  std::unique_ptr<SparseMatrixMultiplicationDenseSide<T>>
+  register_sparse_matrix_multiplication_dense_side(std::size_t dim_l, const CSRMatrix<T>& pattern);
 
   template <typename T>
-  std::unique_ptr<ConvolutionInputSide<T>> register_convolution_input_side(tensor::Conv2DOp);
+  std::unique_ptr<ConvolutionInputSide<T>> register_convolution_input_side(
+      tensor::Conv2DOp, std::size_t num_convs = 1);
   template <typename T>
-  std::unique_ptr<ConvolutionKernelSide<T>> register_convolution_kernel_side(tensor::Conv2DOp);
+  std::unique_ptr<ConvolutionKernelSide<T>> register_convolution_kernel_side(
+      tensor::Conv2DOp, std::size_t num_convs = 1);
 
  private:
   ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider_;
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "base_ot_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace MOTION {
+
+namespace {
+
+constexpr std::array<char, 8> base_ot_cache_magic = {'M', 'O', 'T', 'N', 'B', 'O', 'T', '1'};
+constexpr std::size_t num_choice_bytes = kappa / 8;
+constexpr std::size_t entry_size = base_ot_cache_magic.size() + 2 * sizeof(std::uint64_t) +
+                                   std::tuple_size_v<BaseOTCache::id_t> + num_choice_bytes +
+                                   3 * sizeof(base_ot_msgs_t);
+
+void append_word(std::vector<std::byte>& buffer, std::uint64_t word) {
+  const auto* bytes = reinterpret_cast<const std::byte*>(&word);
+  buffer.insert(std::end(buffer), bytes, bytes + sizeof(word));
+}
+
+std::uint64_t load_word(const std::byte* position) {
+  std::uint64_t word;
+  std::memcpy(&word, position, sizeof(word));
+  return word;
+}
+
+void append_msgs(std::vector<std::byte>& buffer, const base_ot_msgs_t& msgs) {
+  for (const auto& msg : msgs) {
+    buffer.insert(std::end(buffer), std::begin(msg), std::end(msg));
+  }
+}
+
+const std::byte* load_msgs(const std::byte* position, base_ot_msgs_t& msgs) {
+  for (auto& msg : msgs) {
+    std::copy(position, position + msg.size(), std::begin(msg));
+    position += msg.size();
+  }
+  return position;
+}
+
+}  // namespace
+
+BaseOTCache::BaseOTCache(std::string directory, std::string peer_name)
+    : directory_(std::move(directory)), peer_name_(std::move(peer_name)) {}
+
+std::string BaseOTCache::get_path(std::size_t my_id, std::size_t peer_id) const {
+  return fmt::format("{}/base_ots_{}_{}_{}.bin", directory_, peer_name_, my_id, peer_id);
+}
+
+std::optional<BaseOTCache::Entry> BaseOTCache::load(std::size_t my_id,
+                                                    std::size_t peer_id) const {
+  std::ifstream file(get_path(my_id, peer_id), std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+  std::vector<std::byte> buffer(entry_size);
+  file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+  // a truncated or foreign file is treated like a missing one, the base OTs are just recomputed
+  if (file.gcount() != static_cast<std::streamsize>(entry_size) ||
+      file.peek() != std::ifstream::traits_type::eof() ||
+      std::memcmp(buffer.data(), base_ot_cache_magic.data(), base_ot_cache_magic.size()) != 0) {
+    return std::nullopt;
+  }
+  const std::byte* position = buffer.data() + base_ot_cache_magic.size();
+  if (load_word(position) != my_id || load_word(position + sizeof(std::uint64_t)) != peer_id) {
+    return std::nullopt;
+  }
+  position += 2 * sizeof(std::uint64_t);
+
+  Entry entry;
+  std::copy(position, position + entry.id_.size(), std::begin(entry.id_));
+  position += entry.id_.size();
+  entry.receiver_msgs_.c_ = ENCRYPTO::BitVector<>(position, kappa);
+  position += num_choice_bytes;
+  position = load_msgs(position, entry.receiver_msgs_.messages_c_);
+  position = load_msgs(position, entry.sender_msgs_.messages_0_);
+  load_msgs(position, entry.sender_msgs_.messages_1_);
+  return entry;
+}
+
+void BaseOTCache::store(std::size_t my_id, std::size_t peer_id, const Entry& entry) const {
+  std::vector<std::byte> buffer;
+  buffer.reserve(entry_size);
+  buffer.resize(base_ot_cache_magic.size());
+  std::memcpy(buffer.data(), base_ot_cache_magic.data(), base_ot_cache_magic.size());
+  append_word(buffer, my_id);
+  append_word(buffer, peer_id);
+  buffer.insert(std::end(buffer), std::begin(entry.id_), std::end(entry.id_));
+  const auto& choices = entry.receiver_msgs_.c_.GetData();
+  if (entry.receiver_msgs_.c_.GetSize() != kappa || choices.size() != num_choice_bytes) {
+    throw std::invalid_argument("BaseOTCache: expected kappa choice bits");
+  }
+  buffer.insert(std::end(buffer), std::begin(choices), std::end(choices));
+  append_msgs(buffer, entry.receiver_msgs_.messages_c_);
+  append_msgs(buffer, entry.sender_msgs_.messages_0_);
+  append_msgs(buffer, entry.sender_msgs_.messages_1_);
+
+  // write to a temporary file first s.t. a crash never leaves a partial entry behind
+  const auto path = get_path(my_id, peer_id);
+  const auto tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error(fmt::format("BaseOTCache: could not open {} for writing", tmp_path));
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    if (!file) {
+      throw std::runtime_error(fmt::format("BaseOTCache: could not write {}", tmp_path));
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error(fmt::format("BaseOTCache: could not rename {} to {}", tmp_path, path));
+  }
+}
+
+}  // namespace MOTION
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "base_ot_provider.h"
+
+namespace MOTION {
+
+// On-disk cache of the base OTs with one party.
+//
+// An entry holds the base OTs in both directions together with an identifier that both parties
+// agreed on when the base OTs were computed.  Since the OT extension derives all of its state from
+// the base OT keys and fresh randomness, this is all that needs to persist across processes.  The
+// BaseOTProvider only uses an entry if the peer presents the same identifier and re-randomizes
+// the keys with a fresh joint nonce, so that no two sessions extend from the same keys.
+class BaseOTCache {
+ public:
+  using id_t = std::array<std::byte, 16>;
+
+  struct Entry {
+    id_t id_;
+    ReceiverMsgs receiver_msgs_;
+    SenderMsgs sender_msgs_;
+  };
+
+  // The entries are stored as files in `directory`; `peer_name` identifies the other party across
+  // restarts (e.g., its host and port) since the party ids are only meaningful within a session.
+  BaseOTCache(std::string directory, std::string peer_name);
+
+  // return the entry for the base OTs between the parties or std::nullopt if there is none or it
+  // cannot be read
+  std::optional<Entry> load(std::size_t my_id, std::size_t peer_id) const;
+  // (over)write the entry for the base OTs between the parties
+  void store(std::size_t my_id, std::size_t peer_id, const Entry& entry) const;
+
+  std::string get_path(std::size_t my_id, std::size_t peer_id) const;
+
+ private:
+  std::string directory_;
+  std::string peer_name_;
+};
+
+}  // namespace MOTION
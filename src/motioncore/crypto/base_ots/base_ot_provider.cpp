@@ -25,19 +25,23 @@
 #include "base/configuration.h"
 #include "base/register.h"
 #include "base_ot_provider.h"
+#include "base_ot_cache.h"
+#include "communication/base_ot_message.h"
 #include "communication/communication_layer.h"
 #include "communication/fbs_headers/base_ot_generated.h"
 #include "communication/fbs_headers/message_generated.h"
 #include "communication/message_handler.h"
 #include "crypto/base_ots/ot_hl17.h"
+#include "crypto/blake2b.h"
 #include "data_storage/base_ot_data.h"
 #include "statistics/run_time_stats.h"
 #include "utility/fiber_condition.h"
 #include "utility/logger.h"
+#include "utility/random.h"
 
 namespace MOTION {
 
-// Handler for messages of type BaseROTMessageSender, BaseROTMessageReceiver
+// Handler for messages of type BaseROTMessageSender, BaseROTMessageReceiver, BaseOTCacheCheck
 class BaseOTMessageHandler : public Communication::MessageHandler {
  public:
   // Create a handler object for a given party
@@ -61,15 +65,26 @@ void BaseOTMessageHandler::received_message(std::size_t, std::vector<std::uint8_
   auto message = Communication::GetMessage(raw_message.data());
   auto base_ot_message = Communication::GetBaseROTMessage(message->payload()->data());
   auto base_ot_id = base_ot_message->base_ot_id();
-  if (message->message_type() == Communication::MessageType::BaseROTMessageReceiver) {
-    base_ots_data_.MessageReceived(base_ot_message->buffer()->data(), BaseOTsDataType::HL17_R,
-                                   base_ot_id);
+  BaseOTsDataType type;
+  if (message->message_type() == Communication::MessageType::BaseOTCacheCheck) {
+    if (base_ot_message->buffer()->size() != base_ots_data_.cache_check_.size()) {
+      throw std::runtime_error("BaseOTMessageHandler: received cache check of wrong size");
+    }
+    base_ots_data_.MessageReceived(base_ot_message->buffer()->data(), BaseOTsDataType::cache_check);
+    return;
+  } else if (message->message_type() == Communication::MessageType::BaseROTMessageReceiver) {
+    type = BaseOTsDataType::HL17_R;
   } else if (message->message_type() == Communication::MessageType::BaseROTMessageSender) {
-    base_ots_data_.MessageReceived(base_ot_message->buffer()->data(), BaseOTsDataType::HL17_S,
-                                   base_ot_id);
+    type = BaseOTsDataType::HL17_S;
   } else {
     throw std::logic_error("BaseOTMessageHandler registered for wrong MessageType");
   }
+  // a message contains the curve points of one or more consecutive base OTs
+  constexpr std::size_t point_size = 32;
+  const auto buffer = base_ot_message->buffer();
+  for (std::size_t offset = 0; offset < buffer->size(); offset += point_size, ++base_ot_id) {
+    base_ots_data_.MessageReceived(buffer->data() + offset, type, base_ot_id);
+  }
 }
 
 // Implementation of BaseOTProvider: -------------------------------------------
@@ -89,13 +104,15 @@ BaseOTProvider::BaseOTProvider(Communication::CommunicationLayer &communication_
         return std::make_shared<BaseOTMessageHandler>(party_id, logger, data_.at(party_id));
       },
       {Communication::MessageType::BaseROTMessageSender,
-       Communication::MessageType::BaseROTMessageReceiver});
+       Communication::MessageType::BaseROTMessageReceiver,
+       Communication::MessageType::BaseOTCacheCheck});
 }
 
 BaseOTProvider::~BaseOTProvider() {
   communication_layer_.deregister_message_handler(
       {Communication::MessageType::BaseROTMessageSender,
-       Communication::MessageType::BaseROTMessageReceiver});
+       Communication::MessageType::BaseROTMessageReceiver,
+       Communication::MessageType::BaseOTCacheCheck});
 }
 
 void BaseOTProvider::ComputeBaseOTs() {
@@ -110,54 +127,29 @@ void BaseOTProvider::ComputeBaseOTs() {
   }
 
   std::vector<std::future<void>> task_futures;
-  std::vector<std::unique_ptr<OT_HL17>> base_ots;
-
   task_futures.reserve(2 * (num_parties_ - 1));
-  base_ots.reserve(num_parties_);
 
   for (auto i = 0ull; i < num_parties_; ++i) {
     if (i == my_id_) {
-      base_ots.emplace_back(nullptr);
       continue;
     }
-
-    auto send_function = [this, i](flatbuffers::FlatBufferBuilder &&message) {
-      communication_layer_.send_message(i, std::move(message));
-    };
-
     auto &base_ots_data = data_.at(i);
-    base_ots.emplace_back(std::make_unique<OT_HL17>(send_function, base_ots_data));
-
-    if (!base_ots_data.GetReceiverData().is_ready_) {
-      task_futures.emplace_back(std::async(std::launch::async, [this, &base_ots, i] {
-        auto choices = ENCRYPTO::BitVector<>::Random(128);
-        auto chosen_messages = base_ots[i]->recv(choices);  // sender base ots
-        auto &receiver_data = data_[i].GetReceiverData();
-        receiver_data.c_ = std::move(choices);
-        for (std::size_t i = 0; i < chosen_messages.size(); ++i) {
-          auto b = receiver_data.messages_c_.at(i).begin();
-          std::copy(chosen_messages.at(i).begin(), chosen_messages.at(i).begin() + 16, b);
-        }
-        std::scoped_lock lock(receiver_data.is_ready_condition_->GetMutex());
-        receiver_data.is_ready_ = true;
-      }));
-    }
+    const bool receiver_ready = base_ots_data.GetReceiverData().is_ready_;
+    const bool sender_ready = base_ots_data.GetSenderData().is_ready_;
 
-    if (!base_ots_data.GetSenderData().is_ready_) {
-      task_futures.emplace_back(std::async(std::launch::async, [this, &base_ots, i] {
-        auto both_messages = base_ots[i]->send(128);  // receiver base ots
-        auto &sender_data = data_[i].GetSenderData();
-        for (std::size_t i = 0; i < both_messages.size(); ++i) {
-          auto b = sender_data.messages_0_.at(i).begin();
-          std::copy(both_messages.at(i).first.begin(), both_messages.at(i).first.begin() + 16, b);
-        }
-        for (std::size_t i = 0; i < both_messages.size(); ++i) {
-          auto b = sender_data.messages_1_.at(i).begin();
-          std::copy(both_messages.at(i).second.begin(), both_messages.at(i).second.begin() + 16, b);
-        }
-        std::scoped_lock lock(sender_data.is_ready_condition_->GetMutex());
-        sender_data.is_ready_ = true;
-      }));
+    // the cache only holds base OTs in both directions
+    if (cache_ && !receiver_ready && !sender_ready) {
+      task_futures.emplace_back(
+          std::async(std::launch::async, [this, i] { ComputeCachedBaseOTs(i); }));
+      continue;
+    }
+    if (!receiver_ready) {
+      task_futures.emplace_back(
+          std::async(std::launch::async, [this, i] { ComputeReceiverBaseOTs(i); }));
+    }
+    if (!sender_ready) {
+      task_futures.emplace_back(
+          std::async(std::launch::async, [this, i] { ComputeSenderBaseOTs(i); }));
     }
   }
 
@@ -176,6 +168,124 @@ void BaseOTProvider::ComputeBaseOTs() {
   }
 }
 
+void BaseOTProvider::ComputeReceiverBaseOTs(std::size_t party_id) {
+  auto send_function = [this, party_id](flatbuffers::FlatBufferBuilder &&message) {
+    communication_layer_.send_message(party_id, std::move(message));
+  };
+  OT_HL17 base_ots(send_function, data_.at(party_id));
+  auto choices = ENCRYPTO::BitVector<>::Random(128);
+  auto chosen_messages = base_ots.recv(choices);  // sender base ots
+  auto &receiver_data = data_.at(party_id).GetReceiverData();
+  receiver_data.c_ = std::move(choices);
+  for (std::size_t i = 0; i < chosen_messages.size(); ++i) {
+    auto b = receiver_data.messages_c_.at(i).begin();
+    std::copy(chosen_messages.at(i).begin(), chosen_messages.at(i).begin() + 16, b);
+  }
+  std::scoped_lock lock(receiver_data.is_ready_condition_->GetMutex());
+  receiver_data.is_ready_ = true;
+}
+
+void BaseOTProvider::ComputeSenderBaseOTs(std::size_t party_id) {
+  auto send_function = [this, party_id](flatbuffers::FlatBufferBuilder &&message) {
+    communication_layer_.send_message(party_id, std::move(message));
+  };
+  OT_HL17 base_ots(send_function, data_.at(party_id));
+  auto both_messages = base_ots.send(128);  // receiver base ots
+  auto &sender_data = data_.at(party_id).GetSenderData();
+  for (std::size_t i = 0; i < both_messages.size(); ++i) {
+    auto b = sender_data.messages_0_.at(i).begin();
+    std::copy(both_messages.at(i).first.begin(), both_messages.at(i).first.begin() + 16, b);
+  }
+  for (std::size_t i = 0; i < both_messages.size(); ++i) {
+    auto b = sender_data.messages_1_.at(i).begin();
+    std::copy(both_messages.at(i).second.begin(), both_messages.at(i).second.begin() + 16, b);
+  }
+  std::scoped_lock lock(sender_data.is_ready_condition_->GetMutex());
+  sender_data.is_ready_ = true;
+}
+
+namespace {
+
+// k' = Blake2b(k || session_nonce) truncated to 128 bit
+void rerandomize(base_ot_msgs_t &msgs, const BaseOTCache::id_t &session_nonce) {
+  constexpr std::size_t msg_size = std::tuple_size_v<base_ot_msgs_t::value_type>;
+  constexpr std::size_t hash_input_size = msg_size + std::tuple_size_v<BaseOTCache::id_t>;
+  std::vector<std::uint8_t> hash_inputs(msgs.size() * hash_input_size);
+  for (std::size_t i = 0; i < msgs.size(); ++i) {
+    auto *hash_input = hash_inputs.data() + i * hash_input_size;
+    std::copy_n(reinterpret_cast<const std::uint8_t *>(msgs[i].data()), msg_size, hash_input);
+    std::copy_n(reinterpret_cast<const std::uint8_t *>(session_nonce.data()), session_nonce.size(),
+                hash_input + msg_size);
+  }
+  Blake2bBatch(hash_inputs.data(), hash_input_size, msgs.size(),
+               reinterpret_cast<std::uint8_t *>(msgs.data()->data()), msg_size);
+}
+
+}  // namespace
+
+void BaseOTProvider::ComputeCachedBaseOTs(std::size_t party_id) {
+  const auto entry = cache_->load(my_id_, party_id);
+
+  // send the identifier of our cache entry (zero if we have none) and a fresh nonce
+  constexpr std::size_t id_size = std::tuple_size_v<BaseOTCache::id_t>;
+  std::array<std::byte, 2 * id_size> check;
+  if (entry.has_value()) {
+    std::copy(std::begin(entry->id_), std::end(entry->id_), std::begin(check));
+  } else {
+    std::fill_n(std::begin(check), id_size, std::byte(0));
+  }
+  const auto nonce = RandomVector(id_size);
+  std::transform(std::begin(nonce), std::end(nonce), std::begin(check) + id_size,
+                 [](auto b) { return std::byte(b); });
+  communication_layer_.send_message(party_id,
+                                    Communication::BuildBaseOTCacheCheckMessage(check.data(),
+                                                                                check.size()));
+
+  auto &base_ots_data = data_.at(party_id);
+  base_ots_data.cache_check_condition_->Wait();
+  const auto &peer_check = base_ots_data.cache_check_;
+
+  // both parties contributed to the nonce, so it is fresh as long as one of them is honest
+  BaseOTCache::id_t session_nonce;
+  for (std::size_t j = 0; j < id_size; ++j) {
+    session_nonce[j] = check[id_size + j] ^ peer_check[id_size + j];
+  }
+
+  const bool hit = entry.has_value() &&
+                   std::any_of(std::begin(entry->id_), std::end(entry->id_),
+                               [](auto b) { return b != std::byte(0); }) &&
+                   std::equal(std::begin(entry->id_), std::end(entry->id_), std::begin(peer_check));
+  if (hit) {
+    if constexpr (MOTION_DEBUG) {
+      if (logger_) {
+        logger_->LogDebug(fmt::format("Using cached base OTs with Party#{}", party_id));
+      }
+    }
+    // the OT extension only ever sees the re-randomized keys, so it may start from offset 0
+    auto receiver_msgs = entry->receiver_msgs_;
+    auto sender_msgs = entry->sender_msgs_;
+    rerandomize(receiver_msgs.messages_c_, session_nonce);
+    rerandomize(sender_msgs.messages_0_, session_nonce);
+    rerandomize(sender_msgs.messages_1_, session_nonce);
+    ImportBaseOTs(party_id, receiver_msgs);
+    ImportBaseOTs(party_id, sender_msgs);
+    return;
+  }
+
+  // both tasks need to run concurrently since the party runs them in the opposite roles
+  auto sender_future =
+      std::async(std::launch::async, [this, party_id] { ComputeSenderBaseOTs(party_id); });
+  ComputeReceiverBaseOTs(party_id);
+  sender_future.get();
+
+  // the keys are stored as computed and are re-randomized on every use of the entry, which is
+  // identified by the nonce of this session
+  BaseOTCache::Entry new_entry;
+  new_entry.id_ = session_nonce;
+  std::tie(new_entry.receiver_msgs_, new_entry.sender_msgs_) = ExportBaseOTs(party_id);
+  cache_->store(my_id_, party_id, new_entry);
+}
+
 void BaseOTProvider::ImportBaseOTs(std::size_t party_id, const ReceiverMsgs &msgs) {
   auto &rcv_data = data_.at(party_id).GetReceiverData();
   if (rcv_data.is_ready_)
@@ -26,6 +26,7 @@
 
 #include <array>
 #include <cstddef>
+#include <memory>
 
 #include "data_storage/base_ot_data.h"
 #include "utility/bit_vector.h"
@@ -42,6 +43,7 @@ namespace Statistics {
 struct RunTimeStats;
 }
 
+class BaseOTCache;
 class Configuration;
 class Logger;
 class Register;
@@ -67,6 +69,9 @@ class BaseOTProvider : public ENCRYPTO::enable_wait_setup {
   void ImportBaseOTs(std::size_t party_id, const ReceiverMsgs& msgs);
   void ImportBaseOTs(std::size_t party_id, const SenderMsgs& msgs);
   std::pair<ReceiverMsgs, SenderMsgs> ExportBaseOTs(std::size_t party_id);
+  // load the base OTs from and store them in the cache, needs to be set by both parties before
+  // calling ComputeBaseOTs()
+  void set_cache(std::shared_ptr<BaseOTCache> cache) { cache_ = std::move(cache); }
   BaseOTsData& get_base_ots_data(std::size_t party_id) { return data_.at(party_id); }
   const BaseOTsData& get_base_ots_data(std::size_t party_id) const { return data_.at(party_id); }
 
@@ -78,8 +83,14 @@ class BaseOTProvider : public ENCRYPTO::enable_wait_setup {
   Statistics::RunTimeStats* stats_;
   std::shared_ptr<Logger> logger_;
   bool finished_;
+  std::shared_ptr<BaseOTCache> cache_;
 
   Logger& GetLogger();
+  void ComputeReceiverBaseOTs(std::size_t party_id);
+  void ComputeSenderBaseOTs(std::size_t party_id);
+  // agree with the party on using the cached base OTs and import them re-randomized if possible,
+  // otherwise compute new base OTs and store them in the cache
+  void ComputeCachedBaseOTs(std::size_t party_id);
 };
 
 }  // namespace MOTION
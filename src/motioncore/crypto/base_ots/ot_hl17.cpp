@@ -45,17 +45,16 @@ OT_HL17::OT_HL17(std::function<void(flatbuffers::FlatBufferBuilder&&)> send,
 //
 // * random oracle G: GG -> GG
 // * random oracle H: GG^3 -> K
-
-void hash_point(curve25519::ge_p3& output, const curve25519::ge_p3& input) {
-  std::array<uint8_t, 32> hash_input;
-  std::vector<uint8_t> hash_output(EVP_MAX_MD_SIZE);
-
-  curve25519::ge_p3_tobytes(hash_input.data(), &input);
-  Blake2b(hash_input.data(), hash_output.data(), hash_input.size());
-  hash_output.resize(32);
-
-  curve25519::x25519_sc_reduce(hash_output.data());
-  curve25519::x25519_ge_scalarmult_base(&output, hash_output.data());
+//
+// G is implemented as G(S) = g^t with t = Blake2b(S) mod p.  Both parties know the discrete
+// logarithm t, so all multiplications with T = G(S) are done with the fixed-base tables.
+
+// t = Blake2b(S) mod p, reducing the whole 512 bit digest
+void digest_to_scalar(std::uint8_t output[32], const std::uint8_t* digest) {
+  std::array<std::uint8_t, 64> wide;
+  std::copy_n(digest, wide.size(), wide.data());
+  curve25519::x25519_sc_reduce(wide.data());
+  std::copy_n(wide.data(), 32, output);
 }
 
 void OT_HL17::send_0(Sender_State& state,
@@ -66,69 +65,56 @@ void OT_HL17::send_0(Sender_State& state,
   // S = g^y
   curve25519::x25519_ge_scalarmult_base(&state.S, state.y);
 
-  std::vector<std::byte> S_bytes(curve25519_ge_byte_size);
   curve25519::ge_p3_tobytes(reinterpret_cast<std::uint8_t*>(message_out.data()), &state.S);
 }
 
-void OT_HL17::send_1(Sender_State& state) {
-  // T = G(S)
-  hash_point(state.T, state.S);
+void OT_HL17::send_1(Sender_State& state, const std::uint8_t* digest_S) {
+  // T = G(S) = g^t
+  digest_to_scalar(state.t, digest_S);
 }
 
-std::pair<std::vector<std::byte>, std::vector<std::byte>> OT_HL17::send_2(
-    Sender_State& state, const std::array<std::byte, curve25519_ge_byte_size>& message_in) {
+void OT_HL17::send_2(Sender_State& state,
+                     const std::array<std::byte, curve25519_ge_byte_size>& message_in,
+                     std::uint8_t* hash_inputs) {
   // assert R in GG
   if (!x25519_ge_frombytes_vartime(&state.R,
                                    reinterpret_cast<const std::uint8_t*>(message_in.data()))) {
     throw std::runtime_error("Base OT: R is not in G - abort");
   }
 
-  auto mdctx = NewBlakeCtx();
-
-  auto output = std::make_pair<>(std::vector<std::byte>(EVP_MAX_MD_SIZE),
-                                 std::vector<std::byte>(EVP_MAX_MD_SIZE));
-  assert(output.first.size() == EVP_MAX_MD_SIZE);
-  assert(output.second.size() == EVP_MAX_MD_SIZE);
-
-  std::array<uint8_t, 3 * curve25519_ge_byte_size> hash_input;
-  curve25519::ge_p3_tobytes(hash_input.data(), &state.S);
-  curve25519::ge_p3_tobytes(hash_input.data() + 32, &state.R);
+  // inputs of H(S, R, y*R) and H(S, R, y*R - y*T)
+  auto* hash_input_0 = hash_inputs;
+  auto* hash_input_1 = hash_inputs + hash_input_size;
+  curve25519::ge_p3_tobytes(hash_input_0, &state.S);
+  curve25519::ge_p3_tobytes(hash_input_0 + 32, &state.R);
+  std::copy_n(hash_input_0, 64, hash_input_1);
 
   // j = 0:
   // y*R
   curve25519::ge_p2 y_times_R_p2;
   curve25519::x25519_ge_scalarmult(&y_times_R_p2, state.y, &state.R);
-  curve25519::x25519_ge_tobytes(hash_input.data() + 64, &y_times_R_p2);
-
-  // H(S, R, y*R)
-  Blake2b(hash_input.data(), reinterpret_cast<uint8_t*>(output.first.data()), hash_input.size(),
-          mdctx);
+  curve25519::x25519_ge_tobytes(hash_input_0 + 64, &y_times_R_p2);
 
   // j = 1:
-  // y*R + (-y)*T = y*(R - T)
-  {
-    curve25519::ge_cached T_cached;
-    curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
+  // y*(R - T) = y*R - (y*t)*g
+  static constexpr std::uint8_t zero[32] = {};
+  std::uint8_t y_times_t[32];
+  curve25519::x25519_sc_muladd(y_times_t, state.y, state.t, zero);
 
-    curve25519::ge_p1p1 R_minus_T_p1p1;
-    curve25519::x25519_ge_sub(&R_minus_T_p1p1, &state.R, &T_cached);
+  curve25519::ge_p3 y_times_T_p3;
+  curve25519::x25519_ge_scalarmult_base(&y_times_T_p3, y_times_t);
+  curve25519::ge_cached y_times_T_cached;
+  curve25519::x25519_ge_p3_to_cached(&y_times_T_cached, &y_times_T_p3);
 
-    curve25519::ge_p3 R_minus_T_p3;
-    curve25519::x25519_ge_p1p1_to_p3(&R_minus_T_p3, &R_minus_T_p1p1);
-
-    curve25519::ge_p2 y_times_R_minus_T_p2;
-    curve25519::x25519_ge_scalarmult(&y_times_R_minus_T_p2, state.y, &R_minus_T_p3);
-    curve25519::x25519_ge_tobytes(hash_input.data() + 64, &y_times_R_minus_T_p2);
-  }
+  curve25519::ge_p3 y_times_R_p3;
+  curve25519::x25519_ge_p2_to_p3(&y_times_R_p3, &y_times_R_p2);
 
-  // H(S, R, y*R - y*T)
-  Blake2b(hash_input.data(), reinterpret_cast<uint8_t*>(output.second.data()), hash_input.size(),
-          mdctx);
+  curve25519::ge_p1p1 y_times_R_minus_T_p1p1;
+  curve25519::x25519_ge_sub(&y_times_R_minus_T_p1p1, &y_times_R_p3, &y_times_T_cached);
 
-  output.first.resize(16);
-  output.second.resize(16);
-
-  return output;
+  curve25519::ge_p2 y_times_R_minus_T_p2;
+  curve25519::x25519_ge_p1p1_to_p2(&y_times_R_minus_T_p2, &y_times_R_minus_T_p1p1);
+  curve25519::x25519_ge_tobytes(hash_input_1 + 64, &y_times_R_minus_T_p2);
 }
 
 void OT_HL17::recv_0(Receiver_State& state, bool choice) {
@@ -137,11 +123,9 @@ void OT_HL17::recv_0(Receiver_State& state, bool choice) {
   curve25519::sc_random(state.x);
 }
 
-#include "utility/helpers.h"
-
 void OT_HL17::recv_1(Receiver_State& state,
-                     std::array<std::byte, curve25519_ge_byte_size>& message_out,
-                     const std::array<std::byte, curve25519_ge_byte_size>& message_in) {
+                     const std::array<std::byte, curve25519_ge_byte_size>& message_in,
+                     std::uint8_t* S_bytes) {
   // recv S
   auto res = curve25519::x25519_ge_frombytes_vartime(
       &state.S, reinterpret_cast<const std::uint8_t*>(message_in.data()));
@@ -149,50 +133,40 @@ void OT_HL17::recv_1(Receiver_State& state,
   if (res == 0) {
     throw std::runtime_error("Base OT: S is not in G - abort");
   }
+  curve25519::ge_p3_tobytes(S_bytes, &state.S);
+}
 
-  // T = G(S)
-  hash_point(state.T, state.S);
-
-  // R = T^c * g^x
-
-  // R = g^x
-  curve25519::x25519_ge_scalarmult_base(&state.R, state.x);
+void OT_HL17::recv_2(Receiver_State& state, const std::uint8_t* digest_S,
+                     std::array<std::byte, curve25519_ge_byte_size>& message_out) {
+  // T = G(S) = g^t
+  digest_to_scalar(state.t, digest_S);
 
-  // FIXME: not constant time
-  // R = R * T
-  if (state.choice) {
-    curve25519::ge_p1p1 R_p1p1;
-    curve25519::ge_cached T_cached;
-    curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
-    curve25519::x25519_ge_add(&R_p1p1, &state.R, &T_cached);
-    curve25519::x25519_ge_p1p1_to_p3(&state.R, &R_p1p1);
-  }
+  // R = T^c * g^x = g^(c*t + x)
+  // computed with a single fixed-base multiplication, which is also constant time in c
+  std::uint8_t c[32] = {};
+  c[0] = state.choice;
+  std::uint8_t r[32];
+  curve25519::x25519_sc_muladd(r, c, state.t, state.x);
+  curve25519::x25519_ge_scalarmult_base(&state.R, r);
 
-  std::vector<std::byte> R_bytes(32);
   curve25519::ge_p3_tobytes(reinterpret_cast<std::uint8_t*>(message_out.data()), &state.R);
 }
 
-std::vector<std::byte> OT_HL17::recv_2(Receiver_State& state) {
+void OT_HL17::recv_3(Receiver_State& state, std::uint8_t* hash_input) {
   // k_R = H_(S,R)(S^x)
   //     = H_(S,R)(g^xy)
-
-  std::vector<std::byte> hash_output(EVP_MAX_MD_SIZE);
-
-  std::array<uint8_t, 3 * curve25519_ge_byte_size> hash_input;
-  curve25519::ge_p3_tobytes(hash_input.data(), &state.S);
-  curve25519::ge_p3_tobytes(hash_input.data() + curve25519_ge_byte_size, &state.R);
+  curve25519::ge_p3_tobytes(hash_input, &state.S);
+  curve25519::ge_p3_tobytes(hash_input + curve25519_ge_byte_size, &state.R);
 
   curve25519::ge_p2 S_to_the_x;
   curve25519::x25519_ge_scalarmult(&S_to_the_x, state.x, &state.S);
-  curve25519::x25519_ge_tobytes(hash_input.data() + 2 * curve25519_ge_byte_size, &S_to_the_x);
-
-  assert(hash_output.size() == EVP_MAX_MD_SIZE);
-  Blake2b(hash_input.data(), reinterpret_cast<uint8_t*>(hash_output.data()), hash_input.size());
-
-  hash_output.resize(16);
-  return hash_output;
+  curve25519::x25519_ge_tobytes(hash_input + 2 * curve25519_ge_byte_size, &S_to_the_x);
 }
 
+// The OTs are independent, so their group operations are computed in parallel and the points of
+// all OTs are sent in a single message.  The hash inputs of all OTs are collected and hashed
+// with Blake2bBatch().
+
 std::vector<std::pair<std::vector<std::byte>, std::vector<std::byte>>> OT_HL17::send(
     size_t number_ots) {
   std::vector<Sender_State> states;
@@ -205,18 +179,33 @@ std::vector<std::pair<std::vector<std::byte>, std::vector<std::byte>>> OT_HL17::
   std::vector<std::array<std::byte, curve25519_ge_byte_size>> msgs_s0(number_ots);
   std::vector<std::pair<std::vector<std::byte>, std::vector<std::byte>>> output(number_ots);
 
+#pragma omp parallel for
   for (std::size_t i = 0; i < number_ots; ++i) {
     send_0(states.at(i), msgs_s0.at(i));
   }
 
+  Send_(Communication::BuildBaseROTMessageSender(msgs_s0.data()->data(),
+                                                 number_ots * curve25519_ge_byte_size, 0));
+
+  // the messages are the encodings of the points S
+  std::vector<std::uint8_t> digests_S(number_ots * digest_size);
+  Blake2bBatch(reinterpret_cast<const std::uint8_t*>(msgs_s0.data()->data()),
+               curve25519_ge_byte_size, number_ots, digests_S.data(), digest_size);
+
+  std::vector<std::uint8_t> hash_inputs(2 * number_ots * hash_input_size);
+#pragma omp parallel for
   for (std::size_t i = 0; i < number_ots; ++i) {
-    Send_(Communication::BuildBaseROTMessageSender(msgs_s0.at(i).data(), msgs_s0.at(i).size(), i));
-    send_1(states.at(i));
+    send_1(states.at(i), digests_S.data() + i * digest_size);
+    base_ots_snd.received_R_condition_.at(i)->Wait();
+    send_2(states.at(i), base_ots_snd.R_.at(i), hash_inputs.data() + 2 * i * hash_input_size);
   }
 
+  std::vector<std::uint8_t> keys(2 * number_ots * key_size);
+  Blake2bBatch(hash_inputs.data(), hash_input_size, 2 * number_ots, keys.data(), key_size);
   for (std::size_t i = 0; i < number_ots; ++i) {
-    base_ots_snd.received_R_condition_.at(i)->Wait();
-    output.at(i) = send_2(states.at(i), base_ots_snd.R_.at(i));
+    const auto* key_0 = reinterpret_cast<const std::byte*>(keys.data() + 2 * i * key_size);
+    output.at(i).first.assign(key_0, key_0 + key_size);
+    output.at(i).second.assign(key_0 + key_size, key_0 + 2 * key_size);
   }
 
   base_ots_snd.is_ready_ = true;
@@ -236,17 +225,38 @@ std::vector<std::vector<std::byte>> OT_HL17::recv(const ENCRYPTO::BitVector<>& c
 
   for (std::size_t i = 0; i < number_ots; ++i) {
     recv_0(states.at(i), choices.Get(i));
+  }
+
+  std::vector<std::uint8_t> S_bytes(number_ots * curve25519_ge_byte_size);
+#pragma omp parallel for
+  for (std::size_t i = 0; i < number_ots; ++i) {
     base_ots_rcv.received_S_condition_.at(i)->Wait();
+    recv_1(states.at(i), base_ots_rcv.S_.at(i), S_bytes.data() + i * curve25519_ge_byte_size);
+  }
+
+  std::vector<std::uint8_t> digests_S(number_ots * digest_size);
+  Blake2bBatch(S_bytes.data(), curve25519_ge_byte_size, number_ots, digests_S.data(),
+               digest_size);
+
+#pragma omp parallel for
+  for (std::size_t i = 0; i < number_ots; ++i) {
+    recv_2(states.at(i), digests_S.data() + i * digest_size, msgs_r1.at(i));
   }
 
+  Send_(Communication::BuildBaseROTMessageReceiver(msgs_r1.data()->data(),
+                                                   number_ots * curve25519_ge_byte_size, 0));
+
+  std::vector<std::uint8_t> hash_inputs(number_ots * hash_input_size);
+#pragma omp parallel for
   for (std::size_t i = 0; i < number_ots; ++i) {
-    recv_1(states.at(i), msgs_r1.at(i), base_ots_rcv.S_.at(i));
-    Send_(
-        Communication::BuildBaseROTMessageReceiver(msgs_r1.at(i).data(), msgs_r1.at(i).size(), i));
+    recv_3(states.at(i), hash_inputs.data() + i * hash_input_size);
   }
 
+  std::vector<std::uint8_t> keys(number_ots * key_size);
+  Blake2bBatch(hash_inputs.data(), hash_input_size, number_ots, keys.data(), key_size);
   for (std::size_t i = 0; i < number_ots; ++i) {
-    output.at(i) = recv_2(states.at(i));
+    const auto* key = reinterpret_cast<const std::byte*>(keys.data() + i * key_size);
+    output.at(i).assign(key, key + key_size);
   }
 
   base_ots_rcv.is_ready_ = true;
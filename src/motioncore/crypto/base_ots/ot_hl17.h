@@ -77,8 +77,8 @@ class OT_HL17 final : public RandomOT {
     uint8_t y[32];
     // // S
     curve25519::ge_p3 S;
-    // // T
-    curve25519::ge_p3 T;
+    // // t with T = g^t
+    uint8_t t[32];
     // // R
     curve25519::ge_p3 R;
   };
@@ -93,29 +93,39 @@ class OT_HL17 final : public RandomOT {
     uint8_t x[32];
     // S
     curve25519::ge_p3 S;
-    // T
-    curve25519::ge_p3 T;
+    // t with T = g^t
+    uint8_t t[32];
     // R
     curve25519::ge_p3 R;
     // k_R
     // e_c
   };
   static constexpr size_t curve25519_ge_byte_size = 32;
+  // H and G are computed with Blake2b over the encodings of 3 points and 1 point, respectively
+  static constexpr size_t hash_input_size = 3 * curve25519_ge_byte_size;
+  static constexpr size_t digest_size = 64;
+  // size of the random OT messages
+  static constexpr size_t key_size = 16;
 
   /**
    * Parts of the sender side.
    */
   void send_0(Sender_State& state, std::array<std::byte, curve25519_ge_byte_size>& message_out);
-  void send_1(Sender_State& state);
-  std::pair<std::vector<std::byte>, std::vector<std::byte>> send_2(
-      Sender_State& state, const std::array<std::byte, curve25519_ge_byte_size>& message_in);
+  void send_1(Sender_State& state, const std::uint8_t* digest_S);
+  // writes the two inputs of H to hash_inputs
+  void send_2(Sender_State& state, const std::array<std::byte, curve25519_ge_byte_size>& message_in,
+              std::uint8_t* hash_inputs);
 
   /**
    * Parts of the receiver side.
    */
   void recv_0(Receiver_State& state, bool choice);
-  void recv_1(Receiver_State& state, std::array<std::byte, curve25519_ge_byte_size>& message_out,
-              const std::array<std::byte, curve25519_ge_byte_size>& message_in);
-  std::vector<std::byte> recv_2(Receiver_State& state);
+  // writes the encoding of S to S_bytes
+  void recv_1(Receiver_State& state, const std::array<std::byte, curve25519_ge_byte_size>& message_in,
+              std::uint8_t* S_bytes);
+  void recv_2(Receiver_State& state, const std::uint8_t* digest_S,
+              std::array<std::byte, curve25519_ge_byte_size>& message_out);
+  // writes the input of H to hash_input
+  void recv_3(Receiver_State& state, std::uint8_t* hash_input);
 };
 }
@@ -24,6 +24,15 @@
 
 #include "blake2b.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <immintrin.h>
+
+#include "utility/cpu_features.h"
+
 namespace MOTION {
 Blake2bCtx NewBlakeCtx() {
   return Blake2bCtx(EVP_MD_CTX_new(), [](EVP_MD_CTX *ctx) { EVP_MD_CTX_free(ctx); });
@@ -62,4 +71,217 @@ void Blake2b(std::uint8_t *msg, std::uint8_t digest[EVP_MAX_MD_SIZE], std::size_
              Blake2bCtx &b) {
   Blake2b(msg, digest, len, b.get());
 }
-}
\ No newline at end of file
+
+namespace {
+
+constexpr std::size_t blake2b_block_size = 128;
+constexpr std::size_t blake2b_digest_size = 64;
+
+constexpr std::array<std::uint64_t, 8> blake2b_iv = {
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+    0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+
+// h_0 ^ parameter block of Blake2b-512 without key
+constexpr std::uint64_t blake2b_param = 0x01010000 ^ blake2b_digest_size;
+
+constexpr std::uint8_t blake2b_sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+std::size_t get_num_blocks(std::size_t message_size) {
+  return std::max<std::size_t>(1, (message_size + blake2b_block_size - 1) / blake2b_block_size);
+}
+
+// load the i-th little-endian word of the block at `offset` of a message, padded with zeros
+inline std::uint64_t load_word(const std::uint8_t* message, std::size_t message_size,
+                               std::size_t offset, std::size_t i) {
+  std::uint64_t word = 0;
+  const auto begin = offset + 8 * i;
+  if (begin < message_size) {
+    std::memcpy(&word, message + begin, std::min<std::size_t>(8, message_size - begin));
+  }
+  return word;
+}
+
+inline std::uint64_t rotr(std::uint64_t x, int n) { return (x >> n) | (x << (64 - n)); }
+
+inline void g(std::uint64_t v[16], std::size_t a, std::size_t b, std::size_t c, std::size_t d,
+              std::uint64_t x, std::uint64_t y) {
+  v[a] = v[a] + v[b] + x;
+  v[d] = rotr(v[d] ^ v[a], 32);
+  v[c] = v[c] + v[d];
+  v[b] = rotr(v[b] ^ v[c], 24);
+  v[a] = v[a] + v[b] + y;
+  v[d] = rotr(v[d] ^ v[a], 16);
+  v[c] = v[c] + v[d];
+  v[b] = rotr(v[b] ^ v[c], 63);
+}
+
+void compress(std::uint64_t h[8], const std::uint64_t m[16], std::uint64_t counter, bool last) {
+  std::uint64_t v[16];
+  for (std::size_t i = 0; i < 8; ++i) {
+    v[i] = h[i];
+    v[i + 8] = blake2b_iv[i];
+  }
+  v[12] ^= counter;
+  if (last) {
+    v[14] = ~v[14];
+  }
+  for (const auto& s : blake2b_sigma) {
+    g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+  for (std::size_t i = 0; i < 8; ++i) {
+    h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+void Blake2bSingle(const std::uint8_t* message, std::size_t message_size, std::uint8_t* digest,
+                   std::size_t digest_size) {
+  std::uint64_t h[8];
+  std::copy(std::begin(blake2b_iv), std::end(blake2b_iv), h);
+  h[0] ^= blake2b_param;
+  const auto num_blocks = get_num_blocks(message_size);
+  for (std::size_t block_i = 0; block_i < num_blocks; ++block_i) {
+    const auto offset = block_i * blake2b_block_size;
+    const bool last = block_i + 1 == num_blocks;
+    std::uint64_t m[16];
+    for (std::size_t i = 0; i < 16; ++i) {
+      m[i] = load_word(message, message_size, offset, i);
+    }
+    compress(h, m, last ? message_size : offset + blake2b_block_size, last);
+  }
+  std::memcpy(digest, h, digest_size);
+}
+
+// The same functions with the words of four messages in the lanes of AVX2 registers.
+
+template <int n>
+__attribute__((target("avx2"))) inline __m256i rotr_avx2(__m256i x) {
+  if constexpr (n == 32) {
+    return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+  } else if constexpr (n == 24) {
+    const auto mask = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, 3, 4,
+                                       5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    return _mm256_shuffle_epi8(x, mask);
+  } else if constexpr (n == 16) {
+    const auto mask = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, 2, 3,
+                                       4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    return _mm256_shuffle_epi8(x, mask);
+  } else {
+    return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_add_epi64(x, x));
+  }
+}
+
+__attribute__((target("avx2"))) inline void g_avx2(__m256i v[16], std::size_t a, std::size_t b,
+                                                   std::size_t c, std::size_t d, __m256i x,
+                                                   __m256i y) {
+  v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), x);
+  v[d] = rotr_avx2<32>(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi64(v[c], v[d]);
+  v[b] = rotr_avx2<24>(_mm256_xor_si256(v[b], v[c]));
+  v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), y);
+  v[d] = rotr_avx2<16>(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi64(v[c], v[d]);
+  v[b] = rotr_avx2<63>(_mm256_xor_si256(v[b], v[c]));
+}
+
+__attribute__((target("avx2"))) void compress_avx2(__m256i h[8], const __m256i m[16],
+                                                   std::uint64_t counter, bool last) {
+  __m256i v[16];
+  for (std::size_t i = 0; i < 8; ++i) {
+    v[i] = h[i];
+    v[i + 8] = _mm256_set1_epi64x(static_cast<long long>(blake2b_iv[i]));
+  }
+  v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi64x(static_cast<long long>(counter)));
+  if (last) {
+    v[14] = _mm256_xor_si256(v[14], _mm256_set1_epi64x(-1));
+  }
+  for (const auto& s : blake2b_sigma) {
+    g_avx2(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    g_avx2(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    g_avx2(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    g_avx2(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    g_avx2(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    g_avx2(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    g_avx2(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    g_avx2(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+  for (std::size_t i = 0; i < 8; ++i) {
+    h[i] = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]));
+  }
+}
+
+__attribute__((target("avx2"))) void Blake2bAVX2x4(const std::uint8_t* messages,
+                                                   std::size_t message_size, std::uint8_t* digests,
+                                                   std::size_t digest_size) {
+  __m256i h[8];
+  for (std::size_t i = 0; i < 8; ++i) {
+    h[i] = _mm256_set1_epi64x(static_cast<long long>(blake2b_iv[i]));
+  }
+  h[0] = _mm256_xor_si256(h[0], _mm256_set1_epi64x(blake2b_param));
+  const auto num_blocks = get_num_blocks(message_size);
+  for (std::size_t block_i = 0; block_i < num_blocks; ++block_i) {
+    const auto offset = block_i * blake2b_block_size;
+    const bool last = block_i + 1 == num_blocks;
+    __m256i m[16];
+    for (std::size_t i = 0; i < 16; ++i) {
+      m[i] = _mm256_setr_epi64x(
+          static_cast<long long>(load_word(messages, message_size, offset, i)),
+          static_cast<long long>(load_word(messages + message_size, message_size, offset, i)),
+          static_cast<long long>(load_word(messages + 2 * message_size, message_size, offset, i)),
+          static_cast<long long>(load_word(messages + 3 * message_size, message_size, offset, i)));
+    }
+    compress_avx2(h, m, last ? message_size : offset + blake2b_block_size, last);
+  }
+  // transpose the words back to the four digests
+  alignas(32) std::array<std::uint64_t, 4 * 8> state;
+  for (std::size_t i = 0; i < 8; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state.data() + 4 * i), h[i]);
+  }
+  for (std::size_t lane = 0; lane < 4; ++lane) {
+    std::array<std::uint64_t, 8> digest;
+    for (std::size_t i = 0; i < 8; ++i) {
+      digest[i] = state[4 * i + lane];
+    }
+    std::memcpy(digests + lane * digest_size, digest.data(), digest_size);
+  }
+}
+
+}  // namespace
+
+void Blake2bBatch(const std::uint8_t* messages, std::size_t message_size, std::size_t num_messages,
+                  std::uint8_t* digests, std::size_t digest_size) {
+  if (digest_size > blake2b_digest_size) {
+    throw std::invalid_argument("Blake2bBatch: digest_size is larger than 64 bytes");
+  }
+  std::size_t i = 0;
+  if (get_cpu_features().avx2) {
+    for (; i + 4 <= num_messages; i += 4) {
+      Blake2bAVX2x4(messages + i * message_size, message_size, digests + i * digest_size,
+                    digest_size);
+    }
+  }
+  for (; i < num_messages; ++i) {
+    Blake2bSingle(messages + i * message_size, message_size, digests + i * digest_size,
+                  digest_size);
+  }
+}
+
+}  // namespace MOTION
@@ -42,4 +42,11 @@ void Blake2b(std::uint8_t *msg, std::uint8_t digest[EVP_MAX_MD_SIZE], std::size_
 void Blake2b(std::uint8_t *msg, std::uint8_t digest[EVP_MAX_MD_SIZE], std::size_t len,
              Blake2bCtx &b);
 
+// Blake2b-512 of `num_messages` messages of `message_size` bytes each, which are stored one after
+// another in `messages`.  The first `digest_size` (at most 64) bytes of the i-th digest are
+// written to `digests + i * digest_size`.  With AVX2 (see get_cpu_features()) four messages are
+// hashed at once.  The digests are the same as those of Blake2b() with OpenSSL 1.1 or newer.
+void Blake2bBatch(const std::uint8_t *messages, std::size_t message_size, std::size_t num_messages,
+                  std::uint8_t *digests, std::size_t digest_size);
+
 }  // namespace MOTION
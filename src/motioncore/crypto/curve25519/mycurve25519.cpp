@@ -4650,8 +4650,7 @@ void x25519_sc_reduce(uint8_t s[64]) {
 // Output:
 //   s[0]+256*s[1]+...+256^31*s[31] = (ab+c) mod l
 //   where l = 2^252 + 27742317777372353535851937790883648493.
-static void sc_muladd
-    [[maybe_unused]] (uint8_t *s, const uint8_t *a, const uint8_t *b, const uint8_t *c) {
+static void sc_muladd(uint8_t *s, const uint8_t *a, const uint8_t *b, const uint8_t *c) {
   int64_t a0 = 2097151 & load_3(a);
   int64_t a1 = 2097151 & (load_4(a + 2) >> 5);
   int64_t a2 = 2097151 & (load_3(a + 5) >> 2);
@@ -5127,6 +5126,12 @@ static void sc_muladd
   s[31] = s11 >> 17;
 }
 
+// added
+void x25519_sc_muladd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32],
+                      const uint8_t c[32]) {
+  sc_muladd(s, a, b, c);
+}
+
 static void x25519_scalar_mult_generic(uint8_t out[32], const uint8_t scalar[32],
                                        const uint8_t point[32]) {
   fe x1, x2, z2, x3, z3, tmp0, tmp1;
@@ -5254,13 +5259,10 @@ void sc_random(uint8_t s[32]) {
 }
 
 void x25519_ge_p2_to_p3(ge_p3 *r, const ge_p2 *p) {
-  fe_copy(&r->X, &p->X);
-  fe_copy(&r->Y, &p->Y);
-  fe_copy(&r->Z, &p->Z);
-  /* X * Y / Z */
+  /* (X*Z : Y*Z : Z^2 : X*Y) represents the same point without an inversion */
+  fe_mul_ttt(&r->X, &p->X, &p->Z);
+  fe_mul_ttt(&r->Y, &p->Y, &p->Z);
+  fe_sq_tt(&r->Z, &p->Z);
   fe_mul_ttt(&r->T, &p->X, &p->Y);
-  fe tmp;
-  fe_invert(&tmp, &p->Z);
-  fe_mul_ttt(&r->T, &r->T, &tmp);
 }
 }
\ No newline at end of file
@@ -37,6 +37,11 @@ extern "C" {
 namespace curve25519 {
 #endif
 
+// use the faster 64 bit field arithmetic if the compiler supports 128 bit integers
+#if !defined(BORINGSSL_HAS_UINT128) && defined(__SIZEOF_INT128__)
+#define BORINGSSL_HAS_UINT128
+#endif
+
 #if defined(BORINGSSL_HAS_UINT128)
 typedef __uint128_t uint128_t;
 #define BORINGSSL_CURVE25519_64BIT
@@ -131,6 +136,9 @@ void x25519_ge_scalarmult_small_precomp(ge_p3 *h, const uint8_t a[32],
 void x25519_ge_scalarmult_base(ge_p3 *h, const uint8_t a[32]);
 void x25519_ge_scalarmult(ge_p2 *r, const uint8_t *scalar, const ge_p3 *A);
 void x25519_sc_reduce(uint8_t s[64]);
+// s = (a * b + c) mod l, where l is the order of the base point
+void x25519_sc_muladd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32],
+                      const uint8_t c[32]);
 
 typedef struct {
   uint8_t s[32];
@@ -22,6 +22,7 @@
 
 #include "half_gates.h"
 
+#include <immintrin.h>
 #include <parallel/algorithm>
 #include <numeric>
 
@@ -30,6 +31,27 @@
 
 namespace MOTION::Crypto::garbling {
 
+namespace {
+
+// number of AND gates whose hashes are computed together by the batch functions
+constexpr std::size_t and_batch_size = 16;
+
+inline __m128i load(const ENCRYPTO::block128_t& block) {
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(block.data()));
+}
+
+inline void store(ENCRYPTO::block128_t& block, __m128i x) {
+  _mm_store_si128(reinterpret_cast<__m128i*>(block.data()), x);
+}
+
+// all ones if the permutation bit of the key is set and zero otherwise, to avoid the jumps
+inline __m128i permutation_mask(__m128i key) {
+  const __m128i lsb = _mm_and_si128(_mm_shuffle_epi32(key, 0b01'00'01'00), _mm_set1_epi64x(1));
+  return _mm_sub_epi64(_mm_setzero_si128(), lsb);
+}
+
+}  // namespace
+
 HalfGateGarbler::HalfGateGarbler()
     : offset_(ENCRYPTO::block128_t::make_random()), hash_key_(ENCRYPTO::block128_t::make_random()) {
   reinterpret_cast<ENCRYPTO::block128_t*>(round_keys_.data())->set_to_random();
@@ -37,6 +59,13 @@ HalfGateGarbler::HalfGateGarbler()
   offset_.byte_array[0] |= std::byte(1);  // LSB needs to be 1 for freeXOR
 }
 
+HalfGateGarbler::HalfGateGarbler(const ENCRYPTO::block128_t& offset,
+                                 const HalfGatePublicData& public_data)
+    : offset_(offset), hash_key_(public_data.hash_key) {
+  *reinterpret_cast<ENCRYPTO::block128_t*>(round_keys_.data()) = public_data.aes_key;
+  aesni_key_expansion_128(round_keys_.data());
+}
+
 HalfGatePublicData HalfGateGarbler::get_public_data() const noexcept {
   return {hash_key_, *reinterpret_cast<const ENCRYPTO::block128_t*>(round_keys_.data())};
 }
@@ -79,8 +108,48 @@ void HalfGateGarbler::batch_garble_and(ENCRYPTO::block128_t* key_cs,
                                        std::size_t start_index, const ENCRYPTO::block128_t* key_as,
                                        const ENCRYPTO::block128_t* key_bs,
                                        std::size_t num_gates) const {
-  for (std::size_t i = 0; i < num_gates; ++i) {
-    garble_and(key_cs[i], &garbled_tables[2 * i], start_index + i, key_as[i], key_bs[i]);
+  // same as garble_and, but the hashes of and_batch_size gates are computed at once
+  const __m128i offset = load(offset_);
+  const __m128i hash_key = load(hash_key_);
+  alignas(16) std::array<__m128i, 4 * and_batch_size> hashes;
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    const auto batch_size = std::min(and_batch_size, num_gates - batch_i);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const __m128i key_a = load(key_as[batch_i + i]);
+      const __m128i key_b = load(key_bs[batch_i + i]);
+      const std::size_t index = start_index + batch_i + i;
+      const __m128i tweak_a = _mm_xor_si128(hash_key, _mm_set_epi64x(0, index << 1));
+      const __m128i tweak_b = _mm_xor_si128(hash_key, _mm_set_epi64x(0, (index << 1) + 1));
+      hashes[4 * i] = _mm_xor_si128(key_a, tweak_a);
+      hashes[4 * i + 1] = _mm_xor_si128(key_b, tweak_b);
+      hashes[4 * i + 2] = _mm_xor_si128(hashes[4 * i], offset);
+      hashes[4 * i + 3] = _mm_xor_si128(hashes[4 * i + 1], offset);
+    }
+    // compute H(W_a^0, j), H(W_b^0, j'), H(W_a^1, j), H(W_b^1, j') for all gates, an odd number of
+    // gates is padded with one dummy gate
+    const auto num_blocks = (4 * batch_size + 7) & ~std::size_t(7);
+    std::fill(hashes.data() + 4 * batch_size, hashes.data() + num_blocks, _mm_setzero_si128());
+    fixed_key_mmo_hat_batch(round_keys_.data(), hashes.data(), num_blocks);
+
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const __m128i key_a = load(key_as[batch_i + i]);
+      const __m128i key_b = load(key_bs[batch_i + i]);
+      const __m128i p_a = permutation_mask(key_a);
+      const __m128i p_b = permutation_mask(key_b);
+      // T_G <- H(W_a^0, j) ^ H(W_a^1, j) ^ (p_b * R)
+      const __m128i table_g = _mm_xor_si128(_mm_xor_si128(hashes[4 * i], hashes[4 * i + 2]),
+                                            _mm_and_si128(p_b, offset));
+      // T_E <- H(W_b^0, j') ^ H(W_b^1, j') ^ W_a^0
+      const __m128i table_e =
+          _mm_xor_si128(_mm_xor_si128(hashes[4 * i + 1], hashes[4 * i + 3]), key_a);
+      // W_G^0 <- H(W_a^0, j) ^ (p_a * T_G), W_E^0 <- H(W_b^0, j') ^ (p_b * (T_E ^ W_a^0))
+      const __m128i key_g = _mm_xor_si128(hashes[4 * i], _mm_and_si128(p_a, table_g));
+      const __m128i key_e = _mm_xor_si128(hashes[4 * i + 1],
+                                          _mm_and_si128(p_b, _mm_xor_si128(table_e, key_a)));
+      store(garbled_tables[2 * (batch_i + i)], table_g);
+      store(garbled_tables[2 * (batch_i + i) + 1], table_e);
+      store(key_cs[batch_i + i], _mm_xor_si128(key_g, key_e));
+    }
   }
 }
 
@@ -103,8 +172,10 @@ void HalfGateGarbler::batch_garble_and_omp(ENCRYPTO::block128_t* key_cs,
                                            const ENCRYPTO::block128_t* key_bs,
                                            std::size_t num_gates) const {
 #pragma omp parallel for
-  for (std::size_t i = 0; i < num_gates; ++i) {
-    garble_and(key_cs[i], &garbled_tables[2 * i], start_index + i, key_as[i], key_bs[i]);
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    batch_garble_and(key_cs + batch_i, garbled_tables + 2 * batch_i, start_index + batch_i,
+                     key_as + batch_i, key_bs + batch_i,
+                     std::min(and_batch_size, num_gates - batch_i));
   }
 }
 
@@ -185,6 +256,10 @@ HalfGateEvaluator::HalfGateEvaluator(const HalfGatePublicData& public_data)
   aesni_key_expansion_128(round_keys_.data());
 }
 
+HalfGatePublicData HalfGateEvaluator::get_public_data() const noexcept {
+  return {hash_key_, *reinterpret_cast<const ENCRYPTO::block128_t*>(round_keys_.data())};
+}
+
 void HalfGateEvaluator::evaluate_and(ENCRYPTO::block128_t& key_c,
                                      const ENCRYPTO::block128_t* garbled_table, std::size_t index,
                                      const ENCRYPTO::block128_t& key_a,
@@ -209,8 +284,34 @@ void HalfGateEvaluator::batch_evaluate_and(ENCRYPTO::block128_t* key_cs,
                                            const ENCRYPTO::block128_t* key_as,
                                            const ENCRYPTO::block128_t* key_bs,
                                            std::size_t num_gates) const {
-  for (std::size_t i = 0; i < num_gates; ++i) {
-    evaluate_and(key_cs[i], &garbled_tables[2 * i], start_index + i, key_as[i], key_bs[i]);
+  // same as evaluate_and, but the hashes of and_batch_size gates are computed at once
+  const __m128i hash_key = load(hash_key_);
+  alignas(16) std::array<__m128i, 2 * and_batch_size> hashes;
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    const auto batch_size = std::min(and_batch_size, num_gates - batch_i);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const std::size_t index = start_index + batch_i + i;
+      hashes[2 * i] = _mm_xor_si128(load(key_as[batch_i + i]),
+                                    _mm_xor_si128(hash_key, _mm_set_epi64x(0, index << 1)));
+      hashes[2 * i + 1] = _mm_xor_si128(
+          load(key_bs[batch_i + i]), _mm_xor_si128(hash_key, _mm_set_epi64x(0, (index << 1) + 1)));
+    }
+    // pad to a multiple of 4 gates
+    const auto num_blocks = (2 * batch_size + 7) & ~std::size_t(7);
+    std::fill(hashes.data() + 2 * batch_size, hashes.data() + num_blocks, _mm_setzero_si128());
+    fixed_key_mmo_hat_batch(round_keys_.data(), hashes.data(), num_blocks);
+
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const __m128i key_a = load(key_as[batch_i + i]);
+      const __m128i key_b = load(key_bs[batch_i + i]);
+      const __m128i table_g = load(garbled_tables[2 * (batch_i + i)]);
+      const __m128i table_e = load(garbled_tables[2 * (batch_i + i) + 1]);
+      __m128i key_c = _mm_xor_si128(hashes[2 * i], hashes[2 * i + 1]);
+      key_c = _mm_xor_si128(key_c, _mm_and_si128(permutation_mask(key_a), table_g));
+      key_c = _mm_xor_si128(
+          key_c, _mm_and_si128(permutation_mask(key_b), _mm_xor_si128(table_e, key_a)));
+      store(key_cs[batch_i + i], key_c);
+    }
   }
 }
 
@@ -234,8 +335,10 @@ void HalfGateEvaluator::batch_evaluate_and_omp(ENCRYPTO::block128_t* key_cs,
                                                const ENCRYPTO::block128_t* key_bs,
                                                std::size_t num_gates) const {
 #pragma omp parallel for
-  for (std::size_t i = 0; i < num_gates; ++i) {
-    evaluate_and(key_cs[i], &garbled_tables[2 * i], start_index + i, key_as[i], key_bs[i]);
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    batch_evaluate_and(key_cs + batch_i, garbled_tables + 2 * batch_i, start_index + batch_i,
+                       key_as + batch_i, key_bs + batch_i,
+                       std::min(and_batch_size, num_gates - batch_i));
   }
 }
 
@@ -42,6 +42,8 @@ constexpr std::size_t half_gate_block_size = 2;
 class HalfGateGarbler {
  public:
   HalfGateGarbler();
+  // restore a garbler, e.g., from a preprocessing store
+  HalfGateGarbler(const ENCRYPTO::block128_t& offset, const HalfGatePublicData& public_data);
   HalfGatePublicData get_public_data() const noexcept;
   ENCRYPTO::block128_t get_offset() const noexcept;
   void garble_and(ENCRYPTO::block128_t& key_c, ENCRYPTO::block128_t* garbled_table,
@@ -70,6 +72,7 @@ class HalfGateGarbler {
 class HalfGateEvaluator {
  public:
   HalfGateEvaluator(const HalfGatePublicData& public_data);
+  HalfGatePublicData get_public_data() const noexcept;
 
   void evaluate_and(ENCRYPTO::block128_t& key_c, const ENCRYPTO::block128_t* garbled_table,
                     std::size_t index, const ENCRYPTO::block128_t& key_a,
@@ -0,0 +1,380 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "three_halves.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "crypto/aes/aesni_primitives.h"
+#include "crypto/random/aes128_ctr_rng.h"
+
+namespace MOTION::Crypto::garbling {
+
+namespace {
+
+// number of AND gates whose hashes are computed together, their control bits fill 10 bytes
+constexpr std::size_t and_batch_size = 16;
+constexpr std::size_t control_bits_per_gate = 5;
+
+// The garbler XORs a random r into all control values c_ij, the evaluator learns only c_ij of
+// its (unknown) semantic inputs i, j which is uniformly random.  The offsets depend on the
+// permutation bits (alpha, beta), index: alpha << 3 | beta << 2 | i << 1 | j, bit 0: left,
+// bit 1: right control bit.
+constexpr std::array<std::uint64_t, 16> control_offsets = {2, 3, 1, 0, 0, 0, 0, 0,
+                                                           3, 1, 2, 0, 1, 2, 3, 0};
+
+// colors of the evaluator's keys from which the garbled table is computed
+constexpr std::array<std::pair<std::uint64_t, std::uint64_t>, 3> table_colors = {
+    {{0, 0}, {1, 0}, {0, 1}}};
+
+// all ones if bit is 1 and zero if bit is 0
+inline std::uint64_t mask(std::uint64_t bit) { return -bit; }
+
+// Linear part R_ab(c) [A_L A_R B_L B_R]^T of the evaluator's output key for the colors (a, b) and
+// the decrypted control bits (c_l, c_r), where
+//   R_ab(c) = [ c_l ^ c_r ^ !b   c_l        c_l   c_r       ]
+//             [ c_l ^ !a         c_r ^ !b   c_r   c_l ^ c_r ]
+inline void linear_part(std::uint64_t& out_l, std::uint64_t& out_r, std::uint64_t a,
+                        std::uint64_t b, std::uint64_t c_l, std::uint64_t c_r, std::uint64_t a_l,
+                        std::uint64_t a_r, std::uint64_t b_l, std::uint64_t b_r) {
+  out_l = (mask(c_l ^ c_r ^ b ^ 1) & a_l) ^ (mask(c_l) & (a_r ^ b_l)) ^ (mask(c_r) & b_r);
+  out_r = (mask(c_l ^ a ^ 1) & a_l) ^ (mask(c_r ^ b ^ 1) & a_r) ^ (mask(c_r) & b_l) ^
+          (mask(c_l ^ c_r) & b_r);
+}
+
+inline __m128i load(const ENCRYPTO::block128_t& block) {
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(block.data()));
+}
+
+inline void store(std::uint64_t* output, __m128i x) {
+  _mm_store_si128(reinterpret_cast<__m128i*>(output), x);
+}
+
+// left and right half of a key
+inline std::uint64_t left(const ENCRYPTO::block128_t& block) {
+  return _mm_cvtsi128_si64(load(block));
+}
+
+inline std::uint64_t right(const ENCRYPTO::block128_t& block) {
+  return _mm_cvtsi128_si64(_mm_unpackhi_epi64(load(block), load(block)));
+}
+
+inline void store(ENCRYPTO::block128_t& block, std::uint64_t l, std::uint64_t r) {
+  _mm_store_si128(reinterpret_cast<__m128i*>(block.data()), _mm_set_epi64x(r, l));
+}
+
+inline __m128i make_tweak(__m128i hash_key, std::size_t tweak) {
+  return _mm_xor_si128(hash_key, _mm_set_epi64x(0, tweak));
+}
+
+}  // namespace
+
+ThreeHalvesGarbler::ThreeHalvesGarbler(const ENCRYPTO::block128_t& offset,
+                                       const HalfGatePublicData& public_data)
+    : offset_(offset), hash_key_(public_data.hash_key) {
+  assert(static_cast<bool>(offset_.byte_array[0] & std::byte(1)));
+  *reinterpret_cast<ENCRYPTO::block128_t*>(round_keys_.data()) = public_data.aes_key;
+  aesni_key_expansion_128(round_keys_.data());
+}
+
+void ThreeHalvesGarbler::garble_batch(ENCRYPTO::block128_t* key_cs, std::uint64_t* half_keys,
+                                      std::byte* control_bits, std::size_t start_index,
+                                      const ENCRYPTO::block128_t* key_as,
+                                      const ENCRYPTO::block128_t* key_bs,
+                                      std::size_t num_gates) const {
+  const __m128i offset = load(offset_);
+  const __m128i hash_key = load(hash_key_);
+  const std::uint64_t d_l = left(offset_);
+  const std::uint64_t d_r = right(offset_);
+  auto& rng = AES128_CTR_RNG::get_thread_instance();
+  // H(A_0), H(A_1), H(B_0), H(B_1), H(A_0 ^ B_0), H(A_0 ^ B_1) as pairs of 64 bit words
+  alignas(16) std::array<std::uint64_t, 2 * 6 * and_batch_size> hashes;
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    const auto batch_size = std::min(and_batch_size, num_gates - batch_i);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const __m128i key_a = load(key_as[batch_i + i]);
+      const __m128i key_b = load(key_bs[batch_i + i]);
+      const std::size_t index = 3 * (start_index + batch_i + i);
+      const __m128i x_a = _mm_xor_si128(key_a, make_tweak(hash_key, index));
+      const __m128i x_b = _mm_xor_si128(key_b, make_tweak(hash_key, index + 1));
+      const __m128i x_ab =
+          _mm_xor_si128(_mm_xor_si128(key_a, key_b), make_tweak(hash_key, index + 2));
+      store(&hashes[12 * i], x_a);
+      store(&hashes[12 * i + 2], _mm_xor_si128(x_a, offset));
+      store(&hashes[12 * i + 4], x_b);
+      store(&hashes[12 * i + 6], _mm_xor_si128(x_b, offset));
+      store(&hashes[12 * i + 8], x_ab);
+      store(&hashes[12 * i + 10], _mm_xor_si128(x_ab, offset));
+    }
+    // 6 * batch_size is a multiple of 8 for all batch sizes but the last one
+    const auto num_blocks = (6 * batch_size + 7) & ~std::size_t(7);
+    std::fill(hashes.data() + 12 * batch_size, hashes.data() + 2 * num_blocks, 0);
+    fixed_key_mmo_hat_batch(round_keys_.data(), hashes.data(), num_blocks);
+
+    std::uint32_t randomness;
+    rng.random_bytes(reinterpret_cast<std::byte*>(&randomness), sizeof(randomness));
+    __uint128_t batch_control_bits = 0;
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const auto* gate_hashes = &hashes[12 * i];
+      const std::uint64_t a0_l = left(key_as[batch_i + i]);
+      const std::uint64_t a0_r = right(key_as[batch_i + i]);
+      const std::uint64_t b0_l = left(key_bs[batch_i + i]);
+      const std::uint64_t b0_r = right(key_bs[batch_i + i]);
+      const std::uint64_t alpha = a0_l & 1;
+      const std::uint64_t beta = b0_l & 1;
+      const std::uint64_t r = (randomness >> (2 * i)) & 3;
+
+      // what the evaluator computes without the garbled table for the colors (a, b), the left
+      // and right half of the key, and the left and right control bit
+      struct {
+        std::uint64_t l, r;
+        std::uint64_t control_l, control_r;
+      } t[2][2];
+      for (auto [a, b] : table_colors) {
+        const std::uint64_t i_ = a ^ alpha;
+        const std::uint64_t j_ = b ^ beta;
+        const std::uint64_t c = control_offsets[alpha << 3 | beta << 2 | i_ << 1 | j_] ^ r;
+        const std::uint64_t c_l = c & 1;
+        const std::uint64_t c_r = c >> 1;
+        const auto* h_a = &gate_hashes[2 * i_];
+        const auto* h_b = &gate_hashes[4 + 2 * j_];
+        const auto* h_ab = &gate_hashes[8 + 2 * (i_ ^ j_)];
+        std::uint64_t lin_l, lin_r;
+        linear_part(lin_l, lin_r, a, b, c_l, c_r, a0_l ^ (mask(i_) & d_l),
+                    a0_r ^ (mask(i_) & d_r), b0_l ^ (mask(j_) & d_l), b0_r ^ (mask(j_) & d_r));
+        auto& t_ab = t[a][b];
+        t_ab.l = h_a[0] ^ h_ab[0] ^ lin_l ^ (mask(i_ & j_) & d_l);
+        t_ab.r = h_b[0] ^ h_ab[0] ^ lin_r ^ (mask(i_ & j_) & d_r);
+        t_ab.control_l = c_l ^ ((h_a[1] ^ h_ab[1]) & 1);
+        t_ab.control_r = c_r ^ ((h_b[1] ^ h_ab[1]) & 1);
+      }
+
+      // the evaluator with colors (0, 0) obtains the zero key, the other rows define the table
+      const auto& t_00 = t[0][0];
+      const auto& t_10 = t[1][0];
+      const auto& t_01 = t[0][1];
+      auto* gate_half_keys = &half_keys[3 * (batch_i + i)];
+      gate_half_keys[0] = t_10.l ^ t_00.l;
+      gate_half_keys[1] = t_01.r ^ t_00.r;
+      gate_half_keys[2] = t_10.r ^ t_00.r;
+      const std::uint64_t gate_control_bits =
+          (t_10.control_l ^ t_00.control_l) | (t_01.control_r ^ t_00.control_r) << 1 |
+          (t_10.control_r ^ t_00.control_r) << 2 | t_00.control_l << 3 | t_00.control_r << 4;
+      batch_control_bits |= __uint128_t(gate_control_bits) << (control_bits_per_gate * i);
+      store(key_cs[batch_i + i], t_00.l, t_00.r);
+    }
+    std::memcpy(control_bits + control_bits_per_gate * batch_i / 8, &batch_control_bits,
+                (control_bits_per_gate * batch_size + 7) / 8);
+  }
+}
+
+void ThreeHalvesGarbler::batch_garble_and(ENCRYPTO::block128_t* key_cs,
+                                          ENCRYPTO::block128_t* garbled_tables,
+                                          std::size_t start_index,
+                                          const ENCRYPTO::block128_t* key_as,
+                                          const ENCRYPTO::block128_t* key_bs,
+                                          std::size_t num_gates) const {
+  auto* half_keys = reinterpret_cast<std::uint64_t*>(garbled_tables);
+  auto* control_bits = reinterpret_cast<std::byte*>(garbled_tables + (3 * num_gates + 1) / 2);
+  garble_batch(key_cs, half_keys, control_bits, start_index, key_as, key_bs, num_gates);
+  // zero the padding
+  std::fill(half_keys + 3 * num_gates, reinterpret_cast<std::uint64_t*>(control_bits), 0);
+  std::fill(control_bits + (control_bits_per_gate * num_gates + 7) / 8,
+            reinterpret_cast<std::byte*>(garbled_tables + three_halves_table_size(num_gates)),
+            std::byte(0));
+}
+
+void ThreeHalvesGarbler::batch_garble_and(ENCRYPTO::block128_vector& key_cs,
+                                          ENCRYPTO::block128_t* garbled_tables,
+                                          std::size_t start_index,
+                                          const ENCRYPTO::block128_vector& key_as,
+                                          const ENCRYPTO::block128_vector& key_bs) const {
+  assert(key_as.size() == key_bs.size());
+  std::size_t num_gates = key_as.size();
+  key_cs.resize(num_gates);
+  batch_garble_and(key_cs.data(), garbled_tables, start_index, key_as.data(), key_bs.data(),
+                   num_gates);
+}
+
+void ThreeHalvesGarbler::batch_garble_and_omp(ENCRYPTO::block128_t* key_cs,
+                                              ENCRYPTO::block128_t* garbled_tables,
+                                              std::size_t start_index,
+                                              const ENCRYPTO::block128_t* key_as,
+                                              const ENCRYPTO::block128_t* key_bs,
+                                              std::size_t num_gates) const {
+  auto* half_keys = reinterpret_cast<std::uint64_t*>(garbled_tables);
+  auto* control_bits = reinterpret_cast<std::byte*>(garbled_tables + (3 * num_gates + 1) / 2);
+#pragma omp parallel for
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    garble_batch(key_cs + batch_i, half_keys + 3 * batch_i,
+                 control_bits + control_bits_per_gate * batch_i / 8, start_index + batch_i,
+                 key_as + batch_i, key_bs + batch_i, std::min(and_batch_size, num_gates - batch_i));
+  }
+  std::fill(half_keys + 3 * num_gates, reinterpret_cast<std::uint64_t*>(control_bits), 0);
+  std::fill(control_bits + (control_bits_per_gate * num_gates + 7) / 8,
+            reinterpret_cast<std::byte*>(garbled_tables + three_halves_table_size(num_gates)),
+            std::byte(0));
+}
+
+void ThreeHalvesGarbler::batch_garble_and_range(ENCRYPTO::block128_t* key_cs,
+                                                ENCRYPTO::block128_t* garbled_tables,
+                                                std::size_t start_index,
+                                                const ENCRYPTO::block128_t* key_as,
+                                                const ENCRYPTO::block128_t* key_bs,
+                                                std::size_t num_gates, std::size_t begin,
+                                                std::size_t end) const {
+  assert(begin % 8 == 0 && begin <= end && end <= num_gates);
+  auto* half_keys = reinterpret_cast<std::uint64_t*>(garbled_tables);
+  auto* control_bits = reinterpret_cast<std::byte*>(garbled_tables + (3 * num_gates + 1) / 2);
+  garble_batch(key_cs + begin, half_keys + 3 * begin,
+               control_bits + control_bits_per_gate * begin / 8, start_index + begin,
+               key_as + begin, key_bs + begin, end - begin);
+  // the last range zeroes the padding
+  if (end == num_gates) {
+    std::fill(half_keys + 3 * num_gates, reinterpret_cast<std::uint64_t*>(control_bits), 0);
+    std::fill(control_bits + (control_bits_per_gate * num_gates + 7) / 8,
+              reinterpret_cast<std::byte*>(garbled_tables + three_halves_table_size(num_gates)),
+              std::byte(0));
+  }
+}
+
+ThreeHalvesEvaluator::ThreeHalvesEvaluator(const HalfGatePublicData& public_data)
+    : hash_key_(public_data.hash_key) {
+  *reinterpret_cast<ENCRYPTO::block128_t*>(round_keys_.data()) = public_data.aes_key;
+  aesni_key_expansion_128(round_keys_.data());
+}
+
+void ThreeHalvesEvaluator::evaluate_batch(ENCRYPTO::block128_t* key_cs,
+                                          const std::uint64_t* half_keys,
+                                          const std::byte* control_bits, std::size_t start_index,
+                                          const ENCRYPTO::block128_t* key_as,
+                                          const ENCRYPTO::block128_t* key_bs,
+                                          std::size_t num_gates) const {
+  const __m128i hash_key = load(hash_key_);
+  // H(A), H(B), H(A ^ B) as pairs of 64 bit words
+  alignas(16) std::array<std::uint64_t, 2 * 3 * and_batch_size> hashes;
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    const auto batch_size = std::min(and_batch_size, num_gates - batch_i);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const __m128i key_a = load(key_as[batch_i + i]);
+      const __m128i key_b = load(key_bs[batch_i + i]);
+      const std::size_t index = 3 * (start_index + batch_i + i);
+      store(&hashes[6 * i], _mm_xor_si128(key_a, make_tweak(hash_key, index)));
+      store(&hashes[6 * i + 2], _mm_xor_si128(key_b, make_tweak(hash_key, index + 1)));
+      store(&hashes[6 * i + 4],
+            _mm_xor_si128(_mm_xor_si128(key_a, key_b), make_tweak(hash_key, index + 2)));
+    }
+    const auto num_blocks = (3 * batch_size + 7) & ~std::size_t(7);
+    std::fill(hashes.data() + 6 * batch_size, hashes.data() + 2 * num_blocks, 0);
+    fixed_key_mmo_hat_batch(round_keys_.data(), hashes.data(), num_blocks);
+
+    __uint128_t batch_control_bits = 0;
+    std::memcpy(&batch_control_bits, control_bits + control_bits_per_gate * batch_i / 8,
+                (control_bits_per_gate * batch_size + 7) / 8);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      const auto* gate_hashes = &hashes[6 * i];
+      const auto* gate_half_keys = &half_keys[3 * (batch_i + i)];
+      const std::uint64_t a_l = left(key_as[batch_i + i]);
+      const std::uint64_t a_r = right(key_as[batch_i + i]);
+      const std::uint64_t b_l = left(key_bs[batch_i + i]);
+      const std::uint64_t b_r = right(key_bs[batch_i + i]);
+      const std::uint64_t a = a_l & 1;
+      const std::uint64_t b = b_l & 1;
+      const std::uint64_t g =
+          static_cast<std::uint64_t>(batch_control_bits >> (control_bits_per_gate * i));
+      // decrypt the control bits
+      const std::uint64_t c_l = (gate_hashes[1] ^ gate_hashes[5] ^ (a & g) ^ (b & (g >> 2)) ^
+                                 (g >> 3)) & 1;
+      const std::uint64_t c_r = (gate_hashes[3] ^ gate_hashes[5] ^ (b & (g >> 1)) ^
+                                 (a & (g >> 2)) ^ (g >> 4)) & 1;
+      std::uint64_t lin_l, lin_r;
+      linear_part(lin_l, lin_r, a, b, c_l, c_r, a_l, a_r, b_l, b_r);
+      store(key_cs[batch_i + i],
+            gate_hashes[0] ^ gate_hashes[4] ^ (mask(a) & gate_half_keys[0]) ^
+                (mask(b) & gate_half_keys[2]) ^ lin_l,
+            gate_hashes[2] ^ gate_hashes[4] ^ (mask(b) & gate_half_keys[1]) ^
+                (mask(a) & gate_half_keys[2]) ^ lin_r);
+    }
+  }
+}
+
+void ThreeHalvesEvaluator::batch_evaluate_and(ENCRYPTO::block128_t* key_cs,
+                                              const ENCRYPTO::block128_t* garbled_tables,
+                                              std::size_t start_index,
+                                              const ENCRYPTO::block128_t* key_as,
+                                              const ENCRYPTO::block128_t* key_bs,
+                                              std::size_t num_gates) const {
+  evaluate_batch(key_cs, reinterpret_cast<const std::uint64_t*>(garbled_tables),
+                 reinterpret_cast<const std::byte*>(garbled_tables + (3 * num_gates + 1) / 2),
+                 start_index, key_as, key_bs, num_gates);
+}
+
+void ThreeHalvesEvaluator::batch_evaluate_and(ENCRYPTO::block128_vector& key_cs,
+                                              const ENCRYPTO::block128_t* garbled_tables,
+                                              std::size_t start_index,
+                                              const ENCRYPTO::block128_vector& key_as,
+                                              const ENCRYPTO::block128_vector& key_bs) const {
+  assert(key_as.size() == key_bs.size());
+  std::size_t num_gates = key_as.size();
+  key_cs.resize(num_gates);
+  batch_evaluate_and(key_cs.data(), garbled_tables, start_index, key_as.data(), key_bs.data(),
+                     num_gates);
+}
+
+void ThreeHalvesEvaluator::batch_evaluate_and_omp(ENCRYPTO::block128_t* key_cs,
+                                                  const ENCRYPTO::block128_t* garbled_tables,
+                                                  std::size_t start_index,
+                                                  const ENCRYPTO::block128_t* key_as,
+                                                  const ENCRYPTO::block128_t* key_bs,
+                                                  std::size_t num_gates) const {
+  const auto* half_keys = reinterpret_cast<const std::uint64_t*>(garbled_tables);
+  const auto* control_bits =
+      reinterpret_cast<const std::byte*>(garbled_tables + (3 * num_gates + 1) / 2);
+#pragma omp parallel for
+  for (std::size_t batch_i = 0; batch_i < num_gates; batch_i += and_batch_size) {
+    evaluate_batch(key_cs + batch_i, half_keys + 3 * batch_i,
+                   control_bits + control_bits_per_gate * batch_i / 8, start_index + batch_i,
+                   key_as + batch_i, key_bs + batch_i,
+                   std::min(and_batch_size, num_gates - batch_i));
+  }
+}
+
+void ThreeHalvesEvaluator::batch_evaluate_and_range(ENCRYPTO::block128_t* key_cs,
+                                                    const ENCRYPTO::block128_t* garbled_tables,
+                                                    std::size_t start_index,
+                                                    const ENCRYPTO::block128_t* key_as,
+                                                    const ENCRYPTO::block128_t* key_bs,
+                                                    std::size_t num_gates, std::size_t begin,
+                                                    std::size_t end) const {
+  assert(begin % 8 == 0 && begin <= end && end <= num_gates);
+  const auto* half_keys = reinterpret_cast<const std::uint64_t*>(garbled_tables);
+  const auto* control_bits =
+      reinterpret_cast<const std::byte*>(garbled_tables + (3 * num_gates + 1) / 2);
+  evaluate_batch(key_cs + begin, half_keys + 3 * begin,
+                 control_bits + control_bits_per_gate * begin / 8, start_index + begin,
+                 key_as + begin, key_bs + begin, end - begin);
+}
+
+}  // namespace MOTION::Crypto::garbling
@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "crypto/aes/aesni_primitives.h"
+#include "half_gates.h"
+#include "utility/block.h"
+
+namespace MOTION::Crypto::garbling {
+
+// Three halves garbling of AND gates from https://eprint.iacr.org/2021/749: every AND gate costs
+// three half keys (1.5 blocks) and five control bits instead of the two blocks of half gates.
+// The keys are split into a left (lower 64 bits) and a right half (upper 64 bits), the
+// permutation bit is the LSB of the left half.  The garbler computes six and the evaluator three
+// hashes per gate.
+//
+// The garbled tables of n gates consist of the 3n half keys, padded to the next block, followed
+// by the 5n control bits, padded to the next block.
+
+// size of the garbled tables of num_gates AND gates in blocks
+constexpr std::size_t three_halves_table_size(std::size_t num_gates) noexcept {
+  return (3 * num_gates + 1) / 2 + (5 * num_gates + 127) / 128;
+}
+
+class ThreeHalvesGarbler {
+ public:
+  // use the offset and the keys of a half gates garbler s.t. the gates can be mixed in a circuit
+  ThreeHalvesGarbler(const ENCRYPTO::block128_t& offset, const HalfGatePublicData& public_data);
+  void batch_garble_and(ENCRYPTO::block128_t* key_c, ENCRYPTO::block128_t* garbled_tables,
+                        std::size_t index, const ENCRYPTO::block128_t* key_a,
+                        const ENCRYPTO::block128_t* key_b, std::size_t num_gates) const;
+  void batch_garble_and(ENCRYPTO::block128_vector& key_c, ENCRYPTO::block128_t* garbled_tables,
+                        std::size_t index, const ENCRYPTO::block128_vector& key_a,
+                        const ENCRYPTO::block128_vector& key_b) const;
+  void batch_garble_and_omp(ENCRYPTO::block128_t* key_c, ENCRYPTO::block128_t* garbled_tables,
+                            std::size_t index, const ENCRYPTO::block128_t* key_a,
+                            const ENCRYPTO::block128_t* key_b, std::size_t num_gates) const;
+  // Garble only the gates [begin, end) of a batch of num_gates gates, where begin is a multiple of
+  // 8, s.t. disjoint ranges can be garbled concurrently into the same tables.  key_c, key_a and
+  // key_b point to the keys of the whole batch.
+  void batch_garble_and_range(ENCRYPTO::block128_t* key_c, ENCRYPTO::block128_t* garbled_tables,
+                              std::size_t index, const ENCRYPTO::block128_t* key_a,
+                              const ENCRYPTO::block128_t* key_b, std::size_t num_gates,
+                              std::size_t begin, std::size_t end) const;
+
+ private:
+  void garble_batch(ENCRYPTO::block128_t* key_c, std::uint64_t* half_keys,
+                    std::byte* control_bits, std::size_t index, const ENCRYPTO::block128_t* key_a,
+                    const ENCRYPTO::block128_t* key_b, std::size_t num_gates) const;
+
+  ENCRYPTO::block128_t offset_;
+  ENCRYPTO::block128_t hash_key_;
+  alignas(aes_block_size) std::array<std::byte, aes_round_keys_size_128> round_keys_;
+};
+
+class ThreeHalvesEvaluator {
+ public:
+  ThreeHalvesEvaluator(const HalfGatePublicData& public_data);
+  void batch_evaluate_and(ENCRYPTO::block128_t* key_c, const ENCRYPTO::block128_t* garbled_tables,
+                          std::size_t index, const ENCRYPTO::block128_t* key_a,
+                          const ENCRYPTO::block128_t* key_b, std::size_t num_gates) const;
+  void batch_evaluate_and(ENCRYPTO::block128_vector& key_c,
+                          const ENCRYPTO::block128_t* garbled_tables, std::size_t index,
+                          const ENCRYPTO::block128_vector& key_a,
+                          const ENCRYPTO::block128_vector& key_b) const;
+  void batch_evaluate_and_omp(ENCRYPTO::block128_t* key_c,
+                              const ENCRYPTO::block128_t* garbled_tables, std::size_t index,
+                              const ENCRYPTO::block128_t* key_a, const ENCRYPTO::block128_t* key_b,
+                              std::size_t num_gates) const;
+  // evaluate only the gates [begin, end) of a batch of num_gates gates, begin is a multiple of 8
+  void batch_evaluate_and_range(ENCRYPTO::block128_t* key_c,
+                                const ENCRYPTO::block128_t* garbled_tables, std::size_t index,
+                                const ENCRYPTO::block128_t* key_a,
+                                const ENCRYPTO::block128_t* key_b, std::size_t num_gates,
+                                std::size_t begin, std::size_t end) const;
+
+ private:
+  void evaluate_batch(ENCRYPTO::block128_t* key_c, const std::uint64_t* half_keys,
+                      const std::byte* control_bits, std::size_t index,
+                      const ENCRYPTO::block128_t* key_a, const ENCRYPTO::block128_t* key_b,
+                      std::size_t num_gates) const;
+
+  ENCRYPTO::block128_t hash_key_;
+  alignas(aes_block_size) std::array<std::byte, aes_round_keys_size_128> round_keys_;
+};
+
+}  // namespace MOTION::Crypto::garbling
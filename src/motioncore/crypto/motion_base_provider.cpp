@@ -40,6 +40,7 @@ struct HelloMessageHandler : public Communication::MessageHandler {
   // Create a handler object for a given party
   HelloMessageHandler(std::size_t num_parties, std::shared_ptr<Logger> logger)
       : logger_(logger),
+        message_codecs_(num_parties, 0),
         fixed_key_aes_seed_promises_(num_parties),
         randomness_sharing_seed_promises_(num_parties) {
     std::transform(std::begin(fixed_key_aes_seed_promises_), std::end(fixed_key_aes_seed_promises_),
@@ -58,6 +59,9 @@ struct HelloMessageHandler : public Communication::MessageHandler {
 
   std::shared_ptr<Logger> logger_;
 
+  // MessageCodecs announced by each party, valid once its seed futures are ready
+  std::vector<std::uint8_t> message_codecs_;
+
   std::vector<ENCRYPTO::ReusablePromise<std::vector<std::uint8_t>>> fixed_key_aes_seed_promises_;
   std::vector<ENCRYPTO::ReusableFuture<std::vector<std::uint8_t>>> fixed_key_aes_seed_futures_;
 
@@ -72,6 +76,8 @@ void HelloMessageHandler::received_message(std::size_t party_id,
   auto message = Communication::GetMessage(reinterpret_cast<std::uint8_t*>(hello_message.data()));
   auto hello_message_ptr = Communication::GetHelloMessage(message->payload()->data());
 
+  message_codecs_.at(party_id) = hello_message_ptr->supported_message_codecs();
+
   auto* fb_vec = hello_message_ptr->input_sharing_seed();
   randomness_sharing_seed_promises_.at(party_id).set_value(
       std::vector(std::begin(*fb_vec), std::end(*fb_vec)));
@@ -141,7 +147,8 @@ void MotionBaseProvider::setup() {
     }
     auto msg_builder = Communication::BuildHelloMessage(
         my_id_, party_id, num_parties_, &my_seeds.at(party_id), &aes_fixed_key_,
-        /* TODO: config_->GetOnlineAfterSetup()*/ true, MOTION_VERSION);
+        /* TODO: config_->GetOnlineAfterSetup()*/ true, MOTION_VERSION,
+        communication_layer_.get_supported_message_codecs());
     communication_layer_.send_message(party_id, std::move(msg_builder));
   }
   // initialize my randomness generators
@@ -168,7 +175,13 @@ void MotionBaseProvider::setup() {
     // initialize randomness generator of the other party
     their_randomness_generators_.at(party_id)->Initialize(
         reinterpret_cast<const std::byte*>(their_seed.data()));
+    communication_layer_.set_peer_message_codecs(
+        party_id, hello_message_handler_->message_codecs_.at(party_id));
   }
+  // expand the fixed key once instead of in every gate using it
+  std::copy_n(reinterpret_cast<const std::byte*>(aes_fixed_key_.data()), aes_key_size_128,
+              std::begin(aes_fixed_key_round_keys_));
+  aesni_key_expansion_128(aes_fixed_key_round_keys_.data());
   set_setup_ready();
 
   if constexpr (MOTION_DEBUG) {
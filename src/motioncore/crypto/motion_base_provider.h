@@ -22,8 +22,11 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <memory>
+#include "crypto/aes/aesni_primitives.h"
 #include "utility/enable_wait.h"
 #include "utility/reusable_future.h"
 
@@ -53,6 +56,8 @@ class MotionBaseProvider : public ENCRYPTO::enable_wait_setup {
   void setup();
 
   const std::vector<std::uint8_t>& get_aes_fixed_key() const { return aes_fixed_key_; }
+  // expanded fixed key for the aesni_* functions, available after the setup
+  const std::byte* get_aes_fixed_key_round_keys() const { return aes_fixed_key_round_keys_.data(); }
   SharingRandomnessGenerator& get_my_randomness_generator(std::size_t party_id) {
     assert(party_id != my_id_);
     return *my_randomness_generators_.at(party_id);
@@ -71,6 +76,7 @@ class MotionBaseProvider : public ENCRYPTO::enable_wait_setup {
   std::size_t num_parties_;
   std::size_t my_id_;
   std::vector<std::uint8_t> aes_fixed_key_;
+  alignas(aes_block_size) std::array<std::byte, aes_round_keys_size_128> aes_fixed_key_round_keys_;
   std::vector<std::unique_ptr<SharingRandomnessGenerator>> my_randomness_generators_;
   std::vector<std::unique_ptr<SharingRandomnessGenerator>> their_randomness_generators_;
   std::shared_ptr<HelloMessageHandler> hello_message_handler_;
@@ -24,7 +24,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <stdexcept>
+#include <tuple>
 #include <type_traits>
 
 #include <fmt/format.h>
@@ -41,11 +43,110 @@
 
 namespace MOTION {
 
+std::size_t LinAlgTriplePool::size() const noexcept {
+  return std::apply(
+      [](const auto&... triple_maps) {
+        std::size_t size = 0;
+        const auto add_sizes = [&size](const auto& triple_map) {
+          for (const auto& [op, triples] : triple_map) {
+            size += triples.size();
+          }
+        };
+        (add_sizes(triple_maps), ...);
+        return size;
+      },
+      triples_);
+}
+
+void LinAlgTriplePool::clear() noexcept {
+  std::apply([](auto&... triple_maps) { (triple_maps.clear(), ...); }, triples_);
+}
+
+template <typename Op, typename T>
+void LinAlgTripleProvider::take_from_pool(const Op& op) {
+  if (!triple_pool_) {
+    return;
+  }
+  auto& pool_map = triple_pool_->get<Op, T>();
+  auto it = pool_map.find(op);
+  if (it == std::end(pool_map) || it->second.empty()) {
+    return;
+  }
+  if (!pooled_triples_) {
+    pooled_triples_ = std::make_shared<LinAlgTriplePool>();
+  }
+  pooled_triples_->get<Op, T>()[op].emplace_back(std::move(it->second.back()));
+  it->second.pop_back();
+}
+
+template <typename T, typename Op>
+std::size_t LinAlgTripleProvider::get_num_triples_to_generate(const Op& op, std::size_t count) {
+  if (!triple_pool_) {
+    return count;
+  }
+  std::size_t num_pooled = 0;
+  if (pooled_triples_) {
+    const auto& pooled_map = pooled_triples_->get<Op, T>();
+    const auto it = pooled_map.find(op);
+    if (it != std::end(pooled_map)) {
+      num_pooled = it->second.size();
+    }
+  }
+  assert(num_pooled <= count);
+  return (count - num_pooled) * (1 + num_spare_triples_);
+}
+
+void LinAlgTripleProvider::exchange_triples_with_pool() {
+  if (!triple_pool_) {
+    return;
+  }
+  if (!pooled_triples_) {
+    pooled_triples_ = std::make_shared<LinAlgTriplePool>();
+  }
+  const auto exchange = [this](const auto& count_map, auto& triple_map) {
+    using Op = typename std::decay_t<decltype(triple_map)>::key_type;
+    using Triple = typename std::decay_t<decltype(triple_map)>::mapped_type::value_type;
+    using T = typename decltype(Triple::a_)::value_type;
+    auto& pooled_map = pooled_triples_->get<Op, T>();
+    for (const auto& [op, count] : count_map) {
+      auto& triple_vec = triple_map.at(op);
+      auto pooled_it = pooled_map.find(op);
+      const auto num_pooled = pooled_it == std::end(pooled_map) ? 0 : pooled_it->second.size();
+      const auto num_generated = count - num_pooled;
+      assert(triple_vec.size() == num_generated * (1 + num_spare_triples_));
+      // the spare triples are at the end
+      auto& pool_vec = triple_pool_->get<Op, T>()[op];
+      std::move(std::begin(triple_vec) + num_generated, std::end(triple_vec),
+                std::back_inserter(pool_vec));
+      triple_vec.resize(num_generated);
+      if (num_pooled > 0) {
+        std::move(std::begin(pooled_it->second), std::end(pooled_it->second),
+                  std::back_inserter(triple_vec));
+        pooled_map.erase(pooled_it);
+      }
+      assert(triple_vec.size() == count);
+    }
+  };
+
+  exchange(gemm_counts_8_, gemm_triples_8_);
+  exchange(gemm_counts_16_, gemm_triples_16_);
+  exchange(gemm_counts_32_, gemm_triples_32_);
+  exchange(gemm_counts_64_, gemm_triples_64_);
+  exchange(gemm_counts_128_, gemm_triples_128_);
+
+  exchange(conv2d_counts_8_, conv2d_triples_8_);
+  exchange(conv2d_counts_16_, conv2d_triples_16_);
+  exchange(conv2d_counts_32_, conv2d_triples_32_);
+  exchange(conv2d_counts_64_, conv2d_triples_64_);
+  exchange(conv2d_counts_128_, conv2d_triples_128_);
+}
+
 template <typename T>
 std::size_t LinAlgTripleProvider::register_for_gemm_triple(const tensor::GemmOp& gemm_op) {
   assert(gemm_op.verify());
 
-  const auto record_request = [&gemm_op](auto& count_map, auto& triple_map) -> std::size_t {
+  const auto record_request = [this, &gemm_op](auto& count_map, auto& triple_map) -> std::size_t {
+    take_from_pool<tensor::GemmOp, T>(gemm_op);
     auto [it, inserted] = count_map.try_emplace(gemm_op, 1);
     triple_map.try_emplace(gemm_op, std::vector<LinAlgTriple<T>>{});
     if (inserted) {
@@ -124,7 +225,8 @@ template <typename T>
 std::size_t LinAlgTripleProvider::register_for_conv2d_triple(const tensor::Conv2DOp& conv_op) {
   assert(conv_op.verify());
 
-  const auto record_request = [&conv_op](auto& count_map, auto& triple_map) -> std::size_t {
+  const auto record_request = [this, &conv_op](auto& count_map, auto& triple_map) -> std::size_t {
+    take_from_pool<tensor::Conv2DOp, T>(conv_op);
     auto [it, inserted] = count_map.try_emplace(conv_op, 1);
     triple_map.try_emplace(conv_op, std::vector<LinAlgTriple<T>>{});
     if (inserted) {
@@ -238,6 +340,96 @@ LinAlgTriplesFromAP::LinAlgTriplesFromAP(ArithmeticProvider& arith_provider,
 
 LinAlgTriplesFromAP::~LinAlgTriplesFromAP() = default;
 
+void LinAlgTriplesFromAP::presetup() {
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("LinAlgTriplesFromAP::presetup start");
+    }
+  }
+
+  const auto register_gemms = [this](const auto& gemm_op, const auto& count_map,
+                                     auto& gemm_handle_map, auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    auto& [matrix_lhs, matrix_rhs] = gemm_handle_map.at(gemm_op);
+    if (matrix_lhs) {
+      // already registered by a previous call
+      return;
+    }
+    const auto count = get_num_triples_to_generate<T>(gemm_op, count_map.at(gemm_op));
+    if (count == 0) {
+      // all taken from the pool
+      return;
+    }
+    matrix_lhs = arith_provider_.register_matrix_multiplication_lhs<T>(
+        gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1], gemm_op.output_shape_[1], count);
+    matrix_rhs = arith_provider_.register_matrix_multiplication_rhs<T>(
+        gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1], gemm_op.output_shape_[1], count);
+  };
+
+  const auto register_convs = [this](const auto& conv_op, const auto& count_map,
+                                     auto& conv_handle_map, auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    auto& [input_side, kernel_side] = conv_handle_map.at(conv_op);
+    if (input_side) {
+      // already registered by a previous call
+      return;
+    }
+    const auto count = get_num_triples_to_generate<T>(conv_op, count_map.at(conv_op));
+    if (count == 0) {
+      // all taken from the pool
+      return;
+    }
+    input_side = arith_provider_.register_convolution_input_side<T>(conv_op, count);
+    kernel_side = arith_provider_.register_convolution_kernel_side<T>(conv_op, count);
+  };
+
+  for (const auto& [gemm_op, bit_size] : gemm_ops_) {
+    switch (bit_size) {
+      case 8:
+        register_gemms(gemm_op, gemm_counts_8_, gemm_handles_8_, std::uint8_t{});
+        break;
+      case 16:
+        register_gemms(gemm_op, gemm_counts_16_, gemm_handles_16_, std::uint16_t{});
+        break;
+      case 32:
+        register_gemms(gemm_op, gemm_counts_32_, gemm_handles_32_, std::uint32_t{});
+        break;
+      case 64:
+        register_gemms(gemm_op, gemm_counts_64_, gemm_handles_64_, std::uint64_t{});
+        break;
+      case 128:
+        register_gemms(gemm_op, gemm_counts_128_, gemm_handles_128_, __uint128_t{});
+        break;
+    }
+  }
+
+  for (const auto& [conv_op, bit_size] : conv2d_ops_) {
+    switch (bit_size) {
+      case 8:
+        register_convs(conv_op, conv2d_counts_8_, conv2d_handles_8_, std::uint8_t{});
+        break;
+      case 16:
+        register_convs(conv_op, conv2d_counts_16_, conv2d_handles_16_, std::uint16_t{});
+        break;
+      case 32:
+        register_convs(conv_op, conv2d_counts_32_, conv2d_handles_32_, std::uint32_t{});
+        break;
+      case 64:
+        register_convs(conv_op, conv2d_counts_64_, conv2d_handles_64_, std::uint64_t{});
+        break;
+      case 128:
+        register_convs(conv_op, conv2d_counts_128_, conv2d_handles_128_, __uint128_t{});
+        break;
+    }
+  }
+
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("LinAlgTriplesFromAP::presetup end");
+    }
+  }
+}
+
 void LinAlgTriplesFromAP::setup() {
   if constexpr (MOTION_DEBUG) {
     if (logger_) {
@@ -246,91 +438,124 @@ void LinAlgTriplesFromAP::setup() {
   }
   run_time_stats_.record_start<Statistics::RunTimeStats::StatID::linalgtriple_setup>();
 
-  const auto run_setup_gemm_1 = [](const auto& count_map, auto& handle_map, auto& triple_map) {
-    for (const auto& [gemm_op, count] : count_map) {
-      auto& handle_vec = handle_map.at(gemm_op);
+  // generate the random inputs of all triples of a shape, compute the local products in parallel,
+  // and feed the batch into the batched matrix multiplication
+  const auto run_setup_gemm_1 = [this](const auto& count_map, auto& handle_map,
+                                        auto& triple_map) {
+    for (const auto& [gemm_op, num_registered] : count_map) {
+      auto& [handle_input, handle_kernel] = handle_map.at(gemm_op);
       auto& triple_vec = triple_map.at(gemm_op);
-      assert(handle_vec.size() == count);
-      triple_vec.reserve(count);
+      using T = typename decltype(triple_vec.front().a_)::value_type;
+      const auto count = get_num_triples_to_generate<T>(gemm_op, num_registered);
+      if (count == 0) {
+        continue;
+      }
+      if (!handle_input) {
+        throw std::logic_error("gemm triples were not registered, did you call presetup?");
+      }
+      assert(triple_vec.size() == 0);
+      const auto size_a = gemm_op.compute_input_A_size();
+      const auto size_b = gemm_op.compute_input_B_size();
+      auto inputs_a = Helpers::RandomVector<T>(count * size_a);
+      auto inputs_b = Helpers::RandomVector<T>(count * size_b);
+      triple_vec.resize(count);
+#pragma omp parallel for
       for (std::size_t i = 0; i < count; ++i) {
-        auto& triple = triple_vec.emplace_back();
-        using T = typename decltype(triple.a_)::value_type;
-        triple.a_ = Helpers::RandomVector<T>(gemm_op.compute_input_A_size());
-        triple.b_ = Helpers::RandomVector<T>(gemm_op.compute_input_B_size());
+        auto& triple = triple_vec[i];
+        const auto a_begin = std::begin(inputs_a) + i * size_a;
+        const auto b_begin = std::begin(inputs_b) + i * size_b;
+        triple.a_.assign(a_begin, a_begin + size_a);
+        triple.b_.assign(b_begin, b_begin + size_b);
         triple.c_ = matrix_multiply(gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
                                     gemm_op.output_shape_[1], triple.a_, triple.b_);
         assert(triple.c_.size() == gemm_op.compute_output_size());
-        auto& [handle_input, handle_kernel] = handle_vec.at(i);
-        handle_input->set_input(triple.a_);
-        handle_kernel->set_input(triple.b_);
       }
+      handle_input->set_input(std::move(inputs_a));
+      handle_kernel->set_input(std::move(inputs_b));
     }
   };
 
-  const auto run_setup_gemm_2 = [](const auto& count_map, auto& handle_map, auto& triple_map) {
+  // add both batched cross products to the local products (size_c elements per triple)
+  const auto add_batch_outputs = [](auto& triple_vec, const auto& output_1, const auto& output_2,
+                                    std::size_t size_c) {
+    assert(output_1.size() == triple_vec.size() * size_c);
+    assert(output_2.size() == triple_vec.size() * size_c);
+#pragma omp parallel for
+    for (std::size_t i = 0; i < triple_vec.size(); ++i) {
+      auto& c = triple_vec[i].c_;
+      std::transform(std::begin(c), std::end(c), std::begin(output_1) + i * size_c, std::begin(c),
+                     std::plus{});
+      std::transform(std::begin(c), std::end(c), std::begin(output_2) + i * size_c, std::begin(c),
+                     std::plus{});
+    }
+  };
+
+  const auto run_setup_gemm_2 = [&add_batch_outputs](const auto& count_map, auto& handle_map,
+                                                     auto& triple_map) {
     for (const auto& [gemm_op, count] : count_map) {
-      auto& handle_vec = handle_map.at(gemm_op);
+      auto& [handle_input, handle_kernel] = handle_map.at(gemm_op);
       auto& triple_vec = triple_map.at(gemm_op);
-      assert(handle_vec.size() == count);
-      assert(triple_vec.size() == count);
-      for (std::size_t i = 0; i < count; ++i) {
-        auto& triple = triple_vec.at(i);
-        auto& [handle_input, handle_kernel] = handle_vec.at(i);
-        handle_input->compute_output();
-        const auto gemm1_output = handle_input->get_output();
-        assert(gemm1_output.size() == gemm_op.compute_output_size());
-        std::transform(std::begin(triple.c_), std::end(triple.c_), std::begin(gemm1_output),
-                       std::begin(triple.c_), std::plus{});
-        handle_kernel->compute_output();
-        const auto gemm2_output = handle_kernel->get_output();
-        assert(gemm1_output.size() == gemm_op.compute_output_size());
-        std::transform(std::begin(triple.c_), std::end(triple.c_), std::begin(gemm2_output),
-                       std::begin(triple.c_), std::plus{});
+      if (!handle_input) {
+        // all taken from the pool
+        continue;
       }
+      handle_input->compute_output();
+      const auto gemm1_output = handle_input->get_output();
+      handle_kernel->compute_output();
+      const auto gemm2_output = handle_kernel->get_output();
+      add_batch_outputs(triple_vec, gemm1_output, gemm2_output, gemm_op.compute_output_size());
     }
   };
 
-  const auto run_setup_conv_1 = [](const auto& count_map, auto& handle_map, auto& triple_map) {
-    for (const auto& [conv_op, count] : count_map) {
-      auto& handle_vec = handle_map.at(conv_op);
+  const auto run_setup_conv_1 = [this](const auto& count_map, auto& handle_map,
+                                        auto& triple_map) {
+    for (const auto& [conv_op, num_registered] : count_map) {
+      auto& [handle_input, handle_kernel] = handle_map.at(conv_op);
       auto& triple_vec = triple_map.at(conv_op);
-      assert(handle_vec.size() == count);
+      using T = typename decltype(triple_vec.front().a_)::value_type;
+      const auto count = get_num_triples_to_generate<T>(conv_op, num_registered);
+      if (count == 0) {
+        continue;
+      }
+      if (!handle_input) {
+        throw std::logic_error("conv2d triples were not registered, did you call presetup?");
+      }
       assert(triple_vec.size() == 0);
-      triple_vec.reserve(count);
+      const auto size_a = conv_op.compute_input_size();
+      const auto size_b = conv_op.compute_kernel_size();
+      auto inputs_a = Helpers::RandomVector<T>(count * size_a);
+      auto inputs_b = Helpers::RandomVector<T>(count * size_b);
+      triple_vec.resize(count);
+#pragma omp parallel for
       for (std::size_t i = 0; i < count; ++i) {
-        auto& triple = triple_vec.emplace_back();
-        using T = typename decltype(triple.a_)::value_type;
-        triple.a_ = Helpers::RandomVector<T>(conv_op.compute_input_size());
-        triple.b_ = Helpers::RandomVector<T>(conv_op.compute_kernel_size());
+        auto& triple = triple_vec[i];
+        const auto a_begin = std::begin(inputs_a) + i * size_a;
+        const auto b_begin = std::begin(inputs_b) + i * size_b;
+        triple.a_.assign(a_begin, a_begin + size_a);
+        triple.b_.assign(b_begin, b_begin + size_b);
         triple.c_ = convolution(conv_op, triple.a_, triple.b_);
-        auto& [handle_input, handle_kernel] = handle_vec.at(i);
-        handle_input->set_input(triple.a_);
-        handle_kernel->set_input(triple.b_);
       }
+      handle_input->set_input(std::move(inputs_a));
+      handle_kernel->set_input(std::move(inputs_b));
     }
   };
 
-  const auto run_setup_conv_2 = [](const auto& count_map, auto& handle_map, auto& triple_map) {
+  const auto run_setup_conv_2 = [&add_batch_outputs](const auto& count_map, auto& handle_map,
+                                                     auto& triple_map) {
     for (const auto& [conv_op, count] : count_map) {
-      auto& handle_vec = handle_map.at(conv_op);
+      auto& [handle_input, handle_kernel] = handle_map.at(conv_op);
       auto& triple_vec = triple_map.at(conv_op);
-      assert(handle_vec.size() == count);
-      assert(triple_vec.size() == count);
-      for (std::size_t i = 0; i < count; ++i) {
-        auto& triple = triple_vec.at(i);
-        auto& [handle_input, handle_kernel] = handle_vec.at(i);
-        handle_input->compute_output();
-        const auto conv1_output = handle_input->get_output();
-        std::transform(std::begin(triple.c_), std::end(triple.c_), std::begin(conv1_output),
-                       std::begin(triple.c_), std::plus{});
-        handle_kernel->compute_output();
-        const auto conv2_output = handle_kernel->get_output();
-        std::transform(std::begin(triple.c_), std::end(triple.c_), std::begin(conv2_output),
-                       std::begin(triple.c_), std::plus{});
+      if (!handle_input) {
+        // all taken from the pool
+        continue;
       }
+      handle_input->compute_output();
+      const auto conv1_output = handle_input->get_output();
+      handle_kernel->compute_output();
+      const auto conv2_output = handle_kernel->get_output();
+      add_batch_outputs(triple_vec, conv1_output, conv2_output, conv_op.compute_output_size());
     }
   };
-
   const auto run_setup_boolean = [](const auto& count_map, auto& handle_map, auto& triple_map) {
     for (const auto& [key, count] : count_map) {
       const auto num_triples = key.first;
@@ -411,6 +636,7 @@ void LinAlgTriplesFromAP::setup() {
 
   run_setup_boolean(relu_counts_, relu_handles_, relu_triples_);
 
+  exchange_triples_with_pool();
   set_setup_ready();
 
   run_time_stats_.record_end<Statistics::RunTimeStats::StatID::linalgtriple_setup>();
@@ -424,30 +650,25 @@ void LinAlgTriplesFromAP::setup() {
 void LinAlgTriplesFromAP::registration_hook(const tensor::GemmOp& gemm_op, std::size_t bit_size) {
   assert(gemm_op.verify());
 
-  const auto register_gemms = [this, &gemm_op](auto& gemm_handle_map, auto dummy_arg) {
-    using T = decltype(dummy_arg);
-    auto matrix_lhs = arith_provider_.register_matrix_multiplication_lhs<T>(
-        gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1], gemm_op.output_shape_[1]);
-    auto matrix_rhs = arith_provider_.register_matrix_multiplication_rhs<T>(
-        gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1], gemm_op.output_shape_[1]);
-    auto [it, inserted] = gemm_handle_map.try_emplace(gemm_op, gemm_value_type<T>{});
-    auto pair = std::make_pair<std::unique_ptr<MatrixMultiplicationLHS<T>>,
-                               std::unique_ptr<MatrixMultiplicationRHS<T>>>(std::move(matrix_lhs),
-                                                                            std::move(matrix_rhs));
-    it->second.emplace_back(std::move(pair));
+  // the OTs are registered for all triples of a shape at once in presetup()
+  const auto record_shape = [this, &gemm_op, bit_size](auto& gemm_handle_map) {
+    auto [it, inserted] = gemm_handle_map.try_emplace(gemm_op);
+    if (inserted) {
+      gemm_ops_.emplace_back(gemm_op, bit_size);
+    }
   };
 
   switch (bit_size) {
     case 8:
-      return register_gemms(gemm_handles_8_, std::uint8_t{});
+      return record_shape(gemm_handles_8_);
     case 16:
-      return register_gemms(gemm_handles_16_, std::uint16_t{});
+      return record_shape(gemm_handles_16_);
     case 32:
-      return register_gemms(gemm_handles_32_, std::uint32_t{});
+      return record_shape(gemm_handles_32_);
     case 64:
-      return register_gemms(gemm_handles_64_, std::uint64_t{});
+      return record_shape(gemm_handles_64_);
     case 128:
-      return register_gemms(gemm_handles_128_, __uint128_t{});
+      return record_shape(gemm_handles_128_);
     default:
       throw std::logic_error("invalid bit size");
   }
@@ -456,28 +677,25 @@ void LinAlgTriplesFromAP::registration_hook(const tensor::GemmOp& gemm_op, std::
 void LinAlgTriplesFromAP::registration_hook(const tensor::Conv2DOp& conv_op, std::size_t bit_size) {
   assert(conv_op.verify());
 
-  const auto register_convs = [this, &conv_op](auto& conv_handle_map, auto dummy_arg) {
-    using T = decltype(dummy_arg);
-    auto input_side = arith_provider_.register_convolution_input_side<T>(conv_op);
-    auto kernel_side = arith_provider_.register_convolution_kernel_side<T>(conv_op);
-    auto [it, inserted] = conv_handle_map.try_emplace(conv_op, conv_value_type<T>{});
-    auto pair = std::make_pair<std::unique_ptr<ConvolutionInputSide<T>>,
-                               std::unique_ptr<ConvolutionKernelSide<T>>>(std::move(input_side),
-                                                                          std::move(kernel_side));
-    it->second.emplace_back(std::move(pair));
+  // the OTs are registered for all triples of a shape at once in presetup()
+  const auto record_shape = [this, &conv_op, bit_size](auto& conv_handle_map) {
+    auto [it, inserted] = conv_handle_map.try_emplace(conv_op);
+    if (inserted) {
+      conv2d_ops_.emplace_back(conv_op, bit_size);
+    }
   };
 
   switch (bit_size) {
     case 8:
-      return register_convs(conv2d_handles_8_, std::uint8_t{});
+      return record_shape(conv2d_handles_8_);
     case 16:
-      return register_convs(conv2d_handles_16_, std::uint16_t{});
+      return record_shape(conv2d_handles_16_);
     case 32:
-      return register_convs(conv2d_handles_32_, std::uint32_t{});
+      return record_shape(conv2d_handles_32_);
     case 64:
-      return register_convs(conv2d_handles_64_, std::uint64_t{});
+      return record_shape(conv2d_handles_64_);
     case 128:
-      return register_convs(conv2d_handles_128_, __uint128_t{});
+      return record_shape(conv2d_handles_128_);
     default:
       throw std::logic_error("invalid bit size");
   }
@@ -497,26 +715,28 @@ void LinAlgTriplesFromAP::registration_hook_boolean(std::size_t num_triples, std
 // ---------- FakeLinAlgTripleProvider ----------
 
 void FakeLinAlgTripleProvider::setup() {
-  const auto run_setup_gemm = [](const auto& count_map, auto& triple_map) {
-    for (const auto& [gemm_op, count] : count_map) {
+  const auto run_setup_gemm = [this](const auto& count_map, auto& triple_map) {
+    for (const auto& [gemm_op, num_registered] : count_map) {
       auto& triple_vec = triple_map.at(gemm_op);
+      using T = typename decltype(triple_vec.front().a_)::value_type;
+      const auto count = get_num_triples_to_generate<T>(gemm_op, num_registered);
       triple_vec.reserve(count);
       for (std::size_t i = 0; i < count; ++i) {
         auto& triple = triple_vec.emplace_back();
-        using T = typename decltype(triple.a_)::value_type;
         triple.a_ = Helpers::RandomVector<T>(gemm_op.compute_input_A_size());
         triple.b_ = Helpers::RandomVector<T>(gemm_op.compute_input_B_size());
         triple.c_ = Helpers::RandomVector<T>(gemm_op.compute_output_size());
       }
     }
   };
-  const auto run_setup_conv = [](const auto& count_map, auto& triple_map) {
-    for (const auto& [conv_op, count] : count_map) {
+  const auto run_setup_conv = [this](const auto& count_map, auto& triple_map) {
+    for (const auto& [conv_op, num_registered] : count_map) {
       auto& triple_vec = triple_map.at(conv_op);
+      using T = typename decltype(triple_vec.front().a_)::value_type;
+      const auto count = get_num_triples_to_generate<T>(conv_op, num_registered);
       triple_vec.reserve(count);
       for (std::size_t i = 0; i < count; ++i) {
         auto& triple = triple_vec.emplace_back();
-        using T = typename decltype(triple.a_)::value_type;
         triple.a_ = Helpers::RandomVector<T>(conv_op.compute_input_size());
         triple.b_ = Helpers::RandomVector<T>(conv_op.compute_kernel_size());
         triple.c_ = Helpers::RandomVector<T>(conv_op.compute_output_size());
@@ -556,6 +776,7 @@ void FakeLinAlgTripleProvider::setup() {
 
   run_setup_boolean(relu_counts_, relu_triples_);
 
+  exchange_triples_with_pool();
   set_setup_ready();
 }
 
@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -56,6 +57,7 @@ class MatrixMultiplicationLHS;
 template <typename T>
 class MatrixMultiplicationRHS;
 class Logger;
+class LinAlgTriplePool;
 
 class LinAlgTripleProvider : public ENCRYPTO::enable_wait_setup {
  public:
@@ -73,6 +75,14 @@ class LinAlgTripleProvider : public ENCRYPTO::enable_wait_setup {
     std::vector<ENCRYPTO::BitVector<>> c_;
   };
 
+  // Take the gemm and conv2d triples from `pool` if it has some of the registered shape.  Otherwise
+  // generate `num_spare` additional ones per registration and leave them in the pool for later
+  // runs.  Set before the first registration.
+  void set_triple_pool(std::shared_ptr<LinAlgTriplePool> pool, std::size_t num_spare) noexcept {
+    triple_pool_ = std::move(pool);
+    num_spare_triples_ = num_spare;
+  }
+
   template <typename T>
   std::size_t register_for_gemm_triple(const tensor::GemmOp&);
 
@@ -90,6 +100,9 @@ class LinAlgTripleProvider : public ENCRYPTO::enable_wait_setup {
   [[nodiscard]] BooleanTriple get_relu_triple(std::size_t num_triples, std::size_t bit_size,
                                               std::size_t index);
 
+  // register the OTs for the triples requested so far, call after all registrations but before
+  // the OT setup
+  virtual void presetup() {}
   virtual void setup() = 0;
 
  protected:
@@ -97,6 +110,16 @@ class LinAlgTripleProvider : public ENCRYPTO::enable_wait_setup {
   virtual void registration_hook(const tensor::Conv2DOp&, std::size_t bit_size) = 0;
   virtual void registration_hook_boolean(std::size_t num_triples, std::size_t bit_size) = 0;
 
+  // move a triple of the shape from the pool to pooled_triples_ if it has one
+  template <typename Op, typename T>
+  void take_from_pool(const Op&);
+  // number of triples of a shape to generate for `count` registrations
+  template <typename T, typename Op>
+  std::size_t get_num_triples_to_generate(const Op&, std::size_t count);
+  // move the spare triples into the pool and add the ones taken from the pool, call after
+  // generating the triples but before set_setup_ready()
+  void exchange_triples_with_pool();
+
   std::unordered_map<tensor::GemmOp, std::size_t> gemm_counts_8_;
   std::unordered_map<tensor::GemmOp, std::size_t> gemm_counts_16_;
   std::unordered_map<tensor::GemmOp, std::size_t> gemm_counts_32_;
@@ -126,6 +149,35 @@ class LinAlgTripleProvider : public ENCRYPTO::enable_wait_setup {
   std::unordered_map<std::pair<std::size_t, std::size_t>, std::vector<BooleanTriple>,
                      utils::size_t_pair_hash>
       relu_triples_;
+
+  std::shared_ptr<LinAlgTriplePool> triple_pool_;
+  std::size_t num_spare_triples_ = 0;
+  // triples taken from the pool for the registrations so far, created with the first one
+  std::shared_ptr<LinAlgTriplePool> pooled_triples_;
+};
+
+// Gemm and conv2d triples kept across several runs, e.g., by a tensor::ModelSession.  Both parties
+// need to use their pools with the same sequence of registrations.  Not thread-safe.
+class LinAlgTriplePool {
+ public:
+  template <typename Op, typename T>
+  using TripleMap = std::unordered_map<Op, std::vector<LinAlgTripleProvider::LinAlgTriple<T>>>;
+
+  template <typename Op, typename T>
+  TripleMap<Op, T>& get() noexcept {
+    return std::get<TripleMap<Op, T>>(triples_);
+  }
+  // number of triples of all shapes and bit sizes
+  std::size_t size() const noexcept;
+  void clear() noexcept;
+
+ private:
+  std::tuple<TripleMap<tensor::GemmOp, std::uint8_t>, TripleMap<tensor::GemmOp, std::uint16_t>,
+             TripleMap<tensor::GemmOp, std::uint32_t>, TripleMap<tensor::GemmOp, std::uint64_t>,
+             TripleMap<tensor::GemmOp, __uint128_t>, TripleMap<tensor::Conv2DOp, std::uint8_t>,
+             TripleMap<tensor::Conv2DOp, std::uint16_t>, TripleMap<tensor::Conv2DOp, std::uint32_t>,
+             TripleMap<tensor::Conv2DOp, std::uint64_t>, TripleMap<tensor::Conv2DOp, __uint128_t>>
+      triples_;
 };
 
 class LinAlgTriplesFromAP : public LinAlgTripleProvider {
@@ -134,6 +186,9 @@ class LinAlgTriplesFromAP : public LinAlgTripleProvider {
                       Statistics::RunTimeStats&, std::shared_ptr<Logger>);
   ~LinAlgTriplesFromAP();
 
+  // all triples of the same shape and bit size are generated in one batch with one OT batch per
+  // direction
+  void presetup() override;
   void setup() override;
 
  protected:
@@ -147,9 +202,14 @@ class LinAlgTriplesFromAP : public LinAlgTripleProvider {
   Statistics::RunTimeStats& run_time_stats_;
   std::shared_ptr<Logger> logger_;
 
+  // shapes in the order of their first registration, s.t. both parties register the batches in
+  // the same order
+  std::vector<std::pair<tensor::GemmOp, std::size_t>> gemm_ops_;
+  std::vector<std::pair<tensor::Conv2DOp, std::size_t>> conv2d_ops_;
+
   template <typename T>
-  using gemm_value_type = std::vector<std::pair<std::unique_ptr<MatrixMultiplicationLHS<T>>,
-                                                std::unique_ptr<MatrixMultiplicationRHS<T>>>>;
+  using gemm_value_type = std::pair<std::unique_ptr<MatrixMultiplicationLHS<T>>,
+                                    std::unique_ptr<MatrixMultiplicationRHS<T>>>;
   std::unordered_map<tensor::GemmOp, gemm_value_type<std::uint8_t>> gemm_handles_8_;
   std::unordered_map<tensor::GemmOp, gemm_value_type<std::uint16_t>> gemm_handles_16_;
   std::unordered_map<tensor::GemmOp, gemm_value_type<std::uint32_t>> gemm_handles_32_;
@@ -157,8 +217,8 @@ class LinAlgTriplesFromAP : public LinAlgTripleProvider {
   std::unordered_map<tensor::GemmOp, gemm_value_type<__uint128_t>> gemm_handles_128_;
 
   template <typename T>
-  using conv_value_type = std::vector<std::pair<std::unique_ptr<ConvolutionInputSide<T>>,
-                                                std::unique_ptr<ConvolutionKernelSide<T>>>>;
+  using conv_value_type = std::pair<std::unique_ptr<ConvolutionInputSide<T>>,
+                                    std::unique_ptr<ConvolutionKernelSide<T>>>;
   std::unordered_map<tensor::Conv2DOp, conv_value_type<std::uint8_t>> conv2d_handles_8_;
   std::unordered_map<tensor::Conv2DOp, conv_value_type<std::uint16_t>> conv2d_handles_16_;
   std::unordered_map<tensor::Conv2DOp, conv_value_type<std::uint32_t>> conv2d_handles_32_;
@@ -24,9 +24,12 @@
 
 #include "mt_provider.h"
 #include <algorithm>
+#include <string>
 
 #include "crypto/arithmetic_provider.h"
 #include "crypto/oblivious_transfer/ot_flavors.h"
+#include "crypto/random/fake_setup.h"
+#include "statistics/metrics.h"
 #include "statistics/run_time_stats.h"
 #include "utility/constants.h"
 #include "utility/logger.h"
@@ -34,13 +37,22 @@
 namespace MOTION {
 
 bool MTProvider::NeedMTs() const noexcept {
-  return (GetNumMTs<bool>() + GetNumMTs<std::uint8_t>() + GetNumMTs<std::uint16_t>() +
+  const bool need_shared_mts =
+      std::apply([](const auto&... requests) { return (!requests.empty() || ...); }, shared_mts_);
+  return need_shared_mts ||
+         (GetNumMTs<bool>() + GetNumMTs<std::uint8_t>() + GetNumMTs<std::uint16_t>() +
           GetNumMTs<std::uint32_t>() + GetNumMTs<std::uint64_t>()) > 0;
 }
 
-std::size_t MTProvider::RequestBinaryMTs(const std::size_t num_mts) noexcept {
+std::size_t MTProvider::RequestBinaryMTs(const std::size_t num_mts) {
+  if (auto offset = ConstructionScope::take(ConstructionCounter::binary_mts, num_mts)) {
+    return *offset;
+  }
   const auto offset = num_bit_mts_;
   num_bit_mts_ += num_mts;
+  if (request_callback_) {
+    request_callback_(1, num_mts);
+  }
   return offset;
 }
 
@@ -65,6 +77,169 @@ MTProvider::MTProvider(const std::size_t my_id, const std::size_t num_parties)
       std::make_shared<ENCRYPTO::FiberCondition>([this]() { return finished_.load(); });
 }
 
+namespace {
+
+template <typename T>
+void append_mts(IntegerMTVector<T>& mts, const IntegerMTVector<T>& other) {
+  mts.a.insert(std::end(mts.a), std::begin(other.a), std::end(other.a));
+  mts.b.insert(std::end(mts.b), std::begin(other.b), std::end(other.b));
+  mts.c.insert(std::end(mts.c), std::begin(other.c), std::end(other.c));
+}
+
+void append_mts(BinaryMTVector& mts, const BinaryMTVector& other) {
+  mts.a.Append(other.a);
+  mts.b.Append(other.b);
+  mts.c.Append(other.c);
+}
+
+}  // namespace
+
+void MTProvider::TakeFromReservoir() {
+  if (reservoir_ == nullptr) {
+    return;
+  }
+  reserved_bit_mts_ = reservoir_->TakeBinary(num_bit_mts_);
+  num_bit_mts_ -= reserved_bit_mts_.a.GetSize();
+  reserved_mts8_ = reservoir_->TakeInteger<std::uint8_t>(num_mts_8_);
+  num_mts_8_ -= reserved_mts8_.a.size();
+  reserved_mts16_ = reservoir_->TakeInteger<std::uint16_t>(num_mts_16_);
+  num_mts_16_ -= reserved_mts16_.a.size();
+  reserved_mts32_ = reservoir_->TakeInteger<std::uint32_t>(num_mts_32_);
+  num_mts_32_ -= reserved_mts32_.a.size();
+  reserved_mts64_ = reservoir_->TakeInteger<std::uint64_t>(num_mts_64_);
+  num_mts_64_ -= reserved_mts64_.a.size();
+}
+
+void MTProvider::AppendReservedMTs() {
+  if (reservoir_ == nullptr) {
+    return;
+  }
+  append_mts(bit_mts_, reserved_bit_mts_);
+  num_bit_mts_ += reserved_bit_mts_.a.GetSize();
+  append_mts(mts8_, reserved_mts8_);
+  num_mts_8_ += reserved_mts8_.a.size();
+  append_mts(mts16_, reserved_mts16_);
+  num_mts_16_ += reserved_mts16_.a.size();
+  append_mts(mts32_, reserved_mts32_);
+  num_mts_32_ += reserved_mts32_.a.size();
+  append_mts(mts64_, reserved_mts64_);
+  num_mts_64_ += reserved_mts64_.a.size();
+  reserved_bit_mts_ = {};
+  reserved_mts8_ = {};
+  reserved_mts16_ = {};
+  reserved_mts32_ = {};
+  reserved_mts64_ = {};
+}
+
+// ---------- MTReservoir ----------
+
+namespace {
+
+// triples of type T in all reservoirs of the process
+template <typename T>
+Statistics::Gauge& mt_reservoir_gauge() {
+  static auto& gauge = []() -> Statistics::Gauge& {
+    std::string type;
+    if constexpr (std::is_same_v<T, bool>) {
+      type = "bit";
+    } else {
+      type = "uint" + std::to_string(8 * sizeof(T));
+    }
+    return Statistics::MetricsRegistry::get_instance().get_gauge(
+        "motion_mt_reservoir_size", "Multiplication triples in the MTReservoirs",
+        {{"type", type}});
+  }();
+  return gauge;
+}
+
+}  // namespace
+
+MTReservoir::~MTReservoir() {
+  mt_reservoir_gauge<bool>().add(-static_cast<double>(GetSize<bool>()));
+  mt_reservoir_gauge<std::uint8_t>().add(-static_cast<double>(GetSize<std::uint8_t>()));
+  mt_reservoir_gauge<std::uint16_t>().add(-static_cast<double>(GetSize<std::uint16_t>()));
+  mt_reservoir_gauge<std::uint32_t>().add(-static_cast<double>(GetSize<std::uint32_t>()));
+  mt_reservoir_gauge<std::uint64_t>().add(-static_cast<double>(GetSize<std::uint64_t>()));
+}
+
+BinaryMTVector MTReservoir::TakeBinary(std::size_t num_mts) {
+  num_mts = std::min(num_mts, bit_mts_.size());
+  if (num_mts == 0) {
+    return {};
+  }
+  const auto& mts = bit_mts_.mts_;
+  const auto head = bit_mts_.head_;
+  bit_mts_.head_ += num_mts;
+  mt_reservoir_gauge<bool>().add(-static_cast<double>(num_mts));
+  return BinaryMTVector{mts.a.Subset(head, head + num_mts), mts.b.Subset(head, head + num_mts),
+                        mts.c.Subset(head, head + num_mts)};
+}
+
+template <typename T, typename>
+IntegerMTVector<T> MTReservoir::TakeInteger(std::size_t num_mts) {
+  auto& pool = GetPool<T>();
+  num_mts = std::min(num_mts, pool.size());
+  const auto first = static_cast<std::ptrdiff_t>(pool.head_);
+  const auto last = static_cast<std::ptrdiff_t>(pool.head_ + num_mts);
+  pool.head_ += num_mts;
+  const auto& mts = pool.mts_;
+  mt_reservoir_gauge<T>().add(-static_cast<double>(num_mts));
+  return IntegerMTVector<T>{std::vector<T>(mts.a.begin() + first, mts.a.begin() + last),
+                            std::vector<T>(mts.b.begin() + first, mts.b.begin() + last),
+                            std::vector<T>(mts.c.begin() + first, mts.c.begin() + last)};
+}
+
+void MTReservoir::AddBinary(const BinaryMTVector& mts) {
+  auto& pool = bit_mts_;
+  // drop the taken triples before the pool grows again
+  if (pool.head_ > 0) {
+    const auto size = pool.size();
+    if (size == 0) {
+      pool.mts_ = {};
+    } else {
+      const auto total = pool.mts_.a.GetSize();
+      pool.mts_ = BinaryMTVector{pool.mts_.a.Subset(pool.head_, total),
+                                 pool.mts_.b.Subset(pool.head_, total),
+                                 pool.mts_.c.Subset(pool.head_, total)};
+    }
+    pool.head_ = 0;
+  }
+  append_mts(pool.mts_, mts);
+  mt_reservoir_gauge<bool>().add(mts.a.GetSize());
+}
+
+template <typename T, typename>
+void MTReservoir::AddInteger(const IntegerMTVector<T>& mts) {
+  auto& pool = GetPool<T>();
+  // drop the taken triples before the pool grows again
+  if (pool.head_ > 0) {
+    const auto head = static_cast<std::ptrdiff_t>(pool.head_);
+    pool.mts_.a.erase(pool.mts_.a.begin(), pool.mts_.a.begin() + head);
+    pool.mts_.b.erase(pool.mts_.b.begin(), pool.mts_.b.begin() + head);
+    pool.mts_.c.erase(pool.mts_.c.begin(), pool.mts_.c.begin() + head);
+    pool.head_ = 0;
+  }
+  append_mts(pool.mts_, mts);
+  mt_reservoir_gauge<T>().add(mts.a.size());
+}
+
+void MTReservoir::Add(const MTProvider& mt_provider) {
+  AddBinary(mt_provider.GetBinaryAll());
+  AddInteger(mt_provider.GetIntegerAll<std::uint8_t>());
+  AddInteger(mt_provider.GetIntegerAll<std::uint16_t>());
+  AddInteger(mt_provider.GetIntegerAll<std::uint32_t>());
+  AddInteger(mt_provider.GetIntegerAll<std::uint64_t>());
+}
+
+template IntegerMTVector<std::uint8_t> MTReservoir::TakeInteger(std::size_t);
+template IntegerMTVector<std::uint16_t> MTReservoir::TakeInteger(std::size_t);
+template IntegerMTVector<std::uint32_t> MTReservoir::TakeInteger(std::size_t);
+template IntegerMTVector<std::uint64_t> MTReservoir::TakeInteger(std::size_t);
+template void MTReservoir::AddInteger(const IntegerMTVector<std::uint8_t>&);
+template void MTReservoir::AddInteger(const IntegerMTVector<std::uint16_t>&);
+template void MTReservoir::AddInteger(const IntegerMTVector<std::uint32_t>&);
+template void MTReservoir::AddInteger(const IntegerMTVector<std::uint64_t>&);
+
 // ---------- MTProviderFromOTs ----------
 
 namespace {
@@ -107,17 +282,41 @@ void register_helper_bool_2pc(ENCRYPTO::ObliviousTransfer::OTProvider& ot_provid
   ots_rcv = ot_provider.RegisterReceiveROT(num_bit_mts);
 }
 
+template <typename T>
+void generate_random_shared_triples(std::vector<SharedIntegerMTVector<T>>& requests) {
+  for (auto& mts : requests) {
+    const auto vector_size = mts.vector_size;
+    mts.a = Helpers::RandomVector<T>(mts.num_groups);
+    mts.b = Helpers::RandomVector<T>(mts.num_groups * vector_size);
+    mts.c.resize(mts.num_groups * vector_size);
+    for (std::size_t i = 0; i < mts.num_groups; ++i) {
+      for (std::size_t j = 0; j < vector_size; ++j) {
+        mts.c[i * vector_size + j] = mts.a[i] * mts.b[i * vector_size + j];
+      }
+    }
+  }
+}
+
+// number of multiplications of a batch, where the sender's vectors of vector_size values count
+// as one, s.t. a batch has at most max_batch_size products (or a single vector)
+std::size_t get_batch_size(std::size_t max_batch_size, std::size_t vector_size) {
+  return std::max(max_batch_size / vector_size, std::size_t(1));
+}
+
 template <typename T>
 void register_multiplications_helper(
     ArithmeticProvider& arithmetic_provider,
     std::list<std::unique_ptr<IntegerMultiplicationSender<T>>>& mult_senders,
     std::list<std::unique_ptr<IntegerMultiplicationReceiver<T>>>& mult_receivers,
-    std::size_t max_batch_size, std::size_t num_mts) {
+    std::size_t max_batch_size, std::size_t num_mts, std::size_t vector_size = 1) {
+  max_batch_size = get_batch_size(max_batch_size, vector_size);
   for (std::size_t mt_id = 0; mt_id < num_mts;) {
     auto batch_size = std::min(max_batch_size, num_mts - mt_id);
 
-    auto mult_sender = arithmetic_provider.register_integer_multiplication_send<T>(batch_size);
-    auto mult_receiver = arithmetic_provider.register_integer_multiplication_receive<T>(batch_size);
+    auto mult_sender =
+        arithmetic_provider.register_integer_multiplication_send<T>(batch_size, vector_size);
+    auto mult_receiver =
+        arithmetic_provider.register_integer_multiplication_receive<T>(batch_size, vector_size);
     mult_senders.push_back(std::move(mult_sender));
     mult_receivers.push_back(std::move(mult_receiver));
 
@@ -125,16 +324,20 @@ void register_multiplications_helper(
   }
 }
 
+// the senders multiply vectors of vector_size values of sender_inputs with the single values of
+// the receiver_inputs of the other party
 template <typename T>
 void start_multiplications_helper(
     std::list<std::unique_ptr<IntegerMultiplicationSender<T>>>& mult_senders,
     std::list<std::unique_ptr<IntegerMultiplicationReceiver<T>>>& mult_receivers,
-    std::size_t max_batch_size, std::size_t num_mts, const IntegerMTVector<T>& mts) {
+    std::size_t max_batch_size, std::size_t num_mts, const T* sender_inputs,
+    const T* receiver_inputs, std::size_t vector_size = 1) {
+  max_batch_size = get_batch_size(max_batch_size, vector_size);
   auto it_sender = std::begin(mult_senders);
   auto it_receiver = std::begin(mult_receivers);
   for (std::size_t mt_id = 0; mt_id < num_mts; mt_id += max_batch_size) {
-    (*it_sender)->set_inputs(mts.a.data() + mt_id);
-    (*it_receiver)->set_inputs(mts.b.data() + mt_id);
+    (*it_sender)->set_inputs(sender_inputs + mt_id * vector_size);
+    (*it_receiver)->set_inputs(receiver_inputs + mt_id);
 
     ++it_sender;
     ++it_receiver;
@@ -165,14 +368,16 @@ void finish_mts_helper_bool(ENCRYPTO::ObliviousTransfer::XCOTBitSender& ot_sende
 template <typename T>
 void finish_mts_helper(std::list<std::unique_ptr<IntegerMultiplicationSender<T>>>& mult_senders,
                        std::list<std::unique_ptr<IntegerMultiplicationReceiver<T>>>& mult_receivers,
-                       std::size_t max_batch_size, std::size_t num_mts, IntegerMTVector<T>& mts) {
+                       std::size_t max_batch_size, std::size_t num_mts, std::vector<T>& c,
+                       std::size_t vector_size = 1) {
+  max_batch_size = get_batch_size(max_batch_size, vector_size);
   auto it_sender = std::begin(mult_senders);
   auto it_receiver = std::begin(mult_receivers);
   for (std::size_t mt_id = 0; mt_id < num_mts; mt_id += max_batch_size) {
     const auto share_s = (*it_sender)->get_outputs();
     const auto share_r = (*it_receiver)->get_outputs();
     for (std::size_t i = 0; i < share_s.size(); ++i) {
-      mts.c.at(mt_id + i) += share_s[i] + share_r[i];
+      c.at(mt_id * vector_size + i) += share_s[i] + share_r[i];
     }
 
     ++it_sender;
@@ -180,6 +385,59 @@ void finish_mts_helper(std::list<std::unique_ptr<IntegerMultiplicationSender<T>>
   }
 }
 
+// multiplications of the shared triples of each request of one type with one other party
+template <typename T>
+struct SharedMultiplications {
+  std::vector<std::list<std::unique_ptr<IntegerMultiplicationSender<T>>>> senders;
+  std::vector<std::list<std::unique_ptr<IntegerMultiplicationReceiver<T>>>> receivers;
+};
+
+// the vectors of b are multiplied with the shares of a of the other party and vice versa
+template <typename T>
+void register_shared_multiplications_helper(ArithmeticProvider& arithmetic_provider,
+                                            SharedMultiplications<T>& mults,
+                                            const std::vector<SharedIntegerMTVector<T>>& requests,
+                                            std::size_t max_batch_size) {
+  mults.senders.resize(requests.size());
+  mults.receivers.resize(requests.size());
+  for (std::size_t request = 0; request < requests.size(); ++request) {
+    register_multiplications_helper<T>(arithmetic_provider, mults.senders[request],
+                                       mults.receivers[request], max_batch_size,
+                                       requests[request].num_groups,
+                                       requests[request].vector_size);
+  }
+}
+
+template <typename T>
+void start_shared_multiplications_helper(SharedMultiplications<T>& mults,
+                                         const std::vector<SharedIntegerMTVector<T>>& requests,
+                                         std::size_t max_batch_size) {
+  for (std::size_t request = 0; request < requests.size(); ++request) {
+    const auto& mts = requests[request];
+    start_multiplications_helper<T>(mults.senders[request], mults.receivers[request],
+                                    max_batch_size, mts.num_groups, mts.b.data(), mts.a.data(),
+                                    mts.vector_size);
+  }
+}
+
+template <typename T>
+void compute_shared_multiplications_helper(SharedMultiplications<T>& mults) {
+  for (std::size_t request = 0; request < mults.senders.size(); ++request) {
+    compute_multiplications_helper<T>(mults.senders[request], mults.receivers[request]);
+  }
+}
+
+template <typename T>
+void finish_shared_mts_helper(SharedMultiplications<T>& mults,
+                              std::vector<SharedIntegerMTVector<T>>& requests,
+                              std::size_t max_batch_size) {
+  for (std::size_t request = 0; request < requests.size(); ++request) {
+    auto& mts = requests[request];
+    finish_mts_helper<T>(mults.senders[request], mults.receivers[request], max_batch_size,
+                         mts.num_groups, mts.c, mts.vector_size);
+  }
+}
+
 void compute_mts_helper_bool_2pc(ENCRYPTO::ObliviousTransfer::ROTSender& ot_sender,
                                  ENCRYPTO::ObliviousTransfer::ROTReceiver& ot_receiver,
                                  BinaryMTVector& bit_mts) {
@@ -220,6 +478,11 @@ struct MTProviderFromOTs::MTProviderFromOTsImpl {
       mult_senders_64_;
   std::vector<std::list<std::unique_ptr<IntegerMultiplicationReceiver<std::uint64_t>>>>
       mult_receivers_64_;
+  std::vector<std::tuple<SharedMultiplications<std::uint8_t>,
+                         SharedMultiplications<std::uint16_t>,
+                         SharedMultiplications<std::uint32_t>,
+                         SharedMultiplications<std::uint64_t>>>
+      shared_mults_;
 };
 
 MTProviderFromOTs::MTProviderFromOTsImpl::MTProviderFromOTsImpl(std::size_t num_parties)
@@ -232,7 +495,8 @@ MTProviderFromOTs::MTProviderFromOTsImpl::MTProviderFromOTsImpl(std::size_t num_
       mult_senders_32_(num_parties),
       mult_receivers_32_(num_parties),
       mult_senders_64_(num_parties),
-      mult_receivers_64_(num_parties) {}
+      mult_receivers_64_(num_parties),
+      shared_mults_(num_parties) {}
 
 MTProviderFromOTs::MTProviderFromOTs(std::size_t my_id, std::size_t num_parties,
                                      ArithmeticProviderManager& arithmetic_manager,
@@ -265,6 +529,9 @@ void MTProviderFromOTs::PreSetup() {
   }
   run_time_stats_.record_start<Statistics::RunTimeStats::StatID::mt_presetup>();
 
+  // only generate the triples which are not in the reservoir
+  TakeFromReservoir();
+
   if (!use_2pc_) {
     generate_random_triples_bool(bit_mts_, num_bit_mts_);
   }
@@ -272,6 +539,10 @@ void MTProviderFromOTs::PreSetup() {
   generate_random_triples<std::uint16_t>(mts16_, num_mts_16_);
   generate_random_triples<std::uint32_t>(mts32_, num_mts_32_);
   generate_random_triples<std::uint64_t>(mts64_, num_mts_64_);
+  generate_random_shared_triples(GetSharedMTs<std::uint8_t>());
+  generate_random_shared_triples(GetSharedMTs<std::uint16_t>());
+  generate_random_shared_triples(GetSharedMTs<std::uint32_t>());
+  generate_random_shared_triples(GetSharedMTs<std::uint64_t>());
 
   for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
     if (party_id == my_id_) {
@@ -301,6 +572,16 @@ void MTProviderFromOTs::PreSetup() {
     register_multiplications_helper<std::uint64_t>(
         arithmetic_manager_.get_provider(party_id), impl_->mult_senders_64_.at(party_id),
         impl_->mult_receivers_64_.at(party_id), max_batch_size_, num_mts_64_);
+    auto& shared_mults = impl_->shared_mults_.at(party_id);
+    auto& arithmetic_provider = arithmetic_manager_.get_provider(party_id);
+    register_shared_multiplications_helper(arithmetic_provider, std::get<0>(shared_mults),
+                                           GetSharedMTs<std::uint8_t>(), max_batch_size_);
+    register_shared_multiplications_helper(arithmetic_provider, std::get<1>(shared_mults),
+                                           GetSharedMTs<std::uint16_t>(), max_batch_size_);
+    register_shared_multiplications_helper(arithmetic_provider, std::get<2>(shared_mults),
+                                           GetSharedMTs<std::uint32_t>(), max_batch_size_);
+    register_shared_multiplications_helper(arithmetic_provider, std::get<3>(shared_mults),
+                                           GetSharedMTs<std::uint64_t>(), max_batch_size_);
   }
 
   run_time_stats_.record_end<Statistics::RunTimeStats::StatID::mt_presetup>();
@@ -336,16 +617,29 @@ void MTProviderFromOTs::Setup() {
       }
       start_multiplications_helper<std::uint8_t>(impl_->mult_senders_8_.at(party_id),
                                                  impl_->mult_receivers_8_.at(party_id),
-                                                 max_batch_size_, num_mts_8_, mts8_);
+                                                 max_batch_size_, num_mts_8_, mts8_.a.data(),
+                                                 mts8_.b.data());
       start_multiplications_helper<std::uint16_t>(impl_->mult_senders_16_.at(party_id),
                                                   impl_->mult_receivers_16_.at(party_id),
-                                                  max_batch_size_, num_mts_16_, mts16_);
+                                                  max_batch_size_, num_mts_16_, mts16_.a.data(),
+                                                  mts16_.b.data());
       start_multiplications_helper<std::uint32_t>(impl_->mult_senders_32_.at(party_id),
                                                   impl_->mult_receivers_32_.at(party_id),
-                                                  max_batch_size_, num_mts_32_, mts32_);
+                                                  max_batch_size_, num_mts_32_, mts32_.a.data(),
+                                                  mts32_.b.data());
       start_multiplications_helper<std::uint64_t>(impl_->mult_senders_64_.at(party_id),
                                                   impl_->mult_receivers_64_.at(party_id),
-                                                  max_batch_size_, num_mts_64_, mts64_);
+                                                  max_batch_size_, num_mts_64_, mts64_.a.data(),
+                                                  mts64_.b.data());
+      auto& shared_mults = impl_->shared_mults_.at(party_id);
+      start_shared_multiplications_helper(std::get<0>(shared_mults),
+                                          GetSharedMTs<std::uint8_t>(), max_batch_size_);
+      start_shared_multiplications_helper(std::get<1>(shared_mults),
+                                          GetSharedMTs<std::uint16_t>(), max_batch_size_);
+      start_shared_multiplications_helper(std::get<2>(shared_mults),
+                                          GetSharedMTs<std::uint32_t>(), max_batch_size_);
+      start_shared_multiplications_helper(std::get<3>(shared_mults),
+                                          GetSharedMTs<std::uint64_t>(), max_batch_size_);
 
       // finish the OTs and multiplications
       if (num_bit_mts_ > 0 && !use_2pc_) {
@@ -362,6 +656,8 @@ void MTProviderFromOTs::Setup() {
                                                     impl_->mult_receivers_32_.at(party_id));
       compute_multiplications_helper<std::uint64_t>(impl_->mult_senders_64_.at(party_id),
                                                     impl_->mult_receivers_64_.at(party_id));
+      std::apply([](auto&... mults) { (compute_shared_multiplications_helper(mults), ...); },
+                 shared_mults);
     }));
   }
 
@@ -385,18 +681,29 @@ void MTProviderFromOTs::Setup() {
     }
     finish_mts_helper<std::uint8_t>(impl_->mult_senders_8_.at(party_id),
                                     impl_->mult_receivers_8_.at(party_id), max_batch_size_,
-                                    num_mts_8_, mts8_);
+                                    num_mts_8_, mts8_.c);
     finish_mts_helper<std::uint16_t>(impl_->mult_senders_16_.at(party_id),
                                      impl_->mult_receivers_16_.at(party_id), max_batch_size_,
-                                     num_mts_16_, mts16_);
+                                     num_mts_16_, mts16_.c);
     finish_mts_helper<std::uint32_t>(impl_->mult_senders_32_.at(party_id),
                                      impl_->mult_receivers_32_.at(party_id), max_batch_size_,
-                                     num_mts_32_, mts32_);
+                                     num_mts_32_, mts32_.c);
     finish_mts_helper<std::uint64_t>(impl_->mult_senders_64_.at(party_id),
                                      impl_->mult_receivers_64_.at(party_id), max_batch_size_,
-                                     num_mts_64_, mts64_);
+                                     num_mts_64_, mts64_.c);
+    auto& shared_mults = impl_->shared_mults_.at(party_id);
+    finish_shared_mts_helper(std::get<0>(shared_mults), GetSharedMTs<std::uint8_t>(),
+                             max_batch_size_);
+    finish_shared_mts_helper(std::get<1>(shared_mults), GetSharedMTs<std::uint16_t>(),
+                             max_batch_size_);
+    finish_shared_mts_helper(std::get<2>(shared_mults), GetSharedMTs<std::uint32_t>(),
+                             max_batch_size_);
+    finish_shared_mts_helper(std::get<3>(shared_mults), GetSharedMTs<std::uint64_t>(),
+                             max_batch_size_);
   }
 
+  AppendReservedMTs();
+
   // signal MTs are ready
   {
     std::scoped_lock lock(finished_condition_->GetMutex());
@@ -412,4 +719,138 @@ void MTProviderFromOTs::Setup() {
   }
 }
 
+namespace {
+
+// stream of the fake setup for component (0: a, 1: b, 2: c) of the shares of party_id
+std::size_t fake_mt_stream(std::size_t bit_size, std::size_t party_id, std::size_t component) {
+  return (bit_size << 32) | (3 * party_id + component);
+}
+
+void make_fake_mts_bool(std::size_t my_id, std::size_t num_parties, std::size_t num_mts,
+                        BinaryMTVector& mts) {
+  const auto& generator = get_fake_setup_generator();
+  const auto index = fake_setup_index(FakeSetupStream::mts);
+  ENCRYPTO::BitVector<> a(num_mts), b(num_mts), c(num_mts);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    auto a_i = generator.random_bits(fake_mt_stream(1, party_id, 0), num_mts, index);
+    auto b_i = generator.random_bits(fake_mt_stream(1, party_id, 1), num_mts, index);
+    a ^= a_i;
+    b ^= b_i;
+    if (party_id == my_id) {
+      mts.a = std::move(a_i);
+      mts.b = std::move(b_i);
+    }
+  }
+  // the shares of c of the last party complete the product
+  c = a & b;
+  for (std::size_t party_id = 0; party_id + 1 < num_parties; ++party_id) {
+    auto c_i = generator.random_bits(fake_mt_stream(1, party_id, 2), num_mts, index);
+    c ^= c_i;
+    if (party_id == my_id) {
+      mts.c = std::move(c_i);
+    }
+  }
+  if (my_id + 1 == num_parties) {
+    mts.c = std::move(c);
+  }
+}
+
+template <typename T>
+void make_fake_mts(std::size_t my_id, std::size_t num_parties, std::size_t num_mts,
+                   IntegerMTVector<T>& mts) {
+  const auto& generator = get_fake_setup_generator();
+  const auto index = fake_setup_index(FakeSetupStream::mts);
+  constexpr std::size_t bit_size = 8 * sizeof(T);
+  std::vector<T> a(num_mts, 0), b(num_mts, 0), c(num_mts);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    auto a_i = generator.random_vector<T>(fake_mt_stream(bit_size, party_id, 0), num_mts, index);
+    auto b_i = generator.random_vector<T>(fake_mt_stream(bit_size, party_id, 1), num_mts, index);
+    std::transform(std::begin(a), std::end(a), std::begin(a_i), std::begin(a), std::plus{});
+    std::transform(std::begin(b), std::end(b), std::begin(b_i), std::begin(b), std::plus{});
+    if (party_id == my_id) {
+      mts.a = std::move(a_i);
+      mts.b = std::move(b_i);
+    }
+  }
+  std::transform(std::begin(a), std::end(a), std::begin(b), std::begin(c), std::multiplies{});
+  for (std::size_t party_id = 0; party_id + 1 < num_parties; ++party_id) {
+    auto c_i = generator.random_vector<T>(fake_mt_stream(bit_size, party_id, 2), num_mts, index);
+    std::transform(std::begin(c), std::end(c), std::begin(c_i), std::begin(c), std::minus{});
+    if (party_id == my_id) {
+      mts.c = std::move(c_i);
+    }
+  }
+  if (my_id + 1 == num_parties) {
+    mts.c = std::move(c);
+  }
+}
+
+// the fake shares of the triples of one request of shared triples
+template <typename T>
+void make_fake_shared_mts(std::size_t my_id, std::size_t num_parties, std::size_t request,
+                          SharedIntegerMTVector<T>& mts) {
+  const auto& generator = get_fake_setup_generator();
+  const auto index = fake_setup_index(FakeSetupStream::shared_mts);
+  constexpr std::size_t bit_size = 8 * sizeof(T);
+  const auto stream = [request](std::size_t party_id, std::size_t component) {
+    return (bit_size << 48) | (request << 16) | (3 * party_id + component);
+  };
+  const auto num_mts = mts.num_groups * mts.vector_size;
+  std::vector<T> a(mts.num_groups, 0), b(num_mts, 0), c(num_mts);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    auto a_i = generator.random_vector<T>(stream(party_id, 0), mts.num_groups, index);
+    auto b_i = generator.random_vector<T>(stream(party_id, 1), num_mts, index);
+    std::transform(std::begin(a), std::end(a), std::begin(a_i), std::begin(a), std::plus{});
+    std::transform(std::begin(b), std::end(b), std::begin(b_i), std::begin(b), std::plus{});
+    if (party_id == my_id) {
+      mts.a = std::move(a_i);
+      mts.b = std::move(b_i);
+    }
+  }
+  for (std::size_t i = 0; i < num_mts; ++i) {
+    c[i] = a[i / mts.vector_size] * b[i];
+  }
+  for (std::size_t party_id = 0; party_id + 1 < num_parties; ++party_id) {
+    auto c_i = generator.random_vector<T>(stream(party_id, 2), num_mts, index);
+    std::transform(std::begin(c), std::end(c), std::begin(c_i), std::begin(c), std::minus{});
+    if (party_id == my_id) {
+      mts.c = std::move(c_i);
+    }
+  }
+  if (my_id + 1 == num_parties) {
+    mts.c = std::move(c);
+  }
+}
+
+template <typename T>
+void make_fake_shared_mts(std::size_t my_id, std::size_t num_parties,
+                          std::vector<SharedIntegerMTVector<T>>& requests) {
+  for (std::size_t request = 0; request < requests.size(); ++request) {
+    make_fake_shared_mts<T>(my_id, num_parties, request, requests[request]);
+  }
+}
+
+}  // namespace
+
+FakeMTProvider::FakeMTProvider(std::size_t my_id, std::size_t num_parties)
+    : MTProvider(my_id, num_parties) {}
+
+void FakeMTProvider::Setup() {
+  make_fake_mts_bool(my_id_, num_parties_, num_bit_mts_, bit_mts_);
+  make_fake_mts<std::uint8_t>(my_id_, num_parties_, num_mts_8_, mts8_);
+  make_fake_mts<std::uint16_t>(my_id_, num_parties_, num_mts_16_, mts16_);
+  make_fake_mts<std::uint32_t>(my_id_, num_parties_, num_mts_32_, mts32_);
+  make_fake_mts<std::uint64_t>(my_id_, num_parties_, num_mts_64_, mts64_);
+  make_fake_shared_mts(my_id_, num_parties_, GetSharedMTs<std::uint8_t>());
+  make_fake_shared_mts(my_id_, num_parties_, GetSharedMTs<std::uint16_t>());
+  make_fake_shared_mts(my_id_, num_parties_, GetSharedMTs<std::uint32_t>());
+  make_fake_shared_mts(my_id_, num_parties_, GetSharedMTs<std::uint64_t>());
+
+  {
+    std::scoped_lock lock(finished_condition_->GetMutex());
+    finished_ = true;
+  }
+  finished_condition_->NotifyAll();
+}
+
 }  // namespace MOTION
@@ -24,10 +24,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <list>
+#include <span>
+#include <tuple>
 
 #include "crypto/oblivious_transfer/ot_provider.h"
 #include "utility/bit_vector.h"
+#include "utility/construction_scope.h"
 #include "utility/fiber_condition.h"
 #include "utility/helpers.h"
 
@@ -45,10 +50,127 @@ struct IntegerMTVector {
   std::vector<T> a, b, c;  // c[i] = a[i] * b[i]
 };
 
+// view on a range of an IntegerMTVector without copying the triples
+template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+struct IntegerMTSpan {
+  std::span<const T> a, b, c;
+};
+
+// num_groups groups of vector_size triples in which the triples of group i share the multiplicand
+// a[i], i.e., c[i * vector_size + j] = a[i] * b[i * vector_size + j], e.g., for multiplying one
+// secret weight or pattern character with many values.  They are generated with bit_size ACOTs
+// per a[i] whose correlations are vectors of length vector_size, i.e., with a vector_size-th of
+// the OTs of as many independent triples.
+template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+struct SharedIntegerMTVector {
+  std::size_t num_groups{0};
+  std::size_t vector_size{1};
+  std::vector<T> a, b, c;
+};
+
 struct BinaryMTVector {
   ENCRYPTO::BitVector<> a, b, c;  // c[i] = a[i] ^ b[i]
 };
 
+class MTProvider;
+
+// Pool of multiplication triples which are generated ahead of demand, e.g., in the idle time
+// between two circuits, and which outlives the MTProviders of the single circuits.  An MTProvider
+// takes its triples from the front of the pool first and only generates the remaining ones.  The
+// triples are kept in FIFO order s.t. the shares of both parties stay aligned if they fill and use
+// their pools in the same way.  The triples in all reservoirs are counted in the
+// motion_mt_reservoir_size gauge of the MetricsRegistry.
+class MTReservoir {
+ public:
+  MTReservoir() = default;
+  ~MTReservoir();
+
+  // number of triples of type T to keep in the pool (bool for binary triples), 0 by default
+  template <typename T>
+  void SetCapacity(std::size_t capacity) noexcept {
+    GetPool<T>().capacity_ = capacity;
+  }
+  template <typename T>
+  std::size_t GetCapacity() const noexcept {
+    return GetPool<T>().capacity_;
+  }
+  template <typename T>
+  std::size_t GetSize() const noexcept {
+    return GetPool<T>().size();
+  }
+  // number of triples of type T which are missing to fill the pool
+  template <typename T>
+  std::size_t GetNumMissing() const noexcept {
+    const auto& pool = GetPool<T>();
+    return pool.capacity_ - std::min(pool.capacity_, pool.size());
+  }
+
+  // remove up to num_mts triples from the front of the pool
+  BinaryMTVector TakeBinary(std::size_t num_mts);
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  IntegerMTVector<T> TakeInteger(std::size_t num_mts);
+
+  // append triples to the back of the pool
+  void AddBinary(const BinaryMTVector& mts);
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  void AddInteger(const IntegerMTVector<T>& mts);
+  // append all triples generated by the provider
+  void Add(const MTProvider& mt_provider);
+
+ private:
+  template <typename MTVector>
+  struct Pool {
+    std::size_t size() const noexcept {
+      if constexpr (std::is_same_v<MTVector, BinaryMTVector>) {
+        return mts_.a.GetSize() - head_;
+      } else {
+        return mts_.a.size() - head_;
+      }
+    }
+    MTVector mts_;
+    // triples [0, head_) of mts_ have already been taken
+    std::size_t head_{0};
+    std::size_t capacity_{0};
+  };
+
+  template <typename T>
+  auto& GetPool() noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+      return bit_mts_;
+    } else if constexpr (std::is_same_v<T, std::uint8_t>) {
+      return mts8_;
+    } else if constexpr (std::is_same_v<T, std::uint16_t>) {
+      return mts16_;
+    } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+      return mts32_;
+    } else {
+      static_assert(std::is_same_v<T, std::uint64_t>, "unknown type");
+      return mts64_;
+    }
+  }
+  template <typename T>
+  const auto& GetPool() const noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+      return bit_mts_;
+    } else if constexpr (std::is_same_v<T, std::uint8_t>) {
+      return mts8_;
+    } else if constexpr (std::is_same_v<T, std::uint16_t>) {
+      return mts16_;
+    } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+      return mts32_;
+    } else {
+      static_assert(std::is_same_v<T, std::uint64_t>, "unknown type");
+      return mts64_;
+    }
+  }
+
+  Pool<BinaryMTVector> bit_mts_;
+  Pool<IntegerMTVector<std::uint8_t>> mts8_;
+  Pool<IntegerMTVector<std::uint16_t>> mts16_;
+  Pool<IntegerMTVector<std::uint32_t>> mts32_;
+  Pool<IntegerMTVector<std::uint64_t>> mts64_;
+};
+
 class MTProvider {
  public:
   virtual ~MTProvider() = default;
@@ -72,10 +194,16 @@ class MTProvider {
     }
   }
 
-  std::size_t RequestBinaryMTs(const std::size_t num_mts) noexcept;
+  // Within a ConstructionScope, the triples are taken from the block of the calling thread, which
+  // has been reported to the request callback when it was reserved.
+  std::size_t RequestBinaryMTs(const std::size_t num_mts);
 
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
-  std::size_t RequestArithmeticMTs(const std::size_t num_mts) noexcept {
+  std::size_t RequestArithmeticMTs(const std::size_t num_mts) {
+    if (auto offset = ConstructionScope::take(
+            typed_construction_counter<T>(ConstructionCounter::mts_8), num_mts)) {
+      return *offset;
+    }
     std::size_t offset;
     if constexpr (std::is_same_v<T, std::uint8_t>) {
       offset = num_mts_8_;
@@ -92,9 +220,28 @@ class MTProvider {
     } else {
       throw std::runtime_error("Unknown type");
     }
+    if (request_callback_) {
+      request_callback_(sizeof(T) * 8, num_mts);
+    }
     return offset;
   }
 
+  // request num_groups groups of vector_size triples sharing a (see SharedIntegerMTVector) and
+  // return the id of the request; these triples are neither taken from the reservoir nor reported
+  // to the request callback
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  std::size_t RequestSharedArithmeticMTs(const std::size_t num_groups,
+                                         const std::size_t vector_size) {
+    if (vector_size == 0) {
+      throw std::invalid_argument("shared triples need a vector size of at least one");
+    }
+    ConstructionScope::require_serial("requests of shared triples");
+    auto& requests = GetSharedMTs<T>();
+    requests.push_back(
+        SharedIntegerMTVector<T>{.num_groups = num_groups, .vector_size = vector_size});
+    return requests.size() - 1;
+  }
+
   // get bits [i, i+n] as vector
   BinaryMTVector GetBinary(const std::size_t offset, const std::size_t n = 1) const;
 
@@ -116,6 +263,16 @@ class MTProvider {
     }
   }
 
+  // get the triples [offset, offset + n) without copying them
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  IntegerMTSpan<T> GetIntegerSpan(const std::size_t offset, const std::size_t n) const noexcept {
+    const auto& mts = GetIntegerAll<T>();
+    assert(offset + n <= mts.a.size());
+    return IntegerMTSpan<T>{std::span<const T>(mts.a.data() + offset, n),
+                            std::span<const T>(mts.b.data() + offset, n),
+                            std::span<const T>(mts.c.data() + offset, n)};
+  }
+
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
   const IntegerMTVector<T>& GetIntegerAll() const noexcept {
     WaitFinished();
@@ -132,9 +289,26 @@ class MTProvider {
     }
   }
 
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  const SharedIntegerMTVector<T>& GetSharedInteger(const std::size_t request) const {
+    WaitFinished();
+    return GetSharedMTs<T>().at(request);
+  }
+
   virtual void PreSetup() = 0;
   virtual void Setup() = 0;
 
+  // take the requested triples from the reservoir as far as available instead of generating them
+  // (set before PreSetup())
+  void SetReservoir(MTReservoir* reservoir) noexcept { reservoir_ = reservoir; }
+
+  // called with the bit size (1 for binary triples) and the number of triples of every request,
+  // e.g., to generate them in the background while the circuit is still being built
+  using RequestCallback = std::function<void(std::size_t bit_size, std::size_t num_mts)>;
+  void SetRequestCallback(RequestCallback callback) noexcept {
+    request_callback_ = std::move(callback);
+  }
+
   // blocking wait
   void WaitFinished() const { finished_condition_->Wait(); }
 
@@ -142,6 +316,12 @@ class MTProvider {
   MTProvider(std::size_t my_id, std::size_t num_parties);
   MTProvider() = delete;
 
+  // move the available triples from the reservoir aside and decrease the number of triples to
+  // generate accordingly
+  void TakeFromReservoir();
+  // append the triples taken from the reservoir to the generated ones
+  void AppendReservedMTs();
+
   std::size_t num_bit_mts_{0}, num_mts_8_{0}, num_mts_16_{0}, num_mts_32_{0}, num_mts_64_{0};
 
   BinaryMTVector bit_mts_;
@@ -151,12 +331,36 @@ class MTProvider {
   IntegerMTVector<std::uint32_t> mts32_;
   IntegerMTVector<std::uint64_t> mts64_;
 
+  // requests of shared triples of each type
+  template <typename T>
+  std::vector<SharedIntegerMTVector<T>>& GetSharedMTs() noexcept {
+    return std::get<std::vector<SharedIntegerMTVector<T>>>(shared_mts_);
+  }
+  template <typename T>
+  const std::vector<SharedIntegerMTVector<T>>& GetSharedMTs() const noexcept {
+    return std::get<std::vector<SharedIntegerMTVector<T>>>(shared_mts_);
+  }
+  std::tuple<std::vector<SharedIntegerMTVector<std::uint8_t>>,
+             std::vector<SharedIntegerMTVector<std::uint16_t>>,
+             std::vector<SharedIntegerMTVector<std::uint32_t>>,
+             std::vector<SharedIntegerMTVector<std::uint64_t>>>
+      shared_mts_;
+
   const std::size_t my_id_;
   const std::size_t num_parties_;
 
   std::atomic<bool> finished_{false};
   std::shared_ptr<ENCRYPTO::FiberCondition> finished_condition_;
 
+  MTReservoir* reservoir_{nullptr};
+  RequestCallback request_callback_;
+  // triples taken from the reservoir which are appended after the generated ones
+  BinaryMTVector reserved_bit_mts_;
+  IntegerMTVector<std::uint8_t> reserved_mts8_;
+  IntegerMTVector<std::uint16_t> reserved_mts16_;
+  IntegerMTVector<std::uint32_t> reserved_mts32_;
+  IntegerMTVector<std::uint64_t> reserved_mts64_;
+
  private:
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
   inline IntegerMTVector<T> GetInteger(const IntegerMTVector<T>& mts, const std::size_t offset,
@@ -165,9 +369,9 @@ class MTProvider {
     assert(mts.c.size() == mts.b.size());
     assert(offset + n <= mts.a.size());
 
-    return IntegerMTVector<T>{std::vector<T>(mts.a.begin() + offset, mts.a.begin + offset + n),
-                              std::vector<T>(mts.b.begin() + offset, mts.b.begin + offset + n),
-                              std::vector<T>(mts.c.begin() + offset, mts.c.begin + offset + n)};
+    return IntegerMTVector<T>{std::vector<T>(mts.a.begin() + offset, mts.a.begin() + offset + n),
+                              std::vector<T>(mts.b.begin() + offset, mts.b.begin() + offset + n),
+                              std::vector<T>(mts.c.begin() + offset, mts.c.begin() + offset + n)};
   }
 };
 
@@ -200,4 +404,14 @@ class MTProviderFromOTs : public MTProvider {
   std::shared_ptr<Logger> logger_;
 };
 
+// triples of the fake setup (see crypto/random/fake_setup.h): all parties derive the shares of all
+// parties from the fixed key without any communication -- insecure, only for benchmarks
+class FakeMTProvider final : public MTProvider {
+ public:
+  FakeMTProvider(std::size_t my_id, std::size_t num_parties);
+
+  void PreSetup() final {}
+  void Setup() final;
+};
+
 }  // namespace MOTION
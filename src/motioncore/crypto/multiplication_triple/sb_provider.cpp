@@ -22,7 +22,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <type_traits>
 #include "communication/communication_layer.h"
@@ -31,6 +33,7 @@
 #include "communication/shared_bits_message.h"
 #include "crypto/oblivious_transfer/ot_flavors.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "crypto/random/fake_setup.h"
 #include "data_storage/shared_bits_data.h"
 #include "sb_impl.h"
 #include "sb_provider.h"
@@ -485,4 +488,227 @@ void TwoPartySBProvider::Setup() {
   }
 }
 
+// ---------- TwoPartySBProviderFromROTs ----------
+
+TwoPartySBProviderFromROTs::TwoPartySBProviderFromROTs(
+    Communication::CommunicationLayer& communication_layer,
+    ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider, Statistics::RunTimeStats& run_time_stats,
+    std::shared_ptr<Logger> logger)
+    : SBProvider(communication_layer.get_my_id()),
+      communication_layer_(communication_layer),
+      ot_provider_(ot_provider),
+      data_(std::make_unique<SharedBitsData>()),
+      run_time_stats_(run_time_stats),
+      logger_(std::move(logger)) {
+  if (communication_layer.get_num_parties() != 2) {
+    throw std::logic_error("TwoPartySBProviderFromROTs implements a two-party protocol");
+  }
+  communication_layer_.register_message_handler(
+      [this](std::size_t) { return std::make_shared<SBMessageHandler>(*data_); },
+      {MOTION::Communication::MessageType::SharedBitsMask});
+}
+
+TwoPartySBProviderFromROTs::~TwoPartySBProviderFromROTs() {
+  communication_layer_.deregister_message_handler(
+      {MOTION::Communication::MessageType::SharedBitsMask});
+}
+
+template <typename T>
+static std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTSender> rot_setup_sender_register(
+    std::size_t num_sbs, ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider,
+    std::vector<T>& sbs) {
+  if (num_sbs == 0) {
+    return nullptr;
+  }
+  sbs.resize(num_sbs);
+  return ot_provider.RegisterSendROT(num_sbs, 8 * sizeof(T), true);
+}
+
+template <typename T>
+static std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTReceiver> rot_setup_receiver_register(
+    std::size_t num_sbs, ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider,
+    std::vector<T>& sbs) {
+  if (num_sbs == 0) {
+    return nullptr;
+  }
+  sbs.resize(num_sbs);
+  return ot_provider.RegisterReceiveROT(num_sbs, 8 * sizeof(T), true);
+}
+
+void TwoPartySBProviderFromROTs::PreSetup() {
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("TwoPartySBProviderFromROTs::PreSetup start");
+    }
+  }
+  run_time_stats_.record_start<Statistics::RunTimeStats::StatID::sb_presetup>();
+
+  if (my_id_ == 0) {
+    rot_sender_8_ = rot_setup_sender_register(num_sbs_8_, ot_provider_, sbs_8_);
+    rot_sender_16_ = rot_setup_sender_register(num_sbs_16_, ot_provider_, sbs_16_);
+    rot_sender_32_ = rot_setup_sender_register(num_sbs_32_, ot_provider_, sbs_32_);
+    rot_sender_64_ = rot_setup_sender_register(num_sbs_64_, ot_provider_, sbs_64_);
+  } else {
+    rot_receiver_8_ = rot_setup_receiver_register(num_sbs_8_, ot_provider_, sbs_8_);
+    rot_receiver_16_ = rot_setup_receiver_register(num_sbs_16_, ot_provider_, sbs_16_);
+    rot_receiver_32_ = rot_setup_receiver_register(num_sbs_32_, ot_provider_, sbs_32_);
+    rot_receiver_64_ = rot_setup_receiver_register(num_sbs_64_, ot_provider_, sbs_64_);
+    if (NeedSBs()) {
+      mask_message_future_ = data_->RegisterForMaskMessage(
+          num_sbs_8_ * sizeof(std::uint8_t) + num_sbs_16_ * sizeof(std::uint16_t) +
+          num_sbs_32_ * sizeof(std::uint32_t) + num_sbs_64_ * sizeof(std::uint64_t));
+    }
+  }
+
+  run_time_stats_.record_end<Statistics::RunTimeStats::StatID::sb_presetup>();
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("TwoPartySBProviderFromROTs::PreSetup end");
+    }
+  }
+}
+
+// copy the ROT outputs of the whole batch, each of them is one element of T
+template <typename T>
+static std::vector<T> rot_outputs_to_vector(const ENCRYPTO::BitVector<>& outputs,
+                                            std::size_t num_sbs) {
+  assert(outputs.GetSize() == num_sbs * 8 * sizeof(T));
+  std::vector<T> result(num_sbs);
+  std::memcpy(result.data(), outputs.GetData().data(), num_sbs * sizeof(T));
+  return result;
+}
+
+// compute P0's shares r + 2 m_0 and append the corrections d = m_0 - m_1 + r to the message
+template <typename T>
+static void rot_setup_sender(std::size_t num_sbs,
+                             ENCRYPTO::ObliviousTransfer::ROTSender* rot_sender,
+                             std::vector<T>& sbs, std::vector<std::uint8_t>& message) {
+  if (num_sbs == 0) {
+    return;
+  }
+  rot_sender->ComputeOutputs();
+  auto [m0_outputs, m1_outputs] = rot_sender->GetOutputs();
+  const auto m0s = rot_outputs_to_vector<T>(m0_outputs, num_sbs);
+  const auto m1s = rot_outputs_to_vector<T>(m1_outputs, num_sbs);
+  const auto rs = ENCRYPTO::BitVector<>::Random(num_sbs);
+  std::vector<T> ds(num_sbs);
+  for (std::size_t sb_i = 0; sb_i < num_sbs; ++sb_i) {
+    const T r = rs.Get(sb_i);
+    ds[sb_i] = m0s[sb_i] - m1s[sb_i] + r;
+    sbs[sb_i] = r + T(2) * m0s[sb_i];
+  }
+  const auto offset = message.size();
+  message.resize(offset + num_sbs * sizeof(T));
+  std::memcpy(message.data() + offset, ds.data(), num_sbs * sizeof(T));
+}
+
+// compute P1's shares c - 2 (m_c + c d) with the corrections read from the message
+template <typename T>
+static void rot_setup_receiver(std::size_t num_sbs,
+                               ENCRYPTO::ObliviousTransfer::ROTReceiver* rot_receiver,
+                               std::vector<T>& sbs, const std::vector<std::uint8_t>& message,
+                               std::size_t& message_offset) {
+  if (num_sbs == 0) {
+    return;
+  }
+  rot_receiver->ComputeOutputs();
+  const auto& choices = rot_receiver->GetChoices();
+  const auto mcs = rot_outputs_to_vector<T>(rot_receiver->GetOutputs(), num_sbs);
+  std::vector<T> ds(num_sbs);
+  assert(message_offset + num_sbs * sizeof(T) <= message.size());
+  std::memcpy(ds.data(), message.data() + message_offset, num_sbs * sizeof(T));
+  message_offset += num_sbs * sizeof(T);
+  for (std::size_t sb_i = 0; sb_i < num_sbs; ++sb_i) {
+    const T c = choices.Get(sb_i);
+    sbs[sb_i] = c - T(2) * (mcs[sb_i] + c * ds[sb_i]);
+  }
+}
+
+void TwoPartySBProviderFromROTs::Setup() {
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("TwoPartySBProviderFromROTs::Setup start");
+    }
+  }
+  run_time_stats_.record_start<Statistics::RunTimeStats::StatID::sb_setup>();
+
+  if (NeedSBs()) {
+    if (my_id_ == 0) {
+      std::vector<std::uint8_t> message;
+      message.reserve(num_sbs_8_ * sizeof(std::uint8_t) + num_sbs_16_ * sizeof(std::uint16_t) +
+                      num_sbs_32_ * sizeof(std::uint32_t) + num_sbs_64_ * sizeof(std::uint64_t));
+      rot_setup_sender(num_sbs_8_, rot_sender_8_.get(), sbs_8_, message);
+      rot_setup_sender(num_sbs_16_, rot_sender_16_.get(), sbs_16_, message);
+      rot_setup_sender(num_sbs_32_, rot_sender_32_.get(), sbs_32_, message);
+      rot_setup_sender(num_sbs_64_, rot_sender_64_.get(), sbs_64_, message);
+      communication_layer_.send_message(1, Communication::BuildSharedBitsMaskMessage(message));
+    } else {
+      const auto message = mask_message_future_.get();
+      std::size_t offset = 0;
+      rot_setup_receiver(num_sbs_8_, rot_receiver_8_.get(), sbs_8_, message, offset);
+      rot_setup_receiver(num_sbs_16_, rot_receiver_16_.get(), sbs_16_, message, offset);
+      rot_setup_receiver(num_sbs_32_, rot_receiver_32_.get(), sbs_32_, message, offset);
+      rot_setup_receiver(num_sbs_64_, rot_receiver_64_.get(), sbs_64_, message, offset);
+    }
+  }
+
+  {
+    std::scoped_lock lock(finished_condition_->GetMutex());
+    finished_ = true;
+  }
+  finished_condition_->NotifyAll();
+
+  run_time_stats_.record_end<Statistics::RunTimeStats::StatID::sb_setup>();
+  if constexpr (MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("TwoPartySBProviderFromROTs::Setup end");
+    }
+  }
+}
+
+namespace {
+
+template <typename T>
+void make_fake_sbs(std::size_t my_id, std::size_t num_parties, std::size_t num_sbs,
+                   std::vector<T>& sbs) {
+  const auto& generator = get_fake_setup_generator();
+  const auto index = fake_setup_index(FakeSetupStream::sbs);
+  // stream party_id for the shares of party_id, stream num_parties for the shared bits
+  constexpr std::size_t bit_size = 8 * sizeof(T);
+  const auto bits = generator.random_bits((bit_size << 32) | num_parties, num_sbs, index);
+  std::vector<T> last_share(num_sbs);
+  for (std::size_t sb_i = 0; sb_i < num_sbs; ++sb_i) {
+    last_share[sb_i] = bits.Get(sb_i);
+  }
+  for (std::size_t party_id = 0; party_id + 1 < num_parties; ++party_id) {
+    auto share = generator.random_vector<T>((bit_size << 32) | party_id, num_sbs, index);
+    std::transform(std::begin(last_share), std::end(last_share), std::begin(share),
+                   std::begin(last_share), std::minus{});
+    if (party_id == my_id) {
+      sbs = std::move(share);
+    }
+  }
+  if (my_id + 1 == num_parties) {
+    sbs = std::move(last_share);
+  }
+}
+
+}  // namespace
+
+FakeSBProvider::FakeSBProvider(std::size_t my_id, std::size_t num_parties)
+    : SBProvider(my_id), num_parties_(num_parties) {}
+
+void FakeSBProvider::Setup() {
+  make_fake_sbs<std::uint8_t>(my_id_, num_parties_, num_sbs_8_, sbs_8_);
+  make_fake_sbs<std::uint16_t>(my_id_, num_parties_, num_sbs_16_, sbs_16_);
+  make_fake_sbs<std::uint32_t>(my_id_, num_parties_, num_sbs_32_, sbs_32_);
+  make_fake_sbs<std::uint64_t>(my_id_, num_parties_, num_sbs_64_, sbs_64_);
+
+  {
+    std::scoped_lock lock(finished_condition_->GetMutex());
+    finished_ = true;
+  }
+  finished_condition_->NotifyAll();
+}
+
 }  // namespace MOTION
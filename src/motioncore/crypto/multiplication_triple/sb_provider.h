@@ -29,6 +29,7 @@
 #include <type_traits>
 #include <vector>
 
+#include "utility/construction_scope.h"
 #include "utility/fiber_condition.h"
 #include "utility/reusable_future.h"
 
@@ -38,6 +39,8 @@ class ACOTSender;
 template <typename T>
 class ACOTReceiver;
 class OTProvider;
+class ROTSender;
+class ROTReceiver;
 }  // namespace ENCRYPTO::ObliviousTransfer
 
 namespace MOTION {
@@ -78,7 +81,12 @@ class SBProvider {
   }
 
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
-  std::size_t RequestSBs(const std::size_t num_sbs) noexcept {
+  std::size_t RequestSBs(const std::size_t num_sbs) {
+    // within a ConstructionScope, they are taken from the block of the calling thread
+    if (auto offset = ConstructionScope::take(
+            typed_construction_counter<T>(ConstructionCounter::sbs_8), num_sbs)) {
+      return *offset;
+    }
     std::size_t offset;
     if constexpr (std::is_same_v<T, std::uint8_t>) {
       offset = num_sbs_8_;
@@ -228,4 +236,50 @@ class TwoPartySBProvider : public SBProvider {
   std::shared_ptr<Logger> logger_;
 };
 
+// Two-party SBs directly from random OTs with random choices: party 1 keeps its choice bit c and
+// party 0 sends a single correction message per batch, so no correction-then-reply round trip of
+// the ACOTs and no square pairs are needed.  (P0 chooses r and sends d = m_0 - m_1 + r, then
+// r + 2 m_0 and c - 2 (m_c + c d) are shares of r ^ c.)
+class TwoPartySBProviderFromROTs final : public SBProvider {
+ public:
+  TwoPartySBProviderFromROTs(Communication::CommunicationLayer& communication_layer,
+                             ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider,
+                             Statistics::RunTimeStats& run_time_stats,
+                             std::shared_ptr<Logger> logger);
+  ~TwoPartySBProviderFromROTs();
+
+  void PreSetup() final;
+
+  // needs completed OTs
+  void Setup() final;
+
+ private:
+  Communication::CommunicationLayer& communication_layer_;
+  ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider_;
+  std::unique_ptr<SharedBitsData> data_;
+  ENCRYPTO::ReusableFuture<std::vector<std::uint8_t>> mask_message_future_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTSender> rot_sender_8_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTReceiver> rot_receiver_8_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTSender> rot_sender_16_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTReceiver> rot_receiver_16_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTSender> rot_sender_32_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTReceiver> rot_receiver_32_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTSender> rot_sender_64_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ROTReceiver> rot_receiver_64_;
+  Statistics::RunTimeStats& run_time_stats_;
+  std::shared_ptr<Logger> logger_;
+};
+
+// shared bits of the fake setup (see crypto/random/fake_setup.h), insecure
+class FakeSBProvider final : public SBProvider {
+ public:
+  FakeSBProvider(std::size_t my_id, std::size_t num_parties);
+
+  void PreSetup() final {}
+  void Setup() final;
+
+ private:
+  const std::size_t num_parties_;
+};
+
 }  // namespace MOTION
@@ -23,6 +23,7 @@
 // SOFTWARE.
 
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "crypto/random/fake_setup.h"
 #include "sp_provider.h"
 #include "statistics/run_time_stats.h"
 #include "utility/constants.h"
@@ -275,4 +276,53 @@ void SPProviderFromOTs::ParseOutputs() {
   }
 }
 
+namespace {
+
+template <typename T>
+void make_fake_sps(std::size_t my_id, std::size_t num_parties, std::size_t num_sps,
+                   SPVector<T>& sps) {
+  const auto& generator = get_fake_setup_generator();
+  const auto index = fake_setup_index(FakeSetupStream::sps);
+  // streams: 2 * party_id for the shares of a, 2 * party_id + 1 for the shares of c
+  constexpr std::size_t bit_size = 8 * sizeof(T);
+  std::vector<T> a(num_sps, 0), c(num_sps);
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    auto a_i = generator.random_vector<T>((bit_size << 32) | (2 * party_id), num_sps, index);
+    std::transform(std::begin(a), std::end(a), std::begin(a_i), std::begin(a), std::plus{});
+    if (party_id == my_id) {
+      sps.a = std::move(a_i);
+    }
+  }
+  std::transform(std::begin(a), std::end(a), std::begin(c), [](T x) { return T(x * x); });
+  for (std::size_t party_id = 0; party_id + 1 < num_parties; ++party_id) {
+    auto c_i = generator.random_vector<T>((bit_size << 32) | (2 * party_id + 1), num_sps, index);
+    std::transform(std::begin(c), std::end(c), std::begin(c_i), std::begin(c), std::minus{});
+    if (party_id == my_id) {
+      sps.c = std::move(c_i);
+    }
+  }
+  if (my_id + 1 == num_parties) {
+    sps.c = std::move(c);
+  }
+}
+
+}  // namespace
+
+FakeSPProvider::FakeSPProvider(std::size_t my_id, std::size_t num_parties)
+    : SPProvider(my_id), num_parties_(num_parties) {}
+
+void FakeSPProvider::Setup() {
+  make_fake_sps<std::uint8_t>(my_id_, num_parties_, num_sps_8_, sps_8_);
+  make_fake_sps<std::uint16_t>(my_id_, num_parties_, num_sps_16_, sps_16_);
+  make_fake_sps<std::uint32_t>(my_id_, num_parties_, num_sps_32_, sps_32_);
+  make_fake_sps<std::uint64_t>(my_id_, num_parties_, num_sps_64_, sps_64_);
+  make_fake_sps<__uint128_t>(my_id_, num_parties_, num_sps_128_, sps_128_);
+
+  {
+    std::scoped_lock lock(finished_condition_->GetMutex());
+    finished_ = true;
+  }
+  finished_condition_->NotifyAll();
+}
+
 }  // namespace MOTION
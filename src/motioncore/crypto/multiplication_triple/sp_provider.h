@@ -31,6 +31,7 @@
 #include <type_traits>
 #include <vector>
 
+#include "utility/construction_scope.h"
 #include "utility/fiber_condition.h"
 
 namespace ENCRYPTO {
@@ -80,7 +81,12 @@ class SPProvider {
   }
 
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
-  std::size_t RequestSPs(const std::size_t num_sps) noexcept {
+  std::size_t RequestSPs(const std::size_t num_sps) {
+    // within a ConstructionScope, they are taken from the block of the calling thread
+    if (auto offset = ConstructionScope::take(
+            typed_construction_counter<T>(ConstructionCounter::sps_8), num_sps)) {
+      return *offset;
+    }
     std::size_t offset;
     if constexpr (std::is_same_v<T, std::uint8_t>) {
       offset = num_sps_8_;
@@ -202,4 +208,16 @@ class SPProviderFromOTs final : public SPProvider {
   Statistics::RunTimeStats& run_time_stats_;
 };
 
+// square pairs of the fake setup (see crypto/random/fake_setup.h), insecure
+class FakeSPProvider final : public SPProvider {
+ public:
+  FakeSPProvider(std::size_t my_id, std::size_t num_parties);
+
+  void PreSetup() final {}
+  void Setup() final;
+
+ private:
+  const std::size_t num_parties_;
+};
+
 }  // namespace MOTION
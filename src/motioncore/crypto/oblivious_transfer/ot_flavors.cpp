@@ -35,20 +35,15 @@ BasicOTSender::BasicOTSender(std::size_t ot_id, std::size_t num_ots, std::size_t
                              const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send,
                              MOTION::OTExtensionSenderData &data)
     : OTVector(ot_id, num_ots, bitlen, p, Send), data_(data) {
-  data_.received_correction_offsets_cond_.emplace(
-      ot_id_, std::make_unique<FiberCondition>([this]() {
-        std::scoped_lock lock(data_.corrections_mutex_);
-        return data_.received_correction_offsets_.find(ot_id_) !=
-               data_.received_correction_offsets_.end();
-      }));
   data_.y0_.resize(data_.y0_.size() + num_ots);
   data_.y1_.resize(data_.y1_.size() + num_ots);
   data_.bitlengths_.resize(data_.bitlengths_.size() + num_ots, bitlen);
   data_.corrections_.Resize(data_.corrections_.GetSize() + num_ots);
-  data_.num_ots_in_batch_.emplace(ot_id, num_ots);
+  data_.batches_.Add(ot_id, num_ots);
 }
 
-void BasicOTSender::WaitSetup() const { data_.setup_finished_cond_->Wait(); }
+// only the OTs of this vector need to be finished
+void BasicOTSender::WaitSetup() const { data_.ots_ready_->WaitUntil(ot_id_ + num_ots_); }
 
 // ---------- BasicOTReceiver ----------
 
@@ -59,15 +54,17 @@ BasicOTReceiver::BasicOTReceiver(std::size_t ot_id, std::size_t num_ots, std::si
     : OTVector(ot_id, num_ots, bitlen, p, Send), data_(data) {
   data_.outputs_.resize(ot_id + num_ots);
   data_.bitlengths_.resize(ot_id + num_ots, bitlen);
-  data_.num_ots_in_batch_.emplace(ot_id, num_ots);
+  data_.batches_.Add(ot_id, num_ots);
 }
 
-void BasicOTReceiver::WaitSetup() const { data_.setup_finished_cond_->Wait(); }
+// only the OTs of this vector need to be finished
+void BasicOTReceiver::WaitSetup() const { data_.ots_ready_->WaitUntil(ot_id_ + num_ots_); }
 
 void BasicOTReceiver::SendCorrections() {
   if (choices_.Empty()) {
     throw std::runtime_error("Choices in COT must be set before calling SendCorrections()");
   }
+  WaitSetup();
   auto corrections = choices_ ^ data_.random_choices_->Subset(ot_id_, ot_id_ + num_ots_);
   Send_(MOTION::Communication::BuildOTExtensionMessageReceiverCorrections(
       corrections.GetData().data(), corrections.GetData().size(), ot_id_));
@@ -94,7 +91,7 @@ void FixedXCOT128Sender::ComputeOutputs() {
   const auto &ot_ext_snd = data_;
 
   // wait until the receiver has sent its correction bits
-  ot_ext_snd.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  ot_ext_snd.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
 
   // make space for all the OTs
   outputs_.resize(num_ots_);
@@ -119,6 +116,7 @@ void FixedXCOT128Sender::ComputeOutputs() {
 }
 
 void FixedXCOT128Sender::SendMessages() const {
+  WaitSetup();
   block128_vector buffer(num_ots_, correlation_);
   const auto &ot_ext_snd = data_;
   for (std::size_t i = 0; i < num_ots_; ++i) {
@@ -135,7 +133,7 @@ FixedXCOT128Receiver::FixedXCOT128Receiver(
     const std::size_t ot_id, const std::size_t num_ots, MOTION::OTExtensionReceiverData &data,
     const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
     : BasicOTReceiver(ot_id, num_ots, 128, FixedXCOT128, Send, data), outputs_(num_ots) {
-  data_.msg_type_.emplace(ot_id, MOTION::OTMsgType::block128);
+  data_.batches_.Get(ot_id).msg_type_ = MOTION::OTMsgType::block128;
   sender_message_future_ = data_.RegisterForBlock128SenderMessage(ot_id, num_ots);
 }
 
@@ -176,7 +174,7 @@ void XCOTBitSender::ComputeOutputs() {
   WaitSetup();
 
   // wait until the receiver has sent its correction bits
-  data_.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  data_.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
 
   // get the corrections bits
   std::unique_lock lock(data_.corrections_mutex_);
@@ -216,6 +214,7 @@ void XCOTBitSender::ComputeOutputs() {
 }
 
 void XCOTBitSender::SendMessages() const {
+  WaitSetup();
   ENCRYPTO::BitVector<> buffer = correlations_;
   if (vector_size_ == 1) {
     for (std::size_t i = 0; i < num_ots_; ++i) {
@@ -246,7 +245,7 @@ XCOTBitReceiver::XCOTBitReceiver(const std::size_t ot_id, const std::size_t num_
                                  MOTION::OTExtensionReceiverData& data,
                                  const std::function<void(flatbuffers::FlatBufferBuilder&&)>& Send)
     : BasicOTReceiver(ot_id, num_ots, vector_size, XCOTBit, Send, data), vector_size_(vector_size) {
-  data_.msg_type_.emplace(ot_id, MOTION::OTMsgType::bit);
+  data_.batches_.Get(ot_id).msg_type_ = MOTION::OTMsgType::bit;
   sender_message_future_ = data_.RegisterForBitSenderMessage(ot_id, num_ots * vector_size_);
 }
 
@@ -303,7 +302,7 @@ void ACOTSender<T>::ComputeOutputs() {
   WaitSetup();
 
   // wait until the receiver has sent its correction bits
-  data_.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  data_.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
 
   // make space for all the OTs
   outputs_.resize(num_ots_ * vector_size_);
@@ -342,6 +341,7 @@ void ACOTSender<T>::ComputeOutputs() {
 
 template <typename T>
 void ACOTSender<T>::SendMessages() const {
+  WaitSetup();
   auto buffer = correlations_;
   if (vector_size_ == 1) {
     for (std::size_t ot_i = 0; ot_i < num_ots_; ++ot_i) {
@@ -377,7 +377,7 @@ ACOTReceiver<T>::ACOTReceiver(const std::size_t ot_id, const std::size_t num_ots
       boost::hana::make_pair(boost::hana::type_c<std::uint32_t>, MOTION::OTMsgType::uint32),
       boost::hana::make_pair(boost::hana::type_c<std::uint64_t>, MOTION::OTMsgType::uint64),
       boost::hana::make_pair(boost::hana::type_c<__uint128_t>, MOTION::OTMsgType::uint128));
-  data_.msg_type_.emplace(ot_id, int_type_to_msg_type[boost::hana::type_c<T>]);
+  data_.batches_.Get(ot_id).msg_type_ = int_type_to_msg_type[boost::hana::type_c<T>];
   sender_message_future_ = data_.RegisterForIntSenderMessage<T>(ot_id, num_ots * vector_size);
 }
 
@@ -444,10 +444,11 @@ GOT128Sender::GOT128Sender(std::size_t ot_id, std::size_t num_ots,
     : BasicOTSender(ot_id, num_ots, 128, GOT, Send, data) {}
 
 void GOT128Sender::SendMessages() const {
+  WaitSetup();
   block128_vector buffer = std::move(inputs_);
 
   const auto &ot_ext_snd = data_;
-  ot_ext_snd.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  ot_ext_snd.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
   std::unique_lock lock(ot_ext_snd.corrections_mutex_);
   const auto corrections = ot_ext_snd.corrections_.Subset(ot_id_, ot_id_ + num_ots_);
   lock.unlock();
@@ -472,7 +473,7 @@ GOT128Receiver::GOT128Receiver(const std::size_t ot_id, const std::size_t num_ot
                                MOTION::OTExtensionReceiverData &data,
                                const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
     : BasicOTReceiver(ot_id, num_ots, 128, FixedXCOT128, Send, data), outputs_(num_ots) {
-  data_.msg_type_.emplace(ot_id, MOTION::OTMsgType::block128);
+  data_.batches_.Get(ot_id).msg_type_ = MOTION::OTMsgType::block128;
   sender_message_future_ = data_.RegisterForBlock128SenderMessage(ot_id, 2 * num_ots);
 }
 
@@ -508,10 +509,11 @@ GOTBitSender::GOTBitSender(std::size_t ot_id, std::size_t num_ots,
     : BasicOTSender(ot_id, num_ots, 1, GOT, Send, data) {}
 
 void GOTBitSender::SendMessages() const {
+  WaitSetup();
   auto buffer = std::move(inputs_);
 
   const auto &ot_ext_snd = data_;
-  ot_ext_snd.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  ot_ext_snd.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
   std::unique_lock lock(ot_ext_snd.corrections_mutex_);
   const auto corrections = ot_ext_snd.corrections_.Subset(ot_id_, ot_id_ + num_ots_);
   lock.unlock();
@@ -537,7 +539,7 @@ GOTBitReceiver::GOTBitReceiver(const std::size_t ot_id, const std::size_t num_ot
                                MOTION::OTExtensionReceiverData &data,
                                const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
     : BasicOTReceiver(ot_id, num_ots, 1, GOT, Send, data), outputs_(num_ots) {
-  data_.msg_type_.emplace(ot_id, MOTION::OTMsgType::bit);
+  data_.batches_.Get(ot_id).msg_type_ = MOTION::OTMsgType::bit;
   sender_message_future_ = data_.RegisterForBitSenderMessage(ot_id, 2 * num_ots);
 }
 
@@ -620,6 +622,7 @@ void ROTReceiver::ComputeOutputs() {
     // already done
     return;
   }
+  WaitSetup();
 
   if (random_choice_) {
     choices_ = data_.random_choices_->Subset(ot_id_, ot_id_ + num_ots_);
@@ -24,6 +24,9 @@
 
 #include "ot_provider.h"
 
+#include <chrono>
+#include <string>
+
 #include "communication/communication_layer.h"
 #include "communication/fbs_headers/ot_extension_generated.h"
 #include "communication/message_handler.h"
@@ -31,17 +34,68 @@
 #include "crypto/base_ots/base_ot_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/pseudo_random_generator.h"
+#include "crypto/random/fake_setup.h"
 #include "data_storage/base_ot_data.h"
 #include "data_storage/ot_extension_data.h"
 #include "ot_flavors.h"
+#include "silent_ot.h"
+#include "statistics/metrics.h"
 #include "statistics/run_time_stats.h"
 #include "utility/bit_matrix.h"
 #include "utility/config.h"
+#include "utility/construction_scope.h"
 #include "utility/fiber_condition.h"
 #include "utility/logger.h"
+#include "utility/thread.h"
 
 namespace ENCRYPTO::ObliviousTransfer {
 
+namespace {
+
+// number of columns of the OT extension matrix which are expanded, transposed and hashed by one
+// thread at a time, s.t. the 128 rows of a range fit into the L2 cache
+constexpr std::size_t ot_extension_range_size = 16 * 1024;
+
+std::size_t get_num_column_ranges(std::size_t num_columns) {
+  return (num_columns + ot_extension_range_size - 1) / ot_extension_range_size;
+}
+
+// <column offset, number of columns> of the i-th range
+std::pair<std::size_t, std::size_t> get_column_range(std::size_t i, std::size_t num_columns) {
+  const auto column_offset = i * ot_extension_range_size;
+  return {column_offset, std::min(ot_extension_range_size, num_columns - column_offset)};
+}
+
+// keeps track of the finished column ranges and raises the number of ready OTs to the end of the
+// longest prefix of finished ranges
+class RangeProgress {
+ public:
+  RangeProgress(std::size_t num_ranges, std::size_t num_ots, FiberCounter &ots_ready)
+      : finished_(num_ranges, false), num_ots_(num_ots), ots_ready_(ots_ready) {}
+
+  void finish(std::size_t range_i) {
+    std::size_t num_ots_ready;
+    {
+      std::scoped_lock lock(mutex_);
+      finished_.at(range_i) = true;
+      while (num_finished_ < finished_.size() && finished_[num_finished_]) {
+        ++num_finished_;
+      }
+      num_ots_ready = std::min(num_finished_ * ot_extension_range_size, num_ots_);
+    }
+    ots_ready_.Raise(num_ots_ready);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<bool> finished_;
+  std::size_t num_finished_ = 0;
+  const std::size_t num_ots_;
+  FiberCounter &ots_ready_;
+};
+
+}  // namespace
+
 OTProvider::OTProvider(std::function<void(flatbuffers::FlatBufferBuilder &&)> Send,
                        MOTION::OTExtensionData &data, std::size_t party_id,
                        std::shared_ptr<MOTION::Logger> logger)
@@ -177,53 +231,62 @@ void OTProviderFromOTExtension::SendSetup() {
     }
     return;  // no OTs needed
   }
-  ot_ext_snd.bit_size_ = bit_size;
-
   // XXX: index variable?
   std::size_t i;
 
-  // bit size of the matrix rounded to bytes
-  // XXX: maybe round to blocks?
-  const std::size_t byte_size = MOTION::Helpers::Convert::BitsToBytes(bit_size);
-
   // bit size rounded to blocks
   const auto bit_size_padded = bit_size + kappa - (bit_size % kappa);
+  const std::size_t num_ranges = get_num_column_ranges(bit_size_padded);
+  // the receiver only transmits the ranges which contain OTs
+  const std::size_t num_u_chunks = get_num_column_ranges(bit_size);
+
+  {
+    std::scoped_lock lock(ot_ext_snd.u_mutex_);
+    if (streaming_setup_) {
+      // the chunks of u are written into the rows as they arrive
+      for (i = 0; i < kappa; ++i) {
+        ot_ext_snd.u_[i] = HugePageBitVector(bit_size_padded);
+      }
+      ot_ext_snd.num_received_u_rows_.assign(num_u_chunks, 0);
+      ot_ext_snd.u_chunk_size_ = ot_extension_range_size;
+    } else {
+      ot_ext_snd.u_chunk_size_ = 0;
+    }
+  }
+  // the message handler waits for this before it stores the vectors u
+  ot_ext_snd.bit_size_ = bit_size;
 
   // vector containing the matrix rows
   // XXX: note that rows/columns are swapped compared to the ALSZ paper
   std::vector<AlignedBitVector> v(kappa);
+  for (i = 0; i < kappa; ++i) {
+    v[i] = AlignedBitVector(bit_size_padded);
+  }
 
-  // PRG which is used to expand the keys we got from the base OTs
-  PRG prgs_var_key;
-  //// fill the rows of the matrix
+  // PRGs which are used to expand the keys we got from the base OTs
+  std::vector<PRG> prgs_var_key(kappa);
+  const std::size_t consumed_offset = ot_ext_snd.consumed_offset_base_ots_;
   for (i = 0; i < kappa; ++i) {
     // use the key we got from the base OTs as seed
-    prgs_var_key.SetKey(base_ots_rcv.messages_c_.at(i).data());
+    prgs_var_key[i].SetKey(base_ots_rcv.messages_c_.at(i).data());
     // change the offset in the output stream since we might have already used
     // the same base OTs previously
-    prgs_var_key.SetOffset(base_ots_rcv.consumed_offset_);
-    // expand the seed such that it fills one row of the matrix
-    auto row(prgs_var_key.Encrypt(byte_size));
-    v[i] = AlignedBitVector(std::move(row), bit_size_padded);
+    prgs_var_key[i].SetOffset(base_ots_rcv.consumed_offset_ + consumed_offset);
   }
   ot_ext_snd.consumed_offset_base_ots_ += bit_size_padded / kappa;
 
-  // receive the vectors u one by one from the receiver
-  // and xor them to the expanded keys if the corresponding selection bit is 1
-  // transmitted one by one to prevent waiting for finishing all messages to start sending
-  // the vectors can be transmitted in the wrong order
-
-  for (auto it = ot_ext_snd.u_futures_.begin(); it < ot_ext_snd.u_futures_.end(); ++it) {
-    const std::size_t u_id{it->get()};
-    if (base_ots_rcv.c_[u_id]) {
-      const auto &u = ot_ext_snd.u_[u_id];
-      ENCRYPTO::BitSpan bs(v[u_id].GetMutableData().data(), bit_size, true);
-      bs ^= u;
-    }
-  }
+  // pad the vector of bitlength with zeros
+  ot_ext_snd.bitlengths_.resize(bit_size_padded, 0);
+  const std::size_t num_ots{ot_ext_snd.y0_.size()};
+  ot_ext_snd.y0_.resize(bit_size_padded);
+  ot_ext_snd.y1_.resize(bit_size_padded);
 
-  // delete the allocated memory
-  ot_ext_snd.u_ = {};
+  motion_base_provider_.setup();
+  const auto &fixed_key_aes_key = motion_base_provider_.get_aes_fixed_key();
+
+  // for each (extended) OT i
+  PRG prg_fixed_key;
+  prg_fixed_key.SetKey(fixed_key_aes_key.data());
 
   // array with pointers to each row of the matrix
   std::array<const std::byte *, kappa> ptrs;
@@ -231,20 +294,67 @@ void OTProviderFromOTExtension::SendSetup() {
     ptrs[i] = v[i].GetData().data();
   }
 
-  // pad the vector of bitlength with zeros
-  ot_ext_snd.bitlengths_.resize(bit_size_padded, 0);
+  RangeProgress progress(num_ranges, num_ots, *ot_ext_snd.ots_ready_);
 
-  motion_base_provider_.setup();
-  const auto &fixed_key_aes_key = motion_base_provider_.get_aes_fixed_key();
+  // fill the rows of the matrix for the columns of the range
+  const auto expand_range = [&](std::size_t range_i) {
+    const auto [column_offset, num_columns] = get_column_range(range_i, bit_size_padded);
+    for (std::size_t row_i = 0; row_i < kappa; ++row_i) {
+      prgs_var_key[row_i].EncryptBlocks(v[row_i].GetMutableData().data() + column_offset / 8,
+                                        column_offset / kappa, num_columns / kappa);
+    }
+  };
+
+  // xor the vectors u to the expanded keys if the corresponding selection bit is 1, then
+  // transpose the columns of the range and hash them into the outputs
+  const auto hash_range = [&](std::size_t range_i) {
+    const auto [column_offset, num_columns] = get_column_range(range_i, bit_size_padded);
+    if (column_offset < bit_size) {
+      const auto num_bits = std::min(num_columns, bit_size - column_offset);
+      for (std::size_t row_i = 0; row_i < kappa; ++row_i) {
+        if (base_ots_rcv.c_[row_i]) {
+          BitSpan bs(v[row_i].GetMutableData().data() + column_offset / 8, num_bits, true);
+          bs ^= BitSpan(ot_ext_snd.u_[row_i].GetMutableData().data() + column_offset / 8,
+                        num_bits, true);
+        }
+      }
+    }
+    BitMatrix::SenderTransposeAndEncryptRange(ptrs, ot_ext_snd.y0_, ot_ext_snd.y1_,
+                                              base_ots_rcv.c_, prg_fixed_key, column_offset,
+                                              num_columns, num_ots, ot_ext_snd.bitlengths_);
+    progress.finish(range_i);
+  };
+
+  if (streaming_setup_) {
+    // process the ranges in order as soon as their chunks of u have arrived, s.t. the OTs of the
+    // first ranges can be used while the later chunks are still transmitted
+#pragma omp parallel for schedule(dynamic)
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      expand_range(range_i);
+      ot_ext_snd.u_chunks_ready_->WaitUntil(std::min(range_i + 1, num_u_chunks));
+      hash_range(range_i);
+    }
+  } else {
+    // each thread expands the seeds for its own columns
+#pragma omp parallel for
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      expand_range(range_i);
+    }
 
-  // for each (extended) OT i
-  PRG prg_fixed_key;
-  prg_fixed_key.SetKey(fixed_key_aes_key.data());
+    // receive the vectors u one by one from the receiver
+    // the vectors can be transmitted in the wrong order
+    for (auto it = ot_ext_snd.u_futures_.begin(); it < ot_ext_snd.u_futures_.end(); ++it) {
+      it->get();
+    }
 
-  // transpose the bit matrix
-  // XXX: figure out how the result looks like
-  BitMatrix::SenderTransposeAndEncrypt(ptrs, ot_ext_snd.y0_, ot_ext_snd.y1_, base_ots_rcv.c_,
-                                       prg_fixed_key, bit_size_padded, ot_ext_snd.bitlengths_);
+#pragma omp parallel for
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      hash_range(range_i);
+    }
+  }
+
+  // delete the allocated memory
+  ot_ext_snd.u_ = {};
   /*
     for (i = 0; i < ot_ext_snd.bitlengths_.size(); ++i) {
       // here we want to store the sender's outputs
@@ -325,13 +435,8 @@ void OTProviderFromOTExtension::ReceiveSetup() {
 
   // rounded up to a multiple of the security parameter
   const auto bit_size_padded = bit_size + kappa - (bit_size % kappa);
+  const std::size_t num_ranges = get_num_column_ranges(bit_size_padded);
 
-  // convert to bytes
-  const std::size_t byte_size = MOTION::Helpers::Convert::BitsToBytes(bit_size);
-  // XXX: if byte_size is 0 then bit_size was also zero (or an overflow happened
-  if (byte_size == 0) {
-    return;
-  }
   // storage for receiver and base OT sender data
   const auto &base_ots_snd = base_ot_data_.GetSenderData();
   auto &ot_ext_rcv = data_.GetReceiverData();
@@ -339,62 +444,110 @@ void OTProviderFromOTExtension::ReceiveSetup() {
   // make random choices (this is precomputation, real inputs are not known yet)
   ot_ext_rcv.random_choices_ =
       std::make_unique<AlignedBitVector>(AlignedBitVector::Random(bit_size));
+  auto random_choices = ot_ext_rcv.random_choices_->GetMutableData().data();
 
-  // create matrix with kappa rows
-  std::vector<AlignedBitVector> v(kappa);
-
-  // PRG we use with the fixed-key AES function
+  // create matrix with kappa rows and the masks u which we send to the sender
+  std::vector<AlignedBitVector> v(kappa), u(kappa);
+  for (i = 0; i < kappa; ++i) {
+    v[i] = AlignedBitVector(bit_size_padded);
+    u[i] = AlignedBitVector(bit_size_padded);
+  }
 
-  // PRG which is used to expand the keys we got from the base OTs
-  PRG prg_fixed_key, prg_var_key;
-  // fill the rows of the matrix
+  // PRGs which are used to expand the keys we got from the base OTs
+  std::vector<PRG> prgs_0(kappa), prgs_1(kappa);
+  const std::size_t consumed_offset = ot_ext_rcv.consumed_offset_base_ots_;
   for (i = 0; i < kappa; ++i) {
-    // generate rows of the matrix using the corresponding 0 key
-    // T[j] = PRG(s_{j,0})
-    prg_var_key.SetKey(base_ots_snd.messages_0_.at(i).data());
+    prgs_0[i].SetKey(base_ots_snd.messages_0_.at(i).data());
+    prgs_1[i].SetKey(base_ots_snd.messages_1_.at(i).data());
     // change the offset in the output stream since we might have already used
     // the same base OTs previously
-    prg_var_key.SetOffset(base_ots_snd.consumed_offset_);
-    // expand the seed such that it fills one row of the matrix
-    auto row(prg_var_key.Encrypt(byte_size));
-    v.at(i) = AlignedBitVector(std::move(row), bit_size);
-    // take a copy of the row and XOR it with our choices
-    auto u = v.at(i);
-    // u_j = T[j] XOR r
-    u ^= *ot_ext_rcv.random_choices_;
-
-    // now mask the result with random stream expanded from the 1 key
-    // u_j = u_j XOR PRG(s_{j,1})
-    prg_var_key.SetKey(base_ots_snd.messages_1_.at(i).data());
-    prg_var_key.SetOffset(base_ots_snd.consumed_offset_);
-    u ^= AlignedBitVector(prg_var_key.Encrypt(byte_size), bit_size);
-
-    // send this row
-    Send_(MOTION::Communication::BuildOTExtensionMessageReceiverMasks(u.GetData().data(),
-                                                                      u.GetData().size(), i));
+    prgs_0[i].SetOffset(base_ots_snd.consumed_offset_ + consumed_offset);
+    prgs_1[i].SetOffset(base_ots_snd.consumed_offset_ + consumed_offset);
   }
   ot_ext_rcv.consumed_offset_base_ots_ += bit_size_padded / kappa;
 
-  // transpose matrix T
-  if (bit_size_padded != bit_size) {
-    for (i = 0u; i < v.size(); ++i) {
-      v.at(i).Resize(bit_size_padded, true);
-    }
-  }
-
   std::array<const std::byte *, kappa> ptrs;
   for (j = 0; j < ptrs.size(); ++j) {
-    ptrs.at(j) = v.at(j).GetMutableData().data();
+    ptrs.at(j) = v.at(j).GetData().data();
   }
 
   // pad the vector of bitlength with zeros
   ot_ext_rcv.bitlengths_.resize(bit_size_padded, 0);
+  const std::size_t num_ots{ot_ext_rcv.outputs_.size()};
+  ot_ext_rcv.outputs_.resize(bit_size_padded);
 
   motion_base_provider_.setup();
   const auto &fixed_key_aes_key = motion_base_provider_.get_aes_fixed_key();
+  PRG prg_fixed_key;
   prg_fixed_key.SetKey(fixed_key_aes_key.data());
-  BitMatrix::ReceiverTransposeAndEncrypt(ptrs, ot_ext_rcv.outputs_, prg_fixed_key, bit_size_padded,
-                                         ot_ext_rcv.bitlengths_);
+
+  RangeProgress progress(num_ranges, num_ots, *ot_ext_rcv.ots_ready_);
+
+  // fill the rows of the matrix and of u for the columns of the range
+  const auto expand_range = [&](std::size_t range_i) {
+    const auto [column_offset, num_columns] = get_column_range(range_i, bit_size_padded);
+    const auto num_bits = std::min(num_columns, bit_size - std::min(bit_size, column_offset));
+    for (std::size_t row_i = 0; row_i < kappa; ++row_i) {
+      auto t_row = v[row_i].GetMutableData().data() + column_offset / 8;
+      auto u_row = u[row_i].GetMutableData().data() + column_offset / 8;
+      // generate rows of the matrix using the corresponding 0 key
+      // T[j] = PRG(s_{j,0})
+      prgs_0[row_i].EncryptBlocks(t_row, column_offset / kappa, num_columns / kappa);
+      // u_j = T[j] XOR r XOR PRG(s_{j,1})
+      prgs_1[row_i].EncryptBlocks(u_row, column_offset / kappa, num_columns / kappa);
+      if (num_bits > 0) {
+        BitSpan u_span(u_row, num_bits, true);
+        u_span ^= BitSpan(t_row, num_bits, true);
+        u_span ^= BitSpan(random_choices + column_offset / 8, num_bits, true);
+      }
+    }
+  };
+
+  // transpose the matrix T and hash the rows of the result into the outputs
+  const auto hash_range = [&](std::size_t range_i) {
+    const auto [column_offset, num_columns] = get_column_range(range_i, bit_size_padded);
+    BitMatrix::ReceiverTransposeAndEncryptRange(ptrs, ot_ext_rcv.outputs_, prg_fixed_key,
+                                                column_offset, num_columns, num_ots,
+                                                ot_ext_rcv.bitlengths_);
+    progress.finish(range_i);
+  };
+
+  if (streaming_setup_) {
+    // send the chunks of u as soon as they are computed, the message for row j of range r has
+    // the index r * kappa + j
+#pragma omp parallel for schedule(dynamic)
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      expand_range(range_i);
+      const auto [column_offset, num_columns] = get_column_range(range_i, bit_size_padded);
+      if (column_offset < bit_size) {
+        const auto num_bytes = (std::min(num_columns, bit_size - column_offset) + 7) / 8;
+        for (std::size_t row_i = 0; row_i < kappa; ++row_i) {
+          Send_(MOTION::Communication::BuildOTExtensionMessageReceiverMasks(
+              u[row_i].GetData().data() + column_offset / 8, num_bytes, range_i * kappa + row_i));
+        }
+      }
+      hash_range(range_i);
+    }
+  } else {
+    // fill the rows of the matrix, each thread for its own columns
+#pragma omp parallel for
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      expand_range(range_i);
+    }
+
+    // send the rows of u
+    for (i = 0; i < kappa; ++i) {
+      u[i].Resize(bit_size);
+      Send_(MOTION::Communication::BuildOTExtensionMessageReceiverMasks(
+          u[i].GetData().data(), u[i].GetData().size(), i));
+    }
+
+#pragma omp parallel for
+    for (std::size_t range_i = 0; range_i < num_ranges; ++range_i) {
+      hash_range(range_i);
+    }
+  }
+  u = {};
   /*BitMatrix::TransposeUsingBitSlicing(ptrs, bit_size_padded);
   for (i = 0; i < ot_ext_rcv.outputs_.size(); ++i) {
     const auto row_i = i % kappa;
@@ -428,10 +581,92 @@ void OTProviderFromOTExtension::ReceiveSetup() {
   }
 }
 
+OTProviderFromFakeSetup::OTProviderFromFakeSetup(
+    std::function<void(flatbuffers::FlatBufferBuilder &&)> Send, MOTION::OTExtensionData &data,
+    std::size_t my_id, std::size_t party_id, std::shared_ptr<MOTION::Logger> logger)
+    : OTProvider(Send, data, party_id, logger), my_id_(my_id), party_id_(party_id) {
+  auto &ot_ext_rcv = data_.GetReceiverData();
+  ot_ext_rcv.real_choices_ = std::make_unique<BitVector<>>();
+}
+
+namespace {
+
+// stream of the fake setup for message b of OT i in the given setup iteration
+std::size_t fake_ot_stream(std::uint64_t iteration, std::size_t ot_i, std::size_t b) {
+  return (iteration << 41) | (2 * ot_i + b);
+}
+
+}  // namespace
+
+void OTProviderFromFakeSetup::SendSetup() {
+  auto &ot_ext_snd = data_.GetSenderData();
+  const std::size_t num_ots = sender_provider_.GetNumOTs();
+  if (num_ots == 0) {
+    return;  // no OTs needed
+  }
+  ot_ext_snd.bit_size_ = num_ots;
+
+  // the receiver derives the same messages, and its choices from another stream
+  const auto &generator = MOTION::get_fake_setup_generator();
+  const auto index =
+      MOTION::fake_setup_index(MOTION::FakeSetupStream::ot_outputs, my_id_, party_id_);
+  for (std::size_t i = 0; i < num_ots; ++i) {
+    const auto bitlen = ot_ext_snd.bitlengths_.at(i);
+    ot_ext_snd.y0_.at(i) =
+        generator.random_bits(fake_ot_stream(sender_iteration_, i, 0), bitlen, index);
+    ot_ext_snd.y1_.at(i) =
+        generator.random_bits(fake_ot_stream(sender_iteration_, i, 1), bitlen, index);
+  }
+  ++sender_iteration_;
+
+  {
+    std::scoped_lock lock(ot_ext_snd.setup_finished_cond_->GetMutex());
+    ot_ext_snd.setup_finished_ = true;
+  }
+  ot_ext_snd.setup_finished_cond_->NotifyAll();
+  ot_ext_snd.ots_ready_->Raise(num_ots);
+}
+
+void OTProviderFromFakeSetup::ReceiveSetup() {
+  auto &ot_ext_rcv = data_.GetReceiverData();
+  const std::size_t num_ots = receiver_provider_.GetNumOTs();
+  if (num_ots == 0) {
+    return;  // nothing to do
+  }
+
+  const auto &generator = MOTION::get_fake_setup_generator();
+  const auto index =
+      MOTION::fake_setup_index(MOTION::FakeSetupStream::ot_outputs, party_id_, my_id_);
+  const auto choices_index =
+      MOTION::fake_setup_index(MOTION::FakeSetupStream::ot_choices, party_id_, my_id_);
+  std::vector<std::byte> choices(MOTION::Helpers::Convert::BitsToBytes(num_ots));
+  generator.random_bytes(receiver_iteration_, choices_index, choices.data(), choices.size());
+  ot_ext_rcv.random_choices_ = std::make_unique<AlignedBitVector>(choices.data(), num_ots);
+  for (std::size_t i = 0; i < num_ots; ++i) {
+    std::unique_lock lock(ot_ext_rcv.bitlengths_mutex_);
+    const auto bitlen = ot_ext_rcv.bitlengths_.at(i);
+    lock.unlock();
+    const std::size_t choice = ot_ext_rcv.random_choices_->Get(i);
+    ot_ext_rcv.outputs_.at(i) =
+        generator.random_bits(fake_ot_stream(receiver_iteration_, i, choice), bitlen, index);
+  }
+  ++receiver_iteration_;
+
+  {
+    std::scoped_lock lock(ot_ext_rcv.setup_finished_cond_->GetMutex());
+    ot_ext_rcv.setup_finished_ = true;
+  }
+  ot_ext_rcv.setup_finished_cond_->NotifyAll();
+  ot_ext_rcv.ots_ready_->Raise(num_ots);
+}
+
 OTVector::OTVector(const std::size_t ot_id, const std::size_t num_ots, const std::size_t bitlen,
                    const OTProtocol p,
                    const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
-    : ot_id_(ot_id), num_ots_(num_ots), bitlen_(bitlen), p_(p), Send_(Send) {}
+    : ot_id_(ot_id), num_ots_(num_ots), bitlen_(bitlen), p_(p), Send_(Send) {
+  // the OT ids and the data of the OT extension depend on the order of the registrations
+  MOTION::ConstructionScope::require_serial("OT registrations");
+}
 
 const std::vector<BitVector<>> &OTVectorSender::GetOutputs() {
   WaitSetup();
@@ -448,7 +683,8 @@ const std::vector<BitVector<>> &OTVectorSender::GetOutputs() {
   return outputs_;
 }
 
-void OTVectorSender::WaitSetup() { data_.setup_finished_cond_->Wait(); }
+// only the OTs of this vector need to be finished
+void OTVectorSender::WaitSetup() { data_.ots_ready_->WaitUntil(ot_id_ + num_ots_); }
 
 OTVectorSender::OTVectorSender(const std::size_t ot_id, const std::size_t num_ots,
                                const std::size_t bitlen, const OTProtocol p,
@@ -467,20 +703,13 @@ void OTVectorSender::Reserve(const std::size_t id, const std::size_t num_ots,
   for (auto i = 0ull; i < num_ots; ++i) {
     data_.bitlengths_.at(data_.bitlengths_.size() - 1 - i) = bitlen;
   }
-  data_.num_ots_in_batch_.emplace(id, num_ots);
+  data_.batches_.Add(id, num_ots);
 }
 
 GOTVectorSender::GOTVectorSender(const std::size_t ot_id, const std::size_t num_ots,
                                  const std::size_t bitlen, MOTION::OTExtensionSenderData &data,
                                  const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
-    : OTVectorSender(ot_id, num_ots, bitlen, OTProtocol::GOT, data, Send) {
-  data_.received_correction_offsets_cond_.emplace(
-      ot_id_, std::make_unique<FiberCondition>([ot_id, this]() {
-        std::scoped_lock lock(data_.corrections_mutex_);
-        return data_.received_correction_offsets_.find(ot_id) !=
-               data_.received_correction_offsets_.end();
-      }));
-}
+    : OTVectorSender(ot_id, num_ots, bitlen, OTProtocol::GOT, data, Send) {}
 
 void GOTVectorSender::SetInputs(std::vector<BitVector<>> &&v) {
   for ([[maybe_unused]] auto &bv : v) {
@@ -503,7 +732,7 @@ void GOTVectorSender::SendMessages() {
   assert(!inputs_.empty());
   WaitSetup();
   const auto &ot_ext_snd = data_;
-  ot_ext_snd.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  ot_ext_snd.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
   std::unique_lock lock(ot_ext_snd.corrections_mutex_);
   const auto corrections = ot_ext_snd.corrections_.Subset(ot_id_, ot_id_ + num_ots_);
   lock.unlock();
@@ -535,12 +764,6 @@ COTVectorSender::COTVectorSender(const std::size_t id, const std::size_t num_ots
     throw std::runtime_error(fmt::format(
         "Invalid parameter bitlen={}, only 8, 16, 32, 64, or 128 are allowed in ACOT", bitlen_));
   }
-  data_.received_correction_offsets_cond_.emplace(
-      ot_id_, std::make_unique<FiberCondition>([this]() {
-        std::scoped_lock lock(data_.corrections_mutex_);
-        return data_.received_correction_offsets_.find(ot_id_) !=
-               data_.received_correction_offsets_.end();
-      }));
 }
 
 void COTVectorSender::SetInputs(std::vector<BitVector<>> &&v) {
@@ -563,7 +786,7 @@ const std::vector<BitVector<>> &COTVectorSender::GetOutputs() {
   }
   WaitSetup();
   const auto &ot_ext_snd = data_;
-  ot_ext_snd.received_correction_offsets_cond_.at(ot_id_)->Wait();
+  ot_ext_snd.batches_.Wait(ot_id_, MOTION::OTBatchTable::corrections_received);
   if (outputs_.empty()) {
     outputs_.reserve(num_ots_);
     std::unique_lock lock(ot_ext_snd.corrections_mutex_);
@@ -708,7 +931,8 @@ void ROTVectorSender::SendMessages() {
   throw std::runtime_error("Inputs in ROT are available locally and thus do not need to be sent");
 }
 
-void OTVectorReceiver::WaitSetup() { data_.setup_finished_cond_->Wait(); }
+// only the OTs of this vector need to be finished
+void OTVectorReceiver::WaitSetup() { data_.ots_ready_->WaitUntil(ot_id_ + num_ots_); }
 
 OTVectorReceiver::OTVectorReceiver(const std::size_t ot_id, const std::size_t num_ots,
                                    const std::size_t bitlen, const OTProtocol p,
@@ -725,7 +949,7 @@ void OTVectorReceiver::Reserve(const std::size_t id, const std::size_t num_ots,
   for (auto i = 0ull; i < num_ots; ++i) {
     data_.bitlengths_.at(id + i) = bitlen;
   }
-  data_.num_ots_in_batch_.emplace(id, num_ots);
+  data_.batches_.Add(id, num_ots);
 }
 
 GOTVectorReceiver::GOTVectorReceiver(
@@ -733,20 +957,17 @@ GOTVectorReceiver::GOTVectorReceiver(
     MOTION::OTExtensionReceiverData &data,
     const std::function<void(flatbuffers::FlatBufferBuilder &&)> &Send)
     : OTVectorReceiver(ot_id, num_ots, bitlen, OTProtocol::GOT, data, Send) {
-  std::scoped_lock lock(data_.num_messages_mutex_);
-  data_.num_messages_.emplace(ot_id_, 2);
+  data_.batches_.Get(ot_id_).num_messages_ = 2;
 }
 
 void GOTVectorReceiver::SetChoices(BitVector<> &&v) {
   assert(v.GetSize() == num_ots_);
   choices_ = std::move(v);
   {
-    std::scoped_lock lock(data_.real_choices_mutex_,
-                          data_.real_choices_cond_.at(ot_id_)->GetMutex());
+    std::scoped_lock lock(data_.real_choices_mutex_);
     data_.real_choices_->Copy(ot_id_, choices_);
-    data_.set_real_choices_.emplace(ot_id_);
   }
-  data_.real_choices_cond_.at(ot_id_)->NotifyOne();
+  data_.batches_.Set(ot_id_, MOTION::OTBatchTable::choices_set);
   choices_flag_ = true;
 }
 
@@ -754,12 +975,10 @@ void GOTVectorReceiver::SetChoices(const BitVector<> &v) {
   assert(v.GetSize() == num_ots_);
   choices_ = v;
   {
-    std::scoped_lock lock(data_.real_choices_mutex_,
-                          data_.real_choices_cond_.at(ot_id_)->GetMutex());
+    std::scoped_lock lock(data_.real_choices_mutex_);
     data_.real_choices_->Copy(ot_id_, choices_);
-    data_.set_real_choices_.emplace(ot_id_);
   }
-  data_.real_choices_cond_.at(ot_id_)->NotifyOne();
+  data_.batches_.Set(ot_id_, MOTION::OTBatchTable::choices_set);
   choices_flag_ = true;
 }
 
@@ -780,7 +999,7 @@ const std::vector<BitVector<>> &GOTVectorReceiver::GetOutputs() {
   }
   WaitSetup();
   const auto &ot_ext_rcv = data_;
-  ot_ext_rcv.output_conds_.at(ot_id_)->Wait();
+  ot_ext_rcv.batches_.Wait(ot_id_, MOTION::OTBatchTable::outputs_received);
   if (messages_.empty()) {
     for (auto i = 0ull; i < num_ots_; ++i) {
       if (ot_ext_rcv.outputs_.at(ot_id_ + i).GetSize() > 0) {
@@ -801,13 +1020,9 @@ COTVectorReceiver::COTVectorReceiver(
     throw std::runtime_error(fmt::format(
         "Invalid parameter bitlen={}, only 8, 16, 32, 64, or 128 are allowed in ACOT", bitlen_));
   }
-  {
-    std::scoped_lock lock(data_.num_messages_mutex_);
-    data_.num_messages_.emplace(ot_id_, 1);
-  }
-  if (p == OTProtocol::XCOT) {
-    data_.xor_correlation_.emplace(ot_id_);
-  }
+  auto &batch = data_.batches_.Get(ot_id_);
+  batch.num_messages_ = 1;
+  batch.xor_correlation_ = p == OTProtocol::XCOT;
 }
 
 void COTVectorReceiver::SendCorrections() {
@@ -823,24 +1038,20 @@ void COTVectorReceiver::SendCorrections() {
 void COTVectorReceiver::SetChoices(BitVector<> &&v) {
   choices_ = std::move(v);
   {
-    std::scoped_lock lock(data_.real_choices_mutex_,
-                          data_.real_choices_cond_.at(ot_id_)->GetMutex());
+    std::scoped_lock lock(data_.real_choices_mutex_);
     data_.real_choices_->Copy(ot_id_, choices_);
-    data_.set_real_choices_.emplace(ot_id_);
   }
-  data_.real_choices_cond_.at(ot_id_)->NotifyOne();
+  data_.batches_.Set(ot_id_, MOTION::OTBatchTable::choices_set);
   choices_flag_ = true;
 }
 
 void COTVectorReceiver::SetChoices(const BitVector<> &v) {
   choices_ = v;
   {
-    std::scoped_lock lock(data_.real_choices_mutex_,
-                          data_.real_choices_cond_.at(ot_id_)->GetMutex());
+    std::scoped_lock lock(data_.real_choices_mutex_);
     data_.real_choices_->Copy(ot_id_, choices_);
-    data_.set_real_choices_.emplace(ot_id_);
   }
-  data_.real_choices_cond_.at(ot_id_)->NotifyOne();
+  data_.batches_.Set(ot_id_, MOTION::OTBatchTable::choices_set);
   choices_flag_ = true;
 }
 
@@ -849,7 +1060,7 @@ const std::vector<BitVector<>> &COTVectorReceiver::GetOutputs() {
     throw std::runtime_error("In COT, corrections must be set before calling GetOutputs()");
   }
   WaitSetup();
-  data_.output_conds_.at(ot_id_)->Wait();
+  data_.batches_.Wait(ot_id_, MOTION::OTBatchTable::outputs_received);
 
   if (messages_.empty()) {
     messages_.reserve(num_ots_);
@@ -1071,21 +1282,20 @@ void OTProviderSender::Clear() {
     std::scoped_lock lock(data_.setup_finished_cond_->GetMutex());
     data_.setup_finished_ = false;
   }
-  {
-    std::scoped_lock lock(data_.corrections_mutex_);
-    data_.received_correction_offsets_.clear();
-  }
+  data_.ots_ready_->Reset();
+  data_.batches_.ResetFlags();
   {
     std::scoped_lock lock(data_.u_mutex_);
     data_.num_received_u_ = 0;
+    data_.num_received_u_rows_.clear();
   }
+  data_.u_chunks_ready_->Reset();
 }
 
 void OTProviderSender::Reset() {
-  Clear();
+  sender_data_.clear();
   total_ots_count_ = 0;
-  // TODO
-  // - clear promise map
+  data_.Reset();
 }
 
 std::shared_ptr<OTVectorReceiver> &OTProviderReceiver::GetOTs(std::size_t offset) {
@@ -1102,26 +1312,6 @@ std::shared_ptr<OTVectorReceiver> &OTProviderReceiver::RegisterOTs(
   const std::size_t i = total_ots_count_;
   total_ots_count_ += num_ots;
 
-  if (p != OTProtocol::ROT) {
-    {
-      auto &&e =
-          std::pair(i, std::make_unique<FiberCondition>([i, this]() {
-                      std::scoped_lock lock(data_.received_outputs_mutex_);
-                      return data_.received_outputs_.find(i) != data_.received_outputs_.end();
-                    }));
-      data_.output_conds_.insert(std::move(e));
-    }
-    {
-      auto &&e =
-          std::pair(i, std::make_unique<FiberCondition>([i, this]() {
-                      std::scoped_lock lock(data_.real_choices_mutex_);
-                      return data_.set_real_choices_.find(i) != data_.set_real_choices_.end();
-                    }));
-      std::scoped_lock lock(data_.real_choices_mutex_);
-      data_.real_choices_cond_.insert(std::move(e));
-    }
-  }
-
   std::shared_ptr<OTVectorReceiver> ot;
 
   switch (p) {
@@ -1284,22 +1474,13 @@ void OTProviderReceiver::Clear() {
     std::scoped_lock lock(data_.setup_finished_cond_->GetMutex());
     data_.setup_finished_ = false;
   }
-
-  {
-    std::scoped_lock lock(data_.real_choices_mutex_);
-    data_.set_real_choices_.clear();
-  }
-
-  {
-    std::scoped_lock lock(data_.received_outputs_mutex_);
-    data_.received_outputs_.clear();
-  }
+  data_.ots_ready_->Reset();
+  data_.batches_.ResetFlags();
 }
 void OTProviderReceiver::Reset() {
-  Clear();
+  receiver_data_.clear();
   total_ots_count_ = 0;
-  // TODO
-  // - clear promise map
+  data_.Reset();
 }
 
 class OTExtensionMessageHandler : public MOTION::Communication::MessageHandler {
@@ -1334,6 +1515,16 @@ void OTExtensionMessageHandler::received_message(std::size_t,
       data_.MessageReceived(ot_data, ot_data_size, MOTION::OTExtensionDataType::snd_messages, index_i);
       break;
     }
+    case MOTION::Communication::MessageType::SilentOTReceiver: {
+      data_.MessageReceived(ot_data, ot_data_size,
+                            MOTION::OTExtensionDataType::silent_ot_rcv_messages, index_i);
+      break;
+    }
+    case MOTION::Communication::MessageType::SilentOTSender: {
+      data_.MessageReceived(ot_data, ot_data_size,
+                            MOTION::OTExtensionDataType::silent_ot_snd_messages, index_i);
+      break;
+    }
     default: {
       assert(false);
       break;
@@ -1359,14 +1550,9 @@ OTProviderManager::OTProviderManager(MOTION::Communication::CommunicationLayer &
     if (party_id == my_id) {
       continue;
     }
-    auto send_func = [this, party_id](flatbuffers::FlatBufferBuilder &&message_builder) {
-      communication_layer_.send_message(party_id, std::move(message_builder));
-    };
     data_.at(party_id) = std::make_unique<MOTION::OTExtensionData>();
-    providers_.at(party_id) = std::make_unique<OTProviderFromOTExtension>(
-        send_func, *data_.at(party_id), base_ot_provider.get_base_ots_data(party_id),
-        motion_base_provider, party_id, logger);
   }
+  make_providers();
 
   communication_layer_.register_message_handler(
       [this](std::size_t party_id) {
@@ -1374,19 +1560,79 @@ OTProviderManager::OTProviderManager(MOTION::Communication::CommunicationLayer &
       },
       {MOTION::Communication::MessageType::OTExtensionReceiverMasks,
        MOTION::Communication::MessageType::OTExtensionReceiverCorrections,
-       MOTION::Communication::MessageType::OTExtensionSender});
+       MOTION::Communication::MessageType::OTExtensionSender,
+       MOTION::Communication::MessageType::SilentOTReceiver,
+       MOTION::Communication::MessageType::SilentOTSender});
 }
 
 OTProviderManager::~OTProviderManager() {
   communication_layer_.deregister_message_handler(
       {MOTION::Communication::MessageType::OTExtensionReceiverMasks,
        MOTION::Communication::MessageType::OTExtensionReceiverCorrections,
-       MOTION::Communication::MessageType::OTExtensionSender});
+       MOTION::Communication::MessageType::OTExtensionSender,
+       MOTION::Communication::MessageType::SilentOTReceiver,
+       MOTION::Communication::MessageType::SilentOTSender});
+}
+
+void OTProviderManager::make_providers() {
+  auto my_id = communication_layer_.get_my_id();
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (party_id == my_id) {
+      continue;
+    }
+    auto send_func = [this, party_id](flatbuffers::FlatBufferBuilder &&message_builder) {
+      communication_layer_.send_message(party_id, std::move(message_builder));
+    };
+    switch (backend_) {
+      case OTBackend::ot_extension:
+        providers_.at(party_id) = std::make_unique<OTProviderFromOTExtension>(
+            send_func, *data_.at(party_id), base_ot_provider_.get_base_ots_data(party_id),
+            motion_base_provider_, party_id, logger_);
+        break;
+      case OTBackend::silent_ot:
+        providers_.at(party_id) = std::make_unique<OTProviderFromSilentOT>(
+            send_func, *data_.at(party_id), base_ot_provider_.get_base_ots_data(party_id),
+            motion_base_provider_, party_id, logger_);
+        break;
+      case OTBackend::fake_setup:
+        providers_.at(party_id) = std::make_unique<OTProviderFromFakeSetup>(
+            send_func, *data_.at(party_id), my_id, party_id, logger_);
+        break;
+    }
+    providers_.at(party_id)->SetStreamingSetup(streaming_setup_);
+  }
+}
+
+void OTProviderManager::set_streaming_setup(bool streaming) {
+  streaming_setup_ = streaming;
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (providers_.at(party_id)) {
+      providers_.at(party_id)->SetStreamingSetup(streaming);
+    }
+  }
+}
+
+void OTProviderManager::set_backend(OTBackend backend) {
+  if (backend == backend_) {
+    return;
+  }
+  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
+    if (providers_.at(party_id) &&
+        (providers_.at(party_id)->GetNumOTsSender() > 0 ||
+         providers_.at(party_id)->GetNumOTsReceiver() > 0)) {
+      throw std::logic_error("OTProviderManager: the backend must be set before OTs are registered");
+    }
+  }
+  backend_ = backend;
+  // the new providers keep using the same base OTs and the position in their PRG streams
+  make_providers();
 }
 
 void OTProviderManager::run_setup() {
-  motion_base_provider_.wait_setup();
-  base_ot_provider_.wait_setup();
+  if (backend_ != OTBackend::fake_setup) {
+    motion_base_provider_.wait_setup();
+    base_ot_provider_.wait_setup();
+  }
 
   if constexpr (MOTION::MOTION_DEBUG) {
     logger_->LogDebug("Start computing setup for OTExtensions");
@@ -1395,6 +1641,7 @@ void OTProviderManager::run_setup() {
   if (stats_) {
     stats_->record_start<MOTION::Statistics::RunTimeStats::StatID::ot_extension_setup>();
   }
+  const auto setup_start = std::chrono::steady_clock::now();
 
   std::vector<std::future<void>> task_futures;
   task_futures.reserve(2 * (communication_layer_.get_num_parties() - 1));
@@ -1403,15 +1650,43 @@ void OTProviderManager::run_setup() {
     if (party_i == communication_layer_.get_my_id()) {
       continue;
     }
-    task_futures.emplace_back(std::async(
-        std::launch::async, [this, party_i] { providers_.at(party_i)->SendSetup(); }));
-    task_futures.emplace_back(std::async(
-        std::launch::async, [this, party_i] { providers_.at(party_i)->ReceiveSetup(); }));
+    // the threads of the preprocessing are split among the concurrent OT extensions
+    const auto num_tasks = task_futures.capacity();
+    task_futures.emplace_back(std::async(std::launch::async, [this, party_i, num_tasks] {
+      ENCRYPTO::this_thread_use_phase_omp_threads(num_tasks);
+      providers_.at(party_i)->SendSetup();
+    }));
+    task_futures.emplace_back(std::async(std::launch::async, [this, party_i, num_tasks] {
+      ENCRYPTO::this_thread_use_phase_omp_threads(num_tasks);
+      providers_.at(party_i)->ReceiveSetup();
+    }));
   }
 
   std::for_each(task_futures.begin(), task_futures.end(), [](auto &f) { f.get(); });
   set_setup_ready();
 
+  auto& metrics = MOTION::Statistics::MetricsRegistry::get_instance();
+  const auto my_id = std::to_string(communication_layer_.get_my_id());
+  for (auto party_i = 0ull; party_i < communication_layer_.get_num_parties(); ++party_i) {
+    if (party_i == communication_layer_.get_my_id()) {
+      continue;
+    }
+    const auto party_id = std::to_string(party_i);
+    metrics
+        .get_counter("motion_ots_total", "OTs generated with the party",
+                     {{"my_id", my_id}, {"party_id", party_id}, {"role", "sender"}})
+        .increment(providers_.at(party_i)->GetNumOTsSender());
+    metrics
+        .get_counter("motion_ots_total", "OTs generated with the party",
+                     {{"my_id", my_id}, {"party_id", party_id}, {"role", "receiver"}})
+        .increment(providers_.at(party_i)->GetNumOTsReceiver());
+  }
+  metrics
+      .get_histogram("motion_ot_extension_setup_seconds", "Duration of the OT extension setup",
+                     MOTION::Statistics::MetricsRegistry::default_time_bounds, {{"my_id", my_id}})
+      .observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - setup_start)
+                   .count());
+
   if (stats_) {
     stats_->record_end<MOTION::Statistics::RunTimeStats::StatID::ot_extension_setup>();
   }
@@ -1421,6 +1696,32 @@ void OTProviderManager::run_setup() {
   }
 }
 
+void OTProviderManager::fill_pools(std::size_t num_ots) {
+  if (backend_ == OTBackend::fake_setup) {
+    return;
+  }
+  motion_base_provider_.wait_setup();
+  base_ot_provider_.wait_setup();
+
+  std::vector<std::future<void>> task_futures;
+  task_futures.reserve(2 * (communication_layer_.get_num_parties() - 1));
+  for (auto party_i = 0ull; party_i < communication_layer_.get_num_parties(); ++party_i) {
+    if (party_i == communication_layer_.get_my_id()) {
+      continue;
+    }
+    const auto num_tasks = task_futures.capacity();
+    task_futures.emplace_back(std::async(std::launch::async, [this, party_i, num_ots, num_tasks] {
+      ENCRYPTO::this_thread_use_phase_omp_threads(num_tasks);
+      providers_.at(party_i)->SendFillPool(num_ots);
+    }));
+    task_futures.emplace_back(std::async(std::launch::async, [this, party_i, num_ots, num_tasks] {
+      ENCRYPTO::this_thread_use_phase_omp_threads(num_tasks);
+      providers_.at(party_i)->ReceiveFillPool(num_ots);
+    }));
+  }
+  std::for_each(task_futures.begin(), task_futures.end(), [](auto& f) { f.get(); });
+}
+
 void OTProviderManager::clear() {
   if constexpr (MOTION::MOTION_DEBUG) {
     logger_->LogDebug("OTProviderManager::clear()");
@@ -1434,4 +1735,17 @@ void OTProviderManager::clear() {
   reset_setup_ready();
 }
 
+void OTProviderManager::reset() {
+  if constexpr (MOTION::MOTION_DEBUG) {
+    logger_->LogDebug("OTProviderManager::reset()");
+  }
+  for (auto party_i = 0ull; party_i < communication_layer_.get_num_parties(); ++party_i) {
+    if (party_i == communication_layer_.get_my_id()) {
+      continue;
+    }
+    providers_.at(party_i)->Reset();
+  }
+  reset_setup_ready();
+}
+
 }  // namespace ENCRYPTO::ObliviousTransfer
@@ -431,8 +431,20 @@ class OTProvider {
   virtual void SendSetup() = 0;
   virtual void ReceiveSetup() = 0;
 
+  // Generate num_ots random OTs ahead of demand, independent of any registered OTs, which the
+  // following setups derandomize without running the OT extension again.  The other party needs
+  // to call the matching method with the same number.  Only backends with a pool of random OTs
+  // support this, for the others it does nothing.
+  virtual void SendFillPool([[maybe_unused]] std::size_t num_ots) {}
+  virtual void ReceiveFillPool([[maybe_unused]] std::size_t num_ots) {}
+
   void WaitSetup() const;
 
+  // process the OT extension batch in ranges of columns and hand the OTs of each range to their
+  // consumers as soon as it is finished, both parties need to use the same setting
+  void SetStreamingSetup(bool streaming) noexcept { streaming_setup_ = streaming; }
+  [[nodiscard]] bool GetStreamingSetup() const noexcept { return streaming_setup_; }
+
   void Clear() {
     receiver_provider_.Clear();
     sender_provider_.Clear();
@@ -453,6 +465,7 @@ class OTProvider {
   OTProviderReceiver receiver_provider_;
   OTProviderSender sender_provider_;
   std::shared_ptr<MOTION::Logger> logger_;
+  bool streaming_setup_ = false;
 };
 
 class OTProviderFromFile : public OTProvider {
@@ -479,6 +492,27 @@ class OTProviderFromOTExtension final : public OTProvider {
   MOTION::Crypto::MotionBaseProvider& motion_base_provider_;
 };
 
+// OT provider for the fake setup (see crypto/random/fake_setup.h): the random OTs are derived
+// from the fixed key of the fake setup without base OTs and without messages.  It is insecure and
+// only meant to benchmark the online phase.  The OT flavors still exchange their corrections.
+class OTProviderFromFakeSetup final : public OTProvider {
+ public:
+  void SendSetup() final;
+
+  void ReceiveSetup() final;
+
+  OTProviderFromFakeSetup(std::function<void(flatbuffers::FlatBufferBuilder&&)> Send,
+                          MOTION::OTExtensionData& data, std::size_t my_id, std::size_t party_id,
+                          std::shared_ptr<MOTION::Logger> logger);
+
+ private:
+  std::size_t my_id_;
+  std::size_t party_id_;
+  // number of setups so far, s.t. every batch gets fresh OTs
+  std::uint64_t sender_iteration_ = 0;
+  std::uint64_t receiver_iteration_ = 0;
+};
+
 class OTProviderFromThirdParty : public OTProvider {
   // TODO
 };
@@ -487,6 +521,13 @@ class OTProviderFromMultipleThirdParties : public OTProvider {
   // TODO
 };
 
+// how the OTProviderManager generates the OTs
+enum class OTBackend : unsigned int {
+  ot_extension,  // IKNP style OT extension, see OTProviderFromOTExtension
+  silent_ot,     // LPN based pseudorandom correlation generator, see OTProviderFromSilentOT
+  fake_setup,    // insecure OTs without communication, see OTProviderFromFakeSetup
+};
+
 class OTProviderManager : public enable_wait_setup {
  public:
   OTProviderManager(MOTION::Communication::CommunicationLayer&, const MOTION::BaseOTProvider&,
@@ -497,17 +538,37 @@ class OTProviderManager : public enable_wait_setup {
   std::vector<std::unique_ptr<OTProvider>>& get_providers() { return providers_; }
   OTProvider& get_provider(std::size_t party_id) { return *providers_.at(party_id); }
   void run_setup();
+  // fill the pools of random OTs with every other party in both directions, s.t. they hold at
+  // least num_ots OTs, see OTProvider::SendFillPool() (only supported by OTBackend::silent_ot)
+  void fill_pools(std::size_t num_ots);
+
+  // replace the providers by ones using the given backend; both parties need to do this before
+  // any OTs are registered, and references to the old providers become invalid
+  void set_backend(OTBackend backend);
+  OTBackend get_backend() const noexcept { return backend_; }
+
+  // stream the OT extension such that consumers can use the OTs of the first ranges of a batch
+  // while the later ones are still generated; both parties need to set the same value
+  void set_streaming_setup(bool streaming);
+  bool get_streaming_setup() const noexcept { return streaming_setup_; }
 
   // reset all data structures for a new round of OTs
   void clear();
+  // forget all registered OTs to start with a new circuit, the base OTs and the
+  // position in their PRG streams are kept
+  void reset();
 
  private:
+  void make_providers();
+
   MOTION::Communication::CommunicationLayer& communication_layer_;
   const MOTION::BaseOTProvider& base_ot_provider_;
   MOTION::Crypto::MotionBaseProvider& motion_base_provider_;
   MOTION::Statistics::RunTimeStats* stats_;
   std::shared_ptr<MOTION::Logger> logger_;
   std::size_t num_parties_;
+  OTBackend backend_ = OTBackend::ot_extension;
+  bool streaming_setup_ = false;
   std::vector<std::unique_ptr<OTProvider>> providers_;
   std::vector<std::unique_ptr<MOTION::OTExtensionData>> data_;
 };
@@ -0,0 +1,611 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "silent_ot.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "communication/ot_extension_message.h"
+#include "crypto/aes/aesni_primitives.h"
+#include "crypto/motion_base_provider.h"
+#include "crypto/pseudo_random_generator.h"
+#include "data_storage/base_ot_data.h"
+#include "data_storage/ot_extension_data.h"
+#include "utility/config.h"
+#include "utility/fiber_condition.h"
+#include "utility/logger.h"
+
+namespace ENCRYPTO::ObliviousTransfer {
+
+namespace {
+
+bool get_bit(const std::uint8_t* bits, std::size_t i) { return (bits[i / 8] >> (i % 8)) & 1; }
+
+void set_bit(std::uint8_t* bits, std::size_t i) { bits[i / 8] |= std::uint8_t(1) << (i % 8); }
+
+void set_bit(std::byte* bits, std::size_t i) { bits[i / 8] |= std::byte(1) << (i % 8); }
+
+// tweak of the hash which encrypts the keys of one GGM tree level
+uint128_t level_tweak(std::uint64_t iteration, std::size_t cot_index) {
+  return (uint128_t(iteration) << 64) | cot_index;
+}
+
+// Call f(i, indices) for each row i of the LPN matrix with the column indices of its non-zero
+// entries.  The matrix is expanded from a key derived from the fixed key and the iteration, and
+// rows are handled in parallel.  The indices are reduced modulo num_lpn_inputs which introduces a
+// negligible bias.
+template <typename F>
+void for_each_lpn_row(const SilentOTParameters& parameters, PRG& fixed_key_prg,
+                      std::uint64_t iteration, F&& f) {
+  constexpr std::size_t weight = SilentOTParameters::lpn_weight;
+  constexpr std::size_t rows_per_chunk = 256;
+  constexpr std::size_t blocks_per_chunk = rows_per_chunk * weight * sizeof(std::uint32_t) / 16;
+
+  auto lpn_key = block128_t::make_zero();
+  fixed_key_prg.FixedKeyAES(lpn_key.data(), (uint128_t(1) << 127) | iteration, lpn_key.data());
+  PRG lpn_prg;
+  lpn_prg.SetKey(lpn_key.data());
+  const auto* round_keys = lpn_prg.get_round_keys();
+
+  const std::size_t num_rows = parameters.num_outputs;
+  const std::size_t num_chunks = (num_rows + rows_per_chunk - 1) / rows_per_chunk;
+#pragma omp parallel for
+  for (std::size_t chunk_i = 0; chunk_i < num_chunks; ++chunk_i) {
+    alignas(16) std::array<std::uint32_t, rows_per_chunk * weight> indices;
+    std::uint64_t counter = chunk_i * blocks_per_chunk;
+    aesni_ctr_stream_blocks_128(round_keys, &counter, indices.data(), blocks_per_chunk);
+    const std::size_t begin = chunk_i * rows_per_chunk;
+    const std::size_t end = std::min(begin + rows_per_chunk, num_rows);
+    for (std::size_t row_i = begin; row_i < end; ++row_i) {
+      auto* row = &indices[(row_i - begin) * weight];
+      for (std::size_t w = 0; w < weight; ++w) {
+        row[w] %= parameters.num_lpn_inputs;
+      }
+      f(row_i, row);
+    }
+  }
+}
+
+// transpose the 128 rows of num_columns bits into num_columns blocks
+void transpose_rows(const std::vector<std::vector<std::byte>>& rows, std::size_t num_columns,
+                    block128_t* columns) {
+  for (std::size_t j = 0; j < num_columns; ++j) {
+    columns[j].set_to_zero();
+  }
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    const auto* row = rows[i].data();
+    for (std::size_t byte_i = 0; byte_i < num_columns / 8; ++byte_i) {
+      auto byte = std::to_integer<unsigned int>(row[byte_i]);
+      while (byte != 0) {
+        const auto bit_i = __builtin_ctz(byte);
+        set_bit(columns[8 * byte_i + bit_i].data(), i);
+        byte &= byte - 1;
+      }
+    }
+  }
+}
+
+// hash a COT into a random OT output of bitlen bits, as BitMatrix::SenderTransposeAndEncrypt
+void hash_output(PRG& prg_fixed_key, PRG& prg_var_key, block128_t block, std::size_t bitlen,
+                 BitVector<>& output) {
+  constexpr std::size_t kappa = 128;
+  prg_fixed_key.MMO(block.data());
+  if (bitlen <= kappa) {
+    output = BitVector<>(block.data(), kappa);
+    output.Resize(bitlen);
+  } else {
+    // string OT with bit length > 128 bit
+    prg_var_key.SetKey(block.data());
+    output =
+        BitVector<>(prg_var_key.Encrypt(MOTION::Helpers::Convert::BitsToBytes(bitlen)), bitlen);
+  }
+}
+
+// move the new COTs to the end of the pool, after removing the consumed base COTs
+void replace_base_cots(block128_vector& pool, std::size_t num_base_cots,
+                       const block128_vector& outputs) {
+  const auto offset = pool.size() - num_base_cots;
+  pool.resize(offset + outputs.size());
+  std::copy(std::begin(outputs), std::end(outputs), std::begin(pool) + offset);
+}
+
+std::vector<std::uint8_t> receive_silent_ot_message(
+    ENCRYPTO::SynchronizedQueue<std::pair<std::size_t, std::vector<std::uint8_t>>>& queue,
+    std::size_t expected_step, std::size_t expected_size) {
+  auto message = queue.dequeue();
+  if (!message.has_value()) {
+    throw std::runtime_error("OTProviderFromSilentOT: message queue has been closed");
+  }
+  if (message->first != expected_step || message->second.size() != expected_size) {
+    throw std::runtime_error(fmt::format(
+        "OTProviderFromSilentOT: expected message of step {} with {} B, but got step {} with {} B",
+        expected_step, expected_size, message->first, message->second.size()));
+  }
+  return std::move(message->second);
+}
+
+}  // namespace
+
+const SilentOTParameters& choose_silent_ot_parameters(std::size_t pool_size,
+                                                      std::size_t target_size) {
+  const auto& small = silent_ot_parameters_small;
+  const auto& large = silent_ot_parameters_large;
+  if (pool_size >= large.get_num_base_cots() &&
+      target_size - pool_size > small.num_outputs - small.get_num_base_cots()) {
+    return large;
+  }
+  return small;
+}
+
+SilentOTSender::SilentOTSender(const SilentOTParameters& parameters, const block128_t& delta,
+                               PRG& fixed_key_prg)
+    : parameters_(parameters), delta_(delta), fixed_key_prg_(fixed_key_prg) {}
+
+block128_vector SilentOTSender::expand(const block128_t* base_cots,
+                                       std::span<const std::uint8_t> receiver_message,
+                                       std::vector<std::uint8_t>& sender_message,
+                                       std::uint64_t iteration) {
+  const std::size_t num_trees = parameters_.num_trees;
+  const std::size_t tree_depth = parameters_.tree_depth;
+  const std::size_t tree_size = parameters_.get_tree_size();
+  const std::size_t num_lpn_inputs = parameters_.num_lpn_inputs;
+  if (receiver_message.size() != parameters_.get_receiver_message_size()) {
+    throw std::invalid_argument(
+        fmt::format("SilentOTSender: expected message of {} B, but got {} B",
+                    parameters_.get_receiver_message_size(), receiver_message.size()));
+  }
+  const auto* round_keys = fixed_key_prg_.get_round_keys();
+
+  // expand the GGM trees, the leaves of tree j are the noise vector v at [j * 2^h, (j+1) * 2^h)
+  auto roots = block128_vector::make_random(num_trees);
+  block128_vector outputs(parameters_.num_outputs);
+  block128_vector level_keys(2 * num_trees * tree_depth);
+  block128_vector tree_sums(num_trees);
+#pragma omp parallel for
+  for (std::size_t tree_i = 0; tree_i < num_trees; ++tree_i) {
+    auto* nodes = &outputs[tree_i * tree_size];
+    nodes[0] = roots[tree_i];
+    for (std::size_t level_i = 0; level_i < tree_depth; ++level_i) {
+      aesni_ggm_expand_level(round_keys, nodes, std::size_t(1) << level_i);
+      // sums of the left and of the right children on this level
+      auto& key_0 = level_keys[2 * (tree_i * tree_depth + level_i)];
+      auto& key_1 = level_keys[2 * (tree_i * tree_depth + level_i) + 1];
+      key_0.set_to_zero();
+      key_1.set_to_zero();
+      for (std::size_t node_i = 0; node_i < (std::size_t(2) << level_i); node_i += 2) {
+        key_0 ^= nodes[node_i];
+        key_1 ^= nodes[node_i + 1];
+      }
+    }
+    auto& sum = tree_sums[tree_i];
+    sum = delta_;
+    for (std::size_t node_i = 0; node_i < tree_size; ++node_i) {
+      sum ^= nodes[node_i];
+    }
+  }
+
+  // encrypt the keys with the base COTs, s.t. the receiver can only decrypt the sums of the
+  // siblings of its punctured path
+  sender_message.resize(parameters_.get_sender_message_size());
+  auto* message = reinterpret_cast<std::byte*>(sender_message.data());
+  for (std::size_t cot_i = 0; cot_i < num_trees * tree_depth; ++cot_i) {
+    const auto& q = base_cots[num_lpn_inputs + cot_i];
+    const bool correction = get_bit(receiver_message.data(), cot_i);
+    const auto input_0 = correction ? q ^ delta_ : q;
+    const auto input_1 = correction ? q : q ^ delta_;
+    const auto tweak = level_tweak(iteration, cot_i);
+    auto mask_0 = block128_t::make_zero();
+    auto mask_1 = block128_t::make_zero();
+    fixed_key_prg_.FixedKeyAES(input_0.data(), tweak, mask_0.data());
+    fixed_key_prg_.FixedKeyAES(input_1.data(), tweak, mask_1.data());
+    mask_0 ^= level_keys[2 * cot_i];
+    mask_1 ^= level_keys[2 * cot_i + 1];
+    std::copy_n(mask_0.data(), block128_t::size(), message + (2 * cot_i) * block128_t::size());
+    std::copy_n(mask_1.data(), block128_t::size(), message + (2 * cot_i + 1) * block128_t::size());
+  }
+  std::copy_n(tree_sums[0].data(), tree_sums.byte_size(),
+              message + 2 * num_trees * tree_depth * block128_t::size());
+
+  // y = v + A * q
+  for_each_lpn_row(parameters_, fixed_key_prg_, iteration,
+                   [&outputs, base_cots](std::size_t row_i, const std::uint32_t* indices) {
+                     auto& output = outputs[row_i];
+                     for (std::size_t w = 0; w < SilentOTParameters::lpn_weight; ++w) {
+                       output ^= base_cots[indices[w]];
+                     }
+                   });
+  return outputs;
+}
+
+SilentOTReceiver::SilentOTReceiver(const SilentOTParameters& parameters, PRG& fixed_key_prg)
+    : parameters_(parameters), fixed_key_prg_(fixed_key_prg) {}
+
+std::vector<std::uint8_t> SilentOTReceiver::choose(const std::uint8_t* base_choices) {
+  const std::size_t num_trees = parameters_.num_trees;
+  const std::size_t tree_depth = parameters_.tree_depth;
+  const std::size_t num_lpn_inputs = parameters_.num_lpn_inputs;
+
+  auto randomness = block128_vector::make_random(num_trees);
+  noise_positions_.resize(num_trees);
+  std::vector<std::uint8_t> message(parameters_.get_receiver_message_size(), 0);
+  for (std::size_t tree_i = 0; tree_i < num_trees; ++tree_i) {
+    std::uint64_t position;
+    std::copy_n(randomness[tree_i].data(), sizeof(position),
+                reinterpret_cast<std::byte*>(&position));
+    position &= parameters_.get_tree_size() - 1;
+    noise_positions_[tree_i] = position;
+    // correct the choice of each level's base COT to the side which is not on the path
+    for (std::size_t level_i = 0; level_i < tree_depth; ++level_i) {
+      const std::size_t cot_i = tree_i * tree_depth + level_i;
+      const bool path_bit = (position >> (tree_depth - 1 - level_i)) & 1;
+      if (base_choices[num_lpn_inputs + cot_i] == path_bit) {
+        set_bit(message.data(), cot_i);
+      }
+    }
+  }
+  return message;
+}
+
+void SilentOTReceiver::expand(const block128_t* base_cots, const std::uint8_t* base_choices,
+                              std::span<const std::uint8_t> sender_message,
+                              std::uint64_t iteration, block128_vector& outputs,
+                              std::vector<std::uint8_t>& choices) {
+  const std::size_t num_trees = parameters_.num_trees;
+  const std::size_t tree_depth = parameters_.tree_depth;
+  const std::size_t tree_size = parameters_.get_tree_size();
+  const std::size_t num_lpn_inputs = parameters_.num_lpn_inputs;
+  if (noise_positions_.size() != num_trees) {
+    throw std::logic_error("SilentOTReceiver: choose() needs to be called before expand()");
+  }
+  if (sender_message.size() != parameters_.get_sender_message_size()) {
+    throw std::invalid_argument(
+        fmt::format("SilentOTReceiver: expected message of {} B, but got {} B",
+                    parameters_.get_sender_message_size(), sender_message.size()));
+  }
+  const auto* round_keys = fixed_key_prg_.get_round_keys();
+  const auto* message = reinterpret_cast<const std::byte*>(sender_message.data());
+
+  // decrypt the sums of the siblings of the punctured paths
+  block128_vector level_keys(num_trees * tree_depth);
+  for (std::size_t cot_i = 0; cot_i < num_trees * tree_depth; ++cot_i) {
+    const std::size_t tree_i = cot_i / tree_depth;
+    const std::size_t level_i = cot_i % tree_depth;
+    const bool path_bit = (noise_positions_[tree_i] >> (tree_depth - 1 - level_i)) & 1;
+    auto& key = level_keys[cot_i];
+    fixed_key_prg_.FixedKeyAES(base_cots[num_lpn_inputs + cot_i].data(),
+                               level_tweak(iteration, cot_i), key.data());
+    key ^= message + (2 * cot_i + !path_bit) * block128_t::size();
+  }
+  const auto* tree_sums = message + 2 * num_trees * tree_depth * block128_t::size();
+
+  // recompute all leaves except the punctured one, which gets w = v + delta
+  outputs.resize(parameters_.num_outputs);
+  choices.assign(parameters_.num_outputs, 0);
+#pragma omp parallel for
+  for (std::size_t tree_i = 0; tree_i < num_trees; ++tree_i) {
+    auto* nodes = &outputs[tree_i * tree_size];
+    nodes[0].set_to_zero();
+    std::size_t path = 0;
+    for (std::size_t level_i = 0; level_i < tree_depth; ++level_i) {
+      // the children of the path node are garbage and fixed below
+      aesni_ggm_expand_level(round_keys, nodes, std::size_t(1) << level_i);
+      const bool path_bit = (noise_positions_[tree_i] >> (tree_depth - 1 - level_i)) & 1;
+      const std::size_t sibling = 2 * path + !path_bit;
+      auto& sibling_node = nodes[sibling];
+      sibling_node = level_keys[tree_i * tree_depth + level_i];
+      for (std::size_t node_i = !path_bit; node_i < (std::size_t(2) << level_i); node_i += 2) {
+        if (node_i != sibling) {
+          sibling_node ^= nodes[node_i];
+        }
+      }
+      path = 2 * path + path_bit;
+      nodes[path].set_to_zero();
+    }
+    auto& punctured_node = nodes[path];
+    punctured_node.load_from_memory(tree_sums + tree_i * block128_t::size());
+    for (std::size_t node_i = 0; node_i < tree_size; ++node_i) {
+      if (node_i != path) {
+        punctured_node ^= nodes[node_i];
+      }
+    }
+    choices[tree_i * tree_size + path] = 1;
+  }
+  noise_positions_.clear();
+
+  // z = w + A * t and x = e + A * r
+  for_each_lpn_row(parameters_, fixed_key_prg_, iteration,
+                   [&outputs, &choices, base_cots, base_choices](std::size_t row_i,
+                                                                const std::uint32_t* indices) {
+                     auto& output = outputs[row_i];
+                     auto& choice = choices[row_i];
+                     for (std::size_t w = 0; w < SilentOTParameters::lpn_weight; ++w) {
+                       output ^= base_cots[indices[w]];
+                       choice ^= base_choices[indices[w]];
+                     }
+                   });
+}
+
+OTProviderFromSilentOT::OTProviderFromSilentOT(
+    std::function<void(flatbuffers::FlatBufferBuilder&&)> Send, MOTION::OTExtensionData& data,
+    const MOTION::BaseOTsData& base_ot_data,
+    MOTION::Crypto::MotionBaseProvider& motion_base_provider, std::size_t party_id,
+    std::shared_ptr<MOTION::Logger> logger)
+    : OTProvider(Send, data, party_id, logger),
+      base_ot_data_(base_ot_data),
+      motion_base_provider_(motion_base_provider) {
+  auto& ot_ext_rcv = data_.GetReceiverData();
+  ot_ext_rcv.real_choices_ = std::make_unique<BitVector<>>();
+}
+
+void OTProviderFromSilentOT::BootstrapSend(std::size_t num_cots) {
+  constexpr std::size_t kappa = 128;
+  const auto& base_ots_rcv = base_ot_data_.GetReceiverData();
+  auto& ot_ext_snd = data_.GetSenderData();
+  const std::size_t num_cots_padded = (num_cots + kappa - 1) / kappa * kappa;
+  const std::size_t byte_size = num_cots_padded / 8;
+
+  // the correlation of all COTs are the choices of the base OTs
+  delta_.set_to_zero();
+  for (std::size_t i = 0; i < kappa; ++i) {
+    if (base_ots_rcv.c_.Get(i)) {
+      set_bit(delta_.data(), i);
+    }
+  }
+
+  const auto masks = receive_silent_ot_message(ot_ext_snd.silent_ot_messages_,
+                                               2 * sender_iteration_, kappa * byte_size);
+  std::vector<std::vector<std::byte>> rows(kappa);
+  PRG prg_var_key;
+  const std::size_t consumed_offset = ot_ext_snd.consumed_offset_base_ots_;
+  for (std::size_t i = 0; i < kappa; ++i) {
+    prg_var_key.SetKey(base_ots_rcv.messages_c_.at(i).data());
+    prg_var_key.SetOffset(base_ots_rcv.consumed_offset_ + consumed_offset);
+    rows[i] = prg_var_key.Encrypt(byte_size);
+    if (base_ots_rcv.c_.Get(i)) {
+      const auto* mask = reinterpret_cast<const std::byte*>(masks.data()) + i * byte_size;
+      std::transform(mask, mask + byte_size, rows[i].data(), rows[i].data(),
+                     [](auto a, auto b) { return a ^ b; });
+    }
+  }
+  ot_ext_snd.consumed_offset_base_ots_ += num_cots_padded / kappa;
+
+  const auto offset = sender_pool_.size();
+  sender_pool_.resize(offset + num_cots_padded);
+  transpose_rows(rows, num_cots_padded, &sender_pool_[offset]);
+}
+
+void OTProviderFromSilentOT::BootstrapReceive(std::size_t num_cots) {
+  constexpr std::size_t kappa = 128;
+  const auto& base_ots_snd = base_ot_data_.GetSenderData();
+  auto& ot_ext_rcv = data_.GetReceiverData();
+  const std::size_t num_cots_padded = (num_cots + kappa - 1) / kappa * kappa;
+  const std::size_t byte_size = num_cots_padded / 8;
+
+  const auto random_choices = AlignedBitVector::Random(num_cots_padded);
+  const auto* choices = random_choices.GetData().data();
+  std::vector<std::vector<std::byte>> rows(kappa);
+  std::vector<std::byte> masks(kappa * byte_size);
+  PRG prg_var_key;
+  const std::size_t consumed_offset = ot_ext_rcv.consumed_offset_base_ots_;
+  for (std::size_t i = 0; i < kappa; ++i) {
+    // T[i] = PRG(s_{i,0}) and U[i] = T[i] ^ PRG(s_{i,1}) ^ r
+    prg_var_key.SetKey(base_ots_snd.messages_0_.at(i).data());
+    prg_var_key.SetOffset(base_ots_snd.consumed_offset_ + consumed_offset);
+    rows[i] = prg_var_key.Encrypt(byte_size);
+    prg_var_key.SetKey(base_ots_snd.messages_1_.at(i).data());
+    prg_var_key.SetOffset(base_ots_snd.consumed_offset_ + consumed_offset);
+    const auto row_1 = prg_var_key.Encrypt(byte_size);
+    for (std::size_t byte_i = 0; byte_i < byte_size; ++byte_i) {
+      masks[i * byte_size + byte_i] = rows[i][byte_i] ^ row_1[byte_i] ^ choices[byte_i];
+    }
+  }
+  Send_(MOTION::Communication::BuildSilentOTMessageReceiver(masks.data(), masks.size(),
+                                                            2 * receiver_iteration_));
+  ot_ext_rcv.consumed_offset_base_ots_ += num_cots_padded / kappa;
+
+  const auto offset = receiver_pool_.size();
+  receiver_pool_.resize(offset + num_cots_padded);
+  transpose_rows(rows, num_cots_padded, &receiver_pool_[offset]);
+  receiver_pool_choices_.resize(offset + num_cots_padded);
+  for (std::size_t j = 0; j < num_cots_padded; ++j) {
+    receiver_pool_choices_[offset + j] =
+        get_bit(reinterpret_cast<const std::uint8_t*>(choices), j);
+  }
+}
+
+void OTProviderFromSilentOT::GrowSenderPool(std::size_t num_ots, PRG& prg_fixed_key) {
+  auto& ot_ext_snd = data_.GetSenderData();
+  // keep enough COTs for the next iteration, s.t. the base OTs are only used once
+  const std::size_t target_size = num_ots + silent_ot_parameters_small.get_num_base_cots();
+  while (sender_pool_.size() < target_size) {
+    const auto& parameters = choose_silent_ot_parameters(sender_pool_.size(), target_size);
+    const std::size_t num_base_cots = parameters.get_num_base_cots();
+    if (sender_pool_.size() < num_base_cots) {
+      BootstrapSend(num_base_cots - sender_pool_.size());
+    }
+    const auto receiver_message =
+        receive_silent_ot_message(ot_ext_snd.silent_ot_messages_, 2 * sender_iteration_ + 1,
+                                  parameters.get_receiver_message_size());
+    std::vector<std::uint8_t> sender_message;
+    SilentOTSender sender(parameters, delta_, prg_fixed_key);
+    auto outputs = sender.expand(&sender_pool_[sender_pool_.size() - num_base_cots],
+                                 receiver_message, sender_message, sender_iteration_);
+    Send_(MOTION::Communication::BuildSilentOTMessageSender(
+        reinterpret_cast<const std::byte*>(sender_message.data()), sender_message.size(),
+        sender_iteration_));
+    ++sender_iteration_;
+    replace_base_cots(sender_pool_, num_base_cots, outputs);
+  }
+}
+
+void OTProviderFromSilentOT::GrowReceiverPool(std::size_t num_ots, PRG& prg_fixed_key) {
+  auto& ot_ext_rcv = data_.GetReceiverData();
+  const std::size_t target_size = num_ots + silent_ot_parameters_small.get_num_base_cots();
+  while (receiver_pool_.size() < target_size) {
+    const auto& parameters = choose_silent_ot_parameters(receiver_pool_.size(), target_size);
+    const std::size_t num_base_cots = parameters.get_num_base_cots();
+    if (receiver_pool_.size() < num_base_cots) {
+      BootstrapReceive(num_base_cots - receiver_pool_.size());
+    }
+    const auto base_offset = receiver_pool_.size() - num_base_cots;
+    SilentOTReceiver receiver(parameters, prg_fixed_key);
+    const auto receiver_message = receiver.choose(&receiver_pool_choices_[base_offset]);
+    Send_(MOTION::Communication::BuildSilentOTMessageReceiver(
+        reinterpret_cast<const std::byte*>(receiver_message.data()), receiver_message.size(),
+        2 * receiver_iteration_ + 1));
+    const auto sender_message =
+        receive_silent_ot_message(ot_ext_rcv.silent_ot_messages_, receiver_iteration_,
+                                  parameters.get_sender_message_size());
+    block128_vector outputs;
+    std::vector<std::uint8_t> choices;
+    receiver.expand(&receiver_pool_[base_offset], &receiver_pool_choices_[base_offset],
+                    sender_message, receiver_iteration_, outputs, choices);
+    ++receiver_iteration_;
+    replace_base_cots(receiver_pool_, num_base_cots, outputs);
+    receiver_pool_choices_.resize(base_offset);
+    receiver_pool_choices_.insert(std::end(receiver_pool_choices_), std::begin(choices),
+                                  std::end(choices));
+  }
+}
+
+void OTProviderFromSilentOT::SendFillPool(std::size_t num_ots) {
+  motion_base_provider_.setup();
+  PRG prg_fixed_key;
+  prg_fixed_key.SetKey(motion_base_provider_.get_aes_fixed_key().data());
+  GrowSenderPool(num_ots, prg_fixed_key);
+}
+
+void OTProviderFromSilentOT::ReceiveFillPool(std::size_t num_ots) {
+  motion_base_provider_.setup();
+  PRG prg_fixed_key;
+  prg_fixed_key.SetKey(motion_base_provider_.get_aes_fixed_key().data());
+  GrowReceiverPool(num_ots, prg_fixed_key);
+}
+
+void OTProviderFromSilentOT::SendSetup() {
+  if constexpr (MOTION::MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("OTProviderFromSilentOT::SendSetup() start");
+    }
+  }
+
+  auto& ot_ext_snd = data_.GetSenderData();
+  const std::size_t num_ots = sender_provider_.GetNumOTs();
+  if (num_ots == 0) {
+    if constexpr (MOTION::MOTION_DEBUG) {
+      if (logger_) {
+        logger_->LogDebug("OTProviderFromSilentOT::SendSetup() return, nothing to do");
+      }
+    }
+    return;  // no OTs needed
+  }
+  ot_ext_snd.bit_size_ = num_ots;
+
+  motion_base_provider_.setup();
+  PRG prg_fixed_key;
+  prg_fixed_key.SetKey(motion_base_provider_.get_aes_fixed_key().data());
+  // without communication if the pool has been filled in advance
+  GrowSenderPool(num_ots, prg_fixed_key);
+
+  // hash the COTs at the end of the pool into the random OTs
+  const auto offset = sender_pool_.size() - num_ots;
+  PRG prg_var_key;
+  for (std::size_t i = 0; i < num_ots; ++i) {
+    const auto bitlen = ot_ext_snd.bitlengths_.at(i);
+    const auto& q = sender_pool_[offset + i];
+    hash_output(prg_fixed_key, prg_var_key, q, bitlen, ot_ext_snd.y0_.at(i));
+    hash_output(prg_fixed_key, prg_var_key, q ^ delta_, bitlen, ot_ext_snd.y1_.at(i));
+  }
+  sender_pool_.resize(offset);
+
+  // we are done with the setup for the sender side
+  {
+    std::scoped_lock lock(ot_ext_snd.setup_finished_cond_->GetMutex());
+    ot_ext_snd.setup_finished_ = true;
+  }
+  ot_ext_snd.setup_finished_cond_->NotifyAll();
+  ot_ext_snd.ots_ready_->Raise(num_ots);
+
+  if constexpr (MOTION::MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("OTProviderFromSilentOT::SendSetup() end");
+    }
+  }
+}
+
+void OTProviderFromSilentOT::ReceiveSetup() {
+  if constexpr (MOTION::MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("OTProviderFromSilentOT::ReceiveSetup() start");
+    }
+  }
+
+  auto& ot_ext_rcv = data_.GetReceiverData();
+  const std::size_t num_ots = receiver_provider_.GetNumOTs();
+  if (num_ots == 0) {
+    if constexpr (MOTION::MOTION_DEBUG) {
+      if (logger_) {
+        logger_->LogDebug("OTProviderFromSilentOT::ReceiveSetup() return, nothing to do");
+      }
+    }
+    return;  // nothing to do
+  }
+
+  motion_base_provider_.setup();
+  PRG prg_fixed_key;
+  prg_fixed_key.SetKey(motion_base_provider_.get_aes_fixed_key().data());
+  GrowReceiverPool(num_ots, prg_fixed_key);
+
+  // hash the COTs at the end of the pool into the random OTs
+  const auto offset = receiver_pool_.size() - num_ots;
+  ot_ext_rcv.random_choices_ = std::make_unique<AlignedBitVector>(num_ots);
+  PRG prg_var_key;
+  for (std::size_t i = 0; i < num_ots; ++i) {
+    ot_ext_rcv.random_choices_->Set(receiver_pool_choices_[offset + i] != 0, i);
+    std::unique_lock lock(ot_ext_rcv.bitlengths_mutex_);
+    const auto bitlen = ot_ext_rcv.bitlengths_.at(i);
+    lock.unlock();
+    hash_output(prg_fixed_key, prg_var_key, receiver_pool_[offset + i], bitlen,
+                ot_ext_rcv.outputs_.at(i));
+  }
+  receiver_pool_.resize(offset);
+  receiver_pool_choices_.resize(offset);
+
+  {
+    std::scoped_lock lock(ot_ext_rcv.setup_finished_cond_->GetMutex());
+    ot_ext_rcv.setup_finished_ = true;
+  }
+  ot_ext_rcv.setup_finished_cond_->NotifyAll();
+  ot_ext_rcv.ots_ready_->Raise(num_ots);
+
+  if constexpr (MOTION::MOTION_DEBUG) {
+    if (logger_) {
+      logger_->LogDebug("OTProviderFromSilentOT::ReceiveSetup() end");
+    }
+  }
+}
+
+}  // namespace ENCRYPTO::ObliviousTransfer
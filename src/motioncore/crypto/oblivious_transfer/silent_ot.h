@@ -0,0 +1,161 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "ot_provider.h"
+#include "utility/block.h"
+
+namespace ENCRYPTO {
+
+class PRG;
+
+namespace ObliviousTransfer {
+
+// Parameters of one iteration of the silent OT generator based on the primal LPN problem with
+// regular noise as in Ferret (https://eprint.iacr.org/2020/924): num_lpn_inputs base COTs are
+// expanded with a sparse public matrix, and the noise consists of num_trees unit vectors of
+// length 2^tree_depth which are shared with punctured GGM trees.
+struct SilentOTParameters {
+  std::size_t num_outputs;     // n = num_trees * 2^tree_depth
+  std::size_t num_trees;       // t, the weight of the noise
+  std::size_t tree_depth;      // h, the depth of each GGM tree
+  std::size_t num_lpn_inputs;  // k, the dimension of the LPN secret
+
+  // number of non-zero entries per row of the LPN matrix
+  static constexpr std::size_t lpn_weight = 10;
+
+  std::size_t get_tree_size() const noexcept { return std::size_t(1) << tree_depth; }
+  // number of base COTs consumed by one iteration
+  std::size_t get_num_base_cots() const noexcept {
+    return num_lpn_inputs + num_trees * tree_depth;
+  }
+  // size of the message from the receiver: one bit per GGM tree level
+  std::size_t get_receiver_message_size() const noexcept {
+    return (num_trees * tree_depth + 7) / 8;
+  }
+  // size of the message from the sender: two keys per GGM tree level and the sum of each tree
+  std::size_t get_sender_message_size() const noexcept {
+    return num_trees * (2 * tree_depth + 1) * block128_t::size();
+  }
+};
+
+// parameter sets from Ferret with 128 bit security
+inline constexpr SilentOTParameters silent_ot_parameters_small{649'728, 1'269, 9, 36'288};
+inline constexpr SilentOTParameters silent_ot_parameters_large{10'608'640, 1'295, 13, 589'760};
+
+// Select the parameters for the next iteration, s.t. a pool containing pool_size COTs grows
+// towards target_size.  The large parameters are used once the pool can pay for them.
+const SilentOTParameters& choose_silent_ot_parameters(std::size_t pool_size,
+                                                      std::size_t target_size);
+
+// Sender side of one iteration.  The base COTs are given as q_i, where the receiver holds
+// t_i = q_i ^ r_i * delta, and the generated COTs have the same form.
+class SilentOTSender {
+ public:
+  // fixed_key_prg needs to be keyed with a key known to both parties
+  SilentOTSender(const SilentOTParameters& parameters, const block128_t& delta,
+                 PRG& fixed_key_prg);
+
+  // Consume get_num_base_cots() base COTs and the message of the receiver.  Writes the message
+  // for the receiver and returns num_outputs new COTs.  Both parties need to use the same
+  // iteration number, which must not be reused with the same delta.
+  block128_vector expand(const block128_t* base_cots,
+                         std::span<const std::uint8_t> receiver_message,
+                         std::vector<std::uint8_t>& sender_message, std::uint64_t iteration);
+
+ private:
+  const SilentOTParameters parameters_;
+  const block128_t delta_;
+  PRG& fixed_key_prg_;
+};
+
+// Receiver side of one iteration.
+class SilentOTReceiver {
+ public:
+  SilentOTReceiver(const SilentOTParameters& parameters, PRG& fixed_key_prg);
+
+  // Choose the positions of the noise and compute the message for the sender from the choice
+  // bits (one byte per COT with value 0 or 1) of the base COTs.
+  std::vector<std::uint8_t> choose(const std::uint8_t* base_choices);
+
+  // Consume get_num_base_cots() base COTs and the message of the sender.  Writes num_outputs
+  // new COTs and their choice bits.
+  void expand(const block128_t* base_cots, const std::uint8_t* base_choices,
+              std::span<const std::uint8_t> sender_message, std::uint64_t iteration,
+              block128_vector& outputs, std::vector<std::uint8_t>& choices);
+
+ private:
+  const SilentOTParameters parameters_;
+  PRG& fixed_key_prg_;
+  // punctured position of each GGM tree
+  std::vector<std::size_t> noise_positions_;
+};
+
+// OT provider whose random OTs are generated with the silent OT generator from a pool of COTs.
+// The pool is bootstrapped once from the base OTs with an IKNP style OT extension and then only
+// grows by iterations of the generator, so that the communication of the setup is almost
+// independent of the number of OTs.  The construction is secure against semi-honest adversaries.
+class OTProviderFromSilentOT final : public OTProvider {
+ public:
+  void SendSetup() final;
+
+  void ReceiveSetup() final;
+
+  void SendFillPool(std::size_t num_ots) final;
+  void ReceiveFillPool(std::size_t num_ots) final;
+
+  OTProviderFromSilentOT(std::function<void(flatbuffers::FlatBufferBuilder&&)> Send,
+                         MOTION::OTExtensionData& data, const MOTION::BaseOTsData& base_ot_data,
+                         MOTION::Crypto::MotionBaseProvider&, std::size_t party_id,
+                         std::shared_ptr<MOTION::Logger> logger);
+
+ private:
+  // extend the pools with the base OTs, without hashing the outputs
+  void BootstrapSend(std::size_t num_cots);
+  void BootstrapReceive(std::size_t num_cots);
+  // run iterations of the generator until the pools hold num_ots COTs in addition to the base
+  // COTs of the next iteration
+  void GrowSenderPool(std::size_t num_ots, PRG& prg_fixed_key);
+  void GrowReceiverPool(std::size_t num_ots, PRG& prg_fixed_key);
+
+  const MOTION::BaseOTsData& base_ot_data_;
+  MOTION::Crypto::MotionBaseProvider& motion_base_provider_;
+
+  // COTs which have not yet been handed out, they are kept over Clear() and Reset()
+  block128_t delta_;
+  block128_vector sender_pool_;
+  std::uint64_t sender_iteration_ = 0;
+  block128_vector receiver_pool_;
+  std::vector<std::uint8_t> receiver_pool_choices_;
+  std::uint64_t receiver_iteration_ = 0;
+};
+
+}  // namespace ObliviousTransfer
+}  // namespace ENCRYPTO
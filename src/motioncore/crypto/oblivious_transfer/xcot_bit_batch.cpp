@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "xcot_bit_batch.h"
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "ot_flavors.h"
+#include "ot_provider.h"
+#include "utility/construction_scope.h"
+
+namespace ENCRYPTO::ObliviousTransfer {
+
+XCOTBitBatch::XCOTBitBatch(OTProvider& ot_provider, Roles roles)
+    : ot_provider_(ot_provider),
+      roles_(roles),
+      outputs_future_(outputs_promise_.get_future().share()) {}
+
+XCOTBitBatch::~XCOTBitBatch() = default;
+
+std::size_t XCOTBitBatch::reserve(std::size_t num_ots) {
+  using MOTION::ConstructionCounter;
+  using MOTION::ConstructionScope;
+  if (auto offset = ConstructionScope::take(ConstructionCounter::batched_xcot_bits, num_ots)) {
+    num_reservations_.fetch_add(1, std::memory_order_relaxed);
+    return *offset;
+  }
+  auto offset = reserve_block(num_ots);
+  ++num_reservations_;
+  return offset;
+}
+
+std::size_t XCOTBitBatch::reserve_block(std::size_t num_ots) {
+  if (ot_sender_ != nullptr || ot_receiver_ != nullptr) {
+    throw std::logic_error("XCOTBitBatch: cannot reserve OTs after they have been registered");
+  }
+  auto offset = num_ots_;
+  num_ots_ += num_ots;
+  return offset;
+}
+
+void XCOTBitBatch::register_ots() {
+  if (ot_sender_ != nullptr || ot_receiver_ != nullptr || num_ots_ == 0) {
+    return;
+  }
+  switch (roles_) {
+    case Roles::both:
+      ot_sender_ = ot_provider_.RegisterSendXCOTBit(num_ots_);
+      ot_receiver_ = ot_provider_.RegisterReceiveXCOTBit(num_ots_);
+      break;
+    case Roles::receiver:
+      ot_receiver_ = ot_provider_.RegisterReceiveXCOTBit(2 * num_ots_);
+      break;
+    case Roles::sender:
+      ot_sender_ = ot_provider_.RegisterSendXCOTBit(2 * num_ots_);
+      break;
+  }
+  choices_ = BitVector<>(num_ots_);
+  correlations_ = BitVector<>(num_ots_);
+}
+
+BitVector<> XCOTBitBatch::compute(std::size_t offset, const BitVector<>& choices,
+                                  const BitVector<>& correlations) {
+  const auto num_ots = choices.GetSize();
+  if (ot_sender_ == nullptr && ot_receiver_ == nullptr) {
+    throw std::logic_error("XCOTBitBatch: OTs need to be registered before use");
+  }
+  if (correlations.GetSize() != num_ots || offset + num_ots > num_ots_) {
+    throw std::out_of_range(fmt::format(
+        "XCOTBitBatch: invalid access to OTs {} to {} of {}", offset, offset + num_ots, num_ots_));
+  }
+
+  bool last_contribution;
+  {
+    std::scoped_lock lock(mutex_);
+    choices_.Copy(offset, offset + num_ots, choices);
+    correlations_.Copy(offset, offset + num_ots, correlations);
+    last_contribution = ++num_contributions_ == num_reservations_;
+  }
+
+  if (last_contribution) {
+    switch (roles_) {
+      case Roles::both:
+        ot_receiver_->SetChoices(std::move(choices_));
+        ot_receiver_->SendCorrections();
+        ot_sender_->SetCorrelations(std::move(correlations_));
+        ot_sender_->SendMessages();
+        ot_receiver_->ComputeOutputs();
+        ot_sender_->ComputeOutputs();
+        outputs_ = ot_sender_->GetOutputs() ^ ot_receiver_->GetOutputs();
+        break;
+      case Roles::receiver:
+        choices_.Append(correlations_);
+        ot_receiver_->SetChoices(std::move(choices_));
+        ot_receiver_->SendCorrections();
+        ot_receiver_->ComputeOutputs();
+        outputs_ = ot_receiver_->GetOutputs();
+        break;
+      case Roles::sender:
+        correlations_.Append(choices_);
+        ot_sender_->SetCorrelations(std::move(correlations_));
+        ot_sender_->SendMessages();
+        ot_sender_->ComputeOutputs();
+        outputs_ = ot_sender_->GetOutputs();
+        break;
+    }
+    if (roles_ != Roles::both) {
+      // xor of the two products of each OT's shares
+      outputs_ = outputs_.Subset(0, num_ots_) ^ outputs_.Subset(num_ots_, 2 * num_ots_);
+    }
+    outputs_promise_.set_value();
+  }
+
+  outputs_future_.wait();
+  return outputs_.Subset(offset, offset + num_ots);
+}
+
+}  // namespace ENCRYPTO::ObliviousTransfer
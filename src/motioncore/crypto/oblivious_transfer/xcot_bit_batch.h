@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <boost/fiber/future.hpp>
+
+#include "utility/bit_vector.h"
+
+namespace ENCRYPTO::ObliviousTransfer {
+
+class OTProvider;
+class XCOTBitSender;
+class XCOTBitReceiver;
+
+// Combines the xor-correlated bit OTs of many gates into a single sender/receiver pair of an
+// OTProvider, such that the whole batch requires only one correction message and one sender
+// message per direction.
+//
+// Usage: every gate reserves its OTs with reserve() when it is created.  Then register_ots()
+// registers the combined OTs with the OTProvider, which needs to happen before the OT extension
+// setup.  In the setup phase, every gate passes its choices and correlations to compute(), which
+// blocks until all gates of the batch have done so.  Hence, the gates need to be evaluated
+// concurrently.
+class XCOTBitBatch {
+ public:
+  // With both, each party is receiver of one half and sender of the other half of the OTs.  With
+  // receiver or sender, this party is receiver or sender of all of them, and the other party needs
+  // to take the opposite role.  Then the receiver's choices are followed by its correlations and
+  // the sender's correlations by its choices, so the products are the same in all modes.
+  enum class Roles : std::uint8_t { both, receiver, sender };
+
+  explicit XCOTBitBatch(OTProvider&, Roles = Roles::both);
+  ~XCOTBitBatch();
+
+  // reserve num_ots OTs in each direction and return their offset in the batch, within a
+  // MOTION::ConstructionScope they are taken from the block of the calling thread
+  std::size_t reserve(std::size_t num_ots);
+  // reserve the OTs of the gates of a ConstructionScope, which are only counted as reservations
+  // when the gates take them from the block
+  std::size_t reserve_block(std::size_t num_ots);
+  void register_ots();
+  std::size_t get_num_ots() const noexcept { return num_ots_; }
+
+  // Act as receiver with the given choices and as sender with the given correlations on the OTs
+  // at [offset, offset + choices.GetSize()).  Returns the xor of the sender and receiver outputs.
+  BitVector<> compute(std::size_t offset, const BitVector<>& choices,
+                      const BitVector<>& correlations);
+
+ private:
+  OTProvider& ot_provider_;
+  Roles roles_;
+  std::size_t num_ots_ = 0;
+  std::atomic<std::size_t> num_reservations_ = 0;
+  std::unique_ptr<XCOTBitSender> ot_sender_;
+  std::unique_ptr<XCOTBitReceiver> ot_receiver_;
+
+  std::mutex mutex_;
+  std::size_t num_contributions_ = 0;
+  BitVector<> choices_;
+  BitVector<> correlations_;
+  BitVector<> outputs_;
+  boost::fibers::promise<void> outputs_promise_;
+  boost::fibers::shared_future<void> outputs_future_;
+};
+
+}  // namespace ENCRYPTO::ObliviousTransfer
@@ -64,6 +64,12 @@ std::vector<std::byte> PRG::Encrypt(const std::size_t bytes) {
   return output;
 }
 
+void PRG::EncryptBlocks(std::byte *output, const std::size_t block_offset,
+                        const std::size_t num_blocks) const {
+  std::uint64_t counter = offset_ + block_offset;
+  aesni_ctr_stream_blocks_128(round_keys_.data(), &counter, output, num_blocks);
+}
+
 std::vector<std::byte> PRG::Encrypt(const std::byte *input, const std::size_t bytes) {
   const uint remainder = (bytes & 15u) > 0 ? 1 : 0;
   const std::size_t num_blocks = (bytes / 16) + remainder;
@@ -59,6 +59,12 @@ class PRG {
 
   std::vector<std::byte> Encrypt(const std::byte *input, const std::size_t bytes);
 
+  // write num_blocks blocks of the stream of Encrypt(bytes), starting block_offset blocks after
+  // the current offset, into the 16B aligned output without allocating.  The PRG is not modified,
+  // so several threads can fill disjoint parts of the stream at once.
+  void EncryptBlocks(std::byte *output, const std::size_t block_offset,
+                     const std::size_t num_blocks) const;
+
   std::vector<std::byte> FixedKeyAES(const std::byte *x, const std::uint64_t i,
                                      const std::size_t num = 1);
 
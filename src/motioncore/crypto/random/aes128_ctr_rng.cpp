@@ -20,15 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include "aes128_ctr_rng.h"
 #include "crypto/aes/aesni_primitives.h"
 
 thread_local AES128_CTR_RNG AES128_CTR_RNG::thread_instance_;
 
+namespace {
+
+// use the 512 bit VAES instructions for CTR streams of this many blocks if the CPU supports them
+constexpr std::size_t vaes_min_blocks = 16;
+
+}  // namespace
+
 struct AES128_CTR_RNG::AES128_CTR_RNG_State {
   alignas(aes_block_size) std::array<std::byte, aes_round_keys_size_128> round_keys;
   std::uint64_t counter;
+  // random bytes [buffer_offset, buffer_size) of the buffer have not been handed out yet
+  alignas(64) std::array<std::byte, buffer_size> buffer;
+  std::size_t buffer_offset;
 };
 
 AES128_CTR_RNG::AES128_CTR_RNG() : state_(std::make_unique<AES128_CTR_RNG_State>()) {
@@ -53,28 +65,56 @@ void AES128_CTR_RNG::sample_key() {
   // execute key schedule
   aesni_key_expansion_128(state_->round_keys.data());
 
-  // reset counter
+  // reset counter and discard the bytes generated with the old key
   state_->counter = 0;
+  state_->buffer_offset = buffer_size;
 }
 
 void AES128_CTR_RNG::random_blocks_aligned(std::byte* output, std::size_t num_blocks) {
+  if (num_blocks >= vaes_min_blocks && vaes_supported()) {
+    vaes_ctr_stream_blocks_128_unaligned(state_->round_keys.data(), &state_->counter, output,
+                                         num_blocks);
+    return;
+  }
   std::byte* aligned_output = reinterpret_cast<std::byte*>(__builtin_assume_aligned(output, 16));
   aesni_ctr_stream_blocks_128(state_->round_keys.data(), &state_->counter, aligned_output,
                               num_blocks);
 }
 
 void AES128_CTR_RNG::random_blocks(std::byte* output, std::size_t num_blocks) {
+  if (num_blocks >= vaes_min_blocks && vaes_supported()) {
+    vaes_ctr_stream_blocks_128_unaligned(state_->round_keys.data(), &state_->counter, output,
+                                         num_blocks);
+    return;
+  }
   aesni_ctr_stream_blocks_128_unaligned(state_->round_keys.data(), &state_->counter, output,
                                         num_blocks);
 }
 
+void AES128_CTR_RNG::refill_buffer() {
+  random_blocks_aligned(state_->buffer.data(), buffer_size / aes_block_size);
+  state_->buffer_offset = 0;
+}
+
 void AES128_CTR_RNG::random_bytes(std::byte* output, std::size_t num_bytes) {
-  std::size_t num_blocks = num_bytes / aes_block_size;
-  std::size_t remaining_bytes = num_bytes % aes_block_size;
-  random_blocks(output, num_blocks);
-  std::array<std::byte, aes_block_size> extra_block;
-  aesni_ctr_stream_single_block_128_unaligned(state_->round_keys.data(), &state_->counter,
-                                              extra_block.data());
-  std::copy(std::begin(extra_block), std::begin(extra_block) + remaining_bytes,
-            output + num_bytes - remaining_bytes);
+  auto& buffer = state_->buffer;
+  auto& buffer_offset = state_->buffer_offset;
+  // large requests are generated directly into the output, only the last partial block is taken
+  // from the buffer
+  if (num_bytes >= buffer_size) {
+    const std::size_t num_blocks = num_bytes / aes_block_size;
+    random_blocks(output, num_blocks);
+    output += num_blocks * aes_block_size;
+    num_bytes -= num_blocks * aes_block_size;
+  }
+  while (num_bytes > 0) {
+    if (buffer_offset == buffer_size) {
+      refill_buffer();
+    }
+    const std::size_t n = std::min(num_bytes, buffer_size - buffer_offset);
+    std::copy_n(buffer.data() + buffer_offset, n, output);
+    buffer_offset += n;
+    output += n;
+    num_bytes -= n;
+  }
 }
@@ -43,6 +43,7 @@ class AES128_CTR_RNG : public RNG {
   virtual void sample_key();
 
   // fill the output buffer with num_bytes random bytes
+  // * small requests are served from an internal buffer that is refilled in large chunks
   virtual void random_bytes(std::byte* output, std::size_t num_bytes);
 
   // fill the output buffer with num_blocks random blocks of size block_size
@@ -55,7 +56,12 @@ class AES128_CTR_RNG : public RNG {
   static AES128_CTR_RNG& get_thread_instance() { return thread_instance_; }
 
   static constexpr std::size_t block_size = 16;
+  // number of bytes generated at once for random_bytes
+  static constexpr std::size_t buffer_size = 256 * block_size;
+
  private:
+  void refill_buffer();
+
   struct AES128_CTR_RNG_State;
   std::unique_ptr<AES128_CTR_RNG_State> state_;
   static thread_local AES128_CTR_RNG thread_instance_;
@@ -0,0 +1,50 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "fake_setup.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace MOTION {
+
+std::size_t fake_setup_index(FakeSetupStream stream, std::size_t party_a, std::size_t party_b) {
+  if (party_a > 0xff || party_b > 0xff) {
+    throw std::invalid_argument("fake setup supports at most 256 parties");
+  }
+  return (static_cast<std::size_t>(stream) << 16) | (party_a << 8) | party_b;
+}
+
+const GateMaskGenerator& get_fake_setup_generator() {
+  static const GateMaskGenerator generator = [] {
+    // an arbitrary public key, which is the same for all parties
+    std::array<std::byte, aes_block_size> key;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+      key[i] = std::byte(0xa5 ^ i);
+    }
+    return GateMaskGenerator(key.data());
+  }();
+  return generator;
+}
+
+}  // namespace MOTION
@@ -0,0 +1,57 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gate_mask_generator.h"
+
+namespace MOTION {
+
+// Randomness of the fake setup, which lets the providers derive their correlated randomness from
+// a fixed key known to all parties instead of running the setup protocols, s.t. the online phase
+// can be benchmarked without paying for the setup.  It is completely insecure: every party knows
+// the setup material of the other parties.
+//
+// The material is drawn from the streams of a GateMaskGenerator, where the stream index is
+// selected with fake_setup_index() and the gate_id field is free for the provider.
+enum class FakeSetupStream : std::size_t {
+  ot_outputs,
+  ot_choices,
+  mts,
+  sps,
+  sbs,
+  shared_mts,
+};
+
+// index of the stream for the material between party_a and party_b (e.g., OT sender and
+// receiver), or of the material shared by all parties with the default ids
+std::size_t fake_setup_index(FakeSetupStream stream, std::size_t party_a = 0,
+                             std::size_t party_b = 0);
+
+// generator keyed with the fixed key of the fake setup
+const GateMaskGenerator& get_fake_setup_generator();
+
+}  // namespace MOTION
@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gate_mask_generator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "aes128_ctr_rng.h"
+#include "utility/helpers.h"
+
+GateMaskGenerator::GateMaskGenerator() {
+  AES128_CTR_RNG::get_thread_instance().random_bytes(round_keys_.data(), aes_block_size);
+  aesni_key_expansion_128(round_keys_.data());
+}
+
+GateMaskGenerator::GateMaskGenerator(const std::byte* key) {
+  std::copy_n(key, aes_block_size, round_keys_.data());
+  aesni_key_expansion_128(round_keys_.data());
+}
+
+void GateMaskGenerator::random_bytes(std::size_t gate_id, std::size_t index, std::byte* output,
+                                     std::size_t num_bytes) const {
+  if (index > max_index) {
+    throw std::invalid_argument("GateMaskGenerator: index is too large");
+  }
+  // encrypt batches of counter blocks into an aligned buffer on the stack
+  constexpr std::size_t batch_size = 64;
+  alignas(aes_block_size) std::array<std::byte, batch_size * aes_block_size> buffer;
+  std::uint64_t counter = std::uint64_t(index) << 40;
+  for (std::size_t offset = 0; offset < num_bytes; offset += buffer.size()) {
+    const auto num_batch_bytes = std::min(buffer.size(), num_bytes - offset);
+    const auto num_blocks = (num_batch_bytes + aes_block_size - 1) / aes_block_size;
+    aesni_ctr_stream_blocks_128_nonce(round_keys_.data(), gate_id, &counter, buffer.data(),
+                                      num_blocks);
+    std::copy_n(buffer.data(), num_batch_bytes, output + offset);
+  }
+}
+
+ENCRYPTO::BitVector<> GateMaskGenerator::random_bits(std::size_t gate_id, std::size_t num_bits,
+                                                     std::size_t index) const {
+  std::vector<std::byte> bytes(MOTION::Helpers::Convert::BitsToBytes(num_bits));
+  random_bytes(gate_id, index, bytes.data(), bytes.size());
+  return ENCRYPTO::BitVector<>(bytes.data(), num_bits);
+}
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "crypto/aes/aesni_primitives.h"
+#include "utility/bit_vector.h"
+
+// Local randomness for the masks of gate outputs.  The masks are derived with AES in counter mode
+// from a key which is sampled once, and every (gate_id, index) pair selects its own stream, such
+// that the mask of an output wire can be regenerated whenever it is needed instead of being
+// stored.
+//
+// The counter blocks are gate_id || (index << 40) + block number, i.e., a stream has at most 2^40
+// blocks.  All member functions are const, so gates can use one generator concurrently.
+class GateMaskGenerator {
+ public:
+  // sample a random key
+  GateMaskGenerator();
+  // use the given key of aes_block_size bytes
+  explicit GateMaskGenerator(const std::byte* key);
+
+  static constexpr std::size_t max_index = (std::size_t(1) << 24) - 1;
+
+  // fill the output buffer with the first num_bytes bytes of the stream (gate_id, index)
+  void random_bytes(std::size_t gate_id, std::size_t index, std::byte* output,
+                    std::size_t num_bytes) const;
+
+  template <typename T>
+  std::vector<T> random_vector(std::size_t gate_id, std::size_t num_values,
+                               std::size_t index = 0) const {
+    std::vector<T> values(num_values);
+    random_bytes(gate_id, index, reinterpret_cast<std::byte*>(values.data()),
+                 sizeof(T) * num_values);
+    return values;
+  }
+
+  ENCRYPTO::BitVector<> random_bits(std::size_t gate_id, std::size_t num_bits,
+                                    std::size_t index = 0) const;
+
+ private:
+  alignas(aes_block_size) std::array<std::byte, aes_round_keys_size_128> round_keys_;
+};
@@ -58,6 +58,10 @@ void SharingRandomnessGenerator::Initialize(
 
   prg_a.SetKey(raw_key_arithmetic_);
   prg_b.SetKey(raw_key_boolean_);
+  {
+    auto digest = HashKey(master_seed_, KeyType::ArithmeticGMWPackedKey);
+    prg_a_packed.SetKey(digest.data());
+  }
 
   {
     std::scoped_lock lock(initialized_condition_->GetMutex());
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <thread>
 #include <vector>
@@ -42,6 +44,7 @@ static auto &EVP_MD_CTX_free = EVP_MD_CTX_destroy;
 
 #include <fmt/format.h>
 
+#include "aes/aesni_primitives.h"
 #include "pseudo_random_generator.h"
 #include "utility/bit_vector.h"
 #include "utility/fiber_condition.h"
@@ -81,26 +84,9 @@ class SharingRandomnessGenerator {
   //----------------------------------------------
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
   T GetUnsigned(const std::size_t gate_id) {
-    initialized_condition_->Wait();
-
-    std::byte input[AES_BLOCK_SIZE];
-
-    std::copy(std::begin(aes_ctr_nonce_arithmetic_), std::end(aes_ctr_nonce_arithmetic_), input);
-    std::copy_n(reinterpret_cast<const std::byte *>(&gate_id), sizeof(gate_id),
-                input + SharingRandomnessGenerator::COUNTER_OFFSET);
-
-    auto output = prg_a.Encrypt(input, AES_BLOCK_SIZE);
-
-    // combine resulting randomness xored with the gate_id, which is the actual
-    // input to AES-CTR
-    __uint128_t result = reinterpret_cast<std::uint64_t *>(output.data())[0],
-                mod = std::numeric_limits<T>::max();
-    result <<= 64;
-    result ^= reinterpret_cast<std::uint64_t *>(output.data())[1] ^ gate_id;
-    result %= mod;
-
-    return static_cast<T>(result);  // static-cast the result to the smaller
-                                    // ring
+    T result;
+    GetUnsigned(gate_id, 1, &result);
+    return result;
   }
 
   template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
@@ -111,27 +97,24 @@ class SharingRandomnessGenerator {
 
     initialized_condition_->Wait();
 
-    auto size_in_bytes = AES_BLOCK_SIZE * (num_of_gates);
-    std::vector<std::byte> input(size_in_bytes + AES_BLOCK_SIZE);
-
-    auto gate_id_copy = gate_id;
-    for (auto i = 0u; i < num_of_gates; ++i, ++gate_id_copy) {
-      std::copy(std::begin(aes_ctr_nonce_arithmetic_), std::end(aes_ctr_nonce_arithmetic_),
-                &input[i * AES_BLOCK_SIZE]);
-      std::copy_n(reinterpret_cast<const std::byte *>(&gate_id_copy), sizeof(gate_id_copy),
-                  input.data() + i * AES_BLOCK_SIZE + SharingRandomnessGenerator::COUNTER_OFFSET);
-    }
-
-    auto output = prg_a.Encrypt(input.data(), num_of_gates * AES_BLOCK_SIZE);
-    __uint128_t mod = std::numeric_limits<T>::max(), single_result;
-    // combine resulting randomness xored with the gate_id, which is the actual
-    // input to AES-CTR
-    for (auto i = 0u; i < num_of_gates; ++i) {
-      single_result = reinterpret_cast<std::uint64_t *>(output.data())[i * 2];
-      single_result <<= 64;
-      single_result ^= reinterpret_cast<std::uint64_t *>(output.data())[i * 2 + 1] ^ gate_id++;
-      single_result %= mod;
-      output_ptr[i] = static_cast<T>(single_result);  // static-cast the result to the smaller ring
+    // encrypt the blocks nonce || gate_id directly with AES-NI in batches on the stack
+    constexpr std::size_t BATCH_SIZE = 64;
+    alignas(AES_BLOCK_SIZE) std::array<std::uint64_t, 2 * BATCH_SIZE> output;
+    std::uint64_t nonce;
+    std::copy_n(std::begin(aes_ctr_nonce_arithmetic_), sizeof(nonce),
+                reinterpret_cast<std::byte *>(&nonce));
+
+    for (std::size_t offset = 0; offset < num_of_gates; offset += BATCH_SIZE) {
+      const auto batch_size = std::min(BATCH_SIZE, num_of_gates - offset);
+      std::uint64_t counter = gate_id + offset;
+      aesni_ctr_stream_blocks_128_nonce(prg_a.get_round_keys(), nonce, &counter, output.data(),
+                                        batch_size);
+      // combine resulting randomness xored with the gate_id, which is the actual
+      // input to AES-CTR
+      for (std::size_t i = 0; i < batch_size; ++i) {
+        output_ptr[offset + i] =
+            ReduceModMax<T>(output[2 * i], output[2 * i + 1] ^ (gate_id + offset + i));
+      }
     }
   }
 
@@ -147,6 +130,41 @@ class SharingRandomnessGenerator {
     return results;
   }
 
+  // Fill output_ptr with num_of_values random values where every AES block yields
+  // 16 / sizeof(T) values, e.g., 8 std::uint16_t or 2 std::uint64_t, instead of one.  The values
+  // are uniform in the whole ring and are generated with a separate key, so that they never
+  // coincide with the ones of GetUnsigned.  The ids [gate_id, gate_id + num_of_values) are used
+  // as counters.
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  void GetUnsignedPacked(std::size_t gate_id, const std::size_t num_of_values, T* output_ptr) {
+    if (num_of_values == 0) {
+      return;
+    }
+
+    initialized_condition_->Wait();
+
+    constexpr std::size_t VALUES_PER_BLOCK = AES_BLOCK_SIZE / sizeof(T);
+    const auto num_blocks = num_of_values / VALUES_PER_BLOCK;
+    std::uint64_t counter = gate_id;
+    aesni_ctr_stream_blocks_128_unaligned(prg_a_packed.get_round_keys(), &counter, output_ptr,
+                                          num_blocks);
+    const auto remaining_values = num_of_values % VALUES_PER_BLOCK;
+    if (remaining_values > 0) {
+      std::array<T, VALUES_PER_BLOCK> last_block;
+      aesni_ctr_stream_single_block_128_unaligned(prg_a_packed.get_round_keys(), &counter,
+                                                  last_block.data());
+      std::copy_n(std::begin(last_block), remaining_values,
+                  output_ptr + num_blocks * VALUES_PER_BLOCK);
+    }
+  }
+
+  template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+  std::vector<T> GetUnsignedPacked(std::size_t gate_id, const std::size_t num_of_values) {
+    std::vector<T> results(num_of_values);
+    GetUnsignedPacked(gate_id, num_of_values, results.data());
+    return results;
+  }
+
   ENCRYPTO::BitVector<> GetBits(const std::size_t gate_id, const std::size_t num_of_bits);
 
   void ClearBitPool();
@@ -173,16 +191,36 @@ class SharingRandomnessGenerator {
       std::byte{0}};  /// Raw AES CTR nonce that is used
   /// in the left part of IV
 
-  ENCRYPTO::PRG prg_a, prg_b;
+  ENCRYPTO::PRG prg_a, prg_b, prg_a_packed;
 
   enum KeyType : uint {
     ArithmeticGMWKey = 0,
     ArithmeticGMWNonce = 1,
     BooleanGMWKey = 2,
     BooleanGMWNonce = 3,
-    InvalidKeyType = 4
+    ArithmeticGMWPackedKey = 4,
+    InvalidKeyType = 5
   };
 
+  // (hi * 2^64 + lo) % std::numeric_limits<T>::max() without a 128 bit division, since the bit
+  // size k of T divides 64 and hence 2^64 = 1 mod 2^k - 1
+  template <typename T>
+  static T ReduceModMax(std::uint64_t hi, std::uint64_t lo) {
+    if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+      __uint128_t result = hi;
+      result <<= 64;
+      result ^= lo;
+      return static_cast<T>(result % std::numeric_limits<T>::max());
+    } else {
+      constexpr std::uint64_t mod = std::numeric_limits<T>::max();
+      __uint128_t result = __uint128_t(hi % mod) + (lo % mod);
+      if (result >= mod) {
+        result -= mod;
+      }
+      return static_cast<T>(result);
+    }
+  }
+
   // use a seed to generate randomness for a new key
   std::vector<std::byte> HashKey(const std::byte seed[AES_KEY_SIZE], const KeyType key_type);
 
@@ -49,6 +49,11 @@ BaseOTsSenderData::BaseOTsSenderData() : received_R_(128, false) {
       std::make_unique<ENCRYPTO::FiberCondition>([this]() { return is_ready_.load(); });
 }
 
+BaseOTsData::BaseOTsData() {
+  cache_check_condition_ =
+      std::make_unique<ENCRYPTO::FiberCondition>([this]() { return received_cache_check_; });
+}
+
 void BaseOTsData::MessageReceived(const std::uint8_t *message, const BaseOTsDataType type,
                                   const std::size_t ot_id) {
   switch (type) {
@@ -72,6 +77,16 @@ void BaseOTsData::MessageReceived(const std::uint8_t *message, const BaseOTsData
       receiver_data_.received_S_condition_.at(ot_id)->NotifyOne();
       break;
     }
+    case BaseOTsDataType::cache_check: {
+      {
+        std::scoped_lock lock(cache_check_condition_->GetMutex());
+        std::copy(message, message + cache_check_.size(),
+                  reinterpret_cast<std::uint8_t *>(cache_check_.data()));
+        received_cache_check_ = true;
+      }
+      cache_check_condition_->NotifyAll();
+      break;
+    }
     default: {
       throw std::runtime_error(
           fmt::format("DataStorage::BaseOTsReceived: unknown data type {}; data_type must be <{}",
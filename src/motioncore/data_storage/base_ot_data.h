@@ -38,7 +38,12 @@ class FiberCondition;
 
 namespace MOTION {
 
-enum BaseOTsDataType : uint { HL17_R = 0, HL17_S = 1, BaseOTs_invalid_data_type = 2 };
+enum BaseOTsDataType : uint {
+  HL17_R = 0,
+  HL17_S = 1,
+  cache_check = 2,
+  BaseOTs_invalid_data_type = 3
+};
 
 struct BaseOTsReceiverData {
   BaseOTsReceiverData();
@@ -77,6 +82,9 @@ struct BaseOTsSenderData {
 };
 
 struct BaseOTsData {
+  BaseOTsData();
+  ~BaseOTsData() = default;
+
   void MessageReceived(const std::uint8_t* message, const BaseOTsDataType type,
                        const std::size_t ot_id = 0);
 
@@ -87,6 +95,11 @@ struct BaseOTsData {
 
   BaseOTsReceiverData receiver_data_;
   BaseOTsSenderData sender_data_;
+
+  // cache identifier and nonce sent by the other party, see BaseOTCache
+  std::array<std::byte, 32> cache_check_;
+  bool received_cache_check_{false};
+  std::unique_ptr<ENCRYPTO::FiberCondition> cache_check_condition_;
 };
 
 }  // namespace MOTION
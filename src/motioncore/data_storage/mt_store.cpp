@@ -0,0 +1,189 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mt_store.h"
+
+#include <unistd.h>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "crypto/multiplication_triple/mt_provider.h"
+#include "preprocessing_store.h"
+#include "utility/type_traits.hpp"
+
+namespace MOTION {
+
+namespace {
+
+// records of a batch, the integer triples use their bit size as id
+constexpr std::size_t binary_record_id = 1;
+
+constexpr auto poll_interval = std::chrono::milliseconds(1);
+
+template <typename T>
+void write_integer_mts(PreprocessingWriter& writer, MTReservoir& reservoir) {
+  const auto mts = reservoir.TakeInteger<T>(reservoir.GetSize<T>());
+  writer.begin_record(ENCRYPTO::bit_size_v<T>);
+  writer.write_ints(mts.a);
+  writer.write_ints(mts.b);
+  writer.write_ints(mts.c);
+  writer.end_record();
+}
+
+template <typename T>
+void read_integer_mts(PreprocessingRecord& record, MTReservoir& reservoir) {
+  IntegerMTVector<T> mts;
+  mts.a = record.read_ints<T>();
+  mts.b = record.read_ints<T>();
+  mts.c = record.read_ints<T>();
+  if (mts.b.size() != mts.a.size() || mts.c.size() != mts.a.size()) {
+    throw std::runtime_error("MTStoreReader: batch contains incomplete triples");
+  }
+  reservoir.AddInteger(mts);
+}
+
+}  // namespace
+
+std::filesystem::path mt_store_batch_path(const std::filesystem::path& directory,
+                                          std::size_t batch_id) {
+  return directory / fmt::format("batch_{}.mts", batch_id);
+}
+
+MTStoreWriter::MTStoreWriter(std::filesystem::path directory, std::size_t my_id,
+                             std::size_t first_batch)
+    : directory_(std::move(directory)), my_id_(my_id), next_batch_(first_batch) {
+  std::filesystem::create_directories(directory_);
+}
+
+std::size_t MTStoreWriter::publish(MTReservoir& reservoir) {
+  const auto batch_id = next_batch_;
+  const auto path = mt_store_batch_path(directory_, batch_id);
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    PreprocessingWriter writer(tmp_path.string(), my_id_);
+    const auto bit_mts = reservoir.TakeBinary(reservoir.GetSize<bool>());
+    writer.begin_record(binary_record_id);
+    writer.write_bits(bit_mts.a);
+    writer.write_bits(bit_mts.b);
+    writer.write_bits(bit_mts.c);
+    writer.end_record();
+    write_integer_mts<std::uint8_t>(writer, reservoir);
+    write_integer_mts<std::uint16_t>(writer, reservoir);
+    write_integer_mts<std::uint32_t>(writer, reservoir);
+    write_integer_mts<std::uint64_t>(writer, reservoir);
+    writer.finish();
+  }
+  // consumers only see complete batches
+  std::filesystem::rename(tmp_path, path);
+  ++next_batch_;
+  return batch_id;
+}
+
+std::size_t MTStoreWriter::get_num_available() const {
+  std::size_t num_batches = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+    const auto name = entry.path().filename().string();
+    if (name.starts_with("batch_") && name.ends_with(".mts")) {
+      ++num_batches;
+    }
+  }
+  return num_batches;
+}
+
+MTStoreReader::MTStoreReader(std::filesystem::path directory, std::size_t my_id,
+                             std::size_t first_batch, std::size_t stride)
+    : directory_(std::move(directory)), my_id_(my_id), next_batch_(first_batch), stride_(stride) {
+  if (stride_ == 0) {
+    throw std::invalid_argument("MTStoreReader: stride must be positive");
+  }
+}
+
+bool MTStoreReader::take(MTReservoir& reservoir, std::chrono::milliseconds timeout) {
+  const auto path = mt_store_batch_path(directory_, next_batch_);
+  auto claimed_path = path;
+  claimed_path += fmt::format(".{}", ::getpid());
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  // the rename fails until the batch is published
+  for (std::error_code error;; error.clear()) {
+    std::filesystem::rename(path, claimed_path, error);
+    if (!error) {
+      break;
+    }
+    if (error != std::errc::no_such_file_or_directory) {
+      throw std::filesystem::filesystem_error("MTStoreReader: could not claim batch", path, error);
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(poll_interval);
+  }
+
+  try {
+    PreprocessingReader reader(claimed_path.string(), my_id_);
+    for (std::size_t record_i = 0; record_i < reader.get_num_records(); ++record_i) {
+      auto record = reader.get_record(record_i);
+      switch (record.get_gate_id()) {
+        case binary_record_id: {
+          BinaryMTVector mts;
+          mts.a = record.read_bits();
+          mts.b = record.read_bits();
+          mts.c = record.read_bits();
+          if (mts.b.GetSize() != mts.a.GetSize() || mts.c.GetSize() != mts.a.GetSize()) {
+            throw std::runtime_error("MTStoreReader: batch contains incomplete triples");
+          }
+          reservoir.AddBinary(mts);
+          break;
+        }
+        case 8:
+          read_integer_mts<std::uint8_t>(record, reservoir);
+          break;
+        case 16:
+          read_integer_mts<std::uint16_t>(record, reservoir);
+          break;
+        case 32:
+          read_integer_mts<std::uint32_t>(record, reservoir);
+          break;
+        case 64:
+          read_integer_mts<std::uint64_t>(record, reservoir);
+          break;
+        default:
+          throw std::runtime_error(
+              fmt::format("MTStoreReader: unknown record {} in {}", record.get_gate_id(),
+                          path.string()));
+      }
+    }
+  } catch (...) {
+    std::filesystem::remove(claimed_path);
+    throw;
+  }
+  std::filesystem::remove(claimed_path);
+  next_batch_ += stride_;
+  return true;
+}
+
+}  // namespace MOTION
@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace MOTION {
+
+class MTReservoir;
+
+// Multiplication triples shared between the processes of a party through a directory, e.g., on a
+// tmpfs like /dev/shm s.t. the triples never touch the disk.  A long-running generator of each
+// party, see examples/mt_daemon, publishes batches of triples which the MOTION processes of the
+// same party take into the MTReservoir of their backend before they build a circuit.
+//
+// Batch i is stored in the file batch_<i>.mts in the format of PreprocessingWriter.  A batch is
+// written to a temporary file and renamed when it is complete, and a consumer claims it by
+// renaming it again, so several processes can share a directory.  The shares of the parties only
+// match if they use the same batches: the generators of both parties publish in lockstep, and
+// each consumer needs a partner at the other party which takes the same sequence of batches,
+// e.g., every stride-th batch starting at the same one.
+
+class MTStoreWriter {
+ public:
+  MTStoreWriter(std::filesystem::path directory, std::size_t my_id, std::size_t first_batch = 0);
+
+  // move all triples from the reservoir into the next batch and return its id
+  std::size_t publish(MTReservoir& reservoir);
+
+  std::size_t get_next_batch() const noexcept { return next_batch_; }
+  // number of published batches which have not been claimed by a consumer yet
+  std::size_t get_num_available() const;
+
+ private:
+  std::filesystem::path directory_;
+  std::size_t my_id_;
+  std::size_t next_batch_;
+};
+
+class MTStoreReader {
+ public:
+  // takes the batches first_batch, first_batch + stride, first_batch + 2 * stride, ...
+  MTStoreReader(std::filesystem::path directory, std::size_t my_id, std::size_t first_batch = 0,
+                std::size_t stride = 1);
+
+  // claim the next batch, append its triples to the reservoir and delete it, returns false if the
+  // batch has not been published within the timeout
+  bool take(MTReservoir& reservoir,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  std::size_t get_next_batch() const noexcept { return next_batch_; }
+
+ private:
+  std::filesystem::path directory_;
+  std::size_t my_id_;
+  std::size_t next_batch_;
+  std::size_t stride_;
+};
+
+// path of batch `batch_id` in a store
+std::filesystem::path mt_store_batch_path(const std::filesystem::path& directory,
+                                          std::size_t batch_id);
+
+}  // namespace MOTION
@@ -24,7 +24,12 @@
 
 #include "ot_extension_data.h"
 
+#include <algorithm>
 #include <thread>
+#include <utility>
+
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/keys.hpp>
 
 #include "utility/block.h"
 #include "utility/condition.h"
@@ -32,27 +37,158 @@
 
 namespace MOTION {
 
+OTBatch &OTBatchTable::Add(std::size_t ot_id, std::size_t num_ots) {
+  if (!batches_.empty() && batches_.back().ot_id_ >= ot_id) {
+    throw std::logic_error(
+        fmt::format("OT batch #{} registered after OT batch #{}", ot_id, batches_.back().ot_id_));
+  }
+  return batches_.emplace_back(ot_id, num_ots);
+}
+
+OTBatch &OTBatchTable::Get(std::size_t ot_id) {
+  return const_cast<OTBatch &>(std::as_const(*this).Get(ot_id));
+}
+
+const OTBatch &OTBatchTable::Get(std::size_t ot_id) const {
+  auto it = std::lower_bound(std::begin(batches_), std::end(batches_), ot_id,
+                             [](const auto &batch, auto id) { return batch.ot_id_ < id; });
+  if (it == std::end(batches_) || it->ot_id_ != ot_id) {
+    throw std::out_of_range(fmt::format("no OT batch starting at OT#{}", ot_id));
+  }
+  return *it;
+}
+
+bool OTBatchTable::IsSet(std::size_t ot_id, Flag flag) const {
+  return Get(ot_id).flags_.load(std::memory_order_acquire) & flag;
+}
+
+void OTBatchTable::Set(std::size_t ot_id, Flag flag) {
+  auto &batch = Get(ot_id);
+  {
+    std::scoped_lock lock(mutex_);
+    batch.flags_.fetch_or(flag, std::memory_order_release);
+  }
+  condition_variable_.notify_all();
+}
+
+void OTBatchTable::Wait(std::size_t ot_id, Flag flag) const {
+  const auto &batch = Get(ot_id);
+  // fast path without the lock
+  if (batch.flags_.load(std::memory_order_acquire) & flag) {
+    return;
+  }
+  std::unique_lock lock(mutex_);
+  condition_variable_.wait(
+      lock, [&batch, flag] { return batch.flags_.load(std::memory_order_acquire) & flag; });
+}
+
+void OTBatchTable::ResetFlags() {
+  std::scoped_lock lock(mutex_);
+  for (auto &batch : batches_) {
+    batch.flags_ = 0;
+  }
+}
+
+void OTBatchTable::Clear() {
+  std::scoped_lock lock(mutex_);
+  batches_.clear();
+}
+
 OTExtensionReceiverData::OTExtensionReceiverData() {
   setup_finished_cond_ =
       std::make_unique<ENCRYPTO::FiberCondition>([this]() { return setup_finished_.load(); });
+  ots_ready_ = std::make_unique<ENCRYPTO::FiberCounter>();
 }
 
 OTExtensionSenderData::OTExtensionSenderData() {
   setup_finished_cond_ =
       std::make_unique<ENCRYPTO::FiberCondition>([this]() { return setup_finished_.load(); });
+  ots_ready_ = std::make_unique<ENCRYPTO::FiberCounter>();
+  u_chunks_ready_ = std::make_unique<ENCRYPTO::FiberCounter>();
 
   for (std::size_t i = 0; i < u_promises_.size(); ++i) u_futures_[i] = u_promises_[i].get_future();
 }
 
-void OTExtensionData::MessageReceived(const std::uint8_t *message,
-                                      [[maybe_unused]] std::size_t message_size,
+void OTExtensionReceiverData::Reset() {
+  T_.reset();
+  batches_.Clear();
+  outputs_.clear();
+  {
+    std::scoped_lock lock(bitlengths_mutex_);
+    bitlengths_.clear();
+  }
+  {
+    std::scoped_lock lock(real_choices_mutex_);
+    real_choices_ = std::make_unique<ENCRYPTO::BitVector<>>();
+  }
+  message_promises_bit_.clear();
+  message_promises_block128_.clear();
+  boost::hana::for_each(boost::hana::keys(message_promises_int_),
+                        [this](auto key) { message_promises_int_[key].clear(); });
+  random_choices_.reset();
+  {
+    std::scoped_lock lock(setup_finished_cond_->GetMutex());
+    setup_finished_ = false;
+  }
+  ots_ready_->Reset();
+  // consumed_offset_base_ots_ is kept, s.t. the next OT extension uses fresh PRG outputs
+}
+
+void OTExtensionSenderData::Reset() {
+  bit_size_ = 0;
+  {
+    std::scoped_lock lock(u_mutex_);
+    u_ = {};
+    num_received_u_ = 0;
+    u_chunk_size_ = 0;
+    num_received_u_rows_.clear();
+  }
+  u_chunks_ready_->Reset();
+  V_.reset();
+  batches_.Clear();
+  {
+    std::scoped_lock lock(corrections_mutex_);
+    corrections_ = {};
+  }
+  y0_.clear();
+  y1_.clear();
+  bitlengths_.clear();
+  {
+    std::scoped_lock lock(setup_finished_cond_->GetMutex());
+    setup_finished_ = false;
+  }
+  ots_ready_->Reset();
+  // consumed_offset_base_ots_ is kept, s.t. the next OT extension uses fresh PRG outputs
+}
+
+void OTExtensionData::MessageReceived(const std::uint8_t *message, std::size_t message_size,
                                       const OTExtensionDataType type, const std::size_t i) {
   switch (type) {
     case OTExtensionDataType::rcv_masks: {
+      while (sender_data_.bit_size_ == 0) std::this_thread::yield();
+      if (const std::size_t chunk_size = sender_data_.u_chunk_size_; chunk_size > 0) {
+        // streaming setup: message i contains the chunk i / 128 of the row i % 128
+        const auto row_i = i % 128;
+        const auto chunk_i = i / 128;
+        std::size_t num_chunks_ready;
+        {
+          std::scoped_lock lock(sender_data_.u_mutex_);
+          std::copy_n(reinterpret_cast<const std::byte *>(message), message_size,
+                      sender_data_.u_.at(row_i).GetMutableData().data() + chunk_i * chunk_size / 8);
+          auto &num_received_u_rows = sender_data_.num_received_u_rows_;
+          ++num_received_u_rows.at(chunk_i);
+          num_chunks_ready = sender_data_.u_chunks_ready_->Get();
+          while (num_chunks_ready < num_received_u_rows.size() &&
+                 num_received_u_rows[num_chunks_ready] == 128) {
+            ++num_chunks_ready;
+          }
+        }
+        sender_data_.u_chunks_ready_->Raise(num_chunks_ready);
+        break;
+      }
       {
-        while (sender_data_.bit_size_ == 0) std::this_thread::yield();
         std::scoped_lock lock(sender_data_.u_mutex_);
-        sender_data_.u_[i] = ENCRYPTO::AlignedBitVector(message, sender_data_.bit_size_);
+        sender_data_.u_[i] = ENCRYPTO::HugePageBitVector(message, sender_data_.bit_size_);
         sender_data_.u_promises_[sender_data_.num_received_u_].set_value(i);
 
         // set to 0 after Clear()
@@ -62,34 +198,29 @@ void OTExtensionData::MessageReceived(const std::uint8_t *message,
       break;
     }
     case OTExtensionDataType::rcv_corrections: {
-      auto cond = sender_data_.received_correction_offsets_cond_.find(i);
-      assert(cond != sender_data_.received_correction_offsets_cond_.end());
+      const auto num_ots = sender_data_.batches_.Get(i).num_ots_;
       {
-        std::scoped_lock lock(cond->second->GetMutex(), sender_data_.corrections_mutex_);
-        auto num_ots = sender_data_.num_ots_in_batch_.find(i);
-        assert(num_ots != sender_data_.num_ots_in_batch_.end());
-        ENCRYPTO::BitVector<> local_corrections(message, num_ots->second);
-        sender_data_.corrections_.Copy(i, i + num_ots->second, local_corrections);
-        sender_data_.received_correction_offsets_.emplace(i);
+        std::scoped_lock lock(sender_data_.corrections_mutex_);
+        ENCRYPTO::BitVector<> local_corrections(message, num_ots);
+        sender_data_.corrections_.Copy(i, i + num_ots, local_corrections);
       }
-      cond->second->NotifyAll();
+      sender_data_.batches_.Set(i, OTBatchTable::corrections_received);
       break;
     }
     case OTExtensionDataType::snd_messages: {
       {
-        receiver_data_.setup_finished_cond_->Wait();
+        const auto &batch = receiver_data_.batches_.Get(i);
+        const auto batch_size = batch.num_ots_;
+
+        // only the OTs of this batch need to be finished
+        receiver_data_.ots_ready_->WaitUntil(i + batch_size);
 
         std::unique_lock lock(receiver_data_.bitlengths_mutex_);
         const auto bitlen = receiver_data_.bitlengths_.at(i);
         lock.unlock();
 
-        const auto bs_it = receiver_data_.num_ots_in_batch_.find(i);
-        assert(bs_it != receiver_data_.num_ots_in_batch_.end());
-        const auto batch_size = bs_it->second;
-
-        auto msg_type = receiver_data_.msg_type_.find(i);
-        if (msg_type != receiver_data_.msg_type_.end()) {
-          switch (msg_type->second) {
+        if (const auto msg_type = batch.msg_type_; msg_type.has_value()) {
+          switch (*msg_type) {
             case OTMsgType::block128: {
               auto promise_it = receiver_data_.message_promises_block128_.find(i);
               assert(promise_it != receiver_data_.message_promises_block128_.end());
@@ -164,32 +295,11 @@ void OTExtensionData::MessageReceived(const std::uint8_t *message,
           }
         }
 
-        auto it_c = receiver_data_.output_conds_.find(i);
-        assert(it_c != receiver_data_.output_conds_.end());
-
-        bool success{false};
-        do {
-          {
-            std::scoped_lock lock(receiver_data_.num_messages_mutex_);
-            success = receiver_data_.num_messages_.find(i) != receiver_data_.num_messages_.end();
-          }
-          if (!success) std::this_thread::yield();
-        } while (!success);
-
-        const auto n = receiver_data_.num_messages_.at(i);
+        const auto n = batch.num_messages_;
 
         ENCRYPTO::BitVector<> message_bv(message, batch_size * bitlen * n);
 
-        success = false;
-        do {
-          {
-            std::scoped_lock lock(receiver_data_.real_choices_mutex_);
-            success = receiver_data_.real_choices_cond_.find(i) !=
-                      receiver_data_.real_choices_cond_.end();
-          }
-          if (!success) std::this_thread::yield();
-        } while (!success);
-        receiver_data_.real_choices_cond_.at(i)->Wait();
+        receiver_data_.batches_.Wait(i, OTBatchTable::choices_set);
 
         for (auto j = 0ull; j < batch_size; ++j) {
           if (n == 2) {
@@ -202,8 +312,7 @@ void OTExtensionData::MessageReceived(const std::uint8_t *message,
             }
           } else if (n == 1) {
             if (receiver_data_.real_choices_->Get(i + j)) {
-              if (receiver_data_.xor_correlation_.find(i) !=
-                  receiver_data_.xor_correlation_.end()) {
+              if (batch.xor_correlation_) {
                 receiver_data_.outputs_.at(i + j) ^=
                     message_bv.Subset(j * bitlen, (j + 1) * bitlen);
               } else {
@@ -253,14 +362,20 @@ void OTExtensionData::MessageReceived(const std::uint8_t *message,
           }
         }
 
-        {
-          std::scoped_lock lock(it_c->second->GetMutex(), receiver_data_.received_outputs_mutex_);
-          receiver_data_.received_outputs_.emplace(i);
-        }
-        it_c->second->NotifyAll();
+        receiver_data_.batches_.Set(i, OTBatchTable::outputs_received);
       }
       break;
     }
+    case OTExtensionDataType::silent_ot_rcv_messages: {
+      sender_data_.silent_ot_messages_.enqueue(
+          std::make_pair(i, std::vector<std::uint8_t>(message, message + message_size)));
+      break;
+    }
+    case OTExtensionDataType::silent_ot_snd_messages: {
+      receiver_data_.silent_ot_messages_.enqueue(
+          std::make_pair(i, std::vector<std::uint8_t>(message, message + message_size)));
+      break;
+    }
     default: {
       throw std::runtime_error(fmt::format(
           "DataStorage::OTExtensionDataType: unknown data type {}; data_type must be <{}", type,
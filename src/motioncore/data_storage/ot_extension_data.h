@@ -27,21 +27,27 @@
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
 #include "utility/bit_matrix.h"
 #include "utility/bit_vector.h"
 #include "utility/block.h"
 #include "utility/meta.hpp"
 #include "utility/reusable_future.h"
+#include "utility/synchronized_queue.h"
 
 namespace ENCRYPTO {
 class FiberCondition;
+class FiberCounter;
 }  // namespace ENCRYPTO
 
 namespace MOTION {
@@ -50,7 +56,9 @@ enum OTExtensionDataType : uint {
   rcv_masks = 0,
   rcv_corrections = 1,
   snd_messages = 2,
-  OTExtension_invalid_data_type = 3
+  silent_ot_rcv_messages = 3,
+  silent_ot_snd_messages = 4,
+  OTExtension_invalid_data_type = 5
 };
 
 enum class OTMsgType {
@@ -63,10 +71,75 @@ enum class OTMsgType {
   uint128
 };
 
+// state of a batch of OTs which is identified by the id of its first OT
+struct OTBatch {
+  OTBatch(std::size_t ot_id, std::size_t num_ots) : ot_id_(ot_id), num_ots_(num_ots) {}
+
+  const std::size_t ot_id_;
+  const std::size_t num_ots_;
+
+  // receiver: how many messages need to be sent from sender to receiver?
+  // GOT -> 2
+  // COT -> 1
+  std::size_t num_messages_ = 0;
+  // receiver: is it a batch of XOR correlated OT?
+  bool xor_correlation_ = false;
+  // receiver: message type of new-style OTs
+  std::optional<OTMsgType> msg_type_;
+
+  // readiness flags, see OTBatchTable::Flag
+  std::atomic<std::uint8_t> flags_{0};
+};
+
+// Dense table of the OT batches.  The batches are added at registration in the order of their OT
+// ids, s.t. they can be found by binary search without a lock while the OTs are running.
+// Readiness is tracked by atomic flags, and waiting fibers share one condition variable instead
+// of allocating a FiberCondition per batch.
+class OTBatchTable {
+ public:
+  enum Flag : std::uint8_t {
+    // receiver: the real choices have been set
+    choices_set = 1,
+    // receiver: the sender's messages have been received and the outputs are computed
+    outputs_received = 2,
+    // sender: the receiver's corrections have been received
+    corrections_received = 4,
+  };
+
+  // only during registration, the OT ids need to be increasing
+  OTBatch& Add(std::size_t ot_id, std::size_t num_ots);
+
+  // throws if there is no batch starting at ot_id
+  OTBatch& Get(std::size_t ot_id);
+  const OTBatch& Get(std::size_t ot_id) const;
+
+  bool IsSet(std::size_t ot_id, Flag flag) const;
+  // set the flag and wake up the fibers waiting for it
+  void Set(std::size_t ot_id, Flag flag);
+  // block until the flag is set
+  void Wait(std::size_t ot_id, Flag flag) const;
+
+  // unset the flags of all batches, no fiber shall be waiting
+  void ResetFlags();
+  // remove all batches, no fiber shall be waiting
+  void Clear();
+
+  std::size_t size() const noexcept { return batches_.size(); }
+
+ private:
+  // deque since the atomic flags can not be moved
+  std::deque<OTBatch> batches_;
+  mutable boost::fibers::mutex mutex_;
+  mutable boost::fibers::condition_variable condition_variable_;
+};
+
 struct OTExtensionReceiverData {
   OTExtensionReceiverData();
   ~OTExtensionReceiverData() = default;
 
+  // forget all registered OTs, only the consumed part of the base OTs is kept
+  void Reset();
+
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector>
   RegisterForBlock128SenderMessage(std::size_t ot_id, std::size_t size);
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> RegisterForBitSenderMessage(
@@ -79,22 +152,11 @@ struct OTExtensionReceiverData {
   // XXX: can't we delete this after setup?
   std::shared_ptr<ENCRYPTO::BitMatrix> T_;
 
-  // if many OTs are received in batches, it is not necessary to store all of the flags
-  // for received messages but only for the first OT id in the batch. Thus, use a hash table.
-  std::unordered_set<std::size_t> received_outputs_;
-  std::vector<ENCRYPTO::BitVector<>> outputs_;
-  std::unordered_map<std::size_t, std::unique_ptr<ENCRYPTO::FiberCondition>> output_conds_;
-  std::mutex received_outputs_mutex_;
-
-  // how many messages need to be sent from sender to receiver?
-  // GOT -> 2
-  // COT -> 1
-  // ROT -> 0 (not in map)
-  std::unordered_map<std::size_t, std::size_t> num_messages_;
-  std::mutex num_messages_mutex_;
+  // registered batches with their number of messages, correlation, message type and whether the
+  // choices are set and the outputs are received (ROTs are not in the table)
+  OTBatchTable batches_;
 
-  // is an OT batch of XOR correlated OT?
-  std::unordered_set<std::size_t> xor_correlation_;
+  std::vector<ENCRYPTO::BitVector<>> outputs_;
 
   std::mutex bitlengths_mutex_;
   // bit length of every OT
@@ -102,10 +164,6 @@ struct OTExtensionReceiverData {
 
   // real choices for every OT?
   std::unique_ptr<ENCRYPTO::BitVector<>> real_choices_;
-  std::unordered_map<std::size_t, std::unique_ptr<ENCRYPTO::FiberCondition>> real_choices_cond_;
-
-  // store the message types of new-style OTs
-  std::unordered_map<std::size_t, OTMsgType> msg_type_;
 
   // Promises for the sender messages
   // ot_id -> (vector size, vector promise)
@@ -125,52 +183,64 @@ struct OTExtensionReceiverData {
                      __uint128_t>
       message_promises_int_;
 
-  // have we already set the choices for this OT batch?
-  std::unordered_set<std::size_t> set_real_choices_;
+  // batches may share a byte of real_choices_
   std::mutex real_choices_mutex_;
 
   // random choices from OT precomputation
   std::unique_ptr<ENCRYPTO::AlignedBitVector> random_choices_;
 
-  // how many ots are in each batch?
-  std::unordered_map<std::size_t, std::size_t> num_ots_in_batch_;
-
   // flag and condition variable: is setup is done?
   std::unique_ptr<ENCRYPTO::FiberCondition> setup_finished_cond_;
   std::atomic<bool> setup_finished_{false};
+  // the outputs of the OTs [0, ots_ready_) are computed, OT vectors only wait for their own range
+  std::unique_ptr<ENCRYPTO::FiberCounter> ots_ready_;
 
   std::atomic<std::size_t> consumed_offset_base_ots_{0};
   // XXX: unused
   std::atomic<std::size_t> consumed_offset_{0};
+
+  // (step, payload) of the messages from the silent OT sender, kept across Reset()
+  ENCRYPTO::SynchronizedQueue<std::pair<std::size_t, std::vector<std::uint8_t>>>
+      silent_ot_messages_;
 };
 
 struct OTExtensionSenderData {
   OTExtensionSenderData();
   ~OTExtensionSenderData() = default;
 
+  // forget all registered OTs, only the consumed part of the base OTs is kept
+  void Reset();
+
   // width of the bit matrix
   std::atomic<std::size_t> bit_size_{0};
 
   /// receiver's mask that are needed to construct matrix @param V_
-  std::array<ENCRYPTO::AlignedBitVector, 128> u_;
+  /// (rows of large OT extensions are backed by huge pages if the HugePageArena is enabled)
+  std::array<ENCRYPTO::HugePageBitVector, 128> u_;
 
   std::array<ENCRYPTO::ReusableFiberPromise<std::size_t>, 128> u_promises_;
   std::array<ENCRYPTO::ReusableFiberFuture<std::size_t>, 128> u_futures_;
   std::mutex u_mutex_;
   std::size_t num_received_u_{0};
+
+  // streaming setup: the receiver sends the vectors u in chunks of this many columns which are
+  // written into the preallocated rows of u_, 0 if it sends whole rows
+  std::atomic<std::size_t> u_chunk_size_{0};
+  // number of rows received for each chunk
+  std::vector<std::size_t> num_received_u_rows_;
+  // the chunks [0, u_chunks_ready_) have been received completely
+  std::unique_ptr<ENCRYPTO::FiberCounter> u_chunks_ready_;
   // matrix of the OT extension scheme
   // XXX: can't we delete this after setup?
   std::shared_ptr<ENCRYPTO::BitMatrix> V_;
 
-  // offset, num_ots
-  std::unordered_map<std::size_t, std::size_t> num_ots_in_batch_;
+  // registered batches and whether their corrections are received
+  OTBatchTable batches_;
 
   // corrections for GOTs, i.e., if random choice bit is not the real choice bit
   // send 1 to flip the messages before encoding or 0 otherwise for each GOT
-  std::unordered_set<std::size_t> received_correction_offsets_;
-  std::unordered_map<std::size_t, std::unique_ptr<ENCRYPTO::FiberCondition>>
-      received_correction_offsets_cond_;
   ENCRYPTO::BitVector<> corrections_;
+  // batches may share a byte of corrections_
   mutable std::mutex corrections_mutex_;
 
   // random sender outputs
@@ -183,10 +253,16 @@ struct OTExtensionSenderData {
   // flag and condition variable: is setup is done?
   std::unique_ptr<ENCRYPTO::FiberCondition> setup_finished_cond_;
   std::atomic<bool> setup_finished_{false};
+  // the outputs of the OTs [0, ots_ready_) are computed, OT vectors only wait for their own range
+  std::unique_ptr<ENCRYPTO::FiberCounter> ots_ready_;
 
   std::atomic<std::size_t> consumed_offset_base_ots_{0};
   // XXX: unused
   std::atomic<std::size_t> consumed_offset_{0};
+
+  // (step, payload) of the messages from the silent OT receiver, kept across Reset()
+  ENCRYPTO::SynchronizedQueue<std::pair<std::size_t, std::vector<std::uint8_t>>>
+      silent_ot_messages_;
 };
 
 struct OTExtensionData {
@@ -198,6 +274,11 @@ struct OTExtensionData {
   OTExtensionSenderData& GetSenderData() { return sender_data_; }
   const OTExtensionSenderData& GetSenderData() const { return sender_data_; }
 
+  void Reset() {
+    receiver_data_.Reset();
+    sender_data_.Reset();
+  }
+
   OTExtensionReceiverData receiver_data_;
   OTExtensionSenderData sender_data_;
 };
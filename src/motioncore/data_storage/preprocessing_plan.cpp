@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "preprocessing_plan.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <boost/json.hpp>
+
+namespace json = boost::json;
+
+namespace MOTION {
+
+namespace {
+
+// increased on incompatible changes of the format
+constexpr std::size_t plan_version = 1;
+
+template <std::size_t N>
+json::object counts_to_json(const std::array<std::size_t, N>& bit_sizes,
+                            const std::array<std::size_t, N>& counts) {
+  json::object object;
+  for (std::size_t i = 0; i < N; ++i) {
+    object[std::to_string(bit_sizes[i])] = counts[i];
+  }
+  return object;
+}
+
+const json::value& get_entry(const json::object& object, std::string_view key) {
+  const auto* value = object.if_contains(key);
+  if (value == nullptr) {
+    throw std::runtime_error(fmt::format("PreprocessingPlan: missing entry \"{}\"", key));
+  }
+  return *value;
+}
+
+std::size_t get_count(const json::object& object, std::string_view key) {
+  const auto& value = get_entry(object, key);
+  if (!value.is_uint64() && !(value.is_int64() && value.get_int64() >= 0)) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingPlan: entry \"{}\" is not a non-negative integer", key));
+  }
+  return json::value_to<std::size_t>(value);
+}
+
+const json::object& get_object(const json::object& object, std::string_view key) {
+  const auto& value = get_entry(object, key);
+  if (!value.is_object()) {
+    throw std::runtime_error(fmt::format("PreprocessingPlan: entry \"{}\" is not an object", key));
+  }
+  return value.get_object();
+}
+
+template <std::size_t N>
+std::array<std::size_t, N> counts_from_json(const json::object& object,
+                                            const std::array<std::size_t, N>& bit_sizes) {
+  std::array<std::size_t, N> counts;
+  for (std::size_t i = 0; i < N; ++i) {
+    counts[i] = get_count(object, std::to_string(bit_sizes[i]));
+  }
+  return counts;
+}
+
+}  // namespace
+
+json::object PreprocessingPlan::to_json() const {
+  json::object object;
+  object["version"] = plan_version;
+  object["binary_mts"] = num_binary_mts;
+  object["mts"] = counts_to_json(mt_bit_sizes, num_mts);
+  object["sbs"] = counts_to_json(sb_bit_sizes, num_sbs);
+  object["sps"] = counts_to_json(sp_bit_sizes, num_sps);
+  object["ots"] = json::object({{"sent", num_ots_sent}, {"received", num_ots_received}});
+  return object;
+}
+
+PreprocessingPlan PreprocessingPlan::from_json(const json::object& object) {
+  if (const auto version = get_count(object, "version"); version != plan_version) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingPlan: unsupported version {}, expected {}", version,
+                    plan_version));
+  }
+  PreprocessingPlan plan;
+  plan.num_binary_mts = get_count(object, "binary_mts");
+  plan.num_mts = counts_from_json(get_object(object, "mts"), mt_bit_sizes);
+  plan.num_sbs = counts_from_json(get_object(object, "sbs"), sb_bit_sizes);
+  plan.num_sps = counts_from_json(get_object(object, "sps"), sp_bit_sizes);
+  const auto& ots = get_object(object, "ots");
+  plan.num_ots_sent = get_count(ots, "sent");
+  plan.num_ots_received = get_count(ots, "received");
+  return plan;
+}
+
+void PreprocessingPlan::save(const std::string& path) const {
+  std::ofstream file(path);
+  file << json::serialize(to_json()) << '\n';
+  if (!file) {
+    throw std::runtime_error(fmt::format("PreprocessingPlan: could not write {}", path));
+  }
+}
+
+PreprocessingPlan PreprocessingPlan::load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error(fmt::format("PreprocessingPlan: could not open {}", path));
+  }
+  const std::string content(std::istreambuf_iterator<char>(file), {});
+  json::error_code ec;
+  const auto value = json::parse(content, ec);
+  if (ec || !value.is_object()) {
+    throw std::runtime_error(fmt::format("PreprocessingPlan: could not parse {}", path));
+  }
+  return from_json(value.get_object());
+}
+
+}  // namespace MOTION
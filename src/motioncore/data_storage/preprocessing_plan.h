@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include <boost/json/object.hpp>
+
+namespace MOTION {
+
+// Amounts of correlated randomness which a circuit requests from the providers.  It is recorded
+// from a dry run, i.e., by building the circuit without evaluating it, and saved as JSON s.t.
+// later runs of a circuit with the same shape can start their preprocessing before the circuit is
+// built, see TwoPartyBackend::prepare_preprocessing().
+struct PreprocessingPlan {
+  // bit widths of the arrays below
+  static constexpr std::array<std::size_t, 4> mt_bit_sizes = {8, 16, 32, 64};
+  static constexpr std::array<std::size_t, 4> sb_bit_sizes = {8, 16, 32, 64};
+  static constexpr std::array<std::size_t, 5> sp_bit_sizes = {8, 16, 32, 64, 128};
+
+  std::size_t num_binary_mts = 0;
+  std::array<std::size_t, 4> num_mts{};
+  std::array<std::size_t, 4> num_sbs{};
+  std::array<std::size_t, 5> num_sps{};
+  // OTs which the gates register directly with the OT provider
+  std::size_t num_ots_sent = 0;
+  std::size_t num_ots_received = 0;
+
+  boost::json::object to_json() const;
+  static PreprocessingPlan from_json(const boost::json::object&);
+
+  void save(const std::string& path) const;
+  static PreprocessingPlan load(const std::string& path);
+
+  bool operator==(const PreprocessingPlan&) const = default;
+};
+
+}  // namespace MOTION
@@ -0,0 +1,245 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "preprocessing_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <system_error>
+
+#include <fmt/format.h>
+
+namespace MOTION {
+
+namespace {
+
+constexpr std::array<char, 8> preprocessing_store_magic = {'M', 'O', 'T', 'N', 'P', 'R', 'E', '1'};
+constexpr std::size_t header_size = 3 * sizeof(std::uint64_t);
+
+constexpr std::size_t pad_to_words(std::size_t num_bytes) {
+  return (num_bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t) * sizeof(std::uint64_t);
+}
+
+void append_word(std::vector<std::byte>& buffer, std::uint64_t word) {
+  const auto* bytes = reinterpret_cast<const std::byte*>(&word);
+  buffer.insert(std::end(buffer), bytes, bytes + sizeof(word));
+}
+
+std::uint64_t load_word(const std::byte* position) {
+  std::uint64_t word;
+  std::memcpy(&word, position, sizeof(word));
+  return word;
+}
+
+}  // namespace
+
+PreprocessingWriter::PreprocessingWriter(const std::string& path, std::size_t my_id)
+    : path_(path), file_(path, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingWriter: could not open {} for writing", path_));
+  }
+  std::vector<std::byte> header;
+  header.resize(sizeof(preprocessing_store_magic));
+  std::memcpy(header.data(), preprocessing_store_magic.data(), preprocessing_store_magic.size());
+  append_word(header, my_id);
+  // number of records, written by finish()
+  append_word(header, 0);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+PreprocessingWriter::~PreprocessingWriter() = default;
+
+void PreprocessingWriter::begin_record(std::size_t gate_id) {
+  if (in_record_ || finished_) {
+    throw std::logic_error("PreprocessingWriter: unexpected begin_record()");
+  }
+  gate_id_ = gate_id;
+  buffer_.clear();
+  in_record_ = true;
+}
+
+void PreprocessingWriter::write_bits(const ENCRYPTO::BitVector<>& bits) {
+  const auto& data = bits.GetData();
+  write_chunk(bits.GetSize(), data.data(), data.size());
+}
+
+void PreprocessingWriter::write_blocks(const ENCRYPTO::block128_vector& blocks) {
+  write_chunk(blocks.size(), reinterpret_cast<const std::byte*>(blocks.data()), blocks.byte_size());
+}
+
+void PreprocessingWriter::write_chunk(std::size_t size, const std::byte* data,
+                                      std::size_t num_bytes) {
+  if (!in_record_) {
+    throw std::logic_error("PreprocessingWriter: write outside of a record");
+  }
+  append_word(buffer_, size);
+  append_word(buffer_, num_bytes);
+  buffer_.insert(std::end(buffer_), data, data + num_bytes);
+  buffer_.resize(buffer_.size() + pad_to_words(num_bytes) - num_bytes, std::byte(0));
+}
+
+void PreprocessingWriter::end_record() {
+  if (!in_record_) {
+    throw std::logic_error("PreprocessingWriter: unexpected end_record()");
+  }
+  std::vector<std::byte> record_header;
+  append_word(record_header, gate_id_);
+  append_word(record_header, buffer_.size());
+  file_.write(reinterpret_cast<const char*>(record_header.data()), record_header.size());
+  file_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+  in_record_ = false;
+  ++num_records_;
+}
+
+void PreprocessingWriter::finish() {
+  if (in_record_ || finished_) {
+    throw std::logic_error("PreprocessingWriter: unexpected finish()");
+  }
+  const std::uint64_t num_records = num_records_;
+  file_.seekp(header_size - sizeof(num_records));
+  file_.write(reinterpret_cast<const char*>(&num_records), sizeof(num_records));
+  file_.close();
+  if (!file_) {
+    throw std::runtime_error(fmt::format("PreprocessingWriter: could not write {}", path_));
+  }
+  finished_ = true;
+}
+
+ENCRYPTO::BitVector<> PreprocessingRecord::read_bits() {
+  auto [num_bits, data] = read_chunk();
+  if (data.size() != (num_bits + 7) / 8) {
+    throw std::runtime_error("PreprocessingRecord: chunk has unexpected size");
+  }
+  return ENCRYPTO::BitVector<>(data.data(), num_bits);
+}
+
+ENCRYPTO::block128_vector PreprocessingRecord::read_blocks() {
+  auto [num_blocks, data] = read_chunk();
+  if (data.size() != num_blocks * sizeof(ENCRYPTO::block128_t)) {
+    throw std::runtime_error("PreprocessingRecord: chunk has unexpected size");
+  }
+  ENCRYPTO::block128_vector blocks(num_blocks);
+  std::memcpy(blocks.data(), data.data(), data.size());
+  return blocks;
+}
+
+std::pair<std::size_t, std::span<const std::byte>> PreprocessingRecord::read_chunk() {
+  if (end_ - position_ < static_cast<std::ptrdiff_t>(2 * sizeof(std::uint64_t))) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingRecord: no more data stored for gate {}", gate_id_));
+  }
+  const std::size_t size = load_word(position_);
+  const std::size_t num_bytes = load_word(position_ + sizeof(std::uint64_t));
+  const auto* data = position_ + 2 * sizeof(std::uint64_t);
+  if (static_cast<std::size_t>(end_ - data) < pad_to_words(num_bytes)) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingRecord: truncated data stored for gate {}", gate_id_));
+  }
+  position_ = data + pad_to_words(num_bytes);
+  return {size, {data, num_bytes}};
+}
+
+PreprocessingReader::PreprocessingReader(const std::string& path, std::size_t my_id)
+    : path_(path) {
+  int fd = ::open(path_.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            fmt::format("PreprocessingReader: could not open {}", path_));
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == -1) {
+    auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("PreprocessingReader: could not stat {}", path_));
+  }
+  mapping_size_ = file_stat.st_size;
+  if (mapping_size_ < header_size) {
+    ::close(fd);
+    throw std::runtime_error(fmt::format("PreprocessingReader: {} is too small", path_));
+  }
+  mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  auto error = errno;
+  ::close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("PreprocessingReader: could not map {}", path_));
+  }
+
+  try {
+    read_index(my_id);
+  } catch (...) {
+    ::munmap(mapping_, mapping_size_);
+    throw;
+  }
+  // tell the kernel that we are going to read the whole store
+  ::madvise(mapping_, mapping_size_, MADV_WILLNEED);
+}
+
+void PreprocessingReader::read_index(std::size_t my_id) {
+  const auto* data = static_cast<const std::byte*>(mapping_);
+  if (std::memcmp(data, preprocessing_store_magic.data(), preprocessing_store_magic.size()) != 0) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingReader: {} is not a preprocessing store", path_));
+  }
+  if (load_word(data + sizeof(std::uint64_t)) != my_id) {
+    throw std::runtime_error(
+        fmt::format("PreprocessingReader: {} was not written by party {}", path_, my_id));
+  }
+  const std::size_t num_records = load_word(data + 2 * sizeof(std::uint64_t));
+  records_.reserve(num_records);
+  std::size_t offset = header_size;
+  for (std::size_t record_i = 0; record_i < num_records; ++record_i) {
+    if (mapping_size_ - offset < 2 * sizeof(std::uint64_t)) {
+      throw std::runtime_error(fmt::format("PreprocessingReader: {} is truncated", path_));
+    }
+    const std::size_t gate_id = load_word(data + offset);
+    const std::size_t size = load_word(data + offset + sizeof(std::uint64_t));
+    offset += 2 * sizeof(std::uint64_t);
+    if (mapping_size_ - offset < size) {
+      throw std::runtime_error(fmt::format("PreprocessingReader: {} is truncated", path_));
+    }
+    records_.push_back({gate_id, offset, size});
+    offset += size;
+  }
+}
+
+PreprocessingReader::~PreprocessingReader() {
+  if (mapping_) {
+    ::munmap(mapping_, mapping_size_);
+  }
+}
+
+PreprocessingRecord PreprocessingReader::get_record(std::size_t record_i) const {
+  const auto& location = records_.at(record_i);
+  const auto* data = static_cast<const std::byte*>(mapping_);
+  return PreprocessingRecord(location.gate_id, data + location.offset,
+                             data + location.offset + location.size);
+}
+
+}  // namespace MOTION
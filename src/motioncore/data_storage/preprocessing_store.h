@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/bit_vector.h"
+#include "utility/block.h"
+
+namespace MOTION {
+
+// File format of a preprocessing store (all integers are 64 bit in host byte order):
+//
+//   header:   magic, party id, number of records
+//   record:   gate id, size of the payload in bytes, payload
+//   payload:  sequence of chunks (number of bits or elements, size in bytes, data padded to 8
+//             bytes)
+//
+// The store is only meant to be read by the same party on the same machine that wrote it.
+// Besides the gates, providers can write records of their own, which use the ids counting down
+// from provider_record_id.
+
+constexpr std::size_t provider_record_id = std::numeric_limits<std::size_t>::max();
+
+// Writes the setup material of the gates of a circuit to a file.
+class PreprocessingWriter {
+ public:
+  PreprocessingWriter(const std::string& path, std::size_t my_id);
+  ~PreprocessingWriter();
+
+  PreprocessingWriter(const PreprocessingWriter&) = delete;
+  PreprocessingWriter& operator=(const PreprocessingWriter&) = delete;
+
+  void begin_record(std::size_t gate_id);
+  void write_bits(const ENCRYPTO::BitVector<>& bits);
+  void write_blocks(const ENCRYPTO::block128_vector& blocks);
+  template <typename T>
+  void write_ints(const std::vector<T>& ints) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write_chunk(ints.size(), reinterpret_cast<const std::byte*>(ints.data()),
+                ints.size() * sizeof(T));
+  }
+  void end_record();
+
+  // write the number of records to the header and close the file
+  void finish();
+
+  std::size_t get_num_records() const noexcept { return num_records_; }
+
+ private:
+  void write_chunk(std::size_t size, const std::byte* data, std::size_t num_bytes);
+
+  std::string path_;
+  std::ofstream file_;
+  std::vector<std::byte> buffer_;
+  std::size_t gate_id_ = 0;
+  bool in_record_ = false;
+  bool finished_ = false;
+  std::size_t num_records_ = 0;
+};
+
+// View on the setup material of a single gate inside a memory mapped store.  The chunks have to
+// be read in the order they have been written.
+class PreprocessingRecord {
+ public:
+  PreprocessingRecord(std::size_t gate_id, const std::byte* begin, const std::byte* end)
+      : gate_id_(gate_id), position_(begin), end_(end) {}
+
+  std::size_t get_gate_id() const noexcept { return gate_id_; }
+
+  ENCRYPTO::BitVector<> read_bits();
+  // copies the blocks, since the mapped data is only aligned to 8 bytes
+  ENCRYPTO::block128_vector read_blocks();
+  template <typename T>
+  std::vector<T> read_ints() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto [size, data] = read_chunk();
+    if (data.size() != size * sizeof(T)) {
+      throw std::runtime_error("PreprocessingRecord: chunk has unexpected size");
+    }
+    std::vector<T> ints(size);
+    std::memcpy(ints.data(), data.data(), data.size());
+    return ints;
+  }
+  // direct access to the mapped data of the next chunk
+  std::pair<std::size_t, std::span<const std::byte>> read_chunk();
+
+  bool empty() const noexcept { return position_ == end_; }
+
+ private:
+  std::size_t gate_id_;
+  const std::byte* position_;
+  const std::byte* end_;
+};
+
+// Maps a store created by PreprocessingWriter into memory.
+class PreprocessingReader {
+ public:
+  PreprocessingReader(const std::string& path, std::size_t my_id);
+  ~PreprocessingReader();
+
+  PreprocessingReader(const PreprocessingReader&) = delete;
+  PreprocessingReader& operator=(const PreprocessingReader&) = delete;
+
+  std::size_t get_num_records() const noexcept { return records_.size(); }
+  PreprocessingRecord get_record(std::size_t record_i) const;
+
+ private:
+  void read_index(std::size_t my_id);
+
+  struct RecordLocation {
+    std::size_t gate_id;
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  std::string path_;
+  void* mapping_ = nullptr;
+  std::size_t mapping_size_ = 0;
+  std::vector<RecordLocation> records_;
+};
+
+}  // namespace MOTION
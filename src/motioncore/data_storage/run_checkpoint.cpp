@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "run_checkpoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace MOTION {
+
+namespace {
+
+constexpr std::array<char, 8> run_checkpoint_magic = {'M', 'O', 'T', 'N', 'C', 'K', 'P', '1'};
+constexpr std::size_t marker_size = run_checkpoint_magic.size() + 2 * sizeof(std::uint64_t) +
+                                    std::tuple_size_v<RunCheckpoint::id_t>;
+
+void append_word(std::vector<std::byte>& buffer, std::uint64_t word) {
+  const auto* bytes = reinterpret_cast<const std::byte*>(&word);
+  buffer.insert(std::end(buffer), bytes, bytes + sizeof(word));
+}
+
+std::uint64_t load_word(const std::byte* position) {
+  std::uint64_t word;
+  std::memcpy(&word, position, sizeof(word));
+  return word;
+}
+
+}  // namespace
+
+RunCheckpoint::RunCheckpoint(std::string directory, std::string run_name)
+    : directory_(std::move(directory)), run_name_(std::move(run_name)) {}
+
+std::string RunCheckpoint::get_marker_path(std::size_t my_id) const {
+  return fmt::format("{}/checkpoint_{}_{}.marker", directory_, run_name_, my_id);
+}
+
+std::string RunCheckpoint::get_store_path(std::size_t my_id) const {
+  return fmt::format("{}/checkpoint_{}_{}.setup", directory_, run_name_, my_id);
+}
+
+std::optional<RunCheckpoint::Marker> RunCheckpoint::load_marker(std::size_t my_id) const {
+  std::ifstream file(get_marker_path(my_id), std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+  std::vector<std::byte> buffer(marker_size);
+  file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+  // a truncated or foreign marker is treated like a missing one, the run just starts over
+  if (file.gcount() != static_cast<std::streamsize>(marker_size) ||
+      file.peek() != std::ifstream::traits_type::eof() ||
+      std::memcmp(buffer.data(), run_checkpoint_magic.data(), run_checkpoint_magic.size()) != 0) {
+    return std::nullopt;
+  }
+  const std::byte* position = buffer.data() + run_checkpoint_magic.size();
+  if (load_word(position) != my_id) {
+    return std::nullopt;
+  }
+  Marker marker;
+  marker.num_gates_ = load_word(position + sizeof(std::uint64_t));
+  position += 2 * sizeof(std::uint64_t);
+  std::copy(position, position + marker.id_.size(), std::begin(marker.id_));
+  return marker;
+}
+
+void RunCheckpoint::store_marker(std::size_t my_id, const Marker& marker) const {
+  std::vector<std::byte> buffer;
+  buffer.reserve(marker_size);
+  buffer.resize(run_checkpoint_magic.size());
+  std::memcpy(buffer.data(), run_checkpoint_magic.data(), run_checkpoint_magic.size());
+  append_word(buffer, my_id);
+  append_word(buffer, marker.num_gates_);
+  buffer.insert(std::end(buffer), std::begin(marker.id_), std::end(marker.id_));
+
+  // write to a temporary file first s.t. a crash never leaves a partial marker behind
+  const auto path = get_marker_path(my_id);
+  const auto tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error(
+          fmt::format("RunCheckpoint: could not open {} for writing", tmp_path));
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    if (!file) {
+      throw std::runtime_error(fmt::format("RunCheckpoint: could not write {}", tmp_path));
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error(
+        fmt::format("RunCheckpoint: could not rename {} to {}", tmp_path, path));
+  }
+}
+
+void RunCheckpoint::remove(std::size_t my_id) const {
+  // the marker goes first, s.t. a store without a marker is never used
+  std::remove(get_marker_path(my_id).c_str());
+  std::remove(get_store_path(my_id).c_str());
+}
+
+}  // namespace MOTION
@@ -0,0 +1,70 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace MOTION {
+
+// On-disk checkpoint of the evaluation of a circuit with one other party.
+//
+// Once the setup phase of all gates has finished, their setup material is written to a
+// preprocessing store (see PreprocessingWriter) and a marker is stored next to it.  The marker
+// holds an identifier both parties agreed on and the number of gates of the circuit.  A run which
+// loses its connection in the online phase can then be resumed on a new connection by loading the
+// store and running only the online phase, if the peer presents the same identifier.  The online
+// phase itself is not checkpointed since its messages depend on each other, so the checkpoint is
+// removed once it has finished.
+class RunCheckpoint {
+ public:
+  using id_t = std::array<std::byte, 16>;
+
+  struct Marker {
+    id_t id_;
+    std::uint64_t num_gates_;
+  };
+
+  // The files are stored in `directory`; `run_name` identifies the run across restarts.
+  RunCheckpoint(std::string directory, std::string run_name);
+
+  // return the marker of a complete checkpoint or std::nullopt if there is none or it cannot be
+  // read
+  std::optional<Marker> load_marker(std::size_t my_id) const;
+  // (over)write the marker, after the store has been written completely
+  void store_marker(std::size_t my_id, const Marker& marker) const;
+  // remove the marker and the store
+  void remove(std::size_t my_id) const;
+
+  std::string get_marker_path(std::size_t my_id) const;
+  std::string get_store_path(std::size_t my_id) const;
+
+ private:
+  std::string directory_;
+  std::string run_name_;
+};
+
+}  // namespace MOTION
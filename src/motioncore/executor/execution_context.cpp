@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2020 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "execution_context.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <boost/fiber/future.hpp>
+
+#include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
+
+namespace MOTION {
+
+void ExecutionContext::parallel_for(
+    std::size_t size, std::size_t granularity,
+    const std::function<void(std::size_t, std::size_t)>& fctn) const {
+  std::size_t num_chunks = 1;
+  if (fpool_ != nullptr) {
+    num_chunks = std::min(num_threads_, (size + granularity - 1) / granularity);
+  }
+  if (num_chunks <= 1) {
+    fctn(std::size_t(0), size);
+    return;
+  }
+  auto chunk_size = (size + num_chunks - 1) / num_chunks;
+  chunk_size = (chunk_size + granularity - 1) / granularity * granularity;
+  std::vector<boost::fibers::future<void>> futures;
+  for (std::size_t begin = chunk_size; begin < size; begin += chunk_size) {
+    const auto end = std::min(size, begin + chunk_size);
+    auto task = std::make_shared<boost::fibers::packaged_task<void()>>(
+        [&fctn, begin, end] { fctn(begin, end); });
+    futures.emplace_back(task->get_future());
+    fpool_->post([task] { (*task)(); });
+  }
+  // the posted chunks reference fctn, so wait for all of them before throwing
+  std::exception_ptr exception;
+  try {
+    fctn(std::size_t(0), std::min(size, chunk_size));
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  for (auto& f : futures) {
+    try {
+      f.get();
+    } catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace MOTION
@@ -23,17 +23,28 @@
 #pragma once
 
 #include <cstddef>
-#include <memory>
+#include <functional>
 
 namespace ENCRYPTO {
+class Arena;
 class FiberThreadPool;
-}
+}  // namespace ENCRYPTO
 
 namespace MOTION {
 
 struct ExecutionContext {
   std::size_t num_threads_;
-  std::unique_ptr<ENCRYPTO::FiberThreadPool> fpool_;
+  // the pool which also evaluates the gates, owned by the executor
+  ENCRYPTO::FiberThreadPool* fpool_ = nullptr;
+  // memory for buffers which the gates keep until the end of the run, owned by the GateRegister
+  ENCRYPTO::Arena* arena_ = nullptr;
+
+  // Split [0, size) into at most num_threads_ chunks whose sizes are multiples of granularity, and
+  // call fctn(begin, end) for each of them.  The calling fiber evaluates the first chunk itself
+  // and posts the others to fpool_, where they queue up with the gates instead of competing with
+  // them for the cores.  Returns when all chunks are done and rethrows the first exception.
+  void parallel_for(std::size_t size, std::size_t granularity,
+                    const std::function<void(std::size_t, std::size_t)>& fctn) const;
 };
 
 }  // namespace MOTION
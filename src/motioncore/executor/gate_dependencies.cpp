@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gate_dependencies.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "gate/new_gate.h"
+
+namespace MOTION {
+
+GateDependencies::GateDependencies(const std::vector<std::unique_ptr<NewGate>>& gates)
+    : successors_(gates.size()),
+      num_predecessors_(gates.size(), 0),
+      has_unknown_producer_(gates.size(), false) {
+  const auto num_gates = gates.size();
+  std::unordered_map<const NewWire*, std::size_t> producers;
+  std::vector<const NewWire*> wires;
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    wires.clear();
+    gates[gate_i]->collect_output_wires(wires);
+    // forwarding gates report their input wires as outputs, keep the first producer
+    for (const auto* wire : wires) {
+      producers.emplace(wire, gate_i);
+    }
+  }
+  std::vector<std::size_t> predecessors;
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    wires.clear();
+    predecessors.clear();
+    gates[gate_i]->collect_input_wires(wires);
+    for (const auto* wire : wires) {
+      auto it = producers.find(wire);
+      if (it == producers.end()) {
+        has_unknown_producer_[gate_i] = true;
+      } else if (it->second != gate_i) {
+        predecessors.push_back(it->second);
+      }
+    }
+    std::sort(std::begin(predecessors), std::end(predecessors));
+    predecessors.erase(std::unique(std::begin(predecessors), std::end(predecessors)),
+                       std::end(predecessors));
+    for (auto pred_i : predecessors) {
+      successors_[pred_i].push_back(gate_i);
+    }
+    num_predecessors_[gate_i] = predecessors.size();
+  }
+}
+
+std::vector<std::size_t> compute_remaining_rounds(
+    const std::vector<std::unique_ptr<NewGate>>& gates, const GateDependencies& dependencies) {
+  const auto num_gates = gates.size();
+  // topological order of the gates, gates on a cycle are left out
+  std::vector<std::size_t> order;
+  order.reserve(num_gates);
+  std::vector<std::size_t> remaining(dependencies.num_predecessors_);
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    if (remaining[gate_i] == 0) {
+      order.push_back(gate_i);
+    }
+  }
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    for (auto succ_i : dependencies.successors_[order[i]]) {
+      if (--remaining[succ_i] == 0) {
+        order.push_back(succ_i);
+      }
+    }
+  }
+
+  // the successors of a gate come after it, so walk the order backwards
+  std::vector<std::size_t> rounds(num_gates, 0);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const auto gate_i = *it;
+    std::size_t succ_rounds = 0;
+    for (auto succ_i : dependencies.successors_[gate_i]) {
+      succ_rounds = std::max(succ_rounds, rounds[succ_i]);
+    }
+    const auto cost = gates[gate_i]->get_cost();
+    rounds[gate_i] = succ_rounds + (cost.has_value() ? cost->online_rounds_ : 0);
+  }
+  return rounds;
+}
+
+}  // namespace MOTION
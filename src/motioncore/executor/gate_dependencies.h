@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace MOTION {
+
+class NewGate;
+
+// Dependency graph between the registered gates, derived from the wires they read and write.
+struct GateDependencies {
+  explicit GateDependencies(const std::vector<std::unique_ptr<NewGate>>& gates);
+  std::vector<std::vector<std::size_t>> successors_;
+  std::vector<std::size_t> num_predecessors_;
+  // some input wire is not reported as output by any gate
+  std::vector<bool> has_unknown_producer_;
+};
+
+// Remaining interactive depth of each gate, i.e., the largest number of online rounds (see
+// GateCost::online_rounds_) on a path from the gate, including it, to the end of the circuit.
+// Gates without a cost model count as local, gates on a cycle get 0.
+std::vector<std::size_t> compute_remaining_rounds(
+    const std::vector<std::unique_ptr<NewGate>>& gates, const GateDependencies& dependencies);
+
+}  // namespace MOTION
@@ -22,20 +22,202 @@
 
 #include "new_gate_executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <boost/core/demangle.hpp>
 #include <boost/fiber/future/async.hpp>
 #include <boost/fiber/policy.hpp>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
+#include <fmt/format.h>
 
 #include "base/gate_register.h"
+#include "communication/transport.h"
+#include "data_storage/preprocessing_store.h"
+#include "executor/gate_dependencies.h"
 #include "gate/new_gate.h"
+#include "protocols/common/comm_mixin.h"
+#include "statistics/gate_profiler.h"
+#include "statistics/metrics.h"
 #include "statistics/run_time_stats.h"
+#include "statistics/trace_recorder.h"
 #include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
+#include "utility/constants.h"
 #include "utility/synchronized_queue.h"
+#include "utility/thread.h"
 #include "executor/execution_context.h"
 #include "utility/logger.h"
 
 namespace MOTION {
 
+namespace {
+
+// Schedules one phase of all gates in dependency order.  A gate is passed to `launch` as soon
+// as all its predecessors have finished the phase.  The launched task has to call `select` with
+// the gate to find the gate it evaluates and `finish` after the gate has been evaluated.  Gates
+// not taking part in the phase are finished directly.  With priorities, each launched task takes
+// the ready gate with the highest priority when it starts instead of the gate it was launched
+// for, s.t. the gates on the critical path overtake the other gates waiting in the pool.
+class ReadyQueueScheduler {
+ public:
+  ReadyQueueScheduler(const GateDependencies& dependencies,
+                      std::function<bool(std::size_t)> need_phase,
+                      std::function<void(std::size_t)> launch,
+                      const std::vector<std::size_t>* priorities = nullptr)
+      : dependencies_(dependencies),
+        need_phase_(std::move(need_phase)),
+        launch_(std::move(launch)),
+        priorities_(priorities),
+        num_gates_(dependencies.num_predecessors_.size()),
+        remaining_(std::make_unique<std::atomic<std::size_t>[]>(num_gates_)) {
+    for (std::size_t gate_i = 0; gate_i < num_gates_; ++gate_i) {
+      remaining_[gate_i] = dependencies_.num_predecessors_[gate_i];
+    }
+  }
+
+  void start() {
+    std::vector<std::size_t> ready;
+    // push in reverse order such that gates are launched in ascending order
+    for (std::size_t gate_i = num_gates_; gate_i-- > 0;) {
+      if (dependencies_.num_predecessors_[gate_i] == 0) {
+        ready.push_back(gate_i);
+      }
+    }
+    process(ready);
+  }
+
+  std::size_t select(std::size_t gate_i) {
+    if (priorities_ == nullptr) {
+      return gate_i;
+    }
+    std::scoped_lock lock(ready_mutex_);
+    std::pop_heap(std::begin(ready_heap_), std::end(ready_heap_), ready_order_);
+    gate_i = ready_heap_.back();
+    ready_heap_.pop_back();
+    return gate_i;
+  }
+
+  void finish(std::size_t gate_i) {
+    std::vector<std::size_t> ready;
+    release_successors(gate_i, ready);
+    process(ready);
+  }
+
+ private:
+  void release_successors(std::size_t gate_i, std::vector<std::size_t>& ready) {
+    for (auto succ_i : dependencies_.successors_[gate_i]) {
+      if (--remaining_[succ_i] == 0) {
+        ready.push_back(succ_i);
+      }
+    }
+  }
+
+  void process(std::vector<std::size_t>& ready) {
+    while (!ready.empty()) {
+      auto gate_i = ready.back();
+      ready.pop_back();
+      if (!need_phase_(gate_i)) {
+        release_successors(gate_i, ready);
+        continue;
+      }
+      if (priorities_ != nullptr) {
+        std::scoped_lock lock(ready_mutex_);
+        ready_heap_.push_back(gate_i);
+        std::push_heap(std::begin(ready_heap_), std::end(ready_heap_), ready_order_);
+      }
+      launch_(gate_i);
+    }
+  }
+
+  const GateDependencies& dependencies_;
+  std::function<bool(std::size_t)> need_phase_;
+  std::function<void(std::size_t)> launch_;
+  const std::vector<std::size_t>* priorities_;
+  std::size_t num_gates_;
+  std::unique_ptr<std::atomic<std::size_t>[]> remaining_;
+  // max-heap of the launched gates which have not been selected yet, ties are broken in favor of
+  // the gate registered first
+  std::mutex ready_mutex_;
+  std::vector<std::size_t> ready_heap_;
+  std::function<bool(std::size_t, std::size_t)> ready_order_ = [this](auto lhs, auto rhs) {
+    const auto& priorities = *priorities_;
+    return priorities[lhs] < priorities[rhs] || (priorities[lhs] == priorities[rhs] && lhs > rhs);
+  };
+};
+
+// Fuse the online messages and/or the output messages of the gates of the same type within each
+// layer of the circuit, such that each layer needs one message per protocol and gate type instead
+// of one per gate.
+void fuse_layer_messages(const std::vector<std::unique_ptr<NewGate>>& gates, bool online_messages,
+                         bool output_messages) {
+  const GateDependencies dependencies(gates);
+  const auto num_gates = gates.size();
+
+  // compute the depth of each gate in topological order; gates depending on an unknown gate
+  // cannot be assigned a reliable layer, and fusing them could introduce a deadlock
+  std::vector<std::size_t> levels(num_gates, 0);
+  std::vector<bool> untracked(dependencies.has_unknown_producer_);
+  std::vector<std::size_t> remaining(dependencies.num_predecessors_);
+  std::vector<std::size_t> ready;
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    if (remaining[gate_i] == 0) {
+      ready.push_back(gate_i);
+    }
+  }
+  while (!ready.empty()) {
+    auto gate_i = ready.back();
+    ready.pop_back();
+    for (auto succ_i : dependencies.successors_[gate_i]) {
+      levels[succ_i] = std::max(levels[succ_i], levels[gate_i] + 1);
+      if (untracked[gate_i]) {
+        untracked[succ_i] = true;
+      }
+      if (--remaining[succ_i] == 0) {
+        ready.push_back(succ_i);
+      }
+    }
+  }
+
+  // (level, comm mixin, gate type) -> [(gate_id, num_bits or num_elements)]
+  using KeyType = std::tuple<std::size_t, proto::CommMixin*, std::type_index>;
+  std::map<KeyType, std::vector<std::pair<std::size_t, std::size_t>>> layouts;
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    const auto& gate = *gates[gate_i];
+    if (!gate.need_online()) {
+      continue;
+    }
+    auto [comm_mixin, size] = std::pair<proto::CommMixin*, std::size_t>{nullptr, 0};
+    if (online_messages && !untracked[gate_i]) {
+      std::tie(comm_mixin, size) = gate.get_fusable_online_message();
+    }
+    // no gate waits for an output gate, so outputs in a wrong layer are only delayed, but cannot
+    // deadlock
+    if (comm_mixin == nullptr && output_messages) {
+      std::tie(comm_mixin, size) = gate.get_fusable_output_message();
+    }
+    if (comm_mixin == nullptr) {
+      continue;
+    }
+    layouts[{levels[gate_i], comm_mixin, std::type_index(typeid(gate))}].emplace_back(
+        gate.get_gate_id(), size);
+  }
+  for (const auto& [key, layout] : layouts) {
+    if (layout.size() > 1) {
+      std::get<1>(key)->fuse_messages(layout);
+    }
+  }
+}
+
+}  // namespace
+
 NewGateExecutor::NewGateExecutor(GateRegister& reg, std::function<void(void)> preprocessing_fctn,
                                  bool sync_between_setup_and_online,
                                  std::function<void(void)> sync_fctn, std::size_t num_threads,
@@ -43,6 +225,8 @@ NewGateExecutor::NewGateExecutor(GateRegister& reg, std::function<void(void)> pr
     : register_(reg),
       preprocessing_fctn_(std::move(preprocessing_fctn)),
       sync_fctn_(std::move(sync_fctn)),
+      setup_transport_mode_(Communication::TransportMode::throughput),
+      online_transport_mode_(Communication::TransportMode::latency),
       num_threads_(num_threads),
       sync_between_setup_and_online_(sync_between_setup_and_online),
       logger_(std::move(logger)) {}
@@ -52,8 +236,75 @@ NewGateExecutor::NewGateExecutor(GateRegister& reg, std::function<void(void)> pr
     : NewGateExecutor(
           reg, std::move(preprocessing_fctn), false, [] {}, num_threads, std::move(logger)) {}
 
+NewGateExecutor::~NewGateExecutor() {
+  if (fpool_) {
+    fpool_->join();
+  }
+}
+
+void NewGateExecutor::create_fiber_pool() {
+  // create the pool to execute fibers, it is kept for the next circuits
+  if (fpool_) {
+    return;
+  }
+  // the store based evaluation blocks on other gates, so it needs at least two workers
+  const auto num_workers = num_threads_ == 1 ? std::size_t{2} : num_threads_;
+  fpool_ = std::make_unique<ENCRYPTO::FiberThreadPool>(num_workers, 2 * register_.get_num_gates(),
+                                                       true, thread_placement_,
+                                                       fiber_stack_sizes_);
+  // the gates and their parallel loops share the same workers
+  exec_ctx_ = std::make_unique<ExecutionContext>(ExecutionContext{
+      .num_threads_ = num_threads_, .fpool_ = fpool_.get(), .arena_ = &register_.get_arena()});
+}
+
+std::size_t NewGateExecutor::get_gate_node(std::size_t gate_i) const {
+  // contiguous ranges of gates, which tend to share their wires, are placed on the same node
+  return gate_i * fpool_->get_num_nodes() / register_.get_num_gates();
+}
+
+FiberStackClass NewGateExecutor::get_max_fiber_stack_class() const {
+  auto stack_class = FiberStackClass::small;
+  for (const auto& gate : register_.get_gates()) {
+    stack_class = std::max(stack_class, gate->get_fiber_stack_class());
+  }
+  return stack_class;
+}
+
+void NewGateExecutor::set_transport_mode(Communication::TransportMode mode) {
+  if (transport_mode_fctn_) {
+    transport_mode_fctn_(mode);
+  }
+}
+
+void NewGateExecutor::set_adaptive_thread_allocation(std::size_t num_cpus) {
+  // the same number of workers as create_fiber_pool()
+  const auto num_workers = num_threads_ == 1 ? std::size_t{2} : num_threads_;
+  thread_allocator_ = std::make_unique<ThreadAllocator>(num_cpus, num_workers);
+}
+
+PhaseThreads NewGateExecutor::get_phase_threads() const noexcept {
+  return thread_allocator_ ? thread_allocator_->get_phase_threads() : PhaseThreads{};
+}
+
+void NewGateExecutor::use_phase_threads(std::size_t PhaseThreads::*phase) {
+  if (!thread_allocator_) {
+    return;
+  }
+  ENCRYPTO::set_phase_omp_threads(thread_allocator_->get_phase_threads().*phase);
+  // the preprocessing and the single-threaded evaluation run on this thread
+  ENCRYPTO::this_thread_use_phase_omp_threads();
+}
+
+std::vector<std::size_t> NewGateExecutor::compute_priorities(
+    const GateDependencies& dependencies) const {
+  if (scheduling_ != GateScheduling::critical_path) {
+    return {};
+  }
+  return compute_remaining_rounds(register_.get_gates(), dependencies);
+}
 
 void NewGateExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
+  fuse_messages();
   if (num_threads_ == 1) {
     evaluate_setup_online_single_threaded(stats);
   } else {
@@ -63,7 +314,10 @@ void NewGateExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
 
 void NewGateExecutor::evaluate_setup_online_multi_threaded(Statistics::RunTimeStats& stats) {
   stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+  start_instrumentation();
 
+  set_transport_mode(setup_transport_mode_);
+  use_phase_threads(&PhaseThreads::preprocessing_);
   preprocessing_fctn_();
 
   if (logger_) {
@@ -71,53 +325,106 @@ void NewGateExecutor::evaluate_setup_online_multi_threaded(Statistics::RunTimeSt
         "Start evaluating the circuit gates sequentially (online after all finished setup)");
   }
 
-  // create a pool to execute fibers
-  ENCRYPTO::FiberThreadPool fpool(num_threads_, 2 * register_.get_num_gates());
-
-  ExecutionContext exec_ctx{.num_threads_ = num_threads_,
-                            .fpool_ = std::make_unique<ENCRYPTO::FiberThreadPool>(
-                                std::max(std::size_t{2}, num_threads_))};
+  create_fiber_pool();
+  auto& fpool = *fpool_;
+  auto& exec_ctx = *exec_ctx_;
+
+  auto& gates = register_.get_gates();
+  std::unique_ptr<GateDependencies> dependencies;
+  std::vector<std::size_t> priorities;
+  auto max_stack_class = FiberStackClass::regular;
+  if (scheduling_ != GateScheduling::all_at_once) {
+    dependencies = std::make_unique<GateDependencies>(gates);
+    priorities = compute_priorities(*dependencies);
+    max_stack_class = get_max_fiber_stack_class();
+  }
 
   // ------------------------------ setup phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_setup_);
   stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
 
   if (register_.get_num_gates_with_setup()) {
-    // evaluate the setup phase of all the gates
-    for (auto& gate : register_.get_gates()) {
-      if (gate->need_setup()) {
-        fpool.post([&] {
-          gate->evaluate_setup_with_context(exec_ctx);
-          register_.increment_gate_setup_counter();
-        });
+    if (scheduling_ != GateScheduling::all_at_once) {
+      ReadyQueueScheduler scheduler(
+          *dependencies, [&gates](auto gate_i) { return gates[gate_i]->need_setup(); },
+          [&](auto gate_i) {
+            fpool.post(
+                [&, gate_i] {
+                  const auto selected_i = scheduler.select(gate_i);
+                  evaluate_gate_setup(*gates[selected_i], &exec_ctx);
+                  scheduler.finish(selected_i);
+                  register_.increment_gate_setup_counter();
+                },
+                get_gate_node(gate_i), max_stack_class);
+          },
+          priorities.empty() ? nullptr : &priorities);
+      scheduler.start();
+      register_.wait_setup();
+    } else {
+      // evaluate the setup phase of all the gates
+      for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+        if (auto& gate = gates[gate_i]; gate->need_setup()) {
+          fpool.post(
+              [&] {
+                evaluate_gate_setup(*gate, &exec_ctx);
+                register_.increment_gate_setup_counter();
+              },
+              get_gate_node(gate_i), gate->get_fiber_stack_class());
+        }
       }
+      register_.wait_setup();
     }
-    register_.wait_setup();
   }
 
   stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
 
+  if (setup_finished_fctn_) {
+    setup_finished_fctn_();
+  }
   if (sync_between_setup_and_online_) {
     sync_fctn_();
   }
+  set_transport_mode(online_transport_mode_);
 
   if (logger_) {
     logger_->LogInfo("Start with the online phase of the circuit gates");
   }
 
   // ------------------------------ online phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_online_);
   stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
 
   if (register_.get_num_gates_with_online()) {
-    // evaluate the online phase of all the gates
-    for (auto& gate : register_.get_gates()) {
-      if (gate->need_online()) {
-        fpool.post([&] {
-          gate->evaluate_online_with_context(exec_ctx);
-          register_.increment_gate_online_counter();
-        });
+    if (scheduling_ != GateScheduling::all_at_once) {
+      ReadyQueueScheduler scheduler(
+          *dependencies, [&gates](auto gate_i) { return gates[gate_i]->need_online(); },
+          [&](auto gate_i) {
+            fpool.post(
+                [&, gate_i] {
+                  const auto selected_i = scheduler.select(gate_i);
+                  evaluate_gate_online(*gates[selected_i], &exec_ctx);
+                  scheduler.finish(selected_i);
+                  register_.increment_gate_online_counter();
+                },
+                get_gate_node(gate_i), max_stack_class);
+          },
+          priorities.empty() ? nullptr : &priorities);
+      scheduler.start();
+      register_.wait_online();
+    } else {
+      // evaluate the online phase of all the gates
+      for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+        if (auto& gate = gates[gate_i]; gate->need_online()) {
+          fpool.post(
+              [&] {
+                evaluate_gate_online(*gate, &exec_ctx);
+                register_.increment_gate_online_counter();
+              },
+              get_gate_node(gate_i), gate->get_fiber_stack_class());
+        }
       }
+      register_.wait_online();
     }
-    register_.wait_online();
   }
 
   stats.record_end<Statistics::RunTimeStats::StatID::gates_online>();
@@ -127,15 +434,16 @@ void NewGateExecutor::evaluate_setup_online_multi_threaded(Statistics::RunTimeSt
   if (logger_) {
     logger_->LogInfo("Finished with the online phase of the circuit gates");
   }
-  exec_ctx.fpool_->join();
-  fpool.join();
-
   stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  finish_instrumentation(stats);
 }
 
 void NewGateExecutor::evaluate_setup_online_single_threaded(Statistics::RunTimeStats& stats) {
   stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+  start_instrumentation();
 
+  set_transport_mode(setup_transport_mode_);
+  use_phase_threads(&PhaseThreads::preprocessing_);
   preprocessing_fctn_();
 
   ENCRYPTO::SynchronizedFiberQueue<boost::fibers::fiber> cleanup_channel;
@@ -151,49 +459,98 @@ void NewGateExecutor::evaluate_setup_online_single_threaded(Statistics::RunTimeS
         "(single-threaded)");
   }
 
+  auto& gates = register_.get_gates();
+  std::unique_ptr<GateDependencies> dependencies;
+  std::vector<std::size_t> priorities;
+  if (scheduling_ != GateScheduling::all_at_once) {
+    dependencies = std::make_unique<GateDependencies>(gates);
+    priorities = compute_priorities(*dependencies);
+  }
+
   // ------------------------------ setup phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_setup_);
   stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
 
-  // evaluate the setup phase of all the gates
-  for (auto& gate : register_.get_gates()) {
-    if (gate->need_setup()) {
-      cleanup_channel.enqueue(boost::fibers::fiber(boost::fibers::launch::dispatch, [&] {
-        gate->evaluate_setup();
-        register_.increment_gate_setup_counter();
-      }));
+  if (scheduling_ != GateScheduling::all_at_once) {
+    ReadyQueueScheduler scheduler(
+        *dependencies, [&gates](auto gate_i) { return gates[gate_i]->need_setup(); },
+        [&](auto gate_i) {
+          cleanup_channel.enqueue(
+              boost::fibers::fiber(boost::fibers::launch::dispatch, [&, gate_i] {
+                const auto selected_i = scheduler.select(gate_i);
+                evaluate_gate_setup(*gates[selected_i], nullptr);
+                scheduler.finish(selected_i);
+                register_.increment_gate_setup_counter();
+              }));
+        },
+        priorities.empty() ? nullptr : &priorities);
+    scheduler.start();
+    register_.wait_setup();
+  } else {
+    // evaluate the setup phase of all the gates
+    for (auto& gate : gates) {
+      if (gate->need_setup()) {
+        cleanup_channel.enqueue(boost::fibers::fiber(boost::fibers::launch::dispatch, [&] {
+          evaluate_gate_setup(*gate, nullptr);
+          register_.increment_gate_setup_counter();
+        }));
+      }
     }
+    register_.wait_setup();
   }
-  register_.wait_setup();
 
   stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
 
+  if (setup_finished_fctn_) {
+    setup_finished_fctn_();
+  }
   if (sync_between_setup_and_online_) {
     sync_fctn_();
   }
+  set_transport_mode(online_transport_mode_);
 
   if (logger_) {
     logger_->LogInfo("Start with the online phase of the circuit gates (single-threaded)");
   }
 
   // ------------------------------ online phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_online_);
   stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
 
-  // evaluate the online phase of all the gates
-  for (auto& gate : register_.get_gates()) {
-    if (gate->need_online()) {
-      cleanup_channel.enqueue(boost::fibers::fiber(boost::fibers::launch::dispatch, [&] {
-        gate->evaluate_online();
-        register_.increment_gate_online_counter();
-      }));
+  if (scheduling_ != GateScheduling::all_at_once) {
+    ReadyQueueScheduler scheduler(
+        *dependencies, [&gates](auto gate_i) { return gates[gate_i]->need_online(); },
+        [&](auto gate_i) {
+          cleanup_channel.enqueue(
+              boost::fibers::fiber(boost::fibers::launch::dispatch, [&, gate_i] {
+                const auto selected_i = scheduler.select(gate_i);
+                evaluate_gate_online(*gates[selected_i], nullptr);
+                scheduler.finish(selected_i);
+                register_.increment_gate_online_counter();
+              }));
+        },
+        priorities.empty() ? nullptr : &priorities);
+    scheduler.start();
+    register_.wait_online();
+  } else {
+    // evaluate the online phase of all the gates
+    for (auto& gate : gates) {
+      if (gate->need_online()) {
+        cleanup_channel.enqueue(boost::fibers::fiber(boost::fibers::launch::dispatch, [&] {
+          evaluate_gate_online(*gate, nullptr);
+          register_.increment_gate_online_counter();
+        }));
+      }
     }
+    register_.wait_online();
   }
-  register_.wait_online();
 
   stats.record_end<Statistics::RunTimeStats::StatID::gates_online>();
 
   // --------------------------------------------------------------------------
 
   stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  finish_instrumentation(stats);
 
   if (logger_) {
     logger_->LogInfo("Finished with the online phase of the circuit gates (single-threaded)");
@@ -203,8 +560,358 @@ void NewGateExecutor::evaluate_setup_online_single_threaded(Statistics::RunTimeS
   cleanup_fut.get();
 }
 
-void NewGateExecutor::evaluate(Statistics::RunTimeStats&) {
-  throw std::logic_error("not implemented");
+void NewGateExecutor::check_preprocessing_store_support() const {
+  for (const auto& gate : register_.get_gates()) {
+    if (gate->need_setup() && !gate->supports_preprocessing_store()) {
+      throw std::logic_error(
+          fmt::format("gate {} does not support the preprocessing store", gate->get_gate_id()));
+    }
+  }
+}
+
+void NewGateExecutor::write_setup_to_store(PreprocessingWriter& writer) {
+  if (store_save_fctn_) {
+    writer.begin_record(provider_record_id);
+    store_save_fctn_(writer);
+    writer.end_record();
+  }
+  // records are written in the order of the gates in the register
+  for (auto& gate : register_.get_gates()) {
+    if (gate->need_setup()) {
+      writer.begin_record(gate->get_gate_id());
+      gate->save_setup(writer);
+      writer.end_record();
+    }
+  }
+  writer.finish();
+}
+
+void NewGateExecutor::evaluate_setup_and_store(Statistics::RunTimeStats& stats,
+                                               PreprocessingWriter& writer) {
+  auto& gates = register_.get_gates();
+  check_preprocessing_store_support();
+
+  stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+  start_instrumentation();
+
+  set_transport_mode(setup_transport_mode_);
+  use_phase_threads(&PhaseThreads::preprocessing_);
+  preprocessing_fctn_();
+
+  if (logger_) {
+    logger_->LogInfo("Start evaluating the setup phase of the circuit gates for the store");
+  }
+
+  create_fiber_pool();
+  auto& fpool = *fpool_;
+  auto& exec_ctx = *exec_ctx_;
+
+  use_phase_threads(&PhaseThreads::gates_setup_);
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
+  if (register_.get_num_gates_with_setup()) {
+    for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+      if (auto& gate = gates[gate_i]; gate->need_setup()) {
+        fpool.post(
+            [&] {
+              evaluate_gate_setup(*gate, &exec_ctx);
+              register_.increment_gate_setup_counter();
+            },
+            get_gate_node(gate_i), gate->get_fiber_stack_class());
+      }
+    }
+    register_.wait_setup();
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
+
+  write_setup_to_store(writer);
+
+  if (logger_) {
+    logger_->LogInfo(fmt::format("Stored the setup of {} gates", writer.get_num_records()));
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  finish_instrumentation(stats);
+}
+
+void NewGateExecutor::evaluate_online_from_store(Statistics::RunTimeStats& stats,
+                                                 const PreprocessingReader& reader) {
+  auto& gates = register_.get_gates();
+  check_preprocessing_store_support();
+  const auto num_setup_gates = static_cast<std::size_t>(std::count_if(
+      std::begin(gates), std::end(gates), [](const auto& gate) { return gate->need_setup(); }));
+  const std::size_t num_provider_records = store_load_fctn_ ? 1 : 0;
+  if (reader.get_num_records() != num_provider_records + num_setup_gates) {
+    throw std::runtime_error(
+        fmt::format("preprocessing store contains {} records, but the circuit has {} gates with "
+                    "a setup phase",
+                    reader.get_num_records(), num_setup_gates));
+  }
+
+  fuse_messages();
+
+  stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+  start_instrumentation();
+
+  // the setup is loaded from the store, so only the online phase communicates
+  set_transport_mode(online_transport_mode_);
+
+  // ------------------------------ setup phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_setup_);
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
+  std::size_t record_i = 0;
+  if (store_load_fctn_) {
+    auto record = reader.get_record(record_i++);
+    if (record.get_gate_id() != provider_record_id) {
+      throw std::runtime_error("preprocessing store does not start with the provider record");
+    }
+    store_load_fctn_(record);
+  }
+  for (auto& gate : gates) {
+    if (!gate->need_setup()) {
+      continue;
+    }
+    auto record = reader.get_record(record_i++);
+    if (record.get_gate_id() != gate->get_gate_id()) {
+      throw std::runtime_error(
+          fmt::format("preprocessing store record for gate {} does not match gate {}",
+                      record.get_gate_id(), gate->get_gate_id()));
+    }
+    gate->load_setup(record);
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
+
+  if (logger_) {
+    logger_->LogInfo("Loaded the setup from the store, start with the online phase");
+  }
+
+  create_fiber_pool();
+  auto& fpool = *fpool_;
+  auto& exec_ctx = *exec_ctx_;
+
+  // ------------------------------ online phase ------------------------------
+  use_phase_threads(&PhaseThreads::gates_online_);
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
+  if (register_.get_num_gates_with_online()) {
+    for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+      if (auto& gate = gates[gate_i]; gate->need_online()) {
+        fpool.post(
+            [&] {
+              evaluate_gate_online(*gate, &exec_ctx);
+              register_.increment_gate_online_counter();
+            },
+            get_gate_node(gate_i), gate->get_fiber_stack_class());
+      }
+    }
+    register_.wait_online();
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::gates_online>();
+
+  if (logger_) {
+    logger_->LogInfo("Finished with the online phase of the circuit gates");
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  finish_instrumentation(stats);
+}
+
+namespace {
+
+// run the phase of the gate, record its wall time with the profiler and an event with the recorder
+template <typename F>
+void run_gate_phase(const NewGate& gate, Statistics::GateProfiler::Phase phase,
+                    Statistics::GateProfiler* profiler, Statistics::TraceRecorder* recorder,
+                    F&& evaluate) {
+  std::optional<Statistics::TraceScope> trace_scope;
+  if constexpr (MOTION_TRACING) {
+    if (recorder != nullptr) {
+      Statistics::TraceRecorder::set_thread_recorder(recorder);
+      trace_scope.emplace(boost::core::demangle(typeid(gate).name()),
+                          phase == Statistics::GateProfiler::Phase::setup ? "setup" : "online",
+                          fmt::format("\"gate_id\":{}", gate.get_gate_id()));
+    }
+  }
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (profiler != nullptr) {
+      const auto start = Statistics::GateProfiler::clock_type::now();
+      evaluate();
+      profiler->record_time(phase, gate.get_gate_id(),
+                            Statistics::GateProfiler::clock_type::now() - start);
+      return;
+    }
+  }
+  evaluate();
+}
+
+}  // namespace
+
+void NewGateExecutor::fuse_messages() {
+  if ((fuse_online_messages_ || fuse_output_messages_) && !messages_fused_) {
+    fuse_layer_messages(register_.get_gates(), fuse_online_messages_, fuse_output_messages_);
+    messages_fused_ = true;
+  }
+}
+
+void NewGateExecutor::evaluate_gate_setup(NewGate& gate, ExecutionContext* exec_ctx) {
+  // the workers are shared by the phases and pick up the threads of the current one
+  ENCRYPTO::this_thread_use_phase_omp_threads();
+  run_gate_phase(gate, Statistics::GateProfiler::Phase::setup, gate_profiler_, trace_recorder_,
+                 [&gate, exec_ctx] {
+                   if (exec_ctx != nullptr) {
+                     gate.evaluate_setup_with_context(*exec_ctx);
+                   } else {
+                     gate.evaluate_setup();
+                   }
+                 });
+}
+
+void NewGateExecutor::evaluate_gate_online(NewGate& gate, ExecutionContext* exec_ctx) {
+  ENCRYPTO::this_thread_use_phase_omp_threads();
+  run_gate_phase(gate, Statistics::GateProfiler::Phase::online, gate_profiler_, trace_recorder_,
+                 [&gate, exec_ctx] {
+                   if (exec_ctx != nullptr) {
+                     gate.evaluate_online_with_context(*exec_ctx);
+                   } else {
+                     gate.evaluate_online();
+                   }
+                 });
+}
+
+void NewGateExecutor::start_instrumentation() {
+  if (fpool_) {
+    fpool_->reset_stack_statistics();
+  }
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (gate_profiler_ != nullptr) {
+      const auto& gates = register_.get_gates();
+      std::vector<std::pair<std::size_t, std::string>> gate_types;
+      gate_types.reserve(gates.size());
+      for (const auto& gate : gates) {
+        gate_types.emplace_back(gate->get_gate_id(), boost::core::demangle(typeid(*gate).name()));
+      }
+      gate_profiler_->start(gate_types);
+    }
+  }
+}
+
+void NewGateExecutor::finish_instrumentation(Statistics::RunTimeStats& stats) {
+  Statistics::record_evaluation_metrics(stats, register_.get_num_gates_with_setup(),
+                                        register_.get_num_gates_with_online());
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (gate_profiler_ != nullptr) {
+      stats.gate_profile_ = gate_profiler_->get_profile();
+    }
+  }
+  if (fpool_) {
+    const auto stack_stats = fpool_->get_stack_statistics();
+    stats.fiber_stacks_ = {.peak_bytes_in_use_ = stack_stats.peak_bytes_in_use,
+                           .bytes_reserved_ = stack_stats.bytes_reserved,
+                           .num_stacks_allocated_ = std::accumulate(
+                               std::begin(stack_stats.num_allocations),
+                               std::end(stack_stats.num_allocations), std::size_t(0))};
+    // return the stacks of this circuit to the OS before the next one
+    fpool_->release_unused_stacks();
+  }
+  if constexpr (MOTION_TRACING) {
+    // the single-threaded evaluation runs the gates on the calling thread
+    Statistics::TraceRecorder::set_thread_recorder(nullptr);
+  }
+  if (thread_allocator_) {
+    thread_allocator_->update(stats);
+    if (logger_) {
+      const auto& threads = thread_allocator_->get_phase_threads();
+      logger_->LogInfo(fmt::format(
+          "Threads of the next run: {} for the preprocessing, {} and {} per worker for the setup "
+          "and the online phase",
+          threads.preprocessing_, threads.gates_setup_, threads.gates_online_));
+    }
+  }
+}
+
+void NewGateExecutor::evaluate(Statistics::RunTimeStats& stats) {
+  if (sync_between_setup_and_online_) {
+    throw std::logic_error(
+        "the setup and the online phase cannot overlap with a synchronization between them");
+  }
+  fuse_messages();
+
+  stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+  start_instrumentation();
+
+  set_transport_mode(setup_transport_mode_);
+  use_phase_threads(&PhaseThreads::preprocessing_);
+  preprocessing_fctn_();
+  // setup and online messages are interleaved, so favor the online phase
+  set_transport_mode(online_transport_mode_);
+
+  if (logger_) {
+    logger_->LogInfo("Start evaluating the circuit gates (online directly after each setup)");
+  }
+
+  // the online phase of a gate may wait for messages which the other party sends in the setup
+  // phase of its gates, so the gates always run as fibers, even with a single thread
+  create_fiber_pool();
+  auto& fpool = *fpool_;
+  auto& exec_ctx = *exec_ctx_;
+  auto& gates = register_.get_gates();
+
+  const auto evaluate_gate = [this, &exec_ctx](NewGate& gate) {
+    if (gate.need_setup()) {
+      evaluate_gate_setup(gate, &exec_ctx);
+      register_.increment_gate_setup_counter();
+    }
+    if (gate.need_online()) {
+      evaluate_gate_online(gate, &exec_ctx);
+      register_.increment_gate_online_counter();
+    }
+  };
+
+  // both phases start at the same time and end when the last gate has finished them, the loops
+  // of both get the threads of the setup phase, which needs more computation
+  use_phase_threads(&PhaseThreads::gates_setup_);
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
+
+  if (scheduling_ != GateScheduling::all_at_once) {
+    // a gate is launched once its predecessors have finished both phases
+    const GateDependencies dependencies(gates);
+    const auto priorities = compute_priorities(dependencies);
+    const auto max_stack_class = get_max_fiber_stack_class();
+    ReadyQueueScheduler scheduler(
+        dependencies,
+        [&gates](auto gate_i) {
+          return gates[gate_i]->need_setup() || gates[gate_i]->need_online();
+        },
+        [&](auto gate_i) {
+          fpool.post(
+              [&, gate_i] {
+                const auto selected_i = scheduler.select(gate_i);
+                evaluate_gate(*gates[selected_i]);
+                scheduler.finish(selected_i);
+              },
+              get_gate_node(gate_i), max_stack_class);
+        },
+        priorities.empty() ? nullptr : &priorities);
+    scheduler.start();
+    register_.wait_setup();
+    stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
+    register_.wait_online();
+  } else {
+    for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+      if (auto& gate = gates[gate_i]; gate->need_setup() || gate->need_online()) {
+        fpool.post([&] { evaluate_gate(*gate); }, get_gate_node(gate_i),
+                   gate->get_fiber_stack_class());
+      }
+    }
+    register_.wait_setup();
+    stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
+    register_.wait_online();
+  }
+
+  stats.record_end<Statistics::RunTimeStats::StatID::gates_online>();
+
+  if (logger_) {
+    logger_->LogInfo("Finished with the online phase of the circuit gates");
+  }
+  stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  finish_instrumentation(stats);
 }
 
 }  // namespace MOTION
@@ -22,17 +22,53 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
+
+#include "executor/thread_allocator.h"
+#include "utility/constants.h"
+
+namespace ENCRYPTO {
+class FiberThreadPool;
+enum class ThreadPlacement : unsigned int;
+}  // namespace ENCRYPTO
 
 namespace MOTION {
 
+struct ExecutionContext;
+struct GateDependencies;
 class Logger;
 class GateRegister;
+class NewGate;
+class PreprocessingReader;
+class PreprocessingRecord;
+class PreprocessingWriter;
+
+namespace Communication {
+enum class TransportMode : std::uint8_t;
+}
 
 namespace Statistics {
+class GateProfiler;
 struct RunTimeStats;
-}
+class TraceRecorder;
+}  // namespace Statistics
+
+// Strategy used to hand the gates to the fiber pool.
+enum class GateScheduling {
+  // post all gates at once, each one blocks until its inputs are ready
+  all_at_once,
+  // track the number of unfinished predecessors of each gate and post a gate only when all the
+  // gates producing its input wires are done with the current phase
+  ready_queue,
+  // like ready_queue, but the ready gates with the most rounds of communication left until the end
+  // of the circuit are evaluated first, s.t. the latency of the critical path does not wait for
+  // gates which could run later, e.g., in evaluate() where the gates are evaluated as soon as
+  // possible
+  critical_path,
+};
 
 // Evaluates all registered gates.
 class NewGateExecutor {
@@ -42,23 +78,149 @@ class NewGateExecutor {
                   std::size_t num_threads, std::shared_ptr<Logger>);
   NewGateExecutor(GateRegister&, std::function<void()> preprocessing_fctn, std::size_t num_threads,
                   std::shared_ptr<Logger>);
+  ~NewGateExecutor();
 
   // Run the setup phases first for all gates before starting with the online
   // phases.
   void evaluate_setup_online(Statistics::RunTimeStats& stats);
-  // Run setup and online phase of each gate as soon as possible.
+  // Run setup and online phase of each gate as soon as possible, i.e., the online phase of a gate
+  // directly after its setup phase in the same fiber.  This allows the protocols to stream setup
+  // messages which the other party consumes in its online phase, e.g., the garbled tables of Yao
+  // with YaoProvider::set_garbled_table_window().  Both parties need to use it, and it cannot be
+  // combined with sync_between_setup_and_online.
   void evaluate(Statistics::RunTimeStats& stats);
 
+  // Run only the preprocessing and the setup phases and write the setup material of all gates
+  // to the store.  Throws if a gate with a setup phase does not support the store.
+  void evaluate_setup_and_store(Statistics::RunTimeStats& stats, PreprocessingWriter&);
+  // Load the setup material of all gates from the store and run only the online phases.  The
+  // circuit has to be constructed exactly as the one used for evaluate_setup_and_store.
+  void evaluate_online_from_store(Statistics::RunTimeStats& stats, const PreprocessingReader&);
+
+  // Called to save and to load the state of the providers which the stored gates depend on, e.g.,
+  // the keys of the garbling scheme.  The state is kept in a record with provider_record_id in
+  // front of the records of the gates.
+  void set_preprocessing_store_fctns(std::function<void(PreprocessingWriter&)> save_fctn,
+                                     std::function<void(PreprocessingRecord&)> load_fctn) {
+    store_save_fctn_ = std::move(save_fctn);
+    store_load_fctn_ = std::move(load_fctn);
+  }
+  // Throws if a gate with a setup phase does not support the store.
+  void check_preprocessing_store_support() const;
+  // Write the setup material of the providers and of all gates to the store, e.g., from the
+  // setup finished function after their setup phase.
+  void write_setup_to_store(PreprocessingWriter&);
+
+  // Called by evaluate_setup_online() once the setup phase of all gates has finished and before
+  // their online phase starts, e.g., to write a checkpoint of the setup material.
+  void set_setup_finished_fctn(std::function<void()> fctn) {
+    setup_finished_fctn_ = std::move(fctn);
+  }
+
+  void set_gate_scheduling(GateScheduling scheduling) noexcept { scheduling_ = scheduling; }
+  GateScheduling get_gate_scheduling() const noexcept { return scheduling_; }
+
+  // Group the gates into the layers of the circuit and send one fused online message for all
+  // gates of the same type in a layer (for gates supporting it).
+  void set_fuse_online_messages(bool fuse) noexcept { fuse_online_messages_ = fuse; }
+  // Send the reconstruction messages of the output gates of the same type in a layer as one fused
+  // message (for gates supporting it).
+  void set_fuse_output_messages(bool fuse) noexcept { fuse_output_messages_ = fuse; }
+
+  // Called with the transport mode for the phase which is about to start, i.e., before the
+  // preprocessing and before the online phase of the gates.
+  void set_transport_mode_fctn(std::function<void(Communication::TransportMode)> fctn) {
+    transport_mode_fctn_ = std::move(fctn);
+  }
+  // Select the transport modes used for the setup and for the online phase.  By default, the
+  // setup runs in throughput mode and the online phase in latency mode.
+  void set_transport_modes(Communication::TransportMode setup_mode,
+                           Communication::TransportMode online_mode) noexcept {
+    setup_transport_mode_ = setup_mode;
+    online_transport_mode_ = online_mode;
+  }
+
+  // Place the worker threads of the fiber pool on the CPUs (set before the first evaluation).
+  // With NUMA placement, the gates are split into contiguous ranges, one per node, and both
+  // phases of a gate are posted to the node of its range, s.t. its buffers stay local.
+  void set_thread_placement(ENCRYPTO::ThreadPlacement placement) noexcept {
+    thread_placement_ = placement;
+  }
+
+  // Split num_cpus CPUs of the session (0 for all) between the data parallel loops of the
+  // providers and the evaluation of the gates per phase, and adapt the split after each run to
+  // the CPU utilization of the phases (see ThreadAllocator).  Without it, the providers use the
+  // threads of OpenMP in all phases.  (set before the first evaluation)
+  void set_adaptive_thread_allocation(std::size_t num_cpus);
+  // threads of the phases of the next run, all 0 without the adaptive allocation
+  PhaseThreads get_phase_threads() const noexcept;
+
+  // Stack sizes of the fiber stack classes the gates select with get_fiber_stack_class() (set
+  // before the first evaluation).
+  void set_fiber_stack_sizes(const FiberStackSizes& stack_sizes) noexcept {
+    fiber_stack_sizes_ = stack_sizes;
+  }
+
+  // Record the wall time of the phases of each gate with the profiler and store the profile of
+  // the circuit in the run time stats (only used if MOTION_GATE_PROFILING is enabled).
+  void set_gate_profiler(Statistics::GateProfiler* profiler) noexcept { gate_profiler_ = profiler; }
+  // Record an event for each phase of each gate with the recorder, which is also used for the
+  // waits of the threads evaluating the gates (only used if MOTION_TRACING is enabled).
+  void set_trace_recorder(Statistics::TraceRecorder* recorder) noexcept {
+    trace_recorder_ = recorder;
+  }
+
+  // Prepare for the next circuit in the register.  The fiber pool is kept alive.
+  void reset() noexcept { messages_fused_ = false; }
+
  private:
   void evaluate_setup_online_multi_threaded(Statistics::RunTimeStats& stats);
   void evaluate_setup_online_single_threaded(Statistics::RunTimeStats& stats);
+  void create_fiber_pool();
+  // NUMA node of fpool_ the phases of the gate are posted to
+  std::size_t get_gate_node(std::size_t gate_i) const;
+  // the fibers of the ReadyQueueScheduler may evaluate any ready gate, so they get the largest
+  // stack class of all gates
+  FiberStackClass get_max_fiber_stack_class() const;
+  void set_transport_mode(Communication::TransportMode mode);
+  // apply the threads of the allocation for the phase which is about to start
+  void use_phase_threads(std::size_t PhaseThreads::*phase);
+  // fuse the messages of the gates in the register once before their first evaluation
+  void fuse_messages();
+  // priorities of the gates for the ReadyQueueScheduler, empty unless scheduling by the critical
+  // path
+  std::vector<std::size_t> compute_priorities(const GateDependencies& dependencies) const;
+  // evaluate a phase of the gate, with the execution context if it is not null, and record its wall
+  // time with the gate profiler and the trace recorder
+  void evaluate_gate_setup(NewGate& gate, ExecutionContext* exec_ctx);
+  void evaluate_gate_online(NewGate& gate, ExecutionContext* exec_ctx);
+  void start_instrumentation();
+  void finish_instrumentation(Statistics::RunTimeStats& stats);
 
   GateRegister& register_;
   std::function<void()> preprocessing_fctn_;
   std::function<void()> sync_fctn_;
+  std::function<void(Communication::TransportMode)> transport_mode_fctn_;
+  std::function<void(PreprocessingWriter&)> store_save_fctn_;
+  std::function<void(PreprocessingRecord&)> store_load_fctn_;
+  std::function<void()> setup_finished_fctn_;
+  Communication::TransportMode setup_transport_mode_;
+  Communication::TransportMode online_transport_mode_;
   std::size_t num_threads_;
   bool sync_between_setup_and_online_ = false;
+  GateScheduling scheduling_ = GateScheduling::all_at_once;
+  bool fuse_online_messages_ = false;
+  bool fuse_output_messages_ = false;
+  bool messages_fused_ = false;
+  ENCRYPTO::ThreadPlacement thread_placement_{};
+  FiberStackSizes fiber_stack_sizes_ = MOTION_FIBER_STACK_SIZES;
   std::shared_ptr<Logger> logger_;
+  // created on the first multi-threaded evaluation and reused for all following circuits
+  std::unique_ptr<ENCRYPTO::FiberThreadPool> fpool_;
+  std::unique_ptr<ExecutionContext> exec_ctx_;
+  std::unique_ptr<ThreadAllocator> thread_allocator_;
+  Statistics::GateProfiler* gate_profiler_ = nullptr;
+  Statistics::TraceRecorder* trace_recorder_ = nullptr;
 };
 
 }  // namespace MOTION
@@ -25,13 +25,21 @@
 #include <fmt/format.h>
 #include <omp.h>
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
 #include "base/gate_register.h"
 #include "executor/execution_context.h"
 #include "gate/new_gate.h"
 #include "statistics/run_time_stats.h"
+#include "tensor/tensor.h"
 #include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
+#include "utility/linear_algebra.h"
 #include "utility/logger.h"
 
 namespace MOTION {
@@ -56,17 +64,78 @@ TensorOpExecutor::TensorOpExecutor(GateRegister& reg, std::function<void(void)>
     : TensorOpExecutor(
           reg, std::move(preprocessing_fctn), false, [] {}, num_threads, std::move(logger)) {}
 
-void TensorOpExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
+void TensorOpExecutor::set_num_threads() {
   if (num_threads_ > 0) {
     if (logger_) {
-      logger_->LogInfo(fmt::format("Set OpenMP threads to {}", num_threads_));
+      logger_->LogInfo(fmt::format("Set OpenMP and linear algebra threads to {}", num_threads_));
     }
     omp_set_num_threads(num_threads_);
+    // the tensor ops are evaluated one after another, so each of them can use all threads
+    set_linear_algebra_num_threads(num_threads_);
   }
+}
 
-  ExecutionContext exec_ctx{.num_threads_ = num_threads_,
-                            .fpool_ = std::make_unique<ENCRYPTO::FiberThreadPool>(
-                                std::max(std::size_t{2}, num_threads_))};
+std::vector<std::vector<tensor::Tensor*>> TensorOpExecutor::compute_release_schedule() const {
+  const auto& gates = register_.get_gates();
+  std::vector<std::vector<tensor::Tensor*>> schedule(gates.size());
+  if (!memory_planning_) {
+    return schedule;
+  }
+  // only tensors computed by the ops of this register are released, the buffers of all others
+  // (e.g., weights of a previous run) are owned by someone else
+  std::unordered_map<const NewWire*, std::size_t> producers;
+  std::vector<const NewWire*> wires;
+  for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+    wires.clear();
+    gates[gate_i]->collect_output_wires(wires);
+    for (const auto* wire : wires) {
+      producers.emplace(wire, gate_i);
+    }
+  }
+  // the gates are evaluated in the order of the register, so the last consumer of a tensor is
+  // the one with the largest index
+  std::unordered_map<const NewWire*, std::size_t> last_consumers;
+  for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+    wires.clear();
+    gates[gate_i]->collect_input_wires(wires);
+    for (const auto* wire : wires) {
+      last_consumers[wire] = gate_i;
+    }
+  }
+  std::size_t num_tensors = 0;
+  for (const auto& [wire, gate_i] : last_consumers) {
+    auto it = producers.find(wire);
+    if (it == producers.end() || it->second == gate_i) {
+      continue;
+    }
+    auto tensor = dynamic_cast<const tensor::Tensor*>(wire);
+    if (tensor == nullptr || tensor->is_persistent()) {
+      continue;
+    }
+    // the tensor is owned by its producing op which hands it out as const to the consumers
+    schedule[gate_i].push_back(const_cast<tensor::Tensor*>(tensor));
+    ++num_tensors;
+  }
+  if (logger_) {
+    logger_->LogInfo(
+        fmt::format("Memory planning: release {} intermediate tensors after their last use",
+                    num_tensors));
+  }
+  return schedule;
+}
+
+void TensorOpExecutor::release_dead_tensors(std::vector<tensor::Tensor*>& tensors) const {
+  for (auto* tensor : tensors) {
+    tensor->release_buffers();
+  }
+  tensors.clear();
+}
+
+void TensorOpExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
+  set_num_threads();
+
+  auto fpool = std::make_unique<ENCRYPTO::FiberThreadPool>(std::max(std::size_t{2}, num_threads_));
+  ExecutionContext exec_ctx{.num_threads_ = num_threads_, .fpool_ = fpool.get()};
 
   stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
 
@@ -104,13 +173,17 @@ void TensorOpExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
   // ------------------------------ online phase ------------------------------
   stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
 
+  auto release_schedule = compute_release_schedule();
   if (register_.get_num_gates_with_online()) {
     // evaluate the online phase of all the gates
-    for (auto& gate : register_.get_gates()) {
+    const auto& gates = register_.get_gates();
+    for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+      auto& gate = gates[gate_i];
       if (gate->need_online()) {
         gate->evaluate_online_with_context(exec_ctx);
         register_.increment_gate_online_counter();
       }
+      release_dead_tensors(release_schedule[gate_i]);
     }
     register_.wait_online();
   }
@@ -124,7 +197,130 @@ void TensorOpExecutor::evaluate_setup_online(Statistics::RunTimeStats& stats) {
   }
 
   stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
-  exec_ctx.fpool_->join();
+  fpool->join();
+}
+
+void TensorOpExecutor::evaluate_pipelined(Statistics::RunTimeStats& stats,
+                                          std::size_t lookahead) {
+  if (lookahead == 0) {
+    throw std::invalid_argument("TensorOpExecutor::evaluate_pipelined: lookahead must be positive");
+  }
+  if (sync_between_setup_and_online_) {
+    throw std::logic_error(
+        "TensorOpExecutor::evaluate_pipelined: cannot synchronize between the setup and the online "
+        "phase if they overlap");
+  }
+  set_num_threads();
+
+  auto fpool = std::make_unique<ENCRYPTO::FiberThreadPool>(std::max(std::size_t{2}, num_threads_));
+  ExecutionContext exec_ctx{.num_threads_ = num_threads_, .fpool_ = fpool.get()};
+
+  stats.record_start<Statistics::RunTimeStats::StatID::evaluate>();
+
+  preprocessing_fctn_();
+
+  if (logger_) {
+    logger_->LogInfo(fmt::format(
+        "Start evaluating the circuit gates pipelined (setup at most {} gates ahead of online)",
+        lookahead));
+  }
+
+  const auto& gates = register_.get_gates();
+  // a tensor is released after the online phase of its last consumer, at which point the setup
+  // phases of all its consumers have finished as well
+  auto release_schedule = compute_release_schedule();
+  std::mutex mutex;
+  std::condition_variable cv;
+  // the gates [0, num_setup_done) have finished their setup phase, and the gates
+  // [0, num_online_done) their online phase
+  std::size_t num_setup_done = 0;
+  std::size_t num_online_done = 0;
+  std::exception_ptr setup_exception;
+  // set if the online phase failed, s.t. the setup thread does not wait for it forever
+  bool online_failed = false;
+
+  std::thread setup_thread([&] {
+    stats.record_start<Statistics::RunTimeStats::StatID::gates_setup>();
+    try {
+      for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+        {
+          std::unique_lock lock(mutex);
+          cv.wait(lock, [&] { return gate_i < num_online_done + lookahead || online_failed; });
+          if (online_failed) {
+            break;
+          }
+        }
+        auto& gate = gates[gate_i];
+        if (gate->need_setup()) {
+          gate->evaluate_setup_with_context(exec_ctx);
+          register_.increment_gate_setup_counter();
+        }
+        {
+          std::scoped_lock lock(mutex);
+          ++num_setup_done;
+        }
+        cv.notify_all();
+      }
+    } catch (...) {
+      std::scoped_lock lock(mutex);
+      setup_exception = std::current_exception();
+    }
+    cv.notify_all();
+    stats.record_end<Statistics::RunTimeStats::StatID::gates_setup>();
+  });
+
+  stats.record_start<Statistics::RunTimeStats::StatID::gates_online>();
+
+  try {
+    for (std::size_t gate_i = 0; gate_i < gates.size(); ++gate_i) {
+      {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return gate_i < num_setup_done || setup_exception; });
+        if (setup_exception) {
+          break;
+        }
+      }
+      auto& gate = gates[gate_i];
+      if (gate->need_online()) {
+        gate->evaluate_online_with_context(exec_ctx);
+        register_.increment_gate_online_counter();
+      }
+      release_dead_tensors(release_schedule[gate_i]);
+      {
+        std::scoped_lock lock(mutex);
+        ++num_online_done;
+      }
+      cv.notify_all();
+    }
+  } catch (...) {
+    {
+      std::scoped_lock lock(mutex);
+      online_failed = true;
+    }
+    cv.notify_all();
+    setup_thread.join();
+    throw;
+  }
+
+  setup_thread.join();
+  if (setup_exception) {
+    std::rethrow_exception(setup_exception);
+  }
+  if (register_.get_num_gates_with_setup()) {
+    register_.wait_setup();
+  }
+  if (register_.get_num_gates_with_online()) {
+    register_.wait_online();
+  }
+
+  stats.record_end<Statistics::RunTimeStats::StatID::gates_online>();
+
+  if (logger_) {
+    logger_->LogInfo("Finished with the online phase of the circuit gates");
+  }
+
+  stats.record_end<Statistics::RunTimeStats::StatID::evaluate>();
+  fpool->join();
 }
 
 void TensorOpExecutor::evaluate(Statistics::RunTimeStats& stats) {
@@ -24,12 +24,17 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace MOTION {
 
 class Logger;
 class GateRegister;
 
+namespace tensor {
+class Tensor;
+}
+
 namespace Statistics {
 struct RunTimeStats;
 }
@@ -46,16 +51,31 @@ class TensorOpExecutor {
   // Run the setup phases first for all gates before starting with the online
   // phases.
   void evaluate_setup_online(Statistics::RunTimeStats& stats);
+  // Run the setup phases in a separate thread at most `lookahead` gates ahead of the online
+  // phases, s.t. the setup of the next layers overlaps with the online phase of the current one
+  // and only the setup material of a few layers is held at the same time.
+  void evaluate_pipelined(Statistics::RunTimeStats& stats, std::size_t lookahead);
   // Run setup and online phase of each gate as soon as possible.
   void evaluate(Statistics::RunTimeStats& stats);
 
+  // Release the buffers of each intermediate tensor as soon as the last op reading it has finished
+  // its online phase, s.t. only the live activations are held instead of all of them.  Tensors
+  // which are not read by any op (e.g., the results) or are persistent are kept.
+  void set_memory_planning(bool enable) noexcept { memory_planning_ = enable; }
+
  private:
   GateRegister& register_;
   std::function<void()> preprocessing_fctn_;
   std::function<void()> sync_fctn_;
   std::size_t num_threads_;
   bool sync_between_setup_and_online_ = false;
+  bool memory_planning_ = false;
   std::shared_ptr<Logger> logger_;
+
+  void set_num_threads();
+  // for each gate the tensors to release after its online phase (empty without memory planning)
+  std::vector<std::vector<tensor::Tensor*>> compute_release_schedule() const;
+  void release_dead_tensors(std::vector<tensor::Tensor*>&) const;
 };
 
 }  // namespace MOTION
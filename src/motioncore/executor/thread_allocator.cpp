@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "thread_allocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "statistics/run_time_stats.h"
+
+namespace MOTION {
+
+ThreadAllocator::ThreadAllocator(std::size_t num_cpus, std::size_t num_workers)
+    : num_cpus_(num_cpus == 0 ? std::thread::hardware_concurrency() : num_cpus),
+      num_workers_(num_workers == 0 ? std::thread::hardware_concurrency() : num_workers) {
+  if (num_cpus_ == 0 || num_workers_ == 0) {
+    throw std::invalid_argument("ThreadAllocator: number of CPUs is unknown");
+  }
+  phase_threads_ = {.preprocessing_ = num_cpus_,
+                    .gates_setup_ = std::max(num_cpus_ / num_workers_, std::size_t(1)),
+                    .gates_online_ = 1};
+}
+
+std::size_t ThreadAllocator::adapt(std::size_t num_threads, std::size_t num_loop_threads,
+                                   double busy_cpus) const {
+  const auto num_phase_cpus = static_cast<double>(std::min(num_threads * num_loop_threads,
+                                                           std::max(num_cpus_, num_loop_threads)));
+  if (busy_cpus < idle_utilization * num_phase_cpus) {
+    return std::max(num_threads / 2, std::size_t(1));
+  }
+  if (busy_cpus > busy_utilization * num_phase_cpus &&
+      2 * num_threads * num_loop_threads <= num_cpus_) {
+    return 2 * num_threads;
+  }
+  return num_threads;
+}
+
+void ThreadAllocator::update(const Statistics::RunTimeStats& stats) {
+  using StatID = Statistics::RunTimeStats::StatID;
+  // phases which did not run in this evaluation keep their threads
+  const auto update_phase = [this, &stats](std::size_t& num_threads, std::size_t num_loop_threads,
+                                           StatID id) {
+    const auto& [start, end] = stats.get(id);
+    if (end > start) {
+      num_threads = adapt(num_threads, num_loop_threads, stats.get_busy_cpus(id));
+    }
+  };
+  // the preprocessing runs on the thread of the executor
+  update_phase(phase_threads_.preprocessing_, 1, StatID::preprocessing);
+  update_phase(phase_threads_.gates_setup_, num_workers_, StatID::gates_setup);
+  update_phase(phase_threads_.gates_online_, num_workers_, StatID::gates_online);
+}
+
+}  // namespace MOTION
@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+namespace MOTION {
+
+namespace Statistics {
+struct RunTimeStats;
+}
+
+// OpenMP threads of the data parallel loops of the providers in the phases of a run, e.g., of
+// the OT extension and the triple generation in the preprocessing and of the garbling in the
+// setup phase of the gates.  For the phases of the gates, it is the number of threads of each
+// worker of the fiber pool.  0 leaves the threads of OpenMP as they are.
+struct PhaseThreads {
+  std::size_t preprocessing_ = 0;
+  std::size_t gates_setup_ = 0;
+  std::size_t gates_online_ = 0;
+};
+
+// Splits the CPUs of a session between the providers and the evaluation of the gates for each
+// phase.  During the preprocessing the fiber pool is idle, so the providers get all CPUs.  In
+// the setup phase of the gates, which is bound by computation, each worker gets an equal share
+// of the CPUs for its loops.  The online phase is bound by the latency of the messages, so the
+// loops run on the workers alone and the remaining CPUs are left to the communication threads.
+//
+// update() adapts the allocation to the CPU utilization of a finished run: the threads of a
+// phase which kept less than half of its CPUs busy, e.g., because it waited for the network,
+// are halved, and the ones of a phase which kept almost all of them busy are doubled, up to the
+// CPUs of the session.  Sessions sharing a machine thus do not hold on to CPUs they cannot use.
+class ThreadAllocator {
+ public:
+  // num_cpus of the session, 0 uses std::thread::hardware_concurrency(), and num_workers of the
+  // fiber pool
+  ThreadAllocator(std::size_t num_cpus, std::size_t num_workers);
+
+  const PhaseThreads& get_phase_threads() const noexcept { return phase_threads_; }
+  std::size_t get_num_cpus() const noexcept { return num_cpus_; }
+
+  void update(const Statistics::RunTimeStats&);
+
+  // a phase is idle if it keeps less than this fraction of its CPUs busy, and busy if it keeps
+  // more than busy_utilization busy
+  static constexpr double idle_utilization = 0.5;
+  static constexpr double busy_utilization = 0.9;
+
+ private:
+  // adapt the threads of one phase, which runs num_threads threads on each of num_loop_threads
+  std::size_t adapt(std::size_t num_threads, std::size_t num_loop_threads, double busy_cpus) const;
+
+  std::size_t num_cpus_;
+  std::size_t num_workers_;
+  PhaseThreads phase_threads_;
+};
+
+}  // namespace MOTION
@@ -24,6 +24,9 @@
 
 #include "bmr_gate.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/backend.h"
 #include "communication/bmr_message.h"
 #include "communication/communication_layer.h"
@@ -32,7 +35,6 @@
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_flavors.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
-#include "crypto/pseudo_random_generator.h"
 #include "data_storage/bmr_data.h"
 #include "utility/block.h"
 #include "wire/bmr_wire.h"
@@ -40,6 +42,25 @@
 
 namespace MOTION::Gates::BMR {
 
+// Number of DKCs which are computed by a thread at once.  Gates with more DKCs are garbled and
+// evaluated in parallel.
+static constexpr std::size_t bmr_dkc_chunk_size = 1024;
+
+// aesni_bmr_dkc_batch split into chunks which are processed in parallel
+static void bmr_dkc_batch(const std::byte *round_keys, const ENCRYPTO::block128_t *keys_a,
+                          const ENCRYPTO::block128_t *keys_b, const std::uint64_t *gate_ids,
+                          std::size_t num_dkcs, std::size_t num_parties,
+                          ENCRYPTO::block128_t *output) {
+  const std::size_t num_chunks = (num_dkcs + bmr_dkc_chunk_size - 1) / bmr_dkc_chunk_size;
+#pragma omp parallel for if (num_chunks > 1)
+  for (std::size_t chunk_i = 0; chunk_i < num_chunks; ++chunk_i) {
+    const auto offset = chunk_i * bmr_dkc_chunk_size;
+    const auto size = std::min(bmr_dkc_chunk_size, num_dkcs - offset);
+    aesni_bmr_dkc_batch(round_keys, keys_a + offset, keys_b + offset, gate_ids + offset, size,
+                        num_parties, output + offset * num_parties);
+  }
+}
+
 BMRInputGate::BMRInputGate(std::size_t num_simd, std::size_t bit_size, std::size_t input_owner_id,
                            Backend &backend)
     : InputGate(backend), num_simd_(num_simd), bit_size_(bit_size) {
@@ -969,10 +990,12 @@ void BMRANDGate::EvaluateSetup() {
     }
   }  // for each wire
 
-  // AES key expansion
-  ENCRYPTO::PRG prg;
-  prg.SetKey(get_motion_base_provider().get_aes_fixed_key().data());
-  const auto aes_round_keys = prg.get_round_keys();
+  const auto aes_round_keys = get_motion_base_provider().get_aes_fixed_key_round_keys();
+
+  // keys and tweaks of the DKCs of the four rows of all SIMD values of a wire
+  ENCRYPTO::block128_vector dkc_keys_a(4 * num_simd);
+  ENCRYPTO::block128_vector dkc_keys_b(4 * num_simd);
+  std::vector<std::uint64_t> dkc_gate_ids(4 * num_simd);
 
   // Compute garbled rows
   // First, set rows to PRG outputs XOR key
@@ -985,23 +1008,22 @@ void BMRANDGate::EvaluateSetup() {
     assert(bmr_b);
 
     for (auto simd_i = 0ull; simd_i < num_simd; ++simd_i) {
-      const auto &key_a_0{bmr_a->GetSecretKeys().at(simd_i)};
-      const auto &key_a_1{key_a_0 ^ R};
-      const auto &key_b_0{bmr_b->GetSecretKeys().at(simd_i)};
-      const auto &key_b_1{key_b_0 ^ R};
-
+      const auto &key_a_0{bmr_a->GetSecretKeys()[simd_i]};
+      const auto &key_b_0{bmr_b->GetSecretKeys()[simd_i]};
+      // row i uses the keys of a and b of bits (i >> 1) and (i & 1)
+      dkc_keys_a[4 * simd_i] = dkc_keys_a[4 * simd_i + 1] = key_a_0;
+      dkc_keys_a[4 * simd_i + 2] = dkc_keys_a[4 * simd_i + 3] = key_a_0 ^ R;
+      dkc_keys_b[4 * simd_i] = dkc_keys_b[4 * simd_i + 2] = key_b_0;
+      dkc_keys_b[4 * simd_i + 1] = dkc_keys_b[4 * simd_i + 3] = key_b_0 ^ R;
       // TODO: fix gate id computation
-      const auto gate_id = static_cast<uint64_t>(bmr_out->GetWireId() + simd_i);
-
-      aesni_bmr_dkc(aes_round_keys, key_a_0.data(), key_b_0.data(), gate_id, num_parties,
-                    &garbled_tables_[gt_index(wire_i, simd_i, 0, 0)]);
-      aesni_bmr_dkc(aes_round_keys, key_a_0.data(), key_b_1.data(), gate_id, num_parties,
-                    &garbled_tables_[gt_index(wire_i, simd_i, 1, 0)]);
-      aesni_bmr_dkc(aes_round_keys, key_a_1.data(), key_b_0.data(), gate_id, num_parties,
-                    &garbled_tables_[gt_index(wire_i, simd_i, 2, 0)]);
-      aesni_bmr_dkc(aes_round_keys, key_a_1.data(), key_b_1.data(), gate_id, num_parties,
-                    &garbled_tables_[gt_index(wire_i, simd_i, 3, 0)]);
+      std::fill_n(std::begin(dkc_gate_ids) + 4 * simd_i, 4,
+                  static_cast<uint64_t>(bmr_out->GetWireId() + simd_i));
+    }
+    // the rows of the wire are stored consecutively in the order of the DKCs
+    bmr_dkc_batch(aes_round_keys, dkc_keys_a.data(), dkc_keys_b.data(), dkc_gate_ids.data(),
+                  4 * num_simd, num_parties, &garbled_tables_[gt_index(wire_i, 0, 0, 0)]);
 
+    for (auto simd_i = 0ull; simd_i < num_simd; ++simd_i) {
       const auto &key_w_0 = bmr_out->GetSecretKeys()[simd_i];
       garbled_tables_[gt_index(wire_i, simd_i, 0, my_id)] ^= key_w_0;
       garbled_tables_[gt_index(wire_i, simd_i, 1, my_id)] ^= key_w_0;
@@ -1162,10 +1184,11 @@ void BMRANDGate::EvaluateOnline() {
     }
   }
 
-  // AES key expansion
-  ENCRYPTO::PRG prg;
-  prg.SetKey(get_motion_base_provider().get_aes_fixed_key().data());
-  const auto aes_round_keys = prg.get_round_keys();
+  const auto aes_round_keys = get_motion_base_provider().get_aes_fixed_key_round_keys();
+
+  // tweaks and outputs of the DKCs of all parties' keys of all SIMD values of a wire
+  std::vector<std::uint64_t> dkc_gate_ids(num_simd * num_parties);
+  ENCRYPTO::block128_vector dkc_outputs(num_simd * num_parties * num_parties);
 
   for (auto wire_i = 0ull; wire_i < num_wires; ++wire_i) {
     auto bmr_out = std::dynamic_pointer_cast<Wires::BMRWire>(output_wires_.at(wire_i));
@@ -1178,10 +1201,18 @@ void BMRANDGate::EvaluateOnline() {
     wire_a->GetIsReadyCondition().Wait();
     wire_b->GetIsReadyCondition().Wait();
 
+    // the public keys are stored in the order of pk_index, so the DKCs of all SIMD values and
+    // parties can be computed at once
     for (auto simd_i = 0ull; simd_i < num_simd; ++simd_i) {
       // TODO: fix gate id computation
-      const auto gate_id = static_cast<uint64_t>(bmr_out->GetWireId() + simd_i);
+      std::fill_n(std::begin(dkc_gate_ids) + pk_index(simd_i, 0), num_parties,
+                  static_cast<uint64_t>(bmr_out->GetWireId() + simd_i));
+    }
+    std::fill(std::begin(dkc_outputs), std::end(dkc_outputs), ENCRYPTO::block128_t::make_zero());
+    bmr_dkc_batch(aes_round_keys, wire_a->GetPublicKeys().data(), wire_b->GetPublicKeys().data(),
+                  dkc_gate_ids.data(), num_simd * num_parties, num_parties, dkc_outputs.data());
 
+    for (auto simd_i = 0ull; simd_i < num_simd; ++simd_i) {
       // compute index of the correct row in the garbled table
       const bool alpha = wire_a->GetPublicValues()[simd_i],
                  beta = wire_b->GetPublicValues()[simd_i];
@@ -1190,10 +1221,11 @@ void BMRANDGate::EvaluateOnline() {
 
       // decrypt that row of the garbled table
       for (auto party_i = 0ull; party_i < num_parties; ++party_i) {
-        const auto &key_a = wire_a->GetPublicKeys().at(pk_index(simd_i, party_i));
-        const auto &key_b = wire_b->GetPublicKeys().at(pk_index(simd_i, party_i));
-        aesni_bmr_dkc(aes_round_keys, key_a.data(), key_b.data(), gate_id, num_parties,
-                      &garbled_tables_[gt_index(wire_i, simd_i, row_index, 0)]);
+        const auto dkc_offset = pk_index(simd_i, party_i) * num_parties;
+        for (auto party_j = 0ull; party_j < num_parties; ++party_j) {
+          garbled_tables_[gt_index(wire_i, simd_i, row_index, party_j)] ^=
+              dkc_outputs[dkc_offset + party_j];
+        }
       }
 
       // copy decrypted public keys to outgoing wire
@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+namespace MOTION {
+
+enum class MPCProtocol : unsigned int;
+
+// Communication of a gate as predicted from its parameters, used to analyze a circuit before it
+// is evaluated, see Statistics::analyze_circuit().  The bytes are the payload sent by this party,
+// without message headers and without the base OTs.
+struct GateCost {
+  MPCProtocol protocol_;
+  // sent before the online phase, including the OT extension for the gate's correlated
+  // randomness, e.g., its multiplication triples
+  std::size_t setup_bytes_ = 0;
+  std::size_t online_bytes_ = 0;
+  // OTs this party takes part in as sender or as receiver
+  std::size_t num_ots_ = 0;
+  // rounds of communication between the online phase of the inputs and of the outputs
+  std::size_t online_rounds_ = 0;
+  // rounds among the online rounds which reconstruct values that previous gates have left
+  // additively shared, see proto::beavy::ArithmeticBEAVYReconstructGate
+  std::size_t deferred_rounds_ = 0;
+
+  // bits sent by the sender and by the receiver of `num_ots` correlated OTs with messages of
+  // `bit_size` bits produced by OT extension, i.e., the correlated messages and the columns of
+  // the extension matrix with the choice corrections
+  static constexpr std::size_t cot_sender_bits(std::size_t num_ots, std::size_t bit_size) {
+    return num_ots * bit_size;
+  }
+  static constexpr std::size_t cot_receiver_bits(std::size_t num_ots) {
+    return num_ots * (ot_security_parameter + 1);
+  }
+  static constexpr std::size_t ot_security_parameter = 128;
+};
+
+}  // namespace MOTION
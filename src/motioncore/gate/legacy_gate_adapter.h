@@ -0,0 +1,52 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "gate/gate.h"
+#include "gate/new_gate.h"
+
+namespace MOTION {
+
+// Lets the NewGateExecutor evaluate a gate of the legacy Backend, e.g., a BMR or GMW gate created
+// through the ShareWrapper, s.t. both backends share one scheduler and fiber pool.  The legacy
+// gates wait for their input wires themselves and report no wires, i.e., they are posted all at
+// once by both schedulers.
+class LegacyGateAdapter : public NewGate {
+ public:
+  LegacyGateAdapter(std::size_t gate_id, Gates::Interfaces::GatePtr gate)
+      : NewGate(gate_id), gate_(std::move(gate)) {}
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override { gate_->EvaluateSetup(); }
+  void evaluate_online() override { gate_->EvaluateOnline(); }
+
+ private:
+  Gates::Interfaces::GatePtr gate_;
+};
+
+}  // namespace MOTION
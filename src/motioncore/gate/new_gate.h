@@ -24,14 +24,26 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
 
+#include "gate_cost.h"
+#include "utility/constants.h"
 #include "utility/enable_wait.h"
 #include "utility/fiber_condition.h"
+#include "wire/new_wire.h"
 
 namespace MOTION {
 
 struct ExecutionContext;
 enum class MPCProtocol : unsigned int;
+class PreprocessingRecord;
+class PreprocessingWriter;
+
+namespace proto {
+class CommMixin;
+}  // namespace proto
 
 class NewGate : public ENCRYPTO::enable_wait_setup, public ENCRYPTO::enable_wait_online {
  public:
@@ -44,11 +56,72 @@ class NewGate : public ENCRYPTO::enable_wait_setup, public ENCRYPTO::enable_wait
   virtual void evaluate_online_with_context(ExecutionContext&) { evaluate_online(); }
   std::size_t get_gate_id() const noexcept { return gate_id_; }
 
+  // Report the wires read and written by this gate.  These are used by the dependency-aware
+  // scheduler of the NewGateExecutor to post a gate only after the gates producing its inputs
+  // have finished.  Gates which do not override them are treated as having no dependencies
+  // and just wait on their inputs as before.
+  virtual void collect_input_wires(std::vector<const NewWire*>&) const {}
+  virtual void collect_output_wires(std::vector<const NewWire*>&) const {}
+
+  // Gates whose online phase broadcasts one bits message (with msg_num 0) and then waits for the
+  // messages of the other parties can have it fused with the messages of the gates of the same
+  // type in the same circuit layer.  Such gates return the CommMixin they send with and the size
+  // of the message in bits.
+  virtual std::pair<proto::CommMixin*, std::size_t> get_fusable_online_message() const {
+    return {nullptr, 0};
+  }
+
+  // Output gates whose reconstruction broadcasts one bits or ints message (with msg_num 0) can have
+  // it fused with the messages of the output gates of the same type in the same circuit layer.
+  // Such gates return the CommMixin they send with and the size of the message in bits or
+  // elements.
+  virtual std::pair<proto::CommMixin*, std::size_t> get_fusable_output_message() const {
+    return {nullptr, 0};
+  }
+
+  // Predicted communication of this gate for the analysis of the circuit before it is run.  Gates
+  // without a cost model return nothing and are listed as unmodeled by the analysis.
+  virtual std::optional<GateCost> get_cost() const { return std::nullopt; }
+
+  // Size class of the stack of the fiber evaluating this gate.  Gates with a shallow call stack
+  // can use small stacks, gates calling into deep code paths, e.g., tensor operations, need large
+  // ones.
+  virtual FiberStackClass get_fiber_stack_class() const noexcept {
+    return FiberStackClass::regular;
+  }
+
+  // Gates supporting it can write the state produced by their setup phase to a preprocessing
+  // store after evaluate_setup().  In a later process, load_setup() restores this state (and
+  // marks the output wires as setup ready) instead of evaluate_setup(), so that only the online
+  // phase needs to be run.
+  virtual bool supports_preprocessing_store() const noexcept { return false; }
+  virtual void save_setup(PreprocessingWriter&) {}
+  virtual void load_setup(PreprocessingRecord&) {}
+
  protected:
   NewGate(std::size_t gate_id) noexcept : gate_id_(gate_id) {}
   std::size_t gate_id_;
 };
 
+namespace detail {
+
+template <typename WireVectorType>
+void append_wires(std::vector<const NewWire*>& out, const WireVectorType& wires) {
+  for (const auto& wire : wires) {
+    out.push_back(wire.get());
+  }
+}
+
+// append a single wire if it is set, e.g., an optional input of a tensor op
+template <typename WireP>
+void append_wire(std::vector<const NewWire*>& out, const WireP& wire) {
+  if (wire) {
+    out.push_back(wire.get());
+  }
+}
+
+}  // namespace detail
+
 // Convert a GateClass to one that is evaluated purely during the setup phase.
 template <typename GateClass>
 class SetupGate : public GateClass {
@@ -65,6 +138,16 @@ class SetupGate : public GateClass {
     GateClass::evaluate_online();
   }
   virtual void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override {
+    auto cost = GateClass::get_cost();
+    if (cost) {
+      cost->setup_bytes_ += cost->online_bytes_;
+      cost->online_bytes_ = 0;
+      cost->online_rounds_ = 0;
+      cost->deferred_rounds_ = 0;
+    }
+    return cost;
+  }
 };
 
 }  // namespace MOTION
@@ -22,7 +22,12 @@
 
 #include "beavy_provider.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstdint>
+#include <iterator>
+#include <string_view>
 #include <unordered_map>
 
 #include "base/gate_register.h"
@@ -32,12 +37,17 @@
 #include "communication/message_handler.h"
 #include "conversion.h"
 #include "crypto/motion_base_provider.h"
+#include "crypto/oblivious_transfer/ot_provider.h"
+#include "crypto/oblivious_transfer/xcot_bit_batch.h"
+#include "crypto/random/gate_mask_generator.h"
 #include "gate.h"
 #include "plain.h"
 #include "protocols/gmw/wire.h"
+#include "protocols/plain/constant_folding.h"
 #include "protocols/plain/wire.h"
 #include "tensor_op.h"
 #include "utility/constants.h"
+#include "utility/construction_scope.h"
 #include "utility/logger.h"
 #include "utility/meta.hpp"
 #include "wire.h"
@@ -61,7 +71,8 @@ BEAVYProvider::BEAVYProvider(Communication::CommunicationLayer& communication_la
       num_parties_(communication_layer_.get_num_parties()),
       next_input_id_(0),
       logger_(std::move(logger)),
-      fake_setup_(fake_setup) {
+      fake_setup_(fake_setup),
+      mask_generator_(std::make_unique<GateMaskGenerator>()) {
   if (communication_layer.get_num_parties() != 2) {
     throw std::logic_error("currently only two parties are supported");
   }
@@ -75,16 +86,72 @@ void BEAVYProvider::setup() {
   set_setup_ready();
 }
 
+ENCRYPTO::ObliviousTransfer::XCOTBitBatch& BEAVYProvider::get_xcot_batch() {
+  if (!xcot_batch_) {
+    // within a ConstructionScope, the batch has been created when its block was reserved
+    ConstructionScope::require_serial("the batch of XCOTs");
+    using Roles = ENCRYPTO::ObliviousTransfer::XCOTBitBatch::Roles;
+    auto roles = Roles::both;
+    if (strong_party_.has_value()) {
+      roles = *strong_party_ == my_id_ ? Roles::receiver : Roles::sender;
+    }
+    xcot_batch_ = std::make_unique<ENCRYPTO::ObliviousTransfer::XCOTBitBatch>(
+        ot_manager_.get_provider(1 - my_id_), roles);
+  }
+  return *xcot_batch_;
+}
+
+std::size_t BEAVYProvider::reserve_batched_xcot_bits(std::size_t num_ots) {
+  return get_xcot_batch().reserve(num_ots);
+}
+
+std::size_t BEAVYProvider::reserve_batched_xcot_block(std::size_t num_ots) {
+  return get_xcot_batch().reserve_block(num_ots);
+}
+
+ENCRYPTO::BitVector<> BEAVYProvider::compute_batched_xcot_bits(
+    std::size_t offset, const ENCRYPTO::BitVector<>& choices,
+    const ENCRYPTO::BitVector<>& correlations) {
+  assert(xcot_batch_);
+  return xcot_batch_->compute(offset, choices, correlations);
+}
+
+void BEAVYProvider::register_batched_ots() {
+  if (xcot_batch_) {
+    if (logger_) {
+      logger_->LogDebug(fmt::format("BEAVYProvider: registering a batch of {} XCOTs",
+                                    xcot_batch_->get_num_ots()));
+    }
+    xcot_batch_->register_ots();
+  }
+}
+
 bool BEAVYProvider::is_my_job(std::size_t gate_id) const noexcept {
   return my_id_ == (gate_id % num_parties_);
 }
 
-std::size_t BEAVYProvider::get_next_input_id(std::size_t num_inputs) noexcept {
+std::size_t BEAVYProvider::get_next_input_id(std::size_t num_inputs) {
+  if (auto input_id = ConstructionScope::take(ConstructionCounter::beavy_input_ids, num_inputs)) {
+    return *input_id;
+  }
   auto next_id = next_input_id_;
   next_input_id_ += num_inputs;
   return next_id;
 }
 
+BooleanBEAVYWireP BEAVYProvider::make_boolean_wire(std::size_t num_simd) const {
+  return gate_register_.make_wire<BooleanBEAVYWire>(num_simd);
+}
+
+BooleanBEAVYWireVector BEAVYProvider::make_boolean_wires(std::size_t num_wires,
+                                                         std::size_t num_simd) const {
+  BooleanBEAVYWireVector wires;
+  wires.reserve(num_wires);
+  std::generate_n(std::back_inserter(wires), num_wires,
+                  [this, num_simd] { return make_boolean_wire(num_simd); });
+  return wires;
+}
+
 static BooleanBEAVYWireVector cast_wires(std::vector<std::shared_ptr<NewWire>> wires) {
   BooleanBEAVYWireVector result(wires.size());
   std::transform(std::begin(wires), std::end(wires), std::begin(result),
@@ -124,6 +191,56 @@ static std::shared_ptr<NewWire> cast_arith_wire(ArithmeticBEAVYWireP<T> wire) {
   return std::shared_ptr<NewWire>(wire);
 }
 
+template <typename T>
+void BEAVYProvider::basic_reconstruct_additive_wires(std::vector<WireVector>& inputs) {
+  // the wires may be reconstructed by several threads building a circuit concurrently
+  std::scoped_lock lock(reconstructed_wires_mutex_);
+  // indices of the inputs which are reconstructed by the new gate, a wire used by several inputs
+  // is reconstructed once
+  std::vector<std::size_t> pending;
+  ArithmeticBEAVYWireVector<T> wires;
+  for (std::size_t input_i = 0; input_i < inputs.size(); ++input_i) {
+    if (inputs[input_i].size() != 1) {
+      continue;
+    }
+    auto wire = std::dynamic_pointer_cast<ArithmeticBEAVYWire<T>>(inputs[input_i][0]);
+    if (wire == nullptr || !wire->is_additively_shared()) {
+      continue;
+    }
+    if (auto it = reconstructed_wires_.find(wire.get()); it != reconstructed_wires_.end()) {
+      inputs[input_i] = {it->second};
+      continue;
+    }
+    pending.push_back(input_i);
+    if (std::find(std::begin(wires), std::end(wires), wire) == std::end(wires)) {
+      wires.push_back(std::move(wire));
+    }
+  }
+  if (wires.empty()) {
+    return;
+  }
+
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<ArithmeticBEAVYReconstructGate<T>>(
+      gate_id, *this, ArithmeticBEAVYWireVector<T>(wires));
+  const auto& outputs = gate->get_output_wires();
+  for (std::size_t wire_i = 0; wire_i < wires.size(); ++wire_i) {
+    reconstructed_wires_.emplace(wires[wire_i].get(), cast_arith_wire(outputs[wire_i]));
+  }
+  gate_register_.register_gate(std::move(gate));
+  for (auto input_i : pending) {
+    inputs[input_i] = {reconstructed_wires_.at(inputs[input_i][0].get())};
+  }
+}
+
+std::vector<WireVector> BEAVYProvider::reconstruct_additive_wires(std::vector<WireVector> inputs) {
+  basic_reconstruct_additive_wires<std::uint8_t>(inputs);
+  basic_reconstruct_additive_wires<std::uint16_t>(inputs);
+  basic_reconstruct_additive_wires<std::uint32_t>(inputs);
+  basic_reconstruct_additive_wires<std::uint64_t>(inputs);
+  return inputs;
+}
+
 // Boolean inputs/outputs
 
 std::pair<ENCRYPTO::ReusableFiberPromise<BitValues>, WireVector>
@@ -256,7 +373,7 @@ ENCRYPTO::ReusableFiberFuture<IntegerValues<T>> BEAVYProvider::basic_make_arithm
   if (in.size() != 1) {
     throw std::logic_error("invalid number of wires for arithmetic gate");
   }
-  auto input = cast_arith_wire<T>(in[0]);
+  auto input = cast_arith_wire<T>(reconstruct_additive_wires({in})[0][0]);
   if (input == nullptr) {
     throw std::logic_error("wrong wire type");
   }
@@ -293,27 +410,28 @@ void BEAVYProvider::make_arithmetic_output_gate_other(std::size_t output_owner,
   if (in.size() != 1) {
     throw std::logic_error("invalid number of wires for arithmetic gate");
   }
+  const auto input = reconstruct_additive_wires({in})[0];
   std::unique_ptr<NewGate> gate;
   auto gate_id = gate_register_.get_next_gate_id();
-  switch (in[0]->get_bit_size()) {
+  switch (input[0]->get_bit_size()) {
     case 8: {
       gate = std::make_unique<ArithmeticBEAVYOutputGate<std::uint8_t>>(
-          gate_id, *this, cast_arith_wire<std::uint8_t>(in[0]), output_owner);
+          gate_id, *this, cast_arith_wire<std::uint8_t>(input[0]), output_owner);
       break;
     }
     case 16: {
       gate = std::make_unique<ArithmeticBEAVYOutputGate<std::uint16_t>>(
-          gate_id, *this, cast_arith_wire<std::uint16_t>(in[0]), output_owner);
+          gate_id, *this, cast_arith_wire<std::uint16_t>(input[0]), output_owner);
       break;
     }
     case 32: {
       gate = std::make_unique<ArithmeticBEAVYOutputGate<std::uint32_t>>(
-          gate_id, *this, cast_arith_wire<std::uint32_t>(in[0]), output_owner);
+          gate_id, *this, cast_arith_wire<std::uint32_t>(input[0]), output_owner);
       break;
     }
     case 64: {
       gate = std::make_unique<ArithmeticBEAVYOutputGate<std::uint64_t>>(
-          gate_id, *this, cast_arith_wire<std::uint64_t>(in[0]), output_owner);
+          gate_id, *this, cast_arith_wire<std::uint64_t>(input[0]), output_owner);
       break;
     }
     default: {
@@ -430,6 +548,10 @@ std::vector<std::shared_ptr<NewWire>> BEAVYProvider::make_binary_gate(
       return make_mulni_gate(in_a, in_b);
     case ENCRYPTO::PrimitiveOperationType::EQEXP:
       return make_eqexp_gate(in_a, in_b);
+    case ENCRYPTO::PrimitiveOperationType::GT:
+      return make_gt_gate(in_a, in_b);
+    case ENCRYPTO::PrimitiveOperationType::EQ:
+      return make_eq_gate(in_a, in_b);
     default:
       throw std::logic_error(
           fmt::format("BEAVY does not support the binary operation {}", ToString(op)));
@@ -510,7 +632,7 @@ std::pair<NewGateP, WireVector> BEAVYProvider::construct_and_gate(const WireVect
                                                                   const WireVector& in_b) {
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return construct_xor_gate(in_b, in_a);
+    return construct_and_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -520,25 +642,11 @@ std::pair<NewGateP, WireVector> BEAVYProvider::construct_and_gate(const WireVect
   }
 }
 
-std::pair<NewGateP, WireVector> BEAVYProvider::construct_and4_gate(const WireVector& in_a,
-                                                                  const WireVector& in_b) {
-  // assume, at most one of the inputs is a plain wire
-  if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return construct_xor_gate(in_b, in_a);
-  }
-  assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
-  if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return construct_boolean_binary_gate<BooleanBEAVYANDPlainGate, true>(in_a, in_b);
-  } else {
-    return construct_boolean_binary_gate<BooleanBEAVYAND4Gate>(in_a, in_b);
-  }
-}
-
 std::pair<NewGateP, WireVector> BEAVYProvider::construct_msg_gate(const WireVector& in_a,
                                                                   const WireVector& in_b) {
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return construct_xor_gate(in_b, in_a);
+    return construct_msg_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -552,7 +660,7 @@ std::pair<NewGateP, WireVector> BEAVYProvider::construct_dot_gate(const WireVect
                                                                   const WireVector& in_b) {
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return construct_xor_gate(in_b, in_a);
+    return construct_dot_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -563,6 +671,9 @@ std::pair<NewGateP, WireVector> BEAVYProvider::construct_dot_gate(const WireVect
 }
 
 WireVector BEAVYProvider::make_xor_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
     return make_xor_gate(in_b, in_a);
@@ -576,9 +687,12 @@ WireVector BEAVYProvider::make_xor_gate(const WireVector& in_a, const WireVector
 }
 
 WireVector BEAVYProvider::make_and_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return make_xor_gate(in_b, in_a);
+    return make_and_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -588,23 +702,197 @@ WireVector BEAVYProvider::make_and_gate(const WireVector& in_a, const WireVector
   }
 }
 
-WireVector BEAVYProvider::make_and4_gate(const WireVector& in_a, const WireVector& in_b) {
-  // assume, at most one of the inputs is a plain wire
-  if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return make_xor_gate(in_b, in_a);
+WireVector BEAVYProvider::make_multi_and_gate(const std::vector<WireVector>& inputs) {
+  // the plain inputs are ANDed locally at the end
+  std::vector<WireVector> beavy_inputs;
+  std::vector<const WireVector*> plain_inputs;
+  for (const auto& input : inputs) {
+    if (input.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
+      plain_inputs.push_back(&input);
+    } else {
+      assert(input.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
+      beavy_inputs.push_back(input);
+    }
   }
-  assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
-  if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return make_boolean_binary_gate<BooleanBEAVYANDPlainGate, true>(in_a, in_b);
-  } else {
-    return make_boolean_binary_gate<BooleanBEAVYAND4Gate>(in_a, in_b);
+  if (beavy_inputs.empty()) {
+    throw std::logic_error("BEAVY multi-input AND needs at least one BEAVY input");
+  }
+
+  // split the inputs into groups of about the same size per layer, such that the setup does not
+  // compute more products than necessary
+  constexpr auto max_num_inputs = BooleanBEAVYANDnGate::max_num_inputs;
+  while (beavy_inputs.size() > 1) {
+    const auto num_groups = (beavy_inputs.size() + max_num_inputs - 1) / max_num_inputs;
+    std::vector<WireVector> next_inputs;
+    std::size_t begin = 0;
+    for (std::size_t group_i = 0; group_i < num_groups; ++group_i) {
+      const auto end = (group_i + 1) * beavy_inputs.size() / num_groups;
+      if (end - begin == 1) {
+        next_inputs.push_back(std::move(beavy_inputs[begin]));
+      } else if (end - begin == 2) {
+        next_inputs.push_back(make_and_gate(beavy_inputs[begin], beavy_inputs[begin + 1]));
+      } else {
+        std::vector<BooleanBEAVYWireVector> group;
+        for (std::size_t input_i = begin; input_i < end; ++input_i) {
+          group.push_back(cast_wires(std::move(beavy_inputs[input_i])));
+        }
+        auto gate_id = gate_register_.get_next_gate_id();
+        auto gate = std::make_unique<BooleanBEAVYANDnGate>(gate_id, *this, std::move(group));
+        auto output = gate->get_output_wires();
+        gate_register_.register_gate(std::move(gate));
+        next_inputs.push_back(cast_wires(std::move(output)));
+      }
+      begin = end;
+    }
+    beavy_inputs = std::move(next_inputs);
+  }
+
+  auto output = std::move(beavy_inputs.front());
+  for (const auto* plain_input : plain_inputs) {
+    output = make_and_gate(output, *plain_input);
+  }
+  return output;
+}
+
+namespace {
+
+// Number of values combined by each level of the comparison tree of bit_size bits, from the bits
+// to the root.  The bits are combined in groups of 4, i.e., multi-input ANDs of up to 5 inputs, and
+// the groups in groups of up to 4.
+template <std::size_t bit_size>
+constexpr auto comparison_tree_levels() {
+  static_assert(bit_size >= 8 && bit_size % 4 == 0 && std::has_single_bit(bit_size));
+  constexpr auto num_levels = [] {
+    std::size_t n = 1;
+    for (auto m = bit_size / 4; m > 1; m = (m % 4 == 0) ? m / 4 : 1) {
+      ++n;
+    }
+    return n;
+  }();
+  std::array<std::size_t, num_levels> levels{};
+  levels[0] = 4;
+  for (std::size_t level_i = 1, m = bit_size / 4; level_i < num_levels; ++level_i) {
+    levels[level_i] = (m % 4 == 0) ? 4 : m;
+    m /= levels[level_i];
+  }
+  return levels;
+}
+
+void check_comparison_inputs(const WireVector& in_a, const WireVector& in_b) {
+  if (in_a.size() != in_b.size()) {
+    throw std::logic_error(
+        fmt::format("comparison of {} and {} bit values", in_a.size(), in_b.size()));
+  }
+  const auto is_beavy = [](const auto& w) {
+    return w->get_protocol() == MPCProtocol::BooleanBEAVY;
+  };
+  if (!std::all_of(std::begin(in_a), std::end(in_a), is_beavy) ||
+      !std::all_of(std::begin(in_b), std::end(in_b), is_beavy)) {
+    throw std::logic_error("BEAVY comparisons need BooleanBEAVY inputs");
+  }
+}
+
+}  // namespace
+
+// a > b for unsigned values with the least significant bit in the first wire.  Each node of the
+// tree holds G = [a > b] and E = [a == b] for a range of bits.  For a group of nodes 0, ..., c-1
+// ordered from the least significant one, G = XOR_i (G_i & E_{i+1} & ... & E_{c-1}), since at
+// most one of the terms is set, and E = E_0 & ... & E_{c-1}.  In the first level, G_i = a_i & ~b_i
+// is not computed on its own, but a_i and ~b_i are inputs of the multi-input ANDs.  All ANDs of a
+// level are evaluated in the same round, i.e., 2 rounds for 8 and 16 bits and 3 for 32 and 64.
+template <std::size_t bit_size>
+WireVector BEAVYProvider::basic_make_gt_gate(const WireVector& in_a, const WireVector& in_b) {
+  // the operands of G and E for each node of the current level
+  struct Node {
+    std::vector<NewWireP> g;
+    NewWireP e;
+  };
+  const auto not_b = make_inv_gate(in_b);
+  const auto eq_bits = make_inv_gate(make_xor_gate(in_a, in_b));
+  std::vector<Node> nodes(bit_size);
+  for (std::size_t bit_i = 0; bit_i < bit_size; ++bit_i) {
+    nodes[bit_i] = {{in_a[bit_i], not_b[bit_i]}, eq_bits[bit_i]};
+  }
+
+  constexpr auto levels = comparison_tree_levels<bit_size>();
+  for (std::size_t level_i = 0; level_i < levels.size(); ++level_i) {
+    const auto group_size = levels[level_i];
+    const auto num_groups = nodes.size() / group_size;
+    const bool last_level = level_i + 1 == levels.size();
+    // the nodes at the same position of all groups are processed by the same gates
+    const auto collect = [&](std::size_t pos, auto get) {
+      WireVector wires;
+      for (std::size_t group_i = 0; group_i < num_groups; ++group_i) {
+        wires.push_back(get(nodes[group_i * group_size + pos]));
+      }
+      return wires;
+    };
+    WireVector g;
+    for (std::size_t pos = 0; pos < group_size; ++pos) {
+      std::vector<WireVector> operands;
+      for (std::size_t op_i = 0; op_i < nodes[pos].g.size(); ++op_i) {
+        operands.push_back(collect(pos, [op_i](const auto& node) { return node.g[op_i]; }));
+      }
+      for (auto pos_j = pos + 1; pos_j < group_size; ++pos_j) {
+        operands.push_back(collect(pos_j, [](const auto& node) { return node.e; }));
+      }
+      auto term = operands.size() == 1 ? std::move(operands.front())
+                                       : make_multi_and_gate(operands);
+      g = g.empty() ? std::move(term) : make_xor_gate(g, term);
+    }
+    WireVector e;
+    if (!last_level) {
+      std::vector<WireVector> operands;
+      for (std::size_t pos = 0; pos < group_size; ++pos) {
+        operands.push_back(collect(pos, [](const auto& node) { return node.e; }));
+      }
+      e = make_multi_and_gate(operands);
+    }
+    std::vector<Node> next_nodes(num_groups);
+    for (std::size_t group_i = 0; group_i < num_groups; ++group_i) {
+      next_nodes[group_i] = {{g[group_i]}, last_level ? nullptr : e[group_i]};
+    }
+    nodes = std::move(next_nodes);
   }
+  assert(nodes.size() == 1);
+  return {nodes.front().g.front()};
+}
+
+WireVector BEAVYProvider::make_gt_gate(const WireVector& in_a, const WireVector& in_b) {
+  check_comparison_inputs(in_a, in_b);
+  switch (in_a.size()) {
+    case 8:
+      return basic_make_gt_gate<8>(in_a, in_b);
+    case 16:
+      return basic_make_gt_gate<16>(in_a, in_b);
+    case 32:
+      return basic_make_gt_gate<32>(in_a, in_b);
+    case 64:
+      return basic_make_gt_gate<64>(in_a, in_b);
+    default:
+      throw std::logic_error(
+          fmt::format("unsupported bit size {} for BEAVY comparison", in_a.size()));
+  }
+}
+
+// a == b as the AND of all bits of ~(a ^ b), i.e., 1 round for up to 8 bits and 2 for 64
+WireVector BEAVYProvider::make_eq_gate(const WireVector& in_a, const WireVector& in_b) {
+  check_comparison_inputs(in_a, in_b);
+  if (in_a.empty()) {
+    throw std::logic_error("BEAVY equality needs at least one bit");
+  }
+  const auto eq_bits = make_inv_gate(make_xor_gate(in_a, in_b));
+  std::vector<WireVector> operands;
+  for (const auto& wire : eq_bits) {
+    operands.push_back({wire});
+  }
+  return make_multi_and_gate(operands);
 }
 
 WireVector BEAVYProvider::make_msg_gate(const WireVector& in_a, const WireVector& in_b) {
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return make_xor_gate(in_b, in_a);
+    return make_msg_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -615,15 +903,23 @@ WireVector BEAVYProvider::make_msg_gate(const WireVector& in_a, const WireVector
 }
 
 WireVector BEAVYProvider::make_eqexp_gate(const WireVector& in_a, const WireVector& in_b) {
-
-    return make_arithmetic_boolean_binary_gate<ArithmeticBEAVYEQEXPGate>(in_a, in_b);
-
+  // the second input only carries the number of compared values, preferably as a constant
+  if (in_b.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain) {
+    auto gate_id = gate_register_.get_next_gate_id();
+    auto gate = std::make_unique<ArithmeticBEAVYEQEXPGate<std::uint64_t>>(
+        gate_id, *this, cast_arith_wire<std::uint64_t>(in_a.at(0)),
+        cast_arith_plain_wire<std::uint64_t>(in_b.at(0)));
+    auto output = cast_wires(BooleanBEAVYWireVector(gate->get_output_wires()));
+    gate_register_.register_gate(std::move(gate));
+    return output;
+  }
+  return make_arithmetic_boolean_binary_gate<ArithmeticBEAVYEQEXPGate>(in_a, in_b);
 }
 
 WireVector BEAVYProvider::make_dot_gate(const WireVector& in_a, const WireVector& in_b) {
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
-    return make_xor_gate(in_b, in_a);
+    return make_dot_gate(in_b, in_a);
   }
   assert(in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY);
   if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanPlain) {
@@ -633,6 +929,331 @@ WireVector BEAVYProvider::make_dot_gate(const WireVector& in_a, const WireVector
   }
 }
 
+WireVector BEAVYProvider::make_matrix_dot_gate(const WireVector& text,
+                                               const std::vector<WireVector>& patterns) {
+  if (text.empty() || patterns.empty()) {
+    throw std::logic_error("BEAVY matrix DOT needs a text and at least one pattern");
+  }
+  auto is_beavy = [](const auto& wires) {
+    return std::all_of(std::begin(wires), std::end(wires), [](const auto& wire) {
+      return wire->get_protocol() == MPCProtocol::BooleanBEAVY;
+    });
+  };
+  if (!is_beavy(text) || !std::all_of(std::begin(patterns), std::end(patterns), is_beavy)) {
+    throw std::logic_error("BEAVY matrix DOT supports BooleanBEAVY wires only");
+  }
+  std::vector<BooleanBEAVYWireVector> pattern_wires;
+  pattern_wires.reserve(patterns.size());
+  std::transform(std::begin(patterns), std::end(patterns), std::back_inserter(pattern_wires),
+                 [](const auto& pattern) { return cast_wires(pattern); });
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<BooleanBEAVYMatrixDOTGate>(gate_id, *this, cast_wires(text),
+                                                          std::move(pattern_wires));
+  auto output = gate->get_output_wires();
+  gate_register_.register_gate(std::move(gate));
+  return cast_wires(std::move(output));
+}
+
+WireVector BEAVYProvider::make_lane_map_gate(const WireVector& in, std::size_t num_wires,
+                                             std::vector<std::vector<std::size_t>>&& sources,
+                                             ENCRYPTO::BitVector<>&& constants) {
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<BooleanBEAVYLaneMapGate>(gate_id, *this, cast_wires(in), num_wires,
+                                                        std::move(sources), std::move(constants));
+  auto output = gate->get_output_wires();
+  gate_register_.register_gate(std::move(gate));
+  return cast_wires(std::move(output));
+}
+
+// number of SIMD values of the BEAVY wires, which need to be the same for all of them
+static std::size_t check_lane_inputs(const WireVector& in, std::string_view operation) {
+  if (in.empty()) {
+    throw std::logic_error(fmt::format("BEAVY {} needs at least one wire", operation));
+  }
+  const auto num_simd = in[0]->get_num_simd();
+  for (const auto& wire : in) {
+    if (wire->get_protocol() != MPCProtocol::BooleanBEAVY) {
+      throw std::logic_error(fmt::format("BEAVY {} supports BooleanBEAVY wires only", operation));
+    }
+    if (wire->get_num_simd() != num_simd) {
+      throw std::logic_error(
+          fmt::format("BEAVY {} needs the same number of SIMD values on all wires", operation));
+    }
+  }
+  if (num_simd == 0) {
+    throw std::logic_error(fmt::format("BEAVY {} needs at least one SIMD value", operation));
+  }
+  return num_simd;
+}
+
+WireVector BEAVYProvider::make_or_reduction_gate(const WireVector& in) {
+  constexpr auto group_size = BooleanBEAVYMSGGate::group_size;
+  const auto num_wires = in.size();
+  auto num_values = check_lane_inputs(in, "OR reduction");
+  if (num_values == 1) {
+    return in;
+  }
+
+  // the first round ANDs groups of the inverted values, i.e., computes their NORs, the later ones
+  // AND the NORs of the groups, and the last ANDs are inverted again
+  auto values = in;
+  for (bool invert = true; num_values > 1; invert = false) {
+    const auto num_groups = (num_values + group_size - 1) / group_size;
+    std::vector<WireVector> operands;
+    for (std::size_t operand_i = 0; operand_i < std::min(group_size, num_values); ++operand_i) {
+      std::vector<std::vector<std::size_t>> sources(num_wires * num_groups);
+      ENCRYPTO::BitVector<> constants(num_wires * num_groups, true);
+      for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+        for (std::size_t group_i = 0; group_i < num_groups; ++group_i) {
+          const auto value_i = group_i * group_size + operand_i;
+          // missing values of the last group are public ones
+          if (value_i < num_values) {
+            sources[wire_i * num_groups + group_i] = {wire_i * num_values + value_i};
+            constants.Set(invert, wire_i * num_groups + group_i);
+          }
+        }
+      }
+      operands.push_back(
+          make_lane_map_gate(values, num_wires, std::move(sources), std::move(constants)));
+    }
+    values = make_multi_and_gate(operands);
+    num_values = num_groups;
+  }
+  return make_inv_gate(values);
+}
+
+WireVector BEAVYProvider::make_prefix_or_gate(const WireVector& in) {
+  constexpr auto group_size = BooleanBEAVYMSGGate::group_size;
+  const auto num_wires = in.size();
+  const auto num_values = check_lane_inputs(in, "prefix OR");
+  if (num_values == 1) {
+    return in;
+  }
+
+  // After the round with distance d, value i is the NOR of the inputs i - 4d + 1, ..., i, which
+  // is the AND of the values i, i - d, i - 2d and i - 3d of the previous round, where values
+  // before the first one are public ones.
+  auto values = make_inv_gate(in);
+  for (std::size_t distance = 1; distance < num_values; distance *= group_size) {
+    std::vector<WireVector> operands = {values};
+    for (std::size_t operand_i = 1; operand_i < group_size; ++operand_i) {
+      const auto shift = operand_i * distance;
+      if (shift >= num_values) {
+        break;
+      }
+      std::vector<std::vector<std::size_t>> sources(num_wires * num_values);
+      ENCRYPTO::BitVector<> constants(num_wires * num_values, true);
+      for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+        for (std::size_t value_i = shift; value_i < num_values; ++value_i) {
+          sources[wire_i * num_values + value_i] = {wire_i * num_values + value_i - shift};
+          constants.Set(false, wire_i * num_values + value_i);
+        }
+      }
+      operands.push_back(
+          make_lane_map_gate(values, num_wires, std::move(sources), std::move(constants)));
+    }
+    values = make_multi_and_gate(operands);
+  }
+  return make_inv_gate(values);
+}
+
+WireVector BEAVYProvider::make_first_positions_gate(const WireVector& in, std::size_t k) {
+  const auto num_values = check_lane_inputs(in, "first positions");
+  if (in.size() != 1) {
+    throw std::logic_error("BEAVY first positions needs a single wire");
+  }
+  if (k == 0) {
+    throw std::logic_error("BEAVY first positions needs k > 0");
+  }
+
+  // The first set value f is the difference of the prefix ORs P, i.e., f_i = P_i ^ P_(i-1), and
+  // is removed from the input to find the next one.
+  WireVector remaining = in;
+  WireVector prefix_ors;
+  for (std::size_t position_r = 0; position_r < k; ++position_r) {
+    auto prefix_or = make_prefix_or_gate(remaining);
+    if (position_r + 1 < k) {
+      // the remaining values followed by their prefix ORs
+      std::vector<std::vector<std::size_t>> sources(num_values);
+      for (std::size_t value_i = 0; value_i < num_values; ++value_i) {
+        sources[value_i] = {value_i, num_values + value_i};
+        if (value_i > 0) {
+          sources[value_i].push_back(num_values + value_i - 1);
+        }
+      }
+      remaining = make_lane_map_gate({remaining[0], prefix_or[0]}, 1, std::move(sources),
+                                     ENCRYPTO::BitVector<>(num_values));
+    }
+    prefix_ors.push_back(std::move(prefix_or[0]));
+  }
+
+  // Bit b of the position is the XOR of f_i over the values i where bit b of i + 1 is set, i.e.,
+  // of P_i over the values where it differs from bit b of i + 2, where P_n = 0.
+  const auto num_bits = static_cast<std::size_t>(std::bit_width(num_values));
+  std::vector<std::vector<std::size_t>> sources(num_bits * k);
+  for (std::size_t bit_b = 0; bit_b < num_bits; ++bit_b) {
+    for (std::size_t value_i = 0; value_i < num_values; ++value_i) {
+      const bool bit_i = ((value_i + 1) >> bit_b) & 1;
+      const bool bit_next = value_i + 1 < num_values && (((value_i + 2) >> bit_b) & 1);
+      if (bit_i == bit_next) {
+        continue;
+      }
+      for (std::size_t position_r = 0; position_r < k; ++position_r) {
+        sources[bit_b * k + position_r].push_back(position_r * num_values + value_i);
+      }
+    }
+  }
+  return make_lane_map_gate(prefix_ors, num_bits, std::move(sources),
+                            ENCRYPTO::BitVector<>(num_bits * k));
+}
+
+WireVector BEAVYProvider::make_window_hamming_gate(const WireVector& text,
+                                                   const WireVector& pattern) {
+  if (text.empty() || pattern.empty()) {
+    throw std::logic_error("BEAVY window HAM needs a text and a pattern");
+  }
+  auto is_beavy = [](const auto& wire) {
+    return wire->get_protocol() == MPCProtocol::BooleanBEAVY;
+  };
+  if (!std::all_of(std::begin(text), std::end(text), is_beavy) ||
+      !std::all_of(std::begin(pattern), std::end(pattern), is_beavy)) {
+    throw std::logic_error("BEAVY window HAM supports BooleanBEAVY wires only");
+  }
+  const auto window_size = pattern[0]->get_num_simd();
+  auto gate_id = gate_register_.get_next_gate_id();
+  // like make_ham_gate, only 64 bit outputs are supported for now
+  auto gate = std::make_unique<BooleanBEAVYWindowHAMGate<std::uint64_t>>(
+      gate_id, *this, BooleanBEAVYWindowView{cast_wires(text), window_size},
+      cast_wires(pattern));
+  auto output = gate->get_output_wire();
+  gate_register_.register_gate(std::move(gate));
+  return {cast_arith_wire(output)};
+}
+
+WireVector BEAVYProvider::make_threshold_gate(const WireVector& in, std::size_t bound,
+                                              std::uint64_t threshold) {
+  // rows of the one-hot encoding, as for the vec_size of EQEXP
+  constexpr std::size_t max_bound = std::size_t(1) << 16;
+  if (in.size() != 1 || in[0]->get_protocol() != MPCProtocol::ArithmeticBEAVY) {
+    throw std::logic_error("BEAVY threshold test needs a single ArithmeticBEAVY wire");
+  }
+  if (bound == 0 || bound > max_bound) {
+    throw std::invalid_argument(fmt::format("BEAVY threshold test: invalid bound {}", bound));
+  }
+  auto gate_id = gate_register_.get_next_gate_id();
+  // like make_eqexp_gate, only 64 bit values are supported for now
+  auto gate = std::make_unique<ArithmeticBEAVYLEQEXPGate<std::uint64_t>>(
+      gate_id, *this, cast_arith_wire<std::uint64_t>(in[0]), std::bit_ceil(bound), threshold);
+  auto output = cast_wires(BooleanBEAVYWireVector(gate->get_output_wires()));
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+template <typename T>
+WireVector BEAVYProvider::basic_make_arithmetic_lane_map_gate(const WireVector& in,
+                                                            std::vector<std::size_t>&& sources) {
+  ArithmeticBEAVYWireVector<T> inputs;
+  inputs.reserve(in.size());
+  for (const auto& wire : in) {
+    inputs.push_back(cast_arith_wire<T>(wire));
+  }
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<ArithmeticBEAVYLaneMapGate<T>>(gate_id, *this, std::move(inputs),
+                                                              std::move(sources));
+  auto output = {cast_arith_wire(gate->get_output_wire())};
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+WireVector BEAVYProvider::make_arithmetic_lane_map_gate(const WireVector& in,
+                                                        std::vector<std::size_t>&& sources) {
+  if (in.empty()) {
+    throw std::logic_error("BEAVY arithmetic lane map needs at least one wire");
+  }
+  const auto bit_size = in[0]->get_bit_size();
+  for (const auto& wire : in) {
+    if (wire->get_protocol() != MPCProtocol::ArithmeticBEAVY || wire->get_bit_size() != bit_size) {
+      throw std::logic_error(
+          "BEAVY arithmetic lane map needs ArithmeticBEAVY wires of the same bit size");
+    }
+  }
+  switch (bit_size) {
+    case 8:
+      return basic_make_arithmetic_lane_map_gate<std::uint8_t>(in, std::move(sources));
+    case 16:
+      return basic_make_arithmetic_lane_map_gate<std::uint16_t>(in, std::move(sources));
+    case 32:
+      return basic_make_arithmetic_lane_map_gate<std::uint32_t>(in, std::move(sources));
+    case 64:
+      return basic_make_arithmetic_lane_map_gate<std::uint64_t>(in, std::move(sources));
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+}
+
+template <typename T>
+WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_my(std::span<const T> input,
+                                                             std::size_t chunk_size) {
+  if (chunk_size == 0) {
+    throw std::invalid_argument("make_arithmetic_bulk_input_gate_my: chunk_size must be positive");
+  }
+  // the messages of the chunks are sent under consecutive gate ids
+  const auto num_chunks = ArithmeticBEAVYBulkInputGateSender<T>::get_num_chunks(input.size(),
+                                                                               chunk_size);
+  auto gate_id = gate_register_.get_next_gate_ids(std::max<std::size_t>(1, num_chunks));
+  auto gate =
+      std::make_unique<ArithmeticBEAVYBulkInputGateSender<T>>(gate_id, *this, input, chunk_size);
+  WireVector output;
+  output.reserve(num_chunks);
+  for (auto& wire : gate->get_output_wires()) {
+    output.push_back(cast_arith_wire(wire));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+template <typename T>
+WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_other(std::size_t input_owner,
+                                                                std::size_t num_values,
+                                                                std::size_t chunk_size) {
+  if (input_owner == my_id_) {
+    throw std::logic_error("trying to create input gate for wrong party");
+  }
+  if (chunk_size == 0) {
+    throw std::invalid_argument(
+        "make_arithmetic_bulk_input_gate_other: chunk_size must be positive");
+  }
+  const auto num_chunks =
+      ArithmeticBEAVYBulkInputGateSender<T>::get_num_chunks(num_values, chunk_size);
+  auto gate_id = gate_register_.get_next_gate_ids(std::max<std::size_t>(1, num_chunks));
+  auto gate = std::make_unique<ArithmeticBEAVYBulkInputGateReceiver<T>>(
+      gate_id, *this, num_values, chunk_size, input_owner);
+  WireVector output;
+  output.reserve(num_chunks);
+  for (auto& wire : gate->get_output_wires()) {
+    output.push_back(cast_arith_wire(wire));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_my(std::span<const std::uint8_t>,
+                                                                      std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_my(
+    std::span<const std::uint16_t>, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_my(
+    std::span<const std::uint32_t>, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_my(
+    std::span<const std::uint64_t>, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_other<std::uint8_t>(
+    std::size_t, std::size_t, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_other<std::uint16_t>(
+    std::size_t, std::size_t, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_other<std::uint32_t>(
+    std::size_t, std::size_t, std::size_t);
+template WireVector BEAVYProvider::make_arithmetic_bulk_input_gate_other<std::uint64_t>(
+    std::size_t, std::size_t, std::size_t);
+
 static std::size_t check_arithmetic_wire(const WireVector& in) {
   if (in.size() != 1) {
     throw std::logic_error("arithmetic operations support single wires only");
@@ -640,6 +1261,66 @@ static std::size_t check_arithmetic_wire(const WireVector& in) {
   return in[0]->get_bit_size();
 }
 
+template <typename T>
+WireVector BEAVYProvider::basic_make_arithmetic_hamming_gate(const NewWireP& in_a,
+                                                             std::size_t group_size) {
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<BEAVYAHAMGate<T>>(gate_id, *this, cast_arith_wire<T>(in_a),
+                                                 group_size);
+  auto output = {cast_arith_wire(gate->get_output_wire())};
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+WireVector BEAVYProvider::make_arithmetic_hamming_gate(const WireVector& in_a,
+                                                       std::size_t group_size) {
+  auto bit_size = check_arithmetic_wire(in_a);
+  switch (bit_size) {
+    case 8:
+      return basic_make_arithmetic_hamming_gate<std::uint8_t>(in_a[0], group_size);
+    case 16:
+      return basic_make_arithmetic_hamming_gate<std::uint16_t>(in_a[0], group_size);
+    case 32:
+      return basic_make_arithmetic_hamming_gate<std::uint32_t>(in_a[0], group_size);
+    case 64:
+      return basic_make_arithmetic_hamming_gate<std::uint64_t>(in_a[0], group_size);
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+}
+
+template <typename T>
+WireVector BEAVYProvider::basic_make_window_distance_gate(const NewWireP& text,
+                                                          const NewWireP& pattern) {
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate = std::make_unique<ArithmeticBEAVYWindowDistanceGate<T>>(
+      gate_id, *this, cast_arith_wire<T>(text), cast_arith_wire<T>(pattern));
+  auto output = {cast_arith_wire(gate->get_output_wire())};
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+WireVector BEAVYProvider::make_window_distance_gate(const WireVector& text,
+                                                    const WireVector& pattern) {
+  auto bit_size = check_arithmetic_wire(text);
+  if (check_arithmetic_wire(pattern) != bit_size) {
+    throw std::logic_error("BEAVY window distance: text and pattern differ in bit size");
+  }
+  const auto inputs = reconstruct_additive_wires({text, pattern});
+  switch (bit_size) {
+    case 8:
+      return basic_make_window_distance_gate<std::uint8_t>(inputs[0][0], inputs[1][0]);
+    case 16:
+      return basic_make_window_distance_gate<std::uint16_t>(inputs[0][0], inputs[1][0]);
+    case 32:
+      return basic_make_window_distance_gate<std::uint32_t>(inputs[0][0], inputs[1][0]);
+    case 64:
+      return basic_make_window_distance_gate<std::uint64_t>(inputs[0][0], inputs[1][0]);
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+}
+
 template <template <typename> class UnaryGate, typename T>
 WireVector BEAVYProvider::make_arithmetic_unary_gate(const NewWireP& in_a) {
   auto gate_id = gate_register_.get_next_gate_id();
@@ -730,6 +1411,9 @@ WireVector BEAVYProvider::make_neg_gate(const WireVector& in) {
 }
 
 WireVector BEAVYProvider::make_add_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::ADD, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain) {
     return make_add_gate(in_b, in_a);
@@ -744,6 +1428,9 @@ WireVector BEAVYProvider::make_add_gate(const WireVector& in_a, const WireVector
 }
 
 WireVector BEAVYProvider::make_mul_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::MUL, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire or a Boolean wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain ||
       in_a.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY) {
@@ -753,21 +1440,24 @@ WireVector BEAVYProvider::make_mul_gate(const WireVector& in_a, const WireVector
   if (in_b.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain) {
     return make_arithmetic_binary_gate<ArithmeticBEAVYMULPlainGate, mixed_gate_mode_t::plain>(in_a,
                                                                                               in_b);
-  } else if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY) {
+  }
+  // multiplications with a constant can be applied to additive shares
+  const auto inputs = reconstruct_additive_wires({in_a, in_b});
+  if (in_b.at(0)->get_protocol() == MPCProtocol::BooleanBEAVY) {
     return make_arithmetic_binary_gate<BooleanXArithmeticBEAVYMULGate, mixed_gate_mode_t::boolean>(
-        in_b, in_a);
+        inputs[1], inputs[0]);
   } else {
-    return make_arithmetic_binary_gate<ArithmeticBEAVYMULGate>(in_a, in_b);
+    return make_arithmetic_binary_gate<ArithmeticBEAVYMULGate>(inputs[0], inputs[1]);
   }
 }
 
 WireVector BEAVYProvider::make_mulni_gate(const WireVector& in_a, const WireVector& in_b) {
-  // assume, at most one of the inputs is a plain wire or a Boolean wire
-    return make_arithmetic_binary_gate<ArithmeticBEAVYMULNIGate>(in_a, in_b);
+  const auto inputs = reconstruct_additive_wires({in_a, in_b});
+  return make_arithmetic_binary_gate<ArithmeticBEAVYMULNIGate>(inputs[0], inputs[1]);
 }
 
 WireVector BEAVYProvider::make_sqr_gate(const WireVector& in) {
-  return make_arithmetic_unary_gate<ArithmeticBEAVYSQRGate>(in);
+  return make_arithmetic_unary_gate<ArithmeticBEAVYSQRGate>(reconstruct_additive_wires({in})[0]);
 }
 
 template <typename T>
@@ -826,6 +1516,50 @@ std::pair<NewGateP, WireVector>
   return {std::move(gate), {std::dynamic_pointer_cast<NewWire>(output)}};
 }
 
+template <typename T>
+WireVector BEAVYProvider::basic_make_convert_bits_to_arithmetic_beavy_gate(
+    BooleanBEAVYWireVector&& in_a) {
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate =
+      std::make_unique<BooleanBitsToArithmeticBEAVYGate<T>>(gate_id, *this, std::move(in_a));
+  const auto& outputs = gate->get_output_wires();
+  WireVector output(std::begin(outputs), std::end(outputs));
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+template <typename T>
+std::pair<NewGateP, WireVector> BEAVYProvider::external_make_convert_bits_to_arithmetic_beavy_gate(
+    BooleanBEAVYWireVector&& in_a) {
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto gate =
+      std::make_unique<BooleanBitsToArithmeticBEAVYGate<T>>(gate_id, *this, std::move(in_a));
+  const auto& outputs = gate->get_output_wires();
+  WireVector output(std::begin(outputs), std::end(outputs));
+  return {std::move(gate), std::move(output)};
+}
+
+template WireVector BEAVYProvider::basic_make_convert_bits_to_arithmetic_beavy_gate<std::uint8_t>(
+    BooleanBEAVYWireVector&&);
+template WireVector BEAVYProvider::basic_make_convert_bits_to_arithmetic_beavy_gate<std::uint16_t>(
+    BooleanBEAVYWireVector&&);
+template WireVector BEAVYProvider::basic_make_convert_bits_to_arithmetic_beavy_gate<std::uint32_t>(
+    BooleanBEAVYWireVector&&);
+template WireVector BEAVYProvider::basic_make_convert_bits_to_arithmetic_beavy_gate<std::uint64_t>(
+    BooleanBEAVYWireVector&&);
+template std::pair<NewGateP, WireVector>
+BEAVYProvider::external_make_convert_bits_to_arithmetic_beavy_gate<std::uint8_t>(
+    BooleanBEAVYWireVector&&);
+template std::pair<NewGateP, WireVector>
+BEAVYProvider::external_make_convert_bits_to_arithmetic_beavy_gate<std::uint16_t>(
+    BooleanBEAVYWireVector&&);
+template std::pair<NewGateP, WireVector>
+BEAVYProvider::external_make_convert_bits_to_arithmetic_beavy_gate<std::uint32_t>(
+    BooleanBEAVYWireVector&&);
+template std::pair<NewGateP, WireVector>
+BEAVYProvider::external_make_convert_bits_to_arithmetic_beavy_gate<std::uint64_t>(
+    BooleanBEAVYWireVector&&);
+
 template <typename BinaryGate, bool plain = false>
 std::pair<NewGateP, WireVector>
   BEAVYProvider::external_make_beavy_dot_gate(BooleanBEAVYWireP in_a, BooleanBEAVYWireP in_b) {
@@ -865,6 +1599,7 @@ WireVector BEAVYProvider::basic_make_convert_to_arithmetic_gmw_gate(const NewWir
 
 WireVector BEAVYProvider::make_convert_to_arithmetic_gmw_gate(const WireVector& in_a) {
   assert(in_a.size() == 1);
+  // additively shared wires are converted locally, without reconstructing them first
   const auto& wire = in_a.at(0);
   auto bit_size = wire->get_bit_size();
   switch (bit_size) {
@@ -993,50 +1728,55 @@ WireVector BEAVYProvider::convert(MPCProtocol dst_proto, const WireVector& in) {
 
 template <typename T>
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, tensor::TensorCP>
-BEAVYProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions& dims) {
+BEAVYProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                     std::size_t fractional_bits) {
   ENCRYPTO::ReusableFiberPromise<std::vector<T>> promise;
   auto gate_id = gate_register_.get_next_gate_id();
   auto tensor_op = std::make_unique<ArithmeticBEAVYTensorInputSender<T>>(gate_id, *this, dims,
                                                                          promise.get_future());
   auto output = tensor_op->get_output_tensor();
+  output->set_fractional_bits(fractional_bits);
   gate_register_.register_gate(std::move(tensor_op));
   return {std::move(promise), std::dynamic_pointer_cast<const tensor::Tensor>(output)};
 }
 
 template std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-BEAVYProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&);
+BEAVYProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&, std::size_t);
 
 template <typename T>
 tensor::TensorCP BEAVYProvider::basic_make_arithmetic_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
   auto gate_id = gate_register_.get_next_gate_id();
   auto tensor_op = std::make_unique<ArithmeticBEAVYTensorInputReceiver<T>>(gate_id, *this, dims);
   auto output = tensor_op->get_output_tensor();
+  output->set_fractional_bits(fractional_bits);
   gate_register_.register_gate(std::move(tensor_op));
   return std::dynamic_pointer_cast<const tensor::Tensor>(output);
 }
 
 template tensor::TensorCP BEAVYProvider::basic_make_arithmetic_tensor_input_other<std::uint64_t>(
-    const tensor::TensorDimensions&);
+    const tensor::TensorDimensions&, std::size_t);
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, tensor::TensorCP>
-BEAVYProvider::make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_my<std::uint32_t>(dims);
+BEAVYProvider::make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                  std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_my<std::uint32_t>(dims, fractional_bits);
 }
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-BEAVYProvider::make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_my<std::uint64_t>(dims);
+BEAVYProvider::make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                  std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_my<std::uint64_t>(dims, fractional_bits);
 }
 
 tensor::TensorCP BEAVYProvider::make_arithmetic_32_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_other<std::uint32_t>(dims);
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_other<std::uint32_t>(dims, fractional_bits);
 }
 
 tensor::TensorCP BEAVYProvider::make_arithmetic_64_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_other<std::uint64_t>(dims);
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_other<std::uint64_t>(dims, fractional_bits);
 }
 
 template <typename T>
@@ -1135,6 +1875,20 @@ tensor::TensorCP BEAVYProvider::make_tensor_conv2d_op(const tensor::Conv2DOp& co
                                                       const tensor::TensorCP kernel,
                                                       const tensor::TensorCP bias,
                                                       std::size_t fractional_bits) {
+  return basic_make_tensor_conv2d_op(conv_op, input, kernel, bias, fractional_bits, false);
+}
+
+tensor::TensorCP BEAVYProvider::make_tensor_conv2d_sqr_op(const tensor::Conv2DOp& conv_op,
+                                                          const tensor::TensorCP input,
+                                                          const tensor::TensorCP kernel,
+                                                          const tensor::TensorCP bias,
+                                                          std::size_t fractional_bits) {
+  return basic_make_tensor_conv2d_op(conv_op, input, kernel, bias, fractional_bits, true);
+}
+
+tensor::TensorCP BEAVYProvider::basic_make_tensor_conv2d_op(
+    const tensor::Conv2DOp& conv_op, const tensor::TensorCP input, const tensor::TensorCP kernel,
+    const tensor::TensorCP bias, std::size_t fractional_bits, bool fuse_square) {
   if (!conv_op.verify()) {
     throw std::invalid_argument("invalid Conv2dOp");
   }
@@ -1159,7 +1913,7 @@ tensor::TensorCP BEAVYProvider::make_tensor_conv2d_op(const tensor::Conv2DOp& co
   std::unique_ptr<NewGate> gate;
   auto gate_id = gate_register_.get_next_gate_id();
   tensor::TensorCP output;
-  const auto make_op = [this, input, conv_op, kernel, bias, fractional_bits, gate_id,
+  const auto make_op = [this, input, conv_op, kernel, bias, fractional_bits, fuse_square, gate_id,
                         &output](auto dummy_arg) {
     using T = decltype(dummy_arg);
     auto input_ptr = std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input);
@@ -1170,7 +1924,7 @@ tensor::TensorCP BEAVYProvider::make_tensor_conv2d_op(const tensor::Conv2DOp& co
       assert(bias_ptr);
     }
     auto tensor_op = std::make_unique<ArithmeticBEAVYTensorConv2D<T>>(
-        gate_id, *this, conv_op, input_ptr, kernel_ptr, bias_ptr, fractional_bits);
+        gate_id, *this, conv_op, input_ptr, kernel_ptr, bias_ptr, fractional_bits, fuse_square);
     output = tensor_op->get_output_tensor();
     return tensor_op;
   };
@@ -1192,6 +1946,21 @@ tensor::TensorCP BEAVYProvider::make_tensor_gemm_op(const tensor::GemmOp& gemm_o
                                                     const tensor::TensorCP input_A,
                                                     const tensor::TensorCP input_B,
                                                     std::size_t fractional_bits) {
+  return basic_make_tensor_gemm_op(gemm_op, input_A, input_B, fractional_bits, false);
+}
+
+tensor::TensorCP BEAVYProvider::make_tensor_gemm_sqr_op(const tensor::GemmOp& gemm_op,
+                                                        const tensor::TensorCP input_A,
+                                                        const tensor::TensorCP input_B,
+                                                        std::size_t fractional_bits) {
+  return basic_make_tensor_gemm_op(gemm_op, input_A, input_B, fractional_bits, true);
+}
+
+tensor::TensorCP BEAVYProvider::basic_make_tensor_gemm_op(const tensor::GemmOp& gemm_op,
+                                                          const tensor::TensorCP input_A,
+                                                          const tensor::TensorCP input_B,
+                                                          std::size_t fractional_bits,
+                                                          bool fuse_square) {
   if (!gemm_op.verify()) {
     throw std::invalid_argument("invalid GemmOp");
   }
@@ -1208,12 +1977,72 @@ tensor::TensorCP BEAVYProvider::make_tensor_gemm_op(const tensor::GemmOp& gemm_o
   std::unique_ptr<NewGate> gate;
   auto gate_id = gate_register_.get_next_gate_id();
   tensor::TensorCP output;
-  const auto make_op = [this, input_A, gemm_op, input_B, fractional_bits, gate_id,
+  const auto make_op = [this, input_A, gemm_op, input_B, fractional_bits, fuse_square, gate_id,
                         &output](auto dummy_arg) {
     using T = decltype(dummy_arg);
     auto tensor_op = std::make_unique<ArithmeticBEAVYTensorGemm<T>>(
         gate_id, *this, gemm_op, std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input_A),
-        std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input_B), fractional_bits);
+        std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input_B), fractional_bits,
+        fuse_square);
+    output = tensor_op->get_output_tensor();
+    return tensor_op;
+  };
+  switch (bit_size) {
+    case 32:
+      gate = make_op(std::uint32_t{});
+      break;
+    case 64:
+      gate = make_op(std::uint64_t{});
+      break;
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+tensor::TensorCP BEAVYProvider::make_tensor_sparse_gemm_op(const tensor::GemmOp& gemm_op,
+                                                           const tensor::TensorCP input_A,
+                                                           const CSRMatrix<std::uint64_t>& weights,
+                                                           std::size_t weights_owner,
+                                                           std::size_t weights_fractional_bits,
+                                                           std::size_t fractional_bits) {
+  if (!gemm_op.verify() || gemm_op.transA_ || gemm_op.transB_) {
+    throw std::invalid_argument("invalid GemmOp");
+  }
+  if (input_A->get_dimensions() != gemm_op.get_input_A_tensor_dims()) {
+    throw std::invalid_argument("invalid input_A dimensions");
+  }
+  if (!weights.verify() || weights.rows_ != gemm_op.input_B_shape_[0] ||
+      weights.cols_ != gemm_op.input_B_shape_[1]) {
+    throw std::invalid_argument("invalid sparsity pattern of the weights");
+  }
+  if (weights_owner > 1) {
+    throw std::invalid_argument("invalid owner of the weights");
+  }
+  const bool is_weights_owner = weights_owner == get_my_id();
+  if (is_weights_owner && weights.values_.size() != weights.get_num_nonzeros()) {
+    throw std::invalid_argument("weights have unexpected number of values");
+  }
+  auto bit_size = input_A->get_bit_size();
+  std::unique_ptr<NewGate> gate;
+  auto gate_id = gate_register_.get_next_gate_id();
+  tensor::TensorCP output;
+  const auto make_op = [this, input_A, gemm_op, &weights, weights_owner, weights_fractional_bits,
+                        fractional_bits, is_weights_owner, gate_id, &output](auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    // the values are reduced modulo 2^bit_size
+    CSRMatrix<T> weights_T{.rows_ = weights.rows_,
+                           .cols_ = weights.cols_,
+                           .row_ptr_ = weights.row_ptr_,
+                           .col_idx_ = weights.col_idx_,
+                           .values_ = {}};
+    if (is_weights_owner) {
+      weights_T.values_.assign(std::begin(weights.values_), std::end(weights.values_));
+    }
+    auto tensor_op = std::make_unique<ArithmeticBEAVYTensorSparseGemm<T>>(
+        gate_id, *this, gemm_op, std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input_A),
+        std::move(weights_T), weights_owner, weights_fractional_bits, fractional_bits);
     output = tensor_op->get_output_tensor();
     return tensor_op;
   };
@@ -1289,6 +2118,51 @@ tensor::TensorCP BEAVYProvider::make_tensor_avgpool_op(const tensor::AveragePool
   return output;
 }
 
+tensor::TensorCP BEAVYProvider::make_tensor_truncation_op(const tensor::TensorCP input,
+                                                          std::size_t truncate_bits) {
+  auto bit_size = input->get_bit_size();
+  std::unique_ptr<NewGate> gate;
+  auto gate_id = gate_register_.get_next_gate_id();
+  tensor::TensorCP output;
+  const auto make_op = [this, input, truncate_bits, gate_id, &output](auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    auto tensor_op = std::make_unique<ArithmeticBEAVYTensorTruncation<T>>(
+        gate_id, *this, std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<T>>(input),
+        truncate_bits);
+    output = tensor_op->get_output_tensor();
+    return tensor_op;
+  };
+  switch (bit_size) {
+    case 32:
+      gate = make_op(std::uint32_t{});
+      break;
+    case 64:
+      gate = make_op(std::uint64_t{});
+      break;
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+tensor::TensorCP BEAVYProvider::make_tensor_ring_reduction(const tensor::TensorCP input,
+                                                           std::size_t bit_size) {
+  if (input->get_bit_size() != 64 || bit_size != 32) {
+    throw std::invalid_argument(fmt::format("BEAVYProvider: cannot reduce {} bit tensor to {} bits",
+                                            input->get_bit_size(), bit_size));
+  }
+  const auto input_tensor =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<std::uint64_t>>(input);
+  assert(input_tensor != nullptr);
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto tensor_op =
+      std::make_unique<ArithmeticBEAVYTensorRingReduction>(gate_id, *this, input_tensor);
+  auto output = tensor_op->get_output_tensor();
+  gate_register_.register_gate(std::move(tensor_op));
+  return output;
+}
+
 tensor::TensorCP BEAVYProvider::make_tensor_relu_op(const tensor::TensorCP in) {
   const auto input_tensor = std::dynamic_pointer_cast<const BooleanBEAVYTensor>(in);
   assert(input_tensor != nullptr);
@@ -1321,8 +2195,8 @@ tensor::TensorCP BEAVYProvider::make_tensor_relu_op(const tensor::TensorCP in_bo
       in_arith->get_protocol() != MPCProtocol::ArithmeticBEAVY) {
     throw std::invalid_argument("expected Boolean and arithmetic BEAVY, respectively");
   }
-  const auto bit_size = in_bool->get_bit_size();
-  if (bit_size != in_arith->get_bit_size()) {
+  const auto bit_size = in_arith->get_bit_size();
+  if (in_bool->get_bit_size() != bit_size && in_bool->get_bit_size() != 1) {
     throw std::invalid_argument("bit size mismatch");
   }
   switch (bit_size) {
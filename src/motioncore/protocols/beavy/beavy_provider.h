@@ -23,6 +23,10 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 #include "base/gate_factory.h"
@@ -33,8 +37,11 @@
 #include "utility/enable_wait.h"
 #include "utility/type_traits.hpp"
 
+class GateMaskGenerator;
+
 namespace ENCRYPTO::ObliviousTransfer {
 class OTProviderManager;
+class XCOTBitBatch;
 }
 
 namespace MOTION {
@@ -70,6 +77,12 @@ namespace proto::beavy {
 
 enum class OutputRecipient : std::uint8_t { garbler, evaluator, both };
 
+// How the parties open a value shared among all of them, e.g., the outputs for all parties.  With
+// broadcast, each party sends its share to all others, i.e., N(N-1) messages in one round.  With
+// king, the parties send their shares to a king which sends the opened value back, i.e., 2(N-1)
+// messages in two rounds.  Two parties always use broadcast.
+enum class ReconstructionPattern : std::uint8_t { broadcast, king };
+
 class BooleanBEAVYWire;
 using BooleanBEAVYWireP = std::shared_ptr<BooleanBEAVYWire>;
 using BooleanBEAVYWireVector = std::vector<BooleanBEAVYWireP>;
@@ -99,10 +112,70 @@ class BEAVYProvider : public GateFactory,
   std::size_t get_my_id() const noexcept { return my_id_; }
   std::size_t get_num_parties() const noexcept { return num_parties_; }
 
-  std::size_t get_next_input_id(std::size_t num_inputs) noexcept;
+  // within a ConstructionScope, the ids are taken from the block of the calling thread
+  std::size_t get_next_input_id(std::size_t num_inputs);
+
+  // create output wires of a gate in the wire arena of the gate register
+  BooleanBEAVYWireP make_boolean_wire(std::size_t num_simd) const;
+  BooleanBEAVYWireVector make_boolean_wires(std::size_t num_wires, std::size_t num_simd) const;
 
+  // skip the setup of some tensor operations, which makes their results wrong; for a fake setup
+  // with correct results use OTBackend::fake_setup
   bool get_fake_setup() const noexcept { return fake_setup_; }
 
+  // Local randomness for the masks of the gates' output wires: the mask of output wire i of a
+  // gate is mask_generator.random_bits(gate_id, num_simd, i) (random_vector<T> for arithmetic
+  // wires), such that it can be regenerated from the gate_id instead of being kept around.
+  const GateMaskGenerator& get_mask_generator() const noexcept { return *mask_generator_; }
+
+  // message pattern of the gates opening values for all parties (set by all parties in the same
+  // way before the gates are created)
+  void set_reconstruction_pattern(ReconstructionPattern pattern) noexcept {
+    reconstruction_pattern_ = pattern;
+  }
+  ReconstructionPattern get_reconstruction_pattern() const noexcept {
+    return reconstruction_pattern_;
+  }
+
+  // Let the input owner choose the public shares of its inputs from the randomness shared with
+  // the other party, like the secret share of the other party, and set its own secret share to
+  // public share - input - other secret share.  Then the input gates send no messages at all,
+  // but their setup needs the input, and they cannot use the preprocessing store.  Needs to be
+  // set by both parties in the same way before the input gates are created.
+  void set_non_interactive_inputs(bool enable) noexcept { non_interactive_inputs_ = enable; }
+  bool get_non_interactive_inputs() const noexcept { return non_interactive_inputs_; }
+
+  // Let the AND and DOT gates share a single batch of XCOTs instead of running one OT extension
+  // round trip each.  Needs to be enabled before the gates are created, and requires
+  // an executor that evaluates the gates' setup concurrently.
+  void set_batch_ot_preprocessing(bool batch) noexcept { batch_ot_preprocessing_ = batch; }
+  bool get_batch_ot_preprocessing() const noexcept { return batch_ot_preprocessing_; }
+
+  // Let the given party, e.g., a server with a constrained client, do the heavy part of the OT
+  // extension: it is the receiver of all OTs of the products of two shares in the AND, DOT and
+  // MUL gates instead of the receiver of the OTs in one direction and the sender in the
+  // other.  Then the other party only expands one seed per OT extension and sends the short
+  // sender messages instead of the corrections of 128 bits per OT.  nullopt splits the work
+  // evenly (set by both parties in the same way before the gates are created).
+  void set_strong_party(std::optional<std::size_t> party_id) noexcept { strong_party_ = party_id; }
+  std::optional<std::size_t> get_strong_party() const noexcept { return strong_party_; }
+
+  // Replace the additively shared ArithmeticBEAVY wires among the inputs, e.g., the outputs of
+  // the HAM and MULNI gates, by wires holding their masked values (see
+  // ArithmeticBEAVYReconstructGate).  The wires which have not been reconstructed before are
+  // reconstructed by a single gate per bit size, all other wires are returned unchanged.  The
+  // gates which need masked inputs call this, so that chains of ADD, NEG and MULNI gates stay
+  // local until the first such gate.
+  std::vector<WireVector> reconstruct_additive_wires(std::vector<WireVector> inputs);
+  std::size_t reserve_batched_xcot_bits(std::size_t num_ots);
+  // reserve the batched OTs of the gates of a ConstructionScope, see XCOTBitBatch::reserve_block()
+  std::size_t reserve_batched_xcot_block(std::size_t num_ots);
+  ENCRYPTO::BitVector<> compute_batched_xcot_bits(std::size_t offset,
+                                                  const ENCRYPTO::BitVector<>& choices,
+                                                  const ENCRYPTO::BitVector<>& correlations);
+  // register the batched OTs, needs to be called before the OT extension setup
+  void register_batched_ots();
+
   // Implementation of GateFactors interface
 
   // Boolean inputs
@@ -153,6 +226,58 @@ class BEAVYProvider : public GateFactory,
   WireVector make_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector&,
                               const WireVector&) override;
 
+  // AND of all inputs, which have the same number of wires, in one online round for up to
+  // BooleanBEAVYANDnGate::max_num_inputs BEAVY inputs and a tree of those gates for more
+  WireVector make_multi_and_gate(const std::vector<WireVector>& inputs);
+
+  // inner products of the text with each of the patterns, which have the same number of wires, in
+  // one BooleanBEAVYMatrixDOTGate, i.e., one wire per pattern
+  WireVector make_matrix_dot_gate(const WireVector& text, const std::vector<WireVector>& patterns);
+
+  // OR of all SIMD values of each wire, i.e., a single SIMD value per wire, as a tree of 4-input
+  // ANDs of the inverted values in ceil(log_4(#SIMD values)) rounds
+  WireVector make_or_reduction_gate(const WireVector&);
+
+  // prefix ORs over the SIMD values of each wire, i.e., SIMD value i of the output is the OR of the
+  // input values 0, ..., i, with 4-input ANDs of shifted values in ceil(log_4(#SIMD values)) rounds
+  WireVector make_prefix_or_gate(const WireVector&);
+
+  // Positions of the first k set SIMD values of a single wire, e.g., the first k matches of a
+  // pattern, without revealing the others: the output has bit_width(#SIMD values) wires, least
+  // significant bit first, and k SIMD values, where value r is j + 1 if the r-th set value is
+  // number j, and 0 if less than r values are set.  Each position needs one prefix OR, the first
+  // set value and its position are derived locally, such that k * ceil(log_4(#SIMD values))
+  // rounds are needed.
+  WireVector make_first_positions_gate(const WireVector&, std::size_t k);
+
+  // Hamming distances between the pattern and every window of the text of the same length, both
+  // given bit plane by bit plane, i.e., wire b holds bit b of all characters, in one
+  // BooleanBEAVYWindowHAMGate.  The output is a single additively shared arithmetic wire of
+  // 64 bit values with a SIMD value per window.
+  WireVector make_window_hamming_gate(const WireVector& text, const WireVector& pattern);
+
+  // Whether the additively shared values of a single arithmetic wire, e.g., the output of COUNT
+  // or HAM, or its masked values are at most the threshold, in one ArithmeticBEAVYLEQEXPGate.
+  // The values need to be below bound (at most 2^16), which is rounded up to a power of two for
+  // the size of the one-hot encoding.  Only party 0 needs to know the threshold.
+  WireVector make_threshold_gate(const WireVector&, std::size_t bound, std::uint64_t threshold);
+
+  // Values of a concatenation of arithmetic wires of the same bit size, value j of the single
+  // output wire is input value sources[j], in one local ArithmeticBEAVYLaneMapGate
+  WireVector make_arithmetic_lane_map_gate(const WireVector& in,
+                                           std::vector<std::size_t>&& sources);
+
+  // Share a large contiguous input, e.g., a table in a memory mapped file, with a single gate
+  // instead of input gates with a promise per group of values, see
+  // ArithmeticBEAVYBulkInputGateSender.  The output has a wire per chunk of chunk_size values,
+  // where the last one may be shorter.  The input is read in the online phase, so the buffer needs
+  // to outlive the evaluation.
+  template <typename T>
+  WireVector make_arithmetic_bulk_input_gate_my(std::span<const T> input, std::size_t chunk_size);
+  template <typename T>
+  WireVector make_arithmetic_bulk_input_gate_other(std::size_t input_owner, std::size_t num_values,
+                                                   std::size_t chunk_size);
+
   std::pair<NewGateP, WireVector> construct_unary_gate(ENCRYPTO::PrimitiveOperationType op,
                                                        const WireVector&);
 
@@ -164,12 +289,16 @@ class BEAVYProvider : public GateFactory,
 
   // implementation of TensorOpFactory
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, tensor::TensorCP>
-  make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions&) override;
+  make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions&,
+                                     std::size_t fractional_bits = 0) override;
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-  make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions&) override;
+  make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions&,
+                                     std::size_t fractional_bits = 0) override;
 
-  tensor::TensorCP make_arithmetic_32_tensor_input_other(const tensor::TensorDimensions&) override;
-  tensor::TensorCP make_arithmetic_64_tensor_input_other(const tensor::TensorDimensions&) override;
+  tensor::TensorCP make_arithmetic_32_tensor_input_other(const tensor::TensorDimensions&,
+                                                         std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_arithmetic_64_tensor_input_other(const tensor::TensorDimensions&,
+                                                         std::size_t fractional_bits = 0) override;
 
   // arithmetic outputs
   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint32_t>> make_arithmetic_32_tensor_output_my(
@@ -192,8 +321,26 @@ class BEAVYProvider : public GateFactory,
                                        const tensor::TensorCP input_A,
                                        const tensor::TensorCP input_B,
                                        std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_tensor_sparse_gemm_op(const tensor::GemmOp& gemm_op,
+                                              const tensor::TensorCP input_A,
+                                              const CSRMatrix<std::uint64_t>& weights,
+                                              std::size_t weights_owner,
+                                              std::size_t weights_fractional_bits,
+                                              std::size_t fractional_bits = 0) override;
   tensor::TensorCP make_tensor_sqr_op(const tensor::TensorCP input,
                                       std::size_t fractional_bits = 0) override;
+  // Fused linear layer and square activation as in CryptoNets: the square of the convolution or
+  // product is evaluated by the gate of the linear layer, see BEAVYTensorFusedSquare.  Both steps
+  // truncate fractional_bits bits.
+  tensor::TensorCP make_tensor_conv2d_sqr_op(const tensor::Conv2DOp& conv_op,
+                                             const tensor::TensorCP input,
+                                             const tensor::TensorCP kernel,
+                                             const tensor::TensorCP bias,
+                                             std::size_t fractional_bits = 0);
+  tensor::TensorCP make_tensor_gemm_sqr_op(const tensor::GemmOp& gemm_op,
+                                           const tensor::TensorCP input_A,
+                                           const tensor::TensorCP input_B,
+                                           std::size_t fractional_bits = 0);
   tensor::TensorCP make_tensor_relu_op(const tensor::TensorCP) override;
   template <typename T>
   tensor::TensorCP basic_make_tensor_relu_op(const tensor::TensorCP, const tensor::TensorCP);
@@ -202,11 +349,25 @@ class BEAVYProvider : public GateFactory,
                                           const tensor::TensorCP) override;
   tensor::TensorCP make_tensor_avgpool_op(const tensor::AveragePoolOp&, const tensor::TensorCP,
                                           std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_tensor_truncation_op(const tensor::TensorCP input,
+                                             std::size_t truncate_bits) override;
+  tensor::TensorCP make_tensor_ring_reduction(const tensor::TensorCP input,
+                                              std::size_t bit_size) override;
   template <typename T>
   tensor::TensorCP basic_make_convert_boolean_to_arithmetic_beavy_tensor(const tensor::TensorCP);
   tensor::TensorCP make_convert_boolean_to_arithmetic_beavy_tensor(const tensor::TensorCP);
 
  private:
+  tensor::TensorCP basic_make_tensor_conv2d_op(const tensor::Conv2DOp& conv_op,
+                                               const tensor::TensorCP input,
+                                               const tensor::TensorCP kernel,
+                                               const tensor::TensorCP bias,
+                                               std::size_t fractional_bits, bool fuse_square);
+  tensor::TensorCP basic_make_tensor_gemm_op(const tensor::GemmOp& gemm_op,
+                                             const tensor::TensorCP input_A,
+                                             const tensor::TensorCP input_B,
+                                             std::size_t fractional_bits, bool fuse_square);
+
   enum class mixed_gate_mode_t { arithmetic, boolean, plain };
   template <typename T>
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, WireVector>
@@ -223,10 +384,17 @@ class BEAVYProvider : public GateFactory,
   WireVector make_count_gate(const WireVector& in_a);
   WireVector make_xor_gate(const WireVector& in_a, const WireVector& in_b);
   WireVector make_and_gate(const WireVector& in_a, const WireVector& in_b);
-  WireVector make_and4_gate(const WireVector& in_a, const WireVector& in_b);
   WireVector make_msg_gate(const WireVector& in_a, const WireVector& in_b);
   WireVector make_eqexp_gate(const WireVector& in_a, const WireVector& in_b);
+  WireVector make_gt_gate(const WireVector& in_a, const WireVector& in_b);
+  template <std::size_t bit_size>
+  WireVector basic_make_gt_gate(const WireVector& in_a, const WireVector& in_b);
+  WireVector make_eq_gate(const WireVector& in_a, const WireVector& in_b);
   WireVector make_dot_gate(const WireVector& in_a, const WireVector& in_b);
+  // see BooleanBEAVYLaneMapGate
+  WireVector make_lane_map_gate(const WireVector& in, std::size_t num_wires,
+                                std::vector<std::vector<std::size_t>>&& sources,
+                                ENCRYPTO::BitVector<>&& constants);
   template <typename BinaryGate, bool plain = false>
   std::pair<NewGateP, WireVector> construct_boolean_binary_gate(const WireVector& in_a,
                                                                 const WireVector& in_b);
@@ -237,14 +405,23 @@ class BEAVYProvider : public GateFactory,
                                                      const WireVector& in_b);
   std::pair<NewGateP, WireVector> construct_and_gate(const WireVector& in_a,
                                                      const WireVector& in_b);
-  std::pair<NewGateP, WireVector> construct_and4_gate(const WireVector& in_a,
-                                                     const WireVector& in_b);
   std::pair<NewGateP, WireVector> construct_msg_gate(const WireVector& in_a,
                                                      const WireVector& in_b);
   std::pair<NewGateP, WireVector> construct_dot_gate(const WireVector& in_a,
                                                      const WireVector& in_b);
   template <typename T>
   std::pair<NewGateP, WireVector> construct_count_gate(const WireVector& in_a);
+  template <typename T>
+  WireVector basic_make_arithmetic_hamming_gate(const NewWireP& in_a, std::size_t group_size);
+  template <typename T>
+  WireVector basic_make_window_distance_gate(const NewWireP& text, const NewWireP& pattern);
+  template <typename T>
+  WireVector basic_make_arithmetic_lane_map_gate(const WireVector& in,
+                                                 std::vector<std::size_t>&& sources);
+  template <typename T>
+  void basic_reconstruct_additive_wires(std::vector<WireVector>& inputs);
+  // created on first use
+  ENCRYPTO::ObliviousTransfer::XCOTBitBatch& get_xcot_batch();
 
   template <template <typename> class BinaryGate, typename T>
   WireVector make_arithmetic_unary_gate(const NewWireP& in_a);
@@ -279,9 +456,26 @@ class BEAVYProvider : public GateFactory,
   std::pair<NewGateP, WireVector>
   external_make_convert_bit_to_arithmetic_beavy_gate(BooleanBEAVYWireP in_a);
 
+  // converts every bit of the wires to a ring element with a single gate, one output wire per
+  // input wire (see BooleanBitsToArithmeticBEAVYGate)
+  template <typename T>
+  WireVector basic_make_convert_bits_to_arithmetic_beavy_gate(BooleanBEAVYWireVector&& in_a);
+
+  template <typename T>
+  std::pair<NewGateP, WireVector>
+  external_make_convert_bits_to_arithmetic_beavy_gate(BooleanBEAVYWireVector&& in_a);
+
   template <typename BinaryGate, bool plain = false>
   std::pair<NewGateP, WireVector> external_make_beavy_dot_gate(BooleanBEAVYWireP in_a, BooleanBEAVYWireP in_b);
 
+  // Hamming distance of each group of group_size consecutive 0/1 values of an arithmetic wire,
+  // computed without converting to Boolean shares (see BEAVYAHAMGate).
+  WireVector make_arithmetic_hamming_gate(const WireVector& in_a, std::size_t group_size);
+  // Squared distances between the pattern and every window of the text of the same length, both
+  // arithmetic wires with a character per SIMD value, in one ArithmeticBEAVYWindowDistanceGate,
+  // i.e., an additively shared wire with a SIMD value per window which is 0 for the matches.
+  WireVector make_window_distance_gate(const WireVector& text, const WireVector& pattern);
+
  private:
   WireVector make_convert_to_boolean_gmw_gate(BooleanBEAVYWireVector&& in_a);
   BooleanBEAVYWireVector make_convert_from_boolean_gmw_gate(const WireVector& in);
@@ -300,9 +494,11 @@ class BEAVYProvider : public GateFactory,
   // tensor stuff
   template <typename T>
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, tensor::TensorCP>
-  basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&);
+  basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&,
+                                        std::size_t fractional_bits);
   template <typename T>
-  tensor::TensorCP basic_make_arithmetic_tensor_input_other(const tensor::TensorDimensions&);
+  tensor::TensorCP basic_make_arithmetic_tensor_input_other(const tensor::TensorDimensions&,
+                                                            std::size_t fractional_bits);
   template <typename T>
   ENCRYPTO::ReusableFiberFuture<IntegerValues<T>> basic_make_arithmetic_tensor_output_my(
       const tensor::TensorCP&);
@@ -319,6 +515,15 @@ class BEAVYProvider : public GateFactory,
   std::size_t next_input_id_;
   std::shared_ptr<Logger> logger_;
   bool fake_setup_;
+  bool batch_ot_preprocessing_ = false;
+  bool non_interactive_inputs_ = false;
+  std::optional<std::size_t> strong_party_;
+  ReconstructionPattern reconstruction_pattern_ = ReconstructionPattern::broadcast;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitBatch> xcot_batch_;
+  std::unique_ptr<GateMaskGenerator> mask_generator_;
+  // additively shared wire -> reconstructed wire
+  std::unordered_map<const NewWire*, NewWireP> reconstructed_wires_;
+  std::mutex reconstructed_wires_mutex_;
 };
 
 }  // namespace proto::beavy
@@ -35,6 +35,72 @@
 
 namespace MOTION::proto::beavy {
 
+namespace {
+
+// Arithmetic shares [s] of the bits s = s_0 ^ s_1 = s_0 + s_1 - 2 s_0 s_1 of the secret shares of
+// all wires, which are computed with one ACOT per bit where party 0 is the sender.
+template <typename T>
+std::vector<T> arithmetize_secret_shares(
+    ENCRYPTO::ObliviousTransfer::ACOTSender<T>* ot_sender,
+    ENCRYPTO::ObliviousTransfer::ACOTReceiver<T>* ot_receiver,
+    const BooleanBEAVYWireVector& inputs, std::size_t num_simd) {
+  const auto num_wires = inputs.size();
+  std::vector<T> ot_output;
+  if (ot_sender != nullptr) {
+    std::vector<T> correlations(num_wires * num_simd);
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& wire_in = inputs[wire_i];
+      wire_in->wait_setup();
+      const auto& secret_share = wire_in->get_secret_share();
+      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+        if (secret_share.Get(simd_j)) {
+          correlations[wire_i * num_simd + simd_j] = 1;
+        }
+      }
+    }
+    ot_sender->SetCorrelations(std::move(correlations));
+    ot_sender->SendMessages();
+    ot_sender->ComputeOutputs();
+    ot_output = ot_sender->GetOutputs();
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& secret_share = inputs[wire_i]->get_secret_share();
+      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+        T bit = secret_share.Get(simd_j);
+        ot_output[wire_i * num_simd + simd_j] = bit + 2 * ot_output[wire_i * num_simd + simd_j];
+      }
+    }
+  } else {
+    assert(ot_receiver != nullptr);
+    ENCRYPTO::BitVector<> choices;
+    choices.Reserve(Helpers::Convert::BitsToBytes(num_wires * num_simd));
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& wire_in = inputs[wire_i];
+      wire_in->wait_setup();
+      choices.Append(wire_in->get_secret_share());
+    }
+    ot_receiver->SetChoices(std::move(choices));
+    ot_receiver->SendCorrections();
+    ot_receiver->ComputeOutputs();
+    ot_output = ot_receiver->GetOutputs();
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& secret_share = inputs[wire_i]->get_secret_share();
+      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+        T bit = secret_share.Get(simd_j);
+        ot_output[wire_i * num_simd + simd_j] = bit - 2 * ot_output[wire_i * num_simd + simd_j];
+      }
+    }
+  }
+  return ot_output;
+}
+
+// all ones if bit j of the data is set, otherwise zero
+template <typename T>
+T bit_mask(const std::byte* data, std::size_t j) {
+  return T(0) - T((std::to_integer<unsigned>(data[j / 8]) >> (j % 8)) & 1);
+}
+
+}  // namespace
+
 template <typename T>
 BooleanBitToArithmeticBEAVYGate<T>::BooleanBitToArithmeticBEAVYGate(std::size_t gate_id,
                                                                     BEAVYProvider& beavy_provider,
@@ -172,6 +238,136 @@ template class BooleanBitToArithmeticBEAVYGate<std::uint16_t>;
 template class BooleanBitToArithmeticBEAVYGate<std::uint32_t>;
 template class BooleanBitToArithmeticBEAVYGate<std::uint64_t>;
 
+template <typename T>
+BooleanBitsToArithmeticBEAVYGate<T>::BooleanBitsToArithmeticBEAVYGate(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, BooleanBEAVYWireVector&& in)
+    : NewGate(gate_id), inputs_(std::move(in)), beavy_provider_(beavy_provider) {
+  const auto num_wires = inputs_.size();
+  const auto num_simd = inputs_.at(0)->get_num_simd();
+  outputs_.reserve(num_wires);
+  std::generate_n(std::back_inserter(outputs_), num_wires, [num_simd] {
+    return std::make_shared<beavy::ArithmeticBEAVYWire<T>>(num_simd);
+  });
+  const auto my_id = beavy_provider_.get_my_id();
+  auto& ot_provider = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
+  if (my_id == 0) {
+    ot_sender_ = ot_provider.RegisterSendACOT<T>(num_wires * num_simd);
+  } else {
+    assert(my_id == 1);
+    ot_receiver_ = ot_provider.RegisterReceiveACOT<T>(num_wires * num_simd);
+  }
+  share_future_ =
+      beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, num_wires * num_simd);
+}
+
+template <typename T>
+BooleanBitsToArithmeticBEAVYGate<T>::~BooleanBitsToArithmeticBEAVYGate() = default;
+
+template <typename T>
+void BooleanBitsToArithmeticBEAVYGate<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: BooleanBitsToArithmeticBEAVYGate<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto num_wires = inputs_.size();
+  const auto num_simd = inputs_[0]->get_num_simd();
+  for (auto& wire_out : outputs_) {
+    wire_out->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+    wire_out->set_setup_ready();
+  }
+
+  // x = p ^ s = p + (1 - 2 p) s, where p is added by one of the parties
+  share_if_zero_ =
+      arithmetize_secret_shares(ot_sender_.get(), ot_receiver_.get(), inputs_, num_simd);
+  share_difference_.resize(num_wires * num_simd);
+  const T p_share = beavy_provider_.is_my_job(gate_id_);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& delta = outputs_[wire_i]->get_secret_share();
+    T* s = share_if_zero_.data() + wire_i * num_simd;
+    T* diff = share_difference_.data() + wire_i * num_simd;
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      diff[simd_j] = p_share - 2 * s[simd_j];
+      s[simd_j] += delta[simd_j];
+    }
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: BooleanBitsToArithmeticBEAVYGate<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void BooleanBitsToArithmeticBEAVYGate<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: BooleanBitsToArithmeticBEAVYGate<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  const auto num_wires = inputs_.size();
+  const auto num_simd = inputs_[0]->get_num_simd();
+  const auto my_id = beavy_provider_.get_my_id();
+  auto tmp = std::move(share_if_zero_);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& wire_in = inputs_[wire_i];
+    wire_in->wait_online();
+    const auto* public_share = wire_in->get_public_share().GetData().data();
+    T* t = tmp.data() + wire_i * num_simd;
+    const T* diff = share_difference_.data() + wire_i * num_simd;
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      t[simd_j] += bit_mask<T>(public_share, simd_j) & diff[simd_j];
+    }
+  }
+  beavy_provider_.send_ints_message(1 - my_id, gate_id_, tmp);
+  const auto other_share = share_future_.get();
+  std::transform(std::begin(tmp), std::end(tmp), std::begin(other_share), std::begin(tmp),
+                 std::plus{});
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    auto& wire_out = outputs_[wire_i];
+    wire_out->get_public_share().assign(std::begin(tmp) + wire_i * num_simd,
+                                        std::begin(tmp) + (wire_i + 1) * num_simd);
+    wire_out->set_online_ready();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: BooleanBitsToArithmeticBEAVYGate<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+std::optional<GateCost> BooleanBitsToArithmeticBEAVYGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_ots = inputs_.size() * inputs_[0]->get_num_simd();
+  // one ACOT per bit where party 0 is the sender, and one value per bit is exchanged online
+  const auto setup_bits = beavy_provider_.get_my_id() == 0
+                              ? GateCost::cot_sender_bits(num_ots, bit_size)
+                              : GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = num_ots * sizeof(T),
+                  .num_ots_ = num_ots,
+                  .online_rounds_ = 1};
+}
+
+template class BooleanBitsToArithmeticBEAVYGate<std::uint8_t>;
+template class BooleanBitsToArithmeticBEAVYGate<std::uint16_t>;
+template class BooleanBitsToArithmeticBEAVYGate<std::uint32_t>;
+template class BooleanBitsToArithmeticBEAVYGate<std::uint64_t>;
+
 template <typename T>
 BooleanToArithmeticBEAVYGate<T>::BooleanToArithmeticBEAVYGate(std::size_t gate_id,
                                                               BEAVYProvider& beavy_provider,
@@ -213,52 +409,19 @@ void BooleanToArithmeticBEAVYGate<T>::evaluate_setup() {
   output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
   output_->set_setup_ready();
 
-  std::vector<T> ot_output;
-  if (ot_sender_ != nullptr) {
-    std::vector<T> correlations(num_wires * num_simd);
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      const auto& wire_in = inputs_[wire_i];
-      wire_in->wait_setup();
-      const auto& secret_share = wire_in->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        if (secret_share.Get(simd_j)) {
-          correlations[wire_i * num_simd + simd_j] = 1;
-        }
-      }
-    }
-    ot_sender_->SetCorrelations(std::move(correlations));
-    ot_sender_->SendMessages();
-    ot_sender_->ComputeOutputs();
-    ot_output = ot_sender_->GetOutputs();
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      const auto& secret_share = inputs_[wire_i]->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        T bit = secret_share.Get(simd_j);
-        ot_output[wire_i * num_simd + simd_j] = bit + 2 * ot_output[wire_i * num_simd + simd_j];
-      }
-    }
-  } else {
-    assert(ot_receiver_ != nullptr);
-    ENCRYPTO::BitVector<> choices;
-    choices.Reserve(Helpers::Convert::BitsToBytes(num_wires * num_simd));
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      const auto& wire_in = inputs_[wire_i];
-      wire_in->wait_setup();
-      choices.Append(wire_in->get_secret_share());
-    }
-    ot_receiver_->SetChoices(std::move(choices));
-    ot_receiver_->SendCorrections();
-    ot_receiver_->ComputeOutputs();
-    ot_output = ot_receiver_->GetOutputs();
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      const auto& secret_share = inputs_[wire_i]->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        T bit = secret_share.Get(simd_j);
-        ot_output[wire_i * num_simd + simd_j] = bit - 2 * ot_output[wire_i * num_simd + simd_j];
-      }
+  // x = sum_i (p_i ^ s_i) 2^i = sum_i (p_i + (1 - 2 p_i) s_i) 2^i, where the p_i are added by one
+  // of the parties.  Everything but the terms of the p_i set to 1 is summed up here.
+  share_difference_ =
+      arithmetize_secret_shares(ot_sender_.get(), ot_receiver_.get(), inputs_, num_simd);
+  share_if_zero_ = output_->get_secret_share();
+  const T p_share = beavy_provider_.is_my_job(gate_id_);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    T* diff = share_difference_.data() + wire_i * num_simd;
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      share_if_zero_[simd_j] += T(diff[simd_j] << wire_i);
+      diff[simd_j] = T(T(p_share - 2 * diff[simd_j]) << wire_i);
     }
   }
-  arithmetized_secret_share_ = std::move(ot_output);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -282,35 +445,15 @@ void BooleanToArithmeticBEAVYGate<T>::evaluate_online() {
   const auto num_wires = ENCRYPTO::bit_size_v<T>;
   const auto num_simd = output_->get_num_simd();
   const auto my_id = beavy_provider_.get_my_id();
-  std::vector<T> arithmetized_public_share(num_wires * num_simd);
 
+  auto tmp = std::move(share_if_zero_);
   for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
     const auto& wire_in = inputs_[wire_i];
     wire_in->wait_online();
-    const auto& public_share = wire_in->get_public_share();
+    const auto* public_share = wire_in->get_public_share().GetData().data();
+    const T* diff = share_difference_.data() + wire_i * num_simd;
     for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-      if (public_share.Get(simd_j)) {
-        arithmetized_public_share[wire_i * num_simd + simd_j] = 1;
-      }
-    }
-  }
-
-  auto tmp = output_->get_secret_share();
-  if (beavy_provider_.is_my_job(gate_id_)) {
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        const auto p = arithmetized_public_share[wire_i * num_simd + simd_j];
-        const auto s = arithmetized_secret_share_[wire_i * num_simd + simd_j];
-        tmp[simd_j] += (p + (1 - 2 * p) * s) << wire_i;
-      }
-    }
-  } else {
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        const auto p = arithmetized_public_share[wire_i * num_simd + simd_j];
-        const auto s = arithmetized_secret_share_[wire_i * num_simd + simd_j];
-        tmp[simd_j] += ((1 - 2 * p) * s) << wire_i;
-      }
+      tmp[simd_j] += bit_mask<T>(public_share, simd_j) & diff[simd_j];
     }
   }
   beavy_provider_.send_ints_message(1 - my_id, gate_id_, tmp);
@@ -389,9 +532,7 @@ BooleanGMWToBEAVYGate::BooleanGMWToBEAVYGate(std::size_t gate_id, BEAVYProvider&
   const auto num_wires = inputs_.size();
   const auto num_simd = inputs_.at(0)->get_num_simd();
   const auto my_id = beavy_provider_.get_my_id();
-  outputs_.reserve(num_wires);
-  std::generate_n(std::back_inserter(outputs_), num_wires,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+  outputs_ = beavy_provider_.make_boolean_wires(num_wires, num_simd);
   share_future_ =
       beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_wires * num_simd);
 }
@@ -476,7 +617,12 @@ void ArithmeticBEAVYToGMWGate<T>::evaluate_online() {
     }
   }
 
-  if (beavy_provider_.is_my_job(gate_id_)) {
+  if (input_->is_additively_shared()) {
+    // the public share already is this party's GMW share
+    input_->wait_online();
+    output_->get_share() = input_->get_public_share();
+    output_->set_online_ready();
+  } else if (beavy_provider_.is_my_job(gate_id_)) {
     input_->wait_setup();
     input_->wait_online();
     const auto& pshare = input_->get_public_share();
@@ -512,9 +658,10 @@ ArithmeticGMWToBEAVYGate<T>::ArithmeticGMWToBEAVYGate(std::size_t gate_id,
                                                       gmw::ArithmeticGMWWireP<T> in)
     : NewGate(gate_id), beavy_provider_(beavy_provider), input_(std::move(in)) {
   const auto num_simd = input_->get_num_simd();
-  const auto my_id = beavy_provider_.get_my_id();
   output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_simd);
-  share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, num_simd);
+  // the GMW share is reinterpreted as additive share, the masked value is only reconstructed if a
+  // later gate needs it
+  output_->set_additively_shared();
 }
 
 template <typename T>
@@ -550,16 +697,8 @@ void ArithmeticGMWToBEAVYGate<T>::evaluate_online() {
     }
   }
 
-  const auto my_id = beavy_provider_.get_my_id();
   input_->wait_online();
-  auto my_share = input_->get_share();
-  std::transform(std::begin(my_share), std::end(my_share), std::begin(output_->get_secret_share()),
-                 std::begin(my_share), std::plus{});
-  beavy_provider_.send_ints_message(1 - my_id, gate_id_, my_share);
-  const auto other_share = share_future_.get();
-  std::transform(std::begin(my_share), std::end(my_share), std::begin(other_share),
-                 std::begin(my_share), std::plus{});
-  output_->get_public_share() = std::move(my_share);
+  output_->get_public_share() = input_->get_share();
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -81,6 +81,40 @@ class BooleanBitToArithmeticBEAVYGate : public NewGate {
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
+// Converts every bit of several Boolean wires to a ring element, i.e., one arithmetic wire per
+// Boolean wire.  All bits share one ACOT request and one message, whereas a
+// BooleanBitToArithmeticBEAVYGate per wire needs one of each per wire.
+template <typename T>
+class BooleanBitsToArithmeticBEAVYGate : public NewGate {
+ public:
+  BooleanBitsToArithmeticBEAVYGate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWireVector&&);
+  ~BooleanBitsToArithmeticBEAVYGate();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
+  beavy::ArithmeticBEAVYWireVector<T>& get_output_wires() noexcept { return outputs_; };
+
+ private:
+  using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
+  beavy::BooleanBEAVYWireVector inputs_;
+  beavy::ArithmeticBEAVYWireVector<T> outputs_;
+  BEAVYProvider& beavy_provider_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTSender<T>> ot_sender_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTReceiver<T>> ot_receiver_;
+  // share of the output if the public bit is 0, and the difference if it is 1
+  std::vector<T> share_if_zero_;
+  std::vector<T> share_difference_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+};
+
 template <typename T>
 class BooleanToArithmeticBEAVYGate : public NewGate {
  public:
@@ -99,7 +133,9 @@ class BooleanToArithmeticBEAVYGate : public NewGate {
   BEAVYProvider& beavy_provider_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTSender<T>> ot_sender_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTReceiver<T>> ot_receiver_;
-  std::vector<T> arithmetized_secret_share_;
+  // share of the output if all public bits are 0, and the difference of each bit if it is 1
+  std::vector<T> share_if_zero_;
+  std::vector<T> share_difference_;
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
@@ -166,7 +202,6 @@ class ArithmeticGMWToBEAVYGate : public NewGate {
   BEAVYProvider& beavy_provider_;
   gmw::ArithmeticGMWWireP<T> input_;
   ArithmeticBEAVYWireP<T> output_;
-  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
 }  // namespace MOTION::proto::beavy
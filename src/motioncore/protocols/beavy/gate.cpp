@@ -22,8 +22,13 @@
 
 #include <openssl/bn.h>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <boost/fiber/future.hpp>
+#include <cstring>
 #include <functional>
 #include <stdexcept>
+#include <type_traits>
 #include "gate.h"
 
 #include "base/gate_factory.h"
@@ -32,8 +37,18 @@
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_flavors.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "crypto/random/gate_mask_generator.h"
 #include "crypto/sharing_randomness_generator.h"
+#include "data_storage/preprocessing_store.h"
+#include "executor/execution_context.h"
+#include "protocols/common/mul_kernels.h"
+#include "protocols/common/simd_lanes.h"
+#include "protocols/plain/wire.h"
+#include "utility/bit_expression.h"
+#include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
 #include "utility/helpers.h"
+#include "utility/hot_path_log.h"
+#include "utility/linear_algebra.h"
 #include "utility/logger.h"
 #include "wire.h"
 
@@ -45,9 +60,216 @@ static std::size_t count_bits(const BooleanBEAVYWireVector& wires) {
                                [](const auto& a) { return a->get_num_simd(); });
 }
 
+// Split [0, size) into chunks whose size is a multiple of granularity, and call
+// fctn(begin, end) for each of them.  If an execution context is given, the chunks are
+// distributed with its parallel_for.  Otherwise, fctn is called once for the whole range.
+template <typename F>
+static void for_each_chunk(ExecutionContext* exec_ctx, std::size_t size, std::size_t granularity,
+                           F&& fctn) {
+  if (exec_ctx == nullptr) {
+    fctn(std::size_t(0), size);
+    return;
+  }
+  exec_ctx->parallel_for(size, granularity, std::forward<F>(fctn));
+}
+
+// Load the 64 bits of a BitVector starting at position pos into a word such that bit pos + k is
+// stored at (word >> k) & 1.  Bits past the end of the vector are zero.
+static std::uint64_t load_bit_word(const ENCRYPTO::BitVector<>& bv, std::size_t pos) {
+  const auto& data = bv.GetData();
+  const auto byte_pos = pos / 8;
+  const auto shift = pos % 8;
+  if (byte_pos >= data.size()) {
+    return 0;
+  }
+  const auto num_bytes = std::min<std::size_t>(8, data.size() - byte_pos);
+  std::uint64_t word = 0;
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(&word, data.data() + byte_pos, num_bytes);
+  } else {
+    for (std::size_t k = 0; k < num_bytes; ++k) {
+      word |= std::uint64_t(std::to_integer<std::uint8_t>(data[byte_pos + k])) << (8 * k);
+    }
+  }
+  if (shift != 0) {
+    word >>= shift;
+    if (byte_pos + 8 < data.size()) {
+      word |= std::uint64_t(std::to_integer<std::uint8_t>(data[byte_pos + 8])) << (64 - shift);
+    }
+  }
+  return word;
+}
+
+// Store the (up to) 64 bits of word at position pos, which needs to be a multiple of 8, into the
+// BitVector.  Only the first num_bits bits are written.
+static void store_bit_word(ENCRYPTO::BitVector<>& bv, std::size_t pos, std::uint64_t word,
+                           std::size_t num_bits) {
+  assert(pos % 8 == 0);
+  assert(num_bits <= 64);
+  auto& data = bv.GetMutableData();
+  const auto byte_pos = pos / 8;
+  for (std::size_t k = 0; 8 * k < num_bits; ++k) {
+    auto byte = std::uint8_t(word >> (8 * k));
+    if (num_bits - 8 * k < 8) {
+      const auto mask = std::uint8_t((1u << (num_bits - 8 * k)) - 1);
+      byte = (byte & mask) | (std::to_integer<std::uint8_t>(data[byte_pos + k]) & ~mask);
+    }
+    data[byte_pos + k] = std::byte(byte);
+  }
+}
+
+// Pass a BitVector to an interface expecting the default allocator, copies only if the allocator
+// differs.
+template <typename Allocator>
+static decltype(auto) as_default_bit_vector(const ENCRYPTO::BitVector<Allocator>& bits) {
+  if constexpr (std::is_same_v<Allocator, ENCRYPTO::std_alloc>) {
+    return (bits);
+  } else {
+    return ENCRYPTO::BitVector<>(bits);
+  }
+}
+
+// Register the XCOTs of the products of `num_ots` pairs of shared bits with the other party.  If
+// the provider has a strong party, it is the receiver of all 2 * num_ots OTs and the other party
+// the sender, otherwise each party is receiver and sender of num_ots OTs.
+static void register_xcot_bits(BEAVYProvider& beavy_provider, std::size_t num_ots,
+                               std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender>& ot_sender,
+                               std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver>& ot_receiver) {
+  const auto my_id = beavy_provider.get_my_id();
+  auto& otp = beavy_provider.get_ot_manager().get_provider(1 - my_id);
+  const auto strong_party = beavy_provider.get_strong_party();
+  if (!strong_party.has_value()) {
+    ot_sender = otp.RegisterSendXCOTBit(num_ots);
+    ot_receiver = otp.RegisterReceiveXCOTBit(num_ots);
+  } else if (*strong_party == my_id) {
+    ot_receiver = otp.RegisterReceiveXCOTBit(2 * num_ots);
+  } else {
+    ot_sender = otp.RegisterSendXCOTBit(2 * num_ots);
+  }
+}
+
+// Bits sent by this party for the OTs of the products of `num_ots` pairs of shares with messages
+// of `bit_size` bits, see register_xcot_bits().
+static std::size_t product_ots_setup_bits(const BEAVYProvider& beavy_provider,
+                                          std::size_t num_ots, std::size_t bit_size) {
+  const auto strong_party = beavy_provider.get_strong_party();
+  if (!strong_party.has_value()) {
+    return GateCost::cot_sender_bits(num_ots, bit_size) + GateCost::cot_receiver_bits(num_ots);
+  } else if (*strong_party == beavy_provider.get_my_id()) {
+    return GateCost::cot_receiver_bits(2 * num_ots);
+  }
+  return GateCost::cot_sender_bits(2 * num_ots, bit_size);
+}
+
+// Compute the xor of the XCOT outputs with the given choices (as receiver) and correlations (as
+// sender), either on the gate's own OTs or on its slice of the provider's batch.  With a strong
+// party, its choices are followed by its correlations and the other party's correlations by its
+// choices, which gives the same products.
+template <typename Allocator>
+static ENCRYPTO::BitVector<> compute_xcot_bits(
+    BEAVYProvider& beavy_provider, const std::optional<std::size_t>& xcot_batch_offset,
+    ENCRYPTO::ObliviousTransfer::XCOTBitSender* ot_sender,
+    ENCRYPTO::ObliviousTransfer::XCOTBitReceiver* ot_receiver,
+    const ENCRYPTO::BitVector<Allocator>& choices,
+    const ENCRYPTO::BitVector<Allocator>& correlations) {
+  if (xcot_batch_offset.has_value()) {
+    return beavy_provider.compute_batched_xcot_bits(
+        *xcot_batch_offset, as_default_bit_vector(choices), as_default_bit_vector(correlations));
+  }
+  const auto num_ots = choices.GetSize();
+  if (ot_sender == nullptr) {
+    auto all_choices = as_default_bit_vector(choices);
+    all_choices.Append(as_default_bit_vector(correlations));
+    ot_receiver->SetChoices(std::move(all_choices));
+    ot_receiver->SendCorrections();
+    ot_receiver->ComputeOutputs();
+    const auto& outputs = ot_receiver->GetOutputs();
+    return outputs.Subset(0, num_ots) ^ outputs.Subset(num_ots, 2 * num_ots);
+  }
+  if (ot_receiver == nullptr) {
+    auto all_correlations = as_default_bit_vector(correlations);
+    all_correlations.Append(as_default_bit_vector(choices));
+    ot_sender->SetCorrelations(std::move(all_correlations));
+    ot_sender->SendMessages();
+    ot_sender->ComputeOutputs();
+    const auto& outputs = ot_sender->GetOutputs();
+    return outputs.Subset(0, num_ots) ^ outputs.Subset(num_ots, 2 * num_ots);
+  }
+  ot_receiver->SetChoices(as_default_bit_vector(choices));
+  ot_receiver->SendCorrections();
+  ot_sender->SetCorrelations(as_default_bit_vector(correlations));
+  ot_sender->SendMessages();
+  ot_receiver->ComputeOutputs();
+  ot_sender->ComputeOutputs();
+  auto outputs = ot_sender->GetOutputs();
+  outputs ^= ot_receiver->GetOutputs();
+  return outputs;
+}
+
+// Delta_y ^= Delta_a & delta_b ^ Delta_b & delta_a, plus Delta_a & Delta_b by one of the parties,
+// in one pass over the bits of one or several wires
+template <typename E1, typename E2, typename E3, typename E4>
+static void xor_beavy_and_online(std::byte* Delta_y, const ENCRYPTO::BitExpression<E1>& Delta_a,
+                                 const ENCRYPTO::BitExpression<E2>& Delta_b,
+                                 const ENCRYPTO::BitExpression<E3>& delta_a,
+                                 const ENCRYPTO::BitExpression<E4>& delta_b, bool add_Delta_ab) {
+  if (add_Delta_ab) {
+    ENCRYPTO::xor_assign(Delta_y, (Delta_a & (delta_b ^ Delta_b)) ^ (Delta_b & delta_a));
+  } else {
+    ENCRYPTO::xor_assign(Delta_y, (Delta_a & delta_b) ^ (Delta_b & delta_a));
+  }
+}
+
+// Online phase of the BEAVY AND gates on the gate buffers, which hold the shares of the wires one
+// after another.  If the slices of the wires start at byte boundaries, the public shares of the
+// inputs are read in place through views instead of being gathered into buffers first.
+template <typename Allocator>
+static void beavy_and_online(ENCRYPTO::BitVector<Allocator>& Delta_y_share,
+                             const ENCRYPTO::BitVector<Allocator>& delta_a_share,
+                             const ENCRYPTO::BitVector<Allocator>& delta_b_share,
+                             const BooleanBEAVYWireVector& inputs_a,
+                             const BooleanBEAVYWireVector& inputs_b, bool add_Delta_ab) {
+  using ENCRYPTO::bits;
+  const auto num_wires = inputs_a.size();
+  const auto num_simd = inputs_a[0]->get_num_simd();
+  if (num_wires == 1 || num_simd % 8 == 0) {
+    const auto wire_bytes = Helpers::Convert::BitsToBytes(num_simd);
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& wire_a = inputs_a[wire_i];
+      const auto& wire_b = inputs_b[wire_i];
+      wire_a->wait_online();
+      wire_b->wait_online();
+      const auto offset = wire_i * wire_bytes;
+      xor_beavy_and_online(
+          Delta_y_share.GetMutableData().data() + offset, bits(wire_a->get_public_share()),
+          bits(wire_b->get_public_share()),
+          ENCRYPTO::BitTerminal(delta_a_share.GetData().data() + offset, num_simd),
+          ENCRYPTO::BitTerminal(delta_b_share.GetData().data() + offset, num_simd), add_Delta_ab);
+    }
+    return;
+  }
+
+  const auto num_bits = num_wires * num_simd;
+  ENCRYPTO::BitVector<> Delta_a;
+  ENCRYPTO::BitVector<> Delta_b;
+  Delta_a.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+  Delta_b.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& wire_a = inputs_a[wire_i];
+    wire_a->wait_online();
+    Delta_a.Append(wire_a->get_public_share());
+    const auto& wire_b = inputs_b[wire_i];
+    wire_b->wait_online();
+    Delta_b.Append(wire_b->get_public_share());
+  }
+  xor_beavy_and_online(Delta_y_share.GetMutableData().data(), bits(Delta_a), bits(Delta_b),
+                       bits(delta_a_share), bits(delta_b_share), add_Delta_ab);
+}
+
 namespace detail {
 
 BasicBooleanBEAVYBinaryGate::BasicBooleanBEAVYBinaryGate(std::size_t gate_id,
+                                                         const BEAVYProvider& beavy_provider,
                                                          BooleanBEAVYWireVector&& in_b,
                                                          BooleanBEAVYWireVector&& in_a)
     : NewGate(gate_id),
@@ -67,12 +289,11 @@ BasicBooleanBEAVYBinaryGate::BasicBooleanBEAVYBinaryGate(std::size_t gate_id,
       throw std::logic_error("number of SIMD values need to be the same for all wires");
     }
   }
-  outputs_.reserve(num_wires_);
-  std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+  outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
 }
 
 BasicBooleanBEAVYUnaryGate::BasicBooleanBEAVYUnaryGate(std::size_t gate_id,
+                                                       const BEAVYProvider& beavy_provider,
                                                        BooleanBEAVYWireVector&& in, bool forward)
     : NewGate(gate_id), num_wires_(in.size()), inputs_(std::move(in)) {
   if (num_wires_ == 0) {
@@ -87,9 +308,7 @@ BasicBooleanBEAVYUnaryGate::BasicBooleanBEAVYUnaryGate(std::size_t gate_id,
   if (forward) {
     outputs_ = inputs_;
   } else {
-    outputs_.reserve(num_wires_);
-    std::generate_n(std::back_inserter(outputs_), num_wires_,
-                    [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+    outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
   }
 }
 
@@ -103,10 +322,10 @@ BooleanBEAVYInputGateSender::BooleanBEAVYInputGateSender(
       num_wires_(num_wires),
       num_simd_(num_simd),
       input_id_(beavy_provider.get_next_input_id(num_wires)),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(num_wires) : 0),
       input_future_(std::move(input_future)) {
-  outputs_.reserve(num_wires_);
-  std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+  outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
 }
 
 void BooleanBEAVYInputGateSender::evaluate_setup() {
@@ -121,17 +340,33 @@ void BooleanBEAVYInputGateSender::evaluate_setup() {
   auto my_id = beavy_provider_.get_my_id();
   auto num_parties = beavy_provider_.get_num_parties();
   auto& mbp = beavy_provider_.get_motion_base_provider();
-  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    auto& wire = outputs_[wire_i];
-    wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_simd_);
-    wire->set_setup_ready();
-    wire->get_public_share() = wire->get_secret_share();
-    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
-      if (party_id == my_id) {
-        continue;
+  if (non_interactive_) {
+    const auto inputs = input_future_.get();
+    auto& rng = mbp.get_my_randomness_generator(1 - my_id);
+    for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+      auto& wire = outputs_[wire_i];
+      const auto& input_bits = inputs.at(wire_i);
+      if (input_bits.GetSize() != num_simd_) {
+        throw std::runtime_error("size of input bit vector != num_simd_");
+      }
+      wire->get_public_share() = rng.GetBits(public_input_id_ + wire_i, num_simd_);
+      wire->get_secret_share() =
+          wire->get_public_share() ^ input_bits ^ rng.GetBits(input_id_ + wire_i, num_simd_);
+      wire->set_setup_ready();
+    }
+  } else {
+    for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+      auto& wire = outputs_[wire_i];
+      wire->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_simd_);
+      wire->set_setup_ready();
+      wire->get_public_share() = wire->get_secret_share();
+      for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+        if (party_id == my_id) {
+          continue;
+        }
+        auto& rng = mbp.get_my_randomness_generator(party_id);
+        wire->get_public_share() ^= rng.GetBits(input_id_ + wire_i, num_simd_);
       }
-      auto& rng = mbp.get_my_randomness_generator(party_id);
-      wire->get_public_share() ^= rng.GetBits(input_id_ + wire_i, num_simd_);
     }
   }
 
@@ -153,6 +388,14 @@ void BooleanBEAVYInputGateSender::evaluate_online() {
     }
   }
 
+  if (non_interactive_) {
+    // the public shares have been fixed in the setup
+    for (auto& wire : outputs_) {
+      wire->set_online_ready();
+    }
+    return;
+  }
+
   // wait for input value
   const auto inputs = input_future_.get();
 
@@ -182,6 +425,31 @@ void BooleanBEAVYInputGateSender::evaluate_online() {
   }
 }
 
+void BooleanBEAVYInputGateSender::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+    writer.write_bits(wire->get_public_share());
+  }
+}
+
+void BooleanBEAVYInputGateSender::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->get_public_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> BooleanBEAVYInputGateSender::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY};
+  }
+  // the secret shares of the other parties are derived from the shared randomness
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(num_wires_ * num_simd_),
+                  .online_rounds_ = 1};
+}
+
 BooleanBEAVYInputGateReceiver::BooleanBEAVYInputGateReceiver(std::size_t gate_id,
                                                              BEAVYProvider& beavy_provider,
                                                              std::size_t num_wires,
@@ -192,12 +460,14 @@ BooleanBEAVYInputGateReceiver::BooleanBEAVYInputGateReceiver(std::size_t gate_id
       num_wires_(num_wires),
       num_simd_(num_simd),
       input_owner_(input_owner),
-      input_id_(beavy_provider.get_next_input_id(num_wires)) {
-  outputs_.reserve(num_wires_);
-  std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
-  public_share_future_ =
-      beavy_provider_.register_for_bits_message(input_owner_, gate_id_, num_wires * num_simd);
+      input_id_(beavy_provider.get_next_input_id(num_wires)),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(num_wires) : 0) {
+  outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
+  if (!non_interactive_) {
+    public_share_future_ =
+        beavy_provider_.register_for_bits_message(input_owner_, gate_id_, num_wires * num_simd);
+  }
 }
 
 void BooleanBEAVYInputGateReceiver::evaluate_setup() {
@@ -214,6 +484,9 @@ void BooleanBEAVYInputGateReceiver::evaluate_setup() {
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     auto& wire = outputs_[wire_i];
     wire->get_secret_share() = rng.GetBits(input_id_ + wire_i, num_simd_);
+    if (non_interactive_) {
+      wire->get_public_share() = rng.GetBits(public_input_id_ + wire_i, num_simd_);
+    }
     wire->set_setup_ready();
   }
 
@@ -235,6 +508,13 @@ void BooleanBEAVYInputGateReceiver::evaluate_online() {
     }
   }
 
+  if (non_interactive_) {
+    for (auto& wire : outputs_) {
+      wire->set_online_ready();
+    }
+    return;
+  }
+
   auto public_shares = public_share_future_.get();
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     auto& wire = outputs_[wire_i];
@@ -251,6 +531,26 @@ void BooleanBEAVYInputGateReceiver::evaluate_online() {
   }
 }
 
+void BooleanBEAVYInputGateReceiver::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+}
+
+void BooleanBEAVYInputGateReceiver::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> BooleanBEAVYInputGateReceiver::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY};
+  }
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY, .online_rounds_ = 1};
+}
+
 BooleanBEAVYOutputGate::BooleanBEAVYOutputGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
                                                BooleanBEAVYWireVector&& inputs,
                                                std::size_t output_owner)
@@ -261,7 +561,9 @@ BooleanBEAVYOutputGate::BooleanBEAVYOutputGate(std::size_t gate_id, BEAVYProvide
       inputs_(std::move(inputs)) {
   std::size_t my_id = beavy_provider_.get_my_id();
   auto num_bits = count_bits(inputs_);
-  if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
+  if (output_owner_ == ALL_PARTIES) {
+    reconstruction_.emplace(beavy_provider_, gate_id_, num_bits);
+  } else if (output_owner_ == my_id) {
     share_futures_ = beavy_provider_.register_for_bits_messages(gate_id_, num_bits);
   }
   my_secret_share_.Reserve(Helpers::Convert::BitsToBytes(num_bits));
@@ -277,6 +579,14 @@ BooleanBEAVYOutputGate::get_output_future() {
   }
 }
 
+std::pair<CommMixin*, std::size_t> BooleanBEAVYOutputGate::get_fusable_output_message() const {
+  // the shares are broadcast in the setup phase unless they are sent to a king or a single owner
+  if (!reconstruction_.has_value() || reconstruction_->uses_king()) {
+    return {nullptr, 0};
+  }
+  return {&beavy_provider_, count_bits(inputs_)};
+}
+
 void BooleanBEAVYOutputGate::evaluate_setup() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -291,12 +601,14 @@ void BooleanBEAVYOutputGate::evaluate_setup() {
     my_secret_share_.Append(wire->get_secret_share());
   }
   std::size_t my_id = beavy_provider_.get_my_id();
-  if (output_owner_ != my_id) {
-    if (output_owner_ == ALL_PARTIES) {
-      beavy_provider_.broadcast_bits_message(gate_id_, my_secret_share_);
-    } else {
-      beavy_provider_.send_bits_message(output_owner_, gate_id_, my_secret_share_);
+  if (output_owner_ == ALL_PARTIES) {
+    reconstruction_->send_share(my_secret_share_);
+    // the king forwards the opened secret share ahead in the setup phase as well
+    if (reconstruction_->uses_king()) {
+      receive_shares();
     }
+  } else if (output_owner_ != my_id) {
+    beavy_provider_.send_bits_message(output_owner_, gate_id_, my_secret_share_);
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -319,14 +631,7 @@ void BooleanBEAVYOutputGate::evaluate_online() {
 
   std::size_t my_id = beavy_provider_.get_my_id();
   if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
-    std::size_t num_parties = beavy_provider_.get_num_parties();
-    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
-      if (party_id == my_id) {
-        continue;
-      }
-      const auto other_share = share_futures_[party_id].get();
-      my_secret_share_ ^= other_share;
-    }
+    receive_shares();
     std::vector<ENCRYPTO::BitVector<>> outputs;
     outputs.reserve(num_wires_);
     std::size_t bit_offset = 0;
@@ -350,9 +655,61 @@ void BooleanBEAVYOutputGate::evaluate_online() {
   }
 }
 
+void BooleanBEAVYOutputGate::receive_shares() {
+  if (other_shares_received_) {
+    return;
+  }
+  if (reconstruction_) {
+    my_secret_share_ = reconstruction_->get(std::move(my_secret_share_));
+  } else {
+    std::size_t my_id = beavy_provider_.get_my_id();
+    std::size_t num_parties = beavy_provider_.get_num_parties();
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      if (party_id == my_id) {
+        continue;
+      }
+      my_secret_share_ ^= share_futures_[party_id].get();
+    }
+  }
+  other_shares_received_ = true;
+}
+
+void BooleanBEAVYOutputGate::save_setup(PreprocessingWriter& writer) {
+  std::size_t my_id = beavy_provider_.get_my_id();
+  if (output_owner_ != ALL_PARTIES && output_owner_ != my_id) {
+    return;
+  }
+  // the other parties have sent their shares during the setup phase
+  receive_shares();
+  writer.write_bits(my_secret_share_);
+}
+
+void BooleanBEAVYOutputGate::load_setup(PreprocessingRecord& record) {
+  std::size_t my_id = beavy_provider_.get_my_id();
+  if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
+    my_secret_share_ = record.read_bits();
+    other_shares_received_ = true;
+  }
+}
+
+std::optional<GateCost> BooleanBEAVYOutputGate::get_cost() const {
+  std::size_t num_bits = 0;
+  for (const auto& wire : inputs_) {
+    num_bits += wire->get_num_simd();
+  }
+  // the secret shares are sent ahead in the setup phase
+  if (reconstruction_) {
+    return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                    .setup_bytes_ = reconstruction_->get_num_bytes_sent()};
+  }
+  const bool send = output_owner_ != beavy_provider_.get_my_id();
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .setup_bytes_ = send ? Helpers::Convert::BitsToBytes(num_bits) : 0};
+}
+
 BooleanBEAVYINVGate::BooleanBEAVYINVGate(std::size_t gate_id, const BEAVYProvider& beavy_provider,
                                          BooleanBEAVYWireVector&& in)
-    : detail::BasicBooleanBEAVYUnaryGate(gate_id, std::move(in),
+    : detail::BasicBooleanBEAVYUnaryGate(gate_id, beavy_provider, std::move(in),
                                          !beavy_provider.is_my_job(gate_id)),
       is_my_job_(beavy_provider.is_my_job(gate_id)) {}
 
@@ -384,142 +741,206 @@ void BooleanBEAVYINVGate::evaluate_online() {
   }
 }
 
-template <typename T>
-BEAVYAHAMGate<T>::BEAVYAHAMGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
-                                         ArithmeticBEAVYWireP<T>&& in)
-    : NewGate(gate_id), input_(std::move(in)), beavy_provider_(beavy_provider) {
-  
-    std::size_t num_simd = input_->get_num_simd();
-    std::size_t num_ri = ENCRYPTO::bit_size_v<T>;
-    std::size_t my_id = beavy_provider_.get_my_id();
+void BooleanBEAVYINVGate::save_setup(PreprocessingWriter& writer) {
+  if (!is_my_job_) {
+    return;
+  }
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+}
+
+void BooleanBEAVYINVGate::load_setup(PreprocessingRecord& record) {
+  if (!is_my_job_) {
+    return;
+  }
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+}
 
-    bit2a_gates_.resize(num_ri);
-    arithmetic_wires_.resize(num_ri);
+std::optional<GateCost> BooleanBEAVYINVGate::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY};
+}
 
-    for (int i = 0; i < num_ri; i++) {
-      boolean_wires_.push_back(std::make_shared<BooleanBEAVYWire>(num_simd));
+BooleanBEAVYLaneMapGate::BooleanBEAVYLaneMapGate(std::size_t gate_id,
+                                                 const BEAVYProvider& beavy_provider,
+                                                 BooleanBEAVYWireVector&& in,
+                                                 std::size_t num_wires,
+                                                 std::vector<std::vector<std::size_t>>&& sources,
+                                                 ENCRYPTO::BitVector<>&& constants)
+    : NewGate(gate_id),
+      is_my_job_(beavy_provider.is_my_job(gate_id)),
+      inputs_(std::move(in)),
+      sources_(std::move(sources)),
+      constants_(std::move(constants)) {
+  if (num_wires == 0 || sources_.empty() || sources_.size() % num_wires != 0) {
+    throw std::logic_error(fmt::format(
+        "BooleanBEAVYLaneMapGate: {} output bits cannot be split into {} wires", sources_.size(),
+        num_wires));
+  }
+  if (constants_.GetSize() != sources_.size()) {
+    throw std::logic_error("BooleanBEAVYLaneMapGate: need a constant for every output bit");
+  }
+  const auto num_input_bits = count_bits(inputs_);
+  for (const auto& bit_sources : sources_) {
+    if (std::any_of(std::begin(bit_sources), std::end(bit_sources),
+                    [num_input_bits](auto bit_i) { return bit_i >= num_input_bits; })) {
+      throw std::logic_error(fmt::format(
+          "BooleanBEAVYLaneMapGate: source bit out of range of the {} input bits", num_input_bits));
     }
+  }
+  outputs_ = beavy_provider.make_boolean_wires(num_wires, sources_.size() / num_wires);
+}
 
-    beavy_arithmetic_wires_.resize(num_ri);
-    for (int i = 0; i < num_ri; i++) {
-      auto gate_wires = beavy_provider.
-      external_make_convert_bit_to_arithmetic_beavy_gate<std::uint64_t>(boolean_wires_[i]);
-      bit2a_gates_[i] = std::move(gate_wires.first);
-      arithmetic_wires_[i] = std::move(gate_wires.second);
-      assert(arithmetic_wires_[i].size() == 1); // Wire vector size should be 1.
-      auto arith_wire_p = dynamic_pointer_cast<ArithmeticBEAVYWire<T>>(arithmetic_wires_[i][0]);
-      beavy_arithmetic_wires_[i].push_back({arith_wire_p});
-      assert(beavy_arithmetic_wires_[i].size() == 1);
+ENCRYPTO::BitVector<> BooleanBEAVYLaneMapGate::map_shares(bool public_shares) const {
+  ENCRYPTO::BitVector<> input_bits;
+  input_bits.Reserve(Helpers::Convert::BitsToBytes(count_bits(inputs_)));
+  for (const auto& wire : inputs_) {
+    if (public_shares) {
+      wire->wait_online();
+      input_bits.Append(wire->get_public_share());
+    } else {
+      wire->wait_setup();
+      input_bits.Append(wire->get_secret_share());
     }
-
-    output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_simd);
-    share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_simd);
   }
+  ENCRYPTO::BitVector<> output_bits(sources_.size());
+  for (std::size_t bit_j = 0; bit_j < sources_.size(); ++bit_j) {
+    bool bit = false;
+    for (auto bit_i : sources_[bit_j]) {
+      bit ^= input_bits.Get(bit_i);
+    }
+    output_bits.Set(bit, bit_j);
+  }
+  return output_bits;
+}
 
-template <typename T>
-void BEAVYAHAMGate<T>::evaluate_setup_with_context(ExecutionContext& context) {
-  std::size_t num_simd = input_->get_num_simd();
-  std::size_t my_id = beavy_provider_.get_my_id();
-
-  // Make wires!
-  std::size_t num_ri = ENCRYPTO::bit_size_v<T>;
-  random_values_.resize(num_ri);
-  
-  for (int i = 0; i < num_ri; i++) {
-    random_values_[i] = ENCRYPTO::BitVector<>::Random(num_simd);
-    boolean_wires_[i]->get_public_share() = ENCRYPTO::BitVector<>(num_simd);
-    // TODO(pranav): Make sure that the above value is all zero bits.
-    boolean_wires_[i]->get_secret_share() = random_values_[i];
-    boolean_wires_[i]->set_setup_ready();
-    boolean_wires_[i]->set_online_ready();
+void BooleanBEAVYLaneMapGate::evaluate_setup() {
+  auto delta_share = map_shares(false);
+  if (is_my_job_) {
+    delta_share ^= constants_;
+  }
+  const auto num_simd = outputs_[0]->get_num_simd();
+  for (std::size_t wire_i = 0; wire_i < outputs_.size(); ++wire_i) {
+    auto& w_o = outputs_[wire_i];
+    w_o->get_secret_share() = delta_share.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    w_o->set_setup_ready();
   }
+}
 
-  // Run the Bit2A protocol!
-  // TODO(pranav): Change this to parallel running.
-  for (int i = 0; i < num_ri; i++) {
-    bit2a_gates_[i]->evaluate_setup();
+void BooleanBEAVYLaneMapGate::evaluate_online() {
+  const auto Delta = map_shares(true);
+  const auto num_simd = outputs_[0]->get_num_simd();
+  for (std::size_t wire_i = 0; wire_i < outputs_.size(); ++wire_i) {
+    auto& w_o = outputs_[wire_i];
+    w_o->get_public_share() = Delta.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    w_o->set_online_ready();
   }
+}
 
-  for (int i = 0; i < num_ri; i++) {
-    beavy_arithmetic_wires_[i][0]->wait_setup();
-    bit2a_gates_[i]->evaluate_online();
+void BooleanBEAVYLaneMapGate::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
   }
+}
 
-  for (int i = 0; i < num_ri; i++) {
-    beavy_arithmetic_wires_[i][0]->wait_online();
+void BooleanBEAVYLaneMapGate::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
   }
+}
 
-  
-  // for (int i = 0; i < num_ri; i++){
-  //   r->get_public_share() += (beavy_arithmetic_wires_[i][0]->get_public_share());
-  //   r->get_secret_share() += (beavy_arithmetic_wires_[i][0]->get_secret_share());
-  // }
-
-  // ENCRYPTO::BitVector<> for_other_party;
-  // for (int i = 0; i < this->num_wires_; i++) {
-  //   this->input_[i]->wait_setup();
-  //   auto tmp = (this->input_[i]->get_secret_share()) ^ random_values_[i]; // simd = num_simd;
-  //   for_other_party.Append(tmp);
-  // }
-  // beavy_provider_.send_bits_message(1 - my_id, gate_id_, for_other_party);
-  // auto other_party_share = share_future_.get();
-
-  // for (int i = 0; i < this->num_wires_; i++) {
-  //   auto myy = for_other_party.Subset(i * num_simd, (i + 1) * num_simd);
-  //   auto otherr = other_party_share.Subset(i * num_simd, (i + 1) * num_simd);
-  //   public_bits_.push_back(myy ^ otherr);
-  // }
-
-  // assert(public_bits_.size() == this->num_wires_);
-
-  output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
-  output_->set_setup_ready();
+std::optional<GateCost> BooleanBEAVYLaneMapGate::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY};
 }
 
 template <typename T>
-void BEAVYAHAMGate<T>::evaluate_online_with_context(ExecutionContext& context) {
+BEAVYAHAMGate<T>::BEAVYAHAMGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
+                                ArithmeticBEAVYWireP<T>&& in, std::size_t group_size)
+    : NewGate(gate_id),
+      input_(std::move(in)),
+      beavy_provider_(beavy_provider),
+      group_size_(group_size) {
   std::size_t num_simd = input_->get_num_simd();
-  std::size_t my_id = beavy_provider_.get_my_id();
-  std::size_t num_ri = ENCRYPTO::bit_size_v<T>;
-  this->output_->wait_setup();
-
-  // std::vector<ENCRYPTO::BitVector<>> a;
-  // for (int i = 0; i < this->num_wires_; i++) {
-  //   this->input_[i]->wait_online();
-  //   auto public_value = this->input_[i]->get_public_share();
-  //   a.push_back(public_value ^ public_bits_[i]);
-  //   #pragma omp parallel for
-  //   for (int j = 0; j < num_simd; ++j) {
-  //     uint64_t ai = a.back().Get(j);
-  //     if (my_id == 0) {
-  //       if (i == 0) {
-  //         output_->get_public_share()[j] = ai + beavy_arithmetic_wires_[i][0]
-  //         ->get_public_share()[j] - 2*ai*beavy_arithmetic_wires_[i][0]->get_public_share()[j];
-  //       } else {
-  //         output_->get_public_share()[j] += ai + beavy_arithmetic_wires_[i][0]
-  //         ->get_public_share()[j] - 2*ai*beavy_arithmetic_wires_[i][0]->get_public_share()[j];
-  //       }
-  //     }
-  //     if (i == 0) {
-  //       output_->get_public_share()[j] = beavy_arithmetic_wires_[i][0]->get_secret_share()[j] * (2*ai - 1);
-  //     } else {
-  //       output_->get_public_share()[j] += beavy_arithmetic_wires_[i][0]->get_secret_share()[j] * (2*ai - 1);
-  //     }
-  //   }
-  // }
-  output_->get_public_share() = Helpers::RandomVector<T>(num_simd);
-  // IMPORTANT: output_ public shares are set. They are different for both the parties!
-  output_->set_online_ready();
+  if (group_size_ == 0 || num_simd % group_size_ != 0) {
+    throw std::invalid_argument(fmt::format(
+        "BEAVYAHAMGate: number of SIMD values {} is not a multiple of the group size {}",
+        num_simd, group_size_));
+  }
+  output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_simd / group_size_);
+  output_->set_additively_shared();
 }
 
 template <typename T>
 void BEAVYAHAMGate<T>::evaluate_setup() {
-    throw std::logic_error("BEAVYAHAMGate::evaluate_setup() not implemented");
+  output_->get_secret_share() = beavy_provider_.get_mask_generator().random_vector<T>(
+      gate_id_, output_->get_num_simd());
+  output_->set_setup_ready();
 }
 
 template <typename T>
 void BEAVYAHAMGate<T>::evaluate_online() {
-    throw std::logic_error("BEAVYAHAMGate::evaluate_online() not implemented");
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void BEAVYAHAMGate<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void BEAVYAHAMGate<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format("Gate {}: BEAVYAHAMGate<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  bool is_party_0 = beavy_provider_.get_my_id() == 0;
+  std::size_t num_groups = output_->get_num_simd();
+  input_->wait_setup();
+  input_->wait_online();
+  const auto& Delta = input_->get_public_share();
+  const auto& delta = input_->get_secret_share();
+
+  // x = Delta - delta^0 - delta^1, so party 0 sums Delta - delta^0 and party 1 sums -delta^1,
+  // while an additively shared input is summed directly
+  const bool input_additive = input_->is_additively_shared();
+  auto& output = output_->get_public_share();
+  output.resize(num_groups);
+  for_each_chunk(exec_ctx, num_groups, 1, [&, is_party_0](auto begin, auto end) {
+    for (auto group_i = begin; group_i < end; ++group_i) {
+      const auto offset = group_i * group_size_;
+      T sum = 0;
+      if (input_additive) {
+        for (std::size_t k = offset; k < offset + group_size_; ++k) {
+          sum += Delta[k];
+        }
+      } else if (is_party_0) {
+        for (std::size_t k = offset; k < offset + group_size_; ++k) {
+          sum += Delta[k] - delta[k];
+        }
+      } else {
+        for (std::size_t k = offset; k < offset + group_size_; ++k) {
+          sum -= delta[k];
+        }
+      }
+      output[group_i] = sum;
+    }
+  });
+  // the output is additively shared, i.e., the public shares differ between the parties
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format("Gate {}: BEAVYAHAMGate<T>::evaluate_online end", gate_id_));
+    }
+  }
 }
 
 template class BEAVYAHAMGate<std::uint8_t>;
@@ -529,147 +950,603 @@ template class BEAVYAHAMGate<std::uint64_t>;
 
 template <typename T>
 BooleanBEAVYHAMGate<T>::BooleanBEAVYHAMGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
-                                         BooleanBEAVYWireVector&& in)
+                                            BooleanBEAVYWireVector&& in)
     : NewGate(gate_id), input_(std::move(in)), beavy_provider_(beavy_provider) {
-    std::size_t num_simd = input_[0]->get_num_simd();
-    this->num_wires_ = input_.size();
-    std::size_t my_id = beavy_provider_.get_my_id();
-    bit2a_gates_.resize(this->num_wires_);
-    arithmetic_wires_.resize(this->num_wires_);
-    for (int i = 0; i < this->num_wires_; i++) {
-      boolean_wires_.push_back(std::make_shared<BooleanBEAVYWire>(num_simd));
-    }
-    beavy_arithmetic_wires_.resize(this->num_wires_);
-    for (int i = 0; i < this->num_wires_; i++) {
-      auto gate_wires = beavy_provider.
-      external_make_convert_bit_to_arithmetic_beavy_gate<std::uint64_t>(boolean_wires_[i]);
-      bit2a_gates_[i] = std::move(gate_wires.first);
-      arithmetic_wires_[i] = std::move(gate_wires.second);
-      assert(arithmetic_wires_[i].size() == 1); // Wire vector size should be 1.
-      auto arith_wire_p = dynamic_pointer_cast<ArithmeticBEAVYWire<T>>(arithmetic_wires_[i][0]);
-      beavy_arithmetic_wires_[i].push_back({arith_wire_p});
-      assert(beavy_arithmetic_wires_[i].size() == 1);
-    }
+  std::size_t num_simd = input_[0]->get_num_simd();
+  num_wires_ = input_.size();
+  std::size_t my_id = beavy_provider_.get_my_id();
+  for (std::size_t i = 0; i < num_wires_; ++i) {
+    boolean_wires_.push_back(beavy_provider_.make_boolean_wire(num_simd));
+  }
+  // all random bits are converted by a single gate
+  auto [gate, arithmetic_wires] =
+      beavy_provider.external_make_convert_bits_to_arithmetic_beavy_gate<T>(
+          BooleanBEAVYWireVector(boolean_wires_));
+  bits2a_gate_ = std::move(gate);
+  beavy_arithmetic_wires_.reserve(num_wires_);
+  for (auto& wire : arithmetic_wires) {
+    auto arith_wire_p = std::dynamic_pointer_cast<ArithmeticBEAVYWire<T>>(wire);
+    assert(arith_wire_p);
+    beavy_arithmetic_wires_.push_back(std::move(arith_wire_p));
+  }
+
+  output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_simd);
+  output_->set_additively_shared();
+  share_future_ =
+      beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_wires_ * num_simd);
+}
 
-    output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_simd);
-    share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_wires_ * num_simd);
-  }
+template <typename T>
+void BooleanBEAVYHAMGate<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
 
 template <typename T>
-void BooleanBEAVYHAMGate<T>::evaluate_setup_with_context(ExecutionContext& context) {
-  std::size_t num_simd = input_[0]->get_num_simd();
-  std::size_t my_id = beavy_provider_.get_my_id();
+void BooleanBEAVYHAMGate<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
 
-  // Make wires!
+template <typename T>
+void BooleanBEAVYHAMGate<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYHAMGate<T>::evaluate_setup start", gate_id_));
+    }
+  }
 
-  random_values_.resize(this->num_wires_);
+  std::size_t num_simd = input_[0]->get_num_simd();
+  std::size_t my_id = beavy_provider_.get_my_id();
 
-  for (int i = 0; i < this->num_wires_; i++) {
+  // share random bits r_i with public share 0, and convert them to arithmetic shares
+  random_values_.resize(num_wires_);
+  for (std::size_t i = 0; i < num_wires_; ++i) {
     random_values_[i] = ENCRYPTO::BitVector<>::Random(num_simd);
     boolean_wires_[i]->get_public_share() = ENCRYPTO::BitVector<>(num_simd);
-    // TODO(pranav): Make sure that the above value is all zero bits.
     boolean_wires_[i]->get_secret_share() = random_values_[i];
     boolean_wires_[i]->set_setup_ready();
     boolean_wires_[i]->set_online_ready();
   }
+  bits2a_gate_->evaluate_setup();
+  bits2a_gate_->evaluate_online();
 
-  // Run the Bit2A protocol!
-  // TODO(pranav): Change this to parallel running.
-  for (int i = 0; i < this->num_wires_; i++) {
-    bit2a_gates_[i]->evaluate_setup();
-  }
-
-  for (int i = 0; i < this->num_wires_; i++) {
-    beavy_arithmetic_wires_[i][0]->wait_setup();
-    bit2a_gates_[i]->evaluate_online();
-  }
-
-
-  for (int i = 0; i < this->num_wires_; i++) {
-    beavy_arithmetic_wires_[i][0]->wait_online();
-  }
+  // open delta_i ^ r_i
   ENCRYPTO::BitVector<> for_other_party;
-  for (int i = 0; i < this->num_wires_; i++) {
-    this->input_[i]->wait_setup();
-    auto tmp = (this->input_[i]->get_secret_share()) ^ random_values_[i]; // simd = num_simd;
-    for_other_party.Append(tmp);
+  for_other_party.Reserve(Helpers::Convert::BitsToBytes(num_wires_ * num_simd));
+  for (std::size_t i = 0; i < num_wires_; ++i) {
+    input_[i]->wait_setup();
+    for_other_party.Append(input_[i]->get_secret_share() ^ random_values_[i]);
   }
   beavy_provider_.send_bits_message(1 - my_id, gate_id_, for_other_party);
-  auto other_party_share = share_future_.get();
+  for_other_party ^= share_future_.get();
 
-  for (int i = 0; i < this->num_wires_; i++) {
-    auto myy = for_other_party.Subset(i * num_simd, (i + 1) * num_simd);
-    auto otherr = other_party_share.Subset(i * num_simd, (i + 1) * num_simd);
-    public_bits_.push_back(myy ^ otherr);
+  public_bits_.resize(num_wires_);
+  for (std::size_t i = 0; i < num_wires_; ++i) {
+    public_bits_[i] = for_other_party.Subset(i * num_simd, (i + 1) * num_simd);
+    beavy_arithmetic_wires_[i]->wait_online();
   }
 
-  assert(public_bits_.size() == this->num_wires_);
-
-  output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+  output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(gate_id_, num_simd);
   output_->set_setup_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYHAMGate<T>::evaluate_setup end", gate_id_));
+    }
+  }
 }
 
 template <typename T>
-void BooleanBEAVYHAMGate<T>::evaluate_online_with_context(ExecutionContext& context) {
-  std::size_t num_simd = input_[0]->get_num_simd();
-  std::size_t my_id = beavy_provider_.get_my_id();
+void BooleanBEAVYHAMGate<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYHAMGate<T>::evaluate_online start", gate_id_));
+    }
+  }
 
-  this->output_->wait_setup();
-
-  std::vector<ENCRYPTO::BitVector<>> a;
-  for (int i = 0; i < this->num_wires_; i++) {
-    this->input_[i]->wait_online();
-    auto public_value = this->input_[i]->get_public_share();
-    a.push_back(public_value ^ public_bits_[i]);
-    #pragma omp parallel for
-    for (int j = 0; j < num_simd; ++j) {
-      uint64_t ai = a.back().Get(j);
-      if (my_id == 0) {
-        if (i == 0) {
-          output_->get_public_share()[j] = ai + beavy_arithmetic_wires_[i][0]
-          ->get_public_share()[j] - 2*ai*beavy_arithmetic_wires_[i][0]->get_public_share()[j];
-        } else {
-          output_->get_public_share()[j] += ai + beavy_arithmetic_wires_[i][0]
-          ->get_public_share()[j] - 2*ai*beavy_arithmetic_wires_[i][0]->get_public_share()[j];
-        }
-      }
-      if (i == 0) {
-        output_->get_public_share()[j] = beavy_arithmetic_wires_[i][0]->get_secret_share()[j] * (2*ai - 1);
-      } else {
-        output_->get_public_share()[j] += beavy_arithmetic_wires_[i][0]->get_secret_share()[j] * (2*ai - 1);
+  std::size_t num_simd = input_[0]->get_num_simd();
+  bool is_party_0 = beavy_provider_.get_my_id() == 0;
+
+  // a_i = x_i ^ r_i is public
+  std::vector<ENCRYPTO::BitVector<>> masked_inputs(num_wires_);
+  for (std::size_t i = 0; i < num_wires_; ++i) {
+    input_[i]->wait_online();
+    masked_inputs[i] = input_[i]->get_public_share() ^ public_bits_[i];
+  }
+
+  // x_i = a_i + (1 - 2 a_i) r_i, i.e., with m_i = 2 a_i - 1 and [r_i] = (R_i, r_i^0, r_i^1) we
+  // get the additive shares a_i - m_i R_i + m_i r_i^0 and m_i r_i^1 of x_i
+  auto& output = output_->get_public_share();
+  output.assign(num_simd, 0);
+  std::vector<const std::byte*> masked_planes(num_wires_);
+  std::transform(std::begin(masked_inputs), std::end(masked_inputs), std::begin(masked_planes),
+                 [](const auto& a) { return a.GetData().data(); });
+  for_each_chunk(exec_ctx, num_simd, 64, [&, is_party_0](auto begin, auto end) {
+    // the sum of the a_i is added by counting their bits
+    if (is_party_0) {
+      ENCRYPTO::AccumulateBitCounts<T>(masked_planes, begin, end, output.data());
+    }
+    for (std::size_t i = 0; i < num_wires_; ++i) {
+      const auto& R = beavy_arithmetic_wires_[i]->get_public_share();
+      const auto& r = beavy_arithmetic_wires_[i]->get_secret_share();
+      const auto& a = masked_inputs[i];
+      // begin is a multiple of 64, so we can process whole words of a
+      for (auto word_begin = begin; word_begin < end; word_begin += 64) {
+        const auto word = load_bit_word(a, word_begin);
+        const auto word_end = std::min<std::size_t>(end, word_begin + 64);
+        // all words but the last one have 64 lanes
+        with_num_lanes(word_end - word_begin, [&](auto num_lanes) {
+          for (std::size_t k = 0; k < num_lanes; ++k) {
+            const auto j = word_begin + k;
+            const T a_j = (word >> k) & 1;
+            const T m_j = 2 * a_j - 1;
+            if (is_party_0) {
+              output[j] += m_j * (r[j] - R[j]);
+            } else {
+              output[j] += m_j * r[j];
+            }
+          }
+        });
       }
     }
+  });
+  // the output is additively shared, i.e., the public shares differ between the parties
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYHAMGate<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class BooleanBEAVYHAMGate<std::uint8_t>;
+template class BooleanBEAVYHAMGate<std::uint16_t>;
+template class BooleanBEAVYHAMGate<std::uint32_t>;
+template class BooleanBEAVYHAMGate<std::uint64_t>;
+
+template <typename T>
+static ArithmeticBEAVYWireVector<T> cast_arithmetic_wires(const WireVector& wires) {
+  ArithmeticBEAVYWireVector<T> result;
+  result.reserve(wires.size());
+  for (const auto& wire : wires) {
+    auto arith_wire_p = std::dynamic_pointer_cast<ArithmeticBEAVYWire<T>>(wire);
+    assert(arith_wire_p);
+    result.push_back(std::move(arith_wire_p));
+  }
+  return result;
+}
+
+// The public or the secret shares of all wires one after another.
+template <typename T>
+static std::vector<T> concat_arithmetic_shares(const ArithmeticBEAVYWireVector<T>& wires,
+                                               bool public_shares) {
+  std::vector<T> shares;
+  shares.reserve(wires.size() * wires.at(0)->get_num_simd());
+  for (const auto& wire : wires) {
+    const auto& share = public_shares ? wire->get_public_share() : wire->get_secret_share();
+    shares.insert(std::end(shares), std::begin(share), std::end(share));
+  }
+  return shares;
+}
+
+template <typename T>
+BooleanBEAVYWindowHAMGate<T>::BooleanBEAVYWindowHAMGate(std::size_t gate_id,
+                                                        BEAVYProvider& beavy_provider,
+                                                        BooleanBEAVYWindowView&& windows,
+                                                        BooleanBEAVYWireVector&& pattern)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      windows_(std::move(windows)),
+      pattern_(std::move(pattern)) {
+  const auto num_planes = windows_.get_bits_per_character();
+  const auto text_size = windows_.get_text_size();
+  const auto window_size = windows_.window_size_;
+  if (num_planes == 0 || pattern_.size() != num_planes) {
+    throw std::logic_error(
+        "BooleanBEAVYWindowHAMGate: text and pattern differ in bits per character");
+  }
+  if (window_size == 0 || window_size > text_size) {
+    throw std::logic_error("BooleanBEAVYWindowHAMGate: window does not fit into the text");
+  }
+  for (const auto& wire : windows_.text_) {
+    if (wire->get_num_simd() != text_size) {
+      throw std::logic_error("BooleanBEAVYWindowHAMGate: text planes differ in length");
+    }
+  }
+  for (const auto& wire : pattern_) {
+    if (wire->get_num_simd() != window_size) {
+      throw std::logic_error("BooleanBEAVYWindowHAMGate: pattern does not match the window size");
+    }
+  }
+  const auto num_windows = windows_.get_num_windows();
+  conv_op_ = {.kernel_shape_ = {1, num_planes, 1, window_size},
+              .input_shape_ = {num_planes, 1, text_size},
+              .output_shape_ = {1, 1, num_windows},
+              .dilations_ = {1, 1},
+              .pads_ = {0, 0, 0, 0},
+              .strides_ = {1, 1}};
+  assert(conv_op_.verify());
+
+  // all bits of the text and all bits of the pattern are converted by one gate each
+  auto [text_gate, text_wires] =
+      beavy_provider_.external_make_convert_bits_to_arithmetic_beavy_gate<T>(
+          BooleanBEAVYWireVector(windows_.text_));
+  text_bits2a_gate_ = std::move(text_gate);
+  arithmetic_text_ = cast_arithmetic_wires<T>(text_wires);
+  auto [pattern_gate, pattern_wires] =
+      beavy_provider_.external_make_convert_bits_to_arithmetic_beavy_gate<T>(
+          BooleanBEAVYWireVector(pattern_));
+  pattern_bits2a_gate_ = std::move(pattern_gate);
+  arithmetic_pattern_ = cast_arithmetic_wires<T>(pattern_wires);
+
+  if (!beavy_provider_.get_fake_setup()) {
+    auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - beavy_provider_.get_my_id());
+    conv_input_side_ = ap.template register_convolution_input_side<T>(conv_op_);
+    conv_kernel_side_ = ap.template register_convolution_kernel_side<T>(conv_op_);
+  }
+  output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_windows);
+  output_->set_additively_shared();
+}
+
+template <typename T>
+BooleanBEAVYWindowHAMGate<T>::~BooleanBEAVYWindowHAMGate() = default;
+
+template <typename T>
+void BooleanBEAVYWindowHAMGate<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYWindowHAMGate<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto num_windows = windows_.get_num_windows();
+  text_bits2a_gate_->evaluate_setup();
+  pattern_bits2a_gate_->evaluate_setup();
+  for (const auto& wire : arithmetic_text_) {
+    wire->wait_setup();
+  }
+  for (const auto& wire : arithmetic_pattern_) {
+    wire->wait_setup();
+  }
+  const auto delta_t_share = concat_arithmetic_shares(arithmetic_text_, false);
+  const auto delta_P_share = concat_arithmetic_shares(arithmetic_pattern_, false);
+
+  if (!beavy_provider_.get_fake_setup()) {
+    conv_input_side_->set_input(delta_t_share);
+    conv_kernel_side_->set_input(delta_P_share);
+  }
+  // [delta_tP]_i = [delta_t]_i * [delta_P]_i
+  delta_tP_share_.resize(num_windows);
+  convolution(conv_op_, delta_t_share.data(), delta_P_share.data(), delta_tP_share_.data());
+
+  std::vector<T> delta_tP_share1;
+  std::vector<T> delta_tP_share2;
+  if (beavy_provider_.get_fake_setup()) {
+    delta_tP_share1 = Helpers::RandomVector<T>(num_windows);
+    delta_tP_share2 = Helpers::RandomVector<T>(num_windows);
+  } else {
+    conv_input_side_->compute_output();
+    conv_kernel_side_->compute_output();
+    // [[delta_t]_i * [delta_P]_(1-i)]_i
+    delta_tP_share1 = conv_input_side_->get_output();
+    // [[delta_P]_i * [delta_t]_(1-i)]_i
+    delta_tP_share2 = conv_kernel_side_->get_output();
+    conv_input_side_->clear();
+    conv_kernel_side_->clear();
+  }
+  std::transform(std::begin(delta_tP_share_), std::end(delta_tP_share_),
+                 std::begin(delta_tP_share1), std::begin(delta_tP_share_), std::plus{});
+  std::transform(std::begin(delta_tP_share_), std::end(delta_tP_share_),
+                 std::begin(delta_tP_share2), std::begin(delta_tP_share_), std::plus{});
+
+  output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(gate_id_, num_windows);
+  output_->set_setup_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYWindowHAMGate<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void BooleanBEAVYWindowHAMGate<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYWindowHAMGate<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  const auto num_windows = windows_.get_num_windows();
+  const bool is_my_job = beavy_provider_.is_my_job(gate_id_);
+  text_bits2a_gate_->evaluate_online();
+  pattern_bits2a_gate_->evaluate_online();
+  for (const auto& wire : arithmetic_text_) {
+    wire->wait_online();
+  }
+  for (const auto& wire : arithmetic_pattern_) {
+    wire->wait_online();
+  }
+  const auto Delta_t = concat_arithmetic_shares(arithmetic_text_, true);
+  const auto delta_t_share = concat_arithmetic_shares(arithmetic_text_, false);
+  const auto Delta_P = concat_arithmetic_shares(arithmetic_pattern_, true);
+  const auto delta_P_share = concat_arithmetic_shares(arithmetic_pattern_, false);
+
+  // With t = Delta_t - delta_t and P = Delta_P - delta_P, the sum over a window of
+  // t + P - 2 t P = Delta_t (1 - 2 Delta_P + 2 delta_P) + delta_t (2 Delta_P - 1)
+  //                 + Delta_P - delta_P - 2 delta_t delta_P
+  // is split into the kernels applied to Delta_t and [delta_t]_i, and a constant.
+  std::vector<T> Delta_kernel(delta_P_share.size());
+  std::vector<T> delta_kernel(delta_P_share.size());
+  T constant = 0;
+  for (std::size_t j = 0; j < delta_P_share.size(); ++j) {
+    Delta_kernel[j] = 2 * delta_P_share[j];
+    delta_kernel[j] = 2 * Delta_P[j] - 1;
+    constant -= delta_P_share[j];
+    if (is_my_job) {
+      Delta_kernel[j] += 1 - 2 * Delta_P[j];
+      constant += Delta_P[j];
+    }
   }
-  // IMPORTANT: output_ public shares are set. They are different for both the parties!
+
+  auto& output = output_->get_public_share();
+  output.resize(num_windows);
+  std::vector<T> tmp(num_windows);
+  convolution(conv_op_, Delta_t.data(), Delta_kernel.data(), output.data());
+  convolution(conv_op_, delta_t_share.data(), delta_kernel.data(), tmp.data());
+  for (std::size_t s = 0; s < num_windows; ++s) {
+    output[s] += tmp[s] + constant - 2 * delta_tP_share_[s];
+  }
+  // the output is additively shared, i.e., the public shares differ between the parties
   output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYWindowHAMGate<T>::evaluate_online end", gate_id_));
+    }
+  }
 }
 
+template class BooleanBEAVYWindowHAMGate<std::uint8_t>;
+template class BooleanBEAVYWindowHAMGate<std::uint16_t>;
+template class BooleanBEAVYWindowHAMGate<std::uint32_t>;
+template class BooleanBEAVYWindowHAMGate<std::uint64_t>;
+
 template <typename T>
-void BooleanBEAVYHAMGate<T>::evaluate_setup() {
-    throw std::logic_error("BooleanBEAVYHAMGate::evaluate_setup() not implemented");
+ArithmeticBEAVYWindowDistanceGate<T>::ArithmeticBEAVYWindowDistanceGate(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, ArithmeticBEAVYWireP<T>&& text,
+    ArithmeticBEAVYWireP<T>&& pattern)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      text_(std::move(text)),
+      pattern_(std::move(pattern)) {
+  const auto text_size = text_->get_num_simd();
+  const auto window_size = pattern_->get_num_simd();
+  if (window_size == 0 || window_size > text_size) {
+    throw std::logic_error("ArithmeticBEAVYWindowDistanceGate: pattern does not fit into the text");
+  }
+  if (text_->is_additively_shared() || pattern_->is_additively_shared()) {
+    throw std::logic_error(
+        "ArithmeticBEAVYWindowDistanceGate needs reconstructed inputs, see "
+        "BEAVYProvider::reconstruct_additive_wires()");
+  }
+  num_windows_ = text_size - window_size + 1;
+  conv_op_ = {.kernel_shape_ = {1, 1, 1, window_size},
+              .input_shape_ = {1, 1, text_size},
+              .output_shape_ = {1, 1, num_windows_},
+              .dilations_ = {1, 1},
+              .pads_ = {0, 0, 0, 0},
+              .strides_ = {1, 1}};
+  assert(conv_op_.verify());
+
+  const auto my_id = beavy_provider_.get_my_id();
+  auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
+  // the squares of the text and the pattern share one batch
+  if (my_id == 0) {
+    mult_sender_ = ap.template register_integer_multiplication_send<T>(text_size + window_size);
+  } else {
+    mult_receiver_ =
+        ap.template register_integer_multiplication_receive<T>(text_size + window_size);
+  }
+  if (!beavy_provider_.get_fake_setup()) {
+    conv_input_side_ = ap.template register_convolution_input_side<T>(conv_op_);
+    conv_kernel_side_ = ap.template register_convolution_kernel_side<T>(conv_op_);
+  }
+  output_ = std::make_shared<ArithmeticBEAVYWire<T>>(num_windows_);
+  output_->set_additively_shared();
 }
 
 template <typename T>
-void BooleanBEAVYHAMGate<T>::evaluate_online() {
-    throw std::logic_error("BooleanBEAVYHAMGate::evaluate_online() not implemented");
+ArithmeticBEAVYWindowDistanceGate<T>::~ArithmeticBEAVYWindowDistanceGate() = default;
+
+template <typename T>
+void ArithmeticBEAVYWindowDistanceGate<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYWindowDistanceGate<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto text_size = text_->get_num_simd();
+  const auto window_size = pattern_->get_num_simd();
+  text_->wait_setup();
+  pattern_->wait_setup();
+  const auto& delta_t_share = text_->get_secret_share();
+  const auto& delta_P_share = pattern_->get_secret_share();
+
+  std::vector<T> delta_share;
+  delta_share.reserve(text_size + window_size);
+  delta_share.insert(std::end(delta_share), std::begin(delta_t_share), std::end(delta_t_share));
+  delta_share.insert(std::end(delta_share), std::begin(delta_P_share), std::end(delta_P_share));
+  if (mult_sender_) {
+    mult_sender_->set_inputs(delta_share);
+  } else {
+    mult_receiver_->set_inputs(delta_share);
+  }
+  if (!beavy_provider_.get_fake_setup()) {
+    conv_input_side_->set_input(delta_t_share);
+    conv_kernel_side_->set_input(delta_P_share);
+  }
+
+  // [delta_tP]_i = [delta_t]_i * [delta_P]_i
+  delta_tP_share_.resize(num_windows_);
+  cross_correlation(delta_t_share.data(), text_size, delta_P_share.data(), window_size,
+                    delta_tP_share_.data());
+
+  // [[delta]_i * [delta]_(1-i)]_i
+  std::vector<T> delta_cross_share;
+  if (mult_sender_) {
+    mult_sender_->compute_outputs();
+    delta_cross_share = mult_sender_->get_outputs();
+  } else {
+    mult_receiver_->compute_outputs();
+    delta_cross_share = mult_receiver_->get_outputs();
+  }
+  // [delta^2]_i = [delta]_i^2 + 2 [[delta]_i * [delta]_(1-i)]_i
+  using U = proto::detail::mul_t<T>;
+  delta_squares_share_.resize(text_size + window_size);
+  for (std::size_t j = 0; j < delta_share.size(); ++j) {
+    delta_squares_share_[j] =
+        T(U(delta_share[j]) * U(delta_share[j]) + U(2) * U(delta_cross_share[j]));
+  }
+
+  std::vector<T> delta_tP_share1;
+  std::vector<T> delta_tP_share2;
+  if (beavy_provider_.get_fake_setup()) {
+    delta_tP_share1 = Helpers::RandomVector<T>(num_windows_);
+    delta_tP_share2 = Helpers::RandomVector<T>(num_windows_);
+  } else {
+    conv_input_side_->compute_output();
+    conv_kernel_side_->compute_output();
+    // [[delta_t]_i * [delta_P]_(1-i)]_i
+    delta_tP_share1 = conv_input_side_->get_output();
+    // [[delta_P]_i * [delta_t]_(1-i)]_i
+    delta_tP_share2 = conv_kernel_side_->get_output();
+    conv_input_side_->clear();
+    conv_kernel_side_->clear();
+  }
+  for (std::size_t s = 0; s < num_windows_; ++s) {
+    delta_tP_share_[s] += delta_tP_share1[s] + delta_tP_share2[s];
+  }
+
+  output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(gate_id_, num_windows_);
+  output_->set_setup_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYWindowDistanceGate<T>::evaluate_setup end", gate_id_));
+    }
+  }
 }
 
-template class BooleanBEAVYHAMGate<std::uint8_t>;
-template class BooleanBEAVYHAMGate<std::uint16_t>;
-template class BooleanBEAVYHAMGate<std::uint32_t>;
-template class BooleanBEAVYHAMGate<std::uint64_t>;
+template <typename T>
+void ArithmeticBEAVYWindowDistanceGate<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYWindowDistanceGate<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  const auto text_size = text_->get_num_simd();
+  const auto window_size = pattern_->get_num_simd();
+  const bool is_my_job = beavy_provider_.is_my_job(gate_id_);
+  text_->wait_online();
+  pattern_->wait_online();
+  const auto& Delta_t = text_->get_public_share();
+  const auto& delta_t_share = text_->get_secret_share();
+  const auto& Delta_P = pattern_->get_public_share();
+  const auto& delta_P_share = pattern_->get_secret_share();
+
+  // [x^2]_i = Delta_x^2 - 2 Delta_x [delta_x]_i + [delta_x^2]_i, with Delta_x^2 by one party
+  using U = proto::detail::mul_t<T>;
+  auto square_share = [this, is_my_job](U Delta, U delta_share, std::size_t j) -> T {
+    U square = U(delta_squares_share_[j]) - U(2) * Delta * delta_share;
+    if (is_my_job) {
+      square += Delta * Delta;
+    }
+    return T(square);
+  };
+  // prefix sums of the squares of the text, and the sum of the squares of the pattern
+  std::vector<T> text_square_sums(text_size + 1, 0);
+  for (std::size_t c = 0; c < text_size; ++c) {
+    text_square_sums[c + 1] = text_square_sums[c] + square_share(Delta_t[c], delta_t_share[c], c);
+  }
+  T pattern_square_sum = 0;
+  for (std::size_t p = 0; p < window_size; ++p) {
+    pattern_square_sum += square_share(Delta_P[p], delta_P_share[p], text_size + p);
+  }
+
+  // [sum_p t_(s+p) P_p]_i = Delta_t * (Delta_P - [delta_P]_i) - [delta_t]_i * Delta_P
+  //                         + [delta_tP]_i, where Delta_t * Delta_P is computed by one party
+  std::vector<T> Delta_kernel(window_size);
+  for (std::size_t p = 0; p < window_size; ++p) {
+    Delta_kernel[p] = (is_my_job ? Delta_P[p] : T(0)) - delta_P_share[p];
+  }
+  auto& output = output_->get_public_share();
+  output.resize(num_windows_);
+  std::vector<T> tmp(num_windows_);
+  cross_correlation(Delta_t.data(), text_size, Delta_kernel.data(), window_size, output.data());
+  cross_correlation(delta_t_share.data(), text_size, Delta_P.data(), window_size, tmp.data());
+  for (std::size_t s = 0; s < num_windows_; ++s) {
+    const T tP = output[s] - tmp[s] + delta_tP_share_[s];
+    output[s] = T(text_square_sums[s + window_size] - text_square_sums[s] + pattern_square_sum -
+                  U(2) * tP);
+  }
+  // the output is additively shared, i.e., the public shares differ between the parties
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYWindowDistanceGate<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticBEAVYWindowDistanceGate<std::uint8_t>;
+template class ArithmeticBEAVYWindowDistanceGate<std::uint16_t>;
+template class ArithmeticBEAVYWindowDistanceGate<std::uint32_t>;
+template class ArithmeticBEAVYWindowDistanceGate<std::uint64_t>;
 
 template <typename T>
 BooleanBEAVYCOUNTGate<T>::BooleanBEAVYCOUNTGate(std::size_t gate_id,
-                                                              BEAVYProvider& beavy_provider,
-                                                              BooleanBEAVYWireVector&& in)
+                                                BEAVYProvider& beavy_provider,
+                                                BooleanBEAVYWireVector&& in)
     : NewGate(gate_id), inputs_(std::move(in)), beavy_provider_(beavy_provider) {
   const auto num_wires = inputs_.size();
-  // if (num_wires != ENCRYPTO::bit_size_v<T>) {
-  //   throw std::logic_error("number of wires need to be equal to bit size of T");
-  // }
   const auto num_simd = inputs_.at(0)->get_num_simd();
+  if (std::any_of(std::begin(inputs_), std::end(inputs_),
+                  [num_simd](const auto& wire) { return wire->get_num_simd() != num_simd; })) {
+    throw std::logic_error("number of SIMD values need to be the same for all wires");
+  }
   output_ = std::make_shared<beavy::ArithmeticBEAVYWire<T>>(num_simd);
+  output_->set_additively_shared();
   const auto my_id = beavy_provider_.get_my_id();
   auto& ot_provider = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
   if (my_id == 0) {
@@ -678,9 +1555,6 @@ BooleanBEAVYCOUNTGate<T>::BooleanBEAVYCOUNTGate(std::size_t gate_id,
     assert(my_id == 1);
     ot_receiver_ = ot_provider.RegisterReceiveACOT<T>(num_wires * num_simd);
   }
-  share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, num_simd);
-  
-
 }
 
 template <typename T>
@@ -695,11 +1569,12 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_setup() {
           fmt::format("Gate {}: BooleanBEAVYCOUNTGate<T>::evaluate_setup start", gate_id_));
     }
   }
-  std::cout<< "count setup" << std::endl;
+  hot_log("BooleanBEAVYCOUNTGate::evaluate_setup", {{"gate_id", gate_id_}});
   const auto num_wires = inputs_.size();
   const auto num_simd = output_->get_num_simd();
 
-  output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+  output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(gate_id_, num_simd);
   output_->set_setup_ready();
 
   std::vector<T> ot_output;
@@ -709,11 +1584,11 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_setup() {
       const auto& wire_in = inputs_[wire_i];
       wire_in->wait_setup();
       const auto& secret_share = wire_in->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        if (secret_share.Get(simd_j)) {
-          correlations[wire_i * num_simd + simd_j] = 1;
+      with_num_lanes(num_simd, [&](auto num_lanes) {
+        for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+          correlations[wire_i * num_lanes + simd_j] = secret_share.Get(simd_j);
         }
-      }
+      });
     }
     ot_sender_->SetCorrelations(std::move(correlations));
     ot_sender_->SendMessages();
@@ -721,10 +1596,13 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_setup() {
     ot_output = ot_sender_->GetOutputs();
     for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
       const auto& secret_share = inputs_[wire_i]->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        T bit = secret_share.Get(simd_j);
-        ot_output[wire_i * num_simd + simd_j] = bit + 2 * ot_output[wire_i * num_simd + simd_j];
-      }
+      with_num_lanes(num_simd, [&](auto num_lanes) {
+        auto* ot_output_i = ot_output.data() + wire_i * num_lanes;
+        for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+          T bit = secret_share.Get(simd_j);
+          ot_output_i[simd_j] = bit + 2 * ot_output_i[simd_j];
+        }
+      });
     }
   } else {
     assert(ot_receiver_ != nullptr);
@@ -741,13 +1619,16 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_setup() {
     ot_output = ot_receiver_->GetOutputs();
     for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
       const auto& secret_share = inputs_[wire_i]->get_secret_share();
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        T bit = secret_share.Get(simd_j);
-        ot_output[wire_i * num_simd + simd_j] = bit - 2 * ot_output[wire_i * num_simd + simd_j];
-      }
+      with_num_lanes(num_simd, [&](auto num_lanes) {
+        auto* ot_output_i = ot_output.data() + wire_i * num_lanes;
+        for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+          T bit = secret_share.Get(simd_j);
+          ot_output_i[simd_j] = bit - 2 * ot_output_i[simd_j];
+        }
+      });
     }
   }
-  std::cout<<"wefwefd"<<std::endl;
+  hot_log("BooleanBEAVYCOUNTGate::evaluate_setup OTs received", {{"gate_id", gate_id_}});
   arithmetized_secret_share_ = std::move(ot_output);
   
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -761,6 +1642,26 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_setup() {
 
 template <typename T>
 void BooleanBEAVYCOUNTGate<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void BooleanBEAVYCOUNTGate<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+// acc[j] += (1 - 2 p_j) * s[j] for the bits p_j of word, i.e., s[j] is negated where p_j is set
+template <typename T>
+static void accumulate_signed_values(T* __restrict acc, const T* __restrict s, std::uint64_t word,
+                                     std::size_t num_values) {
+  for (std::size_t j = 0; j < num_values; ++j) {
+    const T negate = T(0) - T((word >> j) & 1);
+    acc[j] += T((s[j] ^ negate) - negate);
+  }
+}
+
+template <typename T>
+void BooleanBEAVYCOUNTGate<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -768,48 +1669,39 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_online() {
           fmt::format("Gate {}: BooleanBEAVYCOUNTGate<T>::evaluate_online start", gate_id_));
     }
   }
-  std::cout<< "count online" << std::endl;
+  hot_log("BooleanBEAVYCOUNTGate::evaluate_online", {{"gate_id", gate_id_}});
   const auto num_wires = inputs_.size();
   const auto num_simd = output_->get_num_simd();
-  const auto my_id = beavy_provider_.get_my_id();
-  std::vector<T> arithmetized_public_share(num_wires * num_simd);
+  const bool is_my_job = beavy_provider_.is_my_job(gate_id_);
 
+  std::vector<const std::byte*> public_planes(num_wires);
   for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-    const auto& wire_in = inputs_[wire_i];
-    wire_in->wait_online();
-    const auto& public_share = wire_in->get_public_share();
-    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-      if (public_share.Get(simd_j)) {
-        arithmetized_public_share[wire_i * num_simd + simd_j] = 1;
-      }
-    }
+    inputs_[wire_i]->wait_online();
+    public_planes[wire_i] = inputs_[wire_i]->get_public_share().GetData().data();
   }
 
-  auto tmp = output_->get_secret_share();
-  if (beavy_provider_.is_my_job(gate_id_)) {
-    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        const auto p = arithmetized_public_share[wire_i * num_simd + simd_j];
-        const auto s = arithmetized_secret_share_[wire_i * num_simd + simd_j];
-        tmp[simd_j] += (p + (1 - 2 * p) * s);
-      }
+  // [count_j] = sum_i (1 - 2 p_ij) [s_ij], plus the number of set public bits sum_i p_ij by one
+  // of the parties, where all counters of a word of public bits are updated at once
+  auto& output = output_->get_public_share();
+  output.assign(num_simd, 0);
+  for_each_chunk(exec_ctx, num_simd, 64, [&, is_my_job](auto begin, auto end) {
+    if (is_my_job) {
+      ENCRYPTO::AccumulateBitCounts<T>(public_planes, begin, end, output.data());
     }
-  } else {
     for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-      for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-        const auto p = arithmetized_public_share[wire_i * num_simd + simd_j];
-        const auto s = arithmetized_secret_share_[wire_i * num_simd + simd_j];
-        tmp[simd_j] += ((1 - 2 * p) * s);
+      const auto& public_share = inputs_[wire_i]->get_public_share();
+      const T* s = arithmetized_secret_share_.data() + wire_i * num_simd;
+      // begin is a multiple of 64, so we can process whole words of the public share
+      for (auto word_begin = begin; word_begin < end; word_begin += 64) {
+        accumulate_signed_values(output.data() + word_begin, s + word_begin,
+                                 load_bit_word(public_share, word_begin),
+                                 std::min<std::size_t>(end - word_begin, 64));
       }
     }
-  }
-  beavy_provider_.send_ints_message(1 - my_id, gate_id_, tmp);
-  const auto other_share = share_future_.get();
-  std::transform(std::begin(tmp), std::end(tmp), std::begin(other_share), std::begin(tmp),
-                 std::plus{});
-  output_->get_public_share() = std::move(tmp);
+  });
+  // the output is additively shared, i.e., the public shares differ between the parties
   output_->set_online_ready();
-  
+
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -819,15 +1711,29 @@ void BooleanBEAVYCOUNTGate<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+std::optional<GateCost> BooleanBEAVYCOUNTGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_ots = count_bits(inputs_);
+  // one ACOT per bit where party 0 is the sender, the online phase is local
+  const auto setup_bits = beavy_provider_.get_my_id() == 0
+                              ? GateCost::cot_sender_bits(num_ots, bit_size)
+                              : GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .num_ots_ = num_ots};
+}
+
 template class BooleanBEAVYCOUNTGate<std::uint8_t>;
 template class BooleanBEAVYCOUNTGate<std::uint16_t>;
 template class BooleanBEAVYCOUNTGate<std::uint32_t>;
 template class BooleanBEAVYCOUNTGate<std::uint64_t>;
 
-BooleanBEAVYXORGate::BooleanBEAVYXORGate(std::size_t gate_id, BEAVYProvider&,
+BooleanBEAVYXORGate::BooleanBEAVYXORGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
                                          BooleanBEAVYWireVector&& in_a,
                                          BooleanBEAVYWireVector&& in_b)
-    : detail::BasicBooleanBEAVYBinaryGate(gate_id, std::move(in_a), std::move(in_b)) {}
+    : detail::BasicBooleanBEAVYBinaryGate(gate_id, beavy_provider, std::move(in_a),
+                                          std::move(in_b)) {}
 
 void BooleanBEAVYXORGate::evaluate_setup() {
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
@@ -853,24 +1759,54 @@ void BooleanBEAVYXORGate::evaluate_online() {
   }
 }
 
+void BooleanBEAVYXORGate::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+}
+
+void BooleanBEAVYXORGate::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> BooleanBEAVYXORGate::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY};
+}
+
 BooleanBEAVYANDGate::BooleanBEAVYANDGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
                                          BooleanBEAVYWireVector&& in_a,
                                          BooleanBEAVYWireVector&& in_b)
-    : detail::BasicBooleanBEAVYBinaryGate(gate_id, std::move(in_a), std::move(in_b)),
+    : detail::BasicBooleanBEAVYBinaryGate(gate_id, beavy_provider, std::move(in_a),
+                                          std::move(in_b)),
       beavy_provider_(beavy_provider),
       ot_sender_(nullptr),
       ot_receiver_(nullptr) {
   auto num_bits = count_bits(inputs_a_);
   auto my_id = beavy_provider_.get_my_id();
   share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_bits);
-  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
-  ot_sender_ = otp.RegisterSendXCOTBit(num_bits);
-  ot_receiver_ = otp.RegisterReceiveXCOTBit(num_bits);
+  if (beavy_provider_.get_batch_ot_preprocessing()) {
+    xcot_batch_offset_ = beavy_provider_.reserve_batched_xcot_bits(num_bits);
+  } else {
+    register_xcot_bits(beavy_provider_, num_bits, ot_sender_, ot_receiver_);
+  }
 }
 
 BooleanBEAVYANDGate::~BooleanBEAVYANDGate() = default;
 
-void BooleanBEAVYANDGate::evaluate_setup() {
+std::pair<CommMixin*, std::size_t> BooleanBEAVYANDGate::get_fusable_online_message() const {
+  return {&beavy_provider_, count_bits(inputs_a_)};
+}
+
+void BooleanBEAVYANDGate::evaluate_setup() { evaluate_setup_impl(nullptr); }
+
+void BooleanBEAVYANDGate::evaluate_setup_with_context(ExecutionContext& exec_ctx) {
+  evaluate_setup_impl(&exec_ctx);
+}
+
+void BooleanBEAVYANDGate::evaluate_setup_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -878,14 +1814,24 @@ void BooleanBEAVYANDGate::evaluate_setup() {
     }
   }
 
-  for (auto& wire_o : outputs_) {
-    wire_o->get_secret_share() = ENCRYPTO::BitVector<>::Random(wire_o->get_num_simd());
+  const auto& mask_generator = beavy_provider_.get_mask_generator();
+  for (std::size_t wire_i = 0; wire_i < outputs_.size(); ++wire_i) {
+    auto& wire_o = outputs_[wire_i];
+    wire_o->get_secret_share() =
+        mask_generator.random_bits(gate_id_, wire_o->get_num_simd(), wire_i);
     wire_o->set_setup_ready();
   }
 
   auto num_simd = inputs_a_[0]->get_num_simd();
-  std::cout<< "num_simd: " << num_simd << std::endl;
+  hot_log("BooleanBEAVYANDGate::evaluate_setup",
+          {{"gate_id", gate_id_}, {"num_simd", num_simd}});
   auto num_bytes = Helpers::Convert::BitsToBytes(num_wires_ * num_simd); // what is this?
+  if (exec_ctx != nullptr && exec_ctx->arena_ != nullptr) {
+    const ENCRYPTO::arena_alloc allocator(exec_ctx->arena_);
+    delta_a_share_ = ENCRYPTO::BitVector<ENCRYPTO::arena_alloc>(allocator);
+    delta_b_share_ = ENCRYPTO::BitVector<ENCRYPTO::arena_alloc>(allocator);
+    Delta_y_share_ = ENCRYPTO::BitVector<ENCRYPTO::arena_alloc>(allocator);
+  }
   delta_a_share_.Reserve(num_bytes);
   delta_b_share_.Reserve(num_bytes);
   Delta_y_share_.Reserve(num_bytes);
@@ -903,14 +1849,8 @@ void BooleanBEAVYANDGate::evaluate_setup() {
 
   auto delta_ab_share = delta_a_share_ & delta_b_share_;
 
-  ot_receiver_->SetChoices(delta_a_share_);
-  ot_receiver_->SendCorrections();
-  ot_sender_->SetCorrelations(delta_b_share_);
-  ot_sender_->SendMessages();
-  ot_receiver_->ComputeOutputs();
-  ot_sender_->ComputeOutputs();
-  delta_ab_share ^= ot_sender_->GetOutputs();
-  delta_ab_share ^= ot_receiver_->GetOutputs();
+  delta_ab_share ^= compute_xcot_bits(beavy_provider_, xcot_batch_offset_, ot_sender_.get(),
+                                      ot_receiver_.get(), delta_a_share_, delta_b_share_);
   Delta_y_share_ ^= delta_ab_share;
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -923,135 +1863,227 @@ void BooleanBEAVYANDGate::evaluate_setup() {
 
 void BooleanBEAVYANDGate::evaluate_online() {
   auto num_simd = inputs_a_[0]->get_num_simd();
-  auto num_bits = num_wires_ * num_simd;
-  ENCRYPTO::BitVector<> Delta_a;
-  ENCRYPTO::BitVector<> Delta_b;
-  Delta_a.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-  Delta_b.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+  beavy_and_online(Delta_y_share_, delta_a_share_, delta_b_share_, inputs_a_, inputs_b_,
+                   beavy_provider_.is_my_job(gate_id_));
 
+  beavy_provider_.broadcast_bits_message(gate_id_, as_default_bit_vector(Delta_y_share_));
+  Delta_y_share_ ^= share_future_.get();
+
+  // distribute data among wires
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    const auto& wire_a = inputs_a_[wire_i];
-    wire_a->wait_online();
-    Delta_a.Append(wire_a->get_public_share());
-    const auto& wire_b = inputs_b_[wire_i];
-    wire_b->wait_online();
-    Delta_b.Append(wire_b->get_public_share());
+    auto& wire_o = outputs_[wire_i];
+    wire_o->get_public_share() = ENCRYPTO::BitSpan(Delta_y_share_)
+                                     .Subset<ENCRYPTO::BitVector<>>(wire_i * num_simd,
+                                                                    (wire_i + 1) * num_simd);
+    wire_o->set_online_ready();
   }
+}
 
-  Delta_y_share_ ^= (Delta_a & delta_b_share_);
-  Delta_y_share_ ^= (Delta_b & delta_a_share_);
+void BooleanBEAVYANDGate::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+  writer.write_bits(delta_a_share_);
+  writer.write_bits(delta_b_share_);
+  writer.write_bits(Delta_y_share_);
+}
 
-  if (beavy_provider_.is_my_job(gate_id_)) {
-    Delta_y_share_ ^= (Delta_a & Delta_b);
+void BooleanBEAVYANDGate::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
   }
+  delta_a_share_ = record.read_bits();
+  delta_b_share_ = record.read_bits();
+  Delta_y_share_ = record.read_bits();
+}
 
-  beavy_provider_.broadcast_bits_message(gate_id_, Delta_y_share_);
-  Delta_y_share_ ^= share_future_.get();
+std::optional<GateCost> BooleanBEAVYANDGate::get_cost() const {
+  const auto num_bits = num_wires_ * inputs_a_[0]->get_num_simd();
+  // one XCOT of a bit in each direction per AND, only [Delta_y] is broadcast online
+  const auto setup_bits = product_ots_setup_bits(beavy_provider_, num_bits, 1);
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(num_bits),
+                  .num_ots_ = 2 * num_bits,
+                  .online_rounds_ = 1};
+}
 
-  // distribute data among wires
-  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    auto& wire_o = outputs_[wire_i];
-    wire_o->get_public_share() = Delta_y_share_.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
-    wire_o->set_online_ready();
+// number of subsets of size k of n operands
+static std::size_t binomial(std::size_t n, std::size_t k) {
+  std::size_t result = 1;
+  for (std::size_t i = 1; i <= k; ++i) {
+    result = result * (n - k + i) / i;
   }
+  return result;
 }
 
-BooleanBEAVYAND4Gate::BooleanBEAVYAND4Gate(std::size_t gate_id, BEAVYProvider& beavy_provider,
-                                         BooleanBEAVYWireVector&& in_a,
-                                         BooleanBEAVYWireVector&& in_b)
-    : detail::BasicBooleanBEAVYBinaryGate(gate_id, std::move(in_a), std::move(in_b)),
+BooleanBEAVYANDnGate::BooleanBEAVYANDnGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
+                                           std::vector<BooleanBEAVYWireVector>&& inputs)
+    : NewGate(gate_id),
       beavy_provider_(beavy_provider),
-      ot_sender_(nullptr),
-      ot_receiver_(nullptr) {
-  auto num_bits = count_bits(inputs_a_);
+      num_wires_(inputs.empty() ? 0 : inputs[0].size()),
+      inputs_(std::move(inputs)) {
+  if (inputs_.size() < 2 || inputs_.size() > max_num_inputs) {
+    throw std::logic_error(
+        fmt::format("number of inputs needs to be between 2 and {}", max_num_inputs));
+  }
+  if (num_wires_ == 0) {
+    throw std::logic_error("number of wires need to be positive");
+  }
+  const auto num_simd = inputs_[0][0]->get_num_simd();
+  for (const auto& input : inputs_) {
+    if (input.size() != num_wires_) {
+      throw std::logic_error("number of wires need to be the same for all inputs");
+    }
+    for (const auto& wire : input) {
+      if (wire->get_num_simd() != num_simd) {
+        throw std::logic_error("number of SIMD values need to be the same for all wires");
+      }
+    }
+  }
+  outputs_ = beavy_provider_.make_boolean_wires(num_wires_, num_simd);
+
+  const auto num_bits = get_num_bits();
   auto my_id = beavy_provider_.get_my_id();
   share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_bits);
-  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
-  ot_sender_ = otp.RegisterSendXCOTBit(num_bits);
-  ot_receiver_ = otp.RegisterReceiveXCOTBit(num_bits);
+  for (std::size_t subset_size = 2; subset_size <= inputs_.size(); ++subset_size) {
+    const auto num_ots = binomial(inputs_.size(), subset_size) * num_bits;
+    if (beavy_provider_.get_batch_ot_preprocessing()) {
+      xcot_batch_offsets_.push_back(beavy_provider_.reserve_batched_xcot_bits(num_ots));
+    } else {
+      register_xcot_bits(beavy_provider_, num_ots, ot_senders_.emplace_back(),
+                         ot_receivers_.emplace_back());
+    }
+  }
 }
 
-BooleanBEAVYAND4Gate::~BooleanBEAVYAND4Gate() = default;
+BooleanBEAVYANDnGate::~BooleanBEAVYANDnGate() = default;
+
+std::pair<CommMixin*, std::size_t> BooleanBEAVYANDnGate::get_fusable_online_message() const {
+  return {&beavy_provider_, get_num_bits()};
+}
 
-void BooleanBEAVYAND4Gate::evaluate_setup() {
+void BooleanBEAVYANDnGate::evaluate_setup() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
-      logger->LogTrace(fmt::format("Gate {}: BooleanBEAVYAND4Gate::evaluate_setup start", gate_id_));
+      logger->LogTrace(fmt::format("Gate {}: BooleanBEAVYANDnGate::evaluate_setup start", gate_id_));
     }
   }
 
-  for (auto& wire_o : outputs_) {
-    wire_o->get_secret_share() = ENCRYPTO::BitVector<>::Random(wire_o->get_num_simd());
+  const auto& mask_generator = beavy_provider_.get_mask_generator();
+  for (std::size_t wire_i = 0; wire_i < outputs_.size(); ++wire_i) {
+    auto& wire_o = outputs_[wire_i];
+    wire_o->get_secret_share() =
+        mask_generator.random_bits(gate_id_, wire_o->get_num_simd(), wire_i);
     wire_o->set_setup_ready();
   }
 
-  auto num_simd = inputs_a_[0]->get_num_simd();
-  std::cout<< "num_simd: " << num_simd << std::endl;
-  auto num_bytes = Helpers::Convert::BitsToBytes(num_wires_ * num_simd); // what is this?
-  delta_a_share_.Reserve(num_bytes);
-  delta_b_share_.Reserve(num_bytes);
-  Delta_y_share_.Reserve(num_bytes);
-
-  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    const auto& wire_a = inputs_a_[wire_i];
-    const auto& wire_b = inputs_b_[wire_i];
-    const auto& wire_o = outputs_[wire_i];
-    wire_a->wait_setup();
-    wire_b->wait_setup();
-    delta_a_share_.Append(wire_a->get_secret_share());
-    delta_b_share_.Append(wire_b->get_secret_share());
-    Delta_y_share_.Append(wire_o->get_secret_share());
+  const auto num_inputs = inputs_.size();
+  const auto num_bits = get_num_bits();
+  const auto num_bytes = Helpers::Convert::BitsToBytes(num_bits);
+  const std::size_t all_inputs = (std::size_t(1) << num_inputs) - 1;
+  delta_products_.assign(all_inputs + 1, {});
+  for (std::size_t input_i = 0; input_i < num_inputs; ++input_i) {
+    auto& delta_share = delta_products_[std::size_t(1) << input_i];
+    delta_share.Reserve(num_bytes);
+    for (const auto& wire : inputs_[input_i]) {
+      wire->wait_setup();
+      delta_share.Append(wire->get_secret_share());
+    }
   }
 
-  auto delta_ab_share = delta_a_share_ & delta_b_share_;
+  // [delta_S] = [delta_{S without i}] * [delta_i] for the last operand i of S, all subsets of the
+  // same size at once
+  for (std::size_t subset_size = 2; subset_size <= num_inputs; ++subset_size) {
+    std::vector<std::size_t> subsets;
+    ENCRYPTO::BitVector<> delta_s_share;
+    ENCRYPTO::BitVector<> delta_i_share;
+    const auto num_subsets = binomial(num_inputs, subset_size);
+    delta_s_share.Reserve(num_subsets * num_bytes);
+    delta_i_share.Reserve(num_subsets * num_bytes);
+    for (std::size_t subset = 1; subset <= all_inputs; ++subset) {
+      if (static_cast<std::size_t>(std::popcount(subset)) != subset_size) {
+        continue;
+      }
+      const auto last_input = std::bit_floor(subset);
+      subsets.push_back(subset);
+      delta_s_share.Append(delta_products_[subset ^ last_input]);
+      delta_i_share.Append(delta_products_[last_input]);
+    }
+    const auto level = subset_size - 2;
+    auto products = delta_s_share & delta_i_share;
+    products ^= compute_xcot_bits(
+        beavy_provider_,
+        xcot_batch_offsets_.empty() ? std::nullopt
+                                    : std::optional<std::size_t>(xcot_batch_offsets_[level]),
+        ot_senders_.empty() ? nullptr : ot_senders_[level].get(),
+        ot_receivers_.empty() ? nullptr : ot_receivers_[level].get(), delta_s_share,
+        delta_i_share);
+    for (std::size_t subset_i = 0; subset_i < subsets.size(); ++subset_i) {
+      delta_products_[subsets[subset_i]] =
+          products.Subset(subset_i * num_bits, (subset_i + 1) * num_bits);
+    }
+  }
 
-  ot_receiver_->SetChoices(delta_a_share_);
-  ot_receiver_->SendCorrections();
-  ot_sender_->SetCorrelations(delta_b_share_);
-  ot_sender_->SendMessages();
-  ot_receiver_->ComputeOutputs();
-  ot_sender_->ComputeOutputs();
-  delta_ab_share ^= ot_sender_->GetOutputs();
-  delta_ab_share ^= ot_receiver_->GetOutputs();
-  Delta_y_share_ ^= delta_ab_share;
+  // the product of all delta shares is the only term without public shares
+  Delta_y_share_ = {};
+  Delta_y_share_.Reserve(num_bytes);
+  for (const auto& wire_o : outputs_) {
+    Delta_y_share_.Append(wire_o->get_secret_share());
+  }
+  Delta_y_share_ ^= delta_products_[all_inputs];
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
-      logger->LogTrace(fmt::format("Gate {}: BooleanBEAVYAND4Gate::evaluate_setup end", gate_id_));
+      logger->LogTrace(fmt::format("Gate {}: BooleanBEAVYANDnGate::evaluate_setup end", gate_id_));
     }
   }
 }
 
-void BooleanBEAVYAND4Gate::evaluate_online() {
-  auto num_simd = inputs_a_[0]->get_num_simd();
-  auto num_bits = num_wires_ * num_simd;
-  ENCRYPTO::BitVector<> Delta_a;
-  ENCRYPTO::BitVector<> Delta_b;
-  Delta_a.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-  Delta_b.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-
-  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    const auto& wire_a = inputs_a_[wire_i];
-    wire_a->wait_online();
-    Delta_a.Append(wire_a->get_public_share());
-    const auto& wire_b = inputs_b_[wire_i];
-    wire_b->wait_online();
-    Delta_b.Append(wire_b->get_public_share());
+void BooleanBEAVYANDnGate::evaluate_online() {
+  const auto num_inputs = inputs_.size();
+  const auto num_simd = outputs_[0]->get_num_simd();
+  const std::size_t all_inputs = (std::size_t(1) << num_inputs) - 1;
+
+  // products of the public shares of the operands whose bits are set in the index
+  std::vector<ENCRYPTO::BitVector<>> Delta_products(all_inputs + 1);
+  for (std::size_t input_i = 0; input_i < num_inputs; ++input_i) {
+    auto& Delta = Delta_products[std::size_t(1) << input_i];
+    Delta.Reserve(Helpers::Convert::BitsToBytes(get_num_bits()));
+    for (const auto& wire : inputs_[input_i]) {
+      wire->wait_online();
+      Delta.Append(wire->get_public_share());
+    }
+  }
+  for (std::size_t subset = 1; subset <= all_inputs; ++subset) {
+    const auto first_input = subset & (~subset + 1);
+    if (subset != first_input) {
+      Delta_products[subset] = Delta_products[subset ^ first_input] & Delta_products[first_input];
+    }
   }
 
-  Delta_y_share_ ^= (Delta_a & delta_b_share_);
-  Delta_y_share_ ^= (Delta_b & delta_a_share_);
-
+  // prod_i (Delta_i ^ delta_i) = XOR over all subsets S of prod_{i not in S} Delta_i * delta_S,
+  // where the term of all operands has been added in the setup and the one of no operand is
+  // public
+  for (std::size_t subset = 1; subset < all_inputs; ++subset) {
+    Delta_y_share_ ^= Delta_products[all_inputs ^ subset] & delta_products_[subset];
+  }
   if (beavy_provider_.is_my_job(gate_id_)) {
-    Delta_y_share_ ^= (Delta_a & Delta_b);
+    Delta_y_share_ ^= Delta_products[all_inputs];
   }
 
   beavy_provider_.broadcast_bits_message(gate_id_, Delta_y_share_);
   Delta_y_share_ ^= share_future_.get();
 
-  // distribute data among wires
+  // distribute data among wires, a single wire takes the whole vector
+  if (num_wires_ == 1) {
+    outputs_[0]->get_public_share() = std::move(Delta_y_share_);
+    outputs_[0]->set_online_ready();
+    return;
+  }
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     auto& wire_o = outputs_[wire_i];
     wire_o->get_public_share() = Delta_y_share_.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
@@ -1059,30 +2091,98 @@ void BooleanBEAVYAND4Gate::evaluate_online() {
   }
 }
 
+void BooleanBEAVYANDnGate::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+  // the products of all delta shares are contained in [Delta_y]
+  for (std::size_t subset = 1; subset + 1 < delta_products_.size(); ++subset) {
+    writer.write_bits(delta_products_[subset]);
+  }
+  writer.write_bits(Delta_y_share_);
+}
+
+void BooleanBEAVYANDnGate::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+  delta_products_.assign(std::size_t(1) << inputs_.size(), {});
+  for (std::size_t subset = 1; subset + 1 < delta_products_.size(); ++subset) {
+    delta_products_[subset] = record.read_bits();
+  }
+  Delta_y_share_ = record.read_bits();
+}
+
+std::optional<GateCost> BooleanBEAVYANDnGate::get_cost() const {
+  const auto num_bits = get_num_bits();
+  const auto num_products = (std::size_t(1) << inputs_.size()) - inputs_.size() - 1;
+  // one XCOT of a bit in each direction per product, only [Delta_y] is broadcast online
+  const auto setup_bits = product_ots_setup_bits(beavy_provider_, num_products * num_bits, 1);
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(num_bits),
+                  .num_ots_ = 2 * num_products * num_bits,
+                  .online_rounds_ = 1};
+}
 
 BooleanBEAVYMSGGate::BooleanBEAVYMSGGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
                                          BooleanBEAVYWireVector&& in_a,
                                          BooleanBEAVYWireVector&& in_b)
-    : detail::BasicBooleanBEAVYBinaryGate(gate_id, std::move(in_a), std::move(in_b)),
+    : detail::BasicBooleanBEAVYBinaryGate(gate_id, beavy_provider, std::move(in_a),
+                                          std::move(in_b)),
       beavy_provider_(beavy_provider),
-      ot_sender_(nullptr),
-      ot_receiver_(nullptr) {
-  
-  num_wires_ = 10;
-  auto num_simd = 991;
-  auto rounds = 2;
-  auto num_bits = num_simd*num_wires_;
+      num_simd_(inputs_a_[0]->get_num_simd()) {
+  outputs_ = beavy_provider_.make_boolean_wires(1, num_simd_);
+
+  std::size_t num_bits = 0;
+  for (std::size_t num_values = num_wires_; num_values > 1;) {
+    num_values = (num_values + group_size - 1) / group_size;
+    round_offsets_.push_back(num_bits);
+    round_num_ands_.push_back(num_values);
+    num_bits += num_values * num_simd_;
+  }
+  if (get_num_rounds() == 0) {
+    return;
+  }
 
-  // auto num_bits = count_bits(inputs_a_);
   auto my_id = beavy_provider_.get_my_id();
-  
-  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
-  ot_sender_ = otp.RegisterSendXCOTBit(num_bits);
-  ot_receiver_ = otp.RegisterReceiveXCOTBit(num_bits);
+  for (std::size_t round_i = 0; round_i < get_num_rounds(); ++round_i) {
+    share_futures_.push_back(beavy_provider_.register_for_bits_message(
+        1 - my_id, gate_id_, round_num_ands_[round_i] * num_simd_, round_i));
+  }
+  for (std::size_t subset_size = 2; subset_size <= group_size; ++subset_size) {
+    const auto num_ots = binomial(group_size, subset_size) * num_bits;
+    if (beavy_provider_.get_batch_ot_preprocessing()) {
+      xcot_batch_offsets_.push_back(beavy_provider_.reserve_batched_xcot_bits(num_ots));
+    } else {
+      register_xcot_bits(beavy_provider_, num_ots, ot_senders_.emplace_back(),
+                         ot_receivers_.emplace_back());
+    }
+  }
 }
 
 BooleanBEAVYMSGGate::~BooleanBEAVYMSGGate() = default;
 
+// Operand `operand_i` of the 4-input ANDs of a round whose inputs are `values`, i.e., the values
+// of the groups operand_i, group_size + operand_i, ..., where missing values are `padding`.
+static ENCRYPTO::BitVector<> gather_msg_operand(const ENCRYPTO::BitVector<>& values,
+                                                std::size_t num_values, std::size_t num_ands,
+                                                std::size_t num_simd, std::size_t operand_i,
+                                                bool padding) {
+  ENCRYPTO::BitVector<> operand;
+  operand.Reserve(Helpers::Convert::BitsToBytes(num_ands * num_simd));
+  for (std::size_t and_i = 0; and_i < num_ands; ++and_i) {
+    const auto value_i = and_i * BooleanBEAVYMSGGate::group_size + operand_i;
+    if (value_i < num_values) {
+      operand.Append(values.Subset(value_i * num_simd, (value_i + 1) * num_simd));
+    } else {
+      operand.Append(ENCRYPTO::BitVector<>(num_simd, padding));
+    }
+  }
+  return operand;
+}
+
 void BooleanBEAVYMSGGate::evaluate_setup() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1091,36 +2191,88 @@ void BooleanBEAVYMSGGate::evaluate_setup() {
     }
   }
 
-  for (auto& wire_o : outputs_) {
-    wire_o->get_secret_share() = ENCRYPTO::BitVector<>::Random(wire_o->get_num_simd());
-    wire_o->set_setup_ready();
+  // [delta] of the XNORs of the input wires
+  ENCRYPTO::BitVector<> delta_values;
+  delta_values.Reserve(Helpers::Convert::BitsToBytes(num_wires_ * num_simd_));
+  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+    inputs_a_[wire_i]->wait_setup();
+    inputs_b_[wire_i]->wait_setup();
+    delta_values.Append(inputs_a_[wire_i]->get_secret_share() ^
+                        inputs_b_[wire_i]->get_secret_share());
   }
 
-  num_wires_ = 10;
-  auto num_simd = 991;
-  auto rounds = 2;
-  auto num_bits = num_simd*num_wires_;
+  auto& wire_o = outputs_[0];
+  if (get_num_rounds() == 0) {
+    wire_o->get_secret_share() = std::move(delta_values);
+    wire_o->set_setup_ready();
+    return;
+  }
+  wire_o->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_bits(gate_id_, num_simd_);
+  wire_o->set_setup_ready();
+
+  // the operands of each round are the outputs of the previous one, whose delta shares are chosen
+  // here
+  constexpr std::size_t all_operands = (std::size_t(1) << group_size) - 1;
+  const auto num_rounds = get_num_rounds();
+  std::vector<ENCRYPTO::BitVector<>> delta_outputs(num_rounds);
+  delta_products_.assign(num_rounds, std::vector<ENCRYPTO::BitVector<>>(all_operands + 1));
+  auto num_values = num_wires_;
+  for (std::size_t round_i = 0; round_i < num_rounds; ++round_i) {
+    const auto num_ands = round_num_ands_[round_i];
+    for (std::size_t operand_i = 0; operand_i < group_size; ++operand_i) {
+      delta_products_[round_i][std::size_t(1) << operand_i] =
+          gather_msg_operand(round_i == 0 ? delta_values : delta_outputs[round_i - 1], num_values,
+                             num_ands, num_simd_, operand_i, false);
+    }
+    delta_outputs[round_i] = round_i + 1 == num_rounds
+                                 ? wire_o->get_secret_share()
+                                 : ENCRYPTO::BitVector<>::Random(num_ands * num_simd_);
+    num_values = num_ands;
+  }
+
+  // [delta_S] = [delta_{S without i}] * [delta_i] for the last operand i of S, all subsets of the
+  // same size of all rounds at once
+  for (std::size_t subset_size = 2; subset_size <= group_size; ++subset_size) {
+    std::vector<std::pair<std::size_t, std::size_t>> products;
+    ENCRYPTO::BitVector<> delta_s_share;
+    ENCRYPTO::BitVector<> delta_i_share;
+    for (std::size_t round_i = 0; round_i < num_rounds; ++round_i) {
+      for (std::size_t subset = 1; subset <= all_operands; ++subset) {
+        if (static_cast<std::size_t>(std::popcount(subset)) != subset_size) {
+          continue;
+        }
+        const auto last_operand = std::bit_floor(subset);
+        products.emplace_back(round_i, subset);
+        delta_s_share.Append(delta_products_[round_i][subset ^ last_operand]);
+        delta_i_share.Append(delta_products_[round_i][last_operand]);
+      }
+    }
+    const auto level = subset_size - 2;
+    auto product_shares = delta_s_share & delta_i_share;
+    product_shares ^= compute_xcot_bits(
+        beavy_provider_,
+        xcot_batch_offsets_.empty() ? std::nullopt
+                                    : std::optional<std::size_t>(xcot_batch_offsets_[level]),
+        ot_senders_.empty() ? nullptr : ot_senders_[level].get(),
+        ot_receivers_.empty() ? nullptr : ot_receivers_[level].get(), delta_s_share,
+        delta_i_share);
+    std::size_t offset = 0;
+    for (const auto& [round_i, subset] : products) {
+      const auto num_bits = round_num_ands_[round_i] * num_simd_;
+      delta_products_[round_i][subset] = product_shares.Subset(offset, offset + num_bits);
+      offset += num_bits;
+    }
+  }
 
-  auto num_bytes = Helpers::Convert::BitsToBytes(num_wires_ * num_simd);
-  
-  Delta_y_share_.Reserve(num_bytes);
-  auto rand = ENCRYPTO::BitVector<>(num_wires_ * num_simd, false);
-  auto randa = ENCRYPTO::BitVector<>(num_wires_ * num_simd, false);
-  auto randb = ENCRYPTO::BitVector<>(num_wires_ * num_simd, false);
-  delta_a_share_.Reserve(num_bytes);
-  delta_b_share_.Reserve(num_bytes);
+  // the product of all delta shares is the only term without public shares
+  Delta_y_share_ = {};
+  Delta_y_share_.Reserve(Helpers::Convert::BitsToBytes(round_offsets_.back() +
+                                                       round_num_ands_.back() * num_simd_));
+  for (std::size_t round_i = 0; round_i < num_rounds; ++round_i) {
+    Delta_y_share_.Append(delta_outputs[round_i] ^ delta_products_[round_i][all_operands]);
+  }
 
-  Delta_y_share_.Append(rand);
-  delta_a_share_.Append(randa);
-  delta_b_share_.Append(randb);
-  ot_receiver_->SetChoices(delta_a_share_);
-  ot_receiver_->SendCorrections();
-  ot_sender_->SetCorrelations(delta_b_share_);
-  ot_sender_->SendMessages();
-  ot_receiver_->ComputeOutputs();
-  ot_sender_->ComputeOutputs();
-  Delta_y_share_ ^= ot_sender_->GetOutputs();
-  Delta_y_share_ ^= ot_receiver_->GetOutputs();
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -1130,43 +2282,110 @@ void BooleanBEAVYMSGGate::evaluate_setup() {
 }
 
 void BooleanBEAVYMSGGate::evaluate_online() {
-  
-  num_wires_ = 10;
-  auto num_simd = 991;
-  auto rounds = 2;
-  auto num_bits = num_simd*num_wires_;
-  auto my_id = beavy_provider_.get_my_id();
-  auto rand = ENCRYPTO::BitVector<>::Random(num_bits);
-  
-  // r1
-  num_bits = num_bits/4;
-  std::cout<< "nb: "<< num_bits<< std::endl;
-  rand = ENCRYPTO::BitVector<>::Random(num_bits);
-  share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_bits, 0);
-  beavy_provider_.broadcast_bits_message(gate_id_, rand, 0);
-  Delta_y_share_ = share_future_.get();
-
-  // r2
-  // num_bits = num_bits/4;
-  std::cout<< "nb: "<< num_bits<< std::endl;
-  rand = ENCRYPTO::BitVector<>::Random(num_bits/4);
-  auto share_future_1 = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_bits/4, 1);
-  beavy_provider_.broadcast_bits_message(gate_id_, rand, 1);
-  Delta_y_share_ = share_future_1.get();
+  // Delta of the XNORs of the input wires
+  ENCRYPTO::BitVector<> Delta_values;
+  Delta_values.Reserve(Helpers::Convert::BitsToBytes(num_wires_ * num_simd_));
+  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+    inputs_a_[wire_i]->wait_online();
+    inputs_b_[wire_i]->wait_online();
+    Delta_values.Append(~(inputs_a_[wire_i]->get_public_share() ^
+                          inputs_b_[wire_i]->get_public_share()));
+  }
+
+  constexpr std::size_t all_operands = (std::size_t(1) << group_size) - 1;
+  const bool is_my_job = beavy_provider_.is_my_job(gate_id_);
+  auto num_values = num_wires_;
+  for (std::size_t round_i = 0; round_i < get_num_rounds(); ++round_i) {
+    const auto num_ands = round_num_ands_[round_i];
+    const auto num_bits = num_ands * num_simd_;
+    hot_log("BooleanBEAVYMSGGate::evaluate_online",
+            {{"gate_id", gate_id_}, {"round", round_i}, {"num_bits", num_bits}});
+
+    // products of the public shares of the operands whose bits are set in the index, missing
+    // operands of the last AND are public ones
+    std::vector<ENCRYPTO::BitVector<>> Delta_products(all_operands + 1);
+    for (std::size_t operand_i = 0; operand_i < group_size; ++operand_i) {
+      Delta_products[std::size_t(1) << operand_i] =
+          gather_msg_operand(Delta_values, num_values, num_ands, num_simd_, operand_i, true);
+    }
+    for (std::size_t subset = 1; subset <= all_operands; ++subset) {
+      const auto first_operand = subset & (~subset + 1);
+      if (subset != first_operand) {
+        Delta_products[subset] =
+            Delta_products[subset ^ first_operand] & Delta_products[first_operand];
+      }
+    }
 
+    // see BooleanBEAVYANDnGate::evaluate_online
+    const auto offset = round_offsets_[round_i];
+    auto Delta_y_share = Delta_y_share_.Subset(offset, offset + num_bits);
+    const auto& delta_products = delta_products_[round_i];
+    for (std::size_t subset = 1; subset < all_operands; ++subset) {
+      Delta_y_share ^= Delta_products[all_operands ^ subset] & delta_products[subset];
+    }
+    if (is_my_job) {
+      Delta_y_share ^= Delta_products[all_operands];
+    }
 
-  // distribute data among wires
-  for (auto& wire_o : outputs_) {
-    wire_o->get_public_share() = ENCRYPTO::BitVector<>::Random(wire_o->get_num_simd());
-    wire_o->set_online_ready();
+    beavy_provider_.broadcast_bits_message(gate_id_, Delta_y_share, round_i);
+    Delta_values = std::move(Delta_y_share);
+    Delta_values ^= share_futures_[round_i].get();
+    num_values = num_ands;
+  }
+
+  outputs_[0]->get_public_share() = std::move(Delta_values);
+  outputs_[0]->set_online_ready();
+}
+
+void BooleanBEAVYMSGGate::save_setup(PreprocessingWriter& writer) {
+  writer.write_bits(outputs_[0]->get_secret_share());
+  if (get_num_rounds() == 0) {
+    return;
+  }
+  // the products of all delta shares are contained in [Delta_y]
+  for (const auto& delta_products : delta_products_) {
+    for (std::size_t subset = 1; subset + 1 < delta_products.size(); ++subset) {
+      writer.write_bits(delta_products[subset]);
+    }
+  }
+  writer.write_bits(Delta_y_share_);
+}
+
+void BooleanBEAVYMSGGate::load_setup(PreprocessingRecord& record) {
+  outputs_[0]->get_secret_share() = record.read_bits();
+  outputs_[0]->set_setup_ready();
+  if (get_num_rounds() == 0) {
+    return;
+  }
+  delta_products_.assign(get_num_rounds(),
+                         std::vector<ENCRYPTO::BitVector<>>(std::size_t(1) << group_size));
+  for (auto& delta_products : delta_products_) {
+    for (std::size_t subset = 1; subset + 1 < delta_products.size(); ++subset) {
+      delta_products[subset] = record.read_bits();
+    }
   }
+  Delta_y_share_ = record.read_bits();
 }
 
+std::optional<GateCost> BooleanBEAVYMSGGate::get_cost() const {
+  const auto num_rounds = get_num_rounds();
+  const auto num_bits =
+      num_rounds == 0 ? 0 : round_offsets_.back() + round_num_ands_.back() * num_simd_;
+  const auto num_products = (std::size_t(1) << group_size) - group_size - 1;
+  // like the n-input AND with 4 inputs in every round
+  const auto setup_bits = product_ots_setup_bits(beavy_provider_, num_products * num_bits, 1);
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(num_bits),
+                  .num_ots_ = 2 * num_products * num_bits,
+                  .online_rounds_ = num_rounds};
+}
 
 BooleanBEAVYDOTGate::BooleanBEAVYDOTGate(std::size_t gate_id, BEAVYProvider& beavy_provider,
                                          BooleanBEAVYWireVector&& in_a,
                                          BooleanBEAVYWireVector&& in_b)
-    : detail::BasicBooleanBEAVYBinaryGate(gate_id, std::move(in_a), std::move(in_b)),
+    : detail::BasicBooleanBEAVYBinaryGate(gate_id, beavy_provider, std::move(in_a),
+                                          std::move(in_b)),
       beavy_provider_(beavy_provider),
       ot_sender_(nullptr),
       ot_receiver_(nullptr) {
@@ -1175,9 +2394,11 @@ BooleanBEAVYDOTGate::BooleanBEAVYDOTGate(std::size_t gate_id, BEAVYProvider& bea
   auto num_simd = inputs_a_[0]->get_num_simd();
   auto my_id = beavy_provider_.get_my_id();
   share_future_ = beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_simd);
-  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
-  ot_sender_ = otp.RegisterSendXCOTBit(num_bits);
-  ot_receiver_ = otp.RegisterReceiveXCOTBit(num_bits);
+  if (beavy_provider_.get_batch_ot_preprocessing()) {
+    xcot_batch_offset_ = beavy_provider_.reserve_batched_xcot_bits(num_bits);
+  } else {
+    register_xcot_bits(beavy_provider_, num_bits, ot_sender_, ot_receiver_);
+  }
 }
 
 
@@ -1203,7 +2424,8 @@ void BooleanBEAVYDOTGate::evaluate_setup() {
   Delta_y_share_.Reserve(num_bytes);
 
   outputs_.resize(1);
-  outputs_[0]->get_secret_share() = ENCRYPTO::BitVector<>::Random(num_simd);
+  outputs_[0]->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_bits(gate_id_, num_simd);
   outputs_[0]->set_setup_ready();
 
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
@@ -1218,14 +2440,8 @@ void BooleanBEAVYDOTGate::evaluate_setup() {
 
   auto delta_ab_share = delta_a_share_ & delta_b_share_;
 
-  ot_receiver_->SetChoices(delta_a_share_);
-  ot_receiver_->SendCorrections();
-  ot_sender_->SetCorrelations(delta_b_share_);
-  ot_sender_->SendMessages();
-  ot_receiver_->ComputeOutputs();
-  ot_sender_->ComputeOutputs();
-  delta_ab_share ^= ot_sender_->GetOutputs();
-  delta_ab_share ^= ot_receiver_->GetOutputs();
+  delta_ab_share ^= compute_xcot_bits(beavy_provider_, xcot_batch_offset_, ot_sender_.get(),
+                                      ot_receiver_.get(), delta_a_share_, delta_b_share_);
   Delta_y_share_.Append(delta_ab_share);
   
 
@@ -1239,38 +2455,26 @@ void BooleanBEAVYDOTGate::evaluate_setup() {
 
 void BooleanBEAVYDOTGate::evaluate_online() {
   auto num_simd = inputs_a_[0]->get_num_simd();
-  auto num_bits = num_wires_ * num_simd;
-  ENCRYPTO::BitVector<> Delta_a;
-  ENCRYPTO::BitVector<> Delta_b;
-  Delta_a.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-  Delta_b.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-
-  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    const auto& wire_a = inputs_a_[wire_i];
-    wire_a->wait_online();
-    Delta_a.Append(wire_a->get_public_share());
-    const auto& wire_b = inputs_b_[wire_i];
-    wire_b->wait_online();
-    Delta_b.Append(wire_b->get_public_share());
-  }
-  
-  Delta_y_share_ ^= (Delta_a & delta_b_share_);
-  Delta_y_share_ ^= (Delta_b & delta_a_share_);
-
-  if (beavy_provider_.is_my_job(gate_id_)) {
-    Delta_y_share_ ^= (Delta_a & Delta_b);
-  }
+  beavy_and_online(Delta_y_share_, delta_a_share_, delta_b_share_, inputs_a_, inputs_b_,
+                   beavy_provider_.is_my_job(gate_id_));
 
   ENCRYPTO::BitVector<> Delta_y_share;
   Delta_y_share.Reserve(num_simd);
   Delta_y_share.Append(outputs_[0]->get_secret_share());
 
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-    std::cout<<"here"<<std::endl;
-    Delta_y_share ^= Delta_y_share_.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    if (num_simd % 8 == 0) {
+      // xor the slice of the wire in place
+      const ENCRYPTO::BitTerminal Delta_y_wire(
+          Delta_y_share_.GetData().data() + wire_i * (num_simd / 8), num_simd);
+      ENCRYPTO::xor_assign(Delta_y_share.GetMutableData().data(), Delta_y_wire);
+    } else {
+      Delta_y_share ^= Delta_y_share_.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    }
   }
 
-  std::cout<< "delu: "<< Delta_y_share.GetSize()<<std::endl;
+  hot_log("BooleanBEAVYDOTGate::evaluate_online",
+          {{"gate_id", gate_id_}, {"num_bits", Delta_y_share.GetSize()}});
   beavy_provider_.broadcast_bits_message(gate_id_, Delta_y_share);
   Delta_y_share ^= share_future_.get();
 
@@ -1280,6 +2484,206 @@ void BooleanBEAVYDOTGate::evaluate_online() {
 }
 
 
+// The secret or the public shares of all wires one after another.
+static ENCRYPTO::BitVector<> concat_secret_shares(const BooleanBEAVYWireVector& wires) {
+  ENCRYPTO::BitVector<> shares;
+  shares.Reserve(Helpers::Convert::BitsToBytes(count_bits(wires)));
+  for (const auto& wire : wires) {
+    wire->wait_setup();
+    shares.Append(wire->get_secret_share());
+  }
+  return shares;
+}
+
+static ENCRYPTO::BitVector<> concat_public_shares(const BooleanBEAVYWireVector& wires) {
+  ENCRYPTO::BitVector<> shares;
+  shares.Reserve(Helpers::Convert::BitsToBytes(count_bits(wires)));
+  for (const auto& wire : wires) {
+    wire->wait_online();
+    shares.Append(wire->get_public_share());
+  }
+  return shares;
+}
+
+// XOR of the slices of num_simd bits of the wires in `bits`.
+static ENCRYPTO::BitVector<> xor_wire_slices(const ENCRYPTO::BitVector<>& bits,
+                                             std::size_t num_wires, std::size_t num_simd) {
+  ENCRYPTO::BitVector<> result(num_simd);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    if (num_simd % 8 == 0) {
+      const ENCRYPTO::BitTerminal slice(bits.GetData().data() + wire_i * (num_simd / 8), num_simd);
+      ENCRYPTO::xor_assign(result.GetMutableData().data(), slice);
+    } else {
+      result ^= bits.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    }
+  }
+  return result;
+}
+
+BooleanBEAVYMatrixDOTGate::BooleanBEAVYMatrixDOTGate(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, BooleanBEAVYWireVector&& text,
+    std::vector<BooleanBEAVYWireVector>&& patterns)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      num_simd_(text.at(0)->get_num_simd()),
+      text_(std::move(text)),
+      patterns_(std::move(patterns)) {
+  if (patterns_.empty()) {
+    throw std::logic_error("BooleanBEAVYMatrixDOTGate needs at least one pattern");
+  }
+  auto check_wires = [this](const auto& wires) {
+    if (wires.size() != text_.size()) {
+      throw std::logic_error("BooleanBEAVYMatrixDOTGate: patterns and text differ in size");
+    }
+    for (const auto& wire : wires) {
+      if (wire->get_num_simd() != num_simd_) {
+        throw std::logic_error("BooleanBEAVYMatrixDOTGate: wires differ in number of SIMD values");
+      }
+    }
+  };
+  check_wires(text_);
+  std::for_each(std::begin(patterns_), std::end(patterns_), check_wires);
+
+  const auto num_patterns = patterns_.size();
+  outputs_ = beavy_provider_.make_boolean_wires(num_patterns, num_simd_);
+  auto my_id = beavy_provider_.get_my_id();
+  share_future_ =
+      beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, num_patterns * num_simd_);
+  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
+  ot_sender_ = otp.RegisterSendXCOTBit(get_num_ots(), num_patterns);
+  ot_receiver_ = otp.RegisterReceiveXCOTBit(get_num_ots(), num_patterns);
+}
+
+BooleanBEAVYMatrixDOTGate::~BooleanBEAVYMatrixDOTGate() = default;
+
+void BooleanBEAVYMatrixDOTGate::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYMatrixDOTGate::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto num_patterns = patterns_.size();
+  const auto num_ots = get_num_ots();
+  const auto& mask_generator = beavy_provider_.get_mask_generator();
+  for (std::size_t wire_i = 0; wire_i < outputs_.size(); ++wire_i) {
+    auto& wire = outputs_[wire_i];
+    wire->get_secret_share() = mask_generator.random_bits(gate_id_, num_simd_, wire_i);
+    wire->set_setup_ready();
+  }
+
+  // the correlations of the XCOT of text bit i are the bits i of all patterns
+  const auto delta_text_share = concat_secret_shares(text_);
+  std::vector<ENCRYPTO::BitVector<>> delta_pattern_shares;
+  ENCRYPTO::BitVector<> correlations(num_ots * num_patterns);
+  for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+    const auto& delta_pattern_share =
+        delta_pattern_shares.emplace_back(concat_secret_shares(patterns_[pattern_j]));
+    for (std::size_t bit_i = 0; bit_i < num_ots; ++bit_i) {
+      if (delta_pattern_share.Get(bit_i)) {
+        correlations.Set(true, bit_i * num_patterns + pattern_j);
+      }
+    }
+  }
+  ot_receiver_->SetChoices(delta_text_share);
+  ot_receiver_->SendCorrections();
+  ot_sender_->SetCorrelations(std::move(correlations));
+  ot_sender_->SendMessages();
+  ot_receiver_->ComputeOutputs();
+  ot_sender_->ComputeOutputs();
+  // [[delta_text]_i * [delta_pattern]_(1-i) ^ [delta_text]_(1-i) * [delta_pattern]_i]_i
+  const auto delta_cross_share = ot_receiver_->GetOutputs() ^ ot_sender_->GetOutputs();
+
+  // [Delta_y]_i = [delta_y]_i ^ XOR over the wires of [delta_text * delta_pattern]_i
+  Delta_y_share_ = ENCRYPTO::BitVector<>();
+  Delta_y_share_.Reserve(Helpers::Convert::BitsToBytes(num_patterns * num_simd_));
+  for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+    auto delta_products = delta_text_share & delta_pattern_shares[pattern_j];
+    for (std::size_t bit_i = 0; bit_i < num_ots; ++bit_i) {
+      if (delta_cross_share.Get(bit_i * num_patterns + pattern_j)) {
+        delta_products.Set(!delta_products.Get(bit_i), bit_i);
+      }
+    }
+    auto Delta_y_share = xor_wire_slices(delta_products, text_.size(), num_simd_);
+    Delta_y_share ^= outputs_[pattern_j]->get_secret_share();
+    Delta_y_share_.Append(Delta_y_share);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanBEAVYMatrixDOTGate::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+void BooleanBEAVYMatrixDOTGate::evaluate_online() {
+  const auto num_patterns = patterns_.size();
+  const auto Delta_text = concat_public_shares(text_);
+  const auto delta_text_share = concat_secret_shares(text_);
+
+  ENCRYPTO::BitVector<> Delta_y_share;
+  Delta_y_share.Reserve(Helpers::Convert::BitsToBytes(num_patterns * num_simd_));
+  for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+    const auto Delta_pattern = concat_public_shares(patterns_[pattern_j]);
+    const auto delta_pattern_share = concat_secret_shares(patterns_[pattern_j]);
+    // Delta_text * [delta_pattern]_i ^ Delta_pattern * [delta_text]_i, and
+    // Delta_text * Delta_pattern by one of the parties
+    auto products = Delta_text & delta_pattern_share;
+    products.XorAnd(Delta_pattern, delta_text_share);
+    if (beavy_provider_.is_my_job(gate_id_)) {
+      products.XorAnd(Delta_text, Delta_pattern);
+    }
+    auto Delta_y = xor_wire_slices(products, text_.size(), num_simd_);
+    Delta_y ^= Delta_y_share_.Subset(pattern_j * num_simd_, (pattern_j + 1) * num_simd_);
+    Delta_y_share.Append(Delta_y);
+  }
+
+  hot_log("BooleanBEAVYMatrixDOTGate::evaluate_online",
+          {{"gate_id", gate_id_}, {"num_bits", Delta_y_share.GetSize()}});
+  beavy_provider_.broadcast_bits_message(gate_id_, Delta_y_share);
+  Delta_y_share ^= share_future_.get();
+
+  for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+    auto& wire_o = outputs_[pattern_j];
+    wire_o->get_public_share() =
+        Delta_y_share.Subset(pattern_j * num_simd_, (pattern_j + 1) * num_simd_);
+    wire_o->set_online_ready();
+  }
+}
+
+void BooleanBEAVYMatrixDOTGate::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_bits(wire->get_secret_share());
+  }
+  writer.write_bits(Delta_y_share_);
+}
+
+void BooleanBEAVYMatrixDOTGate::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_bits();
+    wire->set_setup_ready();
+  }
+  Delta_y_share_ = record.read_bits();
+}
+
+std::optional<GateCost> BooleanBEAVYMatrixDOTGate::get_cost() const {
+  const auto num_ots = get_num_ots();
+  const auto num_patterns = patterns_.size();
+  // one XCOT of a bit per pattern in each direction per text bit, only [Delta_y] is broadcast
+  // online
+  const auto setup_bits =
+      GateCost::cot_sender_bits(num_ots, num_patterns) + GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(num_patterns * num_simd_),
+                  .num_ots_ = 2 * num_ots,
+                  .online_rounds_ = 1};
+}
+
 template <typename T>
 ArithmeticBEAVYInputGateSender<T>::ArithmeticBEAVYInputGateSender(
     std::size_t gate_id, BEAVYProvider& beavy_provider, std::size_t num_simd,
@@ -1288,6 +2692,8 @@ ArithmeticBEAVYInputGateSender<T>::ArithmeticBEAVYInputGateSender(
       beavy_provider_(beavy_provider),
       num_simd_(num_simd),
       input_id_(beavy_provider.get_next_input_id(1)),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(num_simd) : 0),
       input_future_(std::move(input_future)),
       output_(std::make_shared<ArithmeticBEAVYWire<T>>(num_simd)) {
   output_->get_public_share().resize(num_simd, 0);
@@ -1307,18 +2713,33 @@ void ArithmeticBEAVYInputGateSender<T>::evaluate_setup() {
   auto num_parties = beavy_provider_.get_num_parties();
   auto& mbp = beavy_provider_.get_motion_base_provider();
   auto& my_secret_share = output_->get_secret_share();
-  auto& my_public_share = output_->get_public_share();
-  my_secret_share = Helpers::RandomVector<T>(num_simd_);
-  output_->set_setup_ready();
-  my_public_share = my_secret_share;
-  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
-    if (party_id == my_id) {
-      continue;
+  auto& my_public_share = output_->get_public_share();
+  if (non_interactive_) {
+    const auto input = input_future_.get();
+    if (input.size() != num_simd_) {
+      throw std::runtime_error("size of input bit vector != num_simd_");
+    }
+    auto& rng = mbp.get_my_randomness_generator(1 - my_id);
+    rng.GetUnsignedPacked<T>(public_input_id_, num_simd_, my_public_share.data());
+    const auto their_secret_share = rng.GetUnsigned<T>(input_id_, num_simd_);
+    my_secret_share.resize(num_simd_);
+    for (std::size_t i = 0; i < num_simd_; ++i) {
+      my_secret_share[i] = my_public_share[i] - input[i] - their_secret_share[i];
+    }
+    output_->set_setup_ready();
+  } else {
+    my_secret_share = Helpers::RandomVector<T>(num_simd_);
+    output_->set_setup_ready();
+    my_public_share = my_secret_share;
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      if (party_id == my_id) {
+        continue;
+      }
+      auto& rng = mbp.get_my_randomness_generator(party_id);
+      std::transform(std::begin(my_public_share), std::end(my_public_share),
+                     std::begin(rng.GetUnsigned<T>(input_id_, num_simd_)),
+                     std::begin(my_public_share), std::plus{});
     }
-    auto& rng = mbp.get_my_randomness_generator(party_id);
-    std::transform(std::begin(my_public_share), std::end(my_public_share),
-                   std::begin(rng.GetUnsigned<T>(input_id_, num_simd_)),
-                   std::begin(my_public_share), std::plus{});
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1340,6 +2761,12 @@ void ArithmeticBEAVYInputGateSender<T>::evaluate_online() {
     }
   }
 
+  if (non_interactive_) {
+    // the public share has been fixed in the setup
+    output_->set_online_ready();
+    return;
+  }
+
   // wait for input value
   const auto input = input_future_.get();
   if (input.size() != num_simd_) {
@@ -1362,6 +2789,29 @@ void ArithmeticBEAVYInputGateSender<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+void ArithmeticBEAVYInputGateSender<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(output_->get_secret_share());
+  writer.write_ints(output_->get_public_share());
+}
+
+template <typename T>
+void ArithmeticBEAVYInputGateSender<T>::load_setup(PreprocessingRecord& record) {
+  output_->get_secret_share() = record.read_ints<T>();
+  output_->get_public_share() = record.read_ints<T>();
+  output_->set_setup_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYInputGateSender<T>::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+  }
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .online_bytes_ = num_simd_ * sizeof(T),
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticBEAVYInputGateSender<std::uint8_t>;
 template class ArithmeticBEAVYInputGateSender<std::uint16_t>;
 template class ArithmeticBEAVYInputGateSender<std::uint32_t>;
@@ -1377,9 +2827,13 @@ ArithmeticBEAVYInputGateReceiver<T>::ArithmeticBEAVYInputGateReceiver(std::size_
       num_simd_(num_simd),
       input_owner_(input_owner),
       input_id_(beavy_provider.get_next_input_id(1)),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(num_simd) : 0),
       output_(std::make_shared<ArithmeticBEAVYWire<T>>(num_simd)) {
-  public_share_future_ =
-      beavy_provider_.register_for_ints_message<T>(input_owner_, gate_id_, num_simd);
+  if (!non_interactive_) {
+    public_share_future_ =
+        beavy_provider_.register_for_ints_message<T>(input_owner_, gate_id_, num_simd);
+  }
 }
 
 template <typename T>
@@ -1395,6 +2849,9 @@ void ArithmeticBEAVYInputGateReceiver<T>::evaluate_setup() {
   auto& mbp = beavy_provider_.get_motion_base_provider();
   auto& rng = mbp.get_their_randomness_generator(input_owner_);
   output_->get_secret_share() = rng.GetUnsigned<T>(input_id_, num_simd_);
+  if (non_interactive_) {
+    output_->get_public_share() = rng.GetUnsignedPacked<T>(public_input_id_, num_simd_);
+  }
   output_->set_setup_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1416,7 +2873,9 @@ void ArithmeticBEAVYInputGateReceiver<T>::evaluate_online() {
     }
   }
 
-  output_->get_public_share() = public_share_future_.get();
+  if (!non_interactive_) {
+    output_->get_public_share() = public_share_future_.get();
+  }
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1428,11 +2887,269 @@ void ArithmeticBEAVYInputGateReceiver<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+void ArithmeticBEAVYInputGateReceiver<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(output_->get_secret_share());
+}
+
+template <typename T>
+void ArithmeticBEAVYInputGateReceiver<T>::load_setup(PreprocessingRecord& record) {
+  output_->get_secret_share() = record.read_ints<T>();
+  output_->set_setup_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYInputGateReceiver<T>::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+  }
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY, .online_rounds_ = 1};
+}
+
 template class ArithmeticBEAVYInputGateReceiver<std::uint8_t>;
 template class ArithmeticBEAVYInputGateReceiver<std::uint16_t>;
 template class ArithmeticBEAVYInputGateReceiver<std::uint32_t>;
 template class ArithmeticBEAVYInputGateReceiver<std::uint64_t>;
 
+template <typename T>
+ArithmeticBEAVYBulkInputGateSender<T>::ArithmeticBEAVYBulkInputGateSender(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, std::span<const T> input,
+    std::size_t chunk_size)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      input_(input),
+      chunk_size_(chunk_size),
+      input_id_(beavy_provider.get_next_input_id(input.size())),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(input.size()) : 0) {
+  if (chunk_size_ == 0) {
+    throw std::invalid_argument("ArithmeticBEAVYBulkInputGateSender: chunk_size must be positive");
+  }
+  const auto num_chunks = get_num_chunks(input_.size(), chunk_size_);
+  outputs_.reserve(num_chunks);
+  for (std::size_t offset = 0; offset < input_.size(); offset += chunk_size_) {
+    outputs_.push_back(std::make_shared<ArithmeticBEAVYWire<T>>(
+        std::min(chunk_size_, input_.size() - offset)));
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYBulkInputGateSender<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateSender<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  auto my_id = beavy_provider_.get_my_id();
+  auto num_parties = beavy_provider_.get_num_parties();
+  auto& mbp = beavy_provider_.get_motion_base_provider();
+  std::vector<T> their_share;
+  for (std::size_t chunk_i = 0; chunk_i < outputs_.size(); ++chunk_i) {
+    auto& wire = *outputs_[chunk_i];
+    const auto offset = chunk_i * chunk_size_;
+    const auto num_values = wire.get_num_simd();
+    auto& my_secret_share = wire.get_secret_share();
+    auto& my_public_share = wire.get_public_share();
+    their_share.resize(num_values);
+    if (non_interactive_) {
+      auto& rng = mbp.get_my_randomness_generator(1 - my_id);
+      my_public_share.resize(num_values);
+      rng.GetUnsignedPacked<T>(public_input_id_ + offset, num_values, my_public_share.data());
+      rng.GetUnsignedPacked<T>(input_id_ + offset, num_values, their_share.data());
+      const auto* input = input_.data() + offset;
+      my_secret_share.resize(num_values);
+      for (std::size_t i = 0; i < num_values; ++i) {
+        my_secret_share[i] = my_public_share[i] - input[i] - their_share[i];
+      }
+      wire.set_setup_ready();
+      continue;
+    }
+    my_secret_share = Helpers::RandomVector<T>(num_values);
+    my_public_share = my_secret_share;
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      if (party_id == my_id) {
+        continue;
+      }
+      // the chunks use disjoint ranges of the input ids
+      auto& rng = mbp.get_my_randomness_generator(party_id);
+      rng.GetUnsignedPacked<T>(input_id_ + offset, num_values, their_share.data());
+      std::transform(std::begin(my_public_share), std::end(my_public_share),
+                     std::begin(their_share), std::begin(my_public_share), std::plus{});
+    }
+    wire.set_setup_ready();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateSender<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYBulkInputGateSender<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateSender<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  if (non_interactive_) {
+    // the public shares have been fixed in the setup
+    for (auto& wire : outputs_) {
+      wire->set_online_ready();
+    }
+    return;
+  }
+
+  // send each chunk as soon as its share is computed
+  for (std::size_t chunk_i = 0; chunk_i < outputs_.size(); ++chunk_i) {
+    auto& wire = *outputs_[chunk_i];
+    auto& my_public_share = wire.get_public_share();
+    const auto* input = input_.data() + chunk_i * chunk_size_;
+    std::transform(std::begin(my_public_share), std::end(my_public_share), input,
+                   std::begin(my_public_share), std::plus{});
+    wire.set_online_ready();
+    beavy_provider_.broadcast_ints_message(gate_id_ + chunk_i, my_public_share);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateSender<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYBulkInputGateSender<T>::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+  }
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .online_bytes_ = input_.size() * sizeof(T),
+                  .online_rounds_ = 1};
+}
+
+template class ArithmeticBEAVYBulkInputGateSender<std::uint8_t>;
+template class ArithmeticBEAVYBulkInputGateSender<std::uint16_t>;
+template class ArithmeticBEAVYBulkInputGateSender<std::uint32_t>;
+template class ArithmeticBEAVYBulkInputGateSender<std::uint64_t>;
+
+template <typename T>
+ArithmeticBEAVYBulkInputGateReceiver<T>::ArithmeticBEAVYBulkInputGateReceiver(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, std::size_t num_values,
+    std::size_t chunk_size, std::size_t input_owner)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      num_values_(num_values),
+      chunk_size_(chunk_size),
+      input_owner_(input_owner),
+      input_id_(beavy_provider.get_next_input_id(num_values)),
+      non_interactive_(beavy_provider.get_non_interactive_inputs()),
+      public_input_id_(non_interactive_ ? beavy_provider.get_next_input_id(num_values) : 0) {
+  if (chunk_size_ == 0) {
+    throw std::invalid_argument(
+        "ArithmeticBEAVYBulkInputGateReceiver: chunk_size must be positive");
+  }
+  const auto num_chunks =
+      ArithmeticBEAVYBulkInputGateSender<T>::get_num_chunks(num_values_, chunk_size_);
+  outputs_.reserve(num_chunks);
+  public_share_futures_.reserve(num_chunks);
+  for (std::size_t chunk_i = 0; chunk_i < num_chunks; ++chunk_i) {
+    const auto chunk_values = std::min(chunk_size_, num_values_ - chunk_i * chunk_size_);
+    outputs_.push_back(std::make_shared<ArithmeticBEAVYWire<T>>(chunk_values));
+    if (!non_interactive_) {
+      public_share_futures_.push_back(
+          beavy_provider_.register_for_ints_message<T>(input_owner_, gate_id_ + chunk_i,
+                                                       chunk_values));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  auto& mbp = beavy_provider_.get_motion_base_provider();
+  auto& rng = mbp.get_their_randomness_generator(input_owner_);
+  for (std::size_t chunk_i = 0; chunk_i < outputs_.size(); ++chunk_i) {
+    auto& wire = *outputs_[chunk_i];
+    auto& secret_share = wire.get_secret_share();
+    rng.GetUnsignedPacked<T>(input_id_ + chunk_i * chunk_size_, wire.get_num_simd(),
+                             secret_share.data());
+    if (non_interactive_) {
+      auto& public_share = wire.get_public_share();
+      public_share.resize(wire.get_num_simd());
+      rng.GetUnsignedPacked<T>(public_input_id_ + chunk_i * chunk_size_, wire.get_num_simd(),
+                               public_share.data());
+    }
+    wire.set_setup_ready();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  // the chunks arrive in order, each one can be used as soon as it is there
+  for (std::size_t chunk_i = 0; chunk_i < outputs_.size(); ++chunk_i) {
+    if (!non_interactive_) {
+      outputs_[chunk_i]->get_public_share() = public_share_futures_[chunk_i].get();
+    }
+    outputs_[chunk_i]->set_online_ready();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYBulkInputGateReceiver<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYBulkInputGateReceiver<T>::get_cost() const {
+  if (non_interactive_) {
+    return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+  }
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY, .online_rounds_ = 1};
+}
+
+template class ArithmeticBEAVYBulkInputGateReceiver<std::uint8_t>;
+template class ArithmeticBEAVYBulkInputGateReceiver<std::uint16_t>;
+template class ArithmeticBEAVYBulkInputGateReceiver<std::uint32_t>;
+template class ArithmeticBEAVYBulkInputGateReceiver<std::uint64_t>;
+
 template <typename T>
 ArithmeticBEAVYOutputGate<T>::ArithmeticBEAVYOutputGate(std::size_t gate_id,
                                                         BEAVYProvider& beavy_provider,
@@ -1443,9 +3160,11 @@ ArithmeticBEAVYOutputGate<T>::ArithmeticBEAVYOutputGate(std::size_t gate_id,
       output_owner_(output_owner),
       input_(std::move(input)) {
   std::size_t my_id = beavy_provider_.get_my_id();
-  if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
-    share_future_ =
-        beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, input_->get_num_simd());
+  if (output_owner_ == ALL_PARTIES) {
+    reconstruction_.emplace(beavy_provider_, gate_id_, input_->get_num_simd());
+  } else if (output_owner_ == my_id) {
+    share_futures_ =
+        beavy_provider_.register_for_ints_messages<T>(gate_id_, input_->get_num_simd());
   }
 }
 
@@ -1459,6 +3178,16 @@ ENCRYPTO::ReusableFiberFuture<std::vector<T>> ArithmeticBEAVYOutputGate<T>::get_
   }
 }
 
+template <typename T>
+std::pair<CommMixin*, std::size_t> ArithmeticBEAVYOutputGate<T>::get_fusable_output_message()
+    const {
+  // the shares are broadcast in the setup phase unless they are sent to a king or a single owner
+  if (!reconstruction_.has_value() || reconstruction_->uses_king()) {
+    return {nullptr, 0};
+  }
+  return {&beavy_provider_, input_->get_num_simd()};
+}
+
 template <typename T>
 void ArithmeticBEAVYOutputGate<T>::evaluate_setup() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1470,14 +3199,16 @@ void ArithmeticBEAVYOutputGate<T>::evaluate_setup() {
   }
 
   std::size_t my_id = beavy_provider_.get_my_id();
-  if (output_owner_ != my_id) {
+  if (output_owner_ == ALL_PARTIES) {
     input_->wait_setup();
-    auto my_secret_share = input_->get_secret_share();
-    if (output_owner_ == ALL_PARTIES) {
-      beavy_provider_.broadcast_ints_message(gate_id_, my_secret_share);
-    } else {
-      beavy_provider_.send_ints_message(output_owner_, gate_id_, my_secret_share);
+    reconstruction_->send_share(input_->get_secret_share());
+    // the king forwards the opened secret share ahead in the setup phase as well
+    if (reconstruction_->uses_king()) {
+      receive_shares();
     }
+  } else if (output_owner_ != my_id) {
+    input_->wait_setup();
+    beavy_provider_.send_ints_message(output_owner_, gate_id_, input_->get_secret_share());
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1501,15 +3232,12 @@ void ArithmeticBEAVYOutputGate<T>::evaluate_online() {
 
   std::size_t my_id = beavy_provider_.get_my_id();
   if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
-    input_->wait_setup();
-    auto my_secret_share = input_->get_secret_share();
-    const auto other_secret_share = share_future_.get();
-    std::transform(std::begin(my_secret_share), std::end(my_secret_share),
-                   std::begin(other_secret_share), std::begin(my_secret_share), std::plus{});
+    receive_shares();
+    auto output = secret_share_;
     input_->wait_online();
     std::transform(std::begin(input_->get_public_share()), std::end(input_->get_public_share()),
-                   std::begin(my_secret_share), std::begin(my_secret_share), std::minus{});
-    output_promise_.set_value(std::move(my_secret_share));
+                   std::begin(output), std::begin(output), std::minus{});
+    output_promise_.set_value(std::move(output));
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1521,6 +3249,62 @@ void ArithmeticBEAVYOutputGate<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+void ArithmeticBEAVYOutputGate<T>::receive_shares() {
+  if (shares_received_) {
+    return;
+  }
+  input_->wait_setup();
+  if (reconstruction_) {
+    secret_share_ = reconstruction_->get(input_->get_secret_share());
+  } else {
+    secret_share_ = input_->get_secret_share();
+    std::size_t my_id = beavy_provider_.get_my_id();
+    std::size_t num_parties = beavy_provider_.get_num_parties();
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      if (party_id == my_id) {
+        continue;
+      }
+      const auto other_share = share_futures_[party_id].get();
+      std::transform(std::begin(secret_share_), std::end(secret_share_), std::begin(other_share),
+                     std::begin(secret_share_), std::plus{});
+    }
+  }
+  shares_received_ = true;
+}
+
+template <typename T>
+void ArithmeticBEAVYOutputGate<T>::save_setup(PreprocessingWriter& writer) {
+  std::size_t my_id = beavy_provider_.get_my_id();
+  if (output_owner_ != ALL_PARTIES && output_owner_ != my_id) {
+    return;
+  }
+  // the other parties have sent their shares during the setup phase
+  receive_shares();
+  writer.write_ints(secret_share_);
+}
+
+template <typename T>
+void ArithmeticBEAVYOutputGate<T>::load_setup(PreprocessingRecord& record) {
+  std::size_t my_id = beavy_provider_.get_my_id();
+  if (output_owner_ == ALL_PARTIES || output_owner_ == my_id) {
+    secret_share_ = record.read_ints<T>();
+    shares_received_ = true;
+  }
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYOutputGate<T>::get_cost() const {
+  // the secret share is sent ahead in the setup phase
+  if (reconstruction_) {
+    return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                    .setup_bytes_ = reconstruction_->get_num_bytes_sent()};
+  }
+  const bool send = output_owner_ != beavy_provider_.get_my_id();
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .setup_bytes_ = send ? input_->get_num_simd() * sizeof(T) : 0};
+}
+
 template class ArithmeticBEAVYOutputGate<std::uint8_t>;
 template class ArithmeticBEAVYOutputGate<std::uint16_t>;
 template class ArithmeticBEAVYOutputGate<std::uint32_t>;
@@ -1552,7 +3336,19 @@ void ArithmeticBEAVYOutputShareGate<T>::evaluate_setup() {
 template <typename T>
 void ArithmeticBEAVYOutputShareGate<T>::evaluate_online() {
   input_->wait_online();
-  public_share_promise_.set_value(input_->get_public_share());
+  if (input_->is_additively_shared()) {
+    // such that the public share minus the secret share is this party's additive share
+    input_->wait_setup();
+    public_share_promise_.set_value(
+        Helpers::AddVectors(input_->get_public_share(), input_->get_secret_share()));
+  } else {
+    public_share_promise_.set_value(input_->get_public_share());
+  }
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYOutputShareGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
 }
 
 template class ArithmeticBEAVYOutputShareGate<std::uint8_t>;
@@ -1560,6 +3356,101 @@ template class ArithmeticBEAVYOutputShareGate<std::uint16_t>;
 template class ArithmeticBEAVYOutputShareGate<std::uint32_t>;
 template class ArithmeticBEAVYOutputShareGate<std::uint64_t>;
 
+template <typename T>
+ArithmeticBEAVYReconstructGate<T>::ArithmeticBEAVYReconstructGate(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, ArithmeticBEAVYWireVector<T>&& inputs)
+    : NewGate(gate_id), beavy_provider_(beavy_provider), inputs_(std::move(inputs)) {
+  if (inputs_.empty()) {
+    throw std::logic_error("number of wires need to be positive");
+  }
+  outputs_.reserve(inputs_.size());
+  for (const auto& wire : inputs_) {
+    if (!wire->is_additively_shared()) {
+      throw std::logic_error("ArithmeticBEAVYReconstructGate expects additively shared wires");
+    }
+    outputs_.push_back(std::make_shared<ArithmeticBEAVYWire<T>>(wire->get_num_simd()));
+  }
+  auto my_id = beavy_provider_.get_my_id();
+  share_future_ =
+      beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, get_num_values());
+}
+
+template <typename T>
+std::size_t ArithmeticBEAVYReconstructGate<T>::get_num_values() const noexcept {
+  std::size_t num_values = 0;
+  for (const auto& wire : inputs_) {
+    num_values += wire->get_num_simd();
+  }
+  return num_values;
+}
+
+template <typename T>
+void ArithmeticBEAVYReconstructGate<T>::evaluate_setup() {
+  for (std::size_t wire_i = 0; wire_i < inputs_.size(); ++wire_i) {
+    inputs_[wire_i]->wait_setup();
+    outputs_[wire_i]->get_secret_share() = inputs_[wire_i]->get_secret_share();
+    outputs_[wire_i]->set_setup_ready();
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYReconstructGate<T>::evaluate_online() {
+  hot_log("ArithmeticBEAVYReconstructGate::evaluate_online",
+          {{"gate_id", gate_id_}, {"num_values", get_num_values()}});
+
+  // [Delta]_i = [x]_i + [delta]_i
+  std::vector<T> Delta_share;
+  Delta_share.reserve(get_num_values());
+  for (const auto& wire : inputs_) {
+    wire->wait_online();
+    const auto& x_share = wire->get_public_share();
+    const auto& delta_share = wire->get_secret_share();
+    std::transform(std::begin(x_share), std::end(x_share), std::begin(delta_share),
+                   std::back_inserter(Delta_share), std::plus{});
+  }
+  beavy_provider_.broadcast_ints_message(gate_id_, Delta_share);
+  const auto other_share = share_future_.get();
+  std::transform(std::begin(Delta_share), std::end(Delta_share), std::begin(other_share),
+                 std::begin(Delta_share), std::plus{});
+
+  std::size_t offset = 0;
+  for (auto& wire_o : outputs_) {
+    const auto num_simd = wire_o->get_num_simd();
+    wire_o->get_public_share().assign(Delta_share.begin() + offset,
+                                      Delta_share.begin() + offset + num_simd);
+    offset += num_simd;
+    wire_o->set_online_ready();
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYReconstructGate<T>::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_ints(wire->get_secret_share());
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYReconstructGate<T>::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_secret_share() = record.read_ints<T>();
+    wire->set_setup_ready();
+  }
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYReconstructGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .online_bytes_ = get_num_values() * sizeof(T),
+                  .online_rounds_ = 1,
+                  .deferred_rounds_ = 1};
+}
+
+template class ArithmeticBEAVYReconstructGate<std::uint8_t>;
+template class ArithmeticBEAVYReconstructGate<std::uint16_t>;
+template class ArithmeticBEAVYReconstructGate<std::uint32_t>;
+template class ArithmeticBEAVYReconstructGate<std::uint64_t>;
+
 namespace detail {
 
 template <typename T>
@@ -1612,18 +3503,17 @@ template class BasicBooleanXArithmeticBEAVYBinaryGate<std::uint64_t>;
 
 template <typename T>
 BasicArithmeticBooleanBEAVYBinaryGate<T>::BasicArithmeticBooleanBEAVYBinaryGate(
-    std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&& in_a, ArithmeticBEAVYWireP<T>&& in_b)
+    std::size_t gate_id, BEAVYProvider& beavy_provider, ArithmeticBEAVYWireP<T>&& in_a,
+    ArithmeticBEAVYWireP<T>&& in_b)
     : NewGate(gate_id),
       num_wires_(1),
       input_a_(std::move(in_a)),
       input_b_(std::move(in_b)) {
   auto num_simd = input_a_->get_num_simd();
-  if (input_a_->get_num_simd() != input_b_->get_num_simd()) {
+  if (input_b_ && input_a_->get_num_simd() != input_b_->get_num_simd()) {
     throw std::logic_error("number of SIMD values need to be the same for all wires");
   }
-  outputs_.reserve(num_wires_);
-  std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+  outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
 }
 
 template class BasicArithmeticBooleanBEAVYBinaryGate<std::uint8_t>;
@@ -1640,6 +3530,7 @@ ArithmeticBEAVYNEGGate<T>::ArithmeticBEAVYNEGGate(std::size_t gate_id,
     : detail::BasicArithmeticBEAVYUnaryGate<T>(gate_id, beavy_provider, std::move(in)) {
   this->output_->get_public_share().resize(this->input_->get_num_simd());
   this->output_->get_secret_share().resize(this->input_->get_num_simd());
+  this->output_->set_additively_shared(this->input_->is_additively_shared());
 }
 
 template <typename T>
@@ -1662,6 +3553,22 @@ void ArithmeticBEAVYNEGGate<T>::evaluate_online() {
   this->output_->set_online_ready();
 }
 
+template <typename T>
+void ArithmeticBEAVYNEGGate<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(this->output_->get_secret_share());
+}
+
+template <typename T>
+void ArithmeticBEAVYNEGGate<T>::load_setup(PreprocessingRecord& record) {
+  this->output_->get_secret_share() = record.read_ints<T>();
+  this->output_->set_setup_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYNEGGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+}
+
 template class ArithmeticBEAVYNEGGate<std::uint8_t>;
 template class ArithmeticBEAVYNEGGate<std::uint16_t>;
 template class ArithmeticBEAVYNEGGate<std::uint32_t>;
@@ -1673,9 +3580,30 @@ ArithmeticBEAVYADDGate<T>::ArithmeticBEAVYADDGate(std::size_t gate_id,
                                                   ArithmeticBEAVYWireP<T>&& in_a,
                                                   ArithmeticBEAVYWireP<T>&& in_b)
     : detail::BasicArithmeticBEAVYBinaryGate<T>(gate_id, beavy_provider, std::move(in_a),
-                                                std::move(in_b)) {
+                                                std::move(in_b)),
+      is_party_0_(beavy_provider.get_my_id() == 0) {
   this->output_->get_public_share().resize(this->input_a_->get_num_simd());
   this->output_->get_secret_share().resize(this->input_a_->get_num_simd());
+  this->output_->set_additively_shared(this->input_a_->is_additively_shared() ||
+                                       this->input_b_->is_additively_shared());
+}
+
+// additive share of a masked or additively shared value, i.e., Delta - delta^0 for party 0 and
+// -delta^1 for party 1
+template <typename T>
+static std::vector<T> get_additive_share(const ArithmeticBEAVYWire<T>& wire, bool is_party_0) {
+  if (wire.is_additively_shared()) {
+    return wire.get_public_share();
+  }
+  const auto& delta = wire.get_secret_share();
+  std::vector<T> share(delta.size());
+  if (is_party_0) {
+    std::transform(std::begin(wire.get_public_share()), std::end(wire.get_public_share()),
+                   std::begin(delta), std::begin(share), std::minus{});
+  } else {
+    std::transform(std::begin(delta), std::end(delta), std::begin(share), std::negate{});
+  }
+  return share;
 }
 
 template <typename T>
@@ -1696,18 +3624,128 @@ void ArithmeticBEAVYADDGate<T>::evaluate_online() {
   this->input_a_->wait_online();
   this->input_b_->wait_online();
   assert(this->output_->get_public_share().size() == this->input_a_->get_num_simd());
-  std::transform(std::begin(this->input_a_->get_public_share()),
-                 std::end(this->input_a_->get_public_share()),
-                 std::begin(this->input_b_->get_public_share()),
-                 std::begin(this->output_->get_public_share()), std::plus{});
+  if (this->input_a_->is_additively_shared() == this->input_b_->is_additively_shared()) {
+    std::transform(std::begin(this->input_a_->get_public_share()),
+                   std::end(this->input_a_->get_public_share()),
+                   std::begin(this->input_b_->get_public_share()),
+                   std::begin(this->output_->get_public_share()), std::plus{});
+  } else {
+    // the masked input is turned into an additive share locally
+    const auto share_a = get_additive_share(*this->input_a_, is_party_0_);
+    const auto share_b = get_additive_share(*this->input_b_, is_party_0_);
+    std::transform(std::begin(share_a), std::end(share_a), std::begin(share_b),
+                   std::begin(this->output_->get_public_share()), std::plus{});
+  }
   this->output_->set_online_ready();
 }
 
+template <typename T>
+void ArithmeticBEAVYADDGate<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(this->output_->get_secret_share());
+}
+
+template <typename T>
+void ArithmeticBEAVYADDGate<T>::load_setup(PreprocessingRecord& record) {
+  this->output_->get_secret_share() = record.read_ints<T>();
+  this->output_->set_setup_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYADDGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+}
+
 template class ArithmeticBEAVYADDGate<std::uint8_t>;
 template class ArithmeticBEAVYADDGate<std::uint16_t>;
 template class ArithmeticBEAVYADDGate<std::uint32_t>;
 template class ArithmeticBEAVYADDGate<std::uint64_t>;
 
+template <typename T>
+ArithmeticBEAVYLaneMapGate<T>::ArithmeticBEAVYLaneMapGate(std::size_t gate_id,
+                                                          BEAVYProvider& beavy_provider,
+                                                          ArithmeticBEAVYWireVector<T>&& inputs,
+                                                          std::vector<std::size_t>&& sources)
+    : NewGate(gate_id),
+      is_party_0_(beavy_provider.get_my_id() == 0),
+      inputs_(std::move(inputs)),
+      sources_(std::move(sources)) {
+  if (inputs_.empty() || sources_.empty()) {
+    throw std::logic_error("ArithmeticBEAVYLaneMapGate needs inputs and output values");
+  }
+  std::size_t num_input_values = 0;
+  for (const auto& wire : inputs_) {
+    num_input_values += wire->get_num_simd();
+  }
+  if (std::any_of(std::begin(sources_), std::end(sources_),
+                  [num_input_values](auto value_i) { return value_i >= num_input_values; })) {
+    throw std::logic_error(fmt::format(
+        "ArithmeticBEAVYLaneMapGate: source value out of range of the {} input values",
+        num_input_values));
+  }
+  output_ = std::make_shared<ArithmeticBEAVYWire<T>>(sources_.size());
+  output_->set_additively_shared(
+      std::any_of(std::begin(inputs_), std::end(inputs_),
+                  [](const auto& wire) { return wire->is_additively_shared(); }));
+}
+
+template <typename T>
+void ArithmeticBEAVYLaneMapGate<T>::evaluate_setup() {
+  std::vector<T> delta;
+  for (const auto& wire : inputs_) {
+    wire->wait_setup();
+    const auto& share = wire->get_secret_share();
+    delta.insert(std::end(delta), std::begin(share), std::end(share));
+  }
+  auto& output_delta = output_->get_secret_share();
+  output_delta.resize(sources_.size());
+  std::transform(std::begin(sources_), std::end(sources_), std::begin(output_delta),
+                 [&delta](auto value_i) { return delta[value_i]; });
+  output_->set_setup_ready();
+}
+
+template <typename T>
+void ArithmeticBEAVYLaneMapGate<T>::evaluate_online() {
+  const bool additive = output_->is_additively_shared();
+  std::vector<T> Delta;
+  for (const auto& wire : inputs_) {
+    wire->wait_online();
+    if (additive && !wire->is_additively_shared()) {
+      wire->wait_setup();
+      const auto share = get_additive_share(*wire, is_party_0_);
+      Delta.insert(std::end(Delta), std::begin(share), std::end(share));
+    } else {
+      const auto& share = wire->get_public_share();
+      Delta.insert(std::end(Delta), std::begin(share), std::end(share));
+    }
+  }
+  auto& output_Delta = output_->get_public_share();
+  output_Delta.resize(sources_.size());
+  std::transform(std::begin(sources_), std::end(sources_), std::begin(output_Delta),
+                 [&Delta](auto value_i) { return Delta[value_i]; });
+  output_->set_online_ready();
+}
+
+template <typename T>
+void ArithmeticBEAVYLaneMapGate<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(output_->get_secret_share());
+}
+
+template <typename T>
+void ArithmeticBEAVYLaneMapGate<T>::load_setup(PreprocessingRecord& record) {
+  output_->get_secret_share() = record.read_ints<T>();
+  output_->set_setup_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYLaneMapGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY};
+}
+
+template class ArithmeticBEAVYLaneMapGate<std::uint8_t>;
+template class ArithmeticBEAVYLaneMapGate<std::uint16_t>;
+template class ArithmeticBEAVYLaneMapGate<std::uint32_t>;
+template class ArithmeticBEAVYLaneMapGate<std::uint64_t>;
+
 template <typename T>
 ArithmeticBEAVYMULNIGate<T>::ArithmeticBEAVYMULNIGate(std::size_t gate_id,
                                                   BEAVYProvider& beavy_provider,
@@ -1723,6 +3761,7 @@ ArithmeticBEAVYMULNIGate<T>::ArithmeticBEAVYMULNIGate(std::size_t gate_id,
   auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
   mult_sender_ = ap.template register_integer_multiplication_send<T>(num_simd);
   mult_receiver_ = ap.template register_integer_multiplication_receive<T>(num_simd);
+  this->output_->set_additively_shared();
 }
 
 template <typename T>
@@ -1740,38 +3779,31 @@ void ArithmeticBEAVYMULNIGate<T>::evaluate_setup() {
 
   auto num_simd = this->input_a_->get_num_simd();
 
-  this->output_->get_secret_share() = Helpers::RandomVector<T>(num_simd); 
+  this->output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(this->gate_id_, num_simd);
   this->output_->set_setup_ready();
 
   this->input_a_->wait_setup();
   this->input_b_->wait_setup();
   const auto& delta_a_share = this->input_a_->get_secret_share();
   const auto& delta_b_share = this->input_b_->get_secret_share();
-  const auto& delta_y_share = this->output_->get_secret_share();
 
   mult_receiver_->set_inputs(delta_a_share);
   mult_sender_->set_inputs(delta_b_share);
 
-  Delta_y_share_.resize(num_simd);
-  // [Delta_y]_i = [delta_a]_i * [delta_b]_i
-  std::transform(std::begin(delta_a_share), std::end(delta_a_share), std::begin(delta_b_share),
-                 std::begin(Delta_y_share_), std::multiplies{});
-  // [Delta_y]_i += [delta_y]_i // don't do this
-  // std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_y_share),
-  //                std::begin(Delta_y_share_), std::plus{});
-
   mult_receiver_->compute_outputs();
   mult_sender_->compute_outputs();
   // [[delta_a]_i * [delta_b]_(1-i)]_i
-  auto delta_ab_share1 = mult_receiver_->get_outputs();
+  const auto delta_ab_share1 = mult_receiver_->get_outputs();
   // [[delta_b]_i * [delta_a]_(1-i)]_i
-  auto delta_ab_share2 = mult_sender_->get_outputs();
-  // [Delta_y]_i += [[delta_a]_i * [delta_b]_(1-i)]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_ab_share1),
-                 std::begin(Delta_y_share_), std::plus{});
-  // [Delta_y]_i += [[delta_b]_i * [delta_a]_(1-i)]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_ab_share2),
-                 std::begin(Delta_y_share_), std::plus{});
+  const auto delta_ab_share2 = mult_sender_->get_outputs();
+  // [Delta_y]_i = [delta_a]_i * [delta_b]_i + [[delta_a]_i * [delta_b]_(1-i)]_i
+  //               + [[delta_b]_i * [delta_a]_(1-i)]_i,
+  // without [delta_y]_i since the output is additively shared
+  Delta_y_share_.resize(num_simd);
+  beavy_mul_setup(Delta_y_share_.data(), delta_a_share.data(), delta_b_share.data(),
+                  static_cast<const T*>(nullptr), delta_ab_share1.data(), delta_ab_share2.data(),
+                  num_simd);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1799,36 +3831,15 @@ void ArithmeticBEAVYMULNIGate<T>::evaluate_online() {
   const auto& Delta_b = this->input_b_->get_public_share();
   const auto& delta_a_share = this->input_a_->get_secret_share();
   const auto& delta_b_share = this->input_b_->get_secret_share();
-  std::vector<T> tmp(num_simd);
 
   // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_ab]_i
 
-  // [Delta_y]_i -= Delta_a * [delta_b]_i
-  std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(delta_b_share), std::begin(tmp),
-                 std::multiplies{});
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                 std::begin(Delta_y_share_), std::minus{});
-
-  // [Delta_y]_i -= Delta_b * [delta_a]_i
-  std::transform(std::begin(Delta_b), std::end(Delta_b), std::begin(delta_a_share), std::begin(tmp),
-                 std::multiplies{});
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                 std::begin(Delta_y_share_), std::minus{});
-
+  // [Delta_y]_i -= Delta_a * [delta_b]_i + Delta_b * [delta_a]_i
   // [Delta_y]_i += Delta_ab (== Delta_a * Delta_b)
-  if (beavy_provider_.is_my_job(this->gate_id_)) {
-    std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(Delta_b), std::begin(tmp),
-                   std::multiplies{});
-    std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                   std::begin(Delta_y_share_), std::plus{});
-  }
-  // broadcast [Delta_y]_i
-  // beavy_provider_.broadcast_ints_message(this->gate_id_, Delta_y_share_);
-  // Delta_y = [Delta_y]_i + [Delta_y]_(1-i)
-  // std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                //  std::begin(share_future_.get()), std::begin(Delta_y_share_), std::plus{});
-  
-  this->output_->get_public_share() = std::move(Delta_y_share_); // !Parties have different public shares which corresponds to additive shares
+  beavy_mul_online(Delta_y_share_.data(), Delta_a.data(), Delta_b.data(), delta_a_share.data(),
+                   delta_b_share.data(), num_simd, beavy_provider_.is_my_job(this->gate_id_));
+  // the output is additively shared, its reconstruction is left to the gates which need it
+  this->output_->get_public_share() = std::move(Delta_y_share_);
   this->output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1858,8 +3869,16 @@ ArithmeticBEAVYMULGate<T>::ArithmeticBEAVYMULGate(std::size_t gate_id,
   share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, this->gate_id_,
                                                                this->input_a_->get_num_simd());
   auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
-  mult_sender_ = ap.template register_integer_multiplication_send<T>(num_simd);
-  mult_receiver_ = ap.template register_integer_multiplication_receive<T>(num_simd);
+  // the strong party multiplies both of its shares as receiver, see BEAVYProvider
+  const auto strong_party = beavy_provider_.get_strong_party();
+  if (!strong_party.has_value()) {
+    mult_sender_ = ap.template register_integer_multiplication_send<T>(num_simd);
+    mult_receiver_ = ap.template register_integer_multiplication_receive<T>(num_simd);
+  } else if (*strong_party == my_id) {
+    mult_receiver_ = ap.template register_integer_multiplication_receive<T>(2 * num_simd);
+  } else {
+    mult_sender_ = ap.template register_integer_multiplication_send<T>(2 * num_simd);
+  }
 }
 
 template <typename T>
@@ -1877,7 +3896,8 @@ void ArithmeticBEAVYMULGate<T>::evaluate_setup() {
 
   auto num_simd = this->input_a_->get_num_simd();
 
-  this->output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+  this->output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(this->gate_id_, num_simd);
   this->output_->set_setup_ready();
 
   this->input_a_->wait_setup();
@@ -1886,29 +3906,53 @@ void ArithmeticBEAVYMULGate<T>::evaluate_setup() {
   const auto& delta_b_share = this->input_b_->get_secret_share();
   const auto& delta_y_share = this->output_->get_secret_share();
 
-  mult_receiver_->set_inputs(delta_a_share);
-  mult_sender_->set_inputs(delta_b_share);
-
+  // with a strong party, its inputs [delta_a]_i || [delta_b]_i are multiplied with the other
+  // party's inputs [delta_b]_(1-i) || [delta_a]_(1-i)
+  auto concat = [](const std::vector<T>& first, const std::vector<T>& second) {
+    std::vector<T> result(first);
+    result.insert(std::end(result), std::begin(second), std::end(second));
+    return result;
+  };
+  if (mult_sender_ == nullptr) {
+    mult_receiver_->set_inputs(concat(delta_a_share, delta_b_share));
+  } else if (mult_receiver_ == nullptr) {
+    mult_sender_->set_inputs(concat(delta_b_share, delta_a_share));
+  } else {
+    mult_receiver_->set_inputs(delta_a_share);
+    mult_sender_->set_inputs(delta_b_share);
+  }
+
+  // [[delta_a]_i * [delta_b]_(1-i)]_i || [[delta_b]_i * [delta_a]_(1-i)]_i, of one
+  // multiplication with a strong party
+  std::vector<T> outputs_1;
+  std::vector<T> outputs_2;
+  const T* delta_ab_share1;
+  const T* delta_ab_share2;
+  if (mult_sender_ == nullptr || mult_receiver_ == nullptr) {
+    if (mult_sender_ == nullptr) {
+      mult_receiver_->compute_outputs();
+      outputs_1 = mult_receiver_->get_outputs();
+    } else {
+      mult_sender_->compute_outputs();
+      outputs_1 = mult_sender_->get_outputs();
+    }
+    delta_ab_share1 = outputs_1.data();
+    delta_ab_share2 = outputs_1.data() + num_simd;
+  } else {
+    mult_receiver_->compute_outputs();
+    mult_sender_->compute_outputs();
+    // [[delta_a]_i * [delta_b]_(1-i)]_i
+    outputs_1 = mult_receiver_->get_outputs();
+    // [[delta_b]_i * [delta_a]_(1-i)]_i
+    outputs_2 = mult_sender_->get_outputs();
+    delta_ab_share1 = outputs_1.data();
+    delta_ab_share2 = outputs_2.data();
+  }
+  // [Delta_y]_i = [delta_a]_i * [delta_b]_i + [delta_y]_i + [[delta_a]_i * [delta_b]_(1-i)]_i
+  //               + [[delta_b]_i * [delta_a]_(1-i)]_i
   Delta_y_share_.resize(num_simd);
-  // [Delta_y]_i = [delta_a]_i * [delta_b]_i
-  std::transform(std::begin(delta_a_share), std::end(delta_a_share), std::begin(delta_b_share),
-                 std::begin(Delta_y_share_), std::multiplies{});
-  // [Delta_y]_i += [delta_y]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_y_share),
-                 std::begin(Delta_y_share_), std::plus{});
-
-  mult_receiver_->compute_outputs();
-  mult_sender_->compute_outputs();
-  // [[delta_a]_i * [delta_b]_(1-i)]_i
-  auto delta_ab_share1 = mult_receiver_->get_outputs();
-  // [[delta_b]_i * [delta_a]_(1-i)]_i
-  auto delta_ab_share2 = mult_sender_->get_outputs();
-  // [Delta_y]_i += [[delta_a]_i * [delta_b]_(1-i)]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_ab_share1),
-                 std::begin(Delta_y_share_), std::plus{});
-  // [Delta_y]_i += [[delta_b]_i * [delta_a]_(1-i)]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_ab_share2),
-                 std::begin(Delta_y_share_), std::plus{});
+  beavy_mul_setup(Delta_y_share_.data(), delta_a_share.data(), delta_b_share.data(),
+                  delta_y_share.data(), delta_ab_share1, delta_ab_share2, num_simd);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1936,29 +3980,13 @@ void ArithmeticBEAVYMULGate<T>::evaluate_online() {
   const auto& Delta_b = this->input_b_->get_public_share();
   const auto& delta_a_share = this->input_a_->get_secret_share();
   const auto& delta_b_share = this->input_b_->get_secret_share();
-  std::vector<T> tmp(num_simd);
 
   // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_ab]_i
 
-  // [Delta_y]_i -= Delta_a * [delta_b]_i
-  std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(delta_b_share), std::begin(tmp),
-                 std::multiplies{});
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                 std::begin(Delta_y_share_), std::minus{});
-
-  // [Delta_y]_i -= Delta_b * [delta_a]_i
-  std::transform(std::begin(Delta_b), std::end(Delta_b), std::begin(delta_a_share), std::begin(tmp),
-                 std::multiplies{});
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                 std::begin(Delta_y_share_), std::minus{});
-
+  // [Delta_y]_i -= Delta_a * [delta_b]_i + Delta_b * [delta_a]_i
   // [Delta_y]_i += Delta_ab (== Delta_a * Delta_b)
-  if (beavy_provider_.is_my_job(this->gate_id_)) {
-    std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(Delta_b), std::begin(tmp),
-                   std::multiplies{});
-    std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                   std::begin(Delta_y_share_), std::plus{});
-  }
+  beavy_mul_online(Delta_y_share_.data(), Delta_a.data(), Delta_b.data(), delta_a_share.data(),
+                   delta_b_share.data(), num_simd, beavy_provider_.is_my_job(this->gate_id_));
   // broadcast [Delta_y]_i
   beavy_provider_.broadcast_ints_message(this->gate_id_, Delta_y_share_);
   // Delta_y = [Delta_y]_i + [Delta_y]_(1-i)
@@ -1976,6 +4004,33 @@ void ArithmeticBEAVYMULGate<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+void ArithmeticBEAVYMULGate<T>::save_setup(PreprocessingWriter& writer) {
+  writer.write_ints(this->output_->get_secret_share());
+  writer.write_ints(Delta_y_share_);
+}
+
+template <typename T>
+void ArithmeticBEAVYMULGate<T>::load_setup(PreprocessingRecord& record) {
+  this->output_->get_secret_share() = record.read_ints<T>();
+  this->output_->set_setup_ready();
+  Delta_y_share_ = record.read_ints<T>();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYMULGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_simd = this->input_a_->get_num_simd();
+  // an integer multiplication in each direction with bit_size OTs of bit_size bits per value
+  const auto num_ots = bit_size * num_simd;
+  const auto setup_bits = product_ots_setup_bits(beavy_provider_, num_ots, bit_size);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = num_simd * sizeof(T),
+                  .num_ots_ = 2 * num_ots,
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticBEAVYMULGate<std::uint8_t>;
 template class ArithmeticBEAVYMULGate<std::uint16_t>;
 template class ArithmeticBEAVYMULGate<std::uint32_t>;
@@ -1986,20 +4041,35 @@ ArithmeticBEAVYEQEXPGate<T>::ArithmeticBEAVYEQEXPGate(std::size_t gate_id,
                                                   BEAVYProvider& beavy_provider,
                                                   ArithmeticBEAVYWireP<T>&& in_a,
                                                   ArithmeticBEAVYWireP<T>&& in_b)
+    : ArithmeticBEAVYEQEXPGate(gate_id, beavy_provider, std::move(in_a), std::move(in_b),
+                               in_b->get_public_share().at(0)) {}
+
+template <typename T>
+ArithmeticBEAVYEQEXPGate<T>::ArithmeticBEAVYEQEXPGate(std::size_t gate_id,
+                                                  BEAVYProvider& beavy_provider,
+                                                  ArithmeticBEAVYWireP<T>&& in_a,
+                                                  plain::ArithmeticPlainWireP<T>&& in_b)
+    : ArithmeticBEAVYEQEXPGate(gate_id, beavy_provider, std::move(in_a),
+                               ArithmeticBEAVYWireP<T>(), in_b->get_data().at(0)) {}
+
+template <typename T>
+ArithmeticBEAVYEQEXPGate<T>::ArithmeticBEAVYEQEXPGate(std::size_t gate_id,
+                                                  BEAVYProvider& beavy_provider,
+                                                  ArithmeticBEAVYWireP<T>&& in_a,
+                                                  ArithmeticBEAVYWireP<T>&& in_b,
+                                                  std::size_t vec_size)
     : detail::BasicArithmeticBooleanBEAVYBinaryGate<T>(gate_id, beavy_provider, std::move(in_a),
                                                 std::move(in_b)),
-      beavy_provider_(beavy_provider) {
+      beavy_provider_(beavy_provider),
+      vec_size_(vec_size) {
   auto my_id = beavy_provider_.get_my_id();
   auto num_simd = this->input_a_->get_num_simd();
-  size_t vec_size = this->input_b_->get_public_share()[0];
-  std::cout<< "vs: " << vec_size << std::endl;
-  assert(vec_size < 100000);
-  assert(vec_size > 0);
-  share_future_1 = beavy_provider_.register_for_bits_message(1 - my_id, this->gate_id_, vec_size*num_simd, 0);
+  hot_log("ArithmeticBEAVYEQEXPGate", {{"gate_id", gate_id}, {"vec_size", vec_size_}});
+  assert(vec_size_ < 100000);
+  assert(vec_size_ > 0);
+  share_future_1 =
+      beavy_provider_.register_for_bits_message(1 - my_id, this->gate_id_, vec_size_ * num_simd, 0);
   share_future_2 = beavy_provider_.register_for_bits_message(1 - my_id, this->gate_id_, num_simd, 1);
-  auto& otp = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
-  ot_sender_ = otp.RegisterSendXCOTBit(vec_size*num_simd);
-  ot_receiver_ = otp.RegisterReceiveXCOTBit(vec_size*num_simd);
 }
 
 template <typename T>
@@ -2010,116 +4080,278 @@ void ArithmeticBEAVYEQEXPGate<T>::evaluate_setup() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
-      logger->LogTrace(fmt::format("Gate {}: BooleanBEAVYDOTGate::evaluate_setup start", this->gate_id));
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYEQEXPGate::evaluate_setup start", this->gate_id_));
     }
   }
-  std::cout<< "eqexp setup" << std::endl;
+  hot_log("ArithmeticBEAVYEQEXPGate::evaluate_setup", {{"gate_id", this->gate_id_}});
 
+  // The masks of the one-hot rows are zero, so their products are zero as well and need no OTs:
+  // each party only draws its share of the output mask.
   auto num_simd = this->input_a_->get_num_simd();
-  size_t vec_size = this->input_b_->get_public_share()[0];
+  this->outputs_[0]->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_bits(this->gate_id_, num_simd);
+  this->outputs_[0]->set_setup_ready();
 
-  auto num_bytes = Helpers::Convert::BitsToBytes(vec_size * num_simd);
-  delta_a_share_.Reserve(num_bytes);
-  delta_b_share_.Reserve(num_bytes);
-  Delta_y_share_.Reserve(num_bytes);
-  ENCRYPTO::BitVector<> rv = ENCRYPTO::BitVector(vec_size * num_simd, false);
-  delta_a_share_.Append(rv);
-  delta_b_share_.Append(rv);
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYEQEXPGate::evaluate_setup end", this->gate_id_));
+    }
+  }
+}
 
-  auto delta_ab_share = delta_a_share_ & delta_b_share_;
+template <typename T>
+void ArithmeticBEAVYEQEXPGate<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
 
-  ot_receiver_->SetChoices(delta_a_share_);
-  ot_receiver_->SendCorrections();
-  ot_sender_->SetCorrelations(delta_b_share_);
-  ot_sender_->SendMessages();
-  ot_receiver_->ComputeOutputs();
-  ot_sender_->ComputeOutputs();
-  delta_ab_share ^= ot_sender_->GetOutputs();
-  delta_ab_share ^= ot_receiver_->GetOutputs();
-  Delta_y_share_.Append(delta_ab_share);
+template <typename T>
+void ArithmeticBEAVYEQEXPGate<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
 
-  
+template <typename T>
+void ArithmeticBEAVYEQEXPGate<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYEQEXPGate::evaluate_online start", this->gate_id_));
+    }
+  }
 
-  this->outputs_[0]->get_secret_share() = ENCRYPTO::BitVector<>::Random(this->input_a_->get_num_simd());
-  this->outputs_[0]->set_setup_ready();
+  auto my_id = beavy_provider_.get_my_id();
+  auto num_simd = this->input_a_->get_num_simd();
+
+  // one-hot encoding of the public values: row pos has bit i set iff value i equals pos
+  this->input_a_->wait_online();
+  const auto& public_a = this->input_a_->get_public_share();
+  ENCRYPTO::BitVector<> one_hot(vec_size_ * num_simd);
+  for (std::size_t i = 0; i < num_simd; ++i) {
+    one_hot.Set(true, (public_a[i] % vec_size_) * num_simd + i);
+  }
+  beavy_provider_.broadcast_bits_message(this->gate_id_, one_hot, 0);
+  const auto other_one_hot = share_future_1.get();
+
+  // Party 0 folds the rows of Delta_a & Delta_b into its output share, party 1 only contributes
+  // its mask.  The columns are processed in tiles, so that the accumulator stays in cache while
+  // the rows are streamed through it word by word.
+  this->outputs_[0]->wait_setup();
+  auto Delta_y = this->outputs_[0]->get_secret_share();
+  if (my_id == 0) {
+    const std::size_t num_tiles = (num_simd + eqexp_tile_bits - 1) / eqexp_tile_bits;
+    for_each_chunk(exec_ctx, num_tiles, 1, [&](auto tiles_begin, auto tiles_end) {
+      for (std::size_t tile_i = tiles_begin; tile_i < tiles_end; ++tile_i) {
+        const auto tile_begin = tile_i * eqexp_tile_bits;
+        const auto tile_size = std::min(eqexp_tile_bits, num_simd - tile_begin);
+        const auto num_words = (tile_size + 63) / 64;
+        std::array<std::uint64_t, eqexp_tile_bits / 64> acc;
+        for (std::size_t word_k = 0; word_k < num_words; ++word_k) {
+          acc[word_k] = load_bit_word(Delta_y, tile_begin + 64 * word_k);
+        }
+        for (std::size_t row_j = 0; row_j < vec_size_; ++row_j) {
+          const auto row_begin = row_j * num_simd + tile_begin;
+          for (std::size_t word_k = 0; word_k < num_words; ++word_k) {
+            const auto pos = row_begin + 64 * word_k;
+            acc[word_k] ^= load_bit_word(one_hot, pos) & load_bit_word(other_one_hot, pos);
+          }
+        }
+        // bits of the last word beyond the tile belong to the next row and are not stored
+        for (std::size_t word_k = 0; word_k < num_words; ++word_k) {
+          const auto offset = 64 * word_k;
+          store_bit_word(Delta_y, tile_begin + offset, acc[word_k],
+                         std::min<std::size_t>(64, tile_size - offset));
+        }
+      }
+    });
+  }
 
+  beavy_provider_.broadcast_bits_message(this->gate_id_, Delta_y, 1);
+  Delta_y ^= share_future_2.get();
+
+  this->outputs_[0]->get_public_share() = std::move(Delta_y);
+  this->outputs_[0]->set_online_ready();
 
-  
-  
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
-      logger->LogTrace(fmt::format("Gate {}: ArithmeticBEAVYEQEXPGate::evaluate_setup end", this->gate_id));
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYEQEXPGate::evaluate_online end", this->gate_id_));
     }
   }
 }
 
 template <typename T>
-void ArithmeticBEAVYEQEXPGate<T>::evaluate_online() {
-  std::cout<< "eqexp online" << std::endl;
+std::optional<GateCost> ArithmeticBEAVYEQEXPGate<T>::get_cost() const {
+  const auto num_simd = this->input_a_->get_num_simd();
+  // the one-hot rows and the output share, no setup communication
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(vec_size_ * num_simd) +
+                                   Helpers::Convert::BitsToBytes(num_simd),
+                  .online_rounds_ = 2};
+}
+
+template class ArithmeticBEAVYEQEXPGate<std::uint8_t>;
+template class ArithmeticBEAVYEQEXPGate<std::uint16_t>;
+template class ArithmeticBEAVYEQEXPGate<std::uint32_t>;
+template class ArithmeticBEAVYEQEXPGate<std::uint64_t>;
+
+template <typename T>
+ArithmeticBEAVYLEQEXPGate<T>::ArithmeticBEAVYLEQEXPGate(std::size_t gate_id,
+                                                        BEAVYProvider& beavy_provider,
+                                                        ArithmeticBEAVYWireP<T>&& in,
+                                                        std::size_t domain_size, T threshold)
+    : detail::BasicArithmeticBooleanBEAVYBinaryGate<T>(gate_id, beavy_provider, std::move(in),
+                                                       ArithmeticBEAVYWireP<T>()),
+      beavy_provider_(beavy_provider),
+      domain_size_(domain_size),
+      threshold_(threshold) {
+  if (!std::has_single_bit(domain_size_) ||
+      std::size_t(std::bit_width(domain_size_ - 1)) > ENCRYPTO::bit_size_v<T>) {
+    throw std::invalid_argument(
+        fmt::format("ArithmeticBEAVYLEQEXPGate: invalid domain size {}", domain_size_));
+  }
   auto my_id = beavy_provider_.get_my_id();
   auto num_simd = this->input_a_->get_num_simd();
-  size_t vec_size = this->input_b_->get_public_share()[0];
-  
- 
-  pub_val_b_.Reserve(vec_size*num_simd);
-  pub_val_a_.Reserve(vec_size*num_simd);
-  auto tmp = ENCRYPTO::BitVector<>(num_simd*vec_size); 
-
-  #pragma omp parallel for
-  for(int i=0; i<num_simd; ++i){
-    auto pos = this->input_a_->get_public_share()[i] % vec_size;
-    tmp.Set(true, (pos)*num_simd + i);
+  hot_log("ArithmeticBEAVYLEQEXPGate", {{"gate_id", gate_id}, {"domain_size", domain_size_}});
+  // only party 0 receives a one-hot encoding
+  if (my_id == 0) {
+    share_future_1 =
+        beavy_provider_.register_for_bits_message(1, this->gate_id_, domain_size_ * num_simd, 0);
   }
-  
-  if(my_id==0){
-    pub_val_a_.Append(tmp);
-    beavy_provider_.broadcast_bits_message(this->gate_id_, pub_val_a_, 0);
-    pub_val_b_ = share_future_1.get();
+  share_future_2 = beavy_provider_.register_for_bits_message(1 - my_id, this->gate_id_, num_simd, 1);
+}
+
+template <typename T>
+ArithmeticBEAVYLEQEXPGate<T>::~ArithmeticBEAVYLEQEXPGate() = default;
 
+template <typename T>
+void ArithmeticBEAVYLEQEXPGate<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYLEQEXPGate::evaluate_setup start", this->gate_id_));
+    }
   }
-  else{
-    
-    pub_val_b_.Append(tmp);
-    beavy_provider_.broadcast_bits_message(this->gate_id_, pub_val_b_, 0);
-    pub_val_a_ = share_future_1.get();
+
+  // as for EQEXP, the one-hot rows are not masked, so only the output mask is needed
+  auto num_simd = this->input_a_->get_num_simd();
+  this->outputs_[0]->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_bits(this->gate_id_, num_simd);
+  this->outputs_[0]->set_setup_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYLEQEXPGate::evaluate_setup end", this->gate_id_));
+    }
   }
-  
-  ENCRYPTO::BitVector<> Delta_a;
-  ENCRYPTO::BitVector<> Delta_b;
-  auto num_bits = num_simd*vec_size;
-  Delta_a.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-  Delta_b.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+}
 
-  Delta_a.Append(pub_val_a_);
-  Delta_b.Append(pub_val_b_);
-  
-  Delta_y_share_ ^= (Delta_a & delta_b_share_);
-  Delta_y_share_ ^= (Delta_b & delta_a_share_);
+template <typename T>
+void ArithmeticBEAVYLEQEXPGate<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
 
-  if (my_id == 0) {
-    Delta_y_share_ ^= (Delta_a & Delta_b);
+template <typename T>
+void ArithmeticBEAVYLEQEXPGate<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticBEAVYLEQEXPGate<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYLEQEXPGate::evaluate_online start", this->gate_id_));
+    }
   }
 
-  ENCRYPTO::BitVector<> Delta_y_share;
-  Delta_y_share.Reserve(num_simd);
-  Delta_y_share.Append(this->outputs_[0]->get_secret_share());
+  auto my_id = beavy_provider_.get_my_id();
+  auto num_simd = this->input_a_->get_num_simd();
+  // the domain is a power of two, so reducing the shares modulo its size commutes with the sum
+  const T mask = T(domain_size_ - 1);
 
-  for (std::size_t i = 0; i < vec_size; ++i) {
-    Delta_y_share ^= Delta_y_share_.Subset(i * num_simd, (i + 1) * num_simd);
+  this->input_a_->wait_online();
+  // a masked input is turned into an additive share locally, as for ADD
+  std::vector<T> additive_a;
+  if (!this->input_a_->is_additively_shared()) {
+    this->input_a_->wait_setup();
+    additive_a = get_additive_share(*this->input_a_, my_id == 0);
+  }
+  const auto& public_a =
+      this->input_a_->is_additively_shared() ? this->input_a_->get_public_share() : additive_a;
+  this->outputs_[0]->wait_setup();
+  auto Delta_y = this->outputs_[0]->get_secret_share();
+  if (my_id == 1) {
+    ENCRYPTO::BitVector<> one_hot(domain_size_ * num_simd);
+    for (std::size_t i = 0; i < num_simd; ++i) {
+      one_hot.Set(true, (public_a[i] & mask) * num_simd + i);
+    }
+    beavy_provider_.send_bits_message(0, this->gate_id_, one_hot, 0);
+  } else {
+    // Value i lies in row j of the other party's one-hot encoding, so the sum is at most the
+    // threshold iff (a_i + j) mod domain_size is.  Each row contributes only its set bits, i.e.,
+    // every SIMD value is tested once.
+    const auto other_one_hot = share_future_1.get();
+    const std::size_t num_words = (num_simd + 63) / 64;
+    for_each_chunk(exec_ctx, num_words, 64, [&](auto words_begin, auto words_end) {
+      for (std::size_t word_k = words_begin; word_k < words_end; ++word_k) {
+        const auto word_begin = 64 * word_k;
+        const auto word_size = std::min<std::size_t>(64, num_simd - word_begin);
+        // bits of the last word beyond the SIMD values belong to the next row
+        const std::uint64_t valid =
+            word_size == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << word_size) - 1;
+        auto acc = load_bit_word(Delta_y, word_begin);
+        for (std::size_t row_j = 0; row_j < domain_size_; ++row_j) {
+          auto bits = load_bit_word(other_one_hot, row_j * num_simd + word_begin) & valid;
+          while (bits) {
+            const auto k = std::countr_zero(bits);
+            const T sum = T(public_a[word_begin + k] + T(row_j)) & mask;
+            acc ^= std::uint64_t(sum <= threshold_) << k;
+            bits &= bits - 1;
+          }
+        }
+        store_bit_word(Delta_y, word_begin, acc, word_size);
+      }
+    });
   }
 
-  beavy_provider_.broadcast_bits_message(this->gate_id_, Delta_y_share, 1);
-  Delta_y_share ^= share_future_2.get();
-  
-  this->outputs_[0]->get_public_share() = Delta_y_share;
+  beavy_provider_.broadcast_bits_message(this->gate_id_, Delta_y, 1);
+  Delta_y ^= share_future_2.get();
+
+  this->outputs_[0]->get_public_share() = std::move(Delta_y);
   this->outputs_[0]->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYLEQEXPGate::evaluate_online end", this->gate_id_));
+    }
+  }
 }
 
-template class ArithmeticBEAVYEQEXPGate<std::uint8_t>;
-template class ArithmeticBEAVYEQEXPGate<std::uint16_t>;
-template class ArithmeticBEAVYEQEXPGate<std::uint32_t>;
-template class ArithmeticBEAVYEQEXPGate<std::uint64_t>;
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYLEQEXPGate<T>::get_cost() const {
+  const auto num_simd = this->input_a_->get_num_simd();
+  // party 1 sends the one-hot rows, both parties their output share, no setup communication
+  const std::size_t one_hot_bits = beavy_provider_.get_my_id() == 1 ? domain_size_ * num_simd : 0;
+  return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                  .online_bytes_ = Helpers::Convert::BitsToBytes(one_hot_bits) +
+                                   Helpers::Convert::BitsToBytes(num_simd),
+                  .online_rounds_ = 2};
+}
+
+template class ArithmeticBEAVYLEQEXPGate<std::uint8_t>;
+template class ArithmeticBEAVYLEQEXPGate<std::uint16_t>;
+template class ArithmeticBEAVYLEQEXPGate<std::uint32_t>;
+template class ArithmeticBEAVYLEQEXPGate<std::uint64_t>;
 
 
 template <typename T>
@@ -2156,7 +4388,8 @@ void ArithmeticBEAVYSQRGate<T>::evaluate_setup() {
 
   auto num_simd = this->input_->get_num_simd();
 
-  this->output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+  this->output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(this->gate_id_, num_simd);
   this->output_->set_setup_ready();
 
   const auto& delta_a_share = this->input_->get_secret_share();
@@ -2168,14 +4401,6 @@ void ArithmeticBEAVYSQRGate<T>::evaluate_setup() {
     mult_receiver_->set_inputs(delta_a_share);
   }
 
-  Delta_y_share_.resize(num_simd);
-  // [Delta_y]_i = [delta_a]_i * [delta_a]_i
-  std::transform(std::begin(delta_a_share), std::end(delta_a_share), std::begin(Delta_y_share_),
-                 [](auto x) { return x * x; });
-  // [Delta_y]_i += [delta_y]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_y_share),
-                 std::begin(Delta_y_share_), std::plus{});
-
   // [[delta_a]_i * [delta_a]_(1-i)]_i
   std::vector<T> delta_aa_share;
   if (mult_sender_) {
@@ -2185,9 +4410,10 @@ void ArithmeticBEAVYSQRGate<T>::evaluate_setup() {
     mult_receiver_->compute_outputs();
     delta_aa_share = mult_receiver_->get_outputs();
   }
-  // [Delta_y]_i += 2 * [[delta_a]_i * [delta_a]_(1-i)]_i
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(delta_aa_share),
-                 std::begin(Delta_y_share_), [](auto x, auto y) { return x + 2 * y; });
+  // [Delta_y]_i = [delta_a]_i * [delta_a]_i + [delta_y]_i + 2 * [[delta_a]_i * [delta_a]_(1-i)]_i
+  Delta_y_share_.resize(num_simd);
+  beavy_sqr_setup(Delta_y_share_.data(), delta_a_share.data(), delta_y_share.data(),
+                  delta_aa_share.data(), num_simd);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -2212,21 +4438,13 @@ void ArithmeticBEAVYSQRGate<T>::evaluate_online() {
   this->input_->wait_online();
   const auto& Delta_a = this->input_->get_public_share();
   const auto& delta_a_share = this->input_->get_secret_share();
-  std::vector<T> tmp(num_simd);
 
-  // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_ab]_i
+  // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_aa]_i
 
   // [Delta_y]_i -= 2 * Delta_a * [delta_a]_i
-  std::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(delta_a_share), std::begin(tmp),
-                 [](auto x, auto y) { return 2 * x * y; });
-  std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                 std::begin(Delta_y_share_), std::minus{});
-
   // [Delta_y]_i += Delta_aa (== Delta_a * Delta_a)
-  if (beavy_provider_.is_my_job(this->gate_id_)) {
-    std::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(Delta_a),
-                   std::begin(Delta_y_share_), [](auto x, auto y) { return x + y * y; });
-  }
+  beavy_sqr_online(Delta_y_share_.data(), Delta_a.data(), delta_a_share.data(), num_simd,
+                   beavy_provider_.is_my_job(this->gate_id_));
   // broadcast [Delta_y]_i
   beavy_provider_.broadcast_ints_message(this->gate_id_, Delta_y_share_);
   // Delta_y = [Delta_y]_i + [Delta_y]_(1-i)
@@ -2244,6 +4462,21 @@ void ArithmeticBEAVYSQRGate<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticBEAVYSQRGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_simd = this->input_->get_num_simd();
+  // a single integer multiplication where party 0 is the sender
+  const auto num_ots = bit_size * num_simd;
+  const auto setup_bits = mult_sender_ ? GateCost::cot_sender_bits(num_ots, bit_size)
+                                       : GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticBEAVY,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = num_simd * sizeof(T),
+                  .num_ots_ = num_ots,
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticBEAVYSQRGate<std::uint8_t>;
 template class ArithmeticBEAVYSQRGate<std::uint16_t>;
 template class ArithmeticBEAVYSQRGate<std::uint32_t>;
@@ -2290,7 +4523,8 @@ void BooleanXArithmeticBEAVYMULGate<T>::evaluate_setup() {
 
   auto num_simd = this->input_arith_->get_num_simd();
 
-  this->output_->get_secret_share() = Helpers::RandomVector<T>(num_simd);
+  this->output_->get_secret_share() =
+      beavy_provider_.get_mask_generator().random_vector<T>(this->gate_id_, num_simd);
   this->output_->set_setup_ready();
 
   this->input_arith_->wait_setup();
@@ -2304,9 +4538,11 @@ void BooleanXArithmeticBEAVYMULGate<T>::evaluate_setup() {
   // using only two (vector) OTs per multiplication.
 
   std::vector<T> bit_sshare_as_ints(num_simd);
-  for (std::size_t int_i = 0; int_i < num_simd; ++int_i) {
-    bit_sshare_as_ints[int_i] = bit_sshare.Get(int_i);
-  }
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    for (std::size_t int_i = 0; int_i < num_lanes; ++int_i) {
+      bit_sshare_as_ints[int_i] = bit_sshare.Get(int_i);
+    }
+  });
 
   mult_bit_side_->set_inputs(bit_sshare);
 
@@ -2331,19 +4567,24 @@ void BooleanXArithmeticBEAVYMULGate<T>::evaluate_setup() {
   auto mult_int_side_out = mult_int_side_->get_outputs();
 
   // compute [delta_b]^A and [delta_b * delta_n]^A
-  if (beavy_provider_.is_my_job(this->gate_id_)) {
-    for (std::size_t int_i = 0; int_i < num_simd; ++int_i) {
-      delta_b_share_[int_i] = bit_sshare_as_ints[int_i] - 2 * mult_int_side_out[2 * int_i];
-      delta_b_x_delta_n_share_[int_i] = bit_sshare_as_ints[int_i] * int_sshare[int_i] +
-                                        mult_int_side_out[2 * int_i + 1] + mult_bit_side_out[int_i];
-    }
-  } else {
-    for (std::size_t int_i = 0; int_i < num_simd; ++int_i) {
-      delta_b_share_[int_i] = bit_sshare_as_ints[int_i] - 2 * mult_bit_side_out[2 * int_i];
-      delta_b_x_delta_n_share_[int_i] = bit_sshare_as_ints[int_i] * int_sshare[int_i] +
-                                        mult_bit_side_out[2 * int_i + 1] + mult_int_side_out[int_i];
+  const auto is_my_job = beavy_provider_.is_my_job(this->gate_id_);
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    if (is_my_job) {
+      for (std::size_t int_i = 0; int_i < num_lanes; ++int_i) {
+        delta_b_share_[int_i] = bit_sshare_as_ints[int_i] - 2 * mult_int_side_out[2 * int_i];
+        delta_b_x_delta_n_share_[int_i] = bit_sshare_as_ints[int_i] * int_sshare[int_i] +
+                                          mult_int_side_out[2 * int_i + 1] +
+                                          mult_bit_side_out[int_i];
+      }
+    } else {
+      for (std::size_t int_i = 0; int_i < num_lanes; ++int_i) {
+        delta_b_share_[int_i] = bit_sshare_as_ints[int_i] - 2 * mult_bit_side_out[2 * int_i];
+        delta_b_x_delta_n_share_[int_i] = bit_sshare_as_ints[int_i] * int_sshare[int_i] +
+                                          mult_bit_side_out[2 * int_i + 1] +
+                                          mult_int_side_out[int_i];
+      }
     }
-  }
+  });
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -2377,16 +4618,17 @@ void BooleanXArithmeticBEAVYMULGate<T>::evaluate_online() {
   const auto& sshare = this->output_->get_secret_share();
   std::vector<T> pshare(num_simd);
 
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    T Delta_b = bit_pshare.Get(simd_j);
-    auto Delta_n = int_pshare[simd_j];
-    pshare[simd_j] = delta_b_share_[simd_j] * (Delta_n - 2 * Delta_b * Delta_n) -
-                    Delta_b * int_sshare[simd_j] -
-                    delta_b_x_delta_n_share_[simd_j] * (1 - 2 * Delta_b) + sshare[simd_j];
-    if (beavy_provider_.is_my_job(this->gate_id_)) {
-      pshare[simd_j] += Delta_b * Delta_n;
+  const T mask_Delta_bn = beavy_provider_.is_my_job(this->gate_id_) ? T(-1) : T(0);
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+      T Delta_b = bit_pshare.Get(simd_j);
+      auto Delta_n = int_pshare[simd_j];
+      pshare[simd_j] = delta_b_share_[simd_j] * (Delta_n - 2 * Delta_b * Delta_n) -
+                       Delta_b * int_sshare[simd_j] -
+                       delta_b_x_delta_n_share_[simd_j] * (1 - 2 * Delta_b) + sshare[simd_j] +
+                       (T(Delta_b * Delta_n) & mask_Delta_bn);
     }
-  }
+  });
 
   beavy_provider_.broadcast_ints_message(this->gate_id_, pshare);
   const auto other_pshare = share_future_.get();
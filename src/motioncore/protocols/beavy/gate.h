@@ -23,11 +23,15 @@
 #pragma once
 
 #include <cstddef>
+#include <optional>
+#include <span>
 
 #include "gate/new_gate.h"
 #include "utility/bit_vector.h"
 #include "utility/reusable_future.h"
 #include "utility/type_traits.hpp"
+#include "reconstruction.h"
+#include "tensor/tensor_op.h"
 #include "wire.h"
 
 namespace ENCRYPTO::ObliviousTransfer {
@@ -39,6 +43,13 @@ template <typename T>
 class ACOTReceiver;
 }  // namespace ENCRYPTO::ObliviousTransfer
 
+namespace MOTION::proto::plain {
+template <typename T>
+class ArithmeticPlainWire;
+template <typename T>
+using ArithmeticPlainWireP = std::shared_ptr<ArithmeticPlainWire<T>>;
+}  // namespace MOTION::proto::plain
+
 namespace MOTION {
 
 using WireVector = std::vector<std::shared_ptr<NewWire>>;
@@ -50,6 +61,10 @@ template <typename T>
 class IntegerMultiplicationSender;
 template <typename T>
 class IntegerMultiplicationReceiver;
+template <typename T>
+class ConvolutionInputSide;
+template <typename T>
+class ConvolutionKernelSide;
 }  // namespace MOTION
 
 namespace MOTION::proto::beavy {
@@ -58,9 +73,16 @@ namespace detail {
 
 class BasicBooleanBEAVYBinaryGate : public NewGate {
  public:
-  BasicBooleanBEAVYBinaryGate(std::size_t gate_id, BooleanBEAVYWireVector&&,
+  BasicBooleanBEAVYBinaryGate(std::size_t gate_id, const BEAVYProvider&, BooleanBEAVYWireVector&&,
                               BooleanBEAVYWireVector&&);
   BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_a_);
+    MOTION::detail::append_wires(wires, inputs_b_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   std::size_t num_wires_;
@@ -71,8 +93,15 @@ class BasicBooleanBEAVYBinaryGate : public NewGate {
 
 class BasicBooleanBEAVYUnaryGate : public NewGate {
  public:
-  BasicBooleanBEAVYUnaryGate(std::size_t gate_id, BooleanBEAVYWireVector&&, bool forward);
+  BasicBooleanBEAVYUnaryGate(std::size_t gate_id, const BEAVYProvider&, BooleanBEAVYWireVector&&,
+                             bool forward);
   BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   std::size_t num_wires_;
@@ -86,10 +115,20 @@ class BasicArithmeticBooleanBEAVYBinaryGate : public NewGate {
   BasicArithmeticBooleanBEAVYBinaryGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
                                  ArithmeticBEAVYWireP<T>&&);
   BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_a_.get());
+    if (input_b_) {
+      wires.push_back(input_b_.get());
+    }
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   std::size_t num_wires_;
   const ArithmeticBEAVYWireP<T> input_a_;
+  // nullptr if the second operand is a public constant
   const ArithmeticBEAVYWireP<T> input_b_;
   BooleanBEAVYWireVector outputs_;
 };
@@ -109,13 +148,24 @@ class BooleanBEAVYInputGateSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  // the setup of non-interactive inputs depends on the input
+  bool supports_preprocessing_store() const noexcept override { return !non_interactive_; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
   BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
   std::size_t num_wires_;
   std::size_t num_simd_;
   std::size_t input_id_;
+  // see BEAVYProvider::set_non_interactive_inputs
+  bool non_interactive_;
+  std::size_t public_input_id_;
   ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>> input_future_;
   BooleanBEAVYWireVector outputs_;
 };
@@ -128,7 +178,15 @@ class BooleanBEAVYInputGateReceiver : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  // the setup of non-interactive inputs depends on the input
+  bool supports_preprocessing_store() const noexcept override { return !non_interactive_; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
   BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -136,6 +194,8 @@ class BooleanBEAVYInputGateReceiver : public NewGate {
   std::size_t num_simd_;
   std::size_t input_owner_;
   std::size_t input_id_;
+  bool non_interactive_;
+  std::size_t public_input_id_;
   BooleanBEAVYWireVector outputs_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> public_share_future_;
 };
@@ -149,15 +209,31 @@ class BooleanBEAVYOutputGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  std::pair<CommMixin*, std::size_t> get_fusable_output_message() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
 
  private:
+  // add the shares of the other parties to my_secret_share_ if not done yet
+  void receive_shares();
+
   BEAVYProvider& beavy_provider_;
   std::size_t num_wires_;
   std::size_t output_owner_;
   ENCRYPTO::ReusableFiberPromise<std::vector<ENCRYPTO::BitVector<>>> output_promise_;
+  // output for a single party
   std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>> share_futures_;
+  // output for all parties
+  std::optional<Reconstruction<ENCRYPTO::BitVector<>>> reconstruction_;
   const BooleanBEAVYWireVector inputs_;
   ENCRYPTO::BitVector<> my_secret_share_;
+  // my_secret_share_ already contains the shares of the other parties
+  bool other_shares_received_ = false;
 };
 
 class BooleanBEAVYINVGate : public detail::BasicBooleanBEAVYUnaryGate {
@@ -167,9 +243,53 @@ class BooleanBEAVYINVGate : public detail::BasicBooleanBEAVYUnaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+
+ private:
+  bool is_my_job_;
+};
+
+// Local gate which moves bits between SIMD values: every output bit is the XOR of the input bits
+// listed in `sources` and a public constant, where the bits of the inputs are numbered wire by
+// wire, and so are the num_wires output wires.  Like the INV gate, the constants are added to the
+// delta share of one party.  This shifts, gathers or concatenates SIMD values without any
+// communication.
+class BooleanBEAVYLaneMapGate : public NewGate {
+ public:
+  BooleanBEAVYLaneMapGate(std::size_t gate_id, const BEAVYProvider&, BooleanBEAVYWireVector&&,
+                          std::size_t num_wires, std::vector<std::vector<std::size_t>>&& sources,
+                          ENCRYPTO::BitVector<>&& constants);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  private:
+  // the map applied to the concatenation of the given shares of all input wires
+  ENCRYPTO::BitVector<> map_shares(bool public_shares) const;
+
   bool is_my_job_;
+  const BooleanBEAVYWireVector inputs_;
+  BooleanBEAVYWireVector outputs_;
+  const std::vector<std::vector<std::size_t>> sources_;
+  const ENCRYPTO::BitVector<> constants_;
 };
 
 template <typename T>
@@ -179,19 +299,25 @@ class BooleanBEAVYHAMGate : public NewGate {
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
-  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
   void evaluate_online_with_context(ExecutionContext&) override;
   beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
   private:
+  void evaluate_online_impl(ExecutionContext*);
+
   beavy::BooleanBEAVYWireVector input_;
   BEAVYProvider& beavy_provider_;
   std::size_t num_wires_;
   std::vector<ENCRYPTO::BitVector<>> random_values_;
-  std::vector<std::unique_ptr<NewGate>> bit2a_gates_;
-  std::vector<MOTION::WireVector> arithmetic_wires_;
-  std::vector<ArithmeticBEAVYWireVector<T>> beavy_arithmetic_wires_;
+  std::unique_ptr<NewGate> bits2a_gate_;
+  ArithmeticBEAVYWireVector<T> beavy_arithmetic_wires_;
   std::vector<BooleanBEAVYWireP> boolean_wires_;
 
   std::vector<ENCRYPTO::BitVector<>> public_bits_; // One element of vector corresponding to one wire.
@@ -200,36 +326,134 @@ class BooleanBEAVYHAMGate : public NewGate {
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
 };
 
+// Hamming distance between every window of a text and a pattern of window_size characters,
+// stored bit plane by bit plane like the text.  Instead of converting each bit of each window,
+// the text and the pattern are converted to arithmetic shares once, and
+//   HAM_s = sum_(b,p) t_(s+p,b) + P_(p,b) - 2 t_(s+p,b) P_(p,b)
+// is computed with convolutions, whose products of the masks are prepared on the whole text in
+// the setup phase.  Hence, the only online messages are those of the two conversions, and apart
+// from the setup messages of the convolutions, the costs grow with the lengths of text and
+// pattern rather than with their product.  As for BooleanBEAVYHAMGate, the public share of the output
+// holds additive shares of the result.
+template <typename T>
+class BooleanBEAVYWindowHAMGate : public NewGate {
+ public:
+  BooleanBEAVYWindowHAMGate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWindowView&&,
+                            BooleanBEAVYWireVector&& pattern);
+  ~BooleanBEAVYWindowHAMGate();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, windows_.text_);
+    MOTION::detail::append_wires(wires, pattern_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  const BooleanBEAVYWindowView windows_;
+  const BooleanBEAVYWireVector pattern_;
+  // cross-correlation of the bit planes of the text with those of the pattern
+  tensor::Conv2DOp conv_op_;
+  std::unique_ptr<NewGate> text_bits2a_gate_;
+  std::unique_ptr<NewGate> pattern_bits2a_gate_;
+  ArithmeticBEAVYWireVector<T> arithmetic_text_;
+  ArithmeticBEAVYWireVector<T> arithmetic_pattern_;
+  // [sum_(b,p) delta_t_(s+p,b) * delta_P_(p,b)]_i
+  std::vector<T> delta_tP_share_;
+  std::unique_ptr<MOTION::ConvolutionInputSide<T>> conv_input_side_;
+  std::unique_ptr<MOTION::ConvolutionKernelSide<T>> conv_kernel_side_;
+  beavy::ArithmeticBEAVYWireP<T> output_;
+};
+
+// Squared Euclidean distance between every window of a text and a pattern of window_size
+// characters, both arithmetic wires with one character per SIMD value, i.e.,
+//   D_s = sum_p (t_(s+p) - P_p)^2 = sum_p t_(s+p)^2 + sum_p P_p^2 - 2 sum_p t_(s+p) P_p,
+// which is 0 iff the window matches the pattern, if no sum wraps around the ring.  The squares
+// need a product of the masks per character, the correlation the cross-correlation of the masks
+// prepared in the setup phase, so the online phase is local, and its correlations are computed
+// with NTTs for long patterns (see cross_correlation()).  As for BooleanBEAVYHAMGate, the public
+// share of the output holds additive shares of the result.
+template <typename T>
+class ArithmeticBEAVYWindowDistanceGate : public NewGate {
+ public:
+  ArithmeticBEAVYWindowDistanceGate(std::size_t gate_id, BEAVYProvider&,
+                                    ArithmeticBEAVYWireP<T>&& text,
+                                    ArithmeticBEAVYWireP<T>&& pattern);
+  ~ArithmeticBEAVYWindowDistanceGate();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(text_.get());
+    wires.push_back(pattern_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  const ArithmeticBEAVYWireP<T> text_;
+  const ArithmeticBEAVYWireP<T> pattern_;
+  std::size_t num_windows_;
+  tensor::Conv2DOp conv_op_;
+  // [delta^2]_i of the characters of the text and then of the pattern
+  std::vector<T> delta_squares_share_;
+  // [sum_p delta_t_(s+p) * delta_P_p]_i
+  std::vector<T> delta_tP_share_;
+  std::unique_ptr<MOTION::IntegerMultiplicationSender<T>> mult_sender_;
+  std::unique_ptr<MOTION::IntegerMultiplicationReceiver<T>> mult_receiver_;
+  std::unique_ptr<MOTION::ConvolutionInputSide<T>> conv_input_side_;
+  std::unique_ptr<MOTION::ConvolutionKernelSide<T>> conv_kernel_side_;
+  beavy::ArithmeticBEAVYWireP<T> output_;
+};
+
+// Hamming distance over ring elements.  The input holds 0/1 values, e.g., mismatch indicators,
+// and the output holds the sum of each group of group_size consecutive SIMD values.  This is
+// computed locally without converting any bits.  As for BooleanBEAVYHAMGate, the public share of
+// the output holds additive shares of the result.
 template <typename T>
 class BEAVYAHAMGate : public NewGate {
  public:
-  BEAVYAHAMGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&);
+  BEAVYAHAMGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
+                std::size_t group_size);
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
-  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
   void evaluate_online_with_context(ExecutionContext&) override;
   beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
+
+ private:
+  void evaluate_online_impl(ExecutionContext*);
 
-  private:
   beavy::ArithmeticBEAVYWireP<T> input_;
   BEAVYProvider& beavy_provider_;
-  std::size_t num_wires_;
-  std::vector<ENCRYPTO::BitVector<>> random_values_;
-  std::vector<std::unique_ptr<NewGate>> bit2a_gates_;
-  std::vector<MOTION::WireVector> arithmetic_wires_;
-  std::vector<ArithmeticBEAVYWireVector<T>> beavy_arithmetic_wires_;
-  std::vector<BooleanBEAVYWireP> boolean_wires_;
-  std::vector<MOTION::WireVector> r;
-
-  std::vector<ENCRYPTO::BitVector<>> public_bits_; // One element of vector corresponding to one wire.
-
+  std::size_t group_size_;
   beavy::ArithmeticBEAVYWireP<T> output_;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
 };
 
 
+// Number of set bits of each SIMD value over all input wires.  The delta shares of the bits are
+// injected into the ring by one ACOT per bit in the setup, such that the count
+//   sum_i x_i = sum_i Delta_i + (1 - 2 Delta_i) delta_i
+// is a local linear combination of the injected shares online.  The output is additively shared,
+// like the one of BooleanBEAVYHAMGate, so it is only reconstructed, possibly together with other
+// wires, if the next gate needs the masked value.
 template <typename T>
 class BooleanBEAVYCOUNTGate : public NewGate {
  public:
@@ -239,17 +463,27 @@ class BooleanBEAVYCOUNTGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  std::optional<GateCost> get_cost() const override;
   beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
+  void evaluate_online_impl(ExecutionContext*);
+
   beavy::BooleanBEAVYWireVector inputs_;
   beavy::ArithmeticBEAVYWireP<T> output_;
   BEAVYProvider& beavy_provider_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTSender<T>> ot_sender_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::ACOTReceiver<T>> ot_receiver_;
+  // [delta_i] of all input bits, wire by wire
   std::vector<T> arithmetized_secret_share_;
-  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
 class BooleanBEAVYXORGate : public detail::BasicBooleanBEAVYBinaryGate {
@@ -260,6 +494,13 @@ class BooleanBEAVYXORGate : public detail::BasicBooleanBEAVYBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 };
 
 class BooleanBEAVYANDGate : public detail::BasicBooleanBEAVYBinaryGate {
@@ -270,41 +511,87 @@ class BooleanBEAVYANDGate : public detail::BasicBooleanBEAVYBinaryGate {
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
+  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  std::pair<CommMixin*, std::size_t> get_fusable_online_message() const override;
 
  private:
+  void evaluate_setup_impl(ExecutionContext*);
+
   BEAVYProvider& beavy_provider_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
-  ENCRYPTO::BitVector<> delta_a_share_;
-  ENCRYPTO::BitVector<> delta_b_share_;
-  ENCRYPTO::BitVector<> Delta_y_share_;
+  // kept until the end of the online phase, taken from the arena of the execution context
+  ENCRYPTO::BitVector<ENCRYPTO::arena_alloc> delta_a_share_;
+  ENCRYPTO::BitVector<ENCRYPTO::arena_alloc> delta_b_share_;
+  ENCRYPTO::BitVector<ENCRYPTO::arena_alloc> Delta_y_share_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
+  std::optional<std::size_t> xcot_batch_offset_;
 };
 
-class BooleanBEAVYAND4Gate : public detail::BasicBooleanBEAVYBinaryGate {
+// AND of n operands with the same number of wires, which needs only one online round and one
+// message like the 2-input AND.  The setup computes shares of the products of the delta shares of
+// all subsets of at least two operands, i.e., 2^n - n - 1 products per bit, in one batch of XCOTs
+// per subset size.  Then the public share of the output is a linear combination of the products
+// weighted by products of the public shares.
+class BooleanBEAVYANDnGate : public NewGate {
  public:
-  BooleanBEAVYAND4Gate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWireVector&&,
-                      BooleanBEAVYWireVector&&);
-  ~BooleanBEAVYAND4Gate();
+  static constexpr std::size_t max_num_inputs = 8;
+
+  BooleanBEAVYANDnGate(std::size_t gate_id, BEAVYProvider&,
+                       std::vector<BooleanBEAVYWireVector>&& inputs);
+  ~BooleanBEAVYANDnGate();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  std::pair<CommMixin*, std::size_t> get_fusable_online_message() const override;
+  BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    for (const auto& input : inputs_) {
+      MOTION::detail::append_wires(wires, input);
+    }
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  private:
+  std::size_t get_num_bits() const noexcept { return num_wires_ * outputs_[0]->get_num_simd(); }
+
   BEAVYProvider& beavy_provider_;
+  std::size_t num_wires_;
+  const std::vector<BooleanBEAVYWireVector> inputs_;
+  BooleanBEAVYWireVector outputs_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
-  ENCRYPTO::BitVector<> delta_a_share_;
-  ENCRYPTO::BitVector<> delta_b_share_;
+  // shares of the products of the delta shares of the operands whose bits are set in the index,
+  // all wires one after another
+  std::vector<ENCRYPTO::BitVector<>> delta_products_;
   ENCRYPTO::BitVector<> Delta_y_share_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
+  // XCOTs for the products of each subset size 2, ..., n
+  std::vector<std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender>> ot_senders_;
+  std::vector<std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver>> ot_receivers_;
+  std::vector<std::size_t> xcot_batch_offsets_;
 };
 
-
+// Matching of two bit strings: the output is a single wire whose i-th SIMD value is 1 iff the
+// i-th SIMD values of both inputs agree on all wires, i.e., the AND of the XNORs of the wires.
+// The AND is a tree of 4-input ANDs, such that every round shrinks the number of bits by 4x and
+// ceil(log_4(#wires)) rounds are needed.  Since the delta shares of the intermediate results are
+// chosen in the setup, the products of the delta shares of all rounds are computed there in one
+// batch of XCOTs per subset size.  The last group of a round is padded with public ones.
 class BooleanBEAVYMSGGate : public detail::BasicBooleanBEAVYBinaryGate {
  public:
+  static constexpr std::size_t group_size = 4;
+
   BooleanBEAVYMSGGate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWireVector&&,
                       BooleanBEAVYWireVector&&);
   ~BooleanBEAVYMSGGate();
@@ -312,16 +599,31 @@ class BooleanBEAVYMSGGate : public detail::BasicBooleanBEAVYBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
+  std::size_t get_num_rounds() const noexcept { return round_num_ands_.size(); }
+
   BEAVYProvider& beavy_provider_;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_1;
-  ENCRYPTO::BitVector<> delta_a_share_;
-  ENCRYPTO::BitVector<> delta_b_share_;
+  std::size_t num_simd_;
+  // number of 4-input ANDs per SIMD value in each round
+  std::vector<std::size_t> round_num_ands_;
+  // bit offset of each round in Delta_y_share_
+  std::vector<std::size_t> round_offsets_;
+  // one message per round
+  std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>> share_futures_;
+  // shares of the products of the delta shares of the operands whose bits are set in the index,
+  // for each round, all ANDs one after another
+  std::vector<std::vector<ENCRYPTO::BitVector<>>> delta_products_;
+  // the messages of all rounds one after another
   ENCRYPTO::BitVector<> Delta_y_share_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
+  // XCOTs for the products of each subset size 2, ..., 4
+  std::vector<std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender>> ot_senders_;
+  std::vector<std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver>> ot_receivers_;
+  std::vector<std::size_t> xcot_batch_offsets_;
 };
 
 class BooleanBEAVYDOTGate : public detail::BasicBooleanBEAVYBinaryGate {
@@ -344,11 +646,53 @@ class BooleanBEAVYDOTGate : public detail::BasicBooleanBEAVYBinaryGate {
   ENCRYPTO::BitVector<> Delta_y_share_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
+  std::optional<std::size_t> xcot_batch_offset_;
 };
 
+// Inner products of one text with several patterns of the same number of wires, i.e., output j
+// is the XOR over all wires i of text[i] & patterns[j][i].  The products of a text bit with the
+// bits of all patterns are computed by one XCOT whose messages have a bit per pattern, and all
+// outputs are opened in one message.
+class BooleanBEAVYMatrixDOTGate : public NewGate {
+ public:
+  BooleanBEAVYMatrixDOTGate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWireVector&& text,
+                            std::vector<BooleanBEAVYWireVector>&& patterns);
+  ~BooleanBEAVYMatrixDOTGate();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, text_);
+    for (const auto& pattern : patterns_) {
+      MOTION::detail::append_wires(wires, pattern);
+    }
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
+ private:
+  std::size_t get_num_ots() const noexcept { return text_.size() * num_simd_; }
 
-
+  BEAVYProvider& beavy_provider_;
+  std::size_t num_simd_;
+  const BooleanBEAVYWireVector text_;
+  const std::vector<BooleanBEAVYWireVector> patterns_;
+  BooleanBEAVYWireVector outputs_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_;
+  // [Delta_y] of all patterns one after another
+  ENCRYPTO::BitVector<> Delta_y_share_;
+  // one XCOT per text bit in each direction, the strong party and the batched XCOTs of the
+  // provider are not used since both are restricted to messages of a single bit
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
+};
 
 template <typename T>
 class ArithmeticBEAVYInputGateSender : public NewGate {
@@ -359,13 +703,24 @@ class ArithmeticBEAVYInputGateSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  // the setup of non-interactive inputs depends on the input
+  bool supports_preprocessing_store() const noexcept override { return !non_interactive_; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
   ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
   std::size_t num_wires_;
   std::size_t num_simd_;
   std::size_t input_id_;
+  // see BEAVYProvider::set_non_interactive_inputs
+  bool non_interactive_;
+  std::size_t public_input_id_;
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> input_future_;
   ArithmeticBEAVYWireP<T> output_;
 };
@@ -379,7 +734,15 @@ class ArithmeticBEAVYInputGateReceiver : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  // the setup of non-interactive inputs depends on the input
+  bool supports_preprocessing_store() const noexcept override { return !non_interactive_; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
   ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -387,10 +750,79 @@ class ArithmeticBEAVYInputGateReceiver : public NewGate {
   std::size_t num_simd_;
   std::size_t input_owner_;
   std::size_t input_id_;
+  bool non_interactive_;
+  std::size_t public_input_id_;
   ArithmeticBEAVYWireP<T> output_;
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> public_share_future_;
 };
 
+// Input gates of a large contiguous input, e.g., a table in a memory mapped file, which is split
+// into chunks of chunk_size values.  Each chunk becomes an output wire of its own and is sent in a
+// separate message, such that the gates using the first chunks can start while the remaining
+// ones are still in transfer.  The message of chunk i is identified by gate id gate_id + i, i.e.,
+// the ids up to gate_id + #chunks - 1 need to be reserved for the gate.  The input values are
+// only read in the online phase, so the buffer needs to stay valid until then.
+template <typename T>
+class ArithmeticBEAVYBulkInputGateSender : public NewGate {
+ public:
+  ArithmeticBEAVYBulkInputGateSender(std::size_t gate_id, BEAVYProvider&, std::span<const T> input,
+                                     std::size_t chunk_size);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  ArithmeticBEAVYWireVector<T>& get_output_wires() noexcept { return outputs_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    for (const auto& wire : outputs_) {
+      wires.push_back(wire.get());
+    }
+  }
+
+  static std::size_t get_num_chunks(std::size_t num_values, std::size_t chunk_size) noexcept {
+    return (num_values + chunk_size - 1) / chunk_size;
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  std::span<const T> input_;
+  std::size_t chunk_size_;
+  std::size_t input_id_;
+  // see BEAVYProvider::set_non_interactive_inputs
+  bool non_interactive_;
+  std::size_t public_input_id_;
+  ArithmeticBEAVYWireVector<T> outputs_;
+};
+
+template <typename T>
+class ArithmeticBEAVYBulkInputGateReceiver : public NewGate {
+ public:
+  ArithmeticBEAVYBulkInputGateReceiver(std::size_t gate_id, BEAVYProvider&, std::size_t num_values,
+                                       std::size_t chunk_size, std::size_t input_owner);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  ArithmeticBEAVYWireVector<T>& get_output_wires() noexcept { return outputs_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    for (const auto& wire : outputs_) {
+      wires.push_back(wire.get());
+    }
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  std::size_t num_values_;
+  std::size_t chunk_size_;
+  std::size_t input_owner_;
+  std::size_t input_id_;
+  bool non_interactive_;
+  std::size_t public_input_id_;
+  ArithmeticBEAVYWireVector<T> outputs_;
+  std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>> public_share_futures_;
+};
+
 template <typename T>
 class ArithmeticBEAVYOutputGate : public NewGate {
  public:
@@ -401,14 +833,31 @@ class ArithmeticBEAVYOutputGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  std::pair<CommMixin*, std::size_t> get_fusable_output_message() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
 
  private:
+  // compute the sum of the secret shares of all parties if not done yet
+  void receive_shares();
+
   BEAVYProvider& beavy_provider_;
   std::size_t num_wires_;
   std::size_t output_owner_;
   ENCRYPTO::ReusableFiberPromise<std::vector<T>> output_promise_;
-  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+  // output for a single party
+  std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>> share_futures_;
+  // output for all parties
+  std::optional<Reconstruction<std::vector<T>>> reconstruction_;
   const ArithmeticBEAVYWireP<T> input_;
+  // sum of the secret shares of all parties
+  std::vector<T> secret_share_;
+  bool shares_received_ = false;
 };
 
 template <typename T>
@@ -421,6 +870,10 @@ class ArithmeticBEAVYOutputShareGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
 
  private:
   ENCRYPTO::ReusableFiberPromise<std::vector<T>> public_share_promise_;
@@ -428,6 +881,40 @@ class ArithmeticBEAVYOutputShareGate : public NewGate {
   const ArithmeticBEAVYWireP<T> input_;
 };
 
+// Reconstruction of the masked values of additively shared wires, see
+// ArithmeticBEAVYWire::is_additively_shared().  The outputs keep the masks of the inputs, and
+// each party broadcasts its additive shares plus its shares of the masks, whose sums are the
+// public shares of the outputs.  The wires of a gate are reconstructed with a single message.
+template <typename T>
+class ArithmeticBEAVYReconstructGate : public NewGate {
+ public:
+  ArithmeticBEAVYReconstructGate(std::size_t gate_id, BEAVYProvider&,
+                                 ArithmeticBEAVYWireVector<T>&&);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  ArithmeticBEAVYWireVector<T>& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
+
+ private:
+  std::size_t get_num_values() const noexcept;
+
+  BEAVYProvider& beavy_provider_;
+  const ArithmeticBEAVYWireVector<T> inputs_;
+  ArithmeticBEAVYWireVector<T> outputs_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+};
+
 namespace detail {
 
 template <typename T>
@@ -436,6 +923,13 @@ class BasicArithmeticBEAVYBinaryGate : public NewGate {
   BasicArithmeticBEAVYBinaryGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
                                  ArithmeticBEAVYWireP<T>&&);
   ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_a_.get());
+    wires.push_back(input_b_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   std::size_t num_wires_;
@@ -449,6 +943,12 @@ class BasicArithmeticBEAVYUnaryGate : public NewGate {
  public:
   BasicArithmeticBEAVYUnaryGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&);
   ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   std::size_t num_wires_;
@@ -462,6 +962,13 @@ class BasicBooleanXArithmeticBEAVYBinaryGate : public NewGate {
   BasicBooleanXArithmeticBEAVYBinaryGate(std::size_t gate_id, BEAVYProvider&, BooleanBEAVYWireP&&,
                                          ArithmeticBEAVYWireP<T>&&);
   ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_bool_.get());
+    wires.push_back(input_arith_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   const BooleanBEAVYWireP input_bool_;
@@ -479,6 +986,13 @@ class ArithmeticBEAVYNEGGate : public detail::BasicArithmeticBEAVYUnaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
@@ -493,6 +1007,51 @@ class ArithmeticBEAVYADDGate : public detail::BasicArithmeticBEAVYBinaryGate<T>
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+
+ private:
+  bool is_party_0_;
+};
+
+// Local gate which moves values between SIMD values, as BooleanBEAVYLaneMapGate for bits: output
+// value j is the value sources[j] of the concatenation of the input wires, e.g., to split a wire
+// into halves or to append the values of another wire.  As for ADD, the output is additively
+// shared if any input is, and the values of masked inputs are turned into additive shares.
+template <typename T>
+class ArithmeticBEAVYLaneMapGate : public NewGate {
+ public:
+  ArithmeticBEAVYLaneMapGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireVector<T>&&,
+                             std::vector<std::size_t>&& sources);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+  ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
+
+ private:
+  bool is_party_0_;
+  const ArithmeticBEAVYWireVector<T> inputs_;
+  const std::vector<std::size_t> sources_;
+  ArithmeticBEAVYWireP<T> output_;
 };
 
 template <typename T>
@@ -505,6 +1064,10 @@ class ArithmeticBEAVYMULGate : public detail::BasicArithmeticBEAVYBinaryGate<T>
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -514,29 +1077,70 @@ class ArithmeticBEAVYMULGate : public detail::BasicArithmeticBEAVYBinaryGate<T>
   std::unique_ptr<MOTION::IntegerMultiplicationReceiver<T>> mult_receiver_;
 };
 
+// Compares the values of a, i.e., the public shares of both parties, modulo the domain size given
+// by the public share of b via their one-hot encodings.  The masks of the one-hot rows are zero,
+// so the products of the masks vanish and the rows are folded locally.  Only the output mask is
+// generated in the setup phase, which needs no communication and no correlated bits per row.
 template <typename T>
 class ArithmeticBEAVYEQEXPGate : public detail::BasicArithmeticBooleanBEAVYBinaryGate<T> {
  public:
+  // The second input holds the number of values vec_size in its public share, as in the
+  // exact_pm example, or, preferably, is a constant wire holding vec_size.
   ArithmeticBEAVYEQEXPGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
                          ArithmeticBEAVYWireP<T>&&);
+  ArithmeticBEAVYEQEXPGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
+                         plain::ArithmeticPlainWireP<T>&&);
   ~ArithmeticBEAVYEQEXPGate();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  std::optional<GateCost> get_cost() const override;
+
+ private:
+  ArithmeticBEAVYEQEXPGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
+                         ArithmeticBEAVYWireP<T>&&, std::size_t vec_size);
+  void evaluate_online_impl(ExecutionContext*);
+
+  // number of SIMD values folded together in the online phase (8 KiB accumulator per tile)
+  static constexpr std::size_t eqexp_tile_bits = 64 * 1024;
+
+  BEAVYProvider& beavy_provider_;
+  std::size_t vec_size_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_1;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_2;
+};
+
+// Tests whether the values of a, which are additively shared in the public shares as for the
+// outputs of HAM and COUNT, are at most a threshold.  Masked values are turned into additive
+// shares locally.  The values need to be below the domain size, a power of two.  Party 1 sends
+// the one-hot encoding of its share as in EQEXP, and party 0 folds it with the rows whose
+// positions complete its own share to a value of at most the threshold, i.e., the prefix of the
+// one-hot encoding of the sum.  Hence, the test is computed
+// in the round of the one-hot encoding without a COUNT and an EQEXP per accepted value, and
+// only party 0 needs to know the threshold.  As in EQEXP, the one-hot row is not masked.
+template <typename T>
+class ArithmeticBEAVYLEQEXPGate : public detail::BasicArithmeticBooleanBEAVYBinaryGate<T> {
+ public:
+  ArithmeticBEAVYLEQEXPGate(std::size_t gate_id, BEAVYProvider&, ArithmeticBEAVYWireP<T>&&,
+                            std::size_t domain_size, T threshold);
+  ~ArithmeticBEAVYLEQEXPGate();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
+  void evaluate_online_impl(ExecutionContext*);
+
   BEAVYProvider& beavy_provider_;
-  ENCRYPTO::BitVector<> pub_val_a_;
-  ENCRYPTO::BitVector<> pub_val_b_;
-  ENCRYPTO::BitVector<> random_val_;
+  std::size_t domain_size_;
+  T threshold_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_1;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> share_future_2;
-  ENCRYPTO::BitVector<> delta_a_share_;
-  ENCRYPTO::BitVector<> delta_b_share_;
-  ENCRYPTO::BitVector<> Delta_y_share_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitSender> ot_sender_;
-  std::unique_ptr<ENCRYPTO::ObliviousTransfer::XCOTBitReceiver> ot_receiver_;
 };
 
 template <typename T>
@@ -567,6 +1171,7 @@ class ArithmeticBEAVYSQRGate : public detail::BasicArithmeticBEAVYUnaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
   BEAVYProvider& beavy_provider_;
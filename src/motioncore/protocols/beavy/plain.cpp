@@ -57,9 +57,7 @@ BasicBooleanBEAVYPlainBinaryGate::BasicBooleanBEAVYPlainBinaryGate(
       throw std::logic_error("number of SIMD values need to be the same for all wires");
     }
   }
-  outputs_.reserve(num_wires_);
-  std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<BooleanBEAVYWire>(num_simd); });
+  outputs_ = beavy_provider.make_boolean_wires(num_wires_, num_simd);
 }
 
 template <typename T>
@@ -74,6 +72,7 @@ BasicArithmeticBEAVYPlainBinaryGate<T>::BasicArithmeticBEAVYPlainBinaryGate(
   if (input_beavy_->get_num_simd() != input_plain_->get_num_simd()) {
     throw std::logic_error("number of SIMD values need to be the same for all wires");
   }
+  output_->set_additively_shared(input_beavy_->is_additively_shared());
 }
 
 template class BasicArithmeticBEAVYPlainBinaryGate<std::uint8_t>;
@@ -285,8 +284,13 @@ void ArithmeticBEAVYADDPlainGate<T>::evaluate_online() {
 
   this->input_beavy_->wait_online();
   this->input_plain_->wait_online();
-  this->output_->get_public_share() =
-      Helpers::AddVectors(this->input_beavy_->get_public_share(), this->input_plain_->get_data());
+  // an additive sharing only gets the constant added once
+  if (this->input_beavy_->is_additively_shared() && this->beavy_provider_.get_my_id() != 0) {
+    this->output_->get_public_share() = this->input_beavy_->get_public_share();
+  } else {
+    this->output_->get_public_share() =
+        Helpers::AddVectors(this->input_beavy_->get_public_share(), this->input_plain_->get_data());
+  }
   this->output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
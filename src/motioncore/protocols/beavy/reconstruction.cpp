@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "reconstruction.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "beavy_provider.h"
+#include "utility/helpers.h"
+
+namespace MOTION::proto::beavy {
+
+namespace {
+
+template <typename T>
+constexpr bool is_bits = std::is_same_v<T, ENCRYPTO::BitVector<>>;
+
+template <typename T>
+void accumulate_share(T& value, const T& share) {
+  if constexpr (is_bits<T>) {
+    value ^= share;
+  } else {
+    std::transform(std::begin(value), std::end(value), std::begin(share), std::begin(value),
+                   std::plus{});
+  }
+}
+
+}  // namespace
+
+template <typename T>
+Reconstruction<T>::Reconstruction(BEAVYProvider& beavy_provider, std::size_t gate_id,
+                                  std::size_t size, std::size_t msg_num)
+    : beavy_provider_(beavy_provider),
+      gate_id_(gate_id),
+      size_(size),
+      msg_num_(msg_num),
+      // with two parties, a king would only add a round
+      use_king_(beavy_provider.get_reconstruction_pattern() == ReconstructionPattern::king &&
+                beavy_provider.get_num_parties() > 2),
+      king_id_(gate_id % beavy_provider.get_num_parties()) {
+  if (use_king_ && beavy_provider_.get_my_id() != king_id_) {
+    if constexpr (is_bits<T>) {
+      result_future_ =
+          beavy_provider_.register_for_bits_message(king_id_, gate_id_, size, msg_num_ + 1);
+    } else {
+      result_future_ = beavy_provider_.template register_for_ints_message<typename T::value_type>(
+          king_id_, gate_id_, size, msg_num_ + 1);
+    }
+    return;
+  }
+  if constexpr (is_bits<T>) {
+    share_futures_ = beavy_provider_.register_for_bits_messages(gate_id_, size, msg_num_);
+  } else {
+    share_futures_ = beavy_provider_.template register_for_ints_messages<typename T::value_type>(
+        gate_id_, size, msg_num_);
+  }
+}
+
+template <typename T>
+void Reconstruction<T>::send_share(const T& my_share) {
+  if (!use_king_) {
+    if constexpr (is_bits<T>) {
+      beavy_provider_.broadcast_bits_message(gate_id_, my_share, msg_num_);
+    } else {
+      beavy_provider_.broadcast_ints_message(gate_id_, my_share, msg_num_);
+    }
+  } else if (beavy_provider_.get_my_id() != king_id_) {
+    if constexpr (is_bits<T>) {
+      beavy_provider_.send_bits_message(king_id_, gate_id_, my_share, msg_num_);
+    } else {
+      beavy_provider_.send_ints_message(king_id_, gate_id_, my_share, msg_num_);
+    }
+  }
+}
+
+template <typename T>
+T Reconstruction<T>::get(T my_share) {
+  const auto my_id = beavy_provider_.get_my_id();
+  if (use_king_ && my_id != king_id_) {
+    return result_future_.get();
+  }
+  const auto num_parties = beavy_provider_.get_num_parties();
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    if (party_id == my_id) {
+      continue;
+    }
+    accumulate_share(my_share, share_futures_[party_id].get());
+  }
+  if (use_king_) {
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      if (party_id == my_id) {
+        continue;
+      }
+      if constexpr (is_bits<T>) {
+        beavy_provider_.send_bits_message(party_id, gate_id_, my_share, msg_num_ + 1);
+      } else {
+        beavy_provider_.send_ints_message(party_id, gate_id_, my_share, msg_num_ + 1);
+      }
+    }
+  }
+  return my_share;
+}
+
+template <typename T>
+std::size_t Reconstruction<T>::get_num_bytes_sent() const noexcept {
+  std::size_t num_bytes;
+  if constexpr (is_bits<T>) {
+    num_bytes = Helpers::Convert::BitsToBytes(size_);
+  } else {
+    num_bytes = size_ * sizeof(typename T::value_type);
+  }
+  if (use_king_ && beavy_provider_.get_my_id() != king_id_) {
+    return num_bytes;
+  }
+  // the king receives the shares and sends the result to each other party
+  return (beavy_provider_.get_num_parties() - 1) * num_bytes;
+}
+
+template class Reconstruction<ENCRYPTO::BitVector<>>;
+template class Reconstruction<std::vector<std::uint8_t>>;
+template class Reconstruction<std::vector<std::uint16_t>>;
+template class Reconstruction<std::vector<std::uint32_t>>;
+template class Reconstruction<std::vector<std::uint64_t>>;
+
+}  // namespace MOTION::proto::beavy
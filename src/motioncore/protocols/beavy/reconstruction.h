@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utility/bit_vector.h"
+#include "utility/reusable_future.h"
+
+namespace MOTION::proto::beavy {
+
+class BEAVYProvider;
+
+// Opens a value which is XOR shared (ENCRYPTO::BitVector<>) or additively shared (std::vector<U>
+// for an unsigned integer type U) among all parties with the message pattern selected in the
+// provider, see ReconstructionPattern.  The messages are registered by the constructor.  The
+// shares are sent with `msg_num` and the king's result with `msg_num + 1`.
+template <typename T>
+class Reconstruction {
+ public:
+  Reconstruction(BEAVYProvider&, std::size_t gate_id, std::size_t size, std::size_t msg_num = 0);
+
+  // the king of a gate is chosen round robin by the gate id, so the load is spread
+  bool uses_king() const noexcept { return use_king_; }
+  std::size_t get_king_id() const noexcept { return king_id_; }
+
+  // send my share to each party or to the king
+  void send_share(const T& my_share);
+  // wait for the other shares and return the opened value, the king also sends it to the others
+  T get(T my_share);
+
+  // bytes sent by this party to open the value
+  std::size_t get_num_bytes_sent() const noexcept;
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  std::size_t gate_id_;
+  // number of bits or elements
+  std::size_t size_;
+  std::size_t msg_num_;
+  bool use_king_;
+  std::size_t king_id_;
+  // shares of the other parties, empty for parties other than the king
+  std::vector<ENCRYPTO::ReusableFiberFuture<T>> share_futures_;
+  // opened value sent by the king
+  ENCRYPTO::ReusableFiberFuture<T> result_future_;
+};
+
+}  // namespace MOTION::proto::beavy
@@ -22,6 +22,10 @@
 
 #pragma once
 
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 #include "tensor/tensor.h"
 #include "utility/bit_vector.h"
 #include "utility/enable_wait.h"
@@ -33,18 +37,33 @@ namespace MOTION::proto::beavy {
 template <typename T>
 class ArithmeticBEAVYTensor : public tensor::Tensor, public ENCRYPTO::enable_wait_setup {
  public:
-  using Tensor::Tensor;
+  ArithmeticBEAVYTensor(const tensor::TensorDimensions& dims)
+      : Tensor(dims),
+        public_share_(std::make_shared<std::vector<T>>()),
+        secret_share_(std::make_shared<std::vector<T>>()) {}
+  // View of the shares of another tensor with the same number of elements, e.g., for a reshape.
+  // The buffers are shared, so the values become valid once the other tensor is ready.
+  ArithmeticBEAVYTensor(const tensor::TensorDimensions& dims, const ArithmeticBEAVYTensor& other)
+      : Tensor(dims), public_share_(other.public_share_), secret_share_(other.secret_share_) {
+    if (dims.get_data_size() != other.get_dimensions().get_data_size()) {
+      throw std::invalid_argument("view needs to have the same number of elements");
+    }
+  }
   MPCProtocol get_protocol() const noexcept override { return MPCProtocol::ArithmeticBEAVY; }
   std::size_t get_bit_size() const noexcept override { return ENCRYPTO::bit_size_v<T>; }
-  std::vector<T>& get_public_share() { return public_share_; };
-  const std::vector<T>& get_public_share() const { return public_share_; };
-  std::vector<T>& get_secret_share() { return secret_share_; };
-  const std::vector<T>& get_secret_share() const { return secret_share_; };
+  std::vector<T>& get_public_share() { return *public_share_; };
+  const std::vector<T>& get_public_share() const { return *public_share_; };
+  std::vector<T>& get_secret_share() { return *secret_share_; };
+  const std::vector<T>& get_secret_share() const { return *secret_share_; };
+  void release_buffers() override {
+    public_share_ = std::make_shared<std::vector<T>>();
+    secret_share_ = std::make_shared<std::vector<T>>();
+  }
 
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
-  std::vector<T> public_share_;
-  std::vector<T> secret_share_;
+  std::shared_ptr<std::vector<T>> public_share_;
+  std::shared_ptr<std::vector<T>> secret_share_;
 };
 
 template <typename T>
@@ -72,6 +91,10 @@ class BooleanBEAVYTensor : public tensor::Tensor, public ENCRYPTO::enable_wait_s
   const std::vector<ENCRYPTO::BitVector<>>& get_secret_share() const noexcept {
     return secret_share_;
   }
+  void release_buffers() override {
+    public_share_ = std::vector<ENCRYPTO::BitVector<>>(bit_size_);
+    secret_share_ = std::vector<ENCRYPTO::BitVector<>>(bit_size_);
+  }
 
  private:
   std::size_t bit_size_;
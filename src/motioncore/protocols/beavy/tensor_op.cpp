@@ -36,6 +36,7 @@
 #include "crypto/oblivious_transfer/ot_provider.h"
 #include "crypto/sharing_randomness_generator.h"
 #include "executor/execution_context.h"
+#include "protocols/common/tensor_kernels.h"
 #include "utility/constants.h"
 #include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
 #include "utility/fixed_point.h"
@@ -314,7 +315,9 @@ ArithmeticBEAVYTensorFlatten<T>::ArithmeticBEAVYTensorFlatten(
     const ArithmeticBEAVYTensorCP<T> input)
     : NewGate(gate_id), beavy_provider_(beavy_provider), input_(input) {
   const auto& input_dims = input_->get_dimensions();
-  output_ = std::make_shared<ArithmeticBEAVYTensor<T>>(flatten(input_dims, axis));
+  // the output is a view of the input shares, so flattening copies nothing
+  output_ = std::make_shared<ArithmeticBEAVYTensor<T>>(flatten(input_dims, axis), *input_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -335,7 +338,6 @@ void ArithmeticBEAVYTensorFlatten<T>::evaluate_setup() {
   }
 
   input_->wait_setup();
-  output_->get_secret_share() = input_->get_secret_share();
   output_->set_setup_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -358,7 +360,6 @@ void ArithmeticBEAVYTensorFlatten<T>::evaluate_online() {
   }
 
   input_->wait_online();
-  output_->get_public_share() = input_->get_public_share();
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -373,11 +374,108 @@ void ArithmeticBEAVYTensorFlatten<T>::evaluate_online() {
 template class ArithmeticBEAVYTensorFlatten<std::uint32_t>;
 template class ArithmeticBEAVYTensorFlatten<std::uint64_t>;
 
+template <typename T>
+BEAVYTensorFusedSquare<T>::BEAVYTensorFusedSquare(std::size_t gate_id,
+                                                  BEAVYProvider& beavy_provider, std::size_t size,
+                                                  std::size_t fractional_bits)
+    : gate_id_(gate_id),
+      beavy_provider_(beavy_provider),
+      size_(size),
+      fractional_bits_(fractional_bits) {
+  const auto my_id = beavy_provider_.get_my_id();
+  // msg_num 0 is used by the linear layer for Delta_y
+  share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, size_, 1);
+  if (!beavy_provider_.get_fake_setup()) {
+    // the cross term of the square is symmetric, so one direction suffices
+    auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
+    if (my_id == 0) {
+      mult_receiver_ = ap.template register_integer_multiplication_receive<T>(size_);
+    } else {
+      mult_sender_ = ap.template register_integer_multiplication_send<T>(size_);
+    }
+  }
+}
+
+template <typename T>
+BEAVYTensorFusedSquare<T>::~BEAVYTensorFusedSquare() = default;
+
+template <typename T>
+const std::vector<T>& BEAVYTensorFusedSquare<T>::generate_mask() {
+  delta_y_share_ = Helpers::RandomVector<T>(size_);
+  return delta_y_share_;
+}
+
+template <typename T>
+void BEAVYTensorFusedSquare<T>::evaluate_setup(const TensorKernels& kernels,
+                                               const std::vector<T>& delta_z_share) {
+  // [[delta_y]_0 * [delta_y]_1]_i
+  std::vector<T> delta_yy_share;
+  if (beavy_provider_.get_fake_setup()) {
+    delta_yy_share = Helpers::RandomVector<T>(size_);
+  } else if (mult_receiver_) {
+    mult_receiver_->set_inputs(delta_y_share_);
+    mult_receiver_->compute_outputs();
+    delta_yy_share = mult_receiver_->get_outputs();
+    mult_receiver_->clear();
+  } else {
+    mult_sender_->set_inputs(delta_y_share_);
+    mult_sender_->compute_outputs();
+    delta_yy_share = mult_sender_->get_outputs();
+    mult_sender_->clear();
+  }
+  // [delta_y^2]_i = [delta_y]_i^2 + 2 * [[delta_y]_0 * [delta_y]_1]_i
+  Delta_z_share_.resize(size_);
+  kernels.for_each_range(size_, TensorKernels::element_granularity,
+                         [this, &delta_yy_share](std::size_t begin, std::size_t end) {
+                           for (std::size_t j = begin; j < end; ++j) {
+                             Delta_z_share_[j] = delta_y_share_[j] * delta_y_share_[j] +
+                                                 2 * delta_yy_share[j];
+                           }
+                         });
+  if (fractional_bits_ == 0) {
+    // [Delta_z]_i += [delta_z]_i
+    kernels.transform(Delta_z_share_, delta_z_share, std::plus{});
+    // NB: happens after truncation if that is requested
+  }
+}
+
+template <typename T>
+std::vector<T> BEAVYTensorFusedSquare<T>::evaluate_online(const TensorKernels& kernels,
+                                                          const std::vector<T>& Delta_y,
+                                                          const std::vector<T>& delta_z_share) {
+  // z = (Delta_y - delta_y)^2, i.e.,
+  // [Delta_z]_i = Delta_y^2 - 2 * Delta_y * [delta_y]_i + [delta_y^2]_i + [delta_z]_i
+  const bool is_my_job = beavy_provider_.is_my_job(gate_id_);
+  kernels.for_each_range(size_, TensorKernels::element_granularity,
+                         [this, &Delta_y, is_my_job](std::size_t begin, std::size_t end) {
+                           for (std::size_t j = begin; j < end; ++j) {
+                             Delta_z_share_[j] -= 2 * Delta_y[j] * delta_y_share_[j];
+                             if (is_my_job) {
+                               Delta_z_share_[j] += Delta_y[j] * Delta_y[j];
+                             }
+                           }
+                         });
+  if (fractional_bits_ > 0) {
+    fixed_point::truncate_shared<T>(Delta_z_share_.data(), fractional_bits_, size_, is_my_job);
+    // [Delta_z]_i += [delta_z]_i
+    kernels.transform(Delta_z_share_, delta_z_share, std::plus{});
+    // NB: happens in setup phase if no truncation is requested
+  }
+  // broadcast [Delta_z]_i
+  beavy_provider_.broadcast_ints_message(gate_id_, Delta_z_share_, 1);
+  // Delta_z = [Delta_z]_i + [Delta_z]_(1-i)
+  kernels.transform(Delta_z_share_, share_future_.get(), std::plus{});
+  return std::move(Delta_z_share_);
+}
+
+template class BEAVYTensorFusedSquare<std::uint32_t>;
+template class BEAVYTensorFusedSquare<std::uint64_t>;
+
 template <typename T>
 ArithmeticBEAVYTensorConv2D<T>::ArithmeticBEAVYTensorConv2D(
     std::size_t gate_id, BEAVYProvider& beavy_provider, tensor::Conv2DOp conv_op,
     const ArithmeticBEAVYTensorCP<T> input, const ArithmeticBEAVYTensorCP<T> kernel,
-    const ArithmeticBEAVYTensorCP<T> bias, std::size_t fractional_bits)
+    const ArithmeticBEAVYTensorCP<T> bias, std::size_t fractional_bits, bool fuse_square)
     : NewGate(gate_id),
       beavy_provider_(beavy_provider),
       conv_op_(conv_op),
@@ -386,8 +484,17 @@ ArithmeticBEAVYTensorConv2D<T>::ArithmeticBEAVYTensorConv2D(
       kernel_(kernel),
       bias_(bias),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(conv_op.get_output_tensor_dims())) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_, *kernel_, fractional_bits_));
   const auto my_id = beavy_provider_.get_my_id();
   const auto output_size = conv_op_.compute_output_size();
+  if (fuse_square) {
+    const auto y_fractional_bits = output_->get_fractional_bits();
+    output_->set_fractional_bits(
+        tensor::truncated_fractional_bits(2 * y_fractional_bits, fractional_bits_));
+    fused_square_ = std::make_unique<BEAVYTensorFusedSquare<T>>(gate_id_, beavy_provider_,
+                                                                output_size, fractional_bits_);
+  }
   share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, output_size);
   auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
   if (!beavy_provider_.get_fake_setup()) {
@@ -402,6 +509,16 @@ ArithmeticBEAVYTensorConv2D<T>::ArithmeticBEAVYTensorConv2D(
       logger->LogTrace(fmt::format("Gate {}: ArithmeticBEAVYTensorConv2D<T> created", gate_id_));
     }
   }
+  if constexpr (MOTION_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      const auto memory = get_convolution_memory(conv_op_, sizeof(T));
+      logger->LogDebug(
+          fmt::format("Gate {}: ArithmeticBEAVYTensorConv2D<T> local convolutions use at most {} "
+                      "bytes, an im2col matrix of the input would need {} bytes",
+                      gate_id_, memory.peak_bytes, memory.im2col_bytes));
+    }
+  }
 }
 
 template <typename T>
@@ -409,6 +526,16 @@ ArithmeticBEAVYTensorConv2D<T>::~ArithmeticBEAVYTensorConv2D() = default;
 
 template <typename T>
 void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
+  evaluate_setup_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup_with_context(ExecutionContext& exec_ctx) {
+  evaluate_setup_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -416,6 +543,7 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
           fmt::format("Gate {}: ArithmeticBEAVYTensorConv2D<T>::evaluate_setup start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   const auto output_size = conv_op_.compute_output_size();
 
@@ -427,7 +555,9 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
 
   const auto& delta_a_share = input_->get_secret_share();
   const auto& delta_b_share = kernel_->get_secret_share();
-  const auto& delta_y_share = output_->get_secret_share();
+  // with a fused square, the output is z = y^2 and y has a mask of its own
+  const auto& delta_y_share =
+      fused_square_ ? fused_square_->generate_mask() : output_->get_secret_share();
 
   if (!beavy_provider_.get_fake_setup()) {
     conv_input_side_->set_input(delta_a_share);
@@ -435,12 +565,11 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
   }
 
   // [Delta_y]_i = [delta_a]_i * [delta_b]_i
-  convolution(conv_op_, delta_a_share.data(), delta_b_share.data(), Delta_y_share_.data());
+  kernels.convolution(conv_op_, delta_a_share.data(), delta_b_share.data(), Delta_y_share_.data());
 
   if (fractional_bits_ == 0) {
     // [Delta_y]_i += [delta_y]_i
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                              std::begin(delta_y_share), std::begin(Delta_y_share_), std::plus{});
+    kernels.transform(Delta_y_share_, delta_y_share, std::plus{});
     // NB: happens after truncation if that is requested
   }
 
@@ -458,13 +587,19 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
     delta_ab_share1 = conv_input_side_->get_output();
     // [[delta_b]_i * [delta_a]_(1-i)]_i
     delta_ab_share2 = conv_kernel_side_->get_output();
+    // free the OT data of the products already in the setup phase
+    conv_input_side_->clear();
+    conv_kernel_side_->clear();
   }
   // [Delta_y]_i += [[delta_a]_i * [delta_b]_(1-i)]_i
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(delta_ab_share1), std::begin(Delta_y_share_), std::plus{});
+  kernels.transform(Delta_y_share_, delta_ab_share1, std::plus{});
   // [Delta_y]_i += [[delta_b]_i * [delta_a]_(1-i)]_i
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(delta_ab_share2), std::begin(Delta_y_share_), std::plus{});
+  kernels.transform(Delta_y_share_, delta_ab_share2, std::plus{});
+
+  if (fused_square_) {
+    // [delta_y^2]_i, after the products of the linear layer which share its OT batch
+    fused_square_->evaluate_setup(kernels, output_->get_secret_share());
+  }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -477,6 +612,16 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_setup() {
 
 template <typename T>
 void ArithmeticBEAVYTensorConv2D<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorConv2D<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorConv2D<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -484,6 +629,7 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_online() {
           fmt::format("Gate {}: ArithmeticBEAVYTensorConv2D<T>::evaluate_online start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   const auto output_size = conv_op_.compute_output_size();
   input_->wait_online();
@@ -497,39 +643,39 @@ void ArithmeticBEAVYTensorConv2D<T>::evaluate_online() {
   // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_ab]_i
 
   // [Delta_y]_i -= Delta_a * [delta_b]_i
-  convolution(conv_op_, Delta_a.data(), delta_b_share.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                            std::begin(Delta_y_share_), std::minus{});
+  kernels.convolution(conv_op_, Delta_a.data(), delta_b_share.data(), tmp.data());
+  kernels.transform(Delta_y_share_, tmp, std::minus{});
 
   // [Delta_y]_i -= Delta_b * [delta_a]_i
-  convolution(conv_op_, delta_a_share.data(), Delta_b.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                            std::begin(Delta_y_share_), std::minus{});
+  kernels.convolution(conv_op_, delta_a_share.data(), Delta_b.data(), tmp.data());
+  kernels.transform(Delta_y_share_, tmp, std::minus{});
 
   // [Delta_y]_i += Delta_ab (== Delta_a * Delta_b)
   if (beavy_provider_.is_my_job(gate_id_)) {
-    convolution(conv_op_, Delta_a.data(), Delta_b.data(), tmp.data());
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                              std::begin(Delta_y_share_), std::plus{});
+    kernels.convolution(conv_op_, Delta_a.data(), Delta_b.data(), tmp.data());
+    kernels.transform(Delta_y_share_, tmp, std::plus{});
   }
 
   if (fractional_bits_ > 0) {
     fixed_point::truncate_shared<T>(Delta_y_share_.data(), fractional_bits_, Delta_y_share_.size(),
                                     beavy_provider_.is_my_job(gate_id_));
     // [Delta_y]_i += [delta_y]_i
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
-                              std::plus{});
+    kernels.transform(Delta_y_share_,
+                      fused_square_ ? fused_square_->get_mask_share() : output_->get_secret_share(),
+                      std::plus{});
     // NB: happens in setup phase if no truncation is requested
   }
 
   // broadcast [Delta_y]_i
   beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
   // Delta_y = [Delta_y]_i + [Delta_y]_(1-i)
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(share_future_.get()), std::begin(Delta_y_share_),
-                            std::plus{});
-  output_->get_public_share() = std::move(Delta_y_share_);
+  kernels.transform(Delta_y_share_, share_future_.get(), std::plus{});
+  if (fused_square_) {
+    output_->get_public_share() =
+        fused_square_->evaluate_online(kernels, Delta_y_share_, output_->get_secret_share());
+  } else {
+    output_->get_public_share() = std::move(Delta_y_share_);
+  }
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -550,7 +696,8 @@ ArithmeticBEAVYTensorGemm<T>::ArithmeticBEAVYTensorGemm(std::size_t gate_id,
                                                         tensor::GemmOp gemm_op,
                                                         const ArithmeticBEAVYTensorCP<T> input_A,
                                                         const ArithmeticBEAVYTensorCP<T> input_B,
-                                                        std::size_t fractional_bits)
+                                                        std::size_t fractional_bits,
+                                                        bool fuse_square)
     : NewGate(gate_id),
       beavy_provider_(beavy_provider),
       gemm_op_(gemm_op),
@@ -558,8 +705,17 @@ ArithmeticBEAVYTensorGemm<T>::ArithmeticBEAVYTensorGemm(std::size_t gate_id,
       input_A_(input_A),
       input_B_(input_B),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(gemm_op.get_output_tensor_dims())) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_A_, *input_B_, fractional_bits_));
   const auto my_id = beavy_provider_.get_my_id();
   const auto output_size = gemm_op_.compute_output_size();
+  if (fuse_square) {
+    const auto y_fractional_bits = output_->get_fractional_bits();
+    output_->set_fractional_bits(
+        tensor::truncated_fractional_bits(2 * y_fractional_bits, fractional_bits_));
+    fused_square_ = std::make_unique<BEAVYTensorFusedSquare<T>>(gate_id_, beavy_provider_,
+                                                                output_size, fractional_bits_);
+  }
   share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, output_size);
   auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
   const auto dim_l = gemm_op_.input_A_shape_[0];
@@ -584,6 +740,16 @@ ArithmeticBEAVYTensorGemm<T>::~ArithmeticBEAVYTensorGemm() = default;
 
 template <typename T>
 void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
+  evaluate_setup_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorGemm<T>::evaluate_setup_with_context(ExecutionContext& exec_ctx) {
+  evaluate_setup_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorGemm<T>::evaluate_setup_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -591,6 +757,7 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
           fmt::format("Gate {}: ArithmeticBEAVYTensorGemm<T>::evaluate_setup start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   const auto output_size = gemm_op_.compute_output_size();
 
@@ -602,7 +769,9 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
 
   const auto& delta_a_share = input_A_->get_secret_share();
   const auto& delta_b_share = input_B_->get_secret_share();
-  const auto& delta_y_share = output_->get_secret_share();
+  // with a fused square, the output is z = y^2 and y has a mask of its own
+  const auto& delta_y_share =
+      fused_square_ ? fused_square_->generate_mask() : output_->get_secret_share();
 
   if (!beavy_provider_.get_fake_setup()) {
     mm_lhs_side_->set_input(delta_a_share);
@@ -610,12 +779,12 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
   }
 
   // [Delta_y]_i = [delta_a]_i * [delta_b]_i
-  matrix_multiply(gemm_op_, delta_a_share.data(), delta_b_share.data(), Delta_y_share_.data());
+  kernels.matrix_multiply(gemm_op_, delta_a_share.data(), delta_b_share.data(),
+                          Delta_y_share_.data());
 
   if (fractional_bits_ == 0) {
     // [Delta_y]_i += [delta_y]_i
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                              std::begin(delta_y_share), std::begin(Delta_y_share_), std::plus{});
+    kernels.transform(Delta_y_share_, delta_y_share, std::plus{});
     // NB: happens after truncation if that is requested
   }
 
@@ -633,13 +802,19 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
     delta_ab_share1 = mm_lhs_side_->get_output();
     // [[delta_b]_i * [delta_a]_(1-i)]_i
     delta_ab_share2 = mm_rhs_side_->get_output();
+    // free the OT data of the products already in the setup phase
+    mm_lhs_side_->clear();
+    mm_rhs_side_->clear();
   }
   // [Delta_y]_i += [[delta_a]_i * [delta_b]_(1-i)]_i
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(delta_ab_share1), std::begin(Delta_y_share_), std::plus{});
+  kernels.transform(Delta_y_share_, delta_ab_share1, std::plus{});
   // [Delta_y]_i += [[delta_b]_i * [delta_a]_(1-i)]_i
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(delta_ab_share2), std::begin(Delta_y_share_), std::plus{});
+  kernels.transform(Delta_y_share_, delta_ab_share2, std::plus{});
+
+  if (fused_square_) {
+    // [delta_y^2]_i, after the products of the linear layer which share its OT batch
+    fused_square_->evaluate_setup(kernels, output_->get_secret_share());
+  }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -652,6 +827,16 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_setup() {
 
 template <typename T>
 void ArithmeticBEAVYTensorGemm<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorGemm<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorGemm<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -659,6 +844,7 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_online() {
           fmt::format("Gate {}: ArithmeticBEAVYTensorGemm<T>::evaluate_online start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   const auto output_size = gemm_op_.compute_output_size();
   input_A_->wait_online();
@@ -672,39 +858,39 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_online() {
   // after setup phase, `Delta_y_share_` contains [delta_y]_i + [delta_ab]_i
 
   // [Delta_y]_i -= Delta_a * [delta_b]_i
-  matrix_multiply(gemm_op_, Delta_a.data(), delta_b_share.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                            std::begin(Delta_y_share_), std::minus{});
+  kernels.matrix_multiply(gemm_op_, Delta_a.data(), delta_b_share.data(), tmp.data());
+  kernels.transform(Delta_y_share_, tmp, std::minus{});
 
   // [Delta_y]_i -= Delta_b * [delta_a]_i
-  matrix_multiply(gemm_op_, delta_a_share.data(), Delta_b.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                            std::begin(Delta_y_share_), std::minus{});
+  kernels.matrix_multiply(gemm_op_, delta_a_share.data(), Delta_b.data(), tmp.data());
+  kernels.transform(Delta_y_share_, tmp, std::minus{});
 
   // [Delta_y]_i += Delta_ab (== Delta_a * Delta_b)
   if (beavy_provider_.is_my_job(gate_id_)) {
-    matrix_multiply(gemm_op_, Delta_a.data(), Delta_b.data(), tmp.data());
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_), std::begin(tmp),
-                              std::begin(Delta_y_share_), std::plus{});
+    kernels.matrix_multiply(gemm_op_, Delta_a.data(), Delta_b.data(), tmp.data());
+    kernels.transform(Delta_y_share_, tmp, std::plus{});
   }
 
   if (fractional_bits_ > 0) {
     fixed_point::truncate_shared<T>(Delta_y_share_.data(), fractional_bits_, Delta_y_share_.size(),
                                     beavy_provider_.is_my_job(gate_id_));
     // [Delta_y]_i += [delta_y]_i
-    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
-                              std::plus{});
+    kernels.transform(Delta_y_share_,
+                      fused_square_ ? fused_square_->get_mask_share() : output_->get_secret_share(),
+                      std::plus{});
     // NB: happens in setup phase if no truncation is requested
   }
 
   // broadcast [Delta_y]_i
   beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
   // Delta_y = [Delta_y]_i + [Delta_y]_(1-i)
-  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
-                            std::begin(share_future_.get()), std::begin(Delta_y_share_),
-                            std::plus{});
-  output_->get_public_share() = std::move(Delta_y_share_);
+  kernels.transform(Delta_y_share_, share_future_.get(), std::plus{});
+  if (fused_square_) {
+    output_->get_public_share() =
+        fused_square_->evaluate_online(kernels, Delta_y_share_, output_->get_secret_share());
+  } else {
+    output_->get_public_share() = std::move(Delta_y_share_);
+  }
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -719,6 +905,159 @@ void ArithmeticBEAVYTensorGemm<T>::evaluate_online() {
 template class ArithmeticBEAVYTensorGemm<std::uint32_t>;
 template class ArithmeticBEAVYTensorGemm<std::uint64_t>;
 
+template <typename T>
+ArithmeticBEAVYTensorSparseGemm<T>::ArithmeticBEAVYTensorSparseGemm(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, tensor::GemmOp gemm_op,
+    const ArithmeticBEAVYTensorCP<T> input_A, CSRMatrix<T> weights, std::size_t weights_owner,
+    std::size_t weights_fractional_bits, std::size_t fractional_bits)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      gemm_op_(gemm_op),
+      fractional_bits_(fractional_bits),
+      input_A_(input_A),
+      weights_(std::move(weights)),
+      is_weights_owner_(weights_owner == beavy_provider.get_my_id()),
+      output_(std::make_shared<ArithmeticBEAVYTensor<T>>(gemm_op.get_output_tensor_dims())) {
+  output_->set_fractional_bits(tensor::truncated_fractional_bits(
+      input_A_->get_fractional_bits() + weights_fractional_bits, fractional_bits_));
+  const auto my_id = beavy_provider_.get_my_id();
+  const auto output_size = gemm_op_.compute_output_size();
+  share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, output_size);
+  auto& ap = beavy_provider_.get_arith_manager().get_provider(1 - my_id);
+  const auto dim_l = gemm_op_.input_A_shape_[0];
+  if (!beavy_provider_.get_fake_setup()) {
+    if (is_weights_owner_) {
+      mm_sparse_side_ =
+          ap.template register_sparse_matrix_multiplication_sparse_side<T>(dim_l, weights_);
+    } else {
+      mm_dense_side_ =
+          ap.template register_sparse_matrix_multiplication_dense_side<T>(dim_l, weights_);
+    }
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYTensorSparseGemm<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+ArithmeticBEAVYTensorSparseGemm<T>::~ArithmeticBEAVYTensorSparseGemm() = default;
+
+// With y = A * B = (Delta_a - [delta_a]_o - [delta_a]_n) * B for the owner o of B and the other
+// party n, the product [delta_a]_n * B is shared in the setup phase.  Then the share
+// -[[delta_a]_n * B]_n of party n is already known in the setup phase and only the owner computes
+// its share in the online phase.
+template <typename T>
+void ArithmeticBEAVYTensorSparseGemm<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorSparseGemm<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto output_size = gemm_op_.compute_output_size();
+
+  output_->get_secret_share() = Helpers::RandomVector<T>(output_size);
+  output_->set_setup_ready();
+
+  // [[delta_a]_n * B]_i
+  std::vector<T> delta_ab_share;
+  if (beavy_provider_.get_fake_setup()) {
+    delta_ab_share = Helpers::RandomVector<T>(output_size);
+  } else if (is_weights_owner_) {
+    mm_sparse_side_->set_input(weights_.values_);
+    mm_sparse_side_->compute_output();
+    delta_ab_share = mm_sparse_side_->get_output();
+    mm_sparse_side_->clear();
+  } else {
+    input_A_->wait_setup();
+    mm_dense_side_->set_input(input_A_->get_secret_share());
+    mm_dense_side_->compute_output();
+    delta_ab_share = mm_dense_side_->get_output();
+    mm_dense_side_->clear();
+  }
+  // [y]_i = -[[delta_a]_n * B]_i (+ the products of the owner in the online phase)
+  Delta_y_share_.resize(output_size);
+  __gnu_parallel::transform(std::begin(delta_ab_share), std::end(delta_ab_share),
+                            std::begin(Delta_y_share_), std::negate{});
+
+  if (!is_weights_owner_) {
+    fixed_point::truncate_shared<T>(Delta_y_share_.data(), fractional_bits_,
+                                    Delta_y_share_.size(), false);
+    // [Delta_y]_n = [y]_n + [delta_y]_n
+    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
+                              std::plus{});
+    beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorSparseGemm<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorSparseGemm<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorSparseGemm<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  if (is_weights_owner_) {
+    const auto output_size = gemm_op_.compute_output_size();
+    const auto dim_l = gemm_op_.input_A_shape_[0];
+    input_A_->wait_online();
+    const auto& Delta_a = input_A_->get_public_share();
+    const auto& delta_a_share = input_A_->get_secret_share();
+    std::vector<T> tmp(Delta_a.size());
+    // Delta_a - [delta_a]_o
+    __gnu_parallel::transform(std::begin(Delta_a), std::end(Delta_a), std::begin(delta_a_share),
+                              std::begin(tmp), std::minus{});
+    std::vector<T> product(output_size);
+    matrix_multiply(dim_l, tmp.data(), weights_, product.data());
+    // [y]_o = (Delta_a - [delta_a]_o) * B - [[delta_a]_n * B]_o
+    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                              std::begin(product), std::begin(Delta_y_share_), std::plus{});
+    fixed_point::truncate_shared<T>(Delta_y_share_.data(), fractional_bits_,
+                                    Delta_y_share_.size(), true);
+    // [Delta_y]_o = [y]_o + [delta_y]_o
+    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
+                              std::plus{});
+    beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
+  }
+  // Delta_y = [Delta_y]_o + [Delta_y]_n
+  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                            std::begin(share_future_.get()), std::begin(Delta_y_share_),
+                            std::plus{});
+  output_->get_public_share() = std::move(Delta_y_share_);
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorSparseGemm<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticBEAVYTensorSparseGemm<std::uint32_t>;
+template class ArithmeticBEAVYTensorSparseGemm<std::uint64_t>;
+
 template <typename T>
 ArithmeticBEAVYTensorMul<T>::ArithmeticBEAVYTensorMul(std::size_t gate_id,
                                                       BEAVYProvider& beavy_provider,
@@ -731,6 +1070,8 @@ ArithmeticBEAVYTensorMul<T>::ArithmeticBEAVYTensorMul(std::size_t gate_id,
       input_A_(input_A),
       input_B_(input_B),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(input_A_->get_dimensions())) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_A_, *input_B_, fractional_bits_));
   if (input_A_->get_dimensions() != input_B_->get_dimensions()) {
     throw std::logic_error("mismatch of dimensions");
   }
@@ -892,16 +1233,22 @@ ArithmeticBEAVYTensorAveragePool<T>::ArithmeticBEAVYTensorAveragePool(
       fractional_bits_(fractional_bits),
       input_(input),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(avgpool_op_.get_output_tensor_dims())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if (!avgpool_op_.verify()) {
     throw std::invalid_argument("invalid AveragePoolOp");
   }
+  output_->get_public_share().resize(avgpool_op_.compute_output_size());
+  if (fractional_bits_ == 0) {
+    // only sum the windows: both shares are summed locally, without any communication
+    output_->get_secret_share().resize(avgpool_op_.compute_output_size());
+    return;
+  }
   auto kernel_size = avgpool_op_.compute_kernel_size();
   if (kernel_size > (T(1) << fractional_bits_)) {
     throw std::invalid_argument(
         "ArithmeticBEAVYTensorAveragePool: not enough fractional bits to represent factor");
   }
   factor_ = fixed_point::encode<T>(1.0 / kernel_size, fractional_bits_);
-  output_->get_public_share().resize(avgpool_op_.compute_output_size());
   tmp_in_.resize(data_size_);
   tmp_out_.resize(avgpool_op_.compute_output_size());
   const auto my_id = beavy_provider_.get_my_id();
@@ -919,6 +1266,14 @@ void ArithmeticBEAVYTensorAveragePool<T>::evaluate_setup() {
     }
   }
 
+  if (fractional_bits_ == 0) {
+    input_->wait_setup();
+    sum_pool(avgpool_op_, input_->get_secret_share().data(),
+             output_->get_secret_share().data());
+    output_->set_setup_ready();
+    return;
+  }
+
   output_->get_secret_share() = Helpers::RandomVector<T>(avgpool_op_.compute_output_size());
   output_->set_setup_ready();
 
@@ -960,6 +1315,14 @@ void ArithmeticBEAVYTensorAveragePool<T>::evaluate_online() {
     }
   }
 
+  if (fractional_bits_ == 0) {
+    input_->wait_online();
+    sum_pool(avgpool_op_, input_->get_public_share().data(),
+             output_->get_public_share().data());
+    output_->set_online_ready();
+    return;
+  }
+
   if (beavy_provider_.is_my_job(gate_id_)) {
     input_->wait_online();
     // convert: alpha -> A
@@ -997,6 +1360,150 @@ void ArithmeticBEAVYTensorAveragePool<T>::evaluate_online() {
 template class ArithmeticBEAVYTensorAveragePool<std::uint32_t>;
 template class ArithmeticBEAVYTensorAveragePool<std::uint64_t>;
 
+template <typename T>
+ArithmeticBEAVYTensorTruncation<T>::ArithmeticBEAVYTensorTruncation(
+    std::size_t gate_id, BEAVYProvider& beavy_provider, const ArithmeticBEAVYTensorCP<T> input,
+    std::size_t truncate_bits)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      data_size_(input->get_dimensions().get_data_size()),
+      truncate_bits_(truncate_bits),
+      input_(input),
+      output_(std::make_shared<ArithmeticBEAVYTensor<T>>(input_->get_dimensions())) {
+  if (truncate_bits_ >= ENCRYPTO::bit_size_v<T>) {
+    throw std::invalid_argument(
+        fmt::format("ArithmeticBEAVYTensorTruncation: cannot truncate {} bits of {} bit values",
+                    truncate_bits_, ENCRYPTO::bit_size_v<T>));
+  }
+  output_->set_fractional_bits(
+      tensor::truncated_fractional_bits(input_->get_fractional_bits(), truncate_bits_));
+  Delta_y_share_.resize(data_size_);
+  const auto my_id = beavy_provider_.get_my_id();
+  share_future_ = beavy_provider_.register_for_ints_message<T>(1 - my_id, gate_id_, data_size_);
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYTensorTruncation<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorTruncation<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorTruncation<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  output_->get_secret_share() = Helpers::RandomVector<T>(data_size_);
+  output_->set_setup_ready();
+
+  // the share of the party not holding the public share is known in the setup phase
+  if (!beavy_provider_.is_my_job(gate_id_)) {
+    input_->wait_setup();
+    // convert: alpha -> A
+    __gnu_parallel::transform(std::begin(input_->get_secret_share()),
+                              std::end(input_->get_secret_share()), std::begin(Delta_y_share_),
+                              std::negate{});
+    fixed_point::truncate_shared(Delta_y_share_.data(), truncate_bits_, data_size_, false);
+    // convert: A -> alpha, mask with secret_share + send
+    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
+                              std::plus{});
+    beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorTruncation<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYTensorTruncation<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorTruncation<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  if (beavy_provider_.is_my_job(gate_id_)) {
+    input_->wait_online();
+    // convert: alpha -> A
+    __gnu_parallel::transform(
+        std::begin(input_->get_public_share()), std::end(input_->get_public_share()),
+        std::begin(input_->get_secret_share()), std::begin(Delta_y_share_), std::minus{});
+    fixed_point::truncate_shared(Delta_y_share_.data(), truncate_bits_, data_size_, true);
+    // convert: A -> alpha, mask with secret_share + send
+    __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                              std::begin(output_->get_secret_share()), std::begin(Delta_y_share_),
+                              std::plus{});
+    beavy_provider_.broadcast_ints_message(gate_id_, Delta_y_share_);
+  }
+
+  auto other_share = share_future_.get();
+  __gnu_parallel::transform(std::begin(Delta_y_share_), std::end(Delta_y_share_),
+                            std::begin(other_share), std::begin(Delta_y_share_), std::plus{});
+  output_->get_public_share() = std::move(Delta_y_share_);
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYTensorTruncation<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticBEAVYTensorTruncation<std::uint32_t>;
+template class ArithmeticBEAVYTensorTruncation<std::uint64_t>;
+
+ArithmeticBEAVYTensorRingReduction::ArithmeticBEAVYTensorRingReduction(
+    std::size_t gate_id, BEAVYProvider& beavy_provider,
+    const ArithmeticBEAVYTensorCP<std::uint64_t> input)
+    : NewGate(gate_id),
+      beavy_provider_(beavy_provider),
+      input_(input),
+      output_(std::make_shared<ArithmeticBEAVYTensor<std::uint32_t>>(input_->get_dimensions())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = beavy_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYTensorRingReduction created", gate_id_));
+    }
+  }
+}
+
+void ArithmeticBEAVYTensorRingReduction::evaluate_setup() {
+  input_->wait_setup();
+  const auto& delta_x_share = input_->get_secret_share();
+  output_->get_secret_share().resize(delta_x_share.size());
+  std::copy(std::begin(delta_x_share), std::end(delta_x_share),
+            std::begin(output_->get_secret_share()));
+  output_->set_setup_ready();
+}
+
+void ArithmeticBEAVYTensorRingReduction::evaluate_online() {
+  input_->wait_online();
+  const auto& Delta_x = input_->get_public_share();
+  output_->get_public_share().resize(Delta_x.size());
+  std::copy(std::begin(Delta_x), std::end(Delta_x), std::begin(output_->get_public_share()));
+  output_->set_online_ready();
+}
+
 template <typename T>
 BooleanToArithmeticBEAVYTensorConversion<T>::BooleanToArithmeticBEAVYTensorConversion(
     std::size_t gate_id, BEAVYProvider& beavy_provider, const BooleanBEAVYTensorCP input)
@@ -1005,6 +1512,7 @@ BooleanToArithmeticBEAVYTensorConversion<T>::BooleanToArithmeticBEAVYTensorConve
       data_size_(input->get_dimensions().get_data_size()),
       input_(std::move(input)),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(input_->get_dimensions())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   const auto my_id = beavy_provider_.get_my_id();
 
   auto& ot_provider = beavy_provider_.get_ot_manager().get_provider(1 - my_id);
@@ -1169,6 +1677,7 @@ BooleanBEAVYTensorRelu::BooleanBEAVYTensorRelu(std::size_t gate_id, BEAVYProvide
       data_size_(input->get_dimensions().get_data_size()),
       input_(std::move(input)),
       output_(std::make_shared<BooleanBEAVYTensor>(input_->get_dimensions(), bit_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   const auto my_id = beavy_provider_.get_my_id();
   share_future_ =
       beavy_provider_.register_for_bits_message(1 - my_id, gate_id_, data_size_ * (bit_size_ - 1));
@@ -1188,6 +1697,14 @@ BooleanBEAVYTensorRelu::BooleanBEAVYTensorRelu(std::size_t gate_id, BEAVYProvide
 BooleanBEAVYTensorRelu::~BooleanBEAVYTensorRelu() = default;
 
 void BooleanBEAVYTensorRelu::evaluate_setup() {
+  evaluate_setup_impl(nullptr);
+}
+
+void BooleanBEAVYTensorRelu::evaluate_setup_with_context(ExecutionContext& exec_ctx) {
+  evaluate_setup_impl(&exec_ctx);
+}
+
+void BooleanBEAVYTensorRelu::evaluate_setup_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -1195,6 +1712,7 @@ void BooleanBEAVYTensorRelu::evaluate_setup() {
           fmt::format("Gate {}: BooleanBEAVYTensorRelu::evaluate_setup start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   // generate the secret shares
   auto& out_sshares = output_->get_secret_share();
@@ -1214,37 +1732,44 @@ void BooleanBEAVYTensorRelu::evaluate_setup() {
   ot_receiver_->SetChoices(my_msb_sshare);
   ot_receiver_->SendCorrections();
   ENCRYPTO::BitVector<> ot_inputs((bit_size_ - 1) * data_size_);
+  // ranges of multiples of 8 values write to disjoint bytes
   // inefficient, but works ...
-  for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
-    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
-      ot_inputs.Set(sshares[bit_j].Get(int_i), int_i * (bit_size_ - 1) + bit_j);
+  kernels.for_each_range(data_size_, 8, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t int_i = begin; int_i < end; ++int_i) {
+      for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
+        ot_inputs.Set(sshares[bit_j].Get(int_i), int_i * (bit_size_ - 1) + bit_j);
+      }
     }
-  }
+  });
   ot_sender_->SetCorrelations(std::move(ot_inputs));
   ot_sender_->SendMessages();
   ot_sender_->ComputeOutputs();
   ot_receiver_->ComputeOutputs();
 
   // compute the products of the msb_mask with all other masks
-  for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
-    // local part
-    auto tmp = my_msb_sshare & sshares[bit_j];
-    // output mask
-    tmp ^= out_sshares[bit_j];
-    Delta_y_share_.Append(tmp);
-  }
   const auto ot_snd_out = ot_sender_->GetOutputs();
   const auto ot_rcv_out = ot_receiver_->GetOutputs();
-  // inefficient, but works ...
-  for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
-    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
-      bool tmp = Delta_y_share_.Get(bit_j * data_size_ + int_i);
-      // product of other msb_mask with my sshare masks
-      tmp ^= ot_snd_out.Get(int_i * (bit_size_ - 1) + bit_j);
-      // product of my_msb_mask with other sshare masks
-      tmp ^= ot_rcv_out.Get(int_i * (bit_size_ - 1) + bit_j);
-      Delta_y_share_.Set(tmp, bit_j * data_size_ + int_i);
+  std::vector<ENCRYPTO::BitVector<>> rows(bit_size_ - 1);
+  kernels.for_each_range(bit_size_ - 1, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t bit_j = begin; bit_j < end; ++bit_j) {
+      // local part
+      auto& row = rows[bit_j];
+      row = my_msb_sshare & sshares[bit_j];
+      // output mask
+      row ^= out_sshares[bit_j];
+      // inefficient, but works ...
+      for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
+        bool tmp = row.Get(int_i);
+        // product of other msb_mask with my sshare masks
+        tmp ^= ot_snd_out.Get(int_i * (bit_size_ - 1) + bit_j);
+        // product of my_msb_mask with other sshare masks
+        tmp ^= ot_rcv_out.Get(int_i * (bit_size_ - 1) + bit_j);
+        row.Set(tmp, int_i);
+      }
     }
+  });
+  for (const auto& row : rows) {
+    Delta_y_share_.Append(row);
   }
   // => Delta_y_share_ contains now [delta_ab]_i ^ [delta_y]_i
 
@@ -1258,6 +1783,14 @@ void BooleanBEAVYTensorRelu::evaluate_setup() {
 }
 
 void BooleanBEAVYTensorRelu::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+void BooleanBEAVYTensorRelu::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+void BooleanBEAVYTensorRelu::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
     if (logger) {
@@ -1265,6 +1798,7 @@ void BooleanBEAVYTensorRelu::evaluate_online() {
           fmt::format("Gate {}: BooleanBEAVYTensorRelu::evaluate_online start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   input_->wait_online();
   const auto& pshares = input_->get_public_share();
@@ -1272,19 +1806,25 @@ void BooleanBEAVYTensorRelu::evaluate_online() {
   const auto& sshares = input_->get_secret_share();
   const auto& my_msb_sshare = sshares[bit_size_ - 1];
 
-  ENCRYPTO::BitVector tmp;
-  tmp.Reserve(Helpers::Convert::BitsToBytes((bit_size_ - 1) * data_size_));
   const bool my_job = beavy_provider_.is_my_job(gate_id_);
-  for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
-    // Delta_y_share_ ^= Delta_a & [delta_b]_i
-    auto tmp2 = my_msb_pshare & sshares[bit_j];
-    // Delta_y_share_ ^= [delta_a]_i & Delta_b
-    tmp2 ^= my_msb_sshare & pshares[bit_j];
-    if (my_job) {
-      // Delta_y_share_ ^= Delta_a & Delta_b
-      tmp2 ^= my_msb_pshare & pshares[bit_j];
+  std::vector<ENCRYPTO::BitVector<>> rows(bit_size_ - 1);
+  kernels.for_each_range(bit_size_ - 1, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t bit_j = begin; bit_j < end; ++bit_j) {
+      // Delta_y_share_ ^= Delta_a & [delta_b]_i
+      auto& row = rows[bit_j];
+      row = my_msb_pshare & sshares[bit_j];
+      // Delta_y_share_ ^= [delta_a]_i & Delta_b
+      row ^= my_msb_sshare & pshares[bit_j];
+      if (my_job) {
+        // Delta_y_share_ ^= Delta_a & Delta_b
+        row ^= my_msb_pshare & pshares[bit_j];
+      }
     }
-    tmp.Append(tmp2);
+  });
+  ENCRYPTO::BitVector tmp;
+  tmp.Reserve(Helpers::Convert::BitsToBytes((bit_size_ - 1) * data_size_));
+  for (const auto& row : rows) {
+    tmp.Append(row);
   }
   Delta_y_share_ ^= tmp;
   const auto my_id = beavy_provider_.get_my_id();
@@ -1292,9 +1832,17 @@ void BooleanBEAVYTensorRelu::evaluate_online() {
   Delta_y_share_ ^= share_future_.get();
 
   auto& out_pshares = output_->get_public_share();
+  if (exec_ctx == nullptr) {
 #pragma omp parallel for
-  for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
-    out_pshares[bit_j] = Delta_y_share_.Subset(bit_j * data_size_, (bit_j + 1) * data_size_);
+    for (std::size_t bit_j = 0; bit_j < bit_size_ - 1; ++bit_j) {
+      out_pshares[bit_j] = Delta_y_share_.Subset(bit_j * data_size_, (bit_j + 1) * data_size_);
+    }
+  } else {
+    kernels.for_each_range(bit_size_ - 1, 1, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t bit_j = begin; bit_j < end; ++bit_j) {
+        out_pshares[bit_j] = Delta_y_share_.Subset(bit_j * data_size_, (bit_j + 1) * data_size_);
+      }
+    });
   }
   out_pshares[bit_size_ - 1].Resize(data_size_, true);  // fill with zeros
   output_->set_online_ready();
@@ -1318,10 +1866,13 @@ BooleanXArithmeticBEAVYTensorRelu<T>::BooleanXArithmeticBEAVYTensorRelu(
       input_bool_(std::move(input_bool)),
       input_arith_(std::move(input_arith)),
       output_(std::make_shared<ArithmeticBEAVYTensor<T>>(input_arith_->get_dimensions())) {
+  output_->set_fractional_bits(input_arith_->get_fractional_bits());
   if (input_bool_->get_dimensions() != input_arith_->get_dimensions()) {
     throw std::invalid_argument("dimension mismatch");
   }
-  if (input_bool_->get_bit_size() != input_arith_->get_bit_size()) {
+  // the Boolean input holds either all bits or only the most significant bits
+  if (input_bool_->get_bit_size() != input_arith_->get_bit_size() &&
+      input_bool_->get_bit_size() != 1) {
     throw std::invalid_argument("bit size mismatch");
   }
   const auto my_id = beavy_provider_.get_my_id();
@@ -1365,7 +1916,7 @@ void BooleanXArithmeticBEAVYTensorRelu<T>::evaluate_setup() {
   input_arith_->wait_setup();
   const auto& int_sshare = input_arith_->get_secret_share();
   assert(int_sshare.size() == data_size_);
-  const auto& msb_sshare = input_bool_->get_secret_share()[bit_size_ - 1];
+  const auto& msb_sshare = input_bool_->get_secret_share().back();
   assert(msb_sshare.GetSize() == data_size_);
 
   std::vector<T> msb_sshare_as_ints(data_size_);
@@ -1434,7 +1985,7 @@ void BooleanXArithmeticBEAVYTensorRelu<T>::evaluate_online() {
   const auto& int_sshare = input_arith_->get_secret_share();
   const auto& int_pshare = input_arith_->get_public_share();
   assert(int_pshare.size() == data_size_);
-  const auto& msb_pshare = input_bool_->get_public_share()[bit_size_ - 1];
+  const auto& msb_pshare = input_bool_->get_public_share().back();
   assert(msb_pshare.GetSize() == data_size_);
 
   const auto& sshare = output_->get_secret_share();
@@ -1484,32 +2035,43 @@ BooleanBEAVYTensorMaxPool::BooleanBEAVYTensorMaxPool(std::size_t gate_id,
       input_(input),
       output_(
           std::make_shared<BooleanBEAVYTensor>(maxpool_op_.get_output_tensor_dims(), bit_size_)),
-      // XXX: use depth-optimized circuit here
-      maxpool_algo_(beavy_provider_.get_circuit_loader().load_maxpool_circuit(
-          bit_size_, maxpool_op_.compute_kernel_size(), true)) {
+      // depth-optimized unless the cost model of the network prefers the size-optimized one
+      gtmux_algo_(beavy_provider_.get_circuit_loader().load_gtmux_circuit(
+          bit_size_, beavy_provider_.get_circuit_loader().select_depth_optimized(
+                         fmt::format("int_gt{}", bit_size_), maxpool_op_.compute_output_size(),
+                         true))),
+      schedule_(maxpool_op_.compute_kernel_size()) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if (!maxpool_op_.verify()) {
     throw std::invalid_argument("invalid MaxPoolOp");
   }
   const auto kernel_size = maxpool_op_.compute_kernel_size();
   const auto output_size = maxpool_op_.compute_output_size();
-  input_wires_.resize(bit_size_ * kernel_size);
-  std::generate(std::begin(input_wires_), std::end(input_wires_), [output_size] {
-    auto w = std::make_shared<BooleanBEAVYWire>(output_size);
-    w->get_secret_share().Resize(output_size);
-    w->get_public_share().Resize(output_size);
-    return w;
-  });
-  {
-    WireVector in(bit_size_ * kernel_size);
-    std::transform(std::begin(input_wires_), std::end(input_wires_), std::begin(in),
-                   [](auto w) { return std::dynamic_pointer_cast<BooleanBEAVYWire>(w); });
-    auto [gates, out] = construct_circuit(beavy_provider_, maxpool_algo_, in);
-    gates_ = std::move(gates);
+  if (kernel_size < 2) {
+    throw std::logic_error("need at least two inputs to combine");
+  }
+  kernel_shares_.resize(bit_size_ * kernel_size, ENCRYPTO::BitVector<>(output_size));
+  layers_.resize(schedule_.get_num_layers());
+  for (std::size_t layer_i = 0; layer_i < layers_.size(); ++layer_i) {
+    auto& layer = layers_.at(layer_i);
+    const auto num_simd = schedule_.get_layer_size(layer_i) * output_size;
+    layer.input_wires.resize(2 * bit_size_);
+    std::generate(std::begin(layer.input_wires), std::end(layer.input_wires), [this, num_simd] {
+      auto w = beavy_provider_.make_boolean_wire(num_simd);
+      w->get_secret_share().Resize(num_simd);
+      w->get_public_share().Resize(num_simd);
+      return w;
+    });
+    WireVector in_a(std::begin(layer.input_wires), std::begin(layer.input_wires) + bit_size_);
+    WireVector in_b(std::begin(layer.input_wires) + bit_size_, std::end(layer.input_wires));
+    auto [gates, out] = construct_circuit(beavy_provider_, gtmux_algo_, in_a, in_b);
+    layer.gates = std::move(gates);
     assert(out.size() == bit_size_);
-    output_wires_.resize(bit_size_);
-    std::transform(std::begin(out), std::end(out), std::begin(output_wires_),
+    layer.output_wires.resize(bit_size_);
+    std::transform(std::begin(out), std::end(out), std::begin(layer.output_wires),
                    [](auto w) { return std::dynamic_pointer_cast<BooleanBEAVYWire>(w); });
   }
+  assert(schedule_.get_layer_size(layers_.size() - 1) == 1);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1519,12 +2081,14 @@ BooleanBEAVYTensorMaxPool::BooleanBEAVYTensorMaxPool(std::size_t gate_id,
   }
 }
 
-template <bool setup>
-static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool_op,
-                          BooleanBEAVYWireVector& circuit_wires,
-                          const std::vector<ENCRYPTO::BitVector<>>& input_shares) {
-  const auto& input_shape = maxpool_op.input_shape_;
-  const auto& output_shape = maxpool_op.output_shape_;
+static void prepare_kernel_shares(std::size_t bit_size, const tensor::MaxPoolOp& maxpool_op,
+                                  std::vector<ENCRYPTO::BitVector<>>& kernel_shares,
+                                  const std::vector<ENCRYPTO::BitVector<>>& input_shares) {
+  // the samples of a batch are pooled like additional channels
+  auto input_shape = maxpool_op.input_shape_;
+  auto output_shape = maxpool_op.output_shape_;
+  input_shape[0] *= maxpool_op.batch_size_;
+  output_shape[0] *= maxpool_op.batch_size_;
   const auto& kernel_shape = maxpool_op.kernel_shape_;
   const auto& strides = maxpool_op.strides_;
 
@@ -1536,7 +2100,7 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
     return channel * (input_shape[1] * input_shape[2]) + row * input_shape[2] + column;
   };
 
-  // compute the index of the input wire of the circuit
+  // compute the index of the kernel share
   const auto mpin_wires_idx = [bit_size, &kernel_shape](auto bit_j, auto k_row, auto k_column) {
     assert(bit_j < bit_size);
     assert(k_row < kernel_shape[0]);
@@ -1544,7 +2108,7 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
     return (k_row * kernel_shape[1] + k_column) * bit_size + bit_j;
   };
 
-  // compute the index in the output shares and circuit input shares
+  // compute the index in the output shares and kernel shares
   const auto out_idx = [&output_shape](auto channel, auto row, auto column) {
     assert(channel < output_shape[0]);
     assert(row < output_shape[1]);
@@ -1563,13 +2127,8 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
           for (std::size_t k_row = 0; k_row < kernel_shape[0]; ++k_row) {
             for (std::size_t k_col = 0; k_col < kernel_shape[0]; ++k_col) {
               auto bit = in_share.Get(in_idx(channel_i, i_row + k_row, i_col + k_col));
-              if constexpr (setup) {
-                auto& bv = circuit_wires[mpin_wires_idx(bit_j, k_row, k_col)]->get_secret_share();
-                bv.Set(bit, out_idx(channel_i, o_row, o_col));
-              } else {
-                auto& bv = circuit_wires[mpin_wires_idx(bit_j, k_row, k_col)]->get_public_share();
-                bv.Set(bit, out_idx(channel_i, o_row, o_col));
-              }
+              kernel_shares[mpin_wires_idx(bit_j, k_row, k_col)].Set(
+                  bit, out_idx(channel_i, o_row, o_col));
             }
           }
 
@@ -1579,13 +2138,112 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
       }
     }
   }
-  for (auto& wire : circuit_wires) {
+}
+
+template <bool setup>
+void BooleanBEAVYTensorMaxPool::evaluate_layers(ExecutionContext* exec_ctx) {
+  const auto output_size = maxpool_op_.compute_output_size();
+  if constexpr (setup) {
+    input_->wait_setup();
+    prepare_kernel_shares(bit_size_, maxpool_op_, kernel_shares_, input_->get_secret_share());
+  } else {
+    input_->wait_online();
+    prepare_kernel_shares(bit_size_, maxpool_op_, kernel_shares_, input_->get_public_share());
+  }
+  if (exec_ctx != nullptr) {
+    // the gates wait until the inputs of their layer are assembled below
+    for (auto& layer : layers_) {
+      for (auto& gate : layer.gates) {
+        exec_ctx->fpool_->post([&] {
+          if constexpr (setup) {
+            gate->evaluate_setup();
+          } else {
+            gate->evaluate_online();
+          }
+        });
+      }
+    }
+  }
+
+  const auto get_share = [](auto& wire) -> ENCRYPTO::BitVector<>& {
+    if constexpr (setup) {
+      return wire->get_secret_share();
+    } else {
+      return wire->get_public_share();
+    }
+  };
+  // shares of bit_j of a value and the offset of the value's SIMD values in them
+  const auto get_value = [this, output_size, &get_share](std::size_t value, std::size_t bit_j)
+      -> std::pair<const ENCRYPTO::BitVector<>&, std::size_t> {
+    if (value < schedule_.num_inputs) {
+      return {kernel_shares_.at(value * bit_size_ + bit_j), 0};
+    }
+    const auto instance = value - schedule_.num_inputs;
+    const auto layer_i = static_cast<std::size_t>(
+        std::upper_bound(std::begin(schedule_.layer_offsets), std::end(schedule_.layer_offsets),
+                         instance) -
+        std::begin(schedule_.layer_offsets) - 1);
+    auto& wire = layers_.at(layer_i).output_wires.at(bit_j);
     if constexpr (setup) {
-      wire->set_setup_ready();
+      wire->wait_setup();
     } else {
-      wire->set_online_ready();
+      wire->wait_online();
+    }
+    return {get_share(wire), (instance - schedule_.layer_offsets.at(layer_i)) * output_size};
+  };
+
+  for (std::size_t layer_i = 0; layer_i < layers_.size(); ++layer_i) {
+    auto& layer = layers_.at(layer_i);
+    const auto first_instance = schedule_.layer_offsets.at(layer_i);
+    for (std::size_t instance_i = 0; instance_i < schedule_.get_layer_size(layer_i);
+         ++instance_i) {
+      const auto [value_a, value_b] = schedule_.instances.at(first_instance + instance_i);
+      const auto offset = instance_i * output_size;
+      for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+        const auto [share_a, offset_a] = get_value(value_a, bit_j);
+        get_share(layer.input_wires.at(bit_j))
+            .Copy(offset, offset + output_size, share_a.Subset(offset_a, offset_a + output_size));
+        const auto [share_b, offset_b] = get_value(value_b, bit_j);
+        get_share(layer.input_wires.at(bit_size_ + bit_j))
+            .Copy(offset, offset + output_size, share_b.Subset(offset_b, offset_b + output_size));
+      }
+    }
+    for (auto& wire : layer.input_wires) {
+      if constexpr (setup) {
+        wire->set_setup_ready();
+      } else {
+        wire->set_online_ready();
+      }
+    }
+    if (exec_ctx == nullptr) {
+      for (auto& gate : layer.gates) {
+        // should work since its a Boolean circuit consisting of AND, XOR, INV gates
+        if constexpr (setup) {
+          gate->evaluate_setup();
+        } else {
+          gate->evaluate_online();
+        }
+      }
     }
   }
+
+  // the last layer consists of a single instance which computes the output
+  auto& output_wires = layers_.back().output_wires;
+  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+    auto& wire = output_wires[bit_j];
+    if constexpr (setup) {
+      wire->wait_setup();
+      output_->get_secret_share()[bit_j] = std::move(wire->get_secret_share());
+    } else {
+      wire->wait_online();
+      output_->get_public_share()[bit_j] = std::move(wire->get_public_share());
+    }
+  }
+  if constexpr (setup) {
+    output_->set_setup_ready();
+  } else {
+    output_->set_online_ready();
+  }
 }
 
 void BooleanBEAVYTensorMaxPool::evaluate_setup() {
@@ -1597,22 +2255,7 @@ void BooleanBEAVYTensorMaxPool::evaluate_setup() {
     }
   }
 
-  input_->wait_setup();
-
-  prepare_wires<true>(bit_size_, maxpool_op_, input_wires_, input_->get_secret_share());
-
-  for (auto& gate : gates_) {
-    // should work since its a Boolean circuit consisting of AND, XOR, INV gates
-    gate->evaluate_setup();
-  }
-
-  auto& output_shares = output_->get_secret_share();
-  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
-    wire->wait_setup();
-    output_shares[bit_j] = std::move(wire->get_secret_share());
-  }
-  output_->set_setup_ready();
+  evaluate_layers<true>(nullptr);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1632,21 +2275,7 @@ void BooleanBEAVYTensorMaxPool::evaluate_setup_with_context(ExecutionContext& ex
     }
   }
 
-  input_->wait_setup();
-
-  prepare_wires<true>(bit_size_, maxpool_op_, input_wires_, input_->get_secret_share());
-
-  for (auto& gate : gates_) {
-    exec_ctx.fpool_->post([&] { gate->evaluate_setup(); });
-  }
-
-  auto& output_shares = output_->get_secret_share();
-  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
-    wire->wait_setup();
-    output_shares[bit_j] = std::move(wire->get_secret_share());
-  }
-  output_->set_setup_ready();
+  evaluate_layers<true>(&exec_ctx);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1666,22 +2295,7 @@ void BooleanBEAVYTensorMaxPool::evaluate_online() {
     }
   }
 
-  input_->wait_online();
-
-  prepare_wires<false>(bit_size_, maxpool_op_, input_wires_, input_->get_public_share());
-
-  for (auto& gate : gates_) {
-    // should work since its a Boolean circuit consisting of AND, XOR, INV gates
-    gate->evaluate_online();
-  }
-
-  auto& output_shares = output_->get_public_share();
-  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
-    wire->wait_online();
-    output_shares[bit_j] = std::move(wire->get_public_share());
-  }
-  output_->set_online_ready();
+  evaluate_layers<false>(nullptr);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -1701,21 +2315,7 @@ void BooleanBEAVYTensorMaxPool::evaluate_online_with_context(ExecutionContext& e
     }
   }
 
-  input_->wait_online();
-
-  prepare_wires<false>(bit_size_, maxpool_op_, input_wires_, input_->get_public_share());
-
-  for (auto& gate : gates_) {
-    exec_ctx.fpool_->post([&] { gate->evaluate_online(); });
-  }
-
-  auto& output_shares = output_->get_public_share();
-  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
-    wire->wait_online();
-    output_shares[bit_j] = std::move(wire->get_public_share());
-  }
-  output_->set_online_ready();
+  evaluate_layers<false>(&exec_ctx);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = beavy_provider_.get_logger();
@@ -22,9 +22,11 @@
 
 #pragma once
 
+#include "algorithm/circuit_loader.h"
 #include "gate/new_gate.h"
 #include "tensor.h"
 #include "tensor/tensor_op.h"
+#include "utility/linear_algebra.h"
 #include "utility/reusable_future.h"
 
 namespace ENCRYPTO {
@@ -59,8 +61,16 @@ template <typename T>
 class MatrixMultiplicationLHS;
 template <typename T>
 class MatrixMultiplicationRHS;
+template <typename T>
+class SparseMatrixMultiplicationDenseSide;
+template <typename T>
+class SparseMatrixMultiplicationSparseSide;
 }  // namespace MOTION
 
+namespace MOTION::proto {
+struct TensorKernels;
+}  // namespace MOTION::proto
+
 namespace MOTION::proto::beavy {
 
 class BooleanBEAVYWire;
@@ -78,8 +88,9 @@ class ArithmeticBEAVYTensorInputSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
-  std::shared_ptr<const ArithmeticBEAVYTensor<T>> get_output_tensor() const noexcept {
-    return output_;
+  const ArithmeticBEAVYTensorP<T>& get_output_tensor() const noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
   }
 
  private:
@@ -100,8 +111,9 @@ class ArithmeticBEAVYTensorInputReceiver : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
-  std::shared_ptr<const ArithmeticBEAVYTensor<T>> get_output_tensor() const noexcept {
-    return output_;
+  const ArithmeticBEAVYTensorP<T>& get_output_tensor() const noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
   }
 
  private:
@@ -123,6 +135,9 @@ class ArithmeticBEAVYTensorOutput : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> get_output_future();
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -143,6 +158,12 @@ class ArithmeticBEAVYTensorFlatten : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -150,21 +171,73 @@ class ArithmeticBEAVYTensorFlatten : public NewGate {
   std::shared_ptr<ArithmeticBEAVYTensor<T>> output_;
 };
 
+// Square z = y^2 of the output y of a linear tensor gate which is evaluated by that gate, see
+// BEAVYProvider::make_tensor_gemm_sqr_op.  The gate masks y with a delta_y of its own instead of
+// the one of its output, s.t. the product [delta_y]_0 * [delta_y]_1 is computed in the setup phase
+// together with the products of the linear layer, and y is neither materialized as a tensor nor
+// evaluated by another gate.  As for a separate square, Delta_y is reconstructed before Delta_z.
+template <typename T>
+class BEAVYTensorFusedSquare {
+ public:
+  BEAVYTensorFusedSquare(std::size_t gate_id, BEAVYProvider&, std::size_t size,
+                         std::size_t fractional_bits);
+  ~BEAVYTensorFusedSquare();
+  // sample [delta_y]_i, first step of the setup phase
+  const std::vector<T>& generate_mask();
+  const std::vector<T>& get_mask_share() const noexcept { return delta_y_share_; }
+  // compute [delta_y^2]_i, where [delta_z]_i is the secret share of the gate's output
+  void evaluate_setup(const TensorKernels&, const std::vector<T>& delta_z_share);
+  // compute and reconstruct Delta_z from the reconstructed Delta_y
+  std::vector<T> evaluate_online(const TensorKernels&, const std::vector<T>& Delta_y,
+                                 const std::vector<T>& delta_z_share);
+
+ private:
+  std::size_t gate_id_;
+  BEAVYProvider& beavy_provider_;
+  std::size_t size_;
+  std::size_t fractional_bits_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+  std::vector<T> delta_y_share_;
+  // [delta_y^2]_i, and [delta_z]_i if no truncation is requested
+  std::vector<T> Delta_z_share_;
+  // party 0 receives and party 1 sends [delta_y]_i for the single cross term
+  std::unique_ptr<MOTION::IntegerMultiplicationSender<T>> mult_sender_;
+  std::unique_ptr<MOTION::IntegerMultiplicationReceiver<T>> mult_receiver_;
+};
+
 template <typename T>
 class ArithmeticBEAVYTensorConv2D : public NewGate {
  public:
+  // with fuse_square, the output is the square of the convolution, see BEAVYTensorFusedSquare
   ArithmeticBEAVYTensorConv2D(std::size_t gate_id, BEAVYProvider&, tensor::Conv2DOp,
                               const ArithmeticBEAVYTensorCP<T> input,
                               const ArithmeticBEAVYTensorCP<T> kernel,
-                              const ArithmeticBEAVYTensorCP<T> bias, std::size_t fractional_bits);
+                              const ArithmeticBEAVYTensorCP<T> bias, std::size_t fractional_bits,
+                              bool fuse_square = false);
   ~ArithmeticBEAVYTensorConv2D();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
+  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+    MOTION::detail::append_wire(wires, kernel_);
+    MOTION::detail::append_wire(wires, bias_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
+  void evaluate_setup_impl(ExecutionContext*);
+  void evaluate_online_impl(ExecutionContext*);
+
   BEAVYProvider& beavy_provider_;
   tensor::Conv2DOp conv_op_;
   std::size_t fractional_bits_;
@@ -176,22 +249,40 @@ class ArithmeticBEAVYTensorConv2D : public NewGate {
   std::vector<T> Delta_y_share_;
   std::unique_ptr<MOTION::ConvolutionInputSide<T>> conv_input_side_;
   std::unique_ptr<MOTION::ConvolutionKernelSide<T>> conv_kernel_side_;
+  std::unique_ptr<BEAVYTensorFusedSquare<T>> fused_square_;
 };
 
 template <typename T>
 class ArithmeticBEAVYTensorGemm : public NewGate {
  public:
+  // with fuse_square, the output is the square of the product, see BEAVYTensorFusedSquare
   ArithmeticBEAVYTensorGemm(std::size_t gate_id, BEAVYProvider&, tensor::GemmOp,
                             const ArithmeticBEAVYTensorCP<T> input_A,
-                            const ArithmeticBEAVYTensorCP<T> input_B, std::size_t fractional_bits);
+                            const ArithmeticBEAVYTensorCP<T> input_B, std::size_t fractional_bits,
+                            bool fuse_square = false);
   ~ArithmeticBEAVYTensorGemm();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
+  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_A_);
+    MOTION::detail::append_wire(wires, input_B_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
+  void evaluate_setup_impl(ExecutionContext*);
+  void evaluate_online_impl(ExecutionContext*);
+
   BEAVYProvider& beavy_provider_;
   tensor::GemmOp gemm_op_;
   std::size_t fractional_bits_;
@@ -202,6 +293,46 @@ class ArithmeticBEAVYTensorGemm : public NewGate {
   std::vector<T> Delta_y_share_;
   std::unique_ptr<MOTION::MatrixMultiplicationRHS<T>> mm_rhs_side_;
   std::unique_ptr<MOTION::MatrixMultiplicationLHS<T>> mm_lhs_side_;
+  std::unique_ptr<BEAVYTensorFusedSquare<T>> fused_square_;
+};
+
+// product of a tensor with a sparse plaintext matrix of one party, see
+// TensorOpFactory::make_tensor_sparse_gemm_op
+template <typename T>
+class ArithmeticBEAVYTensorSparseGemm : public NewGate {
+ public:
+  ArithmeticBEAVYTensorSparseGemm(std::size_t gate_id, BEAVYProvider&, tensor::GemmOp,
+                                  const ArithmeticBEAVYTensorCP<T> input_A, CSRMatrix<T> weights,
+                                  std::size_t weights_owner, std::size_t weights_fractional_bits,
+                                  std::size_t fractional_bits);
+  ~ArithmeticBEAVYTensorSparseGemm();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
+  const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_A_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  tensor::GemmOp gemm_op_;
+  std::size_t fractional_bits_;
+  const ArithmeticBEAVYTensorCP<T> input_A_;
+  const CSRMatrix<T> weights_;
+  const bool is_weights_owner_;
+  std::shared_ptr<ArithmeticBEAVYTensor<T>> output_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+  std::vector<T> Delta_y_share_;
+  std::unique_ptr<MOTION::SparseMatrixMultiplicationSparseSide<T>> mm_sparse_side_;
+  std::unique_ptr<MOTION::SparseMatrixMultiplicationDenseSide<T>> mm_dense_side_;
 };
 
 template <typename T>
@@ -216,6 +347,13 @@ class ArithmeticBEAVYTensorMul : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_A_);
+    MOTION::detail::append_wire(wires, input_B_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -229,6 +367,9 @@ class ArithmeticBEAVYTensorMul : public NewGate {
   std::unique_ptr<MOTION::IntegerMultiplicationReceiver<T>> mult_receiver_;
 };
 
+// multiplies the sums of the windows by 1 / kernel_size encoded with `fractional_bits` bits and
+// truncates the result, which costs a message in both phases; fractional_bits == 0 only computes
+// the sums, which is local
 template <typename T>
 class ArithmeticBEAVYTensorAveragePool : public NewGate {
  public:
@@ -240,6 +381,12 @@ class ArithmeticBEAVYTensorAveragePool : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -254,6 +401,60 @@ class ArithmeticBEAVYTensorAveragePool : public NewGate {
   std::vector<T> tmp_out_;
 };
 
+// probabilistic truncation of fixed-point values by `truncate_bits` bits (Mohassel-Zhang): each
+// party truncates its share of the value locally, the result may be off by one in the last place
+template <typename T>
+class ArithmeticBEAVYTensorTruncation : public NewGate {
+ public:
+  ArithmeticBEAVYTensorTruncation(std::size_t gate_id, BEAVYProvider&,
+                                  const ArithmeticBEAVYTensorCP<T> input,
+                                  std::size_t truncate_bits);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  std::size_t data_size_;
+  std::size_t truncate_bits_;
+  const ArithmeticBEAVYTensorCP<T> input_;
+  std::shared_ptr<ArithmeticBEAVYTensor<T>> output_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+  std::vector<T> Delta_y_share_;
+};
+
+// reduce 64 bit values modulo 2^32 to evaluate the following operations on the smaller ring,
+// which is local since the shares are reduced as well
+class ArithmeticBEAVYTensorRingReduction : public NewGate {
+ public:
+  ArithmeticBEAVYTensorRingReduction(std::size_t gate_id, BEAVYProvider&,
+                                     const ArithmeticBEAVYTensorCP<std::uint64_t> input);
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  const ArithmeticBEAVYTensorP<std::uint32_t>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  BEAVYProvider& beavy_provider_;
+  const ArithmeticBEAVYTensorCP<std::uint64_t> input_;
+  std::shared_ptr<ArithmeticBEAVYTensor<std::uint32_t>> output_;
+};
+
 template <typename T>
 class BooleanToArithmeticBEAVYTensorConversion : public NewGate {
  public:
@@ -265,6 +466,12 @@ class BooleanToArithmeticBEAVYTensorConversion : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   ArithmeticBEAVYTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -286,10 +493,24 @@ class BooleanBEAVYTensorRelu : public NewGate {
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
+  void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   const BooleanBEAVYTensorP& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
+  void evaluate_setup_impl(ExecutionContext*);
+  void evaluate_online_impl(ExecutionContext*);
+
   BEAVYProvider& beavy_provider_;
   const std::size_t bit_size_;
   const std::size_t data_size_;
@@ -312,6 +533,13 @@ class BooleanXArithmeticBEAVYTensorRelu : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   const ArithmeticBEAVYTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_bool_);
+    MOTION::detail::append_wire(wires, input_arith_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
@@ -337,19 +565,40 @@ class BooleanBEAVYTensorMaxPool : public NewGate {
   void evaluate_setup_with_context(ExecutionContext&) override;
   void evaluate_online() override;
   void evaluate_online_with_context(ExecutionContext&) override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   const BooleanBEAVYTensorP& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   BEAVYProvider& beavy_provider_;
   const tensor::MaxPoolOp maxpool_op_;
   const std::size_t bit_size_;
   const std::size_t data_size_;
+  // the independent gtmux instances of a layer of the max tree evaluated as one instance with
+  // their SIMD values concatenated
+  struct Layer {
+    BooleanBEAVYWireVector input_wires;
+    BooleanBEAVYWireVector output_wires;
+    std::vector<std::unique_ptr<NewGate>> gates;
+  };
+
+  template <bool setup>
+  void evaluate_layers(ExecutionContext*);
+
   const BooleanBEAVYTensorCP input_;
   const BooleanBEAVYTensorP output_;
-  const ENCRYPTO::AlgorithmDescription& maxpool_algo_;
-  BooleanBEAVYWireVector input_wires_;
-  BooleanBEAVYWireVector output_wires_;
-  std::vector<std::unique_ptr<NewGate>> gates_;
+  const ENCRYPTO::AlgorithmDescription& gtmux_algo_;
+  const TreeSchedule schedule_;
+  // shares of the values in the kernel window for every output position
+  std::vector<ENCRYPTO::BitVector<>> kernel_shares_;
+  std::vector<Layer> layers_;
 };
 
 }  // namespace MOTION::proto::beavy
@@ -63,6 +63,19 @@ inline std::ostream& operator<<(std::ostream& os, const BooleanBEAVYWire& w) {
   return os << "<BooleanBEAVYWire @ " << &w << ">";
 }
 
+// Sliding windows of window_size characters over a text which is stored bit plane by bit
+// plane, i.e., wire b holds bit b of all characters.  Window s consists of the characters
+// s, ..., s + window_size - 1, so the windows are only offsets into the text shares, which are
+// shared once instead of once per window.
+struct BooleanBEAVYWindowView {
+  BooleanBEAVYWireVector text_;
+  std::size_t window_size_;
+
+  std::size_t get_bits_per_character() const noexcept { return text_.size(); }
+  std::size_t get_text_size() const { return text_.at(0)->get_num_simd(); }
+  std::size_t get_num_windows() const { return get_text_size() - window_size_ + 1; }
+};
+
 template <typename T>
 class ArithmeticBEAVYWire : public NewWire, public ENCRYPTO::enable_wait_setup {
  public:
@@ -81,12 +94,23 @@ class ArithmeticBEAVYWire : public NewWire, public ENCRYPTO::enable_wait_setup {
   std::vector<T>& get_secret_share() { return secret_share_; };
   const std::vector<T>& get_secret_share() const { return secret_share_; };
 
+  // In the additive state, the public share holds this party's additive share of the value
+  // instead of the masked value, i.e., it differs between the parties, while the secret share
+  // still holds a share of a random mask.  Gates which need the masked value get it from an
+  // ArithmeticBEAVYReconstructGate.  The state is fixed by the gate computing the wire when the
+  // circuit is built.
+  bool is_additively_shared() const noexcept { return additively_shared_; }
+  void set_additively_shared(bool additively_shared = true) noexcept {
+    additively_shared_ = additively_shared;
+  }
+
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
 
   // holds this party shares
   std::vector<T> public_share_;
   std::vector<T> secret_share_;
+  bool additively_shared_ = false;
 };
 
 template <typename T>
@@ -22,77 +22,114 @@
 
 #include "comm_mixin.h"
 
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <span>
 #include <unordered_map>
-
-#include <boost/functional/hash.hpp>
+#include <variant>
 
 #include "communication/communication_layer.h"
 #include "communication/fbs_headers/comm_mixin_gate_message_generated.h"
 #include "communication/message.h"
 #include "communication/message_handler.h"
 #include "utility/constants.h"
+#include "message_slot_table.h"
+#include "statistics/gate_profiler.h"
 #include "utility/logger.h"
 
-namespace {
-
-struct SizeTPairHash {
-  std::size_t operator()(const std::pair<std::size_t, std::size_t>& p) const {
-    std::size_t seed = 0;
-    boost::hash_combine(seed, p.first);
-    boost::hash_combine(seed, p.second);
-    return seed;
-  }
-};
-
-}  // namespace
-
 namespace MOTION::proto {
 
 struct CommMixin::GateMessageHandler : public Communication::MessageHandler {
   GateMessageHandler(std::size_t num_parties, Communication::MessageType gate_message_type,
                      std::shared_ptr<Logger> logger);
   void received_message(std::size_t, std::vector<std::uint8_t>&& raw_message) override;
+  // the payload is read directly from the receive buffer, which goes back to the pool afterwards
+  void received_pooled_message(std::size_t, ENCRYPTO::PooledBuffer&& raw_message) override;
+  void handle_message(std::size_t party_id, std::span<const std::uint8_t> raw_message);
 
   enum class MsgValueType { bit, block, uint8, uint16, uint32, uint64 };
 
   template <typename T>
   constexpr static CommMixin::GateMessageHandler::MsgValueType get_msg_value_type();
 
-  // KeyType = (gate_id, msg_num)
-  using KeyType = std::pair<std::size_t, std::size_t>;
-
-  // KeyType -> (size, type)
-  std::unordered_map<KeyType, std::pair<std::size_t, MsgValueType>, SizeTPairHash>
-      expected_messages_;
-
-  // [KeyType -> promise]
-  std::vector<std::unordered_map<KeyType, ENCRYPTO::ReusableFiberPromise<ENCRYPTO::BitVector<>>,
-                                 SizeTPairHash>>
-      bits_promises_;
-  std::vector<std::unordered_map<KeyType, ENCRYPTO::ReusableFiberPromise<ENCRYPTO::block128_vector>,
-                                 SizeTPairHash>>
-      blocks_promises_;
-  std::vector<std::unordered_map<KeyType, ENCRYPTO::ReusableFiberPromise<std::vector<std::uint8_t>>,
-                                 SizeTPairHash>>
-      uint8_promises_;
-  std::vector<std::unordered_map<
-      KeyType, ENCRYPTO::ReusableFiberPromise<std::vector<std::uint16_t>>, SizeTPairHash>>
-      uint16_promises_;
-  std::vector<std::unordered_map<
-      KeyType, ENCRYPTO::ReusableFiberPromise<std::vector<std::uint32_t>>, SizeTPairHash>>
-      uint32_promises_;
-  std::vector<std::unordered_map<
-      KeyType, ENCRYPTO::ReusableFiberPromise<std::vector<std::uint64_t>>, SizeTPairHash>>
-      uint64_promises_;
+  template <typename T>
+  using PromiseVector = std::vector<ENCRYPTO::ReusableFiberPromise<T>>;
+
+  enum class SlotState : std::uint8_t { empty, registering, registered };
+
+  // marks a slot whose message is expected from all other parties
+  static constexpr std::size_t all_parties = std::numeric_limits<std::size_t>::max();
+
+  // Expected message (gate_id, msg_num).  It is claimed by the registering thread and becomes
+  // visible to the receiving thread once its state is set to registered.
+  struct MessageSlot {
+    std::atomic<SlotState> state_{SlotState::empty};
+    MsgValueType type_;
+    std::size_t size_;
+    std::size_t party_id_;
+    // [party_id -> promise], the alternative corresponds to type_
+    std::variant<PromiseVector<ENCRYPTO::BitVector<>>, PromiseVector<ENCRYPTO::block128_vector>,
+                 PromiseVector<std::vector<std::uint8_t>>,
+                 PromiseVector<std::vector<std::uint16_t>>,
+                 PromiseVector<std::vector<std::uint32_t>>,
+                 PromiseVector<std::vector<std::uint64_t>>>
+        promises_;
+  };
 
+  // Register for the message (gate_id, msg_num) from party_id (or all_parties) and return the
+  // futures, throws if it has already been registered.
   template <typename T>
-  std::vector<
-      std::unordered_map<KeyType, ENCRYPTO::ReusableFiberPromise<std::vector<T>>, SizeTPairHash>>&
-  get_promise_map();
+  std::vector<ENCRYPTO::ReusableFiberFuture<T>> register_slot(std::size_t gate_id,
+                                                              std::size_t msg_num,
+                                                              std::size_t party_id,
+                                                              std::size_t size,
+                                                              MsgValueType type);
+  // return the registered slot (gate_id, msg_num) or nullptr
+  MessageSlot* find_slot(std::size_t gate_id, std::size_t msg_num) const noexcept;
+
+  std::size_t num_parties_;
+  MessageSlotTable<MessageSlot> slots_;
+
+  // msg_num used for fused messages, these are identified by the first gate_id in their layout
+  static constexpr std::size_t fused_msg_num = std::numeric_limits<std::size_t>::max();
+
+  struct FusedMessage {
+    // [(gate_id, number of bits or elements)]
+    std::vector<std::pair<std::size_t, std::size_t>> layout_;
+    MsgValueType type_;
+    // total number of bits or elements
+    std::size_t size_;
+    // parts of bits messages, which are concatenated bitwise
+    std::vector<ENCRYPTO::BitVector<>> parts_;
+    // payload of ints messages, where the parts are copied to their byte offsets
+    std::vector<std::uint8_t> payload_;
+    std::vector<std::size_t> offsets_;
+    std::size_t num_missing_parts_;
+  };
+
+  void received_fused_message(std::size_t party_id, std::size_t fused_id,
+                              const std::uint8_t* data, std::size_t size);
+  void split_fused_message(std::size_t party_id, const FusedMessage&, const std::uint8_t* data,
+                           std::size_t size);
+  // size of the payload of a fused message
+  static std::size_t get_byte_size(MsgValueType type, std::size_t size);
+
+  std::atomic<bool> have_fused_messages_ = false;
+  std::mutex fused_mutex_;
+  // fused_id -> fused message
+  std::unordered_map<std::size_t, FusedMessage> fused_messages_;
+  // gate_id -> (fused_id, index in layout)
+  std::unordered_map<std::size_t, std::pair<std::size_t, std::size_t>> fused_gates_;
+  // fused messages which arrived before their layout was known: fused_id -> [(party_id, payload)]
+  std::unordered_map<std::size_t, std::vector<std::pair<std::size_t, std::vector<std::uint8_t>>>>
+      early_fused_messages_;
 
   Communication::MessageType gate_message_type_;
   std::shared_ptr<Logger> logger_;
+  Statistics::GateProfiler* gate_profiler_ = nullptr;
 };
 
 template <typename T>
@@ -109,102 +146,140 @@ CommMixin::GateMessageHandler::get_msg_value_type() {
   }
 }
 
-template <>
-std::vector<
-    std::unordered_map<CommMixin::GateMessageHandler::KeyType,
-                       ENCRYPTO::ReusableFiberPromise<std::vector<std::uint8_t>>, SizeTPairHash>>&
-CommMixin::GateMessageHandler::get_promise_map() {
-  return uint8_promises_;
-}
-template <>
-std::vector<
-    std::unordered_map<CommMixin::GateMessageHandler::KeyType,
-                       ENCRYPTO::ReusableFiberPromise<std::vector<std::uint16_t>>, SizeTPairHash>>&
-CommMixin::GateMessageHandler::get_promise_map() {
-  return uint16_promises_;
-}
-template <>
-std::vector<
-    std::unordered_map<CommMixin::GateMessageHandler::KeyType,
-                       ENCRYPTO::ReusableFiberPromise<std::vector<std::uint32_t>>, SizeTPairHash>>&
-CommMixin::GateMessageHandler::get_promise_map() {
-  return uint32_promises_;
+template <typename T>
+std::vector<ENCRYPTO::ReusableFiberFuture<T>> CommMixin::GateMessageHandler::register_slot(
+    std::size_t gate_id, std::size_t msg_num, std::size_t party_id, std::size_t size,
+    MsgValueType type) {
+  auto& slot = slots_.get(gate_id, msg_num);
+  auto expected = SlotState::empty;
+  if (!slot.state_.compare_exchange_strong(expected, SlotState::registering,
+                                           std::memory_order_acquire)) {
+    throw std::logic_error(
+        fmt::format("tried to register twice for message {} for gate {}", msg_num, gate_id));
+  }
+  slot.type_ = type;
+  slot.size_ = size;
+  slot.party_id_ = party_id;
+  PromiseVector<T> promises(party_id == all_parties ? num_parties_ : 1);
+  std::vector<ENCRYPTO::ReusableFiberFuture<T>> futures;
+  futures.reserve(promises.size());
+  std::transform(std::begin(promises), std::end(promises), std::back_inserter(futures),
+                 [](auto& p) { return p.get_future(); });
+  slot.promises_ = std::move(promises);
+  slot.state_.store(SlotState::registered, std::memory_order_release);
+  return futures;
 }
-template <>
-std::vector<
-    std::unordered_map<CommMixin::GateMessageHandler::KeyType,
-                       ENCRYPTO::ReusableFiberPromise<std::vector<std::uint64_t>>, SizeTPairHash>>&
-CommMixin::GateMessageHandler::get_promise_map() {
-  return uint64_promises_;
+
+CommMixin::GateMessageHandler::MessageSlot* CommMixin::GateMessageHandler::find_slot(
+    std::size_t gate_id, std::size_t msg_num) const noexcept {
+  auto slot = slots_.find(gate_id, msg_num);
+  if (slot == nullptr || slot->state_.load(std::memory_order_acquire) != SlotState::registered) {
+    return nullptr;
+  }
+  return slot;
 }
 
 CommMixin::GateMessageHandler::GateMessageHandler(std::size_t num_parties,
                                                   Communication::MessageType gate_message_type,
                                                   std::shared_ptr<Logger> logger)
-    : bits_promises_(num_parties),
-      blocks_promises_(num_parties),
-      uint8_promises_(num_parties),
-      uint16_promises_(num_parties),
-      uint32_promises_(num_parties),
-      uint64_promises_(num_parties),
-      gate_message_type_(gate_message_type),
+    : num_parties_(num_parties), gate_message_type_(gate_message_type),
       logger_(logger) {}
 
 void CommMixin::GateMessageHandler::received_message(std::size_t party_id,
                                                      std::vector<std::uint8_t>&& raw_message) {
+  handle_message(party_id, raw_message);
+}
+
+void CommMixin::GateMessageHandler::received_pooled_message(std::size_t party_id,
+                                                            ENCRYPTO::PooledBuffer&& raw_message) {
+  handle_message(party_id, raw_message.span());
+}
+
+void CommMixin::GateMessageHandler::handle_message(std::size_t party_id,
+                                                   std::span<const std::uint8_t> raw_message) {
   assert(!raw_message.empty());
-  auto message = Communication::GetMessage(raw_message.data());
-  {
-    flatbuffers::Verifier verifier(raw_message.data(), raw_message.size());
-    if (!message->Verify(verifier)) {
-      throw std::runtime_error("received malformed Message");
-      // TODO: log and drop instead
+  Communication::MessageType message_type;
+  std::uint64_t gate_id;
+  std::uint64_t msg_num;
+  std::span<const std::uint8_t> payload;
+  if (Communication::IsCompactGateMessage(raw_message)) {
+    // the framing has already been checked by the communication layer
+    auto compact_message = Communication::ParseCompactGateMessage(raw_message);
+    if (!compact_message.has_value()) {
+      throw std::runtime_error(
+          fmt::format("received malformed {}", EnumNameMessageType(gate_message_type_)));
+    }
+    message_type = compact_message->message_type;
+    gate_id = compact_message->gate_id;
+    msg_num = compact_message->msg_num;
+    payload = compact_message->payload;
+  } else {
+    // gate messages nested in a Message, as sent by older versions
+    auto message = Communication::GetMessage(raw_message.data());
+    {
+      flatbuffers::Verifier verifier(raw_message.data(), raw_message.size());
+      if (!message->Verify(verifier) || message->payload() == nullptr) {
+        throw std::runtime_error("received malformed Message");
+        // TODO: log and drop instead
+      }
+    }
+    message_type = message->message_type();
+    auto gate_message = flatbuffers::GetRoot<MOTION::Communication::CommMixinGateMessage>(
+        message->payload()->data());
+    {
+      flatbuffers::Verifier verifier(message->payload()->data(), message->payload()->size());
+      if (!gate_message->Verify(verifier) || gate_message->payload() == nullptr) {
+        throw std::runtime_error(
+            fmt::format("received malformed {}", EnumNameMessageType(gate_message_type_)));
+        // TODO: log and drop instead
+      }
     }
+    gate_id = gate_message->gate_id();
+    msg_num = gate_message->msg_num();
+    payload = std::span(gate_message->payload()->data(), gate_message->payload()->size());
   }
 
-  auto message_type = message->message_type();
   if (message_type != gate_message_type_) {
     throw std::logic_error(
         fmt::format("CommMixin::GateMessageHandler: received unexpected message of type {}",
                     EnumNameMessageType(message_type)));
   }
 
-  auto gate_message =
-      flatbuffers::GetRoot<MOTION::Communication::CommMixinGateMessage>(message->payload()->data());
-  {
-    flatbuffers::Verifier verifier(message->payload()->data(), message->payload()->size());
-    if (!gate_message->Verify(verifier)) {
-      throw std::runtime_error(
-          fmt::format("received malformed {}", EnumNameMessageType(gate_message_type_)));
-      // TODO: log and drop instead
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (gate_profiler_ != nullptr) {
+      gate_profiler_->record_received(gate_id, raw_message.size());
     }
   }
-  auto gate_id = gate_message->gate_id();
-  auto msg_num = gate_message->msg_num();
-  auto payload = gate_message->payload();
-  auto it = expected_messages_.find({gate_id, msg_num});
-  if (it == expected_messages_.end()) {
+  if (msg_num == fused_msg_num) {
+    received_fused_message(party_id, gate_id, payload.data(), payload.size());
+    return;
+  }
+  auto slot = find_slot(gate_id, msg_num);
+  if (slot == nullptr || (slot->party_id_ != all_parties && slot->party_id_ != party_id)) {
     logger_->LogError(fmt::format("received unexpected {} for gate {}, dropping",
                                   EnumNameMessageType(gate_message_type_), gate_id));
     return;
   }
-  auto expected_size = it->second.first;
-  auto type = it->second.second;
-
-  auto set_value_helper = [this, party_id, gate_id, msg_num, expected_size, payload](
-                              auto& map_vec, auto type_tag) {
-    auto byte_size = expected_size * sizeof(type_tag);
-    if (byte_size != payload->size()) {
+  auto expected_size = slot->size_;
+  auto& promise_variant = slot->promises_;
+  auto promise_index = slot->party_id_ == all_parties ? party_id : 0;
+
+  auto set_value_helper = [this, gate_id, msg_num, expected_size, payload, &promise_variant,
+                           promise_index](auto type_tag) {
+    using T = decltype(type_tag);
+    auto byte_size = expected_size * sizeof(T);
+    if (byte_size != payload.size()) {
       logger_->LogError(fmt::format(
           "received {} for gate {} (msg_num {}) of size {} while expecting size {}, dropping",
-          EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload->size(), byte_size));
+          EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload.size(), byte_size));
       return;
     }
-    auto& promise_map = map_vec[party_id];
-    auto& promise = promise_map.at({gate_id, msg_num});
-    auto ptr = reinterpret_cast<const decltype(type_tag)*>(payload->data());
+    auto& promise = std::get<PromiseVector<std::vector<T>>>(promise_variant).at(promise_index);
+    // the payload of a compact gate message is not aligned
+    std::vector<T> values(expected_size);
+    std::memcpy(values.data(), payload.data(), byte_size);
     try {
-      promise.set_value(std::vector(ptr, ptr + expected_size));
+      promise.set_value(std::move(values));
     } catch (std::future_error& e) {
       logger_->LogError(fmt::format(
           "unable to fulfill promise ({}) for {} (ints) for gate {} (msg_num {}), dropping",
@@ -212,18 +287,19 @@ void CommMixin::GateMessageHandler::received_message(std::size_t party_id,
     }
   };
 
-  switch (type) {
+  switch (slot->type_) {
     case MsgValueType::bit: {
       auto byte_size = Helpers::Convert::BitsToBytes(expected_size);
-      if (byte_size != payload->size()) {
+      if (byte_size != payload.size()) {
         logger_->LogError(fmt::format(
             "received {} for gate {} (msg_num {}) of size {} while expecting size {}, dropping",
-            EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload->size(), byte_size));
+            EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload.size(), byte_size));
         return;
       }
-      auto& promise = bits_promises_[party_id].at({gate_id, msg_num});
+      auto& promise =
+          std::get<PromiseVector<ENCRYPTO::BitVector<>>>(promise_variant).at(promise_index);
       try {
-        promise.set_value(ENCRYPTO::BitVector(payload->data(), expected_size));
+        promise.set_value(ENCRYPTO::BitVector(payload.data(), expected_size));
       } catch (std::future_error& e) {
         logger_->LogError(fmt::format(
             "unable to fulfill promise ({}) for {} (bits) for gate {} (msg_num {}), dropping",
@@ -233,15 +309,16 @@ void CommMixin::GateMessageHandler::received_message(std::size_t party_id,
     }
     case MsgValueType::block: {
       auto byte_size = 16 * expected_size;
-      if (byte_size != payload->size()) {
+      if (byte_size != payload.size()) {
         logger_->LogError(fmt::format(
             "received {} for gate {} (msg_num {}) of size {} while expecting size {}, dropping",
-            EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload->size(), byte_size));
+            EnumNameMessageType(gate_message_type_), gate_id, msg_num, payload.size(), byte_size));
         return;
       }
-      auto& promise = blocks_promises_[party_id].at({gate_id, msg_num});
+      auto& promise =
+          std::get<PromiseVector<ENCRYPTO::block128_vector>>(promise_variant).at(promise_index);
       try {
-        promise.set_value(ENCRYPTO::block128_vector(expected_size, payload->data()));
+        promise.set_value(ENCRYPTO::block128_vector(expected_size, payload.data()));
       } catch (std::future_error& e) {
         logger_->LogError(fmt::format(
             "unable to fulfill promise ({}) for {} (blocks) for gate {} (msg_num {}), dropping",
@@ -250,24 +327,128 @@ void CommMixin::GateMessageHandler::received_message(std::size_t party_id,
       break;
     }
     case MsgValueType::uint8: {
-      set_value_helper(uint8_promises_, std::uint8_t{});
+      set_value_helper(std::uint8_t{});
       break;
     }
     case MsgValueType::uint16: {
-      set_value_helper(uint16_promises_, std::uint16_t{});
+      set_value_helper(std::uint16_t{});
       break;
     }
     case MsgValueType::uint32: {
-      set_value_helper(uint32_promises_, std::uint32_t{});
+      set_value_helper(std::uint32_t{});
       break;
     }
     case MsgValueType::uint64: {
-      set_value_helper(uint64_promises_, std::uint64_t{});
+      set_value_helper(std::uint64_t{});
       break;
     }
   }
 }
 
+std::size_t CommMixin::GateMessageHandler::get_byte_size(MsgValueType type, std::size_t size) {
+  switch (type) {
+    case MsgValueType::bit:
+      return Helpers::Convert::BitsToBytes(size);
+    case MsgValueType::block:
+      return 16 * size;
+    case MsgValueType::uint8:
+      return size;
+    case MsgValueType::uint16:
+      return 2 * size;
+    case MsgValueType::uint32:
+      return 4 * size;
+    case MsgValueType::uint64:
+      return 8 * size;
+  }
+  return 0;
+}
+
+void CommMixin::GateMessageHandler::received_fused_message(std::size_t party_id,
+                                                           std::size_t fused_id,
+                                                           const std::uint8_t* data,
+                                                           std::size_t size) {
+  std::scoped_lock lock(fused_mutex_);
+  auto it = fused_messages_.find(fused_id);
+  if (it == fused_messages_.end()) {
+    // the other party may have started the online phase before we registered the layout
+    early_fused_messages_[fused_id].emplace_back(party_id, std::vector(data, data + size));
+    return;
+  }
+  split_fused_message(party_id, it->second, data, size);
+}
+
+void CommMixin::GateMessageHandler::split_fused_message(std::size_t party_id,
+                                                        const FusedMessage& fused,
+                                                        const std::uint8_t* data,
+                                                        std::size_t size) {
+  auto fused_id = fused.layout_.front().first;
+  auto byte_size = get_byte_size(fused.type_, fused.size_);
+  if (byte_size != size) {
+    logger_->LogError(
+        fmt::format("received fused {} for gate {} of size {} while expecting size {}, dropping",
+                    EnumNameMessageType(gate_message_type_), fused_id, size, byte_size));
+    return;
+  }
+
+  auto set_ints_helper = [this, party_id, data, &fused](auto type_tag) {
+    using T = decltype(type_tag);
+    std::size_t offset = 0;
+    for (auto [gate_id, num_elements] : fused.layout_) {
+      auto slot = find_slot(gate_id, 0);
+      auto promise_index = slot->party_id_ == all_parties ? party_id : 0;
+      auto& promise = std::get<PromiseVector<std::vector<T>>>(slot->promises_).at(promise_index);
+      std::vector<T> values(num_elements);
+      std::memcpy(values.data(), data + offset, num_elements * sizeof(T));
+      try {
+        promise.set_value(std::move(values));
+      } catch (std::future_error& e) {
+        logger_->LogError(fmt::format(
+            "unable to fulfill promise ({}) for {} (fused ints) for gate {}, dropping", e.what(),
+            EnumNameMessageType(gate_message_type_), gate_id));
+      }
+      offset += num_elements * sizeof(T);
+    }
+  };
+
+  // the layout has been checked against the registered slots in fuse_messages
+  switch (fused.type_) {
+    case MsgValueType::bit: {
+      ENCRYPTO::BitVector<> message(data, fused.size_);
+      std::size_t offset = 0;
+      for (auto [gate_id, num_bits] : fused.layout_) {
+        auto slot = find_slot(gate_id, 0);
+        auto promise_index = slot->party_id_ == all_parties ? party_id : 0;
+        auto& promise =
+            std::get<PromiseVector<ENCRYPTO::BitVector<>>>(slot->promises_).at(promise_index);
+        try {
+          promise.set_value(message.Subset(offset, offset + num_bits));
+        } catch (std::future_error& e) {
+          logger_->LogError(fmt::format(
+              "unable to fulfill promise ({}) for {} (fused bits) for gate {}, dropping", e.what(),
+              EnumNameMessageType(gate_message_type_), gate_id));
+        }
+        offset += num_bits;
+      }
+      break;
+    }
+    case MsgValueType::block:
+      // not fused
+      break;
+    case MsgValueType::uint8:
+      set_ints_helper(std::uint8_t{});
+      break;
+    case MsgValueType::uint16:
+      set_ints_helper(std::uint16_t{});
+      break;
+    case MsgValueType::uint32:
+      set_ints_helper(std::uint32_t{});
+      break;
+    case MsgValueType::uint64:
+      set_ints_helper(std::uint64_t{});
+      break;
+  }
+}
+
 CommMixin::CommMixin(Communication::CommunicationLayer& communication_layer,
                      Communication::MessageType gate_message_type, std::shared_ptr<Logger> logger)
     : communication_layer_(communication_layer),
@@ -284,34 +465,57 @@ CommMixin::CommMixin(Communication::CommunicationLayer& communication_layer,
 
 CommMixin::~CommMixin() { communication_layer_.deregister_message_handler({gate_message_type_}); }
 
-flatbuffers::FlatBufferBuilder CommMixin::build_gate_message(std::size_t gate_id,
-                                                             std::size_t msg_num,
-                                                             const std::uint8_t* message,
-                                                             std::size_t size) const {
-  flatbuffers::FlatBufferBuilder builder;
-  auto vector = builder.CreateVector(message, size);
-  auto root = Communication::CreateCommMixinGateMessage(builder, gate_id, msg_num, vector);
-  builder.Finish(root);
-  return Communication::BuildMessage(gate_message_type_, builder.GetBufferPointer(),
-                                     builder.GetSize());
+void CommMixin::reserve_message_slots(std::size_t first_gate_id, std::size_t num_gate_ids) {
+  message_handler_->slots_.reserve(first_gate_id, num_gate_ids);
+}
+
+void CommMixin::set_gate_profiler(Statistics::GateProfiler* profiler) noexcept {
+  gate_profiler_ = profiler;
+  message_handler_->gate_profiler_ = profiler;
+}
+
+void CommMixin::broadcast_gate_message(std::size_t gate_id,
+                                       std::vector<std::uint8_t>&& message) const {
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (gate_profiler_ != nullptr) {
+      gate_profiler_->record_sent(gate_id, message.size(), num_parties_ - 1);
+    }
+  }
+  communication_layer_.broadcast_message(std::move(message));
+}
+
+void CommMixin::send_gate_message(std::size_t party_id, std::size_t gate_id,
+                                  std::vector<std::uint8_t>&& message) const {
+  if constexpr (MOTION_GATE_PROFILING) {
+    if (gate_profiler_ != nullptr) {
+      gate_profiler_->record_sent(gate_id, message.size());
+    }
+  }
+  communication_layer_.send_message(party_id, std::move(message));
+}
+
+std::vector<std::uint8_t> CommMixin::build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                                        const std::uint8_t* message,
+                                                        std::size_t size) const {
+  return Communication::BuildCompactGateMessage(gate_message_type_, gate_id, msg_num,
+                                                std::span(message, size));
 }
 
 template <typename T>
-flatbuffers::FlatBufferBuilder CommMixin::build_gate_message(std::size_t gate_id,
-                                                             std::size_t msg_num,
-                                                             const std::vector<T>& vector) const {
+std::vector<std::uint8_t> CommMixin::build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                                        const std::vector<T>& vector) const {
   return build_gate_message(gate_id, msg_num, reinterpret_cast<const std::uint8_t*>(vector.data()),
                             sizeof(T) * vector.size());
 }
 
-flatbuffers::FlatBufferBuilder CommMixin::build_gate_message(
+std::vector<std::uint8_t> CommMixin::build_gate_message(
     std::size_t gate_id, std::size_t msg_num, const ENCRYPTO::BitVector<>& message) const {
   auto vector = message.GetData();
   return build_gate_message(gate_id, msg_num, reinterpret_cast<const std::uint8_t*>(vector.data()),
                             vector.size());
 }
 
-flatbuffers::FlatBufferBuilder CommMixin::build_gate_message(
+std::vector<std::uint8_t> CommMixin::build_gate_message(
     std::size_t gate_id, std::size_t msg_num, const ENCRYPTO::block128_vector& message) const {
   auto data = message.data();
   return build_gate_message(gate_id, msg_num, reinterpret_cast<const std::uint8_t*>(data),
@@ -320,37 +524,48 @@ flatbuffers::FlatBufferBuilder CommMixin::build_gate_message(
 
 void CommMixin::broadcast_bits_message(std::size_t gate_id, const ENCRYPTO::BitVector<>& message,
                                        std::size_t msg_num) const {
-  communication_layer_.broadcast_message(build_gate_message(gate_id, msg_num, message));
+  auto& mh = *message_handler_;
+  if (msg_num == 0 && mh.have_fused_messages_) {
+    std::unique_lock lock(mh.fused_mutex_);
+    if (auto it = mh.fused_gates_.find(gate_id); it != mh.fused_gates_.end()) {
+      auto [fused_id, index] = it->second;
+      auto& fused = mh.fused_messages_.at(fused_id);
+      if (message.GetSize() != fused.layout_[index].second) {
+        throw std::logic_error(
+            fmt::format("Gate {}: fused bits message has size {} while expecting size {}", gate_id,
+                        message.GetSize(), fused.layout_[index].second));
+      }
+      fused.parts_[index] = message;
+      if (--fused.num_missing_parts_ > 0) {
+        return;
+      }
+      ENCRYPTO::BitVector<> fused_message;
+      fused_message.Reserve(Helpers::Convert::BitsToBytes(fused.size_));
+      for (auto& part : fused.parts_) {
+        fused_message.Append(part);
+        part = ENCRYPTO::BitVector<>();
+      }
+      fused.num_missing_parts_ = fused.parts_.size();
+      lock.unlock();
+      broadcast_gate_message(
+          fused_id, build_gate_message(fused_id, GateMessageHandler::fused_msg_num, fused_message));
+      return;
+    }
+  }
+  broadcast_gate_message(gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 void CommMixin::send_bits_message(std::size_t party_id, std::size_t gate_id,
                                   const ENCRYPTO::BitVector<>& message, std::size_t msg_num) const {
-  communication_layer_.send_message(party_id, build_gate_message(gate_id, msg_num, message));
+  send_gate_message(party_id, gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 [[nodiscard]] std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>>
 CommMixin::register_for_bits_messages(std::size_t gate_id, std::size_t num_bits,
                                       std::size_t msg_num) {
-  auto& mh = *message_handler_;
-  std::vector<ENCRYPTO::ReusableFiberPromise<ENCRYPTO::BitVector<>>> promises(num_parties_);
-  std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>> futures;
-  std::transform(std::begin(promises), std::end(promises), std::back_inserter(futures),
-                 [](auto& p) { return p.get_future(); });
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num),
-       std::make_pair(num_bits, GateMessageHandler::MsgValueType::bit)});
-  if (!success) {
-    throw std::logic_error(fmt::format("tried to register twice for message for gate {}", gate_id));
-  }
-  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
-    if (party_id == my_id_) {
-      continue;
-    }
-    auto& promise_map = mh.bits_promises_.at(party_id);
-    auto [_, success] =
-        promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promises.at(party_id))});
-    assert(success);
-  }
+  auto futures = message_handler_->register_slot<ENCRYPTO::BitVector<>>(
+      gate_id, msg_num, GateMessageHandler::all_parties, num_bits,
+      GateMessageHandler::MsgValueType::bit);
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(
@@ -364,64 +579,95 @@ CommMixin::register_for_bits_messages(std::size_t gate_id, std::size_t num_bits,
 CommMixin::register_for_bits_message(std::size_t party_id, std::size_t gate_id,
                                      std::size_t num_bits, std::size_t msg_num) {
   assert(party_id != my_id_);
+  auto futures = message_handler_->register_slot<ENCRYPTO::BitVector<>>(
+      gate_id, msg_num, party_id, num_bits, GateMessageHandler::MsgValueType::bit);
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    if (logger_) {
+      logger_->LogTrace(
+          fmt::format("Gate {}: registered for bits message of size {}", gate_id, num_bits));
+    }
+  }
+  return std::move(futures.front());
+}
+
+void CommMixin::fuse_messages(const std::vector<std::pair<std::size_t, std::size_t>>& layout) {
+  if (layout.empty()) {
+    return;
+  }
   auto& mh = *message_handler_;
-  ENCRYPTO::ReusableFiberPromise<ENCRYPTO::BitVector<>> promise;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> future = promise.get_future();
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num),
-       std::make_pair(num_bits, GateMessageHandler::MsgValueType::bit)});
-  if (!success) {
-    throw std::logic_error(fmt::format("tried to register twice for message for gate {}", gate_id));
+  auto fused_id = layout.front().first;
+  auto first_slot = mh.find_slot(fused_id, 0);
+  if (first_slot == nullptr || first_slot->type_ == GateMessageHandler::MsgValueType::block) {
+    throw std::logic_error(fmt::format(
+        "tried to fuse message for gate {} which is not registered as bits or ints message",
+        fused_id));
+  }
+  GateMessageHandler::FusedMessage fused{layout, first_slot->type_, 0, {}, {}, {}, layout.size()};
+  for (auto [gate_id, size] : layout) {
+    auto slot = mh.find_slot(gate_id, 0);
+    if (slot == nullptr || slot->type_ != fused.type_ || slot->size_ != size) {
+      throw std::logic_error(fmt::format(
+          "tried to fuse message for gate {} which is not registered as message of size {} and "
+          "the type of the other fused messages",
+          gate_id, size));
+    }
+    fused.size_ += size;
   }
-  {
-    auto& promise_map = mh.bits_promises_.at(party_id);
-    auto [_, success] = promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promise)});
-    assert(success);
+  if (fused.type_ == GateMessageHandler::MsgValueType::bit) {
+    fused.parts_.resize(layout.size());
+  } else {
+    fused.payload_.resize(GateMessageHandler::get_byte_size(fused.type_, fused.size_));
+    fused.offsets_.reserve(layout.size());
+    std::size_t offset = 0;
+    for (auto [_, size] : layout) {
+      fused.offsets_.push_back(offset);
+      offset += GateMessageHandler::get_byte_size(fused.type_, size);
+    }
+  }
+
+  std::scoped_lock lock(mh.fused_mutex_);
+  for (std::size_t i = 0; i < layout.size(); ++i) {
+    auto [_, success] = mh.fused_gates_.insert({layout[i].first, {fused_id, i}});
+    if (!success) {
+      throw std::logic_error(
+          fmt::format("tried to fuse message for gate {} twice", layout[i].first));
+    }
+  }
+  auto [it, _] = mh.fused_messages_.insert({fused_id, std::move(fused)});
+  mh.have_fused_messages_ = true;
+  if (auto early_it = mh.early_fused_messages_.find(fused_id);
+      early_it != mh.early_fused_messages_.end()) {
+    for (const auto& [party_id, payload] : early_it->second) {
+      mh.split_fused_message(party_id, it->second, payload.data(), payload.size());
+    }
+    mh.early_fused_messages_.erase(early_it);
   }
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(
-          fmt::format("Gate {}: registered for bits message of size {}", gate_id, num_bits));
+          fmt::format("Gate {}: fused messages of {} gates", fused_id, layout.size()));
     }
   }
-  return future;
 }
 
 void CommMixin::broadcast_blocks_message(std::size_t gate_id,
                                          const ENCRYPTO::block128_vector& message,
                                          std::size_t msg_num) const {
-  communication_layer_.broadcast_message(build_gate_message(gate_id, msg_num, message));
+  broadcast_gate_message(gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 void CommMixin::send_blocks_message(std::size_t party_id, std::size_t gate_id,
                                     const ENCRYPTO::block128_vector& message,
                                     std::size_t msg_num) const {
-  communication_layer_.send_message(party_id, build_gate_message(gate_id, msg_num, message));
+  send_gate_message(party_id, gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 [[nodiscard]] std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector>>
 CommMixin::register_for_blocks_messages(std::size_t gate_id, std::size_t num_blocks,
                                         std::size_t msg_num) {
-  auto& mh = *message_handler_;
-  std::vector<ENCRYPTO::ReusableFiberPromise<ENCRYPTO::block128_vector>> promises(num_parties_);
-  std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector>> futures;
-  std::transform(std::begin(promises), std::end(promises), std::back_inserter(futures),
-                 [](auto& p) { return p.get_future(); });
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num),
-       std::make_pair(num_blocks, GateMessageHandler::MsgValueType::block)});
-  if (!success) {
-    throw std::logic_error(fmt::format("tried to register twice for message for gate {}", gate_id));
-  }
-  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
-    if (party_id == my_id_) {
-      continue;
-    }
-    auto& promise_map = mh.blocks_promises_.at(party_id);
-    auto [_, success] =
-        promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promises.at(party_id))});
-    assert(success);
-  }
+  auto futures = message_handler_->register_slot<ENCRYPTO::block128_vector>(
+      gate_id, msg_num, GateMessageHandler::all_parties, num_blocks,
+      GateMessageHandler::MsgValueType::block);
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(
@@ -435,33 +681,47 @@ CommMixin::register_for_blocks_messages(std::size_t gate_id, std::size_t num_blo
 CommMixin::register_for_blocks_message(std::size_t party_id, std::size_t gate_id,
                                        std::size_t num_blocks, std::size_t msg_num) {
   assert(party_id != my_id_);
-  auto& mh = *message_handler_;
-  ENCRYPTO::ReusableFiberPromise<ENCRYPTO::block128_vector> promise;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> future = promise.get_future();
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num),
-       std::make_pair(num_blocks, GateMessageHandler::MsgValueType::block)});
-  if (!success) {
-    throw std::logic_error(fmt::format("tried to register twice for message for gate {}", gate_id));
-  }
-  {
-    auto& promise_map = mh.blocks_promises_.at(party_id);
-    auto [_, success] = promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promise)});
-    assert(success);
-  }
+  auto futures = message_handler_->register_slot<ENCRYPTO::block128_vector>(
+      gate_id, msg_num, party_id, num_blocks, GateMessageHandler::MsgValueType::block);
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(
           fmt::format("Gate {}: registered for blocks message of size {}", gate_id, num_blocks));
     }
   }
-  return future;
+  return std::move(futures.front());
 }
 
 template <typename T>
 void CommMixin::broadcast_ints_message(std::size_t gate_id, const std::vector<T>& message,
                                        std::size_t msg_num) const {
-  communication_layer_.broadcast_message(build_gate_message(gate_id, msg_num, message));
+  auto& mh = *message_handler_;
+  if (msg_num == 0 && mh.have_fused_messages_) {
+    std::unique_lock lock(mh.fused_mutex_);
+    if (auto it = mh.fused_gates_.find(gate_id); it != mh.fused_gates_.end()) {
+      auto [fused_id, index] = it->second;
+      auto& fused = mh.fused_messages_.at(fused_id);
+      if (fused.type_ != GateMessageHandler::get_msg_value_type<T>() ||
+          message.size() != fused.layout_[index].second) {
+        throw std::logic_error(
+            fmt::format("Gate {}: fused ints message has size {} while expecting size {}", gate_id,
+                        message.size(), fused.layout_[index].second));
+      }
+      std::memcpy(fused.payload_.data() + fused.offsets_[index], message.data(),
+                  message.size() * sizeof(T));
+      if (--fused.num_missing_parts_ > 0) {
+        return;
+      }
+      auto fused_message =
+          build_gate_message(fused_id, GateMessageHandler::fused_msg_num, fused.payload_.data(),
+                             fused.payload_.size());
+      fused.num_missing_parts_ = fused.layout_.size();
+      lock.unlock();
+      broadcast_gate_message(fused_id, std::move(fused_message));
+      return;
+    }
+  }
+  broadcast_gate_message(gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 template void CommMixin::broadcast_ints_message(std::size_t, const std::vector<std::uint8_t>&,
@@ -476,7 +736,7 @@ template void CommMixin::broadcast_ints_message(std::size_t, const std::vector<s
 template <typename T>
 void CommMixin::send_ints_message(std::size_t party_id, std::size_t gate_id,
                                   const std::vector<T>& message, std::size_t msg_num) const {
-  communication_layer_.send_message(party_id, build_gate_message(gate_id, msg_num, message));
+  send_gate_message(party_id, gate_id, build_gate_message(gate_id, msg_num, message));
 }
 
 template void CommMixin::send_ints_message(std::size_t, std::size_t,
@@ -492,27 +752,9 @@ template <typename T>
 [[nodiscard]] std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>>
 CommMixin::register_for_ints_messages(std::size_t gate_id, std::size_t num_elements,
                                       std::size_t msg_num) {
-  auto& mh = *message_handler_;
-  std::vector<ENCRYPTO::ReusableFiberPromise<std::vector<T>>> promises(num_parties_);
-  std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>> futures;
-  std::transform(std::begin(promises), std::end(promises), std::back_inserter(futures),
-                 [](auto& p) { return p.get_future(); });
-  auto type = GateMessageHandler::get_msg_value_type<T>();
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num), std::make_pair(num_elements, type)});
-  if (!success) {
-    throw std::logic_error(
-        fmt::format("tried to register twice for message {} for gate {}", msg_num, gate_id));
-  }
-  for (std::size_t party_id = 0; party_id < num_parties_; ++party_id) {
-    if (party_id == my_id_) {
-      continue;
-    }
-    auto& promise_map = mh.get_promise_map<T>().at(party_id);
-    auto [_, success] =
-        promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promises.at(party_id))});
-    assert(success);
-  }
+  auto futures = message_handler_->register_slot<std::vector<T>>(
+      gate_id, msg_num, GateMessageHandler::all_parties, num_elements,
+      GateMessageHandler::get_msg_value_type<T>());
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(fmt::format("Gate {}: registered for int messages {} of size {}", gate_id,
@@ -535,28 +777,15 @@ template <typename T>
 [[nodiscard]] ENCRYPTO::ReusableFiberFuture<std::vector<T>> CommMixin::register_for_ints_message(
     std::size_t party_id, std::size_t gate_id, std::size_t num_elements, std::size_t msg_num) {
   assert(party_id != my_id_);
-  auto& mh = *message_handler_;
-  ENCRYPTO::ReusableFiberPromise<std::vector<T>> promise;
-  ENCRYPTO::ReusableFiberFuture<std::vector<T>> future = promise.get_future();
-  auto type = GateMessageHandler::get_msg_value_type<T>();
-  auto [_, success] = mh.expected_messages_.insert(
-      {std::make_pair(gate_id, msg_num), std::make_pair(num_elements, type)});
-  if (!success) {
-    throw std::logic_error(
-        fmt::format("tried to register twice for message {} for gate {}", msg_num, gate_id));
-  }
-  {
-    auto& promise_map = mh.get_promise_map<T>().at(party_id);
-    auto [_, success] = promise_map.insert({std::make_pair(gate_id, msg_num), std::move(promise)});
-    assert(success);
-  }
+  auto futures = message_handler_->register_slot<std::vector<T>>(
+      gate_id, msg_num, party_id, num_elements, GateMessageHandler::get_msg_value_type<T>());
   if constexpr (MOTION_VERBOSE_DEBUG) {
     if (logger_) {
       logger_->LogTrace(fmt::format("Gate {}: registered for int message {} of size {}", gate_id,
                                     msg_num, num_elements));
     }
   }
-  return future;
+  return std::move(futures.front());
 }
 
 template ENCRYPTO::ReusableFiberFuture<std::vector<std::uint8_t>>
@@ -23,6 +23,8 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "utility/bit_vector.h"
 #include "utility/block.h"
@@ -37,6 +39,10 @@ class CommunicationLayer;
 enum class MessageType : std::uint8_t;
 }  // namespace Communication
 
+namespace Statistics {
+class GateProfiler;
+}
+
 namespace proto {
 
 class CommMixin {
@@ -54,6 +60,13 @@ class CommMixin {
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> register_for_bits_message(
       std::size_t party_id, std::size_t gate_id, std::size_t num_bits, std::size_t msg_num = 0);
 
+  // Fuse the messages (with msg_num 0) of the given (gate_id, num_bits or num_elements) pairs into
+  // a single message, where all of them are registered either as bits messages or as ints
+  // messages of the same type.  It is broadcast once all gates have passed their part to
+  // broadcast_bits_message or broadcast_ints_message, and split into the registered messages on
+  // the receiving side.  All parties need to use the same layout.
+  void fuse_messages(const std::vector<std::pair<std::size_t, std::size_t>>& layout);
+
   void broadcast_blocks_message(std::size_t gate_id, const ENCRYPTO::block128_vector& message,
                                 std::size_t msg_num = 0) const;
   void send_blocks_message(std::size_t party_id, std::size_t gate_id,
@@ -78,17 +91,30 @@ class CommMixin {
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<std::vector<T>> register_for_ints_message(
       std::size_t party_id, std::size_t gate_id, std::size_t num_elements, std::size_t msg_num = 0);
 
+  // Allocate the message slots of the gate ids [first_gate_id, first_gate_id + num_gate_ids)
+  // before the gates register for their messages, see CircuitTemplate.
+  void reserve_message_slots(std::size_t first_gate_id, std::size_t num_gate_ids);
+
+  // Record the gate messages sent and received with the profiler (only used if
+  // MOTION_GATE_PROFILING is enabled, set before the first message).
+  void set_gate_profiler(Statistics::GateProfiler* profiler) noexcept;
+
  private:
-  flatbuffers::FlatBufferBuilder build_gate_message(std::size_t gate_id, std::size_t msg_num,
-                                                    const std::uint8_t* message,
-                                                    std::size_t size) const;
+  void broadcast_gate_message(std::size_t gate_id, std::vector<std::uint8_t>&& message) const;
+  void send_gate_message(std::size_t party_id, std::size_t gate_id,
+                         std::vector<std::uint8_t>&& message) const;
+
+  // gate messages use the compact framing of Communication::BuildCompactGateMessage
+  std::vector<std::uint8_t> build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                               const std::uint8_t* message,
+                                               std::size_t size) const;
   template <typename T>
-  flatbuffers::FlatBufferBuilder build_gate_message(std::size_t gate_id, std::size_t msg_num,
-                                                    const std::vector<T>& vector) const;
-  flatbuffers::FlatBufferBuilder build_gate_message(std::size_t gate_id, std::size_t msg_num,
-                                                    const ENCRYPTO::BitVector<>& message) const;
-  flatbuffers::FlatBufferBuilder build_gate_message(std::size_t gate_id, std::size_t msg_num,
-                                                    const ENCRYPTO::block128_vector& message) const;
+  std::vector<std::uint8_t> build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                               const std::vector<T>& vector) const;
+  std::vector<std::uint8_t> build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                               const ENCRYPTO::BitVector<>& message) const;
+  std::vector<std::uint8_t> build_gate_message(std::size_t gate_id, std::size_t msg_num,
+                                               const ENCRYPTO::block128_vector& message) const;
 
   struct GateMessageHandler;
   Communication::CommunicationLayer& communication_layer_;
@@ -97,6 +123,7 @@ class CommMixin {
   std::size_t num_parties_;
   std::shared_ptr<GateMessageHandler> message_handler_;
   std::shared_ptr<Logger> logger_;
+  Statistics::GateProfiler* gate_profiler_ = nullptr;
 };
 
 }  // namespace proto
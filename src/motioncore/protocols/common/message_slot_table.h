@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace MOTION::proto {
+
+// Table of slots addressed by (gate_id, msg_num).  Since gate ids are dense, the slots are stored
+// in fixed size chunks which are allocated on first use and never moved, so lookups and
+// allocations from different threads need no lock.  Synchronization of the slot contents is up
+// to the Slot type.
+template <typename Slot>
+class MessageSlotTable {
+ public:
+  // number of messages per gate, i.e., msg_num has to be less than this
+  static constexpr std::size_t msgs_per_gate = 4;
+  static constexpr std::size_t chunk_bits = 12;
+  static constexpr std::size_t num_chunk_bits = 16;
+  static constexpr std::size_t chunk_size = msgs_per_gate << chunk_bits;
+  static constexpr std::size_t num_chunks = std::size_t(1) << num_chunk_bits;
+  static constexpr std::size_t max_num_gates = std::size_t(1) << (chunk_bits + num_chunk_bits);
+
+  MessageSlotTable() : chunks_(std::make_unique<std::atomic<Slot*>[]>(num_chunks)) {
+    for (std::size_t i = 0; i < num_chunks; ++i) {
+      chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  MessageSlotTable(const MessageSlotTable&) = delete;
+  MessageSlotTable& operator=(const MessageSlotTable&) = delete;
+  ~MessageSlotTable() {
+    for (std::size_t i = 0; i < num_chunks; ++i) {
+      delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // Return the slot if its chunk has been allocated, nullptr otherwise.
+  Slot* find(std::size_t gate_id, std::size_t msg_num) const noexcept {
+    if (gate_id >= max_num_gates || msg_num >= msgs_per_gate) {
+      return nullptr;
+    }
+    auto chunk = chunks_[gate_id >> chunk_bits].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    return &chunk[index_in_chunk(gate_id, msg_num)];
+  }
+
+  // Return the slot and allocate its chunk if necessary.
+  Slot& get(std::size_t gate_id, std::size_t msg_num) {
+    if (gate_id >= max_num_gates || msg_num >= msgs_per_gate) {
+      throw std::out_of_range(
+          fmt::format("MessageSlotTable: no slot for gate {} (msg_num {})", gate_id, msg_num));
+    }
+    auto& chunk_ptr = chunks_[gate_id >> chunk_bits];
+    auto chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      auto new_chunk = new Slot[chunk_size]();
+      if (chunk_ptr.compare_exchange_strong(chunk, new_chunk, std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+        chunk = new_chunk;
+      } else {
+        // another thread was faster
+        delete[] new_chunk;
+      }
+    }
+    return chunk[index_in_chunk(gate_id, msg_num)];
+  }
+
+  // Allocate the chunks of the gates [first_gate_id, first_gate_id + num_gates) ahead of their
+  // registrations, e.g., of a circuit whose size is known before it is built.
+  void reserve(std::size_t first_gate_id, std::size_t num_gates) {
+    if (num_gates == 0) {
+      return;
+    }
+    const auto last_gate_id = std::min(first_gate_id + num_gates, max_num_gates) - 1;
+    for (auto gate_id = first_gate_id; gate_id <= last_gate_id;
+         gate_id = ((gate_id >> chunk_bits) + 1) << chunk_bits) {
+      get(gate_id, 0);
+    }
+  }
+
+ private:
+  static std::size_t index_in_chunk(std::size_t gate_id, std::size_t msg_num) noexcept {
+    return (gate_id & ((std::size_t(1) << chunk_bits) - 1)) * msgs_per_gate + msg_num;
+  }
+
+  std::unique_ptr<std::atomic<Slot*>[]> chunks_;
+};
+
+}  // namespace MOTION::proto
@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace MOTION::proto {
+
+// Element-wise kernels of the arithmetic multiplication gates.  They work on raw pointers into the
+// structure-of-arrays layout of the shares and triples, s.t. the loops are vectorized with the
+// enabled instruction sets (e.g., AVX2).  Small rings are multiplied in unsigned int to avoid the
+// signed overflow of the integer promotion.
+
+namespace detail {
+
+template <typename T>
+using mul_t = std::conditional_t<(sizeof(T) < sizeof(unsigned int)), unsigned int, T>;
+
+}  // namespace detail
+
+// d = x - a and e = y - b of a Beaver multiplication, written to de[0, n) and de[n, 2n)
+template <typename T>
+inline void beaver_mask(const T* __restrict x, const T* __restrict y, const T* __restrict a,
+                        const T* __restrict b, T* __restrict de, std::size_t n) noexcept {
+  T* __restrict d = de;
+  T* __restrict e = de + n;
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    d[i] = x[i] - a[i];
+    e[i] = y[i] - b[i];
+  }
+}
+
+// z = c + e * x + d * y of a Beaver multiplication, minus d * e by one of the parties
+template <typename T>
+inline void beaver_combine(const T* __restrict c, const T* __restrict de, const T* __restrict x,
+                           const T* __restrict y, T* __restrict z, std::size_t n,
+                           bool subtract_de) noexcept {
+  using U = detail::mul_t<T>;
+  const T* __restrict d = de;
+  const T* __restrict e = de + n;
+  const U mask_de = subtract_de ? U(-1) : U(0);
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    const U de_i = U(d[i]) * U(e[i]);
+    z[i] = T(U(c[i]) + U(e[i]) * U(x[i]) + U(d[i]) * U(y[i]) - (de_i & mask_de));
+  }
+}
+
+// Delta_y -= Delta_a * delta_b + Delta_b * delta_a, plus Delta_a * Delta_b by one of the parties
+template <typename T>
+inline void beavy_mul_online(T* __restrict Delta_y, const T* __restrict Delta_a,
+                             const T* __restrict Delta_b, const T* __restrict delta_a,
+                             const T* __restrict delta_b, std::size_t n,
+                             bool add_Delta_ab) noexcept {
+  using U = detail::mul_t<T>;
+  const U mask_ab = add_Delta_ab ? U(-1) : U(0);
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    const U Delta_ab = U(Delta_a[i]) * U(Delta_b[i]);
+    Delta_y[i] = T(U(Delta_y[i]) - U(Delta_a[i]) * U(delta_b[i]) -
+                   U(Delta_b[i]) * U(delta_a[i]) + (Delta_ab & mask_ab));
+  }
+}
+
+// Delta_y = delta_a * delta_b + delta_y + delta_ab_1 + delta_ab_2 in the setup of the BEAVY
+// multiplication, where delta_ab_1 and delta_ab_2 are the shares of the cross terms from the OT
+// multiplications.  delta_y may be null for outputs without a mask of their own, e.g., of MULNI.
+template <typename T>
+inline void beavy_mul_setup(T* __restrict Delta_y, const T* __restrict delta_a,
+                            const T* __restrict delta_b, const T* __restrict delta_y,
+                            const T* __restrict delta_ab_1, const T* __restrict delta_ab_2,
+                            std::size_t n) noexcept {
+  using U = detail::mul_t<T>;
+  if (delta_y != nullptr) {
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+      Delta_y[i] = T(U(delta_a[i]) * U(delta_b[i]) + U(delta_y[i]) + U(delta_ab_1[i]) +
+                     U(delta_ab_2[i]));
+    }
+  } else {
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+      Delta_y[i] = T(U(delta_a[i]) * U(delta_b[i]) + U(delta_ab_1[i]) + U(delta_ab_2[i]));
+    }
+  }
+}
+
+// Delta_y = delta_a * delta_a + delta_y + 2 * delta_aa in the setup of the BEAVY squaring
+template <typename T>
+inline void beavy_sqr_setup(T* __restrict Delta_y, const T* __restrict delta_a,
+                            const T* __restrict delta_y, const T* __restrict delta_aa,
+                            std::size_t n) noexcept {
+  using U = detail::mul_t<T>;
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    Delta_y[i] = T(U(delta_a[i]) * U(delta_a[i]) + U(delta_y[i]) + 2 * U(delta_aa[i]));
+  }
+}
+
+// Delta_y -= 2 * Delta_a * delta_a, plus Delta_a * Delta_a by one of the parties
+template <typename T>
+inline void beavy_sqr_online(T* __restrict Delta_y, const T* __restrict Delta_a,
+                             const T* __restrict delta_a, std::size_t n,
+                             bool add_Delta_aa) noexcept {
+  using U = detail::mul_t<T>;
+  const U mask_aa = add_Delta_aa ? U(-1) : U(0);
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    const U Delta_aa = U(Delta_a[i]) * U(Delta_a[i]);
+    Delta_y[i] = T(U(Delta_y[i]) - 2 * U(Delta_a[i]) * U(delta_a[i]) + (Delta_aa & mask_aa));
+  }
+}
+
+}  // namespace MOTION::proto
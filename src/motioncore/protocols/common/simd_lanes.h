@@ -0,0 +1,61 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace MOTION::proto {
+
+// Small numbers of SIMD values which are common in circuits, e.g., a single value or one value per
+// bit of a byte or a word.  The per-lane loops of the hot gates are instantiated for them with a
+// compile-time number of lanes, s.t. the compiler unrolls and vectorizes them, while other sizes
+// use the same loops with a runtime bound.
+
+template <std::size_t num_lanes>
+using simd_lanes = std::integral_constant<std::size_t, num_lanes>;
+
+// Call f with the number of lanes as simd_lanes<num_simd> if num_simd is 1, 8, 64 or 128, and as
+// a std::size_t otherwise.  f is a generic lambda whose loops are bounded by its argument, e.g.,
+//
+//   with_num_lanes(num_simd, [&](auto num_lanes) {
+//     for (std::size_t j = 0; j < num_lanes; ++j) { ... }
+//   });
+template <typename F>
+inline decltype(auto) with_num_lanes(std::size_t num_simd, F&& f) {
+  switch (num_simd) {
+    case 1:
+      return f(simd_lanes<1>{});
+    case 8:
+      return f(simd_lanes<8>{});
+    case 64:
+      return f(simd_lanes<64>{});
+    case 128:
+      return f(simd_lanes<128>{});
+    default:
+      return f(num_simd);
+  }
+}
+
+}  // namespace MOTION::proto
@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <parallel/algorithm>
+#include <vector>
+
+#include "executor/execution_context.h"
+#include "tensor/tensor_op.h"
+#include "utility/linear_algebra.h"
+
+namespace MOTION::proto {
+
+// Local computations of the tensor gates.  Without an ExecutionContext they run on the calling
+// fiber, where convolution() and matrix_multiply() may still use the linear algebra thread pool
+// and the element-wise operations OpenMP.  With one, they are split into ranges of convolution
+// units, output rows (or columns of a product with few rows) or elements, which are evaluated by
+// the fibers of the context's pool together with the other gates.  Products which are offloaded to
+// the GPU are not split, see set_linear_algebra_gpu_min_work().
+struct TensorKernels {
+  // elements per range of the element-wise operations
+  static constexpr std::size_t element_granularity = std::size_t(1) << 14;
+
+  ExecutionContext* exec_ctx_ = nullptr;
+
+  // fctn(begin, end) for ranges covering [0, size), a single one without a context
+  void for_each_range(std::size_t size, std::size_t granularity,
+                      const std::function<void(std::size_t, std::size_t)>& fctn) const {
+    if (exec_ctx_ == nullptr) {
+      fctn(0, size);
+    } else {
+      exec_ctx_->parallel_for(size, granularity, fctn);
+    }
+  }
+
+  template <typename T>
+  void convolution(const tensor::Conv2DOp& conv_op, const T* input, const T* kernel,
+                   T* output) const {
+    if (exec_ctx_ == nullptr || is_offloaded_to_gpu<T>(conv_op)) {
+      MOTION::convolution(conv_op, input, kernel, output);
+      return;
+    }
+    exec_ctx_->parallel_for(get_convolution_num_units(conv_op), 1,
+                            [&](std::size_t begin, std::size_t end) {
+                              MOTION::convolution(conv_op, input, kernel, output, begin, end);
+                            });
+  }
+
+  template <typename T>
+  void matrix_multiply(const tensor::GemmOp& gemm_op, const T* A, const T* B, T* output) const {
+    if (exec_ctx_ == nullptr || is_offloaded_to_gpu<T>(gemm_op)) {
+      MOTION::matrix_multiply(gemm_op, A, B, output);
+      return;
+    }
+    const auto [num_rows, num_columns] = gemm_op.output_shape_;
+    if (num_rows >= exec_ctx_->num_threads_) {
+      exec_ctx_->parallel_for(num_rows, 1, [&](std::size_t begin, std::size_t end) {
+        MOTION::matrix_multiply(gemm_op, A, B, output, begin, end, 0, num_columns);
+      });
+    } else {
+      // e.g., a fully connected layer evaluated on a single sample
+      exec_ctx_->parallel_for(num_columns, 16, [&](std::size_t begin, std::size_t end) {
+        MOTION::matrix_multiply(gemm_op, A, B, output, 0, num_rows, begin, end);
+      });
+    }
+  }
+
+  // a[i] = op(a[i], b[i])
+  template <typename T, typename BinaryOp>
+  void transform(std::vector<T>& a, const std::vector<T>& b, BinaryOp op) const {
+    if (exec_ctx_ == nullptr) {
+      __gnu_parallel::transform(std::begin(a), std::end(a), std::begin(b), std::begin(a), op);
+      return;
+    }
+    exec_ctx_->parallel_for(a.size(), element_granularity, [&](std::size_t begin, std::size_t end) {
+      std::transform(std::begin(a) + begin, std::begin(a) + end, std::begin(b) + begin,
+                     std::begin(a) + begin, op);
+    });
+  }
+};
+
+}  // namespace MOTION::proto
@@ -31,6 +31,9 @@
 #include "crypto/multiplication_triple/sp_provider.h"
 #include "crypto/sharing_randomness_generator.h"
 #include "gmw_provider.h"
+#include "protocols/common/mul_kernels.h"
+#include "protocols/common/simd_lanes.h"
+#include "utility/bit_expression.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
 #include "wire.h"
@@ -168,6 +171,11 @@ void BooleanGMWInputGateSender::evaluate_online() {
   }
 }
 
+std::optional<GateCost> BooleanGMWInputGateSender::get_cost() const {
+  // the shares of the other parties are derived from the shared randomness
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW};
+}
+
 BooleanGMWInputGateReceiver::BooleanGMWInputGateReceiver(std::size_t gate_id,
                                                          GMWProvider& gmw_provider,
                                                          std::size_t num_wires,
@@ -211,6 +219,10 @@ void BooleanGMWInputGateReceiver::evaluate_setup() {
   }
 }
 
+std::optional<GateCost> BooleanGMWInputGateReceiver::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW};
+}
+
 // Determine the total number of bits in a collection of wires.
 static std::size_t count_bits(const BooleanGMWWireVector& wires) {
   return std::transform_reduce(std::begin(wires), std::end(wires), 0, std::plus<>(),
@@ -240,6 +252,13 @@ BooleanGMWOutputGate::get_output_future() {
   }
 }
 
+std::pair<CommMixin*, std::size_t> BooleanGMWOutputGate::get_fusable_output_message() const {
+  if (output_owner_ != ALL_PARTIES) {
+    return {nullptr, 0};
+  }
+  return {&gmw_provider_, count_bits(inputs_)};
+}
+
 void BooleanGMWOutputGate::evaluate_online() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
@@ -291,6 +310,17 @@ void BooleanGMWOutputGate::evaluate_online() {
   }
 }
 
+std::optional<GateCost> BooleanGMWOutputGate::get_cost() const {
+  std::size_t num_bits = 0;
+  for (const auto& wire : inputs_) {
+    num_bits += wire->get_num_simd();
+  }
+  const bool send = output_owner_ != gmw_provider_.get_my_id();
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW,
+                  .online_bytes_ = send ? Helpers::Convert::BitsToBytes(num_bits) : 0,
+                  .online_rounds_ = 1};
+}
+
 BooleanGMWINVGate::BooleanGMWINVGate(std::size_t gate_id, const GMWProvider& gmw_provider,
                                      BooleanGMWWireVector&& in)
     : detail::BasicBooleanGMWUnaryGate(gate_id, std::move(in), !gmw_provider.is_my_job(gate_id)),
@@ -310,6 +340,10 @@ void BooleanGMWINVGate::evaluate_online() {
   }
 }
 
+std::optional<GateCost> BooleanGMWINVGate::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW};
+}
+
 void BooleanGMWXORGate::evaluate_online() {
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     const auto& w_a = inputs_a_[wire_i];
@@ -323,40 +357,104 @@ void BooleanGMWXORGate::evaluate_online() {
   }
 }
 
+std::optional<GateCost> BooleanGMWXORGate::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW};
+}
+
 BooleanGMWANDGate::BooleanGMWANDGate(std::size_t gate_id, GMWProvider& gmw_provider,
                                      BooleanGMWWireVector&& in_a, BooleanGMWWireVector&& in_b)
     : detail::BasicBooleanGMWBinaryGate(gate_id, std::move(in_a), std::move(in_b)),
       gmw_provider_(gmw_provider) {
   auto num_wires = inputs_a_.size();
   auto num_simd = inputs_a_.at(0)->get_num_simd();
-  mt_offset_ = gmw_provider_.get_mt_provider().RequestBinaryMTs(num_wires * num_simd);
-  share_futures_ = gmw_provider_.register_for_bits_messages(gate_id_, 2 * count_bits(inputs_a_));
+  auto num_bits = num_wires * num_simd;
+  mt_offset_ = gmw_provider_.get_mt_provider().RequestBinaryMTs(num_bits);
+  // e starts at the byte after d, so that both can be computed in place
+  e_offset_ = 8 * Helpers::Convert::BitsToBytes(num_bits);
+  share_futures_ = gmw_provider_.register_for_bits_messages(gate_id_, e_offset_ + num_bits);
 }
 
+namespace {
+
+// clear the bits after the first num_bits bits at data, which the kernels fill with whatever
+// follows the operands in the last byte
+void clear_padding(std::byte* data, std::size_t num_bits) {
+  if (num_bits % 8 != 0) {
+    data[num_bits / 8] &= ENCRYPTO::TRUNCATION_BIT_MASK[num_bits % 8 - 1];
+  }
+}
+
+}  // namespace
+
 void BooleanGMWANDGate::evaluate_online() {
+  using ENCRYPTO::BitTerminal;
   auto num_simd = inputs_a_[0]->get_num_simd();
   auto num_bits = num_wires_ * num_simd;
   const auto& mtp = gmw_provider_.get_mt_provider();
-  auto mts = mtp.GetBinary(mt_offset_, num_bits);
+
+  // read the MTs in place if they start at a byte boundary, otherwise copy them
+  const std::byte* mt_a;
+  const std::byte* mt_b;
+  const std::byte* mt_c;
+  std::optional<BinaryMTVector> mts;
+  if (mt_offset_ % 8 == 0) {
+    const auto& all_mts = mtp.GetBinaryAll();
+    mt_a = all_mts.a.GetData().data() + mt_offset_ / 8;
+    mt_b = all_mts.b.GetData().data() + mt_offset_ / 8;
+    mt_c = all_mts.c.GetData().data() + mt_offset_ / 8;
+  } else {
+    mts = mtp.GetBinary(mt_offset_, num_bits);
+    mt_a = mts->a.GetData().data();
+    mt_b = mts->b.GetData().data();
+    mt_c = mts->c.GetData().data();
+  }
+
+  // The kernels work on slices starting at byte boundaries.  If the wires do not, their shares are
+  // collected into a single buffer and processed as one slice.
+  const bool per_wire = num_wires_ == 1 || num_simd % 8 == 0;
   ENCRYPTO::BitVector<> x;
   ENCRYPTO::BitVector<> y;
-  x.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-  y.Reserve(Helpers::Convert::BitsToBytes(num_bits));
-
-  // collect all shares into a single buffer
+  if (!per_wire) {
+    x.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+    y.Reserve(Helpers::Convert::BitsToBytes(num_bits));
+  }
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     const auto& wire_x = inputs_a_[wire_i];
     wire_x->wait_online();
     assert(wire_x->get_share().GetSize() == num_simd);
-    x.Append(wire_x->get_share());
     const auto& wire_y = inputs_b_[wire_i];
     wire_y->wait_online();
     assert(wire_y->get_share().GetSize() == num_simd);
-    y.Append(wire_y->get_share());
+    if (!per_wire) {
+      x.Append(wire_x->get_share());
+      y.Append(wire_y->get_share());
+    }
   }
-  // mask values with a, b
-  auto de = x ^ mts.a;
-  de.Append(y ^ mts.b);
+  // (x, y, bit offset in the gate) of each slice
+  const auto for_each_slice = [&](auto&& f) {
+    if (per_wire) {
+      for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+        f(inputs_a_[wire_i]->get_share().GetData().data(),
+          inputs_b_[wire_i]->get_share().GetData().data(), wire_i * num_simd, num_simd);
+      }
+    } else {
+      f(x.GetData().data(), y.GetData().data(), 0, num_bits);
+    }
+  };
+
+  // mask values with a, b directly in the message: d = x ^ a, e = y ^ b
+  ENCRYPTO::BitVector<> de(e_offset_ + num_bits);
+  auto* d_data = de.GetMutableData().data();
+  auto* e_data = d_data + e_offset_ / 8;
+  for_each_slice([&](const std::byte* x_data, const std::byte* y_data, std::size_t offset,
+                     std::size_t size) {
+    ENCRYPTO::xor_assign(d_data + offset / 8,
+                         BitTerminal(x_data, size) ^ BitTerminal(mt_a + offset / 8, size));
+    ENCRYPTO::xor_assign(e_data + offset / 8,
+                         BitTerminal(y_data, size) ^ BitTerminal(mt_b + offset / 8, size));
+  });
+  clear_padding(d_data, num_bits);
+  clear_padding(e_data, num_bits);
   gmw_provider_.broadcast_bits_message(gate_id_, de);
   // compute d, e
   auto num_parties = gmw_provider_.get_num_parties();
@@ -367,28 +465,58 @@ void BooleanGMWANDGate::evaluate_online() {
     }
     de ^= share_futures_[party_id].get();
   }
-  auto e = de.Subset(num_bits, 2 * num_bits);
-  auto d = std::move(de);
-  d.Resize(num_bits);
-  x &= e;  // x & e
-  y &= d;  // y & d
-  d &= e;  // d & e
-  auto result = std::move(mts.c);
-  result ^= x;
-  result ^= y;
-  if (gmw_provider_.is_my_job(gate_id_)) {
-    result ^= d;
+
+  // z = c ^ (x & e) ^ (y & d) [^ (d & e)] in a single pass
+  const bool is_my_job = gmw_provider_.is_my_job(gate_id_);
+  ENCRYPTO::BitVector<> result;
+  if (!per_wire) {
+    result = ENCRYPTO::BitVector<>(num_bits);
   }
+  for_each_slice([&](const std::byte* x_data, const std::byte* y_data, std::size_t offset,
+                     std::size_t size) {
+    std::byte* z_data;
+    if (per_wire) {
+      auto& share = outputs_[offset / num_simd]->get_share();
+      share = ENCRYPTO::BitVector<>(num_simd);
+      z_data = share.GetMutableData().data();
+    } else {
+      z_data = result.GetMutableData().data();
+    }
+    const BitTerminal d(d_data + offset / 8, size);
+    const BitTerminal e(e_data + offset / 8, size);
+    const auto z = BitTerminal(mt_c + offset / 8, size) ^ (BitTerminal(x_data, size) & e) ^
+                   (BitTerminal(y_data, size) & d);
+    if (is_my_job) {
+      ENCRYPTO::xor_assign(z_data, z ^ (d & e));
+    } else {
+      ENCRYPTO::xor_assign(z_data, z);
+    }
+    clear_padding(z_data, size);
+  });
 
   // distribute data among wires
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     auto& wire_o = outputs_[wire_i];
-    wire_o->get_share() = result.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    if (!per_wire) {
+      wire_o->get_share() = result.Subset(wire_i * num_simd, (wire_i + 1) * num_simd);
+    }
     assert(wire_o->get_share().GetSize() == num_simd);
     wire_o->set_online_ready();
   }
 }
 
+std::optional<GateCost> BooleanGMWANDGate::get_cost() const {
+  const auto num_bits = num_wires_ * inputs_a_[0]->get_num_simd();
+  // the MTs are generated from OTs in both directions, d and e are broadcast
+  const auto setup_bits =
+      GateCost::cot_sender_bits(num_bits, 1) + GateCost::cot_receiver_bits(num_bits);
+  return GateCost{.protocol_ = MPCProtocol::BooleanGMW,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = 2 * Helpers::Convert::BitsToBytes(num_bits),
+                  .num_ots_ = 2 * num_bits,
+                  .online_rounds_ = 1};
+}
+
 namespace detail {
 
 template <typename T>
@@ -517,6 +645,11 @@ void ArithmeticGMWInputGateSender<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWInputGateSender<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW};
+}
+
 template class ArithmeticGMWInputGateSender<std::uint8_t>;
 template class ArithmeticGMWInputGateSender<std::uint16_t>;
 template class ArithmeticGMWInputGateSender<std::uint32_t>;
@@ -558,6 +691,11 @@ void ArithmeticGMWInputGateReceiver<T>::evaluate_setup() {
   }
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWInputGateReceiver<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW};
+}
+
 template class ArithmeticGMWInputGateReceiver<std::uint8_t>;
 template class ArithmeticGMWInputGateReceiver<std::uint16_t>;
 template class ArithmeticGMWInputGateReceiver<std::uint32_t>;
@@ -587,6 +725,14 @@ ENCRYPTO::ReusableFiberFuture<std::vector<T>> ArithmeticGMWOutputGate<T>::get_ou
   }
 }
 
+template <typename T>
+std::pair<CommMixin*, std::size_t> ArithmeticGMWOutputGate<T>::get_fusable_output_message() const {
+  if (output_owner_ != ALL_PARTIES) {
+    return {nullptr, 0};
+  }
+  return {&gmw_provider_, input_->get_num_simd()};
+}
+
 template <typename T>
 void ArithmeticGMWOutputGate<T>::evaluate_online() {
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -629,6 +775,14 @@ void ArithmeticGMWOutputGate<T>::evaluate_online() {
   }
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWOutputGate<T>::get_cost() const {
+  const bool send = output_owner_ != gmw_provider_.get_my_id();
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW,
+                  .online_bytes_ = send ? input_->get_num_simd() * sizeof(T) : 0,
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticGMWOutputGate<std::uint8_t>;
 template class ArithmeticGMWOutputGate<std::uint16_t>;
 template class ArithmeticGMWOutputGate<std::uint32_t>;
@@ -652,6 +806,11 @@ void ArithmeticGMWOutputShareGate<T>::evaluate_online() {
   output_promise_.set_value(input_->get_share());
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWOutputShareGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW};
+}
+
 template class ArithmeticGMWOutputShareGate<std::uint8_t>;
 template class ArithmeticGMWOutputShareGate<std::uint16_t>;
 template class ArithmeticGMWOutputShareGate<std::uint32_t>;
@@ -673,6 +832,11 @@ void ArithmeticGMWNEGGate<T>::evaluate_online() {
   this->output_->set_online_ready();
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWNEGGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW};
+}
+
 template class ArithmeticGMWNEGGate<std::uint8_t>;
 template class ArithmeticGMWNEGGate<std::uint16_t>;
 template class ArithmeticGMWNEGGate<std::uint32_t>;
@@ -698,6 +862,11 @@ void ArithmeticGMWADDGate<T>::evaluate_online() {
   this->output_->set_online_ready();
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWADDGate<T>::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW};
+}
+
 template class ArithmeticGMWADDGate<std::uint8_t>;
 template class ArithmeticGMWADDGate<std::uint16_t>;
 template class ArithmeticGMWADDGate<std::uint32_t>;
@@ -719,7 +888,7 @@ template <typename T>
 void ArithmeticGMWMULGate<T>::evaluate_online() {
   auto num_simd = this->input_a_->get_num_simd();
   const auto& mtp = gmw_provider_.get_mt_provider();
-  const auto& all_mts = mtp.GetIntegerAll<T>();
+  const auto mts = mtp.GetIntegerSpan<T>(mt_offset_, num_simd);
   this->input_a_->wait_online();
   this->input_b_->wait_online();
   const auto& x = this->input_a_->get_share();
@@ -727,10 +896,7 @@ void ArithmeticGMWMULGate<T>::evaluate_online() {
 
   //  mask inputs
   std::vector<T> de(2 * num_simd);
-  auto it = std::transform(std::begin(x), std::end(x), std::begin(all_mts.a) + this->mt_offset_,
-                           std::begin(de), std::minus{});
-  std::transform(std::begin(y), std::end(y), std::begin(all_mts.b) + this->mt_offset_, it,
-                 std::minus{});
+  beaver_mask(x.data(), y.data(), mts.a.data(), mts.b.data(), de.data(), num_simd);
   this->gmw_provider_.broadcast_ints_message(this->gate_id_, de);
 
   // compute d, e
@@ -744,28 +910,118 @@ void ArithmeticGMWMULGate<T>::evaluate_online() {
     std::transform(std::begin(de), std::end(de), std::begin(other_share), std::begin(de),
                    std::plus{});
   }
-  // result = c ...
-  std::vector<T> result(std::begin(all_mts.c) + mt_offset_,
-                        std::begin(all_mts.c) + mt_offset_ + num_simd);
-  // ... - d * e ...
-  if (this->gmw_provider_.is_my_job(this->gate_id_)) {
-    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-      result[simd_j] -= de[simd_j] * de[simd_j + num_simd];
-    }
-  }
-  // ... + e * x + d * y
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    result[simd_j] += de[simd_j] * y[simd_j] + de[simd_j + num_simd] * x[simd_j];
-  }
+  // result = c - d * e + e * x + d * y, where only one party subtracts d * e
+  std::vector<T> result(num_simd);
+  beaver_combine(mts.c.data(), de.data(), x.data(), y.data(), result.data(), num_simd,
+                 this->gmw_provider_.is_my_job(this->gate_id_));
   this->output_->get_share() = std::move(result);
   this->output_->set_online_ready();
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWMULGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_simd = this->input_a_->get_num_simd();
+  // each MT needs bit_size OTs of bit_size bits in both directions, d and e are broadcast
+  const auto num_ots = bit_size * num_simd;
+  const auto setup_bits =
+      GateCost::cot_sender_bits(num_ots, bit_size) + GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = 2 * num_simd * sizeof(T),
+                  .num_ots_ = 2 * num_ots,
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticGMWMULGate<std::uint8_t>;
 template class ArithmeticGMWMULGate<std::uint16_t>;
 template class ArithmeticGMWMULGate<std::uint32_t>;
 template class ArithmeticGMWMULGate<std::uint64_t>;
 
+template <typename T>
+ArithmeticGMWBroadcastMULGate<T>::ArithmeticGMWBroadcastMULGate(std::size_t gate_id,
+                                                                GMWProvider& gmw_provider,
+                                                                ArithmeticGMWWireP<T>&& in_a,
+                                                                ArithmeticGMWWireP<T>&& in_b)
+    : NewGate(gate_id),
+      gmw_provider_(gmw_provider),
+      input_a_(std::move(in_a)),
+      input_b_(std::move(in_b)),
+      output_(std::make_shared<ArithmeticGMWWire<T>>(input_b_->get_num_simd())) {
+  const auto num_groups = input_a_->get_num_simd();
+  const auto num_simd = input_b_->get_num_simd();
+  assert(num_groups > 0 && num_simd % num_groups == 0);
+  vector_size_ = num_simd / num_groups;
+  mt_request_ = gmw_provider.get_mt_provider().RequestSharedArithmeticMTs<T>(num_groups,
+                                                                             vector_size_);
+  share_futures_ =
+      gmw_provider_.register_for_ints_messages<T>(this->gate_id_, num_groups + num_simd);
+}
+
+template <typename T>
+void ArithmeticGMWBroadcastMULGate<T>::evaluate_online() {
+  const auto num_groups = input_a_->get_num_simd();
+  const auto num_simd = input_b_->get_num_simd();
+  const auto& mts = gmw_provider_.get_mt_provider().GetSharedInteger<T>(mt_request_);
+  input_a_->wait_online();
+  input_b_->wait_online();
+  const auto& x = input_a_->get_share();
+  const auto& y = input_b_->get_share();
+
+  // mask inputs: d = x - a for each group, e = y - b for each SIMD value
+  std::vector<T> de(num_groups + num_simd);
+  std::transform(std::begin(x), std::end(x), std::begin(mts.a), std::begin(de), std::minus{});
+  std::transform(std::begin(y), std::end(y), std::begin(mts.b), std::begin(de) + num_groups,
+                 std::minus{});
+  gmw_provider_.broadcast_ints_message(this->gate_id_, de);
+
+  // compute d, e
+  auto num_parties = gmw_provider_.get_num_parties();
+  auto my_id = gmw_provider_.get_my_id();
+  for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+    if (party_id == my_id) {
+      continue;
+    }
+    auto other_share = share_futures_[party_id].get();
+    std::transform(std::begin(de), std::end(de), std::begin(other_share), std::begin(de),
+                   std::plus{});
+  }
+  // result = c - d * e + e * x + d * y, where only one party subtracts d * e
+  using U = proto::detail::mul_t<T>;
+  const U mask_de = gmw_provider_.is_my_job(this->gate_id_) ? U(-1) : U(0);
+  const T* e = de.data() + num_groups;
+  std::vector<T> result(num_simd);
+  for (std::size_t i = 0; i < num_simd; ++i) {
+    const auto group = i / vector_size_;
+    const U d = de[group];
+    result[i] = T(U(mts.c[i]) + U(e[i]) * U(x[group]) + d * U(y[i]) - ((d * U(e[i])) & mask_de));
+  }
+  output_->get_share() = std::move(result);
+  output_->set_online_ready();
+}
+
+template <typename T>
+std::optional<GateCost> ArithmeticGMWBroadcastMULGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_groups = input_a_->get_num_simd();
+  const auto num_simd = input_b_->get_num_simd();
+  // each a needs bit_size OTs of vector_size * bit_size bits in both directions, d and e are
+  // broadcast
+  const auto num_ots = bit_size * num_groups;
+  const auto setup_bits = GateCost::cot_sender_bits(num_ots, vector_size_ * bit_size) +
+                          GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = (num_groups + num_simd) * sizeof(T),
+                  .num_ots_ = 2 * num_ots,
+                  .online_rounds_ = 1};
+}
+
+template class ArithmeticGMWBroadcastMULGate<std::uint8_t>;
+template class ArithmeticGMWBroadcastMULGate<std::uint16_t>;
+template class ArithmeticGMWBroadcastMULGate<std::uint32_t>;
+template class ArithmeticGMWBroadcastMULGate<std::uint64_t>;
+
 template <typename T>
 ArithmeticGMWSQRGate<T>::ArithmeticGMWSQRGate(std::size_t gate_id, GMWProvider& gmw_provider,
                                               ArithmeticGMWWireP<T>&& in)
@@ -804,20 +1060,33 @@ void ArithmeticGMWSQRGate<T>::evaluate_online() {
   // result = c ...
   std::vector<T> result(std::begin(all_sps.c) + sp_offset_,
                         std::begin(all_sps.c) + sp_offset_ + num_simd);
-  // ... - d^2 ...
-  if (this->gmw_provider_.is_my_job(this->gate_id_)) {
-    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-      result[simd_j] -= d[simd_j] * d[simd_j];
+  // ... + 2 * d * x - d^2, where d^2 is only subtracted by one party
+  const T mask_dd = this->gmw_provider_.is_my_job(this->gate_id_) ? T(-1) : T(0);
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+      result[simd_j] += 2 * d[simd_j] * x[simd_j] - (T(d[simd_j] * d[simd_j]) & mask_dd);
     }
-  }
-  // ... + 2 * d * x
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    result[simd_j] += 2 * d[simd_j] * x[simd_j];
-  }
+  });
   this->output_->get_share() = std::move(result);
   this->output_->set_online_ready();
 }
 
+template <typename T>
+std::optional<GateCost> ArithmeticGMWSQRGate<T>::get_cost() const {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  const auto num_simd = this->input_->get_num_simd();
+  // each SP needs bit_size OTs of bit_size bits where party 1 is the sender, d is broadcast
+  const auto num_ots = bit_size * num_simd;
+  const auto setup_bits = gmw_provider_.get_my_id() == 1
+                              ? GateCost::cot_sender_bits(num_ots, bit_size)
+                              : GateCost::cot_receiver_bits(num_ots);
+  return GateCost{.protocol_ = MPCProtocol::ArithmeticGMW,
+                  .setup_bytes_ = Helpers::Convert::BitsToBytes(setup_bits),
+                  .online_bytes_ = num_simd * sizeof(T),
+                  .num_ots_ = num_ots,
+                  .online_rounds_ = 1};
+}
+
 template class ArithmeticGMWSQRGate<std::uint8_t>;
 template class ArithmeticGMWSQRGate<std::uint16_t>;
 template class ArithmeticGMWSQRGate<std::uint32_t>;
@@ -875,11 +1144,13 @@ void BooleanXArithmeticGMWMULGate<T>::evaluate_online() {
 
   std::vector<T> result(num_simd);
   std::vector<T> int_factor(num_simd);
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    auto bn_j = b.Get(simd_j) ? n[simd_j] : T(0);
-    result[simd_j] = bn_j;
-    int_factor[simd_j] = n[simd_j] - 2 * bn_j;
-  }
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+      auto bn_j = b.Get(simd_j) ? n[simd_j] : T(0);
+      result[simd_j] = bn_j;
+      int_factor[simd_j] = n[simd_j] - 2 * bn_j;
+    }
+  });
   mult_bit_side_->set_inputs(b);
   mult_int_side_->set_inputs(std::move(int_factor));
 
@@ -888,9 +1159,11 @@ void BooleanXArithmeticGMWMULGate<T>::evaluate_online() {
 
   auto bit_prod = mult_bit_side_->get_outputs();
   auto int_prod = mult_int_side_->get_outputs();
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    result[simd_j] += bit_prod[simd_j] + int_prod[simd_j];
-  }
+  with_num_lanes(num_simd, [&](auto num_lanes) {
+    for (std::size_t simd_j = 0; simd_j < num_lanes; ++simd_j) {
+      result[simd_j] += bit_prod[simd_j] + int_prod[simd_j];
+    }
+  });
   this->output_->get_share() = std::move(result);
   this->output_->set_online_ready();
 
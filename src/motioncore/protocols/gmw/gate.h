@@ -45,6 +45,13 @@ class BasicBooleanGMWBinaryGate : public NewGate {
  public:
   BasicBooleanGMWBinaryGate(std::size_t gate_id, BooleanGMWWireVector&&, BooleanGMWWireVector&&);
   BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_a_);
+    MOTION::detail::append_wires(wires, inputs_b_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   std::size_t num_wires_;
@@ -57,6 +64,12 @@ class BasicBooleanGMWUnaryGate : public NewGate {
  public:
   BasicBooleanGMWUnaryGate(std::size_t gate_id, BooleanGMWWireVector&&, bool forward);
   BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   std::size_t num_wires_;
@@ -79,6 +92,7 @@ class BooleanGMWInputGateSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
   BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; }
 
  private:
@@ -98,6 +112,7 @@ class BooleanGMWInputGateReceiver : public NewGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override;
   BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; }
 
  private:
@@ -118,6 +133,11 @@ class BooleanGMWOutputGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  std::pair<CommMixin*, std::size_t> get_fusable_output_message() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -135,6 +155,10 @@ class BooleanGMWINVGate : public detail::BasicBooleanGMWUnaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
 
  private:
   bool is_my_job_;
@@ -147,6 +171,10 @@ class BooleanGMWXORGate : public detail::BasicBooleanGMWBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
 };
 
 class BooleanGMWANDGate : public detail::BasicBooleanGMWBinaryGate {
@@ -157,10 +185,13 @@ class BooleanGMWANDGate : public detail::BasicBooleanGMWBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
   GMWProvider& gmw_provider_;
   std::size_t mt_offset_;
+  // bit offset of e in the message d || e
+  std::size_t e_offset_;
   std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>> share_futures_;
 };
 
@@ -172,6 +203,13 @@ class BasicArithmeticGMWBinaryGate : public NewGate {
   BasicArithmeticGMWBinaryGate(std::size_t gate_id, GMWProvider&, ArithmeticGMWWireP<T>&&,
                                ArithmeticGMWWireP<T>&&);
   ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_a_.get());
+    wires.push_back(input_b_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   std::size_t num_wires_;
@@ -185,6 +223,12 @@ class BasicArithmeticGMWUnaryGate : public NewGate {
  public:
   BasicArithmeticGMWUnaryGate(std::size_t gate_id, GMWProvider&, ArithmeticGMWWireP<T>&&);
   ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   std::size_t num_wires_;
@@ -198,6 +242,13 @@ class BasicBooleanXArithmeticGMWBinaryGate : public NewGate {
   BasicBooleanXArithmeticGMWBinaryGate(std::size_t gate_id, GMWProvider&, BooleanGMWWireP&&,
                                        ArithmeticGMWWireP<T>&&);
   ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_a_.get());
+    wires.push_back(input_b_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
 
  protected:
   const BooleanGMWWireP input_a_;
@@ -216,6 +267,7 @@ class ArithmeticGMWInputGateSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
   ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
 
  private:
@@ -236,6 +288,7 @@ class ArithmeticGMWInputGateReceiver : public NewGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override;
   ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
 
  private:
@@ -257,6 +310,11 @@ class ArithmeticGMWOutputGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  std::pair<CommMixin*, std::size_t> get_fusable_output_message() const override;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_.get());
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -276,6 +334,7 @@ class ArithmeticGMWOutputShareGate : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
   ENCRYPTO::ReusableFiberPromise<std::vector<T>> output_promise_;
@@ -290,6 +349,10 @@ class ArithmeticGMWNEGGate : public detail::BasicArithmeticGMWUnaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
 
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
@@ -304,6 +367,10 @@ class ArithmeticGMWADDGate : public detail::BasicArithmeticGMWBinaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::small;
+  }
+  std::optional<GateCost> get_cost() const override;
 };
 
 template <typename T>
@@ -315,6 +382,7 @@ class ArithmeticGMWMULGate : public detail::BasicArithmeticGMWBinaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
   GMWProvider& gmw_provider_;
@@ -322,6 +390,39 @@ class ArithmeticGMWMULGate : public detail::BasicArithmeticGMWBinaryGate<T> {
   std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>> share_futures_;
 };
 
+// Multiplies SIMD value i of in_a with each of the SIMD values [i * m, (i + 1) * m) of in_b, where
+// in_b has m times as many SIMD values, e.g., one secret weight with many values.  The triples
+// share their multiplicand a (see SharedIntegerMTVector) s.t. their OTs are only needed for the
+// SIMD values of in_a, and only one d per SIMD value of in_a is sent.
+template <typename T>
+class ArithmeticGMWBroadcastMULGate : public NewGate {
+ public:
+  ArithmeticGMWBroadcastMULGate(std::size_t gate_id, GMWProvider&, ArithmeticGMWWireP<T>&&,
+                                ArithmeticGMWWireP<T>&&);
+  bool need_setup() const noexcept override { return false; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override {}
+  void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(input_a_.get());
+    wires.push_back(input_b_.get());
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    wires.push_back(output_.get());
+  }
+
+ private:
+  GMWProvider& gmw_provider_;
+  const ArithmeticGMWWireP<T> input_a_;
+  const ArithmeticGMWWireP<T> input_b_;
+  ArithmeticGMWWireP<T> output_;
+  std::size_t vector_size_;
+  std::size_t mt_request_;
+  std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<T>>> share_futures_;
+};
+
 template <typename T>
 class ArithmeticGMWSQRGate : public detail::BasicArithmeticGMWUnaryGate<T> {
  public:
@@ -331,6 +432,7 @@ class ArithmeticGMWSQRGate : public detail::BasicArithmeticGMWUnaryGate<T> {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 
  private:
   GMWProvider& gmw_provider_;
@@ -37,9 +37,11 @@
 #include "crypto/multiplication_triple/sp_provider.h"
 #include "gate.h"
 #include "plain.h"
+#include "protocols/plain/constant_folding.h"
 #include "protocols/plain/wire.h"
 #include "tensor_op.h"
 #include "utility/constants.h"
+#include "utility/construction_scope.h"
 #include "utility/logger.h"
 #include "utility/meta.hpp"
 #include "wire.h"
@@ -81,7 +83,10 @@ bool GMWProvider::is_my_job(std::size_t gate_id) const noexcept {
   return my_id_ == (gate_id % num_parties_);
 }
 
-std::size_t GMWProvider::get_next_input_id(std::size_t num_inputs) noexcept {
+std::size_t GMWProvider::get_next_input_id(std::size_t num_inputs) {
+  if (auto input_id = ConstructionScope::take(ConstructionCounter::gmw_input_ids, num_inputs)) {
+    return *input_id;
+  }
   auto next_id = next_input_id_;
   next_input_id_ += num_inputs;
   return next_id;
@@ -415,6 +420,9 @@ std::pair<std::unique_ptr<NewGate>, WireVector> GMWProvider::construct_xor_gate(
 }
 
 WireVector GMWProvider::make_xor_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR, in_a, in_b);
+  }
   auto [gate, output] = construct_xor_gate(in_a, in_b);
   gate_register_.register_gate(std::move(gate));
   return output;
@@ -443,6 +451,9 @@ std::pair<std::unique_ptr<NewGate>, WireVector> GMWProvider::construct_and_gate(
 }
 
 WireVector GMWProvider::make_and_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, in_a, in_b);
+  }
   auto [gate, output] = construct_and_gate(in_a, in_b);
   gate_register_.register_gate(std::move(gate));
   return output;
@@ -570,6 +581,9 @@ WireVector GMWProvider::make_neg_gate(const WireVector& in) {
 }
 
 WireVector GMWProvider::make_add_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::ADD, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain) {
     return make_add_gate(in_b, in_a);
@@ -584,6 +598,9 @@ WireVector GMWProvider::make_add_gate(const WireVector& in_a, const WireVector&
 }
 
 WireVector GMWProvider::make_mul_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (plain::is_constant(in_a) && plain::is_constant(in_b)) {
+    return plain::fold_binary_gate(ENCRYPTO::PrimitiveOperationType::MUL, in_a, in_b);
+  }
   // assume, at most one of the inputs is a plain wire or a Boolean wire
   if (in_a.at(0)->get_protocol() == MPCProtocol::ArithmeticPlain ||
       in_a.at(0)->get_protocol() == MPCProtocol::BooleanGMW) {
@@ -601,6 +618,20 @@ WireVector GMWProvider::make_mul_gate(const WireVector& in_a, const WireVector&
   }
 }
 
+WireVector GMWProvider::make_broadcast_mul_gate(const WireVector& in_a, const WireVector& in_b) {
+  if (in_a.size() != 1 || in_a.at(0)->get_protocol() != MPCProtocol::ArithmeticGMW ||
+      in_b.size() != 1 || in_b.at(0)->get_protocol() != MPCProtocol::ArithmeticGMW) {
+    throw std::logic_error("GMW broadcast multiplication expects ArithmeticGMW wires");
+  }
+  const auto num_groups = in_a[0]->get_num_simd();
+  const auto num_simd = in_b[0]->get_num_simd();
+  if (num_groups == 0 || num_simd % num_groups != 0) {
+    throw std::logic_error(
+        fmt::format("broadcast multiplication of {} with {} SIMD values", num_groups, num_simd));
+  }
+  return make_arithmetic_binary_gate<ArithmeticGMWBroadcastMULGate>(in_a, in_b);
+}
+
 WireVector GMWProvider::make_sqr_gate(const WireVector& in) {
   return make_arithmetic_unary_gate<ArithmeticGMWSQRGate>(in);
 }
@@ -660,50 +691,55 @@ WireVector GMWProvider::convert(MPCProtocol dst_proto, const WireVector &in) {
 
 template <typename T>
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, tensor::TensorCP>
-GMWProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions& dims) {
+GMWProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                   std::size_t fractional_bits) {
   ENCRYPTO::ReusableFiberPromise<std::vector<T>> promise;
   auto gate_id = gate_register_.get_next_gate_id();
   auto tensor_op = std::make_unique<ArithmeticGMWTensorInputSender<T>>(gate_id, *this, dims,
                                                                        promise.get_future());
   auto output = tensor_op->get_output_tensor();
+  output->set_fractional_bits(fractional_bits);
   gate_register_.register_gate(std::move(tensor_op));
   return {std::move(promise), std::dynamic_pointer_cast<const tensor::Tensor>(output)};
 }
 
 template std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-GMWProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&);
+GMWProvider::basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&, std::size_t);
 
 template <typename T>
 tensor::TensorCP GMWProvider::basic_make_arithmetic_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
   auto gate_id = gate_register_.get_next_gate_id();
   auto tensor_op = std::make_unique<ArithmeticGMWTensorInputReceiver<T>>(gate_id, *this, dims);
   auto output = tensor_op->get_output_tensor();
+  output->set_fractional_bits(fractional_bits);
   gate_register_.register_gate(std::move(tensor_op));
   return std::dynamic_pointer_cast<const tensor::Tensor>(output);
 }
 
 template tensor::TensorCP GMWProvider::basic_make_arithmetic_tensor_input_other<std::uint64_t>(
-    const tensor::TensorDimensions&);
+    const tensor::TensorDimensions&, std::size_t);
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, tensor::TensorCP>
-GMWProvider::make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_my<std::uint32_t>(dims);
+GMWProvider::make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_my<std::uint32_t>(dims, fractional_bits);
 }
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-GMWProvider::make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_my<std::uint64_t>(dims);
+GMWProvider::make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions& dims,
+                                                std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_my<std::uint64_t>(dims, fractional_bits);
 }
 
 tensor::TensorCP GMWProvider::make_arithmetic_32_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_other<std::uint32_t>(dims);
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_other<std::uint32_t>(dims, fractional_bits);
 }
 
 tensor::TensorCP GMWProvider::make_arithmetic_64_tensor_input_other(
-    const tensor::TensorDimensions& dims) {
-  return basic_make_arithmetic_tensor_input_other<std::uint64_t>(dims);
+    const tensor::TensorDimensions& dims, std::size_t fractional_bits) {
+  return basic_make_arithmetic_tensor_input_other<std::uint64_t>(dims, fractional_bits);
 }
 
 template <typename T>
@@ -898,6 +934,65 @@ tensor::TensorCP GMWProvider::make_tensor_gemm_op(const tensor::GemmOp& gemm_op,
   return output;
 }
 
+tensor::TensorCP GMWProvider::make_tensor_sparse_gemm_op(const tensor::GemmOp& gemm_op,
+                                                         const tensor::TensorCP input_A,
+                                                         const CSRMatrix<std::uint64_t>& weights,
+                                                         std::size_t weights_owner,
+                                                         std::size_t weights_fractional_bits,
+                                                         std::size_t fractional_bits) {
+  if (!gemm_op.verify() || gemm_op.transA_ || gemm_op.transB_) {
+    throw std::invalid_argument("invalid GemmOp");
+  }
+  if (input_A->get_dimensions() != gemm_op.get_input_A_tensor_dims()) {
+    throw std::invalid_argument("invalid input_A dimensions");
+  }
+  if (!weights.verify() || weights.rows_ != gemm_op.input_B_shape_[0] ||
+      weights.cols_ != gemm_op.input_B_shape_[1]) {
+    throw std::invalid_argument("invalid sparsity pattern of the weights");
+  }
+  if (weights_owner > 1) {
+    throw std::invalid_argument("invalid owner of the weights");
+  }
+  const bool is_weights_owner = weights_owner == get_my_id();
+  if (is_weights_owner && weights.values_.size() != weights.get_num_nonzeros()) {
+    throw std::invalid_argument("weights have unexpected number of values");
+  }
+  auto bit_size = input_A->get_bit_size();
+  std::unique_ptr<NewGate> gate;
+  auto gate_id = gate_register_.get_next_gate_id();
+  tensor::TensorCP output;
+  const auto make_op = [this, input_A, gemm_op, &weights, weights_owner, weights_fractional_bits,
+                        fractional_bits, is_weights_owner, gate_id, &output](auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    // the values are reduced modulo 2^bit_size
+    CSRMatrix<T> weights_T{.rows_ = weights.rows_,
+                           .cols_ = weights.cols_,
+                           .row_ptr_ = weights.row_ptr_,
+                           .col_idx_ = weights.col_idx_,
+                           .values_ = {}};
+    if (is_weights_owner) {
+      weights_T.values_.assign(std::begin(weights.values_), std::end(weights.values_));
+    }
+    auto tensor_op = std::make_unique<ArithmeticGMWTensorSparseGemm<T>>(
+        gate_id, *this, gemm_op, std::dynamic_pointer_cast<const ArithmeticGMWTensor<T>>(input_A),
+        std::move(weights_T), weights_owner, weights_fractional_bits, fractional_bits);
+    output = tensor_op->get_output_tensor();
+    return tensor_op;
+  };
+  switch (bit_size) {
+    case 32:
+      gate = make_op(std::uint32_t{});
+      break;
+    case 64:
+      gate = make_op(std::uint64_t{});
+      break;
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
 tensor::TensorCP GMWProvider::make_tensor_sqr_op(const tensor::TensorCP input,
                                                  std::size_t fractional_bits) {
   auto bit_size = input->get_bit_size();
@@ -956,6 +1051,51 @@ tensor::TensorCP GMWProvider::make_tensor_avgpool_op(const tensor::AveragePoolOp
   return output;
 }
 
+tensor::TensorCP GMWProvider::make_tensor_truncation_op(const tensor::TensorCP input,
+                                                        std::size_t truncate_bits) {
+  auto bit_size = input->get_bit_size();
+  std::unique_ptr<NewGate> gate;
+  auto gate_id = gate_register_.get_next_gate_id();
+  tensor::TensorCP output;
+  const auto make_op = [this, input, truncate_bits, gate_id, &output](auto dummy_arg) {
+    using T = decltype(dummy_arg);
+    auto tensor_op = std::make_unique<ArithmeticGMWTensorTruncation<T>>(
+        gate_id, *this, std::dynamic_pointer_cast<const ArithmeticGMWTensor<T>>(input),
+        truncate_bits);
+    output = tensor_op->get_output_tensor();
+    return tensor_op;
+  };
+  switch (bit_size) {
+    case 32:
+      gate = make_op(std::uint32_t{});
+      break;
+    case 64:
+      gate = make_op(std::uint64_t{});
+      break;
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+  gate_register_.register_gate(std::move(gate));
+  return output;
+}
+
+tensor::TensorCP GMWProvider::make_tensor_ring_reduction(const tensor::TensorCP input,
+                                                         std::size_t bit_size) {
+  if (input->get_bit_size() != 64 || bit_size != 32) {
+    throw std::invalid_argument(fmt::format("GMWProvider: cannot reduce {} bit tensor to {} bits",
+                                            input->get_bit_size(), bit_size));
+  }
+  const auto input_tensor =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<std::uint64_t>>(input);
+  assert(input_tensor != nullptr);
+  auto gate_id = gate_register_.get_next_gate_id();
+  auto tensor_op =
+      std::make_unique<ArithmeticGMWTensorRingReduction>(gate_id, *this, input_tensor);
+  auto output = tensor_op->get_output_tensor();
+  gate_register_.register_gate(std::move(tensor_op));
+  return output;
+}
+
 tensor::TensorCP GMWProvider::make_tensor_relu_op(const tensor::TensorCP in) {
   const auto input_tensor = std::dynamic_pointer_cast<const BooleanGMWTensor>(in);
   assert(input_tensor != nullptr);
@@ -987,8 +1127,8 @@ tensor::TensorCP GMWProvider::make_tensor_relu_op(const tensor::TensorCP in_bool
       in_arith->get_protocol() != MPCProtocol::ArithmeticGMW) {
     throw std::invalid_argument("expected Boolean and arithmetic GMW, respectively");
   }
-  const auto bit_size = in_bool->get_bit_size();
-  if (bit_size != in_arith->get_bit_size()) {
+  const auto bit_size = in_arith->get_bit_size();
+  if (in_bool->get_bit_size() != bit_size && in_bool->get_bit_size() != 1) {
     throw std::invalid_argument("bit size mismatch");
   }
   switch (bit_size) {
@@ -104,7 +104,8 @@ class GMWProvider : public GateFactory,
   std::size_t get_my_id() const noexcept { return my_id_; }
   std::size_t get_num_parties() const noexcept { return num_parties_; }
 
-  std::size_t get_next_input_id(std::size_t num_inputs) noexcept;
+  // within a ConstructionScope, the ids are taken from the block of the calling thread
+  std::size_t get_next_input_id(std::size_t num_inputs);
 
   // Implementation of GateFactors interface
 
@@ -156,6 +157,8 @@ class GMWProvider : public GateFactory,
   WireVector make_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector&,
                               const WireVector&) override;
 
+  WireVector make_broadcast_mul_gate(const WireVector& in_a, const WireVector& in_b) override;
+
   std::pair<NewGateP, WireVector> construct_unary_gate(ENCRYPTO::PrimitiveOperationType op,
                                                        const WireVector&);
 
@@ -171,12 +174,16 @@ class GMWProvider : public GateFactory,
 
   // implementation of TensorOpFactory
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, tensor::TensorCP>
-  make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions&) override;
+  make_arithmetic_32_tensor_input_my(const tensor::TensorDimensions&,
+                                     std::size_t fractional_bits = 0) override;
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, tensor::TensorCP>
-  make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions&) override;
+  make_arithmetic_64_tensor_input_my(const tensor::TensorDimensions&,
+                                     std::size_t fractional_bits = 0) override;
 
-  tensor::TensorCP make_arithmetic_32_tensor_input_other(const tensor::TensorDimensions&) override;
-  tensor::TensorCP make_arithmetic_64_tensor_input_other(const tensor::TensorDimensions&) override;
+  tensor::TensorCP make_arithmetic_32_tensor_input_other(const tensor::TensorDimensions&,
+                                                         std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_arithmetic_64_tensor_input_other(const tensor::TensorDimensions&,
+                                                         std::size_t fractional_bits = 0) override;
 
   // arithmetic outputs
   ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint32_t>> make_arithmetic_32_tensor_output_my(
@@ -200,6 +207,12 @@ class GMWProvider : public GateFactory,
                                        const tensor::TensorCP input_A,
                                        const tensor::TensorCP input_B,
                                        std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_tensor_sparse_gemm_op(const tensor::GemmOp& gemm_op,
+                                              const tensor::TensorCP input_A,
+                                              const CSRMatrix<std::uint64_t>& weights,
+                                              std::size_t weights_owner,
+                                              std::size_t weights_fractional_bits,
+                                              std::size_t fractional_bits = 0) override;
   tensor::TensorCP make_tensor_sqr_op(const tensor::TensorCP input,
                                       std::size_t fractional_bits = 0) override;
   tensor::TensorCP make_tensor_relu_op(const tensor::TensorCP) override;
@@ -210,6 +223,10 @@ class GMWProvider : public GateFactory,
                                           const tensor::TensorCP) override;
   tensor::TensorCP make_tensor_avgpool_op(const tensor::AveragePoolOp&, const tensor::TensorCP,
                                           std::size_t fractional_bits = 0) override;
+  tensor::TensorCP make_tensor_truncation_op(const tensor::TensorCP input,
+                                             std::size_t truncate_bits) override;
+  tensor::TensorCP make_tensor_ring_reduction(const tensor::TensorCP input,
+                                              std::size_t bit_size) override;
   template <typename T>
   tensor::TensorCP basic_make_convert_boolean_to_arithmetic_gmw_tensor(const tensor::TensorCP);
   tensor::TensorCP make_convert_boolean_to_arithmetic_gmw_tensor(const tensor::TensorCP);
@@ -254,9 +271,11 @@ class GMWProvider : public GateFactory,
   // tensor stuff
   template <typename T>
   std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<T>>, tensor::TensorCP>
-  basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&);
+  basic_make_arithmetic_tensor_input_my(const tensor::TensorDimensions&,
+                                        std::size_t fractional_bits);
   template <typename T>
-  tensor::TensorCP basic_make_arithmetic_tensor_input_other(const tensor::TensorDimensions&);
+  tensor::TensorCP basic_make_arithmetic_tensor_input_other(const tensor::TensorDimensions&,
+                                                            std::size_t fractional_bits);
   template <typename T>
   ENCRYPTO::ReusableFiberFuture<IntegerValues<T>> basic_make_arithmetic_tensor_output_my(
       const tensor::TensorCP&);
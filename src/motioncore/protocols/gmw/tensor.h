@@ -22,6 +22,10 @@
 
 #pragma once
 
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 #include "tensor/tensor.h"
 #include "utility/bit_vector.h"
 #include "utility/enable_wait.h"
@@ -33,15 +37,25 @@ namespace MOTION::proto::gmw {
 template <typename T>
 class ArithmeticGMWTensor : public tensor::Tensor {
  public:
-  using Tensor::Tensor;
+  ArithmeticGMWTensor(const tensor::TensorDimensions& dims)
+      : Tensor(dims), data_(std::make_shared<std::vector<T>>()) {}
+  // View of the share of another tensor with the same number of elements, e.g., for a reshape.
+  // The buffer is shared, so the values become valid once the other tensor is ready.
+  ArithmeticGMWTensor(const tensor::TensorDimensions& dims, const ArithmeticGMWTensor& other)
+      : Tensor(dims), data_(other.data_) {
+    if (dims.get_data_size() != other.get_dimensions().get_data_size()) {
+      throw std::invalid_argument("view needs to have the same number of elements");
+    }
+  }
   MPCProtocol get_protocol() const noexcept override { return MPCProtocol::ArithmeticGMW; }
   std::size_t get_bit_size() const noexcept override { return ENCRYPTO::bit_size_v<T>; }
-  std::vector<T>& get_share() noexcept { return data_; }
-  const std::vector<T>& get_share() const noexcept { return data_; }
+  std::vector<T>& get_share() noexcept { return *data_; }
+  const std::vector<T>& get_share() const noexcept { return *data_; }
+  void release_buffers() override { data_ = std::make_shared<std::vector<T>>(); }
 
  private:
   using is_enabled_ = ENCRYPTO::is_unsigned_int_t<T>;
-  std::vector<T> data_;
+  std::shared_ptr<std::vector<T>> data_;
 };
 
 template <typename T>
@@ -63,6 +77,7 @@ class BooleanGMWTensor : public tensor::Tensor {
   std::size_t get_bit_size() const noexcept override { return bit_size_; }
   std::vector<ENCRYPTO::BitVector<>>& get_share() noexcept { return data_; }
   const std::vector<ENCRYPTO::BitVector<>>& get_share() const noexcept { return data_; }
+  void release_buffers() override { data_ = std::vector<ENCRYPTO::BitVector<>>(bit_size_); }
 
  private:
   std::size_t bit_size_;
@@ -30,6 +30,7 @@
 
 #include "algorithm/circuit_loader.h"
 #include "algorithm/make_circuit.h"
+#include "crypto/arithmetic_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/multiplication_triple/linalg_triple_provider.h"
 #include "crypto/multiplication_triple/sb_provider.h"
@@ -39,6 +40,7 @@
 #include "crypto/sharing_randomness_generator.h"
 #include "executor/execution_context.h"
 #include "gmw_provider.h"
+#include "protocols/common/tensor_kernels.h"
 #include "utility/bit_vector.h"
 #include "utility/constants.h"
 #include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
@@ -249,7 +251,9 @@ ArithmeticGMWTensorFlatten<T>::ArithmeticGMWTensorFlatten(std::size_t gate_id,
                                                           const ArithmeticGMWTensorCP<T> input)
     : NewGate(gate_id), gmw_provider_(gmw_provider), input_(input) {
   const auto& input_dims = input_->get_dimensions();
-  output_ = std::make_shared<ArithmeticGMWTensor<T>>(flatten(input_dims, axis));
+  // the output is a view of the input share, so flattening copies nothing
+  output_ = std::make_shared<ArithmeticGMWTensor<T>>(flatten(input_dims, axis), *input_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
@@ -270,7 +274,6 @@ void ArithmeticGMWTensorFlatten<T>::evaluate_online() {
   }
 
   input_->wait_online();
-  output_->get_share() = input_->get_share();
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -303,6 +306,8 @@ ArithmeticGMWTensorConv2D<T>::ArithmeticGMWTensorConv2D(
       share_future_(gmw_provider_.register_for_ints_message<T>(
           1 - gmw_provider.get_my_id(), gate_id_,
           conv_op.compute_input_size() + conv_op.compute_kernel_size())) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_, *kernel_, fractional_bits_));
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
@@ -310,10 +315,30 @@ ArithmeticGMWTensorConv2D<T>::ArithmeticGMWTensorConv2D(
       logger->LogTrace(fmt::format("Gate {}: ArithmeticGMWTensorConv2D<T> created", gate_id_));
     }
   }
+  if constexpr (MOTION_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      const auto memory = get_convolution_memory(conv_op_, sizeof(T));
+      logger->LogDebug(
+          fmt::format("Gate {}: ArithmeticGMWTensorConv2D<T> local convolutions use at most {} "
+                      "bytes, an im2col matrix of the input would need {} bytes",
+                      gate_id_, memory.peak_bytes, memory.im2col_bytes));
+    }
+  }
 }
 
 template <typename T>
 void ArithmeticGMWTensorConv2D<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticGMWTensorConv2D<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticGMWTensorConv2D<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
     if (logger) {
@@ -321,6 +346,7 @@ void ArithmeticGMWTensorConv2D<T>::evaluate_online() {
           fmt::format("Gate {}: ArithmeticGMWTensorConv2D<T>::evaluate_online start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   auto& ltp = gmw_provider_.get_linalg_triple_provider();
   auto triple = ltp.get_conv2d_triple<T>(conv_op_, triple_index_);
@@ -353,17 +379,14 @@ void ArithmeticGMWTensorConv2D<T>::evaluate_online() {
   std::vector<T> tmp(result.size());
   // ... - d * e ...
   if (gmw_provider_.is_my_job(gate_id_)) {
-    convolution(conv_op_, de.data(), de.data() + input_size, tmp.data());
-    __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                              std::begin(result), std::minus{});
+    kernels.convolution(conv_op_, de.data(), de.data() + input_size, tmp.data());
+    kernels.transform(result, tmp, std::minus{});
   }
   // ... + e * x + d * y
-  convolution(conv_op_, input_buffer.data(), de.data() + input_size, tmp.data());
-  __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                            std::begin(result), std::plus{});
-  convolution(conv_op_, de.data(), kernel_buffer.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                            std::begin(result), std::plus{});
+  kernels.convolution(conv_op_, input_buffer.data(), de.data() + input_size, tmp.data());
+  kernels.transform(result, tmp, std::plus{});
+  kernels.convolution(conv_op_, de.data(), kernel_buffer.data(), tmp.data());
+  kernels.transform(result, tmp, std::plus{});
   if (fractional_bits_ > 0) {
     fixed_point::truncate_shared<T>(result.data(), fractional_bits_, result.size(),
                                     gmw_provider_.is_my_job(gate_id_));
@@ -400,6 +423,8 @@ ArithmeticGMWTensorGemm<T>::ArithmeticGMWTensorGemm(std::size_t gate_id, GMWProv
       share_future_(gmw_provider_.register_for_ints_message<T>(
           1 - gmw_provider.get_my_id(), gate_id_,
           gemm_op.compute_input_A_size() + gemm_op.compute_input_B_size())) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_A_, *input_B_, fractional_bits_));
   assert(input_A_->get_dimensions() == gemm_op.get_input_A_tensor_dims());
   assert(input_B_->get_dimensions() == gemm_op.get_input_B_tensor_dims());
   assert(gemm_op.verify());
@@ -414,6 +439,16 @@ ArithmeticGMWTensorGemm<T>::ArithmeticGMWTensorGemm(std::size_t gate_id, GMWProv
 
 template <typename T>
 void ArithmeticGMWTensorGemm<T>::evaluate_online() {
+  evaluate_online_impl(nullptr);
+}
+
+template <typename T>
+void ArithmeticGMWTensorGemm<T>::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+template <typename T>
+void ArithmeticGMWTensorGemm<T>::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
     if (logger) {
@@ -421,6 +456,7 @@ void ArithmeticGMWTensorGemm<T>::evaluate_online() {
           fmt::format("Gate {}: ArithmeticGMWTensorGemm<T>::evaluate_online start", gate_id_));
     }
   }
+  const TensorKernels kernels{exec_ctx};
 
   auto& ltp = gmw_provider_.get_linalg_triple_provider();
   auto triple = ltp.get_gemm_triple<T>(gemm_op_, triple_index_);
@@ -454,17 +490,14 @@ void ArithmeticGMWTensorGemm<T>::evaluate_online() {
 
   // ... - d * e ...
   if (gmw_provider_.is_my_job(gate_id_)) {
-    matrix_multiply(gemm_op_, de.data(), de.data() + input_A_size, tmp.data());
-    __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                              std::begin(result), std::minus{});
+    kernels.matrix_multiply(gemm_op_, de.data(), de.data() + input_A_size, tmp.data());
+    kernels.transform(result, tmp, std::minus{});
   }
   // ... + e * x + d * y
-  matrix_multiply(gemm_op_, input_A_buffer.data(), de.data() + input_A_size, tmp.data());
-  __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                            std::begin(result), std::plus{});
-  matrix_multiply(gemm_op_, de.data(), input_B_buffer.data(), tmp.data());
-  __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(tmp),
-                            std::begin(result), std::plus{});
+  kernels.matrix_multiply(gemm_op_, input_A_buffer.data(), de.data() + input_A_size, tmp.data());
+  kernels.transform(result, tmp, std::plus{});
+  kernels.matrix_multiply(gemm_op_, de.data(), input_B_buffer.data(), tmp.data());
+  kernels.transform(result, tmp, std::plus{});
   if (fractional_bits_ > 0) {
     fixed_point::truncate_shared<T>(result.data(), fractional_bits_, result.size(),
                                     gmw_provider_.is_my_job(gate_id_));
@@ -484,6 +517,133 @@ void ArithmeticGMWTensorGemm<T>::evaluate_online() {
 template class ArithmeticGMWTensorGemm<std::uint32_t>;
 template class ArithmeticGMWTensorGemm<std::uint64_t>;
 
+template <typename T>
+ArithmeticGMWTensorSparseGemm<T>::ArithmeticGMWTensorSparseGemm(
+    std::size_t gate_id, GMWProvider& gmw_provider, tensor::GemmOp gemm_op,
+    const ArithmeticGMWTensorCP<T> input_A, CSRMatrix<T> weights, std::size_t weights_owner,
+    std::size_t weights_fractional_bits, std::size_t fractional_bits)
+    : NewGate(gate_id),
+      gmw_provider_(gmw_provider),
+      gemm_op_(gemm_op),
+      fractional_bits_(fractional_bits),
+      input_A_(input_A),
+      weights_(std::move(weights)),
+      weights_owner_(weights_owner),
+      output_(std::make_shared<ArithmeticGMWTensor<T>>(gemm_op.get_output_tensor_dims())) {
+  output_->set_fractional_bits(tensor::truncated_fractional_bits(
+      input_A_->get_fractional_bits() + weights_fractional_bits, fractional_bits_));
+  assert(input_A_->get_dimensions() == gemm_op.get_input_A_tensor_dims());
+  const auto my_id = gmw_provider_.get_my_id();
+  auto& ap = gmw_provider_.get_arith_manager().get_provider(1 - my_id);
+  const auto dim_l = gemm_op_.input_A_shape_[0];
+  if (my_id == weights_owner_) {
+    share_future_ = gmw_provider_.register_for_ints_message<T>(1 - my_id, gate_id_,
+                                                               gemm_op.compute_input_A_size());
+    mm_sparse_side_ =
+        ap.template register_sparse_matrix_multiplication_sparse_side<T>(dim_l, weights_);
+  } else {
+    mm_dense_side_ =
+        ap.template register_sparse_matrix_multiplication_dense_side<T>(dim_l, weights_);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format("Gate {}: ArithmeticGMWTensorSparseGemm<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+ArithmeticGMWTensorSparseGemm<T>::~ArithmeticGMWTensorSparseGemm() = default;
+
+// The setup phase generates a triple for the product with the fixed matrix B: the other party n
+// chooses a random mask R and the parties get shares of R * B.  In the online phase, n sends
+// D = [A]_n - R to the owner o of B, s.t. A * B = ([A]_o + D) * B + [R * B]_o + [R * B]_n.
+template <typename T>
+void ArithmeticGMWTensorSparseGemm<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticGMWTensorSparseGemm<T>::evaluate_setup start", gate_id_));
+    }
+  }
+
+  if (mm_sparse_side_) {
+    mm_sparse_side_->set_input(weights_.values_);
+    mm_sparse_side_->compute_output();
+    mask_product_share_ = mm_sparse_side_->get_output();
+    mm_sparse_side_->clear();
+  } else {
+    mask_ = Helpers::RandomVector<T>(gemm_op_.compute_input_A_size());
+    mm_dense_side_->set_input(mask_);
+    mm_dense_side_->compute_output();
+    mask_product_share_ = mm_dense_side_->get_output();
+    mm_dense_side_->clear();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticGMWTensorSparseGemm<T>::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticGMWTensorSparseGemm<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticGMWTensorSparseGemm<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  input_A_->wait_online();
+  const auto& input_A_buffer = input_A_->get_share();
+  assert(input_A_buffer.size() == gemm_op_.compute_input_A_size());
+  const bool is_weights_owner = gmw_provider_.get_my_id() == weights_owner_;
+
+  std::vector<T> result(std::move(mask_product_share_));
+  if (is_weights_owner) {
+    // [A]_o + D
+    auto masked_input = share_future_.get();
+    __gnu_parallel::transform(std::begin(masked_input), std::end(masked_input),
+                              std::begin(input_A_buffer), std::begin(masked_input), std::plus{});
+    // [A * B]_o = ([A]_o + D) * B + [R * B]_o
+    std::vector<T> product(result.size());
+    matrix_multiply(gemm_op_.input_A_shape_[0], masked_input.data(), weights_, product.data());
+    __gnu_parallel::transform(std::begin(result), std::end(result), std::begin(product),
+                              std::begin(result), std::plus{});
+  } else {
+    // D = [A]_n - R, and [A * B]_n = [R * B]_n
+    __gnu_parallel::transform(std::begin(input_A_buffer), std::end(input_A_buffer),
+                              std::begin(mask_), std::begin(mask_), std::minus{});
+    gmw_provider_.send_ints_message(weights_owner_, gate_id_, mask_);
+    mask_ = {};
+  }
+  if (fractional_bits_ > 0) {
+    fixed_point::truncate_shared<T>(result.data(), fractional_bits_, result.size(),
+                                    is_weights_owner);
+  }
+  output_->get_share() = std::move(result);
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticGMWTensorSparseGemm<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticGMWTensorSparseGemm<std::uint32_t>;
+template class ArithmeticGMWTensorSparseGemm<std::uint64_t>;
+
 template <typename T>
 ArithmeticGMWTensorSqr<T>::ArithmeticGMWTensorSqr(std::size_t gate_id, GMWProvider& gmw_provider,
                                                   const ArithmeticGMWTensorCP<T> input,
@@ -497,6 +657,8 @@ ArithmeticGMWTensorSqr<T>::ArithmeticGMWTensorSqr(std::size_t gate_id, GMWProvid
       triple_index_(gmw_provider.get_sp_provider().RequestSPs<T>(data_size_)),
       share_future_(gmw_provider_.register_for_ints_message<T>(1 - gmw_provider.get_my_id(),
                                                                gate_id_, data_size_)) {
+  output_->set_fractional_bits(
+      tensor::product_fractional_bits(*input_, *input_, fractional_bits_));
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
     if (logger) {
@@ -580,15 +742,19 @@ ArithmeticGMWTensorAveragePool<T>::ArithmeticGMWTensorAveragePool(
       fractional_bits_(fractional_bits),
       input_(input),
       output_(std::make_shared<ArithmeticGMWTensor<T>>(avgpool_op_.get_output_tensor_dims())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if (!avgpool_op_.verify()) {
     throw std::invalid_argument("invalid AveragePoolOp");
   }
-  auto kernel_size = avgpool_op_.compute_kernel_size();
-  if (kernel_size > (T(1) << fractional_bits_)) {
-    throw std::invalid_argument(
-        "ArithmeticGMWTensorAveragePool: not enough fractional bits to represent factor");
+  // fractional_bits == 0: only sum the windows, the division is left to the next gate
+  if (fractional_bits_ > 0) {
+    auto kernel_size = avgpool_op_.compute_kernel_size();
+    if (kernel_size > (T(1) << fractional_bits_)) {
+      throw std::invalid_argument(
+          "ArithmeticGMWTensorAveragePool: not enough fractional bits to represent factor");
+    }
+    factor_ = fixed_point::encode<T>(1.0 / kernel_size, fractional_bits_);
   }
-  factor_ = fixed_point::encode<T>(1.0 / kernel_size, fractional_bits_);
   output_->get_share().resize(avgpool_op_.compute_output_size());
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -611,11 +777,13 @@ void ArithmeticGMWTensorAveragePool<T>::evaluate_online() {
 
   input_->wait_online();
   sum_pool(avgpool_op_, input_->get_share().data(), output_->get_share().data());
-  __gnu_parallel::transform(std::begin(output_->get_share()), std::end(output_->get_share()),
-                            std::begin(output_->get_share()),
-                            [this](auto x) { return x * factor_; });
-  fixed_point::truncate_shared(output_->get_share().data(), fractional_bits_,
-                               output_->get_share().size(), gmw_provider_.is_my_job(gate_id_));
+  if (fractional_bits_ > 0) {
+    __gnu_parallel::transform(std::begin(output_->get_share()), std::end(output_->get_share()),
+                              std::begin(output_->get_share()),
+                              [this](auto x) { return x * factor_; });
+    fixed_point::truncate_shared(output_->get_share().data(), fractional_bits_,
+                                 output_->get_share().size(), gmw_provider_.is_my_job(gate_id_));
+  }
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -630,6 +798,84 @@ void ArithmeticGMWTensorAveragePool<T>::evaluate_online() {
 template class ArithmeticGMWTensorAveragePool<std::uint32_t>;
 template class ArithmeticGMWTensorAveragePool<std::uint64_t>;
 
+template <typename T>
+ArithmeticGMWTensorTruncation<T>::ArithmeticGMWTensorTruncation(
+    std::size_t gate_id, GMWProvider& gmw_provider, const ArithmeticGMWTensorCP<T> input,
+    std::size_t truncate_bits)
+    : NewGate(gate_id),
+      gmw_provider_(gmw_provider),
+      truncate_bits_(truncate_bits),
+      input_(input),
+      output_(std::make_shared<ArithmeticGMWTensor<T>>(input_->get_dimensions())) {
+  if (truncate_bits_ >= ENCRYPTO::bit_size_v<T>) {
+    throw std::invalid_argument(
+        fmt::format("ArithmeticGMWTensorTruncation: cannot truncate {} bits of {} bit values",
+                    truncate_bits_, ENCRYPTO::bit_size_v<T>));
+  }
+  output_->set_fractional_bits(
+      tensor::truncated_fractional_bits(input_->get_fractional_bits(), truncate_bits_));
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format("Gate {}: ArithmeticGMWTensorTruncation<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticGMWTensorTruncation<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticGMWTensorTruncation<T>::evaluate_online start", gate_id_));
+    }
+  }
+
+  input_->wait_online();
+  output_->get_share() = input_->get_share();
+  fixed_point::truncate_shared(output_->get_share().data(), truncate_bits_,
+                               output_->get_share().size(), gmw_provider_.is_my_job(gate_id_));
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticGMWTensorTruncation<T>::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticGMWTensorTruncation<std::uint32_t>;
+template class ArithmeticGMWTensorTruncation<std::uint64_t>;
+
+ArithmeticGMWTensorRingReduction::ArithmeticGMWTensorRingReduction(
+    std::size_t gate_id, GMWProvider& gmw_provider,
+    const ArithmeticGMWTensorCP<std::uint64_t> input)
+    : NewGate(gate_id),
+      gmw_provider_(gmw_provider),
+      input_(input),
+      output_(std::make_shared<ArithmeticGMWTensor<std::uint32_t>>(input_->get_dimensions())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format("Gate {}: ArithmeticGMWTensorRingReduction created", gate_id_));
+    }
+  }
+}
+
+void ArithmeticGMWTensorRingReduction::evaluate_online() {
+  input_->wait_online();
+  const auto& share = input_->get_share();
+  output_->get_share().resize(share.size());
+  std::copy(std::begin(share), std::end(share), std::begin(output_->get_share()));
+  output_->set_online_ready();
+}
+
 template <typename T>
 BooleanToArithmeticGMWTensorConversion<T>::BooleanToArithmeticGMWTensorConversion(
     std::size_t gate_id, GMWProvider& gmw_provider, const BooleanGMWTensorCP input)
@@ -638,6 +884,7 @@ BooleanToArithmeticGMWTensorConversion<T>::BooleanToArithmeticGMWTensorConversio
       data_size_(input->get_dimensions().get_data_size()),
       input_(std::move(input)),
       output_(std::make_shared<ArithmeticGMWTensor<T>>(input_->get_dimensions())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   const auto my_id = gmw_provider_.get_my_id();
   auto& sb_provider = gmw_provider_.get_sb_provider();
   sb_offset_ = sb_provider.RequestSBs<T>(bit_size_ * data_size_);
@@ -736,6 +983,7 @@ BooleanGMWTensorRelu::BooleanGMWTensorRelu(std::size_t gate_id, GMWProvider& gmw
       output_(std::make_shared<BooleanGMWTensor>(input_->get_dimensions(), bit_size_)),
       triple_index_(gmw_provider_.get_linalg_triple_provider().register_for_relu_triple(
           data_size_, bit_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   const auto my_id = gmw_provider_.get_my_id();
   share_future_ =
       gmw_provider_.register_for_bits_message(1 - my_id, gate_id_, data_size_ * bit_size_);
@@ -841,10 +1089,13 @@ BooleanXArithmeticGMWTensorRelu<T>::BooleanXArithmeticGMWTensorRelu(
       input_bool_(std::move(input_bool)),
       input_arith_(std::move(input_arith)),
       output_(std::make_shared<ArithmeticGMWTensor<T>>(input_arith_->get_dimensions())) {
+  output_->set_fractional_bits(input_arith_->get_fractional_bits());
   if (input_bool_->get_dimensions() != input_arith_->get_dimensions()) {
     throw std::invalid_argument("dimension mismatch");
   }
-  if (input_bool_->get_bit_size() != input_arith_->get_bit_size()) {
+  // the Boolean input holds either all bits or only the most significant bits
+  if (input_bool_->get_bit_size() != input_arith_->get_bit_size() &&
+      input_bool_->get_bit_size() != 1) {
     throw std::invalid_argument("bit size mismatch");
   }
   const auto my_id = gmw_provider_.get_my_id();
@@ -877,7 +1128,7 @@ void BooleanXArithmeticGMWTensorRelu<T>::evaluate_online() {
   input_bool_->wait_online();
   input_arith_->wait_online();
   const auto& ashare = input_arith_->get_share();
-  auto inv_msb_share = input_bool_->get_share()[bit_size_ - 1];
+  auto inv_msb_share = input_bool_->get_share().back();
   auto& out_share = output_->get_share();
 
   if (gmw_provider_.is_my_job(gate_id_)) {
@@ -935,31 +1186,42 @@ BooleanGMWTensorMaxPool::BooleanGMWTensorMaxPool(std::size_t gate_id, GMWProvide
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
       output_(std::make_shared<BooleanGMWTensor>(maxpool_op_.get_output_tensor_dims(), bit_size_)),
-      // XXX: use depth-optimized circuit here
-      maxpool_algo_(gmw_provider_.get_circuit_loader().load_maxpool_circuit(
-          bit_size_, maxpool_op_.compute_kernel_size(), true)) {
+      // depth-optimized unless the cost model of the network prefers the size-optimized one
+      gtmux_algo_(gmw_provider_.get_circuit_loader().load_gtmux_circuit(
+          bit_size_, gmw_provider_.get_circuit_loader().select_depth_optimized(
+                         fmt::format("int_gt{}", bit_size_), maxpool_op_.compute_output_size(),
+                         true))),
+      schedule_(maxpool_op_.compute_kernel_size()) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if (!maxpool_op_.verify()) {
     throw std::invalid_argument("invalid MaxPoolOp");
   }
   const auto kernel_size = maxpool_op_.compute_kernel_size();
   const auto output_size = maxpool_op_.compute_output_size();
-  input_wires_.resize(bit_size_ * kernel_size);
-  std::generate(std::begin(input_wires_), std::end(input_wires_), [output_size] {
-    auto w = std::make_shared<BooleanGMWWire>(output_size);
-    w->get_share().Resize(output_size);
-    return w;
-  });
-  {
-    WireVector in(bit_size_ * kernel_size);
-    std::transform(std::begin(input_wires_), std::end(input_wires_), std::begin(in),
-                   [](auto w) { return std::dynamic_pointer_cast<BooleanGMWWire>(w); });
-    auto [gates, out] = construct_circuit(gmw_provider_, maxpool_algo_, in);
-    gates_ = std::move(gates);
+  if (kernel_size < 2) {
+    throw std::logic_error("need at least two inputs to combine");
+  }
+  kernel_shares_.resize(bit_size_ * kernel_size, ENCRYPTO::BitVector<>(output_size));
+  layers_.resize(schedule_.get_num_layers());
+  for (std::size_t layer_i = 0; layer_i < layers_.size(); ++layer_i) {
+    auto& layer = layers_.at(layer_i);
+    const auto num_simd = schedule_.get_layer_size(layer_i) * output_size;
+    layer.input_wires.resize(2 * bit_size_);
+    std::generate(std::begin(layer.input_wires), std::end(layer.input_wires), [num_simd] {
+      auto w = std::make_shared<BooleanGMWWire>(num_simd);
+      w->get_share().Resize(num_simd);
+      return w;
+    });
+    WireVector in_a(std::begin(layer.input_wires), std::begin(layer.input_wires) + bit_size_);
+    WireVector in_b(std::begin(layer.input_wires) + bit_size_, std::end(layer.input_wires));
+    auto [gates, out] = construct_circuit(gmw_provider_, gtmux_algo_, in_a, in_b);
+    layer.gates = std::move(gates);
     assert(out.size() == bit_size_);
-    output_wires_.resize(bit_size_);
-    std::transform(std::begin(out), std::end(out), std::begin(output_wires_),
+    layer.output_wires.resize(bit_size_);
+    std::transform(std::begin(out), std::end(out), std::begin(layer.output_wires),
                    [](auto w) { return std::dynamic_pointer_cast<BooleanGMWWire>(w); });
   }
+  assert(schedule_.get_layer_size(layers_.size() - 1) == 1);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
@@ -969,11 +1231,14 @@ BooleanGMWTensorMaxPool::BooleanGMWTensorMaxPool(std::size_t gate_id, GMWProvide
   }
 }
 
-static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool_op,
-                          BooleanGMWWireVector& circuit_wires,
-                          const std::vector<ENCRYPTO::BitVector<>>& input_shares) {
-  const auto& input_shape = maxpool_op.input_shape_;
-  const auto& output_shape = maxpool_op.output_shape_;
+static void prepare_kernel_shares(std::size_t bit_size, const tensor::MaxPoolOp& maxpool_op,
+                                  std::vector<ENCRYPTO::BitVector<>>& kernel_shares,
+                                  const std::vector<ENCRYPTO::BitVector<>>& input_shares) {
+  // the samples of a batch are pooled like additional channels
+  auto input_shape = maxpool_op.input_shape_;
+  auto output_shape = maxpool_op.output_shape_;
+  input_shape[0] *= maxpool_op.batch_size_;
+  output_shape[0] *= maxpool_op.batch_size_;
   const auto& kernel_shape = maxpool_op.kernel_shape_;
   const auto& strides = maxpool_op.strides_;
 
@@ -985,7 +1250,7 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
     return channel * (input_shape[1] * input_shape[2]) + row * input_shape[2] + column;
   };
 
-  // compute the index of the input wire of the circuit
+  // compute the index of the kernel share
   const auto mpin_wires_idx = [bit_size, &kernel_shape](auto bit_j, auto k_row, auto k_column) {
     assert(bit_j < bit_size);
     assert(k_row < kernel_shape[0]);
@@ -993,7 +1258,7 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
     return (k_row * kernel_shape[1] + k_column) * bit_size + bit_j;
   };
 
-  // compute the index in the output shares and circuit input shares
+  // compute the index in the output shares and kernel shares
   const auto out_idx = [&output_shape](auto channel, auto row, auto column) {
     assert(channel < output_shape[0]);
     assert(row < output_shape[1]);
@@ -1012,8 +1277,8 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
           for (std::size_t k_row = 0; k_row < kernel_shape[0]; ++k_row) {
             for (std::size_t k_col = 0; k_col < kernel_shape[0]; ++k_col) {
               auto bit = in_share.Get(in_idx(channel_i, i_row + k_row, i_col + k_col));
-              auto& bv = circuit_wires[mpin_wires_idx(bit_j, k_row, k_col)]->get_share();
-              bv.Set(bit, out_idx(channel_i, o_row, o_col));
+              kernel_shares[mpin_wires_idx(bit_j, k_row, k_col)].Set(
+                  bit, out_idx(channel_i, o_row, o_col));
             }
           }
 
@@ -1023,36 +1288,86 @@ static void prepare_wires(std::size_t bit_size, const tensor::MaxPoolOp& maxpool
       }
     }
   }
-  for (auto& wire : circuit_wires) {
-    wire->set_online_ready();
-  }
 }
 
-void BooleanGMWTensorMaxPool::evaluate_online() {
-  if constexpr (MOTION_VERBOSE_DEBUG) {
-    auto logger = gmw_provider_.get_logger();
-    if (logger) {
-      logger->LogTrace(
-          fmt::format("Gate {}: BooleanGMWTensorMaxPool::evaluate_online start", gate_id_));
+void BooleanGMWTensorMaxPool::evaluate_layers(ExecutionContext* exec_ctx) {
+  const auto output_size = maxpool_op_.compute_output_size();
+  input_->wait_online();
+  prepare_kernel_shares(bit_size_, maxpool_op_, kernel_shares_, input_->get_share());
+  if (exec_ctx != nullptr) {
+    // the gates wait until the inputs of their layer are assembled below
+    for (auto& layer : layers_) {
+      for (auto& gate : layer.gates) {
+        exec_ctx->fpool_->post([&] { gate->evaluate_online(); });
+      }
     }
   }
 
-  input_->wait_online();
-
-  prepare_wires(bit_size_, maxpool_op_, input_wires_, input_->get_share());
+  // shares of bit_j of a value and the offset of the value's SIMD values in them
+  const auto get_value = [this, output_size](std::size_t value, std::size_t bit_j)
+      -> std::pair<const ENCRYPTO::BitVector<>&, std::size_t> {
+    if (value < schedule_.num_inputs) {
+      return {kernel_shares_.at(value * bit_size_ + bit_j), 0};
+    }
+    const auto instance = value - schedule_.num_inputs;
+    const auto layer_i = static_cast<std::size_t>(
+        std::upper_bound(std::begin(schedule_.layer_offsets), std::end(schedule_.layer_offsets),
+                         instance) -
+        std::begin(schedule_.layer_offsets) - 1);
+    auto& wire = layers_.at(layer_i).output_wires.at(bit_j);
+    wire->wait_online();
+    return {wire->get_share(), (instance - schedule_.layer_offsets.at(layer_i)) * output_size};
+  };
 
-  for (auto& gate : gates_) {
-    // should work since its a Boolean circuit consisting of AND, XOR, INV gates
-    gate->evaluate_online();
+  for (std::size_t layer_i = 0; layer_i < layers_.size(); ++layer_i) {
+    auto& layer = layers_.at(layer_i);
+    const auto first_instance = schedule_.layer_offsets.at(layer_i);
+    for (std::size_t instance_i = 0; instance_i < schedule_.get_layer_size(layer_i);
+         ++instance_i) {
+      const auto [value_a, value_b] = schedule_.instances.at(first_instance + instance_i);
+      const auto offset = instance_i * output_size;
+      for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+        const auto [share_a, offset_a] = get_value(value_a, bit_j);
+        layer.input_wires.at(bit_j)->get_share().Copy(
+            offset, offset + output_size, share_a.Subset(offset_a, offset_a + output_size));
+        const auto [share_b, offset_b] = get_value(value_b, bit_j);
+        layer.input_wires.at(bit_size_ + bit_j)
+            ->get_share()
+            .Copy(offset, offset + output_size, share_b.Subset(offset_b, offset_b + output_size));
+      }
+    }
+    for (auto& wire : layer.input_wires) {
+      wire->set_online_ready();
+    }
+    if (exec_ctx == nullptr) {
+      for (auto& gate : layer.gates) {
+        // should work since its a Boolean circuit consisting of AND, XOR, INV gates
+        gate->evaluate_online();
+      }
+    }
   }
 
+  // the last layer consists of a single instance which computes the output
   auto& output_shares = output_->get_share();
+  auto& output_wires = layers_.back().output_wires;
   for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
+    auto& wire = output_wires[bit_j];
     wire->wait_online();
     output_shares[bit_j] = std::move(wire->get_share());
   }
   output_->set_online_ready();
+}
+
+void BooleanGMWTensorMaxPool::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = gmw_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: BooleanGMWTensorMaxPool::evaluate_online start", gate_id_));
+    }
+  }
+
+  evaluate_layers(nullptr);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
@@ -1072,21 +1387,7 @@ void BooleanGMWTensorMaxPool::evaluate_online_with_context(ExecutionContext& exe
     }
   }
 
-  input_->wait_online();
-
-  prepare_wires(bit_size_, maxpool_op_, input_wires_, input_->get_share());
-
-  for (auto& gate : gates_) {
-    exec_ctx.fpool_->post([&] { gate->evaluate_online(); });
-  }
-
-  auto& output_shares = output_->get_share();
-  for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
-    auto& wire = output_wires_[bit_j];
-    wire->wait_online();
-    output_shares[bit_j] = std::move(wire->get_share());
-  }
-  output_->set_online_ready();
+  evaluate_layers(&exec_ctx);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = gmw_provider_.get_logger();
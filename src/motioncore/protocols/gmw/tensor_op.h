@@ -22,9 +22,11 @@
 
 #pragma once
 
+#include "algorithm/circuit_loader.h"
 #include "gate/new_gate.h"
 #include "tensor.h"
 #include "tensor/tensor_op.h"
+#include "utility/linear_algebra.h"
 #include "utility/reusable_future.h"
 
 namespace ENCRYPTO {
@@ -40,6 +42,13 @@ class ACOTReceiver;
 
 }  // namespace ENCRYPTO
 
+namespace MOTION {
+template <typename T>
+class SparseMatrixMultiplicationDenseSide;
+template <typename T>
+class SparseMatrixMultiplicationSparseSide;
+}  // namespace MOTION
+
 namespace MOTION::proto::gmw {
 
 class BooleanGMWWire;
@@ -57,8 +66,9 @@ class ArithmeticGMWTensorInputSender : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
-  std::shared_ptr<const ArithmeticGMWTensor<T>> get_output_tensor() const noexcept {
-    return output_;
+  const ArithmeticGMWTensorP<T>& get_output_tensor() const noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
   }
 
  private:
@@ -78,8 +88,9 @@ class ArithmeticGMWTensorInputReceiver : public NewGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
-  std::shared_ptr<const ArithmeticGMWTensor<T>> get_output_tensor() const noexcept {
-    return output_;
+  const ArithmeticGMWTensorP<T>& get_output_tensor() const noexcept { return output_; }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
   }
 
  private:
@@ -99,6 +110,9 @@ class ArithmeticGMWTensorOutput : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> get_output_future();
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -118,6 +132,12 @@ class ArithmeticGMWTensorFlatten : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -136,9 +156,20 @@ class ArithmeticGMWTensorConv2D : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+    MOTION::detail::append_wire(wires, kernel_);
+    MOTION::detail::append_wire(wires, bias_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
+  void evaluate_online_impl(ExecutionContext*);
+
   GMWProvider& gmw_provider_;
   tensor::Conv2DOp conv_op_;
   std::size_t fractional_bits_;
@@ -160,9 +191,19 @@ class ArithmeticGMWTensorGemm : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  void evaluate_online_with_context(ExecutionContext&) override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_A_);
+    MOTION::detail::append_wire(wires, input_B_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
+  void evaluate_online_impl(ExecutionContext*);
+
   GMWProvider& gmw_provider_;
   tensor::GemmOp gemm_op_;
   std::size_t fractional_bits_;
@@ -173,6 +214,44 @@ class ArithmeticGMWTensorGemm : public NewGate {
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
+// product of a tensor with a sparse plaintext matrix of one party, see
+// TensorOpFactory::make_tensor_sparse_gemm_op
+template <typename T>
+class ArithmeticGMWTensorSparseGemm : public NewGate {
+ public:
+  ArithmeticGMWTensorSparseGemm(std::size_t gate_id, GMWProvider&, tensor::GemmOp,
+                                const ArithmeticGMWTensorCP<T> input_A, CSRMatrix<T> weights,
+                                std::size_t weights_owner, std::size_t weights_fractional_bits,
+                                std::size_t fractional_bits);
+  ~ArithmeticGMWTensorSparseGemm();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_A_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  GMWProvider& gmw_provider_;
+  tensor::GemmOp gemm_op_;
+  std::size_t fractional_bits_;
+  const ArithmeticGMWTensorCP<T> input_A_;
+  const CSRMatrix<T> weights_;
+  const std::size_t weights_owner_;
+  std::shared_ptr<ArithmeticGMWTensor<T>> output_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
+  // random mask R of the other party's share of A and the shares of R * B
+  std::vector<T> mask_;
+  std::vector<T> mask_product_share_;
+  std::unique_ptr<MOTION::SparseMatrixMultiplicationSparseSide<T>> mm_sparse_side_;
+  std::unique_ptr<MOTION::SparseMatrixMultiplicationDenseSide<T>> mm_dense_side_;
+};
+
 template <typename T>
 class ArithmeticGMWTensorSqr : public NewGate {
  public:
@@ -183,6 +262,12 @@ class ArithmeticGMWTensorSqr : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -194,6 +279,8 @@ class ArithmeticGMWTensorSqr : public NewGate {
   ENCRYPTO::ReusableFiberFuture<std::vector<T>> share_future_;
 };
 
+// multiplies the sums of the windows by 1 / kernel_size encoded with `fractional_bits` bits and
+// truncates the result; fractional_bits == 0 only computes the sums
 template <typename T>
 class ArithmeticGMWTensorAveragePool : public NewGate {
  public:
@@ -204,6 +291,12 @@ class ArithmeticGMWTensorAveragePool : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -215,6 +308,56 @@ class ArithmeticGMWTensorAveragePool : public NewGate {
   T factor_;
 };
 
+// probabilistic truncation of fixed-point values by `truncate_bits` bits (Mohassel-Zhang): each
+// party truncates its share locally, the result may be off by one in the last place
+template <typename T>
+class ArithmeticGMWTensorTruncation : public NewGate {
+ public:
+  ArithmeticGMWTensorTruncation(std::size_t gate_id, GMWProvider&,
+                                const ArithmeticGMWTensorCP<T> input, std::size_t truncate_bits);
+  bool need_setup() const noexcept override { return false; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override {}
+  void evaluate_online() override;
+  const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  GMWProvider& gmw_provider_;
+  std::size_t truncate_bits_;
+  const ArithmeticGMWTensorCP<T> input_;
+  std::shared_ptr<ArithmeticGMWTensor<T>> output_;
+};
+
+// reduce 64 bit values modulo 2^32 to evaluate the following operations on the smaller ring,
+// which is local since the shares are reduced as well
+class ArithmeticGMWTensorRingReduction : public NewGate {
+ public:
+  ArithmeticGMWTensorRingReduction(std::size_t gate_id, GMWProvider&,
+                                   const ArithmeticGMWTensorCP<std::uint64_t> input);
+  bool need_setup() const noexcept override { return false; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override {}
+  void evaluate_online() override;
+  const ArithmeticGMWTensorP<std::uint32_t>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  GMWProvider& gmw_provider_;
+  const ArithmeticGMWTensorCP<std::uint64_t> input_;
+  std::shared_ptr<ArithmeticGMWTensor<std::uint32_t>> output_;
+};
+
 template <typename T>
 class BooleanToArithmeticGMWTensorConversion : public NewGate {
  public:
@@ -225,6 +368,12 @@ class BooleanToArithmeticGMWTensorConversion : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   gmw::ArithmeticGMWTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -244,6 +393,12 @@ class BooleanGMWTensorRelu : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   const BooleanGMWTensorP& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -266,6 +421,13 @@ class BooleanXArithmeticGMWTensorRelu : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   const ArithmeticGMWTensorP<T>& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_bool_);
+    MOTION::detail::append_wire(wires, input_arith_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
@@ -288,18 +450,35 @@ class BooleanGMWTensorMaxPool : public NewGate {
   void evaluate_online() override;
   void evaluate_online_with_context(ExecutionContext&) override;
   const BooleanGMWTensorP& get_output_tensor() const { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   GMWProvider& gmw_provider_;
   const tensor::MaxPoolOp maxpool_op_;
   const std::size_t bit_size_;
   const std::size_t data_size_;
+  // the independent gtmux instances of a layer of the max tree evaluated as one instance with
+  // their SIMD values concatenated
+  struct Layer {
+    BooleanGMWWireVector input_wires;
+    BooleanGMWWireVector output_wires;
+    std::vector<std::unique_ptr<NewGate>> gates;
+  };
+
+  void evaluate_layers(ExecutionContext*);
+
   const BooleanGMWTensorCP input_;
   const BooleanGMWTensorP output_;
-  const ENCRYPTO::AlgorithmDescription& maxpool_algo_;
-  BooleanGMWWireVector input_wires_;
-  BooleanGMWWireVector output_wires_;
-  std::vector<std::unique_ptr<NewGate>> gates_;
+  const ENCRYPTO::AlgorithmDescription& gtmux_algo_;
+  const TreeSchedule schedule_;
+  // shares of the values in the kernel window for every output position
+  std::vector<ENCRYPTO::BitVector<>> kernel_shares_;
+  std::vector<Layer> layers_;
 };
 
 }  // namespace MOTION::proto::gmw
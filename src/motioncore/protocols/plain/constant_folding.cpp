@@ -0,0 +1,160 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "constant_folding.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "wire.h"
+
+namespace MOTION::proto::plain {
+
+WireVector make_boolean_constant_wires(const std::vector<ENCRYPTO::BitVector<>>& values) {
+  WireVector wires;
+  wires.reserve(values.size());
+  std::transform(std::begin(values), std::end(values), std::back_inserter(wires),
+                 [](const auto& bv) { return std::make_shared<BooleanPlainWire>(bv); });
+  return wires;
+}
+
+template <typename T>
+WireVector make_arithmetic_constant_wire(std::vector<T> values) {
+  return {std::make_shared<ArithmeticPlainWire<T>>(std::move(values))};
+}
+
+template WireVector make_arithmetic_constant_wire(std::vector<std::uint8_t>);
+template WireVector make_arithmetic_constant_wire(std::vector<std::uint16_t>);
+template WireVector make_arithmetic_constant_wire(std::vector<std::uint32_t>);
+template WireVector make_arithmetic_constant_wire(std::vector<std::uint64_t>);
+
+WireVector make_arithmetic_constant_wire(std::size_t bit_size, std::size_t num_simd,
+                                         std::uint64_t value) {
+  switch (bit_size) {
+    case 8:
+      return make_arithmetic_constant_wire(
+          std::vector<std::uint8_t>(num_simd, static_cast<std::uint8_t>(value)));
+    case 16:
+      return make_arithmetic_constant_wire(
+          std::vector<std::uint16_t>(num_simd, static_cast<std::uint16_t>(value)));
+    case 32:
+      return make_arithmetic_constant_wire(
+          std::vector<std::uint32_t>(num_simd, static_cast<std::uint32_t>(value)));
+    case 64:
+      return make_arithmetic_constant_wire(std::vector<std::uint64_t>(num_simd, value));
+    default:
+      throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+  }
+}
+
+bool is_constant(const WireVector& wires) noexcept {
+  return !wires.empty() && std::all_of(std::begin(wires), std::end(wires), [](const auto& w) {
+    const auto protocol = w->get_protocol();
+    return protocol == MPCProtocol::BooleanPlain || protocol == MPCProtocol::ArithmeticPlain;
+  });
+}
+
+static WireVector fold_boolean(ENCRYPTO::PrimitiveOperationType op, const WireVector& in_a,
+                               const WireVector& in_b) {
+  if (in_a.size() != in_b.size()) {
+    throw std::logic_error("number of wires need to be the same for both inputs");
+  }
+  std::vector<ENCRYPTO::BitVector<>> values;
+  values.reserve(in_a.size());
+  for (std::size_t wire_i = 0; wire_i < in_a.size(); ++wire_i) {
+    auto wire_a = std::dynamic_pointer_cast<BooleanPlainWire>(in_a[wire_i]);
+    auto wire_b = std::dynamic_pointer_cast<BooleanPlainWire>(in_b[wire_i]);
+    if (!wire_a || !wire_b) {
+      throw std::logic_error("expected Boolean constant wires");
+    }
+    if (wire_a->get_num_simd() != wire_b->get_num_simd()) {
+      throw std::logic_error("number of SIMD values need to be the same for all wires");
+    }
+    if (op == ENCRYPTO::PrimitiveOperationType::XOR) {
+      values.emplace_back(wire_a->get_data() ^ wire_b->get_data());
+    } else {
+      values.emplace_back(wire_a->get_data() & wire_b->get_data());
+    }
+  }
+  return make_boolean_constant_wires(values);
+}
+
+template <typename T>
+static WireVector fold_arithmetic(ENCRYPTO::PrimitiveOperationType op, const WireVector& in_a,
+                                  const WireVector& in_b) {
+  auto wire_a = std::dynamic_pointer_cast<ArithmeticPlainWire<T>>(in_a.at(0));
+  auto wire_b = std::dynamic_pointer_cast<ArithmeticPlainWire<T>>(in_b.at(0));
+  if (!wire_a || !wire_b) {
+    throw std::logic_error("expected arithmetic constant wires of the same bit size");
+  }
+  const auto& data_a = wire_a->get_data();
+  const auto& data_b = wire_b->get_data();
+  if (data_a.size() != data_b.size()) {
+    throw std::logic_error("number of SIMD values need to be the same for all wires");
+  }
+  std::vector<T> values(data_a.size());
+  if (op == ENCRYPTO::PrimitiveOperationType::ADD) {
+    std::transform(std::begin(data_a), std::end(data_a), std::begin(data_b), std::begin(values),
+                   std::plus{});
+  } else {
+    std::transform(std::begin(data_a), std::end(data_a), std::begin(data_b), std::begin(values),
+                   [](T x, T y) { return static_cast<T>(std::uint64_t(x) * y); });
+  }
+  return make_arithmetic_constant_wire(std::move(values));
+}
+
+WireVector fold_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector& in_a,
+                            const WireVector& in_b) {
+  switch (op) {
+    case ENCRYPTO::PrimitiveOperationType::XOR:
+    case ENCRYPTO::PrimitiveOperationType::AND:
+      return fold_boolean(op, in_a, in_b);
+    case ENCRYPTO::PrimitiveOperationType::ADD:
+    case ENCRYPTO::PrimitiveOperationType::MUL: {
+      if (in_a.size() != 1 || in_b.size() != 1) {
+        throw std::logic_error("arithmetic operations expect a single wire per input");
+      }
+      const auto bit_size = in_a[0]->get_bit_size();
+      switch (bit_size) {
+        case 8:
+          return fold_arithmetic<std::uint8_t>(op, in_a, in_b);
+        case 16:
+          return fold_arithmetic<std::uint16_t>(op, in_a, in_b);
+        case 32:
+          return fold_arithmetic<std::uint32_t>(op, in_a, in_b);
+        case 64:
+          return fold_arithmetic<std::uint64_t>(op, in_a, in_b);
+        default:
+          throw std::logic_error(fmt::format("unexpected bit size {}", bit_size));
+      }
+    }
+    default:
+      throw std::logic_error(
+          fmt::format("cannot fold operation {} on constants", ENCRYPTO::ToString(op)));
+  }
+}
+
+}  // namespace MOTION::proto::plain
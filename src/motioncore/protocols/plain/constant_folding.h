@@ -0,0 +1,57 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utility/bit_vector.h"
+#include "utility/typedefs.h"
+
+namespace MOTION {
+class NewWire;
+}  // namespace MOTION
+
+namespace MOTION::proto::plain {
+
+using WireVector = std::vector<std::shared_ptr<NewWire>>;
+
+// Wires holding public constants, which are known to both parties when the circuit is built.
+// They can be used as an operand of XOR/AND and ADD/MUL gates in the GMW and BEAVY providers,
+// which then evaluate the operation locally on the shares.
+WireVector make_boolean_constant_wires(const std::vector<ENCRYPTO::BitVector<>>& values);
+template <typename T>
+WireVector make_arithmetic_constant_wire(std::vector<T> values);
+// the same value in each of num_simd SIMD lanes, with a bit size of 8, 16, 32 or 64
+WireVector make_arithmetic_constant_wire(std::size_t bit_size, std::size_t num_simd,
+                                         std::uint64_t value);
+
+bool is_constant(const WireVector& wires) noexcept;
+
+// Evaluate XOR, AND, ADD or MUL on two constant operands.  The result is again a constant, so no
+// gate is created.  Throws std::logic_error for other operations or mismatching operands.
+WireVector fold_binary_gate(ENCRYPTO::PrimitiveOperationType op, const WireVector& in_a,
+                            const WireVector& in_b);
+
+}  // namespace MOTION::proto::plain
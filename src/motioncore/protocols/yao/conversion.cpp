@@ -49,6 +49,14 @@ YaoToBooleanGMWGateGarbler::YaoToBooleanGMWGateGarbler(std::size_t gate_id, YaoP
   });
 }
 
+void YaoToBooleanGMWGateGarbler::collect_input_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, inputs_);
+}
+
+void YaoToBooleanGMWGateGarbler::collect_output_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, outputs_);
+}
+
 void YaoToBooleanGMWGateGarbler::evaluate_setup() {
   auto num_wires = inputs_.size();
   auto num_simd = inputs_[0]->get_num_simd();
@@ -83,6 +91,14 @@ YaoToBooleanGMWGateEvaluator::YaoToBooleanGMWGateEvaluator(std::size_t gate_id,
   });
 }
 
+void YaoToBooleanGMWGateEvaluator::collect_input_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, inputs_);
+}
+
+void YaoToBooleanGMWGateEvaluator::collect_output_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, outputs_);
+}
+
 void YaoToBooleanGMWGateEvaluator::evaluate_setup() {
   // nothing to do
 }
@@ -267,6 +283,14 @@ YaoToBooleanBEAVYGateGarbler::YaoToBooleanBEAVYGateGarbler(std::size_t gate_id,
   public_share_future_ = yao_provider_.register_for_bits_message(gate_id, num_wires * num_simd);
 }
 
+void YaoToBooleanBEAVYGateGarbler::collect_input_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, inputs_);
+}
+
+void YaoToBooleanBEAVYGateGarbler::collect_output_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, outputs_);
+}
+
 void YaoToBooleanBEAVYGateGarbler::evaluate_setup() {
   const auto num_wires = inputs_.size();
   const auto num_simd = inputs_[0]->get_num_simd();
@@ -305,6 +329,15 @@ YaoToBooleanBEAVYGateEvaluator::YaoToBooleanBEAVYGateEvaluator(std::size_t gate_
                   [num_simd] { return std::make_shared<beavy::BooleanBEAVYWire>(num_simd); });
 }
 
+void YaoToBooleanBEAVYGateEvaluator::collect_input_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, inputs_);
+}
+
+void YaoToBooleanBEAVYGateEvaluator::collect_output_wires(
+    std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, outputs_);
+}
+
 void YaoToBooleanBEAVYGateEvaluator::evaluate_setup() {
   const auto num_wires = inputs_.size();
   const auto num_simd = inputs_[0]->get_num_simd();
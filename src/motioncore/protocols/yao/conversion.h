@@ -71,7 +71,12 @@ class YaoToBooleanGMWGateGarbler : public NewGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   gmw::BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>&) const override;
+  void collect_output_wires(std::vector<const NewWire*>&) const override;
 
  private:
   const YaoWireVector inputs_;
@@ -85,7 +90,12 @@ class YaoToBooleanGMWGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   gmw::BooleanGMWWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>&) const override;
+  void collect_output_wires(std::vector<const NewWire*>&) const override;
 
  private:
   const YaoWireVector inputs_;
@@ -100,6 +110,9 @@ class BooleanGMWToYaoGateGarbler : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
 
  private:
@@ -118,6 +131,9 @@ class BooleanGMWToYaoGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
 
  private:
@@ -134,6 +150,9 @@ class YaoToArithmeticGMWGateGarbler : public NewGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>> get_mask_future() noexcept {
     return mask_promise_.get_future();
   };
@@ -153,6 +172,9 @@ class YaoToArithmeticGMWGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   gmw::ArithmeticGMWWireP<T>& get_output_wire() noexcept { return output_; };
   void set_masked_value_future(
       ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>>&& future) {
@@ -172,7 +194,12 @@ class YaoToBooleanBEAVYGateGarbler : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   beavy::BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>&) const override;
+  void collect_output_wires(std::vector<const NewWire*>&) const override;
 
  private:
   YaoProvider& yao_provider_;
@@ -188,7 +215,12 @@ class YaoToBooleanBEAVYGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   beavy::BooleanBEAVYWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>&) const override;
+  void collect_output_wires(std::vector<const NewWire*>&) const override;
 
  private:
   YaoProvider& yao_provider_;
@@ -204,6 +236,9 @@ class BooleanBEAVYToYaoGateGarbler : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
 
  private:
@@ -223,6 +258,9 @@ class BooleanBEAVYToYaoGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
 
  private:
@@ -240,6 +278,9 @@ class YaoToArithmeticBEAVYGateGarbler : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>> get_mask_future() noexcept {
     return mask_promise_.get_future();
   };
@@ -260,6 +301,9 @@ class YaoToArithmeticBEAVYGateEvaluator : public NewGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  FiberStackClass get_fiber_stack_class() const noexcept override {
+    return FiberStackClass::large;
+  }
   beavy::ArithmeticBEAVYWireP<T>& get_output_wire() noexcept { return output_; };
   void set_masked_value_future(
       ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>>&& future) {
@@ -22,10 +22,12 @@
 
 #include "gate.h"
 
+#include <cstring>
 #include <stdexcept>
 
 #include "crypto/oblivious_transfer/ot_flavors.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "data_storage/preprocessing_store.h"
 #include "utility/constants.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
@@ -89,9 +91,13 @@ BasicYaoUnaryGate::BasicYaoUnaryGate(std::size_t gate_id, YaoProvider& yao_provi
   if (forward) {
     outputs_ = inputs_;
   } else {
+    // with label streaming the garbler allocates the output keys while garbling
     outputs_.reserve(num_wires_);
     std::generate_n(std::back_inserter(outputs_), num_wires_,
-                    [num_simd] { return std::make_shared<YaoWire>(num_simd); });
+                    [num_simd, defer = yao_provider.is_label_streaming()] {
+                      return defer ? std::make_shared<YaoWire>(num_simd, YaoWire::deferred_keys_t{})
+                                   : std::make_shared<YaoWire>(num_simd);
+                    });
   }
 }
 
@@ -117,7 +123,10 @@ BasicYaoBinaryGate::BasicYaoBinaryGate(std::size_t gate_id, YaoProvider& yao_pro
   }
   outputs_.reserve(num_wires_);
   std::generate_n(std::back_inserter(outputs_), num_wires_,
-                  [num_simd] { return std::make_shared<YaoWire>(num_simd); });
+                  [num_simd, defer = yao_provider.is_label_streaming()] {
+                    return defer ? std::make_shared<YaoWire>(num_simd, YaoWire::deferred_keys_t{})
+                                 : std::make_shared<YaoWire>(num_simd);
+                  });
 }
 
 // Determine the total number of bits in a collection of wires.
@@ -132,10 +141,23 @@ YaoInputGateGarbler::YaoInputGateGarbler(std::size_t gate_id, YaoProvider& yao_p
                                          std::size_t num_wires, std::size_t num_simd, bool in_setup)
     : BasicYaoInputGate(gate_id, yao_provider, num_wires, num_simd) {
   auto& ot_provider = yao_provider_.get_ot_provider();
-  if (in_setup) {
-    ot_sender_ = ot_provider.RegisterSendFixedXCOT128(num_wires * num_simd);
+  const auto num_bits = num_wires * num_simd;
+  if (yao_provider_.get_batch_input_ots()) {
+    // the choice corrections and keys are only sent for inputs given in the online phase
+    const auto num_online_bits = in_setup ? 0 : num_bits;
+    batch_range_ = yao_provider_.get_input_batch().reserve(gate_id, num_bits, num_online_bits,
+                                                           num_online_bits);
+    if (in_setup) {
+      ot_sender_.emplace<2>();
+    } else {
+      ot_sender_.emplace<1>();
+    }
+  } else if (in_setup) {
+    ot_sender_.emplace<2>(ot_provider.RegisterSendFixedXCOT128(num_wires * num_simd));
   } else {
-    ot_sender_ = ot_provider.RegisterSendGOT128(num_wires * num_simd);
+    ot_sender_.emplace<1>(ot_provider.RegisterSendFixedXCOT128(num_wires * num_simd));
+    choice_corrections_future_ =
+        yao_provider_.register_for_bits_message(gate_id, num_wires * num_simd);
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -157,6 +179,9 @@ YaoInputGateGarbler::YaoInputGateGarbler(
     : BasicYaoInputGate(gate_id, yao_provider, num_wires, num_simd, std::move(input_future)),
       ot_sender_(false) {
   assert(ot_sender_.index() == 0);
+  if (yao_provider_.get_batch_input_ots()) {
+    batch_range_ = yao_provider_.get_input_batch().reserve(gate_id, 0, 0, num_wires * num_simd);
+  }
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -181,14 +206,9 @@ void YaoInputGateGarbler::evaluate_setup() {
   }
 
   if (ot_sender_.index() == 2) {
-    // it's the sender's input and it's given during the setup phase
+    // it's the receiver's input and it's given during the setup phase
     // => use XCOT
-    auto& xcot_sender = std::get<2>(ot_sender_);
-    assert(xcot_sender);
-    xcot_sender->SetCorrelation(yao_provider_.get_global_offset());
-    xcot_sender->SendMessages();
-    xcot_sender->ComputeOutputs();
-    const auto keys = xcot_sender->GetOutputs();
+    const auto keys = compute_ot_outputs();
     auto keys_ptr = keys.data();
     for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
       auto& w_o = outputs_[wire_i];
@@ -196,6 +216,19 @@ void YaoInputGateGarbler::evaluate_setup() {
       w_o->set_setup_ready();
       keys_ptr += num_simd_;
     }
+  } else if (ot_sender_.index() == 1) {
+    // it's the receiver's input and it's given during the online phase
+    // => precompute XCOTs with random choices and mask the random zero keys with their outputs
+    key_masks_ = compute_ot_outputs();
+    auto masks_ptr = key_masks_.data();
+    for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
+      auto& w_o = outputs_[wire_i];
+      w_o->get_keys().set_to_random();
+      std::transform(masks_ptr, masks_ptr + num_simd_, std::begin(w_o->get_keys()), masks_ptr,
+                     [](const auto& mask, const auto& key) { return mask ^ key; });
+      w_o->set_setup_ready();
+      masks_ptr += num_simd_;
+    }
   } else {
     // generate random keys for each wire
     for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
@@ -234,21 +267,21 @@ void YaoInputGateGarbler::evaluate_online() {
   }
 
   const auto global_offset = yao_provider_.get_global_offset();
-  if (ot_sender_.index() == 1) {
-    // evaluator's input
-    ENCRYPTO::block128_vector ot_inputs(2 * num_wires_ * num_simd_);
-    for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
-      auto& w_o = outputs_[wire_i];
-      auto& zero_keys = w_o->get_keys();
-      auto keys_offset = 2 * wire_i * num_simd_;
-      for (std::size_t simd_j = 0; simd_j < num_simd_; ++simd_j) {
-        ot_inputs[keys_offset + 2 * simd_j] = zero_keys[simd_j];
-        ot_inputs[keys_offset + 2 * simd_j + 1] = zero_keys[simd_j] ^ global_offset;
+  if (ot_sender_.index() == 1 && batch_range_) {
+    // the batch corrects the key masks once the choice corrections of all gates have arrived
+    yao_provider_.get_input_batch().send_keys(*batch_range_, key_masks_);
+    key_masks_ = ENCRYPTO::block128_vector();
+  } else if (ot_sender_.index() == 1) {
+    // evaluator's input, the evaluator has received the zero keys of the OTs xor c * offset for
+    // random choices c and sends d = input xor c, so we send the keys masks xor d * offset
+    const auto choice_corrections = choice_corrections_future_.get();
+    auto keys = std::move(key_masks_);
+    for (std::size_t bit_i = 0; bit_i < keys.size(); ++bit_i) {
+      if (choice_corrections.Get(bit_i)) {
+        keys[bit_i] ^= global_offset;
       }
     }
-    auto& got_sender = std::get<1>(ot_sender_);
-    got_sender->SetInputs(std::move(ot_inputs));
-    got_sender->SendMessages();
+    yao_provider_.send_blocks_message(gate_id_, std::move(keys));
   } else {
     const auto inputs = input_future_.get();
     if (inputs.size() != num_wires_) {
@@ -272,7 +305,11 @@ void YaoInputGateGarbler::evaluate_online() {
       }
     }
     // send keys to evaluator
-    yao_provider_.send_blocks_message(gate_id_, std::move(keys));
+    if (batch_range_) {
+      yao_provider_.get_input_batch().send_keys(*batch_range_, keys);
+    } else {
+      yao_provider_.send_blocks_message(gate_id_, std::move(keys));
+    }
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -283,12 +320,73 @@ void YaoInputGateGarbler::evaluate_online() {
   }
 }
 
+ENCRYPTO::block128_vector YaoInputGateGarbler::compute_ot_outputs() {
+  if (batch_range_) {
+    return yao_provider_.get_input_batch().send_ots(*batch_range_);
+  }
+  auto& xcot_sender = ot_sender_.index() == 1 ? std::get<1>(ot_sender_) : std::get<2>(ot_sender_);
+  assert(xcot_sender);
+  xcot_sender->SetCorrelation(yao_provider_.get_global_offset());
+  xcot_sender->SendMessages();
+  xcot_sender->ComputeOutputs();
+  return std::move(xcot_sender->GetOutputs());
+}
+
+void YaoInputGateGarbler::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_blocks(wire->get_keys());
+  }
+  if (ot_sender_.index() == 1) {
+    writer.write_blocks(key_masks_);
+  }
+}
+
+void YaoInputGateGarbler::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_keys() = record.read_blocks();
+  }
+  if (ot_sender_.index() == 1) {
+    key_masks_ = record.read_blocks();
+  }
+  for (auto& wire : outputs_) {
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> YaoInputGateGarbler::get_cost() const {
+  const auto num_bits = num_wires_ * num_simd_;
+  switch (ot_sender_.index()) {
+    case 0:
+      // send the keys of my input
+      return GateCost{.protocol_ = MPCProtocol::Yao,
+                      .online_bytes_ = num_bits * sizeof(ENCRYPTO::block128_t),
+                      .online_rounds_ = 1};
+    case 1:
+      // precompute the OTs, wait for the choice corrections of the evaluator and send the keys
+      return GateCost{.protocol_ = MPCProtocol::Yao,
+                      .setup_bytes_ = Helpers::Convert::BitsToBytes(
+                          GateCost::cot_sender_bits(num_bits, 8 * sizeof(ENCRYPTO::block128_t))),
+                      .online_bytes_ = num_bits * sizeof(ENCRYPTO::block128_t),
+                      .num_ots_ = num_bits,
+                      .online_rounds_ = 2};
+    default:
+      return GateCost{.protocol_ = MPCProtocol::Yao,
+                      .setup_bytes_ = Helpers::Convert::BitsToBytes(
+                          GateCost::cot_sender_bits(num_bits, 8 * sizeof(ENCRYPTO::block128_t))),
+                      .num_ots_ = num_bits};
+  }
+}
+
 YaoInputGateEvaluator::YaoInputGateEvaluator(std::size_t gate_id, YaoProvider& yao_provider,
                                              std::size_t num_wires, std::size_t num_simd, bool)
     : BasicYaoInputGate(gate_id, yao_provider, num_wires, num_simd), ot_receiver_(false) {
   assert(ot_receiver_.index() == 0);
   // garbler's input => register for keys message
-  keys_future_ = yao_provider_.register_for_blocks_message(gate_id, num_wires * num_simd);
+  if (yao_provider_.get_batch_input_ots()) {
+    batch_range_ = yao_provider_.get_input_batch().reserve(gate_id, 0, 0, num_wires * num_simd);
+  } else {
+    keys_future_ = yao_provider_.register_for_blocks_message(gate_id, num_wires * num_simd);
+  }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -309,10 +407,21 @@ YaoInputGateEvaluator::YaoInputGateEvaluator(
     : BasicYaoInputGate(gate_id, yao_provider, num_wires, num_simd, std::move(input_future)) {
   // my_inputs_ => register for GOTs
   auto& ot_provider = yao_provider_.get_ot_provider();
-  if (in_setup) {
-    ot_receiver_ = ot_provider.RegisterReceiveFixedXCOT128(num_wires * num_simd);
+  const auto num_bits = num_wires * num_simd;
+  if (yao_provider_.get_batch_input_ots()) {
+    const auto num_online_bits = in_setup ? 0 : num_bits;
+    batch_range_ = yao_provider_.get_input_batch().reserve(gate_id, num_bits, num_online_bits,
+                                                           num_online_bits);
+    if (in_setup) {
+      ot_receiver_.emplace<2>();
+    } else {
+      ot_receiver_.emplace<1>();
+    }
+  } else if (in_setup) {
+    ot_receiver_.emplace<2>(ot_provider.RegisterReceiveFixedXCOT128(num_wires * num_simd));
   } else {
-    ot_receiver_ = ot_provider.RegisterReceiveGOT128(num_wires * num_simd);
+    ot_receiver_.emplace<1>(ot_provider.RegisterReceiveFixedXCOT128(num_wires * num_simd));
+    keys_future_ = yao_provider_.register_for_blocks_message(gate_id, num_wires * num_simd);
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -339,7 +448,7 @@ void YaoInputGateEvaluator::evaluate_setup() {
     }
   }
 
-  if (ot_receiver_.index() != 2) {
+  if (ot_receiver_.index() == 0) {
     if constexpr (MOTION_VERBOSE_DEBUG) {
       auto logger = yao_provider_.get_logger();
       if (logger) {
@@ -349,18 +458,27 @@ void YaoInputGateEvaluator::evaluate_setup() {
     }
     return;
   }
+  if (ot_receiver_.index() == 1) {
+    // My input provided in online phase, precompute C-OTs with random choices
+    random_choices_ = ENCRYPTO::BitVector<>::Random(num_wires_ * num_simd_);
+    ot_keys_ = compute_ot_outputs(random_choices_);
+
+    if constexpr (MOTION_VERBOSE_DEBUG) {
+      auto logger = yao_provider_.get_logger();
+      if (logger) {
+        logger->LogTrace(
+            fmt::format("Gate {}: YaoInputGateEvaluator::evaluate_setup end", gate_id_));
+      }
+    }
+    return;
+  }
   // My input provided in setup phase, run C-OTs to obtain input keys
   auto inputs = input_future_.get();
   ENCRYPTO::BitVector choice_bits;  //(num_wires_ * num_simd_);
   for (auto& wire_bits : inputs) {
     choice_bits.Append(wire_bits);
   }
-  auto& xcot_receiver = std::get<2>(ot_receiver_);
-  assert(xcot_receiver);
-  xcot_receiver->SetChoices(std::move(choice_bits));
-  xcot_receiver->SendCorrections();
-  xcot_receiver->ComputeOutputs();
-  const auto received_keys = std::move(xcot_receiver->GetOutputs());
+  const auto received_keys = compute_ot_outputs(std::move(choice_bits));
   auto keys_ptr = received_keys.data();
   for (auto& w : outputs_) {
     std::copy_n(keys_ptr, num_simd_, std::begin(w->get_keys()));
@@ -398,20 +516,29 @@ void YaoInputGateEvaluator::evaluate_online() {
 
   ENCRYPTO::block128_vector received_keys;
   if (ot_receiver_.index() == 1) {
-    // My input, run OTs to obtain input keys
+    // My input, derandomize the precomputed OTs to obtain input keys
     auto inputs = input_future_.get();
-    ENCRYPTO::BitVector choice_bits;  //(num_wires_ * num_simd_);
+    ENCRYPTO::BitVector choice_corrections;  //(num_wires_ * num_simd_);
     for (auto& wire_bits : inputs) {
-      choice_bits.Append(wire_bits);
+      choice_corrections.Append(wire_bits);
     }
-    auto& got_receiver = std::get<1>(ot_receiver_);
-    got_receiver->SetChoices(std::move(choice_bits));
-    got_receiver->SendCorrections();
-    got_receiver->ComputeOutputs();
-    received_keys = std::move(got_receiver->GetOutputs());
+    choice_corrections ^= random_choices_;
+    if (batch_range_) {
+      received_keys =
+          yao_provider_.get_input_batch().receive_keys(*batch_range_, choice_corrections);
+    } else {
+      yao_provider_.send_bits_message(gate_id_, std::move(choice_corrections));
+      received_keys = keys_future_.get();
+    }
+    received_keys ^= ot_keys_;
+    ot_keys_ = ENCRYPTO::block128_vector();
   } else {
     // Garbler's input, receive input keys
-    received_keys = keys_future_.get();
+    if (batch_range_) {
+      received_keys = yao_provider_.get_input_batch().receive_keys(*batch_range_, {});
+    } else {
+      received_keys = keys_future_.get();
+    }
   }
   auto keys_ptr = received_keys.data();
   for (auto& w : outputs_) {
@@ -429,6 +556,76 @@ void YaoInputGateEvaluator::evaluate_online() {
   }
 }
 
+ENCRYPTO::block128_vector YaoInputGateEvaluator::compute_ot_outputs(
+    ENCRYPTO::BitVector<> choices) {
+  if (batch_range_) {
+    return yao_provider_.get_input_batch().receive_ots(*batch_range_, choices);
+  }
+  auto& xcot_receiver =
+      ot_receiver_.index() == 1 ? std::get<1>(ot_receiver_) : std::get<2>(ot_receiver_);
+  assert(xcot_receiver);
+  xcot_receiver->SetChoices(std::move(choices));
+  xcot_receiver->SendCorrections();
+  xcot_receiver->ComputeOutputs();
+  return xcot_receiver->GetOutputs();
+}
+
+void YaoInputGateEvaluator::save_setup(PreprocessingWriter& writer) {
+  switch (ot_receiver_.index()) {
+    case 1:
+      writer.write_bits(random_choices_);
+      writer.write_blocks(ot_keys_);
+      break;
+    case 2:
+      for (const auto& wire : outputs_) {
+        writer.write_blocks(wire->get_keys());
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void YaoInputGateEvaluator::load_setup(PreprocessingRecord& record) {
+  switch (ot_receiver_.index()) {
+    case 1:
+      random_choices_ = record.read_bits();
+      ot_keys_ = record.read_blocks();
+      break;
+    case 2:
+      // the setup has already computed the keys of my input
+      for (auto& wire : outputs_) {
+        wire->get_keys() = record.read_blocks();
+        wire->set_online_ready();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+std::optional<GateCost> YaoInputGateEvaluator::get_cost() const {
+  const auto num_bits = num_wires_ * num_simd_;
+  switch (ot_receiver_.index()) {
+    case 0:
+      // receive the keys of the garbler's input
+      return GateCost{.protocol_ = MPCProtocol::Yao, .online_rounds_ = 1};
+    case 1:
+      // precompute the OTs in the setup, send the choice corrections and wait for the keys
+      return GateCost{.protocol_ = MPCProtocol::Yao,
+                      .setup_bytes_ =
+                          Helpers::Convert::BitsToBytes(GateCost::cot_receiver_bits(num_bits)),
+                      .online_bytes_ = Helpers::Convert::BitsToBytes(num_bits),
+                      .num_ots_ = num_bits,
+                      .online_rounds_ = 2};
+    default:
+      return GateCost{.protocol_ = MPCProtocol::Yao,
+                      .setup_bytes_ =
+                          Helpers::Convert::BitsToBytes(GateCost::cot_receiver_bits(num_bits)),
+                      .num_ots_ = num_bits};
+  }
+}
+
 YaoOutputGateGarbler::YaoOutputGateGarbler(std::size_t gate_id, YaoProvider& yao_provider,
                                            YaoWireVector&& in, OutputRecipient output_recipient)
     : BasicYaoOutputGate(gate_id, yao_provider, std::move(in), output_recipient) {
@@ -491,6 +688,7 @@ void YaoOutputGateGarbler::evaluate_setup() {
       yao_provider_.send_bits_message(gate_id_, decoding_info_);
       break;
   }
+  yao_provider_.release_input_keys(inputs_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -532,6 +730,22 @@ void YaoOutputGateGarbler::evaluate_online() {
   }
 }
 
+void YaoOutputGateGarbler::save_setup(PreprocessingWriter& writer) {
+  writer.write_bits(decoding_info_);
+}
+
+void YaoOutputGateGarbler::load_setup(PreprocessingRecord& record) {
+  decoding_info_ = record.read_bits();
+}
+
+std::optional<GateCost> YaoOutputGateGarbler::get_cost() const {
+  const auto num_bits = detail::count_bits(inputs_);
+  const bool send = output_recipient_ != OutputRecipient::garbler;
+  return GateCost{.protocol_ = MPCProtocol::Yao,
+                  .setup_bytes_ = send ? Helpers::Convert::BitsToBytes(num_bits) : 0,
+                  .online_rounds_ = output_recipient_ != OutputRecipient::evaluator ? 1u : 0u};
+}
+
 YaoOutputGateEvaluator::YaoOutputGateEvaluator(std::size_t gate_id, YaoProvider& yao_provider,
                                                YaoWireVector&& in, OutputRecipient output_recipient)
     : BasicYaoOutputGate(gate_id, yao_provider, std::move(in), output_recipient) {
@@ -568,7 +782,7 @@ void YaoOutputGateEvaluator::evaluate_setup() {
 
   if (output_recipient_ != OutputRecipient::garbler) {
     // Wait for the decoding information from the garbler.
-    bits_future_.wait();
+    decoding_info_ = bits_future_.get();
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -621,7 +835,7 @@ void YaoOutputGateEvaluator::evaluate_online() {
     outputs.reserve(num_wires_);
     // Receive decoding information and decode the encoded output.
     auto plain_output = std::move(encoded_output);
-    plain_output ^= bits_future_.get();
+    plain_output ^= decoding_info_;
     // Split the bits corresponding to the wires.
     std::size_t bit_offset = 0;
     for (const auto& wire : inputs_) {
@@ -641,6 +855,22 @@ void YaoOutputGateEvaluator::evaluate_online() {
   }
 }
 
+void YaoOutputGateEvaluator::save_setup(PreprocessingWriter& writer) {
+  writer.write_bits(decoding_info_);
+}
+
+void YaoOutputGateEvaluator::load_setup(PreprocessingRecord& record) {
+  decoding_info_ = record.read_bits();
+}
+
+std::optional<GateCost> YaoOutputGateEvaluator::get_cost() const {
+  const auto num_bits = detail::count_bits(inputs_);
+  const bool send = output_recipient_ != OutputRecipient::evaluator;
+  return GateCost{.protocol_ = MPCProtocol::Yao,
+                  .online_bytes_ = send ? Helpers::Convert::BitsToBytes(num_bits) : 0,
+                  .online_rounds_ = send ? 1u : 0u};
+}
+
 YaoINVGateGarbler::YaoINVGateGarbler(std::size_t gate_id, YaoProvider& yao_provider,
                                      YaoWireVector&& in)
     : BasicYaoUnaryGate(gate_id, yao_provider, std::move(in), false) {
@@ -664,9 +894,14 @@ void YaoINVGateGarbler::evaluate_setup() {
     const auto& w_a = inputs_[wire_i];
     w_a->wait_setup();
     auto& w_o = outputs_[wire_i];
-    w_o->get_keys() = w_a->get_keys() ^ yao_provider_.get_global_offset();
+    const auto& keys_a = w_a->get_keys();
+    auto keys_o = yao_provider_.allocate_keys(keys_a.size());
+    std::transform(std::begin(keys_a), std::end(keys_a), std::begin(keys_o),
+                   [offset = yao_provider_.get_global_offset()](auto k) { return k ^ offset; });
+    w_o->get_keys() = std::move(keys_o);
     w_o->set_setup_ready();
   }
+  yao_provider_.release_input_keys(inputs_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -676,6 +911,23 @@ void YaoINVGateGarbler::evaluate_setup() {
   }
 }
 
+void YaoINVGateGarbler::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_blocks(wire->get_keys());
+  }
+}
+
+void YaoINVGateGarbler::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_keys() = record.read_blocks();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> YaoINVGateGarbler::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::Yao};
+}
+
 YaoINVGateEvaluator::YaoINVGateEvaluator(std::size_t gate_id, YaoProvider& yao_provider,
                                          YaoWireVector&& in)
     : BasicYaoUnaryGate(gate_id, yao_provider, std::move(in), true) {
@@ -687,6 +939,10 @@ YaoINVGateEvaluator::YaoINVGateEvaluator(std::size_t gate_id, YaoProvider& yao_p
   }
 }
 
+std::optional<GateCost> YaoINVGateEvaluator::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::Yao};
+}
+
 YaoXORGateGarbler::YaoXORGateGarbler(std::size_t gate_id, YaoProvider& yao_provider,
                                      YaoWireVector&& in_a, YaoWireVector&& in_b)
     : BasicYaoBinaryGate(gate_id, yao_provider, std::move(in_a), std::move(in_b)) {
@@ -713,9 +969,15 @@ void YaoXORGateGarbler::evaluate_setup() {
     w_a->wait_setup();
     w_b->wait_setup();
     auto& w_o = outputs_[wire_i];
-    w_o->get_keys() = w_a->get_keys() ^ w_b->get_keys();
+    const auto& keys_a = w_a->get_keys();
+    auto keys_o = yao_provider_.allocate_keys(keys_a.size());
+    std::copy_n(keys_a.data(), keys_a.size(), keys_o.data());
+    keys_o ^= w_b->get_keys();
+    w_o->get_keys() = std::move(keys_o);
     w_o->set_setup_ready();
   }
+  yao_provider_.release_input_keys(inputs_a_);
+  yao_provider_.release_input_keys(inputs_b_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -725,6 +987,23 @@ void YaoXORGateGarbler::evaluate_setup() {
   }
 }
 
+void YaoXORGateGarbler::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_blocks(wire->get_keys());
+  }
+}
+
+void YaoXORGateGarbler::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_keys() = record.read_blocks();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> YaoXORGateGarbler::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::Yao};
+}
+
 YaoXORGateEvaluator::YaoXORGateEvaluator(std::size_t gate_id, YaoProvider& yao_provider,
                                          YaoWireVector&& in_a, YaoWireVector&& in_b)
     : BasicYaoBinaryGate(gate_id, yao_provider, std::move(in_a), std::move(in_b)) {
@@ -764,9 +1043,16 @@ void YaoXORGateEvaluator::evaluate_online() {
   }
 }
 
+std::optional<GateCost> YaoXORGateEvaluator::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::Yao};
+}
+
 YaoANDGateGarbler::YaoANDGateGarbler(std::size_t gate_id, YaoProvider& yao_provider,
                                      YaoWireVector&& in_a, YaoWireVector&& in_b)
     : BasicYaoBinaryGate(gate_id, yao_provider, std::move(in_a), std::move(in_b)) {
+  if (yao_provider_.get_garbled_table_window() > 0) {
+    window_ack_fut_ = yao_provider_.register_for_bits_message(gate_id_, 1);
+  }
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -775,7 +1061,13 @@ YaoANDGateGarbler::YaoANDGateGarbler(std::size_t gate_id, YaoProvider& yao_provi
   }
 }
 
-void YaoANDGateGarbler::evaluate_setup() {
+void YaoANDGateGarbler::evaluate_setup() { evaluate_setup_impl(nullptr); }
+
+void YaoANDGateGarbler::evaluate_setup_with_context(ExecutionContext& exec_ctx) {
+  evaluate_setup_impl(&exec_ctx);
+}
+
+void YaoANDGateGarbler::evaluate_setup_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -783,19 +1075,46 @@ void YaoANDGateGarbler::evaluate_setup() {
     }
   }
 
+  // garble the AND gates of all wires in one batch
   auto num_gates = detail::count_bits(inputs_a_);
-  ENCRYPTO::block128_vector garbled_tables(YaoProvider::garbled_table_size * num_gates);
-  std::size_t table_offset = 0;
+  ENCRYPTO::block128_vector keys_a(num_gates);
+  ENCRYPTO::block128_vector keys_b(num_gates);
+  ENCRYPTO::block128_vector keys_out;
+  std::size_t offset = 0;
   for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     const auto& w_a = inputs_a_[wire_i];
     const auto& w_b = inputs_b_[wire_i];
     w_a->wait_setup();
     w_b->wait_setup();
+    const auto num_simd = w_a->get_num_simd();
+    std::copy_n(w_a->get_keys().data(), num_simd, keys_a.data() + offset);
+    std::copy_n(w_b->get_keys().data(), num_simd, keys_b.data() + offset);
+    offset += num_simd;
+  }
+  yao_provider_.release_input_keys(inputs_a_);
+  yao_provider_.release_input_keys(inputs_b_);
+  // wait until the tables fit into the window, before the outputs are ready such that the tables
+  // of all gates that this one waits for have been sent
+  const auto table_size = yao_provider_.get_garbled_table_size(num_gates);
+  if (yao_provider_.get_garbled_table_window() > 0) {
+    yao_provider_.acquire_garbled_table_window(table_size, std::move(window_ack_fut_));
+  }
+  ENCRYPTO::block128_vector garbled_tables(table_size);
+  if (exec_ctx != nullptr) {
+    yao_provider_.create_garbled_tables(gate_id_, keys_a, keys_b, garbled_tables.data(), keys_out,
+                                        *exec_ctx);
+  } else {
+    yao_provider_.create_garbled_tables(gate_id_, keys_a, keys_b, garbled_tables.data(),
+                                        keys_out);
+  }
+  offset = 0;
+  for (std::size_t wire_i = 0; wire_i < num_wires_; ++wire_i) {
     auto& w_o = outputs_[wire_i];
-    yao_provider_.create_garbled_tables(gate_id_, w_a->get_keys(), w_b->get_keys(),
-                                        &garbled_tables[table_offset], w_o->get_keys());
+    const auto num_simd = w_o->get_num_simd();
+    w_o->get_keys() = yao_provider_.allocate_keys(num_simd);
+    std::copy_n(keys_out.data() + offset, num_simd, w_o->get_keys().data());
     w_o->set_setup_ready();
-    table_offset += 2 * w_o->get_num_simd();
+    offset += num_simd;
   }
 
   yao_provider_.send_blocks_message(gate_id_, std::move(garbled_tables));
@@ -808,12 +1127,32 @@ void YaoANDGateGarbler::evaluate_setup() {
   }
 }
 
+void YaoANDGateGarbler::save_setup(PreprocessingWriter& writer) {
+  for (const auto& wire : outputs_) {
+    writer.write_blocks(wire->get_keys());
+  }
+}
+
+void YaoANDGateGarbler::load_setup(PreprocessingRecord& record) {
+  for (auto& wire : outputs_) {
+    wire->get_keys() = record.read_blocks();
+    wire->set_setup_ready();
+  }
+}
+
+std::optional<GateCost> YaoANDGateGarbler::get_cost() const {
+  const auto num_gates = detail::count_bits(inputs_a_);
+  return GateCost{.protocol_ = MPCProtocol::Yao,
+                  .setup_bytes_ = yao_provider_.get_garbled_table_size(num_gates) *
+                                  sizeof(ENCRYPTO::block128_t)};
+}
+
 YaoANDGateEvaluator::YaoANDGateEvaluator(std::size_t gate_id, YaoProvider& yao_provider,
                                          YaoWireVector&& in_a, YaoWireVector&& in_b)
     : BasicYaoBinaryGate(gate_id, yao_provider, std::move(in_a), std::move(in_b)) {
   auto num_gates = detail::count_bits(inputs_a_);
   garbled_tables_fut_ = yao_provider_.register_for_blocks_message(
-      gate_id_, num_gates * YaoProvider::garbled_table_size);
+      gate_id_, yao_provider_.get_garbled_table_size(num_gates));
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -832,7 +1171,7 @@ void YaoANDGateEvaluator::evaluate_setup() {
   }
 
   // nothing to do
-  garbled_tables_fut_.wait();
+  garbled_tables_ = garbled_tables_fut_.get();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -842,7 +1181,13 @@ void YaoANDGateEvaluator::evaluate_setup() {
   }
 }
 
-void YaoANDGateEvaluator::evaluate_online() {
+void YaoANDGateEvaluator::evaluate_online() { evaluate_online_impl(nullptr); }
+
+void YaoANDGateEvaluator::evaluate_online_with_context(ExecutionContext& exec_ctx) {
+  evaluate_online_impl(&exec_ctx);
+}
+
+void YaoANDGateEvaluator::evaluate_online_impl(ExecutionContext* exec_ctx) {
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -851,20 +1196,51 @@ void YaoANDGateEvaluator::evaluate_online() {
     }
   }
 
+  // evaluate the AND gates of all wires in one batch
   auto num_wires = outputs_.size();
-  auto garbled_tables = garbled_tables_fut_.get();
-
-  std::size_t table_offset = 0;
+  if (!stored_tables_.empty()) {
+    // copy the tables out of the store, whose mapping is not aligned for the blocks
+    garbled_tables_ =
+        ENCRYPTO::block128_vector(stored_tables_.size() / sizeof(ENCRYPTO::block128_t));
+    std::memcpy(garbled_tables_.data(), stored_tables_.data(), stored_tables_.size());
+    stored_tables_ = {};
+  }
+  auto garbled_tables = std::move(garbled_tables_);
+  const auto num_gates = detail::count_bits(inputs_a_);
+  ENCRYPTO::block128_vector keys_a(num_gates);
+  ENCRYPTO::block128_vector keys_b(num_gates);
+  ENCRYPTO::block128_vector keys_out;
+  std::size_t offset = 0;
   for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
     const auto& w_a = inputs_a_[wire_i];
     const auto& w_b = inputs_b_[wire_i];
     w_a->wait_online();
     w_b->wait_online();
+    const auto num_simd = w_a->get_num_simd();
+    std::copy_n(w_a->get_keys().data(), num_simd, keys_a.data() + offset);
+    std::copy_n(w_b->get_keys().data(), num_simd, keys_b.data() + offset);
+    offset += num_simd;
+  }
+  if (exec_ctx != nullptr) {
+    yao_provider_.evaluate_garbled_tables(gate_id_, keys_a, keys_b, garbled_tables.data(),
+                                          keys_out, *exec_ctx);
+  } else {
+    yao_provider_.evaluate_garbled_tables(gate_id_, keys_a, keys_b, garbled_tables.data(),
+                                          keys_out);
+  }
+  offset = 0;
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
     auto& w_o = outputs_[wire_i];
-    yao_provider_.evaluate_garbled_tables(gate_id_, w_a->get_keys(), w_b->get_keys(),
-                                          &garbled_tables[table_offset], w_o->get_keys());
+    const auto num_simd = w_o->get_num_simd();
+    w_o->get_keys().resize(num_simd);
+    std::copy_n(keys_out.data() + offset, num_simd, w_o->get_keys().data());
     w_o->set_online_ready();
-    table_offset += 2 * w_o->get_num_simd();
+    offset += num_simd;
+  }
+  // free the tables and let the garbler send the next ones
+  if (yao_provider_.get_garbled_table_window() > 0) {
+    garbled_tables = ENCRYPTO::block128_vector();
+    yao_provider_.send_bits_message(gate_id_, ENCRYPTO::BitVector<>(1));
   }
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -875,4 +1251,23 @@ void YaoANDGateEvaluator::evaluate_online() {
   }
 }
 
+void YaoANDGateEvaluator::save_setup(PreprocessingWriter& writer) {
+  writer.write_blocks(garbled_tables_);
+}
+
+void YaoANDGateEvaluator::load_setup(PreprocessingRecord& record) {
+  auto [num_blocks, tables] = record.read_chunk();
+  const auto num_gates = detail::count_bits(inputs_a_);
+  if (num_blocks != yao_provider_.get_garbled_table_size(num_gates) ||
+      tables.size() != num_blocks * sizeof(ENCRYPTO::block128_t)) {
+    throw std::runtime_error(
+        fmt::format("Gate {}: stored garbled tables have unexpected size", gate_id_));
+  }
+  stored_tables_ = tables;
+}
+
+std::optional<GateCost> YaoANDGateEvaluator::get_cost() const {
+  return GateCost{.protocol_ = MPCProtocol::Yao};
+}
+
 }  // namespace MOTION::proto::yao
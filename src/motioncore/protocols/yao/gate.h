@@ -23,9 +23,12 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <variant>
 
 #include "gate/new_gate.h"
+#include "input_batch.h"
 #include "utility/bit_vector.h"
 #include "utility/block.h"
 #include "utility/reusable_future.h"
@@ -34,8 +37,6 @@
 namespace ENCRYPTO::ObliviousTransfer {
 class FixedXCOT128Receiver;
 class FixedXCOT128Sender;
-class GOT128Receiver;
-class GOT128Sender;
 }  // namespace ENCRYPTO::ObliviousTransfer
 
 namespace MOTION::proto::yao {
@@ -54,6 +55,9 @@ class BasicYaoInputGate : public NewGate {
   BasicYaoInputGate(std::size_t gate_id, YaoProvider&, std::size_t num_wires, std::size_t num_simd,
                     ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>>&&);
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   YaoProvider& yao_provider_;
@@ -67,6 +71,9 @@ class BasicYaoOutputGate : public NewGate {
  public:
   BasicYaoOutputGate(std::size_t gate_id, YaoProvider&, YaoWireVector&&, OutputRecipient);
   virtual ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>> get_output_future() = 0;
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
 
  protected:
   YaoProvider& yao_provider_;
@@ -82,6 +89,12 @@ class BasicYaoUnaryGate : public NewGate {
  public:
   BasicYaoUnaryGate(std::size_t gate_id, YaoProvider&, YaoWireVector&&, bool forward);
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   YaoProvider& yao_provider_;
@@ -94,6 +107,13 @@ class BasicYaoBinaryGate : public NewGate {
  public:
   BasicYaoBinaryGate(std::size_t gate_id, YaoProvider&, YaoWireVector&&, YaoWireVector&&);
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, inputs_a_);
+    MOTION::detail::append_wires(wires, inputs_b_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wires(wires, outputs_);
+  }
 
  protected:
   YaoProvider& yao_provider_;
@@ -105,6 +125,13 @@ class BasicYaoBinaryGate : public NewGate {
 
 }  // namespace detail
 
+// Garbler gates which read the keys of their inputs only in the setup phase and hand them back
+// with YaoProvider::release_input_keys() afterwards (see YaoProvider::set_label_streaming).
+class LabelStreamingGate {
+ public:
+  virtual ~LabelStreamingGate() = default;
+};
+
 class YaoInputGateGarbler : public detail::BasicYaoInputGate {
  public:
   YaoInputGateGarbler(std::size_t gate_id, YaoProvider&, std::size_t num_wires,
@@ -123,11 +150,26 @@ class YaoInputGateGarbler : public detail::BasicYaoInputGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
-  std::variant<bool, std::shared_ptr<ENCRYPTO::ObliviousTransfer::GOT128Sender>,
+  // garbler's input, evaluator's input in the online phase (the correlated OTs are precomputed
+  // with random choices and derandomized online), or evaluator's input in the setup phase
+  std::variant<bool, std::shared_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Sender>,
                std::shared_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Sender>>
       ot_sender_;
+  // with YaoProvider::set_batch_input_ots, the OTs and messages are part of the provider's batch
+  // and the OT sender is unset
+  std::optional<YaoInputBatch::Range> batch_range_;
+  // zero keys of the outputs xor the zero keys of the OTs
+  ENCRYPTO::block128_vector key_masks_;
+  // evaluator's inputs xor the random choices of the OTs
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> choice_corrections_future_;
+
+  ENCRYPTO::block128_vector compute_ot_outputs();
 };
 
 class YaoInputGateEvaluator : public detail::BasicYaoInputGate {
@@ -147,15 +189,26 @@ class YaoInputGateEvaluator : public detail::BasicYaoInputGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
-  std::variant<bool, std::shared_ptr<ENCRYPTO::ObliviousTransfer::GOT128Receiver>,
+  // same alternatives as in YaoInputGateGarbler
+  std::variant<bool, std::shared_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Receiver>,
                std::shared_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Receiver>>
       ot_receiver_;
+  std::optional<YaoInputBatch::Range> batch_range_;
+  // random choices of the OTs and the received keys
+  ENCRYPTO::BitVector<> random_choices_;
+  ENCRYPTO::block128_vector ot_keys_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> keys_future_;
+
+  ENCRYPTO::block128_vector compute_ot_outputs(ENCRYPTO::BitVector<> choices);
 };
 
-class YaoOutputGateGarbler : public detail::BasicYaoOutputGate {
+class YaoOutputGateGarbler : public detail::BasicYaoOutputGate, public LabelStreamingGate {
  public:
   YaoOutputGateGarbler(std::size_t gate_id, YaoProvider& yao_provider, YaoWireVector&& in,
                        OutputRecipient);
@@ -164,6 +217,10 @@ class YaoOutputGateGarbler : public detail::BasicYaoOutputGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 };
 
 class YaoOutputGateEvaluator : public detail::BasicYaoOutputGate {
@@ -175,15 +232,23 @@ class YaoOutputGateEvaluator : public detail::BasicYaoOutputGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 };
 
-class YaoINVGateGarbler : public detail::BasicYaoUnaryGate {
+class YaoINVGateGarbler : public detail::BasicYaoUnaryGate, public LabelStreamingGate {
  public:
   YaoINVGateGarbler(std::size_t gate_id, YaoProvider&, YaoWireVector&&);
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 };
 
 class YaoINVGateEvaluator : public detail::BasicYaoUnaryGate {
@@ -193,15 +258,20 @@ class YaoINVGateEvaluator : public detail::BasicYaoUnaryGate {
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override {}
   void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override;
 };
 
-class YaoXORGateGarbler : public detail::BasicYaoBinaryGate {
+class YaoXORGateGarbler : public detail::BasicYaoBinaryGate, public LabelStreamingGate {
  public:
   YaoXORGateGarbler(std::size_t gate_id, YaoProvider&, YaoWireVector&&, YaoWireVector&&);
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 };
 
 class YaoXORGateEvaluator : public detail::BasicYaoBinaryGate {
@@ -211,15 +281,28 @@ class YaoXORGateEvaluator : public detail::BasicYaoBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
+  std::optional<GateCost> get_cost() const override;
 };
 
-class YaoANDGateGarbler : public detail::BasicYaoBinaryGate {
+class YaoANDGateGarbler : public detail::BasicYaoBinaryGate, public LabelStreamingGate {
  public:
   YaoANDGateGarbler(std::size_t gate_id, YaoProvider&, YaoWireVector&&, YaoWireVector&&);
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return false; }
   void evaluate_setup() override;
   void evaluate_online() override {}
+  // garble the AND gates in parallel chunks on the threads of the context
+  void evaluate_setup_with_context(ExecutionContext&) override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
+
+ private:
+  void evaluate_setup_impl(ExecutionContext*);
+
+  // acknowledgment of the tables by the evaluator, if the provider bounds the tables in flight
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> window_ack_fut_;
 };
 
 class YaoANDGateEvaluator : public detail::BasicYaoBinaryGate {
@@ -229,9 +312,20 @@ class YaoANDGateEvaluator : public detail::BasicYaoBinaryGate {
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
+  // evaluate the AND gates in parallel chunks on the threads of the context
+  void evaluate_online_with_context(ExecutionContext&) override;
+  std::optional<GateCost> get_cost() const override;
+  bool supports_preprocessing_store() const noexcept override { return true; }
+  void save_setup(PreprocessingWriter&) override;
+  void load_setup(PreprocessingRecord&) override;
 
  private:
+  void evaluate_online_impl(ExecutionContext*);
+
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbled_tables_fut_;
+  ENCRYPTO::block128_vector garbled_tables_;
+  // tables in the mapped preprocessing store, copied to garbled_tables_ in the online phase
+  std::span<const std::byte> stored_tables_;
 };
 
 }  // namespace MOTION::proto::yao
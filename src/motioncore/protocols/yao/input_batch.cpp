@@ -0,0 +1,205 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "input_batch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "crypto/oblivious_transfer/ot_flavors.h"
+#include "crypto/oblivious_transfer/ot_provider.h"
+#include "yao_provider.h"
+
+namespace MOTION::proto::yao {
+
+YaoInputBatch::YaoInputBatch(YaoProvider& yao_provider,
+                             ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider, bool garbler)
+    : yao_provider_(yao_provider), ot_provider_(ot_provider), garbler_(garbler) {}
+
+YaoInputBatch::~YaoInputBatch() = default;
+
+YaoInputBatch::Range YaoInputBatch::reserve(std::size_t gate_id, std::size_t num_ots,
+                                            std::size_t num_corrections, std::size_t num_keys) {
+  if (ot_sender_ != nullptr || ot_receiver_ != nullptr) {
+    throw std::logic_error("YaoInputBatch: cannot reserve OTs after they have been registered");
+  }
+  if (setup_.num_gates == 0 && online_.num_gates == 0) {
+    gate_id_ = gate_id;
+  }
+  Range range{num_ots_, num_ots, num_corrections_, num_corrections, num_keys_, num_keys};
+  num_ots_ += num_ots;
+  num_corrections_ += num_corrections;
+  num_keys_ += num_keys;
+  if (num_ots > 0) {
+    ++setup_.num_gates;
+  }
+  if (num_keys > 0) {
+    ++online_.num_gates;
+  }
+  if (num_corrections > 0) {
+    if (num_corrections != num_keys) {
+      throw std::logic_error("YaoInputBatch: need a choice correction for each key");
+    }
+    corrected_ranges_.push_back(range);
+  }
+  return range;
+}
+
+void YaoInputBatch::register_ots() {
+  if (ot_sender_ != nullptr || ot_receiver_ != nullptr || num_ots_ == 0) {
+    return;
+  }
+  if (garbler_) {
+    ot_sender_ = ot_provider_.RegisterSendFixedXCOT128(num_ots_);
+  } else {
+    ot_receiver_ = ot_provider_.RegisterReceiveFixedXCOT128(num_ots_);
+    choices_ = ENCRYPTO::BitVector<>(num_ots_);
+  }
+}
+
+void YaoInputBatch::register_messages() {
+  if (garbler_) {
+    if (num_corrections_ > 0) {
+      choice_corrections_future_ =
+          yao_provider_.register_for_bits_message(gate_id_, num_corrections_);
+    }
+    keys_ = ENCRYPTO::block128_vector(num_keys_);
+  } else {
+    if (num_keys_ > 0) {
+      keys_future_ = yao_provider_.register_for_blocks_message(gate_id_, num_keys_);
+    }
+    choice_corrections_ = ENCRYPTO::BitVector<>(num_corrections_);
+  }
+}
+
+bool YaoInputBatch::contribute(Phase& phase) {
+  return ++phase.num_contributions == phase.num_gates;
+}
+
+ENCRYPTO::block128_vector YaoInputBatch::send_ots(const Range& range) {
+  if (ot_sender_ == nullptr) {
+    throw std::logic_error("YaoInputBatch: OTs need to be registered before use");
+  }
+  bool last_contribution;
+  {
+    std::scoped_lock lock(mutex_);
+    last_contribution = contribute(setup_);
+  }
+  if (last_contribution) {
+    ot_sender_->SetCorrelation(yao_provider_.get_global_offset());
+    ot_sender_->SendMessages();
+    ot_sender_->ComputeOutputs();
+    ot_outputs_ = std::move(ot_sender_->GetOutputs());
+    setup_.promise.set_value();
+  }
+  setup_.future.wait();
+  return ENCRYPTO::block128_vector(range.num_ots, ot_outputs_.data() + range.ot_offset);
+}
+
+ENCRYPTO::block128_vector YaoInputBatch::receive_ots(const Range& range,
+                                                     const ENCRYPTO::BitVector<>& choices) {
+  if (ot_receiver_ == nullptr) {
+    throw std::logic_error("YaoInputBatch: OTs need to be registered before use");
+  }
+  if (choices.GetSize() != range.num_ots) {
+    throw std::invalid_argument(fmt::format("YaoInputBatch: expected {} choices, got {}",
+                                            range.num_ots, choices.GetSize()));
+  }
+  bool last_contribution;
+  {
+    std::scoped_lock lock(mutex_);
+    choices_.Copy(range.ot_offset, range.ot_offset + range.num_ots, choices);
+    last_contribution = contribute(setup_);
+  }
+  if (last_contribution) {
+    ot_receiver_->SetChoices(std::move(choices_));
+    ot_receiver_->SendCorrections();
+    ot_receiver_->ComputeOutputs();
+    ot_outputs_ = ot_receiver_->GetOutputs();
+    setup_.promise.set_value();
+  }
+  setup_.future.wait();
+  return ENCRYPTO::block128_vector(range.num_ots, ot_outputs_.data() + range.ot_offset);
+}
+
+void YaoInputBatch::send_keys(const Range& range, const ENCRYPTO::block128_vector& keys) {
+  if (keys.size() != range.num_keys) {
+    throw std::invalid_argument(
+        fmt::format("YaoInputBatch: expected {} keys, got {}", range.num_keys, keys.size()));
+  }
+  bool last_contribution;
+  {
+    std::scoped_lock lock(mutex_);
+    std::copy_n(keys.data(), range.num_keys, keys_.data() + range.key_offset);
+    last_contribution = contribute(online_);
+  }
+  if (!last_contribution) {
+    // nothing to wait for, the last gate sends the message
+    return;
+  }
+  if (num_corrections_ > 0) {
+    // the evaluator has received the zero keys of the OTs xor c * offset for random choices c
+    // and sends d = input xor c, so the keys masks are corrected with d * offset
+    const auto global_offset = yao_provider_.get_global_offset();
+    const auto choice_corrections = choice_corrections_future_.get();
+    for (const auto& corrected : corrected_ranges_) {
+      auto keys_ptr = keys_.data() + corrected.key_offset;
+      for (std::size_t bit_i = 0; bit_i < corrected.num_corrections; ++bit_i) {
+        if (choice_corrections.Get(corrected.correction_offset + bit_i)) {
+          keys_ptr[bit_i] ^= global_offset;
+        }
+      }
+    }
+  }
+  yao_provider_.send_blocks_message(gate_id_, std::move(keys_));
+}
+
+ENCRYPTO::block128_vector YaoInputBatch::receive_keys(
+    const Range& range, const ENCRYPTO::BitVector<>& choice_corrections) {
+  if (choice_corrections.GetSize() != range.num_corrections) {
+    throw std::invalid_argument(fmt::format("YaoInputBatch: expected {} choice corrections, got {}",
+                                            range.num_corrections, choice_corrections.GetSize()));
+  }
+  bool last_contribution;
+  {
+    std::scoped_lock lock(mutex_);
+    if (range.num_corrections > 0) {
+      choice_corrections_.Copy(range.correction_offset,
+                               range.correction_offset + range.num_corrections, choice_corrections);
+    }
+    last_contribution = contribute(online_);
+  }
+  if (last_contribution) {
+    if (num_corrections_ > 0) {
+      yao_provider_.send_bits_message(gate_id_, std::move(choice_corrections_));
+    }
+    keys_ = keys_future_.get();
+    online_.promise.set_value();
+  }
+  online_.future.wait();
+  return ENCRYPTO::block128_vector(range.num_keys, keys_.data() + range.key_offset);
+}
+
+}  // namespace MOTION::proto::yao
@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/fiber/future.hpp>
+
+#include "utility/bit_vector.h"
+#include "utility/block.h"
+#include "utility/reusable_future.h"
+
+namespace ENCRYPTO::ObliviousTransfer {
+class FixedXCOT128Receiver;
+class FixedXCOT128Sender;
+class OTProvider;
+}  // namespace ENCRYPTO::ObliviousTransfer
+
+namespace MOTION::proto::yao {
+
+class YaoProvider;
+
+// Combines the OTs and the messages of all Yao input gates of a circuit (see
+// YaoProvider::set_batch_input_ots), s.t. a circuit with many small input gates, e.g., one per
+// byte of an AES key, runs a single batch of XCOTs in the setup phase and sends a single message
+// with the choice corrections of the evaluator and a single message with the keys of the garbler
+// in the online phase.
+//
+// Usage: every input gate reserves its OTs, choice corrections and keys with reserve() when it
+// is created.  Then register_ots() registers the combined OTs with the OTProvider, which needs to
+// happen before the OT extension setup, and register_messages() the combined messages.  In each
+// phase, the gates pass their part to the batch, which blocks until all gates have done so.
+// Hence, the input gates need to be evaluated concurrently.
+class YaoInputBatch {
+ public:
+  // the part of the batch belonging to a gate
+  struct Range {
+    std::size_t ot_offset;
+    std::size_t num_ots;
+    std::size_t correction_offset;
+    std::size_t num_corrections;
+    std::size_t key_offset;
+    std::size_t num_keys;
+  };
+
+  YaoInputBatch(YaoProvider&, ENCRYPTO::ObliviousTransfer::OTProvider&, bool garbler);
+  ~YaoInputBatch();
+
+  // Reserve num_ots OTs in the setup phase, num_corrections choice corrections of the evaluator
+  // and num_keys keys of the garbler in the online phase.  The messages are sent with the gate id
+  // of the first gate of the batch.
+  Range reserve(std::size_t gate_id, std::size_t num_ots, std::size_t num_corrections,
+                std::size_t num_keys);
+  void register_ots();
+  void register_messages();
+  std::size_t get_num_ots() const noexcept { return num_ots_; }
+
+  // setup phase: the garbler's outputs of the XCOTs with the global offset as correlation, and the
+  // evaluator's outputs for the given choices
+  ENCRYPTO::block128_vector send_ots(const Range&);
+  ENCRYPTO::block128_vector receive_ots(const Range&, const ENCRYPTO::BitVector<>& choices);
+
+  // Online phase: the garbler passes the keys of its part, which are corrected with the global
+  // offset by the choice corrections of the evaluator if the range has any.  The evaluator passes
+  // its choice corrections, and gets the keys of its part.
+  void send_keys(const Range&, const ENCRYPTO::block128_vector& keys);
+  ENCRYPTO::block128_vector receive_keys(const Range&,
+                                         const ENCRYPTO::BitVector<>& choice_corrections);
+
+ private:
+  // gates which have contributed to a phase, and the signal that the phase is complete
+  struct Phase {
+    std::size_t num_gates = 0;
+    std::size_t num_contributions = 0;
+    boost::fibers::promise<void> promise;
+    boost::fibers::shared_future<void> future = promise.get_future().share();
+  };
+  // count a contribution and return whether it was the last one
+  bool contribute(Phase&);
+
+  YaoProvider& yao_provider_;
+  ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider_;
+  bool garbler_;
+  std::size_t gate_id_ = 0;
+  std::size_t num_ots_ = 0;
+  std::size_t num_corrections_ = 0;
+  std::size_t num_keys_ = 0;
+  // ranges of the garbler whose keys are corrected by the choice corrections
+  std::vector<Range> corrected_ranges_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Sender> ot_sender_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Receiver> ot_receiver_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> choice_corrections_future_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> keys_future_;
+
+  std::mutex mutex_;
+  Phase setup_;
+  Phase online_;
+  ENCRYPTO::BitVector<> choices_;
+  ENCRYPTO::block128_vector ot_outputs_;
+  ENCRYPTO::BitVector<> choice_corrections_;
+  ENCRYPTO::block128_vector keys_;
+};
+
+}  // namespace MOTION::proto::yao
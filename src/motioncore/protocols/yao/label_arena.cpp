@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "label_arena.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace MOTION::proto::yao {
+
+ENCRYPTO::block128_vector LabelArena::allocate(std::size_t num_keys) {
+  const auto num_bytes = num_keys * sizeof(ENCRYPTO::block128_t);
+  {
+    std::scoped_lock lock(mutex_);
+    num_live_bytes_ += num_bytes;
+    peak_live_bytes_ = std::max(peak_live_bytes_, num_live_bytes_);
+    if (auto it = free_buffers_.find(num_keys); it != free_buffers_.end() && !it->second.empty()) {
+      auto keys = std::move(it->second.back());
+      it->second.pop_back();
+      num_free_bytes_ -= num_bytes;
+      return keys;
+    }
+  }
+  // allocate outside of the lock
+  return ENCRYPTO::block128_vector(num_keys);
+}
+
+void LabelArena::release(ENCRYPTO::block128_vector&& keys) {
+  const auto num_keys = keys.size();
+  if (num_keys == 0) {
+    return;
+  }
+  const auto num_bytes = num_keys * sizeof(ENCRYPTO::block128_t);
+  std::scoped_lock lock(mutex_);
+  num_live_bytes_ -= std::min(num_live_bytes_, num_bytes);
+  num_free_bytes_ += num_bytes;
+  free_buffers_[num_keys].push_back(std::move(keys));
+}
+
+void LabelArena::clear() {
+  std::scoped_lock lock(mutex_);
+  free_buffers_.clear();
+  num_free_bytes_ = 0;
+}
+
+std::size_t LabelArena::get_num_live_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return num_live_bytes_;
+}
+
+std::size_t LabelArena::get_peak_live_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return peak_live_bytes_;
+}
+
+std::size_t LabelArena::get_num_free_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return num_free_bytes_;
+}
+
+}  // namespace MOTION::proto::yao
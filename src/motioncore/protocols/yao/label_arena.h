@@ -0,0 +1,63 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/block.h"
+
+namespace MOTION::proto::yao {
+
+// Pool of the key buffers of the garbler's Yao wires used by label streaming (see
+// YaoProvider::set_label_streaming).  The buffers are 128 bit aligned block128_vectors, and the
+// ones which are released are kept in free lists by their number of keys, s.t. the outputs of
+// later gates reuse the memory of the wires which are not needed anymore instead of the heap.
+// Since the free-XOR offset is global, only the zero keys are stored.
+class LabelArena {
+ public:
+  // get a buffer of num_keys uninitialized keys
+  ENCRYPTO::block128_vector allocate(std::size_t num_keys);
+  // return a buffer obtained from allocate() which is not used anymore
+  void release(ENCRYPTO::block128_vector&& keys);
+  // free the buffers in the free lists
+  void clear();
+
+  // bytes in buffers which have been allocated and not released
+  std::size_t get_num_live_bytes() const;
+  // maximum of get_num_live_bytes() so far
+  std::size_t get_peak_live_bytes() const;
+  // bytes in buffers kept for reuse
+  std::size_t get_num_free_bytes() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::size_t, std::vector<ENCRYPTO::block128_vector>> free_buffers_;
+  std::size_t num_live_bytes_ = 0;
+  std::size_t peak_live_bytes_ = 0;
+  std::size_t num_free_bytes_ = 0;
+};
+
+}  // namespace MOTION::proto::yao
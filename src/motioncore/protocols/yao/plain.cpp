@@ -58,6 +58,15 @@ BasicYaoPlainBinaryGate::BasicYaoPlainBinaryGate(std::size_t gate_id, YaoProvide
                   [num_simd] { return std::make_shared<YaoWire>(num_simd); });
 }
 
+void BasicYaoPlainBinaryGate::collect_input_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, inputs_yao_);
+  MOTION::detail::append_wires(wires, inputs_plain_);
+}
+
+void BasicYaoPlainBinaryGate::collect_output_wires(std::vector<const NewWire*>& wires) const {
+  MOTION::detail::append_wires(wires, outputs_);
+}
+
 }  // namespace detail
 
 void YaoXORPlainGateGarbler::evaluate_setup() {
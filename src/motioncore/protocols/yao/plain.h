@@ -42,6 +42,8 @@ class BasicYaoPlainBinaryGate : public NewGate {
   BasicYaoPlainBinaryGate(std::size_t gate_id, YaoProvider&, YaoWireVector&&,
                           plain::BooleanPlainWireVector&&);
   YaoWireVector& get_output_wires() noexcept { return outputs_; };
+  void collect_input_wires(std::vector<const NewWire*>&) const override;
+  void collect_output_wires(std::vector<const NewWire*>&) const override;
 
  protected:
   YaoProvider& yao_provider_;
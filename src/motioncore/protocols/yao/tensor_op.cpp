@@ -41,23 +41,60 @@ std::size_t padded_size(std::size_t data_size, std::size_t bit_size) {
   return data_size + (bit_size - data_size % bit_size);
 }
 
+// drop the keys of all but the most significant bits of the values, which are stored last
+void keep_msb_keys(ENCRYPTO::block128_vector& keys, std::size_t bit_size, std::size_t data_size) {
+  keys = ENCRYPTO::block128_vector(data_size, keys.data() + (bit_size - 1) * data_size);
+}
+
+// values per message of the garbled tables of the ReLU, see YaoProvider::set_tensor_chunk_size()
+std::size_t get_relu_chunk_size(const YaoProvider& yao_provider, std::size_t data_size) {
+  const auto chunk_size = yao_provider.get_tensor_chunk_size();
+  return (chunk_size == 0) ? data_size : std::min(chunk_size, data_size);
+}
+
+// decode the output keys of values stored wire by wire with the permutation bits of the garbler
+template <typename T>
+std::vector<T> decode_masked_values(const ENCRYPTO::block128_vector& output_keys,
+                                    const ENCRYPTO::BitVector<>& output_info,
+                                    std::size_t data_size) {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  assert(output_keys.size() == bit_size * data_size);
+  assert(output_info.GetSize() == bit_size * data_size);
+  std::vector<T> values(data_size);
+#pragma omp parallel for
+  for (std::size_t int_i = 0; int_i < data_size; ++int_i) {
+    T value = 0;
+    for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
+      const auto idx = bit_j * data_size + int_i;
+      if (bool(*output_keys[idx].data() & std::byte{0x01}) != output_info.Get(idx)) {
+        value |= T(1) << bit_j;
+      }
+    }
+    values[int_i] = value;
+  }
+  return values;
+}
+
 }  // namespace
 
 // A -> Y Garbler side
 
 template <typename T>
 ArithmeticGMWToYaoTensorConversionGarbler<T>::ArithmeticGMWToYaoTensorConversionGarbler(
-    std::size_t gate_id, YaoProvider& yao_provider, const gmw::ArithmeticGMWTensorCP<T> input)
+    std::size_t gate_id, YaoProvider& yao_provider, const gmw::ArithmeticGMWTensorCP<T> input,
+    bool msb_only)
     : NewGate(gate_id),
       yao_provider_(yao_provider),
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
-      output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
+      msb_only_(msb_only),
+      output_(std::make_shared<YaoTensor>(input->get_dimensions(), msb_only ? 1 : bit_size_)),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   auto& ot_provider = yao_provider_.get_ot_provider();
   ot_sender_ = ot_provider.RegisterSendGOT128(bit_size_ * data_size_);
-  output_->get_keys().resize(bit_size_ * data_size_);
+  output_->get_keys().resize(output_->get_bit_size() * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -102,6 +139,9 @@ void ArithmeticGMWToYaoTensorConversionGarbler<T>::evaluate_setup() {
   yao_provider_.create_garbled_circuit(gate_id_, data_size_, addition_algo_, garbler_input_keys_,
                                        evaluator_input_keys_, garbled_tables_, output_->get_keys(),
                                        true);
+  if (msb_only_) {
+    keep_msb_keys(output_->get_keys(), bit_size_, data_size_);
+  }
   yao_provider_.CommMixin::send_blocks_message(1, gate_id_, std::move(garbled_tables_), 1);
   output_->set_setup_ready();
 
@@ -164,14 +204,17 @@ template class ArithmeticGMWToYaoTensorConversionGarbler<std::uint64_t>;
 
 template <typename T>
 ArithmeticGMWToYaoTensorConversionEvaluator<T>::ArithmeticGMWToYaoTensorConversionEvaluator(
-    std::size_t gate_id, YaoProvider& yao_provider, const gmw::ArithmeticGMWTensorCP<T> input)
+    std::size_t gate_id, YaoProvider& yao_provider, const gmw::ArithmeticGMWTensorCP<T> input,
+    bool msb_only)
     : NewGate(gate_id),
       yao_provider_(yao_provider),
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
-      output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
+      msb_only_(msb_only),
+      output_(std::make_shared<YaoTensor>(input->get_dimensions(), msb_only ? 1 : bit_size_)),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   // assert(input->get_share().size() % bit_size_ == 0);
   auto& ot_provider = yao_provider_.get_ot_provider();
   ot_receiver_ = ot_provider.RegisterReceiveGOT128(bit_size_ * data_size_);
@@ -179,7 +222,7 @@ ArithmeticGMWToYaoTensorConversionEvaluator<T>::ArithmeticGMWToYaoTensorConversi
       yao_provider_.CommMixin::register_for_blocks_message(0, gate_id, bit_size_ * data_size_, 0);
   garbled_tables_future_ = yao_provider_.CommMixin::register_for_blocks_message(
       0, gate_id, 2 * (bit_size_ - 1) * data_size_, 1);
-  output_->get_keys().resize(bit_size_ * data_size_);
+  output_->get_keys().resize(output_->get_bit_size() * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -251,6 +294,9 @@ void ArithmeticGMWToYaoTensorConversionEvaluator<T>::evaluate_online() {
     yao_provider_.evaluate_garbled_circuit(gate_id_, data_size_, addition_algo_,
                                            garbler_input_keys_, evaluator_input_keys_,
                                            garbled_tables_, output_->get_keys(), true);
+    if (msb_only_) {
+      keep_msb_keys(output_->get_keys(), bit_size_, data_size_);
+    }
     output_->set_online_ready();
   }
 
@@ -278,6 +324,7 @@ YaoToArithmeticGMWTensorConversionGarbler<T>::YaoToArithmeticGMWTensorConversion
       output_(std::make_shared<gmw::ArithmeticGMWTensor<T>>(input->get_dimensions())),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -366,6 +413,7 @@ YaoToArithmeticGMWTensorConversionEvaluator<T>::YaoToArithmeticGMWTensorConversi
       output_(std::make_shared<gmw::ArithmeticGMWTensor<T>>(input->get_dimensions())),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   garbler_input_keys_future_ =
       yao_provider_.CommMixin::register_for_blocks_message(0, gate_id, bit_size_ * data_size_, 0);
   garbled_tables_future_ = yao_provider_.CommMixin::register_for_blocks_message(
@@ -483,6 +531,7 @@ YaoToBooleanGMWTensorConversionGarbler::YaoToBooleanGMWTensorConversionGarbler(
       input_(std::move(input)) {
   const auto& tensor_dims = input_->get_dimensions();
   output_ = std::make_shared<gmw::BooleanGMWTensor>(tensor_dims, bit_size_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
   auto& shares = output_->get_share();
   for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
     shares.at(bit_j) = ENCRYPTO::BitVector<>(data_size_);
@@ -534,6 +583,7 @@ YaoToBooleanGMWTensorConversionEvaluator::YaoToBooleanGMWTensorConversionEvaluat
       input_(std::move(input)) {
   const auto& tensor_dims = input_->get_dimensions();
   output_ = std::make_shared<gmw::BooleanGMWTensor>(tensor_dims, bit_size_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
   auto& shares = output_->get_share();
   for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
     shares.at(bit_j) = ENCRYPTO::BitVector<>(data_size_);
@@ -579,17 +629,20 @@ void YaoToBooleanGMWTensorConversionEvaluator::evaluate_online() {
 
 template <typename T>
 ArithmeticBEAVYToYaoTensorConversionGarbler<T>::ArithmeticBEAVYToYaoTensorConversionGarbler(
-    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input)
+    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input,
+    bool msb_only)
     : NewGate(gate_id),
       yao_provider_(yao_provider),
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
-      output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
+      msb_only_(msb_only),
+      output_(std::make_shared<YaoTensor>(input->get_dimensions(), msb_only ? 1 : bit_size_)),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   auto& ot_provider = yao_provider_.get_ot_provider();
   ot_sender_ = ot_provider.RegisterSendFixedXCOT128(bit_size_ * data_size_);
-  output_->get_keys().resize(bit_size_ * data_size_);
+  output_->get_keys().resize(output_->get_bit_size() * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -627,6 +680,9 @@ void ArithmeticBEAVYToYaoTensorConversionGarbler<T>::evaluate_setup() {
   yao_provider_.create_garbled_circuit(gate_id_, data_size_, addition_algo_, garbler_input_keys_,
                                        evaluator_input_keys_, garbled_tables_, output_->get_keys(),
                                        true);
+  if (msb_only_) {
+    keep_msb_keys(output_->get_keys(), bit_size_, data_size_);
+  }
   yao_provider_.CommMixin::send_blocks_message(1, gate_id_, std::move(garbled_tables_), 1);
   output_->set_setup_ready();
 
@@ -688,14 +744,17 @@ template class ArithmeticBEAVYToYaoTensorConversionGarbler<std::uint64_t>;
 
 template <typename T>
 ArithmeticBEAVYToYaoTensorConversionEvaluator<T>::ArithmeticBEAVYToYaoTensorConversionEvaluator(
-    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input)
+    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input,
+    bool msb_only)
     : NewGate(gate_id),
       yao_provider_(yao_provider),
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
-      output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
+      msb_only_(msb_only),
+      output_(std::make_shared<YaoTensor>(input->get_dimensions(), msb_only ? 1 : bit_size_)),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   // assert(input->get_share().size() % bit_size_ == 0);
   auto& ot_provider = yao_provider_.get_ot_provider();
   ot_receiver_ = ot_provider.RegisterReceiveFixedXCOT128(bit_size_ * data_size_);
@@ -703,7 +762,7 @@ ArithmeticBEAVYToYaoTensorConversionEvaluator<T>::ArithmeticBEAVYToYaoTensorConv
       yao_provider_.CommMixin::register_for_blocks_message(0, gate_id, bit_size_ * data_size_, 0);
   garbled_tables_future_ = yao_provider_.CommMixin::register_for_blocks_message(
       0, gate_id, 2 * (bit_size_ - 1) * data_size_, 1);
-  output_->get_keys().resize(bit_size_ * data_size_);
+  output_->get_keys().resize(output_->get_bit_size() * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -798,6 +857,9 @@ void ArithmeticBEAVYToYaoTensorConversionEvaluator<T>::evaluate_online() {
     yao_provider_.evaluate_garbled_circuit(gate_id_, data_size_, addition_algo_,
                                            garbler_input_keys_, evaluator_input_keys_,
                                            garbled_tables_, output_->get_keys(), true);
+    if (msb_only_) {
+      keep_msb_keys(output_->get_keys(), bit_size_, data_size_);
+    }
     output_->set_online_ready();
   }
 
@@ -827,6 +889,7 @@ YaoToArithmeticBEAVYTensorConversionGarbler<T>::YaoToArithmeticBEAVYTensorConver
           yao_provider.register_for_ints_message<T>(1, gate_id_, data_size_)),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
     if (logger) {
@@ -955,6 +1018,7 @@ YaoToArithmeticBEAVYTensorConversionEvaluator<T>::YaoToArithmeticBEAVYTensorConv
       output_(std::make_shared<beavy::ArithmeticBEAVYTensor<T>>(input->get_dimensions())),
       addition_algo_(yao_provider_.get_circuit_loader().load_circuit(
           fmt::format("int_add{}_size.bristol", ENCRYPTO::bit_size_v<T>), CircuitFormat::Bristol)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   garbler_input_keys_future_ =
       yao_provider_.CommMixin::register_for_blocks_message(0, gate_id, bit_size_ * data_size_, 0);
   garbled_tables_future_ = yao_provider_.CommMixin::register_for_blocks_message(
@@ -1097,6 +1161,312 @@ void YaoToArithmeticBEAVYTensorConversionEvaluator<T>::evaluate_online() {
 template class YaoToArithmeticBEAVYTensorConversionEvaluator<std::uint32_t>;
 template class YaoToArithmeticBEAVYTensorConversionEvaluator<std::uint64_t>;
 
+// BEAVY A -> Y -> ReLU -> BEAVY A Garbler side
+
+template <typename T>
+ArithmeticBEAVYYaoTensorReluGarbler<T>::ArithmeticBEAVYYaoTensorReluGarbler(
+    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input)
+    : NewGate(gate_id),
+      yao_provider_(yao_provider),
+      data_size_(input->get_dimensions().get_data_size()),
+      input_(input),
+      output_(std::make_shared<beavy::ArithmeticBEAVYTensor<T>>(input->get_dimensions())),
+      masked_value_public_share_future_(
+          yao_provider.register_for_ints_message<T>(1, gate_id_, data_size_)),
+      masked_relu_algo_(yao_provider_.get_circuit_loader().load_masked_relu_circuit(bit_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+  auto& ot_provider = yao_provider_.get_ot_provider();
+  ot_sender_ = ot_provider.RegisterSendFixedXCOT128(bit_size_ * data_size_);
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYYaoTensorReluGarbler<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+ArithmeticBEAVYYaoTensorReluGarbler<T>::~ArithmeticBEAVYYaoTensorReluGarbler() = default;
+
+template <typename T>
+void ArithmeticBEAVYYaoTensorReluGarbler<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluGarbler::evaluate_setup start", gate_id_));
+    }
+  }
+
+  const auto num_keys = bit_size_ * data_size_;
+  // sample the keys of garbler's input and of the mask
+  garbler_input_keys_ = ENCRYPTO::block128_vector::make_random(2 * num_keys);
+
+  // run OTs for resharing evaluator's arithmetic secret share
+  ot_sender_->SetCorrelation(yao_provider_.get_global_offset());
+  ot_sender_->SendMessages();
+  ot_sender_->ComputeOutputs();
+  const auto evaluator_input_keys = ot_sender_->GetOutputs();
+
+  // generate mask and create BEAVY share, see YaoToArithmeticBEAVYTensorConversionGarbler
+  auto mask = Helpers::RandomVector<T>(data_size_);
+  {
+    auto& mbp = yao_provider_.get_motion_base_provider();
+    auto& rng = mbp.get_their_randomness_generator(1);
+    auto& public_share = output_->get_public_share();
+    auto& secret_share = output_->get_secret_share();
+    auto random_ints = rng.GetUnsigned<T>(gate_id_, 3 * data_size_);
+    public_share.resize(data_size_);
+    std::copy_n(std::begin(random_ints), data_size_, std::begin(public_share));
+    secret_share.resize(data_size_);
+#pragma omp parallel for
+    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
+      secret_share[int_i] = random_ints[2 * data_size_ + int_i] + random_ints[data_size_ + int_i] -
+                            random_ints[int_i] + mask[int_i];
+    }
+    output_->set_setup_ready();
+  }
+
+  // garble the whole circuit and send the keys of the mask together with the tables
+  ENCRYPTO::block128_vector garbled_tables;
+  ENCRYPTO::block128_vector output_keys;
+  yao_provider_.create_garbled_circuit(gate_id_, data_size_, masked_relu_algo_,
+                                       garbler_input_keys_, evaluator_input_keys, garbled_tables,
+                                       output_keys, true);
+  {
+    ENCRYPTO::block128_vector message(num_keys + garbled_tables.size());
+    const auto& R = yao_provider_.get_global_offset();
+#pragma omp parallel for
+    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
+      for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+        const auto idx = bit_j * data_size_ + int_i;
+        message[idx] = garbler_input_keys_[num_keys + idx];
+        if (mask[int_i] & (T(1) << bit_j)) {
+          message[idx] ^= R;
+        }
+      }
+    }
+    std::copy_n(garbled_tables.data(), garbled_tables.size(), message.data() + num_keys);
+    yao_provider_.CommMixin::send_blocks_message(1, gate_id_, std::move(message), 1);
+  }
+  // send output information
+  {
+    ENCRYPTO::BitVector<> output_info(num_keys);
+    for (std::size_t i = 0; i < output_keys.size(); ++i) {
+      output_info.Set((*output_keys[i].data() & std::byte{0x01}) != std::byte{0x00}, i);
+    }
+    yao_provider_.CommMixin::send_bits_message(1, gate_id_, std::move(output_info), 2);
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluGarbler::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYYaoTensorReluGarbler<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluGarbler::evaluate_online start", gate_id_));
+    }
+  }
+
+  // send garbler's keys
+  {
+    input_->wait_online();
+    const auto& public_share = input_->get_public_share();
+    const auto& secret_share = input_->get_secret_share();
+    assert(public_share.size() == data_size_);
+    assert(secret_share.size() == data_size_);
+    ENCRYPTO::block128_vector msg(bit_size_ * data_size_, garbler_input_keys_.data());
+    const auto R = yao_provider_.get_global_offset();
+#pragma omp parallel for
+    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
+      T value = public_share[int_i] - secret_share[int_i];
+      for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+        if (value & (T(1) << bit_j)) {
+          msg[bit_j * data_size_ + int_i] ^= R;
+        }
+      }
+    }
+    yao_provider_.CommMixin::send_blocks_message(1, gate_id_, std::move(msg), 0);
+  }
+
+  // receive public share of shared masked value
+  auto& public_share = output_->get_public_share();
+  auto masked_value_public_share = masked_value_public_share_future_.get();
+  __gnu_parallel::transform(std::begin(masked_value_public_share),
+                            std::end(masked_value_public_share), std::begin(public_share),
+                            std::begin(public_share), std::minus{});
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluGarbler::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticBEAVYYaoTensorReluGarbler<std::uint32_t>;
+template class ArithmeticBEAVYYaoTensorReluGarbler<std::uint64_t>;
+
+// BEAVY A -> Y -> ReLU -> BEAVY A Evaluator side
+
+template <typename T>
+ArithmeticBEAVYYaoTensorReluEvaluator<T>::ArithmeticBEAVYYaoTensorReluEvaluator(
+    std::size_t gate_id, YaoProvider& yao_provider, const beavy::ArithmeticBEAVYTensorCP<T> input)
+    : NewGate(gate_id),
+      yao_provider_(yao_provider),
+      data_size_(input->get_dimensions().get_data_size()),
+      input_(input),
+      output_(std::make_shared<beavy::ArithmeticBEAVYTensor<T>>(input->get_dimensions())),
+      masked_relu_algo_(yao_provider_.get_circuit_loader().load_masked_relu_circuit(bit_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+  auto& ot_provider = yao_provider_.get_ot_provider();
+  ot_receiver_ = ot_provider.RegisterReceiveFixedXCOT128(bit_size_ * data_size_);
+  const auto& gates = masked_relu_algo_.gates_;
+  const std::size_t num_and_gates =
+      std::count_if(std::begin(gates), std::end(gates), [](const auto& op) {
+        return op.type_ == ENCRYPTO::PrimitiveOperationType::AND;
+      });
+  garbler_input_keys_future_ =
+      yao_provider_.CommMixin::register_for_blocks_message(0, gate_id, bit_size_ * data_size_, 0);
+  garbled_tables_future_ = yao_provider_.CommMixin::register_for_blocks_message(
+      0, gate_id, (bit_size_ + YaoProvider::garbled_table_size * num_and_gates) * data_size_, 1);
+  output_info_future_ =
+      yao_provider_.CommMixin::register_for_bits_message(0, gate_id_, bit_size_ * data_size_, 2);
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(
+          fmt::format("Gate {}: ArithmeticBEAVYYaoTensorReluEvaluator<T> created", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+ArithmeticBEAVYYaoTensorReluEvaluator<T>::~ArithmeticBEAVYYaoTensorReluEvaluator() = default;
+
+template <typename T>
+void ArithmeticBEAVYYaoTensorReluEvaluator<T>::evaluate_setup() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluEvaluator::evaluate_setup start", gate_id_));
+    }
+  }
+
+  // receive evaluator's keys
+  {
+    input_->wait_setup();
+    const auto& my_secret_share = input_->get_secret_share();
+    ENCRYPTO::BitVector<> ot_choices(data_size_ * bit_size_);
+    for (std::size_t int_i = 0; int_i < data_size_; ++int_i) {
+      T value = -my_secret_share[int_i];
+      for (std::size_t bit_j = 0; bit_j < bit_size_; ++bit_j) {
+        ot_choices.Set(bool(value & (T(1) << bit_j)), bit_j * data_size_ + int_i);
+      }
+    }
+    ot_receiver_->SetChoices(ot_choices);
+    ot_receiver_->SendCorrections();
+    ot_receiver_->ComputeOutputs();
+    evaluator_input_keys_ = ot_receiver_->GetOutputs();
+  }
+
+  // create BEAVY share, see YaoToArithmeticBEAVYTensorConversionEvaluator
+  {
+    auto& mbp = yao_provider_.get_motion_base_provider();
+    auto& rng = mbp.get_my_randomness_generator(0);
+    masked_value_secret_share_ = Helpers::RandomVector<T>(data_size_);
+    auto& public_share = output_->get_public_share();
+    auto& secret_share = output_->get_secret_share();
+    auto random_ints = rng.GetUnsigned<T>(gate_id_, 3 * data_size_);
+    public_share.resize(data_size_);
+    std::copy_n(std::begin(random_ints), data_size_, std::begin(public_share));
+    secret_share.resize(data_size_);
+#pragma omp parallel for
+    for (std::size_t int_j = 0; int_j < data_size_; ++int_j) {
+      secret_share[int_j] = masked_value_secret_share_[int_j] - random_ints[data_size_ + int_j];
+    }
+    masked_value_public_share_.resize(data_size_);
+    __gnu_parallel::transform(std::begin(masked_value_secret_share_),
+                              std::end(masked_value_secret_share_),
+                              std::begin(random_ints) + 2 * data_size_,
+                              std::begin(masked_value_public_share_), std::plus{});
+    output_->set_setup_ready();
+  }
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluEvaluator::evaluate_setup end", gate_id_));
+    }
+  }
+}
+
+template <typename T>
+void ArithmeticBEAVYYaoTensorReluEvaluator<T>::evaluate_online() {
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluEvaluator::evaluate_online start", gate_id_));
+    }
+  }
+
+  const auto num_keys = bit_size_ * data_size_;
+  // the keys of garbler's input and of the mask form the first input of the circuit
+  ENCRYPTO::block128_vector input_keys_a(2 * num_keys);
+  {
+    const auto garbler_input_keys = garbler_input_keys_future_.get();
+    std::copy_n(garbler_input_keys.data(), num_keys, input_keys_a.data());
+  }
+  const auto message = garbled_tables_future_.get();
+  std::copy_n(message.data(), num_keys, input_keys_a.data() + num_keys);
+  const ENCRYPTO::block128_vector garbled_tables(message.size() - num_keys,
+                                                 message.data() + num_keys);
+  ENCRYPTO::block128_vector output_keys;
+  yao_provider_.evaluate_garbled_circuit(gate_id_, data_size_, masked_relu_algo_, input_keys_a,
+                                         evaluator_input_keys_, garbled_tables, output_keys, true);
+
+  // reshare masked value in Arithmetic BEAVY and subtract shared mask
+  const auto masked_value =
+      decode_masked_values<T>(output_keys, output_info_future_.get(), data_size_);
+  __gnu_parallel::transform(std::begin(masked_value_public_share_),
+                            std::end(masked_value_public_share_), std::begin(masked_value),
+                            std::begin(masked_value_public_share_), std::plus{});
+  yao_provider_.send_ints_message(0, gate_id_, masked_value_public_share_);
+  auto& public_share = output_->get_public_share();
+  __gnu_parallel::transform(std::begin(masked_value_public_share_),
+                            std::end(masked_value_public_share_), std::begin(public_share),
+                            std::begin(public_share), std::minus{});
+  output_->set_online_ready();
+
+  if constexpr (MOTION_VERBOSE_DEBUG) {
+    auto logger = yao_provider_.get_logger();
+    if (logger) {
+      logger->LogTrace(fmt::format(
+          "Gate {}: ArithmeticBEAVYYaoTensorReluEvaluator::evaluate_online end", gate_id_));
+    }
+  }
+}
+
+template class ArithmeticBEAVYYaoTensorReluEvaluator<std::uint32_t>;
+template class ArithmeticBEAVYYaoTensorReluEvaluator<std::uint64_t>;
+
 // Y -> beta Garbler side
 
 YaoToBooleanBEAVYTensorConversionGarbler::YaoToBooleanBEAVYTensorConversionGarbler(
@@ -1108,6 +1478,7 @@ YaoToBooleanBEAVYTensorConversionGarbler::YaoToBooleanBEAVYTensorConversionGarbl
       input_(std::move(input)) {
   const auto& tensor_dims = input_->get_dimensions();
   output_ = std::make_shared<beavy::BooleanBEAVYTensor>(tensor_dims, bit_size_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
   public_share_future_ = yao_provider_.register_for_bits_message(gate_id, bit_size_ * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1187,6 +1558,7 @@ YaoToBooleanBEAVYTensorConversionEvaluator::YaoToBooleanBEAVYTensorConversionEva
       input_(std::move(input)) {
   const auto& tensor_dims = input_->get_dimensions();
   output_ = std::make_shared<beavy::BooleanBEAVYTensor>(tensor_dims, bit_size_);
+  output_->set_fractional_bits(input_->get_fractional_bits());
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -1267,9 +1639,10 @@ YaoTensorReluGarbler::YaoTensorReluGarbler(std::size_t gate_id, YaoProvider& yao
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
       output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
-      relu_algo_(yao_provider_.get_circuit_loader().load_relu_circuit(bit_size_)) {
-  garbled_tables_.resize(data_size_ * (bit_size_ - 1));
-  output_->get_keys().resize(bit_size_);
+      relu_algo_(yao_provider_.get_circuit_loader().load_relu_circuit(bit_size_)),
+      chunk_size_(get_relu_chunk_size(yao_provider_, data_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+  output_->get_keys().resize(bit_size_ * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
     auto logger = yao_provider_.get_logger();
@@ -1288,10 +1661,17 @@ void YaoTensorReluGarbler::evaluate_setup() {
     }
   }
 
-  // garble ReLU circuit
-  yao_provider_.create_garbled_circuit(gate_id_, data_size_, relu_algo_, input_->get_keys(), {},
-                                       garbled_tables_, output_->get_keys(), true);
-  yao_provider_.send_blocks_message(gate_id_, std::move(garbled_tables_));
+  // garble ReLU circuit chunk by chunk, the tables of a chunk are sent while the next one is
+  // garbled
+  const auto& input_keys = input_->get_keys();
+  auto& output_keys = output_->get_keys();
+  for (std::size_t chunk_i = 0, begin = 0; begin < data_size_; ++chunk_i, begin += chunk_size_) {
+    const auto end = std::min(begin + chunk_size_, data_size_);
+    ENCRYPTO::block128_vector garbled_tables;
+    yao_provider_.create_garbled_circuit_range(gate_id_, data_size_, begin, end, relu_algo_,
+                                               input_keys, {}, garbled_tables, output_keys, true);
+    yao_provider_.send_blocks_message(gate_id_, std::move(garbled_tables), chunk_i);
+  }
   output_->set_setup_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1310,9 +1690,14 @@ YaoTensorReluEvaluator::YaoTensorReluEvaluator(std::size_t gate_id, YaoProvider&
       data_size_(input->get_dimensions().get_data_size()),
       input_(input),
       output_(std::make_shared<YaoTensor>(input->get_dimensions(), bit_size_)),
-      relu_algo_(yao_provider_.get_circuit_loader().load_relu_circuit(bit_size_)) {
-  garbled_tables_future_ =
-      yao_provider_.register_for_blocks_message(gate_id, 2 * (bit_size_ - 1) * data_size_);
+      relu_algo_(yao_provider_.get_circuit_loader().load_relu_circuit(bit_size_)),
+      chunk_size_(get_relu_chunk_size(yao_provider_, data_size_)) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
+  for (std::size_t chunk_i = 0, begin = 0; begin < data_size_; ++chunk_i, begin += chunk_size_) {
+    const auto end = std::min(begin + chunk_size_, data_size_);
+    garbled_tables_futures_.push_back(yao_provider_.register_for_blocks_message(
+        gate_id, 2 * (bit_size_ - 1) * (end - begin), chunk_i));
+  }
   output_->get_keys().resize(bit_size_ * data_size_);
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1332,10 +1717,16 @@ void YaoTensorReluEvaluator::evaluate_online() {
     }
   }
 
-  // evaluate ReLU circuit
-  const auto garbled_tables = garbled_tables_future_.get();
-  yao_provider_.evaluate_garbled_circuit(gate_id_, data_size_, relu_algo_, input_->get_keys(), {},
-                                         garbled_tables, output_->get_keys(), true);
+  // evaluate ReLU circuit chunk by chunk as the tables arrive
+  const auto& input_keys = input_->get_keys();
+  auto& output_keys = output_->get_keys();
+  for (std::size_t chunk_i = 0, begin = 0; begin < data_size_; ++chunk_i, begin += chunk_size_) {
+    const auto end = std::min(begin + chunk_size_, data_size_);
+    const auto garbled_tables = garbled_tables_futures_[chunk_i].get();
+    yao_provider_.evaluate_garbled_circuit_range(gate_id_, data_size_, begin, end, relu_algo_,
+                                                 input_keys, {}, garbled_tables, output_keys,
+                                                 true);
+  }
   output_->set_online_ready();
 
   if constexpr (MOTION_VERBOSE_DEBUG) {
@@ -1361,6 +1752,7 @@ YaoTensorMaxPoolGarbler::YaoTensorMaxPoolGarbler(std::size_t gate_id, YaoProvide
       output_(std::make_shared<YaoTensor>(maxpool_op_.get_output_tensor_dims(), bit_size_)),
       maxpool_algo_(yao_provider_.get_circuit_loader().load_maxpool_circuit(
           bit_size_, maxpool_op_.compute_kernel_size())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   assert(maxpool_op_.verify());
   output_->get_keys().resize(data_size_ * bit_size_);
 
@@ -1413,6 +1805,7 @@ YaoTensorMaxPoolEvaluator::YaoTensorMaxPoolEvaluator(std::size_t gate_id, YaoPro
       output_(std::make_shared<YaoTensor>(maxpool_op_.get_output_tensor_dims(), bit_size_)),
       maxpool_algo_(yao_provider_.get_circuit_loader().load_maxpool_circuit(
           bit_size_, maxpool_op_.compute_kernel_size())) {
+  output_->set_fractional_bits(input_->get_fractional_bits());
   const std::size_t num_and_gates =
       (2 * bit_size_) * (maxpool_op_.compute_kernel_size() - 1) * maxpool_op_.compute_output_size();
   garbled_tables_future_ = yao_provider_.register_for_blocks_message(gate_id, 2 * num_and_gates);
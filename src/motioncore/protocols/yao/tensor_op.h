@@ -48,19 +48,28 @@ template <typename T>
 class ArithmeticGMWToYaoTensorConversionGarbler : public NewGate {
  public:
   ArithmeticGMWToYaoTensorConversionGarbler(std::size_t gate_id, YaoProvider&,
-                                            const gmw::ArithmeticGMWTensorCP<T> input);
+                                            const gmw::ArithmeticGMWTensorCP<T> input,
+                                            bool msb_only = false);
   ~ArithmeticGMWToYaoTensorConversionGarbler();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
   static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
   const std::size_t data_size_;
   const gmw::ArithmeticGMWTensorCP<T> input_;
+  // only keep the keys of the most significant bits
+  const bool msb_only_;
   YaoTensorP output_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::GOT128Sender> ot_sender_;
   ENCRYPTO::block128_vector garbler_input_keys_;
@@ -73,19 +82,28 @@ template <typename T>
 class ArithmeticGMWToYaoTensorConversionEvaluator : public NewGate {
  public:
   ArithmeticGMWToYaoTensorConversionEvaluator(std::size_t gate_id, YaoProvider&,
-                                              const gmw::ArithmeticGMWTensorCP<T> input);
+                                              const gmw::ArithmeticGMWTensorCP<T> input,
+                                              bool msb_only = false);
   ~ArithmeticGMWToYaoTensorConversionEvaluator();
   bool need_setup() const noexcept override { return false; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override {}
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
   static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
   const std::size_t data_size_;
   const gmw::ArithmeticGMWTensorCP<T> input_;
+  // only keep the keys of the most significant bits
+  const bool msb_only_;
   YaoTensorP output_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::GOT128Receiver> ot_receiver_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbler_input_keys_future_;
@@ -106,6 +124,12 @@ class YaoToArithmeticGMWTensorConversionGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override {}
   gmw::ArithmeticGMWTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -129,6 +153,12 @@ class YaoToArithmeticGMWTensorConversionEvaluator : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   gmw::ArithmeticGMWTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -151,6 +181,12 @@ class YaoToBooleanGMWTensorConversionGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override {}
   gmw::BooleanGMWTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -169,6 +205,12 @@ class YaoToBooleanGMWTensorConversionEvaluator : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   gmw::BooleanGMWTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -182,19 +224,28 @@ template <typename T>
 class ArithmeticBEAVYToYaoTensorConversionGarbler : public NewGate {
  public:
   ArithmeticBEAVYToYaoTensorConversionGarbler(std::size_t gate_id, YaoProvider&,
-                                              const beavy::ArithmeticBEAVYTensorCP<T> input);
+                                              const beavy::ArithmeticBEAVYTensorCP<T> input,
+                                              bool msb_only = false);
   ~ArithmeticBEAVYToYaoTensorConversionGarbler();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
   static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
   const std::size_t data_size_;
   const beavy::ArithmeticBEAVYTensorCP<T> input_;
+  // only keep the keys of the most significant bits
+  const bool msb_only_;
   YaoTensorP output_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Sender> ot_sender_;
   ENCRYPTO::block128_vector garbler_input_keys_;
@@ -207,19 +258,28 @@ template <typename T>
 class ArithmeticBEAVYToYaoTensorConversionEvaluator : public NewGate {
  public:
   ArithmeticBEAVYToYaoTensorConversionEvaluator(std::size_t gate_id, YaoProvider&,
-                                                const beavy::ArithmeticBEAVYTensorCP<T> input);
+                                                const beavy::ArithmeticBEAVYTensorCP<T> input,
+                                                bool msb_only = false);
   ~ArithmeticBEAVYToYaoTensorConversionEvaluator();
   bool need_setup() const noexcept override { return true; }
   bool need_online() const noexcept override { return true; }
   void evaluate_setup() override;
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
   static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
   const std::size_t data_size_;
   const beavy::ArithmeticBEAVYTensorCP<T> input_;
+  // only keep the keys of the most significant bits
+  const bool msb_only_;
   YaoTensorP output_;
   std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Receiver> ot_receiver_;
   ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbler_input_keys_future_;
@@ -240,6 +300,12 @@ class YaoToArithmeticBEAVYTensorConversionGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   beavy::ArithmeticBEAVYTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -264,6 +330,12 @@ class YaoToArithmeticBEAVYTensorConversionEvaluator : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   beavy::ArithmeticBEAVYTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -279,6 +351,76 @@ class YaoToArithmeticBEAVYTensorConversionEvaluator : public NewGate {
   const ENCRYPTO::AlgorithmDescription& addition_algo_;
 };
 
+// ReLU of an Arithmetic BEAVY tensor in Yao, i.e., the conversion to Yao, the ReLU and the
+// conversion back in one op.  The three steps are garbled as one circuit (see
+// CircuitLoader::load_masked_relu_circuit()), s.t. there is no intermediate Yao tensor and the
+// garbled tables and the keys of the mask are sent in a single message.
+template <typename T>
+class ArithmeticBEAVYYaoTensorReluGarbler : public NewGate {
+ public:
+  ArithmeticBEAVYYaoTensorReluGarbler(std::size_t gate_id, YaoProvider&,
+                                      const beavy::ArithmeticBEAVYTensorCP<T> input);
+  ~ArithmeticBEAVYYaoTensorReluGarbler();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  beavy::ArithmeticBEAVYTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  YaoProvider& yao_provider_;
+  static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
+  const std::size_t data_size_;
+  const beavy::ArithmeticBEAVYTensorCP<T> input_;
+  beavy::ArithmeticBEAVYTensorP<T> output_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Sender> ot_sender_;
+  // keys of the garbler's input followed by the keys of the mask
+  ENCRYPTO::block128_vector garbler_input_keys_;
+  ENCRYPTO::ReusableFiberFuture<std::vector<T>> masked_value_public_share_future_;
+  const ENCRYPTO::AlgorithmDescription& masked_relu_algo_;
+};
+
+template <typename T>
+class ArithmeticBEAVYYaoTensorReluEvaluator : public NewGate {
+ public:
+  ArithmeticBEAVYYaoTensorReluEvaluator(std::size_t gate_id, YaoProvider&,
+                                        const beavy::ArithmeticBEAVYTensorCP<T> input);
+  ~ArithmeticBEAVYYaoTensorReluEvaluator();
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return true; }
+  void evaluate_setup() override;
+  void evaluate_online() override;
+  beavy::ArithmeticBEAVYTensorCP<T> get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
+
+ private:
+  YaoProvider& yao_provider_;
+  static constexpr auto bit_size_ = ENCRYPTO::bit_size_v<T>;
+  const std::size_t data_size_;
+  const beavy::ArithmeticBEAVYTensorCP<T> input_;
+  beavy::ArithmeticBEAVYTensorP<T> output_;
+  std::unique_ptr<ENCRYPTO::ObliviousTransfer::FixedXCOT128Receiver> ot_receiver_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbler_input_keys_future_;
+  // keys of the mask followed by the garbled tables
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbled_tables_future_;
+  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> output_info_future_;
+  ENCRYPTO::block128_vector evaluator_input_keys_;
+  std::vector<T> masked_value_secret_share_;
+  std::vector<T> masked_value_public_share_;
+  const ENCRYPTO::AlgorithmDescription& masked_relu_algo_;
+};
+
 class YaoToBooleanBEAVYTensorConversionGarbler : public NewGate {
  public:
   YaoToBooleanBEAVYTensorConversionGarbler(std::size_t gate_id, YaoProvider&,
@@ -288,6 +430,12 @@ class YaoToBooleanBEAVYTensorConversionGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   beavy::BooleanBEAVYTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -307,6 +455,12 @@ class YaoToBooleanBEAVYTensorConversionEvaluator : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override;
   beavy::BooleanBEAVYTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -324,6 +478,12 @@ class YaoTensorReluGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override {}
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -331,8 +491,9 @@ class YaoTensorReluGarbler : public NewGate {
   const std::size_t data_size_;
   const YaoTensorCP input_;
   const YaoTensorP output_;
-  ENCRYPTO::block128_vector garbled_tables_;
   const ENCRYPTO::AlgorithmDescription& relu_algo_;
+  // values per message of garbled tables, see YaoProvider::set_tensor_chunk_size()
+  const std::size_t chunk_size_;
 };
 
 class YaoTensorReluEvaluator : public NewGate {
@@ -343,6 +504,12 @@ class YaoTensorReluEvaluator : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -350,8 +517,10 @@ class YaoTensorReluEvaluator : public NewGate {
   const std::size_t data_size_;
   const YaoTensorCP input_;
   const YaoTensorP output_;
-  ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> garbled_tables_future_;
   const ENCRYPTO::AlgorithmDescription& relu_algo_;
+  const std::size_t chunk_size_;
+  // one message per chunk
+  std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector>> garbled_tables_futures_;
 };
 
 class YaoTensorMaxPoolGarbler : public NewGate {
@@ -363,6 +532,12 @@ class YaoTensorMaxPoolGarbler : public NewGate {
   void evaluate_setup() override;
   void evaluate_online() override {}
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
@@ -384,6 +559,12 @@ class YaoTensorMaxPoolEvaluator : public NewGate {
   void evaluate_setup() override {}
   void evaluate_online() override;
   YaoTensorCP get_output_tensor() const noexcept { return output_; }
+  void collect_input_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, input_);
+  }
+  void collect_output_wires(std::vector<const NewWire*>& wires) const override {
+    MOTION::detail::append_wire(wires, output_);
+  }
 
  private:
   YaoProvider& yao_provider_;
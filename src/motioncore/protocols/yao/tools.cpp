@@ -54,7 +54,9 @@ void maxpool_rearrange_keys_in(ENCRYPTO::block128_vector& dst, const ENCRYPTO::b
                                std::size_t bit_size, const tensor::MaxPoolOp& maxpool_op) {
   using TensorType4C = Eigen::Tensor<const ENCRYPTO::block128_t, 4, Eigen::RowMajor>;
   using TensorType3 = Eigen::Tensor<ENCRYPTO::block128_t, 3, Eigen::RowMajor>;
-  const auto in_channels = static_cast<Eigen::Index>(maxpool_op.input_shape_[0]);
+  // the samples of a batch are pooled like additional channels
+  const auto in_channels =
+      static_cast<Eigen::Index>(maxpool_op.batch_size_ * maxpool_op.input_shape_[0]);
   const auto in_rows = static_cast<Eigen::Index>(maxpool_op.input_shape_[1]);
   const auto in_columns = static_cast<Eigen::Index>(maxpool_op.input_shape_[2]);
   const auto kernel_rows = static_cast<Eigen::Index>(maxpool_op.kernel_shape_[0]);
@@ -87,7 +89,8 @@ void maxpool_rearrange_keys_out(ENCRYPTO::block128_vector& dst,
   using TensorType2C = Eigen::Tensor<const ENCRYPTO::block128_t, 2, Eigen::RowMajor>;
   using TensorType4 = Eigen::Tensor<ENCRYPTO::block128_t, 4, Eigen::RowMajor>;
 
-  const auto out_channels = static_cast<Eigen::Index>(maxpool_op.output_shape_[0]);
+  const auto out_channels =
+      static_cast<Eigen::Index>(maxpool_op.batch_size_ * maxpool_op.output_shape_[0]);
   const auto out_rows = static_cast<Eigen::Index>(maxpool_op.output_shape_[1]);
   const auto out_columns = static_cast<Eigen::Index>(maxpool_op.output_shape_[2]);
   const auto num_patches = out_rows * out_columns;
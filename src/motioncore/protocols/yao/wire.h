@@ -37,6 +37,9 @@ class YaoProvider;
 class YaoWire : public NewWire, public ENCRYPTO::enable_wait_setup {
  public:
   YaoWire(std::size_t num_simd) : NewWire(num_simd), keys_(num_simd) {}
+  // the keys are allocated later by the gate computing them
+  struct deferred_keys_t {};
+  YaoWire(std::size_t num_simd, deferred_keys_t) : NewWire(num_simd) {}
   MPCProtocol get_protocol() const noexcept override { return MPCProtocol::Yao; }
   std::size_t get_bit_size() const noexcept override { return 1; }
   ENCRYPTO::block128_vector& get_keys() { return keys_; };
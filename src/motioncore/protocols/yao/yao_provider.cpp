@@ -23,8 +23,11 @@
 #include "yao_provider.h"
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <unordered_set>
 
 #include "algorithm/circuit_loader.h"
 #include "algorithm/make_circuit.h"
@@ -34,9 +37,13 @@
 #include "communication/message.h"
 #include "communication/message_handler.h"
 #include "conversion.h"
+#include "data_storage/preprocessing_store.h"
 #include "crypto/garbling/half_gates.h"
+#include "crypto/garbling/three_halves.h"
+#include "executor/execution_context.h"
 #include "gate.h"
 #include "gate/input_gate_adapter.h"
+#include "input_batch.h"
 #include "protocols/beavy/gate.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/gmw/gate.h"
@@ -122,6 +129,9 @@ YaoProvider::YaoProvider(Communication::CommunicationLayer& communication_layer,
       ot_provider_(ot_provider),
       hg_garbler_(nullptr),
       hg_evaluator_(nullptr),
+      garbling_scheme_(GarblingScheme::half_gates),
+      th_garbler_(nullptr),
+      th_evaluator_(nullptr),
       message_handler_(std::make_unique<YaoMessageHandler>(logger)),
       my_id_(communication_layer_.get_my_id()),
       role_((my_id_ == 0) ? Role::garbler : Role::evaluator),
@@ -346,6 +356,23 @@ ENCRYPTO::block128_t YaoProvider::get_shared_zero() const noexcept {
   return shared_zero_;
 }
 
+YaoInputBatch& YaoProvider::get_input_batch() {
+  if (!input_batch_) {
+    input_batch_ = std::make_unique<YaoInputBatch>(*this, ot_provider_, role_ == Role::garbler);
+  }
+  return *input_batch_;
+}
+
+void YaoProvider::register_batched_ots() {
+  if (input_batch_) {
+    if (logger_) {
+      logger_->LogDebug(fmt::format("YaoProvider: registering a batch of {} input XCOTs",
+                                    input_batch_->get_num_ots()));
+    }
+    input_batch_->register_ots();
+  }
+}
+
 void YaoProvider::setup() {
   if (setup_ran_) {
     throw std::logic_error("YaoProvider::setup already ran");
@@ -354,19 +381,148 @@ void YaoProvider::setup() {
     shared_zero_.set_to_random();
     hg_garbler_ = std::make_unique<Crypto::garbling::HalfGateGarbler>();
     auto public_data = hg_garbler_->get_public_data();
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      th_garbler_ = std::make_unique<Crypto::garbling::ThreeHalvesGarbler>(
+          hg_garbler_->get_offset(), public_data);
+    }
     communication_layer_.broadcast_message(
         build_yao_setup_message(public_data.aes_key, public_data.hash_key, shared_zero_));
+    if (label_streaming_) {
+      count_label_consumers();
+    }
   } else {
     auto public_data = message_handler_->hg_public_data_future_.get();
     hg_evaluator_ = std::make_unique<Crypto::garbling::HalfGateEvaluator>(public_data);
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      th_evaluator_ = std::make_unique<Crypto::garbling::ThreeHalvesEvaluator>(public_data);
+    }
     shared_zero_ = message_handler_->shared_zero_future_.get();
   }
+  if (input_batch_) {
+    input_batch_->register_messages();
+  }
   setup_ran_ = true;
 }
 
-void YaoProvider::send_blocks_message(std::size_t gate_id,
-                                      ENCRYPTO::block128_vector&& message) const {
-  CommMixin::send_blocks_message(1 - my_id_, gate_id, std::move(message));
+void YaoProvider::count_label_consumers() {
+  // wires read by other gates, e.g., conversions, need to keep their keys
+  std::unordered_map<const NewWire*, std::size_t> num_consumers;
+  std::unordered_set<const NewWire*> pinned_wires;
+  std::vector<const NewWire*> wires;
+  for (const auto& gate : gate_register_.get_gates()) {
+    wires.clear();
+    gate->collect_input_wires(wires);
+    if (dynamic_cast<const LabelStreamingGate*>(gate.get()) != nullptr) {
+      for (const auto* wire : wires) {
+        ++num_consumers[wire];
+      }
+    } else {
+      pinned_wires.insert(std::begin(wires), std::end(wires));
+    }
+  }
+  label_consumers_.clear();
+  for (const auto& gate : gate_register_.get_gates()) {
+    if (dynamic_cast<const LabelStreamingGate*>(gate.get()) == nullptr) {
+      continue;
+    }
+    wires.clear();
+    gate->collect_output_wires(wires);
+    for (const auto* wire : wires) {
+      if (auto it = num_consumers.find(wire);
+          it != std::end(num_consumers) && !pinned_wires.contains(wire)) {
+        label_consumers_.try_emplace(wire, it->second);
+      }
+    }
+  }
+}
+
+ENCRYPTO::block128_vector YaoProvider::allocate_keys(std::size_t num_keys) {
+  if (!is_label_streaming()) {
+    return ENCRYPTO::block128_vector(num_keys);
+  }
+  return label_arena_.allocate(num_keys);
+}
+
+void YaoProvider::release_input_keys(const YaoWireVector& wires) {
+  if (label_consumers_.empty()) {
+    return;
+  }
+  for (const auto& wire : wires) {
+    auto it = label_consumers_.find(wire.get());
+    if (it == std::end(label_consumers_)) {
+      continue;
+    }
+    // the last gate reading the keys frees them
+    if (it->second.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      label_arena_.release(std::move(wire->get_keys()));
+    }
+  }
+}
+
+void YaoProvider::save_setup(PreprocessingWriter& writer) const {
+  if (!setup_ran_) {
+    throw std::logic_error("setup phase not executed, nothing to store");
+  }
+  if (is_label_streaming()) {
+    throw std::logic_error("the preprocessing store needs the keys freed by label streaming");
+  }
+  writer.write_ints(std::vector<std::uint8_t>{static_cast<std::uint8_t>(garbling_scheme_)});
+  // the garbler additionally stores the global offset in front of the public data
+  if (role_ == Role::garbler) {
+    const auto public_data = hg_garbler_->get_public_data();
+    ENCRYPTO::block128_vector blocks(4);
+    blocks[0] = hg_garbler_->get_offset();
+    blocks[1] = public_data.hash_key;
+    blocks[2] = public_data.aes_key;
+    blocks[3] = shared_zero_;
+    writer.write_blocks(blocks);
+  } else {
+    const auto public_data = hg_evaluator_->get_public_data();
+    ENCRYPTO::block128_vector blocks(3);
+    blocks[0] = public_data.hash_key;
+    blocks[1] = public_data.aes_key;
+    blocks[2] = shared_zero_;
+    writer.write_blocks(blocks);
+  }
+}
+
+void YaoProvider::load_setup(PreprocessingRecord& record) {
+  if (setup_ran_) {
+    throw std::logic_error("YaoProvider::setup already ran");
+  }
+  const auto scheme = record.read_ints<std::uint8_t>();
+  if (scheme.size() != 1 || scheme[0] != static_cast<std::uint8_t>(garbling_scheme_)) {
+    throw std::runtime_error("preprocessing store was created with another garbling scheme");
+  }
+  const auto blocks = record.read_blocks();
+  if (blocks.size() != (role_ == Role::garbler ? 4 : 3)) {
+    throw std::runtime_error("preprocessing store contains no valid Yao setup");
+  }
+  if (role_ == Role::garbler) {
+    const Crypto::garbling::HalfGatePublicData public_data{blocks[1], blocks[2]};
+    hg_garbler_ = std::make_unique<Crypto::garbling::HalfGateGarbler>(blocks[0], public_data);
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      th_garbler_ =
+          std::make_unique<Crypto::garbling::ThreeHalvesGarbler>(blocks[0], public_data);
+    }
+    shared_zero_ = blocks[3];
+  } else {
+    const Crypto::garbling::HalfGatePublicData public_data{blocks[0], blocks[1]};
+    hg_evaluator_ = std::make_unique<Crypto::garbling::HalfGateEvaluator>(public_data);
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      th_evaluator_ = std::make_unique<Crypto::garbling::ThreeHalvesEvaluator>(public_data);
+    }
+    shared_zero_ = blocks[2];
+  }
+  if (input_batch_) {
+    input_batch_->register_messages();
+  }
+  setup_ran_ = true;
+}
+
+void YaoProvider::send_blocks_message(std::size_t gate_id, ENCRYPTO::block128_vector&& message,
+                                      std::size_t msg_num) const {
+  CommMixin::send_blocks_message(1 - my_id_, gate_id, std::move(message), msg_num);
 }
 
 void YaoProvider::send_bits_message(std::size_t gate_id, ENCRYPTO::BitVector<>&& message) const {
@@ -379,8 +535,8 @@ void YaoProvider::send_bits_message(std::size_t gate_id,
 }
 
 ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector> YaoProvider::register_for_blocks_message(
-    std::size_t gate_id, std::size_t num_blocks) {
-  return CommMixin::register_for_blocks_message(1 - my_id_, gate_id, num_blocks);
+    std::size_t gate_id, std::size_t num_blocks, std::size_t msg_num) {
+  return CommMixin::register_for_blocks_message(1 - my_id_, gate_id, num_blocks, msg_num);
 }
 
 ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> YaoProvider::register_for_bits_message(
@@ -393,8 +549,13 @@ void YaoProvider::create_garbled_tables(std::size_t gate_id,
                                         const ENCRYPTO::block128_vector& keys_b,
                                         ENCRYPTO::block128_t* tables,
                                         ENCRYPTO::block128_vector& keys_out) const noexcept {
+  if (garbling_scheme_ == GarblingScheme::three_halves) {
+    assert(th_garbler_);
+    th_garbler_->batch_garble_and(keys_out, tables, get_half_gate_index(gate_id), keys_a, keys_b);
+    return;
+  }
   assert(hg_garbler_);
-  hg_garbler_->batch_garble_and(keys_out, tables, gate_id, keys_a, keys_b);
+  hg_garbler_->batch_garble_and(keys_out, tables, get_half_gate_index(gate_id), keys_a, keys_b);
 }
 
 void YaoProvider::evaluate_garbled_tables(std::size_t gate_id,
@@ -402,8 +563,86 @@ void YaoProvider::evaluate_garbled_tables(std::size_t gate_id,
                                           const ENCRYPTO::block128_vector& keys_b,
                                           const ENCRYPTO::block128_t* tables,
                                           ENCRYPTO::block128_vector& keys_out) const noexcept {
+  if (garbling_scheme_ == GarblingScheme::three_halves) {
+    assert(th_evaluator_);
+    th_evaluator_->batch_evaluate_and(keys_out, tables, get_half_gate_index(gate_id), keys_a,
+                                      keys_b);
+    return;
+  }
   assert(hg_evaluator_);
-  hg_evaluator_->batch_evaluate_and(keys_out, tables, gate_id, keys_a, keys_b);
+  hg_evaluator_->batch_evaluate_and(keys_out, tables, get_half_gate_index(gate_id), keys_a,
+                                    keys_b);
+}
+
+void YaoProvider::create_garbled_tables(std::size_t gate_id,
+                                        const ENCRYPTO::block128_vector& keys_a,
+                                        const ENCRYPTO::block128_vector& keys_b,
+                                        ENCRYPTO::block128_t* tables,
+                                        ENCRYPTO::block128_vector& keys_out,
+                                        const ExecutionContext& exec_ctx) const {
+  assert(keys_a.size() == keys_b.size());
+  const auto num_gates = keys_a.size();
+  const auto start_index = get_half_gate_index(gate_id);
+  keys_out.resize(num_gates);
+  exec_ctx.parallel_for(num_gates, parallel_garbling_granularity, [&](auto begin, auto end) {
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      assert(th_garbler_);
+      th_garbler_->batch_garble_and_range(keys_out.data(), tables, start_index, keys_a.data(),
+                                          keys_b.data(), num_gates, begin, end);
+      return;
+    }
+    assert(hg_garbler_);
+    hg_garbler_->batch_garble_and(keys_out.data() + begin, tables + garbled_table_size * begin,
+                                  start_index + begin, keys_a.data() + begin,
+                                  keys_b.data() + begin, end - begin);
+  });
+}
+
+void YaoProvider::evaluate_garbled_tables(std::size_t gate_id,
+                                          const ENCRYPTO::block128_vector& keys_a,
+                                          const ENCRYPTO::block128_vector& keys_b,
+                                          const ENCRYPTO::block128_t* tables,
+                                          ENCRYPTO::block128_vector& keys_out,
+                                          const ExecutionContext& exec_ctx) const {
+  assert(keys_a.size() == keys_b.size());
+  const auto num_gates = keys_a.size();
+  const auto start_index = get_half_gate_index(gate_id);
+  keys_out.resize(num_gates);
+  exec_ctx.parallel_for(num_gates, parallel_garbling_granularity, [&](auto begin, auto end) {
+    if (garbling_scheme_ == GarblingScheme::three_halves) {
+      assert(th_evaluator_);
+      th_evaluator_->batch_evaluate_and_range(keys_out.data(), tables, start_index, keys_a.data(),
+                                              keys_b.data(), num_gates, begin, end);
+      return;
+    }
+    assert(hg_evaluator_);
+    hg_evaluator_->batch_evaluate_and(keys_out.data() + begin, tables + garbled_table_size * begin,
+                                      start_index + begin, keys_a.data() + begin,
+                                      keys_b.data() + begin, end - begin);
+  });
+}
+
+void YaoProvider::acquire_garbled_table_window(
+    std::size_t num_blocks, ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>&& ack) {
+  assert(role_ == Role::garbler && garbled_table_window_ > 0);
+  std::scoped_lock lock(garbled_table_window_mutex_);
+  // the oldest tables are usually evaluated first, so wait for them in order
+  while (!unacknowledged_tables_.empty() &&
+         num_unacknowledged_blocks_ + num_blocks > garbled_table_window_) {
+    auto& [oldest_ack, oldest_num_blocks] = unacknowledged_tables_.front();
+    oldest_ack.wait();
+    num_unacknowledged_blocks_ -= oldest_num_blocks;
+    unacknowledged_tables_.pop_front();
+  }
+  num_unacknowledged_blocks_ += num_blocks;
+  unacknowledged_tables_.emplace_back(std::move(ack), num_blocks);
+}
+
+std::size_t YaoProvider::get_garbled_table_size(std::size_t num_gates) const noexcept {
+  if (garbling_scheme_ == GarblingScheme::three_halves) {
+    return Crypto::garbling::three_halves_table_size(num_gates);
+  }
+  return garbled_table_size * num_gates;
 }
 
 void YaoProvider::create_garbled_circuit(std::size_t gate_id, std::size_t num_simd,
@@ -414,8 +653,8 @@ void YaoProvider::create_garbled_circuit(std::size_t gate_id, std::size_t num_si
                                          ENCRYPTO::block128_vector& output_keys,
                                          bool parallel) const {
   assert(hg_garbler_);
-  hg_garbler_->garble_circuit(output_keys, tables, gate_id, input_keys_a, input_keys_b, num_simd,
-                              algo, parallel);
+  hg_garbler_->garble_circuit(output_keys, tables, get_half_gate_index(gate_id), input_keys_a,
+                              input_keys_b, num_simd, algo, parallel);
 }
 
 void YaoProvider::evaluate_garbled_circuit(std::size_t gate_id, std::size_t num_simd,
@@ -426,8 +665,85 @@ void YaoProvider::evaluate_garbled_circuit(std::size_t gate_id, std::size_t num_
                                            ENCRYPTO::block128_vector& output_keys,
                                            bool parallel) const {
   assert(hg_evaluator_);
-  hg_evaluator_->evaluate_circuit(output_keys, tables, gate_id, input_keys_a, input_keys_b,
-                                  num_simd, algo, parallel);
+  hg_evaluator_->evaluate_circuit(output_keys, tables, get_half_gate_index(gate_id), input_keys_a,
+                                  input_keys_b, num_simd, algo, parallel);
+}
+
+// copy the keys of the values [simd_begin, simd_end) of each wire, which are stored wire by wire
+static ENCRYPTO::block128_vector gather_keys(const ENCRYPTO::block128_vector& keys,
+                                             std::size_t num_wires, std::size_t num_simd,
+                                             std::size_t simd_begin, std::size_t simd_end) {
+  const auto range_size = simd_end - simd_begin;
+  ENCRYPTO::block128_vector range_keys(num_wires * range_size);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    std::copy_n(keys.data() + wire_i * num_simd + simd_begin, range_size,
+                range_keys.data() + wire_i * range_size);
+  }
+  return range_keys;
+}
+
+static void scatter_keys(const ENCRYPTO::block128_vector& range_keys,
+                         ENCRYPTO::block128_vector& keys, std::size_t num_wires,
+                         std::size_t num_simd, std::size_t simd_begin, std::size_t simd_end) {
+  const auto range_size = simd_end - simd_begin;
+  keys.resize(num_wires * num_simd);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    std::copy_n(range_keys.data() + wire_i * range_size, range_size,
+                keys.data() + wire_i * num_simd + simd_begin);
+  }
+}
+
+static std::size_t get_num_and_gates(const ENCRYPTO::AlgorithmDescription& algo) {
+  return std::count_if(std::begin(algo.gates_), std::end(algo.gates_), [](const auto& op) {
+    return op.type_ == ENCRYPTO::PrimitiveOperationType::AND;
+  });
+}
+
+void YaoProvider::create_garbled_circuit_range(
+    std::size_t gate_id, std::size_t num_simd, std::size_t simd_begin, std::size_t simd_end,
+    const ENCRYPTO::AlgorithmDescription& algo, const ENCRYPTO::block128_vector& input_keys_a,
+    const ENCRYPTO::block128_vector& input_keys_b, ENCRYPTO::block128_vector& tables,
+    ENCRYPTO::block128_vector& output_keys, bool parallel) const {
+  assert(hg_garbler_);
+  assert(simd_begin < simd_end && simd_end <= num_simd);
+  const auto range_size = simd_end - simd_begin;
+  const auto range_keys_a =
+      gather_keys(input_keys_a, algo.n_input_wires_parent_a_, num_simd, simd_begin, simd_end);
+  const auto range_keys_b =
+      algo.n_input_wires_parent_b_.has_value()
+          ? gather_keys(input_keys_b, *algo.n_input_wires_parent_b_, num_simd, simd_begin,
+                        simd_end)
+          : ENCRYPTO::block128_vector{};
+  ENCRYPTO::block128_vector range_output_keys;
+  // the ranges use disjoint blocks of the hash indices of the gate
+  const auto start_index = get_half_gate_index(gate_id) + simd_begin * get_num_and_gates(algo);
+  hg_garbler_->garble_circuit(range_output_keys, tables, start_index, range_keys_a, range_keys_b,
+                              range_size, algo, parallel);
+  scatter_keys(range_output_keys, output_keys, algo.n_output_wires_, num_simd, simd_begin,
+               simd_end);
+}
+
+void YaoProvider::evaluate_garbled_circuit_range(
+    std::size_t gate_id, std::size_t num_simd, std::size_t simd_begin, std::size_t simd_end,
+    const ENCRYPTO::AlgorithmDescription& algo, const ENCRYPTO::block128_vector& input_keys_a,
+    const ENCRYPTO::block128_vector& input_keys_b, const ENCRYPTO::block128_vector& tables,
+    ENCRYPTO::block128_vector& output_keys, bool parallel) const {
+  assert(hg_evaluator_);
+  assert(simd_begin < simd_end && simd_end <= num_simd);
+  const auto range_size = simd_end - simd_begin;
+  const auto range_keys_a =
+      gather_keys(input_keys_a, algo.n_input_wires_parent_a_, num_simd, simd_begin, simd_end);
+  const auto range_keys_b =
+      algo.n_input_wires_parent_b_.has_value()
+          ? gather_keys(input_keys_b, *algo.n_input_wires_parent_b_, num_simd, simd_begin,
+                        simd_end)
+          : ENCRYPTO::block128_vector{};
+  ENCRYPTO::block128_vector range_output_keys;
+  const auto start_index = get_half_gate_index(gate_id) + simd_begin * get_num_and_gates(algo);
+  hg_evaluator_->evaluate_circuit(range_output_keys, tables, start_index, range_keys_a,
+                                  range_keys_b, range_size, algo, parallel);
+  scatter_keys(range_output_keys, output_keys, algo.n_output_wires_, num_simd, simd_begin,
+               simd_end);
 }
 
 static std::vector<std::shared_ptr<NewWire>> cast_wires(gmw::BooleanGMWWireVector&& wires) {
@@ -701,6 +1017,8 @@ WireVector YaoProvider::basic_make_convert_from_arithmetic_beavy_gate(const Wire
   auto arith_wire = std::dynamic_pointer_cast<beavy::ArithmeticBEAVYWire<T>>(in.at(0));
   assert(arith_wire != nullptr);
   auto num_simd = arith_wire->get_num_simd();
+  // an additively shared wire holds the evaluator's share only in the online phase
+  const bool additive = arith_wire->is_additively_shared();
   auto share_output_gate_id = gate_register_.get_next_gate_id();
   auto share_output_gate = std::make_unique<beavy::ArithmeticBEAVYOutputShareGate<T>>(
       share_output_gate_id, std::move(arith_wire));
@@ -715,23 +1033,39 @@ WireVector YaoProvider::basic_make_convert_from_arithmetic_beavy_gate(const Wire
     auto input_gate_0 = std::make_unique<ArithmeticInputAdapterGate<YaoInputGateGarbler, T>>(
         std::move(public_share_future), std::move(secret_share_future),
         [](auto x, auto y) { return x - y; }, logger_, input_gate_0_id, *this, num_wires, num_simd);
-    auto input_gate_1 = std::make_unique<SetupGate<YaoInputGateGarbler>>(input_gate_1_id, *this,
-                                                                         num_wires, num_simd, true);
     wires_0 = input_gate_0->get_output_wires();
-    wires_1 = input_gate_1->get_output_wires();
     gate_register_.register_gate(std::move(input_gate_0));
-    gate_register_.register_gate(std::move(input_gate_1));
+    if (additive) {
+      auto input_gate_1 =
+          std::make_unique<YaoInputGateGarbler>(input_gate_1_id, *this, num_wires, num_simd);
+      wires_1 = input_gate_1->get_output_wires();
+      gate_register_.register_gate(std::move(input_gate_1));
+    } else {
+      auto input_gate_1 = std::make_unique<SetupGate<YaoInputGateGarbler>>(
+          input_gate_1_id, *this, num_wires, num_simd, true);
+      wires_1 = input_gate_1->get_output_wires();
+      gate_register_.register_gate(std::move(input_gate_1));
+    }
   } else {
     auto input_gate_0 =
         std::make_unique<YaoInputGateEvaluator>(input_gate_0_id, *this, num_wires, num_simd);
-    auto input_gate_1 =
-        std::make_unique<SetupGate<ArithmeticInputAdapterGate<YaoInputGateEvaluator, T>>>(
-            std::move(secret_share_future), std::negate{}, true, logger_, input_gate_1_id, *this,
-            num_wires, num_simd, true);
     wires_0 = input_gate_0->get_output_wires();
-    wires_1 = input_gate_1->get_output_wires();
     gate_register_.register_gate(std::move(input_gate_0));
-    gate_register_.register_gate(std::move(input_gate_1));
+    if (additive) {
+      auto input_gate_1 = std::make_unique<ArithmeticInputAdapterGate<YaoInputGateEvaluator, T>>(
+          std::move(public_share_future), std::move(secret_share_future),
+          [](auto x, auto y) { return x - y; }, logger_, input_gate_1_id, *this, num_wires,
+          num_simd);
+      wires_1 = input_gate_1->get_output_wires();
+      gate_register_.register_gate(std::move(input_gate_1));
+    } else {
+      auto input_gate_1 =
+          std::make_unique<SetupGate<ArithmeticInputAdapterGate<YaoInputGateEvaluator, T>>>(
+              std::move(secret_share_future), std::negate{}, true, logger_, input_gate_1_id,
+              *this, num_wires, num_simd, true);
+      wires_1 = input_gate_1->get_output_wires();
+      gate_register_.register_gate(std::move(input_gate_1));
+    }
   }
 
   // sum up the additive shares in a Boolean circuit
@@ -807,19 +1141,19 @@ WireVector YaoProvider::convert(MPCProtocol dst_proto, const WireVector& in) {
 
 template <typename T>
 tensor::TensorCP YaoProvider::basic_make_convert_from_arithmetic_gmw_tensor(
-    const tensor::TensorCP in) {
+    const tensor::TensorCP in, bool msb_only) {
   const auto input_tensor = std::dynamic_pointer_cast<const gmw::ArithmeticGMWTensor<T>>(in);
   assert(input_tensor != nullptr);
   auto gate_id = gate_register_.get_next_gate_id();
   tensor::TensorCP output;
   if (role_ == Role::garbler) {
-    auto tensor_op = std::make_unique<ArithmeticGMWToYaoTensorConversionGarbler<T>>(gate_id, *this,
-                                                                                    input_tensor);
+    auto tensor_op = std::make_unique<ArithmeticGMWToYaoTensorConversionGarbler<T>>(
+        gate_id, *this, input_tensor, msb_only);
     output = tensor_op->get_output_tensor();
     gate_register_.register_gate(std::move(tensor_op));
   } else {
     auto tensor_op = std::make_unique<ArithmeticGMWToYaoTensorConversionEvaluator<T>>(
-        gate_id, *this, input_tensor);
+        gate_id, *this, input_tensor, msb_only);
     output = tensor_op->get_output_tensor();
     gate_register_.register_gate(std::move(tensor_op));
   }
@@ -827,16 +1161,17 @@ tensor::TensorCP YaoProvider::basic_make_convert_from_arithmetic_gmw_tensor(
 }
 
 template tensor::TensorCP YaoProvider::basic_make_convert_from_arithmetic_gmw_tensor<std::uint64_t>(
-    const tensor::TensorCP);
+    const tensor::TensorCP, bool);
 
-tensor::TensorCP YaoProvider::make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP in) {
+tensor::TensorCP YaoProvider::make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP in,
+                                                                      bool msb_only) {
   switch (in->get_bit_size()) {
     case 32: {
-      return basic_make_convert_from_arithmetic_gmw_tensor<std::uint32_t>(std::move(in));
+      return basic_make_convert_from_arithmetic_gmw_tensor<std::uint32_t>(std::move(in), msb_only);
       break;
     }
     case 64: {
-      return basic_make_convert_from_arithmetic_gmw_tensor<std::uint64_t>(std::move(in));
+      return basic_make_convert_from_arithmetic_gmw_tensor<std::uint64_t>(std::move(in), msb_only);
       break;
     }
     default: {
@@ -906,19 +1241,19 @@ tensor::TensorCP YaoProvider::make_convert_to_boolean_gmw_tensor(const tensor::T
 
 template <typename T>
 tensor::TensorCP YaoProvider::basic_make_convert_from_arithmetic_beavy_tensor(
-    const tensor::TensorCP in) {
+    const tensor::TensorCP in, bool msb_only) {
   const auto input_tensor = std::dynamic_pointer_cast<const beavy::ArithmeticBEAVYTensor<T>>(in);
   assert(input_tensor != nullptr);
   auto gate_id = gate_register_.get_next_gate_id();
   tensor::TensorCP output;
   if (role_ == Role::garbler) {
     auto tensor_op = std::make_unique<ArithmeticBEAVYToYaoTensorConversionGarbler<T>>(
-        gate_id, *this, input_tensor);
+        gate_id, *this, input_tensor, msb_only);
     output = tensor_op->get_output_tensor();
     gate_register_.register_gate(std::move(tensor_op));
   } else {
     auto tensor_op = std::make_unique<ArithmeticBEAVYToYaoTensorConversionEvaluator<T>>(
-        gate_id, *this, input_tensor);
+        gate_id, *this, input_tensor, msb_only);
     output = tensor_op->get_output_tensor();
     gate_register_.register_gate(std::move(tensor_op));
   }
@@ -926,16 +1261,20 @@ tensor::TensorCP YaoProvider::basic_make_convert_from_arithmetic_beavy_tensor(
 }
 
 template tensor::TensorCP
-YaoProvider::basic_make_convert_from_arithmetic_beavy_tensor<std::uint64_t>(const tensor::TensorCP);
+YaoProvider::basic_make_convert_from_arithmetic_beavy_tensor<std::uint64_t>(const tensor::TensorCP,
+                                                                            bool);
 
-tensor::TensorCP YaoProvider::make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP in) {
+tensor::TensorCP YaoProvider::make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP in,
+                                                                        bool msb_only) {
   switch (in->get_bit_size()) {
     case 32: {
-      return basic_make_convert_from_arithmetic_beavy_tensor<std::uint32_t>(std::move(in));
+      return basic_make_convert_from_arithmetic_beavy_tensor<std::uint32_t>(std::move(in),
+                                                                            msb_only);
       break;
     }
     case 64: {
-      return basic_make_convert_from_arithmetic_beavy_tensor<std::uint64_t>(std::move(in));
+      return basic_make_convert_from_arithmetic_beavy_tensor<std::uint64_t>(std::move(in),
+                                                                            msb_only);
       break;
     }
     default: {
@@ -1028,6 +1367,21 @@ tensor::TensorCP YaoProvider::make_tensor_conversion(MPCProtocol proto_to,
                   ToString(proto_from), ToString(proto_to)));
 }
 
+tensor::TensorCP YaoProvider::make_tensor_msb_conversion(MPCProtocol proto_to,
+                                                         const tensor::TensorCP in) {
+  auto proto_from = in->get_protocol();
+  if (proto_to == MPCProtocol::Yao) {
+    if (proto_from == MPCProtocol::ArithmeticBEAVY) {
+      return make_convert_from_arithmetic_beavy_tensor(in, true);
+    } else if (proto_from == MPCProtocol::ArithmeticGMW) {
+      return make_convert_from_arithmetic_gmw_tensor(in, true);
+    }
+  }
+  throw std::logic_error(
+      fmt::format("YaoProvider does not support MSB conversions from {} to {}",
+                  ToString(proto_from), ToString(proto_to)));
+}
+
 tensor::TensorCP YaoProvider::make_tensor_relu_op(const tensor::TensorCP in) {
   const auto input_tensor = std::dynamic_pointer_cast<const YaoTensor>(in);
   assert(input_tensor != nullptr);
@@ -1045,6 +1399,43 @@ tensor::TensorCP YaoProvider::make_tensor_relu_op(const tensor::TensorCP in) {
   return output;
 }
 
+template <typename T>
+tensor::TensorCP YaoProvider::basic_make_arithmetic_beavy_tensor_relu_op(
+    const tensor::TensorCP in) {
+  const auto input_tensor = std::dynamic_pointer_cast<const beavy::ArithmeticBEAVYTensor<T>>(in);
+  assert(input_tensor != nullptr);
+  auto gate_id = gate_register_.get_next_gate_id();
+  tensor::TensorCP output;
+  if (role_ == Role::garbler) {
+    auto tensor_op =
+        std::make_unique<ArithmeticBEAVYYaoTensorReluGarbler<T>>(gate_id, *this, input_tensor);
+    output = tensor_op->get_output_tensor();
+    gate_register_.register_gate(std::move(tensor_op));
+  } else {
+    auto tensor_op =
+        std::make_unique<ArithmeticBEAVYYaoTensorReluEvaluator<T>>(gate_id, *this, input_tensor);
+    output = tensor_op->get_output_tensor();
+    gate_register_.register_gate(std::move(tensor_op));
+  }
+  return output;
+}
+
+tensor::TensorCP YaoProvider::make_arithmetic_beavy_tensor_relu_op(const tensor::TensorCP in) {
+  switch (in->get_bit_size()) {
+    case 32: {
+      return basic_make_arithmetic_beavy_tensor_relu_op<std::uint32_t>(std::move(in));
+      break;
+    }
+    case 64: {
+      return basic_make_arithmetic_beavy_tensor_relu_op<std::uint64_t>(std::move(in));
+      break;
+    }
+    default: {
+      throw std::logic_error("unsupprted bit size");
+    }
+  }
+}
+
 tensor::TensorCP YaoProvider::make_tensor_maxpool_op(const tensor::MaxPoolOp& maxpool_op,
                                                      const tensor::TensorCP in) {
   const auto input_tensor = std::dynamic_pointer_cast<const YaoTensor>(in);
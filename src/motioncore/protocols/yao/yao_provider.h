@@ -22,12 +22,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <initializer_list>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <boost/fiber/mutex.hpp>
+
 #include "base/gate_factory.h"
+#include "label_arena.h"
 #include "protocols/common/comm_mixin.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_op_factory.h"
@@ -49,9 +55,12 @@ class OTProvider;
 namespace MOTION {
 
 class CircuitLoader;
+struct ExecutionContext;
 class GateRegister;
 class Logger;
 class NewWire;
+class PreprocessingRecord;
+class PreprocessingWriter;
 
 namespace Communication {
 class CommunicationLayer;
@@ -62,6 +71,8 @@ class MotionBaseProvider;
 namespace garbling {
 class HalfGateGarbler;
 class HalfGateEvaluator;
+class ThreeHalvesGarbler;
+class ThreeHalvesEvaluator;
 }  // namespace garbling
 }  // namespace Crypto
 
@@ -69,9 +80,14 @@ namespace proto::yao {
 
 enum class OutputRecipient : std::uint8_t { garbler, evaluator, both };
 
+// garbling scheme of the AND gates, three halves needs 1.5 instead of 2 blocks per gate but
+// 6 instead of 4 hashes for garbling and 3 instead of 2 for evaluation
+enum class GarblingScheme : std::uint8_t { half_gates, three_halves };
+
 class YaoWire;
 using YaoWireVector = std::vector<std::shared_ptr<YaoWire>>;
 
+class YaoInputBatch;
 struct YaoMessageHandler;
 
 class YaoProvider : public GateFactory,
@@ -117,16 +133,27 @@ class YaoProvider : public GateFactory,
   WireVector convert_from_other_to_yao(MPCProtocol src_proto, const WireVector&);
 
   void setup();
+  // Write the state created by setup(), i.e., the keys of the garbling scheme, to a preprocessing
+  // store.  The process evaluating the stored circuit restores it instead of running setup().
+  void save_setup(PreprocessingWriter&) const;
+  void load_setup(PreprocessingRecord&);
   ENCRYPTO::block128_t get_global_offset() const;
   ENCRYPTO::block128_t get_shared_zero() const noexcept;
 
-  void send_blocks_message(std::size_t gate_id, ENCRYPTO::block128_vector&& message) const;
+  void send_blocks_message(std::size_t gate_id, ENCRYPTO::block128_vector&& message,
+                           std::size_t msg_num = 0) const;
   void send_bits_message(std::size_t gate_id, ENCRYPTO::BitVector<>&& message) const;
   void send_bits_message(std::size_t gate_id, const ENCRYPTO::BitVector<>& message) const;
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<ENCRYPTO::block128_vector>
-  register_for_blocks_message(std::size_t gate_id, std::size_t num_blocks);
+  register_for_blocks_message(std::size_t gate_id, std::size_t num_blocks,
+                              std::size_t msg_num = 0);
   [[nodiscard]] ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>> register_for_bits_message(
       std::size_t gate_id, std::size_t num_bits);
+  // Every gate garbles its AND gates with the half gate indices starting at
+  // get_half_gate_index(gate_id), s.t. no two AND gates of the circuit share a hash tweak.
+  static constexpr std::size_t get_half_gate_index(std::size_t gate_id) noexcept {
+    return gate_id << 32;
+  }
   void create_garbled_tables(std::size_t gate_id, const ENCRYPTO::block128_vector& keys_a,
                              const ENCRYPTO::block128_vector& keys_b, ENCRYPTO::block128_t* tables,
                              ENCRYPTO::block128_vector& keys_out) const noexcept;
@@ -134,6 +161,17 @@ class YaoProvider : public GateFactory,
                                const ENCRYPTO::block128_vector& keys_b,
                                const ENCRYPTO::block128_t* tables,
                                ENCRYPTO::block128_vector& keys_out) const noexcept;
+  // Same as above, but the gates are split into chunks of at least parallel_garbling_granularity
+  // gates, which are garbled or evaluated in parallel on the threads of the execution context.
+  // The tables are the same as with the sequential versions.
+  void create_garbled_tables(std::size_t gate_id, const ENCRYPTO::block128_vector& keys_a,
+                             const ENCRYPTO::block128_vector& keys_b, ENCRYPTO::block128_t* tables,
+                             ENCRYPTO::block128_vector& keys_out, const ExecutionContext&) const;
+  void evaluate_garbled_tables(std::size_t gate_id, const ENCRYPTO::block128_vector& keys_a,
+                               const ENCRYPTO::block128_vector& keys_b,
+                               const ENCRYPTO::block128_t* tables,
+                               ENCRYPTO::block128_vector& keys_out, const ExecutionContext&) const;
+  constexpr static std::size_t parallel_garbling_granularity = 1024;
   void create_garbled_circuit(std::size_t gate_id, std::size_t num_simd,
                               const ENCRYPTO::AlgorithmDescription&,
                               const ENCRYPTO::block128_vector& input_keys_a,
@@ -146,7 +184,81 @@ class YaoProvider : public GateFactory,
                                 const ENCRYPTO::block128_vector& input_keys_b,
                                 const ENCRYPTO::block128_vector& tables,
                                 ENCRYPTO::block128_vector& keys_out, bool parallel = false) const;
+  // Same as above for the SIMD values [simd_begin, simd_end) of a circuit with num_simd values,
+  // i.e., the input and output keys are those of all values stored wire by wire.  Every range
+  // uses its own hash indices, so the ranges of a circuit can be garbled, sent and evaluated one
+  // after another, but the tables differ from those of create_garbled_circuit().
+  void create_garbled_circuit_range(std::size_t gate_id, std::size_t num_simd,
+                                    std::size_t simd_begin, std::size_t simd_end,
+                                    const ENCRYPTO::AlgorithmDescription&,
+                                    const ENCRYPTO::block128_vector& input_keys_a,
+                                    const ENCRYPTO::block128_vector& input_keys_b,
+                                    ENCRYPTO::block128_vector& tables,
+                                    ENCRYPTO::block128_vector& keys_out,
+                                    bool parallel = false) const;
+  void evaluate_garbled_circuit_range(std::size_t gate_id, std::size_t num_simd,
+                                      std::size_t simd_begin, std::size_t simd_end,
+                                      const ENCRYPTO::AlgorithmDescription&,
+                                      const ENCRYPTO::block128_vector& input_keys_a,
+                                      const ENCRYPTO::block128_vector& input_keys_b,
+                                      const ENCRYPTO::block128_vector& tables,
+                                      ENCRYPTO::block128_vector& keys_out,
+                                      bool parallel = false) const;
+  // The tensor ReLU garbles its circuit in ranges of this many values and sends the tables of
+  // each range in a message of its own, s.t. the transfer of the tables overlaps with garbling
+  // the next range on the garbler's side and with the evaluation on the evaluator's side.  0
+  // sends the tables of the whole tensor at once.  (set by both parties before building)
+  static constexpr std::size_t default_tensor_chunk_size = 4096;
+  void set_tensor_chunk_size(std::size_t num_values) noexcept { tensor_chunk_size_ = num_values; }
+  std::size_t get_tensor_chunk_size() const noexcept { return tensor_chunk_size_; }
+  // size of the garbled tables of the garbled circuits in blocks per AND gate (always half gates)
   constexpr static std::size_t garbled_table_size = 2;
+  // size of the garbled tables of a Yao AND gate with num_gates wires in blocks
+  std::size_t get_garbled_table_size(std::size_t num_gates) const noexcept;
+  // select the garbling scheme of the AND gates (set by both parties before building)
+  void set_garbling_scheme(GarblingScheme scheme) noexcept { garbling_scheme_ = scheme; }
+  GarblingScheme get_garbling_scheme() const noexcept { return garbling_scheme_; }
+  // Bound the garbled tables of the AND gates which have been sent to the evaluator but not yet
+  // evaluated to num_blocks blocks, 0 (the default) is unbounded.  The garbler waits before
+  // garbling a gate until the evaluator has acknowledged enough earlier tables, so both parties
+  // need to run the circuit with NewGateExecutor::evaluate(), where the evaluator consumes the
+  // tables while the garbler is still in its setup phase.  A gate with more than num_blocks
+  // blocks is sent once all earlier tables are acknowledged.  (set by both parties before
+  // building)
+  void set_garbled_table_window(std::size_t num_blocks) noexcept {
+    garbled_table_window_ = num_blocks;
+  }
+  std::size_t get_garbled_table_window() const noexcept { return garbled_table_window_; }
+  // Let the garbler free the keys of a wire as soon as the last gate reading them has been
+  // garbled and reuse the memory for the keys of later gates, s.t. its memory is bounded by the
+  // keys of the wires alive at the same time instead of the keys of all wires of the circuit,
+  // e.g., for SHA-512 on many SIMD values.  Only the outputs of INV, XOR and AND gates are freed,
+  // and only if all gates reading them are INV, XOR, AND or output gates, which need the keys
+  // only in the setup phase.  The keys of a wire read by an output gate are gone after the setup
+  // phase.  Cannot be used with the preprocessing store, and has no effect on the evaluator.
+  // (set by both parties before building)
+  void set_label_streaming(bool enable) noexcept { label_streaming_ = enable; }
+
+  // Let all input gates share a single batch of XCOTs in the setup phase and a single message per
+  // direction in the online phase instead of running one OT extension and sending one message
+  // each (see YaoInputBatch).  Requires an executor that evaluates the input gates concurrently.
+  // (set by both parties before building)
+  void set_batch_input_ots(bool batch) noexcept { batch_input_ots_ = batch; }
+  bool get_batch_input_ots() const noexcept { return batch_input_ots_; }
+  // called by the input gates with batch_input_ots
+  YaoInputBatch& get_input_batch();
+  // register the batched OTs, needs to be called before the OT extension setup
+  void register_batched_ots();
+  bool is_label_streaming() const noexcept { return label_streaming_ && role_ == Role::garbler; }
+  // Called by the garbler gates: get a buffer for num_keys output keys, and report that a gate is
+  // done with the keys of its inputs.
+  ENCRYPTO::block128_vector allocate_keys(std::size_t num_keys);
+  void release_input_keys(const YaoWireVector&);
+  const LabelArena& get_label_arena() const noexcept { return label_arena_; }
+  // Called by an AND garbler before garbling num_blocks blocks of tables with the future for the
+  // acknowledgment of the evaluator, blocks until they fit into the window.
+  void acquire_garbled_table_window(std::size_t num_blocks,
+                                    ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>&& ack);
 
   Crypto::MotionBaseProvider& get_motion_base_provider() const noexcept {
     return motion_base_provider_;
@@ -178,12 +290,17 @@ class YaoProvider : public GateFactory,
 
  public:
   // tensor stuff
+  // with msb_only, the Yao tensor only holds the most significant bit of each value
   template <typename T>
-  tensor::TensorCP basic_make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP);
-  tensor::TensorCP make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP);
+  tensor::TensorCP basic_make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP,
+                                                                 bool msb_only = false);
+  tensor::TensorCP make_convert_from_arithmetic_gmw_tensor(const tensor::TensorCP,
+                                                           bool msb_only = false);
   template <typename T>
-  tensor::TensorCP basic_make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP);
-  tensor::TensorCP make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP);
+  tensor::TensorCP basic_make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP,
+                                                                   bool msb_only = false);
+  tensor::TensorCP make_convert_from_arithmetic_beavy_tensor(const tensor::TensorCP,
+                                                             bool msb_only = false);
   template <typename T>
   tensor::TensorCP basic_make_convert_to_arithmetic_gmw_tensor(const tensor::TensorCP);
   tensor::TensorCP make_convert_to_arithmetic_gmw_tensor(const tensor::TensorCP);
@@ -193,8 +310,17 @@ class YaoProvider : public GateFactory,
   tensor::TensorCP make_convert_to_arithmetic_beavy_tensor(const tensor::TensorCP);
   tensor::TensorCP make_convert_to_boolean_beavy_tensor(const tensor::TensorCP);
   tensor::TensorCP make_tensor_conversion(MPCProtocol, const tensor::TensorCP) override;
+  tensor::TensorCP make_tensor_msb_conversion(MPCProtocol, const tensor::TensorCP) override;
   tensor::TensorCP make_tensor_relu_op(const tensor::TensorCP) override;
   using TensorOpFactory::make_tensor_relu_op;
+  // ReLU of an Arithmetic BEAVY tensor in Yao with the conversions from and to Yao fused into a
+  // single op, see ArithmeticBEAVYYaoTensorReluGarbler
+  template <typename T>
+  tensor::TensorCP basic_make_arithmetic_beavy_tensor_relu_op(const tensor::TensorCP);
+  // count the gates reading the keys of each wire which can be freed with label streaming
+  void count_label_consumers();
+
+  tensor::TensorCP make_arithmetic_beavy_tensor_relu_op(const tensor::TensorCP);
   tensor::TensorCP make_tensor_maxpool_op(const tensor::MaxPoolOp&,
                                           const tensor::TensorCP) override;
 
@@ -206,6 +332,23 @@ class YaoProvider : public GateFactory,
   ENCRYPTO::ObliviousTransfer::OTProvider& ot_provider_;
   std::unique_ptr<Crypto::garbling::HalfGateGarbler> hg_garbler_;
   std::unique_ptr<Crypto::garbling::HalfGateEvaluator> hg_evaluator_;
+  GarblingScheme garbling_scheme_;
+  std::size_t garbled_table_window_ = 0;
+  std::size_t tensor_chunk_size_ = default_tensor_chunk_size;
+  // garbled tables sent but not yet acknowledged by the evaluator, in the order they were sent
+  boost::fibers::mutex garbled_table_window_mutex_;
+  std::deque<std::pair<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>, std::size_t>>
+      unacknowledged_tables_;
+  std::size_t num_unacknowledged_blocks_ = 0;
+  bool label_streaming_ = false;
+  bool batch_input_ots_ = false;
+  std::unique_ptr<YaoInputBatch> input_batch_;
+  LabelArena label_arena_;
+  // remaining number of gates reading the keys of the wires freed by label streaming, filled by
+  // setup() and only read afterwards
+  std::unordered_map<const NewWire*, std::atomic<std::size_t>> label_consumers_;
+  std::unique_ptr<Crypto::garbling::ThreeHalvesGarbler> th_garbler_;
+  std::unique_ptr<Crypto::garbling::ThreeHalvesEvaluator> th_evaluator_;
   ENCRYPTO::block128_t shared_zero_;
   std::shared_ptr<YaoMessageHandler> message_handler_;
   std::size_t my_id_;
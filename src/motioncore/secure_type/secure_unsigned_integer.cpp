@@ -24,15 +24,156 @@
 
 #include "secure_unsigned_integer.h"
 
+#include <algorithm>
+
 #include <fmt/format.h>
 
 #include "algorithm/algorithm_description.h"
+#include "algorithm/circuit_loader.h"
 #include "base/register.h"
 #include "utility/logger.h"
 #include "utility/constants.h"
 
 namespace MOTION {
 
+namespace {
+
+using Shares::ShareWrapper;
+
+// Products x_i & y_i of the pairs in a single AND gate.
+std::vector<ShareWrapper> PairwiseAND(const std::vector<ShareWrapper>& x,
+                                      const std::vector<ShareWrapper>& y) {
+  return (ShareWrapper::Join(x) & ShareWrapper::Join(y)).Split();
+}
+
+// Subtraction r - d, where bit j generates a borrow if g_j = ~r_j & d_j and propagates one if
+// p_j = ~(r_j ^ d_j).  Two neighbouring ranges of bits are merged by g = g_high ^ (p_high & g_low)
+// and p = p_high & p_low, where the XOR replaces the OR since g_high and p_high exclude each other.
+
+// Borrow out of the most significant bit of r - d, i.e., r < d, by a tree of ceil(log2(n))
+// levels, each of which merges all pairs of neighbouring ranges with a single AND gate.
+ShareWrapper BorrowOut(const ShareWrapper& r, const ShareWrapper& d) {
+  auto g = (~r & d).Split();
+  auto p = (~(r ^ d)).Split();
+  while (g.size() > 1) {
+    const auto num_pairs = g.size() / 2;
+    // the propagate bits of the last level are not needed
+    const bool last_level = g.size() == 2;
+    std::vector<ShareWrapper> lhs, rhs, g_high;
+    for (std::size_t k = 0; k < num_pairs; ++k) {
+      lhs.emplace_back(p.at(2 * k + 1));
+      rhs.emplace_back(g.at(2 * k));
+      g_high.emplace_back(g.at(2 * k + 1));
+    }
+    if (!last_level) {
+      for (std::size_t k = 0; k < num_pairs; ++k) {
+        lhs.emplace_back(p.at(2 * k + 1));
+        rhs.emplace_back(p.at(2 * k));
+      }
+    }
+    const auto products = PairwiseAND(lhs, rhs);
+    const std::vector<ShareWrapper> g_products(products.begin(), products.begin() + num_pairs);
+    auto next_g = (ShareWrapper::Join(g_high) ^ ShareWrapper::Join(g_products)).Split();
+    std::vector<ShareWrapper> next_p(products.begin() + num_pairs, products.end());
+    if (g.size() % 2 == 1) {
+      next_g.emplace_back(g.back());
+      next_p.emplace_back(p.back());
+    }
+    g = std::move(next_g);
+    p = std::move(next_p);
+  }
+  return g.at(0);
+}
+
+// Borrows out of all bits of r - d, given r ^ d, by a Kogge-Stone prefix network of
+// ceil(log2(n)) levels of a single AND gate each.
+std::vector<ShareWrapper> Borrows(const ShareWrapper& r, const ShareWrapper& d,
+                                  const ShareWrapper& r_xor_d) {
+  auto g = (~r & d).Split();
+  auto p = (~r_xor_d).Split();
+  const auto n = g.size();
+  for (std::size_t distance = 1; distance < n; distance *= 2) {
+    // g_j is final for j < 2 * distance, so p_j is not needed anymore
+    std::vector<ShareWrapper> lhs, rhs;
+    for (std::size_t j = distance; j < n; ++j) {
+      lhs.emplace_back(p.at(j));
+      rhs.emplace_back(g.at(j - distance));
+    }
+    for (std::size_t j = 2 * distance; j < n; ++j) {
+      lhs.emplace_back(p.at(j));
+      rhs.emplace_back(p.at(j - distance));
+    }
+    const auto products = PairwiseAND(lhs, rhs);
+    const auto num_g = n - distance;
+    const std::vector<ShareWrapper> g_old(g.begin() + distance, g.end());
+    const std::vector<ShareWrapper> g_products(products.begin(), products.begin() + num_g);
+    const auto g_new = (ShareWrapper::Join(g_old) ^ ShareWrapper::Join(g_products)).Split();
+    std::copy(g_new.begin(), g_new.end(), g.begin() + distance);
+    std::copy(products.begin() + num_g, products.end(), p.begin() + 2 * distance);
+  }
+  return g;
+}
+
+// s_k = v_k & ... & v_{n-1} by ceil(log2(n)) levels of a single AND gate each
+std::vector<ShareWrapper> SuffixAND(std::vector<ShareWrapper> v) {
+  const auto n = v.size();
+  for (std::size_t distance = 1; distance < n; distance *= 2) {
+    const std::vector<ShareWrapper> lhs(v.begin(), v.end() - distance);
+    const std::vector<ShareWrapper> rhs(v.begin() + distance, v.end());
+    const auto products = PairwiseAND(lhs, rhs);
+    std::copy(products.begin(), products.end(), v.begin());
+  }
+  return v;
+}
+
+// Restoring division, which determines the quotient bits from the most significant one.  Before
+// quotient bit i, the remainder has at most n - i bits, so it is at least b iff it is at least
+// the low n - i bits of b and the others are zero.  Then the step needs ceil(log2(n - i)) + 3
+// layers of AND gates and a few gates over all bits, instead of one gate per bit operation as in
+// the Bristol circuits.
+ShareWrapper NativeDivision(const ShareWrapper& a, const ShareWrapper& b) {
+  const auto a_bits = a.Split();
+  const auto b_bits = b.Split();
+  const auto n = a_bits.size();
+  // b_w, ..., b_{n-1} are zero
+  const auto high_zero = SuffixAND((~b).Split());
+
+  std::vector<ShareWrapper> quotient;
+  quotient.reserve(n);
+  // least significant bit first
+  std::vector<ShareWrapper> remainder;
+  for (std::size_t i = n; i-- > 0;) {
+    remainder.insert(remainder.begin(), a_bits.at(i));
+    const auto w = remainder.size();
+    const auto r = ShareWrapper::Join(remainder);
+    const auto d = ShareWrapper::Join({b_bits.begin(), b_bits.begin() + w});
+    const auto r_xor_d = r ^ d;
+    const auto borrows = Borrows(r, d, r_xor_d);
+    auto r_ge_b = ~borrows.back();
+    if (w < n) {
+      r_ge_b &= high_zero.at(w);
+    }
+    quotient.emplace_back(r_ge_b);
+    if (i == 0) {
+      break;
+    }
+    // difference bit j is r_j ^ d_j ^ borrow_{j-1}
+    auto diff = r_xor_d.Split();
+    if (w > 1) {
+      const std::vector<ShareWrapper> x_high(diff.begin() + 1, diff.end());
+      const std::vector<ShareWrapper> borrows_in(borrows.begin(), borrows.end() - 1);
+      const auto diff_high =
+          (ShareWrapper::Join(x_high) ^ ShareWrapper::Join(borrows_in)).Split();
+      std::copy(diff_high.begin(), diff_high.end(), diff.begin() + 1);
+    }
+    remainder = r_ge_b.MUX(ShareWrapper::Join(diff), r).Split();
+  }
+  std::reverse(quotient.begin(), quotient.end());
+  return ShareWrapper::Join(quotient);
+}
+
+}  // namespace
+
 SecureUnsignedInteger::SecureUnsignedInteger(const Shares::SharePtr& other)
     : share_(std::make_unique<Shares::ShareWrapper>(other)),
       logger_(share_.get()->Get()->GetRegister()->GetLogger()) {}
@@ -47,7 +188,7 @@ SecureUnsignedInteger SecureUnsignedInteger::operator+(const SecureUnsignedInteg
     return *share_ + *other.share_;
   } else {  // BooleanCircuitType
     const auto bitlen = share_->Get()->GetBitLength();
-    std::shared_ptr<ENCRYPTO::AlgorithmDescription> add_algo;
+    std::shared_ptr<const ENCRYPTO::AlgorithmDescription> add_algo;
     std::string path;
 
     if (share_->Get()->GetProtocol() == MPCProtocol::BMR)  // BMR, use size-optimized circuit
@@ -55,18 +196,9 @@ SecureUnsignedInteger SecureUnsignedInteger::operator+(const SecureUnsignedInteg
     else  // GMW, use depth-optimized circuit
       path = ConstructPath(ENCRYPTO::IntegerOperationType::ADD, bitlen, "_depth");
 
-    if ((add_algo = share_->Get()->GetRegister()->GetCachedAlgorithmDescription(path))) {
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(
-            fmt::format("Found in cache Boolean integer addition circuit with file path {}", path));
-      }
-    } else {
-      add_algo = std::make_shared<ENCRYPTO::AlgorithmDescription>(
-          ENCRYPTO::AlgorithmDescription::FromBristol(path));
-      assert(add_algo);
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(fmt::format("Read Boolean integer addition circuit from file {}", path));
-      }
+    add_algo = CircuitCache::get_instance().load(path, CircuitFormat::Bristol);
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug(fmt::format("Using Boolean integer addition circuit from file {}", path));
     }
     const auto s_in{Shares::ShareWrapper::Join({*share_, *other.share_})};
     return SecureUnsignedInteger(s_in.Evaluate(add_algo));
@@ -79,7 +211,7 @@ SecureUnsignedInteger SecureUnsignedInteger::operator-(const SecureUnsignedInteg
     return *share_ - *other.share_;
   } else {  // BooleanCircuitType
     const auto bitlen = share_->Get()->GetBitLength();
-    std::shared_ptr<ENCRYPTO::AlgorithmDescription> sub_algo;
+    std::shared_ptr<const ENCRYPTO::AlgorithmDescription> sub_algo;
     std::string path;
 
     if (share_->Get()->GetProtocol() == MPCProtocol::BMR)  // BMR, use size-optimized circuit
@@ -87,18 +219,10 @@ SecureUnsignedInteger SecureUnsignedInteger::operator-(const SecureUnsignedInteg
     else  // GMW, use depth-optimized circuit
       path = ConstructPath(ENCRYPTO::IntegerOperationType::SUB, bitlen, "_depth");
 
-    if ((sub_algo = share_->Get()->GetRegister()->GetCachedAlgorithmDescription(path))) {
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(
-            fmt::format("Found in cache Boolean integer addition circuit with file path {}", path));
-      }
-    } else {
-      sub_algo = std::make_shared<ENCRYPTO::AlgorithmDescription>(
-          ENCRYPTO::AlgorithmDescription::FromBristol(path));
-      assert(sub_algo);
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(fmt::format("Read Boolean integer addition circuit from file {}", path));
-      }
+    sub_algo = CircuitCache::get_instance().load(path, CircuitFormat::Bristol);
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug(
+          fmt::format("Using Boolean integer subtraction circuit from file {}", path));
     }
     const auto s_in{Shares::ShareWrapper::Join({*share_, *other.share_})};
     return SecureUnsignedInteger(s_in.Evaluate(sub_algo));
@@ -111,7 +235,7 @@ SecureUnsignedInteger SecureUnsignedInteger::operator*(const SecureUnsignedInteg
     return *share_ * *other.share_;
   } else {  // BooleanCircuitType
     const auto bitlen = share_->Get()->GetBitLength();
-    std::shared_ptr<ENCRYPTO::AlgorithmDescription> mul_algo;
+    std::shared_ptr<const ENCRYPTO::AlgorithmDescription> mul_algo;
     std::string path;
 
     if (share_->Get()->GetProtocol() == MPCProtocol::BMR)  // BMR, use size-optimized circuit
@@ -119,31 +243,31 @@ SecureUnsignedInteger SecureUnsignedInteger::operator*(const SecureUnsignedInteg
     else  // GMW, use depth-optimized circuit
       path = ConstructPath(ENCRYPTO::IntegerOperationType::MUL, bitlen, "_depth");
 
-    if ((mul_algo = share_->Get()->GetRegister()->GetCachedAlgorithmDescription(path))) {
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(
-            fmt::format("Found in cache Boolean integer addition circuit with file path {}", path));
-      }
-    } else {
-      mul_algo = std::make_shared<ENCRYPTO::AlgorithmDescription>(
-          ENCRYPTO::AlgorithmDescription::FromBristol(path));
-      assert(mul_algo);
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(fmt::format("Read Boolean integer addition circuit from file {}", path));
-      }
+    mul_algo = CircuitCache::get_instance().load(path, CircuitFormat::Bristol);
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug(
+          fmt::format("Using Boolean integer multiplication circuit from file {}", path));
     }
     const auto s_in{Shares::ShareWrapper::Join({*share_, *other.share_})};
     return SecureUnsignedInteger(s_in.Evaluate(mul_algo));
   }
 }
 
-SecureUnsignedInteger SecureUnsignedInteger::operator/(const SecureUnsignedInteger& other) const {
+SecureUnsignedInteger SecureUnsignedInteger::Divide(const SecureUnsignedInteger& other,
+                                                    IntegerAlgorithm algorithm) const {
   if (share_->Get()->GetCircuitType() != CircuitType::Boolean) {
-    // use primitive operation in arithmetic GMW
-    throw std::runtime_error("Integer division is not implemented for arithmetic GMW");
+    // divide in Boolean GMW
+    const SecureUnsignedInteger a(share_->Convert<MPCProtocol::BooleanGMW>());
+    const SecureUnsignedInteger b(other.share_->Convert<MPCProtocol::BooleanGMW>());
+    return a.Divide(b, algorithm).Get().Convert<MPCProtocol::ArithmeticGMW>();
+  } else if (algorithm == IntegerAlgorithm::Native) {
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug("Creating a native Boolean integer division circuit");
+    }
+    return SecureUnsignedInteger(NativeDivision(*share_, *other.share_));
   } else {  // BooleanCircuitType
     const auto bitlen = share_->Get()->GetBitLength();
-    std::shared_ptr<ENCRYPTO::AlgorithmDescription> div_algo;
+    std::shared_ptr<const ENCRYPTO::AlgorithmDescription> div_algo;
     std::string path;
 
     if (share_->Get()->GetProtocol() == MPCProtocol::BMR)  // BMR, use size-optimized circuit
@@ -151,31 +275,32 @@ SecureUnsignedInteger SecureUnsignedInteger::operator/(const SecureUnsignedInteg
     else  // GMW, use depth-optimized circuit
       path = ConstructPath(ENCRYPTO::IntegerOperationType::DIV, bitlen, "_depth");
 
-    if ((div_algo = share_->Get()->GetRegister()->GetCachedAlgorithmDescription(path))) {
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(
-            fmt::format("Found in cache Boolean integer addition circuit with file path {}", path));
-      }
-    } else {
-      div_algo = std::make_shared<ENCRYPTO::AlgorithmDescription>(
-          ENCRYPTO::AlgorithmDescription::FromBristol(path));
-      assert(div_algo);
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(fmt::format("Read Boolean integer addition circuit from file {}", path));
-      }
+    div_algo = CircuitCache::get_instance().load(path, CircuitFormat::Bristol);
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug(
+          fmt::format("Using Boolean integer division circuit from file {}", path));
     }
     const auto s_in{Shares::ShareWrapper::Join({*share_, *other.share_})};
     return SecureUnsignedInteger(s_in.Evaluate(div_algo));
   }
 }
 
-Shares::ShareWrapper SecureUnsignedInteger::operator>(const SecureUnsignedInteger& other) const {
+Shares::ShareWrapper SecureUnsignedInteger::GreaterThan(const SecureUnsignedInteger& other,
+                                                        IntegerAlgorithm algorithm) const {
   if (share_->Get()->GetCircuitType() != CircuitType::Boolean) {
-    // use primitive operation in arithmetic GMW
-    throw std::runtime_error("Integer comparison is not implemented for arithmetic GMW");
+    // compare in Boolean GMW
+    const SecureUnsignedInteger a(share_->Convert<MPCProtocol::BooleanGMW>());
+    const SecureUnsignedInteger b(other.share_->Convert<MPCProtocol::BooleanGMW>());
+    return a.GreaterThan(b, algorithm);
+  } else if (algorithm == IntegerAlgorithm::Native) {
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug("Creating a native Boolean integer comparison circuit");
+    }
+    // a > b iff b - a borrows
+    return BorrowOut(*other.share_, *share_);
   } else {  // BooleanCircuitType
     const auto bitlen = share_->Get()->GetBitLength();
-    std::shared_ptr<ENCRYPTO::AlgorithmDescription> gt_algo;
+    std::shared_ptr<const ENCRYPTO::AlgorithmDescription> gt_algo;
     std::string path;
 
     if (share_->Get()->GetProtocol() == MPCProtocol::BMR)  // BMR, use size-optimized circuit
@@ -183,18 +308,10 @@ Shares::ShareWrapper SecureUnsignedInteger::operator>(const SecureUnsignedIntege
     else  // GMW, use depth-optimized circuit
       path = ConstructPath(ENCRYPTO::IntegerOperationType::GT, bitlen, "_depth");
 
-    if ((gt_algo = share_->Get()->GetRegister()->GetCachedAlgorithmDescription(path))) {
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(
-            fmt::format("Found in cache Boolean integer addition circuit with file path {}", path));
-      }
-    } else {
-      gt_algo = std::make_shared<ENCRYPTO::AlgorithmDescription>(
-          ENCRYPTO::AlgorithmDescription::FromBristol(path));
-      assert(gt_algo);
-      if constexpr (MOTION_DEBUG) {
-        logger_->LogDebug(fmt::format("Read Boolean integer addition circuit from file {}", path));
-      }
+    gt_algo = CircuitCache::get_instance().load(path, CircuitFormat::Bristol);
+    if constexpr (MOTION_DEBUG) {
+      logger_->LogDebug(
+          fmt::format("Using Boolean integer comparison circuit from file {}", path));
     }
     const auto s_in{Shares::ShareWrapper::Join({*share_, *other.share_})};
     return s_in.Evaluate(gt_algo).Split().at(0);
@@ -203,8 +320,10 @@ Shares::ShareWrapper SecureUnsignedInteger::operator>(const SecureUnsignedIntege
 
 Shares::ShareWrapper SecureUnsignedInteger::operator==(const SecureUnsignedInteger& other) const {
   if (share_->Get()->GetCircuitType() != CircuitType::Boolean) {
-    // use primitive operation in arithmetic GMW
-    throw std::runtime_error("Integer comparison is not implemented for arithmetic GMW");
+    // compare in Boolean GMW
+    const SecureUnsignedInteger a(share_->Convert<MPCProtocol::BooleanGMW>());
+    const SecureUnsignedInteger b(other.share_->Convert<MPCProtocol::BooleanGMW>());
+    return a == b;
   } else {  // BooleanCircuitType
     if constexpr (MOTION_DEBUG) {
       if (other->GetProtocol() == MPCProtocol::BMR) {
@@ -217,6 +336,14 @@ Shares::ShareWrapper SecureUnsignedInteger::operator==(const SecureUnsignedInteg
   }
 }
 
+IntegerAlgorithm SecureUnsignedInteger::GetDefaultAlgorithm() const {
+  if (share_->Get()->GetProtocol() == MPCProtocol::BMR) {
+    return IntegerAlgorithm::Circuit;
+  } else {
+    return IntegerAlgorithm::Native;
+  }
+}
+
 std::string SecureUnsignedInteger::ConstructPath(const ENCRYPTO::IntegerOperationType type,
                                                  const std::size_t bitlen,
                                                  std::string suffix) const {
@@ -24,12 +24,23 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "share/share_wrapper.h"
 
 namespace MOTION {
 
 class Logger;
 
+// How the operations on Boolean shares which have no primitive gate are evaluated.
+enum class IntegerAlgorithm : std::uint8_t {
+  // Bristol circuit from circuits/int, evaluated with one gate per AND, XOR and INV
+  Circuit,
+  // layered circuit which evaluates all bits of a layer in a single gate, s.t. it needs fewer
+  // gates and rounds, but may need more AND gates, i.e., more communication
+  Native,
+};
+
 class SecureUnsignedInteger {
  public:
   SecureUnsignedInteger() = default;
@@ -93,17 +104,33 @@ class SecureUnsignedInteger {
     return *this;
   }
 
-  SecureUnsignedInteger operator/(const SecureUnsignedInteger& other) const;
+  SecureUnsignedInteger operator/(const SecureUnsignedInteger& other) const {
+    return Divide(other, GetDefaultAlgorithm());
+  }
 
   SecureUnsignedInteger& operator/=(const SecureUnsignedInteger& other) {
     *this = *this / other;
     return *this;
   }
 
-  Shares::ShareWrapper operator>(const SecureUnsignedInteger& other) const;
+  // Division rounding down, where the native algorithm computes x / 0 as the largest value.
+  // Arithmetic GMW shares are converted to Boolean GMW and the quotient back.
+  SecureUnsignedInteger Divide(const SecureUnsignedInteger& other, IntegerAlgorithm) const;
+
+  Shares::ShareWrapper operator>(const SecureUnsignedInteger& other) const {
+    return GreaterThan(other, GetDefaultAlgorithm());
+  }
+
+  // Returns a Boolean share of a single bit, which is a Boolean GMW share if this is an
+  // Arithmetic GMW share.
+  Shares::ShareWrapper GreaterThan(const SecureUnsignedInteger& other, IntegerAlgorithm) const;
 
   Shares::ShareWrapper operator==(const SecureUnsignedInteger& other) const;
 
+  // Native for Boolean GMW, where the rounds dominate, and Circuit for BMR, where the AND gates
+  // do, since the circuits are evaluated in a constant number of rounds
+  IntegerAlgorithm GetDefaultAlgorithm() const;
+
  private:
   std::shared_ptr<Shares::ShareWrapper> share_{nullptr};
   std::shared_ptr<Logger> logger_{nullptr};
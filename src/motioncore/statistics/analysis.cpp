@@ -22,7 +22,9 @@
 
 #include "analysis.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <sstream>
 
 #include <fmt/format.h>
@@ -39,6 +41,17 @@ namespace json = boost::json;
 namespace MOTION {
 namespace Statistics {
 
+double compute_percentile(std::vector<double> samples, double p) {
+  if (samples.empty()) {
+    return 0;
+  }
+  std::sort(std::begin(samples), std::end(samples));
+  const auto rank = std::clamp(p, 0.0, 100.0) / 100 * static_cast<double>(samples.size() - 1);
+  const auto lower = static_cast<std::size_t>(std::floor(rank));
+  const auto upper = std::min(lower + 1, samples.size() - 1);
+  return samples[lower] + (rank - static_cast<double>(lower)) * (samples[upper] - samples[lower]);
+}
+
 static double compute_duration(const RunTimeStats::time_point_pair& tpp) {
   std::chrono::duration<double, AccumulatedRunTimeStats::resolution> d = tpp.second - tpp.first;
   return d.count();
@@ -46,11 +59,34 @@ static double compute_duration(const RunTimeStats::time_point_pair& tpp) {
 
 void AccumulatedRunTimeStats::add(const RunTimeStats& stats) {
   for (std::size_t i = 0; i <= static_cast<std::size_t>(RunTimeStats::StatID::MAX); ++i) {
-    accumulators_[i](compute_duration(stats.data_[i]));
+    const auto duration = compute_duration(stats.data_[i]);
+    accumulators_[i](duration);
+    samples_[i].push_back(duration);
   }
+  for (const auto id : RunTimeStats::memory_phases) {
+    memory_samples_.at(static_cast<std::size_t>(id)).push_back(stats.get_memory(id));
+    cpu_samples_.at(static_cast<std::size_t>(id)).push_back(stats.get_cpu(id));
+    busy_cpu_samples_.at(static_cast<std::size_t>(id)).push_back(stats.get_busy_cpus(id));
+  }
+  if constexpr (MOTION_HARDWARE_COUNTERS) {
+    for (const auto id : RunTimeStats::counter_phases) {
+      counter_samples_.at(static_cast<std::size_t>(id)).push_back(stats.get_counters(id));
+    }
+  }
+  gate_profile_ += stats.gate_profile_;
+  fiber_stacks_.peak_bytes_in_use_ =
+      std::max(fiber_stacks_.peak_bytes_in_use_, stats.fiber_stacks_.peak_bytes_in_use_);
+  fiber_stacks_.bytes_reserved_ =
+      std::max(fiber_stacks_.bytes_reserved_, stats.fiber_stacks_.bytes_reserved_);
+  fiber_stacks_.num_stacks_allocated_ =
+      std::max(fiber_stacks_.num_stacks_allocated_, stats.fiber_stacks_.num_stacks_allocated_);
   ++count_;
 }
 
+double AccumulatedRunTimeStats::get_percentile(RunTimeStats::StatID id, double p) const {
+  return compute_percentile(samples_.at(static_cast<std::size_t>(id)), p);
+}
+
 template <typename C>
 static typename C::value_type at(const C& container, RunTimeStats::StatID id) {
   return container.at(static_cast<std::size_t>(id));
@@ -58,16 +94,57 @@ static typename C::value_type at(const C& container, RunTimeStats::StatID id) {
 
 using StatID = RunTimeStats::StatID;
 
+// mean over the repetitions
+static double mean_of(const std::vector<double>& samples) {
+  if (samples.empty()) {
+    return 0;
+  }
+  return std::accumulate(std::begin(samples), std::end(samples), 0.0) /
+         static_cast<double>(samples.size());
+}
+
+// name of the phase in the output
+static const char* phase_name(StatID id) {
+  switch (id) {
+    case StatID::base_ots:
+      return "base_ots";
+    case StatID::ot_extension_setup:
+      return "ot_extension_setup";
+    case StatID::preprocessing:
+      return "preprocessing";
+    case StatID::gates_setup:
+      return "gates_setup";
+    case StatID::gates_online:
+      return "gates_online";
+    default:
+      return "unknown";
+  }
+}
+
+// maximum of a member of the PhaseMemoryStats over the repetitions
+template <typename T>
+static T max_memory(const std::vector<PhaseMemoryStats>& samples, T PhaseMemoryStats::*member) {
+  T max = 0;
+  for (const auto& sample : samples) {
+    max = std::max(max, sample.*member);
+  }
+  return max;
+}
+
 static std::string format_line(std::string name, std::string unit,
-                               AccumulatedRunTimeStats::accumulator_type accumulator,
+                               const AccumulatedRunTimeStats& stats, StatID id,
                                std::size_t field_width) {
+  const auto& accumulator = at(stats.accumulators_, id);
   std::stringstream ss;
   ss << fmt::format("{:19s} ", name);
   ss << fmt::format("{:{}.3f} {:s} ", boost::accumulators::mean(accumulator), field_width, unit);
   ss << fmt::format("{:{}.3f} {:s} ", boost::accumulators::median(accumulator), field_width, unit);
   // uncorrected standard deviation
-  ss << fmt::format("{:{}.3f} {:s}", std::sqrt(boost::accumulators::variance(accumulator)),
+  ss << fmt::format("{:{}.3f} {:s} ", std::sqrt(boost::accumulators::variance(accumulator)),
                     field_width, unit);
+  ss << fmt::format("{:{}.3f} {:s} ", stats.get_percentile(id, 90), field_width, unit);
+  ss << fmt::format("{:{}.3f} {:s} ", stats.get_percentile(id, 99), field_width, unit);
+  ss << fmt::format("{:{}.3f} {:s}", stats.get_percentile(id, 100), field_width, unit);
   ss << "\n";
   return ss.str();
 }
@@ -79,48 +156,227 @@ std::string AccumulatedRunTimeStats::print_human_readable() const {
 
   ss << fmt::format("Run time statistics over {} iterations\n", count_)
      << "---------------------------------------------------------------------------\n"
-     << fmt::format("                    {:>{}s}    {:>{}s}    {:>{}s}\n", "mean", field_width,
-                    "median", field_width, "stddev", field_width)
+     << fmt::format("                    {:>{}s}    {:>{}s}    {:>{}s}    {:>{}s}    {:>{}s}    "
+                    "{:>{}s}\n",
+                    "mean", field_width, "median", field_width, "stddev", field_width, "p90",
+                    field_width, "p99", field_width, "max", field_width)
      << "---------------------------------------------------------------------------\n"
-     << format_line("MT Presetup", unit, at(accumulators_, StatID::mt_presetup), field_width)
-     << format_line("MT Setup", unit, at(accumulators_, StatID::mt_setup), field_width)
-     << format_line("SP Presetup", unit, at(accumulators_, StatID::sp_presetup), field_width)
-     << format_line("SP Setup", unit, at(accumulators_, StatID::sp_setup), field_width)
-     << format_line("SB Presetup", unit, at(accumulators_, StatID::sb_presetup), field_width)
-     << format_line("SB Setup", unit, at(accumulators_, StatID::sb_setup), field_width)
-     << format_line("Base OTs", unit, at(accumulators_, StatID::base_ots), field_width)
-     << format_line("OT Extension Setup", unit, at(accumulators_, StatID::ot_extension_setup),
-                    field_width)
+     << format_line("MT Presetup", unit, *this, StatID::mt_presetup, field_width)
+     << format_line("MT Setup", unit, *this, StatID::mt_setup, field_width)
+     << format_line("SP Presetup", unit, *this, StatID::sp_presetup, field_width)
+     << format_line("SP Setup", unit, *this, StatID::sp_setup, field_width)
+     << format_line("SB Presetup", unit, *this, StatID::sb_presetup, field_width)
+     << format_line("SB Setup", unit, *this, StatID::sb_setup, field_width)
+     << format_line("Base OTs", unit, *this, StatID::base_ots, field_width)
+     << format_line("OT Extension Setup", unit, *this, StatID::ot_extension_setup, field_width)
      << "---------------------------------------------------------------------------\n"
-     << format_line("Preprocessing Total", unit, at(accumulators_, StatID::preprocessing),
-                    field_width)
-     << format_line("Gates Setup", unit, at(accumulators_, StatID::gates_setup), field_width)
-     << format_line("Gates Online", unit, at(accumulators_, StatID::gates_online), field_width)
+     << format_line("Preprocessing Total", unit, *this, StatID::preprocessing, field_width)
+     << format_line("Gates Setup", unit, *this, StatID::gates_setup, field_width)
+     << format_line("Gates Online", unit, *this, StatID::gates_online, field_width)
      << "---------------------------------------------------------------------------\n"
-     << format_line("Circuit Evaluation", unit, at(accumulators_, StatID::evaluate), field_width);
+     << format_line("Circuit Evaluation", unit, *this, StatID::evaluate, field_width)
+     << format_line("Time to First Gate", unit, *this, StatID::time_to_first_gate, field_width);
+
+  ss << "---------------------------------------------------------------------------\n"
+     << fmt::format("Memory (max over iterations) {:>12s} {:>12s} {:>12s} {:>12s}\n", "RSS MiB",
+                    "RSS +MiB", "tracked MiB", "tracked +MiB");
+  for (const auto id : RunTimeStats::memory_phases) {
+    const auto& samples = at(memory_samples_, id);
+    ss << fmt::format(
+        "{:28s} {:12.3f} {:12.3f} {:12.3f} {:12.3f}\n", phase_name(id),
+        static_cast<double>(max_memory(samples, &PhaseMemoryStats::peak_rss_bytes_)) / 1048576,
+        static_cast<double>(max_memory(samples, &PhaseMemoryStats::peak_rss_growth_bytes_)) /
+            1048576,
+        static_cast<double>(max_memory(samples, &PhaseMemoryStats::tracked_peak_bytes_)) / 1048576,
+        static_cast<double>(max_memory(samples, &PhaseMemoryStats::tracked_allocated_bytes_)) /
+            1048576);
+  }
+  ss << fmt::format("{:28s} {:12.3f} {:>12s} {:>12s} {:>12s}\n", "Fiber Stacks (peak MiB)",
+                    static_cast<double>(fiber_stacks_.peak_bytes_in_use_) / 1048576, "", "", "")
+     << fmt::format("{:28s} {:12.3f} {:>12s} {:>12s} {:>12s}\n", "Fiber Stacks (reserved MiB)",
+                    static_cast<double>(fiber_stacks_.bytes_reserved_) / 1048576, "", "", "");
+
+  ss << "---------------------------------------------------------------------------\n"
+     << fmt::format("CPU (mean over iterations)   {:>12s} {:>12s} {:>12s}\n", "CPU ms",
+                    "busy CPUs", "OMP threads");
+  for (const auto id : RunTimeStats::memory_phases) {
+    const auto& samples = at(cpu_samples_, id);
+    std::vector<double> cpu_times(samples.size());
+    std::transform(std::begin(samples), std::end(samples), std::begin(cpu_times),
+                   [](const auto& sample) { return sample.cpu_time_ms_; });
+    // the threads of the last repetition, they may be adapted between the repetitions
+    const auto omp_threads = samples.empty() ? std::size_t(0) : samples.back().omp_threads_;
+    ss << fmt::format("{:28s} {:12.3f} {:12.2f} {:>12s}\n", phase_name(id),
+                      mean_of(cpu_times), mean_of(at(busy_cpu_samples_, id)),
+                      omp_threads == 0 ? std::string("default") : std::to_string(omp_threads));
+  }
+
+  if constexpr (MOTION_HARDWARE_COUNTERS) {
+    ss << "---------------------------------------------------------------------------\n"
+       << fmt::format("Counters (mean over iter.)   {:>12s} {:>12s} {:>12s} {:>12s}\n", "Minstr",
+                      "IPC", "cache miss %", "br. miss %");
+    for (const auto id : RunTimeStats::counter_phases) {
+      const auto& samples = at(counter_samples_, id);
+      std::vector<double> instructions, ipc, cache_miss_rate, branch_miss_rate;
+      for (const auto& sample : samples) {
+        instructions.push_back(static_cast<double>(sample.instructions_) / 1e6);
+        ipc.push_back(sample.get_ipc());
+        cache_miss_rate.push_back(100 * sample.get_cache_miss_rate());
+        branch_miss_rate.push_back(100 * sample.get_branch_miss_rate());
+      }
+      ss << fmt::format("{:28s} {:12.3f} {:12.2f} {:12.2f} {:12.2f}\n", phase_name(id),
+                        mean_of(instructions), mean_of(ipc), mean_of(cache_miss_rate),
+                        mean_of(branch_miss_rate));
+    }
+  }
+
+  if (!gate_profile_.empty()) {
+    const auto n = static_cast<double>(std::max(count_, std::size_t(1)));
+    const auto print_entry = [&ss, n](const std::string& name, const GateProfileEntry& entry) {
+      ss << fmt::format("{:40s} {:8.0f} {:10.3f} {:10.3f} {:10.3f} {:10.3f}\n", name,
+                        entry.num_gates_ / n, entry.setup_time_ms_ / n, entry.online_time_ms_ / n,
+                        static_cast<double>(entry.num_bytes_sent_) / n / 1024,
+                        static_cast<double>(entry.num_bytes_received_) / n / 1024);
+    };
+    ss << "---------------------------------------------------------------------------\n"
+       << fmt::format("Gate profile (mean per iteration)\n{:40s} {:>8s} {:>10s} {:>10s} {:>10s} "
+                      "{:>10s}\n",
+                      "", "gates", "setup ms", "online ms", "sent KiB", "recv KiB");
+    for (const auto& [type, entry] : gate_profile_.by_type_) {
+      print_entry(type, entry);
+    }
+    for (const auto& [first_id, entry] : gate_profile_.by_gate_id_range_) {
+      print_entry(fmt::format("gate ids [{}, {})", first_id,
+                              first_id + gate_profile_.gate_id_range_width_),
+                  entry);
+    }
+    print_entry("unknown gates", gate_profile_.unknown_gates_);
+  }
 
   return ss.str();
 }
 
+static json::object gate_profile_entry_to_json(const GateProfileEntry& entry, double count) {
+  return {{"num_gates", static_cast<double>(entry.num_gates_) / count},
+          {"setup_time", entry.setup_time_ms_ / count},
+          {"online_time", entry.online_time_ms_ / count},
+          {"bytes_sent", static_cast<double>(entry.num_bytes_sent_) / count},
+          {"messages_sent", static_cast<double>(entry.num_messages_sent_) / count},
+          {"bytes_received", static_cast<double>(entry.num_bytes_received_) / count},
+          {"messages_received", static_cast<double>(entry.num_messages_received_) / count}};
+}
+
+static json::object gate_profile_to_json(const GateProfile& profile, std::size_t count) {
+  const auto n = static_cast<double>(std::max(count, std::size_t(1)));
+  json::object by_type;
+  for (const auto& [type, entry] : profile.by_type_) {
+    by_type.emplace(type, gate_profile_entry_to_json(entry, n));
+  }
+  json::array by_gate_id_range;
+  for (const auto& [first_id, entry] : profile.by_gate_id_range_) {
+    auto obj = gate_profile_entry_to_json(entry, n);
+    obj.emplace("first_gate_id", first_id);
+    obj.emplace("last_gate_id", first_id + profile.gate_id_range_width_ - 1);
+    by_gate_id_range.emplace_back(std::move(obj));
+  }
+  return {{"by_type", std::move(by_type)},
+          {"by_gate_id_range", std::move(by_gate_id_range)},
+          {"unknown_gates", gate_profile_entry_to_json(profile.unknown_gates_, n)}};
+}
+
 json::object AccumulatedRunTimeStats::to_json() const {
   const auto mk_triple = [this](const auto& stat_id) {
     const auto& acc = at(accumulators_, stat_id);
+    const auto& samples = at(samples_, stat_id);
     return json::object({{"mean", boost::accumulators::mean(acc)},
                          {"median", boost::accumulators::median(acc)},
                          // uncorrected standard deviation
-                         {"stddev", std::sqrt(boost::accumulators::variance(acc))}});
+                         {"stddev", std::sqrt(boost::accumulators::variance(acc))},
+                         {"p50", get_percentile(stat_id, 50)},
+                         {"p90", get_percentile(stat_id, 90)},
+                         {"p99", get_percentile(stat_id, 99)},
+                         {"max", get_percentile(stat_id, 100)},
+                         {"samples", json::array(std::begin(samples), std::end(samples))}});
   };
-  return {{"repetitions", count_},
-          {"mt_setup", mk_triple(StatID::mt_setup)},
-          {"sp_setup", mk_triple(StatID::sp_setup)},
-          {"sb_setup", mk_triple(StatID::sb_setup)},
-          {"linalgtriple_setup", mk_triple(StatID::linalgtriple_setup)},
-          {"base_ots", mk_triple(StatID::base_ots)},
-          {"ot_extension_setup", mk_triple(StatID::ot_extension_setup)},
-          {"preprocessing", mk_triple(StatID::preprocessing)},
-          {"gates_setup", mk_triple(StatID::gates_setup)},
-          {"gates_online", mk_triple(StatID::gates_online)},
-          {"evaluate", mk_triple(StatID::evaluate)}};
+  json::object obj{{"repetitions", count_},
+                   {"mt_setup", mk_triple(StatID::mt_setup)},
+                   {"sp_setup", mk_triple(StatID::sp_setup)},
+                   {"sb_setup", mk_triple(StatID::sb_setup)},
+                   {"linalgtriple_setup", mk_triple(StatID::linalgtriple_setup)},
+                   {"base_ots", mk_triple(StatID::base_ots)},
+                   {"ot_extension_setup", mk_triple(StatID::ot_extension_setup)},
+                   {"preprocessing", mk_triple(StatID::preprocessing)},
+                   {"gates_setup", mk_triple(StatID::gates_setup)},
+                   {"gates_online", mk_triple(StatID::gates_online)},
+                   {"evaluate", mk_triple(StatID::evaluate)},
+                   {"time_to_first_gate", mk_triple(StatID::time_to_first_gate)}};
+  json::object memory;
+  for (const auto id : RunTimeStats::memory_phases) {
+    const auto& samples = at(memory_samples_, id);
+    memory.emplace(
+        phase_name(id),
+        json::object(
+            {{"peak_rss_bytes", max_memory(samples, &PhaseMemoryStats::peak_rss_bytes_)},
+             {"peak_rss_growth_bytes",
+              max_memory(samples, &PhaseMemoryStats::peak_rss_growth_bytes_)},
+             // zero unless MOTION_MEMORY_TRACKING is enabled
+             {"tracked_peak_bytes", max_memory(samples, &PhaseMemoryStats::tracked_peak_bytes_)},
+             {"tracked_allocated_bytes",
+              max_memory(samples, &PhaseMemoryStats::tracked_allocated_bytes_)}}));
+  }
+  obj.emplace("memory", std::move(memory));
+  json::object cpu;
+  for (const auto id : RunTimeStats::memory_phases) {
+    const auto& samples = at(cpu_samples_, id);
+    json::array cpu_times;
+    json::array omp_threads;
+    for (const auto& sample : samples) {
+      cpu_times.emplace_back(sample.cpu_time_ms_);
+      omp_threads.emplace_back(sample.omp_threads_);
+    }
+    const auto& busy_cpus = at(busy_cpu_samples_, id);
+    cpu.emplace(phase_name(id),
+                json::object({{"cpu_time", std::move(cpu_times)},
+                              {"busy_cpus", json::array(std::begin(busy_cpus),
+                                                        std::end(busy_cpus))},
+                              // 0 if the default of OpenMP was used
+                              {"omp_threads", std::move(omp_threads)}}));
+  }
+  obj.emplace("cpu", std::move(cpu));
+  if constexpr (MOTION_HARDWARE_COUNTERS) {
+    json::object counters;
+    for (const auto id : RunTimeStats::counter_phases) {
+      json::array cycles, instructions, cache_references, cache_misses, branch_instructions,
+          branch_misses, ipc;
+      for (const auto& sample : at(counter_samples_, id)) {
+        cycles.emplace_back(sample.cycles_);
+        instructions.emplace_back(sample.instructions_);
+        cache_references.emplace_back(sample.cache_references_);
+        cache_misses.emplace_back(sample.cache_misses_);
+        branch_instructions.emplace_back(sample.branch_instructions_);
+        branch_misses.emplace_back(sample.branch_misses_);
+        ipc.emplace_back(sample.get_ipc());
+      }
+      counters.emplace(phase_name(id),
+                       json::object({{"cycles", std::move(cycles)},
+                                     {"instructions", std::move(instructions)},
+                                     {"ipc", std::move(ipc)},
+                                     {"cache_references", std::move(cache_references)},
+                                     {"cache_misses", std::move(cache_misses)},
+                                     {"branch_instructions", std::move(branch_instructions)},
+                                     {"branch_misses", std::move(branch_misses)}}));
+    }
+    obj.emplace("hardware_counters", std::move(counters));
+  }
+  obj.emplace("fiber_stacks",
+              json::object({{"peak_bytes_in_use", fiber_stacks_.peak_bytes_in_use_},
+                            {"bytes_reserved", fiber_stacks_.bytes_reserved_},
+                            {"num_stacks_allocated", fiber_stacks_.num_stacks_allocated_}}));
+  // only recorded if MOTION_GATE_PROFILING is enabled
+  if (!gate_profile_.empty()) {
+    obj.emplace("gate_profile", gate_profile_to_json(gate_profile_, count_));
+  }
+  return obj;
 }
 
 void AccumulatedCommunicationStats::add(const Communication::TransportStatistics& stats) {
@@ -128,6 +384,24 @@ void AccumulatedCommunicationStats::add(const Communication::TransportStatistics
   accumulators_[idx_num_messages_received](stats.num_messages_received);
   accumulators_[idx_num_bytes_sent](stats.num_bytes_sent);
   accumulators_[idx_num_bytes_received](stats.num_bytes_received);
+  accumulators_[idx_max_receive_queue_depth](stats.max_receive_queue_depth);
+  accumulators_[idx_receive_stall_time_us](stats.receive_stall_time_us);
+  accumulators_[idx_num_compressed_messages_sent](stats.num_compressed_messages_sent);
+  accumulators_[idx_num_bytes_saved_by_compression](stats.num_bytes_saved_by_compression);
+  accumulators_[idx_num_send_batches](stats.num_send_batches);
+  accumulators_[idx_max_send_batch_size](stats.max_send_batch_size);
+  accumulators_[idx_num_send_queue_retries](stats.num_send_queue_retries);
+  samples_[idx_num_messages_sent].push_back(stats.num_messages_sent);
+  samples_[idx_num_messages_received].push_back(stats.num_messages_received);
+  samples_[idx_num_bytes_sent].push_back(stats.num_bytes_sent);
+  samples_[idx_num_bytes_received].push_back(stats.num_bytes_received);
+  samples_[idx_max_receive_queue_depth].push_back(stats.max_receive_queue_depth);
+  samples_[idx_receive_stall_time_us].push_back(stats.receive_stall_time_us);
+  samples_[idx_num_compressed_messages_sent].push_back(stats.num_compressed_messages_sent);
+  samples_[idx_num_bytes_saved_by_compression].push_back(stats.num_bytes_saved_by_compression);
+  samples_[idx_num_send_batches].push_back(stats.num_send_batches);
+  samples_[idx_max_send_batch_size].push_back(stats.max_send_batch_size);
+  samples_[idx_num_send_queue_retries].push_back(stats.num_send_queue_retries);
   ++count_;
 }
 
@@ -138,7 +412,17 @@ void AccumulatedCommunicationStats::add(
   }
 }
 
+double AccumulatedCommunicationStats::get_percentile(std::size_t idx, double p) const {
+  const auto& samples = samples_.at(idx);
+  return compute_percentile(std::vector<double>(std::begin(samples), std::end(samples)), p);
+}
+
 std::string AccumulatedCommunicationStats::print_human_readable() const {
+  const auto format_percentiles = [this](std::size_t idx) {
+    return fmt::format("p50 {:0.3f} MiB, p90 {:0.3f} MiB, p99 {:0.3f} MiB, max {:0.3f} MiB",
+                       get_percentile(idx, 50) / 1048576, get_percentile(idx, 90) / 1048576,
+                       get_percentile(idx, 99) / 1048576, get_percentile(idx, 100) / 1048576);
+  };
   std::stringstream ss;
   ss << "Communication with each other party:\n"
      << fmt::format("Sent: {:0.3f} MiB in {:d} messages\n",
@@ -148,12 +432,47 @@ std::string AccumulatedCommunicationStats::print_human_readable() const {
      << fmt::format("Received: {:0.3f} MiB in {:d} messages\n",
                     boost::accumulators::mean(accumulators_[idx_num_bytes_received]) / 1048576,
                     static_cast<std::size_t>(
-                        boost::accumulators::mean(accumulators_[idx_num_messages_received])));
+                        boost::accumulators::mean(accumulators_[idx_num_messages_received])))
+     << fmt::format("Sent per repetition: {}\n", format_percentiles(idx_num_bytes_sent))
+     << fmt::format("Received per repetition: {}\n", format_percentiles(idx_num_bytes_received))
+     << fmt::format("Receive queue: max depth {:d} messages, reader stalled for {:0.3f} ms\n",
+                    static_cast<std::size_t>(
+                        boost::accumulators::mean(accumulators_[idx_max_receive_queue_depth])),
+                    boost::accumulators::mean(accumulators_[idx_receive_stall_time_us]) / 1000)
+     << fmt::format("Compression: saved {:0.3f} MiB in {:d} messages\n",
+                    boost::accumulators::mean(accumulators_[idx_num_bytes_saved_by_compression]) /
+                        1048576,
+                    static_cast<std::size_t>(boost::accumulators::mean(
+                        accumulators_[idx_num_compressed_messages_sent])))
+     << fmt::format("Send queue: {:d} batches, max batch {:d} messages, {:d} enqueue retries\n",
+                    static_cast<std::size_t>(
+                        boost::accumulators::mean(accumulators_[idx_num_send_batches])),
+                    static_cast<std::size_t>(
+                        boost::accumulators::mean(accumulators_[idx_max_send_batch_size])),
+                    static_cast<std::size_t>(
+                        boost::accumulators::mean(accumulators_[idx_num_send_queue_retries])));
   return ss.str();
 }
 
 json::object AccumulatedCommunicationStats::to_json() const {
-  return {
+  // same order as the idx_* constants
+  static constexpr std::array<const char*, 11> names = {
+      "num_messages_sent", "num_messages_received", "bytes_sent",
+      "bytes_received", "max_receive_queue_depth", "receive_stall_time_us",
+      "num_compressed_messages_sent", "bytes_saved_by_compression", "num_send_batches",
+      "max_send_batch_size", "num_send_queue_retries"};
+  json::object distribution;
+  for (std::size_t idx = 0; idx < names.size(); ++idx) {
+    const auto& samples = samples_[idx];
+    distribution.emplace(names[idx],
+                         json::object({{"p50", get_percentile(idx, 50)},
+                                       {"p90", get_percentile(idx, 90)},
+                                       {"p99", get_percentile(idx, 99)},
+                                       {"max", get_percentile(idx, 100)},
+                                       {"samples", json::array(std::begin(samples),
+                                                               std::end(samples))}}));
+  }
+  json::object obj{
       {"bytes_sent",
        static_cast<std::size_t>(boost::accumulators::mean(accumulators_[idx_num_bytes_sent]))},
       {"num_messages_sent",
@@ -161,7 +480,24 @@ json::object AccumulatedCommunicationStats::to_json() const {
       {"bytes_received",
        static_cast<std::size_t>(boost::accumulators::mean(accumulators_[idx_num_bytes_received]))},
       {"num_messages_received", static_cast<std::size_t>(boost::accumulators::mean(
-                                    accumulators_[idx_num_messages_received]))}};
+                                    accumulators_[idx_num_messages_received]))},
+      {"max_receive_queue_depth", static_cast<std::size_t>(boost::accumulators::mean(
+                                      accumulators_[idx_max_receive_queue_depth]))},
+      {"receive_stall_time_us", static_cast<std::size_t>(boost::accumulators::mean(
+                                    accumulators_[idx_receive_stall_time_us]))},
+      {"num_compressed_messages_sent", static_cast<std::size_t>(boost::accumulators::mean(
+                                           accumulators_[idx_num_compressed_messages_sent]))},
+      {"bytes_saved_by_compression", static_cast<std::size_t>(boost::accumulators::mean(
+                                         accumulators_[idx_num_bytes_saved_by_compression]))},
+      {"num_send_batches",
+       static_cast<std::size_t>(boost::accumulators::mean(accumulators_[idx_num_send_batches]))},
+      {"max_send_batch_size", static_cast<std::size_t>(boost::accumulators::mean(
+                                  accumulators_[idx_max_send_batch_size]))},
+      {"num_send_queue_retries", static_cast<std::size_t>(boost::accumulators::mean(
+                                     accumulators_[idx_num_send_queue_retries]))}};
+  // per repetition, e.g., for latency and bandwidth percentiles
+  obj.emplace("distribution", std::move(distribution));
+  return obj;
 }
 
 std::string print_motion_info() {
@@ -182,6 +518,8 @@ std::string print_stats(const std::string& experiment_name,
      << print_motion_info()
      << "===========================================================================\n"
      << exec_stats.print_human_readable()
+     << fmt::format("Peak memory usage: {:0.3f} MiB\n",
+                    static_cast<double>(get_peak_memory_usage()) / 1048576)
      << "===========================================================================\n"
      << comm_stats.print_human_readable()
      << "===========================================================================\n";
@@ -202,6 +540,7 @@ json::object to_json(const std::string& experiment_name, const AccumulatedRunTim
                       {"git-commit", get_git_commit()},
                       {"git-version", get_git_version()}}}});
   obj.emplace("runtime", exec_stats.to_json());
+  obj.emplace("peak_memory_bytes", get_peak_memory_usage());
   obj.emplace("communication", comm_stats.to_json());
   return obj;
 }
@@ -30,6 +30,7 @@
 #include <boost/accumulators/statistics/variance.hpp>
 #include <boost/json/object.hpp>
 #include <list>
+#include <vector>
 #include "run_time_stats.h"
 
 namespace MOTION {
@@ -40,6 +41,10 @@ struct TransportStatistics;
 
 namespace Statistics {
 
+// p-th percentile (0 <= p <= 100) of the samples, interpolated linearly between the closest
+// ranks, or 0 if there are no samples
+double compute_percentile(std::vector<double> samples, double p);
+
 struct AccumulatedRunTimeStats {
   using clock_type = std::chrono::steady_clock;
   using duration = clock_type::duration;
@@ -52,8 +57,31 @@ struct AccumulatedRunTimeStats {
   std::size_t count_ = 0;
   std::array<accumulator_type, static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
       accumulators_;
+  // duration of each repetition in the resolution above, for the percentiles and the raw export
+  std::array<std::vector<double>, static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
+      samples_;
+  // memory of each repetition, only filled for the RunTimeStats::memory_phases
+  std::array<std::vector<PhaseMemoryStats>,
+             static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
+      memory_samples_;
+  // CPU time and average number of busy CPUs of each repetition, only filled for the
+  // RunTimeStats::memory_phases
+  std::array<std::vector<PhaseCpuStats>, static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
+      cpu_samples_;
+  std::array<std::vector<double>, static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
+      busy_cpu_samples_;
+  // hardware counters of each repetition, only filled for the RunTimeStats::counter_phases if
+  // MOTION_HARDWARE_COUNTERS is enabled
+  std::array<std::vector<HardwareCounterStats>,
+             static_cast<std::size_t>(RunTimeStats::StatID::MAX) + 1>
+      counter_samples_;
+  // summed over all repetitions, the output shows the mean per repetition
+  GateProfile gate_profile_;
+  // maximum over all repetitions
+  FiberStackMemoryStats fiber_stacks_;
 
   void add(const RunTimeStats& stats);
+  double get_percentile(RunTimeStats::StatID id, double p) const;
   std::string print_human_readable() const;
   boost::json::object to_json() const;
 };
@@ -67,12 +95,22 @@ struct AccumulatedCommunicationStats {
   static constexpr std::size_t idx_num_messages_received = 1;
   static constexpr std::size_t idx_num_bytes_sent = 2;
   static constexpr std::size_t idx_num_bytes_received = 3;
+  static constexpr std::size_t idx_max_receive_queue_depth = 4;
+  static constexpr std::size_t idx_receive_stall_time_us = 5;
+  static constexpr std::size_t idx_num_compressed_messages_sent = 6;
+  static constexpr std::size_t idx_num_bytes_saved_by_compression = 7;
+  static constexpr std::size_t idx_num_send_batches = 8;
+  static constexpr std::size_t idx_max_send_batch_size = 9;
+  static constexpr std::size_t idx_num_send_queue_retries = 10;
 
   std::size_t count_ = 0;
-  std::array<accumulator_type, 4> accumulators_;
+  std::array<accumulator_type, 11> accumulators_;
+  // value of each added TransportStatistics, for the percentiles and the raw export
+  std::array<std::vector<std::size_t>, 11> samples_;
 
   void add(const Communication::TransportStatistics& stats);
   void add(const std::vector<Communication::TransportStatistics>& stats);
+  double get_percentile(std::size_t idx, double p) const;
   std::string print_human_readable() const;
   boost::json::object to_json() const;
 };
@@ -0,0 +1,239 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "circuit_analysis.h"
+
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+
+#include <fmt/format.h>
+
+#include "algorithm/algorithm_description.h"
+#include "algorithm/circuit_optimizer.h"
+#include "base/gate_register.h"
+#include "executor/gate_dependencies.h"
+#include "gate/new_gate.h"
+#include "utility/block.h"
+#include "utility/helpers.h"
+#include "utility/typedefs.h"
+
+namespace MOTION {
+namespace Statistics {
+
+std::size_t CircuitAnalysis::get_setup_bytes() const noexcept {
+  std::size_t num_bytes = 0;
+  for (const auto& [protocol, entry] : by_protocol_) {
+    num_bytes += entry.setup_bytes_;
+  }
+  return num_bytes;
+}
+
+std::size_t CircuitAnalysis::get_online_bytes() const noexcept {
+  std::size_t num_bytes = 0;
+  for (const auto& [protocol, entry] : by_protocol_) {
+    num_bytes += entry.online_bytes_;
+  }
+  return num_bytes;
+}
+
+std::string CircuitAnalysis::print_human_readable() const {
+  std::stringstream ss;
+  ss << "Circuit analysis (predicted, sent by this party)\n"
+     << "---------------------------------------------------------------------------\n"
+     << fmt::format("{:16s} {:>9s} {:>9s} {:>6s} {:>10s} {:>10s} {:>9s}\n", "", "gates",
+                    "interact.", "depth", "setup KiB", "online KiB", "OTs");
+  for (const auto& [protocol, entry] : by_protocol_) {
+    ss << fmt::format("{:16s} {:9d} {:9d} {:6d} {:10.3f} {:10.3f} {:9d}\n", ToString(protocol),
+                      entry.num_gates_, entry.num_interactive_gates_, entry.online_depth_,
+                      static_cast<double>(entry.setup_bytes_) / 1024,
+                      static_cast<double>(entry.online_bytes_) / 1024, entry.num_ots_);
+  }
+  ss << "---------------------------------------------------------------------------\n"
+     << fmt::format("{:16s} {:>9s} {:>9s} {:>6s} {:10.3f} {:10.3f}\n", "Total", "", "", "",
+                    static_cast<double>(get_setup_bytes()) / 1024,
+                    static_cast<double>(get_online_bytes()) / 1024)
+     << fmt::format("Online rounds on the critical path: {} ({} communicating gates)\n",
+                    online_rounds_, critical_path_.size());
+  for (const auto& [protocol, entry] : by_protocol_) {
+    if (entry.deferred_rounds_ > 0) {
+      ss << fmt::format("Deferred reconstruction rounds in {}: {}\n", ToString(protocol),
+                        entry.deferred_rounds_);
+    }
+  }
+  if (!unmodeled_gates_.empty()) {
+    ss << "Gates without cost model (assumed to be local):\n";
+    for (const auto& [type, num_gates] : unmodeled_gates_) {
+      ss << fmt::format("  {:9d} {}\n", num_gates, type);
+    }
+  }
+  return ss.str();
+}
+
+namespace {
+
+// Longest path through the gates in dependency order, where each gate adds its weight.  Returns
+// the length of the path and the predecessor of each gate on the longest path ending there.
+struct LongestPath {
+  std::size_t length_ = 0;
+  std::size_t last_gate_ = 0;
+  std::vector<std::optional<std::size_t>> predecessors_;
+};
+
+LongestPath compute_longest_path(const GateDependencies& dependencies,
+                                 const std::vector<std::size_t>& order,
+                                 const std::vector<std::size_t>& weights) {
+  const auto num_gates = weights.size();
+  LongestPath path;
+  path.predecessors_.resize(num_gates);
+  // length of the longest path ending right before and at each gate
+  std::vector<std::size_t> before(num_gates, 0);
+  std::vector<std::size_t> at(num_gates, 0);
+  for (auto gate_i : order) {
+    at[gate_i] = before[gate_i] + weights[gate_i];
+    if (at[gate_i] > path.length_) {
+      path.length_ = at[gate_i];
+      path.last_gate_ = gate_i;
+    }
+    for (auto succ_i : dependencies.successors_[gate_i]) {
+      if (!path.predecessors_[succ_i].has_value() || at[gate_i] > before[succ_i]) {
+        before[succ_i] = at[gate_i];
+        path.predecessors_[succ_i] = gate_i;
+      }
+    }
+  }
+  return path;
+}
+
+}  // namespace
+
+CircuitAnalysis analyze_circuit(const GateRegister& gate_register) {
+  const auto& gates = gate_register.get_gates();
+  const auto num_gates = gates.size();
+  const GateDependencies dependencies(gates);
+
+  // topological order of the gates, gates on a cycle are left out
+  std::vector<std::size_t> order;
+  order.reserve(num_gates);
+  std::vector<std::size_t> remaining(dependencies.num_predecessors_);
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    if (remaining[gate_i] == 0) {
+      order.push_back(gate_i);
+    }
+  }
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    for (auto succ_i : dependencies.successors_[order[i]]) {
+      if (--remaining[succ_i] == 0) {
+        order.push_back(succ_i);
+      }
+    }
+  }
+
+  CircuitAnalysis analysis;
+  std::vector<std::optional<GateCost>> costs(num_gates);
+  std::vector<std::size_t> rounds(num_gates, 0);
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    const auto& gate = *gates[gate_i];
+    costs[gate_i] = gate.get_cost();
+    if (!costs[gate_i].has_value()) {
+      ++analysis.unmodeled_gates_[boost::core::demangle(typeid(gate).name())];
+      continue;
+    }
+    const auto& cost = *costs[gate_i];
+    auto& entry = analysis.by_protocol_[cost.protocol_];
+    ++entry.num_gates_;
+    if (cost.online_rounds_ > 0) {
+      ++entry.num_interactive_gates_;
+    }
+    entry.setup_bytes_ += cost.setup_bytes_;
+    entry.online_bytes_ += cost.online_bytes_;
+    entry.num_ots_ += cost.num_ots_;
+    entry.deferred_rounds_ += cost.deferred_rounds_;
+    rounds[gate_i] = cost.online_rounds_;
+  }
+
+  auto critical_path = compute_longest_path(dependencies, order, rounds);
+  analysis.online_rounds_ = critical_path.length_;
+  if (critical_path.length_ > 0) {
+    for (std::optional<std::size_t> gate_i = critical_path.last_gate_; gate_i.has_value();
+         gate_i = critical_path.predecessors_[*gate_i]) {
+      if (rounds[*gate_i] > 0) {
+        analysis.critical_path_.push_back(gates[*gate_i]->get_gate_id());
+      }
+    }
+    std::reverse(std::begin(analysis.critical_path_), std::end(analysis.critical_path_));
+  }
+
+  // the depth of each protocol only counts the rounds of its own gates
+  for (auto& [protocol, entry] : analysis.by_protocol_) {
+    std::vector<std::size_t> protocol_rounds(num_gates, 0);
+    for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+      if (costs[gate_i].has_value() && costs[gate_i]->protocol_ == protocol) {
+        protocol_rounds[gate_i] = rounds[gate_i];
+      }
+    }
+    entry.online_depth_ = compute_longest_path(dependencies, order, protocol_rounds).length_;
+  }
+  return analysis;
+}
+
+CircuitAnalysis analyze_circuit(const ENCRYPTO::AlgorithmDescription& algo, MPCProtocol protocol,
+                                std::size_t num_simd) {
+  const auto circuit_stats = ENCRYPTO::ComputeCircuitStatistics(algo);
+  const auto num_nonlinear_gates = circuit_stats.num_and_gates + circuit_stats.num_or_gates;
+  // each AND and OR gate is evaluated like a single AND gate with num_simd values
+  const auto setup_bits =
+      GateCost::cot_sender_bits(num_simd, 1) + GateCost::cot_receiver_bits(num_simd);
+
+  CircuitAnalysis analysis;
+  auto& entry = analysis.by_protocol_[protocol];
+  entry.num_gates_ = circuit_stats.num_gates;
+  switch (protocol) {
+    case MPCProtocol::BooleanGMW:
+    case MPCProtocol::BooleanBEAVY: {
+      const auto online_bits = protocol == MPCProtocol::BooleanGMW ? 2 * num_simd : num_simd;
+      entry.num_interactive_gates_ = num_nonlinear_gates;
+      entry.online_depth_ = circuit_stats.and_depth;
+      entry.setup_bytes_ = num_nonlinear_gates * Helpers::Convert::BitsToBytes(setup_bits);
+      entry.online_bytes_ = num_nonlinear_gates * Helpers::Convert::BitsToBytes(online_bits);
+      entry.num_ots_ = num_nonlinear_gates * 2 * num_simd;
+      analysis.online_rounds_ = circuit_stats.and_depth;
+      break;
+    }
+    case MPCProtocol::Yao: {
+      // half gates: two ciphertexts per gate, the evaluation is local
+      entry.setup_bytes_ = num_nonlinear_gates * 2 * num_simd * sizeof(ENCRYPTO::block128_t);
+      break;
+    }
+    default:
+      throw std::invalid_argument(
+          fmt::format("analyze_circuit: no cost model for Boolean circuits in {}",
+                      ToString(protocol)));
+  }
+  return analysis;
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ENCRYPTO {
+struct AlgorithmDescription;
+}  // namespace ENCRYPTO
+
+namespace MOTION {
+
+class GateRegister;
+enum class MPCProtocol : unsigned int;
+
+namespace Statistics {
+
+// Depth and communication of a circuit as predicted by the cost models of its gates (see
+// NewGate::get_cost()) before it is evaluated.  The bytes are the ones sent by this party.
+struct CircuitAnalysis {
+  struct ProtocolEntry {
+    std::size_t num_gates_ = 0;
+    // gates communicating in the online phase
+    std::size_t num_interactive_gates_ = 0;
+    // online rounds on the longest path counting only the gates of this protocol
+    std::size_t online_depth_ = 0;
+    std::size_t setup_bytes_ = 0;
+    std::size_t online_bytes_ = 0;
+    std::size_t num_ots_ = 0;
+    // rounds of the gates which reconstruct values that previous gates left additively shared
+    std::size_t deferred_rounds_ = 0;
+  };
+
+  std::map<MPCProtocol, ProtocolEntry> by_protocol_;
+  // gate type -> number of gates without a cost model, they are assumed to be local
+  std::map<std::string, std::size_t> unmodeled_gates_;
+  // online rounds on the critical path through all gates
+  std::size_t online_rounds_ = 0;
+  // ids of the communicating gates on the critical path, from the inputs to the outputs
+  std::vector<std::size_t> critical_path_;
+
+  std::size_t get_setup_bytes() const noexcept;
+  std::size_t get_online_bytes() const noexcept;
+  std::string print_human_readable() const;
+};
+
+// Analyze the gates of a built circuit.  The dependencies are taken from the wires reported by
+// the gates, see NewGate::collect_input_wires().
+CircuitAnalysis analyze_circuit(const GateRegister&);
+
+// Analyze a Boolean circuit which is evaluated with `num_simd` values in the given protocol, i.e.,
+// BooleanGMW, BooleanBEAVY or Yao with half gates from the garbler's side, without the costs of
+// its input and output gates.
+CircuitAnalysis analyze_circuit(const ENCRYPTO::AlgorithmDescription&, MPCProtocol,
+                                std::size_t num_simd = 1);
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,112 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gate_profiler.h"
+
+#include <stdexcept>
+
+namespace MOTION {
+namespace Statistics {
+
+GateProfiler::GateProfiler(std::size_t gate_id_range_width)
+    : counters_(std::make_unique<Counters[]>(1)) {
+  set_gate_id_range_width(gate_id_range_width);
+}
+
+GateProfiler::~GateProfiler() = default;
+
+void GateProfiler::set_gate_id_range_width(std::size_t width) {
+  if (width == 0) {
+    throw std::invalid_argument("GateProfiler: the gate id range width must be positive");
+  }
+  gate_id_range_width_ = width;
+}
+
+void GateProfiler::start(const std::vector<std::pair<std::size_t, std::string>>& gates) {
+  gates_ = gates;
+  gate_indices_.clear();
+  gate_indices_.reserve(gates_.size());
+  for (std::size_t i = 0; i < gates_.size(); ++i) {
+    gate_indices_.emplace(gates_[i].first, i);
+  }
+  counters_ = std::make_unique<Counters[]>(gates_.size() + 1);
+}
+
+GateProfiler::Counters& GateProfiler::get_counters(std::size_t gate_id) noexcept {
+  auto it = gate_indices_.find(gate_id);
+  if (it == gate_indices_.end()) {
+    return counters_[gates_.size()];
+  }
+  return counters_[it->second];
+}
+
+void GateProfiler::record_time(Phase phase, std::size_t gate_id,
+                               clock_type::duration duration) noexcept {
+  auto ns = static_cast<std::size_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  auto& counters = get_counters(gate_id);
+  if (phase == Phase::setup) {
+    counters.setup_time_ns_.fetch_add(ns, std::memory_order_relaxed);
+  } else {
+    counters.online_time_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+}
+
+void GateProfiler::record_sent(std::size_t gate_id, std::size_t num_bytes,
+                               std::size_t num_recipients) noexcept {
+  auto& counters = get_counters(gate_id);
+  counters.num_bytes_sent_.fetch_add(num_bytes * num_recipients, std::memory_order_relaxed);
+  counters.num_messages_sent_.fetch_add(num_recipients, std::memory_order_relaxed);
+}
+
+void GateProfiler::record_received(std::size_t gate_id, std::size_t num_bytes) noexcept {
+  auto& counters = get_counters(gate_id);
+  counters.num_bytes_received_.fetch_add(num_bytes, std::memory_order_relaxed);
+  counters.num_messages_received_.fetch_add(1, std::memory_order_relaxed);
+}
+
+GateProfile GateProfiler::get_profile() const {
+  const auto to_entry = [](const Counters& counters) {
+    GateProfileEntry entry;
+    entry.setup_time_ms_ = static_cast<double>(counters.setup_time_ns_.load()) / 1e6;
+    entry.online_time_ms_ = static_cast<double>(counters.online_time_ns_.load()) / 1e6;
+    entry.num_bytes_sent_ = counters.num_bytes_sent_.load();
+    entry.num_messages_sent_ = counters.num_messages_sent_.load();
+    entry.num_bytes_received_ = counters.num_bytes_received_.load();
+    entry.num_messages_received_ = counters.num_messages_received_.load();
+    return entry;
+  };
+  GateProfile profile;
+  profile.gate_id_range_width_ = gate_id_range_width_;
+  for (std::size_t i = 0; i < gates_.size(); ++i) {
+    auto entry = to_entry(counters_[i]);
+    entry.num_gates_ = 1;
+    const auto& [gate_id, type] = gates_[i];
+    profile.by_type_[type] += entry;
+    profile.by_gate_id_range_[gate_id - gate_id % gate_id_range_width_] += entry;
+  }
+  profile.unknown_gates_ = to_entry(counters_[gates_.size()]);
+  return profile;
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
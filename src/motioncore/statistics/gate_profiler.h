@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "run_time_stats.h"
+
+namespace MOTION {
+namespace Statistics {
+
+// Collects the wall time of the setup and the online phase and the messages sent and received of
+// each gate of a circuit, and aggregates them per gate type and per range of gate ids.  The hooks
+// in the NewGateExecutor and the CommMixin are only compiled if MOTION_GATE_PROFILING is enabled.
+//
+// start() has to be called before the evaluation of the circuit, the record functions can then be
+// called concurrently from all threads.
+class GateProfiler {
+ public:
+  using clock_type = std::chrono::steady_clock;
+  enum class Phase { setup, online };
+
+  explicit GateProfiler(std::size_t gate_id_range_width = 1000);
+  ~GateProfiler();
+
+  // the gate ids are grouped into the ranges [k * width, (k + 1) * width) (set before start())
+  void set_gate_id_range_width(std::size_t width);
+  std::size_t get_gate_id_range_width() const noexcept { return gate_id_range_width_; }
+
+  // forget the records of the last circuit and profile the given (gate id, gate type) pairs
+  void start(const std::vector<std::pair<std::size_t, std::string>>& gates);
+
+  void record_time(Phase phase, std::size_t gate_id, clock_type::duration duration) noexcept;
+  // message of the gate to num_recipients parties
+  void record_sent(std::size_t gate_id, std::size_t num_bytes,
+                   std::size_t num_recipients = 1) noexcept;
+  void record_received(std::size_t gate_id, std::size_t num_bytes) noexcept;
+
+  // aggregate the records since the last call of start()
+  GateProfile get_profile() const;
+
+ private:
+  struct Counters {
+    std::atomic<std::size_t> setup_time_ns_{0};
+    std::atomic<std::size_t> online_time_ns_{0};
+    std::atomic<std::size_t> num_bytes_sent_{0};
+    std::atomic<std::size_t> num_messages_sent_{0};
+    std::atomic<std::size_t> num_bytes_received_{0};
+    std::atomic<std::size_t> num_messages_received_{0};
+  };
+  // counters of the gate, or of the unknown gates if it is not profiled
+  Counters& get_counters(std::size_t gate_id) noexcept;
+
+  std::size_t gate_id_range_width_;
+  // not modified during the evaluation
+  std::vector<std::pair<std::size_t, std::string>> gates_;
+  std::unordered_map<std::size_t, std::size_t> gate_indices_;
+  // one for each of gates_ and the last one for the unknown gates
+  std::unique_ptr<Counters[]> counters_;
+};
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "hardware_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+
+#include "utility/constants.h"
+
+namespace MOTION {
+namespace Statistics {
+
+namespace {
+
+constexpr std::array<std::uint64_t, 6> counter_configs = {
+    PERF_COUNT_HW_CPU_CYCLES,          PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_REFERENCES,    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES};
+
+int open_counter(std::uint64_t config) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  // count the threads started later, which rules out reading the counters as a group
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+std::uint64_t read_counter(int fd) {
+  if (fd == -1) {
+    return 0;
+  }
+  struct {
+    std::uint64_t value;
+    std::uint64_t time_enabled;
+    std::uint64_t time_running;
+  } data;
+  if (::read(fd, &data, sizeof(data)) != sizeof(data) || data.time_running == 0) {
+    return 0;
+  }
+  if (data.time_running == data.time_enabled) {
+    return data.value;
+  }
+  return static_cast<std::uint64_t>(static_cast<double>(data.value) *
+                                    static_cast<double>(data.time_enabled) /
+                                    static_cast<double>(data.time_running));
+}
+
+// open the counters before main() starts any thread
+[[maybe_unused]] const bool counters_opened = [] {
+  if constexpr (MOTION_HARDWARE_COUNTERS) {
+    return HardwareCounters::get_instance().is_available();
+  }
+  return false;
+}();
+
+}  // namespace
+
+HardwareCounters& HardwareCounters::get_instance() {
+  static HardwareCounters instance;
+  return instance;
+}
+
+HardwareCounters::HardwareCounters() {
+  for (std::size_t i = 0; i < num_counters; ++i) {
+    fds_[i] = open_counter(counter_configs[i]);
+  }
+}
+
+HardwareCounters::~HardwareCounters() {
+  for (auto fd : fds_) {
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+}
+
+bool HardwareCounters::is_available() const noexcept {
+  for (auto fd : fds_) {
+    if (fd != -1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+HardwareCounterStats HardwareCounters::read() const {
+  HardwareCounterStats stats;
+  stats.cycles_ = read_counter(fds_[0]);
+  stats.instructions_ = read_counter(fds_[1]);
+  stats.cache_references_ = read_counter(fds_[2]);
+  stats.cache_misses_ = read_counter(fds_[3]);
+  stats.branch_instructions_ = read_counter(fds_[4]);
+  stats.branch_misses_ = read_counter(fds_[5]);
+  return stats;
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
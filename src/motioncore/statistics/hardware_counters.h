@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "run_time_stats.h"
+
+namespace MOTION {
+namespace Statistics {
+
+// Hardware performance counters of the whole process, read with perf_event_open.  The counters
+// are inherited by the threads which are started after they have been opened, so they are
+// opened during the static initialization of the library if MOTION_HARDWARE_COUNTERS is enabled,
+// i.e., before the communication layer and the backend start their threads.  If the kernel does
+// not permit them (see /proc/sys/kernel/perf_event_paranoid) or the CPU does not provide a
+// counter, it stays 0.  Counters which the kernel had to multiplex are scaled to the full time.
+class HardwareCounters {
+ public:
+  static HardwareCounters& get_instance();
+
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  // true if at least one counter could be opened
+  bool is_available() const noexcept;
+
+  // values since the counters have been opened, only user space events are counted
+  HardwareCounterStats read() const;
+
+ private:
+  HardwareCounters();
+
+  static constexpr std::size_t num_counters = 6;
+  // file descriptors in the order of the members of HardwareCounterStats, -1 if not available
+  std::array<int, num_counters> fds_;
+};
+
+}  // namespace Statistics
+}  // namespace MOTION
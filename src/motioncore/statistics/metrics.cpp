@@ -0,0 +1,292 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <fmt/format.h>
+
+#include "run_time_stats.h"
+#include "utility/thread.h"
+
+namespace MOTION {
+namespace Statistics {
+
+namespace {
+
+void atomic_add(std::atomic<double>& value, double delta) noexcept {
+  auto old_value = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(old_value, old_value + delta, std::memory_order_relaxed)) {
+  }
+}
+
+std::string escape_label_value(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (auto c : value) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '"') {
+      escaped += "\\\"";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// {a="x",b="y"} with an optional extra label, e.g., the le label of the histogram buckets
+std::string format_labels(const MetricLabels& labels, const std::string& extra_name = {},
+                          const std::string& extra_value = {}) {
+  if (labels.empty() && extra_name.empty()) {
+    return {};
+  }
+  std::string result = "{";
+  for (const auto& [name, value] : labels) {
+    if (result.size() > 1) {
+      result += ',';
+    }
+    result += fmt::format("{}=\"{}\"", name, escape_label_value(value));
+  }
+  if (!extra_name.empty()) {
+    if (result.size() > 1) {
+      result += ',';
+    }
+    result += fmt::format("{}=\"{}\"", extra_name, extra_value);
+  }
+  result += '}';
+  return result;
+}
+
+}  // namespace
+
+void Gauge::add(double delta) noexcept { atomic_add(value_, delta); }
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      bucket_counts_(std::make_unique<std::atomic<std::uint64_t>[]>(bounds_.size() + 1)) {
+  if (!std::is_sorted(bounds_.begin(), bounds_.end())) {
+    throw std::invalid_argument("Histogram: the bounds need to be in ascending order");
+  }
+  for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+    bucket_counts_[i] = 0;
+  }
+}
+
+void Histogram::observe(double value) noexcept {
+  const auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+  bucket_counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  atomic_add(sum_, value);
+}
+
+std::vector<std::uint64_t> Histogram::get_bucket_counts() const {
+  std::vector<std::uint64_t> counts(bounds_.size() + 1);
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = bucket_counts_[i].load(std::memory_order_relaxed);
+  }
+  return counts;
+}
+
+const std::vector<double> MetricsRegistry::default_time_bounds = {
+    0.0001, 0.001, 0.01, 0.1, 0.5, 1, 5, 10, 60, 300};
+
+MetricsRegistry& MetricsRegistry::get_instance() {
+  static MetricsRegistry instance;
+  return instance;
+}
+
+MetricsRegistry::Family& MetricsRegistry::get_family(const std::string& name,
+                                                     const std::string& help, MetricType type) {
+  auto [it, inserted] = families_.try_emplace(name);
+  auto& family = it->second;
+  if (inserted) {
+    family.type_ = type;
+    family.help_ = help;
+  } else if (family.type_ != type) {
+    throw std::logic_error(
+        fmt::format("MetricsRegistry: metric {} already exists with another type", name));
+  }
+  return family;
+}
+
+Counter& MetricsRegistry::get_counter(const std::string& name, const std::string& help,
+                                      const MetricLabels& labels) {
+  std::scoped_lock lock(mutex_);
+  auto& metric = get_family(name, help, MetricType::counter).counters_[labels];
+  if (metric == nullptr) {
+    metric = std::make_unique<Counter>();
+  }
+  return *metric;
+}
+
+Gauge& MetricsRegistry::get_gauge(const std::string& name, const std::string& help,
+                                  const MetricLabels& labels) {
+  std::scoped_lock lock(mutex_);
+  auto& metric = get_family(name, help, MetricType::gauge).gauges_[labels];
+  if (metric == nullptr) {
+    metric = std::make_unique<Gauge>();
+  }
+  return *metric;
+}
+
+Histogram& MetricsRegistry::get_histogram(const std::string& name, const std::string& help,
+                                          const std::vector<double>& bounds,
+                                          const MetricLabels& labels) {
+  std::scoped_lock lock(mutex_);
+  auto& metric = get_family(name, help, MetricType::histogram).histograms_[labels];
+  if (metric == nullptr) {
+    metric = std::make_unique<Histogram>(bounds);
+  }
+  return *metric;
+}
+
+void MetricsRegistry::write_prometheus_text(std::ostream& stream) const {
+  std::scoped_lock lock(mutex_);
+  for (const auto& [name, family] : families_) {
+    stream << fmt::format("# HELP {} {}\n", name, family.help_);
+    switch (family.type_) {
+      case MetricType::counter:
+        stream << fmt::format("# TYPE {} counter\n", name);
+        for (const auto& [labels, counter] : family.counters_) {
+          stream << fmt::format("{}{} {}\n", name, format_labels(labels), counter->get());
+        }
+        break;
+      case MetricType::gauge:
+        stream << fmt::format("# TYPE {} gauge\n", name);
+        for (const auto& [labels, gauge] : family.gauges_) {
+          stream << fmt::format("{}{} {}\n", name, format_labels(labels), gauge->get());
+        }
+        break;
+      case MetricType::histogram:
+        stream << fmt::format("# TYPE {} histogram\n", name);
+        for (const auto& [labels, histogram] : family.histograms_) {
+          const auto& bounds = histogram->get_bounds();
+          const auto counts = histogram->get_bucket_counts();
+          // the buckets are cumulative in the exposition format
+          std::uint64_t cumulative_count = 0;
+          for (std::size_t i = 0; i < counts.size(); ++i) {
+            cumulative_count += counts[i];
+            const auto le = i < bounds.size() ? fmt::format("{}", bounds[i]) : "+Inf";
+            stream << fmt::format("{}_bucket{} {}\n", name, format_labels(labels, "le", le),
+                                  cumulative_count);
+          }
+          stream << fmt::format("{}_sum{} {}\n", name, format_labels(labels),
+                                histogram->get_sum());
+          stream << fmt::format("{}_count{} {}\n", name, format_labels(labels),
+                                cumulative_count);
+        }
+        break;
+    }
+  }
+}
+
+std::string MetricsRegistry::to_prometheus_text() const {
+  std::stringstream stream;
+  write_prometheus_text(stream);
+  return stream.str();
+}
+
+void PrometheusTextFileExporter::export_metrics(const MetricsRegistry& registry) {
+  const auto tmp_path = path_ + ".tmp";
+  {
+    std::ofstream stream(tmp_path);
+    if (!stream) {
+      throw std::runtime_error(
+          fmt::format("PrometheusTextFileExporter: could not open {} for writing", tmp_path));
+    }
+    registry.write_prometheus_text(stream);
+  }
+  std::filesystem::rename(tmp_path, path_);
+}
+
+PeriodicMetricsExport::PeriodicMetricsExport(std::shared_ptr<MetricsExporter> exporter,
+                                             std::chrono::milliseconds interval,
+                                             MetricsRegistry& registry)
+    : exporter_(std::move(exporter)), interval_(interval), registry_(registry) {
+  thread_ = std::thread([this] { run(); });
+  ENCRYPTO::thread_set_name(thread_, "metrics-export");
+}
+
+PeriodicMetricsExport::~PeriodicMetricsExport() {
+  {
+    std::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void PeriodicMetricsExport::run() {
+  std::unique_lock lock(mutex_);
+  bool stop = false;
+  while (!stop) {
+    stop = cv_.wait_for(lock, interval_, [this] { return stop_; });
+    lock.unlock();
+    try {
+      exporter_->export_metrics(registry_);
+    } catch (std::exception&) {
+      // e.g., the directory of the file is not available right now, try again next time
+    }
+    lock.lock();
+  }
+}
+
+void record_evaluation_metrics(const RunTimeStats& stats, std::size_t num_gates_setup,
+                               std::size_t num_gates_online) {
+  using StatID = RunTimeStats::StatID;
+  auto& registry = MetricsRegistry::get_instance();
+  const std::array<std::tuple<StatID, const char*, std::size_t>, 3> phases = {
+      {{StatID::gates_setup, "setup", num_gates_setup},
+       {StatID::gates_online, "online", num_gates_online},
+       {StatID::evaluate, "evaluate", 0}}};
+  for (const auto& [id, phase, num_gates] : phases) {
+    const auto& [start, end] = stats.get(id);
+    if (end <= start) {
+      // phase not part of this evaluation
+      continue;
+    }
+    if (num_gates > 0) {
+      registry
+          .get_counter("motion_gates_evaluated_total", "Gates whose phase has been evaluated",
+                       {{"phase", phase}})
+          .increment(num_gates);
+    }
+    registry
+        .get_histogram("motion_evaluation_phase_seconds", "Duration of the phases of evaluations",
+                       MetricsRegistry::default_time_bounds, {{"phase", phase}})
+        .observe(std::chrono::duration<double>(end - start).count());
+  }
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MOTION {
+namespace Statistics {
+
+// label name -> value of a metric, e.g., {{"party_id", "1"}}
+using MetricLabels = std::map<std::string, std::string>;
+
+// Monotonically increasing number, e.g., of the bytes sent.
+class Counter {
+ public:
+  void increment(std::uint64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+  std::uint64_t get() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<std::uint64_t> value_{0};
+};
+
+// Value which goes up and down, e.g., the depth of a queue.
+class Gauge {
+ public:
+  void set(double value) noexcept { value_.store(value, std::memory_order_relaxed); }
+  void add(double delta) noexcept;
+  double get() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0};
+};
+
+// Distribution of observed values in buckets with the given upper bounds.
+class Histogram {
+ public:
+  // upper bounds in ascending order, an implicit +Inf bucket is added
+  explicit Histogram(std::vector<double> bounds);
+
+  void observe(double value) noexcept;
+
+  const std::vector<double>& get_bounds() const noexcept { return bounds_; }
+  // number of observations in each bucket (not cumulative), the last one is the +Inf bucket
+  std::vector<std::uint64_t> get_bucket_counts() const;
+  std::uint64_t get_count() const noexcept { return count_.load(std::memory_order_relaxed); }
+  double get_sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> bucket_counts_;
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<double> sum_{0};
+};
+
+// Process wide registry of the metrics of the CommunicationLayers, OTProviderManagers, gate
+// executors and MTReservoirs, which can be read while they are running, e.g., by a
+// PeriodicMetricsExport in a long-lived service.  In contrast to the RunTimeStats, the metrics
+// are never reset.
+//
+// The metrics are created on first use and live as long as the process, so the hot paths keep
+// the returned references, and updating a metric is a relaxed atomic operation.  Requesting an
+// existing metric with a different type throws std::logic_error.
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& get_instance();
+
+  Counter& get_counter(const std::string& name, const std::string& help,
+                       const MetricLabels& labels = {});
+  Gauge& get_gauge(const std::string& name, const std::string& help,
+                   const MetricLabels& labels = {});
+  // the bounds are only used when the histogram is created
+  Histogram& get_histogram(const std::string& name, const std::string& help,
+                           const std::vector<double>& bounds, const MetricLabels& labels = {});
+
+  // all metrics in the Prometheus text exposition format
+  void write_prometheus_text(std::ostream&) const;
+  std::string to_prometheus_text() const;
+
+  // default bounds of the histograms of durations in seconds
+  static const std::vector<double> default_time_bounds;
+
+ private:
+  enum class MetricType { counter, gauge, histogram };
+  struct Family {
+    MetricType type_;
+    std::string help_;
+    std::map<MetricLabels, std::unique_ptr<Counter>> counters_;
+    std::map<MetricLabels, std::unique_ptr<Gauge>> gauges_;
+    std::map<MetricLabels, std::unique_ptr<Histogram>> histograms_;
+  };
+  Family& get_family(const std::string& name, const std::string& help, MetricType);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+};
+
+// Destination of the metrics, e.g., a file read by the textfile collector of the Prometheus node
+// exporter.  Other exporters, e.g., an HTTP endpoint of the service, can be plugged in by
+// implementing this interface.
+class MetricsExporter {
+ public:
+  virtual ~MetricsExporter() = default;
+  virtual void export_metrics(const MetricsRegistry&) = 0;
+};
+
+// Writes the metrics in the Prometheus text format to a file, which is replaced atomically such
+// that readers never see a partial file.
+class PrometheusTextFileExporter : public MetricsExporter {
+ public:
+  explicit PrometheusTextFileExporter(std::string path) : path_(std::move(path)) {}
+  void export_metrics(const MetricsRegistry&) override;
+
+ private:
+  std::string path_;
+};
+
+// Calls the exporter with the registry in regular intervals from a background thread, and once
+// more when it is destroyed.
+class PeriodicMetricsExport {
+ public:
+  PeriodicMetricsExport(std::shared_ptr<MetricsExporter> exporter,
+                        std::chrono::milliseconds interval,
+                        MetricsRegistry& registry = MetricsRegistry::get_instance());
+  ~PeriodicMetricsExport();
+  PeriodicMetricsExport(const PeriodicMetricsExport&) = delete;
+  PeriodicMetricsExport& operator=(const PeriodicMetricsExport&) = delete;
+
+ private:
+  void run();
+
+  std::shared_ptr<MetricsExporter> exporter_;
+  std::chrono::milliseconds interval_;
+  MetricsRegistry& registry_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+struct RunTimeStats;
+
+// count the gates and observe the durations of the phases recorded in the stats of an evaluation,
+// called by the gate executors
+void record_evaluation_metrics(const RunTimeStats&, std::size_t num_gates_setup,
+                               std::size_t num_gates_online);
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,283 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "performance_baseline.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+#include <boost/json.hpp>
+
+namespace MOTION {
+namespace Statistics {
+
+namespace json = boost::json;
+
+// increased on incompatible changes of the file format
+constexpr std::int64_t baseline_version = 1;
+
+MetricKind get_metric_kind(std::string_view name) {
+  if (name.ends_with("_ms")) {
+    return MetricKind::time;
+  }
+  if (name.ends_with("rounds")) {
+    return MetricKind::rounds;
+  }
+  if (name.ends_with("bytes_sent") || name.ends_with("messages_sent")) {
+    return MetricKind::communication;
+  }
+  if (name.ends_with("_bytes")) {
+    return MetricKind::memory;
+  }
+  throw std::invalid_argument(fmt::format("unknown kind of metric {}", name));
+}
+
+double RegressionTolerances::get_relative(MetricKind kind) const noexcept {
+  switch (kind) {
+    case MetricKind::time:
+      return time_;
+    case MetricKind::communication:
+      return communication_;
+    case MetricKind::rounds:
+      return rounds_;
+    case MetricKind::memory:
+      return memory_;
+  }
+  return 0.0;
+}
+
+double RegressionTolerances::get_slack(MetricKind kind) const noexcept {
+  switch (kind) {
+    case MetricKind::time:
+      return time_slack_ms_;
+    case MetricKind::memory:
+      return memory_slack_bytes_;
+    default:
+      return 0.0;
+  }
+}
+
+static double to_double(const json::value& value, std::string_view key) {
+  if (!value.is_number()) {
+    throw std::invalid_argument(fmt::format("PerformanceBaseline: {} is not a number", key));
+  }
+  return value.to_number<double>();
+}
+
+static double get_number(const json::object& obj, std::string_view key, double default_value) {
+  const auto* value = obj.if_contains(key);
+  return value != nullptr ? to_double(*value, key) : default_value;
+}
+
+PerformanceBaseline PerformanceBaseline::load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error(fmt::format("PerformanceBaseline: could not open {}", path));
+  }
+  const std::string content(std::istreambuf_iterator<char>(file), {});
+  json::error_code ec;
+  const auto value = json::parse(content, ec);
+  if (ec || !value.is_object()) {
+    throw std::runtime_error(fmt::format("PerformanceBaseline: could not parse {}", path));
+  }
+  return from_json(value.get_object());
+}
+
+PerformanceBaseline PerformanceBaseline::from_json(const json::object& obj) {
+  if (const auto* version = obj.if_contains("version");
+      version == nullptr || !version->is_int64() || version->get_int64() != baseline_version) {
+    throw std::invalid_argument(
+        fmt::format("PerformanceBaseline: expected version {}", baseline_version));
+  }
+  PerformanceBaseline baseline;
+  if (const auto* tolerances = obj.if_contains("tolerances"); tolerances != nullptr) {
+    if (!tolerances->is_object()) {
+      throw std::invalid_argument("PerformanceBaseline: tolerances is not an object");
+    }
+    const auto& t = tolerances->get_object();
+    auto& result = baseline.tolerances_;
+    result.time_ = get_number(t, "time", result.time_);
+    result.communication_ = get_number(t, "communication", result.communication_);
+    result.rounds_ = get_number(t, "rounds", result.rounds_);
+    result.memory_ = get_number(t, "memory", result.memory_);
+    result.time_slack_ms_ = get_number(t, "time_slack_ms", result.time_slack_ms_);
+    result.memory_slack_bytes_ = get_number(t, "memory_slack_bytes", result.memory_slack_bytes_);
+  }
+  const auto* cases = obj.if_contains("cases");
+  if (cases == nullptr || !cases->is_object()) {
+    throw std::invalid_argument("PerformanceBaseline: cases is missing");
+  }
+  for (const auto& [name, metrics] : cases->get_object()) {
+    if (!metrics.is_object()) {
+      throw std::invalid_argument(
+          fmt::format("PerformanceBaseline: case {} is not an object", std::string_view(name)));
+    }
+    auto& result = baseline.cases_[std::string(name)];
+    for (const auto& [metric, value] : metrics.get_object()) {
+      result[std::string(metric)] = to_double(value, metric);
+    }
+  }
+  return baseline;
+}
+
+void PerformanceBaseline::save(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error(fmt::format("PerformanceBaseline: could not open {}", path));
+  }
+  file << json::serialize(to_json()) << '\n';
+}
+
+json::object PerformanceBaseline::to_json() const {
+  json::object tolerances;
+  tolerances["time"] = tolerances_.time_;
+  tolerances["communication"] = tolerances_.communication_;
+  tolerances["rounds"] = tolerances_.rounds_;
+  tolerances["memory"] = tolerances_.memory_;
+  tolerances["time_slack_ms"] = tolerances_.time_slack_ms_;
+  tolerances["memory_slack_bytes"] = tolerances_.memory_slack_bytes_;
+  json::object cases;
+  for (const auto& [name, metrics] : cases_) {
+    json::object obj;
+    for (const auto& [metric, value] : metrics) {
+      obj[metric] = value;
+    }
+    cases[name] = std::move(obj);
+  }
+  json::object obj;
+  obj["version"] = baseline_version;
+  obj["tolerances"] = std::move(tolerances);
+  obj["cases"] = std::move(cases);
+  return obj;
+}
+
+void PerformanceBaseline::set_case(const std::string& name, PerformanceMetrics metrics) {
+  cases_[name] = std::move(metrics);
+}
+
+std::vector<MetricComparison> PerformanceBaseline::compare(
+    const std::string& name, const PerformanceMetrics& measured) const {
+  const auto it = cases_.find(name);
+  if (it == std::end(cases_)) {
+    throw std::invalid_argument(fmt::format("PerformanceBaseline: no case {}", name));
+  }
+  const auto& baseline = it->second;
+  std::vector<MetricComparison> result;
+  for (const auto& [metric, value] : measured) {
+    MetricComparison comparison{metric, 0.0, value, MetricComparison::Status::added};
+    if (const auto b = baseline.find(metric); b != std::end(baseline)) {
+      const auto kind = get_metric_kind(metric);
+      const auto relative = tolerances_.get_relative(kind);
+      const auto slack = tolerances_.get_slack(kind);
+      comparison.baseline_ = b->second;
+      if (value > b->second * (1 + relative) + slack) {
+        comparison.status_ = MetricComparison::Status::regression;
+      } else if (value * (1 + relative) + slack < b->second) {
+        comparison.status_ = MetricComparison::Status::improvement;
+      } else {
+        comparison.status_ = MetricComparison::Status::ok;
+      }
+    }
+    result.push_back(std::move(comparison));
+  }
+  for (const auto& [metric, value] : baseline) {
+    if (!measured.contains(metric)) {
+      result.push_back({metric, value, 0.0, MetricComparison::Status::missing});
+    }
+  }
+  return result;
+}
+
+bool has_regression(const std::vector<MetricComparison>& comparisons) {
+  for (const auto& comparison : comparisons) {
+    if (comparison.status_ == MetricComparison::Status::regression) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static std::string_view to_string(MetricComparison::Status status) {
+  switch (status) {
+    case MetricComparison::Status::ok:
+      return "ok";
+    case MetricComparison::Status::regression:
+      return "REGRESSION";
+    case MetricComparison::Status::improvement:
+      return "improvement";
+    case MetricComparison::Status::added:
+      return "not in baseline";
+    case MetricComparison::Status::missing:
+      return "not measured";
+  }
+  return "unknown";
+}
+
+static std::string format_comparison(std::string_view metric, const MetricComparison& c) {
+  const auto change =
+      c.baseline_ != 0 ? fmt::format("{:+.1f}%", 100 * (c.measured_ / c.baseline_ - 1)) : "";
+  return fmt::format("  {:<40} {:>14.3f} -> {:>14.3f} {:>8}  {}\n", metric, c.baseline_,
+                     c.measured_, change, to_string(c.status_));
+}
+
+std::string print_comparison(const std::string& name,
+                             const std::vector<MetricComparison>& comparisons) {
+  std::stringstream ss;
+  std::size_t num_regressions = 0;
+  // gate type -> comparisons of its metrics, which are not ok
+  std::map<std::string, std::vector<const MetricComparison*>> by_gate_type;
+  std::stringstream phases;
+  for (const auto& comparison : comparisons) {
+    if (comparison.status_ == MetricComparison::Status::regression) {
+      ++num_regressions;
+    }
+    if (comparison.status_ == MetricComparison::Status::ok) {
+      continue;
+    }
+    const std::string_view metric = comparison.metric_;
+    if (metric.starts_with("gate.")) {
+      const auto pos = metric.rfind('.');
+      by_gate_type[std::string(metric.substr(5, pos - 5))].push_back(&comparison);
+    } else {
+      phases << format_comparison(metric, comparison);
+    }
+  }
+  ss << fmt::format("{}: {}\n", name,
+                    num_regressions ? fmt::format("{} regressions", num_regressions) : "ok");
+  ss << phases.str();
+  for (const auto& [gate_type, gate_comparisons] : by_gate_type) {
+    ss << fmt::format("  {}\n", gate_type);
+    for (const auto* comparison : gate_comparisons) {
+      const std::string_view metric = comparison->metric_;
+      ss << format_comparison(fmt::format("  {}", metric.substr(metric.rfind('.') + 1)),
+                              *comparison);
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
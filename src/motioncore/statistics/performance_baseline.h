@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace boost::json {
+class object;
+}  // namespace boost::json
+
+namespace MOTION {
+namespace Statistics {
+
+// Measurements of one benchmark case, metric name -> value, e.g., "gates_online.time_ms".  The
+// metrics of a gate type are named "gate.<type>.<metric>".
+using PerformanceMetrics = std::map<std::string, double>;
+
+// The kind of a metric determines its tolerance, it is derived from the suffix of the name:
+// "_ms" are times, "rounds" are online rounds, "bytes_sent" and "messages_sent" are
+// communication and any other "_bytes" are memory.
+enum class MetricKind { time, communication, rounds, memory };
+MetricKind get_metric_kind(std::string_view name);
+
+// A measured value is a regression if it exceeds baseline * (1 + relative) + slack.  The slack
+// keeps the times and memory of small cases from failing on noise.
+struct RegressionTolerances {
+  double time_ = 0.5;
+  double communication_ = 0.01;
+  double rounds_ = 0.0;
+  double memory_ = 0.5;
+  double time_slack_ms_ = 2.0;
+  double memory_slack_bytes_ = 4 << 20;
+
+  double get_relative(MetricKind) const noexcept;
+  double get_slack(MetricKind) const noexcept;
+};
+
+struct MetricComparison {
+  enum class Status {
+    ok,
+    regression,
+    // better than the baseline by more than the tolerance, the baseline should be updated
+    improvement,
+    // not in the baseline
+    added,
+    // in the baseline, but not measured
+    missing
+  };
+
+  std::string metric_;
+  double baseline_ = 0.0;
+  double measured_ = 0.0;
+  Status status_ = Status::ok;
+};
+
+// Golden values of the metrics of a benchmark suite, stored as JSON:
+//   {"version": 1, "tolerances": {"time": 0.5, ...}, "cases": {"<case>": {"<metric>": value}}}
+class PerformanceBaseline {
+ public:
+  static PerformanceBaseline load(const std::string& path);
+  static PerformanceBaseline from_json(const boost::json::object&);
+  void save(const std::string& path) const;
+  boost::json::object to_json() const;
+
+  bool has_case(const std::string& name) const { return cases_.contains(name); }
+  void set_case(const std::string& name, PerformanceMetrics metrics);
+  // compare the measured metrics of a case with the baseline, throws std::invalid_argument if
+  // the case is not in the baseline
+  std::vector<MetricComparison> compare(const std::string& name,
+                                        const PerformanceMetrics& measured) const;
+
+  RegressionTolerances tolerances_;
+  std::map<std::string, PerformanceMetrics> cases_;
+};
+
+bool has_regression(const std::vector<MetricComparison>&);
+// the regressions and improvements of a case, the ones of the gate profile grouped by gate type
+std::string print_comparison(const std::string& name, const std::vector<MetricComparison>&);
+
+}  // namespace Statistics
+}  // namespace MOTION
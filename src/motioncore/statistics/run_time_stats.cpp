@@ -21,9 +21,14 @@
 // SOFTWARE.
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <cmath>
 #include <sstream>
+#include "hardware_counters.h"
 #include "run_time_stats.h"
+#include "utility/memory_tracker.h"
+#include "utility/runtime_info.h"
+#include "utility/thread.h"
 
 namespace MOTION {
 namespace Statistics {
@@ -33,10 +38,109 @@ static double compute_ms(const RunTimeStats::time_point_pair& tpp) {
   return ms.count();
 }
 
+GateProfileEntry& GateProfileEntry::operator+=(const GateProfileEntry& other) {
+  num_gates_ += other.num_gates_;
+  setup_time_ms_ += other.setup_time_ms_;
+  online_time_ms_ += other.online_time_ms_;
+  num_bytes_sent_ += other.num_bytes_sent_;
+  num_messages_sent_ += other.num_messages_sent_;
+  num_bytes_received_ += other.num_bytes_received_;
+  num_messages_received_ += other.num_messages_received_;
+  return *this;
+}
+
+HardwareCounterStats HardwareCounterStats::operator-(
+    const HardwareCounterStats& other) const noexcept {
+  return {cycles_ - other.cycles_,
+          instructions_ - other.instructions_,
+          cache_references_ - other.cache_references_,
+          cache_misses_ - other.cache_misses_,
+          branch_instructions_ - other.branch_instructions_,
+          branch_misses_ - other.branch_misses_};
+}
+
+double HardwareCounterStats::get_ipc() const noexcept {
+  return cycles_ > 0 ? static_cast<double>(instructions_) / cycles_ : 0.0;
+}
+
+double HardwareCounterStats::get_cache_miss_rate() const noexcept {
+  return cache_references_ > 0 ? static_cast<double>(cache_misses_) / cache_references_ : 0.0;
+}
+
+double HardwareCounterStats::get_branch_miss_rate() const noexcept {
+  return branch_instructions_ > 0 ? static_cast<double>(branch_misses_) / branch_instructions_
+                                  : 0.0;
+}
+
+bool GateProfile::empty() const noexcept {
+  return by_type_.empty() && unknown_gates_.num_messages_sent_ == 0 &&
+         unknown_gates_.num_messages_received_ == 0;
+}
+
+GateProfile& GateProfile::operator+=(const GateProfile& other) {
+  for (const auto& [type, entry] : other.by_type_) {
+    by_type_[type] += entry;
+  }
+  for (const auto& [first_id, entry] : other.by_gate_id_range_) {
+    by_gate_id_range_[first_id] += entry;
+  }
+  gate_id_range_width_ = other.gate_id_range_width_;
+  unknown_gates_ += other.unknown_gates_;
+  return *this;
+}
+
 const RunTimeStats::time_point_pair& RunTimeStats::get(StatID id) const {
   return data_.at(static_cast<std::size_t>(id));
 }
 
+const PhaseMemoryStats& RunTimeStats::get_memory(StatID id) const {
+  return memory_.at(static_cast<std::size_t>(id));
+}
+
+const PhaseCpuStats& RunTimeStats::get_cpu(StatID id) const {
+  return cpu_.at(static_cast<std::size_t>(id));
+}
+
+const HardwareCounterStats& RunTimeStats::get_counters(StatID id) const {
+  return counters_.at(static_cast<std::size_t>(id));
+}
+
+double RunTimeStats::get_busy_cpus(StatID id) const {
+  const auto wall_ms = compute_ms(get(id));
+  return wall_ms > 0 ? get_cpu(id).cpu_time_ms_ / wall_ms : 0.0;
+}
+
+void RunTimeStats::record_phase_start(StatID id) {
+  auto& tracker = ENCRYPTO::MemoryTracker::get_instance();
+  tracker.reset_peak();
+  memory_start_.at(static_cast<std::size_t>(id)) = {get_peak_memory_usage(),
+                                                    tracker.get_current_bytes()};
+  cpu_start_ms_.at(static_cast<std::size_t>(id)) = get_process_cpu_time_ms();
+}
+
+void RunTimeStats::record_phase_end(StatID id) {
+  const auto& tracker = ENCRYPTO::MemoryTracker::get_instance();
+  const auto [start_rss, start_tracked] = memory_start_.at(static_cast<std::size_t>(id));
+  auto& memory = memory_.at(static_cast<std::size_t>(id));
+  memory.peak_rss_bytes_ = get_peak_memory_usage();
+  memory.peak_rss_growth_bytes_ = memory.peak_rss_bytes_ - start_rss;
+  memory.tracked_peak_bytes_ = tracker.get_peak_bytes();
+  memory.tracked_allocated_bytes_ = static_cast<std::ptrdiff_t>(tracker.get_current_bytes()) -
+                                    static_cast<std::ptrdiff_t>(start_tracked);
+  auto& cpu = cpu_.at(static_cast<std::size_t>(id));
+  cpu.cpu_time_ms_ = get_process_cpu_time_ms() - cpu_start_ms_.at(static_cast<std::size_t>(id));
+  cpu.omp_threads_ = ENCRYPTO::get_phase_omp_threads();
+}
+
+void RunTimeStats::record_counters_start(StatID id) {
+  counters_start_.at(static_cast<std::size_t>(id)) = HardwareCounters::get_instance().read();
+}
+
+void RunTimeStats::record_counters_end(StatID id) {
+  counters_.at(static_cast<std::size_t>(id)) =
+      HardwareCounters::get_instance().read() - counters_start_.at(static_cast<std::size_t>(id));
+}
+
 template <typename C>
 typename C::value_type at(const C& container, RunTimeStats::StatID id) {
   return container.at(static_cast<std::size_t>(id));
@@ -62,7 +166,9 @@ std::string RunTimeStats::print_human_readable() const {
      << fmt::format("Gates Setup         {:{}.3f} ms\n", at(ms, StatID::gates_setup), width)
      << fmt::format("Gates Online        {:{}.3f} ms\n", at(ms, StatID::gates_online), width)
      << fmt::format("-------------------------\n")
-     << fmt::format("Circuit Evaluation  {:{}.3f} ms\n", at(ms, StatID::evaluate), width);
+     << fmt::format("Circuit Evaluation  {:{}.3f} ms\n", at(ms, StatID::evaluate), width)
+     << fmt::format("Time to First Gate  {:{}.3f} ms\n", at(ms, StatID::time_to_first_gate),
+                    width);
   return ss.str();
 }
 
@@ -24,12 +24,93 @@
 
 #include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <string>
 #include <utility>
 
+#include "utility/constants.h"
+
 namespace MOTION {
 namespace Statistics {
 
+// Time and communication of a group of gates, summed over the gates.  The times are the wall
+// times of the evaluate_setup/evaluate_online calls, i.e., they include waiting for messages.
+struct GateProfileEntry {
+  std::size_t num_gates_ = 0;
+  double setup_time_ms_ = 0.0;
+  double online_time_ms_ = 0.0;
+  std::size_t num_bytes_sent_ = 0;
+  std::size_t num_messages_sent_ = 0;
+  std::size_t num_bytes_received_ = 0;
+  std::size_t num_messages_received_ = 0;
+
+  GateProfileEntry& operator+=(const GateProfileEntry& other);
+};
+
+// Result of the GateProfiler for one evaluation, empty if MOTION_GATE_PROFILING is disabled.
+struct GateProfile {
+  // demangled type of the gates -> entry
+  std::map<std::string, GateProfileEntry> by_type_;
+  // first gate id of the range [id, id + gate_id_range_width_) -> entry
+  std::map<std::size_t, GateProfileEntry> by_gate_id_range_;
+  std::size_t gate_id_range_width_ = 0;
+  // messages of gate ids which do not belong to a profiled gate
+  GateProfileEntry unknown_gates_;
+
+  bool empty() const noexcept;
+  GateProfile& operator+=(const GateProfile& other);
+};
+
+// Memory of one phase of a run.  The resident set size is the high-water mark of the process
+// (VmHWM), which cannot be reset, so the growth during the phase is reported separately.  The
+// tracked bytes are the ones held by the BitVectors and are only counted if
+// MOTION_MEMORY_TRACKING is enabled.
+struct PhaseMemoryStats {
+  std::size_t peak_rss_bytes_ = 0;
+  std::size_t peak_rss_growth_bytes_ = 0;
+  // high-water mark during the phase
+  std::size_t tracked_peak_bytes_ = 0;
+  // allocated minus deallocated during the phase
+  std::ptrdiff_t tracked_allocated_bytes_ = 0;
+};
+
+// CPU time of one phase of a run, consumed by all threads of the process, and the OpenMP threads
+// of the providers' data parallel loops during the phase (0 if OpenMP's default was used).  The
+// CPU time divided by the wall time of the phase is the number of CPUs it kept busy on average.
+struct PhaseCpuStats {
+  double cpu_time_ms_ = 0.0;
+  std::size_t omp_threads_ = 0;
+};
+
+// Hardware counters of one phase of a run, summed over the threads of the process, see
+// HardwareCounters (only recorded if MOTION_HARDWARE_COUNTERS is enabled).  The phases of the
+// preprocessing overlap, e.g., the OT extension runs while other providers compute their setup.
+struct HardwareCounterStats {
+  std::uint64_t cycles_ = 0;
+  std::uint64_t instructions_ = 0;
+  // last level cache
+  std::uint64_t cache_references_ = 0;
+  std::uint64_t cache_misses_ = 0;
+  std::uint64_t branch_instructions_ = 0;
+  std::uint64_t branch_misses_ = 0;
+
+  HardwareCounterStats operator-(const HardwareCounterStats& other) const noexcept;
+  // instructions per cycle
+  double get_ipc() const noexcept;
+  double get_cache_miss_rate() const noexcept;
+  double get_branch_miss_rate() const noexcept;
+};
+
+// Stacks of the gate fibers during one evaluation, the maximum over the phases.  Only the stack
+// pools of the pooled_fixedsize allocator reserve memory beyond the stacks in use.
+struct FiberStackMemoryStats {
+  std::size_t peak_bytes_in_use_ = 0;
+  std::size_t bytes_reserved_ = 0;
+  std::size_t num_stacks_allocated_ = 0;
+};
+
 struct RunTimeStats {
   using clock_type = std::chrono::steady_clock;
   using time_point = std::chrono::time_point<clock_type>;
@@ -49,13 +130,39 @@ struct RunTimeStats {
     gates_online,
     evaluate,
     base_ots,
+    // from the creation of the backend until the evaluation of its first circuit starts
+    time_to_first_gate,
     MAX  // maximal value of this Enum, use as size
   };
 
+  // phases whose memory and CPU time is recorded, they run one after another
+  static constexpr std::array<StatID, 3> memory_phases = {
+      StatID::preprocessing, StatID::gates_setup, StatID::gates_online};
+
+  static constexpr bool is_memory_phase(StatID id) noexcept {
+    return id == StatID::preprocessing || id == StatID::gates_setup ||
+           id == StatID::gates_online;
+  }
+
+  // phases whose hardware counters are recorded
+  static constexpr std::array<StatID, 5> counter_phases = {
+      StatID::base_ots, StatID::ot_extension_setup, StatID::preprocessing, StatID::gates_setup,
+      StatID::gates_online};
+
+  static constexpr bool is_counter_phase(StatID id) noexcept {
+    return id == StatID::base_ots || id == StatID::ot_extension_setup || is_memory_phase(id);
+  }
+
   time_point get_time() { return clock_type::now(); }
 
   template <StatID ID>
   void record_start() {
+    if constexpr (is_memory_phase(ID)) {
+      record_phase_start(ID);
+    }
+    if constexpr (MOTION_HARDWARE_COUNTERS && is_counter_phase(ID)) {
+      record_counters_start(ID);
+    }
     data_[static_cast<std::size_t>(ID)].first = clock_type::now();
     // data_.at(static_cast<std::size_t>(ID)).first = clock_type::now();
   }
@@ -64,13 +171,45 @@ struct RunTimeStats {
   void record_end() {
     data_[static_cast<std::size_t>(ID)].second = clock_type::now();
     // data_.at(static_cast<std::size_t>(ID)).second = clock_type::now();
+    if constexpr (MOTION_HARDWARE_COUNTERS && is_counter_phase(ID)) {
+      record_counters_end(ID);
+    }
+    if constexpr (is_memory_phase(ID)) {
+      record_phase_end(ID);
+    }
   }
 
   const time_point_pair& get(StatID id) const;
+  const PhaseMemoryStats& get_memory(StatID id) const;
+  const PhaseCpuStats& get_cpu(StatID id) const;
+  const HardwareCounterStats& get_counters(StatID id) const;
+  // average number of CPUs kept busy by the phase
+  double get_busy_cpus(StatID id) const;
 
   std::string print_human_readable() const;
 
   std::array<time_point_pair, static_cast<std::size_t>(StatID::MAX) + 1> data_;
+  // only filled for the memory_phases
+  std::array<PhaseMemoryStats, static_cast<std::size_t>(StatID::MAX) + 1> memory_;
+  std::array<PhaseCpuStats, static_cast<std::size_t>(StatID::MAX) + 1> cpu_;
+  // only filled for the counter_phases
+  std::array<HardwareCounterStats, static_cast<std::size_t>(StatID::MAX) + 1> counters_;
+  GateProfile gate_profile_;
+  FiberStackMemoryStats fiber_stacks_;
+
+ private:
+  void record_phase_start(StatID id);
+  void record_phase_end(StatID id);
+  void record_counters_start(StatID id);
+  void record_counters_end(StatID id);
+
+  // VmHWM and tracked bytes at the start of each phase
+  std::array<std::pair<std::size_t, std::size_t>, static_cast<std::size_t>(StatID::MAX) + 1>
+      memory_start_;
+  // CPU time at the start of each phase
+  std::array<double, static_cast<std::size_t>(StatID::MAX) + 1> cpu_start_ms_;
+  // hardware counters at the start of each phase
+  std::array<HardwareCounterStats, static_cast<std::size_t>(StatID::MAX) + 1> counters_start_;
 };
 
 }  // namespace Statistics
@@ -0,0 +1,187 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "trace_recorder.h"
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+#include <boost/json.hpp>
+
+#include "utility/thread.h"
+
+namespace json = boost::json;
+
+namespace MOTION {
+namespace Statistics {
+
+namespace {
+
+std::atomic<std::uint64_t> next_recorder_id{1};
+
+thread_local TraceRecorder* thread_recorder = nullptr;
+
+// buffer of the calling thread in the recorder it recorded the last event with
+struct ThreadBufferCache {
+  std::uint64_t recorder_id_ = 0;
+  void* buffer_ = nullptr;
+};
+thread_local ThreadBufferCache thread_buffer_cache;
+
+std::string escape_json(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (auto c : str) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+double to_us(TraceRecorder::clock_type::time_point time_point) {
+  return std::chrono::duration<double, std::micro>(time_point.time_since_epoch()).count();
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(std::size_t party_id)
+    : party_id_(party_id), recorder_id_(next_recorder_id.fetch_add(1)) {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+TraceRecorder* TraceRecorder::get_thread_recorder() noexcept { return thread_recorder; }
+
+void TraceRecorder::set_thread_recorder(TraceRecorder* recorder) noexcept {
+  thread_recorder = recorder;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::get_thread_buffer() {
+  if (thread_buffer_cache.recorder_id_ == recorder_id_) {
+    return *static_cast<ThreadBuffer*>(thread_buffer_cache.buffer_);
+  }
+  const auto thread_id = std::this_thread::get_id();
+  std::scoped_lock lock(mutex_);
+  ThreadBuffer* buffer = nullptr;
+  for (auto& b : thread_buffers_) {
+    if (b->thread_id_ == thread_id) {
+      buffer = b.get();
+      break;
+    }
+  }
+  if (buffer == nullptr) {
+    auto& b = thread_buffers_.emplace_back(std::make_unique<ThreadBuffer>());
+    b->thread_id_ = thread_id;
+    b->thread_name_ = ENCRYPTO::this_thread_get_name();
+    buffer = b.get();
+  }
+  thread_buffer_cache = {recorder_id_, buffer};
+  return *buffer;
+}
+
+void TraceRecorder::record(std::string name, const char* category, clock_type::time_point begin,
+                           clock_type::time_point end, std::string args) {
+  get_thread_buffer().events_.push_back(
+      {std::move(name), category, begin, end, std::move(args)});
+}
+
+std::size_t TraceRecorder::get_num_events() const {
+  std::scoped_lock lock(mutex_);
+  std::size_t num_events = 0;
+  for (const auto& buffer : thread_buffers_) {
+    num_events += buffer->events_.size();
+  }
+  return num_events;
+}
+
+void TraceRecorder::clear() {
+  std::scoped_lock lock(mutex_);
+  for (auto& buffer : thread_buffers_) {
+    buffer->events_.clear();
+  }
+}
+
+void TraceRecorder::write_chrome_trace(std::ostream& stream) const {
+  std::scoped_lock lock(mutex_);
+  stream << "{\"traceEvents\":[\n";
+  stream << fmt::format(
+      "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":\"party {}\"}}}}",
+      party_id_, party_id_);
+  for (std::size_t tid = 0; tid < thread_buffers_.size(); ++tid) {
+    const auto& buffer = *thread_buffers_[tid];
+    stream << fmt::format(
+        ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":"
+        "\"{}\"}}}}",
+        party_id_, tid, escape_json(buffer.thread_name_));
+    for (const auto& event : buffer.events_) {
+      stream << fmt::format(
+          ",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},"
+          "\"dur\":{:.3f},\"args\":{{{}}}}}",
+          escape_json(event.name_), event.category_, party_id_, tid, to_us(event.begin_),
+          to_us(event.end_) - to_us(event.begin_), event.args_);
+    }
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void TraceRecorder::write_chrome_trace(const std::string& path) const {
+  std::ofstream stream(path);
+  if (!stream) {
+    throw std::runtime_error(fmt::format("could not open {} for writing the trace", path));
+  }
+  write_chrome_trace(stream);
+}
+
+void merge_chrome_traces(const std::vector<std::string>& input_paths,
+                         const std::string& output_path) {
+  json::array events;
+  for (const auto& path : input_paths) {
+    std::ifstream stream(path);
+    if (!stream) {
+      throw std::runtime_error(fmt::format("could not open trace {}", path));
+    }
+    std::string content(std::istreambuf_iterator<char>(stream), {});
+    auto trace = json::parse(content);
+    for (auto& event : trace.as_object().at("traceEvents").as_array()) {
+      events.emplace_back(std::move(event));
+    }
+  }
+  std::ofstream stream(output_path);
+  if (!stream) {
+    throw std::runtime_error(fmt::format("could not open {} for writing the trace", output_path));
+  }
+  stream << json::serialize(json::object{{"traceEvents", std::move(events)},
+                                         {"displayTimeUnit", "ms"}})
+         << '\n';
+}
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/constants.h"
+
+namespace MOTION {
+namespace Statistics {
+
+// Records begin and end of events, e.g., the phases of the gates, the messages sent and received
+// by the CommunicationLayer and the waits on ReusableFutures, on a timeline of all threads of a
+// party, which can be written in the Chrome trace event format and viewed with chrome://tracing
+// or Perfetto.  The hooks are only compiled if MOTION_TRACING is enabled.
+//
+// The events are buffered per thread, so record() can be called concurrently from all threads.
+class TraceRecorder {
+ public:
+  using clock_type = std::chrono::steady_clock;
+
+  explicit TraceRecorder(std::size_t party_id);
+  ~TraceRecorder();
+
+  // record an event of the calling thread, args is the content of a JSON object, e.g.,
+  // "\"gate_id\":42", which is shown with the event
+  void record(std::string name, const char* category, clock_type::time_point begin,
+              clock_type::time_point end, std::string args = {});
+
+  std::size_t get_party_id() const noexcept { return party_id_; }
+  std::size_t get_num_events() const;
+  // forget all events, must not be called while events are recorded
+  void clear();
+
+  // write all events in the JSON format of the Chrome trace events, the party is the process and
+  // the timestamps are taken from the steady clock, s.t. the traces of the parties running on
+  // the same machine can be merged with merge_chrome_traces
+  void write_chrome_trace(std::ostream&) const;
+  void write_chrome_trace(const std::string& path) const;
+
+  // recorder used by the TraceScopes of the calling thread, e.g., set by the NewGateExecutor for
+  // the threads evaluating the gates
+  static TraceRecorder* get_thread_recorder() noexcept;
+  static void set_thread_recorder(TraceRecorder*) noexcept;
+
+ private:
+  struct Event {
+    std::string name_;
+    const char* category_;
+    clock_type::time_point begin_;
+    clock_type::time_point end_;
+    std::string args_;
+  };
+  struct ThreadBuffer {
+    std::thread::id thread_id_;
+    std::string thread_name_;
+    std::vector<Event> events_;
+  };
+  ThreadBuffer& get_thread_buffer();
+
+  std::size_t party_id_;
+  // distinguishes recorders allocated at the same address in the per thread cache
+  std::uint64_t recorder_id_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers_;
+};
+
+// Records an event from its construction to its destruction with the recorder of the calling
+// thread, if there is one.
+class TraceScope {
+ public:
+  TraceScope(std::string name, const char* category, std::string args = {})
+      : recorder_(MOTION_TRACING ? TraceRecorder::get_thread_recorder() : nullptr) {
+    if (recorder_ != nullptr) {
+      name_ = std::move(name);
+      category_ = category;
+      args_ = std::move(args);
+      begin_ = TraceRecorder::clock_type::now();
+    }
+  }
+  ~TraceScope() {
+    if (recorder_ != nullptr) {
+      recorder_->record(std::move(name_), category_, begin_, TraceRecorder::clock_type::now(),
+                        std::move(args_));
+    }
+  }
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  TraceRecorder* recorder_;
+  std::string name_;
+  const char* category_ = nullptr;
+  std::string args_;
+  TraceRecorder::clock_type::time_point begin_;
+};
+
+// merge the traces written by write_chrome_trace, e.g., by both parties, into a single trace
+void merge_chrome_traces(const std::vector<std::string>& input_paths,
+                         const std::string& output_path);
+
+}  // namespace Statistics
+}  // namespace MOTION
@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "model_session.h"
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "base/two_party_tensor_backend.h"
+#include "crypto/multiplication_triple/linalg_triple_provider.h"
+#include "tensor.h"
+
+namespace MOTION::tensor {
+
+ModelSession::ModelSession(std::size_t num_spare_runs)
+    : num_spare_runs_(num_spare_runs),
+      triple_pool_(std::make_shared<LinAlgTriplePool>()) {}
+
+TensorCP ModelSession::get_weights(const std::string& name) const {
+  auto it = weights_.find(name);
+  if (it == std::end(weights_)) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void ModelSession::store_weights(const std::string& name, TensorCP tensor) {
+  // the later runs read the shares, so they must survive the memory planning of this one
+  tensor->set_persistent();
+  auto [it, inserted] = weights_.try_emplace(name, std::move(tensor));
+  if (!inserted) {
+    throw std::logic_error(fmt::format("ModelSession: weights {} already stored", name));
+  }
+}
+
+void ModelSession::attach(TwoPartyTensorBackend& backend) {
+  backend.get_linalg_triple_provider().set_triple_pool(triple_pool_, num_spare_runs_);
+}
+
+std::size_t ModelSession::get_num_pooled_triples() const noexcept { return triple_pool_->size(); }
+
+void ModelSession::clear() {
+  weights_.clear();
+  triple_pool_->clear();
+}
+
+}  // namespace MOTION::tensor
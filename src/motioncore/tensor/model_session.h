@@ -0,0 +1,71 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace MOTION {
+
+class LinAlgTriplePool;
+class TwoPartyTensorBackend;
+
+namespace tensor {
+
+class Tensor;
+using TensorCP = std::shared_ptr<const Tensor>;
+
+// State of a model that is evaluated on many inputs with the same parties.  The shares of the
+// weights are kept from the run in which they were input, so later runs reuse them and only share
+// the inputs of the query.  The gemm and conv2d triples are taken from a pool, and a run which
+// finds none of a shape there generates the ones for `num_spare_runs` later runs along with its
+// own (see LinAlgTripleProvider::set_triple_pool).
+//
+// Both parties need to use their sessions with the same sequence of networks and the same
+// protocols, since the stored shares belong to the protocol which created them.
+class ModelSession {
+ public:
+  explicit ModelSession(std::size_t num_spare_runs = 0);
+
+  // shares of the weights stored under `name` in a previous run, nullptr if there are none
+  TensorCP get_weights(const std::string& name) const;
+  // the stored tensor is marked persistent, see Tensor::set_persistent()
+  void store_weights(const std::string& name, TensorCP);
+  std::size_t get_num_weights() const noexcept { return weights_.size(); }
+
+  // use the triple pool of the session for the ops built with the backend (call before building)
+  void attach(TwoPartyTensorBackend&);
+  std::size_t get_num_pooled_triples() const noexcept;
+
+  // forget the weights and the triples, e.g., when the model changes
+  void clear();
+
+ private:
+  std::size_t num_spare_runs_;
+  std::unordered_map<std::string, TensorCP> weights_;
+  std::shared_ptr<LinAlgTriplePool> triple_pool_;
+};
+
+}  // namespace tensor
+}  // namespace MOTION
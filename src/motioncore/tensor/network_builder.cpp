@@ -67,6 +67,30 @@ TensorCP NetworkBuilder::convert(MPCProtocol dst_proto, const TensorCP tensor_in
                                        ToString(dst_proto)));
 }
 
+TensorCP NetworkBuilder::convert_msb(MPCProtocol dst_proto, const TensorCP tensor_in) {
+  const auto src_proto = tensor_in->get_protocol();
+  const auto convert_msb_f = [tensor_in](auto& factory,
+                                         MPCProtocol proto) -> std::pair<TensorCP, bool> {
+    try {
+      auto tensor_out = factory.make_tensor_msb_conversion(proto, tensor_in);
+      return {std::move(tensor_out), true};
+    } catch (std::exception& e) {
+      return {{}, false};
+    }
+  };
+  // the MSBs are extracted by the first conversion, the remaining ones convert a single bit
+  const auto proto = convert_via(src_proto, dst_proto).value_or(dst_proto);
+  for (auto factory_proto : {src_proto, proto}) {
+    auto& factory = get_tensor_op_factory(factory_proto);
+    auto [tensor_out, success] = convert_msb_f(factory, proto);
+    if (success) {
+      return proto == dst_proto ? tensor_out : convert(dst_proto, tensor_out);
+    }
+  }
+  throw std::runtime_error(fmt::format("no MSB conversion from {} to {} supported",
+                                       ToString(src_proto), ToString(dst_proto)));
+}
+
 std::optional<MPCProtocol> NetworkBuilder::convert_via(MPCProtocol, MPCProtocol) {
   return std::nullopt;
 }
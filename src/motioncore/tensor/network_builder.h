@@ -38,6 +38,9 @@ using TensorCP = std::shared_ptr<const Tensor>;
 class NetworkBuilder {
  public:
   virtual TensorCP convert(MPCProtocol, const TensorCP);
+  // convert only the most significant bit of each value to a tensor of bit size 1, e.g., the signs
+  // of an arithmetic tensor as input of the ReLU
+  virtual TensorCP convert_msb(MPCProtocol, const TensorCP);
   virtual std::optional<MPCProtocol> convert_via(MPCProtocol src_proto, MPCProtocol dst_proto);
   virtual TensorOpFactory& get_tensor_op_factory(MPCProtocol) = 0;
 };
@@ -57,10 +57,40 @@ class Tensor : public NewWire {
   std::size_t get_num_dimensions() const noexcept { return 4; }
   const TensorDimensions& get_dimensions() const noexcept { return dimensions_; }
   // virtual std::size_t get_dimension(std::size_t) const = 0;
+
+  // scale of the fixed-point values, i.e., a value x is stored as x * 2^fractional_bits, which is
+  // set by the operation computing the tensor (0 for integers)
+  std::size_t get_fractional_bits() const noexcept { return fractional_bits_; }
+  void set_fractional_bits(std::size_t fractional_bits) noexcept {
+    fractional_bits_ = fractional_bits;
+  }
+
+  // Free the memory holding the shares once no op reads them anymore, see
+  // TensorOpExecutor::set_memory_planning().  Views sharing the buffers keep them alive.
+  virtual void release_buffers() {}
+  // Persistent tensors, e.g., weights shared by several runs, are never released.
+  bool is_persistent() const noexcept { return persistent_; }
+  void set_persistent() const noexcept { persistent_ = true; }
+
  private:
   const TensorDimensions dimensions_;
+  std::size_t fractional_bits_ = 0;
+  mutable bool persistent_ = false;
 };
 
+// scale of fixed-point values after truncating `truncate_bits` bits
+inline std::size_t truncated_fractional_bits(std::size_t fractional_bits,
+                                             std::size_t truncate_bits) noexcept {
+  return fractional_bits > truncate_bits ? fractional_bits - truncate_bits : 0;
+}
+
+// scale of the product of two fixed-point tensors after truncating `truncate_bits` bits
+inline std::size_t product_fractional_bits(const Tensor& a, const Tensor& b,
+                                           std::size_t truncate_bits) noexcept {
+  return truncated_fractional_bits(a.get_fractional_bits() + b.get_fractional_bits(),
+                                   truncate_bits);
+}
+
 using TensorP = std::shared_ptr<Tensor>;
 using TensorCP = std::shared_ptr<const Tensor>;
 
@@ -31,6 +31,7 @@ bool Conv2DOp::verify() const noexcept {
   bool result = true;
   result = result && (output_shape_ == compute_output_shape());
   result = result && strides_[0] > 0 && strides_[1] > 0;
+  result = result && batch_size_ > 0;
   // maybe add more checks here
   return result;
 }
@@ -54,12 +55,12 @@ std::array<std::size_t, 3> Conv2DOp::compute_output_shape() const noexcept {
 std::size_t Conv2DOp::compute_output_size() const noexcept {
   assert(verify());
   auto output_shape = compute_output_shape();
-  return output_shape[0] * output_shape[1] * output_shape[2];
+  return batch_size_ * output_shape[0] * output_shape[1] * output_shape[2];
 }
 
 std::size_t Conv2DOp::compute_input_size() const noexcept {
   assert(verify());
-  return input_shape_[0] * input_shape_[1] * input_shape_[2];
+  return batch_size_ * input_shape_[0] * input_shape_[1] * input_shape_[2];
 }
 
 std::size_t Conv2DOp::compute_kernel_size() const noexcept {
@@ -75,7 +76,7 @@ std::size_t Conv2DOp::compute_bias_size() const noexcept {
 std::pair<std::size_t, std::size_t> Conv2DOp::compute_input_matrix_shape() const noexcept {
   assert(verify());
   std::size_t num_rows = kernel_shape_[1] * kernel_shape_[2] * kernel_shape_[3];
-  std::size_t num_columns = output_shape_[1] * output_shape_[2];
+  std::size_t num_columns = batch_size_ * output_shape_[1] * output_shape_[2];
   return {num_rows, num_columns};
 }
 
@@ -89,13 +90,13 @@ std::pair<std::size_t, std::size_t> Conv2DOp::compute_kernel_matrix_shape() cons
 std::pair<std::size_t, std::size_t> Conv2DOp::compute_output_matrix_shape() const noexcept {
   assert(verify());
   std::size_t num_rows = kernel_shape_[0];
-  std::size_t num_columns = output_shape_[1] * output_shape_[2];
+  std::size_t num_columns = batch_size_ * output_shape_[1] * output_shape_[2];
   return {num_rows, num_columns};
 }
 
 TensorDimensions Conv2DOp::get_input_tensor_dims() const noexcept {
   assert(verify());
-  return {.batch_size_ = 1,
+  return {.batch_size_ = batch_size_,
           .num_channels_ = input_shape_[0],
           .height_ = input_shape_[1],
           .width_ = input_shape_[2]};
@@ -111,7 +112,7 @@ TensorDimensions Conv2DOp::get_kernel_tensor_dims() const noexcept {
 
 TensorDimensions Conv2DOp::get_output_tensor_dims() const noexcept {
   assert(verify());
-  return {.batch_size_ = 1,
+  return {.batch_size_ = batch_size_,
           .num_channels_ = output_shape_[0],
           .height_ = output_shape_[1],
           .width_ = output_shape_[2]};
@@ -127,6 +128,7 @@ bool Conv2DOp::operator==(const Conv2DOp& other) const noexcept {
   result = result && dilations_ == other.dilations_;
   result = result && pads_ == other.pads_;
   result = result && strides_ == other.strides_;
+  result = result && batch_size_ == other.batch_size_;
   return result;
 }
 
@@ -235,7 +237,8 @@ bool MaxPoolOp::verify() const noexcept {
   bool result = true;
   result = result && (output_shape_ == compute_output_shape());
   result = result && strides_[0] > 0 && strides_[1] > 0;
-  result = kernel_shape_[0] <= input_shape_[1] && kernel_shape_[1] <= input_shape_[2];
+  result = result && kernel_shape_[0] <= input_shape_[1] && kernel_shape_[1] <= input_shape_[2];
+  result = result && batch_size_ > 0;
   // maybe add more checks here
   return result;
 }
@@ -248,10 +251,8 @@ std::array<std::size_t, 3> MaxPoolOp::compute_output_shape() const noexcept {
 
   std::array<std::size_t, 3> output_shape;
   output_shape[0] = input_shape_[0];
-  output_shape[1] =
-      compute_output_dimension(input_shape_[1], kernel_shape_[2], strides_[0]);
-  output_shape[2] =
-      compute_output_dimension(input_shape_[2], kernel_shape_[3], strides_[1]);
+  output_shape[1] = compute_output_dimension(input_shape_[1], kernel_shape_[0], strides_[0]);
+  output_shape[2] = compute_output_dimension(input_shape_[2], kernel_shape_[1], strides_[1]);
   return output_shape;
 }
 
@@ -262,17 +263,17 @@ std::size_t MaxPoolOp::compute_kernel_size() const noexcept {
 
 std::size_t MaxPoolOp::compute_input_size() const noexcept {
   assert(verify());
-  return input_shape_[0] * input_shape_[1] * input_shape_[2];
+  return batch_size_ * input_shape_[0] * input_shape_[1] * input_shape_[2];
 }
 
 std::size_t MaxPoolOp::compute_output_size() const noexcept {
   assert(verify());
-  return output_shape_[0] * output_shape_[1] * output_shape_[2];
+  return batch_size_ * output_shape_[0] * output_shape_[1] * output_shape_[2];
 }
 
 TensorDimensions MaxPoolOp::get_input_tensor_dims() const noexcept {
   assert(verify());
-  return {.batch_size_ = 1,
+  return {.batch_size_ = batch_size_,
           .num_channels_ = input_shape_[0],
           .height_ = input_shape_[1],
           .width_ = input_shape_[2]};
@@ -280,7 +281,7 @@ TensorDimensions MaxPoolOp::get_input_tensor_dims() const noexcept {
 
 TensorDimensions MaxPoolOp::get_output_tensor_dims() const noexcept {
   assert(verify());
-  return {.batch_size_ = 1,
+  return {.batch_size_ = batch_size_,
           .num_channels_ = output_shape_[0],
           .height_ = output_shape_[1],
           .width_ = output_shape_[2]};
@@ -300,6 +301,7 @@ std::size_t std::hash<MOTION::tensor::Conv2DOp>::operator()(
   boost::hash_combine(seed, boost::hash_range(std::begin(op.dilations_), std::end(op.dilations_)));
   boost::hash_combine(seed, boost::hash_range(std::begin(op.pads_), std::end(op.pads_)));
   boost::hash_combine(seed, boost::hash_range(std::begin(op.strides_), std::end(op.strides_)));
+  boost::hash_combine(seed, op.batch_size_);
   return seed;
 }
 
@@ -44,6 +44,10 @@ struct Conv2DOp {
   std::array<std::size_t, 4> pads_;
   std::array<std::size_t, 2> strides_;
 
+  // number of input samples stored one after another which are convolved with the same kernel,
+  // their im2col matrices are concatenated s.t. all samples use a single matrix multiplication
+  std::size_t batch_size_ = 1;
+
   bool verify() const noexcept;
   std::array<std::size_t, 3> compute_output_shape() const noexcept;
   std::size_t compute_output_size() const noexcept;
@@ -91,6 +95,10 @@ struct MaxPoolOp {
   std::array<std::size_t, 2> kernel_shape_;
   std::array<std::size_t, 2> strides_;
 
+  // number of input samples stored one after another, the channels of all samples are pooled
+  // independently
+  std::size_t batch_size_ = 1;
+
   bool verify() const noexcept;
   std::array<std::size_t, 3> compute_output_shape() const noexcept;
   std::size_t compute_kernel_size() const noexcept;
@@ -30,23 +30,25 @@
 namespace MOTION::tensor {
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, TensorCP>
-TensorOpFactory::make_arithmetic_32_tensor_input_my(const TensorDimensions&) {
+TensorOpFactory::make_arithmetic_32_tensor_input_my(const TensorDimensions&, std::size_t) {
   throw std::logic_error(
       fmt::format("{} does not support arithmetic 32 bit inputs", get_provider_name()));
 }
 
 std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, TensorCP>
-TensorOpFactory::make_arithmetic_64_tensor_input_my(const TensorDimensions&) {
+TensorOpFactory::make_arithmetic_64_tensor_input_my(const TensorDimensions&, std::size_t) {
   throw std::logic_error(
       fmt::format("{} does not support arithmetic 64 bit inputs", get_provider_name()));
 }
 
-TensorCP TensorOpFactory::make_arithmetic_32_tensor_input_other(const TensorDimensions&) {
+TensorCP TensorOpFactory::make_arithmetic_32_tensor_input_other(const TensorDimensions&,
+                                                                std::size_t) {
   throw std::logic_error(
       fmt::format("{} does not support arithmetic 32 bit inputs", get_provider_name()));
 }
 
-TensorCP TensorOpFactory::make_arithmetic_64_tensor_input_other(const TensorDimensions&) {
+TensorCP TensorOpFactory::make_arithmetic_64_tensor_input_other(const TensorDimensions&,
+                                                                std::size_t) {
   throw std::logic_error(
       fmt::format("{} does not support arithmetic 64 bit inputs", get_provider_name()));
 }
@@ -73,6 +75,18 @@ tensor::TensorCP TensorOpFactory::make_tensor_conversion(MPCProtocol, const tens
       fmt::format("{} does not support conversions to other protocols", get_provider_name()));
 }
 
+tensor::TensorCP TensorOpFactory::make_tensor_msb_conversion(MPCProtocol,
+                                                             const tensor::TensorCP) {
+  throw std::logic_error(
+      fmt::format("{} does not support MSB conversions to other protocols", get_provider_name()));
+}
+
+tensor::TensorCP TensorOpFactory::make_tensor_ring_reduction(const tensor::TensorCP,
+                                                             std::size_t) {
+  throw std::logic_error(
+      fmt::format("{} does not support reducing the ring of tensors", get_provider_name()));
+}
+
 tensor::TensorCP TensorOpFactory::make_tensor_flatten_op(const tensor::TensorCP, std::size_t) {
   throw std::logic_error(
       fmt::format("{} does not support the Flatten operation", get_provider_name()));
@@ -89,8 +103,8 @@ tensor::TensorCP TensorOpFactory::make_tensor_conv2d_op(const tensor::Conv2DOp&,
 tensor::TensorCP TensorOpFactory::make_tensor_conv2d_op(const tensor::Conv2DOp& op,
                                                         const tensor::TensorCP input,
                                                         const tensor::TensorCP kernel,
-                                                        std::size_t) {
-  return make_tensor_conv2d_op(op, input, kernel, nullptr);
+                                                        std::size_t truncate_bits) {
+  return make_tensor_conv2d_op(op, input, kernel, nullptr, truncate_bits);
 }
 
 tensor::TensorCP TensorOpFactory::make_tensor_gemm_op(const tensor::GemmOp&, const tensor::TensorCP,
@@ -99,6 +113,15 @@ tensor::TensorCP TensorOpFactory::make_tensor_gemm_op(const tensor::GemmOp&, con
       fmt::format("{} does not support the Gemm operation", get_provider_name()));
 }
 
+tensor::TensorCP TensorOpFactory::make_tensor_sparse_gemm_op(const tensor::GemmOp&,
+                                                             const tensor::TensorCP,
+                                                             const CSRMatrix<std::uint64_t>&,
+                                                             std::size_t, std::size_t,
+                                                             std::size_t) {
+  throw std::logic_error(
+      fmt::format("{} does not support the sparse Gemm operation", get_provider_name()));
+}
+
 tensor::TensorCP TensorOpFactory::make_tensor_sqr_op(const tensor::TensorCP, std::size_t) {
   throw std::logic_error(fmt::format("{} does not support the Sqr operation", get_provider_name()));
 }
@@ -126,4 +149,9 @@ tensor::TensorCP TensorOpFactory::make_tensor_avgpool_op(const tensor::AveragePo
       fmt::format("{} does not support the AveragePool operation", get_provider_name()));
 }
 
+tensor::TensorCP TensorOpFactory::make_tensor_truncation_op(const tensor::TensorCP, std::size_t) {
+  throw std::logic_error(
+      fmt::format("{} does not support the Truncation operation", get_provider_name()));
+}
+
 }  // namespace MOTION::tensor
@@ -29,6 +29,11 @@
 #include "tensor_op.h"
 #include "utility/reusable_future.h"
 
+namespace MOTION {
+template <typename T>
+struct CSRMatrix;
+}  // namespace MOTION
+
 namespace MOTION::tensor {
 
 struct TensorDimensions;
@@ -48,12 +53,15 @@ class TensorOpFactory {
   virtual std::string get_provider_name() const noexcept = 0;
 
   // arithmetic inputs
+  // the input tensors are fixed-point values with the given scale, see Tensor
   virtual std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint32_t>>, TensorCP>
-  make_arithmetic_32_tensor_input_my(const TensorDimensions&);
+  make_arithmetic_32_tensor_input_my(const TensorDimensions&, std::size_t fractional_bits = 0);
   virtual std::pair<ENCRYPTO::ReusableFiberPromise<IntegerValues<std::uint64_t>>, TensorCP>
-  make_arithmetic_64_tensor_input_my(const TensorDimensions&);
-  virtual TensorCP make_arithmetic_32_tensor_input_other(const TensorDimensions&);
-  virtual TensorCP make_arithmetic_64_tensor_input_other(const TensorDimensions&);
+  make_arithmetic_64_tensor_input_my(const TensorDimensions&, std::size_t fractional_bits = 0);
+  virtual TensorCP make_arithmetic_32_tensor_input_other(const TensorDimensions&,
+                                                         std::size_t fractional_bits = 0);
+  virtual TensorCP make_arithmetic_64_tensor_input_other(const TensorDimensions&,
+                                                         std::size_t fractional_bits = 0);
 
   // arithmetic outputs
   virtual ENCRYPTO::ReusableFiberFuture<IntegerValues<std::uint32_t>>
@@ -64,6 +72,13 @@ class TensorOpFactory {
 
   // conversions
   virtual tensor::TensorCP make_tensor_conversion(MPCProtocol, const tensor::TensorCP input);
+  // convert only the most significant bits of the values, e.g., the signs needed by the ReLU, to a
+  // tensor of bit size 1
+  virtual tensor::TensorCP make_tensor_msb_conversion(MPCProtocol, const tensor::TensorCP input);
+  // reduce 64 bit values to `bit_size` bits, e.g., to evaluate the following layers on 32 bit
+  // values if their scale leaves enough bits for the integer part
+  virtual tensor::TensorCP make_tensor_ring_reduction(const tensor::TensorCP input,
+                                                      std::size_t bit_size);
 
   // operations
   virtual tensor::TensorCP make_tensor_flatten_op(const tensor::TensorCP input, std::size_t axis);
@@ -80,6 +95,17 @@ class TensorOpFactory {
                                                const tensor::TensorCP input_A,
                                                const tensor::TensorCP input_B,
                                                std::size_t truncate_bits = 0);
+  // product of input_A with a plaintext matrix B = weights of party weights_owner, where both
+  // parties know the sparsity pattern of B but only the owner its values (the other party passes
+  // the pattern without values), s.t. the cost only depends on the nonzero entries of B; the
+  // values are fixed-point numbers with weights_fractional_bits and are reduced to the bit size
+  // of input_A (op(A) and op(B) must not be transposed)
+  virtual tensor::TensorCP make_tensor_sparse_gemm_op(const tensor::GemmOp& gemm_op,
+                                                      const tensor::TensorCP input_A,
+                                                      const CSRMatrix<std::uint64_t>& weights,
+                                                      std::size_t weights_owner,
+                                                      std::size_t weights_fractional_bits,
+                                                      std::size_t truncate_bits = 0);
   virtual tensor::TensorCP make_tensor_sqr_op(const tensor::TensorCP input,
                                               std::size_t truncate_bits = 0);
   virtual tensor::TensorCP make_tensor_relu_op(const tensor::TensorCP input);
@@ -87,9 +113,14 @@ class TensorOpFactory {
                                                const tensor::TensorCP input_arith);
   virtual tensor::TensorCP make_tensor_maxpool_op(const tensor::MaxPoolOp& maxpool_op,
                                                   const tensor::TensorCP input);
+  // truncate_bits == 0 returns the sums of the windows without dividing them by the kernel size
   virtual tensor::TensorCP make_tensor_avgpool_op(const tensor::AveragePoolOp& avgpool_op,
                                                   const tensor::TensorCP input,
                                                   std::size_t truncate_bits);
+  // probabilistic truncation of the fixed-point values by `truncate_bits` bits, which lowers their
+  // scale, i.e., the result may be off by one in the last place
+  virtual tensor::TensorCP make_tensor_truncation_op(const tensor::TensorCP input,
+                                                     std::size_t truncate_bits);
 };
 
 }  // namespace MOTION::tensor
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ENCRYPTO {
+
+Arena::Arena(std::size_t chunk_size) : chunk_size_(chunk_size) {
+  if (chunk_size_ == 0) {
+    throw std::invalid_argument("Arena: chunk size needs to be positive");
+  }
+}
+
+Arena::~Arena() = default;
+
+void* Arena::allocate(std::size_t num_bytes, std::size_t alignment) {
+  // do not hand out the same address twice
+  num_bytes = std::max(num_bytes, std::size_t(1));
+  std::scoped_lock lock(mutex_);
+  void* ptr = current_;
+  if (current_ == nullptr || std::align(alignment, num_bytes, ptr, remaining_) == nullptr) {
+    const auto size = num_bytes + alignment;
+    const auto chunk_size = std::max(size, chunk_size_);
+    std::unique_ptr<std::byte[]> chunk(new std::byte[chunk_size]);
+    num_reserved_bytes_ += chunk_size;
+    ptr = chunk.get();
+    auto space = size;
+    std::align(alignment, num_bytes, ptr, space);
+    if (4 * num_bytes > chunk_size_) {
+      // keep on using the current chunk for the small allocations
+      chunks_.push_back(std::move(chunk));
+      num_allocated_bytes_ += num_bytes;
+      return ptr;
+    }
+    remaining_ = chunk_size - (static_cast<std::byte*>(ptr) - chunk.get());
+    chunks_.push_back(std::move(chunk));
+  }
+  current_ = static_cast<std::byte*>(ptr) + num_bytes;
+  remaining_ -= num_bytes;
+  num_allocated_bytes_ += num_bytes;
+  return ptr;
+}
+
+void Arena::release() noexcept {
+  std::scoped_lock lock(mutex_);
+  chunks_.clear();
+  current_ = nullptr;
+  remaining_ = 0;
+  num_allocated_bytes_ = 0;
+  num_reserved_bytes_ = 0;
+}
+
+std::size_t Arena::get_num_allocated_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return num_allocated_bytes_;
+}
+
+std::size_t Arena::get_num_reserved_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return num_reserved_bytes_;
+}
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace ENCRYPTO {
+
+// Thread-safe bump allocator for buffers which live until the end of a run, e.g., the setup
+// material of the gates.  Memory is taken from large chunks and is only freed in bulk by
+// release(), so allocating is cheap and freeing single buffers is a no-op.  Allocations larger
+// than a quarter of the chunk size get a chunk of their own.
+class Arena {
+ public:
+  static constexpr std::size_t default_chunk_size = std::size_t(1) << 20;
+
+  explicit Arena(std::size_t chunk_size = default_chunk_size);
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // get num_bytes of memory aligned to alignment, which needs to be a power of two
+  void* allocate(std::size_t num_bytes, std::size_t alignment);
+
+  // free all memory at once, buffers allocated before must not be used afterwards
+  void release() noexcept;
+
+  // number of bytes handed out since the last release()
+  std::size_t get_num_allocated_bytes() const;
+  // number of bytes held in chunks
+  std::size_t get_num_reserved_bytes() const;
+
+ private:
+  const std::size_t chunk_size_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<std::byte[]>> chunks_;
+  std::byte* current_ = nullptr;
+  std::size_t remaining_ = 0;
+  std::size_t num_allocated_bytes_ = 0;
+  std::size_t num_reserved_bytes_ = 0;
+};
+
+// Allocator for containers which takes its memory from an Arena.  A default constructed
+// ArenaAllocator has no arena and uses the heap, which is also used for copies of a container,
+// such that temporaries do not keep memory of the arena.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  ArenaAllocator() noexcept = default;
+  explicit ArenaAllocator(Arena* arena) noexcept : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.get_arena()) {}
+
+  T* allocate(std::size_t n) {
+    if (arena_ == nullptr) {
+      return std::allocator<T>().allocate(n);
+    }
+    constexpr auto alignment = std::max(alignof(T), alignof(std::max_align_t));
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignment));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if (arena_ == nullptr) {
+      std::allocator<T>().deallocate(p, n);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const noexcept { return {}; }
+
+  Arena* get_arena() const noexcept { return arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const noexcept {
+    return arena_ == other.get_arena();
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+    return arena_ != other.get_arena();
+  }
+
+ private:
+  Arena* arena_ = nullptr;
+};
+
+// Allocator which keeps its Arena alive, e.g., for std::allocate_shared: every object holds a
+// reference to the arena in its control block, so the arena is freed after the last object has
+// been destroyed.  Memory of single objects is not reused.
+template <typename T>
+class SharedArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit SharedArenaAllocator(std::shared_ptr<Arena> arena) noexcept
+      : arena_(std::move(arena)) {}
+  template <typename U>
+  SharedArenaAllocator(const SharedArenaAllocator<U>& other) noexcept
+      : arena_(other.get_arena()) {}
+
+  T* allocate(std::size_t n) {
+    constexpr auto alignment = std::max(alignof(T), alignof(std::max_align_t));
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignment));
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  const std::shared_ptr<Arena>& get_arena() const noexcept { return arena_; }
+
+  template <typename U>
+  bool operator==(const SharedArenaAllocator<U>& other) const noexcept {
+    return arena_ == other.get_arena();
+  }
+  template <typename U>
+  bool operator!=(const SharedArenaAllocator<U>& other) const noexcept {
+    return arena_ != other.get_arena();
+  }
+
+ private:
+  std::shared_ptr<Arena> arena_;
+};
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,221 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "bit_vector.h"
+
+// Lazy bit-wise expressions over BitVectors and BitSpans: an expression such as
+//
+//   Delta_y ^= (bits(Delta_a) & bits(delta_b)) ^ (bits(Delta_b) & bits(delta_a));
+//
+// is evaluated in a single pass over the memory without temporary BitVectors.  The operands are
+// combined in vector registers of the widest instruction set enabled at compile time, then in
+// 64-bit words and the remaining bytes.  Expressions refer to the memory of their operands and
+// must not outlive them.  All operands need to have the same size.
+
+namespace ENCRYPTO {
+
+namespace detail {
+
+#if defined(__AVX512F__)
+using bit_expression_vector = std::uint64_t __attribute__((vector_size(64)));
+#elif defined(__AVX2__)
+using bit_expression_vector = std::uint64_t __attribute__((vector_size(32)));
+#else
+using bit_expression_vector = std::uint64_t __attribute__((vector_size(16)));
+#endif
+
+struct BitAndOp {
+  template <typename W>
+  W operator()(W a, W b) const noexcept {
+    return W(a & b);
+  }
+};
+
+struct BitXorOp {
+  template <typename W>
+  W operator()(W a, W b) const noexcept {
+    return W(a ^ b);
+  }
+};
+
+struct BitOrOp {
+  template <typename W>
+  W operator()(W a, W b) const noexcept {
+    return W(a | b);
+  }
+};
+
+}  // namespace detail
+
+template <typename E>
+struct BitExpression {
+  const E& self() const noexcept { return static_cast<const E&>(*this); }
+};
+
+// operand of an expression
+class BitTerminal : public BitExpression<BitTerminal> {
+ public:
+  BitTerminal(const std::byte* data, std::size_t bit_size) noexcept
+      : data_(data), bit_size_(bit_size) {}
+
+  std::size_t GetSize() const noexcept { return bit_size_; }
+
+  // word of the type W starting at the given byte
+  template <typename W>
+  W load(std::size_t byte_offset) const noexcept {
+    W word;
+    std::memcpy(&word, data_ + byte_offset, sizeof(W));
+    return word;
+  }
+
+ private:
+  const std::byte* data_;
+  std::size_t bit_size_;
+};
+
+template <typename Op, typename L, typename R>
+class BitBinaryExpression : public BitExpression<BitBinaryExpression<Op, L, R>> {
+ public:
+  BitBinaryExpression(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+    if (lhs_.GetSize() != rhs_.GetSize()) {
+      throw std::invalid_argument(fmt::format("BitExpression: operands of sizes {} and {}",
+                                              lhs_.GetSize(), rhs_.GetSize()));
+    }
+  }
+
+  std::size_t GetSize() const noexcept { return lhs_.GetSize(); }
+
+  template <typename W>
+  W load(std::size_t byte_offset) const noexcept {
+    return Op{}(lhs_.template load<W>(byte_offset), rhs_.template load<W>(byte_offset));
+  }
+
+ private:
+  // the nodes are small, so they are kept by value and temporaries of a full expression can be
+  // combined
+  L lhs_;
+  R rhs_;
+};
+
+template <typename Allocator>
+BitTerminal bits(const BitVector<Allocator>& bv) noexcept {
+  return {bv.GetData().data(), bv.GetSize()};
+}
+
+inline BitTerminal bits(const BitSpan& bs) noexcept { return {bs.GetData(), bs.GetSize()}; }
+
+template <typename L, typename R>
+BitBinaryExpression<detail::BitAndOp, L, R> operator&(const BitExpression<L>& lhs,
+                                                      const BitExpression<R>& rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+template <typename L, typename R>
+BitBinaryExpression<detail::BitXorOp, L, R> operator^(const BitExpression<L>& lhs,
+                                                      const BitExpression<R>& rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+template <typename L, typename R>
+BitBinaryExpression<detail::BitOrOp, L, R> operator|(const BitExpression<L>& lhs,
+                                                     const BitExpression<R>& rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+namespace detail {
+
+// res[i] = op(res[i], expression[i]) for byte_size bytes
+template <typename Op, typename E>
+void evaluate_bit_expression(std::byte* res, const E& expression, std::size_t byte_size) {
+  const auto loop = [res, &expression, byte_size, op = Op{}]<typename W>(std::size_t i) {
+    for (; i + sizeof(W) <= byte_size; i += sizeof(W)) {
+      W word;
+      std::memcpy(&word, res + i, sizeof(W));
+      word = op(word, expression.template load<W>(i));
+      std::memcpy(res + i, &word, sizeof(W));
+    }
+    return i;
+  };
+  std::size_t i = loop.template operator()<bit_expression_vector>(0);
+  i = loop.template operator()<std::uint64_t>(i);
+  loop.template operator()<std::uint8_t>(i);
+}
+
+template <typename Op, typename Allocator, typename E>
+void evaluate_bit_expression(BitVector<Allocator>& bv, const BitExpression<E>& expression) {
+  const auto& e = expression.self();
+  if (bv.GetSize() != e.GetSize()) {
+    throw std::invalid_argument(fmt::format(
+        "BitExpression: assigning an expression of size {} to a BitVector of size {}", e.GetSize(),
+        bv.GetSize()));
+  }
+  evaluate_bit_expression<Op>(bv.GetMutableData().data(), e, bv.GetData().size());
+}
+
+}  // namespace detail
+
+template <typename Allocator, typename E>
+BitVector<Allocator>& operator^=(BitVector<Allocator>& bv, const BitExpression<E>& expression) {
+  detail::evaluate_bit_expression<detail::BitXorOp>(bv, expression);
+  return bv;
+}
+
+template <typename Allocator, typename E>
+BitVector<Allocator>& operator&=(BitVector<Allocator>& bv, const BitExpression<E>& expression) {
+  detail::evaluate_bit_expression<detail::BitAndOp>(bv, expression);
+  return bv;
+}
+
+template <typename Allocator, typename E>
+BitVector<Allocator>& operator|=(BitVector<Allocator>& bv, const BitExpression<E>& expression) {
+  detail::evaluate_bit_expression<detail::BitOrOp>(bv, expression);
+  return bv;
+}
+
+// res ^= expression on the bytes at res, e.g., the slice of one wire in a BitVector holding the
+// bits of several wires, which needs to start at a byte boundary.  If the size of the expression
+// is not a multiple of 8, the remaining bits of the last byte are xored with zeros.
+template <typename E>
+void xor_assign(std::byte* res, const BitExpression<E>& expression) {
+  const auto& e = expression.self();
+  detail::evaluate_bit_expression<detail::BitXorOp>(
+      res, e, MOTION::Helpers::Convert::BitsToBytes(e.GetSize()));
+}
+
+// compute the expression into a new BitVector
+template <typename Allocator = std_alloc, typename E>
+BitVector<Allocator> evaluate(const BitExpression<E>& expression) {
+  BitVector<Allocator> result(expression.self().GetSize());
+  result |= expression;
+  return result;
+}
+
+}  // namespace ENCRYPTO
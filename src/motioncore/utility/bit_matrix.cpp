@@ -26,119 +26,25 @@
 
 #include <immintrin.h>
 #include <omp.h>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
+#include "cpu_features.h"
+#include "crypto/aes/aesni_primitives.h"
 #include "crypto/pseudo_random_generator.h"
 #include "helpers.h"
 
 namespace ENCRYPTO {
 void BitMatrix::Transpose() {
-  std::size_t num_rows = data_.size();
-  if (num_rows == 0 || num_columns_ == 0 || (num_rows == 1 && num_columns_ == 1)) {
-    return;
-  } else if (num_rows == 1) {
-    for (auto i = 1ull; i < num_columns_; ++i) {
-      data_.emplace_back(1, data_.at(0).Get(i));
-    }
-    data_.at(0).Resize(1, true);
-    return;
-  } else if (num_columns_ == 1) {
-    for (auto i = 1ull; i < num_rows; ++i) {
-      data_.at(0).Append(data_.at(i));
-    }
-    data_.resize(1);
+  if (data_.empty() || num_columns_ == 0) {
     return;
   }
-
-  const std::size_t block_size_unpadded = std::min(num_rows, num_columns_);
-  const std::size_t block_size = static_cast<std::size_t>(pow(2, ceil(log2(block_size_unpadded))));
-  const std::size_t initial_num_columns = num_columns_;
-  const std::size_t initial_num_rows = data_.size();
-
-  // pad to the block size
-  if (num_columns_ % block_size > 0u) {
-    for (auto& bv : data_) {
-      bv.Resize(num_columns_ + block_size - (num_columns_ % block_size), true);
-    }
-  }
-
-  if (data_.size() % block_size > 0u) {
-    AlignedBitVector tmp(data_.at(0).GetSize());
-    data_.resize(data_.size() + block_size - (data_.size() % block_size), tmp);
-  }
-
-  // move the first blocks manually to reduce the memory overhead - prevent padding to a square
-  if (num_columns_ > num_rows) {
-    for (auto i = block_size; i < num_columns_; i += block_size) {
-#pragma omp for
-      for (auto j = 0ull; j < block_size; ++j) {
-        data_.emplace_back(data_.at(j).Subset(i, i + block_size));
-      }
-    }
-#pragma omp for
-    for (auto i = 0ull; i < block_size; ++i) {
-      data_.at(i).Resize(block_size, true);
-    }
-  } else if (num_columns_ < num_rows) {
-    for (auto i = block_size; i < data_.size(); i += block_size) {
-#pragma omp for
-      for (auto j = 0ull; j < block_size; ++j) {
-        data_.at(j).Append(data_.at(i + j));
-      }
-    }
-    data_.resize(block_size);
-  }
-
-  TransposeInternal();
-
-  // remove padding
-  data_.resize(initial_num_columns);
-
-  for (auto& bv : data_) {
-    bv.Resize(initial_num_rows, true);
-  }
-
-  num_columns_ = initial_num_rows;
-}
-
-void BitMatrix::TransposeInternal() {
-  for (auto block_size = std::min(data_.size(), data_.at(0).GetSize()); block_size > 1u;
-       block_size /= 2) {
-    const auto subblock_size = block_size / 2;
-    for (auto column_i = 0ull; column_i + subblock_size < data_.at(0).GetSize();
-         column_i += block_size) {
-      for (auto row_i = 0ull; row_i + subblock_size < data_.size(); row_i += block_size) {
-        auto subblock_1_row_offset = row_i + subblock_size;
-        auto subblock_1_column_offset = column_i;
-
-        auto subblock_2_row_offset = row_i;
-        auto subblock_2_column_offset = column_i + subblock_size;
-
-        if (subblock_size > 1u) {
-          for (auto i = 0ull; i < subblock_size; ++i) {
-            BitVector block_1 =
-                data_.at(subblock_1_row_offset + i)
-                    .Subset(subblock_1_column_offset, subblock_1_column_offset + subblock_size);
-            BitVector block_2 =
-                data_.at(subblock_2_row_offset + i)
-                    .Subset(subblock_2_column_offset, subblock_2_column_offset + subblock_size);
-
-            data_.at(subblock_2_row_offset + i)
-                .Copy(subblock_2_column_offset, subblock_2_column_offset + subblock_size, block_1);
-
-            data_.at(subblock_1_row_offset + i)
-                .Copy(subblock_1_column_offset, subblock_1_column_offset + subblock_size, block_2);
-          }
-        } else {
-          bool bit_1 = Get(subblock_1_row_offset, subblock_1_column_offset);
-          bool bit_2 = Get(subblock_2_row_offset, subblock_2_column_offset);
-          Set(subblock_1_row_offset, subblock_1_column_offset, bit_2);
-          Set(subblock_2_row_offset, subblock_2_column_offset, bit_1);
-        }
-      }
-    }
-  }
+  const auto transposed = ContiguousBitMatrix(data_).Transposed();
+  data_ = transposed.GetRows<aligned_alloc>();
+  num_columns_ = transposed.GetNumColumns();
 }
 
 void BitMatrix::Transpose128Rows() {
@@ -495,16 +401,266 @@ void BitMatrix::TransposeUsingBitSlicing(std::array<std::byte*, 128>& matrix, st
   // }
 }
 
+namespace {
+
+// number of columns that the wide kernels transpose in one pass before hashing them
+constexpr std::size_t wide_tile_columns = 512;
+
+// Transpose the 128 x (128 * num_chunks) submatrix starting at column `column` of the matrix into
+// the tile, s.t. block j of the tile holds column `column + j` (bit i of the block is row i).
+//
+// All 16 x 16 byte matrices of the 32 rows in the 128 bit lanes are transposed with four rounds
+// of unpacking, afterwards register m holds byte m of all rows and the bits of the columns are
+// extracted with movemask, as in the SSE kernel.
+__attribute__((target("avx2"))) void transpose_tile_avx2(
+    const std::array<const std::byte*, 128>& matrix, std::size_t column, std::size_t num_chunks,
+    __m128i* tile) {
+  std::array<__m256i, 16> vec, tmp;
+  auto tile_bytes = reinterpret_cast<std::byte*>(tile);
+  for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const std::size_t byte_offset = column / 8 + 16 * chunk;
+    for (std::size_t r = 0; r < 128; r += 32) {
+      // lane 0 holds the rows r, ..., r + 15, lane 1 the rows r + 16, ..., r + 31
+      for (std::size_t k = 0; k < 16; ++k) {
+        const auto lo =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix[r + k] + byte_offset));
+        const auto hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix[r + 16 + k] + byte_offset));
+        vec[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+      }
+      for (std::size_t round = 0; round < 4; ++round) {
+        for (std::size_t k = 0; k < 8; ++k) {
+          tmp[2 * k] = _mm256_unpacklo_epi8(vec[k], vec[k + 8]);
+          tmp[2 * k + 1] = _mm256_unpackhi_epi8(vec[k], vec[k + 8]);
+        }
+        vec = tmp;
+      }
+      for (std::size_t m = 0; m < 16; ++m) {
+        auto v = vec[m];
+        // the most significant bits belong to the last column of the byte
+        for (std::size_t i = 8; i > 0; v = _mm256_slli_epi64(v, 1), --i) {
+          const std::size_t j = 128 * chunk + 8 * m + i - 1;
+          *reinterpret_cast<std::uint32_t* __restrict__>(tile_bytes + 16 * j + r / 8) =
+              _mm256_movemask_epi8(v);
+        }
+      }
+    }
+  }
+}
+
+// the same as transpose_tile_avx2 with four lanes, i.e., 64 rows at once
+__attribute__((target("avx512f,avx512bw"))) void transpose_tile_avx512(
+    const std::array<const std::byte*, 128>& matrix, std::size_t column, std::size_t num_chunks,
+    __m128i* tile) {
+  std::array<__m512i, 16> vec, tmp;
+  auto tile_bytes = reinterpret_cast<std::byte*>(tile);
+  for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const std::size_t byte_offset = column / 8 + 16 * chunk;
+    for (std::size_t r = 0; r < 128; r += 64) {
+      // lane l holds the rows r + 16 * l, ..., r + 16 * l + 15
+      for (std::size_t k = 0; k < 16; ++k) {
+        auto load_row = [&matrix, byte_offset](std::size_t row) {
+          return _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix[row] + byte_offset));
+        };
+        auto v = _mm512_castsi128_si512(load_row(r + k));
+        v = _mm512_inserti32x4(v, load_row(r + 16 + k), 1);
+        v = _mm512_inserti32x4(v, load_row(r + 32 + k), 2);
+        vec[k] = _mm512_inserti32x4(v, load_row(r + 48 + k), 3);
+      }
+      for (std::size_t round = 0; round < 4; ++round) {
+        for (std::size_t k = 0; k < 8; ++k) {
+          tmp[2 * k] = _mm512_unpacklo_epi8(vec[k], vec[k + 8]);
+          tmp[2 * k + 1] = _mm512_unpackhi_epi8(vec[k], vec[k + 8]);
+        }
+        vec = tmp;
+      }
+      for (std::size_t m = 0; m < 16; ++m) {
+        auto v = vec[m];
+        for (std::size_t i = 8; i > 0; v = _mm512_slli_epi64(v, 1), --i) {
+          const std::size_t j = 128 * chunk + 8 * m + i - 1;
+          *reinterpret_cast<std::uint64_t* __restrict__>(tile_bytes + 16 * j + r / 8) =
+              _mm512_movepi8_mask(v);
+        }
+      }
+    }
+  }
+}
+
+void transpose_tile(BitMatrix::TransposeKernel kernel,
+                    const std::array<const std::byte*, 128>& matrix, std::size_t column,
+                    std::size_t num_columns, __m128i* tile) {
+  if (kernel == BitMatrix::TransposeKernel::avx512) {
+    transpose_tile_avx512(matrix, column, num_columns / 128, tile);
+  } else {
+    transpose_tile_avx2(matrix, column, num_columns / 128, tile);
+  }
+}
+
+// hash 8 (AVX2) or 16 (AVX-512) consecutive blocks inplace
+void mmo_batch(BitMatrix::TransposeKernel kernel, const void* round_keys, __m128i* blocks) {
+  if (kernel == BitMatrix::TransposeKernel::avx512) {
+    vaes_mmo_batch_16(round_keys, blocks);
+  } else {
+    aesni_mmo_batch_8(round_keys, blocks);
+  }
+}
+
+// set the output of an OT from its hashed block, as the SSE kernel does
+void set_output(BitVector<>& out, const __m128i& block, std::size_t bitlen, PRG& prg_var_key) {
+  constexpr std::size_t kappa{128};
+  const auto block_ptr = reinterpret_cast<const std::byte*>(&block);
+  if (bitlen <= kappa) {
+    out = BitVector<>(block_ptr, bitlen);
+  } else {
+    prg_var_key.SetKey(block_ptr);
+    out = BitVector<>(prg_var_key.Encrypt(MOTION::Helpers::Convert::BitsToBytes(bitlen)), bitlen);
+  }
+}
+
+// Transpose 512 columns at once and pipeline the fixed-key hashing of 4 (AVX2) or 8 (AVX-512)
+// columns, i.e., of both sender outputs per column, through the AES units.
+void sender_transpose_and_encrypt_wide(BitMatrix::TransposeKernel kernel,
+                                       const std::array<const std::byte*, 128>& matrix,
+                                       std::vector<BitVector<>>& y0, std::vector<BitVector<>>& y1,
+                                       const BitVector<>& choices, PRG& prg_fixed_key,
+                                       std::size_t column_offset, std::size_t ncols,
+                                       std::size_t num_ots,
+                                       const std::vector<std::size_t>& bitlengths) {
+  constexpr std::size_t kappa{128};
+  const std::size_t batch_size = kernel == BitMatrix::TransposeKernel::avx512 ? 8 : 4;
+  const auto round_keys = prg_fixed_key.get_round_keys();
+  const auto delta = _mm_loadu_si128(reinterpret_cast<const __m128i*>(choices.GetData().data()));
+  alignas(64) std::array<__m128i, wide_tile_columns> tile;
+  alignas(64) std::array<__m128i, 16> hashes;
+  PRG prg_var_key;
+
+  for (std::size_t c = 0; c < ncols; c += wide_tile_columns) {
+    const std::size_t num_columns = std::min(wide_tile_columns, ncols - c);
+    transpose_tile(kernel, matrix, c, num_columns, tile.data());
+    for (std::size_t j = 0; j < num_columns; j += batch_size) {
+      if (column_offset + c + j >= num_ots) {
+        // padding, which is not hashed
+        for (std::size_t k = 0; k < batch_size; ++k) {
+          y0[column_offset + c + j + k] =
+              BitVector<>(reinterpret_cast<const std::byte*>(&tile[j + k]), kappa);
+        }
+        continue;
+      }
+      for (std::size_t k = 0; k < batch_size; ++k) {
+        hashes[2 * k] = tile[j + k];
+        hashes[2 * k + 1] = _mm_xor_si128(tile[j + k], delta);
+      }
+      mmo_batch(kernel, round_keys, hashes.data());
+      for (std::size_t k = 0; k < batch_size; ++k) {
+        const std::size_t col = column_offset + c + j + k;
+        if (col < num_ots) {
+          set_output(y0[col], hashes[2 * k], bitlengths[col], prg_var_key);
+          set_output(y1[col], hashes[2 * k + 1], bitlengths[col], prg_var_key);
+        } else {
+          y0[col] = BitVector<>(reinterpret_cast<const std::byte*>(&tile[j + k]), kappa);
+        }
+      }
+    }
+  }
+}
+
+// see sender_transpose_and_encrypt_wide, the receiver hashes 8 (AVX2) or 16 (AVX-512) columns
+void receiver_transpose_and_encrypt_wide(BitMatrix::TransposeKernel kernel,
+                                         const std::array<const std::byte*, 128>& matrix,
+                                         std::vector<BitVector<>>& out, PRG& prg_fixed_key,
+                                         std::size_t column_offset, std::size_t ncols,
+                                         std::size_t num_ots,
+                                         const std::vector<std::size_t>& bitlengths) {
+  constexpr std::size_t kappa{128};
+  const std::size_t batch_size = kernel == BitMatrix::TransposeKernel::avx512 ? 16 : 8;
+  const auto round_keys = prg_fixed_key.get_round_keys();
+  alignas(64) std::array<__m128i, wide_tile_columns> tile;
+  PRG prg_var_key;
+
+  for (std::size_t c = 0; c < ncols; c += wide_tile_columns) {
+    const std::size_t num_columns = std::min(wide_tile_columns, ncols - c);
+    transpose_tile(kernel, matrix, c, num_columns, tile.data());
+    for (std::size_t j = 0; j < num_columns; j += batch_size) {
+      const std::size_t col = column_offset + c + j;
+      const std::size_t num_hashed = std::min(batch_size, num_ots - std::min(num_ots, col));
+      // padding, which is not hashed
+      for (std::size_t k = num_hashed; k < batch_size; ++k) {
+        out[col + k] = BitVector<>(reinterpret_cast<const std::byte*>(&tile[j + k]), kappa);
+      }
+      if (num_hashed == 0) {
+        continue;
+      }
+      mmo_batch(kernel, round_keys, &tile[j]);
+      for (std::size_t k = 0; k < num_hashed; ++k) {
+        set_output(out[col + k], tile[j + k], bitlengths[col + k], prg_var_key);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool BitMatrix::IsTransposeKernelSupported(TransposeKernel kernel) {
+  switch (kernel) {
+    case TransposeKernel::automatic:
+    case TransposeKernel::sse:
+      return true;
+    case TransposeKernel::avx2:
+      return MOTION::get_cpu_features().avx2;
+    case TransposeKernel::avx512: {
+      const auto& features = MOTION::get_cpu_features();
+      return features.avx512f && features.avx512bw && features.vaes;
+    }
+  }
+  return false;
+}
+
+BitMatrix::TransposeKernel BitMatrix::GetBestTransposeKernel() {
+  static const TransposeKernel best_kernel = [] {
+    for (auto kernel : {TransposeKernel::avx512, TransposeKernel::avx2}) {
+      if (IsTransposeKernelSupported(kernel)) {
+        return kernel;
+      }
+    }
+    return TransposeKernel::sse;
+  }();
+  return best_kernel;
+}
+
+std::string to_string(BitMatrix::TransposeKernel kernel) {
+  switch (kernel) {
+    case BitMatrix::TransposeKernel::automatic:
+      return "automatic";
+    case BitMatrix::TransposeKernel::sse:
+      return "sse";
+    case BitMatrix::TransposeKernel::avx2:
+      return "avx2";
+    case BitMatrix::TransposeKernel::avx512:
+      return "avx512";
+  }
+  return "invalid";
+}
+
+// select the kernel to use, or throw if it is not supported
+static BitMatrix::TransposeKernel resolve_transpose_kernel(BitMatrix::TransposeKernel kernel) {
+  if (kernel == BitMatrix::TransposeKernel::automatic) {
+    return BitMatrix::GetBestTransposeKernel();
+  }
+  if (!BitMatrix::IsTransposeKernelSupported(kernel)) {
+    throw std::invalid_argument("transpose kernel " + to_string(kernel) +
+                                " is not supported by this CPU");
+  }
+  return kernel;
+}
+
 void BitMatrix::SenderTransposeAndEncrypt(const std::array<const std::byte*, 128>& matrix,
                                           std::vector<BitVector<>>& y0,
                                           std::vector<BitVector<>>& y1, const BitVector<> choices,
                                           PRG& prg_fixed_key, const std::size_t ncols,
-                                          const std::vector<std::size_t>& bitlengths) {
-  constexpr std::size_t kappa{128}, nrows{128};
-#define INP(r, c)                                     \
-  reinterpret_cast<const std::uint8_t* __restrict__>( \
-      __builtin_assume_aligned(matrix.at(r), 16))[c / 8]
+                                          const std::vector<std::size_t>& bitlengths,
+                                          TransposeKernel kernel) {
   assert(y0.size() == y1.size());
+  assert(ncols % 128 == 0);
 
   const std::size_t original_size{y0.size()}, difference{ncols - original_size};
   if (difference) {
@@ -512,58 +668,45 @@ void BitMatrix::SenderTransposeAndEncrypt(const std::array<const std::byte*, 128
     y1.resize(ncols);
   }
 
-  for (auto& bv : y0) bv = BitVector(std::vector<std::byte>(kappa / 8), kappa);
+  SenderTransposeAndEncryptRange(matrix, y0, y1, choices, prg_fixed_key, 0, ncols, original_size,
+                                 bitlengths, kernel);
+}
+
+void BitMatrix::SenderTransposeAndEncryptRange(
+    const std::array<const std::byte*, 128>& full_matrix, std::vector<BitVector<>>& y0,
+    std::vector<BitVector<>>& y1, const BitVector<>& choices, PRG& prg_fixed_key,
+    const std::size_t column_offset, const std::size_t ncols, const std::size_t num_ots,
+    const std::vector<std::size_t>& bitlengths, TransposeKernel kernel) {
+  constexpr std::size_t kappa{128}, nrows{128};
+  assert(column_offset % 128 == 0 && ncols % 128 == 0);
+  assert(y0.size() >= column_offset + ncols && y1.size() >= column_offset + ncols);
+
+  // the columns of the range
+  std::array<const std::byte*, 128> matrix;
+  for (std::size_t j = 0; j < matrix.size(); ++j) {
+    matrix[j] = full_matrix[j] + column_offset / 8;
+  }
+
+#define INP(r, c)                                     \
+  reinterpret_cast<const std::uint8_t* __restrict__>( \
+      __builtin_assume_aligned(matrix.at(r), 16))[c / 8]
+
+  kernel = resolve_transpose_kernel(kernel);
+  if (kernel != TransposeKernel::sse) {
+    sender_transpose_and_encrypt_wide(kernel, matrix, y0, y1, choices, prg_fixed_key,
+                                      column_offset, ncols, num_ots, bitlengths);
+    return;
+  }
+
+  for (std::size_t j = 0; j < ncols; ++j) {
+    y0[column_offset + j] = BitVector(std::vector<std::byte>(kappa / 8), kappa);
+  }
 
   std::uint64_t r{0}, c{0};
   int i{0};
 
   assert(nrows % 8 == 0 && ncols % 8 == 0);
 
-//#define MOTION_AVX2
-#if defined(MOTION_AVX512)
-  // TODO: not tested yet
-  __m512i vec;
-  for (rr = 0; rr <= nrows - 32; rr += 8) {
-    for (cc = 0; cc < ncols; cc += 64) {
-      vec = _mm512_set_epi8(
-          INP(rr + 56, cc), INP(rr + 57, cc), INP(rr + 58, cc), INP(rr + 59, cc), INP(rr + 60, cc),
-          INP(rr + 61, cc), INP(rr + 62, cc), INP(rr + 63, cc), INP(rr + 48, cc), INP(rr + 49, cc),
-          INP(rr + 50, cc), INP(rr + 51, cc), INP(rr + 52, cc), INP(rr + 53, cc), INP(rr + 54, cc),
-          INP(rr + 55, cc), INP(rr + 39, cc), INP(rr + 40, cc), INP(rr + 41, cc), INP(rr + 42, cc),
-          INP(rr + 43, cc), INP(rr + 44, cc), INP(rr + 45, cc), INP(rr + 46, cc), INP(rr + 32, cc),
-          INP(rr + 33, cc), INP(rr + 34, cc), INP(rr + 35, cc), INP(rr + 36, cc), INP(rr + 37, cc),
-          INP(rr + 38, cc), INP(rr + 39, cc), INP(rr + 24, cc), INP(rr + 25, cc), INP(rr + 26, cc),
-          INP(rr + 27, cc), INP(rr + 28, cc), INP(rr + 29, cc), INP(rr + 30, cc), INP(rr + 31, cc),
-          INP(rr + 16, cc), INP(rr + 17, cc), INP(rr + 18, cc), INP(rr + 19, cc), INP(rr + 20, cc),
-          INP(rr + 21, cc), INP(rr + 22, cc), INP(rr + 23, cc), INP(rr + 8, cc), INP(rr + 9, cc),
-          INP(rr + 10, cc), INP(rr + 11, cc), INP(rr + 12, cc), INP(rr + 13, cc), INP(rr + 14, cc),
-          INP(rr + 15, cc), INP(rr + 0, cc), INP(rr + 1, cc), INP(rr + 2, cc), INP(rr + 3, cc),
-          INP(rr + 4, cc), INP(rr + 5, cc), INP(rr + 6, cc), INP(rr + 7, cc));
-      for (i = 0; i < 64; vec = _mm512_slli_epi64(vec, 1), ++i) {
-        OUT(cc + i, rr) = _mm512_movepi64_mask(vec);
-      }
-    }
-  }
-#elif defined(MOTION_AVX2)
-  __m256i vec;
-  for (rr = 0; rr <= nrows - 32; rr += 32) {
-    for (cc = 0; cc < ncols; cc += 8) {
-      vec = _mm256_set_epi8(INP(rr + 24, cc), INP(rr + 25, cc), INP(rr + 26, cc), INP(rr + 27, cc),
-                            INP(rr + 28, cc), INP(rr + 29, cc), INP(rr + 30, cc), INP(rr + 31, cc),
-                            INP(rr + 16, cc), INP(rr + 17, cc), INP(rr + 18, cc), INP(rr + 19, cc),
-                            INP(rr + 20, cc), INP(rr + 21, cc), INP(rr + 22, cc), INP(rr + 23, cc),
-                            INP(rr + 8, cc), INP(rr + 9, cc), INP(rr + 10, cc), INP(rr + 11, cc),
-                            INP(rr + 12, cc), INP(rr + 13, cc), INP(rr + 14, cc), INP(rr + 15, cc),
-                            INP(rr + 0, cc), INP(rr + 1, cc), INP(rr + 2, cc), INP(rr + 3, cc),
-                            INP(rr + 4, cc), INP(rr + 5, cc), INP(rr + 6, cc), INP(rr + 7, cc));
-      for (i = 0; i < 8; vec = _mm256_slli_epi64(vec, 1), ++i) {
-        *(uint32_t*)&OUT(cc + i, rr) = _mm256_movemask_epi8(vec);
-        // const auto pos = ((cc + i) % nrows) * num_blocks * 16 + (cc / nrows) * 16 + rr / 8;
-        //*(uint16_t*)&out[pos] = _mm_movemask_epi8(vec);
-      }
-    }
-  }
-#else
   __m128i vec;
   PRG prg_var_key;
   // process 128x128 blocks
@@ -582,18 +725,19 @@ void BitMatrix::SenderTransposeAndEncrypt(const std::array<const std::byte*, 128
         // for (i = 0; i < 8; vec = _mm_slli_epi64(vec, 1), ++i) {
         for (i = 8; i > 0; vec = _mm_slli_epi64(vec, 1), --i) {
           // *reinterpret_cast<std::uint16_t* __restrict__>(y0[c + i].GetMutableData().data() +
-          *reinterpret_cast<std::uint16_t* __restrict__>(y0[c + i - 1].GetMutableData().data() +
-                                                         r / 8) = _mm_movemask_epi8(vec);
+          *reinterpret_cast<std::uint16_t* __restrict__>(
+              y0[column_offset + c + i - 1].GetMutableData().data() + r / 8) =
+              _mm_movemask_epi8(vec);
         }
       }
     }
     // XXX
-    for (; c_old < c && c_old < original_size; ++c_old) {
-      auto& out0 = y0[c_old];
-      auto& out1 = y1[c_old];
+    for (; c_old < c && column_offset + c_old < num_ots; ++c_old) {
+      auto& out0 = y0[column_offset + c_old];
+      auto& out1 = y1[column_offset + c_old];
 
       // bit length of the OT
-      const auto bitlen = bitlengths[c_old];
+      const auto bitlen = bitlengths[column_offset + c_old];
 
       out1 = choices ^ out0;
       assert(out0.GetSize() == 128);
@@ -619,75 +763,59 @@ void BitMatrix::SenderTransposeAndEncrypt(const std::array<const std::byte*, 128
       }
     }
   }
-#endif
 }
 
 void BitMatrix::ReceiverTransposeAndEncrypt(const std::array<const std::byte*, 128>& matrix,
                                             std::vector<BitVector<>>& out, PRG& prg_fixed_key,
                                             const std::size_t ncols,
-                                            const std::vector<std::size_t>& bitlengths) {
+                                            const std::vector<std::size_t>& bitlengths,
+                                            TransposeKernel kernel) {
+  assert(ncols % 128 == 0);
+
+  const std::size_t original_size{out.size()}, difference{ncols - original_size};
+  if (difference) {
+    out.resize(ncols);
+  }
+
+  ReceiverTransposeAndEncryptRange(matrix, out, prg_fixed_key, 0, ncols, original_size, bitlengths,
+                                   kernel);
+}
+
+void BitMatrix::ReceiverTransposeAndEncryptRange(
+    const std::array<const std::byte*, 128>& full_matrix, std::vector<BitVector<>>& out,
+    PRG& prg_fixed_key, const std::size_t column_offset, const std::size_t ncols,
+    const std::size_t num_ots, const std::vector<std::size_t>& bitlengths,
+    TransposeKernel kernel) {
   constexpr std::size_t kappa{128}, nrows{128};
+  assert(column_offset % 128 == 0 && ncols % 128 == 0);
+  assert(out.size() >= column_offset + ncols);
+
+  // the columns of the range
+  std::array<const std::byte*, 128> matrix;
+  for (std::size_t j = 0; j < matrix.size(); ++j) {
+    matrix[j] = full_matrix[j] + column_offset / 8;
+  }
+
 #define INP(r, c)                                     \
   reinterpret_cast<const std::uint8_t* __restrict__>( \
       __builtin_assume_aligned(matrix.at(r), 16))[c / 8]
 
-  const std::size_t original_size{out.size()}, difference{ncols - original_size};
-  if (difference) {
-    out.resize(ncols);
+  kernel = resolve_transpose_kernel(kernel);
+  if (kernel != TransposeKernel::sse) {
+    receiver_transpose_and_encrypt_wide(kernel, matrix, out, prg_fixed_key, column_offset, ncols,
+                                        num_ots, bitlengths);
+    return;
   }
 
-  for (auto& bv : out) bv = BitVector(std::vector<std::byte>(kappa / 8), kappa);
+  for (std::size_t j = 0; j < ncols; ++j) {
+    out[column_offset + j] = BitVector(std::vector<std::byte>(kappa / 8), kappa);
+  }
 
   std::uint64_t r{0}, c{0};
   int i{0};
 
   assert(nrows % 8 == 0 && ncols % 8 == 0);
 
-//#define MOTION_AVX2
-#if defined(MOTION_AVX512)
-  // TODO: not tested yet
-  __m512i vec;
-  for (rr = 0; rr <= nrows - 32; rr += 8) {
-    for (cc = 0; cc < ncols; cc += 64) {
-      vec = _mm512_set_epi8(
-          INP(rr + 56, cc), INP(rr + 57, cc), INP(rr + 58, cc), INP(rr + 59, cc), INP(rr + 60, cc),
-          INP(rr + 61, cc), INP(rr + 62, cc), INP(rr + 63, cc), INP(rr + 48, cc), INP(rr + 49, cc),
-          INP(rr + 50, cc), INP(rr + 51, cc), INP(rr + 52, cc), INP(rr + 53, cc), INP(rr + 54, cc),
-          INP(rr + 55, cc), INP(rr + 39, cc), INP(rr + 40, cc), INP(rr + 41, cc), INP(rr + 42, cc),
-          INP(rr + 43, cc), INP(rr + 44, cc), INP(rr + 45, cc), INP(rr + 46, cc), INP(rr + 32, cc),
-          INP(rr + 33, cc), INP(rr + 34, cc), INP(rr + 35, cc), INP(rr + 36, cc), INP(rr + 37, cc),
-          INP(rr + 38, cc), INP(rr + 39, cc), INP(rr + 24, cc), INP(rr + 25, cc), INP(rr + 26, cc),
-          INP(rr + 27, cc), INP(rr + 28, cc), INP(rr + 29, cc), INP(rr + 30, cc), INP(rr + 31, cc),
-          INP(rr + 16, cc), INP(rr + 17, cc), INP(rr + 18, cc), INP(rr + 19, cc), INP(rr + 20, cc),
-          INP(rr + 21, cc), INP(rr + 22, cc), INP(rr + 23, cc), INP(rr + 8, cc), INP(rr + 9, cc),
-          INP(rr + 10, cc), INP(rr + 11, cc), INP(rr + 12, cc), INP(rr + 13, cc), INP(rr + 14, cc),
-          INP(rr + 15, cc), INP(rr + 0, cc), INP(rr + 1, cc), INP(rr + 2, cc), INP(rr + 3, cc),
-          INP(rr + 4, cc), INP(rr + 5, cc), INP(rr + 6, cc), INP(rr + 7, cc));
-      for (i = 0; i < 64; vec = _mm512_slli_epi64(vec, 1), ++i) {
-        OUT(cc + i, rr) = _mm512_movepi64_mask(vec);
-      }
-    }
-  }
-#elif defined(MOTION_AVX2)
-  __m256i vec;
-  for (rr = 0; rr <= nrows - 32; rr += 32) {
-    for (cc = 0; cc < ncols; cc += 8) {
-      vec = _mm256_set_epi8(INP(rr + 24, cc), INP(rr + 25, cc), INP(rr + 26, cc), INP(rr + 27, cc),
-                            INP(rr + 28, cc), INP(rr + 29, cc), INP(rr + 30, cc), INP(rr + 31, cc),
-                            INP(rr + 16, cc), INP(rr + 17, cc), INP(rr + 18, cc), INP(rr + 19, cc),
-                            INP(rr + 20, cc), INP(rr + 21, cc), INP(rr + 22, cc), INP(rr + 23, cc),
-                            INP(rr + 8, cc), INP(rr + 9, cc), INP(rr + 10, cc), INP(rr + 11, cc),
-                            INP(rr + 12, cc), INP(rr + 13, cc), INP(rr + 14, cc), INP(rr + 15, cc),
-                            INP(rr + 0, cc), INP(rr + 1, cc), INP(rr + 2, cc), INP(rr + 3, cc),
-                            INP(rr + 4, cc), INP(rr + 5, cc), INP(rr + 6, cc), INP(rr + 7, cc));
-      for (i = 0; i < 8; vec = _mm256_slli_epi64(vec, 1), ++i) {
-        *(uint32_t*)&OUT(cc + i, rr) = _mm256_movemask_epi8(vec);
-        // const auto pos = ((cc + i) % nrows) * num_blocks * 16 + (cc / nrows) * 16 + rr / 8;
-        //*(uint16_t*)&out[pos] = _mm_movemask_epi8(vec);
-      }
-    }
-  }
-#else
   __m128i vec;
   PRG prg_var_key;
   // process 128x128 blocks
@@ -706,16 +834,17 @@ void BitMatrix::ReceiverTransposeAndEncrypt(const std::array<const std::byte*, 1
         // for (i = 0; i < 8; vec = _mm_slli_epi64(vec, 1), ++i) {
         for (i = 8; i > 0; vec = _mm_slli_epi64(vec, 1), --i) {
           // *reinterpret_cast<std::uint16_t* __restrict__>(out[c + i].GetMutableData().data() +
-          *reinterpret_cast<std::uint16_t* __restrict__>(out[c + i - 1].GetMutableData().data() +
-                                                         r / 8) = _mm_movemask_epi8(vec);
+          *reinterpret_cast<std::uint16_t* __restrict__>(
+              out[column_offset + c + i - 1].GetMutableData().data() + r / 8) =
+              _mm_movemask_epi8(vec);
         }
       }
     }
     // XXX
-    for (; c_old < c && c_old < original_size; ++c_old) {
-        auto &o = out[c_old];
+    for (; c_old < c && column_offset + c_old < num_ots; ++c_old) {
+        auto &o = out[column_offset + c_old];
         assert(o.GetSize() == 128);
-        const std::size_t bitlen = bitlengths[c_old];
+        const std::size_t bitlen = bitlengths[column_offset + c_old];
 
         if (bitlen <= kappa) {
           prg_fixed_key.MMO(o.GetMutableData().data());
@@ -727,7 +856,6 @@ void BitMatrix::ReceiverTransposeAndEncrypt(const std::array<const std::byte*, 1
         }
     }
   }
-#endif
 }
 
 bool BitMatrix::operator==(const BitMatrix& other) {
@@ -744,4 +872,148 @@ bool BitMatrix::operator==(const BitMatrix& other) {
   return true;
 }
 
+
+namespace {
+
+// the matrix to transpose by transpose_recursive and where to write the result
+struct TransposeArguments {
+  const std::byte* input;
+  std::byte* output;
+  std::size_t num_rows;
+  std::size_t num_columns;
+  std::size_t input_stride;
+  std::size_t output_stride;
+};
+
+// collect the byte `byte_i` of the rows [row_i, row_i + num_lanes) and zeros up to `lane_count`
+inline void gather_column_bytes(const TransposeArguments& args, std::size_t row_i,
+                                std::size_t byte_i, std::uint8_t* lanes, std::size_t lane_count) {
+  const auto num_lanes = std::min(lane_count, args.num_rows - row_i);
+  const auto* in = reinterpret_cast<const std::uint8_t*>(args.input) + row_i * args.input_stride;
+  for (std::size_t k = 0; k < num_lanes; ++k) {
+    lanes[k] = in[k * args.input_stride + byte_i];
+  }
+  std::fill(lanes + num_lanes, lanes + lane_count, std::uint8_t(0));
+}
+
+// Each kernel transposes a tile of rows [row_begin, row_end) and columns [column_begin,
+// column_end), where the beginnings are multiples of 8.  It gathers the same byte of 16, 32 or 64
+// rows into a vector whose most significant bits are then the bits of one input column.  The
+// movemask of the vector is the part of the output row for these input rows, and shifting all
+// bytes to the left exposes the next column.
+
+inline void write_output_bits(const TransposeArguments& args, std::size_t row_i,
+                              std::size_t column_i, std::uint64_t mask, std::size_t lane_count) {
+  const auto num_bytes = std::min(lane_count, args.num_rows - row_i + 7) / 8;
+  std::memcpy(args.output + column_i * args.output_stride + row_i / 8, &mask, num_bytes);
+}
+
+void transpose_leaf_sse(const TransposeArguments& args, std::size_t row_begin,
+                        std::size_t row_end, std::size_t column_begin, std::size_t column_end) {
+  alignas(16) std::array<std::uint8_t, 16> lanes;
+  for (auto row_i = row_begin; row_i < row_end; row_i += 16) {
+    for (auto byte_i = column_begin / 8; 8 * byte_i < column_end; ++byte_i) {
+      gather_column_bytes(args, row_i, byte_i, lanes.data(), 16);
+      auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes.data()));
+      const auto num_bits = std::min<std::size_t>(8, args.num_columns - 8 * byte_i);
+      for (std::size_t i = 8; i > 0; v = _mm_slli_epi64(v, 1), --i) {
+        if (i <= num_bits) {
+          write_output_bits(args, row_i, 8 * byte_i + i - 1, _mm_movemask_epi8(v), 16);
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2"))) void transpose_leaf_avx2(const TransposeArguments& args,
+                                                         std::size_t row_begin,
+                                                         std::size_t row_end,
+                                                         std::size_t column_begin,
+                                                         std::size_t column_end) {
+  alignas(32) std::array<std::uint8_t, 32> lanes;
+  for (auto row_i = row_begin; row_i < row_end; row_i += 32) {
+    for (auto byte_i = column_begin / 8; 8 * byte_i < column_end; ++byte_i) {
+      gather_column_bytes(args, row_i, byte_i, lanes.data(), 32);
+      auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.data()));
+      const auto num_bits = std::min<std::size_t>(8, args.num_columns - 8 * byte_i);
+      for (std::size_t i = 8; i > 0; v = _mm256_slli_epi64(v, 1), --i) {
+        if (i <= num_bits) {
+          write_output_bits(args, row_i, 8 * byte_i + i - 1,
+                            static_cast<std::uint32_t>(_mm256_movemask_epi8(v)), 32);
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx512f,avx512bw"))) void transpose_leaf_avx512(
+    const TransposeArguments& args, std::size_t row_begin, std::size_t row_end,
+    std::size_t column_begin, std::size_t column_end) {
+  alignas(64) std::array<std::uint8_t, 64> lanes;
+  for (auto row_i = row_begin; row_i < row_end; row_i += 64) {
+    for (auto byte_i = column_begin / 8; 8 * byte_i < column_end; ++byte_i) {
+      gather_column_bytes(args, row_i, byte_i, lanes.data(), 64);
+      auto v = _mm512_load_si512(lanes.data());
+      const auto num_bits = std::min<std::size_t>(8, args.num_columns - 8 * byte_i);
+      for (std::size_t i = 8; i > 0; v = _mm512_slli_epi64(v, 1), --i) {
+        if (i <= num_bits) {
+          write_output_bits(args, row_i, 8 * byte_i + i - 1, _mm512_movepi8_mask(v), 64);
+        }
+      }
+    }
+  }
+}
+
+// split the longer side of the block in halves (at multiples of 8) until it fits into the cache
+void transpose_recursive(BitMatrix::TransposeKernel kernel, const TransposeArguments& args,
+                         std::size_t row_begin, std::size_t row_end, std::size_t column_begin,
+                         std::size_t column_end) {
+  // 256 x 64 bits touch 256 input cache lines and 64 output rows of 32 bytes
+  constexpr std::size_t max_leaf_rows = 256;
+  constexpr std::size_t max_leaf_columns = 64;
+  const auto num_rows = row_end - row_begin;
+  const auto num_columns = column_end - column_begin;
+  if (num_rows <= max_leaf_rows && num_columns <= max_leaf_columns) {
+    switch (kernel) {
+      case BitMatrix::TransposeKernel::avx512:
+        transpose_leaf_avx512(args, row_begin, row_end, column_begin, column_end);
+        break;
+      case BitMatrix::TransposeKernel::avx2:
+        transpose_leaf_avx2(args, row_begin, row_end, column_begin, column_end);
+        break;
+      default:
+        transpose_leaf_sse(args, row_begin, row_end, column_begin, column_end);
+        break;
+    }
+  } else if (num_columns <= max_leaf_columns ||
+             (num_rows > max_leaf_rows && num_rows >= 4 * num_columns)) {
+    const auto row_mid = row_begin + (num_rows / 2 + 7) / 8 * 8;
+    transpose_recursive(kernel, args, row_begin, row_mid, column_begin, column_end);
+    transpose_recursive(kernel, args, row_mid, row_end, column_begin, column_end);
+  } else {
+    const auto column_mid = column_begin + (num_columns / 2 + 7) / 8 * 8;
+    transpose_recursive(kernel, args, row_begin, row_end, column_begin, column_mid);
+    transpose_recursive(kernel, args, row_begin, row_end, column_mid, column_end);
+  }
+}
+
+}  // namespace
+
+void ContiguousBitMatrix::Transpose(const std::byte* input, std::byte* output,
+                                    std::size_t num_rows, std::size_t num_columns,
+                                    BitMatrix::TransposeKernel kernel) {
+  if (num_rows == 0 || num_columns == 0) {
+    return;
+  }
+  const TransposeArguments args{input,       output, num_rows, num_columns, (num_columns + 7) / 8,
+                                (num_rows + 7) / 8};
+  transpose_recursive(resolve_transpose_kernel(kernel), args, 0, num_rows, 0, num_columns);
+}
+
+ContiguousBitMatrix ContiguousBitMatrix::Transposed(BitMatrix::TransposeKernel kernel) const {
+  ContiguousBitMatrix result(num_columns_, num_rows_);
+  Transpose(data_.data(), result.data_.data(), num_rows_, num_columns_, kernel);
+  return result;
+}
+
 }  // namespace ENCRYPTO
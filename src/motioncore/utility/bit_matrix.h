@@ -30,12 +30,20 @@
 #include <stdlib.h>
 #include <cassert>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace ENCRYPTO {
 class PRG;
 
 class BitMatrix {
  public:
+  // SIMD kernels for the transposition and hashing in Sender/ReceiverTransposeAndEncrypt.  All
+  // kernels compute the same outputs, so the two parties of an OT extension may use different ones.
+  // automatic selects the widest kernel supported by the CPU at runtime.
+  enum class TransposeKernel : unsigned int { automatic, sse, avx2, avx512 };
+
   BitMatrix() = default;
 
   BitMatrix(std::size_t rows, std::size_t columns, bool value = false) : num_columns_(columns) {
@@ -109,7 +117,7 @@ class BitMatrix {
 
   void ForceSetNumColumns(std::size_t n) { num_columns_ = n; }
 
-  /// \brief Transposes the matrix inplace
+  /// \brief Transposes the matrix, see ContiguousBitMatrix::Transposed
   void Transpose();
 
   void Transpose128Rows();
@@ -123,12 +131,40 @@ class BitMatrix {
                                         std::vector<BitVector<>>& y0, std::vector<BitVector<>>& y1,
                                         const BitVector<> choices, PRG& prg_fixed_key,
                                         const std::size_t ncols,
-                                        const std::vector<std::size_t>& bitlengths);
+                                        const std::vector<std::size_t>& bitlengths,
+                                        TransposeKernel kernel = TransposeKernel::automatic);
 
   static void ReceiverTransposeAndEncrypt(const std::array<const std::byte*, 128>& matrix,
                                           std::vector<BitVector<>>& out, PRG& prg_fixed_key,
                                           const std::size_t ncols,
-                                          const std::vector<std::size_t>& bitlengths);
+                                          const std::vector<std::size_t>& bitlengths,
+                                          TransposeKernel kernel = TransposeKernel::automatic);
+
+  // Transpose and hash only the columns [column_offset, column_offset + ncols) of the matrix into
+  // the entries with the same indices of the outputs, s.t. disjoint ranges can be processed in
+  // parallel.  The outputs need to have space for the range, only the first num_ots columns of the
+  // matrix are hashed.  column_offset and ncols need to be multiples of 128.
+  static void SenderTransposeAndEncryptRange(const std::array<const std::byte*, 128>& matrix,
+                                             std::vector<BitVector<>>& y0,
+                                             std::vector<BitVector<>>& y1,
+                                             const BitVector<>& choices, PRG& prg_fixed_key,
+                                             const std::size_t column_offset,
+                                             const std::size_t ncols, const std::size_t num_ots,
+                                             const std::vector<std::size_t>& bitlengths,
+                                             TransposeKernel kernel = TransposeKernel::automatic);
+
+  static void ReceiverTransposeAndEncryptRange(const std::array<const std::byte*, 128>& matrix,
+                                               std::vector<BitVector<>>& out, PRG& prg_fixed_key,
+                                               const std::size_t column_offset,
+                                               const std::size_t ncols, const std::size_t num_ots,
+                                               const std::vector<std::size_t>& bitlengths,
+                                               TransposeKernel kernel = TransposeKernel::automatic);
+
+  // check whether the CPU we are running on supports the kernel
+  static bool IsTransposeKernelSupported(TransposeKernel kernel);
+
+  // the widest kernel supported by the CPU, determined once
+  static TransposeKernel GetBestTransposeKernel();
 
   bool operator==(const BitMatrix& other);
 
@@ -143,13 +179,101 @@ class BitMatrix {
 
   std::size_t num_columns_ = 0;
 
-  // blockwise inplace
-  void TransposeInternal();
-
   // blockwise inplace
   void Transpose128RowsInternal();
 
   static void Transpose128x128InPlace(std::array<std::uint64_t*, 128>& rows_64,
                                       std::array<std::uint32_t*, 128>& rows_32);
 };
+
+std::string to_string(BitMatrix::TransposeKernel kernel);
+
+// Bit matrix of arbitrary dimensions stored in a single buffer, row after row, where each row is
+// padded to full bytes and uses the bit order of BitVector.  Used for the general transpositions,
+// e.g., between the wire-major and the SIMD-major layout of the shares of many wires.
+class ContiguousBitMatrix {
+ public:
+  ContiguousBitMatrix() = default;
+
+  ContiguousBitMatrix(std::size_t num_rows, std::size_t num_columns)
+      : num_rows_(num_rows),
+        num_columns_(num_columns),
+        row_stride_((num_columns + 7) / 8),
+        data_(num_rows * row_stride_) {}
+
+  // copy the rows which all need to have the same size
+  template <typename Allocator>
+  explicit ContiguousBitMatrix(const std::vector<BitVector<Allocator>>& rows)
+      : ContiguousBitMatrix(rows.size(), rows.empty() ? 0 : rows.front().GetSize()) {
+    for (std::size_t i = 0; i < num_rows_; ++i) {
+      if (rows[i].GetSize() != num_columns_) {
+        throw std::invalid_argument("ContiguousBitMatrix: rows of different sizes");
+      }
+      std::copy_n(rows[i].GetData().data(), row_stride_, GetRowData(i));
+    }
+  }
+
+  bool Get(std::size_t row_i, std::size_t column_i) const {
+    return (data_[row_i * row_stride_ + column_i / 8] & SET_BIT_MASK[column_i % 8]) != std::byte(0);
+  }
+
+  void Set(std::size_t row_i, std::size_t column_i, bool value) {
+    auto& b = data_[row_i * row_stride_ + column_i / 8];
+    b = value ? (b | SET_BIT_MASK[column_i % 8]) : (b & UNSET_BIT_MASK[column_i % 8]);
+  }
+
+  std::byte* GetRowData(std::size_t row_i) noexcept { return data_.data() + row_i * row_stride_; }
+  const std::byte* GetRowData(std::size_t row_i) const noexcept {
+    return data_.data() + row_i * row_stride_;
+  }
+
+  template <typename Allocator = std_alloc>
+  BitVector<Allocator> GetRow(std::size_t row_i) const {
+    return BitVector<Allocator>(
+        std::vector<std::byte, Allocator>(GetRowData(row_i), GetRowData(row_i) + row_stride_),
+        num_columns_);
+  }
+
+  template <typename Allocator = std_alloc>
+  std::vector<BitVector<Allocator>> GetRows() const {
+    std::vector<BitVector<Allocator>> rows;
+    rows.reserve(num_rows_);
+    for (std::size_t i = 0; i < num_rows_; ++i) {
+      rows.emplace_back(GetRow<Allocator>(i));
+    }
+    return rows;
+  }
+
+  // the transposed matrix, computed with a recursive cache-oblivious algorithm on SIMD tiles
+  ContiguousBitMatrix Transposed(
+      BitMatrix::TransposeKernel kernel = BitMatrix::TransposeKernel::automatic) const;
+
+  // Transpose the num_rows x num_columns matrix at `input` to the num_columns x num_rows matrix at
+  // `output`, both in the layout of this class.  The buffers must not overlap.
+  static void Transpose(const std::byte* input, std::byte* output, std::size_t num_rows,
+                        std::size_t num_columns,
+                        BitMatrix::TransposeKernel kernel = BitMatrix::TransposeKernel::automatic);
+
+  bool operator==(const ContiguousBitMatrix& other) const {
+    return num_rows_ == other.num_rows_ && num_columns_ == other.num_columns_ &&
+           data_ == other.data_;
+  }
+
+  bool operator!=(const ContiguousBitMatrix& other) const { return !(*this == other); }
+
+  auto GetNumRows() const noexcept { return num_rows_; }
+
+  auto GetNumColumns() const noexcept { return num_columns_; }
+
+  // number of bytes from the start of one row to the next
+  auto GetRowStride() const noexcept { return row_stride_; }
+
+  const auto& GetData() const noexcept { return data_; }
+
+ private:
+  std::size_t num_rows_ = 0;
+  std::size_t num_columns_ = 0;
+  std::size_t row_stride_ = 0;
+  std::vector<std::byte> data_;
+};
 }
\ No newline at end of file
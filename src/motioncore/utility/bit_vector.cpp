@@ -23,6 +23,15 @@
 // SOFTWARE.
 
 #include "bit_vector.h"
+
+#include <immintrin.h>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "cpu_features.h"
 #include "crypto/random/aes128_ctr_rng.h"
 
 namespace ENCRYPTO {
@@ -88,59 +97,225 @@ inline bool AlignedEQImpl(const T* ptr1, const U* ptr2, const std::size_t byte_s
   return std::equal(ptr1_cast, ptr1_cast + byte_size, ptr2_cast);
 }
 
+// Vector loops of BitwiseImpl for the CPUs which support them, see MOTION::get_cpu_features().
+// They return the number of bytes they have processed.
+template <typename Op>
+__attribute__((target("avx512f"))) std::size_t BitwiseAVX512(const std::byte* in, std::byte* res,
+                                                             const std::size_t byte_size,
+                                                             Op op) noexcept {
+  std::size_t i = 0;
+  for (; i + 64 <= byte_size; i += 64) {
+    const auto a = _mm512_loadu_si512(res + i);
+    const auto b = _mm512_loadu_si512(in + i);
+    _mm512_storeu_si512(res + i, op(a, b));
+  }
+  for (; i + 32 <= byte_size; i += 32) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(res + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), op(a, b));
+  }
+  return i;
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) std::size_t BitwiseAVX2(const std::byte* in, std::byte* res,
+                                                        const std::size_t byte_size,
+                                                        Op op) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= byte_size; i += 32) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(res + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), op(a, b));
+  }
+  return i;
+}
+
+template <typename Op>
+__attribute__((target("avx512f"))) std::size_t BitwiseAVX512(const std::byte* in1,
+                                                             const std::byte* in2, std::byte* res,
+                                                             const std::size_t byte_size,
+                                                             Op op) noexcept {
+  std::size_t i = 0;
+  for (; i + 64 <= byte_size; i += 64) {
+    const auto a = _mm512_loadu_si512(res + i);
+    const auto b = _mm512_loadu_si512(in1 + i);
+    const auto c = _mm512_loadu_si512(in2 + i);
+    _mm512_storeu_si512(res + i, op(a, b, c));
+  }
+  for (; i + 32 <= byte_size; i += 32) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(res + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in1 + i));
+    const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in2 + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), op(a, b, c));
+  }
+  return i;
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) std::size_t BitwiseAVX2(const std::byte* in1, const std::byte* in2,
+                                                        std::byte* res,
+                                                        const std::size_t byte_size,
+                                                        Op op) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= byte_size; i += 32) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(res + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in1 + i));
+    const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in2 + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), op(a, b, c));
+  }
+  return i;
+}
+
+// Combine the bytes of `res` with those of `in` as res[i] = op(res[i], in[i]) using the widest
+// vector registers supported by the CPU, then 64-bit words and the remaining bytes.
+template <typename Op>
+inline void BitwiseImpl(const std::byte* in, std::byte* res, const std::size_t byte_size,
+                        Op op) noexcept {
+  std::size_t i = 0;
+  if (byte_size >= 32) {
+    const auto& features = MOTION::get_cpu_features();
+    if (features.avx512f) {
+      i = BitwiseAVX512(in, res, byte_size, op);
+    } else if (features.avx2) {
+      i = BitwiseAVX2(in, res, byte_size, op);
+    }
+  }
+  for (; i + 8 <= byte_size; i += 8) {
+    std::uint64_t a, b;
+    std::memcpy(&a, res + i, 8);
+    std::memcpy(&b, in + i, 8);
+    a = op(a, b);
+    std::memcpy(res + i, &a, 8);
+  }
+  for (; i < byte_size; ++i) {
+    res[i] = op(res[i], in[i]);
+  }
+}
+
+// Three operand form of BitwiseImpl: res[i] = op(res[i], in1[i], in2[i]).
+template <typename Op>
+inline void BitwiseImpl(const std::byte* in1, const std::byte* in2, std::byte* res,
+                        const std::size_t byte_size, Op op) noexcept {
+  std::size_t i = 0;
+  if (byte_size >= 32) {
+    const auto& features = MOTION::get_cpu_features();
+    if (features.avx512f) {
+      i = BitwiseAVX512(in1, in2, res, byte_size, op);
+    } else if (features.avx2) {
+      i = BitwiseAVX2(in1, in2, res, byte_size, op);
+    }
+  }
+  for (; i + 8 <= byte_size; i += 8) {
+    std::uint64_t a, b, c;
+    std::memcpy(&a, res + i, 8);
+    std::memcpy(&b, in1 + i, 8);
+    std::memcpy(&c, in2 + i, 8);
+    a = op(a, b, c);
+    std::memcpy(res + i, &a, 8);
+  }
+  for (; i < byte_size; ++i) {
+    res[i] = op(res[i], in1[i], in2[i]);
+  }
+}
+
+// Ops of BitwiseImpl on bytes and 64-bit words, and on the vectors of the AVX loops, which are
+// overloaded with the targets of these loops s.t. no vector is passed to a function compiled
+// without AVX.
+struct XorOp {
+  template <typename T>
+  T operator()(T a, T b) const noexcept {
+    return a ^ b;
+  }
+  __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const noexcept {
+    return _mm256_xor_si256(a, b);
+  }
+  __attribute__((target("avx512f"))) __m512i operator()(__m512i a, __m512i b) const noexcept {
+    return _mm512_xor_si512(a, b);
+  }
+};
+
+struct AndOp {
+  template <typename T>
+  T operator()(T a, T b) const noexcept {
+    return a & b;
+  }
+  __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const noexcept {
+    return _mm256_and_si256(a, b);
+  }
+  __attribute__((target("avx512f"))) __m512i operator()(__m512i a, __m512i b) const noexcept {
+    return _mm512_and_si512(a, b);
+  }
+};
+
+struct OrOp {
+  template <typename T>
+  T operator()(T a, T b) const noexcept {
+    return a | b;
+  }
+  __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const noexcept {
+    return _mm256_or_si256(a, b);
+  }
+  __attribute__((target("avx512f"))) __m512i operator()(__m512i a, __m512i b) const noexcept {
+    return _mm512_or_si512(a, b);
+  }
+};
+
+// y ^ (a & b)
+struct XorAndOp {
+  template <typename T>
+  T operator()(T y, T a, T b) const noexcept {
+    return y ^ (a & b);
+  }
+  __attribute__((target("avx2"))) __m256i operator()(__m256i y, __m256i a,
+                                                     __m256i b) const noexcept {
+    return _mm256_xor_si256(y, _mm256_and_si256(a, b));
+  }
+  __attribute__((target("avx512f"))) __m512i operator()(__m512i y, __m512i a,
+                                                        __m512i b) const noexcept {
+    return _mm512_xor_si512(y, _mm512_and_si512(a, b));
+  }
+};
+
+constexpr XorOp xor_op;
+constexpr AndOp and_op;
+constexpr OrOp or_op;
+
 template <typename T, typename U>
 inline void XORImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{reinterpret_cast<const std::byte*>(in)};
-  auto res_cast{reinterpret_cast<std::byte*>(res)};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a ^ b; });
+  BitwiseImpl(reinterpret_cast<const std::byte*>(in), reinterpret_cast<std::byte*>(res),
+              byte_size, xor_op);
 }
 
-// TODO: check how good this is vectorized
 template <typename T, typename U>
 inline void AlignedXORImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{
-      reinterpret_cast<const std::byte*>(__builtin_assume_aligned(in, MOTION::MOTION_ALIGNMENT))};
-  auto res_cast{
-      reinterpret_cast<std::byte*>(__builtin_assume_aligned(res, MOTION::MOTION_ALIGNMENT))};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a ^ b; });
+  XORImpl(in, res, byte_size);
 }
 
 template <typename T, typename U>
 inline void ANDImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{reinterpret_cast<const std::byte*>(in)};
-  auto res_cast{reinterpret_cast<std::byte*>(res)};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a & b; });
+  BitwiseImpl(reinterpret_cast<const std::byte*>(in), reinterpret_cast<std::byte*>(res),
+              byte_size, and_op);
 }
 
 template <typename T, typename U>
 inline void AlignedANDImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{
-      reinterpret_cast<const std::byte*>(__builtin_assume_aligned(in, MOTION::MOTION_ALIGNMENT))};
-  auto res_cast{
-      reinterpret_cast<std::byte*>(__builtin_assume_aligned(res, MOTION::MOTION_ALIGNMENT))};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a & b; });
+  ANDImpl(in, res, byte_size);
 }
 
 template <typename T, typename U>
 inline void ORImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{reinterpret_cast<const std::byte*>(in)};
-  auto res_cast{reinterpret_cast<std::byte*>(res)};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a | b; });
+  BitwiseImpl(reinterpret_cast<const std::byte*>(in), reinterpret_cast<std::byte*>(res),
+              byte_size, or_op);
 }
 
 template <typename T, typename U>
 inline void AlignedORImpl(const T* in, U* res, const std::size_t byte_size) {
-  const auto in_cast{
-      reinterpret_cast<const std::byte*>(__builtin_assume_aligned(in, MOTION::MOTION_ALIGNMENT))};
-  auto res_cast{
-      reinterpret_cast<std::byte*>(__builtin_assume_aligned(res, MOTION::MOTION_ALIGNMENT))};
-  std::transform(in_cast, in_cast + byte_size, res_cast, res_cast,
-                 [](const std::byte& a, const std::byte& b) { return a | b; });
+  ORImpl(in, res, byte_size);
+}
+
+void XorAndImpl(const std::byte* in1, const std::byte* in2, std::byte* res,
+                const std::size_t byte_size) noexcept {
+  BitwiseImpl(in1, in2, res, byte_size, XorAndOp{});
 }
 
 inline void CopyImpl(const std::size_t from, const std::size_t to, std::byte* src, std::byte* dst) {
@@ -252,6 +427,18 @@ template BitVector<aligned_alloc>::BitVector(const std::vector<std::byte, std_al
                                              std::size_t n_bits);
 template BitVector<aligned_alloc>::BitVector(const std::vector<std::byte, aligned_alloc>& data,
                                              std::size_t n_bits);
+template BitVector<std_alloc>::BitVector(const std::vector<std::byte, arena_alloc>& data,
+                                         std::size_t n_bits);
+template BitVector<arena_alloc>::BitVector(const std::vector<std::byte, std_alloc>& data,
+                                           std::size_t n_bits);
+template BitVector<arena_alloc>::BitVector(const std::vector<std::byte, arena_alloc>& data,
+                                           std::size_t n_bits);
+template BitVector<std_alloc>::BitVector(const std::vector<std::byte, huge_page_alloc>& data,
+                                         std::size_t n_bits);
+template BitVector<huge_page_alloc>::BitVector(const std::vector<std::byte, std_alloc>& data,
+                                               std::size_t n_bits);
+template BitVector<huge_page_alloc>::BitVector(const std::vector<std::byte, huge_page_alloc>& data,
+                                               std::size_t n_bits);
 
 template <typename Allocator>
 BitVector<Allocator>::BitVector(std::vector<std::byte, Allocator>&& data, std::size_t n_bits)
@@ -315,6 +502,16 @@ template bool BitVector<aligned_alloc>::operator!=(const BitVector<std_alloc>& o
     noexcept;
 template bool BitVector<aligned_alloc>::operator!=(const BitVector<aligned_alloc>& other) const
     noexcept;
+template bool BitVector<std_alloc>::operator!=(const BitVector<arena_alloc>& other) const noexcept;
+template bool BitVector<arena_alloc>::operator!=(const BitVector<std_alloc>& other) const noexcept;
+template bool BitVector<arena_alloc>::operator!=(const BitVector<arena_alloc>& other) const
+    noexcept;
+template bool BitVector<std_alloc>::operator!=(const BitVector<huge_page_alloc>& other) const
+    noexcept;
+template bool BitVector<huge_page_alloc>::operator!=(const BitVector<std_alloc>& other) const
+    noexcept;
+template bool BitVector<huge_page_alloc>::operator!=(const BitVector<huge_page_alloc>& other) const
+    noexcept;
 
 template <typename Allocator1>
 template <typename Allocator2>
@@ -333,6 +530,18 @@ template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator&(
     const BitVector<std_alloc>& other) const noexcept;
 template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator&(
     const BitVector<aligned_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator&(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator&(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator&(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator&(
+    const BitVector<huge_page_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator&(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator&(
+    const BitVector<huge_page_alloc>& other) const noexcept;
 
 template <typename Allocator>
 BitVector<Allocator> BitVector<Allocator>::operator&(const BitSpan& bs) const noexcept {
@@ -356,6 +565,18 @@ template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator^(
     const BitVector<std_alloc>& other) const noexcept;
 template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator^(
     const BitVector<aligned_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator^(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator^(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator^(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator^(
+    const BitVector<huge_page_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator^(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator^(
+    const BitVector<huge_page_alloc>& other) const noexcept;
 
 template <typename Allocator>
 BitVector<Allocator> BitVector<Allocator>::operator^(const BitSpan& bs) const noexcept {
@@ -379,6 +600,18 @@ template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator|(
     const BitVector<std_alloc>& other) const noexcept;
 template BitVector<aligned_alloc> BitVector<aligned_alloc>::operator|(
     const BitVector<aligned_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator|(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator|(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<arena_alloc> BitVector<arena_alloc>::operator|(
+    const BitVector<arena_alloc>& other) const noexcept;
+template BitVector<std_alloc> BitVector<std_alloc>::operator|(
+    const BitVector<huge_page_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator|(
+    const BitVector<std_alloc>& other) const noexcept;
+template BitVector<huge_page_alloc> BitVector<huge_page_alloc>::operator|(
+    const BitVector<huge_page_alloc>& other) const noexcept;
 
 template <typename Allocator>
 BitVector<Allocator> BitVector<Allocator>::operator|(const BitSpan& bs) const noexcept {
@@ -404,6 +637,14 @@ template BitVector<std_alloc>& BitVector<std_alloc>::operator=(
     const BitVector<aligned_alloc>& other) noexcept;
 template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator=(
     const BitVector<std_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator=(
+    const BitVector<huge_page_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator=(
+    const BitVector<std_alloc>& other) noexcept;
 
 template <typename Allocator>
 BitVector<Allocator>& BitVector<Allocator>::operator=(BitVector<Allocator>&& other) noexcept {
@@ -433,6 +674,16 @@ template bool BitVector<aligned_alloc>::operator==(const BitVector<std_alloc>& o
     noexcept;
 template bool BitVector<aligned_alloc>::operator==(const BitVector<aligned_alloc>& other) const
     noexcept;
+template bool BitVector<std_alloc>::operator==(const BitVector<arena_alloc>& other) const noexcept;
+template bool BitVector<arena_alloc>::operator==(const BitVector<std_alloc>& other) const noexcept;
+template bool BitVector<arena_alloc>::operator==(const BitVector<arena_alloc>& other) const
+    noexcept;
+template bool BitVector<std_alloc>::operator==(const BitVector<huge_page_alloc>& other) const
+    noexcept;
+template bool BitVector<huge_page_alloc>::operator==(const BitVector<std_alloc>& other) const
+    noexcept;
+template bool BitVector<huge_page_alloc>::operator==(const BitVector<huge_page_alloc>& other) const
+    noexcept;
 
 template <typename Allocator>
 bool BitVector<Allocator>::operator==(const BitSpan& bs) const noexcept {
@@ -494,9 +745,7 @@ BitVector<Allocator1>& BitVector<Allocator1>::operator&=(
 
   Resize(max_bit_size, true);
 
-  for (auto i = 0ull; i < min_byte_size; ++i) {
-    data_vector_.at(i) &= other.GetData().at(i);
-  }
+  ANDImpl(other.data_vector_.data(), data_vector_.data(), min_byte_size);
   return *this;
 }
 
@@ -508,6 +757,18 @@ template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator&=(
     const BitVector<std_alloc>& other) noexcept;
 template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator&=(
     const BitVector<aligned_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator&=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator&=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator&=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator&=(
+    const BitVector<huge_page_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator&=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator&=(
+    const BitVector<huge_page_alloc>& other) noexcept;
 
 template <typename Allocator>
 BitVector<Allocator>& BitVector<Allocator>::operator&=(const BitSpan& bs) noexcept {
@@ -528,10 +789,7 @@ BitVector<Allocator1>& BitVector<Allocator1>::operator^=(
     const BitVector<Allocator2>& other) noexcept {
   auto min_byte_size = std::min(data_vector_.size(), other.data_vector_.size());
 
-  std::transform(data_vector_.cbegin(), data_vector_.cbegin() + min_byte_size,
-                 other.data_vector_.cbegin(), data_vector_.begin(),
-                 [](auto a, auto b) { return a ^ b; });
-
+  XORImpl(other.data_vector_.data(), data_vector_.data(), min_byte_size);
   return *this;
 }
 
@@ -543,6 +801,18 @@ template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator^=(
     const BitVector<std_alloc>& other) noexcept;
 template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator^=(
     const BitVector<aligned_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator^=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator^=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator^=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator^=(
+    const BitVector<huge_page_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator^=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator^=(
+    const BitVector<huge_page_alloc>& other) noexcept;
 
 template <typename Allocator>
 BitVector<Allocator>& BitVector<Allocator>::operator^=(const BitSpan& bs) noexcept {
@@ -567,9 +837,7 @@ BitVector<Allocator1>& BitVector<Allocator1>::operator|=(
 
   Resize(max_bit_size, true);
 
-  for (auto i = 0ull; i < min_byte_size; ++i) {
-    data_vector_.at(i) |= other.GetData().at(i);
-  }
+  ORImpl(other.data_vector_.data(), data_vector_.data(), min_byte_size);
 
   if (min_byte_size == max_byte_size) {
     for (auto i = min_byte_size; i < max_byte_size; ++i) {
@@ -587,6 +855,18 @@ template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator|=(
     const BitVector<std_alloc>& other) noexcept;
 template BitVector<aligned_alloc>& BitVector<aligned_alloc>::operator|=(
     const BitVector<aligned_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator|=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator|=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<arena_alloc>& BitVector<arena_alloc>::operator|=(
+    const BitVector<arena_alloc>& other) noexcept;
+template BitVector<std_alloc>& BitVector<std_alloc>::operator|=(
+    const BitVector<huge_page_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator|=(
+    const BitVector<std_alloc>& other) noexcept;
+template BitVector<huge_page_alloc>& BitVector<huge_page_alloc>::operator|=(
+    const BitVector<huge_page_alloc>& other) noexcept;
 
 template <typename Allocator>
 BitVector<Allocator>& BitVector<Allocator>::operator|=(const BitSpan& bs) noexcept {
@@ -1219,6 +1499,8 @@ void BitVector<Allocator>::BoundsCheckInRange([[maybe_unused]] const std::size_t
 
 template class BitVector<std_alloc>;
 template class BitVector<aligned_alloc>;
+template class BitVector<arena_alloc>;
+template class BitVector<huge_page_alloc>;
 
 template <>
 std::vector<BitVector<std_alloc>> ToInput<float, std::true_type, std_alloc>(float t) {
@@ -1693,4 +1975,130 @@ void BitSpan::Copy(const std::size_t dest_from, BitSpan&& other) {
 
 std::ostream& operator<<(std::ostream& os, const BitSpan& bar) { return os << bar.AsString(); }
 
+namespace {
+
+// Add the set bits of the counter of the words [0, num_words) of a block to the counts, where
+// counter[b * num_words + w] holds bit b of the counts of the 64 positions of word w.
+template <typename T>
+void AddBitSlicedCounts(const std::uint64_t* counter, std::size_t num_counter_bits,
+                        std::size_t num_words, std::size_t num_bits, T* counts) noexcept {
+  for (std::size_t j = 0; j < num_bits; ++j) {
+    const auto word_i = j / 64;
+    const auto bit_i = j % 64;
+    std::uint64_t count = 0;
+    for (std::size_t b = 0; b < num_counter_bits; ++b) {
+      count |= ((counter[b * num_words + word_i] >> bit_i) & 1) << b;
+    }
+    counts[j] += T(count);
+  }
+}
+
+// Vector versions of AccumulateBitCounts, which add blocks of 256 and 512 positions at once and
+// return the end of the blocks they have processed.
+template <typename T>
+__attribute__((target("avx2"))) std::size_t AccumulateBitCountsAVX2(
+    std::span<const std::byte* const> planes, std::size_t begin, std::size_t end,
+    T* counts) noexcept {
+  const auto num_counter_bits = std::bit_width(planes.size());
+  __m256i counter[64];
+  alignas(32) std::array<std::uint64_t, 64 * 4> counter_words;
+  auto block_begin = begin;
+  for (; block_begin + 256 <= end; block_begin += 256) {
+    std::fill_n(counter, num_counter_bits, _mm256_setzero_si256());
+    for (const auto* plane : planes) {
+      auto carry = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(plane + block_begin / 8));
+      for (std::size_t b = 0; !_mm256_testz_si256(carry, carry) && b < num_counter_bits; ++b) {
+        const auto next_carry = _mm256_and_si256(counter[b], carry);
+        counter[b] = _mm256_xor_si256(counter[b], carry);
+        carry = next_carry;
+      }
+    }
+    for (std::size_t b = 0; b < num_counter_bits; ++b) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(&counter_words[b * 4]), counter[b]);
+    }
+    AddBitSlicedCounts(counter_words.data(), num_counter_bits, 4, 256, counts + block_begin);
+  }
+  return block_begin;
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) std::size_t AccumulateBitCountsAVX512(
+    std::span<const std::byte* const> planes, std::size_t begin, std::size_t end,
+    T* counts) noexcept {
+  const auto num_counter_bits = std::bit_width(planes.size());
+  __m512i counter[64];
+  alignas(64) std::array<std::uint64_t, 64 * 8> counter_words;
+  auto block_begin = begin;
+  for (; block_begin + 512 <= end; block_begin += 512) {
+    std::fill_n(counter, num_counter_bits, _mm512_setzero_si512());
+    for (const auto* plane : planes) {
+      auto carry = _mm512_loadu_si512(plane + block_begin / 8);
+      for (std::size_t b = 0; _mm512_test_epi64_mask(carry, carry) != 0 && b < num_counter_bits;
+           ++b) {
+        const auto next_carry = _mm512_and_si512(counter[b], carry);
+        counter[b] = _mm512_xor_si512(counter[b], carry);
+        carry = next_carry;
+      }
+    }
+    for (std::size_t b = 0; b < num_counter_bits; ++b) {
+      _mm512_store_si512(&counter_words[b * 8], counter[b]);
+    }
+    AddBitSlicedCounts(counter_words.data(), num_counter_bits, 8, 512, counts + block_begin);
+  }
+  return block_begin;
+}
+
+}  // namespace
+
+template <typename T>
+void AccumulateBitCounts(std::span<const std::byte* const> planes, std::size_t begin,
+                         std::size_t end, T* counts) noexcept {
+  assert(begin % 8 == 0);
+  // the vector versions need the little-endian layout of the words
+  if constexpr (std::endian::native == std::endian::little) {
+    const auto& features = MOTION::get_cpu_features();
+    if (features.avx512f) {
+      begin = AccumulateBitCountsAVX512(planes, begin, end, counts);
+    }
+    if (features.avx2) {
+      begin = AccumulateBitCountsAVX2(planes, begin, end, counts);
+    }
+  }
+  // counter[b] holds bit b of the count of each of the 64 positions of a word
+  const auto num_counter_bits = std::bit_width(planes.size());
+  std::array<std::uint64_t, 64> counter;
+  for (auto word_begin = begin; word_begin < end; word_begin += 64) {
+    const auto num_bits = std::min<std::size_t>(64, end - word_begin);
+    const auto num_bytes = bits_to_bytes(num_bits);
+    std::fill_n(counter.begin(), num_counter_bits, 0);
+    for (const auto* plane : planes) {
+      // add the word of the plane with a chain of half adders
+      std::uint64_t carry = 0;
+      if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&carry, plane + word_begin / 8, num_bytes);
+      } else {
+        for (std::size_t k = 0; k < num_bytes; ++k) {
+          const auto byte = std::to_integer<std::uint8_t>(plane[word_begin / 8 + k]);
+          carry |= std::uint64_t(byte) << (8 * k);
+        }
+      }
+      for (std::size_t b = 0; carry != 0 && b < num_counter_bits; ++b) {
+        const auto next_carry = counter[b] & carry;
+        counter[b] ^= carry;
+        carry = next_carry;
+      }
+    }
+    AddBitSlicedCounts(counter.data(), num_counter_bits, 1, num_bits, counts + word_begin);
+  }
+}
+
+template void AccumulateBitCounts(std::span<const std::byte* const>, std::size_t, std::size_t,
+                                  std::uint8_t*) noexcept;
+template void AccumulateBitCounts(std::span<const std::byte* const>, std::size_t, std::size_t,
+                                  std::uint16_t*) noexcept;
+template void AccumulateBitCounts(std::span<const std::byte* const>, std::size_t, std::size_t,
+                                  std::uint32_t*) noexcept;
+template void AccumulateBitCounts(std::span<const std::byte* const>, std::size_t, std::size_t,
+                                  std::uint64_t*) noexcept;
+
 }  // namespace ENCRYPTO
@@ -24,18 +24,24 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
 #include <fmt/format.h>
 #include <boost/align/aligned_allocator.hpp>
 
+#include "arena.h"
 #include "config.h"
+#include "constants.h"
 #include "helpers.h"
+#include "huge_page_allocator.h"
+#include "memory_tracker.h"
 
 namespace ENCRYPTO {
 constexpr std::byte SET_BIT_MASK[] = {
@@ -52,10 +58,27 @@ constexpr std::byte TRUNCATION_BIT_MASK[] = {
 
 class BitSpan;
 
-using std_alloc = std::allocator<std::byte>;
-using aligned_alloc = boost::alignment::aligned_allocator<std::byte, MOTION::MOTION_ALIGNMENT>;
-
-template <typename Allocator = std::allocator<std::byte>>
+// res[i] ^= in1[i] & in2[i] for byte_size bytes, see BitVector::XorAnd
+void XorAndImpl(const std::byte* in1, const std::byte* in2, std::byte* res,
+                std::size_t byte_size) noexcept;
+
+// counted by the MemoryTracker if MOTION_MEMORY_TRACKING is enabled
+using std_alloc = std::conditional_t<MOTION::MOTION_MEMORY_TRACKING, CountingAllocator<std::byte>,
+                                     std::allocator<std::byte>>;
+using aligned_alloc = std::conditional_t<
+    MOTION::MOTION_MEMORY_TRACKING,
+    CountingAllocator<std::byte,
+                      boost::alignment::aligned_allocator<std::byte, MOTION::MOTION_ALIGNMENT>>,
+    boost::alignment::aligned_allocator<std::byte, MOTION::MOTION_ALIGNMENT>>;
+// takes the memory from an Arena, copies of such a BitVector use the heap
+using arena_alloc = ArenaAllocator<std::byte>;
+// aligned like aligned_alloc, large vectors are backed by huge pages of the HugePageArena
+using huge_page_alloc =
+    std::conditional_t<MOTION::MOTION_MEMORY_TRACKING,
+                       CountingAllocator<std::byte, HugePageAllocator<std::byte>>,
+                       HugePageAllocator<std::byte>>;
+
+template <typename Allocator = std_alloc>
 class BitVector {
   template <typename Allocator2>
   friend class BitVector;
@@ -64,6 +87,10 @@ class BitVector {
   // Default constructor, results in an empty vector
   BitVector() noexcept : bit_size_(0){};
 
+  // Empty vector which takes its memory from the given allocator
+  explicit BitVector(const Allocator& allocator) noexcept
+      : data_vector_(allocator), bit_size_(0) {}
+
   // Initialized with a single bit
   explicit BitVector(bool value) noexcept
       : data_vector_{value ? SET_BIT_MASK[0] : std::byte(0x00)}, bit_size_(1) {}
@@ -124,7 +151,9 @@ class BitVector {
   /// \brief In-place bit-wise invert
   void Invert();
 
-  static constexpr bool IsAligned() noexcept { return std::is_same_v<Allocator, aligned_alloc>; }
+  static constexpr bool IsAligned() noexcept {
+    return std::is_same_v<Allocator, aligned_alloc> || std::is_same_v<Allocator, huge_page_alloc>;
+  }
 
   BitVector operator~() const;
 
@@ -193,6 +222,15 @@ class BitVector {
 
   BitVector& operator|=(const BitSpan& bs) noexcept;
 
+  // In-place this ^= (a & b) without allocating a temporary for a & b, all three vectors need
+  // to have the same size
+  template <typename Allocator2, typename Allocator3>
+  void XorAnd(const BitVector<Allocator2>& a, const BitVector<Allocator3>& b) noexcept {
+    const auto byte_size =
+        std::min({data_vector_.size(), a.data_vector_.size(), b.data_vector_.size()});
+    XorAndImpl(a.data_vector_.data(), b.data_vector_.data(), data_vector_.data(), byte_size);
+  }
+
   void Resize(std::size_t num_bits, bool zero_fill = false) noexcept;
 
   void Reserve(std::size_t num_bytes) { data_vector_.reserve(num_bytes); }
@@ -201,6 +239,11 @@ class BitVector {
 
   void Append(const BitVector<Allocator>& other) noexcept;
 
+  template <typename Allocator2>
+  void Append(const BitVector<Allocator2>& other) noexcept {
+    Append(other.GetData().data(), other.GetSize());
+  }
+
   void Append(BitVector&& other) noexcept;
 
   void Append(const BitSpan& bs);
@@ -268,26 +311,26 @@ std::ostream& operator<<(std::ostream& os, const BitVector<Allocator>& bar) {
 // BitVectors, which are a suitable input to MOTION
 
 template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 std::vector<BitVector<Allocator>> ToInput(T t);
 
 template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 std::vector<BitVector<Allocator>> ToInput(const std::vector<T>& in_v);
 
 template <typename T, std::enable_if_t<std::is_floating_point_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 std::vector<BitVector<Allocator>> ToInput(T t);
 
 template <typename T, std::enable_if_t<std::is_floating_point_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 std::vector<BitVector<Allocator>> ToInput(const std::vector<T>& t);
 
 // Output functions for converting vectors of BitVectors to vectors of floating point or
 // integer numbers
 
 template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 T ToOutput(std::vector<BitVector<Allocator>> v) {
   static_assert(std::is_integral<T>::value);
   static_assert(sizeof(T) <= 8);
@@ -319,7 +362,7 @@ T ToOutput(std::vector<BitVector<Allocator>> v) {
 }
 
 template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>,
-          typename Allocator = std::allocator<std::byte>>
+          typename Allocator = std_alloc>
 std::vector<T> ToVectorOutput(std::vector<BitVector<Allocator>> v) {
   static_assert(std::is_integral<T>::value);
   static_assert(sizeof(T) <= 8);
@@ -355,6 +398,7 @@ std::vector<T> ToVectorOutput(std::vector<BitVector<Allocator>> v) {
 }
 
 using AlignedBitVector = BitVector<aligned_alloc>;
+using HugePageBitVector = BitVector<huge_page_alloc>;
 
 /// \brief provides a read-write BitVector API over a raw buffer, e.g., std::byte *.
 /// The underlying buffer is not owned by the BitSpan, in contrast to BitVector.
@@ -488,4 +532,14 @@ class BitSpan {
 };
 
 std::ostream& operator<<(std::ostream& os, const BitSpan& bar);
+
+/// \brief Count the set bits of several bit-planes per position, i.e., counts[j] += sum_i
+/// planes[i][j] for j in [begin, end), e.g., to sum the bits of num_wires wires per SIMD value.
+/// The planes are added in words of 64 positions to a bit-sliced counter, s.t. no single bits are
+/// extracted from the planes.  begin needs to be a multiple of 8 and each plane needs to hold at
+/// least end bits.  The counts are computed modulo 2^(8 sizeof(T)).
+template <typename T>
+void AccumulateBitCounts(std::span<const std::byte* const> planes, std::size_t begin,
+                         std::size_t end, T* counts) noexcept;
+
 }  // namespace ENCRYPTO
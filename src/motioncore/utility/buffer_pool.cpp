@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "buffer_pool.h"
+
+#include <utility>
+
+namespace ENCRYPTO {
+
+PooledBuffer::PooledBuffer(Node* node) noexcept : node_(node) {}
+
+PooledBuffer::PooledBuffer(const PooledBuffer& other) noexcept : node_(other.node_) {
+  if (node_ != nullptr) {
+    node_->ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : node_(std::exchange(other.node_, nullptr)) {}
+
+PooledBuffer& PooledBuffer::operator=(const PooledBuffer& other) noexcept {
+  if (this != &other) {
+    PooledBuffer tmp(other);
+    std::swap(node_, tmp.node_);
+  }
+  return *this;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+  if (this != &other) {
+    reset();
+    node_ = std::exchange(other.node_, nullptr);
+  }
+  return *this;
+}
+
+PooledBuffer::~PooledBuffer() { reset(); }
+
+bool PooledBuffer::unique() const noexcept {
+  return node_ != nullptr && node_->ref_count_.load(std::memory_order_acquire) == 1;
+}
+
+std::vector<std::uint8_t> PooledBuffer::release() {
+  if (node_ == nullptr) {
+    return {};
+  }
+  std::vector<std::uint8_t> result;
+  if (unique()) {
+    result = std::move(node_->buffer_);
+    node_->buffer_.clear();
+  } else {
+    result = node_->buffer_;
+  }
+  reset();
+  return result;
+}
+
+void PooledBuffer::reset() noexcept {
+  if (node_ == nullptr) {
+    return;
+  }
+  if (node_->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    auto pool = std::move(node_->pool_);
+    if (pool) {
+      pool->release(node_);
+    } else {
+      delete node_;
+    }
+  }
+  node_ = nullptr;
+}
+
+std::shared_ptr<BufferPool> BufferPool::create(std::size_t max_num_buffers,
+                                               std::size_t max_buffer_capacity) {
+  return std::shared_ptr<BufferPool>(new BufferPool(max_num_buffers, max_buffer_capacity));
+}
+
+BufferPool::BufferPool(std::size_t max_num_buffers, std::size_t max_buffer_capacity)
+    : max_num_buffers_(max_num_buffers), max_buffer_capacity_(max_buffer_capacity) {
+  free_nodes_.reserve(max_num_buffers_);
+}
+
+BufferPool::~BufferPool() {
+  // buffers still in use keep the pool alive, so only the free ones are left
+  for (auto* node : free_nodes_) {
+    delete node;
+  }
+}
+
+PooledBuffer BufferPool::acquire(std::size_t size) {
+  auto* node = take_node(size);
+  node->buffer_.resize(size);
+  return PooledBuffer(node);
+}
+
+PooledBuffer BufferPool::adopt(std::vector<std::uint8_t>&& buffer) {
+  auto* node = take_node(0);
+  node->buffer_ = std::move(buffer);
+  return PooledBuffer(node);
+}
+
+std::size_t BufferPool::get_num_free_buffers() const {
+  std::scoped_lock lock(mutex_);
+  return free_nodes_.size();
+}
+
+BufferPool::Statistics BufferPool::get_statistics() const {
+  std::scoped_lock lock(mutex_);
+  return statistics_;
+}
+
+PooledBuffer::Node* BufferPool::take_node(std::size_t size) {
+  PooledBuffer::Node* node = nullptr;
+  {
+    std::scoped_lock lock(mutex_);
+    if (size > 0) {
+      ++statistics_.num_acquired;
+    }
+    if (!free_nodes_.empty()) {
+      node = free_nodes_.back();
+      free_nodes_.pop_back();
+      if (size > 0 && node->buffer_.capacity() >= size) {
+        ++statistics_.num_reused;
+      }
+    }
+  }
+  if (node == nullptr) {
+    node = new PooledBuffer::Node;
+  }
+  node->ref_count_.store(1, std::memory_order_relaxed);
+  node->pool_ = shared_from_this();
+  return node;
+}
+
+void BufferPool::release(PooledBuffer::Node* node) noexcept {
+  if (node->buffer_.capacity() <= max_buffer_capacity_) {
+    std::scoped_lock lock(mutex_);
+    if (free_nodes_.size() < max_num_buffers_) {
+      free_nodes_.push_back(node);
+      return;
+    }
+  }
+  delete node;
+}
+
+}  // namespace ENCRYPTO
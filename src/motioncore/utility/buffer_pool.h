@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace ENCRYPTO {
+
+class BufferPool;
+
+// Ref-counted handle to a byte buffer taken from a BufferPool.  Copies share the same buffer,
+// which goes back to its pool when the last handle is destroyed.  A default constructed
+// PooledBuffer is empty and belongs to no pool.
+class PooledBuffer {
+ public:
+  PooledBuffer() = default;
+  PooledBuffer(const PooledBuffer& other) noexcept;
+  PooledBuffer(PooledBuffer&& other) noexcept;
+  PooledBuffer& operator=(const PooledBuffer& other) noexcept;
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+  ~PooledBuffer();
+
+  std::uint8_t* data() noexcept { return node_ ? node_->buffer_.data() : nullptr; }
+  const std::uint8_t* data() const noexcept { return node_ ? node_->buffer_.data() : nullptr; }
+  std::size_t size() const noexcept { return node_ ? node_->buffer_.size() : 0; }
+  bool empty() const noexcept { return size() == 0; }
+  std::span<const std::uint8_t> span() const noexcept { return {data(), size()}; }
+
+  // check if no other handle shares the buffer
+  bool unique() const noexcept;
+
+  // Take the content out of the pool: the vector is moved out if this is the only handle and
+  // copied otherwise.  The handle is empty afterwards.
+  std::vector<std::uint8_t> release();
+
+  // drop this handle
+  void reset() noexcept;
+
+ private:
+  friend class BufferPool;
+
+  struct Node {
+    std::atomic<std::size_t> ref_count_ = 0;
+    std::vector<std::uint8_t> buffer_;
+    // keeps the pool alive while the buffer is in use, empty while the node is in the pool
+    std::shared_ptr<BufferPool> pool_;
+  };
+
+  explicit PooledBuffer(Node* node) noexcept;
+
+  Node* node_ = nullptr;
+};
+
+// Thread-safe pool of byte buffers for received messages, such that the receive path does not
+// allocate once the pool has warmed up.  Buffers keep their capacity while they are in the pool.
+// At most max_num_buffers are kept, and buffers larger than max_buffer_capacity are freed when
+// they are released.
+class BufferPool : public std::enable_shared_from_this<BufferPool> {
+ public:
+  static constexpr std::size_t default_max_num_buffers = 1024;
+  static constexpr std::size_t default_max_buffer_capacity = std::size_t(1) << 24;
+
+  static std::shared_ptr<BufferPool> create(
+      std::size_t max_num_buffers = default_max_num_buffers,
+      std::size_t max_buffer_capacity = default_max_buffer_capacity);
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // get a buffer of the given size, its content is unspecified
+  PooledBuffer acquire(std::size_t size);
+
+  // wrap an existing vector without copying it, it is reused by the pool afterwards
+  PooledBuffer adopt(std::vector<std::uint8_t>&& buffer);
+
+  // number of buffers currently waiting in the pool
+  std::size_t get_num_free_buffers() const;
+
+  struct Statistics {
+    std::size_t num_acquired = 0;
+    // acquisitions served by a pooled buffer with sufficient capacity
+    std::size_t num_reused = 0;
+  };
+  Statistics get_statistics() const;
+
+ private:
+  friend class PooledBuffer;
+
+  BufferPool(std::size_t max_num_buffers, std::size_t max_buffer_capacity);
+
+  // take a node from the pool or create a new one
+  PooledBuffer::Node* take_node(std::size_t size);
+  void release(PooledBuffer::Node* node) noexcept;
+
+  const std::size_t max_num_buffers_;
+  const std::size_t max_buffer_capacity_;
+  mutable std::mutex mutex_;
+  std::vector<PooledBuffer::Node*> free_nodes_;
+  Statistics statistics_;
+};
+
+}  // namespace ENCRYPTO
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <string>
@@ -43,6 +45,27 @@ constexpr bool MOTION_VERBOSE_DEBUG_WISH{false};
 // Don't compile unnecessary code if verbose debugging is not needed
 constexpr bool MOTION_VERBOSE_DEBUG{MOTION_DEBUG && MOTION_VERBOSE_DEBUG_WISH};
 
+// Record the time and the communication of each gate with the Statistics::GateProfiler of the
+// backend, without it the hooks in the executor and in the CommMixin are not compiled
+constexpr bool MOTION_GATE_PROFILING{false};
+
+// Record a timeline of the gate phases, messages and future waits with the
+// Statistics::TraceRecorder of the backend, without it the hooks are not compiled
+constexpr bool MOTION_TRACING{false};
+
+// Count the memory of the BitVectors with the ENCRYPTO::MemoryTracker to report its high-water
+// mark per phase in the RunTimeStats, without it the BitVectors use the plain allocators
+constexpr bool MOTION_MEMORY_TRACKING{false};
+
+// Read the hardware performance counters (cycles, instructions, cache and branch misses) with
+// Statistics::HardwareCounters at the phase boundaries of the RunTimeStats, without it the
+// counters are not opened
+constexpr bool MOTION_HARDWARE_COUNTERS{false};
+
+// Write the hot_log() records of the gates to the asynchronous HotPathLogSink, without it the
+// calls are not compiled
+constexpr bool MOTION_HOT_PATH_LOGGING{false};
+
 constexpr std::size_t AES_KEY_SIZE{16};
 
 constexpr std::size_t AES_BLOCK_SIZE_{16};
@@ -60,10 +83,25 @@ constexpr std::size_t kappa{128};
 // stack size for fibers
 constexpr std::size_t MOTION_FIBER_STACK_SIZE{14 * 1024};
 
+// Size classes of the fiber stacks, a gate selects its class with
+// NewGate::get_fiber_stack_class().
+enum class FiberStackClass : std::uint8_t {
+  // local gates with a shallow call stack, e.g., XOR and ADD
+  small,
+  regular,
+  // gates with deep call stacks, e.g., tensor operations and conversions from and to Yao
+  large,
+};
+constexpr std::size_t num_fiber_stack_classes{3};
+using FiberStackSizes = std::array<std::size_t, num_fiber_stack_classes>;
+
+// default stack size of each class
+constexpr FiberStackSizes MOTION_FIBER_STACK_SIZES{8 * 1024, MOTION_FIBER_STACK_SIZE, 64 * 1024};
+
 enum class FiberStackAllocator {
   // standard allocator
   fixedsize,
-  // allocate the stacks from a memory pool
+  // allocate the stacks from a memory pool of the FiberThreadPool
   pooled_fixedsize,
   // use an allocator for fiber stacks that inserts a guard page at the end of
   // the stack space resulting in a SIGSEGV if a stack overflow happens
@@ -71,6 +109,6 @@ enum class FiberStackAllocator {
 };
 
 // standard allocator for fiber stacks
-constexpr FiberStackAllocator MOTION_FIBER_STACK_ALLOCATOR{FiberStackAllocator::fixedsize};
+constexpr FiberStackAllocator MOTION_FIBER_STACK_ALLOCATOR{FiberStackAllocator::pooled_fixedsize};
 
 }  // namespace MOTION
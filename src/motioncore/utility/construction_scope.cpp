@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "construction_scope.h"
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace MOTION {
+
+thread_local ConstructionScope* ConstructionScope::current_ = nullptr;
+
+void ConstructionScope::add_block(ConstructionCounter counter, std::size_t first,
+                                  std::size_t num_ids) {
+  if (mode_ != Mode::blocks) {
+    throw std::logic_error("ConstructionScope: blocks can only be added to a scope in block mode");
+  }
+  const auto i = static_cast<std::size_t>(counter);
+  if (next_[i] != end_[i]) {
+    throw std::logic_error(fmt::format("ConstructionScope: counter {} already has a block", i));
+  }
+  next_[i] = first;
+  end_[i] = first + num_ids;
+  counts_[i] = num_ids;
+}
+
+std::optional<std::size_t> ConstructionScope::take_from_block(ConstructionCounter counter,
+                                                              std::size_t num_ids) {
+  const auto i = static_cast<std::size_t>(counter);
+  if (mode_ == Mode::tally) {
+    counts_[i] += num_ids;
+    return std::nullopt;
+  }
+  if (end_[i] - next_[i] < num_ids) {
+    throw std::logic_error(
+        fmt::format("ConstructionScope: {} ids of counter {} requested, but only {} are left in "
+                    "the block of this thread",
+                    num_ids, i, end_[i] - next_[i]));
+  }
+  const auto id = next_[i];
+  next_[i] += num_ids;
+  return id;
+}
+
+void ConstructionScope::require_serial(const char* what) {
+  if (current_ == nullptr) {
+    return;
+  }
+  if (current_->mode_ == Mode::blocks) {
+    throw std::logic_error(
+        fmt::format("ConstructionScope: {} cannot be made during concurrent construction", what));
+  }
+  if (current_->serial_reason_.empty()) {
+    current_->serial_reason_ = what;
+  }
+}
+
+void ConstructionScope::check_exhausted() const {
+  if (mode_ != Mode::blocks) {
+    return;
+  }
+  for (std::size_t i = 0; i < num_construction_counters; ++i) {
+    if (next_[i] != end_[i]) {
+      throw std::logic_error(
+          fmt::format("ConstructionScope: {} ids of the block of counter {} have not been taken",
+                      end_[i] - next_[i], i));
+    }
+  }
+}
+
+}  // namespace MOTION
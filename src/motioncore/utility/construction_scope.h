@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace MOTION {
+
+// Counters of the ids which are taken while a circuit is built and on which both parties need to
+// agree, e.g., the gate ids or the offsets of the multiplication triples of the gates.
+enum class ConstructionCounter : std::uint8_t {
+  gate_ids,
+  gate_slots,
+  beavy_input_ids,
+  gmw_input_ids,
+  batched_xcot_bits,
+  binary_mts,
+  mts_8,
+  mts_16,
+  mts_32,
+  mts_64,
+  sps_8,
+  sps_16,
+  sps_32,
+  sps_64,
+  sps_128,
+  sbs_8,
+  sbs_16,
+  sbs_32,
+  sbs_64,
+  num_counters
+};
+
+constexpr std::size_t num_construction_counters =
+    static_cast<std::size_t>(ConstructionCounter::num_counters);
+
+// counter of the triples, pairs or bits of type T, where `first` is the one of std::uint8_t
+template <typename T>
+constexpr ConstructionCounter typed_construction_counter(ConstructionCounter first) noexcept {
+  return static_cast<ConstructionCounter>(static_cast<std::size_t>(first) +
+                                          std::countr_zero(sizeof(T)));
+}
+
+// Ids for building a part of a circuit on another thread than the rest of it.
+//
+// The counters of the GateRegister and the providers hand out their ids in the order in which the
+// gates are created, so both parties assign the same ids to the same gates only if they build the
+// circuit in the same order.  To build independent subcircuits concurrently, each of them gets
+// a block of ids of every counter it uses, which the parties take from the counters in the same
+// order on one thread.  A thread which builds a subcircuit enters its scope with a Guard, and
+// take() hands out the ids of the blocks instead of the shared counters, so the ids do not depend
+// on the interleaving of the threads.  A scope in tally mode does not hand out ids, but counts the
+// ids taken by the thread, e.g., while a CircuitTemplate is recorded, which gives the sizes of the
+// blocks.
+//
+// Construction steps which cannot be split into blocks, e.g., registering OTs with the
+// OTProvider, call require_serial(): within a block scope this throws, within a tally scope the
+// reason is kept, s.t. the recorded circuit is only built on one thread.
+class ConstructionScope {
+ public:
+  enum class Mode : std::uint8_t { tally, blocks };
+  using Counts = std::array<std::size_t, num_construction_counters>;
+
+  explicit ConstructionScope(Mode mode) noexcept : mode_(mode) {}
+
+  // enters the scope on the calling thread until the guard is destroyed
+  class Guard {
+   public:
+    explicit Guard(ConstructionScope& scope) noexcept : previous_(current_) { current_ = &scope; }
+    ~Guard() { current_ = previous_; }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+   private:
+    ConstructionScope* previous_;
+  };
+
+  // hand the ids [first, first + num_ids) of the counter to this scope (only in block mode)
+  void add_block(ConstructionCounter counter, std::size_t first, std::size_t num_ids);
+
+  // If the calling thread has entered a scope in block mode, take num_ids consecutive ids from its
+  // block of the counter.  Otherwise, the caller takes them from the shared counter.
+  static std::optional<std::size_t> take(ConstructionCounter counter, std::size_t num_ids) {
+    if (current_ == nullptr) {
+      return std::nullopt;
+    }
+    return current_->take_from_block(counter, num_ids);
+  }
+  // mark a construction step which needs to happen in program order on one thread, `what` is
+  // used in the error message
+  static void require_serial(const char* what);
+  static bool is_active() noexcept { return current_ != nullptr; }
+
+  Mode get_mode() const noexcept { return mode_; }
+  // number of ids of every counter taken within a tally scope
+  const Counts& get_counts() const noexcept { return counts_; }
+  // the first step which requires a serial construction, empty if there is none
+  const std::string& get_serial_reason() const noexcept { return serial_reason_; }
+  // throws if not all ids of the blocks have been taken, i.e., the subcircuit was not built the
+  // same way as the one whose ids have been counted
+  void check_exhausted() const;
+
+ private:
+  std::optional<std::size_t> take_from_block(ConstructionCounter counter, std::size_t num_ids);
+
+  static thread_local ConstructionScope* current_;
+
+  Mode mode_;
+  Counts counts_{};
+  // next id and end of the block of every counter in block mode
+  Counts next_{};
+  Counts end_{};
+  std::string serial_reason_;
+};
+
+}  // namespace MOTION
@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "cpu_features.h"
+
+#include <cstdlib>
+#include <string_view>
+
+namespace MOTION {
+
+namespace {
+
+CpuFeatures detect_cpu_features() noexcept {
+  CpuFeatures features;
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.avx512f = __builtin_cpu_supports("avx512f");
+  features.avx512bw = __builtin_cpu_supports("avx512bw");
+  features.vaes = __builtin_cpu_supports("vaes");
+
+  const char* max_isa = std::getenv("MOTION_MAX_ISA");
+  if (max_isa == nullptr) {
+    return features;
+  }
+  const std::string_view max_isa_sv(max_isa);
+  if (max_isa_sv == "sse" || max_isa_sv == "avx2") {
+    features.avx512f = false;
+    features.avx512bw = false;
+    features.vaes = false;
+  }
+  if (max_isa_sv == "sse") {
+    features.avx2 = false;
+  }
+  return features;
+}
+
+}  // namespace
+
+std::string CpuFeatures::to_string() const {
+  std::string result = "sse";
+  if (avx2) {
+    result += " avx2";
+  }
+  if (avx512f) {
+    result += " avx512f";
+  }
+  if (avx512bw) {
+    result += " avx512bw";
+  }
+  if (vaes) {
+    result += " vaes";
+  }
+  return result;
+}
+
+const CpuFeatures& get_cpu_features() noexcept {
+  static const CpuFeatures features = detect_cpu_features();
+  return features;
+}
+
+}  // namespace MOTION
@@ -1,6 +1,6 @@
 // MIT License
 //
-// Copyright (c) 2020 Lennart Braun
+// Copyright (c) 2021 Lennart Braun
 //
 // Permission is hereby granted, free of charge, to any person obtaining a copy
 // of this software and associated documentation files (the "Software"), to deal
@@ -20,35 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+
 #pragma once
 
-#include <functional>
-#include <memory>
+#include <string>
 
 namespace MOTION {
 
-class Logger;
-class Register;
-
-namespace Statistics {
-struct RunTimeStats;
-}
-
-// Evaluates all registered gates.
-class GateExecutor {
- public:
-  GateExecutor(Register &, std::function<void()> preprocessing_fctn, std::shared_ptr<Logger>);
-
-  // Run the setup phases first for all gates before starting with the online
-  // phases.
-  void evaluate_setup_online(Statistics::RunTimeStats &stats);
-  // Run setup and online phase of each gate as soon as possible.
-  void evaluate(Statistics::RunTimeStats &stats);
-
- private:
-  Register &register_;
-  std::function<void()> preprocessing_fctn_;
-  std::shared_ptr<Logger> logger_;
+// Instruction set extensions of the kernels which have several implementations, e.g., the AES,
+// bit-wise, transpose and bit count kernels.  They are detected once at run time, s.t. a single
+// binary uses AVX-512 and VAES where available and falls back to AVX2 or SSE elsewhere.  The
+// environment variable MOTION_MAX_ISA=sse|avx2|avx512 limits the extensions which are used, e.g.,
+// to compare the kernels on one machine.
+struct CpuFeatures {
+  bool avx2 = false;
+  bool avx512f = false;
+  bool avx512bw = false;
+  bool vaes = false;
+
+  std::string to_string() const;
 };
 
+const CpuFeatures& get_cpu_features() noexcept;
+
 }  // namespace MOTION
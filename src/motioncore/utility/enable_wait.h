@@ -22,50 +22,28 @@
 
 #pragma once
 
-#include <mutex>
-#include "fiber_condition.h"
+#include "parking_flag.h"
 
 namespace ENCRYPTO {
 
 class enable_wait_online {
  public:
-  void set_online_ready() noexcept {
-    {
-      std::scoped_lock lock(online_cond_.GetMutex());
-      online_ready_ = true;
-    }
-    online_cond_.NotifyAll();
-  }
-  void reset_online_ready() noexcept {
-    std::scoped_lock lock(online_cond_.GetMutex());
-    online_ready_ = false;
-  }
-  void wait_online() const noexcept { online_cond_.Wait(); }
+  void set_online_ready() noexcept { online_flag_.Set(); }
+  void reset_online_ready() noexcept { online_flag_.Reset(); }
+  void wait_online() const noexcept { online_flag_.Wait(); }
 
  private:
-  bool online_ready_ = false;
-  ENCRYPTO::FiberCondition online_cond_ =
-      ENCRYPTO::FiberCondition([this] { return online_ready_; });
+  ENCRYPTO::CompactFiberFlag online_flag_;
 };
 
 class enable_wait_setup {
  public:
-  void set_setup_ready() noexcept {
-    {
-      std::scoped_lock lock(setup_cond_.GetMutex());
-      setup_ready_ = true;
-    }
-    setup_cond_.NotifyAll();
-  }
-  void reset_setup_ready() noexcept {
-    std::scoped_lock lock(setup_cond_.GetMutex());
-    setup_ready_ = false;
-  }
-  void wait_setup() const noexcept { setup_cond_.Wait(); }
+  void set_setup_ready() noexcept { setup_flag_.Set(); }
+  void reset_setup_ready() noexcept { setup_flag_.Reset(); }
+  void wait_setup() const noexcept { setup_flag_.Wait(); }
 
  private:
-  bool setup_ready_ = false;
-  ENCRYPTO::FiberCondition setup_cond_ = ENCRYPTO::FiberCondition([this] { return setup_ready_; });
+  ENCRYPTO::CompactFiberFlag setup_flag_;
 };
 
 }  // namespace ENCRYPTO
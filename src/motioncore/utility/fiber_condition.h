@@ -26,7 +26,9 @@
 
 #include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <cstddef>
 #include <functional>
+#include <mutex>
 
 namespace ENCRYPTO {
 
@@ -71,4 +73,47 @@ class FiberCondition {
   const std::function<bool()> condition_function_;
 };
 
+// counter which only grows, e.g. the number of items of a batch which are ready, fibers can wait
+// until it has reached a given value
+class FiberCounter {
+ public:
+  FiberCounter() = default;
+  ~FiberCounter() = default;
+  FiberCounter(FiberCounter &) = delete;
+
+  // raise the counter to value and wake up the waiting fibers, smaller values are ignored
+  void Raise(std::size_t value) {
+    {
+      std::scoped_lock lock(mutex_);
+      if (value <= value_) {
+        return;
+      }
+      value_ = value;
+    }
+    condition_variable_.notify_all();
+  }
+
+  // set the counter back to zero, no fiber shall be waiting
+  void Reset() {
+    std::scoped_lock lock(mutex_);
+    value_ = 0;
+  }
+
+  // block until the counter is at least value
+  void WaitUntil(std::size_t value) const {
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+    condition_variable_.wait(lock, [this, value] { return value_ >= value; });
+  }
+
+  std::size_t Get() const {
+    std::scoped_lock lock(mutex_);
+    return value_;
+  }
+
+ private:
+  mutable boost::fibers::condition_variable condition_variable_;
+  mutable boost::fibers::mutex mutex_;
+  std::size_t value_ = 0;
+};
+
 }  // namespace ENCRYPTO
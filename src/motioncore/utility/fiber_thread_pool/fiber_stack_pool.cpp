@@ -0,0 +1,154 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fiber_stack_pool.hpp"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <new>
+
+namespace ENCRYPTO {
+
+void FiberStackUsage::allocated(MOTION::FiberStackClass stack_class, std::size_t size) noexcept {
+  num_stacks_in_use_.fetch_add(1, std::memory_order_relaxed);
+  num_allocations_[static_cast<std::size_t>(stack_class)].fetch_add(1, std::memory_order_relaxed);
+  const auto bytes_in_use = bytes_in_use_.fetch_add(size, std::memory_order_relaxed) + size;
+  auto peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (peak < bytes_in_use &&
+         !peak_bytes_in_use_.compare_exchange_weak(peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void FiberStackUsage::deallocated(std::size_t size) noexcept {
+  num_stacks_in_use_.fetch_sub(1, std::memory_order_relaxed);
+  bytes_in_use_.fetch_sub(size, std::memory_order_relaxed);
+}
+
+FiberStackStatistics FiberStackUsage::get_statistics() const noexcept {
+  FiberStackStatistics statistics;
+  statistics.num_stacks_in_use = num_stacks_in_use_.load(std::memory_order_relaxed);
+  statistics.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  statistics.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  for (std::size_t class_i = 0; class_i < MOTION::num_fiber_stack_classes; ++class_i) {
+    statistics.num_allocations[class_i] = num_allocations_[class_i].load(std::memory_order_relaxed);
+  }
+  return statistics;
+}
+
+void FiberStackUsage::reset() noexcept {
+  peak_bytes_in_use_ = bytes_in_use_.load();
+  for (auto& num_allocations : num_allocations_) {
+    num_allocations = 0;
+  }
+}
+
+FiberStackPool::FiberStackPool(const MOTION::FiberStackSizes& stack_sizes) {
+  for (std::size_t class_i = 0; class_i < MOTION::num_fiber_stack_classes; ++class_i) {
+    // keep the stack pointers 64 byte aligned
+    const auto stack_size =
+        std::max(stack_sizes[class_i], boost::context::stack_traits::minimum_size());
+    size_classes_[class_i].slot_size_ = (header_size + stack_size + 63) / 64 * 64;
+  }
+}
+
+FiberStackPool::~FiberStackPool() {
+  for (auto& size_class : size_classes_) {
+    for (const auto& chunk : size_class.chunks_) {
+      unmap_chunk(*chunk);
+    }
+  }
+}
+
+void FiberStackPool::add_chunk(std::size_t class_index) {
+  auto& size_class = size_classes_[class_index];
+  const auto num_slots = std::max(std::size_t(1), chunk_size / size_class.slot_size_);
+  const auto size = num_slots * size_class.slot_size_;
+  // the pages are only backed by memory once they are touched by a fiber, i.e., on the NUMA
+  // node of the worker running it
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  auto& chunk = size_class.chunks_.emplace_back(std::make_unique<Chunk>(Chunk{
+      .memory_ = static_cast<std::byte*>(memory), .size_ = size, .class_index_ = class_index}));
+  reserved_bytes_ += size;
+  // hand out the slots in order of their addresses
+  for (std::size_t slot_i = num_slots; slot_i-- > 0;) {
+    auto* slot = chunk->memory_ + slot_i * size_class.slot_size_;
+    *reinterpret_cast<Chunk**>(slot) = chunk.get();
+    size_class.free_slots_.push_back(slot);
+  }
+}
+
+void FiberStackPool::unmap_chunk(const Chunk& chunk) noexcept {
+  munmap(chunk.memory_, chunk.size_);
+  reserved_bytes_ -= chunk.size_;
+}
+
+boost::context::stack_context FiberStackPool::allocate(MOTION::FiberStackClass stack_class) {
+  const auto class_index = static_cast<std::size_t>(stack_class);
+  auto& size_class = size_classes_[class_index];
+  std::byte* slot;
+  {
+    std::scoped_lock lock(size_class.mutex_);
+    if (size_class.free_slots_.empty()) {
+      add_chunk(class_index);
+    }
+    slot = size_class.free_slots_.back();
+    size_class.free_slots_.pop_back();
+    ++(*reinterpret_cast<Chunk**>(slot))->num_in_use_;
+  }
+  boost::context::stack_context sctx;
+  sctx.size = size_class.slot_size_ - header_size;
+  sctx.sp = slot + size_class.slot_size_;
+  return sctx;
+}
+
+void FiberStackPool::deallocate(boost::context::stack_context& sctx) noexcept {
+  auto* slot = static_cast<std::byte*>(sctx.sp) - sctx.size - header_size;
+  auto* chunk = *reinterpret_cast<Chunk**>(slot);
+  auto& size_class = size_classes_[chunk->class_index_];
+  std::scoped_lock lock(size_class.mutex_);
+  --chunk->num_in_use_;
+  size_class.free_slots_.push_back(slot);
+}
+
+void FiberStackPool::release_unused() {
+  for (auto& size_class : size_classes_) {
+    std::scoped_lock lock(size_class.mutex_);
+    const auto is_unused = [](const auto& chunk) { return chunk->num_in_use_ == 0; };
+    if (std::none_of(size_class.chunks_.begin(), size_class.chunks_.end(), is_unused)) {
+      continue;
+    }
+    std::erase_if(size_class.free_slots_,
+                  [](auto* slot) { return (*reinterpret_cast<Chunk**>(slot))->num_in_use_ == 0; });
+    std::erase_if(size_class.chunks_, [this, &is_unused](const auto& chunk) {
+      if (!is_unused(chunk)) {
+        return false;
+      }
+      unmap_chunk(*chunk);
+      return true;
+    });
+  }
+}
+
+}  // namespace ENCRYPTO
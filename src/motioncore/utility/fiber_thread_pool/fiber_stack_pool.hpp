@@ -0,0 +1,169 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FIBER_STACK_POOL_HPP
+#define FIBER_STACK_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/context/stack_traits.hpp>
+
+#include "utility/constants.h"
+
+namespace ENCRYPTO {
+
+// Memory used by the fiber stacks of a FiberThreadPool
+struct FiberStackStatistics {
+  // stacks of the fibers which currently exist
+  std::size_t num_stacks_in_use = 0;
+  std::size_t bytes_in_use = 0;
+  // maximum of bytes_in_use since the statistics have been reset
+  std::size_t peak_bytes_in_use = 0;
+  // memory mapped by the stack pools including the free stacks kept for reuse, 0 for the other
+  // allocators which get each stack from the heap
+  std::size_t bytes_reserved = 0;
+  // stacks handed out for each size class since the statistics have been reset
+  std::array<std::size_t, MOTION::num_fiber_stack_classes> num_allocations{};
+};
+
+// Counts the stacks handed out by the stack allocators of a FiberThreadPool (thread-safe).
+class FiberStackUsage {
+ public:
+  void allocated(MOTION::FiberStackClass stack_class, std::size_t size) noexcept;
+  void deallocated(std::size_t size) noexcept;
+  // all members except bytes_reserved
+  FiberStackStatistics get_statistics() const noexcept;
+  // reset the peak to the current usage and the allocation counters to 0
+  void reset() noexcept;
+
+ private:
+  std::atomic<std::size_t> num_stacks_in_use_ = 0;
+  std::atomic<std::size_t> bytes_in_use_ = 0;
+  std::atomic<std::size_t> peak_bytes_in_use_ = 0;
+  std::array<std::atomic<std::size_t>, MOTION::num_fiber_stack_classes> num_allocations_{};
+};
+
+// Stack allocator for boost::fibers::fiber which records the stacks of another one in a
+// FiberStackUsage.
+template <typename StackAllocator>
+class TrackedStackAllocator {
+ public:
+  using traits_type = typename StackAllocator::traits_type;
+
+  TrackedStackAllocator(StackAllocator allocator, MOTION::FiberStackClass stack_class,
+                        FiberStackUsage& usage)
+      : allocator_(std::move(allocator)), stack_class_(stack_class), usage_(&usage) {}
+
+  MOTION::FiberStackClass get_stack_class() const noexcept { return stack_class_; }
+
+  boost::context::stack_context allocate() {
+    auto sctx = allocator_.allocate();
+    usage_->allocated(stack_class_, sctx.size);
+    return sctx;
+  }
+
+  void deallocate(boost::context::stack_context& sctx) noexcept {
+    usage_->deallocated(sctx.size);
+    allocator_.deallocate(sctx);
+  }
+
+ private:
+  StackAllocator allocator_;
+  MOTION::FiberStackClass stack_class_;
+  FiberStackUsage* usage_;
+};
+
+// Pool of fiber stacks owned by a FiberThreadPool, one for each NUMA node.  The stacks of each
+// size class are cut from chunks mapped from the OS and reused once their fiber has finished.
+// release_unused() returns the chunks whose stacks are all free to the OS, and the pool unmaps
+// all of them when it is destroyed, i.e., no memory is kept after the FiberThreadPool is gone.
+class FiberStackPool {
+ public:
+  explicit FiberStackPool(const MOTION::FiberStackSizes& stack_sizes);
+  // all stacks need to have been returned
+  ~FiberStackPool();
+  FiberStackPool(const FiberStackPool&) = delete;
+  FiberStackPool& operator=(const FiberStackPool&) = delete;
+
+  boost::context::stack_context allocate(MOTION::FiberStackClass stack_class);
+  void deallocate(boost::context::stack_context& sctx) noexcept;
+
+  // unmap the chunks without stacks in use
+  void release_unused();
+  // bytes currently mapped
+  std::size_t get_reserved_bytes() const noexcept { return reserved_bytes_; }
+
+  // stack allocator for boost::fibers::fiber taking the stacks of one class from the pool
+  class Allocator {
+   public:
+    using traits_type = boost::context::stack_traits;
+
+    Allocator(FiberStackPool& pool, MOTION::FiberStackClass stack_class) noexcept
+        : pool_(&pool), stack_class_(stack_class) {}
+
+    boost::context::stack_context allocate() { return pool_->allocate(stack_class_); }
+    void deallocate(boost::context::stack_context& sctx) noexcept { pool_->deallocate(sctx); }
+
+   private:
+    FiberStackPool* pool_;
+    MOTION::FiberStackClass stack_class_;
+  };
+
+ private:
+  // each stack is preceded by a header pointing to its chunk, i.e., it lies behind the end of
+  // the stack which grows downwards
+  static constexpr std::size_t header_size = 64;
+  // chunks hold at least one stack and about this many bytes
+  static constexpr std::size_t chunk_size = std::size_t(1) << 20;
+
+  struct Chunk {
+    std::byte* memory_;
+    std::size_t size_;
+    std::size_t class_index_;
+    std::size_t num_in_use_ = 0;
+  };
+
+  struct SizeClass {
+    // header and stack
+    std::size_t slot_size_ = 0;
+    std::mutex mutex_;
+    std::vector<std::byte*> free_slots_;
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+  };
+
+  // map a new chunk and add its slots to the free ones (with the mutex of the class held)
+  void add_chunk(std::size_t class_index);
+  void unmap_chunk(const Chunk& chunk) noexcept;
+
+  std::array<SizeClass, MOTION::num_fiber_stack_classes> size_classes_;
+  std::atomic<std::size_t> reserved_bytes_ = 0;
+};
+
+}  // namespace ENCRYPTO
+
+#endif  // FIBER_STACK_POOL_HPP
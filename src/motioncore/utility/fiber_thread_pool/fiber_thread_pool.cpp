@@ -29,10 +29,11 @@
 #include <boost/fiber/operations.hpp>
 #include <cassert>
 #include <iostream>
+#include <optional>
 #include <thread>
+#include <utility>
 #include "fiber_thread_pool.hpp"
 #include "pooled_work_stealing.hpp"
-#include "singleton_pooled_fixedsize_stack.hpp"
 #include "utility/constants.h"
 #include "utility/locked_fiber_queue.h"
 #include "utility/thread.h"
@@ -40,16 +41,26 @@
 namespace ENCRYPTO {
 
 FiberThreadPool::FiberThreadPool(std::size_t num_workers, std::size_t num_tasks,
-                                 bool suspend_scheduler)
+                                 bool suspend_scheduler, ThreadPlacement placement,
+                                 const MOTION::FiberStackSizes& stack_sizes)
     : num_workers_(num_workers > 0 ? num_workers : std::thread::hardware_concurrency()),
       running_(false),
       suspend_scheduler_(suspend_scheduler),
-      task_queue_(std::make_unique<boost::fibers::buffered_channel<task_t>>(64)),
+      placement_(placement),
+      stack_sizes_(stack_sizes),
+      stack_usage_(std::make_unique<FiberStackUsage>()),
       worker_barrier_(std::make_unique<boost::fibers::barrier>(num_workers_)) {
   if (num_workers_ == 1) {
     throw std::invalid_argument("FiberThreadPool needs at least two worker threads");
   }
 
+  // every node gets at least one worker
+  const std::size_t num_nodes =
+      placement_ == ThreadPlacement::numa ? std::min(get_numa_node_cpus().size(), num_workers_) : 1;
+  for (std::size_t node = 0; node < num_nodes; ++node) {
+    task_queues_.emplace_back(std::make_unique<boost::fibers::buffered_channel<QueuedTask>>(64));
+  }
+
   (void)num_tasks;
 
   // create the worker threads
@@ -62,11 +73,20 @@ FiberThreadPool::~FiberThreadPool() {
   }
 }
 
-// This function is executed in the worker thread
+// This function is executed in the worker thread, with one stack allocator per FiberStackClass
 template <typename StackAllocator>
 static void worker_fctn(std::shared_ptr<pool_ctx> pool_ctx,
-                        boost::fibers::buffered_channel<FiberThreadPool::task_t>& task_queue,
-                        boost::fibers::barrier& barrier) {
+                        boost::fibers::buffered_channel<FiberThreadPool::QueuedTask>& task_queue,
+                        boost::fibers::barrier& barrier, std::size_t node,
+                        std::optional<std::size_t> cpu,
+                        std::array<StackAllocator, MOTION::num_fiber_stack_classes>
+                            stack_allocators) {
+  // place the thread before it allocates anything, s.t. its memory is local to its node
+  if (cpu) {
+    this_thread_set_affinity(*cpu);
+  }
+  set_this_thread_numa_node(node);
+
   LockedFiberQueue<boost::fibers::fiber> cleanup_channel;
 
   // start cleanup thread for joining the created fibers
@@ -80,25 +100,33 @@ static void worker_fctn(std::shared_ptr<pool_ctx> pool_ctx,
   boost::fibers::use_scheduling_algorithm<pooled_work_stealing>(pool_ctx);
   // (void)pool_ctx;
 
-  FiberThreadPool::task_t task;
-
-  // allocator the the fibers' stacks
-  StackAllocator stack_allocator(
-      std::max(MOTION::MOTION_FIBER_STACK_SIZE, StackAllocator::traits_type::minimum_size()));
-
-  // try to get new tasks from the queue until the channel is closed and empty,
-  // which is the signal to therminate the pool
-  while (task_queue.pop(task) != boost::fibers::channel_op_status::closed) {
-    // create a fiber from the task we retrieved and store its handle
-    // cleanup_channel.enqueue(boost::fibers::fiber(std::allocator_arg_t{}, stack_allocator, task));
-    cleanup_channel.enqueue(
-        boost::fibers::fiber(std::allocator_arg_t{}, stack_allocator, [task = std::move(task), &task_queue] {
+  // create a fiber from the task and store its handle, the fiber continues with the following
+  // tasks in the queue which fit on its stack.  All fibers are spawned before their tasks have
+  // finished, i.e., before the pool is joined, so the channel is still open.
+  std::function<void(FiberThreadPool::QueuedTask&&)> spawn_fiber;
+  spawn_fiber = [&](FiberThreadPool::QueuedTask&& task) {
+    const auto stack_class = task.stack_class_;
+    auto& stack_allocator = stack_allocators[static_cast<std::size_t>(stack_class)];
+    cleanup_channel.enqueue(boost::fibers::fiber(
+        std::allocator_arg_t{}, stack_allocator,
+        [task = std::move(task.task_), stack_class, &task_queue, &spawn_fiber] {
           task();
-          FiberThreadPool::task_t next_task;
+          FiberThreadPool::QueuedTask next_task;
           while (task_queue.try_pop(next_task) == boost::fibers::channel_op_status::success) {
-            next_task();
+            if (next_task.stack_class_ <= stack_class) {
+              next_task.task_();
+            } else {
+              spawn_fiber(std::move(next_task));
+            }
           }
         }));
+  };
+
+  // try to get new tasks from the queue until the channel is closed and empty,
+  // which is the signal to therminate the pool
+  FiberThreadPool::QueuedTask task;
+  while (task_queue.pop(task) != boost::fibers::channel_op_status::closed) {
+    spawn_fiber(std::move(task));
 
     // give another fiber the chance to run
     boost::this_fiber::yield();
@@ -110,6 +138,26 @@ static void worker_fctn(std::shared_ptr<pool_ctx> pool_ctx,
   barrier.wait();
 }
 
+// one allocator per FiberStackClass, make_allocator creates the underlying one for a class
+template <typename StackAllocator, typename MakeAllocator>
+static auto make_stack_allocators(FiberStackUsage& usage, MakeAllocator make_allocator) {
+  return [&]<std::size_t... class_i>(std::index_sequence<class_i...>) {
+    return std::array{TrackedStackAllocator<StackAllocator>(
+        make_allocator(MOTION::FiberStackClass(class_i)), MOTION::FiberStackClass(class_i),
+        usage)...};
+  }(std::make_index_sequence<MOTION::num_fiber_stack_classes>{});
+}
+
+// allocators which get the stacks of each class from the heap
+template <typename StackAllocator>
+static auto make_heap_stack_allocators(FiberStackUsage& usage,
+                                       const MOTION::FiberStackSizes& stack_sizes) {
+  return make_stack_allocators<StackAllocator>(usage, [&stack_sizes](auto stack_class) {
+    return StackAllocator(std::max(stack_sizes[static_cast<std::size_t>(stack_class)],
+                                   StackAllocator::traits_type::minimum_size()));
+  });
+}
+
 void FiberThreadPool::create_threads() {
   assert(worker_threads_.empty());
 
@@ -117,42 +165,105 @@ void FiberThreadPool::create_threads() {
   // schedulers
   pool_ctx_ = pooled_work_stealing::create_pool_ctx(num_workers_, suspend_scheduler_);
 
-  std::function<decltype(worker_fctn<boost::context::fixedsize_stack>)> worker_function;
-  switch (MOTION::MOTION_FIBER_STACK_ALLOCATOR) {
-    case MOTION::FiberStackAllocator::fixedsize:
-      worker_function = worker_fctn<boost::context::fixedsize_stack>;
-      break;
-    case MOTION::FiberStackAllocator::protected_fixedsize:
-      worker_function = worker_fctn<boost::context::protected_fixedsize_stack>;
-      break;
-    case MOTION::FiberStackAllocator::pooled_fixedsize:
-      worker_function =
-          worker_fctn<singleton_pooled_fixedsize_stack<MOTION::MOTION_FIBER_STACK_SIZE>>;
-      break;
+  // keep the stacks on the node of their fibers, except for the debugging allocator
+  auto stack_allocator = MOTION::MOTION_FIBER_STACK_ALLOCATOR;
+  if (placement_ == ThreadPlacement::numa &&
+      stack_allocator != MOTION::FiberStackAllocator::protected_fixedsize) {
+    stack_allocator = MOTION::FiberStackAllocator::pooled_fixedsize;
+  }
+  if (stack_allocator == MOTION::FiberStackAllocator::pooled_fixedsize) {
+    for (std::size_t node = 0; node < get_num_nodes(); ++node) {
+      stack_pools_.emplace_back(std::make_unique<FiberStackPool>(stack_sizes_));
+    }
+  }
+  const auto start_worker = [this](std::size_t node, std::optional<std::size_t> cpu,
+                                   auto stack_allocators) {
+    using allocator_t = typename decltype(stack_allocators)::value_type;
+    return std::thread(worker_fctn<allocator_t>, pool_ctx_, std::ref(*task_queues_[node]),
+                       std::ref(*worker_barrier_), node, cpu, std::move(stack_allocators));
+  };
+
+  const auto& node_cpus = get_numa_node_cpus();
+  std::vector<std::size_t> all_cpus;
+  for (const auto& cpus : node_cpus) {
+    all_cpus.insert(all_cpus.end(), cpus.begin(), cpus.end());
   }
+  const auto num_nodes = get_num_nodes();
 
   // create the worker threads
   worker_threads_.reserve(num_workers_);
   for (std::size_t i = 0; i < num_workers_; ++i) {
-    auto& t = worker_threads_.emplace_back(worker_function, pool_ctx_, std::ref(*task_queue_),
-                                           std::ref(*worker_barrier_));
+    std::size_t node = 0;
+    std::optional<std::size_t> cpu;
+    if (placement_ == ThreadPlacement::numa) {
+      // the workers [first_worker, ...) of the node use its CPUs round-robin
+      node = i * num_nodes / num_workers_;
+      const auto first_worker = (node * num_workers_ + num_nodes - 1) / num_nodes;
+      cpu = node_cpus[node][(i - first_worker) % node_cpus[node].size()];
+    } else if (placement_ == ThreadPlacement::pinned) {
+      cpu = all_cpus[i % all_cpus.size()];
+    }
+    std::thread t;
+    switch (stack_allocator) {
+      case MOTION::FiberStackAllocator::fixedsize:
+        t = start_worker(node, cpu,
+                         make_heap_stack_allocators<boost::context::fixedsize_stack>(
+                             *stack_usage_, stack_sizes_));
+        break;
+      case MOTION::FiberStackAllocator::protected_fixedsize:
+        t = start_worker(node, cpu,
+                         make_heap_stack_allocators<boost::context::protected_fixedsize_stack>(
+                             *stack_usage_, stack_sizes_));
+        break;
+      case MOTION::FiberStackAllocator::pooled_fixedsize:
+        t = start_worker(node, cpu,
+                         make_stack_allocators<FiberStackPool::Allocator>(
+                             *stack_usage_, [this, node](auto stack_class) {
+                               return FiberStackPool::Allocator(*stack_pools_[node], stack_class);
+                             }));
+        break;
+    }
 
     if constexpr (MOTION::MOTION_DEBUG) {
       thread_set_name(t, fmt::format("pool-worker-{}", i));
     }
+    worker_threads_.push_back(std::move(t));
   }
   running_ = true;
 }
 
 void FiberThreadPool::join() {
-  task_queue_->close();
+  for (auto& task_queue : task_queues_) {
+    task_queue->close();
+  }
   std::for_each(worker_threads_.begin(), worker_threads_.end(), [](auto& t) { t.join(); });
   running_ = false;
 }
 
 void FiberThreadPool::post(std::function<void()> fctn) {
+  post(std::move(fctn), placement_ == ThreadPlacement::numa ? get_this_thread_numa_node() : 0);
+}
+
+void FiberThreadPool::post(std::function<void()> fctn, std::size_t node,
+                           MOTION::FiberStackClass stack_class) {
   assert(running_);
-  task_queue_->push(fctn);
+  task_queues_[node % task_queues_.size()]->push(QueuedTask{std::move(fctn), stack_class});
+}
+
+FiberStackStatistics FiberThreadPool::get_stack_statistics() const {
+  auto statistics = stack_usage_->get_statistics();
+  for (const auto& stack_pool : stack_pools_) {
+    statistics.bytes_reserved += stack_pool->get_reserved_bytes();
+  }
+  return statistics;
+}
+
+void FiberThreadPool::reset_stack_statistics() noexcept { stack_usage_->reset(); }
+
+void FiberThreadPool::release_unused_stacks() {
+  for (auto& stack_pool : stack_pools_) {
+    stack_pool->release_unused();
+  }
 }
 
 }  // namespace ENCRYPTO
@@ -26,6 +26,9 @@
 #include <thread>
 #include <vector>
 
+#include "fiber_stack_pool.hpp"
+#include "utility/constants.h"
+
 namespace boost {
 namespace fibers {
 class barrier;
@@ -38,9 +41,26 @@ struct pool_ctx;
 
 namespace ENCRYPTO {
 
+// How the worker threads of a FiberThreadPool are placed on the CPUs
+enum class ThreadPlacement : unsigned int {
+  // leave the placement to the operating system
+  none,
+  // pin the workers round-robin to the CPUs the process may run on
+  pinned,
+  // distribute the workers evenly over the NUMA nodes and pin them to the CPUs of their node:
+  // tasks posted to a node are only taken by its workers, the fiber stacks come from one pool per
+  // node, and idle workers steal fibers from their own node first
+  numa,
+};
+
 class FiberThreadPool {
  public:
   using task_t = std::function<void()>;
+  // a posted task and the size class of the stack of the fiber running it
+  struct QueuedTask {
+    task_t task_;
+    MOTION::FiberStackClass stack_class_ = MOTION::FiberStackClass::regular;
+  };
 
   // Create a thread pool with given number of workers
   // - num_workers
@@ -50,16 +70,40 @@ class FiberThreadPool {
   //   number of tasks that are to be expected
   // - suspend_scheduler
   //   suspend if there is no work to be done
+  // - placement
+  //   how the worker threads are placed on the CPUs
+  // - stack_sizes
+  //   stack size of the fibers of each FiberStackClass
   FiberThreadPool(std::size_t num_workers, std::size_t num_tasks = 0,
-                  bool suspend_scheduler = true);
+                  bool suspend_scheduler = true,
+                  ThreadPlacement placement = ThreadPlacement::none,
+                  const MOTION::FiberStackSizes& stack_sizes = MOTION::MOTION_FIBER_STACK_SIZES);
 
   // Destructor, calls join() if necessary
   ~FiberThreadPool();
 
   // Post a new task to the pool's queue.
   // This may block if the task queue is currently full
+  // With NUMA placement, the task is run on the node of the calling thread if it is a worker of
+  // a pool with NUMA placement, otherwise on node 0.
   void post(task_t task);
 
+  // Post a new task to the queue of the given NUMA node (modulo get_num_nodes()), s.t. it runs
+  // on a worker of this node unless its fiber is stolen by another node.  The task runs on a
+  // stack of the given class or a larger one.
+  void post(task_t task, std::size_t node,
+            MOTION::FiberStackClass stack_class = MOTION::FiberStackClass::regular);
+
+  // Number of NUMA nodes the workers are distributed over, 1 without NUMA placement
+  std::size_t get_num_nodes() const noexcept { return task_queues_.size(); }
+
+  // Memory used by the fiber stacks
+  FiberStackStatistics get_stack_statistics() const;
+  // Reset the peak and the allocation counters of the stack statistics
+  void reset_stack_statistics() noexcept;
+  // Return the pooled stacks which are not in use to the OS
+  void release_unused_stacks();
+
   // Close the pool.  No new tasks can be posted to the pool.
   // Note: Be sure that all previously posted tasks has been completed before
   // you call this method.
@@ -75,7 +119,13 @@ class FiberThreadPool {
   std::size_t num_workers_;
   bool running_;
   bool suspend_scheduler_;
-  std::unique_ptr<boost::fibers::buffered_channel<task_t>> task_queue_;
+  ThreadPlacement placement_;
+  MOTION::FiberStackSizes stack_sizes_;
+  // one queue per NUMA node
+  std::vector<std::unique_ptr<boost::fibers::buffered_channel<QueuedTask>>> task_queues_;
+  // one per NUMA node if the stacks are pooled, they outlive the workers
+  std::vector<std::unique_ptr<FiberStackPool>> stack_pools_;
+  std::unique_ptr<FiberStackUsage> stack_usage_;
   std::unique_ptr<boost::fibers::barrier> worker_barrier_;
   std::vector<std::thread> worker_threads_;
   std::shared_ptr<pool_ctx> pool_ctx_;
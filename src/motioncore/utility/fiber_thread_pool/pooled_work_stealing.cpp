@@ -8,6 +8,7 @@
 
 #include "pooled_work_stealing.hpp"
 
+#include <algorithm>
 #include <random>
 
 #include <boost/assert.hpp>
@@ -16,15 +17,19 @@
 #include <boost/fiber/detail/thread_barrier.hpp>
 #include <boost/fiber/type.hpp>
 
+#include "utility/thread.h"
+
 struct pool_ctx {
   pool_ctx( std::uint32_t thread_count, bool suspend)
-    : thread_count_(thread_count), suspend_(suspend), counter_(0), schedulers_(thread_count, nullptr), barrier_(thread_count) {
+    : thread_count_(thread_count), suspend_(suspend), counter_(0), schedulers_(thread_count, nullptr), nodes_(thread_count, 0), barrier_(thread_count) {
         BOOST_ASSERT( thread_count > 1 );
     }
     const std::uint32_t thread_count_;
     const bool suspend_;
     std::atomic< std::uint32_t >                     counter_;
     std::vector< pooled_work_stealing* >    schedulers_;
+    // NUMA node of the thread of each scheduler
+    std::vector< std::size_t >              nodes_;
     boost::barrier barrier_;
 };
 
@@ -40,7 +45,19 @@ pooled_work_stealing::pooled_work_stealing( std::shared_ptr<pool_ctx> pool_ctx )
         suspend_{ pool_ctx_->suspend_ } {
 
     pool_ctx_->schedulers_[id_] = this;
+    pool_ctx_->nodes_[id_] = ENCRYPTO::get_this_thread_numa_node();
     pool_ctx_->barrier_.wait();
+
+    // if the threads of the pool are spread over several NUMA nodes, steal from the schedulers
+    // of the own node first
+    const auto& nodes = pool_ctx_->nodes_;
+    if ( std::any_of( nodes.begin(), nodes.end(), [&nodes](auto node){ return node != nodes[0]; }) ) {
+        for ( std::uint32_t id = 0; id < thread_count_; ++id) {
+            if ( id != id_ && nodes[id] == nodes[id_]) {
+                local_ids_.push_back( id);
+            }
+        }
+    }
 }
 
 pooled_work_stealing::~pooled_work_stealing() {
@@ -66,22 +83,28 @@ pooled_work_stealing::pick_next() noexcept {
             boost::fibers::context::active()->attach( victim);
         }
     } else {
+        static thread_local std::minstd_rand generator{ std::random_device{}() };
+        if ( ! local_ids_.empty() ) {
+            // the stacks and buffers of the fibers of the same node are local
+            const std::size_t offset = generator() % local_ids_.size();
+            for ( std::size_t i = 0; i < local_ids_.size() && nullptr == victim; ++i) {
+                victim = pool_ctx_->schedulers_[local_ids_[( offset + i) % local_ids_.size()]]->steal();
+            }
+        }
         std::uint32_t id = 0;
         std::size_t count = 0, size = pool_ctx_->schedulers_.size();
-        static thread_local std::minstd_rand generator{ std::random_device{}() };
         std::uniform_int_distribution< std::uint32_t > distribution{
             0, static_cast< std::uint32_t >( thread_count_ - 1) };
-        do {
+        while ( nullptr == victim && count < size) {
             do {
                 ++count;
                 // random selection of one logical cpu
-                // that belongs to the local NUMA node
                 id = distribution( generator);
                 // prevent stealing from own scheduler
             } while ( id == id_);
             // steal context from other scheduler
             victim = pool_ctx_->schedulers_[id]->steal();
-        } while ( nullptr == victim && count < size);
+        }
         if ( nullptr != victim) {
             boost::context::detail::prefetch_range( victim, sizeof( boost::fibers::context) );
             BOOST_ASSERT( ! victim->is_context( boost::fibers::type::pinned_context) );
@@ -39,6 +39,8 @@ private:
 
     std::uint32_t                                           id_;
     std::uint32_t                                           thread_count_;
+    // the other schedulers on the same NUMA node, empty if all are on the same node
+    std::vector< std::uint32_t >                            local_ids_{};
 #ifdef BOOST_FIBERS_USE_SPMC_QUEUE
     boost::fibers::detail::context_spmc_queue               rqueue_{};
 #else
@@ -0,0 +1,349 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fixed_point.h"
+
+#include <immintrin.h>
+#include <type_traits>
+
+#include "cpu_features.h"
+
+namespace MOTION::fixed_point::detail {
+
+namespace {
+
+// The conversions are computed in double precision like the scalar ones, where the floats are
+// converted exactly.  Doubles convert to 32 bit integers directly, and to 64 bit integers with the
+// exponent trick, i.e., the bits of r + 1.5 * 2^52 minus the bits of 1.5 * 2^52 are r for integers
+// |r| < 2^51.  Blocks with values out of these ranges or NaNs are computed with the scalar
+// functions.  The vector loops return the number of values they have processed.
+
+constexpr double magic = 0x1.8p52;
+constexpr std::int64_t magic_bits = 0x4338000000000000;
+constexpr double int32_limit = 0x1p31;
+constexpr double int64_limit = 0x1p51;
+
+template <typename I, typename F>
+void encode_scalar(I* dst, const F* src, std::size_t fractional_bits, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    dst[i] = encode<I, F>(src[i], fractional_bits);
+  }
+}
+
+template <typename I, typename F>
+void decode_scalar(F* dst, const I* src, std::size_t fractional_bits, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    dst[i] = decode<I, F>(src[i], fractional_bits);
+  }
+}
+
+template <typename T>
+void truncate_shared_scalar(T* buffer, std::size_t fractional_bits, std::size_t n,
+                            bool party_0) noexcept {
+  if (party_0) {
+    for (std::size_t i = 0; i < n; ++i) {
+      buffer[i] = buffer[i] >> fractional_bits;
+    }
+  } else {
+    for (std::size_t i = 0; i < n; ++i) {
+      buffer[i] = -((-buffer[i]) >> fractional_bits);
+    }
+  }
+}
+
+template <typename I, typename F>
+__attribute__((target("avx2"))) std::size_t encode_avx2(I* dst, const F* src,
+                                                        std::size_t fractional_bits,
+                                                        std::size_t n) noexcept {
+  const auto scale = _mm256_set1_pd(std::exp2(fractional_bits));
+  const auto half = _mm256_set1_pd(0.5);
+  const auto one = _mm256_set1_pd(1.0);
+  const auto sign_mask = _mm256_set1_pd(-0.0);
+  const auto limit = _mm256_set1_pd(sizeof(I) == 4 ? int32_limit : int64_limit);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x;
+    if constexpr (std::is_same_v<F, float>) {
+      x = _mm256_cvtps_pd(_mm_loadu_ps(src + i));
+    } else {
+      x = _mm256_loadu_pd(src + i);
+    }
+    const auto y = _mm256_mul_pd(x, scale);
+    // round half away from zero like std::lround
+    auto r = _mm256_round_pd(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const auto fraction = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(y, r));
+    const auto sign = _mm256_or_pd(one, _mm256_and_pd(y, sign_mask));
+    r = _mm256_add_pd(r, _mm256_and_pd(_mm256_cmp_pd(fraction, half, _CMP_GE_OQ), sign));
+    if (_mm256_movemask_pd(
+            _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, r), limit, _CMP_NLT_UQ)) != 0) {
+      encode_scalar(dst + i, src + i, fractional_bits, 4);
+      continue;
+    }
+    if constexpr (sizeof(I) == 4) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvttpd_epi32(r));
+    } else {
+      const auto biased = _mm256_castpd_si256(_mm256_add_pd(r, _mm256_set1_pd(magic)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                          _mm256_sub_epi64(biased, _mm256_set1_epi64x(magic_bits)));
+    }
+  }
+  return i;
+}
+
+template <typename I, typename F>
+__attribute__((target("avx512f"))) std::size_t encode_avx512(I* dst, const F* src,
+                                                             std::size_t fractional_bits,
+                                                             std::size_t n) noexcept {
+  const auto scale = _mm512_set1_pd(std::exp2(fractional_bits));
+  const auto half = _mm512_set1_pd(0.5);
+  const auto one = _mm512_set1_epi64(0x3ff0000000000000);
+  const auto sign_mask = _mm512_set1_epi64(std::numeric_limits<std::int64_t>::min());
+  const auto limit = _mm512_set1_pd(sizeof(I) == 4 ? int32_limit : int64_limit);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d x;
+    if constexpr (std::is_same_v<F, float>) {
+      x = _mm512_cvtps_pd(_mm256_loadu_ps(src + i));
+    } else {
+      x = _mm512_loadu_pd(src + i);
+    }
+    const auto y = _mm512_mul_pd(x, scale);
+    // round half away from zero like std::lround
+    auto r = _mm512_roundscale_pd(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const auto away = _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_sub_pd(y, r)), half, _CMP_GE_OQ);
+    const auto sign = _mm512_castsi512_pd(
+        _mm512_or_si512(one, _mm512_and_si512(_mm512_castpd_si512(y), sign_mask)));
+    r = _mm512_mask_add_pd(r, away, r, sign);
+    if (_mm512_cmp_pd_mask(_mm512_abs_pd(r), limit, _CMP_NLT_UQ) != 0) {
+      encode_scalar(dst + i, src + i, fractional_bits, 8);
+      continue;
+    }
+    if constexpr (sizeof(I) == 4) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvttpd_epi32(r));
+    } else {
+      const auto biased = _mm512_castpd_si512(_mm512_add_pd(r, _mm512_set1_pd(magic)));
+      _mm512_storeu_si512(dst + i, _mm512_sub_epi64(biased, _mm512_set1_epi64(magic_bits)));
+    }
+  }
+  return i;
+}
+
+template <typename I, typename F>
+__attribute__((target("avx2"))) std::size_t decode_avx2(F* dst, const I* src,
+                                                        std::size_t fractional_bits,
+                                                        std::size_t n) noexcept {
+  const auto scale = _mm256_set1_pd(std::exp2(-static_cast<double>(fractional_bits)));
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x;
+    if constexpr (sizeof(I) == 4) {
+      x = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    } else {
+      const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      // |v| < 2^51 iff v + 2^51 has no bits above the 52nd
+      const auto offset = _mm256_add_epi64(v, _mm256_set1_epi64x(std::int64_t(1) << 51));
+      if (!_mm256_testz_si256(offset, _mm256_set1_epi64x(-(std::int64_t(1) << 52)))) {
+        decode_scalar(dst + i, src + i, fractional_bits, 4);
+        continue;
+      }
+      x = _mm256_sub_pd(
+          _mm256_castsi256_pd(_mm256_add_epi64(v, _mm256_set1_epi64x(magic_bits))),
+          _mm256_set1_pd(magic));
+    }
+    const auto y = _mm256_mul_pd(x, scale);
+    if constexpr (std::is_same_v<F, float>) {
+      _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(y));
+    } else {
+      _mm256_storeu_pd(dst + i, y);
+    }
+  }
+  return i;
+}
+
+template <typename I, typename F>
+__attribute__((target("avx512f"))) std::size_t decode_avx512(F* dst, const I* src,
+                                                             std::size_t fractional_bits,
+                                                             std::size_t n) noexcept {
+  const auto scale = _mm512_set1_pd(std::exp2(-static_cast<double>(fractional_bits)));
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d x;
+    if constexpr (sizeof(I) == 4) {
+      x = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    } else {
+      const auto v = _mm512_loadu_si512(src + i);
+      const auto offset = _mm512_add_epi64(v, _mm512_set1_epi64(std::int64_t(1) << 51));
+      if (_mm512_test_epi64_mask(offset, _mm512_set1_epi64(-(std::int64_t(1) << 52))) != 0) {
+        decode_scalar(dst + i, src + i, fractional_bits, 8);
+        continue;
+      }
+      x = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_add_epi64(v, _mm512_set1_epi64(magic_bits))),
+                        _mm512_set1_pd(magic));
+    }
+    const auto y = _mm512_mul_pd(x, scale);
+    if constexpr (std::is_same_v<F, float>) {
+      _mm256_storeu_ps(dst + i, _mm512_cvtpd_ps(y));
+    } else {
+      _mm512_storeu_pd(dst + i, y);
+    }
+  }
+  return i;
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t truncate_shared_avx2(T* buffer,
+                                                                 std::size_t fractional_bits,
+                                                                 std::size_t n,
+                                                                 bool party_0) noexcept {
+  constexpr std::size_t lanes = sizeof(__m256i) / sizeof(T);
+  const auto count = _mm_cvtsi64_si128(static_cast<std::int64_t>(fractional_bits));
+  const auto zero = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto* ptr = reinterpret_cast<__m256i*>(buffer + i);
+    auto x = _mm256_loadu_si256(ptr);
+    if constexpr (sizeof(T) == 4) {
+      x = party_0 ? _mm256_srl_epi32(x, count)
+                  : _mm256_sub_epi32(zero, _mm256_srl_epi32(_mm256_sub_epi32(zero, x), count));
+    } else {
+      x = party_0 ? _mm256_srl_epi64(x, count)
+                  : _mm256_sub_epi64(zero, _mm256_srl_epi64(_mm256_sub_epi64(zero, x), count));
+    }
+    _mm256_storeu_si256(ptr, x);
+  }
+  return i;
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) std::size_t truncate_shared_avx512(T* buffer,
+                                                                      std::size_t fractional_bits,
+                                                                      std::size_t n,
+                                                                      bool party_0) noexcept {
+  constexpr std::size_t lanes = sizeof(__m512i) / sizeof(T);
+  const auto count = _mm_cvtsi64_si128(static_cast<std::int64_t>(fractional_bits));
+  const auto zero = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto x = _mm512_loadu_si512(buffer + i);
+    if constexpr (sizeof(T) == 4) {
+      x = party_0 ? _mm512_srl_epi32(x, count)
+                  : _mm512_sub_epi32(zero, _mm512_srl_epi32(_mm512_sub_epi32(zero, x), count));
+    } else {
+      x = party_0 ? _mm512_srl_epi64(x, count)
+                  : _mm512_sub_epi64(zero, _mm512_srl_epi64(_mm512_sub_epi64(zero, x), count));
+    }
+    _mm512_storeu_si512(buffer + i, x);
+  }
+  return i;
+}
+
+template <typename I, typename F>
+void encode_impl(I* dst, const F* src, std::size_t fractional_bits, std::size_t n) {
+  assert(fractional_bits <= bit_size_v<I>);
+  std::size_t i = 0;
+  const auto& features = get_cpu_features();
+  if (features.avx512f) {
+    i = encode_avx512(dst, src, fractional_bits, n);
+  } else if (features.avx2) {
+    i = encode_avx2(dst, src, fractional_bits, n);
+  }
+  encode_scalar(dst + i, src + i, fractional_bits, n - i);
+}
+
+template <typename I, typename F>
+void decode_impl(F* dst, const I* src, std::size_t fractional_bits, std::size_t n) {
+  assert(fractional_bits <= bit_size_v<I>);
+  std::size_t i = 0;
+  const auto& features = get_cpu_features();
+  if (features.avx512f) {
+    i = decode_avx512(dst, src, fractional_bits, n);
+  } else if (features.avx2) {
+    i = decode_avx2(dst, src, fractional_bits, n);
+  }
+  decode_scalar(dst + i, src + i, fractional_bits, n - i);
+}
+
+template <typename T>
+void truncate_shared_impl(T* buffer, std::size_t fractional_bits, std::size_t n, bool party_0) {
+  std::size_t i = 0;
+  const auto& features = get_cpu_features();
+  if (features.avx512f) {
+    i = truncate_shared_avx512(buffer, fractional_bits, n, party_0);
+  } else if (features.avx2) {
+    i = truncate_shared_avx2(buffer, fractional_bits, n, party_0);
+  }
+  truncate_shared_scalar(buffer + i, fractional_bits, n - i, party_0);
+}
+
+}  // namespace
+
+void encode_vectorized(std::uint32_t* dst, const float* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  encode_impl(dst, src, fractional_bits, n);
+}
+
+void encode_vectorized(std::uint32_t* dst, const double* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  encode_impl(dst, src, fractional_bits, n);
+}
+
+void encode_vectorized(std::uint64_t* dst, const float* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  encode_impl(dst, src, fractional_bits, n);
+}
+
+void encode_vectorized(std::uint64_t* dst, const double* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  encode_impl(dst, src, fractional_bits, n);
+}
+
+void decode_vectorized(float* dst, const std::uint32_t* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  decode_impl(dst, src, fractional_bits, n);
+}
+
+void decode_vectorized(double* dst, const std::uint32_t* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  decode_impl(dst, src, fractional_bits, n);
+}
+
+void decode_vectorized(float* dst, const std::uint64_t* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  decode_impl(dst, src, fractional_bits, n);
+}
+
+void decode_vectorized(double* dst, const std::uint64_t* src, std::size_t fractional_bits,
+                       std::size_t n) {
+  decode_impl(dst, src, fractional_bits, n);
+}
+
+void truncate_shared_vectorized(std::uint32_t* buffer, std::size_t fractional_bits,
+                                std::size_t n, bool party_0) {
+  truncate_shared_impl(buffer, fractional_bits, n, party_0);
+}
+
+void truncate_shared_vectorized(std::uint64_t* buffer, std::size_t fractional_bits,
+                                std::size_t n, bool party_0) {
+  truncate_shared_impl(buffer, fractional_bits, n, party_0);
+}
+
+}  // namespace MOTION::fixed_point::detail
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <type_traits>
@@ -41,6 +42,15 @@ constexpr bool check_types_v =
 template <typename T>
 constexpr std::size_t bit_size_v = 8 * sizeof(T);
 
+// the range operations have vectorized versions for these types
+template <typename I>
+constexpr bool is_vectorized_integer_v =
+    std::is_same_v<I, std::uint32_t> || std::is_same_v<I, std::uint64_t>;
+
+template <typename I, typename F>
+constexpr bool is_vectorized_v =
+    is_vectorized_integer_v<I> && (std::is_same_v<F, float> || std::is_same_v<F, double>);
+
 template <typename T>
 T sar(T x, std::size_t n) {
   constexpr T mask = T(1) << (bit_size_v<T> - 1);
@@ -71,11 +81,9 @@ I encode(F x, std::size_t fractional_bits) {
 template <typename I, typename F, typename = std::enable_if_t<check_types_v<I, F>>>
 F decode(I y, std::size_t fractional_bits) {
   assert(fractional_bits <= bit_size_v<I>);
-  if (y < (I(1) << (bit_size_v<I> - 1))) {
-    return double(y) / std::exp2(fractional_bits);
-  } else {
-    return (double(y) - std::exp2(bit_size_v<I>)) / std::exp2(fractional_bits);
-  }
+  // convert the two's complement value with a single rounding, subtracting 2^64 from the rounded
+  // unsigned value would lose the low bits of small negative numbers
+  return double(std::make_signed_t<I>(y)) / std::exp2(fractional_bits);
 }
 
 template <typename I>
@@ -83,24 +91,61 @@ I truncate(I y, std::size_t fractional_bits) {
   return sar(y, fractional_bits);
 }
 
+namespace detail {
+
+// AVX2 and AVX-512 versions of the range operations below for the CPUs which support them, see
+// MOTION::get_cpu_features().  They compute the same results as the scalar functions.
+void encode_vectorized(std::uint32_t* dst, const float* src, std::size_t fractional_bits,
+                       std::size_t n);
+void encode_vectorized(std::uint32_t* dst, const double* src, std::size_t fractional_bits,
+                       std::size_t n);
+void encode_vectorized(std::uint64_t* dst, const float* src, std::size_t fractional_bits,
+                       std::size_t n);
+void encode_vectorized(std::uint64_t* dst, const double* src, std::size_t fractional_bits,
+                       std::size_t n);
+void decode_vectorized(float* dst, const std::uint32_t* src, std::size_t fractional_bits,
+                       std::size_t n);
+void decode_vectorized(double* dst, const std::uint32_t* src, std::size_t fractional_bits,
+                       std::size_t n);
+void decode_vectorized(float* dst, const std::uint64_t* src, std::size_t fractional_bits,
+                       std::size_t n);
+void decode_vectorized(double* dst, const std::uint64_t* src, std::size_t fractional_bits,
+                       std::size_t n);
+void truncate_shared_vectorized(std::uint32_t* buffer, std::size_t fractional_bits,
+                                std::size_t n, bool party_0);
+void truncate_shared_vectorized(std::uint64_t* buffer, std::size_t fractional_bits,
+                                std::size_t n, bool party_0);
+
+}  // namespace detail
+
 // Encode a range of floating point numbers using above encoding algorithm.
 template <typename I, typename F>
 void encode(I* dst, const F* src, std::size_t fractional_bits, std::size_t n) {
-  std::transform(src, src + n, dst,
-                 [fractional_bits](auto x) { return encode(x, fractional_bits); });
+  if constexpr (is_vectorized_v<I, F>) {
+    detail::encode_vectorized(dst, src, fractional_bits, n);
+  } else {
+    std::transform(src, src + n, dst,
+                   [fractional_bits](auto x) { return encode<I, F>(x, fractional_bits); });
+  }
 }
 
 // Decode a range of floating point numbers using above decoding algorithm.
 template <typename I, typename F>
 void decode(F* dst, const I* src, std::size_t fractional_bits, std::size_t n) {
-  std::transform(src, src + n, dst,
-                 [fractional_bits](auto x) { return decode(x, fractional_bits); });
+  if constexpr (is_vectorized_v<I, F>) {
+    detail::decode_vectorized(dst, src, fractional_bits, n);
+  } else {
+    std::transform(src, src + n, dst,
+                   [fractional_bits](auto x) { return decode<I, F>(x, fractional_bits); });
+  }
 }
 
 // Truncation protocol by Mohassel and Zhang (https://eprint.iacr.org/2017/396).
 template <typename T>
 void truncate_shared(T* buffer, std::size_t fractional_bits, std::size_t n, bool party_0) {
-  if (party_0) {
+  if constexpr (is_vectorized_integer_v<T>) {
+    detail::truncate_shared_vectorized(buffer, fractional_bits, n, party_0);
+  } else if (party_0) {
     std::transform(buffer, buffer + n, buffer,
                    [fractional_bits](auto x) { return x >> fractional_bits; });
   } else {
@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "hot_path_log.h"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+#include <fmt/format.h>
+
+#include "utility/thread.h"
+
+namespace MOTION {
+
+HotPathLogSink::HotPathLogSink(std::size_t capacity)
+    : start_time_(std::chrono::steady_clock::now()),
+      mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      slots_(std::make_unique<Slot[]>(mask_ + 1)),
+      output_([](const std::string& line) { std::clog << line << '\n'; }) {
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    slots_[i].sequence_.store(i, std::memory_order_relaxed);
+  }
+  thread_ = std::thread([this] { run(); });
+  ENCRYPTO::thread_set_name(thread_, "hot-path-log");
+}
+
+HotPathLogSink::~HotPathLogSink() {
+  stop_ = true;
+  thread_.join();
+  drain();
+}
+
+HotPathLogSink& HotPathLogSink::get_instance() {
+  static HotPathLogSink instance;
+  return instance;
+}
+
+bool HotPathLogSink::try_push(const char* event,
+                              std::initializer_list<HotLogField> fields) noexcept {
+  // bounded multi-producer queue: a slot can be written if its sequence equals the position
+  auto position = enqueue_position_.load(std::memory_order_relaxed);
+  while (true) {
+    auto& slot = slots_[position & mask_];
+    const auto sequence = slot.sequence_.load(std::memory_order_acquire);
+    const auto difference =
+        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+    if (difference == 0) {
+      if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed)) {
+        auto& record = slot.record_;
+        record.event_ = event;
+        record.time_ = std::chrono::steady_clock::now();
+        record.num_fields_ = static_cast<std::uint8_t>(std::min(fields.size(), max_num_fields));
+        std::copy_n(fields.begin(), record.num_fields_, record.fields_.begin());
+        slot.sequence_.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (difference < 0) {
+      // the consumer has not yet read the record of the previous round
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void HotPathLogSink::set_output(output_function output) {
+  std::scoped_lock lock(drain_mutex_);
+  output_ = std::move(output);
+}
+
+void HotPathLogSink::flush() { drain(); }
+
+void HotPathLogSink::drain() {
+  std::scoped_lock lock(drain_mutex_);
+  while (true) {
+    auto& slot = slots_[dequeue_position_ & mask_];
+    if (slot.sequence_.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+      break;
+    }
+    const auto record = slot.record_;
+    // release the slot for the producers of the next round before formatting
+    slot.sequence_.store(dequeue_position_ + mask_ + 1, std::memory_order_release);
+    ++dequeue_position_;
+
+    const auto time_ms =
+        std::chrono::duration<double, std::milli>(record.time_ - start_time_).count();
+    auto line = fmt::format("[+{:.3f}ms] {}", time_ms, record.event_);
+    for (std::size_t i = 0; i < record.num_fields_; ++i) {
+      line += fmt::format(" {}={}", record.fields_[i].key_, record.fields_[i].value_);
+    }
+    output_(line);
+  }
+}
+
+void HotPathLogSink::run() {
+  while (!stop_) {
+    drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+}  // namespace MOTION
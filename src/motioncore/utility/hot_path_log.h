@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "utility/constants.h"
+
+namespace MOTION {
+
+// Integer value of a hot path log record with its name, which needs to be a string literal.
+struct HotLogField {
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+  constexpr HotLogField(const char* key, T value) noexcept
+      : key_(key), value_(static_cast<std::int64_t>(value)) {}
+  HotLogField() = default;
+
+  const char* key_ = nullptr;
+  std::int64_t value_ = 0;
+};
+
+// Asynchronous sink for log records of the gates and other hot paths.  In contrast to the
+// Logger, writing a record does neither format a string nor take a lock: the event name, which
+// needs to be a string literal, and a few integer fields are copied into a bounded lock-free ring
+// buffer.  A background thread formats them as "[+1.234ms] event key=value ..." lines and passes
+// them to the output, std::clog by default.  If the ring buffer is full, the record is dropped
+// and counted.
+class HotPathLogSink {
+ public:
+  using output_function = std::function<void(const std::string&)>;
+  static constexpr std::size_t max_num_fields = 4;
+  static constexpr std::size_t default_capacity = 1 << 14;
+
+  // the capacity is rounded up to a power of two
+  explicit HotPathLogSink(std::size_t capacity = default_capacity);
+  // writes the remaining records
+  ~HotPathLogSink();
+  HotPathLogSink(const HotPathLogSink&) = delete;
+  HotPathLogSink& operator=(const HotPathLogSink&) = delete;
+
+  // sink used by hot_log(), created on first use
+  static HotPathLogSink& get_instance();
+
+  // can be called concurrently from all threads, only the first max_num_fields fields are kept
+  bool try_push(const char* event, std::initializer_list<HotLogField> fields) noexcept;
+
+  // e.g., forward the lines to a Logger
+  void set_output(output_function);
+  // write all records pushed so far
+  void flush();
+
+  std::size_t get_num_dropped() const noexcept {
+    return num_dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Record {
+    const char* event_;
+    std::chrono::steady_clock::time_point time_;
+    std::uint8_t num_fields_;
+    std::array<HotLogField, max_num_fields> fields_;
+  };
+  struct Slot {
+    std::atomic<std::size_t> sequence_;
+    Record record_;
+  };
+  void drain();
+  void run();
+
+  const std::chrono::steady_clock::time_point start_time_;
+  std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<std::size_t> enqueue_position_{0};
+  alignas(64) std::atomic<std::size_t> num_dropped_{0};
+
+  // protects the consumer side, i.e., the dequeue position and the output
+  std::mutex drain_mutex_;
+  std::size_t dequeue_position_ = 0;
+  output_function output_;
+
+  std::atomic<bool> stop_ = false;
+  std::thread thread_;
+};
+
+// Log an event from a hot path, e.g., inside the evaluate_setup/evaluate_online of a gate:
+//   hot_log("BooleanBEAVYANDGate::evaluate_setup", {{"gate_id", gate_id_}, {"num_simd", n}});
+// Compiled out unless MOTION_HOT_PATH_LOGGING is enabled.
+inline void hot_log([[maybe_unused]] const char* event,
+                    [[maybe_unused]] std::initializer_list<HotLogField> fields = {}) noexcept {
+  if constexpr (MOTION_HOT_PATH_LOGGING) {
+    HotPathLogSink::get_instance().try_push(event, fields);
+  }
+}
+
+}  // namespace MOTION
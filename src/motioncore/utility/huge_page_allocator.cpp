@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "huge_page_allocator.h"
+
+#include <sys/mman.h>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+namespace ENCRYPTO {
+
+namespace {
+
+constexpr std::size_t round_up(std::size_t num_bytes, std::size_t page_size) noexcept {
+  return (num_bytes + page_size - 1) / page_size * page_size;
+}
+
+void* heap_allocate(std::size_t num_bytes) {
+  return ::operator new(num_bytes, std::align_val_t(MOTION::MOTION_ALIGNMENT));
+}
+
+void heap_deallocate(void* p) noexcept {
+  ::operator delete(p, std::align_val_t(MOTION::MOTION_ALIGNMENT));
+}
+
+}  // namespace
+
+HugePageArena& HugePageArena::get_instance() noexcept {
+  // never destroyed, since containers in other static objects may free their buffers later
+  static auto* instance = new HugePageArena;
+  return *instance;
+}
+
+void HugePageArena::set_mode(HugePageMode mode) { mode_ = mode; }
+
+HugePageMode HugePageArena::get_mode() const { return mode_; }
+
+void HugePageArena::set_min_size(std::size_t num_bytes) {
+  if (num_bytes == 0) {
+    throw std::invalid_argument("HugePageArena: minimal size must not be 0");
+  }
+  min_size_ = num_bytes;
+}
+
+void HugePageArena::set_max_cached_bytes(std::size_t num_bytes) {
+  std::scoped_lock lock(mutex_);
+  max_cached_bytes_ = num_bytes;
+}
+
+void* HugePageArena::allocate(std::size_t num_bytes) {
+  const HugePageMode mode = mode_;
+  if (mode == HugePageMode::disabled || num_bytes < min_size_) {
+    return heap_allocate(num_bytes);
+  }
+  {
+    std::scoped_lock lock(mutex_);
+    if (mode == HugePageMode::transparent) {
+      if (auto p = reuse(round_up(num_bytes, huge_page_size), false); p != nullptr) {
+        return p;
+      }
+    } else {
+      const auto page_size =
+          mode == HugePageMode::explicit_1g ? gigantic_page_size : huge_page_size;
+      if (auto p = reuse(round_up(num_bytes, page_size), true); p != nullptr) {
+        return p;
+      }
+      // the reserved huge pages have run out before, so take a fallback mapping
+      if (statistics_.num_fallbacks > 0) {
+        if (auto p = reuse(round_up(num_bytes, huge_page_size), false); p != nullptr) {
+          return p;
+        }
+      }
+    }
+  }
+
+  // fault in the pages outside of the lock
+  Mapping mapping;
+  auto p = map(num_bytes, mode, mapping);
+  if (p == nullptr) {
+    return heap_allocate(num_bytes);
+  }
+  std::scoped_lock lock(mutex_);
+  buffers_.emplace(p, mapping);
+  ++num_buffers_;
+  statistics_.num_mapped_bytes += mapping.size;
+  ++statistics_.num_mapped_buffers;
+  if (mapping.is_explicit) {
+    ++statistics_.num_explicit_buffers;
+  } else if (mode != HugePageMode::transparent) {
+    ++statistics_.num_fallbacks;
+  }
+  return p;
+}
+
+void* HugePageArena::reuse(std::size_t size, bool is_explicit) {
+  auto it = cache_.find({size, is_explicit});
+  if (it == cache_.end()) {
+    return nullptr;
+  }
+  auto p = it->second;
+  const Mapping mapping{size, is_explicit};
+  cache_.erase(it);
+  buffers_.emplace(p, mapping);
+  ++num_buffers_;
+  statistics_.num_cached_bytes -= mapping.size;
+  statistics_.num_mapped_bytes += mapping.size;
+  ++statistics_.num_mapped_buffers;
+  ++statistics_.num_reused_buffers;
+  return p;
+}
+
+void HugePageArena::deallocate(void* p, std::size_t) noexcept {
+  if (num_buffers_ == 0) {
+    heap_deallocate(p);
+    return;
+  }
+  std::unique_lock lock(mutex_);
+  auto it = buffers_.find(p);
+  if (it == buffers_.end()) {
+    lock.unlock();
+    heap_deallocate(p);
+    return;
+  }
+  const auto mapping = it->second;
+  buffers_.erase(it);
+  --num_buffers_;
+  statistics_.num_mapped_bytes -= mapping.size;
+  if (statistics_.num_cached_bytes + mapping.size <= max_cached_bytes_) {
+    cache_.emplace(std::make_pair(mapping.size, mapping.is_explicit), p);
+    statistics_.num_cached_bytes += mapping.size;
+    return;
+  }
+  lock.unlock();
+  unmap(p, mapping);
+}
+
+void HugePageArena::release() noexcept {
+  decltype(cache_) cache;
+  {
+    std::scoped_lock lock(mutex_);
+    cache.swap(cache_);
+    statistics_.num_cached_bytes = 0;
+  }
+  for (const auto& [key, p] : cache) {
+    unmap(p, {key.first, key.second});
+  }
+}
+
+HugePageStatistics HugePageArena::get_statistics() const {
+  std::scoped_lock lock(mutex_);
+  return statistics_;
+}
+
+void* HugePageArena::map(std::size_t num_bytes, [[maybe_unused]] HugePageMode mode,
+                         Mapping& mapping) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  if (mode == HugePageMode::explicit_2m || mode == HugePageMode::explicit_1g) {
+    const bool gigantic = mode == HugePageMode::explicit_1g;
+    const auto size = round_up(num_bytes, gigantic ? gigantic_page_size : huge_page_size);
+    const int page_shift = gigantic ? 30 : 21;
+    auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT),
+                    -1, 0);
+    if (p != MAP_FAILED) {
+      mapping = {size, true};
+      return p;
+    }
+  }
+#endif
+
+  // transparent huge pages are only used for the aligned parts of a mapping, so map an extra
+  // huge page and trim the unaligned ends
+  const auto size = round_up(num_bytes, huge_page_size);
+  const auto reserved_size = size + huge_page_size;
+  auto reserved = ::mmap(nullptr, reserved_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED) {
+    return nullptr;
+  }
+  const auto begin = reinterpret_cast<std::uintptr_t>(reserved);
+  const auto aligned_begin = round_up(begin, huge_page_size);
+  if (aligned_begin != begin) {
+    ::munmap(reserved, aligned_begin - begin);
+  }
+  const auto end = begin + reserved_size;
+  if (aligned_begin + size != end) {
+    ::munmap(reinterpret_cast<void*>(aligned_begin + size), end - aligned_begin - size);
+  }
+  auto p = reinterpret_cast<void*>(aligned_begin);
+#ifdef MADV_HUGEPAGE
+  // fails if transparent huge pages are not supported, the mapping is still usable
+  ::madvise(p, size, MADV_HUGEPAGE);
+#endif
+  mapping = {size, false};
+  return p;
+}
+
+void HugePageArena::unmap(void* p, const Mapping& mapping) noexcept {
+  ::munmap(p, mapping.size);
+}
+
+}  // namespace ENCRYPTO
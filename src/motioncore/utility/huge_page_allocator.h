@@ -0,0 +1,163 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "config.h"
+
+namespace ENCRYPTO {
+
+// Kind of pages the HugePageArena maps its buffers with.  The explicit huge pages need to be
+// reserved by the administrator, e.g., via /proc/sys/vm/nr_hugepages or the hugepagesz kernel
+// parameter for 1 GiB pages.
+enum class HugePageMode : std::uint8_t {
+  // every buffer comes from the heap
+  disabled,
+  // anonymous mappings which are advised to be backed by transparent huge pages
+  transparent,
+  // reserved 2 MiB pages, falls back to transparent huge pages
+  explicit_2m,
+  // reserved 1 GiB pages, falls back to transparent huge pages
+  explicit_1g,
+};
+
+struct HugePageStatistics {
+  // buffers which have been mapped, including those taken from the cache
+  std::size_t num_mapped_buffers = 0;
+  // buffers which have been backed by reserved huge pages
+  std::size_t num_explicit_buffers = 0;
+  // buffers which should have been backed by reserved huge pages, but none were available
+  std::size_t num_fallbacks = 0;
+  // buffers which have been taken from the cache
+  std::size_t num_reused_buffers = 0;
+  // bytes mapped by the buffers in use
+  std::size_t num_mapped_bytes = 0;
+  // bytes mapped by the buffers in the cache
+  std::size_t num_cached_bytes = 0;
+};
+
+// Process wide source of large buffers, e.g., for the OT extension matrices or long BitVectors,
+// which are backed by huge pages to reduce the TLB misses of sweeps over them.  Every buffer of at
+// least the minimal size gets its own mapping which is rounded up to whole huge pages, smaller
+// buffers and every buffer in the disabled mode come from the heap.  If huge pages cannot be
+// used, the buffers are backed by normal pages, so enabling the arena never breaks a run.
+// Freed mappings are cached for buffers of the same size, since faulting in fresh huge pages
+// costs more than a pass over them; release() unmaps the cache.
+class HugePageArena {
+ public:
+  static constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+  static constexpr std::size_t gigantic_page_size = std::size_t(1) << 30;
+  static constexpr std::size_t default_min_size = huge_page_size / 2;
+  static constexpr std::size_t default_max_cached_bytes = std::size_t(1) << 30;
+
+  static HugePageArena& get_instance() noexcept;
+
+  HugePageArena(const HugePageArena&) = delete;
+  HugePageArena& operator=(const HugePageArena&) = delete;
+
+  // changes apply to subsequent allocations, buffers in use keep their pages
+  void set_mode(HugePageMode mode);
+  HugePageMode get_mode() const;
+  // smallest buffer which is mapped
+  void set_min_size(std::size_t num_bytes);
+  // limit of the bytes in the cache, set to 0 to unmap every buffer when it is freed
+  void set_max_cached_bytes(std::size_t num_bytes);
+
+  // get num_bytes of memory aligned to at least MOTION_ALIGNMENT
+  void* allocate(std::size_t num_bytes);
+  void deallocate(void* p, std::size_t num_bytes) noexcept;
+
+  // unmap the cached buffers
+  void release() noexcept;
+
+  HugePageStatistics get_statistics() const;
+
+ private:
+  HugePageArena() = default;
+
+  struct Mapping {
+    std::size_t size;
+    bool is_explicit;
+  };
+
+  // returns nullptr if no mapping could be created
+  static void* map(std::size_t num_bytes, HugePageMode mode, Mapping& mapping);
+  // takes a cached mapping of the given kind, the mutex needs to be held
+  void* reuse(std::size_t size, bool is_explicit);
+  static void unmap(void* p, const Mapping& mapping) noexcept;
+
+  // the settings and the number of mappings in use are read without the lock, s.t. buffers
+  // from the heap do not contend for it
+  std::atomic<HugePageMode> mode_{HugePageMode::disabled};
+  std::atomic<std::size_t> min_size_{default_min_size};
+  std::atomic<std::size_t> num_buffers_{0};
+  mutable std::mutex mutex_;
+  std::size_t max_cached_bytes_ = default_max_cached_bytes;
+  std::unordered_map<void*, Mapping> buffers_;
+  // freed mappings by their size and whether they are backed by reserved huge pages
+  std::multimap<std::pair<std::size_t, bool>, void*> cache_;
+  HugePageStatistics statistics_;
+};
+
+// Stateless allocator for containers which takes its memory from the HugePageArena, e.g., as the
+// Allocator of a BitVector.  Every allocation is aligned to MOTION_ALIGNMENT like the ones of the
+// aligned_allocator, so such containers can be used with the aligned SIMD code.
+template <typename T>
+class HugePageAllocator {
+ public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  HugePageAllocator() noexcept = default;
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    static_assert(alignof(T) <= MOTION::MOTION_ALIGNMENT);
+    return static_cast<T*>(HugePageArena::get_instance().allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    HugePageArena::get_instance().deallocate(p, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+}  // namespace ENCRYPTO
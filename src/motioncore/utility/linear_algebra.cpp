@@ -22,18 +22,220 @@
 
 #include "linear_algebra.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
 
+#define EIGEN_USE_THREADS
 #include <Eigen/Core>
 #include <unsupported/Eigen/CXX11/Tensor>
 
 #include "tensor/tensor_op.h"
 
+#ifdef MOTION_USE_CUDA
+#include "linear_algebra_gpu.h"
+#endif
+
 namespace MOTION {
 
+namespace {
+
+struct LinearAlgebraThreadPool {
+  LinearAlgebraThreadPool(std::size_t num_threads)
+      : pool_(num_threads), device_(&pool_, num_threads) {}
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+// operations with fewer multiplications are not worth distributing over the threads
+constexpr std::size_t min_parallel_work = std::size_t(1) << 16;
+
+std::atomic<std::size_t> linear_algebra_num_threads = 1;
+std::mutex linear_algebra_thread_pool_mutex;
+// shared s.t. a running operation keeps its pool alive if the number of threads is changed
+std::shared_ptr<LinearAlgebraThreadPool> linear_algebra_thread_pool;
+
+// get the thread pool if an operation with `work` multiplications should be run in parallel
+std::shared_ptr<LinearAlgebraThreadPool> get_thread_pool(std::size_t work) {
+  if (linear_algebra_num_threads.load(std::memory_order_relaxed) == 1 ||
+      work < min_parallel_work) {
+    return nullptr;
+  }
+  std::scoped_lock lock(linear_algebra_thread_pool_mutex);
+  return linear_algebra_thread_pool;
+}
+
+// operations with at least this many multiplications run on the GPU, 0 if it is disabled
+std::atomic<std::size_t> linear_algebra_gpu_min_work = 0;
+
+template <typename T>
+constexpr bool is_gpu_type_v = std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>;
+
+template <typename T>
+bool use_gpu(std::size_t work) noexcept {
+  if constexpr (is_gpu_type_v<T>) {
+    const auto min_work = linear_algebra_gpu_min_work.load(std::memory_order_relaxed);
+    return min_work > 0 && work >= min_work;
+  } else {
+    return false;
+  }
+}
+
+std::size_t get_matrix_multiply_work(const tensor::GemmOp& gemm_op) noexcept {
+  return gemm_op.output_shape_[0] * gemm_op.output_shape_[1] *
+         (gemm_op.transA_ ? gemm_op.input_A_shape_[0] : gemm_op.input_A_shape_[1]);
+}
+
+std::size_t get_convolution_work(const tensor::Conv2DOp& conv_op) noexcept {
+  return conv_op.compute_output_size() * conv_op.compute_kernel_matrix_shape().second;
+}
+
+// compute op(A) * op(B) on the GPU if it is enabled for products of this size
+template <typename T>
+bool try_matrix_multiply_gpu([[maybe_unused]] const T* A, [[maybe_unused]] std::size_t rows_A,
+                             [[maybe_unused]] std::size_t cols_A, [[maybe_unused]] bool trans_A,
+                             [[maybe_unused]] const T* B, [[maybe_unused]] std::size_t rows_B,
+                             [[maybe_unused]] std::size_t cols_B, [[maybe_unused]] bool trans_B,
+                             [[maybe_unused]] T* output, std::size_t work) {
+  if (!use_gpu<T>(work)) {
+    return false;
+  }
+#ifdef MOTION_USE_CUDA
+  if constexpr (is_gpu_type_v<T>) {
+    gpu::matrix_multiply(A, rows_A, cols_A, trans_A, B, rows_B, cols_B, trans_B, output);
+    return true;
+  }
+#endif
+  return false;
+}
+
+template <typename T>
+bool try_convolution_gpu(const tensor::Conv2DOp& conv_op, [[maybe_unused]] const T* input,
+                         [[maybe_unused]] const T* kernel, [[maybe_unused]] T* output) {
+  if (!use_gpu<T>(get_convolution_work(conv_op))) {
+    return false;
+  }
+#ifdef MOTION_USE_CUDA
+  if constexpr (is_gpu_type_v<T>) {
+    const gpu::ConvolutionShape shape = {.batch_size = conv_op.batch_size_,
+                                         .in_channels = conv_op.input_shape_[0],
+                                         .in_rows = conv_op.input_shape_[1],
+                                         .in_columns = conv_op.input_shape_[2],
+                                         .out_channels = conv_op.output_shape_[0],
+                                         .out_rows = conv_op.output_shape_[1],
+                                         .out_columns = conv_op.output_shape_[2],
+                                         .kernel_rows = conv_op.kernel_shape_[2],
+                                         .kernel_columns = conv_op.kernel_shape_[3],
+                                         .stride_rows = conv_op.strides_[0],
+                                         .stride_columns = conv_op.strides_[1],
+                                         .dilation_rows = conv_op.dilations_[0],
+                                         .dilation_columns = conv_op.dilations_[1],
+                                         .pad_top = conv_op.pads_[0],
+                                         .pad_left = conv_op.pads_[1]};
+    gpu::convolution(shape, input, kernel, output);
+    return true;
+  }
+#endif
+  return false;
+}
+
+}  // namespace
+
+void set_linear_algebra_num_threads(std::size_t num_threads) {
+  if (num_threads == 0) {
+    throw std::invalid_argument("number of threads must be positive");
+  }
+  std::scoped_lock lock(linear_algebra_thread_pool_mutex);
+  if (num_threads == linear_algebra_num_threads) {
+    return;
+  }
+  if (num_threads == 1) {
+    linear_algebra_thread_pool = nullptr;
+  } else {
+    linear_algebra_thread_pool = std::make_shared<LinearAlgebraThreadPool>(num_threads);
+  }
+  linear_algebra_num_threads = num_threads;
+}
+
+std::size_t get_linear_algebra_num_threads() noexcept { return linear_algebra_num_threads; }
+
+void set_linear_algebra_gpu_min_work(std::size_t min_work) {
+  if (min_work > 0 && !is_linear_algebra_gpu_available()) {
+    throw std::logic_error(
+        "no GPU available for linear algebra (build with MOTION_USE_CUDA and a CUDA device)");
+  }
+  linear_algebra_gpu_min_work = min_work;
+}
+
+std::size_t get_linear_algebra_gpu_min_work() noexcept { return linear_algebra_gpu_min_work; }
+
+bool is_linear_algebra_gpu_available() noexcept {
+#ifdef MOTION_USE_CUDA
+  static const bool available = gpu::is_device_available();
+  return available;
+#else
+  return false;
+#endif
+}
+
+template <typename T>
+bool is_offloaded_to_gpu(const tensor::GemmOp& gemm_op) noexcept {
+  return use_gpu<T>(get_matrix_multiply_work(gemm_op));
+}
+
+template <typename T>
+bool is_offloaded_to_gpu(const tensor::Conv2DOp& conv_op) noexcept {
+  return use_gpu<T>(get_convolution_work(conv_op));
+}
+
+template bool is_offloaded_to_gpu<std::uint8_t>(const tensor::GemmOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint16_t>(const tensor::GemmOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint32_t>(const tensor::GemmOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint64_t>(const tensor::GemmOp&) noexcept;
+template bool is_offloaded_to_gpu<__uint128_t>(const tensor::GemmOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint8_t>(const tensor::Conv2DOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint16_t>(const tensor::Conv2DOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint32_t>(const tensor::Conv2DOp&) noexcept;
+template bool is_offloaded_to_gpu<std::uint64_t>(const tensor::Conv2DOp&) noexcept;
+template bool is_offloaded_to_gpu<__uint128_t>(const tensor::Conv2DOp&) noexcept;
+
+// compute op(A) * op(B) as a tensor contraction on the thread pool, where op transposes the
+// matrix if requested (A and B are given in their stored shapes)
+template <typename T>
+static void matrix_multiply_parallel(const Eigen::ThreadPoolDevice& device, const T* A,
+                                     std::size_t rows_A, std::size_t cols_A, bool trans_A,
+                                     const T* B, std::size_t rows_B, std::size_t cols_B,
+                                     bool trans_B, T* output) {
+  using TensorType2 = Eigen::Tensor<T, 2, Eigen::RowMajor>;
+  using CTensorType2 = Eigen::Tensor<const T, 2, Eigen::RowMajor>;
+  Eigen::TensorMap<CTensorType2> tensor_A(A, rows_A, cols_A);
+  Eigen::TensorMap<CTensorType2> tensor_B(B, rows_B, cols_B);
+  Eigen::TensorMap<TensorType2> tensor_output(output, trans_A ? cols_A : rows_A,
+                                              trans_B ? rows_B : cols_B);
+  const std::array<Eigen::IndexPair<Eigen::Index>, 1> contraction_dimensions = {
+      Eigen::IndexPair<Eigen::Index>(trans_A ? 0 : 1, trans_B ? 1 : 0)};
+  tensor_output.device(device) = tensor_A.contract(tensor_B, contraction_dimensions);
+}
+
 template <typename T>
 void matrix_multiply(std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, const T* A,
                      const T* B, T* output) {
+  if (try_matrix_multiply_gpu(A, dim_l, dim_m, false, B, dim_m, dim_n, false, output,
+                              dim_l * dim_m * dim_n)) {
+    return;
+  }
+  if (auto thread_pool = get_thread_pool(dim_l * dim_m * dim_n); thread_pool) {
+    matrix_multiply_parallel(thread_pool->device_, A, dim_l, dim_m, false, B, dim_m, dim_n, false,
+                             output);
+    return;
+  }
   using MatrixType = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
   Eigen::Map<MatrixType> matrix_output(output, dim_l, dim_n);
   Eigen::Map<const MatrixType> matrix_A(A, dim_l, dim_m);
@@ -53,8 +255,21 @@ std::vector<T> matrix_multiply(std::size_t dim_l, std::size_t dim_m, std::size_t
 
 template <typename T>
 void matrix_multiply(const tensor::GemmOp& gemm_op, const T* A, const T* B, T* output) {
-  using MatrixType = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
   assert(gemm_op.verify());
+  const auto work = get_matrix_multiply_work(gemm_op);
+  if (try_matrix_multiply_gpu(A, gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
+                              gemm_op.transA_, B, gemm_op.input_B_shape_[0],
+                              gemm_op.input_B_shape_[1], gemm_op.transB_, output, work)) {
+    return;
+  }
+  if (auto thread_pool = get_thread_pool(work); thread_pool) {
+    matrix_multiply_parallel(thread_pool->device_, A, gemm_op.input_A_shape_[0],
+                             gemm_op.input_A_shape_[1], gemm_op.transA_, B,
+                             gemm_op.input_B_shape_[0], gemm_op.input_B_shape_[1],
+                             gemm_op.transB_, output);
+    return;
+  }
+  using MatrixType = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
   Eigen::Map<MatrixType> matrix_output(output, gemm_op.output_shape_[0], gemm_op.output_shape_[1]);
   Eigen::Map<const MatrixType> matrix_A(A, gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1]);
   Eigen::Map<const MatrixType> matrix_B(B, gemm_op.input_B_shape_[0], gemm_op.input_B_shape_[1]);
@@ -70,6 +285,36 @@ void matrix_multiply(const tensor::GemmOp& gemm_op, const T* A, const T* B, T* o
   }
 }
 
+template <typename T>
+void matrix_multiply(const tensor::GemmOp& gemm_op, const T* A, const T* B, T* output,
+                     std::size_t row_begin, std::size_t row_end, std::size_t column_begin,
+                     std::size_t column_end) {
+  assert(gemm_op.verify());
+  assert(row_begin <= row_end && row_end <= gemm_op.output_shape_[0]);
+  assert(column_begin <= column_end && column_end <= gemm_op.output_shape_[1]);
+  using MatrixType = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  Eigen::Map<MatrixType> matrix_output(output, gemm_op.output_shape_[0], gemm_op.output_shape_[1]);
+  Eigen::Map<const MatrixType> matrix_A(A, gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1]);
+  Eigen::Map<const MatrixType> matrix_B(B, gemm_op.input_B_shape_[0], gemm_op.input_B_shape_[1]);
+  const auto rows = static_cast<Eigen::Index>(row_end - row_begin);
+  const auto columns = static_cast<Eigen::Index>(column_end - column_begin);
+  auto block = matrix_output.block(row_begin, column_begin, rows, columns);
+
+  if (gemm_op.transA_ && gemm_op.transB_) {
+    block.noalias() = matrix_A.transpose().middleRows(row_begin, rows) *
+                      matrix_B.transpose().middleCols(column_begin, columns);
+  } else if (gemm_op.transA_) {
+    block.noalias() = matrix_A.transpose().middleRows(row_begin, rows) *
+                      matrix_B.middleCols(column_begin, columns);
+  } else if (gemm_op.transB_) {
+    block.noalias() = matrix_A.middleRows(row_begin, rows) *
+                      matrix_B.transpose().middleCols(column_begin, columns);
+  } else {
+    block.noalias() =
+        matrix_A.middleRows(row_begin, rows) * matrix_B.middleCols(column_begin, columns);
+  }
+}
+
 template void matrix_multiply(std::size_t, std::size_t, std::size_t, const std::uint8_t*,
                               const std::uint8_t*, std::uint8_t*);
 template void matrix_multiply(std::size_t, std::size_t, std::size_t, const std::uint16_t*,
@@ -104,54 +349,730 @@ template void matrix_multiply(const tensor::GemmOp&, const std::uint64_t*, const
 template void matrix_multiply(const tensor::GemmOp&, const __uint128_t*, const __uint128_t*,
                               __uint128_t*);
 
+template void matrix_multiply(const tensor::GemmOp&, const std::uint8_t*, const std::uint8_t*,
+                              std::uint8_t*, std::size_t, std::size_t, std::size_t, std::size_t);
+template void matrix_multiply(const tensor::GemmOp&, const std::uint16_t*, const std::uint16_t*,
+                              std::uint16_t*, std::size_t, std::size_t, std::size_t, std::size_t);
+template void matrix_multiply(const tensor::GemmOp&, const std::uint32_t*, const std::uint32_t*,
+                              std::uint32_t*, std::size_t, std::size_t, std::size_t, std::size_t);
+template void matrix_multiply(const tensor::GemmOp&, const std::uint64_t*, const std::uint64_t*,
+                              std::uint64_t*, std::size_t, std::size_t, std::size_t, std::size_t);
+template void matrix_multiply(const tensor::GemmOp&, const __uint128_t*, const __uint128_t*,
+                              __uint128_t*, std::size_t, std::size_t, std::size_t, std::size_t);
+
+template <typename T>
+CSRMatrix<T> CSRMatrix<T>::from_dense(std::size_t rows, std::size_t cols, const T* dense) {
+  CSRMatrix<T> matrix;
+  matrix.rows_ = rows;
+  matrix.cols_ = cols;
+  matrix.row_ptr_.reserve(rows + 1);
+  matrix.row_ptr_.push_back(0);
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (std::size_t j = 0; j < cols; ++j) {
+      if (dense[i * cols + j] != T(0)) {
+        matrix.col_idx_.push_back(j);
+        matrix.values_.push_back(dense[i * cols + j]);
+      }
+    }
+    matrix.row_ptr_.push_back(matrix.col_idx_.size());
+  }
+  return matrix;
+}
+
+template <typename T>
+std::vector<T> CSRMatrix<T>::to_dense() const {
+  assert(verify());
+  assert(values_.size() == get_num_nonzeros());
+  std::vector<T> dense(rows_ * cols_, T(0));
+  for (std::size_t i = 0; i < rows_; ++i) {
+    for (std::size_t e = row_ptr_[i]; e < row_ptr_[i + 1]; ++e) {
+      dense[i * cols_ + col_idx_[e]] = values_[e];
+    }
+  }
+  return dense;
+}
+
+template <typename T>
+bool CSRMatrix<T>::verify() const noexcept {
+  if (row_ptr_.size() != rows_ + 1 || row_ptr_.front() != 0 ||
+      row_ptr_.back() != col_idx_.size()) {
+    return false;
+  }
+  if (!std::is_sorted(std::begin(row_ptr_), std::end(row_ptr_))) {
+    return false;
+  }
+  return std::all_of(std::begin(col_idx_), std::end(col_idx_),
+                     [this](auto j) { return j < cols_; });
+}
+
+// rows [row_begin, row_end) of the product of a dense and a sparse matrix: each entry a_ij of A
+// scales the nonzero entries of row j of B, which are accumulated into row i of the output
+template <typename T>
+static void matrix_multiply_sparse(const T* A, const CSRMatrix<T>& B, T* output,
+                                   std::size_t row_begin, std::size_t row_end) {
+  // avoid the promotion of small types to (signed) int, whose overflow is undefined
+  using MulType = std::conditional_t<(sizeof(T) < sizeof(unsigned int)), unsigned int, T>;
+  const auto dim_m = B.rows_;
+  const auto dim_n = B.cols_;
+  for (std::size_t i = row_begin; i < row_end; ++i) {
+    T* output_row = output + i * dim_n;
+    std::fill_n(output_row, dim_n, T(0));
+    for (std::size_t j = 0; j < dim_m; ++j) {
+      const MulType a_ij = A[i * dim_m + j];
+      if (a_ij == 0) {
+        continue;
+      }
+      for (std::size_t e = B.row_ptr_[j]; e < B.row_ptr_[j + 1]; ++e) {
+        output_row[B.col_idx_[e]] += T(a_ij * MulType(B.values_[e]));
+      }
+    }
+  }
+}
+
+template <typename T>
+void matrix_multiply(std::size_t dim_l, const T* A, const CSRMatrix<T>& B, T* output) {
+  assert(B.verify());
+  assert(B.values_.size() == B.get_num_nonzeros());
+  const auto work = dim_l * B.get_num_nonzeros();
+  if (auto thread_pool = get_thread_pool(work); thread_pool && dim_l > 1) {
+    const auto row_work = double(B.get_num_nonzeros());
+    const Eigen::TensorOpCost row_cost(row_work * sizeof(T), double(B.cols_ * sizeof(T)),
+                                       row_work);
+    thread_pool->device_.parallelFor(static_cast<Eigen::Index>(dim_l), row_cost,
+                                     [&](Eigen::Index first, Eigen::Index last) {
+                                       matrix_multiply_sparse(A, B, output, first, last);
+                                     });
+  } else {
+    matrix_multiply_sparse(A, B, output, 0, dim_l);
+  }
+}
+
+template struct CSRMatrix<std::uint8_t>;
+template struct CSRMatrix<std::uint16_t>;
+template struct CSRMatrix<std::uint32_t>;
+template struct CSRMatrix<std::uint64_t>;
+template struct CSRMatrix<__uint128_t>;
+template void matrix_multiply(std::size_t, const std::uint8_t*, const CSRMatrix<std::uint8_t>&,
+                              std::uint8_t*);
+template void matrix_multiply(std::size_t, const std::uint16_t*, const CSRMatrix<std::uint16_t>&,
+                              std::uint16_t*);
+template void matrix_multiply(std::size_t, const std::uint32_t*, const CSRMatrix<std::uint32_t>&,
+                              std::uint32_t*);
+template void matrix_multiply(std::size_t, const std::uint64_t*, const CSRMatrix<std::uint64_t>&,
+                              std::uint64_t*);
+template void matrix_multiply(std::size_t, const __uint128_t*, const CSRMatrix<__uint128_t>&,
+                              __uint128_t*);
+
+// number of output channels whose output rows are accumulated together by the direct convolution
+constexpr std::size_t convolution_channel_tile = 8;
+
+// output rows of a work unit of the convolutions which may use Winograd's algorithm, a multiple of
+// its tile sizes
+constexpr std::size_t winograd_unit_rows = 4;
+
+static bool is_winograd_shape(const tensor::Conv2DOp& conv_op) noexcept {
+  return conv_op.kernel_shape_[2] == 3 && conv_op.kernel_shape_[3] == 3 &&
+         conv_op.strides_[0] == 1 && conv_op.strides_[1] == 1 && conv_op.dilations_[0] == 1 &&
+         conv_op.dilations_[1] == 1;
+}
+
+static std::size_t get_convolution_unit_rows(const tensor::Conv2DOp& conv_op) noexcept {
+  return is_winograd_shape(conv_op) ? winograd_unit_rows : 1;
+}
+
+// Direct convolution of the work units [unit_begin, unit_end), where a unit is a block of output
+// rows of a tile of output channels of one sample of the batch.  Each kernel entry is multiplied
+// with the matching segment of an input row and accumulated into the output rows of the tile, so
+// no im2col matrix of the input is built and the output rows of a unit stay in the cache.
+template <typename T>
+static void convolution_direct(const tensor::Conv2DOp& conv_op, const T* input, const T* kernel,
+                               T* output, std::size_t unit_begin, std::size_t unit_end) {
+  // avoid the promotion of small types to (signed) int, whose overflow is undefined
+  using MulType = std::conditional_t<(sizeof(T) < sizeof(unsigned int)), unsigned int, T>;
+  const std::size_t in_channels = conv_op.input_shape_[0];
+  const auto in_rows = static_cast<std::ptrdiff_t>(conv_op.input_shape_[1]);
+  const auto in_columns = static_cast<std::ptrdiff_t>(conv_op.input_shape_[2]);
+  const std::size_t out_channels = conv_op.output_shape_[0];
+  const std::size_t out_rows = conv_op.output_shape_[1];
+  const std::size_t out_columns = conv_op.output_shape_[2];
+  const std::size_t kernel_rows = conv_op.kernel_shape_[2];
+  const std::size_t kernel_columns = conv_op.kernel_shape_[3];
+  const auto stride_rows = static_cast<std::ptrdiff_t>(conv_op.strides_[0]);
+  const auto stride_columns = static_cast<std::ptrdiff_t>(conv_op.strides_[1]);
+  const auto dilation_rows = static_cast<std::ptrdiff_t>(conv_op.dilations_[0]);
+  const auto dilation_columns = static_cast<std::ptrdiff_t>(conv_op.dilations_[1]);
+  const auto pad_top = static_cast<std::ptrdiff_t>(conv_op.pads_[0]);
+  const auto pad_left = static_cast<std::ptrdiff_t>(conv_op.pads_[1]);
+  const std::size_t kernel_channel_size = in_channels * kernel_rows * kernel_columns;
+  const std::size_t sample_input_size = conv_op.compute_input_size() / conv_op.batch_size_;
+  const std::size_t sample_output_size = conv_op.compute_output_size() / conv_op.batch_size_;
+  const std::size_t unit_rows = get_convolution_unit_rows(conv_op);
+  const std::size_t num_row_blocks = (out_rows + unit_rows - 1) / unit_rows;
+  const std::size_t num_sample_units =
+      ((out_channels + convolution_channel_tile - 1) / convolution_channel_tile) * num_row_blocks;
+
+  for (std::size_t batch_unit = unit_begin; batch_unit < unit_end; ++batch_unit) {
+    const std::size_t sample = batch_unit / num_sample_units;
+    const std::size_t unit = batch_unit % num_sample_units;
+    const T* sample_input = input + sample * sample_input_size;
+    T* sample_output = output + sample * sample_output_size;
+    const std::size_t oc_begin = (unit / num_row_blocks) * convolution_channel_tile;
+    const std::size_t oc_end = std::min(oc_begin + convolution_channel_tile, out_channels);
+    const std::size_t oh_begin = (unit % num_row_blocks) * unit_rows;
+    const std::size_t oh_end = std::min(oh_begin + unit_rows, out_rows);
+    for (std::size_t oh = oh_begin; oh < oh_end; ++oh) {
+      for (std::size_t oc = oc_begin; oc < oc_end; ++oc) {
+        std::fill_n(sample_output + (oc * out_rows + oh) * out_columns, out_columns, T(0));
+      }
+      for (std::size_t kh = 0; kh < kernel_rows; ++kh) {
+        const auto ih = static_cast<std::ptrdiff_t>(oh) * stride_rows +
+                        static_cast<std::ptrdiff_t>(kh) * dilation_rows - pad_top;
+        if (ih < 0 || ih >= in_rows) {
+          // row of the zero padding
+          continue;
+        }
+        for (std::size_t kw = 0; kw < kernel_columns; ++kw) {
+          // output column ow reads input column ow * stride_columns + offset, restrict the output
+          // columns to those which do not read from the zero padding
+          const auto offset = static_cast<std::ptrdiff_t>(kw) * dilation_columns - pad_left;
+          const std::size_t ow_begin =
+              offset >= 0 ? 0
+                          : static_cast<std::size_t>((-offset + stride_columns - 1) /
+                                                     stride_columns);
+          const std::size_t ow_end =
+              offset >= in_columns
+                  ? 0
+                  : std::min(out_columns, static_cast<std::size_t>((in_columns - offset +
+                                                                    stride_columns - 1) /
+                                                                   stride_columns));
+          if (ow_begin >= ow_end) {
+            continue;
+          }
+          const std::size_t num_columns = ow_end - ow_begin;
+          for (std::size_t ic = 0; ic < in_channels; ++ic) {
+            const T* input_row =
+                sample_input + (ic * in_rows + ih) * in_columns +
+                (static_cast<std::ptrdiff_t>(ow_begin) * stride_columns + offset);
+            const std::size_t kernel_offset = (ic * kernel_rows + kh) * kernel_columns + kw;
+            for (std::size_t oc = oc_begin; oc < oc_end; ++oc) {
+              const MulType k = kernel[oc * kernel_channel_size + kernel_offset];
+              T* output_row = sample_output + (oc * out_rows + oh) * out_columns + ow_begin;
+              if (stride_columns == 1) {
+                for (std::size_t j = 0; j < num_columns; ++j) {
+                  output_row[j] += static_cast<T>(k * MulType(input_row[j]));
+                }
+              } else {
+                for (std::size_t j = 0; j < num_columns; ++j) {
+                  output_row[j] += static_cast<T>(k * MulType(input_row[j * stride_columns]));
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Transforms of Winograd's minimal filtering F(m x m, 3 x 3), which computes an m x m tile of
+// the cross-correlation of an n x n input tile d (n = m + 2) with a 3 x 3 kernel g as
+// Y = A^T [(G g G^T) * (B^T d B)] A, see Lavin and Gray, "Fast Algorithms for Convolutional Neural
+// Networks".  G is scaled by `scale` to integer coefficients, so the result is scale^2 Y, where
+// scale^2 = 2^shift * odd.
+template <std::size_t m>
+struct WinogradTransforms;
+
+template <>
+struct WinogradTransforms<2> {
+  static constexpr std::size_t n = 4;
+  static constexpr std::array<std::array<int, n>, n> BT = {{
+      {1, 0, -1, 0},
+      {0, 1, 1, 0},
+      {0, -1, 1, 0},
+      {0, 1, 0, -1},
+  }};
+  // 2 G
+  static constexpr std::array<std::array<int, 3>, n> G = {{
+      {2, 0, 0},
+      {1, 1, 1},
+      {1, -1, 1},
+      {0, 0, 2},
+  }};
+  static constexpr std::array<std::array<int, n>, 2> AT = {{
+      {1, 1, 1, 0},
+      {0, 1, -1, -1},
+  }};
+  static constexpr unsigned shift = 2;
+  static constexpr unsigned odd = 1;
+};
+
+template <>
+struct WinogradTransforms<4> {
+  static constexpr std::size_t n = 6;
+  static constexpr std::array<std::array<int, n>, n> BT = {{
+      {4, 0, -5, 0, 1, 0},
+      {0, -4, -4, 1, 1, 0},
+      {0, 4, -4, -1, 1, 0},
+      {0, -2, -1, 2, 1, 0},
+      {0, 2, -1, -2, 1, 0},
+      {0, 4, 0, -5, 0, 1},
+  }};
+  // 24 G
+  static constexpr std::array<std::array<int, 3>, n> G = {{
+      {6, 0, 0},
+      {-4, -4, -4},
+      {-4, 4, -4},
+      {1, 2, 4},
+      {1, -2, 4},
+      {0, 0, 24},
+  }};
+  static constexpr std::array<std::array<int, n>, 4> AT = {{
+      {1, 1, 1, 1, 1, 0},
+      {0, 1, -1, 2, -2, 0},
+      {0, 1, 1, 4, 4, 0},
+      {0, 1, -1, 8, -8, 1},
+  }};
+  // 24^2 = 2^6 * 9
+  static constexpr unsigned shift = 6;
+  static constexpr unsigned odd = 9;
+};
+
+// output = L X L^T for an r x c matrix L and a c x c matrix X, both row major
+template <typename W, std::size_t r, std::size_t c>
+static inline void winograd_transform(const std::array<std::array<int, c>, r>& L, const W* X,
+                                      W* output) {
+  std::array<W, r * c> tmp;
+  for (std::size_t i = 0; i < r; ++i) {
+    for (std::size_t j = 0; j < c; ++j) {
+      W sum = 0;
+      for (std::size_t k = 0; k < c; ++k) {
+        sum += static_cast<W>(static_cast<std::int64_t>(L[i][k])) * X[k * c + j];
+      }
+      tmp[i * c + j] = sum;
+    }
+  }
+  for (std::size_t i = 0; i < r; ++i) {
+    for (std::size_t j = 0; j < r; ++j) {
+      W sum = 0;
+      for (std::size_t k = 0; k < c; ++k) {
+        sum += tmp[i * c + k] * static_cast<W>(static_cast<std::int64_t>(L[j][k]));
+      }
+      output[i * r + j] = sum;
+    }
+  }
+}
+
+// inverse of an odd value modulo 2^k with Newton's iteration
+template <typename T>
+static T inverse_odd(T x) noexcept {
+  T inverse = x;
+  for (int i = 0; i < 6; ++i) {
+    inverse *= T(2) - x * inverse;
+  }
+  return inverse;
+}
+
+// Winograd's F(m x m, 3 x 3) of the work units [unit_begin, unit_end), which are the same as the
+// ones of the direct convolution.  The kernels of a tile of output channels are transformed once
+// per tile.  For each m x m tile of the output rows of a unit, the input tile of each input channel
+// is transformed and its element-wise products with the transformed kernels are accumulated, so
+// only one inverse transform per output channel and tile is needed.
+template <typename T, std::size_t m>
+static void convolution_winograd(const tensor::Conv2DOp& conv_op, const T* input, const T* kernel,
+                                 T* output, std::size_t unit_begin, std::size_t unit_end) {
+  // the transforms are evaluated modulo 2^64, which leaves 58 bits after dividing by 2^shift
+  static_assert(sizeof(T) == sizeof(std::uint32_t));
+  using W = std::uint64_t;
+  using Transforms = WinogradTransforms<m>;
+  constexpr std::size_t n = Transforms::n;
+  static_assert(winograd_unit_rows % m == 0);
+  const std::size_t in_channels = conv_op.input_shape_[0];
+  const auto in_rows = static_cast<std::ptrdiff_t>(conv_op.input_shape_[1]);
+  const auto in_columns = static_cast<std::ptrdiff_t>(conv_op.input_shape_[2]);
+  const std::size_t out_channels = conv_op.output_shape_[0];
+  const std::size_t out_rows = conv_op.output_shape_[1];
+  const std::size_t out_columns = conv_op.output_shape_[2];
+  const auto pad_top = static_cast<std::ptrdiff_t>(conv_op.pads_[0]);
+  const auto pad_left = static_cast<std::ptrdiff_t>(conv_op.pads_[1]);
+  const std::size_t sample_input_size = conv_op.compute_input_size() / conv_op.batch_size_;
+  const std::size_t sample_output_size = conv_op.compute_output_size() / conv_op.batch_size_;
+  const std::size_t num_row_blocks = (out_rows + winograd_unit_rows - 1) / winograd_unit_rows;
+  const std::size_t num_sample_units =
+      ((out_channels + convolution_channel_tile - 1) / convolution_channel_tile) * num_row_blocks;
+  const T inverse = inverse_odd<T>(Transforms::odd);
+
+  // G g G^T of the kernels of the current tile of output channels, indexed by (oc, ic)
+  std::vector<W> kernels_transformed(convolution_channel_tile * in_channels * n * n);
+  std::size_t transformed_oc_begin = out_channels;
+  std::array<W, n * n> input_tile;
+  std::array<W, n * n> input_transformed;
+  std::vector<W> products(convolution_channel_tile * n * n);
+  std::array<W, m * m> output_tile;
+
+  for (std::size_t batch_unit = unit_begin; batch_unit < unit_end; ++batch_unit) {
+    const std::size_t sample = batch_unit / num_sample_units;
+    const std::size_t unit = batch_unit % num_sample_units;
+    const T* sample_input = input + sample * sample_input_size;
+    T* sample_output = output + sample * sample_output_size;
+    const std::size_t oc_begin = (unit / num_row_blocks) * convolution_channel_tile;
+    const std::size_t oc_end = std::min(oc_begin + convolution_channel_tile, out_channels);
+    const std::size_t num_tile_channels = oc_end - oc_begin;
+    const std::size_t oh_begin = (unit % num_row_blocks) * winograd_unit_rows;
+    const std::size_t oh_end = std::min(oh_begin + winograd_unit_rows, out_rows);
+
+    if (oc_begin != transformed_oc_begin) {
+      for (std::size_t oc = oc_begin; oc < oc_end; ++oc) {
+        for (std::size_t ic = 0; ic < in_channels; ++ic) {
+          std::array<W, 9> g;
+          std::copy_n(kernel + (oc * in_channels + ic) * 9, 9, std::begin(g));
+          winograd_transform(
+              Transforms::G, g.data(),
+              kernels_transformed.data() + ((oc - oc_begin) * in_channels + ic) * n * n);
+        }
+      }
+      transformed_oc_begin = oc_begin;
+    }
+
+    for (std::size_t oh = oh_begin; oh < oh_end; oh += m) {
+      for (std::size_t ow = 0; ow < out_columns; ow += m) {
+        std::fill(std::begin(products), std::end(products), W(0));
+        for (std::size_t ic = 0; ic < in_channels; ++ic) {
+          // n x n input tile, outside of the input (padding and beyond the last tile) it is zero
+          const T* channel_input = sample_input + ic * in_rows * in_columns;
+          for (std::size_t i = 0; i < n; ++i) {
+            const auto ih = static_cast<std::ptrdiff_t>(oh + i) - pad_top;
+            for (std::size_t j = 0; j < n; ++j) {
+              const auto iw = static_cast<std::ptrdiff_t>(ow + j) - pad_left;
+              input_tile[i * n + j] = (ih >= 0 && ih < in_rows && iw >= 0 && iw < in_columns)
+                                          ? W(channel_input[ih * in_columns + iw])
+                                          : W(0);
+            }
+          }
+          winograd_transform(Transforms::BT, input_tile.data(), input_transformed.data());
+          for (std::size_t oc_i = 0; oc_i < num_tile_channels; ++oc_i) {
+            const W* U = kernels_transformed.data() + (oc_i * in_channels + ic) * n * n;
+            W* M = products.data() + oc_i * n * n;
+            for (std::size_t k = 0; k < n * n; ++k) {
+              M[k] += U[k] * input_transformed[k];
+            }
+          }
+        }
+        const std::size_t num_rows = std::min(m, out_rows - oh);
+        const std::size_t num_columns = std::min(m, out_columns - ow);
+        for (std::size_t oc_i = 0; oc_i < num_tile_channels; ++oc_i) {
+          winograd_transform(Transforms::AT, products.data() + oc_i * n * n, output_tile.data());
+          T* channel_output = sample_output + (oc_begin + oc_i) * out_rows * out_columns;
+          for (std::size_t i = 0; i < num_rows; ++i) {
+            for (std::size_t j = 0; j < num_columns; ++j) {
+              // divide by scale^2 = 2^shift * odd
+              channel_output[(oh + i) * out_columns + ow + j] =
+                  static_cast<T>(output_tile[i * m + j] >> Transforms::shift) * inverse;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+static std::size_t get_winograd_tile_size(const tensor::Conv2DOp& conv_op,
+                                          std::size_t element_size) noexcept {
+  if (!is_winograd_shape(conv_op)) {
+    return 0;
+  }
+  if (element_size != sizeof(std::uint32_t)) {
+    return 0;
+  }
+  return conv_op.output_shape_[1] >= 4 && conv_op.output_shape_[2] >= 4 ? 4 : 2;
+}
+
+template <typename T>
+ConvolutionAlgorithm get_convolution_algorithm(const tensor::Conv2DOp& conv_op) noexcept {
+  switch (get_winograd_tile_size(conv_op, sizeof(T))) {
+    case 2:
+      return ConvolutionAlgorithm::winograd_2x2;
+    case 4:
+      return ConvolutionAlgorithm::winograd_4x4;
+    default:
+      return ConvolutionAlgorithm::direct;
+  }
+}
+
+template ConvolutionAlgorithm get_convolution_algorithm<std::uint8_t>(
+    const tensor::Conv2DOp&) noexcept;
+template ConvolutionAlgorithm get_convolution_algorithm<std::uint16_t>(
+    const tensor::Conv2DOp&) noexcept;
+template ConvolutionAlgorithm get_convolution_algorithm<std::uint32_t>(
+    const tensor::Conv2DOp&) noexcept;
+template ConvolutionAlgorithm get_convolution_algorithm<std::uint64_t>(
+    const tensor::Conv2DOp&) noexcept;
+
+template <typename T>
+static void convolution_units(const tensor::Conv2DOp& conv_op, const T* input, const T* kernel,
+                              T* output, std::size_t unit_begin, std::size_t unit_end) {
+  if constexpr (sizeof(T) == sizeof(std::uint32_t)) {
+    switch (get_convolution_algorithm<T>(conv_op)) {
+      case ConvolutionAlgorithm::winograd_2x2:
+        convolution_winograd<T, 2>(conv_op, input, kernel, output, unit_begin, unit_end);
+        return;
+      case ConvolutionAlgorithm::winograd_4x4:
+        convolution_winograd<T, 4>(conv_op, input, kernel, output, unit_begin, unit_end);
+        return;
+      case ConvolutionAlgorithm::direct:
+        break;
+    }
+  }
+  convolution_direct(conv_op, input, kernel, output, unit_begin, unit_end);
+}
+
+std::size_t get_convolution_num_units(const tensor::Conv2DOp& conv_op) noexcept {
+  const auto num_tiles =
+      (conv_op.output_shape_[0] + convolution_channel_tile - 1) / convolution_channel_tile;
+  const auto unit_rows = get_convolution_unit_rows(conv_op);
+  return conv_op.batch_size_ * num_tiles * ((conv_op.output_shape_[1] + unit_rows - 1) / unit_rows);
+}
+
+template <typename T>
+void convolution(const tensor::Conv2DOp& conv_op, const T* input, const T* kernel, T* output,
+                 std::size_t unit_begin, std::size_t unit_end) {
+  assert(conv_op.verify());
+  assert(unit_begin <= unit_end && unit_end <= get_convolution_num_units(conv_op));
+  convolution_units(conv_op, input, kernel, output, unit_begin, unit_end);
+}
+
 template <typename T>
 void convolution(const tensor::Conv2DOp& conv_op, const T* input_buffer, const T* kernel_buffer,
                  T* output_buffer) {
-  using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  using CTensorType3 = Eigen::Tensor<const T, 3, Eigen::RowMajor>;
-  using CTensorType4 = Eigen::Tensor<const T, 4, Eigen::RowMajor>;
   assert(conv_op.verify());
-  const auto& output_shape = conv_op.output_shape_;
-  const auto& input_shape = conv_op.input_shape_;
-  const auto& kernel_shape = conv_op.kernel_shape_;
-
-  Eigen::TensorMap<CTensorType3> input(input_buffer, input_shape[0], input_shape[1],
-                                       input_shape[2]);
-  Eigen::TensorMap<CTensorType4> kernel(kernel_buffer, kernel_shape[0], kernel_shape[1],
-                                        kernel_shape[2], kernel_shape[3]);
-  Eigen::TensorMap<TensorType3> output(output_buffer, output_shape[0], output_shape[1],
-                                       output_shape[2]);
-  const std::array<Eigen::Index, 2> kernel_matrix_dimensions = {
-      static_cast<Eigen::Index>(kernel_shape[1] * kernel_shape[2] * kernel_shape[3]),
-      static_cast<Eigen::Index>(kernel_shape[0])};
-  const std::array<Eigen::Index, 2> input_matrix_dimensions = {
-      static_cast<Eigen::Index>(output_shape[1] * output_shape[2]),
-      static_cast<Eigen::Index>(kernel_shape[1] * kernel_shape[2] * kernel_shape[3])};
-
-  auto kernel_matrix =
-      kernel.shuffle(std::array<int, 4>{3, 2, 1, 0}).reshape(kernel_matrix_dimensions);
-
-  auto input_matrix =
-      input.shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0})
-          .extract_image_patches(kernel_shape[2], kernel_shape[3], conv_op.strides_[0],
-                                 conv_op.strides_[1], conv_op.dilations_[0], conv_op.dilations_[1],
-                                 1, 1, conv_op.pads_[0], conv_op.pads_[2], conv_op.pads_[1],
-                                 conv_op.pads_[3], 0)
-          .reshape(input_matrix_dimensions);
+  if (try_convolution_gpu(conv_op, input_buffer, kernel_buffer, output_buffer)) {
+    return;
+  }
+  const auto num_units = get_convolution_num_units(conv_op);
+  const auto work = get_convolution_work(conv_op);
+  if (auto thread_pool = get_thread_pool(work); thread_pool && num_units > 1) {
+    const auto unit_work = double(work) / double(num_units);
+    const auto unit_output_bytes =
+        double(convolution_channel_tile * get_convolution_unit_rows(conv_op) *
+               conv_op.output_shape_[2] * sizeof(T));
+    const Eigen::TensorOpCost unit_cost(unit_work * sizeof(T), unit_output_bytes, unit_work);
+    thread_pool->device_.parallelFor(static_cast<Eigen::Index>(num_units), unit_cost,
+                                     [&](Eigen::Index first, Eigen::Index last) {
+                                       convolution_units(conv_op, input_buffer, kernel_buffer,
+                                                         output_buffer, first, last);
+                                     });
+  } else {
+    convolution_units(conv_op, input_buffer, kernel_buffer, output_buffer, 0, num_units);
+  }
+}
 
-  const std::array<Eigen::IndexPair<Eigen::Index>, 1> contraction_dimensions = {
-      Eigen::IndexPair<Eigen::Index>(1, 0)};
-  auto output_matrix =
-      kernel_matrix.shuffle(std::array<Eigen::Index, 2>{1, 0})
-          .contract(input_matrix.shuffle(std::array<Eigen::Index, 2>{1, 0}), contraction_dimensions)
-          .shuffle(std::array<Eigen::Index, 2>{1, 0});
+// NTT friendly primes c * 2^k + 1 with a generator of their multiplicative group.  Their product
+// has more than 183 bits, s.t. the correlation of 64 bit values with kernels of less than 2^55
+// values is exact.
+static constexpr std::array<std::pair<std::uint64_t, std::uint64_t>, 3> ntt_primes = {{
+    {4179340454199820289ULL, 3},  // 29 * 2^57 + 1
+    {1945555039024054273ULL, 5},  // 27 * 2^56 + 1
+    {2485986994308513793ULL, 5},  // 69 * 2^55 + 1
+}};
+
+// Arithmetic modulo a prime of less than 62 bits with Montgomery multiplication, i.e., a
+// multiplication by a constant in Montgomery form x R mod p (R = 2^64) keeps the normal form.
+class NTTPrime {
+ public:
+  NTTPrime(std::uint64_t modulus, std::uint64_t generator)
+      : modulus_(modulus), generator_(generator) {
+    // -p^-1 mod 2^64 by Newton's iteration
+    std::uint64_t inverse = modulus;
+    for (int i = 0; i < 6; ++i) {
+      inverse *= 2 - modulus * inverse;
+    }
+    neg_inverse_ = -inverse;
+    const auto r = static_cast<std::uint64_t>((__uint128_t(1) << 64) % modulus);
+    r2_ = static_cast<std::uint64_t>(__uint128_t(r) * r % modulus);
+  }
+  std::uint64_t get_modulus() const noexcept { return modulus_; }
+  // x * y / R mod p
+  std::uint64_t mul(std::uint64_t x, std::uint64_t y) const noexcept {
+    const auto product = __uint128_t(x) * y;
+    const std::uint64_t m = static_cast<std::uint64_t>(product) * neg_inverse_;
+    const auto t = static_cast<std::uint64_t>((product + __uint128_t(m) * modulus_) >> 64);
+    return t >= modulus_ ? t - modulus_ : t;
+  }
+  std::uint64_t to_montgomery(std::uint64_t x) const noexcept { return mul(x % modulus_, r2_); }
+  // x^exponent in Montgomery form for x in Montgomery form
+  std::uint64_t pow(std::uint64_t x, std::uint64_t exponent) const noexcept {
+    auto result = to_montgomery(1);
+    for (; exponent > 0; exponent >>= 1) {
+      if (exponent & 1) {
+        result = mul(result, x);
+      }
+      x = mul(x, x);
+    }
+    return result;
+  }
+  std::uint64_t inverse(std::uint64_t x) const noexcept { return pow(x, modulus_ - 2); }
+
+  // in-place NTT of a vector in normal form whose size is a power of two, the inverse one is
+  // scaled by 1 / size
+  void ntt(std::vector<std::uint64_t>& values, bool inverse_transform) const {
+    const auto size = values.size();
+    for (std::size_t i = 1, j = 0; i < size; ++i) {
+      auto bit = size >> 1;
+      for (; j & bit; bit >>= 1) {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+        std::swap(values[i], values[j]);
+      }
+    }
+    std::vector<std::uint64_t> twiddles(size / 2);
+    for (std::size_t length = 2; length <= size; length <<= 1) {
+      auto root = pow(to_montgomery(generator_), (modulus_ - 1) / length);
+      if (inverse_transform) {
+        root = inverse(root);
+      }
+      const auto half = length / 2;
+      twiddles[0] = to_montgomery(1);
+      for (std::size_t k = 1; k < half; ++k) {
+        twiddles[k] = mul(twiddles[k - 1], root);
+      }
+      for (std::size_t begin = 0; begin < size; begin += length) {
+        for (std::size_t k = 0; k < half; ++k) {
+          const auto u = values[begin + k];
+          const auto v = mul(values[begin + k + half], twiddles[k]);
+          values[begin + k] = u + v >= modulus_ ? u + v - modulus_ : u + v;
+          values[begin + k + half] = u >= v ? u - v : u + modulus_ - v;
+        }
+      }
+    }
+    if (inverse_transform) {
+      const auto size_inverse = inverse(to_montgomery(size));
+      for (auto& value : values) {
+        value = mul(value, size_inverse);
+      }
+    }
+  }
+
+  // the pointwise products of two transforms in normal form
+  void multiply(std::vector<std::uint64_t>& values,
+                const std::vector<std::uint64_t>& factors) const {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = mul(mul(values[i], factors[i]), r2_);
+    }
+  }
+
+ private:
+  std::uint64_t modulus_;
+  std::uint64_t generator_;
+  std::uint64_t neg_inverse_;
+  std::uint64_t r2_;
+};
 
-  const std::array<Eigen::Index, 3> rev_output_dimensions = {
-      output.dimension(2), output.dimension(1), output.dimension(0)};
-  output =
-      output_matrix.reshape(rev_output_dimensions).shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0});
+template <typename T>
+static void cross_correlation_direct(const T* input, std::size_t input_size, const T* kernel,
+                                     std::size_t kernel_size, T* output) {
+  // avoid the promotion of small types to (signed) int, whose overflow is undefined
+  using MulType = std::conditional_t<(sizeof(T) < sizeof(unsigned int)), unsigned int, T>;
+  const auto output_size = input_size - kernel_size + 1;
+  for (std::size_t s = 0; s < output_size; ++s) {
+    MulType sum = 0;
+    for (std::size_t p = 0; p < kernel_size; ++p) {
+      sum += MulType(input[s + p]) * MulType(kernel[p]);
+    }
+    output[s] = static_cast<T>(sum);
+  }
+}
+
+template <typename T>
+static void cross_correlation_ntt(const T* input, std::size_t input_size, const T* kernel,
+                                  std::size_t kernel_size, T* output) {
+  // Overlap-save: a block of block_size inputs times the reversed kernel gives the outputs of the
+  // block_size - kernel_size + 1 positions which do not wrap around, s.t. the transforms have
+  // about 4 kernel_size instead of input_size values.
+  const auto output_size = input_size - kernel_size + 1;
+  const auto block_size = std::min(std::bit_ceil(4 * kernel_size), std::bit_ceil(input_size));
+  const auto block_outputs = block_size - kernel_size + 1;
+  std::array<std::vector<std::uint64_t>, ntt_primes.size()> residues;
+  for (std::size_t prime_i = 0; prime_i < ntt_primes.size(); ++prime_i) {
+    const NTTPrime prime(ntt_primes[prime_i].first, ntt_primes[prime_i].second);
+    const auto modulus = prime.get_modulus();
+    std::vector<std::uint64_t> kernel_transform(block_size, 0);
+    for (std::size_t p = 0; p < kernel_size; ++p) {
+      kernel_transform[kernel_size - 1 - p] = std::uint64_t(kernel[p]) % modulus;
+    }
+    prime.ntt(kernel_transform, false);
+    auto& output_residues = residues[prime_i];
+    output_residues.resize(output_size);
+    std::vector<std::uint64_t> block(block_size);
+    for (std::size_t block_begin = 0; block_begin < output_size; block_begin += block_outputs) {
+      for (std::size_t i = 0; i < block_size; ++i) {
+        block[i] =
+            block_begin + i < input_size ? std::uint64_t(input[block_begin + i]) % modulus : 0;
+      }
+      prime.ntt(block, false);
+      prime.multiply(block, kernel_transform);
+      prime.ntt(block, true);
+      const auto num_outputs = std::min(block_outputs, output_size - block_begin);
+      std::copy_n(std::begin(block) + (kernel_size - 1), num_outputs,
+                  std::begin(output_residues) + block_begin);
+    }
+  }
+
+  // Garner's algorithm: x = r_0 + p_0 v_1 + p_0 p_1 v_2, evaluated modulo 2^64
+  const auto p0 = ntt_primes[0].first;
+  const auto p1 = ntt_primes[1].first;
+  const auto p2 = ntt_primes[2].first;
+  auto inverse_mod = [](std::uint64_t x, std::uint64_t modulus) {
+    std::uint64_t result = 1;
+    x %= modulus;
+    for (auto exponent = modulus - 2; exponent > 0; exponent >>= 1) {
+      if (exponent & 1) {
+        result = static_cast<std::uint64_t>(__uint128_t(result) * x % modulus);
+      }
+      x = static_cast<std::uint64_t>(__uint128_t(x) * x % modulus);
+    }
+    return result;
+  };
+  auto mul_mod = [](std::uint64_t x, std::uint64_t y, std::uint64_t modulus) {
+    return static_cast<std::uint64_t>(__uint128_t(x) * y % modulus);
+  };
+  const auto p0_inverse_1 = inverse_mod(p0, p1);
+  const auto p0_inverse_2 = inverse_mod(p0, p2);
+  const auto p1_inverse_2 = inverse_mod(p1, p2);
+  for (std::size_t s = 0; s < output_size; ++s) {
+    const auto r0 = residues[0][s];
+    const auto r1 = residues[1][s];
+    const auto r2 = residues[2][s];
+    const auto v1 = mul_mod((r1 + p1 - r0 % p1) % p1, p0_inverse_1, p1);
+    auto v2 = mul_mod((r2 + p2 - r0 % p2) % p2, p0_inverse_2, p2);
+    v2 = mul_mod((v2 + p2 - v1 % p2) % p2, p1_inverse_2, p2);
+    output[s] = static_cast<T>(r0 + p0 * v1 + p0 * p1 * v2);
+  }
+}
+
+template <typename T>
+void cross_correlation(const T* input, std::size_t input_size, const T* kernel,
+                       std::size_t kernel_size, T* output) {
+  static_assert(sizeof(T) <= sizeof(std::uint64_t));
+  if (kernel_size == 0 || kernel_size > input_size) {
+    throw std::invalid_argument("cross_correlation: kernel does not fit into the input");
+  }
+  if (kernel_size < ntt_correlation_threshold) {
+    cross_correlation_direct(input, input_size, kernel, kernel_size, output);
+  } else {
+    cross_correlation_ntt(input, input_size, kernel, kernel_size, output);
+  }
 }
 
+template void cross_correlation(const std::uint8_t*, std::size_t, const std::uint8_t*,
+                                std::size_t, std::uint8_t*);
+template void cross_correlation(const std::uint16_t*, std::size_t, const std::uint16_t*,
+                                std::size_t, std::uint16_t*);
+template void cross_correlation(const std::uint32_t*, std::size_t, const std::uint32_t*,
+                                std::size_t, std::uint32_t*);
+template void cross_correlation(const std::uint64_t*, std::size_t, const std::uint64_t*,
+                                std::size_t, std::uint64_t*);
+
 template <typename T>
 std::vector<T> convolution(const tensor::Conv2DOp& conv_op, const std::vector<T>& input_buffer,
                            const std::vector<T>& kernel_buffer) {
@@ -163,13 +1084,35 @@ std::vector<T> convolution(const tensor::Conv2DOp& conv_op, const std::vector<T>
   return output_buffer;
 }
 
-void convolution(const tensor::Conv2DOp&, const std::uint8_t*, const std::uint8_t*, std::uint8_t*);
-void convolution(const tensor::Conv2DOp&, const std::uint16_t*, const std::uint16_t*,
-                 std::uint16_t*);
-void convolution(const tensor::Conv2DOp&, const std::uint32_t*, const std::uint32_t*,
-                 std::uint32_t*);
-void convolution(const tensor::Conv2DOp&, const std::uint64_t*, const std::uint64_t*,
-                 std::uint64_t*);
+ConvolutionMemory get_convolution_memory(const tensor::Conv2DOp& conv_op,
+                                         std::size_t element_size) noexcept {
+  const auto [input_matrix_rows, input_matrix_columns] = conv_op.compute_input_matrix_shape();
+  return {.peak_bytes = (conv_op.compute_input_size() + conv_op.compute_kernel_size() +
+                         conv_op.compute_output_size()) *
+                        element_size,
+          .im2col_bytes = input_matrix_rows * input_matrix_columns * element_size};
+}
+
+template void convolution(const tensor::Conv2DOp&, const std::uint8_t*, const std::uint8_t*,
+                          std::uint8_t*);
+template void convolution(const tensor::Conv2DOp&, const std::uint16_t*, const std::uint16_t*,
+                          std::uint16_t*);
+template void convolution(const tensor::Conv2DOp&, const std::uint32_t*, const std::uint32_t*,
+                          std::uint32_t*);
+template void convolution(const tensor::Conv2DOp&, const std::uint64_t*, const std::uint64_t*,
+                          std::uint64_t*);
+template void convolution(const tensor::Conv2DOp&, const __uint128_t*, const __uint128_t*,
+                          __uint128_t*);
+template void convolution(const tensor::Conv2DOp&, const std::uint8_t*, const std::uint8_t*,
+                          std::uint8_t*, std::size_t, std::size_t);
+template void convolution(const tensor::Conv2DOp&, const std::uint16_t*, const std::uint16_t*,
+                          std::uint16_t*, std::size_t, std::size_t);
+template void convolution(const tensor::Conv2DOp&, const std::uint32_t*, const std::uint32_t*,
+                          std::uint32_t*, std::size_t, std::size_t);
+template void convolution(const tensor::Conv2DOp&, const std::uint64_t*, const std::uint64_t*,
+                          std::uint64_t*, std::size_t, std::size_t);
+template void convolution(const tensor::Conv2DOp&, const __uint128_t*, const __uint128_t*,
+                          __uint128_t*, std::size_t, std::size_t);
 template std::vector<std::uint8_t> convolution(const tensor::Conv2DOp&,
                                                const std::vector<std::uint8_t>&,
                                                const std::vector<std::uint8_t>&);
@@ -186,31 +1129,65 @@ template std::vector<__uint128_t> convolution(const tensor::Conv2DOp&,
                                               const std::vector<__uint128_t>&,
                                               const std::vector<__uint128_t>&);
 
+// sum pool the channels [channel_begin, channel_end), where the samples of a batch are pooled
+// like additional channels
+template <typename T>
+static void sum_pool_channels(const tensor::AveragePoolOp& avgpool_op, const T* input, T* output,
+                              std::size_t channel_begin, std::size_t channel_end) {
+  const auto in_rows = avgpool_op.input_shape_[1];
+  const auto in_columns = avgpool_op.input_shape_[2];
+  const auto out_rows = avgpool_op.output_shape_[1];
+  const auto out_columns = avgpool_op.output_shape_[2];
+  const auto kernel_rows = avgpool_op.kernel_shape_[0];
+  const auto kernel_columns = avgpool_op.kernel_shape_[1];
+  const auto stride_rows = avgpool_op.strides_[0];
+  const auto stride_columns = avgpool_op.strides_[1];
+
+  for (std::size_t channel_i = channel_begin; channel_i < channel_end; ++channel_i) {
+    const T* in_channel = input + channel_i * in_rows * in_columns;
+    T* out_channel = output + channel_i * out_rows * out_columns;
+    for (std::size_t row_i = 0; row_i < out_rows; ++row_i) {
+      T* out_row = out_channel + row_i * out_columns;
+      std::fill_n(out_row, out_columns, T(0));
+      // add the rows of the window one after another, s.t. the innermost loop runs over the
+      // output columns and is vectorized for stride 1
+      for (std::size_t kernel_row = 0; kernel_row < kernel_rows; ++kernel_row) {
+        const T* in_row = in_channel + (row_i * stride_rows + kernel_row) * in_columns;
+        for (std::size_t kernel_column = 0; kernel_column < kernel_columns; ++kernel_column) {
+          const T* in_ptr = in_row + kernel_column;
+          if (stride_columns == 1) {
+            for (std::size_t column_j = 0; column_j < out_columns; ++column_j) {
+              out_row[column_j] += in_ptr[column_j];
+            }
+          } else {
+            for (std::size_t column_j = 0; column_j < out_columns; ++column_j) {
+              out_row[column_j] += in_ptr[column_j * stride_columns];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 template <typename T>
 void sum_pool(const tensor::AveragePoolOp& avgpool_op, const T* input, T* output) {
   assert(avgpool_op.verify());
-  using TensorType3C = Eigen::Tensor<const T, 3, Eigen::RowMajor>;
-  using TensorType3 = Eigen::Tensor<T, 3, Eigen::RowMajor>;
-  const auto in_channels = static_cast<Eigen::Index>(avgpool_op.input_shape_[0]);
-  const auto in_rows = static_cast<Eigen::Index>(avgpool_op.input_shape_[1]);
-  const auto in_columns = static_cast<Eigen::Index>(avgpool_op.input_shape_[2]);
-  const auto out_channels = static_cast<Eigen::Index>(avgpool_op.output_shape_[0]);
-  const auto out_rows = static_cast<Eigen::Index>(avgpool_op.output_shape_[1]);
-  const auto out_columns = static_cast<Eigen::Index>(avgpool_op.output_shape_[2]);
-  const auto kernel_rows = static_cast<Eigen::Index>(avgpool_op.kernel_shape_[0]);
-  const auto kernel_columns = static_cast<Eigen::Index>(avgpool_op.kernel_shape_[1]);
-  const auto stride_rows = static_cast<Eigen::Index>(avgpool_op.strides_[0]);
-  const auto stride_columns = static_cast<Eigen::Index>(avgpool_op.strides_[1]);
-
-  Eigen::TensorMap<TensorType3C> tensor_src(input, in_channels, in_rows, in_columns);
-  Eigen::TensorMap<TensorType3> tensor_dst(output, out_channels, out_rows, out_columns);
-
-  tensor_dst = tensor_src.shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0})
-                   .extract_image_patches(kernel_rows, kernel_columns, stride_rows, stride_columns,
-                                          1, 1, 1, 1, 0, 0, 0, 0, T(0))
-                   .sum(Eigen::array<Eigen::Index, 2>{1, 2})
-                   .reshape(Eigen::array<Eigen::Index, 3>{out_columns, out_rows, out_channels})
-                   .shuffle(Eigen::array<Eigen::Index, 3>{2, 1, 0});
+  const auto num_channels = avgpool_op.batch_size_ * avgpool_op.input_shape_[0];
+  const auto work = avgpool_op.compute_output_size() * avgpool_op.compute_kernel_size();
+  if (auto thread_pool = get_thread_pool(work); thread_pool && num_channels > 1) {
+    const auto channel_work = double(work) / double(num_channels);
+    const auto channel_output_bytes =
+        double(avgpool_op.output_shape_[1] * avgpool_op.output_shape_[2] * sizeof(T));
+    const Eigen::TensorOpCost channel_cost(channel_work * sizeof(T), channel_output_bytes,
+                                           channel_work);
+    thread_pool->device_.parallelFor(static_cast<Eigen::Index>(num_channels), channel_cost,
+                                     [&](Eigen::Index first, Eigen::Index last) {
+                                       sum_pool_channels(avgpool_op, input, output, first, last);
+                                     });
+  } else {
+    sum_pool_channels(avgpool_op, input, output, 0, num_channels);
+  }
 }
 
 template void sum_pool(const tensor::AveragePoolOp&, const std::uint8_t*, std::uint8_t*);
@@ -34,6 +34,26 @@ struct Conv2DOp;
 struct GemmOp;
 }  // namespace tensor
 
+// Set the number of threads which matrix_multiply and convolution use for large operations.
+// With 1 (the default) everything is evaluated on the calling thread, otherwise a shared Eigen
+// thread pool of this size is used.
+void set_linear_algebra_num_threads(std::size_t num_threads);
+std::size_t get_linear_algebra_num_threads() noexcept;
+
+// Offload matrix_multiply and convolution of std::uint32_t and std::uint64_t values with at least
+// `min_work` multiplications to a CUDA device, 0 (the default) disables it.  This requires a build
+// with MOTION_USE_CUDA and a device, otherwise std::logic_error is thrown.  Each thread uses its own
+// streams, s.t. the products of one thread overlap with the communication of the others, and the
+// output is copied back in chunks while the next chunk is computed.
+void set_linear_algebra_gpu_min_work(std::size_t min_work);
+std::size_t get_linear_algebra_gpu_min_work() noexcept;
+bool is_linear_algebra_gpu_available() noexcept;
+// would the product / convolution be evaluated by the GPU, i.e., not in ranges on the CPU
+template <typename T>
+bool is_offloaded_to_gpu(const tensor::GemmOp&) noexcept;
+template <typename T>
+bool is_offloaded_to_gpu(const tensor::Conv2DOp&) noexcept;
+
 template <typename T>
 std::vector<T> matrix_multiply(std::size_t dim_l, std::size_t dim_m, std::size_t dim_n,
                                const std::vector<T>& A, const std::vector<T>& B);
@@ -45,13 +65,89 @@ void matrix_multiply(std::size_t dim_l, std::size_t dim_m, std::size_t dim_n, co
 template <typename T>
 void matrix_multiply(const tensor::GemmOp&, const T* A, const T* B, T* output);
 
+// Only the block [row_begin, row_end) x [column_begin, column_end) of the output, evaluated on the
+// calling thread, e.g., to distribute a product over the fibers of an ExecutionContext.
+template <typename T>
+void matrix_multiply(const tensor::GemmOp&, const T* A, const T* B, T* output,
+                     std::size_t row_begin, std::size_t row_end, std::size_t column_begin,
+                     std::size_t column_end);
+
+// matrix in compressed sparse row format: the nonzero entries of row i are stored in
+// values_[row_ptr_[i], row_ptr_[i + 1]) and their columns in col_idx_[row_ptr_[i], row_ptr_[i + 1])
+template <typename T>
+struct CSRMatrix {
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<std::size_t> row_ptr_;
+  std::vector<std::size_t> col_idx_;
+  std::vector<T> values_;
+
+  // keep only the nonzero entries of a dense row-major matrix
+  static CSRMatrix from_dense(std::size_t rows, std::size_t cols, const T* dense);
+  std::vector<T> to_dense() const;
+  std::size_t get_num_nonzeros() const noexcept { return col_idx_.size(); }
+  // is the sparsity pattern consistent, i.e., are the rows well-formed and the columns in
+  // range (the values are not checked s.t. a pattern without values is valid, too)
+  bool verify() const noexcept;
+};
+
+// multiply the dense l x m matrix A with the sparse m x n matrix B, i.e., only the nonzero
+// entries of B are touched
+template <typename T>
+void matrix_multiply(std::size_t dim_l, const T* A, const CSRMatrix<T>& B, T* output);
+
 template <typename T>
 std::vector<T> convolution(const tensor::Conv2DOp&, const std::vector<T>& input,
                            const std::vector<T>& kernel);
 
+// Computed directly on the input without expanding it into an im2col matrix, i.e., apart from
+// input, kernel and output no memory is needed except for the transformed kernels of a tile of
+// output channels if Winograd's algorithm is used, see get_convolution_algorithm().
 template <typename T>
 void convolution(const tensor::Conv2DOp&, const T* input, const T* kernel, T* output);
 
+// 3x3 kernels with stride and dilation 1 of 32 bit values are evaluated with Winograd's minimal
+// filtering F(4x4, 3x3), or F(2x2, 3x3) if the output has less than 4 rows or columns, which needs
+// 36 instead of 144 (16 instead of 36) multiplications per tile of outputs and input channel.  Its
+// transforms have fractional coefficients, so they are scaled to integers, evaluated modulo 2^64
+// and the scale is divided out exactly at the end, i.e., the result is the same as the one of the
+// direct convolution.  64 bit values would need products modulo 2^128, which are slower than the
+// direct convolution, so they use it like all other shapes and strides.
+enum class ConvolutionAlgorithm { direct, winograd_2x2, winograd_4x4 };
+template <typename T>
+ConvolutionAlgorithm get_convolution_algorithm(const tensor::Conv2DOp&) noexcept;
+
+// The output is computed in independent units, i.e., one output row (a block of four rows for 3x3
+// kernels with stride and dilation 1) of a tile of output channels of one sample each.  This
+// evaluates the units [unit_begin, unit_end) on the calling thread.
+std::size_t get_convolution_num_units(const tensor::Conv2DOp&) noexcept;
+template <typename T>
+void convolution(const tensor::Conv2DOp&, const T* input, const T* kernel, T* output,
+                 std::size_t unit_begin, std::size_t unit_end);
+
+// Peak memory in bytes of convolution() with elements of `element_size` bytes, together with the
+// size of the im2col matrix of the input which it avoids.
+struct ConvolutionMemory {
+  std::size_t peak_bytes;
+  std::size_t im2col_bytes;
+};
+ConvolutionMemory get_convolution_memory(const tensor::Conv2DOp&,
+                                         std::size_t element_size) noexcept;
+
+// Cross-correlation of a single channel, i.e., output[s] = sum_(p < kernel_size) input[s + p] *
+// kernel[p] for the input_size - kernel_size + 1 positions s.  Kernels of at least
+// ntt_correlation_threshold values are correlated with number theoretic transforms modulo three
+// primes whose product exceeds the sums over the integers, and the result modulo 2^k is
+// reconstructed with the CRT.  This takes O(n log n) instead of O(n * kernel_size) operations.
+// T has at most 64 bits.
+template <typename T>
+void cross_correlation(const T* input, std::size_t input_size, const T* kernel,
+                       std::size_t kernel_size, T* output);
+// about where the NTT gets faster than the direct computation on 64 bit values
+constexpr std::size_t ntt_correlation_threshold = 512;
+
+// Sum of every window of the pooling, without dividing by the kernel size.  The channels are
+// distributed over the linear algebra threads.
 template <typename T>
 void sum_pool(const tensor::AveragePoolOp&, const T* input, T* output);
 
@@ -0,0 +1,273 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "linear_algebra_gpu.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <cuda_runtime.h>
+
+namespace MOTION::gpu {
+
+namespace {
+
+void check(cudaError_t error, const char* what) {
+  if (error != cudaSuccess) {
+    throw std::runtime_error(std::string("CUDA error in ") + what + ": " +
+                             cudaGetErrorString(error));
+  }
+}
+
+// Two streams per thread: the chunks of an output alternate between them, s.t. the copy of one
+// chunk back to the host overlaps with the computation of the next one.  Since every thread has
+// its own streams, the products of the setup and the online phase of different layers overlap,
+// too.
+struct ThreadStreams {
+  ThreadStreams() {
+    for (auto& stream : streams_) {
+      check(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreate");
+    }
+  }
+  ~ThreadStreams() {
+    for (auto stream : streams_) {
+      cudaStreamDestroy(stream);
+    }
+  }
+  std::array<cudaStream_t, 2> streams_;
+};
+
+ThreadStreams& get_thread_streams() {
+  thread_local ThreadStreams streams;
+  return streams;
+}
+
+// device memory which is allocated and freed in stream order
+template <typename T>
+class DeviceBuffer {
+ public:
+  DeviceBuffer(std::size_t size, cudaStream_t stream) : stream_(stream) {
+    check(cudaMallocAsync(reinterpret_cast<void**>(&data_), size * sizeof(T), stream),
+          "cudaMallocAsync");
+  }
+  DeviceBuffer(const T* host_data, std::size_t size, cudaStream_t stream)
+      : DeviceBuffer(size, stream) {
+    check(cudaMemcpyAsync(data_, host_data, size * sizeof(T), cudaMemcpyHostToDevice, stream),
+          "cudaMemcpyAsync");
+  }
+  ~DeviceBuffer() { cudaFreeAsync(data_, stream_); }
+  DeviceBuffer(const DeviceBuffer&) = delete;
+  DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+  T* get() const noexcept { return data_; }
+
+ private:
+  T* data_ = nullptr;
+  cudaStream_t stream_;
+};
+
+// elements of the output per chunk which is copied back at once
+constexpr std::size_t chunk_size = std::size_t(1) << 20;
+
+// Compute the output of `num_units` units of `unit_size` elements each with
+// launch(stream, unit_begin, unit_end) in chunks and copy them back to the host.  The inputs
+// have been copied with the first stream.  The kernel of the next chunk is launched before the
+// copy of the current one, since a copy to pageable host memory blocks the calling thread.
+template <typename T, typename LaunchFctn>
+void compute_in_chunks(T* output, T* device_output, std::size_t num_units, std::size_t unit_size,
+                       LaunchFctn launch) {
+  auto& streams = get_thread_streams().streams_;
+  // the second stream must not start before the inputs are on the device
+  check(cudaStreamSynchronize(streams[0]), "cudaStreamSynchronize");
+  const auto units_per_chunk = std::max(std::size_t(1), chunk_size / unit_size);
+  const auto num_chunks = (num_units + units_per_chunk - 1) / units_per_chunk;
+  const auto launch_chunk = [&](std::size_t chunk_i) {
+    const auto begin = chunk_i * units_per_chunk;
+    launch(streams[chunk_i % 2], begin, std::min(begin + units_per_chunk, num_units));
+    check(cudaGetLastError(), "kernel launch");
+  };
+  launch_chunk(0);
+  for (std::size_t chunk_i = 0; chunk_i < num_chunks; ++chunk_i) {
+    if (chunk_i + 1 < num_chunks) {
+      launch_chunk(chunk_i + 1);
+    }
+    const auto begin = chunk_i * units_per_chunk;
+    const auto end = std::min(begin + units_per_chunk, num_units);
+    check(cudaMemcpyAsync(output + begin * unit_size, device_output + begin * unit_size,
+                          (end - begin) * unit_size * sizeof(T), cudaMemcpyDeviceToHost,
+                          streams[chunk_i % 2]),
+          "cudaMemcpyAsync");
+  }
+  for (auto stream : streams) {
+    check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+  }
+}
+
+constexpr unsigned int tile_size = 16;
+
+// op(A)[i][k] = A[i * a_row_stride + k * a_column_stride] and analogously for op(B), each block
+// computes a tile of the rows [row_begin, row_end) of the output
+template <typename T>
+__global__ void matrix_multiply_kernel(const T* A, std::size_t a_row_stride,
+                                       std::size_t a_column_stride, const T* B,
+                                       std::size_t b_row_stride, std::size_t b_column_stride,
+                                       T* output, std::size_t row_begin, std::size_t row_end,
+                                       std::size_t dim_m, std::size_t dim_n) {
+  __shared__ T tile_A[tile_size][tile_size];
+  __shared__ T tile_B[tile_size][tile_size];
+  const std::size_t row = row_begin + blockIdx.y * tile_size + threadIdx.y;
+  const std::size_t column = blockIdx.x * tile_size + threadIdx.x;
+  T sum = 0;
+  for (std::size_t k_begin = 0; k_begin < dim_m; k_begin += tile_size) {
+    const std::size_t k_A = k_begin + threadIdx.x;
+    const std::size_t k_B = k_begin + threadIdx.y;
+    tile_A[threadIdx.y][threadIdx.x] =
+        (row < row_end && k_A < dim_m) ? A[row * a_row_stride + k_A * a_column_stride] : T(0);
+    tile_B[threadIdx.y][threadIdx.x] =
+        (k_B < dim_m && column < dim_n) ? B[k_B * b_row_stride + column * b_column_stride] : T(0);
+    __syncthreads();
+    for (unsigned int k = 0; k < tile_size; ++k) {
+      sum += tile_A[threadIdx.y][k] * tile_B[k][threadIdx.x];
+    }
+    __syncthreads();
+  }
+  if (row < row_end && column < dim_n) {
+    output[row * dim_n + column] = sum;
+  }
+}
+
+// one thread per output element in [begin, end) of the output in NCHW order
+template <typename T>
+__global__ void convolution_kernel(ConvolutionShape shape, const T* input, const T* kernel,
+                                   T* output, std::size_t begin, std::size_t end) {
+  const std::size_t index = begin + std::size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (index >= end) {
+    return;
+  }
+  const std::size_t ow = index % shape.out_columns;
+  const std::size_t oh = (index / shape.out_columns) % shape.out_rows;
+  const std::size_t oc = (index / (shape.out_columns * shape.out_rows)) % shape.out_channels;
+  const std::size_t sample = index / (shape.out_columns * shape.out_rows * shape.out_channels);
+  const auto in_rows = static_cast<std::ptrdiff_t>(shape.in_rows);
+  const auto in_columns = static_cast<std::ptrdiff_t>(shape.in_columns);
+  const T* sample_input = input + sample * shape.in_channels * shape.in_rows * shape.in_columns;
+  const T* oc_kernel = kernel + oc * shape.in_channels * shape.kernel_rows * shape.kernel_columns;
+  T sum = 0;
+  for (std::size_t ic = 0; ic < shape.in_channels; ++ic) {
+    for (std::size_t kh = 0; kh < shape.kernel_rows; ++kh) {
+      const auto ih =
+          static_cast<std::ptrdiff_t>(oh * shape.stride_rows + kh * shape.dilation_rows) -
+          static_cast<std::ptrdiff_t>(shape.pad_top);
+      if (ih < 0 || ih >= in_rows) {
+        continue;
+      }
+      for (std::size_t kw = 0; kw < shape.kernel_columns; ++kw) {
+        const auto iw =
+            static_cast<std::ptrdiff_t>(ow * shape.stride_columns + kw * shape.dilation_columns) -
+            static_cast<std::ptrdiff_t>(shape.pad_left);
+        if (iw < 0 || iw >= in_columns) {
+          continue;
+        }
+        sum += oc_kernel[(ic * shape.kernel_rows + kh) * shape.kernel_columns + kw] *
+               sample_input[(ic * shape.in_rows + ih) * shape.in_columns + iw];
+      }
+    }
+  }
+  output[index] = sum;
+}
+
+}  // namespace
+
+bool is_device_available() noexcept {
+  int num_devices = 0;
+  return cudaGetDeviceCount(&num_devices) == cudaSuccess && num_devices > 0;
+}
+
+template <typename T>
+void matrix_multiply(const T* A, std::size_t rows_A, std::size_t cols_A, bool trans_A,
+                     const T* B, std::size_t rows_B, std::size_t cols_B, bool trans_B,
+                     T* output) {
+  const auto dim_l = trans_A ? cols_A : rows_A;
+  const auto dim_m = trans_A ? rows_A : cols_A;
+  const auto dim_n = trans_B ? rows_B : cols_B;
+  if (dim_l * dim_n == 0) {
+    return;
+  }
+  const auto stream = get_thread_streams().streams_[0];
+  DeviceBuffer<T> device_A(A, rows_A * cols_A, stream);
+  DeviceBuffer<T> device_B(B, rows_B * cols_B, stream);
+  DeviceBuffer<T> device_output(dim_l * dim_n, stream);
+  const auto a_row_stride = trans_A ? 1 : cols_A;
+  const auto a_column_stride = trans_A ? cols_A : 1;
+  const auto b_row_stride = trans_B ? 1 : cols_B;
+  const auto b_column_stride = trans_B ? cols_B : 1;
+  compute_in_chunks(output, device_output.get(), dim_l, dim_n,
+                    [&](cudaStream_t chunk_stream, std::size_t row_begin, std::size_t row_end) {
+                      const dim3 block(tile_size, tile_size);
+                      const dim3 grid((dim_n + tile_size - 1) / tile_size,
+                                      (row_end - row_begin + tile_size - 1) / tile_size);
+                      matrix_multiply_kernel<<<grid, block, 0, chunk_stream>>>(
+                          device_A.get(), a_row_stride, a_column_stride, device_B.get(),
+                          b_row_stride, b_column_stride, device_output.get(), row_begin, row_end,
+                          dim_m, dim_n);
+                    });
+}
+
+template <typename T>
+void convolution(const ConvolutionShape& shape, const T* input, const T* kernel, T* output) {
+  const auto output_size =
+      shape.batch_size * shape.out_channels * shape.out_rows * shape.out_columns;
+  if (output_size == 0) {
+    return;
+  }
+  const auto stream = get_thread_streams().streams_[0];
+  DeviceBuffer<T> device_input(
+      input, shape.batch_size * shape.in_channels * shape.in_rows * shape.in_columns, stream);
+  DeviceBuffer<T> device_kernel(
+      kernel, shape.out_channels * shape.in_channels * shape.kernel_rows * shape.kernel_columns,
+      stream);
+  DeviceBuffer<T> device_output(output_size, stream);
+  constexpr unsigned int block_size = 256;
+  compute_in_chunks(output, device_output.get(), output_size, 1,
+                    [&](cudaStream_t chunk_stream, std::size_t begin, std::size_t end) {
+                      const auto num_blocks =
+                          static_cast<unsigned int>((end - begin + block_size - 1) / block_size);
+                      convolution_kernel<<<num_blocks, block_size, 0, chunk_stream>>>(
+                          shape, device_input.get(), device_kernel.get(), device_output.get(),
+                          begin, end);
+                    });
+}
+
+template void matrix_multiply(const std::uint32_t*, std::size_t, std::size_t, bool,
+                              const std::uint32_t*, std::size_t, std::size_t, bool,
+                              std::uint32_t*);
+template void matrix_multiply(const std::uint64_t*, std::size_t, std::size_t, bool,
+                              const std::uint64_t*, std::size_t, std::size_t, bool,
+                              std::uint64_t*);
+template void convolution(const ConvolutionShape&, const std::uint32_t*, const std::uint32_t*,
+                          std::uint32_t*);
+template void convolution(const ConvolutionShape&, const std::uint64_t*, const std::uint64_t*,
+                          std::uint64_t*);
+
+}  // namespace MOTION::gpu
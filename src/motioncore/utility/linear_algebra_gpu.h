@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+// Products of the linear algebra functions evaluated on a CUDA device, which are only available
+// in builds with MOTION_USE_CUDA, see set_linear_algebra_gpu_min_work().  This header is included
+// by the CUDA sources, so it does not depend on the rest of the library.
+
+namespace MOTION::gpu {
+
+// shape of a 2D convolution, see tensor::Conv2DOp
+struct ConvolutionShape {
+  std::size_t batch_size;
+  std::size_t in_channels;
+  std::size_t in_rows;
+  std::size_t in_columns;
+  std::size_t out_channels;
+  std::size_t out_rows;
+  std::size_t out_columns;
+  std::size_t kernel_rows;
+  std::size_t kernel_columns;
+  std::size_t stride_rows;
+  std::size_t stride_columns;
+  std::size_t dilation_rows;
+  std::size_t dilation_columns;
+  std::size_t pad_top;
+  std::size_t pad_left;
+};
+
+bool is_device_available() noexcept;
+
+// op(A) * op(B) where op transposes the matrix if requested (A and B are given in their stored
+// shapes), T is std::uint32_t or std::uint64_t
+template <typename T>
+void matrix_multiply(const T* A, std::size_t rows_A, std::size_t cols_A, bool trans_A,
+                     const T* B, std::size_t rows_B, std::size_t cols_B, bool trans_B,
+                     T* output);
+
+template <typename T>
+void convolution(const ConvolutionShape&, const T* input, const T* kernel, T* output);
+
+}  // namespace MOTION::gpu
@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+
+#include <fmt/format.h>
+
+namespace MOTION {
+
+MappedFile::MappedFile(const std::string& path) : path_(path) {
+  int fd = ::open(path_.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            fmt::format("MappedFile: could not open {}", path_));
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == -1) {
+    auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("MappedFile: could not stat {}", path_));
+  }
+  size_ = file_stat.st_size;
+  if (size_ == 0) {
+    // mmap does not accept empty mappings
+    ::close(fd);
+    return;
+  }
+  mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  auto error = errno;
+  ::close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::system_error(error, std::generic_category(),
+                            fmt::format("MappedFile: could not map {}", path_));
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, size_);
+  }
+}
+
+void MappedFile::advise_sequential() const noexcept {
+  if (mapping_ != nullptr) {
+    ::madvise(mapping_, size_, MADV_SEQUENTIAL);
+  }
+}
+
+}  // namespace MOTION
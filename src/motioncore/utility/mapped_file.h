@@ -0,0 +1,59 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace MOTION {
+
+// Read-only memory mapping of a whole file, e.g., of a multi-GB input, whose pages are only
+// loaded when they are accessed and can be dropped by the kernel again, so the memory used by the
+// process stays bounded.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::span<const std::byte> get_data() const noexcept {
+    return {static_cast<const std::byte*>(mapping_), size_};
+  }
+  std::size_t get_size() const noexcept { return size_; }
+  const std::string& get_path() const noexcept { return path_; }
+
+  // tell the kernel that the mapping is read front to back, s.t. it reads ahead and drops the
+  // pages behind the reader
+  void advise_sequential() const noexcept;
+
+ private:
+  std::string path_;
+  void* mapping_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace MOTION
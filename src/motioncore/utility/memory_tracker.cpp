@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "memory_tracker.h"
+
+namespace ENCRYPTO {
+
+MemoryTracker& MemoryTracker::get_instance() noexcept {
+  static MemoryTracker instance;
+  return instance;
+}
+
+void MemoryTracker::record_allocation(std::size_t num_bytes) noexcept {
+  const auto current = current_bytes_.fetch_add(num_bytes, std::memory_order_relaxed) + num_bytes;
+  auto peak = peak_bytes_.load(std::memory_order_relaxed);
+  while (peak < current &&
+         !peak_bytes_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryTracker::record_deallocation(std::size_t num_bytes) noexcept {
+  current_bytes_.fetch_sub(num_bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::reset_peak() noexcept {
+  peak_bytes_.store(current_bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ENCRYPTO {
+
+// Process wide number of the bytes held by the containers with a CountingAllocator, i.e., by
+// the BitVectors if MOTION_MEMORY_TRACKING is enabled.  The peak is a high-water mark which is
+// restarted by reset_peak(), e.g., at the beginning of each phase of a run.
+class MemoryTracker {
+ public:
+  static MemoryTracker& get_instance() noexcept;
+
+  void record_allocation(std::size_t num_bytes) noexcept;
+  void record_deallocation(std::size_t num_bytes) noexcept;
+
+  std::size_t get_current_bytes() const noexcept {
+    return current_bytes_.load(std::memory_order_relaxed);
+  }
+  // largest number of bytes held at once since the last reset_peak()
+  std::size_t get_peak_bytes() const noexcept {
+    return peak_bytes_.load(std::memory_order_relaxed);
+  }
+  // start a new high-water mark at the current number of bytes
+  void reset_peak() noexcept;
+
+ private:
+  std::atomic<std::size_t> current_bytes_{0};
+  std::atomic<std::size_t> peak_bytes_{0};
+};
+
+// Allocator which takes its memory from Base and counts it in the MemoryTracker.
+template <typename T, typename Base = std::allocator<T>>
+class CountingAllocator {
+  using base_traits = std::allocator_traits<Base>;
+
+ public:
+  using value_type = T;
+  template <typename U>
+  struct rebind {
+    using other = CountingAllocator<U, typename base_traits::template rebind_alloc<U>>;
+  };
+
+  CountingAllocator() noexcept = default;
+  template <typename U, typename Base2>
+  CountingAllocator(const CountingAllocator<U, Base2>& other) noexcept
+      : base_(other.get_base()) {}
+
+  T* allocate(std::size_t n) {
+    auto p = base_traits::allocate(base_, n);
+    MemoryTracker::get_instance().record_allocation(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    base_traits::deallocate(base_, p, n);
+    MemoryTracker::get_instance().record_deallocation(n * sizeof(T));
+  }
+
+  const Base& get_base() const noexcept { return base_; }
+
+  template <typename U, typename Base2>
+  bool operator==(const CountingAllocator<U, Base2>&) const noexcept {
+    return true;
+  }
+  template <typename U, typename Base2>
+  bool operator!=(const CountingAllocator<U, Base2>&) const noexcept {
+    return false;
+  }
+
+ private:
+  [[no_unique_address]] Base base_;
+};
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,240 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+namespace ENCRYPTO {
+
+// counters of a BasicMPSCQueue to check how much the producers contend for it
+struct MPSCQueueStatistics {
+  // batches returned by batch_dequeue and the elements in them
+  std::size_t num_batches = 0;
+  std::size_t num_elements = 0;
+  std::size_t max_batch_size = 0;
+  // failed attempts of producers to link their element, i.e., another producer was faster
+  std::size_t num_enqueue_retries = 0;
+  // number of times the consumer found the queue empty and went to sleep
+  std::size_t num_consumer_waits = 0;
+};
+
+/**
+ * Closable multi-producer single-consumer queue for elements of type T.
+ *
+ * Producers push their element onto a lock-free linked stack with a single
+ * compare-and-swap.  The consumer takes the whole stack with one exchange and
+ * reverses it, so batch_dequeue returns all elements enqueued so far in the
+ * order in which they were linked.  The mutex and the condition variable are
+ * only used when the consumer finds the queue empty and needs to sleep,
+ * producers only touch them if the consumer is sleeping.
+ */
+template <typename T, typename MutexType, typename CVType>
+class BasicMPSCQueue {
+ public:
+  BasicMPSCQueue() = default;
+  BasicMPSCQueue(const BasicMPSCQueue&) = delete;
+  BasicMPSCQueue& operator=(const BasicMPSCQueue&) = delete;
+  ~BasicMPSCQueue() { delete_nodes(head_.load(std::memory_order_acquire)); }
+
+  /**
+   * Check if queue is empty.
+   */
+  bool empty() const noexcept { return head_.load(std::memory_order_acquire) == nullptr; }
+
+  /**
+   * Check if queue is closed.
+   */
+  bool closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+  /**
+   * Close the queue.  The consumer still receives the elements enqueued before.
+   */
+  void close() noexcept {
+    closed_.store(true, std::memory_order_seq_cst);
+    { std::scoped_lock lock(mutex_); }
+    cv_.notify_all();
+  }
+
+  /**
+   * Add a new element to the queue.
+   */
+  void enqueue(const T& item) { push(new Node{T(item), nullptr}); }
+  void enqueue(T&& item) { push(new Node{std::move(item), nullptr}); }
+
+  /**
+   * Replace the contents of batch by all elements of the queue, wait if it is
+   * empty.  Returns false if the queue is closed and empty.  Only one thread
+   * may call this at a time.
+   */
+  bool batch_dequeue(std::vector<T>& batch) {
+    batch.clear();
+    auto* head = head_.exchange(nullptr, std::memory_order_acquire);
+    while (head == nullptr) {
+      if (closed_.load(std::memory_order_seq_cst)) {
+        // elements enqueued before the queue was closed
+        head = head_.exchange(nullptr, std::memory_order_acquire);
+        if (head == nullptr) {
+          return false;
+        }
+        break;
+      }
+      {
+        std::unique_lock lock(mutex_);
+        consumer_waiting_.store(true, std::memory_order_seq_cst);
+        cv_.wait(lock, [this] {
+          return head_.load(std::memory_order_seq_cst) != nullptr ||
+                 closed_.load(std::memory_order_seq_cst);
+        });
+        consumer_waiting_.store(false, std::memory_order_relaxed);
+      }
+      stats_.num_consumer_waits.fetch_add(1, std::memory_order_relaxed);
+      head = head_.exchange(nullptr, std::memory_order_acquire);
+    }
+    take_batch(head, batch);
+    return true;
+  }
+
+  /**
+   * Same as batch_dequeue, but returns false instead of waiting if the queue
+   * is empty.
+   */
+  bool try_batch_dequeue(std::vector<T>& batch) {
+    batch.clear();
+    auto* head = head_.exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr) {
+      return false;
+    }
+    take_batch(head, batch);
+    return true;
+  }
+
+  MPSCQueueStatistics get_statistics() const noexcept {
+    return {stats_.num_batches.load(std::memory_order_relaxed),
+            stats_.num_elements.load(std::memory_order_relaxed),
+            stats_.max_batch_size.load(std::memory_order_relaxed),
+            stats_.num_enqueue_retries.load(std::memory_order_relaxed),
+            stats_.num_consumer_waits.load(std::memory_order_relaxed)};
+  }
+
+  void reset_statistics() noexcept {
+    stats_.num_batches = 0;
+    stats_.num_elements = 0;
+    stats_.max_batch_size = 0;
+    stats_.num_enqueue_retries = 0;
+    stats_.num_consumer_waits = 0;
+  }
+
+ private:
+  struct Node {
+    T item;
+    Node* next;
+  };
+
+  void push(Node* node) {
+    if (closed_.load(std::memory_order_relaxed)) {
+      delete node;
+      throw std::logic_error("Tried to enqueue in closed BasicMPSCQueue");
+    }
+    node->next = head_.load(std::memory_order_relaxed);
+    std::size_t num_retries = 0;
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+      ++num_retries;
+    }
+    if (num_retries > 0) {
+      stats_.num_enqueue_retries.fetch_add(num_retries, std::memory_order_relaxed);
+    }
+    // either the consumer sees the element before it sleeps or we see that it sleeps
+    if (consumer_waiting_.load(std::memory_order_seq_cst)) {
+      { std::scoped_lock lock(mutex_); }
+      cv_.notify_one();
+    }
+  }
+
+  // move the elements of the stack starting at head into batch
+  void take_batch(Node* head, std::vector<T>& batch) {
+    // the stack holds the newest element first
+    Node* fifo = nullptr;
+    std::size_t size = 0;
+    while (head != nullptr) {
+      auto* next = head->next;
+      head->next = fifo;
+      fifo = head;
+      head = next;
+      ++size;
+    }
+    batch.reserve(size);
+    while (fifo != nullptr) {
+      batch.emplace_back(std::move(fifo->item));
+      auto* next = fifo->next;
+      delete fifo;
+      fifo = next;
+    }
+
+    stats_.num_batches.fetch_add(1, std::memory_order_relaxed);
+    stats_.num_elements.fetch_add(size, std::memory_order_relaxed);
+    if (size > stats_.max_batch_size.load(std::memory_order_relaxed)) {
+      stats_.max_batch_size.store(size, std::memory_order_relaxed);
+    }
+  }
+
+  static void delete_nodes(Node* node) noexcept {
+    while (node != nullptr) {
+      auto* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  // the producers contend for the head, keep it on a cache line of its own
+  alignas(64) std::atomic<Node*> head_ = nullptr;
+  alignas(64) std::atomic<bool> consumer_waiting_ = false;
+  std::atomic<bool> closed_ = false;
+  mutable MutexType mutex_;
+  CVType cv_;
+
+  struct {
+    std::atomic<std::size_t> num_batches = 0;
+    std::atomic<std::size_t> num_elements = 0;
+    std::atomic<std::size_t> max_batch_size = 0;
+    std::atomic<std::size_t> num_enqueue_retries = 0;
+    std::atomic<std::size_t> num_consumer_waits = 0;
+  } stats_;
+};
+
+template <typename T>
+using MPSCQueue = BasicMPSCQueue<T, std::mutex, std::condition_variable>;
+
+template <typename T>
+using MPSCFiberQueue = BasicMPSCQueue<T, boost::fibers::mutex, boost::fibers::condition_variable>;
+
+}  // namespace ENCRYPTO
@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+namespace ENCRYPTO {
+
+namespace detail {
+
+// each flag has a mutex and a condition variable of its own
+template <typename MutexType, typename CVType>
+class InlineParking {
+ protected:
+  MutexType& get_mutex() const noexcept { return mutex_; }
+  CVType& get_cv() const noexcept { return cv_; }
+
+ private:
+  mutable MutexType mutex_;
+  mutable CVType cv_;
+};
+
+// the flags share a table of mutexes and condition variables indexed by their address, such that
+// a flag only consists of its atomic word, e.g., for the readiness of the many wires of a circuit
+template <typename MutexType, typename CVType>
+class SharedParking {
+ protected:
+  MutexType& get_mutex() const noexcept { return get_slot().mutex; }
+  CVType& get_cv() const noexcept { return get_slot().cv; }
+
+ private:
+  static constexpr std::size_t num_slots = 256;
+  struct alignas(64) Slot {
+    MutexType mutex;
+    CVType cv;
+  };
+  Slot& get_slot() const noexcept {
+    static Slot slots[num_slots];
+    const auto address = reinterpret_cast<std::uintptr_t>(this);
+    return slots[(address >> 4) % num_slots];
+  }
+};
+
+}  // namespace detail
+
+// Flag which can be set once and waited for, e.g., for a value or a wire becoming ready.  Setting
+// the flag and waiting for a flag which is already set only access an atomic word.  The mutex and
+// the condition variable are only used when a waiter needs to park, which it records in the word,
+// so that Set() takes the mutex only if somebody is waiting.
+template <typename Parking>
+class BasicParkingFlag : private Parking {
+ public:
+  BasicParkingFlag() = default;
+  BasicParkingFlag(const BasicParkingFlag&) = delete;
+  BasicParkingFlag& operator=(const BasicParkingFlag&) = delete;
+
+  // set the flag and wake up all waiters, returns false if it was already set
+  bool Set() noexcept {
+    const auto previous = state_.fetch_or(set_bit, std::memory_order_acq_rel);
+    if (previous & waiting_bit) {
+      // a waiter which has not started waiting yet holds the mutex and will see the flag
+      { std::scoped_lock lock(this->get_mutex()); }
+      this->get_cv().notify_all();
+    }
+    return !(previous & set_bit);
+  }
+
+  // clear the flag, nobody must be waiting
+  void Reset() noexcept { state_.store(0, std::memory_order_release); }
+
+  bool IsSet() const noexcept { return state_.load(std::memory_order_acquire) & set_bit; }
+
+  // block until the flag is set
+  void Wait() const noexcept {
+    if (IsSet()) {
+      return;
+    }
+    std::unique_lock lock(this->get_mutex());
+    if (state_.fetch_or(waiting_bit, std::memory_order_acq_rel) & set_bit) {
+      return;
+    }
+    // with shared parking, the condition variable may also be notified for other flags
+    this->get_cv().wait(lock, [this] { return IsSet(); });
+  }
+
+ private:
+  static constexpr std::uint32_t set_bit = 1;
+  static constexpr std::uint32_t waiting_bit = 2;
+
+  mutable std::atomic<std::uint32_t> state_ = 0;
+};
+
+template <typename MutexType, typename CVType>
+using ParkingFlag = BasicParkingFlag<detail::InlineParking<MutexType, CVType>>;
+
+using FiberFlag = ParkingFlag<boost::fibers::mutex, boost::fibers::condition_variable>;
+
+// FiberFlag of the size of an atomic word
+using CompactFiberFlag = BasicParkingFlag<
+    detail::SharedParking<boost::fibers::mutex, boost::fibers::condition_variable>>;
+
+}  // namespace ENCRYPTO
@@ -34,6 +34,10 @@
 #include <mutex>
 #include <type_traits>
 
+#include "parking_flag.h"
+#include "statistics/trace_recorder.h"
+#include "utility/constants.h"
+
 namespace ENCRYPTO {
 
 namespace detail {
@@ -117,14 +121,75 @@ class ReusableSharedState {
   void delete_helper() noexcept { reinterpret_cast<R*>(&value_storage_)->~R(); }
 };
 
+// Shared state for a single producer and a single consumer, which only accesses an atomic word
+// if the value is set before it is retrieved.  The mutex and condition variable are only used
+// when the consumer needs to park, see ParkingFlag.
+template <typename R, typename MutexType, typename CVType>
+class SPSCReusableSharedState {
+ public:
+  SPSCReusableSharedState() = default;
+  ~SPSCReusableSharedState() {
+    if (contains_value()) {
+      delete_helper();
+    }
+  }
+
+  // set value
+  template <typename Arg>
+  void set(Arg&& arg) {
+    if (contains_value()) {
+      throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+    // construct R from argument in the allocated value_storage and publish it
+    new (&value_storage_) R(std::forward<Arg>(arg));
+    ready_.Set();
+  }
+
+  // remove value if present, the consumer must not be waiting
+  void reset() noexcept {
+    if (contains_value()) {
+      delete_helper();
+      ready_.Reset();
+    }
+  }
+
+  // wait until there is a value
+  void wait() const noexcept { ready_.Wait(); }
+
+  // move value out of the shared state
+  R move() noexcept {
+    ready_.Wait();
+    auto& value = *reinterpret_cast<R*>(&value_storage_);
+    R result(std::move(value));
+    delete_helper();
+    // the producer may set the next value from now on
+    ready_.Reset();
+    return result;
+  }
+
+  // check if there is some value stored
+  bool contains_value() const noexcept { return ready_.IsSet(); }
+
+ private:
+  // storage for the value
+  std::aligned_storage_t<sizeof(R), std::alignment_of_v<R>> value_storage_;
+
+  // set while there is a value in the shared state
+  ParkingFlag<MutexType, CVType> ready_;
+
+  // delete the stored object
+  void delete_helper() noexcept { reinterpret_cast<R*>(&value_storage_)->~R(); }
+};
+
 }  // namespace detail
 
-template <typename R, typename MutexType, typename CVType>
+template <typename R, typename MutexType, typename CVType, typename SharedState>
 class ReusablePromise;
 
 // std::future-like future whose value can be set and read repeatedly,
 // basically the consumer end of a channel with a capacity of one
-template <typename R, typename MutexType = std::mutex, typename CVType = std::condition_variable>
+template <typename R, typename MutexType = std::mutex, typename CVType = std::condition_variable,
+          typename SharedState = detail::ReusableSharedState<R, MutexType, CVType>>
 class ReusableFuture {
  public:
   // create future without associated state
@@ -155,6 +220,9 @@ class ReusableFuture {
     if (!shared_state_) {
       throw std::future_error(std::future_errc::no_state);
     }
+    if constexpr (MOTION::MOTION_TRACING) {
+      wait_traced();
+    }
     return shared_state_->move();
   }
 
@@ -165,35 +233,50 @@ class ReusableFuture {
   bool valid() const noexcept { return shared_state_ != nullptr; }
 
   // wait until the future gets ready
-  void wait() const { shared_state_->wait(); }
+  void wait() const {
+    if constexpr (MOTION::MOTION_TRACING) {
+      wait_traced();
+    }
+    shared_state_->wait();
+  }
 
   // TODO: wait_for, wait_until
 
  private:
   // allow ReusablePromise to use the following constructor
-  friend ReusablePromise<R, MutexType, CVType>;
+  friend ReusablePromise<R, MutexType, CVType, SharedState>;
+
+  // record the time the calling thread blocks until the value is set
+  void wait_traced() const {
+    if (!shared_state_->contains_value()) {
+      MOTION::Statistics::TraceScope scope("wait", "future");
+      shared_state_->wait();
+    }
+  }
 
   // create future with associated state
-  ReusableFuture(
-      std::shared_ptr<detail::ReusableSharedState<R, MutexType, CVType>> shared_state) noexcept
+  ReusableFuture(std::shared_ptr<SharedState> shared_state) noexcept
       : shared_state_(std::move(shared_state)) {}
 
   // pointer to the shared state
-  std::shared_ptr<detail::ReusableSharedState<R, MutexType, CVType>> shared_state_;
+  std::shared_ptr<SharedState> shared_state_;
 };
 
+// futures of fibers have a single consumer and use the lock-free shared state
 template <typename R>
 using ReusableFiberFuture =
-    ReusableFuture<R, boost::fibers::mutex, boost::fibers::condition_variable>;
+    ReusableFuture<R, boost::fibers::mutex, boost::fibers::condition_variable,
+                   detail::SPSCReusableSharedState<R, boost::fibers::mutex,
+                                                   boost::fibers::condition_variable>>;
 
 // std::promise-like promise which can be used repeatedly to set thevalue in the corresponding
 // shared state, basically the produceer end of a channel with a capacity of one
-template <typename R, typename MutexType = std::mutex, typename CVType = std::condition_variable>
+template <typename R, typename MutexType = std::mutex, typename CVType = std::condition_variable,
+          typename SharedState = detail::ReusableSharedState<R, MutexType, CVType>>
 class ReusablePromise {
  public:
   ReusablePromise() noexcept
-      : shared_state_(std::make_shared<detail::ReusableSharedState<R, MutexType, CVType>>()),
-        future_retrieved_(false) {}
+      : shared_state_(std::make_shared<SharedState>()), future_retrieved_(false) {}
 
   // no copy constructor
   ReusablePromise(const ReusablePromise&) = delete;
@@ -236,7 +319,7 @@ class ReusablePromise {
   }
 
   // returns future associated with the shared state of the promise
-  ReusableFuture<R, MutexType, CVType> get_future() {
+  ReusableFuture<R, MutexType, CVType, SharedState> get_future() {
     if (!shared_state_) {
       throw std::future_error(std::future_errc::no_state);
     }
@@ -244,7 +327,7 @@ class ReusablePromise {
       throw std::future_error(std::future_errc::future_already_retrieved);
     }
     future_retrieved_ = true;
-    return ReusableFuture(shared_state_);
+    return ReusableFuture<R, MutexType, CVType, SharedState>(shared_state_);
   }
 
   // swaps this future with another
@@ -254,18 +337,21 @@ class ReusablePromise {
   }
 
  private:
-  std::shared_ptr<detail::ReusableSharedState<R, MutexType, CVType>> shared_state_;
+  std::shared_ptr<SharedState> shared_state_;
   bool future_retrieved_ = false;
 };
 
+// promises of fibers have a single producer and use the lock-free shared state
 template <typename R>
 using ReusableFiberPromise =
-    ReusablePromise<R, boost::fibers::mutex, boost::fibers::condition_variable>;
+    ReusablePromise<R, boost::fibers::mutex, boost::fibers::condition_variable,
+                    detail::SPSCReusableSharedState<R, boost::fibers::mutex,
+                                                    boost::fibers::condition_variable>>;
 
 // make ReusablePromise swappable
-template <typename R, typename MutexType, typename CVType>
-void swap(ReusablePromise<R, MutexType, CVType>& lhs,
-          ReusablePromise<R, MutexType, CVType>& rhs) noexcept {
+template <typename R, typename MutexType, typename CVType, typename SharedState>
+void swap(ReusablePromise<R, MutexType, CVType, SharedState>& lhs,
+          ReusablePromise<R, MutexType, CVType, SharedState>& rhs) noexcept {
   lhs.swap(rhs);
 }
 
@@ -25,6 +25,9 @@
 #include <cassert>
 #include <ctime>
 #include <fstream>
+#include <sstream>
+
+#include <sys/resource.h>
 
 #include <fmt/chrono.h>
 #include <boost/process/child.hpp>
@@ -76,4 +79,21 @@ std::string get_timestamp() {
   return fmt::format("{:%FT%T%z}.", fmt::localtime(t));
 }
 
+std::size_t get_peak_memory_usage() {
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // the maximum resident set size is given in KiB on Linux
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+double get_process_cpu_time_ms() {
+  timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) / 1e6;
+}
+
 }  // namespace MOTION
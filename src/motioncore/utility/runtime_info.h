@@ -44,4 +44,10 @@ std::string get_username();
 // Get current timestamp
 std::string get_timestamp();
 
+// Get this process' peak resident set size in bytes via getrusage
+std::size_t get_peak_memory_usage();
+
+// Get the CPU time consumed by all threads of this process in milliseconds
+double get_process_cpu_time_ms();
+
 }  // namespace MOTION
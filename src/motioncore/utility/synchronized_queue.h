@@ -24,11 +24,14 @@
 
 #include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <cassert>
+#include <condition_variable>
 #include <future>
 #include <iostream>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <stdexcept>
 
 namespace ENCRYPTO {
 
@@ -164,4 +167,109 @@ template <typename T>
 using SynchronizedFiberQueue =
     BasicSynchronizedQueue<T, boost::fibers::mutex, boost::fibers::condition_variable>;
 
+/**
+ * Synchronized, closable queue holding at most a fixed number of elements.
+ *
+ * Producers block in enqueue while the queue is full, which propagates back
+ * pressure to them.  try_enqueue allows producers to detect this case.
+ */
+template <typename T>
+class BoundedSynchronizedQueue {
+ public:
+  explicit BoundedSynchronizedQueue(std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+      throw std::invalid_argument("BoundedSynchronizedQueue needs a capacity > 0");
+    }
+  }
+
+  std::size_t size() const noexcept {
+    std::scoped_lock lock(mutex_);
+    return queue_.size();
+  }
+
+  std::size_t get_capacity() const noexcept { return capacity_; }
+
+  /**
+   * Close the queue.  Blocked producers return without inserting their element.
+   */
+  void close() noexcept {
+    {
+      std::scoped_lock lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_cv_.notify_all();
+    not_full_cv_.notify_all();
+  }
+
+  /**
+   * Move the element into the queue if it is not full.  Returns the number of
+   * elements in the queue after the insertion or std::nullopt if the queue is
+   * full, in which case item is left untouched.
+   */
+  std::optional<std::size_t> try_enqueue(T& item) {
+    std::size_t size;
+    {
+      std::scoped_lock lock(mutex_);
+      if (closed_) {
+        throw std::logic_error("Tried to enqueue in closed BoundedSynchronizedQueue");
+      }
+      if (queue_.size() >= capacity_) {
+        return std::nullopt;
+      }
+      queue_.push(std::move(item));
+      size = queue_.size();
+    }
+    not_empty_cv_.notify_one();
+    return size;
+  }
+
+  /**
+   * Add a new element to the queue, block while the queue is full.  Returns the
+   * number of elements in the queue after the insertion, or 0 if the queue has
+   * been closed while waiting.
+   */
+  std::size_t enqueue(T&& item) {
+    std::size_t size;
+    {
+      std::unique_lock lock(mutex_);
+      if (closed_) {
+        throw std::logic_error("Tried to enqueue in closed BoundedSynchronizedQueue");
+      }
+      not_full_cv_.wait(lock, [this] { return this->queue_.size() < capacity_ || this->closed_; });
+      if (closed_) {
+        return 0;
+      }
+      queue_.push(std::move(item));
+      size = queue_.size();
+    }
+    not_empty_cv_.notify_one();
+    return size;
+  }
+
+  /**
+   * Extract an element from the queue.
+   */
+  std::optional<T> dequeue() noexcept {
+    std::unique_lock lock(mutex_);
+    not_empty_cv_.wait(lock, [this] { return !this->queue_.empty() || this->closed_; });
+    if (queue_.empty()) {
+      assert(closed_);
+      return std::nullopt;
+    }
+    auto item = std::move(queue_.front());
+    queue_.pop();
+    lock.unlock();
+    not_full_cv_.notify_one();
+    return std::optional<T>(std::move(item));
+  }
+
+ private:
+  const std::size_t capacity_;
+  bool closed_ = false;
+  std::queue<T> queue_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_cv_;
+  std::condition_variable not_full_cv_;
+};
+
 }  // namespace ENCRYPTO
@@ -18,18 +18,136 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <omp.h>
 #include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
 #include <string>
+#include <system_error>
 #include <thread>
 #include "thread.h"
 
 namespace ENCRYPTO {
 
+static thread_local std::size_t this_thread_numa_node = 0;
+static std::atomic<std::size_t> phase_omp_threads = 0;
+
 void thread_set_name(std::thread& thread, const std::string& name) {
   assert(name.size() <= 16);
   auto handle = thread.native_handle();
   pthread_setname_np(handle, name.c_str());
 }
 
+std::string this_thread_get_name() {
+  // at most 16 bytes including the terminating null byte
+  char name[16] = {};
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  return name;
+}
+
+void this_thread_set_affinity(std::size_t cpu) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set); ret != 0) {
+    throw std::system_error(ret, std::generic_category(), "pthread_setaffinity_np");
+  }
+}
+
+// parse a list of CPUs like "0-3,8,10-11"
+static std::vector<std::size_t> parse_cpu_list(const std::string& list) {
+  std::vector<std::size_t> cpus;
+  std::istringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    const auto dash = range.find('-');
+    const std::size_t first = std::stoul(range.substr(0, dash));
+    const std::size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+static std::vector<std::vector<std::size_t>> read_numa_node_cpus() {
+  // only use the CPUs the process is allowed to run on, e.g., restricted by taskset or cgroups
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    throw std::system_error(errno, std::generic_category(), "sched_getaffinity");
+  }
+  auto is_allowed = [&allowed](auto cpu) { return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed); };
+
+  std::map<std::size_t, std::vector<std::size_t>> nodes;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+    const auto name = entry.path().filename().string();
+    if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos) {
+      continue;
+    }
+    std::ifstream file(entry.path() / "cpulist");
+    std::string list;
+    // nodes without CPUs have an empty list
+    if (std::getline(file, list)) {
+      auto cpus = parse_cpu_list(list);
+      std::erase_if(cpus, [&is_allowed](auto cpu) { return !is_allowed(cpu); });
+      if (!cpus.empty()) {
+        nodes.emplace(std::stoul(name.substr(4)), std::move(cpus));
+      }
+    }
+  }
+  std::vector<std::vector<std::size_t>> node_cpus;
+  for (auto& [node, cpus] : nodes) {
+    node_cpus.emplace_back(std::move(cpus));
+  }
+  if (node_cpus.empty()) {
+    auto& cpus = node_cpus.emplace_back();
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (is_allowed(cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return node_cpus;
+}
+
+const std::vector<std::vector<std::size_t>>& get_numa_node_cpus() {
+  static const auto node_cpus = read_numa_node_cpus();
+  return node_cpus;
+}
+
+std::size_t get_this_thread_numa_node() noexcept { return this_thread_numa_node; }
+
+void set_this_thread_numa_node(std::size_t node) noexcept { this_thread_numa_node = node; }
+
+void set_phase_omp_threads(std::size_t num_threads) noexcept {
+  phase_omp_threads.store(num_threads, std::memory_order_relaxed);
+}
+
+std::size_t get_phase_omp_threads() noexcept {
+  return phase_omp_threads.load(std::memory_order_relaxed);
+}
+
+void this_thread_use_phase_omp_threads(std::size_t num_concurrent) {
+  const auto num_threads = get_phase_omp_threads();
+  if (num_threads == 0) {
+    return;
+  }
+  // the number of threads is an internal control variable of the calling thread
+  const auto share = num_threads / std::max(num_concurrent, std::size_t(1));
+  omp_set_num_threads(static_cast<int>(std::max(share, std::size_t(1))));
+}
+
 }  // namespace ENCRYPTO
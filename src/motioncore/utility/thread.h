@@ -20,8 +20,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace ENCRYPTO {
 
@@ -29,4 +31,28 @@ namespace ENCRYPTO {
 // - name.size() <= 16
 void thread_set_name(std::thread& thread, const std::string& name);
 
+// Returns the name of the calling thread, see thread_set_name.
+std::string this_thread_get_name();
+
+// Restricts the calling thread to run only on the given logical CPU.
+void this_thread_set_affinity(std::size_t cpu);
+
+// Returns the logical CPUs of each NUMA node with CPUs as reported by sysfs, or a single node
+// with all CPUs if the topology is not available.
+const std::vector<std::vector<std::size_t>>& get_numa_node_cpus();
+
+// The NUMA node (index into get_numa_node_cpus()) the calling thread was assigned to, 0 if the
+// thread was never assigned to a node.
+std::size_t get_this_thread_numa_node() noexcept;
+void set_this_thread_numa_node(std::size_t node) noexcept;
+
+// Number of OpenMP threads of the data parallel loops of the providers in the current phase of a
+// run, e.g., of the OT extension or of the garbling, set by the executor before each phase (see
+// MOTION::ThreadAllocator).  0 leaves the threads of OpenMP as they are.
+void set_phase_omp_threads(std::size_t num_threads) noexcept;
+std::size_t get_phase_omp_threads() noexcept;
+// Let the OpenMP loops started by the calling thread use the threads of the current phase, split
+// evenly among num_concurrent threads which start such loops at the same time.
+void this_thread_use_phase_omp_threads(std::size_t num_concurrent = 1);
+
 }  // namespace ENCRYPTO
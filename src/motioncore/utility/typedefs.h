@@ -57,6 +57,9 @@ enum class PrimitiveOperationType : std::uint8_t {
   B2Y,  // for GMW only
   Y2A,  // for BMR only
   Y2B,  // for BMR only
+  // comparisons of unsigned values, appended to keep the values stored in binary circuit files
+  GT,  // for Boolean BEAVY only
+  EQ,  // for Boolean BEAVY only
   INVALID
 };
 
@@ -113,6 +116,12 @@ inline std::string ToString(PrimitiveOperationType t) {
     case PrimitiveOperationType::Y2B: {
       return "Y2B";
     }
+    case PrimitiveOperationType::GT: {
+      return "GT";
+    }
+    case PrimitiveOperationType::EQ: {
+      return "EQ";
+    }
     default:
       throw std::invalid_argument("Invalid PrimitiveOperationType");
   }
@@ -25,6 +25,7 @@
 #include "test_constants.h"
 
 #include "crypto/aes/aesni_primitives.h"
+#include "utility/block.h"
 
 // Test vectors from NIST FIPS 197, Appendix A
 
@@ -104,6 +105,35 @@ TEST(aesni128, ctr_stream_unaligned) {
   }
 }
 
+TEST(aesni128, vaes_ctr_stream) {
+  if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("vaes")) {
+    GTEST_SKIP() << "VAES is not available";
+  }
+  std::array<std::uint8_t, aes_key_size_128> key = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                                    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+  alignas(aes_block_size) std::array<std::uint8_t, aes_round_keys_size_128> round_keys;
+  std::copy(std::begin(key), std::end(key), std::begin(round_keys));
+  aesni_key_expansion_128(round_keys.data());
+
+  constexpr std::size_t max_blocks = 50;
+  std::array<std::uint8_t, max_blocks * aes_block_size + 1> output;
+  std::array<std::uint8_t, max_blocks * aes_block_size> expected_output;
+  // also cross the wrap around of the lower 64 bit of the counter within a batch
+  for (std::uint64_t start : {std::uint64_t(0), ~std::uint64_t(0) - 5}) {
+    for (std::size_t n = 0; n <= max_blocks; ++n) {
+      std::uint64_t counter = start;
+      std::uint64_t expected_counter = start;
+      aesni_ctr_stream_blocks_128_unaligned(round_keys.data(), &expected_counter,
+                                            expected_output.data(), n);
+      // write to an odd address
+      vaes_ctr_stream_blocks_128_unaligned(round_keys.data(), &counter, output.data() + 1, n);
+      EXPECT_EQ(counter, expected_counter);
+      EXPECT_TRUE(std::equal(std::begin(output) + 1, std::begin(output) + 1 + n * aes_block_size,
+                             std::begin(expected_output)));
+    }
+  }
+}
+
 TEST(aesni128, ctr_stream_blockwise) {
   std::array<std::uint8_t, aes_key_size_128> key = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
                                                     0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
@@ -172,3 +202,31 @@ TEST(aesni128, mmo_single) {
   aesni_mmo_single(round_keys.data(), output.data());
   EXPECT_EQ(output, expected_output);
 }
+
+TEST(aesni128, bmr_dkc_batch) {
+  std::array<std::uint8_t, aes_key_size_128> key = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                                    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+  alignas(aes_block_size) std::array<std::uint8_t, aes_round_keys_size_128> round_keys;
+  std::copy(std::begin(key), std::end(key), std::begin(round_keys));
+  aesni_key_expansion_128(round_keys.data());
+
+  // the number of blocks is not a multiple of the batch size
+  constexpr std::size_t num_dkcs = 7;
+  constexpr std::size_t num_parties = 3;
+  const auto keys_a = ENCRYPTO::block128_vector::make_random(num_dkcs);
+  const auto keys_b = ENCRYPTO::block128_vector::make_random(num_dkcs);
+  std::array<std::uint64_t, num_dkcs> gate_ids = {0, 1, 2, 42, 43, 1337, 0xffffffffffffffff};
+  const auto initial_output = ENCRYPTO::block128_vector::make_random(num_dkcs * num_parties);
+
+  auto expected_output = initial_output;
+  for (std::size_t dkc_i = 0; dkc_i < num_dkcs; ++dkc_i) {
+    aesni_bmr_dkc(round_keys.data(), keys_a[dkc_i].data(), keys_b[dkc_i].data(), gate_ids[dkc_i],
+                  num_parties, expected_output[dkc_i * num_parties].data());
+  }
+  auto output = initial_output;
+  aesni_bmr_dkc_batch(round_keys.data(), keys_a.data(), keys_b.data(), gate_ids.data(), num_dkcs,
+                      num_parties, output.data());
+  for (std::size_t block_i = 0; block_i < num_dkcs * num_parties; ++block_i) {
+    EXPECT_EQ(output[block_i], expected_output[block_i]);
+  }
+}
@@ -27,6 +27,7 @@
 #include "crypto/base_ots/base_ot_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "utility/helpers.h"
 #include "utility/linear_algebra.h"
 
 template <typename T>
@@ -281,6 +282,50 @@ TYPED_TEST(ArithmeticProviderTest, MatrixMultiplication) {
   }
 }
 
+TYPED_TEST(ArithmeticProviderTest, SparseMatrixMultiplication) {
+  const std::size_t dim_l = 7;
+  const std::size_t dim_m = 13;
+  const std::size_t dim_n = 11;
+
+  // keep about every fourth entry of the sparse matrix, the row with index 2 stays empty
+  auto dense_B = MOTION::Helpers::RandomVector<TypeParam>(dim_m * dim_n);
+  for (std::size_t i = 0; i < dense_B.size(); ++i) {
+    if (i % 4 != 0 || i / dim_n == 2) {
+      dense_B[i] = 0;
+    }
+  }
+  const auto sparse_B = MOTION::CSRMatrix<TypeParam>::from_dense(dim_m, dim_n, dense_B.data());
+  const auto input_A = MOTION::Helpers::RandomVector<TypeParam>(dim_l * dim_m);
+  std::vector<TypeParam> expected_output =
+      MOTION::matrix_multiply(dim_l, dim_m, dim_n, input_A, dense_B);
+
+  // the dense side only knows the sparsity pattern
+  auto pattern = sparse_B;
+  pattern.values_.clear();
+  auto mm_dense_side =
+      this->get_sender_provider()
+          .template register_sparse_matrix_multiplication_dense_side<TypeParam>(dim_l, pattern);
+  auto mm_sparse_side =
+      this->get_receiver_provider()
+          .template register_sparse_matrix_multiplication_sparse_side<TypeParam>(dim_l, sparse_B);
+
+  this->run_setup();
+
+  mm_dense_side->set_input(input_A);
+  mm_sparse_side->set_input(sparse_B.values_);
+  mm_dense_side->compute_output();
+  mm_sparse_side->compute_output();
+  const auto output_sender = mm_dense_side->get_output();
+  const auto output_receiver = mm_sparse_side->get_output();
+
+  ASSERT_EQ(output_sender.size(), dim_l * dim_n);
+  ASSERT_EQ(output_receiver.size(), dim_l * dim_n);
+
+  for (std::size_t i = 0; i < dim_l * dim_n; ++i) {
+    ASSERT_EQ(TypeParam(output_sender[i] + output_receiver[i]), expected_output[i]);
+  }
+}
+
 TYPED_TEST(ArithmeticProviderTest, Convolution) {
   // Convolution from CryptoNets
   const MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {5, 1, 5, 5},
@@ -317,3 +362,82 @@ TYPED_TEST(ArithmeticProviderTest, Convolution) {
     ASSERT_EQ(TypeParam(output_is[i] + output_ks[i]), TypeParam(expected_output[i]));
   }
 }
+
+TYPED_TEST(ArithmeticProviderTest, ConvolutionBatch) {
+  // the samples of the batch are multiplied with the kernel in a single matrix multiplication
+  const MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {4, 2, 3, 3},
+                                            .input_shape_ = {2, 9, 8},
+                                            .output_shape_ = {4, 4, 3},
+                                            .dilations_ = {1, 1},
+                                            .pads_ = {1, 0, 0, 1},
+                                            .strides_ = {2, 2},
+                                            .batch_size_ = 3};
+  ASSERT_TRUE(conv_op.verify());
+
+  const auto input = MOTION::Helpers::RandomVector<TypeParam>(conv_op.compute_input_size());
+  const auto kernel = MOTION::Helpers::RandomVector<TypeParam>(conv_op.compute_kernel_size());
+  std::vector<TypeParam> expected_output = MOTION::convolution(conv_op, input, kernel);
+  ASSERT_EQ(expected_output.size(), conv_op.compute_output_size());
+
+  auto conv_input_side =
+      this->get_sender_provider().template register_convolution_input_side<TypeParam>(conv_op);
+  auto conv_kernel_side =
+      this->get_receiver_provider().template register_convolution_kernel_side<TypeParam>(conv_op);
+
+  this->run_setup();
+
+  conv_input_side->set_input(input);
+  conv_kernel_side->set_input(kernel);
+  conv_input_side->compute_output();
+  conv_kernel_side->compute_output();
+  const auto output_is = conv_input_side->get_output();
+  const auto output_ks = conv_kernel_side->get_output();
+
+  ASSERT_EQ(output_is.size(), conv_op.compute_output_size());
+  ASSERT_EQ(output_ks.size(), conv_op.compute_output_size());
+
+  for (std::size_t i = 0; i < expected_output.size(); ++i) {
+    ASSERT_EQ(TypeParam(output_is[i] + output_ks[i]), TypeParam(expected_output[i]));
+  }
+}
+
+template <typename T>
+void test_sum_bit_products_kernels() {
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+  for (std::size_t vector_size : {1, 3, 40}) {
+    const std::size_t batch_size = 37;
+    const auto ot_outputs = MOTION::Helpers::RandomVector<T>(batch_size * bit_size * vector_size);
+    for (bool negate : {false, true}) {
+      std::vector<T> expected_outputs(batch_size * vector_size);
+      MOTION::detail::sum_bit_products(ot_outputs.data(), expected_outputs.data(), batch_size,
+                                       vector_size, negate,
+                                       MOTION::IntegerMultiplicationKernel::scalar);
+      for (std::size_t i = 0; i < expected_outputs.size(); ++i) {
+        T value = 0;
+        for (std::size_t bit_j = 0; bit_j < bit_size; ++bit_j) {
+          value += ot_outputs[((i / vector_size) * bit_size + bit_j) * vector_size +
+                              i % vector_size];
+        }
+        ASSERT_EQ(expected_outputs[i], negate ? T(-value) : value);
+      }
+      using Kernel = MOTION::IntegerMultiplicationKernel;
+      for (auto kernel : {Kernel::avx2, Kernel::avx512}) {
+        if (!MOTION::is_integer_multiplication_kernel_supported(kernel)) {
+          continue;
+        }
+        std::vector<T> outputs(batch_size * vector_size);
+        MOTION::detail::sum_bit_products(ot_outputs.data(), outputs.data(), batch_size,
+                                         vector_size, negate, kernel);
+        EXPECT_EQ(outputs, expected_outputs) << MOTION::to_string(kernel);
+      }
+    }
+  }
+}
+
+TEST(ArithmeticProvider, SumBitProductsKernels) {
+  test_sum_bit_products_kernels<std::uint8_t>();
+  test_sum_bit_products_kernels<std::uint16_t>();
+  test_sum_bit_products_kernels<std::uint32_t>();
+  test_sum_bit_products_kernels<std::uint64_t>();
+  test_sum_bit_products_kernels<__uint128_t>();
+}
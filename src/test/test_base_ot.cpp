@@ -20,12 +20,20 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <filesystem>
+#include <future>
+
+#include <fmt/format.h>
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
 #include "test_constants.h"
 
 #include "base/backend.h"
 #include "base/party.h"
+#include "communication/communication_layer.h"
+#include "crypto/base_ots/base_ot_cache.h"
 #include "crypto/base_ots/base_ot_provider.h"
 #include "data_storage/base_ot_data.h"
 
@@ -115,3 +123,71 @@ TEST(ObliviousTransfer, BaseOT) {
     }
   }
 }
+
+TEST(ObliviousTransfer, BaseOTCache) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         fmt::format("motion_base_ot_cache_{}", ::getpid());
+  std::filesystem::create_directories(directory);
+
+  // run a session between two fresh processes and return the base OTs of both parties
+  auto run_session = [&directory] {
+    auto comm_layers = Communication::make_dummy_communication_layers(2);
+    std::vector<std::unique_ptr<BaseOTProvider>> providers(2);
+    for (std::size_t i = 0; i < 2; ++i) {
+      providers[i] = std::make_unique<BaseOTProvider>(*comm_layers[i], nullptr, nullptr);
+      providers[i]->set_cache(
+          std::make_shared<BaseOTCache>(directory.string(), fmt::format("peer{}", 1 - i)));
+      comm_layers[i]->start();
+    }
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [&providers, i] {
+        providers[i]->ComputeBaseOTs();
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto &fut) { fut.get(); });
+    std::vector<std::pair<ReceiverMsgs, SenderMsgs>> base_ots;
+    base_ots.push_back(providers[0]->ExportBaseOTs(1));
+    base_ots.push_back(providers[1]->ExportBaseOTs(0));
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs[i] = std::async(std::launch::async, [&comm_layers, i] { comm_layers[i]->shutdown(); });
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto &fut) { fut.get(); });
+    return base_ots;
+  };
+
+  auto check_correlation = [](const auto &base_ots) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      const auto &receiver_msgs = base_ots.at(i).first;
+      const auto &sender_msgs = base_ots.at(1 - i).second;
+      for (std::size_t k = 0; k < kappa; ++k) {
+        if (receiver_msgs.c_.Get(k)) {
+          ASSERT_EQ(receiver_msgs.messages_c_.at(k), sender_msgs.messages_1_.at(k));
+        } else {
+          ASSERT_EQ(receiver_msgs.messages_c_.at(k), sender_msgs.messages_0_.at(k));
+        }
+      }
+    }
+  };
+
+  const auto computed = run_session();
+  check_correlation(computed);
+  EXPECT_TRUE(std::filesystem::exists(BaseOTCache(directory.string(), "peer1").get_path(0, 1)));
+  EXPECT_TRUE(std::filesystem::exists(BaseOTCache(directory.string(), "peer0").get_path(1, 0)));
+
+  // later sessions use the cached base OTs, but never the same keys
+  const auto cached_1 = run_session();
+  check_correlation(cached_1);
+  const auto cached_2 = run_session();
+  check_correlation(cached_2);
+  for (std::size_t i = 0; i < 2; ++i) {
+    EXPECT_EQ(computed.at(i).first.c_, cached_1.at(i).first.c_);
+    EXPECT_EQ(computed.at(i).first.c_, cached_2.at(i).first.c_);
+    EXPECT_NE(computed.at(i).first.messages_c_, cached_1.at(i).first.messages_c_);
+    EXPECT_NE(cached_1.at(i).first.messages_c_, cached_2.at(i).first.messages_c_);
+    EXPECT_NE(computed.at(i).second.messages_0_, cached_1.at(i).second.messages_0_);
+    EXPECT_NE(cached_1.at(i).second.messages_1_, cached_2.at(i).second.messages_1_);
+  }
+
+  std::filesystem::remove_all(directory);
+}
@@ -20,13 +20,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <array>
 #include <iterator>
 #include <memory>
+#include <span>
 
 #include <gtest/gtest.h>
 
 #include "algorithm/circuit_loader.h"
+#include "algorithm/edit_distance.h"
 #include "base/gate_register.h"
 #include "communication/communication_layer.h"
 #include "crypto/arithmetic_provider.h"
@@ -35,8 +38,10 @@
 #include "crypto/oblivious_transfer/ot_provider.h"
 #include "gate/new_gate.h"
 #include "protocols/beavy/beavy_provider.h"
+#include "protocols/beavy/gate.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/gmw/wire.h"
+#include "protocols/plain/constant_folding.h"
 #include "protocols/plain/wire.h"
 #include "statistics/run_time_stats.h"
 #include "utility/helpers.h"
@@ -223,6 +228,37 @@ TEST_F(BooleanBEAVYTest, Input) {
   }
 }
 
+TEST_F(BooleanBEAVYTest, NonInteractiveInput) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+
+  for (std::size_t i = 0; i < 2; ++i) {
+    beavy_providers_[i]->set_non_interactive_inputs(true);
+  }
+  auto [input_a_promise, wires_a_in_0] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_a_in_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+
+  run_setup();
+  // the setup of the input gate needs the input
+  input_a_promise.set_value(inputs_a);
+  run_gates_setup();
+  run_gates_online();
+
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto wire_a0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_a_in_0.at(wire_i));
+    const auto wire_a1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_a_in_1.at(wire_i));
+    wire_a0->wait_online();
+    wire_a1->wait_online();
+    const auto& pshare_a0 = wire_a0->get_public_share();
+    ASSERT_EQ(pshare_a0.GetSize(), num_simd);
+    ASSERT_EQ(pshare_a0, wire_a1->get_public_share());
+    ASSERT_EQ(inputs_a.at(wire_i),
+              pshare_a0 ^ wire_a0->get_secret_share() ^ wire_a1->get_secret_share());
+  }
+}
+
 TEST_F(BooleanBEAVYTest, OutputSingle) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
@@ -499,7 +535,59 @@ TEST_F(BooleanBEAVYTest, AND) {
   }
 }
 
-TEST_F(BooleanBEAVYTest, ConstantAND) {
+TEST_F(BooleanBEAVYTest, BulkGates) {
+  std::size_t num_wires = 4;
+  std::size_t num_simd = 10;
+  const auto inputs = generate_inputs(num_wires, num_simd);
+  // gates on arbitrary and repeated wires, as in a layer of a circuit
+  const std::vector<std::size_t> inputs_a = {0, 2, 1, 2};
+  const std::vector<std::size_t> inputs_b = {3, 3, 0, 2};
+  const std::vector<std::size_t> inputs_inv = {1, 3};
+
+  auto [input_promise, wires_0_in] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  std::array<MOTION::WireVector, 2> wires_and;
+  std::array<MOTION::WireVector, 2> wires_inv;
+  const auto num_gates = gate_registers_[0]->get_num_gates();
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    const auto& wires_in = party_id == 0 ? wires_0_in : wires_1_in;
+    wires_and[party_id] = beavy_providers_[party_id]->make_binary_gates(
+        ENCRYPTO::PrimitiveOperationType::AND, wires_in, inputs_a, inputs_b);
+    wires_inv[party_id] = beavy_providers_[party_id]->make_unary_gates(
+        ENCRYPTO::PrimitiveOperationType::INV, wires_in, inputs_inv);
+  }
+  // one gate for each call
+  EXPECT_EQ(gate_registers_[0]->get_num_gates(), num_gates + 2);
+  EXPECT_THROW(beavy_providers_[0]->make_unary_gates(ENCRYPTO::PrimitiveOperationType::HAM,
+                                                     wires_0_in, inputs_inv),
+               std::invalid_argument);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(inputs);
+  run_gates_online();
+
+  const auto get_output = [](const auto& wires_0, const auto& wires_1, std::size_t wire_i) {
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1.at(wire_i));
+    wire_0->wait_online();
+    wire_1->wait_online();
+    EXPECT_EQ(wire_0->get_public_share(), wire_1->get_public_share());
+    return wire_0->get_public_share() ^ wire_0->get_secret_share() ^ wire_1->get_secret_share();
+  };
+  ASSERT_EQ(wires_and[0].size(), inputs_a.size());
+  for (std::size_t gate_i = 0; gate_i < inputs_a.size(); ++gate_i) {
+    EXPECT_EQ(get_output(wires_and[0], wires_and[1], gate_i),
+              inputs[inputs_a[gate_i]] & inputs[inputs_b[gate_i]]);
+  }
+  ASSERT_EQ(wires_inv[0].size(), inputs_inv.size());
+  for (std::size_t gate_i = 0; gate_i < inputs_inv.size(); ++gate_i) {
+    EXPECT_EQ(get_output(wires_inv[0], wires_inv[1], gate_i), ~inputs[inputs_inv[gate_i]]);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, StrongPartyAND) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
   const auto inputs_a = generate_inputs(num_wires, num_simd);
@@ -509,24 +597,33 @@ TEST_F(BooleanBEAVYTest, ConstantAND) {
                  std::back_inserter(expected_output),
                  [](const auto& bv_a, const auto& bv_b) { return bv_a & bv_b; });
 
-  MOTION::WireVector plain_wires_0(num_wires);
-  MOTION::WireVector plain_wires_1(num_wires);
-  std::transform(std::begin(inputs_b), std::end(inputs_b), std::begin(plain_wires_0),
-                 [](const auto& bv) { return std::make_shared<plain::BooleanPlainWire>(bv); });
-  std::transform(std::begin(inputs_b), std::end(inputs_b), std::begin(plain_wires_1),
-                 [](const auto& bv) { return std::make_shared<plain::BooleanPlainWire>(bv); });
-
+  // party 1 is the receiver of all OTs
+  for (std::size_t i = 0; i < 2; ++i) {
+    beavy_providers_[i]->set_strong_party(1);
+  }
   auto [input_a_promise, wires_0_in_a] =
       beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
   auto wires_1_in_a = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_in_b = beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+  auto [input_b_promise, wires_1_in_b] =
+      beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
   auto wires_0_out = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
-                                                           wires_0_in_a, plain_wires_0);
+                                                           wires_0_in_a, wires_0_in_b);
   auto wires_1_out = beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
-                                                           wires_1_in_a, plain_wires_1);
+                                                           wires_1_in_a, wires_1_in_b);
+
+  // the weak party only sends the sender messages of one bit per OT
+  const auto cost_0 = gate_registers_[0]->get_gates().back()->get_cost();
+  const auto cost_1 = gate_registers_[1]->get_gates().back()->get_cost();
+  ASSERT_TRUE(cost_0.has_value() && cost_1.has_value());
+  EXPECT_EQ(cost_0->setup_bytes_, MOTION::Helpers::Convert::BitsToBytes(
+                                      MOTION::GateCost::cot_sender_bits(2 * num_wires * num_simd, 1)));
+  EXPECT_LT(cost_0->setup_bytes_, cost_1->setup_bytes_);
 
   run_setup();
   run_gates_setup();
   input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
   run_gates_online();
 
   for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
@@ -539,159 +636,1040 @@ TEST_F(BooleanBEAVYTest, ConstantAND) {
     const auto& pshare_1 = wire_1->get_public_share();
     const auto& sshare_0 = wire_0->get_secret_share();
     const auto& sshare_1 = wire_1->get_secret_share();
-    ASSERT_EQ(pshare_0.GetSize(), num_simd);
-    ASSERT_EQ(pshare_1.GetSize(), num_simd);
-    ASSERT_EQ(sshare_0.GetSize(), num_simd);
-    ASSERT_EQ(sshare_1.GetSize(), num_simd);
     ASSERT_EQ(pshare_0, pshare_1);
     ASSERT_EQ(expected_output_bits, pshare_0 ^ sshare_0 ^ sshare_1);
   }
 }
 
-TEST_F(BooleanBEAVYTest, BooleanBEAVYToGMW) {
-  std::size_t num_wires = 8;
+TEST_F(BooleanBEAVYTest, MultiInputAND) {
+  std::size_t num_wires = 2;
   std::size_t num_simd = 10;
-  const auto expected_output = generate_inputs(num_wires, num_simd);
+  // up to 8 inputs are a single gate, 11 a tree of two gates and an AND
+  const std::vector<std::size_t> nums_inputs = {3, 4, 8, 11};
+  std::vector<MOTION::BitValues> inputs;
+  std::array<std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>>, 2> promises;
+  std::vector<MOTION::BitValues> expected_outputs;
+  std::array<std::vector<MOTION::WireVector>, 2> output_wires;
+  for (auto num_inputs : nums_inputs) {
+    MOTION::BitValues expected_output(num_wires, ENCRYPTO::BitVector<>(num_simd, true));
+    std::array<std::vector<MOTION::WireVector>, 2> input_wires;
+    for (std::size_t input_i = 0; input_i < num_inputs; ++input_i) {
+      inputs.push_back(generate_inputs(num_wires, num_simd));
+      for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+        expected_output[wire_i] &= inputs.back()[wire_i];
+      }
+      const auto owner = input_i % 2;
+      auto [promise, wires_my] =
+          beavy_providers_[owner]->make_boolean_input_gate_my(owner, num_wires, num_simd);
+      promises[owner].push_back(std::move(promise));
+      input_wires[owner].push_back(std::move(wires_my));
+      input_wires[1 - owner].push_back(
+          beavy_providers_[1 - owner]->make_boolean_input_gate_other(owner, num_wires, num_simd));
+    }
+    expected_outputs.push_back(std::move(expected_output));
+    for (std::size_t party_i = 0; party_i < 2; ++party_i) {
+      output_wires[party_i].push_back(
+          beavy_providers_[party_i]->make_multi_and_gate(input_wires[party_i]));
+    }
+  }
 
-  auto [input_promise, wires_in_0] =
-      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
-  auto wires_in_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  run_setup();
+  run_gates_setup();
+  // the inputs in the order of their gates, which alternate between the owners
+  std::array<std::size_t, 2> promise_i = {0, 0};
+  for (const auto num_inputs : nums_inputs) {
+    for (std::size_t input_i = 0; input_i < num_inputs; ++input_i) {
+      const auto owner = input_i % 2;
+      promises[owner][promise_i[owner]++].set_value(inputs.front());
+      inputs.erase(inputs.begin());
+    }
+  }
+  run_gates_online();
 
-  auto wires_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_0);
-  auto wires_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_1);
+  for (std::size_t and_i = 0; and_i < nums_inputs.size(); ++and_i) {
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto wire_0 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[0][and_i].at(wire_i));
+      const auto wire_1 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[1][and_i].at(wire_i));
+      wire_0->wait_online();
+      wire_1->wait_online();
+      const auto& pshare_0 = wire_0->get_public_share();
+      ASSERT_EQ(pshare_0, wire_1->get_public_share());
+      ASSERT_EQ(expected_outputs[and_i].at(wire_i),
+                pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share());
+    }
+  }
+}
+
+TEST_F(BooleanBEAVYTest, MSG) {
+  std::size_t num_simd = 10;
+  // no round, one round with a padded AND, and two and three rounds
+  const std::vector<std::size_t> nums_wires = {1, 3, 10, 17};
+  const std::vector<std::size_t> nums_rounds = {0, 1, 2, 3};
+  std::vector<MOTION::BitValues> inputs_a;
+  std::vector<MOTION::BitValues> inputs_b;
+  std::array<std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>>, 2> promises;
+  std::vector<ENCRYPTO::BitVector<>> expected_outputs;
+  std::array<std::vector<MOTION::WireVector>, 2> output_wires;
+  for (std::size_t gate_i = 0; gate_i < nums_wires.size(); ++gate_i) {
+    const auto num_wires = nums_wires[gate_i];
+    // the inputs differ in one wire of every other SIMD value
+    inputs_a.push_back(generate_inputs(num_wires, num_simd));
+    inputs_b.push_back(inputs_a.back());
+    ENCRYPTO::BitVector<> expected_output(num_simd, true);
+    for (std::size_t simd_j = 0; simd_j < num_simd; simd_j += 2) {
+      auto& bits = inputs_b.back()[(simd_j / 2) % num_wires];
+      bits.Set(!bits.Get(simd_j), simd_j);
+      expected_output.Set(false, simd_j);
+    }
+    expected_outputs.push_back(std::move(expected_output));
+
+    auto [input_a_promise, wires_0_in_a] =
+        beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+    auto wires_1_in_a = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+    auto wires_0_in_b = beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+    auto [input_b_promise, wires_1_in_b] =
+        beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+    promises[0].push_back(std::move(input_a_promise));
+    promises[1].push_back(std::move(input_b_promise));
+    output_wires[0].push_back(beavy_providers_[0]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::MSG, wires_0_in_a, wires_0_in_b));
+    output_wires[1].push_back(beavy_providers_[1]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::MSG, wires_1_in_a, wires_1_in_b));
+    const auto cost = gate_registers_[0]->get_gates().back()->get_cost();
+    ASSERT_TRUE(cost.has_value());
+    EXPECT_EQ(cost->online_rounds_, nums_rounds[gate_i]);
+  }
 
   run_setup();
   run_gates_setup();
-  input_promise.set_value(expected_output);
+  for (std::size_t gate_i = 0; gate_i < nums_wires.size(); ++gate_i) {
+    promises[0][gate_i].set_value(inputs_a[gate_i]);
+    promises[1][gate_i].set_value(inputs_b[gate_i]);
+  }
   run_gates_online();
 
-  // check wire values
-  ASSERT_EQ(wires_0.size(), num_wires);
-  ASSERT_EQ(wires_1.size(), num_wires);
-  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
-    const auto& expected_output_bits = expected_output.at(wire_i);
-    const auto wire_0 = std::dynamic_pointer_cast<gmw::BooleanGMWWire>(wires_0.at(wire_i));
-    const auto wire_1 = std::dynamic_pointer_cast<gmw::BooleanGMWWire>(wires_1.at(wire_i));
-    ASSERT_NE(wire_0, nullptr);
-    ASSERT_NE(wire_1, nullptr);
+  for (std::size_t gate_i = 0; gate_i < nums_wires.size(); ++gate_i) {
+    ASSERT_EQ(output_wires[0][gate_i].size(), 1);
+    ASSERT_EQ(output_wires[1][gate_i].size(), 1);
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[0][gate_i][0]);
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[1][gate_i][0]);
     wire_0->wait_online();
     wire_1->wait_online();
-    const auto& share_0 = wire_0->get_share();
-    const auto& share_1 = wire_1->get_share();
-    ASSERT_EQ(share_0.GetSize(), num_simd);
-    ASSERT_EQ(share_1.GetSize(), num_simd);
-    ASSERT_EQ(expected_output_bits, share_0 ^ share_1);
+    const auto& pshare_0 = wire_0->get_public_share();
+    const auto& pshare_1 = wire_1->get_public_share();
+    ASSERT_EQ(pshare_0.GetSize(), num_simd);
+    ASSERT_EQ(pshare_0, pshare_1);
+    ASSERT_EQ(expected_outputs[gate_i],
+              pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share());
   }
 }
 
-TEST_F(BooleanBEAVYTest, BooleanBEAVYFromGMW) {
+TEST_F(BooleanBEAVYTest, MatrixDOT) {
+  std::size_t num_wires = 5;
+  std::size_t num_patterns = 3;
+  // with SIMD values which end within and at a byte boundary
+  const std::vector<std::size_t> nums_simd = {10, 16};
+  std::vector<MOTION::BitValues> texts;
+  std::vector<std::vector<MOTION::BitValues>> patterns;
+  std::vector<std::vector<ENCRYPTO::BitVector<>>> expected_outputs;
+  std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>> text_promises;
+  std::vector<std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>>> pattern_promises;
+  std::array<std::vector<MOTION::WireVector>, 2> output_wires;
+  for (auto num_simd : nums_simd) {
+    texts.push_back(generate_inputs(num_wires, num_simd));
+    auto& gate_patterns = patterns.emplace_back();
+    auto& gate_expected_outputs = expected_outputs.emplace_back();
+    for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+      gate_patterns.push_back(generate_inputs(num_wires, num_simd));
+      ENCRYPTO::BitVector<> expected_output(num_simd);
+      for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+        expected_output ^= texts.back()[wire_i] & gate_patterns.back()[wire_i];
+      }
+      gate_expected_outputs.push_back(std::move(expected_output));
+    }
+
+    // the text of party 0 and the patterns of party 1
+    auto [text_promise, text_wires_0] =
+        beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+    auto text_wires_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+    text_promises.push_back(std::move(text_promise));
+    std::array<std::vector<MOTION::WireVector>, 2> pattern_wires;
+    auto& gate_pattern_promises = pattern_promises.emplace_back();
+    for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+      pattern_wires[0].push_back(
+          beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd));
+      auto [promise, wires] =
+          beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+      gate_pattern_promises.push_back(std::move(promise));
+      pattern_wires[1].push_back(std::move(wires));
+    }
+    output_wires[0].push_back(
+        beavy_providers_[0]->make_matrix_dot_gate(text_wires_0, pattern_wires[0]));
+    output_wires[1].push_back(
+        beavy_providers_[1]->make_matrix_dot_gate(text_wires_1, pattern_wires[1]));
+    const auto cost = gate_registers_[0]->get_gates().back()->get_cost();
+    ASSERT_TRUE(cost.has_value());
+    EXPECT_EQ(cost->online_rounds_, 1);
+    // one OT per text bit in each direction, and one message with all outputs
+    EXPECT_EQ(cost->num_ots_, 2 * num_wires * num_simd);
+    EXPECT_EQ(cost->online_bytes_, MOTION::Helpers::Convert::BitsToBytes(num_patterns * num_simd));
+  }
+
+  run_setup();
+  run_gates_setup();
+  for (std::size_t gate_i = 0; gate_i < nums_simd.size(); ++gate_i) {
+    text_promises[gate_i].set_value(texts[gate_i]);
+    for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+      pattern_promises[gate_i][pattern_j].set_value(patterns[gate_i][pattern_j]);
+    }
+  }
+  run_gates_online();
+
+  for (std::size_t gate_i = 0; gate_i < nums_simd.size(); ++gate_i) {
+    ASSERT_EQ(output_wires[0][gate_i].size(), num_patterns);
+    ASSERT_EQ(output_wires[1][gate_i].size(), num_patterns);
+    for (std::size_t pattern_j = 0; pattern_j < num_patterns; ++pattern_j) {
+      const auto wire_0 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[0][gate_i][pattern_j]);
+      const auto wire_1 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[1][gate_i][pattern_j]);
+      wire_0->wait_online();
+      wire_1->wait_online();
+      const auto& pshare_0 = wire_0->get_public_share();
+      ASSERT_EQ(pshare_0.GetSize(), nums_simd[gate_i]);
+      ASSERT_EQ(pshare_0, wire_1->get_public_share());
+      ASSERT_EQ(expected_outputs[gate_i][pattern_j],
+                pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share());
+    }
+  }
+}
+
+TEST_F(BooleanBEAVYTest, BatchedOTPreprocessing) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
-  const auto expected_output = generate_inputs(num_wires, num_simd);
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  MOTION::BitValues expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output),
+                 [](const auto& bv_a, const auto& bv_b) { return bv_a & bv_b; });
 
-  auto [input_promise, wires_in_0] =
+  for (std::size_t i = 0; i < 2; ++i) {
+    beavy_providers_[i]->set_batch_ot_preprocessing(true);
+  }
+  auto [input_a_promise, wires_0_in_a] =
       beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
-  auto wires_in_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
-
-  auto wires_tmp_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_0);
-  auto wires_tmp_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_1);
-  auto wires_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanBEAVY, wires_tmp_0);
-  auto wires_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanBEAVY, wires_tmp_1);
+  auto wires_1_in_a = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_in_b = beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+  auto [input_b_promise, wires_1_in_b] =
+      beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+  // (a & b) & a, so that the second gate depends on the setup of the first one
+  auto wires_0_ab = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                          wires_0_in_a, wires_0_in_b);
+  auto wires_1_ab = beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                          wires_1_in_a, wires_1_in_b);
+  auto wires_0_out = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                           wires_0_ab, wires_0_in_a);
+  auto wires_1_out = beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                           wires_1_ab, wires_1_in_a);
 
+  for (std::size_t i = 0; i < 2; ++i) {
+    beavy_providers_[i]->register_batched_ots();
+  }
   run_setup();
-  run_gates_setup();
-  input_promise.set_value(expected_output);
+  // the batch completes only after all gates have contributed, so run the setups concurrently
+  auto eval_gates_setup = [this](auto party_id) {
+    std::vector<std::future<void>> futs;
+    for (auto& gate : gate_registers_[party_id]->get_gates()) {
+      if (gate->need_setup()) {
+        futs.emplace_back(std::async(std::launch::async, [&gate] { gate->evaluate_setup(); }));
+      }
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  };
+  auto f0 = std::async(std::launch::async, eval_gates_setup, 0);
+  auto f1 = std::async(std::launch::async, eval_gates_setup, 1);
+  f0.get();
+  f1.get();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
   run_gates_online();
 
-  // check wire values
-  ASSERT_EQ(wires_0.size(), num_wires);
-  ASSERT_EQ(wires_1.size(), num_wires);
   for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
     const auto& expected_output_bits = expected_output.at(wire_i);
-    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0.at(wire_i));
-    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1.at(wire_i));
-    ASSERT_NE(wire_0, nullptr);
-    ASSERT_NE(wire_1, nullptr);
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0_out.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1_out.at(wire_i));
     wire_0->wait_online();
     wire_1->wait_online();
-    const auto& sshare_0 = wire_0->get_secret_share();
-    const auto& sshare_1 = wire_1->get_secret_share();
     const auto& pshare_0 = wire_0->get_public_share();
     const auto& pshare_1 = wire_1->get_public_share();
-    ASSERT_EQ(sshare_0.GetSize(), num_simd);
-    ASSERT_EQ(sshare_1.GetSize(), num_simd);
-    ASSERT_EQ(pshare_0.GetSize(), num_simd);
+    const auto& sshare_0 = wire_0->get_secret_share();
+    const auto& sshare_1 = wire_1->get_secret_share();
     ASSERT_EQ(pshare_0, pshare_1);
     ASSERT_EQ(expected_output_bits, pshare_0 ^ sshare_0 ^ sshare_1);
   }
 }
 
-template <typename T>
-class ArithmeticBEAVYTest : public BEAVYTest {
- public:
-  static std::vector<T> generate_inputs(std::size_t num_simd) {
-    return MOTION::Helpers::RandomVector<T>(num_simd);
+TEST_F(BEAVYTest, FusedBitsMessages) {
+  const std::vector<std::pair<std::size_t, std::size_t>> layout = {{1000, 7}, {1001, 64}, {1002, 13}};
+  std::array<std::vector<ENCRYPTO::ReusableFiberFuture<ENCRYPTO::BitVector<>>>, 2> futures;
+  std::array<std::vector<ENCRYPTO::BitVector<>>, 2> messages;
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (auto [gate_id, num_bits] : layout) {
+      futures[i].emplace_back(
+          beavy_providers_[i]->register_for_bits_message(1 - i, gate_id, num_bits));
+      messages[i].emplace_back(ENCRYPTO::BitVector<>::Random(num_bits));
+    }
+    beavy_providers_[i]->fuse_messages(layout);
   }
-  std::pair<ENCRYPTO::ReusableFiberPromise<MOTION::IntegerValues<T>>, MOTION::WireVector>
-  make_arithmetic_T_input_gate_my(std::size_t party_id, std::size_t input_owner,
-                                  std::size_t num_simd) {
-    auto& gp = *beavy_providers_.at(party_id);
-    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
-      return gp.make_arithmetic_8_input_gate_my(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
-      return gp.make_arithmetic_16_input_gate_my(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
-      return gp.make_arithmetic_32_input_gate_my(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return gp.make_arithmetic_64_input_gate_my(input_owner, num_simd);
+
+  run_setup();
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (std::size_t j = 0; j < layout.size(); ++j) {
+      beavy_providers_[i]->broadcast_bits_message(layout[j].first, messages[i][j]);
     }
   }
-  MOTION::WireVector make_arithmetic_T_input_gate_other(std::size_t party_id,
-                                                        std::size_t input_owner,
-                                                        std::size_t num_simd) {
-    auto& gp = *beavy_providers_.at(party_id);
-    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
-      return gp.make_arithmetic_8_input_gate_other(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
-      return gp.make_arithmetic_16_input_gate_other(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
-      return gp.make_arithmetic_32_input_gate_other(input_owner, num_simd);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return gp.make_arithmetic_64_input_gate_other(input_owner, num_simd);
+
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (std::size_t j = 0; j < layout.size(); ++j) {
+      EXPECT_EQ(futures[i][j].get(), messages[1 - i][j]);
     }
   }
-  ENCRYPTO::ReusableFiberFuture<MOTION::IntegerValues<T>> make_arithmetic_T_output_gate_my(
-      std::size_t party_id, std::size_t output_owner, const MOTION::WireVector& in) {
-    auto& gp = *beavy_providers_.at(party_id);
-    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
-      return gp.make_arithmetic_8_output_gate_my(output_owner, in);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
-      return gp.make_arithmetic_16_output_gate_my(output_owner, in);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
-      return gp.make_arithmetic_32_output_gate_my(output_owner, in);
-    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return gp.make_arithmetic_64_output_gate_my(output_owner, in);
+}
+
+TEST_F(BEAVYTest, FusedIntsMessages) {
+  const std::vector<std::pair<std::size_t, std::size_t>> layout = {{1000, 3}, {1001, 1}, {1002, 17}};
+  std::array<std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<std::uint64_t>>>, 2> futures;
+  std::array<std::vector<std::vector<std::uint64_t>>, 2> messages;
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (auto [gate_id, num_elements] : layout) {
+      futures[i].emplace_back(beavy_providers_[i]->register_for_ints_message<std::uint64_t>(
+          1 - i, gate_id, num_elements));
+      messages[i].emplace_back(MOTION::Helpers::RandomVector<std::uint64_t>(num_elements));
     }
+    beavy_providers_[i]->fuse_messages(layout);
   }
-};
 
-using integer_types = ::testing::Types<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t>;
-TYPED_TEST_SUITE(ArithmeticBEAVYTest, integer_types);
+  run_setup();
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (std::size_t j = 0; j < layout.size(); ++j) {
+      beavy_providers_[i]->broadcast_ints_message(layout[j].first, messages[i][j]);
+    }
+  }
 
-TYPED_TEST(ArithmeticBEAVYTest, Input) {
-  std::size_t num_simd = 10;
-  const auto inputs_a = this->generate_inputs(num_simd);
-  const auto inputs_b = this->generate_inputs(num_simd);
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (std::size_t j = 0; j < layout.size(); ++j) {
+      EXPECT_EQ(futures[i][j].get(), messages[1 - i][j]);
+    }
+  }
+}
 
-  // input of party 0
-  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
-  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+TEST_F(BooleanBEAVYTest, ConstantAND) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  MOTION::BitValues expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output),
+                 [](const auto& bv_a, const auto& bv_b) { return bv_a & bv_b; });
 
-  // input of party 1
-  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
-  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+  MOTION::WireVector plain_wires_0(num_wires);
+  MOTION::WireVector plain_wires_1(num_wires);
+  std::transform(std::begin(inputs_b), std::end(inputs_b), std::begin(plain_wires_0),
+                 [](const auto& bv) { return std::make_shared<plain::BooleanPlainWire>(bv); });
+  std::transform(std::begin(inputs_b), std::end(inputs_b), std::begin(plain_wires_1),
+                 [](const auto& bv) { return std::make_shared<plain::BooleanPlainWire>(bv); });
 
-  ASSERT_EQ(wires_a_in_0.size(), 1);
+  auto [input_a_promise, wires_0_in_a] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in_a = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_out = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                           wires_0_in_a, plain_wires_0);
+  auto wires_1_out = beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                           wires_1_in_a, plain_wires_1);
+
+  run_setup();
+  run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  run_gates_online();
+
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& expected_output_bits = expected_output.at(wire_i);
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0_out.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1_out.at(wire_i));
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& pshare_0 = wire_0->get_public_share();
+    const auto& pshare_1 = wire_1->get_public_share();
+    const auto& sshare_0 = wire_0->get_secret_share();
+    const auto& sshare_1 = wire_1->get_secret_share();
+    ASSERT_EQ(pshare_0.GetSize(), num_simd);
+    ASSERT_EQ(pshare_1.GetSize(), num_simd);
+    ASSERT_EQ(sshare_0.GetSize(), num_simd);
+    ASSERT_EQ(sshare_1.GetSize(), num_simd);
+    ASSERT_EQ(pshare_0, pshare_1);
+    ASSERT_EQ(expected_output_bits, pshare_0 ^ sshare_0 ^ sshare_1);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, HAM) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 100;
+  const auto inputs = generate_inputs(num_wires, num_simd);
+  std::vector<std::uint64_t> expected_output(num_simd, 0);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      expected_output[simd_j] += inputs[wire_i].Get(simd_j);
+    }
+  }
+
+  auto [input_promise, wires_0_in] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_out =
+      beavy_providers_[0]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM, wires_0_in);
+  auto wires_1_out =
+      beavy_providers_[1]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::HAM, wires_1_in);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(inputs);
+  run_gates_online();
+
+  ASSERT_EQ(wires_0_out.size(), 1);
+  ASSERT_EQ(wires_1_out.size(), 1);
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_0_out[0]);
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_1_out[0]);
+  wire_0->wait_online();
+  wire_1->wait_online();
+  // the output consists of additive shares in the public share
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  ASSERT_EQ(share_0.size(), num_simd);
+  ASSERT_EQ(share_1.size(), num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    EXPECT_EQ(expected_output[simd_j], share_0[simd_j] + share_1[simd_j]);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, COUNT) {
+  // more than one word of SIMD values which is not a multiple of 64
+  std::size_t num_wires = 5;
+  std::size_t num_simd = 150;
+  const auto inputs = generate_inputs(num_wires, num_simd);
+  std::vector<std::uint64_t> expected_output(num_simd, 0);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      expected_output[simd_j] += inputs[wire_i].Get(simd_j);
+    }
+  }
+
+  auto [input_promise, wires_0_in] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_out =
+      beavy_providers_[0]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::COUNT, wires_0_in);
+  auto wires_1_out =
+      beavy_providers_[1]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::COUNT, wires_1_in);
+
+  // the bits are injected in the setup phase, so the online phase is local
+  const auto cost = gate_registers_[0]->get_gates().back()->get_cost();
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_EQ(cost->num_ots_, num_wires * num_simd);
+  EXPECT_EQ(cost->online_bytes_, 0);
+  EXPECT_EQ(cost->online_rounds_, 0);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(inputs);
+  run_gates_online();
+
+  ASSERT_EQ(wires_0_out.size(), 1);
+  ASSERT_EQ(wires_1_out.size(), 1);
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_0_out[0]);
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_1_out[0]);
+  ASSERT_TRUE(wire_0->is_additively_shared());
+  ASSERT_TRUE(wire_1->is_additively_shared());
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  ASSERT_EQ(share_0.size(), num_simd);
+  ASSERT_EQ(share_1.size(), num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    EXPECT_EQ(expected_output[simd_j], share_0[simd_j] + share_1[simd_j]);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, EQEXP) {
+  // more than one word of SIMD values, and values beyond the domain which wrap around
+  std::size_t num_simd = 100;
+  std::uint64_t vec_size = 7;
+  auto make_ready_wire = [num_simd](std::vector<std::uint64_t> values) {
+    auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(num_simd);
+    wire->get_public_share() = std::move(values);
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    return wire;
+  };
+  std::array<std::vector<std::uint64_t>, 2> values;
+  for (auto& party_values : values) {
+    party_values = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+    std::transform(std::begin(party_values), std::end(party_values), std::begin(party_values),
+                   [](auto x) { return x % 10; });
+  }
+  ENCRYPTO::BitVector<> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    expected_output.Set(values[0][simd_j] % vec_size == values[1][simd_j] % vec_size, simd_j);
+  }
+
+  std::array<MOTION::WireVector, 2> wires_out;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    wires_out[party_id] = beavy_providers_[party_id]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::EQEXP, {make_ready_wire(values[party_id])},
+        {make_ready_wire(std::vector<std::uint64_t>(num_simd, vec_size))});
+  }
+
+  // the masks of the one-hot rows are zero, so the setup needs no OTs
+  const auto cost = gate_registers_[0]->get_gates().back()->get_cost();
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_EQ(cost->setup_bytes_, 0);
+  EXPECT_EQ(cost->num_ots_, 0);
+
+  run_setup();
+  run_gates_setup();
+  run_gates_online();
+
+  ASSERT_EQ(wires_out[0].size(), 1);
+  ASSERT_EQ(wires_out[1].size(), 1);
+  const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[0][0]);
+  const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[1][0]);
+  wire_0->wait_online();
+  wire_1->wait_online();
+  ASSERT_EQ(wire_0->get_public_share(), wire_1->get_public_share());
+  EXPECT_EQ(expected_output, wire_0->get_public_share() ^ wire_0->get_secret_share() ^
+                                 wire_1->get_secret_share());
+}
+
+TEST_F(BooleanBEAVYTest, EQEXPConstantBound) {
+  std::size_t num_simd = 100;
+  std::uint64_t vec_size = 7;
+  std::array<MOTION::WireVector, 2> wires_in;
+  std::array<std::vector<std::uint64_t>, 2> values;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    values[party_id] = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+    std::transform(std::begin(values[party_id]), std::end(values[party_id]),
+                   std::begin(values[party_id]), [vec_size](auto x) { return x % vec_size; });
+    auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(num_simd);
+    wire->get_public_share() = values[party_id];
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    wires_in[party_id] = {wire};
+  }
+  ENCRYPTO::BitVector<> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    expected_output.Set(values[0][simd_j] == values[1][simd_j], simd_j);
+  }
+
+  // the bound is a public constant, a single SIMD value suffices
+  std::array<MOTION::WireVector, 2> wires_out;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    wires_out[party_id] = beavy_providers_[party_id]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::EQEXP, wires_in[party_id],
+        plain::make_arithmetic_constant_wire(64, 1, vec_size));
+  }
+
+  run_setup();
+  run_gates_setup();
+  run_gates_online();
+
+  const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[0].at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[1].at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  EXPECT_EQ(expected_output, wire_0->get_public_share() ^ wire_0->get_secret_share() ^
+                                 wire_1->get_secret_share());
+}
+
+TEST_F(BooleanBEAVYTest, Threshold) {
+  // more than one word of SIMD values, and a bound which is not a power of two
+  std::size_t num_simd = 100;
+  std::size_t bound = 11;
+  std::uint64_t threshold = 4;
+  const auto values = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  std::array<std::vector<std::uint64_t>, 2> shares;
+  shares[0] = MOTION::Helpers::RandomVector<std::uint64_t>(num_simd);
+  shares[1].resize(num_simd);
+  ENCRYPTO::BitVector<> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    const auto value = values[simd_j] % bound;
+    shares[1][simd_j] = value - shares[0][simd_j];
+    expected_output.Set(value <= threshold, simd_j);
+  }
+
+  std::array<MOTION::WireVector, 2> wires_out;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    auto wire = std::make_shared<ArithmeticBEAVYWire<std::uint64_t>>(num_simd);
+    wire->get_public_share() = shares[party_id];
+    wire->set_additively_shared();
+    wire->set_setup_ready();
+    wire->set_online_ready();
+    // party 1 does not need to know the threshold
+    wires_out[party_id] = beavy_providers_[party_id]->make_threshold_gate(
+        {wire}, bound, party_id == 0 ? threshold : 0);
+  }
+
+  // only party 1 sends the one-hot rows of the 16 values of the domain
+  const auto cost = gate_registers_[1]->get_gates().back()->get_cost();
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_EQ(cost->setup_bytes_, 0);
+  EXPECT_EQ(cost->online_bytes_, 16 * num_simd / 8 + (num_simd + 7) / 8);
+
+  run_setup();
+  run_gates_setup();
+  run_gates_online();
+
+  const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[0].at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_out[1].at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  ASSERT_EQ(wire_0->get_public_share(), wire_1->get_public_share());
+  EXPECT_EQ(expected_output, wire_0->get_public_share() ^ wire_0->get_secret_share() ^
+                                 wire_1->get_secret_share());
+  EXPECT_THROW(beavy_providers_[0]->make_threshold_gate(wires_out[0], bound, threshold),
+               std::logic_error);
+}
+
+TEST_F(BooleanBEAVYTest, ConstantFolding) {
+  std::size_t num_wires = 3;
+  std::size_t num_simd = 10;
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  const auto wires_a = plain::make_boolean_constant_wires(inputs_a);
+  const auto wires_b = plain::make_boolean_constant_wires(inputs_b);
+
+  auto wires_xor = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR,
+                                                         wires_a, wires_b);
+  auto wires_and = beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND,
+                                                         wires_a, wires_b);
+
+  // both operands are public, so the results are computed when the circuit is built
+  EXPECT_EQ(gate_registers_[0]->get_num_gates(), 0);
+  ASSERT_EQ(wires_xor.size(), num_wires);
+  ASSERT_EQ(wires_and.size(), num_wires);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto wire_xor = std::dynamic_pointer_cast<plain::BooleanPlainWire>(wires_xor[wire_i]);
+    const auto wire_and = std::dynamic_pointer_cast<plain::BooleanPlainWire>(wires_and[wire_i]);
+    ASSERT_TRUE(wire_xor);
+    ASSERT_TRUE(wire_and);
+    EXPECT_EQ(wire_xor->get_data(), inputs_a[wire_i] ^ inputs_b[wire_i]);
+    EXPECT_EQ(wire_and->get_data(), inputs_a[wire_i] & inputs_b[wire_i]);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, WindowHAM) {
+  std::size_t bits_per_character = 3;
+  std::size_t text_size = 50;
+  std::size_t window_size = 4;
+  std::size_t num_windows = text_size - window_size + 1;
+  const auto text = generate_inputs(bits_per_character, text_size);
+  const auto pattern = generate_inputs(bits_per_character, window_size);
+  std::vector<std::uint64_t> expected_output(num_windows, 0);
+  for (std::size_t window_s = 0; window_s < num_windows; ++window_s) {
+    for (std::size_t bit_b = 0; bit_b < bits_per_character; ++bit_b) {
+      for (std::size_t char_p = 0; char_p < window_size; ++char_p) {
+        expected_output[window_s] +=
+            text[bit_b].Get(window_s + char_p) != pattern[bit_b].Get(char_p);
+      }
+    }
+  }
+
+  // the text of party 0 and the pattern of party 1
+  auto [text_promise, text_wires_0] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, bits_per_character, text_size);
+  auto text_wires_1 =
+      beavy_providers_[1]->make_boolean_input_gate_other(0, bits_per_character, text_size);
+  auto pattern_wires_0 =
+      beavy_providers_[0]->make_boolean_input_gate_other(1, bits_per_character, window_size);
+  auto [pattern_promise, pattern_wires_1] =
+      beavy_providers_[1]->make_boolean_input_gate_my(1, bits_per_character, window_size);
+  auto wires_0_out = beavy_providers_[0]->make_window_hamming_gate(text_wires_0, pattern_wires_0);
+  auto wires_1_out = beavy_providers_[1]->make_window_hamming_gate(text_wires_1, pattern_wires_1);
+
+  run_setup();
+  run_gates_setup();
+  text_promise.set_value(text);
+  pattern_promise.set_value(pattern);
+  run_gates_online();
+
+  ASSERT_EQ(wires_0_out.size(), 1);
+  ASSERT_EQ(wires_1_out.size(), 1);
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_0_out[0]);
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_1_out[0]);
+  wire_0->wait_online();
+  wire_1->wait_online();
+  EXPECT_TRUE(wire_0->is_additively_shared());
+  // the output consists of additive shares in the public share
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  ASSERT_EQ(share_0.size(), num_windows);
+  ASSERT_EQ(share_1.size(), num_windows);
+  for (std::size_t window_s = 0; window_s < num_windows; ++window_s) {
+    EXPECT_EQ(expected_output[window_s], share_0[window_s] + share_1[window_s]);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, WindowHAMInvalidPattern) {
+  auto text_wires = beavy_providers_[0]->make_boolean_input_gate_other(1, 3, 10);
+  auto pattern_wires = beavy_providers_[0]->make_boolean_input_gate_other(1, 2, 4);
+  EXPECT_THROW(beavy_providers_[0]->make_window_hamming_gate(text_wires, pattern_wires),
+               std::logic_error);
+  auto long_pattern_wires = beavy_providers_[0]->make_boolean_input_gate_other(1, 3, 11);
+  EXPECT_THROW(beavy_providers_[0]->make_window_hamming_gate(text_wires, long_pattern_wires),
+               std::logic_error);
+}
+
+TEST_F(BooleanBEAVYTest, BandedEditDistance) {
+  std::size_t bits_per_character = 2;
+  std::size_t pattern_size = 6;
+  std::size_t band = 2;
+  std::size_t num_simd = 20;
+  std::size_t num_wires = bits_per_character * pattern_size;
+  // a window of the text of party 0 and a copy of the pattern of party 1 in every SIMD value
+  const auto text = generate_inputs(num_wires, num_simd);
+  const auto pattern = generate_inputs(num_wires, num_simd);
+  std::vector<std::uint64_t> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    std::vector<std::uint64_t> text_characters(pattern_size), pattern_characters(pattern_size);
+    for (std::size_t char_k = 0; char_k < pattern_size; ++char_k) {
+      for (std::size_t bit_b = 0; bit_b < bits_per_character; ++bit_b) {
+        const auto wire_i = char_k * bits_per_character + bit_b;
+        text_characters[char_k] |= std::uint64_t(text[wire_i].Get(simd_j)) << bit_b;
+        pattern_characters[char_k] |= std::uint64_t(pattern[wire_i].Get(simd_j)) << bit_b;
+      }
+    }
+    expected_output[simd_j] =
+        MOTION::banded_edit_distance(pattern_characters, text_characters, band);
+  }
+
+  auto [text_promise, text_wires_0] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto text_wires_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto pattern_wires_0 = beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+  auto [pattern_promise, pattern_wires_1] =
+      beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+  auto wires_0_out = MOTION::make_banded_edit_distance_circuit(
+      *beavy_providers_[0], text_wires_0, pattern_wires_0, bits_per_character, band);
+  auto wires_1_out = MOTION::make_banded_edit_distance_circuit(
+      *beavy_providers_[1], text_wires_1, pattern_wires_1, bits_per_character, band);
+
+  run_setup();
+  run_gates_setup();
+  text_promise.set_value(text);
+  pattern_promise.set_value(pattern);
+  run_gates_online();
+
+  ASSERT_EQ(wires_0_out.size(), 1);
+  ASSERT_EQ(wires_1_out.size(), 1);
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_0_out[0]);
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<std::uint64_t>>(wires_1_out[0]);
+  wire_0->wait_online();
+  wire_1->wait_online();
+  EXPECT_TRUE(wire_0->is_additively_shared());
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    EXPECT_EQ(expected_output[simd_j], share_0[simd_j] + share_1[simd_j]);
+  }
+  EXPECT_THROW(MOTION::make_banded_edit_distance_circuit(*beavy_providers_[0], text_wires_0,
+                                                         pattern_wires_0, 5, band),
+               std::invalid_argument);
+}
+
+TEST_F(BooleanBEAVYTest, ORReduction) {
+  std::size_t num_wires = 3;
+  // no round, a single round, a padded tree, and more rounds
+  const std::vector<std::size_t> nums_simd = {1, 4, 17, 70};
+  std::vector<MOTION::BitValues> inputs;
+  std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>> promises;
+  std::array<std::vector<MOTION::WireVector>, 2> output_wires;
+  for (auto num_simd : nums_simd) {
+    // the first wire is zero, the second one has only its last bit set
+    inputs.push_back(generate_inputs(num_wires, num_simd));
+    inputs.back()[0] = ENCRYPTO::BitVector<>(num_simd);
+    inputs.back()[1] = ENCRYPTO::BitVector<>(num_simd);
+    inputs.back()[1].Set(true, num_simd - 1);
+    auto [promise, wires_0_in] =
+        beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+    auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+    promises.push_back(std::move(promise));
+    output_wires[0].push_back(beavy_providers_[0]->make_or_reduction_gate(wires_0_in));
+    output_wires[1].push_back(beavy_providers_[1]->make_or_reduction_gate(wires_1_in));
+  }
+
+  run_setup();
+  run_gates_setup();
+  for (std::size_t gate_i = 0; gate_i < nums_simd.size(); ++gate_i) {
+    promises[gate_i].set_value(inputs[gate_i]);
+  }
+  run_gates_online();
+
+  for (std::size_t gate_i = 0; gate_i < nums_simd.size(); ++gate_i) {
+    ASSERT_EQ(output_wires[0][gate_i].size(), num_wires);
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto wire_0 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[0][gate_i].at(wire_i));
+      const auto wire_1 =
+          std::dynamic_pointer_cast<BooleanBEAVYWire>(output_wires[1][gate_i].at(wire_i));
+      wire_0->wait_online();
+      wire_1->wait_online();
+      const auto& pshare_0 = wire_0->get_public_share();
+      ASSERT_EQ(pshare_0.GetSize(), 1);
+      ASSERT_EQ(pshare_0, wire_1->get_public_share());
+      const auto& input = inputs[gate_i][wire_i];
+      const bool any_set = input != ENCRYPTO::BitVector<>(input.GetSize());
+      const ENCRYPTO::BitVector<> expected_output(1, any_set);
+      ASSERT_EQ(expected_output,
+                pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share());
+    }
+  }
+}
+
+TEST_F(BooleanBEAVYTest, PrefixOR) {
+  std::size_t num_wires = 2;
+  std::size_t num_simd = 70;
+  // a few set bits, such that the prefixes differ
+  MOTION::BitValues inputs(num_wires, ENCRYPTO::BitVector<>(num_simd));
+  inputs[0].Set(true, 3);
+  inputs[0].Set(true, 40);
+  inputs[1].Set(true, 69);
+  MOTION::BitValues expected_outputs(num_wires, ENCRYPTO::BitVector<>(num_simd));
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    bool prefix_or = false;
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      prefix_or = prefix_or || inputs[wire_i].Get(simd_j);
+      expected_outputs[wire_i].Set(prefix_or, simd_j);
+    }
+  }
+
+  auto [input_promise, wires_0_in] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_out = beavy_providers_[0]->make_prefix_or_gate(wires_0_in);
+  auto wires_1_out = beavy_providers_[1]->make_prefix_or_gate(wires_1_in);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(inputs);
+  run_gates_online();
+
+  ASSERT_EQ(wires_0_out.size(), num_wires);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0_out.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1_out.at(wire_i));
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& pshare_0 = wire_0->get_public_share();
+    ASSERT_EQ(pshare_0, wire_1->get_public_share());
+    ASSERT_EQ(expected_outputs[wire_i],
+              pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share());
+  }
+}
+
+TEST_F(BooleanBEAVYTest, FirstPositions) {
+  std::size_t num_simd = 60;
+  std::size_t k = 3;
+  // fewer matches than requested positions, which are padded with zeros
+  MOTION::BitValues inputs(1, ENCRYPTO::BitVector<>(num_simd));
+  inputs[0].Set(true, 0);
+  inputs[0].Set(true, 17);
+  const std::vector<std::size_t> expected_positions = {1, 18, 0};
+
+  auto [input_promise, wires_0_in] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, 1, num_simd);
+  auto wires_1_in = beavy_providers_[1]->make_boolean_input_gate_other(0, 1, num_simd);
+  auto wires_0_out = beavy_providers_[0]->make_first_positions_gate(wires_0_in, k);
+  auto wires_1_out = beavy_providers_[1]->make_first_positions_gate(wires_1_in, k);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(inputs);
+  run_gates_online();
+
+  // 6 bits for the positions 1, ..., 60
+  ASSERT_EQ(wires_0_out.size(), 6);
+  ASSERT_EQ(wires_1_out.size(), 6);
+  std::vector<std::size_t> positions(k, 0);
+  for (std::size_t bit_b = 0; bit_b < wires_0_out.size(); ++bit_b) {
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0_out.at(bit_b));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1_out.at(bit_b));
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& pshare_0 = wire_0->get_public_share();
+    ASSERT_EQ(pshare_0.GetSize(), k);
+    ASSERT_EQ(pshare_0, wire_1->get_public_share());
+    const auto bits = pshare_0 ^ wire_0->get_secret_share() ^ wire_1->get_secret_share();
+    for (std::size_t position_r = 0; position_r < k; ++position_r) {
+      positions[position_r] |= std::size_t(bits.Get(position_r)) << bit_b;
+    }
+  }
+  EXPECT_EQ(positions, expected_positions);
+}
+
+TEST_F(BooleanBEAVYTest, FirstPositionsInvalidInput) {
+  auto wires_in = beavy_providers_[0]->make_boolean_input_gate_other(1, 2, 10);
+  EXPECT_THROW(beavy_providers_[0]->make_first_positions_gate(wires_in, 1), std::logic_error);
+  wires_in.pop_back();
+  EXPECT_THROW(beavy_providers_[0]->make_first_positions_gate(wires_in, 0), std::logic_error);
+}
+
+TEST_F(BooleanBEAVYTest, BooleanBEAVYToGMW) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  const auto expected_output = generate_inputs(num_wires, num_simd);
+
+  auto [input_promise, wires_in_0] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_in_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+
+  auto wires_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_0);
+  auto wires_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_1);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(expected_output);
+  run_gates_online();
+
+  // check wire values
+  ASSERT_EQ(wires_0.size(), num_wires);
+  ASSERT_EQ(wires_1.size(), num_wires);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& expected_output_bits = expected_output.at(wire_i);
+    const auto wire_0 = std::dynamic_pointer_cast<gmw::BooleanGMWWire>(wires_0.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<gmw::BooleanGMWWire>(wires_1.at(wire_i));
+    ASSERT_NE(wire_0, nullptr);
+    ASSERT_NE(wire_1, nullptr);
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& share_0 = wire_0->get_share();
+    const auto& share_1 = wire_1->get_share();
+    ASSERT_EQ(share_0.GetSize(), num_simd);
+    ASSERT_EQ(share_1.GetSize(), num_simd);
+    ASSERT_EQ(expected_output_bits, share_0 ^ share_1);
+  }
+}
+
+TEST_F(BooleanBEAVYTest, BooleanBEAVYFromGMW) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  const auto expected_output = generate_inputs(num_wires, num_simd);
+
+  auto [input_promise, wires_in_0] =
+      beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_in_1 = beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+
+  auto wires_tmp_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_0);
+  auto wires_tmp_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanGMW, wires_in_1);
+  auto wires_0 = beavy_providers_[0]->convert(MOTION::MPCProtocol::BooleanBEAVY, wires_tmp_0);
+  auto wires_1 = beavy_providers_[1]->convert(MOTION::MPCProtocol::BooleanBEAVY, wires_tmp_1);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(expected_output);
+  run_gates_online();
+
+  // check wire values
+  ASSERT_EQ(wires_0.size(), num_wires);
+  ASSERT_EQ(wires_1.size(), num_wires);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto& expected_output_bits = expected_output.at(wire_i);
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_0.at(wire_i));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires_1.at(wire_i));
+    ASSERT_NE(wire_0, nullptr);
+    ASSERT_NE(wire_1, nullptr);
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& sshare_0 = wire_0->get_secret_share();
+    const auto& sshare_1 = wire_1->get_secret_share();
+    const auto& pshare_0 = wire_0->get_public_share();
+    const auto& pshare_1 = wire_1->get_public_share();
+    ASSERT_EQ(sshare_0.GetSize(), num_simd);
+    ASSERT_EQ(sshare_1.GetSize(), num_simd);
+    ASSERT_EQ(pshare_0.GetSize(), num_simd);
+    ASSERT_EQ(pshare_0, pshare_1);
+    ASSERT_EQ(expected_output_bits, pshare_0 ^ sshare_0 ^ sshare_1);
+  }
+}
+
+template <typename T>
+class ArithmeticBEAVYTest : public BEAVYTest {
+ public:
+  static std::vector<T> generate_inputs(std::size_t num_simd) {
+    return MOTION::Helpers::RandomVector<T>(num_simd);
+  }
+  std::pair<ENCRYPTO::ReusableFiberPromise<MOTION::IntegerValues<T>>, MOTION::WireVector>
+  make_arithmetic_T_input_gate_my(std::size_t party_id, std::size_t input_owner,
+                                  std::size_t num_simd) {
+    auto& gp = *beavy_providers_.at(party_id);
+    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
+      return gp.make_arithmetic_8_input_gate_my(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
+      return gp.make_arithmetic_16_input_gate_my(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
+      return gp.make_arithmetic_32_input_gate_my(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
+      return gp.make_arithmetic_64_input_gate_my(input_owner, num_simd);
+    }
+  }
+  MOTION::WireVector make_arithmetic_T_input_gate_other(std::size_t party_id,
+                                                        std::size_t input_owner,
+                                                        std::size_t num_simd) {
+    auto& gp = *beavy_providers_.at(party_id);
+    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
+      return gp.make_arithmetic_8_input_gate_other(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
+      return gp.make_arithmetic_16_input_gate_other(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
+      return gp.make_arithmetic_32_input_gate_other(input_owner, num_simd);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
+      return gp.make_arithmetic_64_input_gate_other(input_owner, num_simd);
+    }
+  }
+  ENCRYPTO::ReusableFiberFuture<MOTION::IntegerValues<T>> make_arithmetic_T_output_gate_my(
+      std::size_t party_id, std::size_t output_owner, const MOTION::WireVector& in) {
+    auto& gp = *beavy_providers_.at(party_id);
+    if constexpr (ENCRYPTO::bit_size_v<T> == 8) {
+      return gp.make_arithmetic_8_output_gate_my(output_owner, in);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 16) {
+      return gp.make_arithmetic_16_output_gate_my(output_owner, in);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 32) {
+      return gp.make_arithmetic_32_output_gate_my(output_owner, in);
+    } else if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
+      return gp.make_arithmetic_64_output_gate_my(output_owner, in);
+    }
+  }
+};
+
+using integer_types = ::testing::Types<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t>;
+TYPED_TEST_SUITE(ArithmeticBEAVYTest, integer_types);
+
+TYPED_TEST(ArithmeticBEAVYTest, Input) {
+  std::size_t num_simd = 10;
+  const auto inputs_a = this->generate_inputs(num_simd);
+  const auto inputs_b = this->generate_inputs(num_simd);
+
+  // input of party 0
+  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  // input of party 1
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  ASSERT_EQ(wires_a_in_0.size(), 1);
   ASSERT_EQ(wires_a_in_1.size(), 1);
   ASSERT_EQ(wires_b_in_0.size(), 1);
   ASSERT_EQ(wires_b_in_1.size(), 1);
@@ -706,40 +1684,73 @@ TYPED_TEST(ArithmeticBEAVYTest, Input) {
   input_b_promise.set_value(inputs_b);
   this->run_gates_online();
 
-  // check wire values
-  const auto wire_a0 =
-      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_a_in_0.at(0));
-  const auto wire_a1 =
-      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_a_in_1.at(0));
+  // check wire values
+  const auto wire_a0 =
+      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_a_in_0.at(0));
+  const auto wire_a1 =
+      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_a_in_1.at(0));
+  const auto wire_b0 =
+      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_b_in_0.at(0));
+  const auto wire_b1 =
+      std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_b_in_1.at(0));
+  wire_a0->wait_online();
+  wire_a1->wait_online();
+  wire_b0->wait_online();
+  wire_b1->wait_online();
+  const auto& pshare_a0 = wire_a0->get_public_share();
+  const auto& pshare_a1 = wire_a1->get_public_share();
+  const auto& pshare_b0 = wire_b0->get_public_share();
+  const auto& pshare_b1 = wire_b1->get_public_share();
+  const auto& sshare_a0 = wire_a0->get_secret_share();
+  const auto& sshare_a1 = wire_a1->get_secret_share();
+  const auto& sshare_b0 = wire_b0->get_secret_share();
+  const auto& sshare_b1 = wire_b1->get_secret_share();
+  ASSERT_EQ(pshare_a0.size(), num_simd);
+  ASSERT_EQ(pshare_a1.size(), num_simd);
+  ASSERT_EQ(pshare_b0.size(), num_simd);
+  ASSERT_EQ(pshare_b1.size(), num_simd);
+  ASSERT_EQ(sshare_a0.size(), num_simd);
+  ASSERT_EQ(sshare_a1.size(), num_simd);
+  ASSERT_EQ(sshare_b0.size(), num_simd);
+  ASSERT_EQ(sshare_b1.size(), num_simd);
+  ASSERT_EQ(pshare_a0, pshare_a1);
+  ASSERT_EQ(pshare_b0, pshare_b1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(inputs_a[simd_j],
+              TypeParam(pshare_a0[simd_j] - sshare_a0[simd_j] - sshare_a1[simd_j]));
+    ASSERT_EQ(inputs_b[simd_j],
+              TypeParam(pshare_b0[simd_j] - sshare_b0[simd_j] - sshare_b1[simd_j]));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, NonInteractiveInput) {
+  std::size_t num_simd = 10;
+  const auto inputs_b = this->generate_inputs(num_simd);
+
+  for (std::size_t i = 0; i < 2; ++i) {
+    this->beavy_providers_[i]->set_non_interactive_inputs(true);
+  }
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  this->run_setup();
+  // the setup of the input gate needs the input
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_setup();
+  this->run_gates_online();
+
   const auto wire_b0 =
       std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_b_in_0.at(0));
   const auto wire_b1 =
       std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_b_in_1.at(0));
-  wire_a0->wait_online();
-  wire_a1->wait_online();
   wire_b0->wait_online();
   wire_b1->wait_online();
-  const auto& pshare_a0 = wire_a0->get_public_share();
-  const auto& pshare_a1 = wire_a1->get_public_share();
   const auto& pshare_b0 = wire_b0->get_public_share();
-  const auto& pshare_b1 = wire_b1->get_public_share();
-  const auto& sshare_a0 = wire_a0->get_secret_share();
-  const auto& sshare_a1 = wire_a1->get_secret_share();
   const auto& sshare_b0 = wire_b0->get_secret_share();
   const auto& sshare_b1 = wire_b1->get_secret_share();
-  ASSERT_EQ(pshare_a0.size(), num_simd);
-  ASSERT_EQ(pshare_a1.size(), num_simd);
   ASSERT_EQ(pshare_b0.size(), num_simd);
-  ASSERT_EQ(pshare_b1.size(), num_simd);
-  ASSERT_EQ(sshare_a0.size(), num_simd);
-  ASSERT_EQ(sshare_a1.size(), num_simd);
-  ASSERT_EQ(sshare_b0.size(), num_simd);
-  ASSERT_EQ(sshare_b1.size(), num_simd);
-  ASSERT_EQ(pshare_a0, pshare_a1);
-  ASSERT_EQ(pshare_b0, pshare_b1);
+  ASSERT_EQ(pshare_b0, wire_b1->get_public_share());
   for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    ASSERT_EQ(inputs_a[simd_j],
-              TypeParam(pshare_a0[simd_j] - sshare_a0[simd_j] - sshare_a1[simd_j]));
     ASSERT_EQ(inputs_b[simd_j],
               TypeParam(pshare_b0[simd_j] - sshare_b0[simd_j] - sshare_b1[simd_j]));
   }
@@ -825,6 +1836,50 @@ TYPED_TEST(ArithmeticBEAVYTest, OutputBoth) {
   ASSERT_EQ(inputs_b, outputs_b_1);
 }
 
+TYPED_TEST(ArithmeticBEAVYTest, BulkInput) {
+  using T = TypeParam;
+  std::size_t num_values = 25;
+  std::size_t chunk_size = 10;
+  std::size_t num_simd = 3;
+  const auto inputs_a = this->generate_inputs(num_values);
+  const auto inputs_b = this->generate_inputs(num_simd);
+
+  auto wires_a_in_0 = this->beavy_providers_[0]->template make_arithmetic_bulk_input_gate_my<T>(
+      std::span<const T>(inputs_a), chunk_size);
+  auto wires_a_in_1 =
+      this->beavy_providers_[1]->template make_arithmetic_bulk_input_gate_other<T>(0, num_values,
+                                                                                  chunk_size);
+  ASSERT_EQ(wires_a_in_0.size(), 3);
+  ASSERT_EQ(wires_a_in_1.size(), 3);
+  ASSERT_EQ(wires_a_in_1.at(2)->get_num_simd(), 5);
+
+  // the gates after the bulk input still use matching gate ids
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  std::vector<ENCRYPTO::ReusableFiberFuture<MOTION::IntegerValues<T>>> output_futures_a;
+  for (std::size_t chunk_i = 0; chunk_i < wires_a_in_0.size(); ++chunk_i) {
+    this->beavy_providers_[0]->make_arithmetic_output_gate_other(1, {wires_a_in_0.at(chunk_i)});
+    output_futures_a.push_back(
+        this->make_arithmetic_T_output_gate_my(1, 1, {wires_a_in_1.at(chunk_i)}));
+  }
+  auto output_future_b_0 = this->make_arithmetic_T_output_gate_my(0, 0, wires_b_in_0);
+  this->beavy_providers_[1]->make_arithmetic_output_gate_other(0, wires_b_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_online();
+
+  std::vector<T> outputs_a;
+  for (auto& future : output_futures_a) {
+    const auto chunk = future.get();
+    outputs_a.insert(std::end(outputs_a), std::begin(chunk), std::end(chunk));
+  }
+  EXPECT_EQ(outputs_a, inputs_a);
+  EXPECT_EQ(output_future_b_0.get(), inputs_b);
+}
+
 TYPED_TEST(ArithmeticBEAVYTest, NEG) {
   std::size_t num_simd = 10;
   const auto inputs = this->generate_inputs(num_simd);
@@ -945,28 +2000,278 @@ TYPED_TEST(ArithmeticBEAVYTest, ConstantADD) {
   const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
   wire_0->wait_online();
   wire_1->wait_online();
-  const auto& pshare_0 = wire_0->get_public_share();
-  const auto& pshare_1 = wire_1->get_public_share();
-  const auto& sshare_0 = wire_0->get_secret_share();
-  const auto& sshare_1 = wire_1->get_secret_share();
-  ASSERT_EQ(pshare_0.size(), num_simd);
-  ASSERT_EQ(pshare_1.size(), num_simd);
-  ASSERT_EQ(sshare_0.size(), num_simd);
-  ASSERT_EQ(sshare_1.size(), num_simd);
-  ASSERT_EQ(pshare_0, pshare_1);
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    ASSERT_EQ(expected_output.at(simd_j),
-              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  const auto& pshare_0 = wire_0->get_public_share();
+  const auto& pshare_1 = wire_1->get_public_share();
+  const auto& sshare_0 = wire_0->get_secret_share();
+  const auto& sshare_1 = wire_1->get_secret_share();
+  ASSERT_EQ(pshare_0.size(), num_simd);
+  ASSERT_EQ(pshare_1.size(), num_simd);
+  ASSERT_EQ(sshare_0.size(), num_simd);
+  ASSERT_EQ(sshare_1.size(), num_simd);
+  ASSERT_EQ(pshare_0, pshare_1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j),
+              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, ConstantFolding) {
+  std::size_t num_simd = 10;
+  const auto inputs_a = this->generate_inputs(num_simd);
+  const auto inputs_b = this->generate_inputs(num_simd);
+  const auto wires_a = plain::make_arithmetic_constant_wire(inputs_a);
+  const auto wires_b = plain::make_arithmetic_constant_wire(inputs_b);
+
+  auto wires_add = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::ADD, wires_a, wires_b);
+  auto wires_mul = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a, wires_b);
+
+  EXPECT_EQ(this->gate_registers_[0]->get_num_gates(), 0);
+  const auto wire_add =
+      std::dynamic_pointer_cast<plain::ArithmeticPlainWire<TypeParam>>(wires_add.at(0));
+  const auto wire_mul =
+      std::dynamic_pointer_cast<plain::ArithmeticPlainWire<TypeParam>>(wires_mul.at(0));
+  ASSERT_TRUE(wire_add);
+  ASSERT_TRUE(wire_mul);
+  ASSERT_EQ(wire_add->get_data().size(), num_simd);
+  ASSERT_EQ(wire_mul->get_data().size(), num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    EXPECT_EQ(wire_add->get_data()[simd_j], TypeParam(inputs_a[simd_j] + inputs_b[simd_j]));
+    EXPECT_EQ(wire_mul->get_data()[simd_j],
+              TypeParam(std::uint64_t(inputs_a[simd_j]) * inputs_b[simd_j]));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, MUL) {
+  std::size_t num_simd = 10;
+  const auto inputs_a = this->generate_inputs(num_simd);
+  const auto inputs_b = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output), std::multiplies{});
+
+  // input of party 0
+  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  // input of party 1
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  auto wires_out_0 = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_0, wires_b_in_0);
+  auto wires_out_1 = this->beavy_providers_[1]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_1, wires_b_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_online();
+
+  // check wire values
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& pshare_0 = wire_0->get_public_share();
+  const auto& pshare_1 = wire_1->get_public_share();
+  const auto& sshare_0 = wire_0->get_secret_share();
+  const auto& sshare_1 = wire_1->get_secret_share();
+  ASSERT_EQ(pshare_0.size(), num_simd);
+  ASSERT_EQ(pshare_1.size(), num_simd);
+  ASSERT_EQ(sshare_0.size(), num_simd);
+  ASSERT_EQ(sshare_1.size(), num_simd);
+  ASSERT_EQ(pshare_0, pshare_1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j),
+              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, StrongPartyMUL) {
+  std::size_t num_simd = 10;
+  const auto inputs_a = this->generate_inputs(num_simd);
+  const auto inputs_b = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output), std::multiplies{});
+
+  // party 0 is the receiver of all OTs
+  for (std::size_t i = 0; i < 2; ++i) {
+    this->beavy_providers_[i]->set_strong_party(0);
+  }
+  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  auto wires_out_0 = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_0, wires_b_in_0);
+  auto wires_out_1 = this->beavy_providers_[1]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_1, wires_b_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_online();
+
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& pshare_0 = wire_0->get_public_share();
+  const auto& pshare_1 = wire_1->get_public_share();
+  const auto& sshare_0 = wire_0->get_secret_share();
+  const auto& sshare_1 = wire_1->get_secret_share();
+  ASSERT_EQ(pshare_0, pshare_1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j),
+              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, ConstantMUL) {
+  std::size_t num_simd = 10;
+  const auto inputs_a = this->generate_inputs(num_simd);
+  const auto inputs_b = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output), std::multiplies{});
+
+  MOTION::WireVector plain_wires_0 = {
+      std::make_shared<plain::ArithmeticPlainWire<TypeParam>>(inputs_b)};
+  MOTION::WireVector plain_wires_1 = {
+      std::make_shared<plain::ArithmeticPlainWire<TypeParam>>(inputs_b)};
+
+  // input of party 0
+  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  auto wires_out_0 = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_0, plain_wires_0);
+  auto wires_out_1 = this->beavy_providers_[1]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_1, plain_wires_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  this->run_gates_online();
+
+  // check wire values
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& pshare_0 = wire_0->get_public_share();
+  const auto& pshare_1 = wire_1->get_public_share();
+  const auto& sshare_0 = wire_0->get_secret_share();
+  const auto& sshare_1 = wire_1->get_secret_share();
+  ASSERT_EQ(pshare_0.size(), num_simd);
+  ASSERT_EQ(pshare_1.size(), num_simd);
+  ASSERT_EQ(sshare_0.size(), num_simd);
+  ASSERT_EQ(sshare_1.size(), num_simd);
+  ASSERT_EQ(pshare_0, pshare_1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j),
+              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, SQR) {
+  std::size_t num_simd = 10;
+  const auto inputs = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output;
+  std::transform(std::begin(inputs), std::end(inputs), std::back_inserter(expected_output),
+                 [](auto x) { return x * x; });
+
+  // input of party 0
+  auto [input_promise, wires_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  auto wires_out_0 =
+      this->beavy_providers_[0]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::SQR, wires_in_0);
+  auto wires_out_1 =
+      this->beavy_providers_[1]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::SQR, wires_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(inputs);
+  this->run_gates_online();
+
+  // check wire values
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& pshare_0 = wire_0->get_public_share();
+  const auto& pshare_1 = wire_1->get_public_share();
+  const auto& sshare_0 = wire_0->get_secret_share();
+  const auto& sshare_1 = wire_1->get_secret_share();
+  ASSERT_EQ(pshare_0.size(), num_simd);
+  ASSERT_EQ(pshare_1.size(), num_simd);
+  ASSERT_EQ(sshare_0.size(), num_simd);
+  ASSERT_EQ(sshare_1.size(), num_simd);
+  ASSERT_EQ(pshare_0, pshare_1);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j),
+              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, AHAM) {
+  std::size_t group_size = 8;
+  std::size_t num_groups = 10;
+  std::size_t num_simd = group_size * num_groups;
+  std::vector<TypeParam> inputs = this->generate_inputs(num_simd);
+  std::transform(std::begin(inputs), std::end(inputs), std::begin(inputs),
+                 [](auto x) { return TypeParam(x & 1); });
+  std::vector<TypeParam> expected_output(num_groups, 0);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    expected_output[simd_j / group_size] += inputs[simd_j];
+  }
+
+  // input of party 0
+  auto [input_promise, wires_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  auto wires_out_0 =
+      this->beavy_providers_[0]->make_arithmetic_hamming_gate(wires_in_0, group_size);
+  auto wires_out_1 =
+      this->beavy_providers_[1]->make_arithmetic_hamming_gate(wires_in_1, group_size);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(inputs);
+  this->run_gates_online();
+
+  // check wire values
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  // the output consists of additive shares in the public share
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  ASSERT_EQ(share_0.size(), num_groups);
+  ASSERT_EQ(share_1.size(), num_groups);
+  for (std::size_t group_j = 0; group_j < num_groups; ++group_j) {
+    ASSERT_EQ(expected_output.at(group_j), TypeParam(share_0.at(group_j) + share_1.at(group_j)));
   }
 }
 
-TYPED_TEST(ArithmeticBEAVYTest, MUL) {
+TYPED_TEST(ArithmeticBEAVYTest, DeferredReconstruction) {
   std::size_t num_simd = 10;
   const auto inputs_a = this->generate_inputs(num_simd);
   const auto inputs_b = this->generate_inputs(num_simd);
   std::vector<TypeParam> expected_output;
   std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
-                 std::back_inserter(expected_output), std::multiplies{});
+                 std::back_inserter(expected_output), [](auto a, auto b) {
+                   TypeParam c = a * b + a;
+                   return TypeParam(c * c);
+                 });
 
   // input of party 0
   auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
@@ -976,10 +2281,28 @@ TYPED_TEST(ArithmeticBEAVYTest, MUL) {
   auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
   auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
 
-  auto wires_out_0 = this->beavy_providers_[0]->make_binary_gate(
-      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_0, wires_b_in_0);
-  auto wires_out_1 = this->beavy_providers_[1]->make_binary_gate(
-      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_1, wires_b_in_1);
+  std::array<MOTION::WireVector, 2> wires_out;
+  std::array<MOTION::WireVector, 2> wires_c;
+  std::array<std::pair<MOTION::WireVector, MOTION::WireVector>, 2> wires_in = {
+      std::make_pair(wires_a_in_0, wires_b_in_0), std::make_pair(wires_a_in_1, wires_b_in_1)};
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    auto& gp = *this->beavy_providers_[party_id];
+    const auto& [wires_a, wires_b] = wires_in[party_id];
+    // (a * b) + a stays additively shared
+    auto wires_ab = gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, wires_a, wires_b);
+    wires_c[party_id] =
+        gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::ADD, wires_ab, wires_a);
+    ASSERT_TRUE(std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_c[party_id].at(0))
+                    ->is_additively_shared());
+    // both inputs of the multiplication are reconstructed by the same gate
+    wires_out[party_id] = gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MUL,
+                                              wires_c[party_id], wires_c[party_id]);
+    // and a later use of the wire reuses it
+    const auto reconstructed_0 = gp.reconstruct_additive_wires({wires_c[party_id]});
+    const auto reconstructed_1 = gp.reconstruct_additive_wires({wires_c[party_id]});
+    ASSERT_TRUE(reconstructed_0.at(0).at(0) == reconstructed_1.at(0).at(0));
+    ASSERT_TRUE(reconstructed_0.at(0).at(0) != wires_c[party_id].at(0));
+  }
 
   this->run_setup();
   this->run_gates_setup();
@@ -988,8 +2311,9 @@ TYPED_TEST(ArithmeticBEAVYTest, MUL) {
   this->run_gates_online();
 
   // check wire values
-  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
-  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out[0].at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out[1].at(0));
+  ASSERT_FALSE(wire_0->is_additively_shared());
   wire_0->wait_online();
   wire_1->wait_online();
   const auto& pshare_0 = wire_0->get_public_share();
@@ -997,9 +2321,6 @@ TYPED_TEST(ArithmeticBEAVYTest, MUL) {
   const auto& sshare_0 = wire_0->get_secret_share();
   const auto& sshare_1 = wire_1->get_secret_share();
   ASSERT_EQ(pshare_0.size(), num_simd);
-  ASSERT_EQ(pshare_1.size(), num_simd);
-  ASSERT_EQ(sshare_0.size(), num_simd);
-  ASSERT_EQ(sshare_1.size(), num_simd);
   ASSERT_EQ(pshare_0, pshare_1);
   for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
     ASSERT_EQ(expected_output.at(simd_j),
@@ -1007,31 +2328,127 @@ TYPED_TEST(ArithmeticBEAVYTest, MUL) {
   }
 }
 
-TYPED_TEST(ArithmeticBEAVYTest, ConstantMUL) {
+TYPED_TEST(ArithmeticBEAVYTest, DeferredReconstructionCost) {
+  std::size_t num_simd = 10;
+  auto [input_promise, wires_in] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto& gp = *this->beavy_providers_[0];
+  auto wires_ab = gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, wires_in, wires_in);
+  auto wires_c = gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, wires_in, wires_in);
+  const auto& gates = this->gate_registers_[0]->get_gates();
+  const auto num_gates = gates.size();
+  // the wires are reconstructed by a single gate, the masked input is kept
+  auto wires = gp.reconstruct_additive_wires({wires_ab, wires_c, wires_in});
+  ASSERT_TRUE(wires.at(2).at(0) == wires_in.at(0));
+  ASSERT_EQ(gates.size(), num_gates + 1);
+  const auto cost = gates.back()->get_cost();
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_EQ(cost->online_rounds_, 1);
+  EXPECT_EQ(cost->deferred_rounds_, 1);
+  EXPECT_EQ(cost->online_bytes_, 2 * num_simd * sizeof(TypeParam));
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, LaneMap) {
   std::size_t num_simd = 10;
   const auto inputs_a = this->generate_inputs(num_simd);
   const auto inputs_b = this->generate_inputs(num_simd);
-  std::vector<TypeParam> expected_output;
-  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
-                 std::back_inserter(expected_output), std::multiplies{});
-
-  MOTION::WireVector plain_wires_0 = {
-      std::make_shared<plain::ArithmeticPlainWire<TypeParam>>(inputs_b)};
-  MOTION::WireVector plain_wires_1 = {
-      std::make_shared<plain::ArithmeticPlainWire<TypeParam>>(inputs_b)};
+  // values of a * b, which is additively shared, followed by the values of a, which is masked
+  const std::vector<std::size_t> sources = {12, 3, 0, 19, 9, 12};
+  std::vector<TypeParam> expected_mixed;
+  for (auto value_i : sources) {
+    expected_mixed.push_back(value_i < num_simd ? TypeParam(inputs_a[value_i] * inputs_b[value_i])
+                                                : inputs_a[value_i - num_simd]);
+  }
+  const std::vector<TypeParam> expected_masked = {inputs_a[9], inputs_a[0]};
 
-  // input of party 0
   auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
   auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
 
-  auto wires_out_0 = this->beavy_providers_[0]->make_binary_gate(
-      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_0, plain_wires_0);
-  auto wires_out_1 = this->beavy_providers_[1]->make_binary_gate(
-      ENCRYPTO::PrimitiveOperationType::MUL, wires_a_in_1, plain_wires_1);
+  std::array<MOTION::WireVector, 2> wires_mixed;
+  std::array<MOTION::WireVector, 2> wires_masked;
+  std::array<std::pair<MOTION::WireVector, MOTION::WireVector>, 2> wires_in = {
+      std::make_pair(wires_a_in_0, wires_b_in_0), std::make_pair(wires_a_in_1, wires_b_in_1)};
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    auto& gp = *this->beavy_providers_[party_id];
+    const auto& [wires_a, wires_b] = wires_in[party_id];
+    auto wires_ab = gp.make_binary_gate(ENCRYPTO::PrimitiveOperationType::MULNI, wires_a, wires_b);
+    wires_mixed[party_id] = gp.make_arithmetic_lane_map_gate(
+        {wires_ab.at(0), wires_a.at(0)}, std::vector<std::size_t>(sources));
+    wires_masked[party_id] = gp.make_arithmetic_lane_map_gate(wires_a, {9, 0});
+    EXPECT_THROW(gp.make_arithmetic_lane_map_gate(wires_a, {num_simd}), std::logic_error);
+  }
 
   this->run_setup();
   this->run_gates_setup();
   input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_online();
+
+  const auto get_wire = [](const auto& wires) {
+    auto wire = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires.at(0));
+    wire->wait_online();
+    return wire;
+  };
+  // the public shares of the additively shared output hold the additive shares
+  const auto mixed_0 = get_wire(wires_mixed[0]);
+  const auto mixed_1 = get_wire(wires_mixed[1]);
+  ASSERT_TRUE(mixed_0->is_additively_shared());
+  ASSERT_EQ(mixed_0->get_public_share().size(), sources.size());
+  for (std::size_t simd_j = 0; simd_j < sources.size(); ++simd_j) {
+    EXPECT_EQ(expected_mixed.at(simd_j), TypeParam(mixed_0->get_public_share().at(simd_j) +
+                                                   mixed_1->get_public_share().at(simd_j)));
+  }
+  const auto masked_0 = get_wire(wires_masked[0]);
+  const auto masked_1 = get_wire(wires_masked[1]);
+  ASSERT_FALSE(masked_0->is_additively_shared());
+  ASSERT_EQ(masked_0->get_public_share(), masked_1->get_public_share());
+  for (std::size_t simd_j = 0; simd_j < expected_masked.size(); ++simd_j) {
+    EXPECT_EQ(expected_masked.at(simd_j), TypeParam(masked_0->get_public_share().at(simd_j) -
+                                                    masked_0->get_secret_share().at(simd_j) -
+                                                    masked_1->get_secret_share().at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, AHAMInvalidGroupSize) {
+  std::size_t num_simd = 10;
+  auto wires_in = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+  EXPECT_THROW(this->beavy_providers_[1]->make_arithmetic_hamming_gate(wires_in, 3),
+               std::invalid_argument);
+  EXPECT_THROW(this->beavy_providers_[1]->make_arithmetic_hamming_gate(wires_in, 0),
+               std::invalid_argument);
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, WindowDistance) {
+  std::size_t text_size = 40;
+  std::size_t window_size = 5;
+  std::size_t num_windows = text_size - window_size + 1;
+  const auto text = this->generate_inputs(text_size);
+  const auto pattern = this->generate_inputs(window_size);
+  std::vector<TypeParam> expected_output(num_windows, 0);
+  for (std::size_t window_s = 0; window_s < num_windows; ++window_s) {
+    for (std::size_t char_p = 0; char_p < window_size; ++char_p) {
+      TypeParam difference = text[window_s + char_p] - pattern[char_p];
+      expected_output[window_s] += TypeParam(difference * difference);
+    }
+  }
+
+  // the text of party 0 and the pattern of party 1
+  auto [text_promise, text_wires_0] = this->make_arithmetic_T_input_gate_my(0, 0, text_size);
+  auto text_wires_1 = this->make_arithmetic_T_input_gate_other(1, 0, text_size);
+  auto pattern_wires_0 = this->make_arithmetic_T_input_gate_other(0, 1, window_size);
+  auto [pattern_promise, pattern_wires_1] =
+      this->make_arithmetic_T_input_gate_my(1, 1, window_size);
+
+  auto wires_out_0 =
+      this->beavy_providers_[0]->make_window_distance_gate(text_wires_0, pattern_wires_0);
+  auto wires_out_1 =
+      this->beavy_providers_[1]->make_window_distance_gate(text_wires_1, pattern_wires_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  text_promise.set_value(text);
+  pattern_promise.set_value(pattern);
   this->run_gates_online();
 
   // check wire values
@@ -1039,45 +2456,56 @@ TYPED_TEST(ArithmeticBEAVYTest, ConstantMUL) {
   const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
   wire_0->wait_online();
   wire_1->wait_online();
-  const auto& pshare_0 = wire_0->get_public_share();
-  const auto& pshare_1 = wire_1->get_public_share();
-  const auto& sshare_0 = wire_0->get_secret_share();
-  const auto& sshare_1 = wire_1->get_secret_share();
-  ASSERT_EQ(pshare_0.size(), num_simd);
-  ASSERT_EQ(pshare_1.size(), num_simd);
-  ASSERT_EQ(sshare_0.size(), num_simd);
-  ASSERT_EQ(sshare_1.size(), num_simd);
-  ASSERT_EQ(pshare_0, pshare_1);
-  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
-    ASSERT_EQ(expected_output.at(simd_j),
-              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  EXPECT_TRUE(wire_0->is_additively_shared());
+  // the output consists of additive shares in the public share
+  const auto& share_0 = wire_0->get_public_share();
+  const auto& share_1 = wire_1->get_public_share();
+  ASSERT_EQ(share_0.size(), num_windows);
+  ASSERT_EQ(share_1.size(), num_windows);
+  for (std::size_t window_s = 0; window_s < num_windows; ++window_s) {
+    ASSERT_EQ(expected_output.at(window_s), TypeParam(share_0.at(window_s) + share_1.at(window_s)));
   }
 }
 
-TYPED_TEST(ArithmeticBEAVYTest, SQR) {
+TYPED_TEST(ArithmeticBEAVYTest, WindowDistanceInvalidPattern) {
+  auto text_wires = this->make_arithmetic_T_input_gate_other(1, 0, 10);
+  auto pattern_wires = this->make_arithmetic_T_input_gate_other(1, 0, 11);
+  EXPECT_THROW(this->beavy_providers_[1]->make_window_distance_gate(text_wires, pattern_wires),
+               std::logic_error);
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, BitMUL) {
   std::size_t num_simd = 10;
-  const auto inputs = this->generate_inputs(num_simd);
-  std::vector<TypeParam> expected_output;
-  std::transform(std::begin(inputs), std::end(inputs), std::back_inserter(expected_output),
-                 [](auto x) { return x * x; });
+  const auto input_bit = ENCRYPTO::BitVector<>::Random(num_simd);
+  const auto input_int = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    expected_output.at(simd_j) = input_bit.Get(simd_j) ? input_int.at(simd_j) : TypeParam(0);
+  }
 
   // input of party 0
-  auto [input_promise, wires_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
-  auto wires_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+  auto [input_int_promise, wires_int_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_int_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
 
-  auto wires_out_0 =
-      this->beavy_providers_[0]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::SQR, wires_in_0);
-  auto wires_out_1 =
-      this->beavy_providers_[1]->make_unary_gate(ENCRYPTO::PrimitiveOperationType::SQR, wires_in_1);
+  // input of party 1
+  auto wires_bit_in_0 = this->beavy_providers_[0]->make_boolean_input_gate_other(1, 1, num_simd);
+  auto [input_bit_promise, wires_bit_in_1] =
+      this->beavy_providers_[1]->make_boolean_input_gate_my(1, 1, num_simd);
+
+  auto wires_0_out = this->beavy_providers_[0]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_bit_in_0, wires_int_in_0);
+  auto wires_1_out = this->beavy_providers_[1]->make_binary_gate(
+      ENCRYPTO::PrimitiveOperationType::MUL, wires_bit_in_1, wires_int_in_1);
 
   this->run_setup();
   this->run_gates_setup();
-  input_promise.set_value(inputs);
+  input_bit_promise.set_value({input_bit});
+  input_int_promise.set_value(input_int);
   this->run_gates_online();
 
   // check wire values
-  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_0.at(0));
-  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_out_1.at(0));
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_0_out.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_1_out.at(0));
   wire_0->wait_online();
   wire_1->wait_online();
   const auto& pshare_0 = wire_0->get_public_share();
@@ -1095,8 +2523,9 @@ TYPED_TEST(ArithmeticBEAVYTest, SQR) {
   }
 }
 
-TYPED_TEST(ArithmeticBEAVYTest, BitMUL) {
-  std::size_t num_simd = 10;
+// 64 lanes take the loops with a compile-time number of lanes, see with_num_lanes()
+TYPED_TEST(ArithmeticBEAVYTest, BitMULFixedLanes) {
+  std::size_t num_simd = 64;
   const auto input_bit = ENCRYPTO::BitVector<>::Random(num_simd);
   const auto input_int = this->generate_inputs(num_simd);
   std::vector<TypeParam> expected_output(num_simd);
@@ -1214,6 +2643,65 @@ TYPED_TEST(ArithmeticBEAVYTest, BooleanBitToArithmeticBEAVY) {
   }
 }
 
+TYPED_TEST(ArithmeticBEAVYTest, BooleanBitsToArithmeticBEAVY) {
+  std::size_t num_wires = 3;
+  std::size_t num_simd = 10;
+  std::vector<ENCRYPTO::BitVector<>> inputs;
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    inputs.push_back(ENCRYPTO::BitVector<>::Random(num_simd));
+  }
+
+  auto [input_promise, wires_in_0] =
+      this->beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_in_1 =
+      this->beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  const auto cast_wires = [](const auto& wires) {
+    BooleanBEAVYWireVector boolean_wires;
+    for (const auto& wire : wires) {
+      boolean_wires.push_back(std::dynamic_pointer_cast<BooleanBEAVYWire>(wire));
+    }
+    return boolean_wires;
+  };
+
+  auto wires_0 = this->beavy_providers_[0]
+                     ->template basic_make_convert_bits_to_arithmetic_beavy_gate<TypeParam>(
+                         cast_wires(wires_in_0));
+  auto wires_1 = this->beavy_providers_[1]
+                     ->template basic_make_convert_bits_to_arithmetic_beavy_gate<TypeParam>(
+                         cast_wires(wires_in_1));
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(inputs);
+  this->run_gates_online();
+
+  // check wire values
+  ASSERT_EQ(wires_0.size(), num_wires);
+  ASSERT_EQ(wires_1.size(), num_wires);
+  for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+    const auto wire_0 =
+        std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_0.at(wire_i));
+    const auto wire_1 =
+        std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_1.at(wire_i));
+    ASSERT_NE(wire_0, nullptr);
+    ASSERT_NE(wire_1, nullptr);
+    wire_0->wait_online();
+    wire_1->wait_online();
+    const auto& sshare_0 = wire_0->get_secret_share();
+    const auto& sshare_1 = wire_1->get_secret_share();
+    const auto& pshare_0 = wire_0->get_public_share();
+    const auto& pshare_1 = wire_1->get_public_share();
+    ASSERT_EQ(sshare_0.size(), num_simd);
+    ASSERT_EQ(sshare_1.size(), num_simd);
+    ASSERT_EQ(pshare_0.size(), num_simd);
+    ASSERT_EQ(pshare_0, pshare_1);
+    for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+      ASSERT_EQ(TypeParam(inputs.at(wire_i).Get(simd_j)),
+                TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+    }
+  }
+}
+
 TYPED_TEST(ArithmeticBEAVYTest, BooleanToArithmeticBEAVY) {
   std::size_t num_wires = ENCRYPTO::bit_size_v<TypeParam>;
   std::size_t num_simd = 1;
@@ -1258,6 +2746,62 @@ TYPED_TEST(ArithmeticBEAVYTest, BooleanToArithmeticBEAVY) {
   }
 }
 
+TYPED_TEST(ArithmeticBEAVYTest, GTAndEQ) {
+  std::size_t num_wires = ENCRYPTO::bit_size_v<TypeParam>;
+  std::size_t num_simd = 16;
+  auto inputs_a = this->generate_inputs(num_simd);
+  auto inputs_b = this->generate_inputs(num_simd);
+  // some equal values and values which differ in a single bit
+  for (std::size_t simd_j = 0; simd_j < 4; ++simd_j) {
+    inputs_b.at(simd_j) = inputs_a.at(simd_j);
+    inputs_b.at(simd_j + 4) = inputs_a.at(simd_j + 4) ^ (TypeParam(1) << (simd_j * 2));
+  }
+
+  auto [input_a_promise, wires_0_in_a] =
+      this->beavy_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+  auto wires_1_in_a =
+      this->beavy_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+  auto wires_0_in_b =
+      this->beavy_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+  auto [input_b_promise, wires_1_in_b] =
+      this->beavy_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+  std::array<MOTION::WireVector, 2> gt_out = {
+      this->beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::GT,
+                                                  wires_0_in_a, wires_0_in_b),
+      this->beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::GT,
+                                                  wires_1_in_a, wires_1_in_b)};
+  std::array<MOTION::WireVector, 2> eq_out = {
+      this->beavy_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQ,
+                                                  wires_0_in_a, wires_0_in_b),
+      this->beavy_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::EQ,
+                                                  wires_1_in_a, wires_1_in_b)};
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_a_promise.set_value(int_to_bit_vectors(inputs_a));
+  input_b_promise.set_value(int_to_bit_vectors(inputs_b));
+  this->run_gates_online();
+
+  const auto get_value = [](const auto& wires) {
+    EXPECT_EQ(wires[0].size(), 1);
+    EXPECT_EQ(wires[1].size(), 1);
+    const auto wire_0 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires[0].at(0));
+    const auto wire_1 = std::dynamic_pointer_cast<BooleanBEAVYWire>(wires[1].at(0));
+    wire_0->wait_online();
+    wire_1->wait_online();
+    EXPECT_EQ(wire_0->get_public_share(), wire_1->get_public_share());
+    return wire_0->get_public_share() ^ wire_0->get_secret_share() ^ wire_1->get_secret_share();
+  };
+  const auto gt = get_value(gt_out);
+  const auto eq = get_value(eq_out);
+  ASSERT_EQ(gt.GetSize(), num_simd);
+  ASSERT_EQ(eq.GetSize(), num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    EXPECT_EQ(gt.Get(simd_j), inputs_a.at(simd_j) > inputs_b.at(simd_j));
+    EXPECT_EQ(eq.Get(simd_j), inputs_a.at(simd_j) == inputs_b.at(simd_j));
+  }
+}
+
 TYPED_TEST(ArithmeticBEAVYTest, ArithmeticBEAVYToGMW) {
   std::size_t num_wires = ENCRYPTO::bit_size_v<TypeParam>;
   std::size_t num_simd = 1;
@@ -1330,9 +2874,218 @@ TYPED_TEST(ArithmeticBEAVYTest, ArithmeticBEAVYFromGMW) {
   ASSERT_EQ(sshare_0.size(), num_simd);
   ASSERT_EQ(sshare_1.size(), num_simd);
   ASSERT_EQ(pshare_0.size(), num_simd);
-  ASSERT_EQ(pshare_0, pshare_1);
+  ASSERT_EQ(pshare_1.size(), num_simd);
+  // the GMW shares are reinterpreted as additive shares without communication
+  ASSERT_TRUE(wire_0->is_additively_shared());
+  ASSERT_TRUE(wire_1->is_additively_shared());
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j), TypeParam(pshare_0.at(simd_j) + pshare_1.at(simd_j)));
+  }
+}
+
+TYPED_TEST(ArithmeticBEAVYTest, ArithmeticBEAVYFromGMWReconstructed) {
+  std::size_t num_simd = 10;
+  const auto inputs = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output(num_simd);
+  std::transform(std::begin(inputs), std::end(inputs), std::begin(expected_output),
+                 [](auto x) { return TypeParam(x * x); });
+
+  auto [input_promise, wires_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_simd);
+  auto wires_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_simd);
+
+  // BEAVY -> GMW -> BEAVY -> GMW is local, only the SQR gate needs the masked value
+  std::array<WireVector, 2> wires_gmw;
+  std::array<WireVector, 2> wires_sqr;
+  std::array<WireVector, 2> wires_in = {wires_in_0, wires_in_1};
+  for (std::size_t party_i = 0; party_i < 2; ++party_i) {
+    auto& provider = *this->beavy_providers_[party_i];
+    auto wires_tmp = provider.convert(MOTION::MPCProtocol::ArithmeticGMW, wires_in[party_i]);
+    auto wires_beavy = provider.convert(MOTION::MPCProtocol::ArithmeticBEAVY, wires_tmp);
+    wires_gmw[party_i] = provider.convert(MOTION::MPCProtocol::ArithmeticGMW, wires_beavy);
+    wires_sqr[party_i] =
+        provider.make_unary_gate(ENCRYPTO::PrimitiveOperationType::SQR, wires_beavy);
+  }
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(inputs);
+  this->run_gates_online();
+
+  std::array<std::vector<TypeParam>, 2> gmw_shares;
+  std::array<std::shared_ptr<ArithmeticBEAVYWire<TypeParam>>, 2> sqr_wires;
+  for (std::size_t party_i = 0; party_i < 2; ++party_i) {
+    ASSERT_EQ(wires_gmw[party_i].size(), 1);
+    ASSERT_EQ(wires_sqr[party_i].size(), 1);
+    auto gmw_wire =
+        std::dynamic_pointer_cast<gmw::ArithmeticGMWWire<TypeParam>>(wires_gmw[party_i].at(0));
+    sqr_wires[party_i] =
+        std::dynamic_pointer_cast<ArithmeticBEAVYWire<TypeParam>>(wires_sqr[party_i].at(0));
+    ASSERT_NE(gmw_wire, nullptr);
+    ASSERT_NE(sqr_wires[party_i], nullptr);
+    gmw_wire->wait_online();
+    sqr_wires[party_i]->wait_online();
+    gmw_shares[party_i] = gmw_wire->get_share();
+    ASSERT_EQ(gmw_shares[party_i].size(), num_simd);
+  }
+  ASSERT_FALSE(sqr_wires[0]->is_additively_shared());
+  const auto& pshare = sqr_wires[0]->get_public_share();
+  ASSERT_EQ(pshare, sqr_wires[1]->get_public_share());
+  const auto& sshare_0 = sqr_wires[0]->get_secret_share();
+  const auto& sshare_1 = sqr_wires[1]->get_secret_share();
   for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(inputs.at(simd_j),
+              TypeParam(gmw_shares[0].at(simd_j) + gmw_shares[1].at(simd_j)));
     ASSERT_EQ(expected_output.at(simd_j),
-              TypeParam(pshare_0.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+              TypeParam(pshare.at(simd_j) - sshare_0.at(simd_j) - sshare_1.at(simd_j)));
+  }
+}
+
+// inputs and outputs of more than two parties with both reconstruction patterns
+class MultiPartyBEAVYTest : public ::testing::TestWithParam<ReconstructionPattern> {
+ protected:
+  static constexpr std::size_t num_parties_ = 3;
+
+  void SetUp() override {
+    comm_layers_ = MOTION::Communication::make_dummy_communication_layers(num_parties_);
+    for (std::size_t i = 0; i < num_parties_; ++i) {
+      loggers_[i] = std::make_shared<MOTION::Logger>(i, boost::log::trivial::severity_level::trace);
+      comm_layers_[i]->set_logger(loggers_[i]);
+      base_ot_providers_[i] =
+          std::make_unique<MOTION::BaseOTProvider>(*comm_layers_[i], nullptr, loggers_[i]);
+      motion_base_providers_[i] =
+          std::make_unique<MOTION::Crypto::MotionBaseProvider>(*comm_layers_[i], loggers_[i]);
+      ot_provider_managers_[i] = std::make_unique<ENCRYPTO::ObliviousTransfer::OTProviderManager>(
+          *comm_layers_[i], *base_ot_providers_[i], *motion_base_providers_[i], nullptr,
+          loggers_[i]);
+      arithmetic_provider_managers_[i] = std::make_unique<MOTION::ArithmeticProviderManager>(
+          *comm_layers_[i], *ot_provider_managers_[i], loggers_[i]);
+      gate_registers_[i] = std::make_unique<MOTION::GateRegister>();
+      beavy_providers_[i] = std::make_unique<BEAVYProvider>(
+          *comm_layers_[i], *gate_registers_[i], circuit_loader_, *motion_base_providers_[i],
+          *ot_provider_managers_[i], *arithmetic_provider_managers_[i], loggers_[i]);
+      beavy_providers_[i]->set_reconstruction_pattern(GetParam());
+    }
+  }
+
+  void TearDown() override {
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < num_parties_; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [this, i] { comm_layers_[i]->shutdown(); }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  }
+
+  // the input and output gates do not need OTs
+  void run() {
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < num_parties_; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [this, i] {
+        comm_layers_[i]->start();
+        motion_base_providers_[i]->setup();
+        beavy_providers_[i]->setup();
+        for (auto& gate : gate_registers_[i]->get_gates()) {
+          if (gate->need_setup()) {
+            gate->evaluate_setup();
+          }
+        }
+        for (auto& gate : gate_registers_[i]->get_gates()) {
+          if (gate->need_online()) {
+            gate->evaluate_online();
+          }
+        }
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  }
+
+  // bytes sent by all parties for the outputs
+  std::size_t get_output_setup_bytes() const {
+    std::size_t num_bytes = 0;
+    for (std::size_t i = 0; i < num_parties_; ++i) {
+      for (const auto& gate : gate_registers_[i]->get_gates()) {
+        if (dynamic_cast<const BooleanBEAVYOutputGate*>(gate.get()) != nullptr ||
+            dynamic_cast<const ArithmeticBEAVYOutputGate<std::uint32_t>*>(gate.get()) != nullptr) {
+          num_bytes += gate->get_cost()->setup_bytes_;
+        }
+      }
+    }
+    return num_bytes;
+  }
+
+  MOTION::CircuitLoader circuit_loader_;
+  std::vector<std::unique_ptr<MOTION::Communication::CommunicationLayer>> comm_layers_;
+  std::array<std::unique_ptr<MOTION::BaseOTProvider>, num_parties_> base_ot_providers_;
+  std::array<std::unique_ptr<MOTION::Crypto::MotionBaseProvider>, num_parties_>
+      motion_base_providers_;
+  std::array<std::unique_ptr<ENCRYPTO::ObliviousTransfer::OTProviderManager>, num_parties_>
+      ot_provider_managers_;
+  std::array<std::unique_ptr<MOTION::ArithmeticProviderManager>, num_parties_>
+      arithmetic_provider_managers_;
+  std::array<std::unique_ptr<MOTION::GateRegister>, num_parties_> gate_registers_;
+  std::array<std::unique_ptr<BEAVYProvider>, num_parties_> beavy_providers_;
+  std::array<std::shared_ptr<MOTION::Logger>, num_parties_> loggers_;
+};
+
+TEST_P(MultiPartyBEAVYTest, OutputAll) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  std::array<std::vector<ENCRYPTO::BitVector<>>, num_parties_> boolean_inputs;
+  std::array<std::vector<std::uint32_t>, num_parties_> arithmetic_inputs;
+  std::array<std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<ENCRYPTO::BitVector<>>>>,
+             num_parties_>
+      boolean_output_futures;
+  std::array<std::vector<ENCRYPTO::ReusableFiberFuture<std::vector<std::uint32_t>>>,
+             num_parties_>
+      arithmetic_output_futures;
+
+  // each party has a Boolean and an arithmetic input which is output to all parties
+  for (std::size_t owner = 0; owner < num_parties_; ++owner) {
+    boolean_inputs[owner] = BooleanBEAVYTest::generate_inputs(num_wires, num_simd);
+    arithmetic_inputs[owner] = MOTION::Helpers::RandomVector<std::uint32_t>(num_simd);
+    for (std::size_t i = 0; i < num_parties_; ++i) {
+      MOTION::WireVector boolean_wires;
+      MOTION::WireVector arithmetic_wires;
+      if (i == owner) {
+        auto [boolean_promise, b_wires] =
+            beavy_providers_[i]->make_boolean_input_gate_my(owner, num_wires, num_simd);
+        boolean_promise.set_value(boolean_inputs[owner]);
+        boolean_wires = std::move(b_wires);
+        auto [arithmetic_promise, a_wires] =
+            beavy_providers_[i]->make_arithmetic_32_input_gate_my(owner, num_simd);
+        arithmetic_promise.set_value(arithmetic_inputs[owner]);
+        arithmetic_wires = std::move(a_wires);
+      } else {
+        boolean_wires =
+            beavy_providers_[i]->make_boolean_input_gate_other(owner, num_wires, num_simd);
+        arithmetic_wires = beavy_providers_[i]->make_arithmetic_32_input_gate_other(owner, num_simd);
+      }
+      boolean_output_futures[i].push_back(
+          beavy_providers_[i]->make_boolean_output_gate_my(MOTION::ALL_PARTIES, boolean_wires));
+      arithmetic_output_futures[i].push_back(
+          beavy_providers_[i]->make_arithmetic_32_output_gate_my(MOTION::ALL_PARTIES,
+                                                                 arithmetic_wires));
+    }
+  }
+
+  run();
+
+  for (std::size_t i = 0; i < num_parties_; ++i) {
+    for (std::size_t owner = 0; owner < num_parties_; ++owner) {
+      EXPECT_EQ(boolean_output_futures[i][owner].get(), boolean_inputs[owner]);
+      EXPECT_EQ(arithmetic_output_futures[i][owner].get(), arithmetic_inputs[owner]);
+    }
   }
+
+  // each opened value costs N(N-1) messages with broadcast and 2(N-1) with a king
+  const std::size_t bytes_per_output =
+      MOTION::Helpers::Convert::BitsToBytes(num_wires * num_simd) +
+      num_simd * sizeof(std::uint32_t);
+  const std::size_t num_messages = GetParam() == ReconstructionPattern::king
+                                       ? 2 * (num_parties_ - 1)
+                                       : num_parties_ * (num_parties_ - 1);
+  EXPECT_EQ(get_output_setup_bytes(), num_parties_ * num_messages * bytes_per_output);
 }
+
+INSTANTIATE_TEST_SUITE_P(ReconstructionPatterns, MultiPartyBEAVYTest,
+                         ::testing::Values(ReconstructionPattern::broadcast,
+                                           ReconstructionPattern::king));
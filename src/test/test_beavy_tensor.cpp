@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <array>
 #include <iterator>
 #include <memory>
@@ -33,10 +34,12 @@
 #include "crypto/base_ots/base_ot_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "executor/tensor_op_executor.h"
 #include "gate/new_gate.h"
 #include "protocols/beavy/beavy_provider.h"
 #include "protocols/beavy/tensor.h"
 #include "statistics/run_time_stats.h"
+#include "utility/fixed_point.h"
 #include "utility/helpers.h"
 #include "utility/linear_algebra.h"
 #include "utility/logger.h"
@@ -150,23 +153,25 @@ class ArithmeticBEAVYTensorTest : public BEAVYTensorTest {
   }
   std::pair<ENCRYPTO::ReusableFiberPromise<MOTION::IntegerValues<T>>, MOTION::tensor::TensorCP>
   make_arithmetic_T_tensor_input_my(std::size_t party_id,
-                                    const MOTION::tensor::TensorDimensions& dims) {
+                                    const MOTION::tensor::TensorDimensions& dims,
+                                    std::size_t fractional_bits = 0) {
     auto& bp = *beavy_providers_.at(party_id);
     if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return bp.make_arithmetic_64_tensor_input_my(dims);
+      return bp.make_arithmetic_64_tensor_input_my(dims, fractional_bits);
     } else {
       static_assert(ENCRYPTO::bit_size_v<T> == 32);
-      return bp.make_arithmetic_32_tensor_input_my(dims);
+      return bp.make_arithmetic_32_tensor_input_my(dims, fractional_bits);
     }
   }
   MOTION::tensor::TensorCP make_arithmetic_T_tensor_input_other(
-      std::size_t party_id, const MOTION::tensor::TensorDimensions& dims) {
+      std::size_t party_id, const MOTION::tensor::TensorDimensions& dims,
+      std::size_t fractional_bits = 0) {
     auto& bp = *beavy_providers_.at(party_id);
     if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return bp.make_arithmetic_64_tensor_input_other(dims);
+      return bp.make_arithmetic_64_tensor_input_other(dims, fractional_bits);
     } else {
       static_assert(ENCRYPTO::bit_size_v<T> == 32);
-      return bp.make_arithmetic_32_tensor_input_other(dims);
+      return bp.make_arithmetic_32_tensor_input_other(dims, fractional_bits);
     }
   }
   ENCRYPTO::ReusableFiberFuture<MOTION::IntegerValues<T>> make_arithmetic_T_tensor_output_my(
@@ -419,6 +424,222 @@ TYPED_TEST(ArithmeticBEAVYTensorTest, Gemm) {
   ASSERT_EQ(plain_output, expected_output);
 }
 
+TYPED_TEST(ArithmeticBEAVYTensorTest, GemmSqr) {
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {2, 100}, .input_B_shape_ = {100, 10}, .output_shape_ = {2, 10}};
+  ASSERT_TRUE(gemm_op.verify());
+  const auto input_A_dims = gemm_op.get_input_A_tensor_dims();
+  const auto input_B_dims = gemm_op.get_input_B_tensor_dims();
+  const auto output_dims = gemm_op.get_output_tensor_dims();
+  const auto input_A = this->generate_inputs(input_A_dims);
+  const auto input_B = this->generate_inputs(input_B_dims);
+
+  auto [input_A_promise, tensor_input_A_0] =
+      this->make_arithmetic_T_tensor_input_my(0, input_A_dims);
+  auto tensor_input_A_1 = this->make_arithmetic_T_tensor_input_other(1, input_A_dims);
+  auto tensor_input_B_0 = this->make_arithmetic_T_tensor_input_other(0, input_B_dims);
+  auto [input_B_promise, tensor_input_B_1] =
+      this->make_arithmetic_T_tensor_input_my(1, input_B_dims);
+
+  auto tensor_output_0 = this->beavy_providers_[0]->make_tensor_gemm_sqr_op(
+      gemm_op, tensor_input_A_0, tensor_input_B_0);
+  auto tensor_output_1 = this->beavy_providers_[1]->make_tensor_gemm_sqr_op(
+      gemm_op, tensor_input_A_1, tensor_input_B_1);
+
+  ASSERT_EQ(tensor_output_0->get_dimensions(), output_dims);
+  ASSERT_EQ(tensor_output_1->get_dimensions(), output_dims);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_A_promise.set_value(input_A);
+  input_B_promise.set_value(input_B);
+  this->run_gates_online();
+
+  const auto output_beavy_tensor_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_output_0);
+  const auto output_beavy_tensor_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_output_1);
+
+  const auto& public_output_share_0 = output_beavy_tensor_0->get_public_share();
+  const auto& public_output_share_1 = output_beavy_tensor_1->get_public_share();
+  const auto& secret_output_share_0 = output_beavy_tensor_0->get_secret_share();
+  const auto& secret_output_share_1 = output_beavy_tensor_1->get_secret_share();
+
+  ASSERT_EQ(public_output_share_0.size(), output_dims.get_data_size());
+  ASSERT_EQ(public_output_share_1.size(), output_dims.get_data_size());
+  ASSERT_EQ(public_output_share_0, public_output_share_1);
+
+  const auto product =
+      MOTION::matrix_multiply(gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
+                              gemm_op.input_B_shape_[1], input_A, input_B);
+  const auto expected_output = MOTION::Helpers::MultiplyVectors(product, product);
+  const auto plain_output = MOTION::Helpers::SubVectors(
+      public_output_share_0,
+      MOTION::Helpers::AddVectors(secret_output_share_0, secret_output_share_1));
+
+  ASSERT_EQ(plain_output, expected_output);
+}
+
+TYPED_TEST(ArithmeticBEAVYTensorTest, SparseGemm) {
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {3, 100}, .input_B_shape_ = {100, 10}, .output_shape_ = {3, 10}};
+  ASSERT_TRUE(gemm_op.verify());
+  const auto input_A_dims = gemm_op.get_input_A_tensor_dims();
+  const auto output_dims = gemm_op.get_output_tensor_dims();
+  const auto input_A = this->generate_inputs(input_A_dims);
+  // party 1 holds the weights of which about every fifth is nonzero
+  auto weights = this->generate_inputs(gemm_op.get_input_B_tensor_dims());
+  for (std::size_t i = 0; i < weights.size(); ++i) {
+    if (i % 5 != 0) {
+      weights[i] = 0;
+    }
+  }
+  const auto sparse_weights_T = MOTION::CSRMatrix<TypeParam>::from_dense(100, 10, weights.data());
+  MOTION::CSRMatrix<std::uint64_t> sparse_weights{.rows_ = sparse_weights_T.rows_,
+                                                  .cols_ = sparse_weights_T.cols_,
+                                                  .row_ptr_ = sparse_weights_T.row_ptr_,
+                                                  .col_idx_ = sparse_weights_T.col_idx_,
+                                                  .values_ = {}};
+  auto weights_pattern = sparse_weights;
+  sparse_weights.values_.assign(std::begin(sparse_weights_T.values_),
+                                std::end(sparse_weights_T.values_));
+
+  auto [input_A_promise, tensor_input_A_0] =
+      this->make_arithmetic_T_tensor_input_my(0, input_A_dims);
+  auto tensor_input_A_1 = this->make_arithmetic_T_tensor_input_other(1, input_A_dims);
+
+  auto tensor_output_0 = this->beavy_providers_[0]->make_tensor_sparse_gemm_op(
+      gemm_op, tensor_input_A_0, weights_pattern, 1, 0);
+  auto tensor_output_1 = this->beavy_providers_[1]->make_tensor_sparse_gemm_op(
+      gemm_op, tensor_input_A_1, sparse_weights, 1, 0);
+
+  ASSERT_EQ(tensor_output_0->get_dimensions(), output_dims);
+  ASSERT_EQ(tensor_output_1->get_dimensions(), output_dims);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_A_promise.set_value(input_A);
+  this->run_gates_online();
+
+  const auto output_beavy_tensor_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_output_0);
+  const auto output_beavy_tensor_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_output_1);
+
+  const auto& public_output_share_0 = output_beavy_tensor_0->get_public_share();
+  const auto& public_output_share_1 = output_beavy_tensor_1->get_public_share();
+  const auto& secret_output_share_0 = output_beavy_tensor_0->get_secret_share();
+  const auto& secret_output_share_1 = output_beavy_tensor_1->get_secret_share();
+
+  ASSERT_EQ(public_output_share_0.size(), output_dims.get_data_size());
+  ASSERT_EQ(public_output_share_0, public_output_share_1);
+
+  const auto expected_output =
+      MOTION::matrix_multiply(gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
+                              gemm_op.input_B_shape_[1], input_A, weights);
+  const auto plain_output = MOTION::Helpers::SubVectors(
+      public_output_share_0,
+      MOTION::Helpers::AddVectors(secret_output_share_0, secret_output_share_1));
+
+  ASSERT_EQ(plain_output, expected_output);
+}
+
+TYPED_TEST(ArithmeticBEAVYTensorTest, Flatten) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 3, .height_ = 4, .width_ = 5};
+  const auto input = this->generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto tensor_out_0 = this->beavy_providers_[0]->make_tensor_flatten_op(tensor_in_0, 1);
+  auto tensor_out_1 = this->beavy_providers_[1]->make_tensor_flatten_op(tensor_in_1, 1);
+
+  const MOTION::tensor::TensorDimensions expected_dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 1, .width_ = dims.get_data_size()};
+  ASSERT_EQ(tensor_out_0->get_dimensions(), expected_dims);
+  ASSERT_EQ(tensor_out_1->get_dimensions(), expected_dims);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto tensor_input_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_in_0);
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_out_1);
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  // the output is a view of the input shares
+  EXPECT_EQ(tensor_output_0->get_public_share().data(),
+            tensor_input_0->get_public_share().data());
+  EXPECT_EQ(tensor_output_0->get_secret_share().data(),
+            tensor_input_0->get_secret_share().data());
+
+  const auto plain_output = MOTION::Helpers::SubVectors(
+      tensor_output_0->get_public_share(),
+      MOTION::Helpers::AddVectors(tensor_output_0->get_secret_share(),
+                                  tensor_output_1->get_secret_share()));
+  ASSERT_EQ(plain_output, input);
+}
+
+TYPED_TEST(ArithmeticBEAVYTensorTest, MemoryPlanning) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 3, .height_ = 4, .width_ = 5};
+  const auto input_a = this->generate_inputs(dims);
+  const auto input_b = this->generate_inputs(dims);
+
+  auto [input_a_promise, tensor_a_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto [input_b_promise, tensor_b_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_a_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+  auto tensor_b_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+  // b is kept by both parties although it is dead after the flatten op
+  tensor_b_in_0->set_persistent();
+  tensor_b_in_1->set_persistent();
+
+  auto tensor_a_out_0 = this->beavy_providers_[0]->make_tensor_flatten_op(tensor_a_in_0, 1);
+  auto tensor_a_out_1 = this->beavy_providers_[1]->make_tensor_flatten_op(tensor_a_in_1, 1);
+  auto tensor_b_out_0 = this->beavy_providers_[0]->make_tensor_flatten_op(tensor_b_in_0, 1);
+  auto tensor_b_out_1 = this->beavy_providers_[1]->make_tensor_flatten_op(tensor_b_in_1, 1);
+  this->beavy_providers_[0]->make_arithmetic_tensor_output_other(tensor_a_out_0);
+  this->beavy_providers_[0]->make_arithmetic_tensor_output_other(tensor_b_out_0);
+  auto output_a_future = this->make_arithmetic_T_tensor_output_my(1, tensor_a_out_1);
+  auto output_b_future = this->make_arithmetic_T_tensor_output_my(1, tensor_b_out_1);
+
+  this->run_setup();
+  input_a_promise.set_value(input_a);
+  input_b_promise.set_value(input_b);
+  std::vector<std::future<void>> futs;
+  for (std::size_t i = 0; i < 2; ++i) {
+    futs.emplace_back(std::async(std::launch::async, [this, i] {
+      MOTION::TensorOpExecutor executor(*this->gate_registers_[i], [] {}, 1, nullptr);
+      executor.set_memory_planning(true);
+      executor.evaluate_setup_online(this->stats_[i]);
+    }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  EXPECT_EQ(output_a_future.get(), input_a);
+  EXPECT_EQ(output_b_future.get(), input_b);
+
+  for (const auto& [tensor, is_kept] :
+       {std::pair{tensor_a_in_0, false}, std::pair{tensor_a_out_0, false},
+        std::pair{tensor_b_in_0, true}, std::pair{tensor_b_out_0, false}}) {
+    const auto beavy_tensor =
+        std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor);
+    ASSERT_NE(beavy_tensor, nullptr);
+    const auto expected_size = is_kept ? dims.get_data_size() : 0;
+    EXPECT_EQ(beavy_tensor->get_public_share().size(), expected_size);
+    EXPECT_EQ(beavy_tensor->get_secret_share().size(), expected_size);
+  }
+}
+
 TYPED_TEST(ArithmeticBEAVYTensorTest, Sqr) {
   MOTION::tensor::TensorDimensions dims = {
       .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
@@ -466,3 +687,100 @@ TYPED_TEST(ArithmeticBEAVYTensorTest, Sqr) {
       MOTION::Helpers::AddVectors(secret_output_share_0, secret_output_share_1));
   ASSERT_EQ(plain_output, expected_output);
 }
+
+TYPED_TEST(ArithmeticBEAVYTensorTest, Truncation) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 4, .width_ = 4};
+  constexpr std::size_t fractional_bits = 8;
+  constexpr std::size_t truncate_bits = 4;
+  // small positive and negative values s.t. the probabilistic truncation does not fail
+  auto input = this->generate_inputs(dims);
+  std::transform(std::begin(input), std::end(input), std::begin(input),
+                 [](auto x) { return TypeParam(x % 4096) - TypeParam(2048); });
+
+  auto [input_promise, tensor_in_0] =
+      this->make_arithmetic_T_tensor_input_my(0, dims, fractional_bits);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims, fractional_bits);
+
+  auto tensor_out_0 =
+      this->beavy_providers_[0]->make_tensor_truncation_op(tensor_in_0, truncate_bits);
+  auto tensor_out_1 =
+      this->beavy_providers_[1]->make_tensor_truncation_op(tensor_in_1, truncate_bits);
+
+  ASSERT_EQ(tensor_out_0->get_dimensions(), dims);
+  ASSERT_EQ(tensor_out_1->get_dimensions(), dims);
+  ASSERT_EQ(tensor_out_0->get_fractional_bits(), fractional_bits - truncate_bits);
+  ASSERT_EQ(tensor_out_1->get_fractional_bits(), fractional_bits - truncate_bits);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(tensor_out_1);
+
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  const auto& public_output_share_0 = tensor_output_0->get_public_share();
+  const auto& public_output_share_1 = tensor_output_1->get_public_share();
+  ASSERT_EQ(public_output_share_0, public_output_share_1);
+
+  const auto plain_output = MOTION::Helpers::SubVectors(
+      public_output_share_0, MOTION::Helpers::AddVectors(tensor_output_0->get_secret_share(),
+                                                         tensor_output_1->get_secret_share()));
+  ASSERT_EQ(plain_output.size(), input.size());
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    // the result may be off by one in the last place
+    const TypeParam diff = plain_output[i] - MOTION::fixed_point::truncate(input[i], truncate_bits);
+    EXPECT_TRUE(diff == 0 || diff == 1 || diff == TypeParam(-1));
+  }
+}
+
+using ArithmeticBEAVYTensor64Test = ArithmeticBEAVYTensorTest<std::uint64_t>;
+
+TEST_F(ArithmeticBEAVYTensor64Test, RingReduction) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = make_arithmetic_T_tensor_input_my(0, dims, 16);
+  auto tensor_in_1 = make_arithmetic_T_tensor_input_other(1, dims, 16);
+
+  auto tensor_out_0 = beavy_providers_[0]->make_tensor_ring_reduction(tensor_in_0, 32);
+  auto tensor_out_1 = beavy_providers_[1]->make_tensor_ring_reduction(tensor_in_1, 32);
+
+  ASSERT_EQ(tensor_out_0->get_bit_size(), 32);
+  ASSERT_EQ(tensor_out_0->get_fractional_bits(), 16);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(input);
+  run_gates_online();
+
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<std::uint32_t>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<std::uint32_t>>(tensor_out_1);
+
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  const auto plain_output = MOTION::Helpers::SubVectors(
+      tensor_output_0->get_public_share(),
+      MOTION::Helpers::AddVectors(tensor_output_0->get_secret_share(),
+                                  tensor_output_1->get_secret_share()));
+  ASSERT_EQ(plain_output.size(), input.size());
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(plain_output[i], std::uint32_t(input[i]));
+  }
+}
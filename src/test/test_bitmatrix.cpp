@@ -22,10 +22,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <random>
 
 #include <gtest/gtest.h>
 
+#include "crypto/pseudo_random_generator.h"
 #include "utility/bit_matrix.h"
 
 #include "test_constants.h"
@@ -166,4 +168,125 @@ TEST(BitMatrix, Transpose128InPlaceOnRawPointersBitSlicing) {
     }
   }
 }  // namespace
+
+// all kernels need to compute the same outputs, since the parties may use different ones
+TEST(BitMatrix, TransposeAndEncryptKernels) {
+  using Kernel = ENCRYPTO::BitMatrix::TransposeKernel;
+  std::mt19937_64 gen(std::random_device{}());
+  std::array<std::uint8_t, 16> key;
+  std::generate(std::begin(key), std::end(key), gen);
+  ENCRYPTO::PRG prg_fixed_key;
+  prg_fixed_key.SetKey(key.data());
+
+  for (std::size_t ncols : {128, 640, 1152}) {
+    // the number of OTs is padded to the next multiple of 128
+    for (std::size_t num_ots : {ncols, ncols - 3, ncols - 127}) {
+      std::vector<ENCRYPTO::AlignedBitVector> rows(128);
+      std::array<const std::byte *, 128> ptrs;
+      for (auto j = 0ull; j < ptrs.size(); ++j) {
+        rows.at(j) = ENCRYPTO::AlignedBitVector::Random(ncols);
+        ptrs.at(j) = rows.at(j).GetData().data();
+      }
+      // mix short OTs and string OTs
+      std::vector<std::size_t> bitlengths(ncols);
+      std::generate(std::begin(bitlengths), std::end(bitlengths), [&gen] { return gen() % 300; });
+      const auto choices = ENCRYPTO::BitVector<>::Random(128);
+
+      std::vector<ENCRYPTO::BitVector<>> y0_sse(num_ots), y1_sse(num_ots), out_sse(num_ots);
+      ENCRYPTO::BitMatrix::SenderTransposeAndEncrypt(ptrs, y0_sse, y1_sse, choices, prg_fixed_key,
+                                                     ncols, bitlengths, Kernel::sse);
+      ENCRYPTO::BitMatrix::ReceiverTransposeAndEncrypt(ptrs, out_sse, prg_fixed_key, ncols,
+                                                       bitlengths, Kernel::sse);
+
+      for (auto kernel : {Kernel::avx2, Kernel::avx512}) {
+        if (!ENCRYPTO::BitMatrix::IsTransposeKernelSupported(kernel)) {
+          continue;
+        }
+        std::vector<ENCRYPTO::BitVector<>> y0(num_ots), y1(num_ots), out(num_ots);
+        ENCRYPTO::BitMatrix::SenderTransposeAndEncrypt(ptrs, y0, y1, choices, prg_fixed_key,
+                                                       ncols, bitlengths, kernel);
+        ENCRYPTO::BitMatrix::ReceiverTransposeAndEncrypt(ptrs, out, prg_fixed_key, ncols,
+                                                         bitlengths, kernel);
+        EXPECT_EQ(y0, y0_sse);
+        EXPECT_EQ(y1, y1_sse);
+        EXPECT_EQ(out, out_sse);
+      }
+    }
+  }
+}
+
+// processing the columns in independent ranges needs to give the same outputs as one pass
+TEST(BitMatrix, TransposeAndEncryptRanges) {
+  std::mt19937_64 gen(std::random_device{}());
+  std::array<std::uint8_t, 16> key;
+  std::generate(std::begin(key), std::end(key), gen);
+  ENCRYPTO::PRG prg_fixed_key;
+  prg_fixed_key.SetKey(key.data());
+
+  constexpr std::size_t ncols = 5 * 128, num_ots = ncols - 100, range_size = 256;
+  std::vector<ENCRYPTO::AlignedBitVector> rows(128);
+  std::array<const std::byte *, 128> ptrs;
+  for (auto j = 0ull; j < ptrs.size(); ++j) {
+    rows.at(j) = ENCRYPTO::AlignedBitVector::Random(ncols);
+    ptrs.at(j) = rows.at(j).GetData().data();
+  }
+  std::vector<std::size_t> bitlengths(ncols);
+  std::generate(std::begin(bitlengths), std::end(bitlengths), [&gen] { return gen() % 300; });
+  const auto choices = ENCRYPTO::BitVector<>::Random(128);
+
+  std::vector<ENCRYPTO::BitVector<>> y0_expected(num_ots), y1_expected(num_ots),
+      out_expected(num_ots);
+  ENCRYPTO::BitMatrix::SenderTransposeAndEncrypt(ptrs, y0_expected, y1_expected, choices,
+                                                 prg_fixed_key, ncols, bitlengths);
+  ENCRYPTO::BitMatrix::ReceiverTransposeAndEncrypt(ptrs, out_expected, prg_fixed_key, ncols,
+                                                   bitlengths);
+
+  std::vector<ENCRYPTO::BitVector<>> y0(ncols), y1(ncols), out(ncols);
+  for (std::size_t offset = 0; offset < ncols; offset += range_size) {
+    const auto range_cols = std::min(range_size, ncols - offset);
+    ENCRYPTO::BitMatrix::SenderTransposeAndEncryptRange(ptrs, y0, y1, choices, prg_fixed_key,
+                                                        offset, range_cols, num_ots, bitlengths);
+    ENCRYPTO::BitMatrix::ReceiverTransposeAndEncryptRange(ptrs, out, prg_fixed_key, offset,
+                                                          range_cols, num_ots, bitlengths);
+  }
+  EXPECT_EQ(y0, y0_expected);
+  EXPECT_EQ(y1, y1_expected);
+  EXPECT_EQ(out, out_expected);
+}
+
+// the transposition of contiguous matrices of arbitrary shapes, with all kernels
+TEST(BitMatrix, ContiguousTranspose) {
+  using Kernel = ENCRYPTO::BitMatrix::TransposeKernel;
+  for (std::size_t num_rows : {1, 7, 8, 17, 64, 300, 1025}) {
+    for (std::size_t num_columns : {1, 9, 64, 129, 700}) {
+      std::vector<ENCRYPTO::BitVector<>> rows(num_rows);
+      for (auto& row : rows) {
+        row = ENCRYPTO::BitVector<>::Random(num_columns);
+      }
+      const ENCRYPTO::ContiguousBitMatrix matrix(rows);
+      for (auto kernel : {Kernel::sse, Kernel::avx2, Kernel::avx512}) {
+        if (!ENCRYPTO::BitMatrix::IsTransposeKernelSupported(kernel)) {
+          continue;
+        }
+        const auto transposed = matrix.Transposed(kernel);
+        ASSERT_EQ(transposed.GetNumRows(), num_columns);
+        ASSERT_EQ(transposed.GetNumColumns(), num_rows);
+        for (std::size_t row_i = 0; row_i < num_rows; ++row_i) {
+          for (std::size_t column_i = 0; column_i < num_columns; ++column_i) {
+            ASSERT_EQ(transposed.Get(column_i, row_i), rows[row_i].Get(column_i));
+          }
+        }
+        EXPECT_TRUE(transposed.Transposed(kernel) == matrix);
+        // the padding of the rows stays zero
+        if (num_rows % 8 != 0) {
+          for (std::size_t row_i = 0; row_i < num_columns; ++row_i) {
+            const auto last_byte = transposed.GetRowData(row_i)[transposed.GetRowStride() - 1];
+            EXPECT_EQ(std::to_integer<unsigned>(last_byte) >> (num_rows % 8), 0);
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace
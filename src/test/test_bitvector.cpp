@@ -26,6 +26,7 @@
 
 #include <gtest/gtest.h>
 
+#include "utility/bit_expression.h"
 #include "utility/bit_vector.h"
 
 #include "test_constants.h"
@@ -415,6 +416,130 @@ TEST(BitVector, AppendSpan) {
   }
 }
 
+// sizes hitting the vector, word and byte loops of the bit-wise kernels
+TEST(BitVector, BitwiseOperationsAllSizes) {
+  for (std::size_t num_bits = 1; num_bits < 1200; num_bits += 13) {
+    auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+    auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+    auto y = ENCRYPTO::BitVector<>::Random(num_bits);
+    ENCRYPTO::BitVector<> a_xor_b(num_bits), a_and_b(num_bits), a_or_b(num_bits);
+    ENCRYPTO::BitVector<> y_xor_a_and_b(num_bits);
+    for (std::size_t i = 0; i < num_bits; ++i) {
+      a_xor_b.Set(a.Get(i) != b.Get(i), i);
+      a_and_b.Set(a.Get(i) && b.Get(i), i);
+      a_or_b.Set(a.Get(i) || b.Get(i), i);
+      y_xor_a_and_b.Set(y.Get(i) != (a.Get(i) && b.Get(i)), i);
+    }
+    EXPECT_EQ(a ^ b, a_xor_b);
+    EXPECT_EQ(a & b, a_and_b);
+    EXPECT_EQ(a | b, a_or_b);
+    ENCRYPTO::AlignedBitVector aligned_b(b);
+    EXPECT_EQ(a ^ aligned_b, a_xor_b);
+    y.XorAnd(a, aligned_b);
+    EXPECT_EQ(y, y_xor_a_and_b);
+  }
+}
+
+TEST(BitVector, Expressions) {
+  using ENCRYPTO::bits;
+  for (std::size_t num_bits = 1; num_bits < 1200; num_bits += 13) {
+    const auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+    const ENCRYPTO::AlignedBitVector b = ENCRYPTO::BitVector<>::Random(num_bits);
+    const auto c = ENCRYPTO::BitVector<>::Random(num_bits);
+    auto y = ENCRYPTO::BitVector<>::Random(num_bits);
+
+    auto expected = y ^ (a & b) ^ (b & c);
+    y ^= (bits(a) & bits(b)) ^ (bits(b) & bits(c));
+    EXPECT_EQ(y, expected);
+
+    expected = y & (a | c);
+    y &= bits(a) | bits(c);
+    EXPECT_EQ(y, expected);
+
+    EXPECT_EQ(ENCRYPTO::evaluate(bits(a) ^ bits(ENCRYPTO::BitSpan(y))), a ^ y);
+  }
+  // slices of several wires of 16 bits
+  auto wires = ENCRYPTO::BitVector<>::Random(3 * 16);
+  const auto x = ENCRYPTO::BitVector<>::Random(16);
+  auto expected = wires;
+  expected.Copy(16, 32, expected.Subset(16, 32) ^ x);
+  ENCRYPTO::xor_assign(wires.GetMutableData().data() + 2, bits(x));
+  EXPECT_EQ(wires, expected);
+
+  ENCRYPTO::BitVector<> y(10);
+  EXPECT_THROW(y ^= bits(ENCRYPTO::BitVector<>(11)) & bits(ENCRYPTO::BitVector<>(11)),
+               std::invalid_argument);
+  EXPECT_THROW(bits(ENCRYPTO::BitVector<>(10)) & bits(ENCRYPTO::BitVector<>(11)),
+               std::invalid_argument);
+}
+
+TEST(BitVector, ArenaAllocator) {
+  ENCRYPTO::Arena arena(1024);
+  const ENCRYPTO::arena_alloc allocator(&arena);
+  for (std::size_t num_bits : {1, 7, 64, 1000, 10'000}) {
+    auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+    auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+    ENCRYPTO::BitVector<ENCRYPTO::arena_alloc> arena_a(allocator);
+    arena_a.Reserve(MOTION::Helpers::Convert::BitsToBytes(num_bits));
+    arena_a.Append(a);
+    EXPECT_EQ(arena_a.GetData().get_allocator().get_arena(), &arena);
+    EXPECT_EQ(arena_a, a);
+
+    // copies do not take memory from the arena
+    auto arena_ab = arena_a & b;
+    EXPECT_EQ(arena_ab.GetData().get_allocator().get_arena(), nullptr);
+    EXPECT_EQ(arena_ab, a & b);
+
+    arena_a ^= b;
+    EXPECT_EQ(arena_a, a ^ b);
+    EXPECT_EQ(b ^ arena_a, a);
+  }
+  EXPECT_GT(arena.get_num_allocated_bytes(), 0);
+  EXPECT_GE(arena.get_num_reserved_bytes(), arena.get_num_allocated_bytes());
+  arena.release();
+  EXPECT_EQ(arena.get_num_allocated_bytes(), 0);
+  EXPECT_EQ(arena.get_num_reserved_bytes(), 0);
+}
+
+TEST(BitVector, HugePageAllocator) {
+  auto& huge_pages = ENCRYPTO::HugePageArena::get_instance();
+  const auto mode = huge_pages.get_mode();
+  huge_pages.set_min_size(ENCRYPTO::HugePageArena::huge_page_size);
+  // explicit huge pages are usually not reserved, so this also covers the fallback
+  for (auto m : {ENCRYPTO::HugePageMode::disabled, ENCRYPTO::HugePageMode::transparent,
+                 ENCRYPTO::HugePageMode::explicit_2m}) {
+    huge_pages.set_mode(m);
+    for (std::size_t num_bits : {1, 1000, 20'000'000}) {
+      auto a = ENCRYPTO::BitVector<>::Random(num_bits);
+      auto b = ENCRYPTO::BitVector<>::Random(num_bits);
+
+      ENCRYPTO::HugePageBitVector huge_a(a);
+      EXPECT_TRUE(huge_a.IsAligned());
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(huge_a.GetData().data()) %
+                    MOTION::MOTION_ALIGNMENT,
+                0);
+      EXPECT_EQ(huge_a, a);
+      huge_a ^= b;
+      EXPECT_EQ(huge_a, a ^ b);
+      EXPECT_EQ(b ^ huge_a, a);
+      huge_a &= ENCRYPTO::BitSpan(b);
+      EXPECT_EQ(huge_a, (a ^ b) & b);
+    }
+    const auto statistics = huge_pages.get_statistics();
+    EXPECT_EQ(statistics.num_mapped_bytes, 0);
+    if (m == ENCRYPTO::HugePageMode::disabled) {
+      EXPECT_EQ(statistics.num_mapped_buffers, 0);
+    } else {
+      EXPECT_GT(statistics.num_mapped_buffers, 0);
+    }
+  }
+  huge_pages.release();
+  EXPECT_EQ(huge_pages.get_statistics().num_cached_bytes, 0);
+  huge_pages.set_mode(mode);
+  huge_pages.set_min_size(ENCRYPTO::HugePageArena::default_min_size);
+}
+
 TEST(BitVector, Copy) {
   std::mt19937_64 e(0);
   for (auto test_iterations = 0ull; test_iterations < TEST_ITERATIONS; ++test_iterations) {
@@ -656,4 +781,37 @@ TEST(BitSpan, Copy) {
     }
   }
 }
+
+TEST(BitVector, AccumulateBitCounts) {
+  std::mt19937_64 e(0);
+  for (const std::size_t num_planes : {1, 2, 7, 64, 300}) {
+    for (const std::size_t num_bits : {1, 63, 64, 65, 200, 1000, 1801}) {
+      std::vector<ENCRYPTO::BitVector<>> planes;
+      std::vector<const std::byte*> plane_ptrs;
+      for (std::size_t i = 0; i < num_planes; ++i) {
+        planes.push_back(ENCRYPTO::BitVector<>::Random(num_bits));
+      }
+      for (const auto& p : planes) {
+        plane_ptrs.push_back(p.GetData().data());
+      }
+      std::uniform_int_distribution<std::size_t> dist(0, num_bits / 8);
+      const auto begin = 8 * dist(e);
+      std::vector<std::uint16_t> init(num_bits);
+      for (auto& c : init) {
+        c = e();
+      }
+      auto counts = init;
+      ENCRYPTO::AccumulateBitCounts<std::uint16_t>(plane_ptrs, begin, num_bits, counts.data());
+      for (std::size_t j = 0; j < num_bits; ++j) {
+        std::uint16_t expected = init[j];
+        if (j >= begin) {
+          for (const auto& p : planes) {
+            expected += p.Get(j);
+          }
+        }
+        EXPECT_EQ(counts[j], expected);
+      }
+    }
+  }
+}
 }  // namespace
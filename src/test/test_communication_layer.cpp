@@ -22,9 +22,17 @@
 
 #include <gtest/gtest.h>
 #include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <span>
 
 #include "communication/communication_layer.h"
+#include "communication/message.h"
+#include "communication/message_codec.h"
 #include "communication/message_handler.h"
+#include "communication/sync_handler.h"
+#include "communication/transport.h"
 #include "utility/logger.h"
 
 TEST(CommunicationLayer, Dummy) {
@@ -85,6 +93,41 @@ TEST(CommunicationLayer, Dummy) {
   std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
 }
 
+TEST(CommunicationLayer, DummyWithoutVerification) {
+  using namespace MOTION::Communication;
+  auto comm_layers = make_dummy_communication_layers(2, false);
+  auto& cl_alice = comm_layers.at(0);
+  auto& cl_bob = comm_layers.at(1);
+  cl_bob->register_message_handler([](auto) { return std::make_shared<QueueHandler>(); },
+                                   {MessageType::BEAVYGate});
+  auto& qh_bob =
+      dynamic_cast<QueueHandler&>(cl_bob->get_message_handler(0, MessageType::BEAVYGate));
+  std::for_each(std::begin(comm_layers), std::end(comm_layers), [](auto& cl) { cl->start(); });
+
+  // the vector is handed over to Bob, the flatbuffer and the broadcast message are copied
+  const std::vector<std::uint8_t> payload = {0xde, 0xad, 0xbe, 0xef};
+  auto message_builder = BuildMessage(MessageType::BEAVYGate, &payload);
+  const std::vector<std::uint8_t> message(
+      message_builder.GetBufferPointer(),
+      message_builder.GetBufferPointer() + message_builder.GetSize());
+  cl_alice->send_message(1, std::vector<std::uint8_t>(message));
+  cl_alice->send_message(1, std::move(message_builder));
+  cl_alice->broadcast_message(std::make_shared<const std::vector<std::uint8_t>>(message));
+  for (std::size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(qh_bob.get_queue().dequeue(), message);
+  }
+
+  std::vector<std::future<void>> futs;
+  for (auto& cl : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&cl] { cl->shutdown(); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  const auto stats = cl_alice->get_transport_statistics().at(0);
+  EXPECT_GE(stats.num_messages_sent, 3);
+  EXPECT_GE(stats.num_bytes_sent, 3 * message.size());
+}
+
 class CommunicationLayerTCP : public testing::TestWithParam<bool> {};
 
 TEST_P(CommunicationLayerTCP, TCP) {
@@ -147,3 +190,238 @@ TEST_P(CommunicationLayerTCP, TCP) {
 
 INSTANTIATE_TEST_SUITE_P(CommunicationLayerTCPTests, CommunicationLayerTCP, testing::Bool(),
                          [](auto& info) { return info.param ? "ipv6" : "ipv4"; });
+
+TEST(MessageCodec, RoundTrip) {
+  using namespace MOTION::Communication;
+  // one-hot blocks
+  std::vector<std::uint8_t> one_hot(1 << 16, 0);
+  for (std::size_t i = 0; i < one_hot.size(); i += 512) {
+    one_hot[i + (i % 7)] = 1 << (i % 8);
+  }
+  auto sparse = compress_message(one_hot, supported_message_codecs);
+  ASSERT_TRUE(sparse.has_value());
+  EXPECT_EQ(sparse->front(), static_cast<std::uint8_t>(MessageCodec::sparse));
+  EXPECT_LT(sparse->size(), one_hot.size() / 100);
+  EXPECT_EQ(decompress_message(*sparse), one_hot);
+
+  // blocks of equal bytes with some literals in between
+  std::vector<std::uint8_t> blocks(10000, 0xff);
+  std::fill_n(std::begin(blocks) + 3000, 3000, 0x00);
+  blocks[42] = 0x13;
+  blocks[43] = 0x37;
+  auto run_length = compress_message(blocks, supported_message_codecs);
+  ASSERT_TRUE(run_length.has_value());
+  EXPECT_EQ(run_length->front(), static_cast<std::uint8_t>(MessageCodec::run_length));
+  EXPECT_EQ(decompress_message(*run_length), blocks);
+
+  // random data is sent uncompressed
+  std::vector<std::uint8_t> random(10000);
+  std::mt19937 gen(0);
+  std::generate(std::begin(random), std::end(random), [&gen] { return gen(); });
+  EXPECT_FALSE(compress_message(random, supported_message_codecs).has_value());
+  EXPECT_FALSE(compress_message(one_hot, 0).has_value());
+}
+
+TEST(CommunicationLayer, Compression) {
+  auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2);
+  auto& cl_alice = comm_layers.at(0);
+  auto& cl_bob = comm_layers.at(1);
+  for (auto& cl : comm_layers) {
+    cl->set_message_compression(true);
+  }
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    // normally negotiated by the MotionBaseProvider in the HelloMessages
+    comm_layers.at(party_id)->set_peer_message_codecs(
+        1 - party_id, comm_layers.at(1 - party_id)->get_supported_message_codecs());
+  }
+  cl_bob->register_fallback_message_handler(
+      [](auto party_id) { return std::make_shared<MOTION::Communication::QueueHandler>(); });
+  auto& qh_bob =
+      dynamic_cast<MOTION::Communication::QueueHandler&>(cl_bob->get_fallback_message_handler(0));
+  std::for_each(std::begin(comm_layers), std::end(comm_layers), [](auto& cl) { cl->start(); });
+
+  std::vector<std::uint8_t> payload(1 << 16, 0);
+  payload[1234] = 0x10;
+  auto message_builder =
+      MOTION::Communication::BuildMessage(MOTION::Communication::MessageType::BEAVYGate, &payload);
+  const std::vector<std::uint8_t> message(
+      message_builder.GetBufferPointer(),
+      message_builder.GetBufferPointer() + message_builder.GetSize());
+  cl_alice->send_message(1, std::move(message_builder));
+  // the handler receives the original message
+  EXPECT_EQ(qh_bob.get_queue().dequeue(), message);
+
+  std::vector<std::future<void>> futs;
+  for (auto& cl : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&cl] { cl->shutdown(); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  const auto stats = cl_alice->get_transport_statistics().at(0);
+  EXPECT_EQ(stats.num_compressed_messages_sent, 1);
+  EXPECT_GT(stats.num_bytes_saved_by_compression, payload.size() / 2);
+  EXPECT_LT(stats.num_bytes_sent, payload.size() / 100);
+}
+
+TEST(CommunicationLayer, BulkLane) {
+  using namespace MOTION::Communication;
+  auto comm_layers = make_dummy_communication_layers(2);
+  auto& cl_alice = comm_layers.at(0);
+  auto& cl_bob = comm_layers.at(1);
+  const std::size_t chunk_size = 1000;
+  cl_alice->set_bulk_chunk_size(chunk_size);
+  cl_bob->register_fallback_message_handler(
+      [](auto party_id) { return std::make_shared<QueueHandler>(); });
+  auto& qh_bob = dynamic_cast<QueueHandler&>(cl_bob->get_fallback_message_handler(0));
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<unsigned int> dist(0, 255);
+  std::vector<std::uint8_t> bulk_payload(10 * chunk_size);
+  std::generate(std::begin(bulk_payload), std::end(bulk_payload), [&] { return dist(gen); });
+  auto bulk_builder = BuildMessage(MessageType::OTExtensionSender, &bulk_payload);
+  const std::vector<std::uint8_t> bulk_message(
+      bulk_builder.GetBufferPointer(), bulk_builder.GetBufferPointer() + bulk_builder.GetSize());
+  const std::vector<std::uint8_t> gate_payload = {0xde, 0xad, 0xbe, 0xef};
+  auto gate_builder = BuildMessage(MessageType::BEAVYGate, &gate_payload);
+  const std::vector<std::uint8_t> gate_message(
+      gate_builder.GetBufferPointer(), gate_builder.GetBufferPointer() + gate_builder.GetSize());
+  // both are in the first batch of the send thread, the gate message overtakes the bulk message
+  cl_alice->send_message(1, std::move(bulk_builder));
+  cl_alice->send_message(1, std::move(gate_builder));
+  std::for_each(std::begin(comm_layers), std::end(comm_layers), [](auto& cl) { cl->start(); });
+
+  EXPECT_EQ(qh_bob.get_queue().dequeue(), gate_message);
+  // the chunks are reassembled to the original message
+  EXPECT_EQ(qh_bob.get_queue().dequeue(), bulk_message);
+
+  std::vector<std::future<void>> futs;
+  for (auto& cl : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&cl] { cl->shutdown(); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  const auto stats = cl_alice->get_transport_statistics().at(0);
+  EXPECT_GT(stats.num_messages_sent, bulk_payload.size() / chunk_size);
+}
+
+TEST(CommunicationLayer, Sessions) {
+  using namespace MOTION::Communication;
+  auto comm_layers = make_dummy_communication_layers(2);
+  std::for_each(std::begin(comm_layers), std::end(comm_layers), [](auto& cl) { cl->start(); });
+
+  const auto make_queue_handler = [](auto) { return std::make_shared<QueueHandler>(); };
+  std::vector<std::unique_ptr<CommunicationLayer>> sessions_alice;
+  for (std::uint32_t session_id : {1, 2}) {
+    auto& session = sessions_alice.emplace_back(
+        std::make_unique<CommunicationLayer>(*comm_layers.at(0), session_id));
+    session->register_message_handler(make_queue_handler, {MessageType::BEAVYGate});
+    session->start();
+  }
+  // Bob's sessions do not exist yet, so these messages need to be buffered
+  for (std::uint8_t i = 0; i < 2; ++i) {
+    const std::vector<std::uint8_t> payload = {i};
+    sessions_alice.at(i)->send_message(1, BuildMessage(MessageType::BEAVYGate, &payload));
+  }
+
+  std::vector<std::unique_ptr<CommunicationLayer>> sessions_bob;
+  for (std::uint32_t session_id : {1, 2}) {
+    auto& session = sessions_bob.emplace_back(
+        std::make_unique<CommunicationLayer>(*comm_layers.at(1), session_id));
+    session->register_message_handler(make_queue_handler, {MessageType::BEAVYGate});
+    session->start();
+  }
+  EXPECT_THROW({ CommunicationLayer session(*comm_layers.at(1), 1); }, std::invalid_argument);
+
+  // each session receives only its own messages
+  for (std::uint8_t i = 0; i < 2; ++i) {
+    auto& qh = dynamic_cast<QueueHandler&>(
+        sessions_bob.at(i)->get_message_handler(0, MessageType::BEAVYGate));
+    auto raw_message = qh.get_queue().dequeue();
+    ASSERT_TRUE(raw_message.has_value());
+    const auto* message = GetMessage(raw_message->data());
+    EXPECT_EQ(message->session_id(), i + 1u);
+    ASSERT_EQ(message->payload()->size(), 1u);
+    EXPECT_EQ(message->payload()->Get(0), i);
+  }
+
+  // the sessions synchronize independently
+  {
+    std::vector<std::future<void>> futs;
+    for (auto& session : sessions_alice) {
+      futs.emplace_back(std::async(std::launch::async, [&session] { session->sync(); }));
+    }
+    for (auto& session : sessions_bob) {
+      futs.emplace_back(std::async(std::launch::async, [&session] { session->sync(); }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  }
+
+  sessions_alice.clear();
+  sessions_bob.clear();
+  std::vector<std::future<void>> futs;
+  for (auto& cl : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&cl] { cl->shutdown(); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+}
+
+TEST(CommunicationLayer, CompactGateMessages) {
+  using namespace MOTION::Communication;
+  std::vector<std::uint8_t> payload(300);
+  std::iota(std::begin(payload), std::end(payload), 0);
+  auto message = BuildCompactGateMessage(MessageType::YaoGate, 1234567, 42, payload);
+  ASSERT_TRUE(IsCompactGateMessage(message));
+  // cannot be mistaken for a Message
+  flatbuffers::Verifier verifier(message.data(), message.size());
+  EXPECT_FALSE(VerifyMessageBuffer(verifier));
+
+  auto parsed = ParseCompactGateMessage(message);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->message_type, MessageType::YaoGate);
+  EXPECT_EQ(parsed->session_id, 0u);
+  EXPECT_EQ(parsed->gate_id, 1234567u);
+  EXPECT_EQ(parsed->msg_num, 42u);
+  EXPECT_EQ(parsed->sync_epoch, 0u);  // stamped by the CommunicationLayer on sending
+  EXPECT_TRUE(std::equal(std::begin(payload), std::end(payload), std::begin(parsed->payload),
+                         std::end(parsed->payload)));
+
+  EXPECT_TRUE(SetMessageSessionId(message.data(), 0xdeadbeef));
+  EXPECT_EQ(GetMessageTypeAndSessionId(message),
+            std::make_pair(MessageType::YaoGate, std::uint32_t(0xdeadbeef)));
+
+  // truncated and extended frames are rejected
+  EXPECT_FALSE(ParseCompactGateMessage(std::span(message).first(message.size() - 1)));
+  message.push_back(0);
+  EXPECT_FALSE(ParseCompactGateMessage(message));
+  EXPECT_FALSE(ParseCompactGateMessage(std::span(message).first(4)));
+}
+
+TEST(CommunicationLayer, SyncEpochs) {
+  using namespace MOTION::Communication;
+  SyncHandler sync_handler_0(0, 2, nullptr);
+  SyncHandler sync_handler_1(1, 2, nullptr);
+  EXPECT_TRUE(sync_handler_0.others_reached());
+  // more syncs than there are stamps, which wrap around without producing 0 (unstamped)
+  for (std::size_t i = 0; i < 600; ++i) {
+    sync_handler_0.increment_my_sync_state();
+    EXPECT_FALSE(sync_handler_0.others_reached());
+    auto epoch_0 = sync_handler_0.stamp_epoch(1);
+    EXPECT_NE(epoch_0, 0);
+    sync_handler_1.received_epoch(0, 0);
+    sync_handler_1.received_epoch(0, epoch_0);
+    sync_handler_1.increment_my_sync_state();
+    // party 1 learned the state of party 0 from the stamp
+    EXPECT_TRUE(sync_handler_1.others_reached());
+
+    auto epoch_1 = sync_handler_1.stamp_epoch(0);
+    EXPECT_NE(epoch_1, 0);
+    sync_handler_0.received_epoch(1, epoch_1);
+    EXPECT_TRUE(sync_handler_0.others_reached());
+    // replayed stamps are ignored
+    sync_handler_0.received_epoch(1, epoch_1);
+    sync_handler_1.received_epoch(0, epoch_0);
+    EXPECT_TRUE(sync_handler_0.others_reached());
+  }
+  sync_handler_0.increment_my_sync_state();
+  EXPECT_FALSE(sync_handler_0.others_reached());
+}
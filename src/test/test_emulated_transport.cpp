@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communication/communication_layer.h"
+#include "communication/dummy_transport.h"
+#include "communication/emulated_transport.h"
+
+using namespace MOTION::Communication;
+using namespace std::chrono_literals;
+
+TEST(EmulatedTransport, ParseNetworkProfile) {
+  EXPECT_TRUE(parse_network_profile("none").is_none());
+  EXPECT_EQ(parse_network_profile("wan").round_trip_time, 100ms);
+  const auto profile = parse_network_profile("20,50,1.5");
+  EXPECT_EQ(profile.round_trip_time, 20ms);
+  EXPECT_EQ(profile.bandwidth, 50'000'000);
+  EXPECT_EQ(profile.jitter, 1500us);
+  EXPECT_EQ(parse_network_profile("0.5,0").bandwidth, 0);
+  EXPECT_THROW(parse_network_profile("20"), std::invalid_argument);
+  EXPECT_THROW(parse_network_profile("20,x"), std::invalid_argument);
+  EXPECT_THROW(parse_network_profile("-1,10"), std::invalid_argument);
+}
+
+TEST(EmulatedTransport, LatencyAndBandwidth) {
+  auto [dummy_alice, dummy_bob] = DummyTransport::make_transport_pair();
+  // 8 Mbit/s, such that each message of 10000 bytes needs 10 ms
+  auto emulation = std::make_shared<NetworkEmulation>(parse_network_profile("40,8,5"));
+  EmulatedTransport transport_alice(std::move(dummy_alice), emulation);
+  auto& transport_bob = *dummy_bob;
+
+  const auto start = std::chrono::steady_clock::now();
+  constexpr std::size_t num_messages = 10;
+  for (std::size_t i = 0; i < num_messages; ++i) {
+    transport_alice.send_message(std::vector<std::uint8_t>(10000, i));
+  }
+  // sending does not block
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10ms);
+
+  auto first_message = transport_bob.receive_message();
+  const auto first_time = std::chrono::steady_clock::now() - start;
+  ASSERT_TRUE(first_message.has_value());
+  EXPECT_EQ(first_message->at(0), 0);
+  // half of the RTT plus the transmission time
+  EXPECT_GE(first_time, 30ms);
+  for (std::size_t i = 1; i < num_messages; ++i) {
+    auto message = transport_bob.receive_message();
+    ASSERT_TRUE(message.has_value());
+    // the jitter does not reorder the messages
+    EXPECT_EQ(message->at(0), i);
+  }
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 120ms);
+
+  const auto& stats = transport_alice.get_stats();
+  EXPECT_EQ(stats.num_messages_sent, num_messages);
+  EXPECT_EQ(stats.num_bytes_sent, num_messages * 10000);
+
+  transport_alice.shutdown();
+  EXPECT_FALSE(transport_bob.receive_message().has_value());
+}
+
+TEST(EmulatedTransport, MeasureNetwork) {
+  // 64 Mbit/s, such that the probe of 80000 bytes needs 10 ms
+  auto emulation = std::make_shared<NetworkEmulation>(parse_network_profile("20,64"));
+  auto [dummy_alice, dummy_bob] = DummyTransport::make_transport_pair();
+  std::vector<std::unique_ptr<Transport>> transports_alice(2), transports_bob(2);
+  transports_alice.at(1) = std::move(dummy_alice);
+  transports_bob.at(0) = std::move(dummy_bob);
+  MOTION::Communication::CommunicationLayer comm_layer_alice(
+      0, make_emulated_transports(std::move(transports_alice), emulation));
+  MOTION::Communication::CommunicationLayer comm_layer_bob(
+      1, make_emulated_transports(std::move(transports_bob), emulation));
+  comm_layer_alice.start();
+  comm_layer_bob.start();
+
+  auto future_bob = std::async(std::launch::async, [&comm_layer_bob] {
+    return comm_layer_bob.measure_network(4, 80000);
+  });
+  const auto profile = comm_layer_alice.measure_network(4, 80000);
+  future_bob.get();
+  EXPECT_GE(profile.round_trip_time, 18ms);
+  EXPECT_LE(profile.round_trip_time, 60ms);
+  EXPECT_GE(profile.bandwidth, 16'000'000);
+  EXPECT_LE(profile.bandwidth, 128'000'000);
+
+  auto shutdown_bob =
+      std::async(std::launch::async, [&comm_layer_bob] { comm_layer_bob.shutdown(); });
+  comm_layer_alice.shutdown();
+  shutdown_bob.get();
+}
@@ -21,7 +21,10 @@
 // SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <cstdint>
+#include <random>
+#include <vector>
 
 #include "utility/fixed_point.h"
 
@@ -82,3 +85,58 @@ TEST(FixedPoint, TruncateShared) {
   // check that the result matches the product computed on doubles in plaintext
   EXPECT_NEAR(dec_h, h, max_error);
 }
+
+template <typename I, typename F>
+void test_range_conversions(std::size_t fractional_bits) {
+  // an odd number of values for the scalar tail after the vector loops
+  constexpr std::size_t n = 1003;
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<F> dist(-1000, 1000);
+  std::vector<F> values(n);
+  for (auto& x : values) {
+    x = dist(gen);
+  }
+  // ties which std::lround rounds away from zero, and values out of the range of I
+  values[1] = F(2.5) / std::exp2(fractional_bits);
+  values[2] = F(-2.5) / std::exp2(fractional_bits);
+  values[3] = F(-0.5) / std::exp2(fractional_bits);
+  values[4] = F(1e18);
+  values[5] = F(-1e18);
+
+  std::vector<I> encoded(n);
+  fp::encode(encoded.data(), values.data(), fractional_bits, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(encoded[i], (fp::encode<I, F>(values[i], fractional_bits))) << i;
+  }
+
+  std::vector<I> shares(n);
+  for (auto& y : shares) {
+    y = static_cast<I>(gen());
+  }
+  shares[0] = I(-1);
+  shares[1] = I(1) << (fp::bit_size_v<I> - 1);
+  std::vector<F> decoded(n);
+  fp::decode(decoded.data(), shares.data(), fractional_bits, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(decoded[i], (fp::decode<I, F>(shares[i], fractional_bits))) << i;
+  }
+
+  for (const bool party_0 : {true, false}) {
+    auto truncated = shares;
+    fp::truncate_shared(truncated.data(), fractional_bits, n, party_0);
+    for (std::size_t i = 0; i < n; ++i) {
+      const I expected =
+          party_0 ? I(shares[i] >> fractional_bits) : I(-I(I(-shares[i]) >> fractional_bits));
+      EXPECT_EQ(truncated[i], expected) << i;
+    }
+  }
+}
+
+TEST(FixedPoint, RangeConversionsMatchScalar) {
+  test_range_conversions<std::uint32_t, float>(13);
+  test_range_conversions<std::uint32_t, double>(16);
+  test_range_conversions<std::uint64_t, float>(13);
+  test_range_conversions<std::uint64_t, double>(24);
+  // a small negative 64 bit value keeps its low bits
+  EXPECT_EQ((fp::decode<std::uint64_t, double>(std::uint64_t(-3), 1)), -1.5);
+}
@@ -486,6 +486,58 @@ TEST_F(BooleanGMWTest, AND) {
   }
 }
 
+// AND gates whose MTs and wires start at byte boundaries or not
+TEST_F(BooleanGMWTest, ANDAlignments) {
+  const std::vector<std::pair<std::size_t, std::size_t>> gate_sizes = {{8, 16}, {1, 13}, {2, 16}};
+  std::vector<MOTION::BitValues> inputs_a;
+  std::vector<MOTION::BitValues> inputs_b;
+  std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>> input_promises;
+  std::vector<std::array<MOTION::WireVector, 2>> wires_out;
+  for (const auto [num_wires, num_simd] : gate_sizes) {
+    inputs_a.push_back(generate_inputs(num_wires, num_simd));
+    inputs_b.push_back(generate_inputs(num_wires, num_simd));
+    auto [input_a_promise, wires_0_in_a] =
+        gmw_providers_[0]->make_boolean_input_gate_my(0, num_wires, num_simd);
+    auto wires_1_in_a = gmw_providers_[1]->make_boolean_input_gate_other(0, num_wires, num_simd);
+    auto wires_0_in_b = gmw_providers_[0]->make_boolean_input_gate_other(1, num_wires, num_simd);
+    auto [input_b_promise, wires_1_in_b] =
+        gmw_providers_[1]->make_boolean_input_gate_my(1, num_wires, num_simd);
+    input_promises.push_back(std::move(input_a_promise));
+    input_promises.push_back(std::move(input_b_promise));
+    wires_out.push_back(
+        {gmw_providers_[0]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, wires_0_in_a,
+                                             wires_0_in_b),
+         gmw_providers_[1]->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, wires_1_in_a,
+                                             wires_1_in_b)});
+  }
+
+  run_setup();
+  run_gates_setup();
+  for (std::size_t gate_i = 0; gate_i < gate_sizes.size(); ++gate_i) {
+    input_promises.at(2 * gate_i).set_value(inputs_a.at(gate_i));
+    input_promises.at(2 * gate_i + 1).set_value(inputs_b.at(gate_i));
+  }
+  run_gates_online();
+
+  for (std::size_t gate_i = 0; gate_i < gate_sizes.size(); ++gate_i) {
+    const auto [num_wires, num_simd] = gate_sizes.at(gate_i);
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto wire_0 =
+          std::dynamic_pointer_cast<BooleanGMWWire>(wires_out.at(gate_i)[0].at(wire_i));
+      const auto wire_1 =
+          std::dynamic_pointer_cast<BooleanGMWWire>(wires_out.at(gate_i)[1].at(wire_i));
+      wire_0->wait_online();
+      wire_1->wait_online();
+      const auto& share_0 = wire_0->get_share();
+      const auto& share_1 = wire_1->get_share();
+      ASSERT_EQ(share_0.GetSize(), num_simd);
+      ASSERT_EQ(share_1.GetSize(), num_simd);
+      ASSERT_EQ(inputs_a.at(gate_i).at(wire_i) & inputs_b.at(gate_i).at(wire_i),
+                share_0 ^ share_1);
+    }
+  }
+}
+
 TEST_F(BooleanGMWTest, ConstantAND) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
@@ -897,6 +949,51 @@ TYPED_TEST(ArithmeticGMWTest, MUL) {
   }
 }
 
+TYPED_TEST(ArithmeticGMWTest, BroadcastMUL) {
+  std::size_t num_groups = 3;
+  std::size_t vector_size = 7;
+  std::size_t num_simd = num_groups * vector_size;
+  const auto inputs_a = this->generate_inputs(num_groups);
+  const auto inputs_b = this->generate_inputs(num_simd);
+  std::vector<TypeParam> expected_output(num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    expected_output.at(simd_j) = inputs_a.at(simd_j / vector_size) * inputs_b.at(simd_j);
+  }
+
+  // input of party 0
+  auto [input_a_promise, wires_a_in_0] = this->make_arithmetic_T_input_gate_my(0, 0, num_groups);
+  auto wires_a_in_1 = this->make_arithmetic_T_input_gate_other(1, 0, num_groups);
+
+  // input of party 1
+  auto wires_b_in_0 = this->make_arithmetic_T_input_gate_other(0, 1, num_simd);
+  auto [input_b_promise, wires_b_in_1] = this->make_arithmetic_T_input_gate_my(1, 1, num_simd);
+
+  auto wires_out_0 = this->gmw_providers_[0]->make_broadcast_mul_gate(wires_a_in_0, wires_b_in_0);
+  auto wires_out_1 = this->gmw_providers_[1]->make_broadcast_mul_gate(wires_a_in_1, wires_b_in_1);
+  // in_b needs a multiple of the SIMD values of in_a
+  EXPECT_THROW(this->gmw_providers_[0]->make_broadcast_mul_gate(wires_b_in_0, wires_a_in_0),
+               std::logic_error);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  this->run_gates_online();
+
+  // check wire values
+  const auto wire_0 = std::dynamic_pointer_cast<ArithmeticGMWWire<TypeParam>>(wires_out_0.at(0));
+  const auto wire_1 = std::dynamic_pointer_cast<ArithmeticGMWWire<TypeParam>>(wires_out_1.at(0));
+  wire_0->wait_online();
+  wire_1->wait_online();
+  const auto& share_0 = wire_0->get_share();
+  const auto& share_1 = wire_1->get_share();
+  ASSERT_EQ(share_0.size(), num_simd);
+  ASSERT_EQ(share_1.size(), num_simd);
+  for (std::size_t simd_j = 0; simd_j < num_simd; ++simd_j) {
+    ASSERT_EQ(expected_output.at(simd_j), TypeParam(share_0.at(simd_j) + share_1.at(simd_j)));
+  }
+}
+
 TYPED_TEST(ArithmeticGMWTest, ConstantMUL) {
   std::size_t num_simd = 10;
   const auto inputs_a = this->generate_inputs(num_simd);
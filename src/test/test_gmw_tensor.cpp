@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <array>
 #include <iterator>
 #include <memory>
@@ -43,6 +44,7 @@
 #include "protocols/gmw/wire.h"
 #include "statistics/run_time_stats.h"
 #include "tensor/tensor.h"
+#include "utility/fixed_point.h"
 #include "utility/helpers.h"
 #include "utility/linear_algebra.h"
 #include "utility/logger.h"
@@ -177,23 +179,25 @@ class ArithmeticGMWTensorTest : public GMWTensorTest {
   }
   std::pair<ENCRYPTO::ReusableFiberPromise<MOTION::IntegerValues<T>>, MOTION::tensor::TensorCP>
   make_arithmetic_T_tensor_input_my(std::size_t party_id,
-                                    const MOTION::tensor::TensorDimensions& dims) {
+                                    const MOTION::tensor::TensorDimensions& dims,
+                                    std::size_t fractional_bits = 0) {
     auto& gp = *gmw_providers_.at(party_id);
     if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return gp.make_arithmetic_64_tensor_input_my(dims);
+      return gp.make_arithmetic_64_tensor_input_my(dims, fractional_bits);
     } else {
       static_assert(ENCRYPTO::bit_size_v<T> == 32);
-      return gp.make_arithmetic_32_tensor_input_my(dims);
+      return gp.make_arithmetic_32_tensor_input_my(dims, fractional_bits);
     }
   }
   MOTION::tensor::TensorCP make_arithmetic_T_tensor_input_other(
-      std::size_t party_id, const MOTION::tensor::TensorDimensions& dims) {
+      std::size_t party_id, const MOTION::tensor::TensorDimensions& dims,
+      std::size_t fractional_bits = 0) {
     auto& gp = *gmw_providers_.at(party_id);
     if constexpr (ENCRYPTO::bit_size_v<T> == 64) {
-      return gp.make_arithmetic_64_tensor_input_other(dims);
+      return gp.make_arithmetic_64_tensor_input_other(dims, fractional_bits);
     } else {
       static_assert(ENCRYPTO::bit_size_v<T> == 32);
-      return gp.make_arithmetic_32_tensor_input_other(dims);
+      return gp.make_arithmetic_32_tensor_input_other(dims, fractional_bits);
     }
   }
   ENCRYPTO::ReusableFiberFuture<MOTION::IntegerValues<T>> make_arithmetic_T_tensor_output_my(
@@ -400,6 +404,104 @@ TYPED_TEST(ArithmeticGMWTensorTest, Gemm) {
   ASSERT_EQ(plain_output, expected_output);
 }
 
+TYPED_TEST(ArithmeticGMWTensorTest, SparseGemm) {
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {3, 100}, .input_B_shape_ = {100, 10}, .output_shape_ = {3, 10}};
+  ASSERT_TRUE(gemm_op.verify());
+  const auto input_A_dims = gemm_op.get_input_A_tensor_dims();
+  const auto output_dims = gemm_op.get_output_tensor_dims();
+  const auto input_A = this->generate_inputs(input_A_dims);
+  // party 1 holds the weights of which about every fifth is nonzero
+  auto weights = this->generate_inputs(gemm_op.get_input_B_tensor_dims());
+  for (std::size_t i = 0; i < weights.size(); ++i) {
+    if (i % 5 != 0) {
+      weights[i] = 0;
+    }
+  }
+  const auto sparse_weights_T = MOTION::CSRMatrix<TypeParam>::from_dense(100, 10, weights.data());
+  MOTION::CSRMatrix<std::uint64_t> sparse_weights{.rows_ = sparse_weights_T.rows_,
+                                                  .cols_ = sparse_weights_T.cols_,
+                                                  .row_ptr_ = sparse_weights_T.row_ptr_,
+                                                  .col_idx_ = sparse_weights_T.col_idx_,
+                                                  .values_ = {}};
+  auto weights_pattern = sparse_weights;
+  sparse_weights.values_.assign(std::begin(sparse_weights_T.values_),
+                                std::end(sparse_weights_T.values_));
+
+  auto [input_A_promise, tensor_input_A_0] =
+      this->make_arithmetic_T_tensor_input_my(0, input_A_dims);
+  auto tensor_input_A_1 = this->make_arithmetic_T_tensor_input_other(1, input_A_dims);
+
+  auto tensor_output_0 = this->gmw_providers_[0]->make_tensor_sparse_gemm_op(
+      gemm_op, tensor_input_A_0, weights_pattern, 1, 0);
+  auto tensor_output_1 = this->gmw_providers_[1]->make_tensor_sparse_gemm_op(
+      gemm_op, tensor_input_A_1, sparse_weights, 1, 0);
+
+  ASSERT_EQ(tensor_output_0->get_dimensions(), output_dims);
+  ASSERT_EQ(tensor_output_1->get_dimensions(), output_dims);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_A_promise.set_value(input_A);
+  this->run_gates_online();
+
+  const auto output_gmw_tensor_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_output_0);
+  const auto output_gmw_tensor_1 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_output_1);
+
+  const auto& output_share_0 = output_gmw_tensor_0->get_share();
+  const auto& output_share_1 = output_gmw_tensor_1->get_share();
+
+  ASSERT_EQ(output_share_0.size(), output_dims.get_data_size());
+  ASSERT_EQ(output_share_1.size(), output_dims.get_data_size());
+
+  const auto expected_output =
+      MOTION::matrix_multiply(gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
+                              gemm_op.input_B_shape_[1], input_A, weights);
+  const auto plain_output = MOTION::Helpers::AddVectors(output_share_0, output_share_1);
+
+  ASSERT_EQ(plain_output, expected_output);
+}
+
+TYPED_TEST(ArithmeticGMWTensorTest, Flatten) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 3, .height_ = 4, .width_ = 5};
+  const auto input = this->generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto tensor_out_0 = this->gmw_providers_[0]->make_tensor_flatten_op(tensor_in_0, 1);
+  auto tensor_out_1 = this->gmw_providers_[1]->make_tensor_flatten_op(tensor_in_1, 1);
+
+  const MOTION::tensor::TensorDimensions expected_dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 1, .width_ = dims.get_data_size()};
+  ASSERT_EQ(tensor_out_0->get_dimensions(), expected_dims);
+  ASSERT_EQ(tensor_out_1->get_dimensions(), expected_dims);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto tensor_input_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_in_0);
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_out_1);
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  // the output is a view of the input share
+  EXPECT_EQ(tensor_output_0->get_share().data(), tensor_input_0->get_share().data());
+  ASSERT_EQ(MOTION::Helpers::AddVectors(tensor_output_0->get_share(), tensor_output_1->get_share()),
+            input);
+}
+
 TYPED_TEST(ArithmeticGMWTensorTest, Sqr) {
   MOTION::tensor::TensorDimensions dims = {
       .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
@@ -440,3 +542,98 @@ TYPED_TEST(ArithmeticGMWTensorTest, Sqr) {
     ASSERT_EQ(TypeParam(input[i] * input[i]), TypeParam(share_0[i] + share_1[i]));
   }
 }
+
+TYPED_TEST(ArithmeticGMWTensorTest, Truncation) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 4, .width_ = 4};
+  constexpr std::size_t fractional_bits = 8;
+  constexpr std::size_t truncate_bits = 4;
+  // small positive and negative values s.t. the probabilistic truncation does not fail
+  auto input = this->generate_inputs(dims);
+  std::transform(std::begin(input), std::end(input), std::begin(input),
+                 [](auto x) { return TypeParam(x % 4096) - TypeParam(2048); });
+
+  auto [input_promise, tensor_in_0] =
+      this->make_arithmetic_T_tensor_input_my(0, dims, fractional_bits);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims, fractional_bits);
+
+  auto tensor_out_0 =
+      this->gmw_providers_[0]->make_tensor_truncation_op(tensor_in_0, truncate_bits);
+  auto tensor_out_1 =
+      this->gmw_providers_[1]->make_tensor_truncation_op(tensor_in_1, truncate_bits);
+
+  ASSERT_EQ(tensor_out_0->get_dimensions(), dims);
+  ASSERT_EQ(tensor_out_1->get_dimensions(), dims);
+  ASSERT_EQ(tensor_out_0->get_fractional_bits(), fractional_bits - truncate_bits);
+  ASSERT_EQ(tensor_out_1->get_fractional_bits(), fractional_bits - truncate_bits);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(tensor_out_1);
+
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  const auto& share_0 = tensor_output_0->get_share();
+  const auto& share_1 = tensor_output_1->get_share();
+
+  ASSERT_EQ(share_0.size(), input.size());
+  ASSERT_EQ(share_1.size(), input.size());
+
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    // the result may be off by one in the last place
+    const TypeParam diff =
+        share_0[i] + share_1[i] - MOTION::fixed_point::truncate(input[i], truncate_bits);
+    EXPECT_TRUE(diff == 0 || diff == 1 || diff == TypeParam(-1));
+  }
+}
+
+using ArithmeticGMWTensor64Test = ArithmeticGMWTensorTest<std::uint64_t>;
+
+TEST_F(ArithmeticGMWTensor64Test, RingReduction) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = make_arithmetic_T_tensor_input_my(0, dims, 16);
+  auto tensor_in_1 = make_arithmetic_T_tensor_input_other(1, dims, 16);
+
+  auto tensor_out_0 = gmw_providers_[0]->make_tensor_ring_reduction(tensor_in_0, 32);
+  auto tensor_out_1 = gmw_providers_[1]->make_tensor_ring_reduction(tensor_in_1, 32);
+
+  ASSERT_EQ(tensor_out_0->get_bit_size(), 32);
+  ASSERT_EQ(tensor_out_0->get_fractional_bits(), 16);
+
+  run_setup();
+  run_gates_setup();
+  input_promise.set_value(input);
+  run_gates_online();
+
+  const auto tensor_output_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<std::uint32_t>>(tensor_out_0);
+  const auto tensor_output_1 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<std::uint32_t>>(tensor_out_1);
+
+  ASSERT_NE(tensor_output_0, nullptr);
+  ASSERT_NE(tensor_output_1, nullptr);
+
+  tensor_output_0->wait_online();
+  tensor_output_1->wait_online();
+
+  const auto& share_0 = tensor_output_0->get_share();
+  const auto& share_1 = tensor_output_1->get_share();
+
+  ASSERT_EQ(share_0.size(), input.size());
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(std::uint32_t(share_0[i] + share_1[i]), std::uint32_t(input[i]));
+  }
+}
@@ -28,6 +28,7 @@
 
 #include "algorithm/circuit_loader.h"
 #include "crypto/garbling/half_gates.h"
+#include "crypto/garbling/three_halves.h"
 
 using namespace MOTION::Crypto::garbling;
 
@@ -96,6 +97,41 @@ TEST(half_gates, batch_garble_eval) {
   }
 }
 
+TEST(half_gates, batch_matches_single) {
+  HalfGateGarbler garbler;
+  HalfGateEvaluator evaluator(garbler.get_public_data());
+
+  // not a multiple of the hashing batch size
+  const std::size_t size = 37;
+  auto key_as = ENCRYPTO::block128_vector::make_random(size);
+  auto key_bs = ENCRYPTO::block128_vector::make_random(size);
+  const std::size_t index = 42;
+
+  ENCRYPTO::block128_vector key_cs_batch(size);
+  ENCRYPTO::block128_vector garbled_tables_batch(2 * size);
+  garbler.batch_garble_and(key_cs_batch, garbled_tables_batch.data(), index, key_as, key_bs);
+  ENCRYPTO::block128_vector key_cs_omp(size);
+  ENCRYPTO::block128_vector garbled_tables_omp(2 * size);
+  garbler.batch_garble_and_omp(key_cs_omp.data(), garbled_tables_omp.data(), index,
+                               key_as.data(), key_bs.data(), size);
+
+  ENCRYPTO::block128_vector key_cs_eval(size);
+  evaluator.batch_evaluate_and(key_cs_eval, garbled_tables_batch.data(), index, key_as, key_bs);
+  for (std::size_t i = 0; i < size; ++i) {
+    ENCRYPTO::block128_t key_c;
+    std::array<ENCRYPTO::block128_t, 2> garbled_table;
+    garbler.garble_and(key_c, garbled_table.data(), index + i, key_as[i], key_bs[i]);
+    EXPECT_EQ(key_cs_batch[i], key_c);
+    EXPECT_EQ(key_cs_omp[i], key_c);
+    EXPECT_EQ(garbled_tables_omp[2 * i], garbled_table[0]);
+    EXPECT_EQ(garbled_tables_omp[2 * i + 1], garbled_table[1]);
+    EXPECT_EQ(garbled_tables_batch[2 * i], garbled_table[0]);
+    EXPECT_EQ(garbled_tables_batch[2 * i + 1], garbled_table[1]);
+    evaluator.evaluate_and(key_c, garbled_table.data(), index + i, key_as[i], key_bs[i]);
+    EXPECT_EQ(key_cs_eval[i], key_c);
+  }
+}
+
 TEST(half_gates, circuit_garble_eval) {
   HalfGateGarbler garbler;
   HalfGateEvaluator evaluator(garbler.get_public_data());
@@ -185,3 +221,129 @@ TEST(half_gates, circuit_garble_eval_batch) {
     }
   }
 }
+
+TEST(three_halves, batch_garble_eval) {
+  HalfGateGarbler hg_garbler;
+  const auto offset = hg_garbler.get_offset();
+  ThreeHalvesGarbler garbler(offset, hg_garbler.get_public_data());
+  ThreeHalvesEvaluator evaluator(hg_garbler.get_public_data());
+
+  // sizes that do not fill the last batch or the last block of the garbled tables
+  for (std::size_t size : {1, 2, 37, 1024}) {
+    auto key_as = ENCRYPTO::block128_vector::make_random(size);
+    auto key_bs = ENCRYPTO::block128_vector::make_random(size);
+    const std::size_t index = 42;
+
+    ENCRYPTO::block128_vector key_cs_original(size);
+    ENCRYPTO::block128_vector garbled_tables(three_halves_table_size(size));
+    garbler.batch_garble_and(key_cs_original, garbled_tables.data(), index, key_as, key_bs);
+
+    // try every combination of inputs
+    for (std::size_t choice = 0; choice < 4; ++choice) {
+      const bool bit_a = choice & 1;
+      const bool bit_b = choice & 2;
+      auto key_as_chosen = bit_a ? key_as ^ offset : key_as;
+      auto key_bs_chosen = bit_b ? key_bs ^ offset : key_bs;
+      ENCRYPTO::block128_vector key_cs(size);
+      evaluator.batch_evaluate_and(key_cs, garbled_tables.data(), index, key_as_chosen,
+                                   key_bs_chosen);
+      for (std::size_t i = 0; i < size; ++i) {
+        if (bit_a && bit_b) {
+          EXPECT_EQ(key_cs[i], key_cs_original[i] ^ offset);
+        } else {
+          EXPECT_EQ(key_cs[i], key_cs_original[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(three_halves, batch_garble_eval_omp) {
+  HalfGateGarbler hg_garbler;
+  const auto offset = hg_garbler.get_offset();
+  ThreeHalvesGarbler garbler(offset, hg_garbler.get_public_data());
+  ThreeHalvesEvaluator evaluator(hg_garbler.get_public_data());
+
+  const std::size_t size = 1000;
+  auto key_as = ENCRYPTO::block128_vector::make_random(size);
+  auto key_bs = ENCRYPTO::block128_vector::make_random(size);
+  const std::size_t index = 42;
+
+  ENCRYPTO::block128_vector key_cs_original(size);
+  ENCRYPTO::block128_vector garbled_tables(three_halves_table_size(size));
+  garbler.batch_garble_and_omp(key_cs_original.data(), garbled_tables.data(), index,
+                               key_as.data(), key_bs.data(), size);
+
+  std::minstd_rand gen_a(0x61);
+  std::minstd_rand gen_b(0x62);
+  std::uniform_int_distribution dist(0, 1);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    if (dist(gen_a) == 1) key_as[i] ^= offset;
+    if (dist(gen_b) == 1) key_bs[i] ^= offset;
+  }
+
+  ENCRYPTO::block128_vector key_cs(size);
+  evaluator.batch_evaluate_and_omp(key_cs.data(), garbled_tables.data(), index, key_as.data(),
+                                   key_bs.data(), size);
+  gen_a.seed(0x61);
+  gen_b.seed(0x62);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    if (dist(gen_a) + dist(gen_b) == 2)
+      EXPECT_EQ(key_cs[i], key_cs_original[i] ^ offset);
+    else
+      EXPECT_EQ(key_cs[i], key_cs_original[i]);
+  }
+}
+
+TEST(three_halves, batch_garble_eval_range) {
+  HalfGateGarbler hg_garbler;
+  const auto offset = hg_garbler.get_offset();
+  ThreeHalvesGarbler garbler(offset, hg_garbler.get_public_data());
+  ThreeHalvesEvaluator evaluator(hg_garbler.get_public_data());
+
+  const std::size_t size = 1001;
+  const std::size_t chunk_size = 104;
+  auto key_as = ENCRYPTO::block128_vector::make_random(size);
+  auto key_bs = ENCRYPTO::block128_vector::make_random(size);
+  const std::size_t index = 42;
+
+  // garble the ranges in reverse order, they need to form the tables of the whole batch
+  ENCRYPTO::block128_vector key_cs_original(size);
+  ENCRYPTO::block128_vector garbled_tables(three_halves_table_size(size));
+  for (std::size_t begin = (size - 1) / chunk_size * chunk_size;; begin -= chunk_size) {
+    garbler.batch_garble_and_range(key_cs_original.data(), garbled_tables.data(), index,
+                                   key_as.data(), key_bs.data(), size, begin,
+                                   std::min(size, begin + chunk_size));
+    if (begin == 0) break;
+  }
+
+  std::minstd_rand gen_a(0x61);
+  std::minstd_rand gen_b(0x62);
+  std::uniform_int_distribution dist(0, 1);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    if (dist(gen_a) == 1) key_as[i] ^= offset;
+    if (dist(gen_b) == 1) key_bs[i] ^= offset;
+  }
+
+  ENCRYPTO::block128_vector key_cs_batch(size);
+  evaluator.batch_evaluate_and(key_cs_batch.data(), garbled_tables.data(), index, key_as.data(),
+                               key_bs.data(), size);
+  ENCRYPTO::block128_vector key_cs_range(size);
+  for (std::size_t begin = 0; begin < size; begin += chunk_size) {
+    evaluator.batch_evaluate_and_range(key_cs_range.data(), garbled_tables.data(), index,
+                                       key_as.data(), key_bs.data(), size, begin,
+                                       std::min(size, begin + chunk_size));
+  }
+  gen_a.seed(0x61);
+  gen_b.seed(0x62);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    const auto expected = dist(gen_a) + dist(gen_b) == 2 ? key_cs_original[i] ^ offset
+                                                          : key_cs_original[i];
+    EXPECT_EQ(key_cs_batch[i], expected);
+    EXPECT_EQ(key_cs_range[i], expected);
+  }
+}
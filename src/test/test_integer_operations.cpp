@@ -931,4 +931,130 @@ TYPED_TEST(SecureUintTest, GreaterThanInBMR) {
     if (tt.joinable()) tt.join();
 }
 
+TYPED_TEST(SecureUintTest, NativeDivisionInGMW) {
+  using T = TypeParam;
+  using namespace MOTION;
+  constexpr auto GMW = MOTION::MPCProtocol::BooleanGMW;
+  std::mt19937 g(sizeof(T));
+  // the native circuit divides unsigned integers, so the full range can be used
+  std::uniform_int_distribution<T> dist(0, std::numeric_limits<T>::max());
+  std::uniform_int_distribution<T> dist_divisor(1, std::numeric_limits<T>::max() / 10);
+  auto r = std::bind(dist, g);
+  auto r_divisor = std::bind(dist_divisor, g);
+  constexpr T max = std::numeric_limits<T>::max();
+  // divisor larger than the dividend, equal values, division by one and by zero
+  const std::vector<std::vector<T>> raw_global_input_simd{{r(), r(), 3, max, max, 7, r()},
+                                                          {r_divisor(), max, 3, 1, max, 0, r()}};
+  constexpr auto n_wires{sizeof(T) * 8};
+  const auto n_simd{raw_global_input_simd.at(0).size()};
+  std::vector<std::vector<ENCRYPTO::BitVector<>>> global_input_simd{
+      ENCRYPTO::ToInput(raw_global_input_simd.at(0)),
+      ENCRYPTO::ToInput(raw_global_input_simd.at(1))};
+  std::vector<ENCRYPTO::BitVector<>> dummy_input_simd(n_wires,
+                                                      ENCRYPTO::BitVector<>(n_simd, false));
+
+  std::vector<PartyPtr> motion_parties(std::move(GetNLocalParties(2, PORT_OFFSET)));
+  for (auto &p : motion_parties) {
+    p->GetLogger()->SetEnabled(DETAILED_LOGGING_ENABLED);
+    p->GetConfiguration()->SetOnlineAfterSetup(true);
+  }
+  std::vector<std::thread> t;
+  for (auto party_id = 0u; party_id < motion_parties.size(); ++party_id) {
+    t.emplace_back([party_id, &motion_parties, n_wires, &global_input_simd, &dummy_input_simd,
+                    &raw_global_input_simd]() {
+      const bool party_0 = motion_parties.at(party_id)->GetConfiguration()->GetMyId() == 0;
+      MOTION::SecureUnsignedInteger s_0 = party_0 ? motion_parties.at(party_id)->IN<GMW>(
+                                                        global_input_simd.at(0), 0)
+                                                  : motion_parties.at(party_id)->IN<GMW>(
+                                                        dummy_input_simd, 0),
+                                    s_1 = party_0 ? motion_parties.at(party_id)->IN<GMW>(
+                                                        dummy_input_simd, 1)
+                                                  : motion_parties.at(party_id)->IN<GMW>(
+                                                        global_input_simd.at(1), 1);
+
+      const auto s_div = s_0.Divide(s_1, MOTION::IntegerAlgorithm::Native);
+      EXPECT_EQ(s_div.Get()->GetBitLength(), n_wires);
+      auto s_out = s_div.Get().Out();
+
+      motion_parties.at(party_id)->Run();
+
+      std::vector<T> div_check;
+      for (std::size_t i = 0; i < raw_global_input_simd.at(0).size(); ++i) {
+        const auto a = raw_global_input_simd.at(0).at(i);
+        const auto b = raw_global_input_simd.at(1).at(i);
+        div_check.emplace_back(b == 0 ? std::numeric_limits<T>::max() : T(a / b));
+      }
+      std::vector<ENCRYPTO::BitVector<>> out;
+      for (auto i = 0ull; i < n_wires; ++i) {
+        auto wire_single =
+            std::dynamic_pointer_cast<MOTION::Wires::GMWWire>(s_out->GetWires().at(i));
+        assert(wire_single);
+        out.emplace_back(wire_single->GetValues());
+      }
+      EXPECT_EQ(ENCRYPTO::ToVectorOutput<T>(out), div_check);
+      motion_parties.at(party_id)->Finish();
+    });
+  }
+  for (auto &tt : t)
+    if (tt.joinable()) tt.join();
+}
+
+TYPED_TEST(SecureUintTest, NativeGreaterThanInBMR) {
+  using T = TypeParam;
+  using namespace MOTION;
+  constexpr auto BMR = MOTION::MPCProtocol::BMR;
+  std::mt19937 g(sizeof(T));
+  std::uniform_int_distribution<T> dist(0, std::numeric_limits<T>::max());
+  auto r = std::bind(dist, g);
+  constexpr T max = std::numeric_limits<T>::max();
+  const std::vector<std::vector<T>> raw_global_input_simd{{r(), r(), r(), 5, max, 0, max},
+                                                          {r(), r(), r(), 5, 0, max, max - 1}};
+  constexpr auto n_wires{sizeof(T) * 8};
+  const auto n_simd{raw_global_input_simd.at(0).size()};
+  std::vector<std::vector<ENCRYPTO::BitVector<>>> global_input_simd{
+      ENCRYPTO::ToInput(raw_global_input_simd.at(0)),
+      ENCRYPTO::ToInput(raw_global_input_simd.at(1))};
+  std::vector<ENCRYPTO::BitVector<>> dummy_input_simd(n_wires,
+                                                      ENCRYPTO::BitVector<>(n_simd, false));
+
+  std::vector<PartyPtr> motion_parties(std::move(GetNLocalParties(2, PORT_OFFSET)));
+  for (auto &p : motion_parties) {
+    p->GetLogger()->SetEnabled(DETAILED_LOGGING_ENABLED);
+    p->GetConfiguration()->SetOnlineAfterSetup(true);
+  }
+  std::vector<std::thread> t;
+  for (auto party_id = 0u; party_id < motion_parties.size(); ++party_id) {
+    t.emplace_back([party_id, &motion_parties, n_simd, &global_input_simd, &dummy_input_simd,
+                    &raw_global_input_simd]() {
+      const bool party_0 = motion_parties.at(party_id)->GetConfiguration()->GetMyId() == 0;
+      MOTION::SecureUnsignedInteger s_0 = party_0 ? motion_parties.at(party_id)->IN<BMR>(
+                                                        global_input_simd.at(0), 0)
+                                                  : motion_parties.at(party_id)->IN<BMR>(
+                                                        dummy_input_simd, 0),
+                                    s_1 = party_0 ? motion_parties.at(party_id)->IN<BMR>(
+                                                        dummy_input_simd, 1)
+                                                  : motion_parties.at(party_id)->IN<BMR>(
+                                                        global_input_simd.at(1), 1);
+
+      const auto s_gt = s_0.GreaterThan(s_1, MOTION::IntegerAlgorithm::Native);
+      auto s_out = s_gt.Out();
+      assert(s_out->GetBitLength() == 1);
+
+      motion_parties.at(party_id)->Run();
+
+      auto wire_single = std::dynamic_pointer_cast<MOTION::Wires::BMRWire>(s_out->GetWires().at(0));
+      assert(wire_single);
+      for (std::size_t i = 0; i < n_simd; ++i) {
+        const bool result_check =
+            raw_global_input_simd.at(0).at(i) > raw_global_input_simd.at(1).at(i);
+        EXPECT_EQ(wire_single->GetPublicValues().Get(i), result_check);
+      }
+
+      motion_parties.at(party_id)->Finish();
+    });
+  }
+  for (auto &tt : t)
+    if (tt.joinable()) tt.join();
+}
+
 }  // namespace
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <array>
 #include <iterator>
 #include <memory>
 
@@ -80,6 +81,9 @@ class LinAlgTripleProviderTest : public ::testing::Test {
 
   void run_setup() {
     std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      linalg_triple_providers_[i]->presetup();
+    }
     for (std::size_t i = 0; i < 2; ++i) {
       futs.emplace_back(std::async(std::launch::async, [this, i] {
         ot_provider_managers_[i]->get_provider(1 - i).SendSetup();
@@ -188,6 +192,69 @@ TYPED_TEST(LinAlgTripleProviderTest, Convolution) {
   ASSERT_EQ(plain_triple.c_, expected_c);
 }
 
+TYPED_TEST(LinAlgTripleProviderTest, BatchedGemmAndConvolution) {
+  const MOTION::tensor::GemmOp gemm_op_1 = {
+      .input_A_shape_ = {3, 5}, .input_B_shape_ = {5, 2}, .output_shape_ = {3, 2}};
+  const MOTION::tensor::GemmOp gemm_op_2 = {
+      .input_A_shape_ = {1, 4}, .input_B_shape_ = {4, 6}, .output_shape_ = {1, 6}};
+  const MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {2, 1, 3, 3},
+                                            .input_shape_ = {1, 6, 6},
+                                            .output_shape_ = {2, 4, 4},
+                                            .dilations_ = {1, 1},
+                                            .pads_ = {0, 0, 0, 0},
+                                            .strides_ = {1, 1}};
+  ASSERT_TRUE(gemm_op_1.verify());
+  ASSERT_TRUE(gemm_op_2.verify());
+  ASSERT_TRUE(conv_op.verify());
+  const std::size_t num_triples = 5;
+
+  // interleave the shapes, all triples of a shape are generated in one batch
+  std::vector<std::array<std::size_t, 2>> gemm_indices_1, gemm_indices_2, conv_indices;
+  for (std::size_t t_i = 0; t_i < num_triples; ++t_i) {
+    for (auto [op, indices] : {std::make_pair(&gemm_op_1, &gemm_indices_1),
+                               std::make_pair(&gemm_op_2, &gemm_indices_2)}) {
+      auto& idx = indices->emplace_back();
+      for (std::size_t i = 0; i < 2; ++i) {
+        idx[i] = this->linalg_triple_providers_[i]->template register_for_gemm_triple<TypeParam>(
+            *op);
+      }
+    }
+    auto& idx = conv_indices.emplace_back();
+    for (std::size_t i = 0; i < 2; ++i) {
+      idx[i] = this->linalg_triple_providers_[i]->template register_for_conv2d_triple<TypeParam>(
+          conv_op);
+    }
+  }
+
+  this->run_setup();
+
+  for (auto [op, indices] : {std::make_pair(&gemm_op_1, &gemm_indices_1),
+                             std::make_pair(&gemm_op_2, &gemm_indices_2)}) {
+    for (const auto& idx : *indices) {
+      auto triple_0 =
+          this->linalg_triple_providers_[0]->template get_gemm_triple<TypeParam>(*op, idx[0]);
+      auto triple_1 =
+          this->linalg_triple_providers_[1]->template get_gemm_triple<TypeParam>(*op, idx[1]);
+      auto a = MOTION::Helpers::AddVectors(triple_0.a_, triple_1.a_);
+      auto b = MOTION::Helpers::AddVectors(triple_0.b_, triple_1.b_);
+      auto c = MOTION::Helpers::AddVectors(triple_0.c_, triple_1.c_);
+      auto expected_c = MOTION::matrix_multiply(op->input_A_shape_[0], op->input_A_shape_[1],
+                                                op->output_shape_[1], a, b);
+      ASSERT_EQ(c, expected_c);
+    }
+  }
+  for (const auto& idx : conv_indices) {
+    auto triple_0 =
+        this->linalg_triple_providers_[0]->template get_conv2d_triple<TypeParam>(conv_op, idx[0]);
+    auto triple_1 =
+        this->linalg_triple_providers_[1]->template get_conv2d_triple<TypeParam>(conv_op, idx[1]);
+    auto a = MOTION::Helpers::AddVectors(triple_0.a_, triple_1.a_);
+    auto b = MOTION::Helpers::AddVectors(triple_0.b_, triple_1.b_);
+    auto c = MOTION::Helpers::AddVectors(triple_0.c_, triple_1.c_);
+    ASSERT_EQ(c, MOTION::convolution(conv_op, a, b));
+  }
+}
+
 TYPED_TEST(LinAlgTripleProviderTest, ReLU) {
   std::size_t num_triples = 100;
   constexpr auto bit_size = ENCRYPTO::bit_size_v<TypeParam>;
@@ -230,3 +297,51 @@ TYPED_TEST(LinAlgTripleProviderTest, ReLU) {
   }
   ASSERT_EQ(plain_triple.c_, expected_c);
 }
+
+TYPED_TEST(LinAlgTripleProviderTest, TriplePool) {
+  const MOTION::tensor::GemmOp gemm_op = {
+      .input_A_shape_ = {3, 5}, .input_B_shape_ = {5, 2}, .output_shape_ = {3, 2}};
+  ASSERT_TRUE(gemm_op.verify());
+  const std::size_t num_spare = 2;
+  std::array<std::shared_ptr<MOTION::LinAlgTriplePool>, 2> pools;
+  for (std::size_t i = 0; i < 2; ++i) {
+    pools[i] = std::make_shared<MOTION::LinAlgTriplePool>();
+    this->linalg_triple_providers_[i]->set_triple_pool(pools[i], num_spare);
+  }
+
+  const auto check_triple = [&gemm_op](auto& providers, const auto& idx) {
+    auto triple_0 = providers[0]->template get_gemm_triple<TypeParam>(gemm_op, idx[0]);
+    auto triple_1 = providers[1]->template get_gemm_triple<TypeParam>(gemm_op, idx[1]);
+    auto a = MOTION::Helpers::AddVectors(triple_0.a_, triple_1.a_);
+    auto b = MOTION::Helpers::AddVectors(triple_0.b_, triple_1.b_);
+    auto c = MOTION::Helpers::AddVectors(triple_0.c_, triple_1.c_);
+    auto expected_c = MOTION::matrix_multiply(gemm_op.input_A_shape_[0], gemm_op.input_A_shape_[1],
+                                              gemm_op.output_shape_[1], a, b);
+    EXPECT_EQ(c, expected_c);
+  };
+
+  // the first run generates the spare triples for the next ones
+  std::array<std::size_t, 2> idx;
+  for (std::size_t i = 0; i < 2; ++i) {
+    idx[i] = this->linalg_triple_providers_[i]->template register_for_gemm_triple<TypeParam>(
+        gemm_op);
+  }
+  this->run_setup();
+  check_triple(this->linalg_triple_providers_, idx);
+  ASSERT_EQ(pools[0]->size(), num_spare);
+  ASSERT_EQ(pools[1]->size(), num_spare);
+
+  // later runs only take them from the pool, fake triples would not be valid
+  for (std::size_t run_i = 0; run_i < num_spare; ++run_i) {
+    std::array<std::unique_ptr<MOTION::LinAlgTripleProvider>, 2> providers;
+    for (std::size_t i = 0; i < 2; ++i) {
+      providers[i] = std::make_unique<MOTION::FakeLinAlgTripleProvider>();
+      providers[i]->set_triple_pool(pools[i], num_spare);
+      idx[i] = providers[i]->template register_for_gemm_triple<TypeParam>(gemm_op);
+      providers[i]->setup();
+    }
+    check_triple(providers, idx);
+    ASSERT_EQ(pools[0]->size(), num_spare - run_i - 1);
+    ASSERT_EQ(pools[1]->size(), num_spare - run_i - 1);
+  }
+}
@@ -21,7 +21,12 @@
 // SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <tuple>
 #include "tensor/tensor_op.h"
 #include "utility/linear_algebra.h"
 
@@ -256,3 +261,470 @@ TEST(LinearAlgebra, SumPool2) {
   MOTION::sum_pool(avgpool_op, input.data(), output.data());
   ASSERT_EQ(output, expected_output);
 }
+
+template <typename T>
+static std::vector<T> random_vector(std::size_t size, std::mt19937_64& rng) {
+  std::vector<T> v(size);
+  std::generate(std::begin(v), std::end(v), [&rng] { return static_cast<T>(rng()); });
+  return v;
+}
+
+// straightforward convolution with explicit zero padding as a reference
+template <typename T>
+static std::vector<T> naive_convolution(const MOTION::tensor::Conv2DOp& conv_op,
+                                        const std::vector<T>& input, const std::vector<T>& kernel) {
+  const auto [in_channels, in_rows, in_columns] = conv_op.input_shape_;
+  const auto [out_channels, out_rows, out_columns] = conv_op.output_shape_;
+  const auto kernel_rows = conv_op.kernel_shape_[2];
+  const auto kernel_columns = conv_op.kernel_shape_[3];
+  std::vector<T> output(conv_op.compute_output_size());
+  for (std::size_t oc = 0; oc < out_channels; ++oc) {
+    for (std::size_t oh = 0; oh < out_rows; ++oh) {
+      for (std::size_t ow = 0; ow < out_columns; ++ow) {
+        std::uint64_t sum = 0;
+        for (std::size_t ic = 0; ic < in_channels; ++ic) {
+          for (std::size_t kh = 0; kh < kernel_rows; ++kh) {
+            for (std::size_t kw = 0; kw < kernel_columns; ++kw) {
+              // unsigned wrap around for positions in the padding
+              const std::size_t ih = oh * conv_op.strides_[0] + kh - conv_op.pads_[0];
+              const std::size_t iw = ow * conv_op.strides_[1] + kw - conv_op.pads_[1];
+              if (ih >= in_rows || iw >= in_columns) {
+                continue;
+              }
+              sum += std::uint64_t(input[(ic * in_rows + ih) * in_columns + iw]) *
+                     kernel[((oc * in_channels + ic) * kernel_rows + kh) * kernel_columns + kw];
+            }
+          }
+        }
+        output[(oc * out_rows + oh) * out_columns + ow] = static_cast<T>(sum);
+      }
+    }
+  }
+  return output;
+}
+
+TEST(LinearAlgebra, Conv2DPaddedAndStrided) {
+  std::mt19937_64 rng(1);
+  // {kernel_shape, input_shape, pads, strides}
+  const std::vector<std::tuple<std::array<std::size_t, 4>, std::array<std::size_t, 3>,
+                               std::array<std::size_t, 4>, std::array<std::size_t, 2>>>
+      configs = {{{5, 1, 5, 5}, {1, 28, 28}, {1, 1, 0, 0}, {2, 2}},
+                 {{11, 3, 3, 2}, {3, 9, 13}, {2, 0, 1, 1}, {1, 3}},
+                 {{4, 2, 1, 4}, {2, 7, 10}, {0, 2, 2, 0}, {3, 1}},
+                 {{9, 4, 3, 3}, {4, 12, 12}, {1, 1, 1, 1}, {1, 1}}};
+  for (const auto& [kernel_shape, input_shape, pads, strides] : configs) {
+    MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = kernel_shape,
+                                        .input_shape_ = input_shape,
+                                        .dilations_ = {1, 1},
+                                        .pads_ = pads,
+                                        .strides_ = strides};
+    conv_op.output_shape_ = conv_op.compute_output_shape();
+    ASSERT_TRUE(conv_op.verify());
+    const auto input_8 = random_vector<std::uint8_t>(conv_op.compute_input_size(), rng);
+    const auto kernel_8 = random_vector<std::uint8_t>(conv_op.compute_kernel_size(), rng);
+    EXPECT_EQ(MOTION::convolution(conv_op, input_8, kernel_8),
+              naive_convolution(conv_op, input_8, kernel_8));
+    const auto input_16 = random_vector<std::uint16_t>(conv_op.compute_input_size(), rng);
+    const auto kernel_16 = random_vector<std::uint16_t>(conv_op.compute_kernel_size(), rng);
+    EXPECT_EQ(MOTION::convolution(conv_op, input_16, kernel_16),
+              naive_convolution(conv_op, input_16, kernel_16));
+    const auto input_64 = random_vector<std::uint64_t>(conv_op.compute_input_size(), rng);
+    const auto kernel_64 = random_vector<std::uint64_t>(conv_op.compute_kernel_size(), rng);
+    EXPECT_EQ(MOTION::convolution(conv_op, input_64, kernel_64),
+              naive_convolution(conv_op, input_64, kernel_64));
+
+    const auto memory = MOTION::get_convolution_memory(conv_op, sizeof(std::uint64_t));
+    const auto output_size = conv_op.compute_output_size();
+    EXPECT_EQ(memory.peak_bytes, (input_64.size() + kernel_64.size() + output_size) * 8);
+    const auto [input_matrix_rows, input_matrix_columns] = conv_op.compute_input_matrix_shape();
+    EXPECT_EQ(memory.im2col_bytes, input_matrix_rows * input_matrix_columns * 8);
+  }
+}
+
+TEST(LinearAlgebra, Conv2DWinograd) {
+  std::mt19937_64 rng(3);
+  // {kernel_shape, input_shape, pads, batch_size}, with partial tiles at the borders
+  const std::vector<std::tuple<std::array<std::size_t, 4>, std::array<std::size_t, 3>,
+                               std::array<std::size_t, 4>, std::size_t>>
+      configs = {{{9, 4, 3, 3}, {4, 12, 12}, {1, 1, 1, 1}, 1},
+                 {{3, 2, 3, 3}, {2, 11, 9}, {0, 0, 0, 0}, 2},
+                 {{17, 3, 3, 3}, {3, 7, 10}, {2, 1, 0, 2}, 1},
+                 {{5, 1, 3, 3}, {1, 4, 5}, {0, 0, 0, 0}, 3}};
+  for (const auto& [kernel_shape, input_shape, pads, batch_size] : configs) {
+    MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = kernel_shape,
+                                        .input_shape_ = input_shape,
+                                        .dilations_ = {1, 1},
+                                        .pads_ = pads,
+                                        .strides_ = {1, 1}};
+    conv_op.output_shape_ = conv_op.compute_output_shape();
+    ASSERT_TRUE(conv_op.verify());
+    const bool large_output = conv_op.output_shape_[1] >= 4 && conv_op.output_shape_[2] >= 4;
+    EXPECT_EQ(MOTION::get_convolution_algorithm<std::uint32_t>(conv_op),
+              large_output ? MOTION::ConvolutionAlgorithm::winograd_4x4
+                           : MOTION::ConvolutionAlgorithm::winograd_2x2);
+    EXPECT_EQ(MOTION::get_convolution_algorithm<std::uint64_t>(conv_op),
+              MOTION::ConvolutionAlgorithm::direct);
+    EXPECT_EQ(MOTION::get_convolution_algorithm<std::uint16_t>(conv_op),
+              MOTION::ConvolutionAlgorithm::direct);
+
+    const auto check = [&conv_op, &rng, batch_size = batch_size](auto dummy) {
+      using T = decltype(dummy);
+      const auto sample_op = conv_op;
+      auto batch_op = conv_op;
+      batch_op.batch_size_ = batch_size;
+      const auto input = random_vector<T>(batch_op.compute_input_size(), rng);
+      const auto kernel = random_vector<T>(batch_op.compute_kernel_size(), rng);
+      const auto output = MOTION::convolution(batch_op, input, kernel);
+      const auto sample_input_size = sample_op.compute_input_size();
+      const auto sample_output_size = sample_op.compute_output_size();
+      for (std::size_t sample = 0; sample < batch_size; ++sample) {
+        const std::vector<T> sample_input(input.begin() + sample * sample_input_size,
+                                          input.begin() + (sample + 1) * sample_input_size);
+        const std::vector<T> sample_output(output.begin() + sample * sample_output_size,
+                                           output.begin() + (sample + 1) * sample_output_size);
+        EXPECT_EQ(sample_output, naive_convolution(sample_op, sample_input, kernel));
+      }
+      // ranges of units
+      const auto num_units = MOTION::get_convolution_num_units(batch_op);
+      std::vector<T> unit_output(batch_op.compute_output_size());
+      for (std::size_t begin = 0; begin < num_units; begin += 3) {
+        MOTION::convolution(batch_op, input.data(), kernel.data(), unit_output.data(), begin,
+                            std::min(begin + 3, num_units));
+      }
+      EXPECT_EQ(unit_output, output);
+    };
+    check(std::uint32_t{});
+    check(std::uint64_t{});
+  }
+}
+
+TEST(LinearAlgebra, Conv2DBatch) {
+  std::mt19937_64 rng(7);
+  MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {11, 3, 3, 2},
+                                      .input_shape_ = {3, 9, 13},
+                                      .dilations_ = {1, 1},
+                                      .pads_ = {2, 0, 1, 1},
+                                      .strides_ = {1, 3}};
+  conv_op.output_shape_ = conv_op.compute_output_shape();
+  const auto sample_op = conv_op;
+  conv_op.batch_size_ = 5;
+  ASSERT_TRUE(conv_op.verify());
+  ASSERT_EQ(conv_op.compute_input_size(), 5 * sample_op.compute_input_size());
+  ASSERT_EQ(conv_op.compute_output_size(), 5 * sample_op.compute_output_size());
+  ASSERT_EQ(conv_op.get_output_tensor_dims().batch_size_, 5);
+  EXPECT_FALSE(conv_op == sample_op);
+
+  const auto input = random_vector<std::uint32_t>(conv_op.compute_input_size(), rng);
+  const auto kernel = random_vector<std::uint32_t>(conv_op.compute_kernel_size(), rng);
+  const auto output = MOTION::convolution(conv_op, input, kernel);
+  // each sample is convolved with the same kernel
+  const auto input_size = sample_op.compute_input_size();
+  const auto output_size = sample_op.compute_output_size();
+  for (std::size_t sample_i = 0; sample_i < conv_op.batch_size_; ++sample_i) {
+    const std::vector<std::uint32_t> sample_input(
+        std::begin(input) + sample_i * input_size, std::begin(input) + (sample_i + 1) * input_size);
+    const std::vector<std::uint32_t> sample_output(
+        std::begin(output) + sample_i * output_size,
+        std::begin(output) + (sample_i + 1) * output_size);
+    EXPECT_EQ(sample_output, naive_convolution(sample_op, sample_input, kernel));
+  }
+
+  MOTION::set_linear_algebra_num_threads(4);
+  EXPECT_EQ(MOTION::convolution(conv_op, input, kernel), output);
+  MOTION::set_linear_algebra_num_threads(1);
+}
+
+template <typename T>
+static void check_cross_correlation(std::size_t input_size, std::size_t kernel_size,
+                                    std::mt19937_64& rng) {
+  const MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {1, 1, 1, kernel_size},
+                                            .input_shape_ = {1, 1, input_size},
+                                            .output_shape_ = {1, 1, input_size - kernel_size + 1},
+                                            .dilations_ = {1, 1},
+                                            .pads_ = {0, 0, 0, 0},
+                                            .strides_ = {1, 1}};
+  const auto input = random_vector<T>(input_size, rng);
+  const auto kernel = random_vector<T>(kernel_size, rng);
+  std::vector<T> output(input_size - kernel_size + 1);
+  MOTION::cross_correlation(input.data(), input_size, kernel.data(), kernel_size, output.data());
+  EXPECT_EQ(output, MOTION::convolution(conv_op, input, kernel));
+}
+
+TEST(LinearAlgebra, CrossCorrelation) {
+  std::mt19937_64 rng(3);
+  // short kernels are applied directly, long ones with NTTs, which are exact modulo 2^64, too,
+  // also if the kernel covers the whole input or the blocks do not divide the output
+  const auto long_kernel = MOTION::ntt_correlation_threshold;
+  const std::vector<std::pair<std::size_t, std::size_t>> sizes = {
+      {1, 1},
+      {50, 7},
+      {long_kernel, long_kernel},
+      {3000, long_kernel + 3},
+      {5000, 2 * long_kernel}};
+  for (const auto& [input_size, kernel_size] : sizes) {
+    check_cross_correlation<std::uint8_t>(input_size, kernel_size, rng);
+    check_cross_correlation<std::uint16_t>(input_size, kernel_size, rng);
+    check_cross_correlation<std::uint32_t>(input_size, kernel_size, rng);
+    check_cross_correlation<std::uint64_t>(input_size, kernel_size, rng);
+  }
+  std::vector<std::uint64_t> input(4), kernel(5), output(1);
+  EXPECT_THROW(MOTION::cross_correlation(input.data(), 4, kernel.data(), 5, output.data()),
+               std::invalid_argument);
+}
+
+TEST(LinearAlgebra, SumPoolBatch) {
+  MOTION::tensor::AveragePoolOp avgpool_op{
+      .input_shape_ = {1, 4, 4},
+      .output_shape_ = {1, 2, 2},
+      .kernel_shape_ = {2, 2},
+      .strides_ = {2, 2},
+      .batch_size_ = 2,
+  };
+
+  ASSERT_TRUE(avgpool_op.verify());
+  // clang-format off
+  const std::vector<std::uint16_t> input = {
+    45, 26, 35, 59,
+    50, 58, 38,  7,
+     6, 31, 55, 39,
+    15, 13, 43, 25,
+     1,  2,  3,  4,
+     5,  6,  7,  8,
+     9, 10, 11, 12,
+    13, 14, 15, 16
+  };
+  const std::vector<std::uint16_t> expected_output = {
+    179, 139,
+     65, 162,
+     14,  22,
+     46,  54
+  };
+  // clang-format on
+  std::vector<std::uint16_t> output(8);
+  ASSERT_EQ(input.size(), avgpool_op.compute_input_size());
+  ASSERT_EQ(output.size(), avgpool_op.compute_output_size());
+  MOTION::sum_pool(avgpool_op, input.data(), output.data());
+  ASSERT_EQ(output, expected_output);
+}
+
+// windows which overlap in one and skip values in the other dimension, on the thread pool
+TEST(LinearAlgebra, SumPoolStrided) {
+  std::mt19937_64 rng(7);
+  MOTION::tensor::AveragePoolOp avgpool_op{
+      .input_shape_ = {5, 33, 40},
+      .kernel_shape_ = {3, 2},
+      .strides_ = {2, 3},
+      .batch_size_ = 20,
+  };
+  avgpool_op.output_shape_ = avgpool_op.compute_output_shape();
+  ASSERT_TRUE(avgpool_op.verify());
+  ASSERT_EQ(avgpool_op.output_shape_, (std::array<std::size_t, 3>{5, 16, 13}));
+  const auto input = random_vector<std::uint64_t>(avgpool_op.compute_input_size(), rng);
+  std::vector<std::uint64_t> expected_output(avgpool_op.compute_output_size());
+  const auto [channels, in_rows, in_columns] = avgpool_op.input_shape_;
+  const auto [out_channels, out_rows, out_columns] = avgpool_op.output_shape_;
+  for (std::size_t c = 0; c < avgpool_op.batch_size_ * channels; ++c) {
+    for (std::size_t i = 0; i < out_rows; ++i) {
+      for (std::size_t j = 0; j < out_columns; ++j) {
+        auto& sum = expected_output.at((c * out_rows + i) * out_columns + j);
+        for (std::size_t k = 0; k < avgpool_op.kernel_shape_[0]; ++k) {
+          for (std::size_t l = 0; l < avgpool_op.kernel_shape_[1]; ++l) {
+            sum += input.at((c * in_rows + 2 * i + k) * in_columns + 3 * j + l);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<std::uint64_t> output(avgpool_op.compute_output_size());
+  MOTION::sum_pool(avgpool_op, input.data(), output.data());
+  EXPECT_EQ(output, expected_output);
+  MOTION::set_linear_algebra_num_threads(4);
+  std::fill(std::begin(output), std::end(output), 0);
+  MOTION::sum_pool(avgpool_op, input.data(), output.data());
+  EXPECT_EQ(output, expected_output);
+  MOTION::set_linear_algebra_num_threads(1);
+}
+
+TEST(LinearAlgebra, ParallelMatchesSerial) {
+  std::mt19937_64 rng(42);
+  const MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {8, 3, 3, 3},
+                                            .input_shape_ = {3, 32, 32},
+                                            .output_shape_ = {8, 30, 30},
+                                            .dilations_ = {1, 1},
+                                            .pads_ = {0, 0, 0, 0},
+                                            .strides_ = {1, 1}};
+  ASSERT_TRUE(conv_op.verify());
+  const auto input = random_vector<std::uint64_t>(conv_op.compute_input_size(), rng);
+  const auto kernel = random_vector<std::uint64_t>(conv_op.compute_kernel_size(), rng);
+  const std::size_t dim_l = 64, dim_m = 48, dim_n = 40;
+  const auto A = random_vector<std::uint32_t>(dim_l * dim_m, rng);
+  const auto B = random_vector<std::uint32_t>(dim_m * dim_n, rng);
+  const auto make_gemm_op = [dim_l, dim_m, dim_n](bool trans_A, bool trans_B) {
+    return MOTION::tensor::GemmOp{
+        .input_A_shape_ = {trans_A ? dim_m : dim_l, trans_A ? dim_l : dim_m},
+        .input_B_shape_ = {trans_B ? dim_n : dim_m, trans_B ? dim_m : dim_n},
+        .output_shape_ = {dim_l, dim_n},
+        .transA_ = trans_A,
+        .transB_ = trans_B};
+  };
+  std::vector<std::vector<std::uint32_t>> gemm_outputs;
+  for (bool trans_A : {false, true}) {
+    for (bool trans_B : {false, true}) {
+      const auto gemm_op = make_gemm_op(trans_A, trans_B);
+      ASSERT_TRUE(gemm_op.verify());
+      auto& output = gemm_outputs.emplace_back(dim_l * dim_n);
+      MOTION::matrix_multiply(gemm_op, A.data(), B.data(), output.data());
+    }
+  }
+
+  ASSERT_EQ(MOTION::get_linear_algebra_num_threads(), 1);
+  const auto expected_conv = MOTION::convolution(conv_op, input, kernel);
+  const auto expected_matmul = MOTION::matrix_multiply(dim_l, dim_m, dim_n, A, B);
+
+  MOTION::set_linear_algebra_num_threads(4);
+  EXPECT_EQ(MOTION::get_linear_algebra_num_threads(), 4);
+  EXPECT_EQ(MOTION::convolution(conv_op, input, kernel), expected_conv);
+  EXPECT_EQ(MOTION::matrix_multiply(dim_l, dim_m, dim_n, A, B), expected_matmul);
+  std::size_t gemm_i = 0;
+  for (bool trans_A : {false, true}) {
+    for (bool trans_B : {false, true}) {
+      std::vector<std::uint32_t> output(dim_l * dim_n);
+      MOTION::matrix_multiply(make_gemm_op(trans_A, trans_B), A.data(), B.data(), output.data());
+      EXPECT_EQ(output, gemm_outputs.at(gemm_i++));
+    }
+  }
+  MOTION::set_linear_algebra_num_threads(1);
+  EXPECT_THROW(MOTION::set_linear_algebra_num_threads(0), std::invalid_argument);
+}
+
+TEST(LinearAlgebra, GpuMatchesCpu) {
+  if (!MOTION::is_linear_algebra_gpu_available()) {
+    EXPECT_THROW(MOTION::set_linear_algebra_gpu_min_work(1), std::logic_error);
+    GTEST_SKIP() << "no GPU available";
+  }
+  std::mt19937_64 rng(23);
+  MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {11, 3, 3, 2},
+                                      .input_shape_ = {3, 9, 13},
+                                      .dilations_ = {2, 1},
+                                      .pads_ = {2, 0, 1, 1},
+                                      .strides_ = {1, 3}};
+  conv_op.output_shape_ = conv_op.compute_output_shape();
+  conv_op.batch_size_ = 2;
+  ASSERT_TRUE(conv_op.verify());
+  const auto input = random_vector<std::uint32_t>(conv_op.compute_input_size(), rng);
+  const auto kernel = random_vector<std::uint32_t>(conv_op.compute_kernel_size(), rng);
+  const std::size_t dim_l = 37, dim_m = 21, dim_n = 19;
+  const auto A = random_vector<std::uint64_t>(dim_l * dim_m, rng);
+  const auto B = random_vector<std::uint64_t>(dim_m * dim_n, rng);
+  const auto make_gemm_op = [dim_l, dim_m, dim_n](bool trans_A, bool trans_B) {
+    return MOTION::tensor::GemmOp{
+        .input_A_shape_ = {trans_A ? dim_m : dim_l, trans_A ? dim_l : dim_m},
+        .input_B_shape_ = {trans_B ? dim_n : dim_m, trans_B ? dim_m : dim_n},
+        .output_shape_ = {dim_l, dim_n},
+        .transA_ = trans_A,
+        .transB_ = trans_B};
+  };
+  const auto expected_conv = MOTION::convolution(conv_op, input, kernel);
+  std::vector<std::vector<std::uint64_t>> expected_gemm;
+  for (bool trans_A : {false, true}) {
+    for (bool trans_B : {false, true}) {
+      auto& output = expected_gemm.emplace_back(dim_l * dim_n);
+      MOTION::matrix_multiply(make_gemm_op(trans_A, trans_B), A.data(), B.data(), output.data());
+    }
+  }
+
+  MOTION::set_linear_algebra_gpu_min_work(1);
+  EXPECT_TRUE(MOTION::is_offloaded_to_gpu<std::uint32_t>(conv_op));
+  EXPECT_FALSE(MOTION::is_offloaded_to_gpu<std::uint16_t>(conv_op));
+  EXPECT_EQ(MOTION::convolution(conv_op, input, kernel), expected_conv);
+  std::size_t gemm_i = 0;
+  for (bool trans_A : {false, true}) {
+    for (bool trans_B : {false, true}) {
+      std::vector<std::uint64_t> output(dim_l * dim_n);
+      MOTION::matrix_multiply(make_gemm_op(trans_A, trans_B), A.data(), B.data(), output.data());
+      EXPECT_EQ(output, expected_gemm.at(gemm_i++));
+    }
+  }
+  MOTION::set_linear_algebra_gpu_min_work(0);
+  EXPECT_FALSE(MOTION::is_offloaded_to_gpu<std::uint32_t>(conv_op));
+}
+
+TEST(LinearAlgebra, PartialMatchesFull) {
+  std::mt19937_64 rng(11);
+  MOTION::tensor::Conv2DOp conv_op = {.kernel_shape_ = {11, 3, 3, 2},
+                                      .input_shape_ = {3, 9, 13},
+                                      .dilations_ = {1, 1},
+                                      .pads_ = {2, 0, 1, 1},
+                                      .strides_ = {1, 3}};
+  conv_op.output_shape_ = conv_op.compute_output_shape();
+  conv_op.batch_size_ = 2;
+  ASSERT_TRUE(conv_op.verify());
+  const auto input = random_vector<std::uint32_t>(conv_op.compute_input_size(), rng);
+  const auto kernel = random_vector<std::uint32_t>(conv_op.compute_kernel_size(), rng);
+  const auto expected_conv = MOTION::convolution(conv_op, input, kernel);
+  // uneven ranges of units, which together cover the output
+  const auto num_units = MOTION::get_convolution_num_units(conv_op);
+  std::vector<std::uint32_t> conv_output(conv_op.compute_output_size());
+  for (std::size_t begin = 0; begin < num_units; begin += 5) {
+    MOTION::convolution(conv_op, input.data(), kernel.data(), conv_output.data(), begin,
+                        std::min(begin + 5, num_units));
+  }
+  EXPECT_EQ(conv_output, expected_conv);
+
+  const std::size_t dim_l = 7, dim_m = 5, dim_n = 9;
+  const auto A = random_vector<std::uint64_t>(dim_l * dim_m, rng);
+  const auto B = random_vector<std::uint64_t>(dim_m * dim_n, rng);
+  for (bool trans_A : {false, true}) {
+    for (bool trans_B : {false, true}) {
+      const MOTION::tensor::GemmOp gemm_op = {
+          .input_A_shape_ = {trans_A ? dim_m : dim_l, trans_A ? dim_l : dim_m},
+          .input_B_shape_ = {trans_B ? dim_n : dim_m, trans_B ? dim_m : dim_n},
+          .output_shape_ = {dim_l, dim_n},
+          .transA_ = trans_A,
+          .transB_ = trans_B};
+      std::vector<std::uint64_t> expected_output(dim_l * dim_n);
+      MOTION::matrix_multiply(gemm_op, A.data(), B.data(), expected_output.data());
+      std::vector<std::uint64_t> output(dim_l * dim_n);
+      for (std::size_t row = 0; row < dim_l; row += 3) {
+        for (std::size_t column = 0; column < dim_n; column += 4) {
+          MOTION::matrix_multiply(gemm_op, A.data(), B.data(), output.data(), row,
+                                  std::min(row + 3, dim_l), column, std::min(column + 4, dim_n));
+        }
+      }
+      EXPECT_EQ(output, expected_output);
+    }
+  }
+}
+
+TEST(LinearAlgebra, SparseMatrixMultiply) {
+  std::mt19937_64 rng(42);
+  const std::size_t dim_l = 300, dim_m = 96, dim_n = 80;
+  const auto A = random_vector<std::uint64_t>(dim_l * dim_m, rng);
+  // only about a tenth of the entries of B are nonzero
+  auto B = random_vector<std::uint64_t>(dim_m * dim_n, rng);
+  std::transform(std::begin(B), std::end(B), std::begin(B),
+                 [&rng](auto b) { return rng() % 10 == 0 ? b : 0; });
+  const auto sparse_B = MOTION::CSRMatrix<std::uint64_t>::from_dense(dim_m, dim_n, B.data());
+  ASSERT_TRUE(sparse_B.verify());
+  EXPECT_EQ(sparse_B.get_num_nonzeros(),
+            dim_m * dim_n - std::count(std::begin(B), std::end(B), 0));
+  EXPECT_EQ(sparse_B.to_dense(), B);
+
+  const auto expected_output = MOTION::matrix_multiply(dim_l, dim_m, dim_n, A, B);
+  std::vector<std::uint64_t> output(dim_l * dim_n, 1);
+  MOTION::matrix_multiply(dim_l, A.data(), sparse_B, output.data());
+  EXPECT_EQ(output, expected_output);
+
+  MOTION::set_linear_algebra_num_threads(4);
+  std::fill(std::begin(output), std::end(output), 1);
+  MOTION::matrix_multiply(dim_l, A.data(), sparse_B, output.data());
+  EXPECT_EQ(output, expected_output);
+  MOTION::set_linear_algebra_num_threads(1);
+
+  auto invalid_B = sparse_B;
+  invalid_B.col_idx_.back() = dim_n;
+  EXPECT_FALSE(invalid_B.verify());
+  invalid_B.row_ptr_.pop_back();
+  EXPECT_FALSE(invalid_B.verify());
+}
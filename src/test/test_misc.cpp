@@ -22,15 +22,73 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <future>
+#include <limits>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
+#include <fmt/format.h>
 #include <gtest/gtest.h>
+#include <boost/fiber/operations.hpp>
+#include <boost/json.hpp>
 
 #include "test_constants.h"
+#include "algorithm/algorithm_description.h"
+#include "algorithm/circuit_loader.h"
+#include "algorithm/circuit_optimizer.h"
+#include "algorithm/edit_distance.h"
+#include "algorithm/nearest_neighbour.h"
+#include "algorithm/pattern_matcher.h"
+#include "algorithm/private_set_intersection.h"
+#include "algorithm/protocol_assignment.h"
+#include "algorithm/query_coalescer.h"
+#include "base/gate_register.h"
+#include "base/scale_out.h"
+#include "communication/communication_layer.h"
+#include "communication/dummy_transport.h"
+#include "communication/emulated_transport.h"
+#include "communication/transport.h"
+#include "crypto/multiplication_triple/mt_provider.h"
+#include "data_storage/mt_store.h"
+#include "data_storage/preprocessing_plan.h"
+#include "data_storage/preprocessing_store.h"
+#include "data_storage/run_checkpoint.h"
+#include "executor/execution_context.h"
+#include "executor/thread_allocator.h"
+#include "gate/new_gate.h"
+#include "protocols/common/message_slot_table.h"
+#include "protocols/common/mul_kernels.h"
+#include "statistics/analysis.h"
+#include "statistics/circuit_analysis.h"
+#include "statistics/gate_profiler.h"
+#include "statistics/hardware_counters.h"
+#include "statistics/metrics.h"
+#include "statistics/performance_baseline.h"
+#include "statistics/trace_recorder.h"
 #include "utility/bit_vector.h"
+#include "utility/hot_path_log.h"
+#include "utility/logger.h"
+#include "utility/mapped_file.h"
+#include "utility/buffer_pool.h"
 #include "utility/condition.h"
+#include "utility/config.h"
+#include "utility/construction_scope.h"
+#include "utility/fiber_thread_pool/fiber_thread_pool.hpp"
+#include "utility/memory_tracker.h"
+#include "utility/mpsc_queue.h"
+#include "utility/thread.h"
+#include "utility/typedefs.h"
 
 namespace {
 TEST(Condition, Wait_NotifyOne) {
@@ -251,4 +309,1789 @@ TEST(InputOutput_Un_Vectorization, VectorsOfUnsignedIntegers) {
   EXPECT_EQ(v32, v32_check);
   EXPECT_EQ(v64, v64_check);
 }
-}
\ No newline at end of file
+
+TEST(PreprocessingStore, WriteAndRead) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "motion_preprocessing_store_test").string();
+  const auto bits = ENCRYPTO::BitVector<>::Random(77);
+  const std::vector<std::uint32_t> ints = {42, 0, std::numeric_limits<std::uint32_t>::max()};
+
+  {
+    MOTION::PreprocessingWriter writer(path, 1);
+    writer.begin_record(3);
+    writer.write_bits(bits);
+    writer.write_ints(ints);
+    writer.end_record();
+    writer.begin_record(5);
+    writer.end_record();
+    writer.finish();
+    EXPECT_EQ(writer.get_num_records(), 2);
+  }
+
+  EXPECT_THROW(MOTION::PreprocessingReader(path, 0), std::runtime_error);
+  {
+    const MOTION::PreprocessingReader reader(path, 1);
+    ASSERT_EQ(reader.get_num_records(), 2);
+    auto record_0 = reader.get_record(0);
+    EXPECT_EQ(record_0.get_gate_id(), 3);
+    EXPECT_EQ(record_0.read_bits(), bits);
+    EXPECT_EQ(record_0.read_ints<std::uint32_t>(), ints);
+    EXPECT_TRUE(record_0.empty());
+    auto record_1 = reader.get_record(1);
+    EXPECT_EQ(record_1.get_gate_id(), 5);
+    EXPECT_TRUE(record_1.empty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(RunCheckpoint, Marker) {
+  const auto directory = std::filesystem::temp_directory_path() / "motion_run_checkpoint_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  const MOTION::RunCheckpoint checkpoint(directory.string(), "run");
+  EXPECT_FALSE(checkpoint.load_marker(0).has_value());
+
+  MOTION::RunCheckpoint::Marker marker{.num_gates_ = 1234};
+  std::fill(std::begin(marker.id_), std::end(marker.id_), std::byte(0x2a));
+  checkpoint.store_marker(0, marker);
+  const auto loaded = checkpoint.load_marker(0);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->id_, marker.id_);
+  EXPECT_EQ(loaded->num_gates_, 1234);
+  // the marker belongs to party 0
+  EXPECT_FALSE(checkpoint.load_marker(1).has_value());
+
+  // a truncated marker is ignored
+  std::filesystem::resize_file(checkpoint.get_marker_path(0), 12);
+  EXPECT_FALSE(checkpoint.load_marker(0).has_value());
+
+  checkpoint.store_marker(0, marker);
+  {
+    MOTION::PreprocessingWriter writer(checkpoint.get_store_path(0), 0);
+    writer.finish();
+  }
+  checkpoint.remove(0);
+  EXPECT_FALSE(checkpoint.load_marker(0).has_value());
+  EXPECT_FALSE(std::filesystem::exists(checkpoint.get_store_path(0)));
+  std::filesystem::remove_all(directory);
+}
+
+TEST(MTStore, PublishAndTake) {
+  const auto directory = std::filesystem::temp_directory_path() / "motion_mt_store_test";
+  std::filesystem::remove_all(directory);
+  const auto bits = ENCRYPTO::BitVector<>::Random(3 * 100);
+  MOTION::BinaryMTVector bit_mts{bits.Subset(0, 100), bits.Subset(100, 200),
+                                 bits.Subset(200, 300)};
+  MOTION::IntegerMTVector<std::uint32_t> int_mts{{1, 2, 3}, {4, 5, 6}, {4, 10, 18}};
+
+  MOTION::MTStoreWriter writer(directory, 1);
+  for (std::size_t batch_i = 0; batch_i < 3; ++batch_i) {
+    MOTION::MTReservoir reservoir;
+    reservoir.AddBinary(bit_mts);
+    reservoir.AddInteger(int_mts);
+    EXPECT_EQ(writer.publish(reservoir), batch_i);
+    EXPECT_EQ(reservoir.GetSize<bool>(), 0);
+    EXPECT_EQ(reservoir.GetSize<std::uint32_t>(), 0);
+  }
+  EXPECT_EQ(writer.get_num_available(), 3);
+
+  // a second consumer takes the batches 1, 3, ..., so this one gets the batches 0 and 2
+  MOTION::MTStoreReader reader(directory, 1, 0, 2);
+  MOTION::MTReservoir reservoir;
+  EXPECT_TRUE(reader.take(reservoir));
+  EXPECT_TRUE(reader.take(reservoir));
+  EXPECT_FALSE(reader.take(reservoir, std::chrono::milliseconds(10)));
+  EXPECT_EQ(reader.get_next_batch(), 4);
+  EXPECT_EQ(writer.get_num_available(), 1);
+  EXPECT_TRUE(std::filesystem::exists(MOTION::mt_store_batch_path(directory, 1)));
+
+  ASSERT_EQ(reservoir.GetSize<bool>(), 200);
+  ASSERT_EQ(reservoir.GetSize<std::uint32_t>(), 6);
+  EXPECT_EQ(reservoir.GetSize<std::uint64_t>(), 0);
+  for (std::size_t batch_i = 0; batch_i < 2; ++batch_i) {
+    const auto taken_bit_mts = reservoir.TakeBinary(100);
+    EXPECT_EQ(taken_bit_mts.a, bit_mts.a);
+    EXPECT_EQ(taken_bit_mts.b, bit_mts.b);
+    EXPECT_EQ(taken_bit_mts.c, bit_mts.c);
+    const auto taken_int_mts = reservoir.TakeInteger<std::uint32_t>(3);
+    EXPECT_EQ(taken_int_mts.a, int_mts.a);
+    EXPECT_EQ(taken_int_mts.b, int_mts.b);
+    EXPECT_EQ(taken_int_mts.c, int_mts.c);
+  }
+
+  // a reader of the other party cannot use the batches
+  MOTION::MTStoreReader other_reader(directory, 0, 1);
+  EXPECT_THROW(other_reader.take(reservoir), std::runtime_error);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(PatternMatcher, EncodeTextFile) {
+  const auto path = (std::filesystem::temp_directory_path() / "motion_pattern_text_test").string();
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<unsigned> dist(0, 255);
+  std::vector<std::uint8_t> text(1000);
+  std::generate(std::begin(text), std::end(text), [&] { return dist(gen); });
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(text.data()), text.size());
+  }
+
+  const MOTION::MappedFile file(path);
+  ASSERT_EQ(file.get_size(), text.size());
+  const auto data = file.get_data();
+  const auto bit_planes = MOTION::encode_bit_planes(
+      std::span(reinterpret_cast<const std::uint8_t*>(data.data()), data.size()), 10);
+  const std::vector<std::uint64_t> wide_text(std::begin(text), std::end(text));
+  EXPECT_EQ(MOTION::encode_bit_planes(std::span(wide_text), 10), bit_planes);
+  ASSERT_EQ(bit_planes.size(), 10);
+  for (std::size_t bit_j = 0; bit_j < 10; ++bit_j) {
+    ASSERT_EQ(bit_planes[bit_j].GetSize(), text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      EXPECT_EQ(bit_planes[bit_j].Get(i), bit_j < 8 && ((text[i] >> bit_j) & 1) == 1);
+    }
+  }
+  std::filesystem::remove(path);
+  EXPECT_THROW(MOTION::MappedFile{path}, std::system_error);
+}
+
+TEST(PatternMatcher, MatchBitsWriter) {
+  const auto path = (std::filesystem::temp_directory_path() / "motion_match_bits_test").string();
+  const auto matches = ENCRYPTO::BitVector<>::Random(77);
+  {
+    MOTION::MatchBitsWriter writer(path);
+    writer.write(3, matches);
+    writer.close();
+  }
+  {
+    const MOTION::MappedFile file(path);
+    ASSERT_EQ(file.get_size(), 2 * sizeof(std::uint64_t) + (77 + 7) / 8);
+    std::array<std::uint64_t, 2> header;
+    std::memcpy(header.data(), file.get_data().data(), sizeof(header));
+    EXPECT_EQ(header[0], 3);
+    EXPECT_EQ(header[1], 77);
+    ENCRYPTO::BitVector<> read_matches(file.get_data().data() + sizeof(header), 77);
+    EXPECT_EQ(read_matches, matches);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(EditDistance, BandedMatchesDP) {
+  std::mt19937_64 gen(42);
+  for (std::size_t size = 1; size <= 12; ++size) {
+    for (std::size_t band = 0; band <= 4; ++band) {
+      for (std::size_t rep = 0; rep < 20; ++rep) {
+        // a small alphabet for many matches
+        std::vector<std::uint64_t> pattern(size), text(size);
+        std::generate(std::begin(pattern), std::end(pattern), [&] { return gen() % 3; });
+        std::generate(std::begin(text), std::end(text), [&] { return gen() % 3; });
+        // the textbook DP, where cells outside of the band are infinite
+        constexpr std::size_t infinity = std::numeric_limits<std::size_t>::max() / 2;
+        std::vector<std::vector<std::size_t>> dp(size + 1,
+                                                 std::vector<std::size_t>(size + 1, infinity));
+        for (std::size_t i = 0; i <= size; ++i) {
+          for (std::size_t j = 0; j <= size; ++j) {
+            if ((i > j ? i - j : j - i) > band) {
+              continue;
+            }
+            if (i == 0 || j == 0) {
+              dp[i][j] = i + j;
+            } else {
+              dp[i][j] = std::min({dp[i - 1][j] + 1, dp[i][j - 1] + 1,
+                                   dp[i - 1][j - 1] + (pattern[i - 1] != text[j - 1])});
+            }
+          }
+        }
+        EXPECT_EQ(MOTION::banded_edit_distance(pattern, text, band), dp[size][size]);
+      }
+    }
+  }
+  EXPECT_THROW(MOTION::banded_edit_distance(std::vector<std::uint64_t>(3),
+                                            std::vector<std::uint64_t>(4), 1),
+               std::invalid_argument);
+}
+
+TEST(QueryCoalescer, BatchesConcurrentQueries) {
+  constexpr std::size_t text_owner = 0;
+  constexpr std::size_t num_clients = 4;
+  constexpr std::size_t queries_per_client = 3;
+  const std::vector<std::uint64_t> text = {1, 2, 3, 1, 2, 1, 2, 3, 0, 1, 2, 3, 3, 2};
+  // a long delay s.t. the queries of all clients end up in few batches
+  const MOTION::QueryCoalescingPolicy policy{
+      .max_delay = std::chrono::milliseconds(100), .max_queries = 8, .max_batch_size = 8};
+  auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2);
+
+  const auto make_pattern = [](std::size_t client_i, std::size_t query_i) {
+    return std::vector<std::uint64_t>{client_i % 4, (client_i + query_i + 1) % 4, 3};
+  };
+  std::array<std::vector<ENCRYPTO::BitVector<>>, num_clients> results;
+  MOTION::QueryCoalescingStatistics statistics;
+  std::vector<std::future<void>> futs;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    futs.emplace_back(std::async(std::launch::async, [&, party_id] {
+      auto logger =
+          std::make_shared<MOTION::Logger>(party_id, boost::log::trivial::severity_level::error);
+      comm_layers[party_id]->set_logger(logger);
+      MOTION::PatternMatcher matcher(*comm_layers[party_id], text_owner, 2, 1, logger);
+      if (party_id == text_owner) {
+        matcher.share_text(text);
+      } else {
+        matcher.share_text(text.size());
+      }
+      MOTION::QueryCoalescer coalescer(*comm_layers[party_id], matcher, policy);
+      if (party_id == text_owner) {
+        coalescer.serve();
+        return;
+      }
+      auto server = std::async(std::launch::async, [&] { coalescer.serve(); });
+      std::vector<std::future<void>> clients;
+      for (std::size_t client_i = 0; client_i < num_clients; ++client_i) {
+        clients.emplace_back(std::async(std::launch::async, [&, client_i] {
+          std::vector<std::future<ENCRYPTO::BitVector<>>> matches;
+          for (std::size_t query_i = 0; query_i < queries_per_client; ++query_i) {
+            matches.push_back(coalescer.submit(
+                {.type = MOTION::PatternMatchingType::exact,
+                 .pattern_size = 3,
+                 .pattern = make_pattern(client_i, query_i)}));
+          }
+          for (auto& f : matches) {
+            results[client_i].push_back(f.get());
+          }
+        }));
+      }
+      // an invalid query fails on its own
+      auto invalid = coalescer.submit({.type = MOTION::PatternMatchingType::exact,
+                                       .pattern_size = 3,
+                                       .pattern = {1, 2}});
+      std::for_each(std::begin(clients), std::end(clients), [](auto& f) { f.get(); });
+      EXPECT_THROW(invalid.get(), std::invalid_argument);
+      coalescer.stop();
+      server.get();
+      statistics = coalescer.get_statistics();
+    }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  for (auto& comm_layer : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&] { comm_layer->shutdown(); }));
+  }
+  std::for_each(std::begin(futs) + 2, std::end(futs), [](auto& f) { f.get(); });
+
+  for (std::size_t client_i = 0; client_i < num_clients; ++client_i) {
+    ASSERT_EQ(results[client_i].size(), queries_per_client);
+    for (std::size_t query_i = 0; query_i < queries_per_client; ++query_i) {
+      const auto pattern = make_pattern(client_i, query_i);
+      ENCRYPTO::BitVector<> expected(text.size() - pattern.size() + 1);
+      for (std::size_t window_i = 0; window_i < expected.GetSize(); ++window_i) {
+        expected.Set(std::equal(std::begin(pattern), std::end(pattern),
+                                std::begin(text) + window_i),
+                     window_i);
+      }
+      EXPECT_EQ(results[client_i][query_i], expected);
+    }
+  }
+  EXPECT_EQ(statistics.num_queries, num_clients * queries_per_client);
+  EXPECT_LT(statistics.num_batches, statistics.num_queries);
+}
+
+TEST(PrivateSetIntersection, HashTables) {
+  constexpr std::size_t num_items = 1000;
+  constexpr std::uint64_t seed = 42;
+  std::mt19937_64 rng(1);
+  std::vector<std::uint64_t> items(num_items);
+  std::generate(std::begin(items), std::end(items), rng);
+  const auto num_bins = MOTION::PSIParameters{.client_set_size = num_items}.get_num_bins();
+  EXPECT_EQ(num_bins, 1270);
+
+  // every item is stored once in one of its bins
+  const auto cuckoo_table = MOTION::make_cuckoo_table(items, num_bins, seed);
+  ASSERT_EQ(cuckoo_table.size(), num_bins);
+  std::vector<std::size_t> count(num_items);
+  for (std::size_t bin_i = 0; bin_i < num_bins; ++bin_i) {
+    if (const auto& item_i = cuckoo_table[bin_i]; item_i.has_value()) {
+      ++count.at(*item_i);
+      bool in_own_bin = false;
+      for (std::size_t hash_i = 0; hash_i < MOTION::psi_num_hash_functions; ++hash_i) {
+        in_own_bin |= MOTION::get_psi_bin(items[*item_i], hash_i, seed, num_bins) == bin_i;
+      }
+      EXPECT_TRUE(in_own_bin);
+    }
+  }
+  EXPECT_TRUE(std::all_of(std::begin(count), std::end(count), [](auto c) { return c == 1; }));
+  EXPECT_THROW(MOTION::make_cuckoo_table(items, num_items / 2, seed), std::invalid_argument);
+
+  // every item is stored in the bins of all its hash functions, and the bound holds
+  const auto simple_table = MOTION::make_simple_hash_table(items, num_bins, seed);
+  const auto max_load = MOTION::get_max_bin_load(num_items, num_bins);
+  for (std::size_t item_i = 0; item_i < num_items; ++item_i) {
+    for (std::size_t hash_i = 0; hash_i < MOTION::psi_num_hash_functions; ++hash_i) {
+      const auto& bin = simple_table[MOTION::get_psi_bin(items[item_i], hash_i, seed, num_bins)];
+      EXPECT_EQ(std::count(std::begin(bin), std::end(bin), item_i), 1);
+    }
+  }
+  for (const auto& bin : simple_table) {
+    EXPECT_LE(bin.size(), max_load);
+  }
+  // far below the number of items, which pairwise comparisons would need
+  EXPECT_LT(max_load, 32);
+  EXPECT_EQ(MOTION::get_max_bin_load(5, 1), 5);
+}
+
+TEST(PrivateSetIntersection, Intersection) {
+  constexpr std::size_t client_id = 1;
+  const std::vector<std::uint64_t> client_items = {3, 17, 250, 1000, 4095, 77, 8, 512, 9, 1234};
+  const std::vector<std::uint64_t> server_items = {17, 1, 2, 4095, 9, 3000, 77, 5, 1023,
+                                                   6, 7, 100, 1001, 2048, 4000, 12, 11};
+  const std::vector<std::size_t> expected = {1, 3, 5, 8};
+  for (auto pipeline : {MOTION::PatternMatchingPipeline::msg,
+                        MOTION::PatternMatchingPipeline::ham_eqexp}) {
+    const MOTION::PSIParameters parameters{.client_set_size = client_items.size(),
+                                           .server_set_size = server_items.size(),
+                                           .bits_per_item = 12,
+                                           .seed = 7,
+                                           .max_bins_per_circuit = 5,
+                                           .pipeline = pipeline};
+    auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2);
+    std::vector<std::size_t> result;
+    MOTION::PSIStatistics statistics;
+    std::vector<std::future<void>> futs;
+    for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+      futs.emplace_back(std::async(std::launch::async, [&, party_id] {
+        auto logger =
+            std::make_shared<MOTION::Logger>(party_id, boost::log::trivial::severity_level::error);
+        comm_layers[party_id]->set_logger(logger);
+        MOTION::PrivateSetIntersection psi(*comm_layers[party_id], client_id, parameters, 1,
+                                           logger);
+        if (party_id == client_id) {
+          EXPECT_THROW(psi.run({1, 2}), std::invalid_argument);
+          result = psi.run(client_items);
+          statistics = psi.get_statistics();
+        } else {
+          EXPECT_TRUE(psi.run(server_items).empty());
+        }
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+    for (auto& comm_layer : comm_layers) {
+      futs.emplace_back(std::async(std::launch::async, [&] { comm_layer->shutdown(); }));
+    }
+    std::for_each(std::begin(futs) + 2, std::end(futs), [](auto& f) { f.get(); });
+
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(statistics.num_circuits, (statistics.num_bins + 4) / 5);
+    EXPECT_EQ(statistics.num_comparisons, statistics.num_bins * statistics.max_bin_load);
+  }
+}
+
+TEST(HammingNearestNeighbours, Search) {
+  constexpr std::size_t gallery_owner = 0;
+  constexpr std::size_t template_bits = 40;
+  // an odd number of templates, s.t. values are carried over levels of the tournament
+  constexpr std::size_t gallery_size = 37;
+  std::vector<ENCRYPTO::BitVector<>> gallery;
+  for (std::size_t i = 0; i < gallery_size; ++i) {
+    gallery.push_back(ENCRYPTO::BitVector<>::RandomSeeded(template_bits, i));
+  }
+  auto query = gallery[29];
+  // the nearest templates at distances 0, 1 and 3 from the query
+  gallery[4] = query;
+  gallery[4].Set(!query.Get(7), 7);
+  gallery[18] = gallery[4];
+  gallery[18].Set(!query.Get(8), 8);
+  gallery[18].Set(!query.Get(9), 9);
+  const std::vector<std::size_t> expected = {29, 4, 18};
+
+  auto comm_layers = MOTION::Communication::make_dummy_communication_layers(2);
+  std::vector<std::size_t> nearest;
+  std::vector<std::size_t> top_k;
+  std::vector<std::future<void>> futs;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    futs.emplace_back(std::async(std::launch::async, [&, party_id] {
+      auto logger =
+          std::make_shared<MOTION::Logger>(party_id, boost::log::trivial::severity_level::error);
+      comm_layers[party_id]->set_logger(logger);
+      MOTION::HammingNearestNeighbours engine(*comm_layers[party_id], gallery_owner,
+                                              template_bits, 1, logger);
+      if (party_id == gallery_owner) {
+        engine.share_gallery(gallery);
+        engine.search(1);
+        engine.search(3);
+      } else {
+        engine.share_gallery(gallery_size);
+        EXPECT_THROW(engine.search(query, gallery_size + 1), std::invalid_argument);
+        nearest = engine.search(query, 1);
+        top_k = engine.search(query, 3);
+        EXPECT_EQ(engine.get_statistics().num_circuits, 4);
+      }
+    }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  for (auto& comm_layer : comm_layers) {
+    futs.emplace_back(std::async(std::launch::async, [&] { comm_layer->shutdown(); }));
+  }
+  std::for_each(std::begin(futs) + 2, std::end(futs), [](auto& f) { f.get(); });
+
+  EXPECT_EQ(nearest, std::vector<std::size_t>{29});
+  EXPECT_EQ(top_k, expected);
+}
+
+TEST(ScaleOut, PartitionSimd) {
+  const auto slices = MOTION::partition_simd(10, 3, 3);
+  ASSERT_EQ(slices.size(), 3);
+  EXPECT_EQ(slices[0].offset, 0);
+  EXPECT_EQ(slices[0].num_simd, 6);
+  EXPECT_EQ(slices[1].offset, 6);
+  EXPECT_EQ(slices[1].num_simd, 3);
+  EXPECT_EQ(slices[2].offset, 9);
+  EXPECT_EQ(slices[2].num_simd, 1);
+  // more workers than values
+  const auto small = MOTION::partition_simd(2, 4);
+  EXPECT_EQ(small[1].num_simd, 1);
+  EXPECT_EQ(small[2].offset, 2);
+  EXPECT_EQ(small[3].num_simd, 0);
+  EXPECT_THROW(MOTION::partition_simd(10, 0), std::invalid_argument);
+}
+
+TEST(ScaleOut, PatternMatchingWorkers) {
+  constexpr std::size_t text_owner = 0;
+  constexpr std::size_t num_workers = 3;
+  const std::vector<std::uint64_t> text = {1, 2, 3, 1, 2, 3, 0, 1, 2, 3, 3, 2, 1, 2, 3, 1, 1};
+  const std::vector<std::uint64_t> pattern = {1, 2, 3};
+  const auto num_windows = text.size() - pattern.size() + 1;
+
+  // a coordinator per party and a worker pair per slice of the windows, which shares only the
+  // characters of its windows
+  std::array<std::vector<std::unique_ptr<MOTION::Communication::Transport>>, 2> to_workers;
+  std::array<std::vector<std::unique_ptr<MOTION::Communication::Transport>>, 2> to_coordinators;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    for (std::size_t worker_id = 0; worker_id < num_workers; ++worker_id) {
+      auto [coordinator_end, worker_end] =
+          MOTION::Communication::DummyTransport::make_transport_pair();
+      to_workers[party_id].push_back(std::move(coordinator_end));
+      to_coordinators[party_id].push_back(std::move(worker_end));
+    }
+  }
+  std::array<std::vector<MOTION::ScaleOutChunk>, 2> chunks;
+  std::vector<std::future<void>> futs;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    futs.emplace_back(std::async(std::launch::async, [&, party_id] {
+      MOTION::ScaleOutCoordinator coordinator(std::move(to_workers[party_id]));
+      chunks[party_id] = coordinator.collect_outputs();
+    }));
+  }
+  std::vector<std::vector<std::unique_ptr<MOTION::Communication::CommunicationLayer>>>
+      comm_layers;
+  for (std::size_t worker_id = 0; worker_id < num_workers; ++worker_id) {
+    comm_layers.push_back(MOTION::Communication::make_dummy_communication_layers(2));
+    for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+      futs.emplace_back(std::async(std::launch::async, [&, party_id, worker_id] {
+        auto& comm_layer = comm_layers[worker_id][party_id];
+        auto logger =
+            std::make_shared<MOTION::Logger>(party_id, boost::log::trivial::severity_level::error);
+        comm_layer->set_logger(logger);
+        MOTION::ScaleOutWorker worker(worker_id, num_workers,
+                                      std::move(to_coordinators[party_id][worker_id]));
+        const auto slice = worker.get_slice(num_windows);
+        const auto slice_size = slice.num_simd + pattern.size() - 1;
+        MOTION::PatternMatcher matcher(*comm_layer, text_owner, 2, 1, logger);
+        if (party_id == text_owner) {
+          matcher.share_text(std::vector<std::uint64_t>(
+              std::begin(text) + slice.offset, std::begin(text) + slice.offset + slice_size));
+          matcher.add_query({.type = MOTION::PatternMatchingType::exact,
+                             .pattern_size = pattern.size()});
+        } else {
+          matcher.share_text(slice_size);
+          matcher.add_query({.type = MOTION::PatternMatchingType::exact,
+                             .pattern_size = pattern.size(),
+                             .pattern = pattern});
+        }
+        const auto matches = matcher.run().at(0);
+        if (party_id == text_owner) {
+          worker.send_output(slice.offset, slice.num_simd, {});
+        } else {
+          worker.send_output_bits(slice.offset, matches);
+        }
+        worker.finish();
+      }));
+    }
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  futs.clear();
+  for (auto& worker_comm_layers : comm_layers) {
+    for (auto& comm_layer : worker_comm_layers) {
+      futs.emplace_back(std::async(std::launch::async, [&] { comm_layer->shutdown(); }));
+    }
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  ENCRYPTO::BitVector<> expected(num_windows);
+  for (std::size_t window_i = 0; window_i < num_windows; ++window_i) {
+    expected.Set(std::equal(std::begin(pattern), std::end(pattern), std::begin(text) + window_i),
+                 window_i);
+  }
+  EXPECT_EQ(chunks[1 - text_owner].size(), num_workers);
+  EXPECT_EQ(MOTION::ScaleOutCoordinator::merge_bits(chunks[1 - text_owner]), expected);
+  // the text owner does not learn the matches
+  EXPECT_TRUE(std::all_of(std::begin(chunks[text_owner]), std::end(chunks[text_owner]),
+                          [](const auto& chunk) { return chunk.output.empty(); }));
+}
+
+TEST(AlgorithmDescription, BinaryFormat) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "motion_binary_circuit_test").string();
+  MOTION::CircuitLoader circuit_loader;
+  const auto& algo =
+      circuit_loader.load_circuit("int_add8_size.bristol", MOTION::CircuitFormat::Bristol);
+  algo.WriteBinary(path);
+  const auto loaded_algo = ENCRYPTO::AlgorithmDescription::FromBinary(path);
+  std::filesystem::remove(path);
+
+  EXPECT_EQ(loaded_algo.n_gates_, algo.n_gates_);
+  EXPECT_EQ(loaded_algo.n_wires_, algo.n_wires_);
+  EXPECT_EQ(loaded_algo.n_input_wires_parent_a_, algo.n_input_wires_parent_a_);
+  EXPECT_EQ(loaded_algo.n_input_wires_parent_b_, algo.n_input_wires_parent_b_);
+  EXPECT_EQ(loaded_algo.n_output_wires_, algo.n_output_wires_);
+  ASSERT_EQ(loaded_algo.gates_.size(), algo.gates_.size());
+  for (std::size_t gate_i = 0; gate_i < algo.gates_.size(); ++gate_i) {
+    const auto& op = algo.gates_[gate_i];
+    const auto& loaded_op = loaded_algo.gates_[gate_i];
+    EXPECT_EQ(loaded_op.type_, op.type_);
+    EXPECT_EQ(loaded_op.parent_a_, op.parent_a_);
+    EXPECT_EQ(loaded_op.parent_b_, op.parent_b_);
+    EXPECT_EQ(loaded_op.selection_bit_, op.selection_bit_);
+    EXPECT_EQ(loaded_op.output_wire_, op.output_wire_);
+  }
+
+  // wire ids need to fit into 32 bit
+  auto large_algo = algo;
+  large_algo.gates_.back().output_wire_ = std::size_t(1) << 32;
+  EXPECT_THROW(large_algo.WriteBinary(path), std::runtime_error);
+  EXPECT_THROW(ENCRYPTO::AlgorithmDescription::FromBinary(path), std::runtime_error);
+}
+
+static std::vector<bool> evaluate_plain(const ENCRYPTO::AlgorithmDescription& algo,
+                                        const std::vector<bool>& inputs) {
+  std::vector<bool> wires(algo.n_wires_, false);
+  std::copy(std::begin(inputs), std::end(inputs), std::begin(wires));
+  for (const auto& op : algo.gates_) {
+    const bool a = wires.at(op.parent_a_);
+    switch (op.type_) {
+      case ENCRYPTO::PrimitiveOperationType::INV:
+        wires.at(op.output_wire_) = !a;
+        break;
+      case ENCRYPTO::PrimitiveOperationType::XOR:
+        wires.at(op.output_wire_) = a != wires.at(*op.parent_b_);
+        break;
+      case ENCRYPTO::PrimitiveOperationType::AND:
+        wires.at(op.output_wire_) = a && wires.at(*op.parent_b_);
+        break;
+      case ENCRYPTO::PrimitiveOperationType::OR:
+        wires.at(op.output_wire_) = a || wires.at(*op.parent_b_);
+        break;
+      default:
+        throw std::logic_error("unexpected gate type");
+    }
+  }
+  return {std::end(wires) - algo.n_output_wires_, std::end(wires)};
+}
+
+static void expect_same_function(const ENCRYPTO::AlgorithmDescription& algo,
+                                 const ENCRYPTO::AlgorithmDescription& optimized_algo,
+                                 std::size_t num_samples) {
+  const auto num_inputs = algo.n_input_wires_parent_a_ + algo.n_input_wires_parent_b_.value_or(0);
+  EXPECT_EQ(optimized_algo.n_input_wires_parent_a_, algo.n_input_wires_parent_a_);
+  EXPECT_EQ(optimized_algo.n_input_wires_parent_b_, algo.n_input_wires_parent_b_);
+  ASSERT_EQ(optimized_algo.n_output_wires_, algo.n_output_wires_);
+  EXPECT_EQ(optimized_algo.n_gates_, optimized_algo.gates_.size());
+  std::mt19937_64 random_engine(42);
+  std::vector<bool> inputs(num_inputs);
+  for (std::size_t sample_i = 0; sample_i < num_samples; ++sample_i) {
+    std::generate(std::begin(inputs), std::end(inputs), [&] { return random_engine() & 1; });
+    EXPECT_EQ(evaluate_plain(optimized_algo, inputs), evaluate_plain(algo, inputs));
+  }
+}
+
+TEST(CircuitOptimizer, SimplifiesGates) {
+  // inputs 0-2, outputs 11-15
+  ENCRYPTO::AlgorithmDescription algo{.n_output_wires_ = 5,
+                                      .n_input_wires_parent_a_ = 2,
+                                      .n_wires_ = 16,
+                                      .n_input_wires_parent_b_ = 1};
+  using ENCRYPTO::PrimitiveOperationType;
+  algo.gates_ = {
+      {.type_ = PrimitiveOperationType::AND, .parent_a_ = 0, .parent_b_ = 1, .output_wire_ = 3},
+      {.type_ = PrimitiveOperationType::AND, .parent_a_ = 0, .parent_b_ = 2, .output_wire_ = 4},
+      {.type_ = PrimitiveOperationType::AND, .parent_a_ = 1, .parent_b_ = 0, .output_wire_ = 5},
+      {.type_ = PrimitiveOperationType::XOR, .parent_a_ = 3, .parent_b_ = 4, .output_wire_ = 6},
+      {.type_ = PrimitiveOperationType::XOR, .parent_a_ = 3, .parent_b_ = 5, .output_wire_ = 7},
+      {.type_ = PrimitiveOperationType::INV, .parent_a_ = 2, .output_wire_ = 8},
+      {.type_ = PrimitiveOperationType::AND, .parent_a_ = 2, .parent_b_ = 8, .output_wire_ = 9},
+      {.type_ = PrimitiveOperationType::INV, .parent_a_ = 8, .output_wire_ = 10},
+      // x0 & x1 ^ x0 & x2
+      {.type_ = PrimitiveOperationType::XOR, .parent_a_ = 3, .parent_b_ = 4, .output_wire_ = 11},
+      // 0
+      {.type_ = PrimitiveOperationType::OR, .parent_a_ = 7, .parent_b_ = 9, .output_wire_ = 12},
+      // x2
+      {.type_ = PrimitiveOperationType::AND, .parent_a_ = 10, .parent_b_ = 2, .output_wire_ = 13},
+      // 1
+      {.type_ = PrimitiveOperationType::INV, .parent_a_ = 9, .output_wire_ = 14},
+      {.type_ = PrimitiveOperationType::XOR, .parent_a_ = 6, .parent_b_ = 9, .output_wire_ = 15},
+  };
+  algo.n_gates_ = algo.gates_.size();
+
+  const auto optimized_algo = ENCRYPTO::OptimizeCircuit(algo);
+  expect_same_function(algo, optimized_algo, 32);
+  const auto stats = ENCRYPTO::ComputeCircuitStatistics(algo);
+  const auto optimized_stats = ENCRYPTO::ComputeCircuitStatistics(optimized_algo);
+  EXPECT_EQ(stats.num_and_gates, 5);
+  EXPECT_EQ(optimized_stats.num_and_gates, 1);
+  EXPECT_EQ(optimized_stats.num_or_gates, 0);
+  EXPECT_EQ(optimized_stats.and_depth, 1);
+}
+
+TEST(CircuitOptimizer, BuiltinCircuits) {
+  MOTION::CircuitLoader circuit_loader;
+  for (bool depth_optimized : {false, true}) {
+    // the loader returns the optimized circuits, compare them with the original files
+    const auto& gt_algo = circuit_loader.load_gt_circuit(8, depth_optimized);
+    const auto& original_algo = circuit_loader.load_circuit(
+        fmt::format("int_gt8_{}.bristol", depth_optimized ? "depth" : "size"),
+        MOTION::CircuitFormat::Bristol);
+    // the comparison is the first output of the original circuit, the others are constant
+    const auto gtmux = [&](const std::vector<bool>& x, const std::vector<bool>& y) {
+      auto inputs = x;
+      inputs.insert(std::end(inputs), std::begin(y), std::end(y));
+      return evaluate_plain(original_algo, inputs).at(0) ? x : y;
+    };
+    const auto& maxpool_algo = circuit_loader.load_maxpool_circuit(8, 4, depth_optimized);
+    std::mt19937_64 random_engine(depth_optimized);
+    std::vector<bool> inputs(32);
+    for (std::size_t sample_i = 0; sample_i < 64; ++sample_i) {
+      std::generate(std::begin(inputs), std::end(inputs), [&] { return random_engine() & 1; });
+      std::array<std::vector<bool>, 4> values;
+      for (std::size_t i = 0; i < 4; ++i) {
+        values[i] = {std::begin(inputs) + 8 * i, std::begin(inputs) + 8 * (i + 1)};
+      }
+      const std::vector<bool> gt_inputs(std::begin(inputs), std::begin(inputs) + 16);
+      EXPECT_EQ(evaluate_plain(gt_algo, gt_inputs).at(0),
+                evaluate_plain(original_algo, gt_inputs).at(0));
+      EXPECT_EQ(evaluate_plain(maxpool_algo, inputs),
+                gtmux(gtmux(values[0], values[1]), gtmux(values[2], values[3])));
+    }
+  }
+  const auto& reports = circuit_loader.get_optimization_reports();
+  ASSERT_EQ(reports.size(), 6);
+  for (const auto& report : reports) {
+    EXPECT_LE(report.optimized.num_and_gates + report.optimized.num_or_gates,
+              report.original.num_and_gates + report.original.num_or_gates)
+        << report.name;
+    EXPECT_LE(report.optimized.and_depth, report.original.and_depth) << report.name;
+  }
+}
+
+TEST(CircuitLoader, SelectDepthOptimized) {
+  using namespace std::chrono_literals;
+  MOTION::CircuitLoader circuit_loader;
+  const auto stats = circuit_loader.load_circuit_statistics("int_gt32_depth.bristol",
+                                                            MOTION::CircuitFormat::Bristol);
+  EXPECT_EQ(stats.num_and_gates, 89);
+  EXPECT_EQ(stats.and_depth, 6);
+  EXPECT_EQ(stats.num_gates, 188);
+
+  EXPECT_TRUE(circuit_loader.select_depth_optimized("int_gt32", 1, true));
+  EXPECT_FALSE(circuit_loader.select_depth_optimized("int_gt32", 1, false));
+  // LAN: the round trips dominate for few values, the communication for many values
+  circuit_loader.set_cost_model(
+      MOTION::CircuitCostModel{.round_trip_time = 500us, .bandwidth = 1e9});
+  EXPECT_TRUE(circuit_loader.select_depth_optimized("int_gt32", 1));
+  EXPECT_FALSE(circuit_loader.select_depth_optimized("int_gt32", 10'000'000));
+  // WAN
+  circuit_loader.set_cost_model(
+      MOTION::CircuitCostModel{.round_trip_time = 100ms, .bandwidth = 1e8});
+  EXPECT_TRUE(circuit_loader.select_depth_optimized("int_gt32", 100'000));
+  EXPECT_THROW(circuit_loader.select_depth_optimized("int_gt31", 1), std::runtime_error);
+}
+
+TEST(CircuitCache, SharedByLoaders) {
+  auto& cache = MOTION::CircuitCache::get_instance();
+  const std::filesystem::path path =
+      std::string(MOTION::MOTION_ROOT_DIR) + "/circuits/int/int_add8_size.bristol";
+  // the circuit may already be cached by other tests
+  const auto algo = cache.load(path, MOTION::CircuitFormat::Bristol);
+  const auto num_parsed = cache.get_num_parsed();
+  EXPECT_EQ(algo->n_gates_, 34);
+
+  MOTION::CircuitLoader loader_a;
+  MOTION::CircuitLoader loader_b;
+  const auto& algo_a =
+      loader_a.load_circuit("int_add8_size.bristol", MOTION::CircuitFormat::Bristol);
+  const auto& algo_b =
+      loader_b.load_circuit("int_add8_size.bristol", MOTION::CircuitFormat::Bristol);
+  EXPECT_EQ(&algo_a, algo.get());
+  EXPECT_EQ(&algo_b, algo.get());
+  // the key is normalized
+  EXPECT_EQ(cache.load(path.parent_path() / "." / path.filename(), MOTION::CircuitFormat::Bristol),
+            algo);
+  EXPECT_EQ(cache.get_num_parsed(), num_parsed);
+
+  EXPECT_THROW(cache.load(path.parent_path() / "int_add7_size.bristol",
+                          MOTION::CircuitFormat::Bristol),
+               std::runtime_error);
+}
+
+TEST(TreeSchedule, Layers) {
+  // 3x3 kernel of a maxpool, the ninth value enters in the second layer
+  const MOTION::TreeSchedule schedule(9);
+  ASSERT_EQ(schedule.instances.size(), 8);
+  ASSERT_EQ(schedule.get_num_layers(), 4);
+  EXPECT_EQ(schedule.get_layer_size(0), 4);
+  EXPECT_EQ(schedule.get_layer_size(1), 2);
+  EXPECT_EQ(schedule.get_layer_size(2), 1);
+  EXPECT_EQ(schedule.get_layer_size(3), 1);
+  EXPECT_EQ(schedule.instances.at(4), std::make_pair(std::size_t(8), std::size_t(9)));
+  // instances only use values computed in earlier layers
+  for (std::size_t layer_i = 0; layer_i < schedule.get_num_layers(); ++layer_i) {
+    const auto first_output = schedule.num_inputs + schedule.layer_offsets.at(layer_i);
+    for (std::size_t instance_i = schedule.layer_offsets.at(layer_i);
+         instance_i < schedule.layer_offsets.at(layer_i + 1); ++instance_i) {
+      EXPECT_LT(schedule.instances.at(instance_i).first, first_output);
+      EXPECT_LT(schedule.instances.at(instance_i).second, first_output);
+    }
+  }
+  EXPECT_EQ(MOTION::TreeSchedule(1).get_num_layers(), 0);
+}
+
+TEST(PreprocessingPlan, SaveAndLoad) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "motion_preprocessing_plan_test.json").string();
+  MOTION::PreprocessingPlan plan;
+  plan.num_binary_mts = 1000;
+  plan.num_mts = {1, 0, 3, std::numeric_limits<std::uint32_t>::max()};
+  plan.num_sbs = {0, 5, 0, 7};
+  plan.num_sps = {8, 9, 10, 11, 12};
+  plan.num_ots_sent = 128;
+  plan.num_ots_received = 256;
+
+  plan.save(path);
+  EXPECT_EQ(MOTION::PreprocessingPlan::load(path), plan);
+  EXPECT_EQ(MOTION::PreprocessingPlan::from_json(plan.to_json()), plan);
+
+  auto json = plan.to_json();
+  json.erase("sps");
+  EXPECT_THROW(MOTION::PreprocessingPlan::from_json(json), std::runtime_error);
+  json = plan.to_json();
+  json["version"] = 42;
+  EXPECT_THROW(MOTION::PreprocessingPlan::from_json(json), std::runtime_error);
+  std::filesystem::remove(path);
+  EXPECT_THROW(MOTION::PreprocessingPlan::load(path), std::runtime_error);
+}
+
+TEST(MessageSlotTable, ConcurrentGet) {
+  using table_type = MOTION::proto::MessageSlotTable<std::atomic<std::size_t>>;
+  table_type table;
+  EXPECT_EQ(table.find(0, 0), nullptr);
+  EXPECT_EQ(table.find(table_type::max_num_gates, 0), nullptr);
+  EXPECT_THROW(table.get(0, table_type::msgs_per_gate), std::out_of_range);
+
+  constexpr std::size_t num_threads = 4;
+  constexpr std::size_t num_gates = 3 << table_type::chunk_bits;
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&table] {
+      for (std::size_t gate_id = 0; gate_id < num_gates; ++gate_id) {
+        for (std::size_t msg_num = 0; msg_num < table_type::msgs_per_gate; ++msg_num) {
+          table.get(gate_id, msg_num) += gate_id + msg_num;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (std::size_t gate_id = 0; gate_id < num_gates; ++gate_id) {
+    for (std::size_t msg_num = 0; msg_num < table_type::msgs_per_gate; ++msg_num) {
+      auto slot = table.find(gate_id, msg_num);
+      ASSERT_NE(slot, nullptr);
+      EXPECT_EQ(slot, &table.get(gate_id, msg_num));
+      EXPECT_EQ(*slot, num_threads * (gate_id + msg_num));
+    }
+  }
+  EXPECT_EQ(table.find(num_gates, 0), nullptr);
+}
+
+TEST(MessageSlotTable, Reserve) {
+  using table_type = MOTION::proto::MessageSlotTable<std::size_t>;
+  constexpr std::size_t chunk_gates = std::size_t(1) << table_type::chunk_bits;
+  table_type table;
+  table.reserve(0, 0);
+  EXPECT_EQ(table.find(0, 0), nullptr);
+  // gates [chunk_gates - 1, 3 * chunk_gates + 1) span the chunks 0 to 3
+  table.reserve(chunk_gates - 1, 2 * chunk_gates + 2);
+  for (std::size_t chunk = 0; chunk < 4; ++chunk) {
+    EXPECT_NE(table.find(chunk * chunk_gates, table_type::msgs_per_gate - 1), nullptr);
+  }
+  EXPECT_EQ(table.find(4 * chunk_gates, 0), nullptr);
+  EXPECT_EQ(*table.find(chunk_gates, 0), 0);
+  // ids beyond the table are left to get()
+  table.reserve(table_type::max_num_gates - 1, 2);
+  EXPECT_NE(table.find(table_type::max_num_gates - 1, 0), nullptr);
+}
+
+TEST(BufferPool, ReuseAndRelease) {
+  auto pool = ENCRYPTO::BufferPool::create(2, 1024);
+  const std::uint8_t* data;
+  {
+    auto buffer = pool->acquire(100);
+    EXPECT_EQ(buffer.size(), 100);
+    EXPECT_TRUE(buffer.unique());
+    data = buffer.data();
+    {
+      auto copy = buffer;
+      EXPECT_FALSE(buffer.unique());
+      EXPECT_EQ(copy.data(), data);
+    }
+    EXPECT_TRUE(buffer.unique());
+    EXPECT_EQ(pool->get_num_free_buffers(), 0);
+  }
+  EXPECT_EQ(pool->get_num_free_buffers(), 1);
+  {
+    // a smaller buffer fits into the capacity of the pooled one
+    auto buffer = pool->acquire(50);
+    EXPECT_EQ(buffer.data(), data);
+    EXPECT_EQ(pool->get_statistics().num_reused, 1);
+  }
+  {
+    // too large to be kept
+    auto large_buffer = pool->acquire(2048);
+  }
+  EXPECT_EQ(pool->get_num_free_buffers(), 0);
+  {
+    std::vector<std::uint8_t> vector = {1, 2, 3};
+    auto vector_data = vector.data();
+    auto buffer = pool->adopt(std::move(vector));
+    EXPECT_EQ(buffer.data(), vector_data);
+    auto shared = buffer;
+    // the other handle still uses the buffer
+    auto copied = shared.release();
+    EXPECT_EQ(copied, (std::vector<std::uint8_t>{1, 2, 3}));
+    EXPECT_NE(copied.data(), vector_data);
+    EXPECT_TRUE(shared.empty());
+    auto moved = buffer.release();
+    EXPECT_EQ(moved.data(), vector_data);
+  }
+
+  // buffers outlive their pool
+  auto buffer = pool->acquire(10);
+  pool.reset();
+  buffer.data()[9] = 42;
+  EXPECT_EQ(buffer.span()[9], 42);
+}
+
+// wires of a circuit may be destroyed after the gate register has been reset
+TEST(GateRegister, WiresOutliveReset) {
+  MOTION::GateRegister gate_register;
+  auto wire = gate_register.make_wire<std::vector<int>>(3, 42);
+  EXPECT_EQ(wire.use_count(), 1);
+  gate_register.reset();
+  auto next_wire = gate_register.make_wire<std::vector<int>>(2, 47);
+  EXPECT_EQ(*wire, (std::vector<int>{42, 42, 42}));
+  EXPECT_EQ(*next_wire, (std::vector<int>{47, 47}));
+}
+
+class ConstructionTestGate : public MOTION::NewGate {
+ public:
+  explicit ConstructionTestGate(std::size_t gate_id) : NewGate(gate_id) {}
+  bool need_setup() const noexcept override { return true; }
+  bool need_online() const noexcept override { return false; }
+  void evaluate_setup() override {}
+  void evaluate_online() override {}
+};
+
+// a chain of gates of which every third one sends its messages under two gate ids
+static void build_construction_test_circuit(MOTION::GateRegister& gate_register,
+                                            std::size_t num_gates) {
+  for (std::size_t gate_i = 0; gate_i < num_gates; ++gate_i) {
+    auto gate_id = gate_register.get_next_gate_ids(gate_i % 3 == 0 ? 2 : 1);
+    gate_register.register_gate(std::make_unique<ConstructionTestGate>(gate_id));
+  }
+}
+
+// subcircuits built concurrently within their scopes get the same ids as when built in order
+TEST(ConstructionScope, BlocksAreIndependentOfThreads) {
+  using MOTION::ConstructionCounter;
+  using MOTION::ConstructionScope;
+  constexpr std::size_t num_instances = 8;
+  constexpr std::size_t num_gates = 1000;
+
+  MOTION::GateRegister serial_register;
+  ConstructionScope tally(ConstructionScope::Mode::tally);
+  {
+    ConstructionScope::Guard guard(tally);
+    build_construction_test_circuit(serial_register, num_gates);
+  }
+  for (std::size_t i = 1; i < num_instances; ++i) {
+    build_construction_test_circuit(serial_register, num_gates);
+  }
+  const auto& counts = tally.get_counts();
+  EXPECT_EQ(counts[std::size_t(ConstructionCounter::gate_slots)], num_gates);
+  EXPECT_EQ(counts[std::size_t(ConstructionCounter::gate_ids)], num_gates + (num_gates + 2) / 3);
+  EXPECT_TRUE(tally.get_serial_reason().empty());
+
+  MOTION::GateRegister concurrent_register;
+  std::vector<ConstructionScope> scopes;
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    auto& scope = scopes.emplace_back(ConstructionScope::Mode::blocks);
+    const auto num_ids = counts[std::size_t(ConstructionCounter::gate_ids)];
+    scope.add_block(ConstructionCounter::gate_ids, concurrent_register.get_next_gate_ids(num_ids),
+                    num_ids);
+    scope.add_block(ConstructionCounter::gate_slots,
+                    concurrent_register.reserve_gate_slots(num_gates), num_gates);
+  }
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    // start with the last instance
+    threads.emplace_back([&concurrent_register, &scope = scopes[num_instances - 1 - i]] {
+      ConstructionScope::Guard guard(scope);
+      build_construction_test_circuit(concurrent_register, num_gates);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& scope : scopes) {
+    EXPECT_NO_THROW(scope.check_exhausted());
+  }
+
+  const auto& serial_gates = serial_register.get_gates();
+  const auto& concurrent_gates = concurrent_register.get_gates();
+  ASSERT_EQ(concurrent_gates.size(), serial_gates.size());
+  for (std::size_t gate_i = 0; gate_i < serial_gates.size(); ++gate_i) {
+    ASSERT_NE(concurrent_gates[gate_i].get(), nullptr);
+    EXPECT_EQ(concurrent_gates[gate_i]->get_gate_id(), serial_gates[gate_i]->get_gate_id());
+  }
+  EXPECT_EQ(concurrent_register.get_num_gates(), serial_register.get_num_gates());
+  EXPECT_EQ(concurrent_register.get_num_gates_with_setup(), num_instances * num_gates);
+
+  // a block which is too small and steps which need a serial construction are reported
+  ConstructionScope small_scope(ConstructionScope::Mode::blocks);
+  small_scope.add_block(ConstructionCounter::gate_ids, 0, 1);
+  {
+    ConstructionScope::Guard guard(small_scope);
+    EXPECT_EQ(concurrent_register.get_next_gate_id(), 0);
+    EXPECT_THROW(concurrent_register.get_next_gate_id(), std::logic_error);
+    EXPECT_THROW(ConstructionScope::require_serial("OT registrations"), std::logic_error);
+  }
+  EXPECT_FALSE(ConstructionScope::is_active());
+  ConstructionScope serial_tally(ConstructionScope::Mode::tally);
+  {
+    ConstructionScope::Guard guard(serial_tally);
+    ConstructionScope::require_serial("OT registrations");
+  }
+  EXPECT_EQ(serial_tally.get_serial_reason(), "OT registrations");
+}
+
+TEST(MPSCQueue, ProducersAndConsumer) {
+  constexpr std::size_t num_producers = 4;
+  constexpr std::size_t num_items = 10000;
+  ENCRYPTO::MPSCQueue<std::pair<std::size_t, std::size_t>> queue;
+  std::vector<std::thread> producers;
+  for (std::size_t producer_id = 0; producer_id < num_producers; ++producer_id) {
+    producers.emplace_back([&queue, producer_id] {
+      for (std::size_t i = 0; i < num_items; ++i) {
+        queue.enqueue({producer_id, i});
+      }
+    });
+  }
+  auto closer = std::thread([&] {
+    for (auto& t : producers) {
+      t.join();
+    }
+    queue.close();
+  });
+
+  // the elements of each producer arrive in order
+  std::vector<std::size_t> next(num_producers, 0);
+  std::vector<std::pair<std::size_t, std::size_t>> batch;
+  std::size_t num_batches = 0;
+  while (queue.batch_dequeue(batch)) {
+    EXPECT_FALSE(batch.empty());
+    ++num_batches;
+    for (const auto& [producer_id, i] : batch) {
+      ASSERT_EQ(i, next.at(producer_id));
+      ++next.at(producer_id);
+    }
+  }
+  closer.join();
+  for (std::size_t n : next) {
+    EXPECT_EQ(n, num_items);
+  }
+  EXPECT_TRUE(queue.empty());
+  EXPECT_THROW(queue.enqueue({0, 0}), std::logic_error);
+
+  const auto stats = queue.get_statistics();
+  EXPECT_EQ(stats.num_batches, num_batches);
+  EXPECT_EQ(stats.num_elements, num_producers * num_items);
+  EXPECT_LE(stats.max_batch_size, num_producers * num_items);
+  queue.reset_statistics();
+  EXPECT_EQ(queue.get_statistics().num_elements, 0);
+}
+
+template <typename T>
+void test_mul_kernels() {
+  constexpr std::size_t n = 1001;
+  std::mt19937_64 rng(42);
+  auto random_vector = [&rng] {
+    std::vector<T> v(n);
+    std::generate(std::begin(v), std::end(v), [&rng] { return static_cast<T>(rng()); });
+    return v;
+  };
+  const auto x = random_vector(), y = random_vector(), a = random_vector(), b = random_vector(),
+             c = random_vector();
+  std::vector<T> de(2 * n);
+  MOTION::proto::beaver_mask(x.data(), y.data(), a.data(), b.data(), de.data(), n);
+  for (bool subtract_de : {false, true}) {
+    std::vector<T> z(n);
+    MOTION::proto::beaver_combine(c.data(), de.data(), x.data(), y.data(), z.data(), n,
+                                  subtract_de);
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::uint64_t d = T(x[i] - a[i]), e = T(y[i] - b[i]);
+      ASSERT_EQ(de[i], T(d));
+      ASSERT_EQ(de[n + i], T(e));
+      ASSERT_EQ(z[i], T(c[i] + e * x[i] + d * y[i] - (subtract_de ? d * e : 0)));
+    }
+  }
+  for (bool add_Delta_ab : {false, true}) {
+    auto Delta_y = c;
+    MOTION::proto::beavy_mul_online(Delta_y.data(), x.data(), y.data(), a.data(), b.data(), n,
+                                    add_Delta_ab);
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::uint64_t expected = std::uint64_t(c[i]) - std::uint64_t(x[i]) * b[i] -
+                                     std::uint64_t(y[i]) * a[i] +
+                                     (add_Delta_ab ? std::uint64_t(x[i]) * y[i] : 0);
+      ASSERT_EQ(Delta_y[i], T(expected));
+    }
+    Delta_y = c;
+    MOTION::proto::beavy_sqr_online(Delta_y.data(), x.data(), a.data(), n, add_Delta_ab);
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::uint64_t expected = std::uint64_t(c[i]) - 2 * std::uint64_t(x[i]) * a[i] +
+                                     (add_Delta_ab ? std::uint64_t(x[i]) * x[i] : 0);
+      ASSERT_EQ(Delta_y[i], T(expected));
+    }
+  }
+  for (bool with_delta_y : {false, true}) {
+    std::vector<T> Delta_y(n);
+    MOTION::proto::beavy_mul_setup(Delta_y.data(), a.data(), b.data(),
+                                   with_delta_y ? c.data() : nullptr, x.data(), y.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::uint64_t expected = std::uint64_t(a[i]) * b[i] + (with_delta_y ? c[i] : 0) +
+                                     std::uint64_t(x[i]) + y[i];
+      ASSERT_EQ(Delta_y[i], T(expected));
+    }
+  }
+  std::vector<T> Delta_y(n);
+  MOTION::proto::beavy_sqr_setup(Delta_y.data(), a.data(), c.data(), x.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(Delta_y[i], T(std::uint64_t(a[i]) * a[i] + c[i] + 2 * std::uint64_t(x[i])));
+  }
+}
+
+TEST(MulKernels, MatchPlainArithmetic) {
+  test_mul_kernels<std::uint8_t>();
+  test_mul_kernels<std::uint16_t>();
+  test_mul_kernels<std::uint32_t>();
+  test_mul_kernels<std::uint64_t>();
+}
+
+// all tasks run with each placement, and on workers assigned to one of the pool's nodes
+TEST(FiberThreadPool, ThreadPlacement) {
+  using ENCRYPTO::ThreadPlacement;
+  for (auto placement : {ThreadPlacement::none, ThreadPlacement::pinned, ThreadPlacement::numa}) {
+    ENCRYPTO::FiberThreadPool pool(4, 0, true, placement);
+    const auto num_nodes = pool.get_num_nodes();
+    EXPECT_GE(num_nodes, 1);
+    if (placement != ThreadPlacement::numa) {
+      EXPECT_EQ(num_nodes, 1);
+    }
+    constexpr std::size_t num_tasks = 100;
+    std::atomic<std::size_t> num_finished = 0;
+    std::atomic<std::size_t> num_invalid_nodes = 0;
+    std::promise<void> all_finished;
+    for (std::size_t task_i = 0; task_i < num_tasks; ++task_i) {
+      const auto node = task_i % num_nodes;
+      pool.post(
+          [&] {
+            // the fiber may have been stolen by a worker of another node
+            if (ENCRYPTO::get_this_thread_numa_node() >= num_nodes) {
+              ++num_invalid_nodes;
+            }
+            if (++num_finished == num_tasks) {
+              all_finished.set_value();
+            }
+          },
+          node);
+    }
+    all_finished.get_future().wait();
+    pool.join();
+    EXPECT_EQ(num_finished, num_tasks);
+    EXPECT_EQ(num_invalid_nodes, 0);
+  }
+}
+
+// tasks run on stacks of their size class, which are returned to the pool and then to the OS
+TEST(FiberThreadPool, StackClasses) {
+  using MOTION::FiberStackClass;
+  ENCRYPTO::FiberThreadPool pool(2);
+  constexpr std::size_t num_tasks = 300;
+  std::atomic<std::size_t> num_finished = 0;
+  std::promise<void> all_finished;
+  for (std::size_t task_i = 0; task_i < num_tasks; ++task_i) {
+    const auto stack_class = FiberStackClass(task_i % MOTION::num_fiber_stack_classes);
+    pool.post(
+        [&, stack_class] {
+          if (stack_class == FiberStackClass::large) {
+            // more than the regular stack size
+            std::array<volatile std::byte, 32 * 1024> buffer;
+            buffer.front() = std::byte(0x42);
+            buffer.back() = std::byte(0x42);
+          }
+          boost::this_fiber::yield();
+          if (++num_finished == num_tasks) {
+            all_finished.set_value();
+          }
+        },
+        0, stack_class);
+  }
+  all_finished.get_future().wait();
+  // the last fiber may still be finishing
+  while (pool.get_stack_statistics().num_stacks_in_use > 0) {
+    std::this_thread::yield();
+  }
+  auto stats = pool.get_stack_statistics();
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_GE(stats.peak_bytes_in_use, MOTION::MOTION_FIBER_STACK_SIZES.back());
+  // a large task never runs on a smaller stack
+  EXPECT_GE(stats.num_allocations[std::size_t(FiberStackClass::large)], 1);
+  if constexpr (MOTION::MOTION_FIBER_STACK_ALLOCATOR ==
+                MOTION::FiberStackAllocator::pooled_fixedsize) {
+    EXPECT_GE(stats.bytes_reserved, stats.peak_bytes_in_use);
+  }
+  pool.release_unused_stacks();
+  EXPECT_EQ(pool.get_stack_statistics().bytes_reserved, 0);
+  pool.reset_stack_statistics();
+  stats = pool.get_stack_statistics();
+  EXPECT_EQ(stats.peak_bytes_in_use, 0);
+  EXPECT_EQ(stats.num_allocations[std::size_t(FiberStackClass::large)], 0);
+  pool.join();
+}
+
+// the chunks of parallel_for cover the range once, also when called from a task of the pool
+TEST(ExecutionContext, ParallelFor) {
+  ENCRYPTO::FiberThreadPool pool(3);
+  const MOTION::ExecutionContext exec_ctx{.num_threads_ = 3, .fpool_ = &pool};
+  auto check = [&exec_ctx](std::size_t size, std::size_t granularity) {
+    std::vector<std::atomic<std::size_t>> counts(size);
+    exec_ctx.parallel_for(size, granularity, [&](auto begin, auto end) {
+      EXPECT_EQ(begin % granularity, 0);
+      for (auto i = begin; i < end; ++i) {
+        ++counts[i];
+      }
+    });
+    EXPECT_TRUE(std::all_of(std::begin(counts), std::end(counts), [](auto& c) { return c == 1; }));
+  };
+  for (std::size_t size : {0, 1, 7, 64, 1000}) {
+    check(size, 1);
+    check(size, 64);
+  }
+  std::promise<void> done;
+  pool.post([&] {
+    check(1000, 8);
+    EXPECT_THROW(exec_ctx.parallel_for(100, 1,
+                                       [](auto begin, auto) {
+                                         if (begin > 0) {
+                                           throw std::runtime_error("chunk failed");
+                                         }
+                                       }),
+                 std::runtime_error);
+    done.set_value();
+  });
+  done.get_future().wait();
+  pool.join();
+}
+
+TEST(GateProfiler, AggregatesByTypeAndRange) {
+  using MOTION::Statistics::GateProfiler;
+  GateProfiler profiler(10);
+  profiler.start({{3, "AND"}, {8, "XOR"}, {12, "AND"}});
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&profiler] {
+      profiler.record_time(GateProfiler::Phase::setup, 3, std::chrono::milliseconds(1));
+      profiler.record_time(GateProfiler::Phase::online, 12, std::chrono::milliseconds(2));
+      profiler.record_sent(8, 100, 2);
+      profiler.record_received(12, 50);
+      profiler.record_received(42, 7);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto profile = profiler.get_profile();
+  ASSERT_EQ(profile.by_type_.size(), 2);
+  const auto& and_entry = profile.by_type_.at("AND");
+  EXPECT_EQ(and_entry.num_gates_, 2);
+  EXPECT_DOUBLE_EQ(and_entry.setup_time_ms_, 4.0);
+  EXPECT_DOUBLE_EQ(and_entry.online_time_ms_, 8.0);
+  EXPECT_EQ(and_entry.num_bytes_received_, 200);
+  EXPECT_EQ(and_entry.num_messages_received_, 4);
+  const auto& xor_entry = profile.by_type_.at("XOR");
+  EXPECT_EQ(xor_entry.num_bytes_sent_, 800);
+  EXPECT_EQ(xor_entry.num_messages_sent_, 8);
+
+  ASSERT_EQ(profile.by_gate_id_range_.size(), 2);
+  EXPECT_EQ(profile.by_gate_id_range_.at(0).num_gates_, 2);
+  EXPECT_EQ(profile.by_gate_id_range_.at(0).num_bytes_sent_, 800);
+  EXPECT_EQ(profile.by_gate_id_range_.at(10).num_gates_, 1);
+  EXPECT_EQ(profile.unknown_gates_.num_bytes_received_, 28);
+
+  // a new circuit starts from scratch
+  profiler.start({{20, "XOR"}});
+  const auto next_profile = profiler.get_profile();
+  EXPECT_EQ(next_profile.by_type_.at("XOR").num_bytes_sent_, 0);
+  EXPECT_EQ(next_profile.unknown_gates_.num_messages_received_, 0);
+}
+
+TEST(TraceRecorder, WriteAndMergeChromeTraces) {
+  using MOTION::Statistics::TraceRecorder;
+  std::vector<std::unique_ptr<TraceRecorder>> recorders;
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    auto& recorder = *recorders.emplace_back(std::make_unique<TraceRecorder>(party_id));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 3; ++t) {
+      threads.emplace_back([&recorder, t] {
+        const auto begin = TraceRecorder::clock_type::now();
+        recorder.record(fmt::format("gate \"{}\"", t), "online", begin,
+                        begin + std::chrono::microseconds(5), fmt::format("\"gate_id\":{}", t));
+        recorder.record("send", "communication", begin, begin);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(recorder.get_num_events(), 6);
+  }
+
+  std::stringstream stream;
+  recorders[1]->write_chrome_trace(stream);
+  const auto trace = stream.str();
+  EXPECT_NE(trace.find("\"name\":\"party 1\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"gate \\\"2\\\"\""), std::string::npos);
+  EXPECT_NE(trace.find("\"gate_id\":2"), std::string::npos);
+
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::vector<std::string> paths = {(dir / "motion_trace_0.json").string(),
+                                          (dir / "motion_trace_1.json").string()};
+  const auto merged_path = (dir / "motion_trace_merged.json").string();
+  for (std::size_t party_id = 0; party_id < 2; ++party_id) {
+    recorders[party_id]->write_chrome_trace(paths[party_id]);
+  }
+  MOTION::Statistics::merge_chrome_traces(paths, merged_path);
+  std::ifstream merged(merged_path);
+  const std::string merged_trace(std::istreambuf_iterator<char>(merged), {});
+  // per party: process name, 3 thread names and 6 events
+  std::size_t num_events = 0;
+  for (auto pos = merged_trace.find("\"ph\":"); pos != std::string::npos;
+       pos = merged_trace.find("\"ph\":", pos + 1)) {
+    ++num_events;
+  }
+  EXPECT_EQ(num_events, 20);
+  for (const auto& path : paths) {
+    std::filesystem::remove(path);
+  }
+  std::filesystem::remove(merged_path);
+
+  recorders[0]->clear();
+  EXPECT_EQ(recorders[0]->get_num_events(), 0);
+}
+
+
+class AnalysisTestWire : public MOTION::NewWire {
+ public:
+  AnalysisTestWire() : NewWire(1) {}
+  MOTION::MPCProtocol get_protocol() const noexcept override {
+    return MOTION::MPCProtocol::BooleanBEAVY;
+  }
+  std::size_t get_bit_size() const noexcept override { return 1; }
+};
+
+class AnalysisTestGate : public MOTION::NewGate {
+ public:
+  AnalysisTestGate(std::size_t gate_id, std::vector<const MOTION::NewWire*> inputs,
+                   std::optional<MOTION::GateCost> cost)
+      : NewGate(gate_id), inputs_(std::move(inputs)), cost_(cost) {}
+  bool need_setup() const noexcept override { return false; }
+  bool need_online() const noexcept override { return false; }
+  void evaluate_setup() override {}
+  void evaluate_online() override {}
+  std::optional<MOTION::GateCost> get_cost() const override { return cost_; }
+  void collect_input_wires(std::vector<const MOTION::NewWire*>& wires) const override {
+    wires.insert(std::end(wires), std::begin(inputs_), std::end(inputs_));
+  }
+  void collect_output_wires(std::vector<const MOTION::NewWire*>& wires) const override {
+    wires.push_back(&output_);
+  }
+  const MOTION::NewWire* get_output() const noexcept { return &output_; }
+
+ private:
+  std::vector<const MOTION::NewWire*> inputs_;
+  std::optional<MOTION::GateCost> cost_;
+  AnalysisTestWire output_;
+};
+
+TEST(CircuitAnalysis, CriticalPathAndDepths) {
+  using MOTION::GateCost;
+  using MOTION::MPCProtocol;
+  MOTION::GateRegister gate_register;
+  std::vector<const AnalysisTestGate*> gates;
+  const auto add_gate = [&](std::vector<std::size_t> inputs, std::optional<GateCost> cost) {
+    std::vector<const MOTION::NewWire*> wires;
+    for (auto gate_i : inputs) {
+      wires.push_back(gates.at(gate_i)->get_output());
+    }
+    auto gate = std::make_unique<AnalysisTestGate>(gate_register.get_next_gate_id(),
+                                                   std::move(wires), cost);
+    gates.push_back(gate.get());
+    gate_register.register_gate(std::move(gate));
+  };
+  const auto beavy = [](std::size_t rounds, std::size_t online_bytes) {
+    return GateCost{.protocol_ = MPCProtocol::BooleanBEAVY,
+                    .setup_bytes_ = 1,
+                    .online_bytes_ = online_bytes,
+                    .num_ots_ = 2,
+                    .online_rounds_ = rounds};
+  };
+  // BEAVY inputs 0 and 1 and AND gates 2 and 3, a conversion 4 and a Yao AND 5 and output 6
+  add_gate({}, beavy(1, 4));
+  add_gate({}, beavy(0, 0));
+  add_gate({0, 1}, beavy(1, 8));
+  add_gate({1}, beavy(1, 8));
+  add_gate({2}, std::nullopt);
+  add_gate({4}, GateCost{.protocol_ = MPCProtocol::Yao, .setup_bytes_ = 64});
+  add_gate({5, 3}, GateCost{.protocol_ = MPCProtocol::Yao, .online_rounds_ = 1});
+
+  const auto analysis = MOTION::Statistics::analyze_circuit(gate_register);
+  EXPECT_EQ(analysis.online_rounds_, 3);
+  EXPECT_EQ(analysis.critical_path_, (std::vector<std::size_t>{gates[0]->get_gate_id(),
+                                                               gates[2]->get_gate_id(),
+                                                               gates[6]->get_gate_id()}));
+  const auto& beavy_entry = analysis.by_protocol_.at(MPCProtocol::BooleanBEAVY);
+  EXPECT_EQ(beavy_entry.num_gates_, 4);
+  EXPECT_EQ(beavy_entry.num_interactive_gates_, 3);
+  EXPECT_EQ(beavy_entry.online_depth_, 2);
+  EXPECT_EQ(beavy_entry.setup_bytes_, 4);
+  EXPECT_EQ(beavy_entry.online_bytes_, 20);
+  EXPECT_EQ(beavy_entry.num_ots_, 8);
+  const auto& yao_entry = analysis.by_protocol_.at(MPCProtocol::Yao);
+  EXPECT_EQ(yao_entry.online_depth_, 1);
+  EXPECT_EQ(analysis.get_setup_bytes(), 68);
+  EXPECT_EQ(analysis.unmodeled_gates_.size(), 1);
+  EXPECT_NE(analysis.print_human_readable().find("AnalysisTestGate"), std::string::npos);
+
+  // a Boolean circuit in BEAVY needs as many rounds as its AND depth
+  MOTION::CircuitLoader circuit_loader;
+  const auto& algo =
+      circuit_loader.load_circuit("int_add8_size.bristol", MOTION::CircuitFormat::Bristol);
+  const auto circuit_stats = ENCRYPTO::ComputeCircuitStatistics(algo);
+  const auto algo_analysis =
+      MOTION::Statistics::analyze_circuit(algo, MPCProtocol::BooleanBEAVY, 8);
+  EXPECT_EQ(algo_analysis.online_rounds_, circuit_stats.and_depth);
+  EXPECT_EQ(algo_analysis.get_online_bytes(),
+            circuit_stats.num_and_gates + circuit_stats.num_or_gates);
+  EXPECT_THROW(MOTION::Statistics::analyze_circuit(algo, MPCProtocol::ArithmeticGMW),
+               std::invalid_argument);
+}
+
+TEST(AccumulatedStats, PercentilesOverRepetitions) {
+  EXPECT_EQ(MOTION::Statistics::compute_percentile({}, 50), 0);
+  EXPECT_DOUBLE_EQ(MOTION::Statistics::compute_percentile({4, 1, 3, 2}, 50), 2.5);
+  EXPECT_DOUBLE_EQ(MOTION::Statistics::compute_percentile({4, 1, 3, 2}, 100), 4);
+
+  using StatID = MOTION::Statistics::RunTimeStats::StatID;
+  MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+  MOTION::Statistics::AccumulatedCommunicationStats comm_stats;
+  for (std::size_t i = 1; i <= 100; ++i) {
+    MOTION::Statistics::RunTimeStats stats;
+    auto& [start, end] = stats.data_[static_cast<std::size_t>(StatID::evaluate)];
+    end = start + std::chrono::milliseconds(i);
+    run_time_stats.add(stats);
+    MOTION::Communication::TransportStatistics transport_stats;
+    transport_stats.num_bytes_sent = 1000 * i;
+    comm_stats.add(transport_stats);
+  }
+  EXPECT_EQ(run_time_stats.samples_[static_cast<std::size_t>(StatID::evaluate)].size(), 100);
+  EXPECT_DOUBLE_EQ(run_time_stats.get_percentile(StatID::evaluate, 50), 50.5);
+  EXPECT_NEAR(run_time_stats.get_percentile(StatID::evaluate, 99), 99.01, 1e-9);
+  EXPECT_DOUBLE_EQ(run_time_stats.get_percentile(StatID::evaluate, 100), 100);
+  using CommStats = MOTION::Statistics::AccumulatedCommunicationStats;
+  EXPECT_DOUBLE_EQ(comm_stats.get_percentile(CommStats::idx_num_bytes_sent, 90), 90100);
+  EXPECT_DOUBLE_EQ(comm_stats.get_percentile(CommStats::idx_num_bytes_received, 90), 0);
+}
+
+TEST(MemoryTracker, PeakPerPhase) {
+  using ByteVector = std::vector<std::byte, ENCRYPTO::CountingAllocator<std::byte>>;
+  using StatID = MOTION::Statistics::RunTimeStats::StatID;
+  auto& tracker = ENCRYPTO::MemoryTracker::get_instance();
+  MOTION::Statistics::RunTimeStats stats;
+
+  stats.record_start<StatID::gates_setup>();
+  const auto start = tracker.get_current_bytes();
+  {
+    ByteVector temporary(4096);
+  }
+  ByteVector kept(1024);
+  stats.record_end<StatID::gates_setup>();
+
+  const auto& memory = stats.get_memory(StatID::gates_setup);
+  EXPECT_GE(memory.tracked_peak_bytes_, start + 4096);
+  EXPECT_EQ(memory.tracked_allocated_bytes_, 1024);
+  EXPECT_GT(memory.peak_rss_bytes_, 0);
+  EXPECT_EQ(stats.get_memory(StatID::gates_online).peak_rss_bytes_, 0);
+
+  MOTION::Statistics::AccumulatedRunTimeStats run_time_stats;
+  run_time_stats.add(stats);
+  const auto json = run_time_stats.to_json();
+  const auto& memory_json = json.at("memory").as_object().at("gates_setup").as_object();
+  EXPECT_EQ(memory_json.at("tracked_allocated_bytes").as_int64(), 1024);
+}
+
+TEST(HardwareCounters, CountsPerPhase) {
+  MOTION::Statistics::HardwareCounterStats start{100, 150, 40, 10, 30, 3};
+  MOTION::Statistics::HardwareCounterStats end{1100, 2150, 140, 35, 530, 8};
+  const auto phase = end - start;
+  EXPECT_EQ(phase.cycles_, 1000);
+  EXPECT_EQ(phase.instructions_, 2000);
+  EXPECT_DOUBLE_EQ(phase.get_ipc(), 2);
+  EXPECT_DOUBLE_EQ(phase.get_cache_miss_rate(), 0.25);
+  EXPECT_DOUBLE_EQ(phase.get_branch_miss_rate(), 0.01);
+  EXPECT_EQ(MOTION::Statistics::HardwareCounterStats{}.get_ipc(), 0);
+
+  // the counters are usually not permitted in containers, then they stay 0
+  const auto& counters = MOTION::Statistics::HardwareCounters::get_instance();
+  const auto before = counters.read();
+  volatile std::uint64_t sum = 0;
+  for (std::uint64_t i = 0; i < 1'000'000; ++i) {
+    sum = sum + i;
+  }
+  const auto after = counters.read();
+  EXPECT_GE(after.instructions_, before.instructions_);
+  if (!counters.is_available()) {
+    EXPECT_EQ(after.instructions_, 0);
+  }
+}
+
+TEST(ThreadAllocator, AdaptsToUtilization) {
+  using StatID = MOTION::Statistics::RunTimeStats::StatID;
+  MOTION::ThreadAllocator allocator(16, 4);
+  EXPECT_EQ(allocator.get_phase_threads().preprocessing_, 16);
+  EXPECT_EQ(allocator.get_phase_threads().gates_setup_, 4);
+  EXPECT_EQ(allocator.get_phase_threads().gates_online_, 1);
+
+  // each phase takes 100 ms
+  MOTION::Statistics::RunTimeStats stats;
+  const auto set_phase = [&stats](StatID id, double cpu_time_ms) {
+    auto& [start, end] = stats.data_[static_cast<std::size_t>(id)];
+    end = start + std::chrono::milliseconds(100);
+    stats.cpu_[static_cast<std::size_t>(id)].cpu_time_ms_ = cpu_time_ms;
+  };
+  // the preprocessing waits for the network, the setup uses all CPUs, and the online phase
+  // keeps its workers busy
+  set_phase(StatID::preprocessing, 400);
+  set_phase(StatID::gates_setup, 1500);
+  set_phase(StatID::gates_online, 390);
+  EXPECT_DOUBLE_EQ(stats.get_busy_cpus(StatID::preprocessing), 4);
+  allocator.update(stats);
+  EXPECT_EQ(allocator.get_phase_threads().preprocessing_, 8);
+  EXPECT_EQ(allocator.get_phase_threads().gates_setup_, 4);
+  EXPECT_EQ(allocator.get_phase_threads().gates_online_, 2);
+
+  // phases which did not run keep their threads
+  allocator.update(MOTION::Statistics::RunTimeStats{});
+  EXPECT_EQ(allocator.get_phase_threads().preprocessing_, 8);
+  EXPECT_EQ(allocator.get_phase_threads().gates_online_, 2);
+}
+
+TEST(MetricsRegistry, PrometheusText) {
+  MOTION::Statistics::MetricsRegistry registry;
+  auto& counter = registry.get_counter("test_bytes_total", "Bytes", {{"party_id", "1"}});
+  counter.increment(40);
+  registry.get_counter("test_bytes_total", "Bytes", {{"party_id", "1"}}).increment(2);
+  EXPECT_EQ(counter.get(), 42);
+  registry.get_gauge("test_depth", "Depth").set(3);
+  auto& histogram = registry.get_histogram("test_seconds", "Time", {0.1, 1});
+  histogram.observe(0.05);
+  histogram.observe(0.5);
+  histogram.observe(5);
+  EXPECT_THROW(registry.get_gauge("test_bytes_total", "Bytes"), std::logic_error);
+
+  const auto text = registry.to_prometheus_text();
+  EXPECT_NE(text.find("# TYPE test_bytes_total counter\ntest_bytes_total{party_id=\"1\"} 42\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_depth 3\n"), std::string::npos);
+  EXPECT_NE(text.find("test_seconds_bucket{le=\"0.1\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("test_seconds_bucket{le=\"1\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("test_seconds_bucket{le=\"+Inf\"} 3\n"), std::string::npos);
+  EXPECT_NE(text.find("test_seconds_count 3\n"), std::string::npos);
+
+  const auto path =
+      (std::filesystem::temp_directory_path() / "motion_test_metrics.prom").string();
+  MOTION::Statistics::PrometheusTextFileExporter exporter(path);
+  exporter.export_metrics(registry);
+  std::ifstream stream(path);
+  std::stringstream content;
+  content << stream.rdbuf();
+  EXPECT_EQ(content.str(), text);
+  std::filesystem::remove(path);
+}
+
+TEST(PerformanceBaseline, DetectsRegressions) {
+  using MOTION::Statistics::MetricComparison;
+  using MOTION::Statistics::MetricKind;
+  EXPECT_EQ(MOTION::Statistics::get_metric_kind("gates_online.time_ms"), MetricKind::time);
+  EXPECT_EQ(MOTION::Statistics::get_metric_kind("online_rounds"), MetricKind::rounds);
+  EXPECT_EQ(MOTION::Statistics::get_metric_kind("gate.AND.bytes_sent"),
+            MetricKind::communication);
+  EXPECT_EQ(MOTION::Statistics::get_metric_kind("gates_setup.peak_rss_growth_bytes"),
+            MetricKind::memory);
+
+  MOTION::Statistics::PerformanceBaseline baseline;
+  baseline.tolerances_.time_ = 0.1;
+  baseline.tolerances_.time_slack_ms_ = 1.0;
+  baseline.set_case("exact", {{"gates_online.time_ms", 100.0},
+                              {"online_rounds", 4.0},
+                              {"bytes_sent", 1000.0},
+                              {"gate.AND.online_time_ms", 10.0},
+                              {"gate.XOR.online_time_ms", 5.0}});
+  EXPECT_THROW(baseline.compare("wildcard", {}), std::invalid_argument);
+
+  // within the tolerance, only the one additional round is a regression
+  auto comparisons = baseline.compare("exact", {{"gates_online.time_ms", 110.5},
+                                                {"online_rounds", 5.0},
+                                                {"bytes_sent", 1000.0},
+                                                {"gate.AND.online_time_ms", 10.0},
+                                                {"gate.XOR.online_time_ms", 5.0}});
+  EXPECT_TRUE(MOTION::Statistics::has_regression(comparisons));
+  for (const auto& comparison : comparisons) {
+    EXPECT_EQ(comparison.status_, comparison.metric_ == "online_rounds"
+                                      ? MetricComparison::Status::regression
+                                      : MetricComparison::Status::ok)
+        << comparison.metric_;
+  }
+
+  // slower AND gates are reported under their gate type, faster XOR gates are no regression
+  comparisons = baseline.compare("exact", {{"gates_online.time_ms", 100.0},
+                                           {"online_rounds", 4.0},
+                                           {"bytes_sent", 1000.0},
+                                           {"gate.AND.online_time_ms", 20.0},
+                                           {"gate.XOR.online_time_ms", 1.0},
+                                           {"gate.OR.online_time_ms", 1.0}});
+  EXPECT_TRUE(MOTION::Statistics::has_regression(comparisons));
+  const auto status_of = [&comparisons](const std::string& metric) {
+    for (const auto& comparison : comparisons) {
+      if (comparison.metric_ == metric) {
+        return comparison.status_;
+      }
+    }
+    return MetricComparison::Status::missing;
+  };
+  EXPECT_EQ(status_of("gate.AND.online_time_ms"), MetricComparison::Status::regression);
+  EXPECT_EQ(status_of("gate.XOR.online_time_ms"), MetricComparison::Status::improvement);
+  EXPECT_EQ(status_of("gate.OR.online_time_ms"), MetricComparison::Status::added);
+  const auto report = MOTION::Statistics::print_comparison("exact", comparisons);
+  EXPECT_NE(report.find("exact: 1 regressions"), std::string::npos) << report;
+  EXPECT_NE(report.find("  AND\n"), std::string::npos) << report;
+
+  // a metric of the baseline which was not measured is reported, but no regression
+  comparisons = baseline.compare("exact", {{"online_rounds", 4.0}});
+  EXPECT_FALSE(MOTION::Statistics::has_regression(comparisons));
+  EXPECT_EQ(status_of("bytes_sent"), MetricComparison::Status::missing);
+}
+
+TEST(HotPathLogSink, WritesRecordsInOrder) {
+  std::vector<std::string> lines;
+  {
+    MOTION::HotPathLogSink sink(4);
+    sink.set_output([&lines](const std::string& line) { lines.push_back(line); });
+    std::size_t num_pushed = 0;
+    for (std::size_t i = 0; i < 3; ++i) {
+      num_pushed += sink.try_push("gate", {{"gate_id", i}, {"num_simd", -1}});
+    }
+    EXPECT_EQ(num_pushed + sink.get_num_dropped(), 3);
+    sink.flush();
+    EXPECT_EQ(lines.size(), num_pushed);
+    // more fields than the records can hold
+    sink.try_push("many", {{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}, {"e", 5}});
+  }
+  ASSERT_GE(lines.size(), 2);
+  EXPECT_NE(lines.front().find("] gate gate_id=0 num_simd=-1"), std::string::npos);
+  EXPECT_NE(lines.back().find("] many a=1 b=2 c=3 d=4"), std::string::npos);
+  EXPECT_EQ(lines.back().find("e=5"), std::string::npos);
+}
+
+TEST(ProtocolAssigner, ChoosesProtocolsForTheNetwork) {
+  using ENCRYPTO::PrimitiveOperationType;
+  using MOTION::MPCProtocol;
+  // a chain of AND gates between two inputs and an output in Boolean GMW
+  std::vector<MOTION::ProtocolAssignmentNode> nodes;
+  nodes.push_back({PrimitiveOperationType::IN, {}, 1, nullptr, MPCProtocol::BooleanGMW});
+  nodes.push_back({PrimitiveOperationType::IN, {}, 1, nullptr, MPCProtocol::BooleanGMW});
+  nodes.push_back({PrimitiveOperationType::AND, {0, 1}});
+  for (std::size_t i = 1; i < 100; ++i) {
+    nodes.push_back({PrimitiveOperationType::AND, {nodes.size() - 1, 1}});
+  }
+  nodes.push_back(
+      {PrimitiveOperationType::OUT, {nodes.size() - 1}, 1, nullptr, MPCProtocol::BooleanGMW});
+  const std::vector<MPCProtocol> protocols = {MPCProtocol::BooleanGMW, MPCProtocol::Yao};
+  const auto no_via = [](auto, auto) { return std::optional<MPCProtocol>(); };
+
+  // the rounds dominate on a slow link, so the chain is garbled
+  auto cost_model = MOTION::ProtocolCostModel::make_default(32);
+  cost_model.round_trip_time = std::chrono::milliseconds(100);
+  const auto wan = MOTION::ProtocolAssigner(cost_model, protocols, no_via).assign(nodes);
+  EXPECT_EQ(wan.protocols_.at(50), MPCProtocol::Yao);
+  EXPECT_EQ(wan.protocols_.back(), MPCProtocol::BooleanGMW);
+  // both inputs to Yao and the result back to GMW
+  EXPECT_EQ(wan.conversions_.size(), 3);
+  EXPECT_NEAR(wan.estimated_time_.count(), 0.1, 1e-9);
+
+  // on a fast link the calibrated garbling time dominates
+  cost_model.round_trip_time = std::chrono::microseconds(10);
+  cost_model.bandwidth = 1e10;
+  cost_model.calibrate(boost::json::parse(R"({"operations": [{"operation": "AND",
+      "protocol": "Yao", "compute_time_us": 10}]})")
+                           .as_object());
+  const auto lan = MOTION::ProtocolAssigner(cost_model, protocols, no_via).assign(nodes);
+  EXPECT_TRUE(std::all_of(std::begin(lan.protocols_), std::end(lan.protocols_),
+                          [](auto proto) { return proto == MPCProtocol::BooleanGMW; }));
+  EXPECT_TRUE(lan.conversions_.empty());
+
+  // entries of a machine profile for other bit sizes and protocols are skipped
+  const auto num_operations = cost_model.operations_.size();
+  cost_model.calibrate(boost::json::parse(R"({"operations": [{"operation": "AND",
+      "protocol": "BooleanGMW", "bit_size": 64, "bits": 0}, {"operation": "AND",
+      "protocol": "BMR", "bits": 0}]})")
+                           .as_object());
+  EXPECT_EQ(cost_model.operations_.size(), num_operations);
+  EXPECT_GT(cost_model.operations_.at({PrimitiveOperationType::AND, MPCProtocol::BooleanGMW}).bits_,
+            0);
+
+  // MUL is not supported by any of the protocols
+  nodes.at(50).operation_ = PrimitiveOperationType::MUL;
+  EXPECT_THROW(MOTION::ProtocolAssigner(cost_model, protocols, no_via).assign(nodes),
+               std::invalid_argument);
+}
+
+TEST(ProtocolAssigner, MovesSharedRegionsToBEAVY) {
+  using ENCRYPTO::PrimitiveOperationType;
+  using MOTION::MPCProtocol;
+  // an AND gate on the inputs whose output is used by 8 further AND gates
+  std::vector<MOTION::ProtocolAssignmentNode> nodes;
+  nodes.push_back({PrimitiveOperationType::IN, {}, 1000});
+  nodes.push_back({PrimitiveOperationType::IN, {}, 1000});
+  nodes.push_back({PrimitiveOperationType::AND, {0, 1}, 1000});
+  for (std::size_t i = 0; i < 8; ++i) {
+    nodes.push_back({PrimitiveOperationType::AND, {2, 1}, 1000});
+  }
+  for (std::size_t i = 3; i < 11; ++i) {
+    nodes.push_back({PrimitiveOperationType::OUT, {i}, 1000, nullptr, MPCProtocol::BooleanGMW});
+  }
+  const auto no_via = [](auto, auto) { return std::optional<MPCProtocol>(); };
+  // a GMW AND opens 64 kbit in 64 ms, a BEAVY AND opens half of it
+  auto cost_model = MOTION::ProtocolCostModel::make_default(32);
+  cost_model.bandwidth = 1e6;
+  const MOTION::ProtocolAssigner assigner(cost_model, {MPCProtocol::BooleanGMW}, no_via);
+
+  // with pooled MTs, GMW sends the fewest bits
+  const auto gmw = assigner.assign_boolean_sharing(nodes, std::chrono::seconds(1));
+  EXPECT_TRUE(std::all_of(std::begin(gmw.protocols_), std::end(gmw.protocols_),
+                          [](auto proto) { return proto == MPCProtocol::BooleanGMW; }));
+  EXPECT_TRUE(gmw.conversions_.empty());
+  EXPECT_NEAR(gmw.estimated_online_time_.count(), 0.128, 1e-9);
+  EXPECT_NEAR(gmw.estimated_bits_, 9 * 64000, 1e-6);
+
+  // the shared gate and the inputs move to BEAVY, the conversions to GMW are local
+  const auto mixed = assigner.assign_boolean_sharing(nodes, std::chrono::milliseconds(100));
+  EXPECT_EQ(mixed.protocols_.at(0), MPCProtocol::BooleanBEAVY);
+  EXPECT_EQ(mixed.protocols_.at(1), MPCProtocol::BooleanBEAVY);
+  EXPECT_EQ(mixed.protocols_.at(2), MPCProtocol::BooleanBEAVY);
+  EXPECT_EQ(mixed.protocols_.at(3), MPCProtocol::BooleanGMW);
+  EXPECT_EQ(mixed.protocols_.back(), MPCProtocol::BooleanGMW);
+  EXPECT_TRUE(std::all_of(std::begin(mixed.conversions_), std::end(mixed.conversions_),
+                          [](const auto& conversion) {
+                            return conversion.src_ == MPCProtocol::BooleanBEAVY &&
+                                   conversion.dst_ == MPCProtocol::BooleanGMW;
+                          }));
+  EXPECT_NEAR(mixed.estimated_online_time_.count(), 0.096, 1e-9);
+  EXPECT_GT(mixed.estimated_bits_, gmw.estimated_bits_);
+
+  // a budget which cannot be met leaves the critical path in BEAVY
+  const auto beavy = assigner.assign_boolean_sharing(nodes, std::chrono::milliseconds(1));
+  EXPECT_EQ(beavy.protocols_.at(3), MPCProtocol::BooleanBEAVY);
+  EXPECT_NEAR(beavy.estimated_online_time_.count(), 0.064, 1e-9);
+
+  // without the pool, BEAVY needs fewer bits in total
+  const auto unpooled = assigner.assign_boolean_sharing(nodes, std::chrono::seconds(1), false);
+  EXPECT_EQ(unpooled.protocols_.at(2), MPCProtocol::BooleanBEAVY);
+  EXPECT_EQ(unpooled.protocols_.back(), MPCProtocol::BooleanGMW);
+}
+
+TEST(PatternMatchingPlanner, ChoosesPipelinesForTheNetwork) {
+  using MOTION::PatternMatchingPipeline;
+  using MOTION::PatternMatchingPlanner;
+  using MOTION::PatternMatchingType;
+  // a tree of 4-input ANDs needs one round for up to 4 bits, and 3 rounds for 64 bits
+  EXPECT_EQ(PatternMatchingPlanner::get_cost(PatternMatchingType::exact, 1, 1,
+                                             PatternMatchingPipeline::msg)
+                .online_rounds,
+            0);
+  EXPECT_EQ(PatternMatchingPlanner::get_cost(PatternMatchingType::exact, 8, 8,
+                                             PatternMatchingPipeline::msg)
+                .online_rounds,
+            3);
+  // the approximate circuits test each character on its own
+  EXPECT_EQ(PatternMatchingPlanner::get_cost(PatternMatchingType::approximate, 8, 8,
+                                             PatternMatchingPipeline::msg)
+                .online_rounds,
+            2);
+  EXPECT_EQ(PatternMatchingPlanner::get_cost(PatternMatchingType::wildcard, 8, 8,
+                                             PatternMatchingPipeline::ham_eqexp)
+                .online_rounds,
+            2);
+  EXPECT_THROW(PatternMatchingPlanner::get_cost(PatternMatchingType::exact, 0, 8,
+                                                PatternMatchingPipeline::ham_eqexp),
+               std::invalid_argument);
+
+  // without network costs, the pipelines tie and the first one is chosen
+  PatternMatchingPlanner planner;
+  EXPECT_EQ(planner.choose(PatternMatchingType::exact, 2, 2, 1000),
+            PatternMatchingPipeline::ham_eqexp);
+
+  // on a slow link, the single round of the AND tree pays off for short patterns over a small
+  // alphabet and few windows, otherwise its setup communication dominates
+  planner = PatternMatchingPlanner::from_network(MOTION::Communication::NetworkProfile::wan());
+  EXPECT_EQ(planner.choose(PatternMatchingType::exact, 2, 2, 1000), PatternMatchingPipeline::msg);
+  EXPECT_EQ(planner.choose(PatternMatchingType::approximate, 10, 2, 100),
+            PatternMatchingPipeline::msg);
+  EXPECT_EQ(planner.choose(PatternMatchingType::exact, 2, 2, 1'000'000),
+            PatternMatchingPipeline::ham_eqexp);
+  EXPECT_EQ(planner.choose(PatternMatchingType::exact, 16, 8, 1000),
+            PatternMatchingPipeline::ham_eqexp);
+
+  // measured computation times are added to the estimates
+  planner = PatternMatchingPlanner();
+  planner.compute_time_per_bit[PatternMatchingPipeline::ham_eqexp] = std::chrono::nanoseconds(10);
+  EXPECT_EQ(planner.choose(PatternMatchingType::exact, 16, 8, 1000), PatternMatchingPipeline::msg);
+  EXPECT_NEAR(
+      planner.estimate(PatternMatchingType::exact, 16, 8, PatternMatchingPipeline::ham_eqexp, 1000)
+          .count(),
+      128 * 1000 * 10e-9, 1e-12);
+}
+
+}  // namespace
@@ -153,4 +153,85 @@ TEST(MultiplicationTriples, Integer) {
   template_test_integer<std::uint32_t>();
   template_test_integer<std::uint64_t>();
 }
+
+TEST(MultiplicationTriples, Reservoir) {
+  MOTION::MTReservoir reservoir;
+  reservoir.SetCapacity<bool>(100);
+  reservoir.SetCapacity<std::uint32_t>(100);
+  EXPECT_EQ(reservoir.GetNumMissing<bool>(), 100);
+  EXPECT_EQ(reservoir.GetNumMissing<std::uint32_t>(), 100);
+  EXPECT_EQ(reservoir.GetNumMissing<std::uint64_t>(), 0);
+
+  MOTION::BinaryMTVector bit_mts{ENCRYPTO::BitVector<>::Random(100),
+                                 ENCRYPTO::BitVector<>::Random(100),
+                                 ENCRYPTO::BitVector<>::Random(100)};
+  MOTION::IntegerMTVector<std::uint32_t> mts;
+  for (std::uint32_t i = 0; i < 100; ++i) {
+    mts.a.push_back(i);
+    mts.b.push_back(2 * i);
+    mts.c.push_back(3 * i);
+  }
+  reservoir.AddBinary(bit_mts);
+  reservoir.AddInteger(mts);
+  EXPECT_EQ(reservoir.GetSize<bool>(), 100);
+  EXPECT_EQ(reservoir.GetNumMissing<bool>(), 0);
+
+  // the triples are taken in FIFO order
+  auto taken_bits = reservoir.TakeBinary(30);
+  EXPECT_EQ(taken_bits.a, bit_mts.a.Subset(0, 30));
+  EXPECT_EQ(taken_bits.c, bit_mts.c.Subset(0, 30));
+  auto taken = reservoir.TakeInteger<std::uint32_t>(30);
+  ASSERT_EQ(taken.a.size(), 30);
+  EXPECT_EQ(taken.a.at(29), 29);
+  EXPECT_EQ(reservoir.GetNumMissing<bool>(), 30);
+  EXPECT_EQ(reservoir.GetNumMissing<std::uint32_t>(), 30);
+
+  // refilling appends behind the remaining triples
+  reservoir.AddBinary(taken_bits);
+  reservoir.AddInteger(taken);
+  taken_bits = reservoir.TakeBinary(1000);
+  EXPECT_EQ(taken_bits.a.GetSize(), 100);
+  EXPECT_EQ(taken_bits.b.Subset(0, 70), bit_mts.b.Subset(30, 100));
+  EXPECT_EQ(taken_bits.b.Subset(70, 100), bit_mts.b.Subset(0, 30));
+  taken = reservoir.TakeInteger<std::uint32_t>(1000);
+  ASSERT_EQ(taken.a.size(), 100);
+  EXPECT_EQ(taken.b.at(0), 60);
+  EXPECT_EQ(taken.c.at(70), 0);
+  EXPECT_EQ(reservoir.GetSize<std::uint32_t>(), 0);
+  EXPECT_EQ(reservoir.TakeInteger<std::uint32_t>(10).a.size(), 0);
+}
+
+// every party derives its shares on its own, the triples of all parties still fit together
+TEST(MultiplicationTriples, FakeSetup) {
+  for (auto num_parties : num_parties_list) {
+    std::size_t num_mts = 100;
+    std::vector<std::unique_ptr<MOTION::FakeMTProvider>> mt_providers;
+    for (std::size_t party_id = 0; party_id < num_parties; ++party_id) {
+      mt_providers.emplace_back(std::make_unique<MOTION::FakeMTProvider>(party_id, num_parties));
+      mt_providers.back()->RequestBinaryMTs(num_mts);
+      mt_providers.back()->RequestArithmeticMTs<std::uint32_t>(num_mts);
+      mt_providers.back()->PreSetup();
+      mt_providers.back()->Setup();
+    }
+
+    auto bit_mts = mt_providers.at(0)->GetBinaryAll();
+    auto mts = mt_providers.at(0)->GetIntegerAll<std::uint32_t>();
+    for (std::size_t j = 1; j < num_parties; ++j) {
+      bit_mts.a ^= mt_providers.at(j)->GetBinaryAll().a;
+      bit_mts.b ^= mt_providers.at(j)->GetBinaryAll().b;
+      bit_mts.c ^= mt_providers.at(j)->GetBinaryAll().c;
+      const auto& mts_j = mt_providers.at(j)->GetIntegerAll<std::uint32_t>();
+      for (std::size_t k = 0; k < num_mts; ++k) {
+        mts.a.at(k) += mts_j.a.at(k);
+        mts.b.at(k) += mts_j.b.at(k);
+        mts.c.at(k) += mts_j.c.at(k);
+      }
+    }
+    EXPECT_EQ(bit_mts.c.GetSize(), num_mts);
+    EXPECT_EQ(bit_mts.c, bit_mts.a & bit_mts.b);
+    for (std::size_t k = 0; k < num_mts; ++k) {
+      EXPECT_EQ(mts.c.at(k), std::uint32_t(mts.a.at(k) * mts.b.at(k)));
+    }
+  }
+}
 }  // namespace
@@ -22,6 +22,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <thread>
+
 #include "gtest/gtest.h"
 
 #include "test_constants.h"
@@ -31,6 +33,7 @@
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
 #include "data_storage/base_ot_data.h"
+#include "data_storage/ot_extension_data.h"
 
 namespace {
 
@@ -39,6 +42,33 @@ constexpr auto num_parties_list = {2u, 3u};
 template <typename T>
 using vvv = std::vector<std::vector<std::vector<T>>>;
 
+TEST(ObliviousTransfer, OTBatchTable) {
+  MOTION::OTBatchTable table;
+  table.Add(0, 10);
+  table.Add(10, 5);
+  table.Add(20, 1);
+  EXPECT_THROW(table.Add(20, 1), std::logic_error);
+  EXPECT_EQ(table.size(), 3u);
+  EXPECT_EQ(table.Get(10).num_ots_, 5u);
+  EXPECT_THROW(table.Get(5), std::out_of_range);
+
+  table.Get(10).num_messages_ = 2;
+  EXPECT_EQ(table.Get(10).num_messages_, 2u);
+
+  std::thread t([&table] { table.Wait(10, MOTION::OTBatchTable::choices_set); });
+  table.Set(10, MOTION::OTBatchTable::choices_set);
+  t.join();
+  EXPECT_TRUE(table.IsSet(10, MOTION::OTBatchTable::choices_set));
+  EXPECT_FALSE(table.IsSet(10, MOTION::OTBatchTable::outputs_received));
+  EXPECT_FALSE(table.IsSet(0, MOTION::OTBatchTable::choices_set));
+
+  table.ResetFlags();
+  EXPECT_FALSE(table.IsSet(10, MOTION::OTBatchTable::choices_set));
+  EXPECT_EQ(table.size(), 3u);
+  table.Clear();
+  EXPECT_EQ(table.size(), 0u);
+}
+
 TEST(ObliviousTransfer, Random1oo2OTsFromOTExtension) {
   constexpr std::size_t num_ots{10};
   for (auto num_parties : num_parties_list) {
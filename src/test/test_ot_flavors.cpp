@@ -383,3 +383,221 @@ TEST_F(OTFlavorTest, VectorROT) {
     }
   }
 }
+
+class SilentOTFlavorTest : public OTFlavorTest {
+ protected:
+  void SetUp() override {
+    OTFlavorTest::SetUp();
+    for (auto& ot_provider_wrapper : ot_provider_wrappers_) {
+      ot_provider_wrapper->set_backend(ENCRYPTO::ObliviousTransfer::OTBackend::silent_ot);
+    }
+  }
+};
+
+TEST_F(SilentOTFlavorTest, XCOTBit) {
+  const std::size_t num_ots = 1000;
+  const auto correlations = ENCRYPTO::BitVector<>::Random(num_ots);
+  const auto choice_bits = ENCRYPTO::BitVector<>::Random(num_ots);
+  auto ot_sender = get_sender_provider().RegisterSendXCOTBit(num_ots);
+  auto ot_receiver = get_receiver_provider().RegisterReceiveXCOTBit(num_ots);
+
+  run_ot_extension_setup();
+
+  ot_sender->SetCorrelations(correlations);
+  ot_sender->SendMessages();
+
+  ot_receiver->SetChoices(choice_bits);
+  ot_receiver->SendCorrections();
+
+  ot_sender->ComputeOutputs();
+  ot_receiver->ComputeOutputs();
+  const auto sender_output = ot_sender->GetOutputs();
+  const auto receiver_output = ot_receiver->GetOutputs();
+
+  ASSERT_EQ(sender_output.GetSize(), num_ots);
+  ASSERT_EQ(receiver_output.GetSize(), num_ots);
+  ASSERT_EQ(receiver_output, sender_output ^ (choice_bits & correlations));
+}
+
+TEST_F(SilentOTFlavorTest, ACOT) {
+  const std::size_t num_ots = 1000;
+  const auto correlations = MOTION::Helpers::RandomVector<std::uint64_t>(num_ots);
+  const auto choice_bits = ENCRYPTO::BitVector<>::Random(num_ots);
+  auto ot_sender = get_sender_provider().RegisterSendACOT<std::uint64_t>(num_ots);
+  auto ot_receiver = get_receiver_provider().RegisterReceiveACOT<std::uint64_t>(num_ots);
+
+  run_ot_extension_setup();
+
+  ot_sender->SetCorrelations(correlations);
+  ot_sender->SendMessages();
+
+  ot_receiver->SetChoices(choice_bits);
+  ot_receiver->SendCorrections();
+
+  ot_sender->ComputeOutputs();
+  ot_receiver->ComputeOutputs();
+  const auto sender_output = ot_sender->GetOutputs();
+  const auto receiver_output = ot_receiver->GetOutputs();
+
+  EXPECT_EQ(sender_output.size(), num_ots);
+  EXPECT_EQ(receiver_output.size(), num_ots);
+
+  for (std::size_t ot_i = 0; ot_i < num_ots; ++ot_i) {
+    if (choice_bits.Get(ot_i)) {
+      EXPECT_EQ(receiver_output[ot_i], std::uint64_t(sender_output[ot_i] + correlations[ot_i]));
+    } else {
+      EXPECT_EQ(receiver_output[ot_i], sender_output[ot_i]);
+    }
+  }
+}
+
+// the second setup only uses COTs from the pool filled by the first one
+TEST_F(SilentOTFlavorTest, RepeatedROT) {
+  const std::size_t num_ots = 1000;
+  const std::size_t vector_size = 1;
+  const bool random_choice = true;
+  for (std::size_t round_i = 0; round_i < 2; ++round_i) {
+    if (round_i > 0) {
+      for (auto& ot_provider_wrapper : ot_provider_wrappers_) {
+        ot_provider_wrapper->reset();
+      }
+    }
+    auto ot_sender = get_sender_provider().RegisterSendROT(num_ots, vector_size, random_choice);
+    auto ot_receiver =
+        get_receiver_provider().RegisterReceiveROT(num_ots, vector_size, random_choice);
+
+    run_ot_extension_setup();
+
+    ot_receiver->ComputeOutputs();
+    const auto receiver_output = ot_receiver->GetOutputs();
+    const auto choice_bits = ot_receiver->GetChoices();
+    ot_sender->ComputeOutputs();
+    const auto [sender_output_m0, sender_output_m1] = ot_sender->GetOutputs();
+
+    ASSERT_EQ(receiver_output.GetSize(), num_ots * vector_size);
+    ASSERT_EQ(choice_bits.GetSize(), num_ots);
+    ASSERT_NE(sender_output_m0, sender_output_m1);
+
+    for (std::size_t ot_i = 0; ot_i < num_ots; ++ot_i) {
+      if (choice_bits.Get(ot_i)) {
+        ASSERT_EQ(receiver_output.Get(ot_i), sender_output_m1.Get(ot_i));
+      } else {
+        ASSERT_EQ(receiver_output.Get(ot_i), sender_output_m0.Get(ot_i));
+      }
+    }
+  }
+}
+
+// the random OTs are generated before any OTs are registered and derandomized by the setup
+TEST_F(SilentOTFlavorTest, FilledPoolXCOTBit) {
+  const std::size_t num_ots = 1000;
+  std::vector<std::future<void>> futs;
+  for (std::size_t i = 0; i < 2; ++i) {
+    futs.emplace_back(std::async(std::launch::async,
+                                 [this, i] { ot_provider_wrappers_[i]->fill_pools(num_ots); }));
+  }
+  std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+
+  const auto correlations = ENCRYPTO::BitVector<>::Random(num_ots);
+  const auto choice_bits = ENCRYPTO::BitVector<>::Random(num_ots);
+  auto ot_sender = get_sender_provider().RegisterSendXCOTBit(num_ots);
+  auto ot_receiver = get_receiver_provider().RegisterReceiveXCOTBit(num_ots);
+
+  run_ot_extension_setup();
+
+  ot_sender->SetCorrelations(correlations);
+  ot_sender->SendMessages();
+
+  ot_receiver->SetChoices(choice_bits);
+  ot_receiver->SendCorrections();
+
+  ot_sender->ComputeOutputs();
+  ot_receiver->ComputeOutputs();
+  ASSERT_EQ(ot_receiver->GetOutputs(), ot_sender->GetOutputs() ^ (choice_bits & correlations));
+}
+
+class FakeSetupOTFlavorTest : public OTFlavorTest {
+ protected:
+  void SetUp() override {
+    OTFlavorTest::SetUp();
+    for (auto& ot_provider_wrapper : ot_provider_wrappers_) {
+      ot_provider_wrapper->set_backend(ENCRYPTO::ObliviousTransfer::OTBackend::fake_setup);
+    }
+  }
+};
+
+TEST_F(FakeSetupOTFlavorTest, XCOTBit) {
+  const std::size_t num_ots = 1000;
+  const auto correlations = ENCRYPTO::BitVector<>::Random(num_ots);
+  const auto choice_bits = ENCRYPTO::BitVector<>::Random(num_ots);
+  auto ot_sender = get_sender_provider().RegisterSendXCOTBit(num_ots);
+  auto ot_receiver = get_receiver_provider().RegisterReceiveXCOTBit(num_ots);
+
+  run_ot_extension_setup();
+
+  ot_sender->SetCorrelations(correlations);
+  ot_sender->SendMessages();
+
+  ot_receiver->SetChoices(choice_bits);
+  ot_receiver->SendCorrections();
+
+  ot_sender->ComputeOutputs();
+  ot_receiver->ComputeOutputs();
+  const auto sender_output = ot_sender->GetOutputs();
+  const auto receiver_output = ot_receiver->GetOutputs();
+
+  ASSERT_EQ(sender_output.GetSize(), num_ots);
+  ASSERT_EQ(receiver_output.GetSize(), num_ots);
+  ASSERT_EQ(receiver_output, sender_output ^ (choice_bits & correlations));
+}
+
+class StreamingOTFlavorTest : public OTFlavorTest {
+ protected:
+  void SetUp() override {
+    OTFlavorTest::SetUp();
+    for (auto& ot_provider_wrapper : ot_provider_wrappers_) {
+      ot_provider_wrapper->set_streaming_setup(true);
+    }
+  }
+};
+
+// the OTs of the first batch are consumed while the setup of the later ranges is still running
+TEST_F(StreamingOTFlavorTest, XCOTBitAndROT) {
+  const std::size_t num_xcots = 1000;
+  // spans several column ranges of the OT extension
+  const std::size_t num_rots = 100000;
+  const auto correlations = ENCRYPTO::BitVector<>::Random(num_xcots);
+  const auto choice_bits = ENCRYPTO::BitVector<>::Random(num_xcots);
+  auto xcot_sender = get_sender_provider().RegisterSendXCOTBit(num_xcots);
+  auto xcot_receiver = get_receiver_provider().RegisterReceiveXCOTBit(num_xcots);
+  auto rot_sender = get_sender_provider().RegisterSendROT(num_rots, 1, true);
+  auto rot_receiver = get_receiver_provider().RegisterReceiveROT(num_rots, 1, true);
+
+  auto setup_future = std::async(std::launch::async, [this] { run_ot_extension_setup(); });
+
+  xcot_sender->SetCorrelations(correlations);
+  xcot_sender->SendMessages();
+  xcot_receiver->SetChoices(choice_bits);
+  xcot_receiver->SendCorrections();
+  xcot_sender->ComputeOutputs();
+  xcot_receiver->ComputeOutputs();
+  const auto xcot_sender_output = xcot_sender->GetOutputs();
+  const auto xcot_receiver_output = xcot_receiver->GetOutputs();
+  ASSERT_EQ(xcot_receiver_output, xcot_sender_output ^ (choice_bits & correlations));
+
+  rot_receiver->ComputeOutputs();
+  const auto rot_receiver_output = rot_receiver->GetOutputs();
+  const auto rot_choice_bits = rot_receiver->GetChoices();
+  rot_sender->ComputeOutputs();
+  const auto [rot_sender_output_m0, rot_sender_output_m1] = rot_sender->GetOutputs();
+  setup_future.get();
+
+  ASSERT_EQ(rot_receiver_output.GetSize(), num_rots);
+  for (std::size_t ot_i = 0; ot_i < num_rots; ++ot_i) {
+    if (rot_choice_bits.Get(ot_i)) {
+      ASSERT_EQ(rot_receiver_output.Get(ot_i), rot_sender_output_m1.Get(ot_i));
+    } else {
+      ASSERT_EQ(rot_receiver_output.Get(ot_i), rot_sender_output_m0.Get(ot_i));
+    }
+  }
+}
@@ -20,8 +20,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "utility/parking_flag.h"
 #include "utility/reusable_future.h"
 
 namespace {
@@ -90,4 +96,77 @@ TEST(ReusableFuture, RetrieveFutureTwice) {
   EXPECT_THROW(promise.get_future(), std::future_error);
 }
 
+TEST(ReusableFiberFuture, SetTwiceWithReset) {
+  ReusableFiberPromise<std::vector<int>> promise;
+  auto future = promise.get_future();
+  promise.set_value(std::vector<int>{42});
+  EXPECT_THROW(promise.set_value(std::vector<int>{47}), std::future_error);
+  EXPECT_EQ(future.get(), std::vector<int>{42});
+  promise.set_value(std::vector<int>{47});
+  EXPECT_EQ(future.get(), std::vector<int>{47});
+}
+
+// the consumer parks if a value is not there yet and is woken up by the producer
+TEST(ReusableFiberFuture, ProducerAndConsumerThreads) {
+  constexpr int num_values = 100;
+  ReusableFiberPromise<int> value_promise, ack_promise;
+  auto value_future = value_promise.get_future();
+  auto ack_future = ack_promise.get_future();
+  std::thread producer([&] {
+    for (int i = 0; i < num_values; ++i) {
+      value_promise.set_value(i);
+      ack_future.get();
+    }
+  });
+  for (int i = 0; i < num_values; ++i) {
+    ASSERT_EQ(value_future.get(), i);
+    ack_promise.set_value(i);
+  }
+  producer.join();
+}
+
+// all waiters of a flag are woken up
+TEST(FiberFlag, WaitForSet) {
+  FiberFlag flag;
+  std::atomic<int> num_woken = 0;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; ++i) {
+    waiters.emplace_back([&] {
+      flag.Wait();
+      ++num_woken;
+    });
+  }
+  EXPECT_TRUE(flag.Set());
+  EXPECT_FALSE(flag.Set());
+  for (auto& t : waiters) {
+    t.join();
+  }
+  EXPECT_EQ(num_woken, 4);
+  flag.Reset();
+  EXPECT_FALSE(flag.IsSet());
+}
+
+// flags sharing the slots of the parking table only wake up their own waiters
+TEST(CompactFiberFlag, WaitForSet) {
+  EXPECT_EQ(sizeof(CompactFiberFlag), sizeof(std::uint32_t));
+  constexpr std::size_t num_flags = 1024;
+  std::vector<CompactFiberFlag> flags(num_flags);
+  std::vector<std::thread> waiters;
+  std::atomic<std::size_t> num_woken = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    waiters.emplace_back([&, i] {
+      flags[i].Wait();
+      EXPECT_TRUE(flags[i].IsSet());
+      ++num_woken;
+    });
+  }
+  for (std::size_t i = num_flags; i-- > 0;) {
+    flags[i].Set();
+  }
+  for (auto& t : waiters) {
+    t.join();
+  }
+  EXPECT_EQ(num_woken, 4);
+}
+
 }  // namespace
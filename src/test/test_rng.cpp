@@ -20,11 +20,18 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "test_constants.h"
 
+#include "crypto/blake2b.h"
 #include "crypto/random/aes128_ctr_rng.h"
+#include "crypto/random/gate_mask_generator.h"
+#include "crypto/sharing_randomness_generator.h"
 
 // Test vectors from NIST FIPS 197, Appendix A
 
@@ -53,3 +60,104 @@ TEST(AES128_CTR_RNG, no_trivial_output) {
   rngt.random_blocks_aligned(output_1.data(), 10);
   EXPECT_NE(output_0, output_1);
 }
+
+TEST(AES128_CTR_RNG, random_bytes_buffered) {
+  AES128_CTR_RNG rng;
+  // small requests are served from the buffer, large ones bypass it partially
+  for (std::size_t num_bytes : {std::size_t(1), std::size_t(10), std::size_t(100),
+                                AES128_CTR_RNG::buffer_size - 1, AES128_CTR_RNG::buffer_size,
+                                3 * AES128_CTR_RNG::buffer_size + 7}) {
+    std::vector<std::byte> output_0(num_bytes + 1, std::byte(0));
+    std::vector<std::byte> output_1(num_bytes + 1, std::byte(0));
+    rng.random_bytes(output_0.data(), num_bytes);
+    rng.random_bytes(output_1.data(), num_bytes);
+    // the byte after the requested range is untouched
+    EXPECT_EQ(output_0.back(), std::byte(0));
+    EXPECT_EQ(output_1.back(), std::byte(0));
+    // bytes are never handed out twice
+    if (num_bytes >= 10) {
+      EXPECT_NE(output_0, output_1);
+    }
+  }
+
+  // many small requests do not overlap with each other
+  std::vector<std::array<std::byte, 8>> outputs(2 * AES128_CTR_RNG::buffer_size / 8);
+  for (auto& output : outputs) {
+    rng.random_bytes(output.data(), output.size());
+  }
+  std::sort(std::begin(outputs), std::end(outputs));
+  EXPECT_EQ(std::adjacent_find(std::begin(outputs), std::end(outputs)), std::end(outputs));
+}
+
+TEST(SharingRandomnessGenerator, GetUnsigned) {
+  std::array<std::byte, MOTION::Crypto::SharingRandomnessGenerator::MASTER_SEED_BYTE_LENGTH> seed;
+  AES128_CTR_RNG::get_thread_instance().random_bytes(seed.data(), seed.size());
+  MOTION::Crypto::SharingRandomnessGenerator rng_0(0);
+  MOTION::Crypto::SharingRandomnessGenerator rng_1(1);
+  rng_0.Initialize(seed.data());
+  rng_1.Initialize(seed.data());
+
+  // the bulk path produces the same values as single queries and on both sides
+  const std::size_t gate_id = 42, num_values = 100;
+  const auto values = rng_0.GetUnsigned<std::uint32_t>(gate_id, num_values);
+  EXPECT_EQ(values, rng_1.GetUnsigned<std::uint32_t>(gate_id, num_values));
+  for (std::size_t i = 0; i < num_values; ++i) {
+    EXPECT_EQ(values.at(i), rng_1.GetUnsigned<std::uint32_t>(gate_id + i));
+  }
+
+  // the packed values of a shorter request are a prefix of those of a longer one
+  const auto packed = rng_0.GetUnsignedPacked<std::uint16_t>(gate_id, num_values);
+  EXPECT_EQ(packed, rng_1.GetUnsignedPacked<std::uint16_t>(gate_id, num_values));
+  const auto packed_prefix = rng_1.GetUnsignedPacked<std::uint16_t>(gate_id, 13);
+  EXPECT_TRUE(std::equal(std::begin(packed_prefix), std::end(packed_prefix), std::begin(packed)));
+  EXPECT_NE(rng_0.GetUnsignedPacked<std::uint64_t>(gate_id, 2),
+            rng_0.GetUnsigned<std::uint64_t>(gate_id, 2));
+}
+
+TEST(GateMaskGenerator, Regenerate) {
+  std::array<std::byte, aes_block_size> key;
+  AES128_CTR_RNG::get_thread_instance().random_bytes(key.data(), key.size());
+  const GateMaskGenerator generator_0(key.data());
+  const GateMaskGenerator generator_1(key.data());
+  const GateMaskGenerator generator_2;
+
+  // masks can be regenerated from the key and (gate_id, index)
+  const std::size_t gate_id = 42, num_values = 1000;
+  const auto values = generator_0.random_vector<std::uint64_t>(gate_id, num_values);
+  EXPECT_EQ(values, generator_1.random_vector<std::uint64_t>(gate_id, num_values));
+  EXPECT_NE(values, generator_2.random_vector<std::uint64_t>(gate_id, num_values));
+
+  // every (gate_id, index) pair has its own stream, also for neighboring gates
+  const auto prefix = generator_0.random_vector<std::uint64_t>(gate_id, 3);
+  EXPECT_TRUE(std::equal(std::begin(prefix), std::end(prefix), std::begin(values)));
+  EXPECT_NE(values, generator_0.random_vector<std::uint64_t>(gate_id + 1, num_values));
+  EXPECT_NE(values, generator_0.random_vector<std::uint64_t>(gate_id, num_values, 1));
+
+  const auto bits = generator_0.random_bits(gate_id, 77, 3);
+  EXPECT_EQ(bits.GetSize(), 77u);
+  EXPECT_EQ(bits, generator_1.random_bits(gate_id, 77, 3));
+  EXPECT_EQ(bits, generator_1.random_bits(gate_id, 100, 3).Subset(0, 77));
+}
+
+TEST(Blake2b, Batch) {
+  // message sizes of less than one, exactly one and several blocks, and more messages than lanes
+  for (std::size_t message_size : {0, 32, 96, 128, 200}) {
+    const std::size_t num_messages = 11;
+    std::vector<std::uint8_t> messages(num_messages * message_size);
+    AES128_CTR_RNG::get_thread_instance().random_bytes(
+        reinterpret_cast<std::byte*>(messages.data()), messages.size());
+    std::vector<std::uint8_t> digests(num_messages * 64);
+    MOTION::Blake2bBatch(messages.data(), message_size, num_messages, digests.data(), 64);
+    std::vector<std::uint8_t> short_digests(num_messages * 16);
+    MOTION::Blake2bBatch(messages.data(), message_size, num_messages, short_digests.data(), 16);
+
+    for (std::size_t i = 0; i < num_messages; ++i) {
+      std::vector<std::uint8_t> message(messages.data() + i * message_size,
+                                        messages.data() + (i + 1) * message_size);
+      std::array<std::uint8_t, EVP_MAX_MD_SIZE> expected;
+      MOTION::Blake2b(message.data(), expected.data(), message.size());
+      EXPECT_TRUE(std::equal(expected.data(), expected.data() + 64, digests.data() + i * 64));
+      EXPECT_TRUE(std::equal(expected.data(), expected.data() + 16, short_digests.data() + i * 16));
+    }
+  }
+}
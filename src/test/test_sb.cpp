@@ -371,4 +371,51 @@ TYPED_TEST(TwoPartySBProviderTest, SBs) {
   }
 }
 
+template <typename T>
+class TwoPartySBProviderFromROTsTest : public TwoPartySBProviderTest<T> {
+ protected:
+  void SetUp() override {
+    TwoPartySBProviderTest<T>::SetUp();
+    for (std::size_t i = 0; i < 2; ++i) {
+      this->sb_providers_[i] = std::make_unique<MOTION::TwoPartySBProviderFromROTs>(
+          *this->comm_layers_[i], this->ot_provider_managers_[i]->get_provider(1 - i),
+          this->stats_[i], nullptr);
+    }
+  }
+};
+
+TYPED_TEST_SUITE(TwoPartySBProviderFromROTsTest, integer_types);
+
+TYPED_TEST(TwoPartySBProviderFromROTsTest, SBs) {
+  std::size_t num_sbs_a = 47;
+  std::size_t num_sbs_b = 42;
+  auto& sb_provider_0 = *this->sb_providers_[0];
+  auto& sb_provider_1 = *this->sb_providers_[1];
+  auto offset_a_0 = sb_provider_0.template RequestSBs<TypeParam>(num_sbs_a);
+  auto offset_a_1 = sb_provider_1.template RequestSBs<TypeParam>(num_sbs_a);
+  ASSERT_EQ(offset_a_0, offset_a_1);
+  auto offset_b_0 = sb_provider_0.template RequestSBs<TypeParam>(num_sbs_b);
+  auto offset_b_1 = sb_provider_1.template RequestSBs<TypeParam>(num_sbs_b);
+  ASSERT_EQ(offset_b_0, offset_b_1);
+  // SBs of another type are sent in the same message
+  sb_provider_0.template RequestSBs<std::uint64_t>(13);
+  sb_provider_1.template RequestSBs<std::uint64_t>(13);
+
+  this->run_setup();
+
+  const auto& sbs_all_0 = sb_provider_0.template GetSBsAll<TypeParam>();
+  const auto& sbs_all_1 = sb_provider_1.template GetSBsAll<TypeParam>();
+  ASSERT_EQ(sbs_all_0.size(), sbs_all_1.size());
+  ASSERT_GE(sbs_all_0.size(), num_sbs_a + num_sbs_b);
+
+  std::size_t num_ones = 0;
+  for (std::size_t sb_i = 0; sb_i < num_sbs_a + num_sbs_b; ++sb_i) {
+    TypeParam bit = sbs_all_0.at(sb_i) + sbs_all_1.at(sb_i);
+    ASSERT_TRUE(bit == TypeParam(0) || bit == TypeParam(1));
+    num_ones += bit;
+  }
+  EXPECT_GT(num_ones, 0);
+  EXPECT_LT(num_ones, num_sbs_a + num_sbs_b);
+}
+
 }  // namespace
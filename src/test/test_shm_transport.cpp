@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <span>
+#include <vector>
+
+#include <fmt/format.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "communication/shm_transport.h"
+
+using namespace MOTION::Communication;
+
+namespace {
+
+std::pair<std::unique_ptr<Transport>, std::unique_ptr<Transport>> make_shm_transport_pair(
+    const std::string& name, std::size_t ring_size = ShmSetupHelper::default_ring_size) {
+  auto transport_alice_fut = std::async(std::launch::async, [name, ring_size] {
+    ShmSetupHelper helper(0, 2, name, ring_size);
+    return std::move(helper.setup_connections().at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [name, ring_size] {
+    ShmSetupHelper helper(1, 2, name, ring_size);
+    return std::move(helper.setup_connections().at(0));
+  });
+  return {transport_alice_fut.get(), transport_bob_fut.get()};
+}
+
+TEST(ShmTransport, dummy) {
+  auto [transport_alice, transport_bob] =
+      make_shm_transport_pair(fmt::format("motiontest-{}-dummy", getpid()));
+
+  const std::vector<std::uint8_t> message = {0xde, 0xad, 0xbe, 0xef};
+
+  EXPECT_FALSE(transport_bob->available());
+  transport_alice->send_message(message);
+  EXPECT_TRUE(transport_bob->available());
+  auto received_message = transport_bob->receive_message();
+  EXPECT_FALSE(transport_bob->available());
+
+  EXPECT_EQ(received_message, message);
+
+  transport_alice->shutdown_send();
+  EXPECT_EQ(transport_bob->receive_message(), std::nullopt);
+}
+
+TEST(ShmTransport, larger_than_ring) {
+  // the messages do not fit into the ring buffer and need to be streamed through it
+  auto [transport_alice, transport_bob] =
+      make_shm_transport_pair(fmt::format("motiontest-{}-large", getpid()), 1000);
+
+  std::vector<std::vector<std::uint8_t>> messages;
+  for (std::size_t i = 0; i < 10; ++i) {
+    messages.emplace_back(i * 777, static_cast<std::uint8_t>(i));
+  }
+  std::vector<std::span<const std::uint8_t>> buffers(std::begin(messages), std::end(messages));
+
+  auto send_fut = std::async(std::launch::async,
+                             [&transport_alice = transport_alice, &buffers] {
+                               transport_alice->send_messages(buffers);
+                             });
+  for (const auto& message : messages) {
+    EXPECT_EQ(transport_bob->receive_message(), message);
+  }
+  send_fut.get();
+  EXPECT_EQ(transport_bob->get_stats().num_messages_received, messages.size());
+}
+
+TEST(ShmTransport, separate_processes) {
+  const auto name = fmt::format("motiontest-{}-processes", getpid());
+  const std::vector<std::uint8_t> message = {0xde, 0xad, 0xbe, 0xef};
+
+  auto pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    // child: echo one message back to the parent
+    int status = 1;
+    try {
+      ShmSetupHelper helper(1, 2, name);
+      auto transport = std::move(helper.setup_connections().at(0));
+      auto received_message = transport->receive_message();
+      if (received_message.has_value()) {
+        transport->send_message(*received_message);
+        status = 0;
+      }
+      transport->shutdown_send();
+    } catch (...) {
+    }
+    _exit(status);
+  }
+
+  ShmSetupHelper helper(0, 2, name);
+  auto transport = std::move(helper.setup_connections().at(1));
+  transport->send_message(message);
+  EXPECT_EQ(transport->receive_message(), message);
+  EXPECT_EQ(transport->receive_message(), std::nullopt);
+  int status;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+}  // namespace
@@ -22,9 +22,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <future>
+#include <span>
+#include <vector>
 
 #include "communication/tcp_transport.h"
+#include "communication/uring_transport.h"
 
 class TCPTransportTest : public testing::TestWithParam<std::string> {};
 
@@ -54,5 +58,198 @@ TEST_P(TCPTransportTest, dummy) {
   EXPECT_EQ(received_message, message);
 }
 
+TEST_P(TCPTransportTest, send_messages) {
+  auto localhost = GetParam();
+  auto transport_alice_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(0, {{localhost, 13339}, {localhost, 13340}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(1, {{localhost, 13339}, {localhost, 13340}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(0));
+  });
+  auto transport_alice = transport_alice_fut.get();
+  auto transport_bob = transport_bob_fut.get();
+
+  // more messages than fit into a single iovec array
+  std::vector<std::vector<std::uint8_t>> messages;
+  for (std::size_t i = 0; i < 100; ++i) {
+    messages.emplace_back(i % 7, static_cast<std::uint8_t>(i));
+  }
+  std::vector<std::span<const std::uint8_t>> buffers(std::begin(messages), std::end(messages));
+
+  transport_alice->send_messages(buffers);
+  for (const auto& message : messages) {
+    auto received_message = transport_bob->receive_message();
+    EXPECT_EQ(received_message, message);
+  }
+  EXPECT_FALSE(transport_bob->available());
+  EXPECT_EQ(transport_alice->get_stats().num_messages_sent, messages.size());
+  EXPECT_EQ(transport_bob->get_stats().num_messages_received, messages.size());
+}
+
+TEST_P(TCPTransportTest, multi_stream) {
+  constexpr std::size_t num_streams = 3;
+  auto localhost = GetParam();
+  auto transport_alice_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(0, {{localhost, 13341}, {localhost, 13342}},
+                                                 num_streams);
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(1, {{localhost, 13341}, {localhost, 13342}},
+                                                 num_streams);
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(0));
+  });
+  auto transport_alice = transport_alice_fut.get();
+  auto transport_bob = transport_bob_fut.get();
+
+  // small messages around a message large enough to be striped over all streams
+  const std::size_t large_size =
+      MOTION::Communication::MultiStreamTCPTransport::default_striping_threshold + 5;
+  std::vector<std::vector<std::uint8_t>> messages = {
+      {0xde, 0xad}, {}, std::vector<std::uint8_t>(large_size), {0xbe, 0xef}};
+  for (std::size_t i = 0; i < large_size; ++i) {
+    messages[2][i] = static_cast<std::uint8_t>(i * 31);
+  }
+  std::vector<std::span<const std::uint8_t>> buffers(std::begin(messages), std::end(messages));
+
+  transport_alice->send_messages(buffers);
+  transport_alice->send_message(messages[2]);
+  for (const auto& message : messages) {
+    auto received_message = transport_bob->receive_message();
+    EXPECT_EQ(received_message, message);
+  }
+  auto received_message = transport_bob->receive_message();
+  EXPECT_EQ(received_message, messages[2]);
+  EXPECT_FALSE(transport_bob->available());
+
+  transport_alice->shutdown_send();
+  EXPECT_EQ(transport_bob->receive_message(), std::nullopt);
+}
+
+TEST_P(TCPTransportTest, transport_modes) {
+  auto localhost = GetParam();
+  auto transport_alice_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(0, {{localhost, 13345}, {localhost, 13346}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(1, {{localhost, 13345}, {localhost, 13346}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(0));
+  });
+  auto transport_alice = transport_alice_fut.get();
+  auto transport_bob = transport_bob_fut.get();
+
+  // a large batch which is corked in throughput mode
+  std::vector<std::vector<std::uint8_t>> messages(200);
+  for (std::size_t i = 0; i < messages.size(); ++i) {
+    messages[i].assign(1000 + i, static_cast<std::uint8_t>(i));
+  }
+  std::vector<std::span<const std::uint8_t>> buffers(std::begin(messages), std::end(messages));
+
+  for (auto mode : {MOTION::Communication::TransportMode::throughput,
+                    MOTION::Communication::TransportMode::latency}) {
+    transport_alice->set_mode(mode);
+    auto receive_fut = std::async(std::launch::async, [&transport_bob, &messages] {
+      for (const auto& message : messages) {
+        EXPECT_EQ(transport_bob->receive_message(), message);
+      }
+    });
+    transport_alice->send_messages(buffers);
+    receive_fut.get();
+  }
+  EXPECT_FALSE(transport_bob->available());
+}
+
+TEST_P(TCPTransportTest, pooled_receive) {
+  auto localhost = GetParam();
+  auto transport_alice_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(0, {{localhost, 13347}, {localhost, 13348}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(1, {{localhost, 13347}, {localhost, 13348}});
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(0));
+  });
+  auto transport_alice = transport_alice_fut.get();
+  auto transport_bob = transport_bob_fut.get();
+  auto pool = ENCRYPTO::BufferPool::create();
+
+  const std::vector<std::uint8_t> message = {0xde, 0xad, 0xbe, 0xef};
+  constexpr std::size_t num_messages = 10;
+  for (std::size_t i = 0; i < num_messages; ++i) {
+    transport_alice->send_message(message);
+  }
+  for (std::size_t i = 0; i < num_messages; ++i) {
+    auto received_message = transport_bob->receive_pooled_message(*pool);
+    ASSERT_TRUE(received_message.has_value());
+    EXPECT_TRUE(std::equal(std::begin(message), std::end(message),
+                           std::begin(received_message->span()),
+                           std::end(received_message->span())));
+  }
+  // the buffer of the first message is used for all following ones
+  EXPECT_EQ(pool->get_statistics().num_acquired, num_messages);
+  EXPECT_EQ(pool->get_statistics().num_reused, num_messages - 1);
+  EXPECT_EQ(transport_bob->get_stats().num_messages_received, num_messages);
+
+  transport_alice->shutdown_send();
+  EXPECT_EQ(transport_bob->receive_pooled_message(*pool), std::nullopt);
+}
+
+TEST_P(TCPTransportTest, io_uring) {
+  if (!MOTION::Communication::is_io_uring_available()) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  auto localhost = GetParam();
+  auto transport_alice_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(0, {{localhost, 13343}, {localhost, 13344}});
+    helper.set_use_io_uring(true);
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(1));
+  });
+  auto transport_bob_fut = std::async(std::launch::async, [localhost] {
+    MOTION::Communication::TCPSetupHelper helper(1, {{localhost, 13343}, {localhost, 13344}});
+    helper.set_use_io_uring(true);
+    auto transports = helper.setup_connections();
+    return std::move(transports.at(0));
+  });
+  auto transport_alice = transport_alice_fut.get();
+  auto transport_bob = transport_bob_fut.get();
+
+  // small messages around a message larger than the registered receive buffer
+  const std::size_t large_size = 3 * (std::size_t{1} << 20) + 7;
+  std::vector<std::vector<std::uint8_t>> messages = {
+      {0xde, 0xad}, {}, std::vector<std::uint8_t>(large_size), {0xbe, 0xef}};
+  for (std::size_t i = 0; i < large_size; ++i) {
+    messages[2][i] = static_cast<std::uint8_t>(i * 31);
+  }
+  std::vector<std::span<const std::uint8_t>> buffers(std::begin(messages), std::end(messages));
+
+  transport_alice->send_messages(buffers);
+  for (const auto& message : messages) {
+    transport_bob->send_message(message);
+  }
+  for (const auto& message : messages) {
+    EXPECT_EQ(transport_bob->receive_message(), message);
+    EXPECT_EQ(transport_alice->receive_message(), message);
+  }
+  EXPECT_EQ(transport_alice->get_stats().num_messages_sent, messages.size());
+  EXPECT_EQ(transport_bob->get_stats().num_messages_received, messages.size());
+
+  transport_alice->shutdown_send();
+  EXPECT_EQ(transport_bob->receive_message(), std::nullopt);
+  transport_bob->shutdown_send();
+  EXPECT_EQ(transport_alice->receive_message(), std::nullopt);
+}
+
 INSTANTIATE_TEST_SUITE_P(TCPTransportSuite, TCPTransportTest, testing::Values("127.0.0.1", "::1"),
                          [](auto& info) { return info.param == "::1" ? "ipv6" : "ipv4"; });
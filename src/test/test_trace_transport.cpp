@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2021 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communication/dummy_transport.h"
+#include "communication/trace_transport.h"
+
+using namespace MOTION::Communication;
+using namespace std::chrono_literals;
+
+TEST(TraceTransport, RecordAndReplay) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "motion_trace_transport_test.trace").string();
+  auto [dummy_alice, dummy_bob] = DummyTransport::make_transport_pair();
+  {
+    RecordingTransport transport_alice(std::move(dummy_alice), path);
+    auto& transport_bob = *dummy_bob;
+    for (std::uint8_t i = 0; i < 3; ++i) {
+      std::this_thread::sleep_for(20ms);
+      transport_bob.send_message(std::vector<std::uint8_t>(100 * i + 1, i));
+    }
+    transport_bob.shutdown_send();
+    transport_alice.send_message(std::vector<std::uint8_t>{42});
+    EXPECT_EQ(transport_bob.receive_message()->at(0), 42);
+    for (std::uint8_t i = 0; i < 3; ++i) {
+      auto message = transport_alice.receive_message();
+      ASSERT_TRUE(message.has_value());
+      EXPECT_EQ(*message, std::vector<std::uint8_t>(100 * i + 1, i));
+    }
+    EXPECT_FALSE(transport_alice.receive_message().has_value());
+    transport_alice.shutdown();
+  }
+
+  // the messages arrive at their recorded times
+  {
+    const auto start = std::chrono::steady_clock::now();
+    ReplayTransport replay(path);
+    replay.send_message(std::vector<std::uint8_t>{42});
+    EXPECT_FALSE(replay.available());
+    for (std::uint8_t i = 0; i < 3; ++i) {
+      auto message = replay.receive_message();
+      ASSERT_TRUE(message.has_value());
+      EXPECT_EQ(*message, std::vector<std::uint8_t>(100 * i + 1, i));
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 60ms);
+    EXPECT_FALSE(replay.receive_message().has_value());
+    EXPECT_EQ(replay.get_stats().num_messages_received, 3);
+    EXPECT_EQ(replay.get_stats().num_bytes_received, 1 + 101 + 201);
+    EXPECT_EQ(replay.get_stats().num_messages_sent, 1);
+  }
+
+  // without the recorded times all messages are available at once
+  {
+    ReplayTransport replay(path, 0.0);
+    EXPECT_TRUE(replay.available());
+    for (std::uint8_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(replay.receive_message()->size(), 100 * i + 1);
+    }
+    EXPECT_FALSE(replay.receive_message().has_value());
+  }
+
+  // shutting down interrupts the wait for the next message
+  {
+    ReplayTransport replay(path, 1000.0);
+    std::thread shutdown_thread([&replay] {
+      std::this_thread::sleep_for(10ms);
+      replay.shutdown();
+    });
+    EXPECT_FALSE(replay.receive_message().has_value());
+    shutdown_thread.join();
+  }
+
+  std::ofstream(path, std::ios::trunc) << "no trace";
+  EXPECT_THROW(ReplayTransport{path}, std::runtime_error);
+  std::filesystem::remove(path);
+  EXPECT_THROW(ReplayTransport{path}, std::runtime_error);
+}
@@ -24,6 +24,7 @@
 #include <array>
 #include <boost/fiber/future/async.hpp>
 #include <boost/fiber/future/future.hpp>
+#include <filesystem>
 #include <iterator>
 #include <memory>
 
@@ -33,6 +34,7 @@
 #include "crypto/base_ots/base_ot_provider.h"
 #include "crypto/motion_base_provider.h"
 #include "crypto/oblivious_transfer/ot_provider.h"
+#include "data_storage/preprocessing_store.h"
 #include "gate/new_gate.h"
 #include "protocols/beavy/wire.h"
 #include "protocols/gmw/wire.h"
@@ -136,6 +138,70 @@ class YaoTest : public ::testing::Test {
     fut_e.get();
   }
 
+  // run the online phase of each gate directly after its setup phase
+  void run_gates_setup_online() {
+    std::vector<std::future<void>> futs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      futs.emplace_back(std::async(std::launch::async, [this, i] {
+        for (auto& gate : gate_registers_[i]->get_gates()) {
+          if (gate->need_setup()) {
+            gate->evaluate_setup();
+          }
+          if (gate->need_online()) {
+            gate->evaluate_online();
+          }
+        }
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  }
+
+  // write the setup of the providers and the gates to the store of each party
+  void save_setup(const std::array<std::string, 2>& paths) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      MOTION::PreprocessingWriter writer(paths[i], i);
+      writer.begin_record(MOTION::provider_record_id);
+      yao_providers_[i]->save_setup(writer);
+      writer.end_record();
+      for (auto& gate : gate_registers_[i]->get_gates()) {
+        if (gate->need_setup()) {
+          writer.begin_record(gate->get_gate_id());
+          gate->save_setup(writer);
+          writer.end_record();
+        }
+      }
+      writer.finish();
+    }
+  }
+
+  // replace the providers and gates by fresh ones, on which the circuit can be built again
+  void reset_providers() {
+    for (std::size_t i = 0; i < 2; ++i) {
+      gate_registers_[i].reset();
+      yao_providers_[i].reset();
+      gate_registers_[i] = std::make_unique<MOTION::GateRegister>();
+      yao_providers_[i] = std::make_unique<YaoProvider>(
+          *comm_layers_[i], *gate_registers_[i], circuit_loader_, *motion_base_providers_[i],
+          ot_provider_managers_[i]->get_provider(1 - i), loggers_[i]);
+    }
+  }
+
+  void load_setup(const std::array<std::string, 2>& paths) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      const MOTION::PreprocessingReader reader(paths[i], i);
+      std::size_t record_i = 0;
+      auto provider_record = reader.get_record(record_i++);
+      yao_providers_[i]->load_setup(provider_record);
+      for (auto& gate : gate_registers_[i]->get_gates()) {
+        if (gate->need_setup()) {
+          auto record = reader.get_record(record_i++);
+          ASSERT_EQ(record.get_gate_id(), gate->get_gate_id());
+          gate->load_setup(record);
+        }
+      }
+    }
+  }
+
   MOTION::CircuitLoader circuit_loader_;
   std::vector<std::unique_ptr<MOTION::Communication::CommunicationLayer>> comm_layers_;
   std::array<std::unique_ptr<MOTION::BaseOTProvider>, 2> base_ot_providers_;
@@ -235,6 +301,76 @@ TEST_F(YaoTest, InputEvaluator) {
   }
 }
 
+TEST_F(YaoTest, BatchedInputOTs) {
+  std::size_t num_wires = 3;
+  std::size_t num_simd = 10;
+  for (auto& yao_provider : yao_providers_) {
+    yao_provider->set_batch_input_ots(true);
+  }
+  // alternate the input owners, s.t. the keys of all gates share the message of the batch
+  std::vector<std::size_t> input_owners = {garbler_i_, evaluator_i_, evaluator_i_, garbler_i_};
+  std::vector<MOTION::BitValues> inputs;
+  std::vector<ENCRYPTO::ReusableFiberPromise<MOTION::BitValues>> input_promises;
+  std::vector<std::array<MOTION::WireVector, 2>> wires;
+  for (auto owner : input_owners) {
+    inputs.push_back(generate_inputs(num_wires, num_simd));
+    auto [input_promise, wires_my] =
+        yao_providers_[owner]->make_boolean_input_gate_my(owner, num_wires, num_simd);
+    auto wires_other =
+        yao_providers_[1 - owner]->make_boolean_input_gate_other(owner, num_wires, num_simd);
+    input_promises.push_back(std::move(input_promise));
+    wires.emplace_back();
+    wires.back()[owner] = std::move(wires_my);
+    wires.back()[1 - owner] = std::move(wires_other);
+  }
+
+  for (auto& yao_provider : yao_providers_) {
+    yao_provider->register_batched_ots();
+  }
+  run_setup();
+  // the batch completes only after all gates have contributed, so run the gates concurrently
+  auto eval_gates = [this](auto party_id, bool setup) {
+    std::vector<std::future<void>> futs;
+    for (auto& gate : gate_registers_[party_id]->get_gates()) {
+      futs.emplace_back(std::async(std::launch::async, [&gate, setup] {
+        setup ? gate->evaluate_setup() : gate->evaluate_online();
+      }));
+    }
+    std::for_each(std::begin(futs), std::end(futs), [](auto& f) { f.get(); });
+  };
+  auto fut_g = std::async(std::launch::async, eval_gates, garbler_i_, true);
+  auto fut_e = std::async(std::launch::async, eval_gates, evaluator_i_, true);
+  fut_g.get();
+  fut_e.get();
+  for (std::size_t gate_i = 0; gate_i < input_owners.size(); ++gate_i) {
+    input_promises[gate_i].set_value(inputs[gate_i]);
+  }
+  fut_g = std::async(std::launch::async, eval_gates, garbler_i_, false);
+  fut_e = std::async(std::launch::async, eval_gates, evaluator_i_, false);
+  fut_g.get();
+  fut_e.get();
+
+  // check wire values
+  const auto global_offset = yao_providers_[garbler_i_]->get_global_offset();
+  for (std::size_t gate_i = 0; gate_i < input_owners.size(); ++gate_i) {
+    for (std::size_t wire_i = 0; wire_i < num_wires; ++wire_i) {
+      const auto& input_bits = inputs[gate_i].at(wire_i);
+      const auto wire_g = std::dynamic_pointer_cast<YaoWire>(wires[gate_i][garbler_i_].at(wire_i));
+      const auto wire_e =
+          std::dynamic_pointer_cast<YaoWire>(wires[gate_i][evaluator_i_].at(wire_i));
+      const auto& keys_g = wire_g->get_keys();
+      const auto& keys_e = wire_e->get_keys();
+      for (std::size_t simd_i = 0; simd_i < num_simd; ++simd_i) {
+        if (input_bits.Get(simd_i)) {
+          ASSERT_EQ(keys_e.at(simd_i), keys_g.at(simd_i) ^ global_offset);
+        } else {
+          ASSERT_EQ(keys_e.at(simd_i), keys_g.at(simd_i));
+        }
+      }
+    }
+  }
+}
+
 TEST_F(YaoTest, OutputGarbler) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
@@ -429,6 +565,177 @@ TEST_F(YaoTest, AND) {
   ASSERT_EQ(expected_output, outputs);
 }
 
+TEST_F(YaoTest, ANDChainWithGarbledTableWindow) {
+  std::size_t num_wires = 2;
+  std::size_t num_simd = 10;
+  std::size_t num_levels = 5;
+  // the tables of a single gate fill the window, so each gate waits for the previous one
+  for (auto& yao_provider : yao_providers_) {
+    yao_provider->set_garbled_table_window(
+        yao_provider->get_garbled_table_size(num_wires * num_simd));
+  }
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  MOTION::BitValues expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output),
+                 [](const auto& bv_a, const auto& bv_b) { return bv_a & bv_b; });
+
+  auto [input_a_promise, wires_g_in_a] =
+      yao_providers_[garbler_i_]->make_boolean_input_gate_my(garbler_i_, num_wires, num_simd);
+  auto wires_e_in_a =
+      yao_providers_[evaluator_i_]->make_boolean_input_gate_other(garbler_i_, num_wires, num_simd);
+  auto [input_b_promise, wires_g_in_b] =
+      yao_providers_[garbler_i_]->make_boolean_input_gate_my(garbler_i_, num_wires, num_simd);
+  auto wires_e_in_b =
+      yao_providers_[evaluator_i_]->make_boolean_input_gate_other(garbler_i_, num_wires, num_simd);
+
+  // (a & b) & b & ... & b
+  auto wires_g_out = wires_g_in_a;
+  auto wires_e_out = wires_e_in_a;
+  for (std::size_t level_i = 0; level_i < num_levels; ++level_i) {
+    wires_g_out = yao_providers_[garbler_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::AND, wires_g_out, wires_g_in_b);
+    wires_e_out = yao_providers_[evaluator_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::AND, wires_e_out, wires_e_in_b);
+  }
+
+  auto output_future_g =
+      yao_providers_[garbler_i_]->make_boolean_output_gate_my(garbler_i_, wires_g_out);
+  yao_providers_[evaluator_i_]->make_boolean_output_gate_other(garbler_i_, wires_e_out);
+  ASSERT_TRUE(output_future_g.valid());
+
+  run_setup();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  run_gates_setup_online();
+
+  auto outputs = output_future_g.get();
+
+  // check output values
+  ASSERT_EQ(expected_output, outputs);
+}
+
+TEST_F(YaoTest, LabelStreaming) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  for (auto& yao_provider : yao_providers_) {
+    yao_provider->set_label_streaming(true);
+  }
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  MOTION::BitValues expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output),
+                 [](const auto& bv_a, const auto& bv_b) { return ~((bv_a & bv_b) ^ bv_a) & bv_b; });
+
+  auto [input_a_promise, wires_g_in_a] =
+      yao_providers_[garbler_i_]->make_boolean_input_gate_my(garbler_i_, num_wires, num_simd);
+  auto wires_e_in_a =
+      yao_providers_[evaluator_i_]->make_boolean_input_gate_other(garbler_i_, num_wires, num_simd);
+  auto [input_b_promise, wires_g_in_b] =
+      yao_providers_[garbler_i_]->make_boolean_input_gate_my(garbler_i_, num_wires, num_simd);
+  auto wires_e_in_b =
+      yao_providers_[evaluator_i_]->make_boolean_input_gate_other(garbler_i_, num_wires, num_simd);
+
+  // ~((a & b) ^ a) & b, the keys of all intermediate wires can be freed
+  auto build = [](auto& yao_provider, const auto& wires_a, const auto& wires_b) {
+    auto wires = yao_provider->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, wires_a,
+                                                wires_b);
+    wires = yao_provider->make_binary_gate(ENCRYPTO::PrimitiveOperationType::XOR, wires, wires_a);
+    wires = yao_provider->make_unary_gate(ENCRYPTO::PrimitiveOperationType::INV, wires);
+    return yao_provider->make_binary_gate(ENCRYPTO::PrimitiveOperationType::AND, wires, wires_b);
+  };
+  auto wires_g_out = build(yao_providers_[garbler_i_], wires_g_in_a, wires_g_in_b);
+  auto wires_e_out = build(yao_providers_[evaluator_i_], wires_e_in_a, wires_e_in_b);
+
+  auto output_future_g =
+      yao_providers_[garbler_i_]->make_boolean_output_gate_my(garbler_i_, wires_g_out);
+  yao_providers_[evaluator_i_]->make_boolean_output_gate_other(garbler_i_, wires_e_out);
+  ASSERT_TRUE(output_future_g.valid());
+
+  run_setup();
+  run_gates_setup();
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  run_gates_online();
+
+  auto outputs = output_future_g.get();
+
+  // check output values
+  ASSERT_EQ(expected_output, outputs);
+  // the keys of all four gates have been returned to the arena
+  const auto& arena = yao_providers_[garbler_i_]->get_label_arena();
+  EXPECT_EQ(arena.get_num_live_bytes(), 0);
+  EXPECT_GT(arena.get_peak_live_bytes(), 0);
+  EXPECT_LE(arena.get_num_free_bytes(),
+            4 * num_wires * num_simd * sizeof(ENCRYPTO::block128_t));
+}
+
+TEST_F(YaoTest, CircuitFromPreprocessingStore) {
+  std::size_t num_wires = 8;
+  std::size_t num_simd = 10;
+  const std::array<std::string, 2> paths = {
+      (std::filesystem::temp_directory_path() / "motion_yao_store_test_0").string(),
+      (std::filesystem::temp_directory_path() / "motion_yao_store_test_1").string()};
+
+  // (a & b) ^ a with a from the garbler and b from the evaluator
+  auto build_circuit = [this, num_wires, num_simd] {
+    auto [input_a_promise, wires_g_in_a] =
+        yao_providers_[garbler_i_]->make_boolean_input_gate_my(garbler_i_, num_wires, num_simd);
+    auto wires_e_in_a = yao_providers_[evaluator_i_]->make_boolean_input_gate_other(
+        garbler_i_, num_wires, num_simd);
+    auto wires_g_in_b = yao_providers_[garbler_i_]->make_boolean_input_gate_other(
+        evaluator_i_, num_wires, num_simd);
+    auto [input_b_promise, wires_e_in_b] =
+        yao_providers_[evaluator_i_]->make_boolean_input_gate_my(evaluator_i_, num_wires,
+                                                                 num_simd);
+    auto wires_g_and = yao_providers_[garbler_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::AND, wires_g_in_a, wires_g_in_b);
+    auto wires_e_and = yao_providers_[evaluator_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::AND, wires_e_in_a, wires_e_in_b);
+    auto wires_g_out = yao_providers_[garbler_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::XOR, wires_g_and, wires_g_in_a);
+    auto wires_e_out = yao_providers_[evaluator_i_]->make_binary_gate(
+        ENCRYPTO::PrimitiveOperationType::XOR, wires_e_and, wires_e_in_a);
+    auto output_future_g =
+        yao_providers_[garbler_i_]->make_boolean_output_gate_my(MOTION::ALL_PARTIES, wires_g_out);
+    auto output_future_e = yao_providers_[evaluator_i_]->make_boolean_output_gate_my(
+        MOTION::ALL_PARTIES, wires_e_out);
+    return std::make_tuple(std::move(input_a_promise), std::move(input_b_promise),
+                           std::move(output_future_g), std::move(output_future_e));
+  };
+
+  // garble the circuit and store it
+  {
+    auto circuit = build_circuit();
+    run_setup();
+    run_gates_setup();
+    save_setup(paths);
+  }
+
+  // evaluate the stored circuit with fresh providers, which do not run any setup
+  reset_providers();
+  auto [input_a_promise, input_b_promise, output_future_g, output_future_e] = build_circuit();
+  load_setup(paths);
+  const auto inputs_a = generate_inputs(num_wires, num_simd);
+  const auto inputs_b = generate_inputs(num_wires, num_simd);
+  MOTION::BitValues expected_output;
+  std::transform(std::begin(inputs_a), std::end(inputs_a), std::begin(inputs_b),
+                 std::back_inserter(expected_output),
+                 [](const auto& bv_a, const auto& bv_b) { return (bv_a & bv_b) ^ bv_a; });
+  input_a_promise.set_value(inputs_a);
+  input_b_promise.set_value(inputs_b);
+  run_gates_online();
+
+  // check output values
+  ASSERT_EQ(expected_output, output_future_g.get());
+  ASSERT_EQ(expected_output, output_future_e.get());
+  for (const auto& path : paths) {
+    std::filesystem::remove(path);
+  }
+}
+
 TEST_F(YaoTest, YaoToBooleanGMW) {
   std::size_t num_wires = 8;
   std::size_t num_simd = 10;
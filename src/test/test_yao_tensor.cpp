@@ -236,6 +236,46 @@ class YaoArithmeticGMWTensorTest : public YaoTensorTest {
       return gp.make_arithmetic_32_tensor_output_my(in);
     }
   }
+  // check that the outputs of YaoProvider::make_tensor_relu_op hold the ReLU of the inputs
+  void check_relu_keys(const std::vector<T>& input,
+                       const MOTION::tensor::TensorCP& output_tensor_0,
+                       const MOTION::tensor::TensorCP& output_tensor_1) {
+    const auto yao_tensor_0 = std::dynamic_pointer_cast<const YaoTensor>(output_tensor_0);
+    const auto yao_tensor_1 = std::dynamic_pointer_cast<const YaoTensor>(output_tensor_1);
+    ASSERT_NE(yao_tensor_0, nullptr);
+    ASSERT_NE(yao_tensor_1, nullptr);
+    yao_tensor_0->wait_setup();
+    yao_tensor_1->wait_online();
+
+    const auto& R = yao_providers_[0]->get_global_offset();
+    const auto& zero_keys = yao_tensor_0->get_keys();
+    const auto& evaluator_keys = yao_tensor_1->get_keys();
+    constexpr auto bit_size = ENCRYPTO::bit_size_v<T>;
+    const auto data_size = input.size();
+    ASSERT_EQ(zero_keys.size(), data_size * bit_size);
+    ASSERT_EQ(evaluator_keys.size(), data_size * bit_size);
+    for (std::size_t int_i = 0; int_i < data_size; ++int_i) {
+      const auto value = input.at(int_i);
+      bool zero = (value >> (ENCRYPTO::bit_size_v<T> - 1)) == 0;
+      if (zero) {
+        for (std::size_t bit_j = 0; bit_j < ENCRYPTO::bit_size_v<T>; ++bit_j) {
+          auto idx = bit_j * data_size + int_i;
+          EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx));
+        }
+      } else {
+        for (std::size_t bit_j = 0; bit_j < ENCRYPTO::bit_size_v<T> - 1; ++bit_j) {
+          auto idx = bit_j * data_size + int_i;
+          if (value & (T(1) << bit_j)) {
+            EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx) ^ R);
+          } else {
+            EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx));
+          }
+        }
+        auto idx = (ENCRYPTO::bit_size_v<T> - 1) * data_size + int_i;
+        EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx) ^ R);
+      }
+    }
+  }
 };
 
 using integer_types = ::testing::Types<std::uint32_t, std::uint64_t>;
@@ -413,41 +453,32 @@ TYPED_TEST(YaoArithmeticGMWTensorTest, ReLU) {
   input_promise.set_value(input);
   this->run_gates_online();
 
-  const auto yao_tensor_0 = std::dynamic_pointer_cast<const YaoTensor>(output_tensor_0);
-  const auto yao_tensor_1 = std::dynamic_pointer_cast<const YaoTensor>(output_tensor_1);
-  ASSERT_NE(yao_tensor_0, nullptr);
-  ASSERT_NE(yao_tensor_1, nullptr);
-  yao_tensor_0->wait_setup();
-  yao_tensor_1->wait_online();
+  this->check_relu_keys(input, output_tensor_0, output_tensor_1);
+}
 
-  const auto& R = this->yao_providers_[0]->get_global_offset();
-  const auto& zero_keys = yao_tensor_0->get_keys();
-  const auto& evaluator_keys = yao_tensor_1->get_keys();
-  constexpr auto bit_size = ENCRYPTO::bit_size_v<TypeParam>;
-  const auto data_size = input.size();
-  ASSERT_EQ(zero_keys.size(), data_size * bit_size);
-  ASSERT_EQ(evaluator_keys.size(), data_size * bit_size);
-  for (std::size_t int_i = 0; int_i < data_size; ++int_i) {
-    const auto value = input.at(int_i);
-    bool zero = (value >> (ENCRYPTO::bit_size_v<TypeParam> - 1)) == 0;
-    if (zero) {
-      for (std::size_t bit_j = 0; bit_j < ENCRYPTO::bit_size_v<TypeParam>; ++bit_j) {
-        auto idx = bit_j * data_size + int_i;
-        EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx));
-      }
-    } else {
-      for (std::size_t bit_j = 0; bit_j < ENCRYPTO::bit_size_v<TypeParam> - 1; ++bit_j) {
-        auto idx = bit_j * data_size + int_i;
-        if (value & (TypeParam(1) << bit_j)) {
-          EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx) ^ R);
-        } else {
-          EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx));
-        }
-      }
-      auto idx = (ENCRYPTO::bit_size_v<TypeParam> - 1) * data_size + int_i;
-      EXPECT_EQ(evaluator_keys.at(idx), zero_keys.at(idx) ^ R);
-    }
+// the tables are sent in several messages, the last of which is shorter
+TYPED_TEST(YaoArithmeticGMWTensorTest, ReLUChunked) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = this->generate_inputs(dims);
+  for (auto& yp : this->yao_providers_) {
+    yp->set_tensor_chunk_size(100);
   }
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto tensor_0 = this->yao_providers_[0]->make_convert_from_arithmetic_gmw_tensor(tensor_in_0);
+  auto tensor_1 = this->yao_providers_[1]->make_convert_from_arithmetic_gmw_tensor(tensor_in_1);
+  auto output_tensor_0 = this->yao_providers_[0]->make_tensor_relu_op(tensor_0);
+  auto output_tensor_1 = this->yao_providers_[1]->make_tensor_relu_op(tensor_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  this->check_relu_keys(input, output_tensor_0, output_tensor_1);
 }
 
 TYPED_TEST(YaoArithmeticGMWTensorTest, ReLUInBooleanGMW) {
@@ -550,6 +581,57 @@ TYPED_TEST(YaoArithmeticGMWTensorTest, ReLUInBooleanXArithmeticGMW) {
   }
 }
 
+TYPED_TEST(YaoArithmeticGMWTensorTest, ReLUInBooleanXArithmeticGMWFromMSB) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = this->generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto tensor_yao_0 =
+      this->yao_providers_[0]->make_convert_from_arithmetic_gmw_tensor(tensor_in_0, true);
+  auto tensor_yao_1 =
+      this->yao_providers_[1]->make_convert_from_arithmetic_gmw_tensor(tensor_in_1, true);
+  auto tensor_gmw_0 = this->yao_providers_[0]->make_convert_to_boolean_gmw_tensor(tensor_yao_0);
+  auto tensor_gmw_1 = this->yao_providers_[1]->make_convert_to_boolean_gmw_tensor(tensor_yao_1);
+  ASSERT_EQ(tensor_gmw_0->get_bit_size(), 1);
+  ASSERT_EQ(tensor_gmw_1->get_bit_size(), 1);
+  auto output_tensor_0 = this->gmw_providers_[0]->make_tensor_relu_op(tensor_gmw_0, tensor_in_0);
+  auto output_tensor_1 = this->gmw_providers_[1]->make_tensor_relu_op(tensor_gmw_1, tensor_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto gmw_tensor_0 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(output_tensor_0);
+  const auto gmw_tensor_1 =
+      std::dynamic_pointer_cast<const ArithmeticGMWTensor<TypeParam>>(output_tensor_1);
+  ASSERT_NE(gmw_tensor_0, nullptr);
+  ASSERT_NE(gmw_tensor_1, nullptr);
+  gmw_tensor_0->wait_online();
+  gmw_tensor_1->wait_online();
+
+  const auto& share_0 = gmw_tensor_0->get_share();
+  const auto& share_1 = gmw_tensor_1->get_share();
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<TypeParam>;
+  const auto data_size = input.size();
+  ASSERT_EQ(share_0.size(), data_size);
+  ASSERT_EQ(share_1.size(), data_size);
+  const auto plain_ints = MOTION::Helpers::AddVectors(share_0, share_1);
+  for (std::size_t int_i = 0; int_i < data_size; ++int_i) {
+    const auto value = input.at(int_i);
+    const auto msb = bool(value >> (ENCRYPTO::bit_size_v<TypeParam> - 1));
+    if (msb) {
+      EXPECT_EQ(plain_ints.at(int_i), 0);
+    } else {
+      EXPECT_EQ(plain_ints.at(int_i), value);
+    }
+  }
+}
+
 TYPED_TEST(YaoArithmeticGMWTensorTest, MaxPoolSimple) {
   const MOTION::tensor::TensorDimensions dims = {
       .batch_size_ = 1, .num_channels_ = 1, .height_ = 2, .width_ = 2};
@@ -1111,6 +1193,97 @@ TYPED_TEST(YaoArithmeticBEAVYTensorTest, ReLUInBooleanXArithmeticBEAVY) {
   }
 }
 
+TYPED_TEST(YaoArithmeticBEAVYTensorTest, ReLUInBooleanXArithmeticBEAVYFromMSB) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = this->generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto tensor_yao_0 =
+      this->yao_providers_[0]->make_convert_from_arithmetic_beavy_tensor(tensor_in_0, true);
+  auto tensor_yao_1 =
+      this->yao_providers_[1]->make_convert_from_arithmetic_beavy_tensor(tensor_in_1, true);
+  auto tensor_beavy_0 = this->yao_providers_[0]->make_convert_to_boolean_beavy_tensor(tensor_yao_0);
+  auto tensor_beavy_1 = this->yao_providers_[1]->make_convert_to_boolean_beavy_tensor(tensor_yao_1);
+  ASSERT_EQ(tensor_beavy_0->get_bit_size(), 1);
+  ASSERT_EQ(tensor_beavy_1->get_bit_size(), 1);
+  auto output_tensor_0 =
+      this->beavy_providers_[0]->make_tensor_relu_op(tensor_beavy_0, tensor_in_0);
+  auto output_tensor_1 =
+      this->beavy_providers_[1]->make_tensor_relu_op(tensor_beavy_1, tensor_in_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  const auto beavy_tensor_0 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(output_tensor_0);
+  const auto beavy_tensor_1 =
+      std::dynamic_pointer_cast<const ArithmeticBEAVYTensor<TypeParam>>(output_tensor_1);
+  ASSERT_NE(beavy_tensor_0, nullptr);
+  ASSERT_NE(beavy_tensor_1, nullptr);
+  beavy_tensor_0->wait_online();
+  beavy_tensor_1->wait_online();
+
+  const auto& pshare_0 = beavy_tensor_0->get_public_share();
+  const auto& pshare_1 = beavy_tensor_1->get_public_share();
+  const auto& sshare_0 = beavy_tensor_0->get_secret_share();
+  const auto& sshare_1 = beavy_tensor_1->get_secret_share();
+  constexpr auto bit_size = ENCRYPTO::bit_size_v<TypeParam>;
+  const auto data_size = input.size();
+  ASSERT_EQ(pshare_0.size(), data_size);
+  ASSERT_EQ(pshare_0, pshare_1);
+  ASSERT_EQ(sshare_0.size(), data_size);
+  ASSERT_EQ(sshare_1.size(), data_size);
+  const auto plain_ints =
+      MOTION::Helpers::SubVectors(pshare_0, MOTION::Helpers::AddVectors(sshare_0, sshare_1));
+  for (std::size_t int_i = 0; int_i < data_size; ++int_i) {
+    const auto value = input.at(int_i);
+    const auto msb = bool(value >> (ENCRYPTO::bit_size_v<TypeParam> - 1));
+    if (msb) {
+      EXPECT_EQ(plain_ints.at(int_i), 0);
+    } else {
+      EXPECT_EQ(plain_ints.at(int_i), value);
+    }
+  }
+}
+
+// conversion to Yao, ReLU and conversion back in one op
+TYPED_TEST(YaoArithmeticBEAVYTensorTest, FusedReLU) {
+  MOTION::tensor::TensorDimensions dims = {
+      .batch_size_ = 1, .num_channels_ = 1, .height_ = 28, .width_ = 28};
+  const auto input = this->generate_inputs(dims);
+
+  auto [input_promise, tensor_in_0] = this->make_arithmetic_T_tensor_input_my(0, dims);
+  auto tensor_in_1 = this->make_arithmetic_T_tensor_input_other(1, dims);
+
+  auto output_tensor_0 = this->yao_providers_[0]->make_arithmetic_beavy_tensor_relu_op(tensor_in_0);
+  auto output_tensor_1 = this->yao_providers_[1]->make_arithmetic_beavy_tensor_relu_op(tensor_in_1);
+
+  this->beavy_providers_[0]->make_arithmetic_tensor_output_other(output_tensor_0);
+  auto output_future = this->make_arithmetic_T_tensor_output_my(1, output_tensor_1);
+
+  this->run_setup();
+  this->run_gates_setup();
+  input_promise.set_value(input);
+  this->run_gates_online();
+
+  auto output = output_future.get();
+  ASSERT_EQ(output.size(), dims.get_data_size());
+  for (std::size_t int_i = 0; int_i < output.size(); ++int_i) {
+    const auto value = input.at(int_i);
+    const auto msb = bool(value >> (ENCRYPTO::bit_size_v<TypeParam> - 1));
+    if (msb) {
+      EXPECT_EQ(output.at(int_i), 0);
+    } else {
+      EXPECT_EQ(output.at(int_i), value);
+    }
+  }
+}
+
 TYPED_TEST(YaoArithmeticBEAVYTensorTest, MaxPoolInBooleanBEAVY) {
   const MOTION::tensor::TensorDimensions dims = {
       .batch_size_ = 1, .num_channels_ = 1, .height_ = 4, .width_ = 4};